@@ -8,6 +8,8 @@ endif
 SPVTOOLS_SRC_FILES := \
 		source/assembly_grammar.cpp \
 		source/binary.cpp \
+		source/binary_codec.cpp \
+		source/binary_index.cpp \
 		source/diagnostic.cpp \
 		source/disassemble.cpp \
 		source/ext_inst.cpp \
@@ -19,6 +21,7 @@ SPVTOOLS_SRC_FILES := \
 		source/operand.cpp \
 		source/parsed_operand.cpp \
 		source/print.cpp \
+		source/reflection.cpp \
 		source/software_version.cpp \
 		source/spirv_endian.cpp \
 		source/spirv_optimizer_options.cpp \
@@ -28,7 +31,11 @@ SPVTOOLS_SRC_FILES := \
 		source/text.cpp \
 		source/text_handler.cpp \
 		source/util/bit_vector.cpp \
+		source/util/node_pool.cpp \
+		source/util/parallel.cpp \
 		source/util/parse_number.cpp \
+		source/util/profiler.cpp \
+		source/util/sha256.cpp \
 		source/util/string_utils.cpp \
 		source/util/timer.cpp \
 		source/val/basic_block.cpp \
@@ -76,15 +83,18 @@ SPVTOOLS_OPT_SRC_FILES := \
 		source/opt/aggressive_dead_code_elim_pass.cpp \
 		source/opt/amd_ext_to_khr.cpp \
 		source/opt/basic_block.cpp \
+		source/opt/binary_filter.cpp \
 		source/opt/block_merge_pass.cpp \
 		source/opt/block_merge_util.cpp \
 		source/opt/build_module.cpp \
+		source/opt/call_graph.cpp \
 		source/opt/cfg.cpp \
 		source/opt/cfg_cleanup_pass.cpp \
 		source/opt/ccp_pass.cpp \
 		source/opt/code_sink.cpp \
 		source/opt/combine_access_chains.cpp \
 		source/opt/compact_ids_pass.cpp \
+		source/opt/compact_instruction.cpp \
 		source/opt/composite.cpp \
 		source/opt/const_folding_rules.cpp \
 		source/opt/constants.cpp \
@@ -93,6 +103,7 @@ SPVTOOLS_OPT_SRC_FILES := \
 		source/opt/dead_branch_elim_pass.cpp \
 		source/opt/dead_insert_elim_pass.cpp \
 		source/opt/dead_variable_elimination.cpp \
+		source/opt/debug_line_table.cpp \
 		source/opt/decompose_initialized_variables_pass.cpp \
 		source/opt/decoration_manager.cpp \
 		source/opt/def_use_manager.cpp \
@@ -105,20 +116,26 @@ SPVTOOLS_OPT_SRC_FILES := \
 		source/opt/eliminate_dead_members_pass.cpp \
 		source/opt/feature_manager.cpp \
 		source/opt/fix_storage_class.cpp \
+		source/opt/fixpoint_pass.cpp \
 		source/opt/flatten_decoration_pass.cpp \
+		source/opt/float_range_analysis.cpp \
 		source/opt/fold.cpp \
 		source/opt/folding_rules.cpp \
 		source/opt/fold_spec_constant_op_and_composite_pass.cpp \
 		source/opt/freeze_spec_constant_value_pass.cpp \
 		source/opt/function.cpp \
+		source/opt/function_stream.cpp \
 		source/opt/generate_webgpu_initializers_pass.cpp \
 		source/opt/graphics_robust_access_pass.cpp \
+		source/opt/id_allocator.cpp \
 		source/opt/if_conversion.cpp \
 		source/opt/inline_pass.cpp \
+		source/opt/inline_cost_pass.cpp \
 		source/opt/inline_exhaustive_pass.cpp \
 		source/opt/inline_opaque_pass.cpp \
 		source/opt/inst_bindless_check_pass.cpp \
 		source/opt/inst_buff_addr_check_pass.cpp \
+		source/opt/inst_profile_pass.cpp \
 		source/opt/instruction.cpp \
 		source/opt/instruction_list.cpp \
 		source/opt/instrument_pass.cpp \
@@ -141,15 +158,22 @@ SPVTOOLS_OPT_SRC_FILES := \
 		source/opt/loop_unswitch_pass.cpp \
 		source/opt/loop_utils.cpp \
 		source/opt/mem_pass.cpp \
+		source/opt/memory_load_store_elim_pass.cpp \
+		source/opt/memory_ssa.cpp \
+		source/opt/merge_identical_functions_pass.cpp \
 		source/opt/merge_return_pass.cpp \
 		source/opt/module.cpp \
+		source/opt/module_snapshot.cpp \
+		source/opt/module_summary.cpp \
 		source/opt/optimizer.cpp \
+		source/opt/partial_redundancy_elimination.cpp \
 		source/opt/pass.cpp \
 		source/opt/pass_manager.cpp \
 		source/opt/private_to_local_pass.cpp \
 		source/opt/process_lines_pass.cpp \
 		source/opt/propagator.cpp \
 		source/opt/reduce_load_size.cpp \
+		source/opt/reduce_register_pressure.cpp \
 		source/opt/redundancy_elimination.cpp \
 		source/opt/register_pressure.cpp \
 		source/opt/relax_float_ops_pass.cpp \
@@ -159,6 +183,7 @@ SPVTOOLS_OPT_SRC_FILES := \
 		source/opt/scalar_analysis_simplification.cpp \
 		source/opt/scalar_replacement_pass.cpp \
 		source/opt/set_spec_constant_default_value_pass.cpp \
+		source/opt/slp_vectorize_pass.cpp \
 		source/opt/simplification_pass.cpp \
 		source/opt/split_invalid_unreachable_pass.cpp \
 		source/opt/ssa_rewrite_pass.cpp \
@@ -169,6 +194,7 @@ SPVTOOLS_OPT_SRC_FILES := \
 		source/opt/struct_cfg_analysis.cpp \
 		source/opt/type_manager.cpp \
 		source/opt/types.cpp \
+		source/opt/uniformity_analysis.cpp \
 		source/opt/unify_const_pass.cpp \
 		source/opt/upgrade_memory_model.cpp \
 		source/opt/value_number_table.cpp \
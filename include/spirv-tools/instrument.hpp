@@ -208,6 +208,9 @@ static const int kDebugInputBindingBindless = 1;
 // The binding for the input buffer read by InstBuffAddrCheckPass.
 static const int kDebugInputBindingBuffAddr = 2;
 
+// The binding for the output buffer written by InstProfilePass.
+static const int kDebugOutputBindingProfile = 3;
+
 // Bindless Validation Input Buffer Format
 //
 // An input buffer for bindless validation consists of a single array of
@@ -254,6 +257,30 @@ static const int kDebugInputBuffAddrPtrOffset = 1;
 // not a valid buffer, the length associated with the 0x0 address is zero.
 static const int kDebugInputBuffAddrLengthOffset = 0;
 
+// Profile Output Buffer Format
+//
+// The output buffer written by InstProfilePass has the same layout as the
+// stream output buffer, but its size member is not written. The data array
+// holds one record of kInstProfileOutCnt uints per profiled site, the record
+// of site s starting at Data[ s * kInstProfileOutCnt ]. The host is expected
+// to zero the buffer before the shader runs. A site which does not fit in the
+// buffer is not recorded.
+//
+// The index of the instruction which starts the site: the first instruction
+// of a function, or the merge instruction of a structured construct. For a
+// loop, this is the OpLoopMerge of its header.
+static const int kInstProfileOutInstructionIdx = 0;
+//
+// The number of times an invocation went through the site.
+static const int kInstProfileOutCount = 1;
+//
+// The total number of shader clock cycles spent in the site, summed over
+// all invocations, as a 64-bit value split in two uints. Each pass through
+// the site counts the low 32 bits of the subgroup clock.
+static const int kInstProfileOutCyclesLo = 2;
+static const int kInstProfileOutCyclesHi = 3;
+static const int kInstProfileOutCnt = 4;
+
 }  // namespace spvtools
 
 #endif  // INCLUDE_SPIRV_TOOLS_INSTRUMENT_HPP_
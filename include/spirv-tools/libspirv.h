@@ -301,6 +301,9 @@ typedef enum spv_binary_to_text_options_t {
   // time, but will use common names for scalar types, and debug names from
   // OpName instructions.
   SPV_BINARY_TO_TEXT_OPTION_FRIENDLY_NAMES = SPV_BIT(6),
+  // Format function bodies on multiple threads.  The output is the same as
+  // without this option.
+  SPV_BINARY_TO_TEXT_OPTION_PARALLEL = SPV_BIT(7),
   SPV_FORCE_32_BIT_ENUM(spv_binary_to_text_options_t)
 } spv_binary_to_text_options_t;
 
@@ -359,6 +362,21 @@ typedef struct spv_binary_t {
   size_t wordCount;
 } spv_binary_t;
 
+// A SPIR-V binary in the compact encoding of spvBinaryEncode.
+typedef struct spv_encoded_binary_t {
+  uint8_t* bytes;
+  size_t size;
+} spv_encoded_binary_t;
+
+// A range of the words of a SPIR-V binary, found with a spv_binary_index.
+typedef struct spv_binary_range_t {
+  // The result id of the function or the block in the range, if any.
+  uint32_t id;
+  // The offsets of the first word of the range and of the word past its end.
+  size_t begin;
+  size_t end;
+} spv_binary_range_t;
+
 typedef struct spv_text_t {
   const char* str;
   size_t length;
@@ -388,10 +406,17 @@ typedef struct spv_reducer_options_t spv_reducer_options_t;
 
 typedef struct spv_fuzzer_options_t spv_fuzzer_options_t;
 
+typedef struct spv_binary_parser_t spv_binary_parser_t;
+
+typedef struct spv_incremental_validator_t spv_incremental_validator_t;
+
+typedef struct spv_binary_index_t spv_binary_index_t;
+
 // Type Definitions
 
 typedef spv_const_binary_t* spv_const_binary;
 typedef spv_binary_t* spv_binary;
+typedef spv_encoded_binary_t* spv_encoded_binary;
 typedef spv_text_t* spv_text;
 typedef spv_position_t* spv_position;
 typedef spv_diagnostic_t* spv_diagnostic;
@@ -405,6 +430,10 @@ typedef spv_reducer_options_t* spv_reducer_options;
 typedef const spv_reducer_options_t* spv_const_reducer_options;
 typedef spv_fuzzer_options_t* spv_fuzzer_options;
 typedef const spv_fuzzer_options_t* spv_const_fuzzer_options;
+typedef spv_binary_parser_t* spv_binary_parser;
+typedef spv_incremental_validator_t* spv_incremental_validator;
+typedef spv_binary_index_t* spv_binary_index;
+typedef const spv_binary_index_t* spv_const_binary_index;
 
 // Platform API
 
@@ -598,6 +627,72 @@ SPIRV_TOOLS_EXPORT void spvValidatorOptionsSetScalarBlockLayout(
 SPIRV_TOOLS_EXPORT void spvValidatorOptionsSetSkipBlockLayout(
     spv_validator_options options, bool val);
 
+// Records whether the validator should only check that the module is
+// structurally sound, skipping the rules that a module built by a trusted
+// producer is expected to satisfy already.
+//
+// A module accepted with this option is guaranteed to:
+// - be a well-formed binary of the target environment: its header, the
+//   encoding and operands of its instructions, and the layout of its sections;
+// - use only declared capabilities and extensions;
+// - define every id exactly once, before its uses unless forward references
+//   are allowed, and only use ids of the right kind where the operand
+//   requires one;
+// - have well-formed type, constant and function declarations;
+// - have well-formed control flow: blocks and terminators, branch and OpPhi
+//   operands, structured control flow rules, and definitions dominating uses.
+//
+// It does not check decorations or block layouts, the interfaces of entry
+// points, built-in variables, the execution model and environment limitations
+// of instructions, nor the operand rules of individual non-control-flow
+// instructions, such as arithmetic, memory, image and atomic operations.
+SPIRV_TOOLS_EXPORT void spvValidatorOptionsSetStructuralOnly(
+    spv_validator_options options, bool val);
+
+// Records the number of threads the validator may use to check the
+// instructions of different functions concurrently.  A value of 0 means one
+// thread per hardware thread.  The default is 1, which checks every
+// instruction on the calling thread.  The result and diagnostic are the same
+// for any number of threads.
+SPIRV_TOOLS_EXPORT void spvValidatorOptionsSetNumThreads(
+    spv_validator_options options, uint32_t num_threads);
+
+// A function that returns true if the module identified by |key| was stored
+// as valid.  |key| is a null-terminated string of lowercase hexadecimal
+// digits.
+typedef bool (*spv_validation_cache_lookup_fn_t)(void* user_data,
+                                                 const char* key);
+
+// A function that stores the module identified by |key| as valid.  |key| is a
+// null-terminated string of lowercase hexadecimal digits.
+typedef void (*spv_validation_cache_store_fn_t)(void* user_data,
+                                                const char* key);
+
+// Records a cache of the modules known to be valid, for
+// spvValidateWithOptions.  Before validating a module, it calls |lookup| with
+// |user_data| and the key of the module, and returns SPV_SUCCESS right away
+// if |lookup| returns true.  Otherwise it calls |store| once the module is
+// found valid.  The key is a SHA-256 hash of the binary, of the target
+// environment, of the options that affect the result and of the version of
+// the validator.  Warnings are not repeated for a module found in the cache.
+// A null |lookup| removes the cache.
+SPIRV_TOOLS_EXPORT void spvValidatorOptionsSetCache(
+    spv_validator_options options, spv_validation_cache_lookup_fn_t lookup,
+    spv_validation_cache_store_fn_t store, void* user_data);
+
+// A function that receives the time report of a validation: a
+// null-terminated table of the time spent in each phase of the validation and
+// in each check of the instructions within the phase.
+typedef void (*spv_validator_time_report_fn_t)(void* user_data,
+                                               const char* report);
+
+// Calls |report| with |user_data| and the time report at the end of each
+// validation which checks the module.  A module found in the cache of valid
+// modules is not reported.  A null |report| turns the reports off.
+SPIRV_TOOLS_EXPORT void spvValidatorOptionsSetTimeReport(
+    spv_validator_options options, spv_validator_time_report_fn_t report,
+    void* user_data);
+
 // Creates an optimizer options object with default options. Returns a valid
 // options object. The object remains valid until it is passed into
 // |spvOptimizerOptionsDestroy|.
@@ -630,6 +725,21 @@ SPIRV_TOOLS_EXPORT void spvOptimizerOptionsSetPreserveBindings(
 SPIRV_TOOLS_EXPORT void spvOptimizerOptionsSetPreserveSpecConstants(
     spv_optimizer_options options, bool val);
 
+// Records the number of threads the optimizer may use to build the analyses
+// of different functions concurrently.  A value of 0 means one thread per
+// hardware thread.  The default is 1.  The result is the same for any number
+// of threads.
+SPIRV_TOOLS_EXPORT void spvOptimizerOptionsSetNumThreads(
+    spv_optimizer_options options, uint32_t num_threads);
+
+// Records the time in microseconds the passes of an optimizer run may take.
+// Once it is spent, the passes left are skipped, except those the module
+// needs for its target environment, and the module is returned as far as it
+// was optimized.  A pass which is running is not interrupted.  A value of 0,
+// the default, means no limit.
+SPIRV_TOOLS_EXPORT void spvOptimizerOptionsSetTimeBudget(
+    spv_optimizer_options options, uint32_t microseconds);
+
 // Creates a reducer options object with default options. Returns a valid
 // options object. The object remains valid until it is passed into
 // |spvReducerOptionsDestroy|.
@@ -650,6 +760,35 @@ SPIRV_TOOLS_EXPORT void spvReducerOptionsSetStepLimit(
 SPIRV_TOOLS_EXPORT void spvReducerOptionsSetFailOnValidationError(
     spv_reducer_options options, bool fail_on_validation_error);
 
+// Records the number of threads the reducer may use to test reduction steps
+// concurrently.  A value of 0 means one thread per hardware thread.  The
+// default is 1.  With more than one thread, each pass produces several
+// candidate steps, for consecutive chunks of its opportunities, and tests
+// them at once; the first interesting one in order is kept.  The result is
+// the same for any number of threads, but the interestingness function is
+// called concurrently, and for steps which are then discarded.
+SPIRV_TOOLS_EXPORT void spvReducerOptionsSetNumThreads(
+    spv_reducer_options options, uint32_t num_threads);
+
+// Sets the adaptive-scheduling option; if true, the passes of each round
+// after the first run in decreasing order of the fraction of their steps
+// found interesting so far, and each pass also tries applying all its
+// opportunities but a chunk of them, as delta debugging does, until this
+// stops paying off.  This usually reaches a similar result with fewer calls
+// to the interestingness function, but the result may differ from the one
+// reached without it.  The default is false.
+SPIRV_TOOLS_EXPORT void spvReducerOptionsSetAdaptiveScheduling(
+    spv_reducer_options options, bool adaptive_scheduling);
+
+// Sets the function-by-function option; if true, the reducer first removes
+// the functions which are not needed, then reduces the remaining functions
+// one at a time, each time looking for reduction opportunities in that
+// function only, and finally removes the functions which are no longer
+// needed.  The cost of each reduction step then depends on the size of one
+// function rather than of the whole module.  The default is false.
+SPIRV_TOOLS_EXPORT void spvReducerOptionsSetFunctionByFunction(
+    spv_reducer_options options, bool function_by_function);
+
 // Creates a fuzzer options object with default options. Returns a valid
 // options object. The object remains valid until it is passed into
 // |spvFuzzerOptionsDestroy|.
@@ -673,6 +812,13 @@ SPIRV_TOOLS_EXPORT void spvFuzzerOptionsSetRandomSeed(
 SPIRV_TOOLS_EXPORT void spvFuzzerOptionsSetShrinkerStepLimit(
     spv_fuzzer_options options, uint32_t shrinker_step_limit);
 
+// Records the number of threads the shrinker may use to try removing chunks
+// of transformations concurrently.  A value of 0 means one thread per
+// hardware thread.  The default is 1.  The result is the same for any number
+// of threads, but the interestingness function is called concurrently.
+SPIRV_TOOLS_EXPORT void spvFuzzerOptionsSetShrinkerNumThreads(
+    spv_fuzzer_options options, uint32_t shrinker_num_threads);
+
 // Enables running the validator after every pass is applied during a fuzzing
 // run.
 SPIRV_TOOLS_EXPORT void spvFuzzerOptionsEnableFuzzerPassValidation(
@@ -698,6 +844,37 @@ SPIRV_TOOLS_EXPORT spv_result_t spvTextToBinaryWithOptions(
     const spv_const_context context, const char* text, const size_t length,
     const uint32_t options, spv_binary* binary, spv_diagnostic* diagnostic);
 
+// A function that supplies assembly text to spvTextToBinaryStream.  It copies
+// up to size bytes of the text into buffer, and returns the number of bytes
+// copied.  Returning 0 indicates the end of the text.
+typedef size_t (*spv_text_read_fn_t)(void* user_data, char* buffer,
+                                     size_t size);
+
+// A function that receives binary words from spvTextToBinaryStream.  It is
+// given num_words words to be stored starting at word offset in the binary.
+// Returns SPV_SUCCESS to continue assembling, and any other value to stop.
+typedef spv_result_t (*spv_binary_write_fn_t)(void* user_data, size_t offset,
+                                              const uint32_t* words,
+                                              size_t num_words);
+
+// Encodes SPIR-V assembly text to its binary representation, like
+// spvTextToBinaryWithOptions, but without holding the whole module in memory.
+// The text is read incrementally by calling read_text, and each instruction is
+// passed to write_binary as soon as it is encoded.  Words are written in
+// increasing order of offset, except that the header is written first with an
+// Id bound of 0, and is written again at the end with the final Id bound.
+// The user_data argument is passed to both functions.  Any error will be
+// written into *diagnostic if diagnostic is non-null, otherwise the context's
+// message consumer will be used.
+//
+// Memory use is proportional to the largest instruction and to the number of
+// Ids in the module.  The SPV_TEXT_TO_BINARY_OPTION_PRESERVE_NUMERIC_IDS
+// option requires reading the text twice, and is not supported.
+SPIRV_TOOLS_EXPORT spv_result_t spvTextToBinaryStream(
+    const spv_const_context context, void* user_data,
+    spv_text_read_fn_t read_text, spv_binary_write_fn_t write_binary,
+    const uint32_t options, spv_diagnostic* diagnostic);
+
 // Frees an allocated text stream. This is a no-op if the text parameter
 // is a null pointer.
 SPIRV_TOOLS_EXPORT void spvTextDestroy(spv_text text);
@@ -715,6 +892,23 @@ SPIRV_TOOLS_EXPORT spv_result_t spvBinaryToText(const spv_const_context context,
                                                 spv_text* text,
                                                 spv_diagnostic* diagnostic);
 
+// A function that receives text from spvBinaryToTextStream.  It is called
+// with successive pieces of the text, where each piece is length bytes long
+// and is not null-terminated.  Returns SPV_SUCCESS to continue disassembling,
+// and any other value to stop.
+typedef spv_result_t (*spv_text_write_fn_t)(void* user_data, const char* text,
+                                            size_t length);
+
+// Decodes the given SPIR-V binary representation to its assembly text, like
+// spvBinaryToText, but passes the text to write_text as it is produced
+// instead of accumulating all of it in memory.  The user_data argument is
+// passed to write_text.  If the SPV_BINARY_TO_TEXT_OPTION_PRINT option is
+// given, the text is printed instead, and write_text is not called.
+SPIRV_TOOLS_EXPORT spv_result_t spvBinaryToTextStream(
+    const spv_const_context context, const uint32_t* binary,
+    const size_t word_count, const uint32_t options, void* user_data,
+    spv_text_write_fn_t write_text, spv_diagnostic* diagnostic);
+
 // Frees a binary stream from memory. This is a no-op if binary is a null
 // pointer.
 SPIRV_TOOLS_EXPORT void spvBinaryDestroy(spv_binary binary);
@@ -745,6 +939,25 @@ SPIRV_TOOLS_EXPORT spv_result_t spvValidateWithOptions(
     const spv_const_context context, const spv_const_validator_options options,
     const spv_const_binary binary, spv_diagnostic* diagnostic);
 
+// Validates the |count| SPIR-V binaries of |binaries|, each as
+// spvValidateWithOptions would, sharing the context and the options.  The
+// binaries are spread over at most |num_threads| threads, or one per hardware
+// thread if num_threads is 0.  When several binaries are validated at once,
+// the functions of each binary are checked on a single thread.
+//
+// The result for binaries[i] is written to results[i].  If |diagnostics| is
+// not null, the errors for binaries[i] are written into diagnostics[i], which
+// is set to null if there are none.  Otherwise the context's message consumer
+// is used, and must then be thread safe, as must the validation cache of the
+// options, if any.
+//
+// Returns SPV_SUCCESS if all the binaries are valid, or else the result of the
+// first binary which is not.
+SPIRV_TOOLS_EXPORT spv_result_t spvValidateBatchWithOptions(
+    const spv_const_context context, const spv_const_validator_options options,
+    const spv_const_binary_t* binaries, size_t count, uint32_t num_threads,
+    spv_result_t* results, spv_diagnostic* diagnostics);
+
 // Validates a raw SPIR-V binary for correctness. Any errors will be written
 // into *diagnostic if diagnostic is non-null, otherwise the context's message
 // consumer will be used.
@@ -752,6 +965,33 @@ SPIRV_TOOLS_EXPORT spv_result_t
 spvValidateBinary(const spv_const_context context, const uint32_t* words,
                   const size_t num_words, spv_diagnostic* diagnostic);
 
+// Creates an incremental validator for the given context and options, or for
+// the default options if options is null.  The context and options are
+// copied.  Returns a null pointer if context is null.
+//
+// An incremental validator is meant to validate a module again after each of
+// a series of changes, such as optimization passes.  It keeps the state of
+// the last module it found valid, and does not repeat the checks of the
+// instructions of a function that did not change since, when the global
+// section of the module did not change either.  A function is only
+// considered unchanged if the functions it calls and the functions calling it
+// are unchanged too.  All the checks that span the whole module are repeated.
+SPIRV_TOOLS_EXPORT spv_incremental_validator spvIncrementalValidatorCreate(
+    const spv_const_context context, const spv_const_validator_options options);
+
+// Destroys the given incremental validator.  This is a no-op if validator is
+// a null pointer.
+SPIRV_TOOLS_EXPORT void spvIncrementalValidatorDestroy(
+    spv_incremental_validator validator);
+
+// Validates a raw SPIR-V binary exactly as spvValidateWithOptions would, with
+// the context and options of the given incremental validator.  If the binary
+// is valid, the validator keeps its state for the next validation.  An
+// incremental validator must not be used by more than one thread at a time.
+SPIRV_TOOLS_EXPORT spv_result_t spvIncrementalValidatorValidate(
+    spv_incremental_validator validator, const uint32_t* words,
+    const size_t num_words, spv_diagnostic* diagnostic);
+
 // Creates a diagnostic object. The position parameter specifies the location in
 // the text/binary stream. The message parameter, copied into the diagnostic
 // object, contains the error message to display.
@@ -803,6 +1043,243 @@ SPIRV_TOOLS_EXPORT spv_result_t spvBinaryParse(
     const size_t num_words, spv_parsed_header_fn_t parse_header,
     spv_parsed_instruction_fn_t parse_instruction, spv_diagnostic* diagnostic);
 
+// Creates a binary parser for the given context.  The parser keeps the
+// storage it uses to parse a module, so that parsing further modules of
+// similar size with it does not allocate memory.  Returns a null pointer if
+// context is null.
+SPIRV_TOOLS_EXPORT spv_binary_parser
+spvBinaryParserCreate(const spv_const_context context);
+
+// Destroys the given binary parser, releasing its storage.
+SPIRV_TOOLS_EXPORT void spvBinaryParserDestroy(spv_binary_parser parser);
+
+// Parses a SPIR-V binary exactly as spvBinaryParse would, using the context
+// the parser was created with, but reusing the storage of the parser.  A
+// parser must not be used by more than one thread at a time.
+SPIRV_TOOLS_EXPORT spv_result_t spvBinaryParserParse(
+    spv_binary_parser parser, void* user_data, const uint32_t* words,
+    const size_t num_words, spv_parsed_header_fn_t parse_header,
+    spv_parsed_instruction_fn_t parse_instruction, spv_diagnostic* diagnostic);
+
+// Like spvBinaryParse, but decodes the functions of the module on up to
+// num_threads threads, or on one thread per hardware thread if num_threads is
+// 0.  The callbacks are issued exactly as by spvBinaryParse: on the calling
+// thread, and in module order.  Callbacks are only issued once the whole
+// module has been decoded, so the decoded instructions are held in memory
+// until then.  Modules that cannot be split into independently decodable
+// functions, including all invalid modules, are parsed sequentially.
+SPIRV_TOOLS_EXPORT spv_result_t spvBinaryParseParallel(
+    const spv_const_context context, void* user_data, const uint32_t* words,
+    const size_t num_words, spv_parsed_header_fn_t parse_header,
+    spv_parsed_instruction_fn_t parse_instruction, uint32_t num_threads,
+    spv_diagnostic* diagnostic);
+
+// A pointer to a function that accepts a batch of parsed instructions, in
+// module order.  The instructions are transient in the same way as for
+// spv_parsed_instruction_fn_t.  The operands of all the instructions in a
+// batch are held in a single array, in the same order as the instructions.
+// The function should return SPV_SUCCESS if and only if parsing should
+// continue.
+typedef spv_result_t (*spv_parsed_instruction_batch_fn_t)(
+    void* user_data, const spv_parsed_instruction_t* parsed_instructions,
+    size_t num_instructions);
+
+// Like spvBinaryParse, but issues the parsed instructions to the callback in
+// batches of up to batch_size instructions, or of a default size if
+// batch_size is 0, rather than one at a time.  This lets the callback process
+// many instructions in a tight loop.  If an instruction is invalid, the
+// instructions before it that were not issued yet are issued as a last batch
+// after the diagnostic is emitted.
+SPIRV_TOOLS_EXPORT spv_result_t spvBinaryParseBatched(
+    const spv_const_context context, void* user_data, const uint32_t* words,
+    const size_t num_words, spv_parsed_header_fn_t parse_header,
+    spv_parsed_instruction_batch_fn_t parse_instructions, size_t batch_size,
+    spv_diagnostic* diagnostic);
+
+// A lightweight view of an instruction in a SPIR-V binary, as produced by
+// spvBinaryParseView.  Only the opcode, word count, and the type and result
+// Ids are decoded.  Operands can be decoded on demand with
+// spvInstructionViewDecode.
+typedef struct spv_instruction_view_t {
+  // The words of this instruction.  This points directly into the binary
+  // being parsed, so the words are in the endianness of that binary, as
+  // given by the endian member.
+  const uint32_t* words;
+  // The number of words in this instruction.
+  uint16_t num_words;
+  uint16_t opcode;
+  // The endianness of the words array.
+  spv_endianness_t endian;
+  // The extended instruction type, if opcode is OpExtInst.  Otherwise
+  // this is the "none" value.
+  spv_ext_inst_type_t ext_inst_type;
+  // The type id, or 0 if this instruction doesn't have one.
+  uint32_t type_id;
+  // The result id, or 0 if this instruction doesn't have one.
+  uint32_t result_id;
+  // The position of the first word of this instruction, in words from the
+  // start of the binary.
+  size_t offset;
+  // Internal parser state used by spvInstructionViewDecode.  Do not modify.
+  void* parser;
+} spv_instruction_view_t;
+
+// A pointer to a function that accepts an instruction view.
+// The view is transient: it and the parser state it refers to may be
+// released immediately after the function has returned.  The function
+// should return SPV_SUCCESS if and only if parsing should continue.
+typedef spv_result_t (*spv_instruction_view_fn_t)(
+    void* user_data, const spv_instruction_view_t* instruction_view);
+
+// Like spvBinaryParse, but hands each instruction to the callback as a view
+// over the binary rather than as a fully decoded instruction.  The parser does
+// not allocate or copy per-instruction operand storage.  As a consequence,
+// only the structure of the module is checked: the header, the word count of
+// each instruction, the opcodes, and the type and result Ids.  Malformed
+// operands are only diagnosed if they are decoded with
+// spvInstructionViewDecode.
+SPIRV_TOOLS_EXPORT spv_result_t spvBinaryParseView(
+    const spv_const_context context, void* user_data, const uint32_t* words,
+    const size_t num_words, spv_parsed_header_fn_t parse_header,
+    spv_instruction_view_fn_t parse_instruction, spv_diagnostic* diagnostic);
+
+// Decodes the operands of the instruction described by instruction_view,
+// writing the result into *parsed_instruction exactly as spvBinaryParse would
+// have presented it.  This may only be called from within the callback that
+// received instruction_view.  The storage referenced by *parsed_instruction
+// is valid until the next call to this function, or until the callback
+// returns.  Returns SPV_SUCCESS on success.  Otherwise returns an error code
+// and emits a diagnostic as spvBinaryParseView would.
+SPIRV_TOOLS_EXPORT spv_result_t
+spvInstructionViewDecode(const spv_instruction_view_t* instruction_view,
+                         spv_parsed_instruction_t* parsed_instruction);
+
+// Encodes a SPIR-V binary, specified as counted sequence of 32-bit words in
+// host endianness, into a compact byte encoding for storage and transfer.
+// Operands are written as varints, ids relative to the latest result id, and
+// the word counts and the kinds of the operands are predicted from the
+// grammar, so that most words take one or two bytes.  The instructions are
+// not otherwise checked, and any sequence of words with a valid header and
+// word counts is encoded.  The encoding does not depend on the target
+// environment of the context.  On success, returns SPV_SUCCESS and writes
+// the encoded binary to *encoded, which must be destroyed with
+// spvEncodedBinaryDestroy.  Otherwise returns an error code and, if
+// diagnostic is non-null, emits a diagnostic.
+SPIRV_TOOLS_EXPORT spv_result_t spvBinaryEncode(
+    const spv_const_context context, const uint32_t* words,
+    const size_t num_words, spv_encoded_binary* encoded,
+    spv_diagnostic* diagnostic);
+
+// Decodes a binary encoded by spvBinaryEncode back into exactly the words it
+// was encoded from.  On success, returns SPV_SUCCESS and writes the binary
+// to *binary, which must be destroyed with spvBinaryDestroy.  Otherwise,
+// including when the bytes are truncated or corrupt, returns an error code
+// and, if diagnostic is non-null, emits a diagnostic.
+SPIRV_TOOLS_EXPORT spv_result_t spvBinaryDecode(
+    const spv_const_context context, const uint8_t* bytes,
+    const size_t num_bytes, spv_binary* binary, spv_diagnostic* diagnostic);
+
+// Frees an encoded binary.
+SPIRV_TOOLS_EXPORT void spvEncodedBinaryDestroy(spv_encoded_binary encoded);
+
+// Builds an index of a SPIR-V binary, specified as counted sequence of 32-bit
+// words in host endianness, from a single scan of its word counts.  The index
+// locates any instruction by its position in the module, the global section,
+// and the functions and their blocks, so that a part of a large binary can be
+// inspected without parsing all of it.  Only the structure of the module is
+// checked: the header, the word counts, and the nesting of the functions and
+// the blocks.  On success, returns SPV_SUCCESS and writes the index to
+// *index, which must be destroyed with spvBinaryIndexDestroy.  Otherwise
+// returns an error code and, if diagnostic is non-null, emits a diagnostic.
+SPIRV_TOOLS_EXPORT spv_result_t spvBinaryIndexBuild(
+    const spv_const_context context, const uint32_t* words,
+    const size_t num_words, spv_binary_index* index,
+    spv_diagnostic* diagnostic);
+
+// Writes the given index as words to *index_words, so that it can be stored
+// next to the binary it indexes and loaded again by spvBinaryIndexLoad.
+// *index_words must be destroyed with spvBinaryDestroy.
+SPIRV_TOOLS_EXPORT spv_result_t spvBinaryIndexSave(
+    spv_const_binary_index index, spv_binary* index_words);
+
+// Loads an index written by spvBinaryIndexSave for the binary of num_words
+// words at words.  Only the header and the global section of the binary are
+// read, to check that the index was built for it.  On success, returns
+// SPV_SUCCESS and writes the index to *index, which must be destroyed with
+// spvBinaryIndexDestroy.  Otherwise, including when the index is corrupt or
+// was built for another binary, returns an error code and, if diagnostic is
+// non-null, emits a diagnostic.
+SPIRV_TOOLS_EXPORT spv_result_t spvBinaryIndexLoad(
+    const spv_const_context context, const uint32_t* index_words,
+    const size_t num_index_words, const uint32_t* words,
+    const size_t num_words, spv_binary_index* index,
+    spv_diagnostic* diagnostic);
+
+// Frees an index.  This is a no-op if index is a null pointer.
+SPIRV_TOOLS_EXPORT void spvBinaryIndexDestroy(spv_binary_index index);
+
+// Returns the number of instructions of the binary of the index.
+SPIRV_TOOLS_EXPORT size_t
+spvBinaryIndexInstructionCount(spv_const_binary_index index);
+
+// Writes to *offset the offset in words of the instruction at the given
+// position in the module, where 0 is the first instruction after the header.
+// The word counts of at most a few dozen instructions are read from the
+// binary at words, which must be the binary of the index.  Returns
+// SPV_ERROR_INVALID_LOOKUP if there is no such instruction.
+SPIRV_TOOLS_EXPORT spv_result_t spvBinaryIndexFindInstruction(
+    spv_const_binary_index index, const uint32_t* words,
+    const size_t instruction, size_t* offset);
+
+// Writes to *range the range of the global section: the instructions after
+// the header and before the first function.
+SPIRV_TOOLS_EXPORT spv_result_t spvBinaryIndexGetGlobalSection(
+    spv_const_binary_index index, spv_binary_range_t* range);
+
+// Returns the number of functions of the binary of the index.
+SPIRV_TOOLS_EXPORT size_t
+spvBinaryIndexFunctionCount(spv_const_binary_index index);
+
+// Writes to *range the range of the given function, from its OpFunction to
+// its OpFunctionEnd.  Returns SPV_ERROR_INVALID_LOOKUP if there is no such
+// function.
+SPIRV_TOOLS_EXPORT spv_result_t spvBinaryIndexGetFunction(
+    spv_const_binary_index index, const size_t function,
+    spv_binary_range_t* range);
+
+// Returns the number of blocks of the given function, or 0 if there is no
+// such function.
+SPIRV_TOOLS_EXPORT size_t spvBinaryIndexBlockCount(
+    spv_const_binary_index index, const size_t function);
+
+// Writes to *range the range of the given block of the given function, from
+// its OpLabel to the next OpLabel or the OpFunctionEnd.  Returns
+// SPV_ERROR_INVALID_LOOKUP if there is no such block.
+SPIRV_TOOLS_EXPORT spv_result_t spvBinaryIndexGetBlock(
+    spv_const_binary_index index, const size_t function, const size_t block,
+    spv_binary_range_t* range);
+
+// Like spvBinaryParse, but only issues the instructions between the offsets
+// begin and end of the binary, which must be the binary of the index, and
+// must be in host endianness.  The offsets must be those of instructions, or
+// the end of the binary.  So that the instructions are decoded as in the
+// whole module, the global section is also parsed, and so is the function
+// containing begin, from its start.  Other functions are not read.
+SPIRV_TOOLS_EXPORT spv_result_t spvBinaryParseRange(
+    const spv_const_context context, void* user_data, const uint32_t* words,
+    const size_t num_words, spv_const_binary_index index, const size_t begin,
+    const size_t end, spv_parsed_header_fn_t parse_header,
+    spv_parsed_instruction_fn_t parse_instruction, spv_diagnostic* diagnostic);
+
+// Like spvBinaryToText, but only decodes the instructions between the offsets
+// begin and end, as spvBinaryParseRange parses them.  The header is never
+// printed.  Friendly names are taken from the global section.
+SPIRV_TOOLS_EXPORT spv_result_t spvBinaryToTextRange(
+    const spv_const_context context, const uint32_t* words,
+    const size_t num_words, spv_const_binary_index index, const size_t begin,
+    const size_t end, const uint32_t options, spv_text* text,
+    spv_diagnostic* diagnostic);
+
 #ifdef __cplusplus
 }
 #endif
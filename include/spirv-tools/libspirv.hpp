@@ -17,6 +17,7 @@
 
 #include <functional>
 #include <memory>
+#include <ostream>
 #include <string>
 #include <vector>
 
@@ -67,6 +68,38 @@ class Context {
   spv_context context_;
 };
 
+// A store of the modules known to be valid, for ValidatorOptions::SetCache.
+// Each module is identified by a key, which is a string of hexadecimal digits.
+// Its methods may be called concurrently by different validations.
+class ValidationCache {
+ public:
+  virtual ~ValidationCache() {}
+
+  // Returns true if the module identified by |key| was stored as valid.
+  virtual bool Contains(const std::string& key) = 0;
+
+  // Stores the module identified by |key| as valid.
+  virtual void Insert(const std::string& key) = 0;
+};
+
+// A validation cache that keeps an empty file, named after its key, for each
+// module in the existing directory |path|.  The directory may be shared by
+// processes and persist across runs.  Failures to write to it are ignored,
+// so at worst modules are validated again.
+class DirectoryValidationCache : public ValidationCache {
+ public:
+  explicit DirectoryValidationCache(const std::string& path);
+
+  bool Contains(const std::string& key) override;
+  void Insert(const std::string& key) override;
+
+ private:
+  // Returns the path of the file for |key|.
+  std::string FilePath(const std::string& key) const;
+
+  const std::string path_;
+};
+
 // A RAII wrapper around a validator options object.
 class ValidatorOptions {
  public:
@@ -109,6 +142,13 @@ class ValidatorOptions {
     spvValidatorOptionsSetSkipBlockLayout(options_, val);
   }
 
+  // Only checks that the module is structurally sound: well-formed ids,
+  // types and control flow.  See spvValidatorOptionsSetStructuralOnly for
+  // the guarantees that this gives.
+  void SetStructuralOnly(bool val) {
+    spvValidatorOptionsSetStructuralOnly(options_, val);
+  }
+
   // Records whether or not the validator should relax the rules on pointer
   // usage in logical addressing mode.
   //
@@ -134,6 +174,46 @@ class ValidatorOptions {
     spvValidatorOptionsSetBeforeHlslLegalization(options_, val);
   }
 
+  // Sets the number of threads used to check the instructions of different
+  // functions concurrently.  0 means one thread per hardware thread.
+  void SetNumThreads(uint32_t num_threads) {
+    spvValidatorOptionsSetNumThreads(options_, num_threads);
+  }
+
+  // Sets the cache of the modules known to be valid.  Validating a module
+  // found in |cache| returns success without checking it again.  |cache|
+  // must outlive the options, and null removes the cache.
+  void SetCache(ValidationCache* cache) {
+    if (!cache) {
+      spvValidatorOptionsSetCache(options_, nullptr, nullptr, nullptr);
+      return;
+    }
+    spvValidatorOptionsSetCache(
+        options_,
+        [](void* user_data, const char* key) {
+          return static_cast<ValidationCache*>(user_data)->Contains(key);
+        },
+        [](void* user_data, const char* key) {
+          static_cast<ValidationCache*>(user_data)->Insert(key);
+        },
+        cache);
+  }
+
+  // Writes the time spent in each phase and check of the validations to
+  // |out|, which must outlive the options.  Null turns the reports off.
+  void SetTimeReport(std::ostream* out) {
+    if (!out) {
+      spvValidatorOptionsSetTimeReport(options_, nullptr, nullptr);
+      return;
+    }
+    spvValidatorOptionsSetTimeReport(
+        options_,
+        [](void* user_data, const char* report) {
+          *static_cast<std::ostream*>(user_data) << report;
+        },
+        out);
+  }
+
  private:
   spv_validator_options options_;
 };
@@ -176,6 +256,18 @@ class OptimizerOptions {
                                                 preserve_spec_constants);
   }
 
+  // Records the number of threads the optimizer may use.  See
+  // spvOptimizerOptionsSetNumThreads.
+  void set_num_threads(uint32_t num_threads) {
+    spvOptimizerOptionsSetNumThreads(options_, num_threads);
+  }
+
+  // Records the time in microseconds the passes may take.  See
+  // spvOptimizerOptionsSetTimeBudget.
+  void set_time_budget(uint32_t microseconds) {
+    spvOptimizerOptionsSetTimeBudget(options_, microseconds);
+  }
+
  private:
   spv_optimizer_options options_;
 };
@@ -202,6 +294,21 @@ class ReducerOptions {
                                               fail_on_validation_error);
   }
 
+  // See spvReducerOptionsSetNumThreads.
+  void set_num_threads(uint32_t num_threads) {
+    spvReducerOptionsSetNumThreads(options_, num_threads);
+  }
+
+  // See spvReducerOptionsSetAdaptiveScheduling.
+  void set_adaptive_scheduling(bool adaptive_scheduling) {
+    spvReducerOptionsSetAdaptiveScheduling(options_, adaptive_scheduling);
+  }
+
+  // See spvReducerOptionsSetFunctionByFunction.
+  void set_function_by_function(bool function_by_function) {
+    spvReducerOptionsSetFunctionByFunction(options_, function_by_function);
+  }
+
  private:
   spv_reducer_options options_;
 };
@@ -232,6 +339,11 @@ class FuzzerOptions {
     spvFuzzerOptionsSetShrinkerStepLimit(options_, shrinker_step_limit);
   }
 
+  // See spvFuzzerOptionsSetShrinkerNumThreads.
+  void set_shrinker_num_threads(uint32_t shrinker_num_threads) {
+    spvFuzzerOptionsSetShrinkerNumThreads(options_, shrinker_num_threads);
+  }
+
   // See spvFuzzerOptionsEnableFuzzerPassValidation.
   void enable_fuzzer_pass_validation() {
     spvFuzzerOptionsEnableFuzzerPassValidation(options_);
@@ -304,6 +416,18 @@ class SpirvTools {
                    std::string* text,
                    uint32_t options = kDefaultDisassembleOption) const;
 
+  // Encodes the given SPIR-V |binary| with spvBinaryEncode and writes the
+  // bytes to |encoded|. Returns true on success. |encoded| will be kept
+  // untouched if encoding is unsuccessful.
+  bool Encode(const std::vector<uint32_t>& binary,
+              std::vector<uint8_t>* encoded) const;
+
+  // Decodes the bytes |encoded| by spvBinaryEncode and writes the SPIR-V
+  // binary to |binary|. Returns true on success. |binary| will be kept
+  // untouched if decoding is unsuccessful.
+  bool Decode(const std::vector<uint8_t>& encoded,
+              std::vector<uint32_t>* binary) const;
+
   // Validates the given SPIR-V |binary|. Returns true if no issues are found.
   // Otherwise, returns false and communicates issues via the message consumer
   // registered.
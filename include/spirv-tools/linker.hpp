@@ -24,12 +24,17 @@
 
 namespace spvtools {
 
+class LinkCache;
+
 class LinkerOptions {
  public:
   LinkerOptions()
       : create_library_(false),
         verify_ids_(false),
-        allow_partial_linkage_(false) {}
+        allow_partial_linkage_(false),
+        remove_unused_functions_(false),
+        num_threads_(1),
+        cache_(nullptr) {}
 
   // Returns whether a library or an executable should be produced by the
   // linking phase.
@@ -63,10 +68,41 @@ class LinkerOptions {
     allow_partial_linkage_ = allow_partial_linkage;
   }
 
+  // Returns whether to remove the functions which cannot be called from the
+  // entry points, or from the exported functions when creating a library.
+  bool GetRemoveUnusedFunctions() const { return remove_unused_functions_; }
+
+  // Sets whether to remove the functions which cannot be called from the
+  // entry points, or from the exported functions when creating a library.
+  void SetRemoveUnusedFunctions(bool remove_unused_functions) {
+    remove_unused_functions_ = remove_unused_functions;
+  }
+
+  // Returns the number of threads used to load the input modules.
+  uint32_t GetNumThreads() const { return num_threads_; }
+
+  // Sets the number of threads used to load the input modules concurrently.
+  // 0 means one thread per hardware thread.  The default is 1.  The messages
+  // of each module are passed to the message consumer of the context from the
+  // calling thread, in the order of the modules, so the result and the
+  // messages are the same for any number of threads.
+  void SetNumThreads(uint32_t num_threads) { num_threads_ = num_threads; }
+
+  // Returns the cache of the loaded modules, or nullptr if there is none.
+  LinkCache* GetCache() const { return cache_; }
+
+  // Sets the cache in which the loaded modules are kept between the calls to
+  // Link.  The cache is not owned by the options, and nullptr, the default,
+  // loads every module on each call.
+  void SetCache(LinkCache* cache) { cache_ = cache; }
+
  private:
   bool create_library_;
   bool verify_ids_;
   bool allow_partial_linkage_;
+  bool remove_unused_functions_;
+  uint32_t num_threads_;
+  LinkCache* cache_;
 };
 
 // Links one or more SPIR-V modules into a new SPIR-V module. That is, combine
@@ -92,6 +128,38 @@ spv_result_t Link(const Context& context, const uint32_t* const* binaries,
                   std::vector<uint32_t>* linked_binary,
                   const LinkerOptions& options = LinkerOptions());
 
+// Keeps the modules loaded by Link between calls, so that relinking the same
+// binaries after changing some of them only loads the changed ones.  The
+// modules are found by the contents of their binary and their target
+// environment.  Each call to Link using the cache forgets the modules which
+// were not among its inputs.
+//
+// A cache must not be used by more than one call to Link at a time.
+class LinkCache {
+ public:
+  LinkCache();
+  ~LinkCache();
+
+  LinkCache(const LinkCache&) = delete;
+  LinkCache& operator=(const LinkCache&) = delete;
+
+  // Returns the number of modules in the cache.
+  size_t size() const;
+
+  // Forgets every module in the cache.
+  void Clear();
+
+ private:
+  friend spv_result_t Link(const Context& context,
+                           const uint32_t* const* binaries,
+                           const size_t* binary_sizes, size_t num_binaries,
+                           std::vector<uint32_t>* linked_binary,
+                           const LinkerOptions& options);
+
+  struct Impl;  // Opaque struct for holding internal data.
+  std::unique_ptr<Impl> impl_;
+};
+
 }  // namespace spvtools
 
 #endif  // INCLUDE_SPIRV_TOOLS_LINKER_HPP_
@@ -29,6 +29,43 @@ namespace opt {
 class Pass;
 }
 
+// A store of the results of optimizations, for Optimizer::SetCache.  Each
+// result is identified by a key, which is a string of hexadecimal digits.
+// Its methods may be called concurrently by different optimizers.
+class OptimizationCache {
+ public:
+  virtual ~OptimizationCache() {}
+
+  // Returns true and sets |*binary| to the optimized module stored for |key|,
+  // if there is one.
+  virtual bool Lookup(const std::string& key,
+                      std::vector<uint32_t>* binary) = 0;
+
+  // Stores |binary| as the optimized module for |key|.
+  virtual void Insert(const std::string& key,
+                      const std::vector<uint32_t>& binary) = 0;
+};
+
+// An optimization cache that keeps a file, named after its key, for each
+// optimized module in the existing directory |path|.  The directory may be
+// shared by processes and persist across runs.  Failures to write to it are
+// ignored, and incomplete files are not found, so at worst modules are
+// optimized again.
+class DirectoryOptimizationCache : public OptimizationCache {
+ public:
+  explicit DirectoryOptimizationCache(const std::string& path);
+
+  bool Lookup(const std::string& key, std::vector<uint32_t>* binary) override;
+  void Insert(const std::string& key,
+              const std::vector<uint32_t>& binary) override;
+
+ private:
+  // Returns the path of the file for |key|.
+  std::string FilePath(const std::string& key) const;
+
+  const std::string path_;
+};
+
 // C++ interface for SPIR-V optimization functionalities. It wraps the context
 // (including target environment and the corresponding SPIR-V grammar) and
 // provides methods for registering optimization passes and optimizing.
@@ -62,6 +99,49 @@ class Optimizer {
     std::unique_ptr<Impl> impl_;  // Unique pointer to internal data.
   };
 
+  // The work done by the runs of an optimizer.
+  struct Statistics {
+    // The work done to build one analysis of the modules.
+    struct Analysis {
+      const char* name;  // The name of the analysis, such as "def-use".
+      // The number of times the analysis was built.  The dominator and loop
+      // analyses count each tree they build for a function.
+      uint64_t builds;
+      // The time spent building the analysis, including any analysis it
+      // needed to build first.
+      uint64_t nanoseconds;
+    };
+
+    // The analyses, in a fixed order.
+    std::vector<Analysis> analyses;
+  };
+
+  // A module in the internal representation of the optimizer, built by
+  // BuildIR.  Several optimizers can run one after another on the same
+  // handle, so that the module is parsed and serialized only once.  Handles
+  // can only be moved.
+  class IRHandle {
+   public:
+    IRHandle();
+    IRHandle(const IRHandle&) = delete;
+    IRHandle(IRHandle&&);
+    IRHandle& operator=(const IRHandle&) = delete;
+    IRHandle& operator=(IRHandle&&);
+    ~IRHandle();
+
+    // Returns true if the handle holds a module.
+    bool HasModule() const;
+
+    // Writes the binary of the module into |binary|, replacing its contents.
+    // The handle must hold a module.
+    void ToBinary(std::vector<uint32_t>* binary) const;
+
+   private:
+    friend class Optimizer;
+    struct Impl;                  // Opaque struct for holding internal data.
+    std::unique_ptr<Impl> impl_;  // Unique pointer to internal data.
+  };
+
   // Constructs an instance with the given target |env|, which is used to decode
   // the binaries to be optimized later.
   //
@@ -211,6 +291,126 @@ class Optimizer {
            std::vector<uint32_t>* optimized_binary,
            const spv_optimizer_options opt_options) const;
 
+  // Validates |original_binary| if |opt_options| say so, as Run does, then
+  // parses it into |ir|.  Returns false if it fails to validate or to parse,
+  // in which case |ir| holds no module.  The module keeps the target
+  // environment of this optimizer.
+  bool BuildIR(const uint32_t* original_binary, size_t original_binary_size,
+               IRHandle* ir, const spv_optimizer_options opt_options) const;
+
+  // Runs the registered passes on the module of |ir|, which may have been
+  // built by another optimizer.  The module is not validated first, and the
+  // cache is not used.  Returns true on success, whether or not the module is
+  // modified.  Returns false if errors occur in any of the passes, in which
+  // case no further passes are executed and the module may be invalid.
+  bool Run(IRHandle* ir, const spv_optimizer_options opt_options) const;
+
+  // Optimizes the module of |ir| once for each set of specialization constant
+  // values in |specializations|, and writes the binaries into
+  // |optimized_binaries|, in the same order.  Each set maps spec ids to
+  // values, as for CreateSetSpecConstantDefaultValuePass.
+  //
+  // The module of |ir| is left unchanged, so the passes which do not depend
+  // on the values, such as the legalization passes or a first -O, should run
+  // on it once beforehand, with Run.  Each specialization starts from a copy
+  // of it, sharing the saved instructions of its functions, on which the
+  // values are set and frozen and the operations on specialization constants
+  // folded.  Then the passes registered on this optimizer run on it.
+  //
+  // A pass can only run once, so every pass must have been registered from a
+  // flag: each specialization gets a new optimizer, with the passes
+  // registered from the same flags and the same message consumer.  If
+  // |opt_options| allow several threads, the specializations are optimized
+  // concurrently, the message consumer must then be thread safe, their work
+  // is not added to GetStatistics, and no profile trace is written.
+  // Otherwise the specializations are optimized one after another.
+  //
+  // Returns false if errors occur while optimizing any of them, in which case
+  // its binary is left empty.
+  bool RunSpecializations(
+      const IRHandle& ir,
+      const std::vector<std::unordered_map<uint32_t, std::string>>&
+          specializations,
+      std::vector<std::vector<uint32_t>>* optimized_binaries,
+      const spv_optimizer_options opt_options) const;
+
+  // Optimizes each entry point of the module of |ir| on its own, and writes
+  // the names of the entry points into |names| and the binaries into
+  // |optimized_binaries|, in the order of the OpEntryPoint instructions.
+  //
+  // The module of |ir| is left unchanged.  Each entry point starts from a
+  // copy of it, sharing the saved instructions of its functions, from which
+  // the other entry points and their execution modes are removed, and then
+  // the functions they no longer reach, as eliminate-dead-functions does.
+  // Then the passes registered on this optimizer run on it.  The globals only
+  // the other entry points use are left for those passes to remove.
+  //
+  // Every pass must have been registered from a flag, and each entry point
+  // gets a new optimizer, as in RunSpecializations.  If |opt_options| allow
+  // several threads, the entry points are optimized concurrently, and the
+  // message consumer must then be thread safe.  Otherwise the entry points
+  // are optimized one after another.
+  //
+  // Returns false if errors occur while optimizing any of them, in which case
+  // its binary is left empty.
+  bool RunEntryPoints(const IRHandle& ir, std::vector<std::string>* names,
+                      std::vector<std::vector<uint32_t>>* optimized_binaries,
+                      const spv_optimizer_options opt_options) const;
+
+  // Optimizes the module of |original_binary_size| words at |original_binary|
+  // one function at a time, and writes the result into |optimized_binary|.
+  // Only the global section and one function definition are held as IR at any
+  // time, so this needs less memory than Run for a module with many
+  // functions.
+  //
+  // The global section is built once, with the functions only declared.  Each
+  // function definition is then parsed in place of its declaration, the
+  // passes run on it alone, and it is serialized and released.  The
+  // serialized functions are written after the global section, which the
+  // passes may have added to.
+  //
+  // Every pass must have been registered from a flag and be function local:
+  // it processes each function on its own and changes nothing else but the
+  // global values it uses, as ssa-rewrite, ccp, simplify-instructions or
+  // redundancy-elimination.  The passes are registered again from the flags
+  // for each function.  The optimization cache and the validation after each
+  // pass are not used.
+  //
+  // Returns false if a pass is not function local, if the module fails to
+  // validate or to optimize, or if it cannot be streamed because it has
+  // decoration groups.
+  bool RunStreaming(const uint32_t* original_binary,
+                    size_t original_binary_size,
+                    std::vector<uint32_t>* optimized_binary,
+                    const spv_optimizer_options opt_options) const;
+
+  // Optimizes each binary of |original_binaries| as Run would, and writes the
+  // optimized binaries into |optimized_binaries|, in the same order.
+  //
+  // A pass can only run once, so every pass must have been registered from a
+  // flag: each binary gets a new optimizer, with the passes registered from
+  // the same flags and the same cache.  If |opt_options| allow several
+  // threads, the binaries are optimized concurrently, each one validated and
+  // optimized on a single thread, their work is not added to GetStatistics,
+  // and no profile trace is written.  Otherwise the binaries are optimized
+  // one after another.
+  //
+  // If |messages| is not null, the messages reported while optimizing each
+  // binary are written into the string of the same index, one per line,
+  // instead of being sent to the message consumer.  Otherwise the message
+  // consumer must be thread safe if the binaries are optimized concurrently.
+  //
+  // Returns false if any binary fails to validate or to optimize, in which
+  // case its optimized binary is left empty.
+  bool RunBatch(const std::vector<std::vector<uint32_t>>& original_binaries,
+                std::vector<std::vector<uint32_t>>* optimized_binaries,
+                std::vector<std::string>* messages,
+                const spv_optimizer_options opt_options) const;
+
+  // Returns the work done by all the runs of this optimizer so far.  Modules
+  // found in the cache add no work.
+  Statistics GetStatistics() const;
+
   // Returns a vector of strings with all the pass names added to this
   // optimizer's pass manager. These strings are valid until the associated
   // pass manager is destroyed.
@@ -229,6 +429,35 @@ class Optimizer {
   // Sets the option to validate the module after each pass.
   Optimizer& SetValidateAfterAll(bool validate);
 
+  // Sets the stream to write a profile of each run to, as a Chrome trace in
+  // JSON.  It nests the passes, the functions they process and the analyses
+  // they build, with the time and memory each takes, so that the analyses
+  // rebuilt by each pass can be seen.  If |out| is null, then nothing is
+  // recorded.  BuildIR and each Run write one trace.
+  Optimizer& SetProfileTrace(std::ostream* out);
+
+  // Sets the cache of the optimized modules.  Run looks up each module in
+  // |cache| before parsing it, and stores the result of each successful
+  // optimization.  The key is a SHA-256 hash of the binary, of the target
+  // environment, of the flags the passes were registered from, arguments
+  // included, of the options that affect the result and of the version of the
+  // optimizer.  A pass created through the API may take arguments that the key
+  // cannot see, so the cache is not used if any pass was not registered from
+  // a flag.  Messages, SetPrintAll and SetTimeReport output are not repeated
+  // for a module found in the cache.  |cache| must outlive the optimizer, and
+  // null removes the cache.
+  Optimizer& SetCache(OptimizationCache* cache);
+
+  // Sets the execution counts of the blocks of the modules to optimize, by
+  // the id of their OpLabel, as measured by a profiler.  Passes which trade
+  // code size or speculation for speed use them to leave the code the
+  // profile shows to be cold alone: if-conversion keeps biased branches, and
+  // loop unswitching and peeling skip cold loops.  Blocks missing from
+  // |counts| are treated as if there were no profile, and empty |counts|
+  // removes the profile.
+  Optimizer& SetBlockCounts(
+      const std::unordered_map<uint32_t, uint64_t>& counts);
+
  private:
   struct Impl;                  // Opaque struct for holding internal data.
   std::unique_ptr<Impl> impl_;  // Unique pointer to internal data.
@@ -355,6 +584,14 @@ Optimizer::PassToken CreateEliminateDeadConstantPass();
 // A strength-reduction pass will look for opportunities to replace an
 // instruction with an equivalent and less expensive one.  For example,
 // multiplying by a power of 2 can be replaced by a bit shift.
+//
+// The 32-bit integer divisions and modulos by constants are replaced by
+// shifts and masks for powers of 2, and by multiplications by magic numbers
+// otherwise.  The float divisions by constants are replaced by
+// multiplications by their reciprocals, if the reciprocals are exact or if
+// the shader or the FPFastMathMode decorations allow rounding them.  The
+// multiplications of an induction variable by a constant in a loop are
+// replaced by new induction variables incremented by additions.
 Optimizer::PassToken CreateStrengthReductionPass();
 
 // Creates a block merge pass.
@@ -393,6 +630,17 @@ Optimizer::PassToken CreateInlineExhaustivePass();
 // point are not changed.
 Optimizer::PassToken CreateInlineOpaquePass();
 
+// Creates a budgeted inline pass.
+// This pass visits the functions of the module bottom-up in the call graph,
+// callees before their callers, and inlines a call if the size of the callee,
+// less the instructions of the call and a bonus for constant arguments, is at
+// most |budget|, or if the call is the only call to the callee.  A function
+// grows by at most a few times |budget| this way.  Calls which have opaque
+// arguments or return type, or which pass pointers that are not variables or
+// parameters, are always inlined, so that the module stays legal for targets
+// which require inlining them.
+Optimizer::PassToken CreateInlineCostPass(uint32_t budget = 75);
+
 // Creates a single-block local variable load/store elimination pass.
 // For every entry point function, do single block memory optimization of
 // function variables referenced only with non-access-chain loads and stores.
@@ -487,6 +735,19 @@ Optimizer::PassToken CreateLocalAccessChainConvertPass();
 // such as DeadBranchElimination which depend on values for their analysis.
 Optimizer::PassToken CreateLocalSingleStoreElimPass();
 
+// Creates a memory SSA load and store elimination pass.
+// This pass builds the memory SSA form of the function scope and private
+// variables which are only accessed by loads, stores and access chains.  A
+// load reading the value of a single store is replaced by that value, or by
+// the part of it read through an access chain with constant indices, even if
+// the store is in another block.  The stores whose value is never read are
+// removed.
+//
+// This covers the loads of struct and array elements left by
+// LocalSingleBlockLoadStoreElim and LocalSingleStoreElim, which only forward
+// stores within a block or from variables stored once.
+Optimizer::PassToken CreateMemoryLoadStoreElimPass();
+
 // Creates an insert/extract elimination pass.
 // This pass processes each entry point function in the module, searching for
 // extracts on a sequence of inserts. It further searches the sequence for an
@@ -562,7 +823,13 @@ Optimizer::PassToken CreateRedundantLineInfoElimPass();
 
 // Creates a compact ids pass.
 // The pass remaps result ids to a compact and gapless range starting from %1.
-Optimizer::PassToken CreateCompactIdsPass();
+//
+// If |order_by_locality| is true, the ids are numbered by their first use in
+// each function instead of in module order, and the types, constants and
+// global variables are grouped, both in the module and in the id range, with
+// the function using them the most.  This gives dense and local ids to the
+// tools which reflect over a module by id.
+Optimizer::PassToken CreateCompactIdsPass(bool order_by_locality = false);
 
 // Creates a remove duplicate pass.
 // This pass removes various duplicates:
@@ -600,6 +867,15 @@ Optimizer::PassToken CreateDeadVariableEliminationPass();
 // elimination.
 Optimizer::PassToken CreateMergeReturnPass();
 
+// Creates a pass that merges identical functions.
+// Functions that are the same up to the renaming of the ids they define, such
+// as the instantiations of a template or the copies of a helper function left
+// by linking, are found by hashing a canonical form of each function.  The
+// calls to all of them are redirected to one of them, and the others are
+// removed.  Entry points, and functions used other than by calls, are never
+// removed.
+Optimizer::PassToken CreateMergeIdenticalFunctionsPass();
+
 // Create value numbering pass.
 // This pass will look for instructions in the same basic block that compute the
 // same value, and remove the redundant ones.
@@ -612,14 +888,21 @@ Optimizer::PassToken CreateLoopInvariantCodeMotionPass();
 
 // Creates a loop fission pass.
 // This pass will split all top level loops whose register pressure exceedes the
-// given |threshold|.
-Optimizer::PassToken CreateLoopFissionPass(size_t threshold);
+// given |threshold|.  If |keep_reused_data| is true, the loops whose two parts
+// would access the same storage or uniform buffer elements within a few
+// iterations are not split, since that would make the data travel through
+// the cache twice.
+Optimizer::PassToken CreateLoopFissionPass(size_t threshold,
+                                           bool keep_reused_data = false);
 
 // Creates a loop fusion pass.
 // This pass will look for adjacent loops that are compatible and legal to be
 // fused. The fuse all such loops as long as the register usage for the fused
-// loop stays under the threshold defined by |max_registers_per_loop|.
-Optimizer::PassToken CreateLoopFusionPass(size_t max_registers_per_loop);
+// loop stays under the threshold defined by |max_registers_per_loop|.  If
+// |shared_data_only| is true, only the loops accessing the same storage or
+// uniform buffer elements within a few iterations once fused are fused.
+Optimizer::PassToken CreateLoopFusionPass(size_t max_registers_per_loop,
+                                          bool shared_data_only = false);
 
 // Creates a loop peeling pass.
 // This pass will look for conditions inside a loop that are true or false only
@@ -633,20 +916,47 @@ Optimizer::PassToken CreateLoopPeelingPass();
 // This pass will look for loop independent branch conditions and move the
 // condition out of the loop and version the loop based on the taken branch.
 // Works best after LICM and local multi store elimination pass.
-Optimizer::PassToken CreateLoopUnswitchPass();
+// When a loop has several such conditions, the one expected to execute most
+// often is unswitched first, based on the profile or on the loop nesting.
+// |size_budget| is the number of instructions the copies of the loops may add
+// to each function.  0 means there is no limit.
+Optimizer::PassToken CreateLoopUnswitchPass(uint32_t size_budget = 1000);
 
 // Create global value numbering pass.
 // This pass will look for instructions where the same value is computed on all
 // paths leading to the instruction.  Those instructions are deleted.
 Optimizer::PassToken CreateRedundancyEliminationPass();
 
+// Create partial redundancy elimination pass.
+// This pass looks for instructions whose value is already computed on some of
+// the paths leading to them.  The value is computed on the other paths too,
+// at the end of the predecessors of the block, and the instruction is
+// replaced by an OpPhi.  It is best followed by redundancy elimination.
+Optimizer::PassToken CreatePartialRedundancyEliminationPass();
+
 // Create scalar replacement pass.
 // This pass replaces composite function scope variables with variables for each
 // element if those elements are accessed individually.  The parameter is a
 // limit on the number of members in the composite variable that the pass will
-// consider replacing.
+// replace.  A larger composite only gets variables for the elements accessed
+// individually, if there are no more of them than the limit, and the variable
+// is kept for its other elements.
 Optimizer::PassToken CreateScalarReplacementPass(uint32_t size_limit = 100);
 
+// Creates an SLP vectorization pass.
+// This pass looks for vectors constructed from scalar instructions which
+// apply the same arithmetic to the components of other vectors, typically
+// left by the scalarization of vector code, and computes them with vector
+// instructions instead.  The operands are taken as whole vectors, as
+// shuffles of a vector, as constant vectors, or are gathered with an
+// OpCompositeConstruct.  A construct is only rewritten if fewer instructions
+// are generated than the scalar instructions removed.
+//
+// This is most useful on shaders whose arithmetic was narrowed by
+// ConvertRelaxedToHalfPass, where a vector instruction packs several half
+// precision operations.
+Optimizer::PassToken CreateSLPVectorizePass();
+
 // Create a private to local pass.
 // This pass looks for variables delcared in the private storage class that are
 // used in only one function.  Those variables are moved to the function storage
@@ -689,6 +999,15 @@ Optimizer::PassToken CreateSimplificationPass();
 // won't be unrolled. See CanPerformUnroll LoopUtils.h for more information.
 Optimizer::PassToken CreateLoopUnrollPass(bool fully_unroll, int factor = 0);
 
+// Creates a loop unroller pass which picks the unroll factor of each loop.
+// Like the pass above, it only unrolls the loops which have the "Unroll" loop
+// control mask set and which meet the criteria of
+// LoopUtils::CanPerformUnroll.  The factor of each loop is picked from its
+// trip count, its size and its register pressure, so that the unrolled loop
+// is expected to use at most |max_registers| registers.  Small loops are
+// fully unrolled.
+Optimizer::PassToken CreateLoopUnrollAutoPass(size_t max_registers);
+
 // Create the SSA rewrite pass.
 // This pass converts load/store operations on function local variables into
 // operations on SSA IDs.  This allows SSA optimizers to act on these variables.
@@ -712,6 +1031,17 @@ Optimizer::PassToken CreateConvertRelaxedToHalfPass();
 // if not already so decorated.
 Optimizer::PassToken CreateRelaxFloatOpsPass();
 
+// Create relax float ops pass which only relaxes the values in range.
+// Like CreateRelaxFloatOpsPass, but an interval analysis of each function
+// bounds its float values, starting from the constants, the operations with
+// a bounded result such as sin, clamp or normalize, and the texels of images
+// with a normalized format.  Only the instructions whose result and float
+// operands are known to stay within [-|max_magnitude|, |max_magnitude|] are
+// decorated.  The default is the largest half value; a smaller magnitude
+// keeps more precision, as half has 11 significant bits.
+Optimizer::PassToken CreateRelaxFloatOpsInRangePass(
+    float max_magnitude = 65504.0f);
+
 // Create copy propagate arrays pass.
 // This pass looks to copy propagate memory references for arrays.  It looks
 // for specific code patterns to recognize array copies.
@@ -763,9 +1093,21 @@ Optimizer::PassToken CreateCombineAccessChainsPass();
 // references, and |input_init_enable| controls instrumentation of descriptor
 // initialization checking, both of which require input buffer support.
 // |version| specifies the buffer record format.
+//
+// If |sample_rate| is greater than 1, only about one invocation in
+// |sample_rate|, selected by a hash of its invocation id, checks its
+// references, and each invocation writes at most one record per reference.
+// This lowers the cost of the instrumentation enough to leave it enabled
+// while profiling, at the price of missing some of the errors.
+//
+// If |dedup_checks| is true, a reference through the same descriptor variable
+// and the same index as a reference dominating it is not checked again, since
+// the dominating check has already reported the error if there is one. The
+// later reference is then left unprotected.
 Optimizer::PassToken CreateInstBindlessCheckPass(
     uint32_t desc_set, uint32_t shader_id, bool input_length_enable = false,
-    bool input_init_enable = false, uint32_t version = 2);
+    bool input_init_enable = false, uint32_t version = 2,
+    uint32_t sample_rate = 1, bool dedup_checks = false);
 
 // Create a pass to instrument physical buffer address checking
 // This pass instruments all physical buffer address references to check that
@@ -791,6 +1133,23 @@ Optimizer::PassToken CreateInstBuffAddrCheckPass(uint32_t desc_set,
                                                  uint32_t shader_id,
                                                  uint32_t version = 2);
 
+// Create a pass to instrument shader clock profiling.
+// This pass measures the time spent in each function in the call trees of
+// the entry points, and in each of their selection constructs and of their
+// loops entered from a single block. The time is read from the subgroup
+// clock of SPV_KHR_shader_clock when entering and leaving these sites. The
+// cycles and the number of passes through each site are summed over the
+// subgroup and added to the record of the site in the profile output buffer
+// by one invocation. The module must be SPIR-V 1.3 or later.
+//
+// It is recommended that this pass be run after any legalization and
+// optimization passes, so that the profile matches the code which is run.
+//
+// The instrumentation will write the profile output buffer in debug
+// descriptor set |desc_set|.
+Optimizer::PassToken CreateInstProfilePass(uint32_t desc_set,
+                                           uint32_t shader_id);
+
 // Create a pass to upgrade to the VulkanKHR memory model.
 // This pass upgrades the Logical GLSL450 memory model to Logical VulkanKHR.
 // Additionally, it modifies memory, image, atomic and barrier operations to
@@ -799,8 +1158,19 @@ Optimizer::PassToken CreateUpgradeMemoryModelPass();
 
 // Create a pass to do code sinking.  Code sinking is a transformation
 // where an instruction is moved into a more deeply nested construct.
+// Loads and access chains are moved to the nearest block dominating their
+// uses, across nested selection constructs, but never into a loop.
 Optimizer::PassToken CreateCodeSinkingPass();
 
+// Creates a pass to reduce the register pressure of the functions which need
+// more than |max_registers| registers, as estimated by the register liveness
+// analysis.  Loads from read only memory live across blocks are recomputed
+// in the blocks using them, loads and access chains are sunk as by the code
+// sinking pass, and within the blocks still over the budget the instructions
+// computing a value from their operands only are moved next to their first
+// user.  None of these transformations lengthens a live range.
+Optimizer::PassToken CreateReduceRegisterPressurePass(size_t max_registers);
+
 // Create a pass to adds initializers for OpVariable calls that require them
 // in WebGPU. Currently this pass naively initializes variables that are
 // missing an initializer with a null value. In the future it may initialize
@@ -867,6 +1237,22 @@ Optimizer::PassToken CreateGraphicsRobustAccessPass();
 // for the first index.
 Optimizer::PassToken CreateDescriptorScalarReplacementPass();
 
+// Creates a partial descriptor scalar replacement pass.
+// Like the descriptor scalar replacement pass, but the arrays which are also
+// accessed with non constant indices, runtime arrays included, are split as
+// well.  Every element accessed with a constant index gets its own variable,
+// and the array keeps its binding for the other accesses, so the application
+// must bind those descriptors in both places.  The variables of the elements
+// of such an array are bound consecutively in its descriptor set: element i
+// at the binding of element 0 plus i.  Element 0 of the first array in each
+// set is bound at |first_binding|, or, if it is negative, right after the
+// largest binding of the set, counting the bindings taken by the elements of
+// the arrays which are replaced entirely.  The following arrays of the set
+// come right after the largest element used of the previous one.  The arrays
+// accessed with constant indices only are replaced as by the other pass.
+Optimizer::PassToken CreatePartialDescriptorScalarReplacementPass(
+    int32_t first_binding = -1);
+
 // Create a pass to replace all OpKill instruction with a function call to a
 // function that has a single OpKill.  This allows more code to be inlined.
 Optimizer::PassToken CreateWrapOpKillPass();
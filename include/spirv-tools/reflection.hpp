@@ -0,0 +1,130 @@
+// Copyright (c) 2020 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef INCLUDE_SPIRV_TOOLS_REFLECTION_HPP_
+#define INCLUDE_SPIRV_TOOLS_REFLECTION_HPP_
+
+#include <cstdint>
+
+#include <string>
+#include <vector>
+
+#include "libspirv.hpp"
+
+namespace spvtools {
+
+// The kind of resource accessed through a descriptor.
+enum class DescriptorKind {
+  kUnknown,
+  kSampler,
+  kCombinedImageSampler,
+  kSampledImage,
+  kStorageImage,
+  kUniformTexelBuffer,
+  kStorageTexelBuffer,
+  kUniformBuffer,
+  kStorageBuffer,
+  kInputAttachment,
+  kAccelerationStructure,
+};
+
+// An entry point of a module.
+struct ReflectedEntryPoint {
+  // The SpvExecutionModel of the entry point.
+  uint32_t execution_model;
+  std::string name;
+  uint32_t function_id;
+  // The ids of the variables in the interface of the entry point.
+  std::vector<uint32_t> interface_ids;
+};
+
+// A variable accessed through a descriptor set.
+struct ReflectedDescriptor {
+  uint32_t variable_id;
+  uint32_t set;
+  uint32_t binding;
+  DescriptorKind kind;
+  // The number of descriptors: the length of the array of resources, 1 if
+  // the variable is not an array, or 0 if it is a runtime array.
+  uint32_t count;
+  // The id of the type of a single resource, inside any array.
+  uint32_t type_id;
+};
+
+// A member of a block with an explicit layout.
+struct ReflectedBlockMember {
+  // The offset of the member from the start of the block, in bytes.
+  uint32_t offset;
+  // The size of the member in bytes, or 0 for a runtime array.
+  uint32_t size;
+};
+
+// A push constant block.
+struct ReflectedPushConstant {
+  uint32_t variable_id;
+  // The id of the block type.
+  uint32_t type_id;
+  // The size of the block in bytes: the end of its last member.
+  uint32_t size;
+  std::vector<ReflectedBlockMember> members;
+};
+
+// A scalar specialization constant.
+struct ReflectedSpecConstant {
+  uint32_t id;
+  uint32_t spec_id;
+  uint32_t type_id;
+  // The words of the default value, as in the module.
+  std::vector<uint32_t> default_value;
+};
+
+// An input or output variable.
+struct ReflectedInterfaceVariable {
+  // The value of kNone for a decoration the variable does not have.
+  static const uint32_t kNone = 0xFFFFFFFFu;
+
+  uint32_t variable_id;
+  // The SpvStorageClass of the variable: Input or Output.
+  uint32_t storage_class;
+  // The id of the type of the variable, not of its pointer type.
+  uint32_t type_id;
+  uint32_t location;
+  uint32_t component;
+  // The SpvBuiltIn decorating the variable itself.
+  uint32_t built_in;
+};
+
+// What a pipeline needs to know about a module to create its layouts.  The
+// lists are in the order of the declarations in the module.
+struct ModuleReflection {
+  std::vector<ReflectedEntryPoint> entry_points;
+  std::vector<ReflectedDescriptor> descriptors;
+  std::vector<ReflectedPushConstant> push_constants;
+  std::vector<ReflectedSpecConstant> spec_constants;
+  std::vector<ReflectedInterfaceVariable> interface_variables;
+};
+
+// Fills |reflection| with the entry points and the shader interface of the
+// SPIR-V module in |binary| of |binary_size| words.  Only the instructions
+// before the first function are decoded: the functions are skipped using
+// the word counts of their instructions, and no IR is built.  The module is
+// not validated, but it must be parseable.  Returns SPV_SUCCESS on success.
+// Otherwise returns an error code and sends a message to the message consumer
+// of |context|.
+spv_result_t Reflect(const Context& context, const uint32_t* binary,
+                     size_t binary_size, ModuleReflection* reflection);
+
+}  // namespace spvtools
+
+#endif  // INCLUDE_SPIRV_TOOLS_REFLECTION_HPP_
@@ -31,6 +31,7 @@
 #include "source/operand.h"
 #include "source/spirv_constant.h"
 #include "source/spirv_endian.h"
+#include "source/util/parallel.h"
 
 spv_result_t spvBinaryHeaderGet(const spv_const_binary binary,
                                 const spv_endianness_t endian,
@@ -54,6 +55,99 @@ spv_result_t spvBinaryHeaderGet(const spv_const_binary binary,
 
 namespace {
 
+// Instructions decoded ahead of issuing their callbacks.  Owns the operands
+// of the instructions, and their words if they required endian conversion.
+struct DecodedInstructions {
+  std::vector<spv_parsed_instruction_t> instructions;
+  // For each instruction, the index of its first operand in operands.
+  std::vector<size_t> operand_offsets;
+  // For each instruction, the index of its first word in words.  Empty if the
+  // module did not require endian conversion.
+  std::vector<size_t> word_offsets;
+  std::vector<spv_parsed_operand_t> operands;
+  std::vector<uint32_t> words;
+
+  // Removes all the instructions, but keeps the capacity of the storage.
+  void clear() {
+    instructions.clear();
+    operand_offsets.clear();
+    word_offsets.clear();
+    operands.clear();
+    words.clear();
+  }
+
+  // Points the instructions at their operands and words.  Must be called
+  // once all the instructions have been appended, since the storage only
+  // stops moving then.
+  void finalize() {
+    for (size_t i = 0; i < instructions.size(); ++i) {
+      instructions[i].operands = operands.data() + operand_offsets[i];
+      if (!word_offsets.empty())
+        instructions[i].words = words.data() + word_offsets[i];
+    }
+  }
+};
+
+// Maps result Ids to their type Ids.  Ids below the size given to reset are
+// held in flat arrays, which keep their capacity when the map is reset, and
+// any others in a hash map.
+class IdTypeMap {
+ public:
+  // Removes all the Ids, and holds Ids below dense_size in the flat arrays.
+  void reset(size_t dense_size) {
+    defined_.assign(dense_size, false);
+    type_ids_.resize(dense_size);
+    sparse_.clear();
+  }
+
+  // Maps id to type_id.  Returns false if id was already mapped.
+  bool insert(uint32_t id, uint32_t type_id) {
+    if (id < defined_.size()) {
+      if (defined_[id]) return false;
+      defined_[id] = true;
+      type_ids_[id] = type_id;
+      return true;
+    }
+    return sparse_.insert({id, type_id}).second;
+  }
+
+  // Returns true and sets *type_id to the type Id of id if it is mapped.
+  // Otherwise returns false.
+  bool find(uint32_t id, uint32_t* type_id) const {
+    if (id < defined_.size()) {
+      if (!defined_[id]) return false;
+      *type_id = type_ids_[id];
+      return true;
+    }
+    const auto iter = sparse_.find(id);
+    if (iter == sparse_.end()) return false;
+    *type_id = iter->second;
+    return true;
+  }
+
+ private:
+  std::vector<bool> defined_;
+  std::vector<uint32_t> type_ids_;
+  std::unordered_map<uint32_t, uint32_t> sparse_;
+};
+
+// Returns true if an operand of the given type always takes one word, and
+// never adds operands of its own to the expected operands.
+bool IsPlainSingleWordOperand(spv_operand_type_t type) {
+  switch (type) {
+    case SPV_OPERAND_TYPE_TYPE_ID:
+    case SPV_OPERAND_TYPE_RESULT_ID:
+    case SPV_OPERAND_TYPE_ID:
+    case SPV_OPERAND_TYPE_SCOPE_ID:
+    case SPV_OPERAND_TYPE_MEMORY_SEMANTICS_ID:
+    case SPV_OPERAND_TYPE_LITERAL_INTEGER:
+      return true;
+    default:
+      break;
+  }
+  return false;
+}
+
 // A SPIR-V binary parser.  A parser instance communicates detailed parse
 // results via callbacks.
 class Parser {
@@ -66,7 +160,65 @@ class Parser {
         consumer_(context->consumer),
         user_data_(user_data),
         parsed_header_fn_(parsed_header_fn),
-        parsed_instruction_fn_(parsed_instruction_fn) {}
+        parsed_instruction_fn_(parsed_instruction_fn),
+        parsed_batch_fn_(nullptr),
+        batch_size_(0),
+        parsed_view_fn_(nullptr),
+        parse_views_(false),
+        reuse_storage_(false) {
+    compileOperandPrograms(context->opcode_table);
+  }
+
+  // Like the constructor above, but the parser issues instruction views
+  // to parsed_view_fn rather than fully decoded instructions.
+  Parser(const spv_const_context context, void* user_data,
+         spv_parsed_header_fn_t parsed_header_fn,
+         spv_instruction_view_fn_t parsed_view_fn)
+      : grammar_(context),
+        consumer_(context->consumer),
+        user_data_(user_data),
+        parsed_header_fn_(parsed_header_fn),
+        parsed_instruction_fn_(nullptr),
+        parsed_batch_fn_(nullptr),
+        batch_size_(0),
+        parsed_view_fn_(parsed_view_fn),
+        parse_views_(true),
+        reuse_storage_(false) {
+    compileOperandPrograms(context->opcode_table);
+  }
+
+  // Like the first constructor, but the parser issues the decoded
+  // instructions to parsed_batch_fn in batches of up to batch_size
+  // instructions, rather than one at a time.
+  Parser(const spv_const_context context, void* user_data,
+         spv_parsed_header_fn_t parsed_header_fn,
+         spv_parsed_instruction_batch_fn_t parsed_batch_fn, size_t batch_size)
+      : grammar_(context),
+        consumer_(context->consumer),
+        user_data_(user_data),
+        parsed_header_fn_(parsed_header_fn),
+        parsed_instruction_fn_(nullptr),
+        parsed_batch_fn_(parsed_batch_fn),
+        batch_size_(batch_size),
+        parsed_view_fn_(nullptr),
+        parse_views_(false),
+        reuse_storage_(false) {
+    assert(batch_size_ > 0);
+    compileOperandPrograms(context->opcode_table);
+  }
+
+  // Sets the callbacks, and their context, for the following parses.
+  void setCallbacks(void* user_data, spv_parsed_header_fn_t parsed_header_fn,
+                    spv_parsed_instruction_fn_t parsed_instruction_fn) {
+    user_data_ = user_data;
+    parsed_header_fn_ = parsed_header_fn;
+    parsed_instruction_fn_ = parsed_instruction_fn;
+  }
+
+  // Makes the parser keep the capacity of its storage after each call to
+  // parse, rather than releasing it, so that parsing similar modules again
+  // does not allocate.
+  void reuseStorage() { reuse_storage_ = true; }
 
   // Parses the specified binary SPIR-V module, issuing callbacks on a parsed
   // header and for each parsed instruction.  Returns SPV_SUCCESS on success.
@@ -74,12 +226,84 @@ class Parser {
   spv_result_t parse(const uint32_t* words, size_t num_words,
                      spv_diagnostic* diagnostic);
 
+  // Starts parsing a module that is supplied one instruction at a time to
+  // parseNext, rather than as a whole binary.  The header is given by the
+  // first SPV_INDEX_INSTRUCTION words of |header|, and the module must be in
+  // host native endianness.  Issues the parsed-header callback.  Returns
+  // SPV_SUCCESS on success.  Otherwise returns an error code and issues a
+  // diagnostic.
+  spv_result_t begin(const uint32_t* header, spv_diagnostic* diagnostic);
+
+  // Parses the next instruction of the module started by begin, which must
+  // be exactly the |num_words| words at |words|, and issues the
+  // parsed-instruction callback.  The instruction is decoded and checked
+  // exactly as it would be in the binary of the whole module.  Returns
+  // SPV_SUCCESS on success.  Otherwise returns an error code and issues a
+  // diagnostic.
+  spv_result_t parseNext(const uint32_t* words, size_t num_words);
+
+  // Decodes the operands of the instruction described by view into *inst.
+  // The view must have been issued by this parser for the instruction it is
+  // currently processing.  Returns SPV_SUCCESS on success.  Otherwise returns
+  // an error code and issues a diagnostic.
+  spv_result_t decodeView(const spv_instruction_view_t* view,
+                          spv_parsed_instruction_t* inst);
+
+  // Decodes the specified binary SPIR-V module without issuing any
+  // instruction callbacks, appending the instructions to *decoded in module
+  // order.  Instructions in the function section are decoded on up to
+  // num_threads threads.  Returns SPV_SUCCESS on success.  Otherwise returns
+  // an error code, and the module should be parsed sequentially instead.
+  // In that case, the parser should not have a message consumer, because it
+  // may fail in ways that a sequential parse does not.
+  spv_result_t decodeModule(const uint32_t* words, size_t num_words,
+                            uint32_t num_threads,
+                            std::vector<DecodedInstructions>* decoded);
+
+  // Issues the parsed-header callback for the specified binary SPIR-V module,
+  // followed by the parsed-instruction callback for each instruction in
+  // decoded.  The instructions must have been decoded from the same module by
+  // decodeModule.  Returns SPV_SUCCESS if all callbacks return SPV_SUCCESS.
+  spv_result_t issueDecoded(const uint32_t* words, size_t num_words,
+                            std::vector<DecodedInstructions>* decoded);
+
  private:
   // All remaining methods work on the current module parse state.
 
   // Like the parse method, but works on the current module parse state.
   spv_result_t parseModule();
 
+  // Parses the header of the module, and issues the parsed-header callback.
+  // On success, returns SPV_SUCCESS and sets the parsing position to the
+  // first instruction.  Otherwise returns an error code and issues a
+  // diagnostic.
+  spv_result_t parseHeader();
+
+  // Converts the whole module to host native endianness in a single pass,
+  // so that instructions are decoded without per-operand conversion.
+  // Literal strings keep the bytes of the original module, and are restored
+  // as they are parsed.  Must only be called after a successful parseHeader
+  // for a module that requires endian conversion.
+  void convertModuleToNativeEndianness();
+
+  // Decodes the instruction at the current position, and appends it to
+  // *decoded.  Returns SPV_SUCCESS on success.  Otherwise returns an error
+  // code and issues a diagnostic.
+  spv_result_t decodeNext(DecodedInstructions* decoded);
+
+  // Issues the parsed-instruction batch callback for the instructions in
+  // _.batch, then removes them.  Returns the result of the callback.
+  spv_result_t issueBatch();
+
+  // Decodes the instructions from the current position up to the given word
+  // index, appending them to *decoded.  Returns SPV_SUCCESS on success.
+  // Otherwise returns an error code and issues a diagnostic.
+  spv_result_t decodeRange(size_t end, DecodedInstructions* decoded);
+
+  // Like decodeModule, but works on the current module parse state.
+  spv_result_t decodeModuleInParallel(uint32_t num_threads,
+                                      std::vector<DecodedInstructions>* decoded);
+
   // Parses an instruction at the current position of the binary.  Assumes
   // the header has been parsed, the endian has been set, and the word index is
   // still in range.  Advances the parsing position past the instruction, and
@@ -88,6 +312,22 @@ class Parser {
   // On failure, returns an error code and issues a diagnostic.
   spv_result_t parseInstruction();
 
+  // Decodes the instruction at the current position of the binary into
+  // *inst, with the same assumptions as parseInstruction.  Advances the
+  // parsing position past the instruction.  The storage referenced by *inst
+  // is valid until the next instruction is decoded.  On success, returns
+  // SPV_SUCCESS.  On failure, returns an error code and issues a diagnostic.
+  spv_result_t decodeInstruction(spv_parsed_instruction_t* inst);
+
+  // Like parseInstruction, but only decodes the opcode, word count, and the
+  // type and result Ids of the instruction, and issues the instruction view
+  // callback instead.
+  spv_result_t parseInstructionView();
+
+  // Fills operand_programs_ with the decoding program of each opcode in the
+  // given table.
+  void compileOperandPrograms(const spv_opcode_table opcode_table);
+
   // Parses an instruction operand with the given type, for an instruction
   // starting at inst_offset words into the SPIR-V binary.
   // If the SPIR-V binary is the same endianness as the host, then the
@@ -160,10 +400,38 @@ class Parser {
 
   const spvtools::AssemblyGrammar grammar_;        // SPIR-V syntax utility.
   const spvtools::MessageConsumer& consumer_;      // Message consumer callback.
-  void* const user_data_;                          // Context for the callbacks
-  const spv_parsed_header_fn_t parsed_header_fn_;  // Parsed header callback
-  const spv_parsed_instruction_fn_t
+  void* user_data_;                                // Context for the callbacks
+  spv_parsed_header_fn_t parsed_header_fn_;        // Parsed header callback
+  spv_parsed_instruction_fn_t
       parsed_instruction_fn_;  // Parsed instruction callback
+  spv_parsed_instruction_batch_fn_t
+      parsed_batch_fn_;  // Parsed instruction batch callback
+  size_t batch_size_;    // Maximum number of instructions in a batch
+  const spv_instruction_view_fn_t parsed_view_fn_;  // Instruction view callback
+  const bool parse_views_;  // Issue views instead of decoded instructions?
+  bool reuse_storage_;      // Keep the storage capacity after parsing?
+
+  // A precompiled program for decoding the operands of an opcode whose
+  // operands all take one word each.  The types of the operands of such an
+  // instruction follow from its word count alone, so it is decoded without
+  // the expected operands stack.
+  struct OperandProgram {
+    // Is the opcode decoded by this program?  If not, the operands are
+    // decoded with the expected operands stack.
+    bool is_compiled;
+    // The number of leading operands that are always present.  Their types
+    // are the first entries of the operand types of the opcode.
+    uint16_t num_required;
+    // The type of each operand after the required ones.
+    spv_operand_type_t tail_type;
+    // The maximum number of operands after the required ones.
+    uint16_t max_tail;
+  };
+
+  // The entries of the opcode table of the context, and the decoding program
+  // of each of them, at the same index.
+  const spv_opcode_desc_t* opcode_entries_;
+  std::vector<OperandProgram> operand_programs_;
 
   // Describes the format of a typed literal number.
   struct NumberType {
@@ -174,61 +442,169 @@ class Parser {
   // The state used to parse a single SPIR-V binary module.
   struct State {
     State(const uint32_t* words_arg, size_t num_words_arg,
-          spv_diagnostic* diagnostic_arg)
-        : words(words_arg),
-          num_words(num_words_arg),
-          diagnostic(diagnostic_arg),
-          word_index(0),
-          instruction_count(0),
-          endian(),
-          requires_endian_conversion(false) {
+          spv_diagnostic* diagnostic_arg) {
       // Temporary storage for parser state within a single instruction.
       // Most instructions require fewer than 25 words or operands.
       operands.reserve(25);
       endian_converted_words.reserve(25);
       expected_operands.reserve(25);
+      reset(words_arg, num_words_arg, diagnostic_arg);
     }
     State() : State(0, 0, nullptr) {}
+
+    // Prepares to parse the given module, as if newly constructed, but keeps
+    // the capacity of the containers.
+    void reset(const uint32_t* words_arg, size_t num_words_arg,
+               spv_diagnostic* diagnostic_arg) {
+      words = words_arg;
+      original_words = words_arg;
+      num_words = num_words_arg;
+      diagnostic = diagnostic_arg;
+      id_bound = 0;
+      word_index = 0;
+      instruction_count = 0;
+      endian = spv_endianness_t();
+      requires_endian_conversion = false;
+      decoding_view = false;
+      id_to_type_id.reset(0);
+      type_id_to_number_type_info.clear();
+      import_id_to_ext_inst_type.clear();
+      native_words.clear();
+      operands.clear();
+      endian_converted_words.clear();
+      expected_operands.clear();
+      batch.clear();
+    }
     const uint32_t* words;       // Words in the binary SPIR-V module.
+    // Words in the module as originally given.  This differs from words only
+    // after the module has been converted to native endianness.
+    const uint32_t* original_words;
     size_t num_words;            // Number of words in the module.
     spv_diagnostic* diagnostic;  // Where diagnostics go.
+    uint32_t id_bound;           // The Id bound from the header.
     size_t word_index;           // The current position in words.
     size_t instruction_count;    // The count of processed instructions
     spv_endianness_t endian;     // The endianness of the binary.
     // Is the SPIR-V binary in a different endiannes from the host native
     // endianness?
     bool requires_endian_conversion;
+    // Is the current instruction being decoded from an instruction view?
+    // If so, its result Id has already been recorded.
+    bool decoding_view;
 
     // Maps a result ID to its type ID.  By convention:
     //  - a result ID that is a type definition maps to itself.
     //  - a result ID without a type maps to 0.  (E.g. for OpLabel)
-    std::unordered_map<uint32_t, uint32_t> id_to_type_id;
+    IdTypeMap id_to_type_id;
     // Maps a type ID to its number type description.
     std::unordered_map<uint32_t, NumberType> type_id_to_number_type_info;
     // Maps an ExtInstImport id to the extended instruction type.
     std::unordered_map<uint32_t, spv_ext_inst_type_t>
         import_id_to_ext_inst_type;
+    // The module converted to native endianness, if that was required.
+    std::vector<uint32_t> native_words;
 
     // Used by parseOperand
     std::vector<spv_parsed_operand_t> operands;
     std::vector<uint32_t> endian_converted_words;
     spv_operand_pattern_t expected_operands;
+
+    // The instructions decoded since the last batch was issued.
+    DecodedInstructions batch;
   } _;
 };
 
 spv_result_t Parser::parse(const uint32_t* words, size_t num_words,
                            spv_diagnostic* diagnostic_arg) {
-  _ = State(words, num_words, diagnostic_arg);
+  _.reset(words, num_words, diagnostic_arg);
 
   const spv_result_t result = parseModule();
 
-  // Clear the module state.  The tables might be big.
-  _ = State();
+  // Clear the module state.  The tables might be big, so release them unless
+  // they are to be reused.
+  if (reuse_storage_) {
+    _.reset(nullptr, 0, nullptr);
+  } else {
+    _ = State();
+  }
 
   return result;
 }
 
+spv_result_t Parser::begin(const uint32_t* header,
+                           spv_diagnostic* diagnostic_arg) {
+  _.reset(header, SPV_INDEX_INSTRUCTION, diagnostic_arg);
+  if (auto error = parseHeader()) return error;
+  if (_.requires_endian_conversion) {
+    return diagnostic() << "Module supplied by instruction must be in host "
+                           "native endianness.";
+  }
+  // The module is not available to bound the number of Ids it defines, but
+  // unlike a binary it was not read from an untrusted source.
+  _.id_to_type_id.reset(_.id_bound);
+  return SPV_SUCCESS;
+}
+
+spv_result_t Parser::parseNext(const uint32_t* words, size_t num_words) {
+  assert(num_words > 0);
+  _.words = words;
+  _.original_words = words;
+  _.num_words = num_words;
+  _.word_index = 0;
+  if (auto error = parseInstruction()) return error;
+  if (_.word_index != num_words) {
+    return diagnostic() << "Invalid instruction word count: "
+                        << _.word_index << " words read from an instruction "
+                        << "of " << num_words << " words.";
+  }
+  return SPV_SUCCESS;
+}
+
 spv_result_t Parser::parseModule() {
+  if (auto error = parseHeader()) return error;
+
+  // Process the instructions.
+  if (parse_views_) {
+    while (_.word_index < _.num_words)
+      if (auto error = parseInstructionView()) return error;
+  } else if (parsed_batch_fn_) {
+    if (_.requires_endian_conversion) convertModuleToNativeEndianness();
+    while (_.word_index < _.num_words) {
+      _.instruction_count++;
+      if (auto error = decodeNext(&_.batch)) {
+        // Issue the instructions before the invalid one, as they would have
+        // been issued one at a time.
+        if (auto batch_error = issueBatch()) return batch_error;
+        return error;
+      }
+      if (_.batch.instructions.size() == batch_size_) {
+        if (auto error = issueBatch()) return error;
+      }
+    }
+    if (auto error = issueBatch()) return error;
+  } else {
+    if (_.requires_endian_conversion) convertModuleToNativeEndianness();
+    while (_.word_index < _.num_words)
+      if (auto error = parseInstruction()) return error;
+  }
+
+  // Running off the end should already have been reported earlier.
+  assert(_.word_index == _.num_words);
+
+  return SPV_SUCCESS;
+}
+
+void Parser::convertModuleToNativeEndianness() {
+  assert(_.requires_endian_conversion);
+  _.native_words.resize(_.num_words);
+  spvFixWords(_.words, _.num_words, _.endian, _.native_words.data());
+  _.words = _.native_words.data();
+  _.endian = spvIsHostEndian(SPV_ENDIANNESS_LITTLE) ? SPV_ENDIANNESS_LITTLE
+                                                    : SPV_ENDIANNESS_BIG;
+  _.requires_endian_conversion = false;
+}
+
+spv_result_t Parser::parseHeader() {
   if (!_.words) return diagnostic() << "Missing module.";
 
   if (_.num_words < SPV_INDEX_INSTRUCTION)
@@ -258,18 +634,198 @@ spv_result_t Parser::parseModule() {
       return error;
     }
   }
+  _.id_bound = header.bound;
+  // A valid module defines fewer Ids than it has words, so this bounds the
+  // flat storage for the Id to type mapping.
+  _.id_to_type_id.reset(std::min(static_cast<size_t>(_.id_bound), _.num_words));
 
-  // Process the instructions.
   _.word_index = SPV_INDEX_INSTRUCTION;
-  while (_.word_index < _.num_words)
-    if (auto error = parseInstruction()) return error;
+  return SPV_SUCCESS;
+}
 
-  // Running off the end should already have been reported earlier.
-  assert(_.word_index == _.num_words);
+spv_result_t Parser::decodeModule(const uint32_t* words, size_t num_words,
+                                  uint32_t num_threads,
+                                  std::vector<DecodedInstructions>* decoded) {
+  _ = State(words, num_words, nullptr);
+
+  spv_result_t result = parseHeader();
+  if (result == SPV_SUCCESS) result = decodeModuleInParallel(num_threads, decoded);
 
+  // Clear the module state.  The tables might be big.
+  _ = State();
+
+  return result;
+}
+
+spv_result_t Parser::decodeModuleInParallel(
+    uint32_t num_threads, std::vector<DecodedInstructions>* decoded) {
+  // Find where each function starts, using only the word count and opcode of
+  // each instruction.
+  std::vector<size_t> function_starts;
+  for (size_t index = _.word_index; index < _.num_words;) {
+    uint16_t word_count = 0;
+    uint16_t opcode = 0;
+    spvOpcodeSplit(peekAt(index), &word_count, &opcode);
+    if (word_count == 0 || _.num_words - index < word_count)
+      return SPV_ERROR_INVALID_BINARY;
+    if (opcode == SpvOpFunction) function_starts.push_back(index);
+    index += word_count;
+  }
+
+  // The instructions before the first function define the types and
+  // extended instruction imports needed to decode the functions, so decode
+  // them first.
+  const size_t global_section_end =
+      function_starts.empty() ? _.num_words : function_starts.front();
+  decoded->clear();
+  decoded->emplace_back();
+  if (auto error = decodeRange(global_section_end, &decoded->back()))
+    return error;
+  if (function_starts.empty()) return SPV_SUCCESS;
+
+  // Split the function section into chunks of roughly equal size, each
+  // holding whole functions.
+  const size_t num_chunks =
+      std::min(static_cast<size_t>(spvtools::utils::ResolveNumThreads(num_threads)),
+               function_starts.size());
+  const size_t section_words = _.num_words - global_section_end;
+  std::vector<size_t> chunk_starts;
+  for (size_t start : function_starts) {
+    if ((start - global_section_end) * num_chunks >=
+        chunk_starts.size() * section_words) {
+      chunk_starts.push_back(start);
+    }
+  }
+
+  // Each chunk is decoded by its own copy of the parser, starting from the
+  // state left by the global section.
+  decoded->resize(1 + chunk_starts.size());
+  std::vector<spv_result_t> results(chunk_starts.size(), SPV_SUCCESS);
+  spvtools::utils::ParallelFor(
+      chunk_starts.size(), num_threads,
+      [this, &chunk_starts, &results, decoded](size_t i) {
+        Parser chunk_parser(*this);
+        chunk_parser._.word_index = chunk_starts[i];
+        const size_t end =
+            i + 1 < chunk_starts.size() ? chunk_starts[i + 1] : _.num_words;
+        results[i] = chunk_parser.decodeRange(end, &(*decoded)[i + 1]);
+      });
+  for (spv_result_t result : results)
+    if (result != SPV_SUCCESS) return result;
+
+  // Each chunk only checked its result Ids against the global section and
+  // itself.  Check the chunks against each other.
+  if (_.id_bound > 16 * _.num_words) return SPV_ERROR_INVALID_ID;
+  std::vector<bool> defined(_.id_bound, false);
+  for (size_t i = 1; i < decoded->size(); ++i) {
+    for (const auto& inst : (*decoded)[i].instructions) {
+      if (!inst.result_id) continue;
+      if (inst.result_id >= _.id_bound || defined[inst.result_id])
+        return SPV_ERROR_INVALID_ID;
+      defined[inst.result_id] = true;
+    }
+  }
+
+  return SPV_SUCCESS;
+}
+
+spv_result_t Parser::decodeNext(DecodedInstructions* decoded) {
+  spv_parsed_instruction_t inst = {};
+  if (auto error = decodeInstruction(&inst)) return error;
+
+  decoded->operand_offsets.push_back(decoded->operands.size());
+  decoded->operands.insert(decoded->operands.end(), inst.operands,
+                           inst.operands + inst.num_operands);
+  if (_.requires_endian_conversion) {
+    decoded->word_offsets.push_back(decoded->words.size());
+    decoded->words.insert(decoded->words.end(), inst.words,
+                          inst.words + inst.num_words);
+  }
+  decoded->instructions.push_back(inst);
+  return SPV_SUCCESS;
+}
+
+spv_result_t Parser::issueBatch() {
+  if (_.batch.instructions.empty()) return SPV_SUCCESS;
+  _.batch.finalize();
+  const spv_result_t result =
+      parsed_batch_fn_(user_data_, _.batch.instructions.data(),
+                       _.batch.instructions.size());
+  _.batch.clear();
+  return result;
+}
+
+spv_result_t Parser::decodeRange(size_t end, DecodedInstructions* decoded) {
+  while (_.word_index < end) {
+    _.instruction_count++;
+    if (auto error = decodeNext(decoded)) return error;
+  }
+  // The end is always an instruction boundary found by a pre-scan.
+  assert(_.word_index == end);
   return SPV_SUCCESS;
 }
 
+spv_result_t Parser::issueDecoded(const uint32_t* words, size_t num_words,
+                                  std::vector<DecodedInstructions>* decoded) {
+  _ = State(words, num_words, nullptr);
+  spv_result_t result = parseHeader();
+  for (size_t part = 0; result == SPV_SUCCESS && part < decoded->size();
+       ++part) {
+    DecodedInstructions& instructions = (*decoded)[part];
+    instructions.finalize();
+    for (const spv_parsed_instruction_t& inst : instructions.instructions) {
+      if (parsed_instruction_fn_) {
+        result = parsed_instruction_fn_(user_data_, &inst);
+        if (result != SPV_SUCCESS) break;
+      }
+    }
+  }
+  _ = State();
+  return result;
+}
+
+void Parser::compileOperandPrograms(const spv_opcode_table opcode_table) {
+  opcode_entries_ = opcode_table->entries;
+  operand_programs_.clear();
+  operand_programs_.reserve(opcode_table->count);
+  for (uint32_t i = 0; i < opcode_table->count; ++i) {
+    const spv_opcode_desc_t& entry = opcode_table->entries[i];
+    OperandProgram program = {false, 0, SPV_OPERAND_TYPE_NONE, 0};
+    uint16_t num_required = 0;
+    while (num_required < entry.numTypes &&
+           IsPlainSingleWordOperand(entry.operandTypes[num_required])) {
+      ++num_required;
+    }
+    program.num_required = num_required;
+    program.is_compiled = true;
+    if (num_required + 1 == entry.numTypes) {
+      // The last operand may be absent or repeated.  Variable operands are
+      // decoded as their optional element, as after expanding them.
+      switch (entry.operandTypes[num_required]) {
+        case SPV_OPERAND_TYPE_OPTIONAL_ID:
+        case SPV_OPERAND_TYPE_OPTIONAL_LITERAL_INTEGER:
+          program.tail_type = entry.operandTypes[num_required];
+          program.max_tail = 1;
+          break;
+        case SPV_OPERAND_TYPE_VARIABLE_ID:
+          program.tail_type = SPV_OPERAND_TYPE_OPTIONAL_ID;
+          program.max_tail = std::numeric_limits<uint16_t>::max();
+          break;
+        case SPV_OPERAND_TYPE_VARIABLE_LITERAL_INTEGER:
+          program.tail_type = SPV_OPERAND_TYPE_OPTIONAL_LITERAL_INTEGER;
+          program.max_tail = std::numeric_limits<uint16_t>::max();
+          break;
+        default:
+          program.is_compiled = false;
+          break;
+      }
+    } else if (num_required != entry.numTypes) {
+      program.is_compiled = false;
+    }
+    operand_programs_.push_back(program);
+  }
+}
+
 spv_result_t Parser::parseInstruction() {
   _.instruction_count++;
 
@@ -277,6 +833,20 @@ spv_result_t Parser::parseInstruction() {
   // correct initial values.
   spv_parsed_instruction_t inst = {};
 
+  if (auto error = decodeInstruction(&inst)) return error;
+
+  // Issue the callback.  The callee should know that all the storage in inst
+  // is transient, and will disappear immediately afterward.
+  if (parsed_instruction_fn_) {
+    if (auto error = parsed_instruction_fn_(user_data_, &inst)) return error;
+  }
+
+  return SPV_SUCCESS;
+}
+
+spv_result_t Parser::decodeInstruction(spv_parsed_instruction_t* inst_ptr) {
+  spv_parsed_instruction_t& inst = *inst_ptr;
+
   const uint32_t first_word = peek();
 
   // If the module's endianness is different from the host native endianness,
@@ -306,45 +876,65 @@ spv_result_t Parser::parseInstruction() {
   const size_t inst_offset = _.word_index;
   _.word_index++;
 
-  // Maintains the ordered list of expected operand types.
-  // For many instructions we only need the {numTypes, operandTypes}
-  // entries in opcode_desc.  However, sometimes we need to modify
-  // the list as we parse the operands. This occurs when an operand
-  // has its own logical operands (such as the LocalSize operand for
-  // ExecutionMode), or for extended instructions that may have their
-  // own operands depending on the selected extended instruction.
-  _.expected_operands.clear();
-  for (auto i = 0; i < opcode_desc->numTypes; i++)
-    _.expected_operands.push_back(
-        opcode_desc->operandTypes[opcode_desc->numTypes - i - 1]);
-
-  while (_.word_index < inst_offset + inst_word_count) {
-    const uint16_t inst_word_index = uint16_t(_.word_index - inst_offset);
-    if (_.expected_operands.empty()) {
-      return diagnostic() << "Invalid instruction Op" << opcode_desc->name
-                          << " starting at word " << inst_offset
-                          << ": expected no more operands after "
-                          << inst_word_index
-                          << " words, but stated word count is "
-                          << inst_word_count << ".";
+  const OperandProgram& program =
+      operand_programs_[opcode_desc - opcode_entries_];
+  const uint16_t num_operands = uint16_t(inst_word_count - 1);
+  if (program.is_compiled && num_operands >= program.num_required &&
+      num_operands - program.num_required <= program.max_tail) {
+    // Each operand takes one word, so the word count gives the type of
+    // every operand.  Other word counts are left to the general decoding
+    // below, which reports them.
+    for (uint16_t i = 0; i < num_operands; i++) {
+      const spv_operand_type_t type = i < program.num_required
+                                          ? opcode_desc->operandTypes[i]
+                                          : program.tail_type;
+      if (auto error =
+              parseOperand(inst_offset, &inst, type, &_.endian_converted_words,
+                           &_.operands, &_.expected_operands)) {
+        return error;
+      }
     }
+  } else {
+    // Maintains the ordered list of expected operand types.
+    // For many instructions we only need the {numTypes, operandTypes}
+    // entries in opcode_desc.  However, sometimes we need to modify
+    // the list as we parse the operands. This occurs when an operand
+    // has its own logical operands (such as the LocalSize operand for
+    // ExecutionMode), or for extended instructions that may have their
+    // own operands depending on the selected extended instruction.
+    _.expected_operands.clear();
+    for (auto i = 0; i < opcode_desc->numTypes; i++)
+      _.expected_operands.push_back(
+          opcode_desc->operandTypes[opcode_desc->numTypes - i - 1]);
+
+    while (_.word_index < inst_offset + inst_word_count) {
+      const uint16_t inst_word_index = uint16_t(_.word_index - inst_offset);
+      if (_.expected_operands.empty()) {
+        return diagnostic() << "Invalid instruction Op" << opcode_desc->name
+                            << " starting at word " << inst_offset
+                            << ": expected no more operands after "
+                            << inst_word_index
+                            << " words, but stated word count is "
+                            << inst_word_count << ".";
+      }
 
-    spv_operand_type_t type =
-        spvTakeFirstMatchableOperand(&_.expected_operands);
+      spv_operand_type_t type =
+          spvTakeFirstMatchableOperand(&_.expected_operands);
 
-    if (auto error =
-            parseOperand(inst_offset, &inst, type, &_.endian_converted_words,
-                         &_.operands, &_.expected_operands)) {
-      return error;
+      if (auto error =
+              parseOperand(inst_offset, &inst, type, &_.endian_converted_words,
+                           &_.operands, &_.expected_operands)) {
+        return error;
+      }
     }
-  }
 
-  if (!_.expected_operands.empty() &&
-      !spvOperandIsOptional(_.expected_operands.back())) {
-    return diagnostic() << "End of input reached while decoding Op"
-                        << opcode_desc->name << " starting at word "
-                        << inst_offset << ": expected more operands after "
-                        << inst_word_count << " words.";
+    if (!_.expected_operands.empty() &&
+        !spvOperandIsOptional(_.expected_operands.back())) {
+      return diagnostic() << "End of input reached while decoding Op"
+                          << opcode_desc->name << " starting at word "
+                          << inst_offset << ": expected more operands after "
+                          << inst_word_count << " words.";
+    }
   }
 
   if ((inst_offset + inst_word_count) != _.word_index) {
@@ -365,7 +955,7 @@ spv_result_t Parser::parseInstruction() {
   assert(_.requires_endian_conversion ||
          (_.endian_converted_words.size() == 1));
 
-  recordNumberType(inst_offset, &inst);
+  if (!_.decoding_view) recordNumberType(inst_offset, &inst);
 
   if (_.requires_endian_conversion) {
     // We must wait until here to set this pointer, because the vector might
@@ -383,15 +973,137 @@ spv_result_t Parser::parseInstruction() {
   inst.operands = _.operands.data();
   inst.num_operands = uint16_t(_.operands.size());
 
-  // Issue the callback.  The callee should know that all the storage in inst
-  // is transient, and will disappear immediately afterward.
-  if (parsed_instruction_fn_) {
-    if (auto error = parsed_instruction_fn_(user_data_, &inst)) return error;
+  return SPV_SUCCESS;
+}
+
+spv_result_t Parser::parseInstructionView() {
+  _.instruction_count++;
+
+  assert(_.word_index < _.num_words);
+  const size_t inst_offset = _.word_index;
+  uint16_t inst_word_count = 0;
+  uint16_t opcode_value = 0;
+  spvOpcodeSplit(peek(), &inst_word_count, &opcode_value);
+  if (inst_word_count < 1) {
+    return diagnostic() << "Invalid instruction word count: "
+                        << inst_word_count;
+  }
+  const SpvOp opcode = static_cast<SpvOp>(opcode_value);
+  spv_opcode_desc opcode_desc;
+  if (grammar_.lookupOpcode(opcode, &opcode_desc))
+    return diagnostic() << "Invalid opcode: " << opcode_value;
+
+  if (_.num_words - inst_offset < inst_word_count) {
+    return diagnostic() << "End of input reached while decoding Op"
+                        << opcode_desc->name << " starting at word "
+                        << inst_offset << ": stated word count is "
+                        << inst_word_count << ", but only "
+                        << _.num_words - inst_offset << " words remain.";
+  }
+
+  // Every operand which is neither optional nor variable occupies at least
+  // one word.
+  uint16_t min_word_count = 1;
+  for (auto i = 0; i < opcode_desc->numTypes; i++) {
+    const spv_operand_type_t type = opcode_desc->operandTypes[i];
+    if (!spvOperandIsOptional(type) && !spvOperandIsVariable(type))
+      min_word_count++;
+  }
+  if (inst_word_count < min_word_count) {
+    return diagnostic() << "End of input reached while decoding Op"
+                        << opcode_desc->name << " starting at word "
+                        << inst_offset << ": expected more operands after "
+                        << inst_word_count << " words.";
+  }
+
+  spv_instruction_view_t view = {};
+  view.words = _.words + inst_offset;
+  view.num_words = inst_word_count;
+  view.opcode = opcode_value;
+  view.endian = _.endian;
+  view.ext_inst_type = SPV_EXT_INST_TYPE_NONE;
+  view.offset = inst_offset;
+  view.parser = this;
+
+  size_t word = inst_offset + 1;
+  if (opcode_desc->hasType) {
+    view.type_id = peekAt(word++);
+    if (!view.type_id)
+      return diagnostic(SPV_ERROR_INVALID_ID) << "Error: Type Id is 0";
+  }
+  if (opcode_desc->hasResult) {
+    view.result_id = peekAt(word++);
+    if (!view.result_id)
+      return diagnostic(SPV_ERROR_INVALID_ID) << "Error: Result Id is 0";
+    // The id to type mapping is needed to decode OpSwitch literals, so it is
+    // maintained even though operands are not decoded.
+    if (!_.id_to_type_id.insert(view.result_id,
+                                spvOpcodeGeneratesType(opcode)
+                                    ? view.result_id
+                                    : view.type_id)) {
+      return diagnostic(SPV_ERROR_INVALID_ID)
+             << "Id " << view.result_id << " is defined more than once";
+    }
+  }
+
+  if (SpvOpExtInstImport == opcode) {
+    const char* string = reinterpret_cast<const char*>(_.words + word);
+    const size_t string_max_bytes =
+        sizeof(uint32_t) * (inst_offset + inst_word_count - word);
+    if (spv_strnlen_s(string, string_max_bytes) == string_max_bytes) {
+      return diagnostic() << "Invalid OpExtInstImport starting at word "
+                          << inst_offset
+                          << ": literal string is not null-terminated";
+    }
+    const spv_ext_inst_type_t ext_inst_type = spvExtInstImportTypeGet(string);
+    if (SPV_EXT_INST_TYPE_NONE == ext_inst_type) {
+      return diagnostic() << "Invalid extended instruction import '" << string
+                          << "'";
+    }
+    _.import_id_to_ext_inst_type[view.result_id] = ext_inst_type;
+  } else if (SpvOpExtInst == opcode) {
+    const uint32_t set_id = peekAt(word);
+    auto ext_inst_type_iter = _.import_id_to_ext_inst_type.find(set_id);
+    if (ext_inst_type_iter == _.import_id_to_ext_inst_type.end()) {
+      return diagnostic(SPV_ERROR_INVALID_ID)
+             << "OpExtInst set Id " << set_id
+             << " does not reference an OpExtInstImport result Id";
+    }
+    view.ext_inst_type = ext_inst_type_iter->second;
+  }
+
+  // Peeks at the literal operands of OpTypeInt and OpTypeFloat, whose
+  // presence is guaranteed by the minimum word count check above.
+  spv_parsed_instruction_t type_inst = {};
+  type_inst.opcode = opcode_value;
+  type_inst.result_id = view.result_id;
+  recordNumberType(inst_offset, &type_inst);
+
+  // Advance past the instruction before issuing the callback, so the parser
+  // is in a consistent state if the callback decodes the view.
+  _.word_index = inst_offset + inst_word_count;
+
+  if (parsed_view_fn_) {
+    if (auto error = parsed_view_fn_(user_data_, &view)) return error;
   }
 
   return SPV_SUCCESS;
 }
 
+spv_result_t Parser::decodeView(const spv_instruction_view_t* view,
+                                spv_parsed_instruction_t* inst) {
+  if (!view || !inst) return SPV_ERROR_INVALID_POINTER;
+
+  const size_t saved_word_index = _.word_index;
+  _.word_index = view->offset;
+  _.decoding_view = true;
+  *inst = {};
+  const spv_result_t result = decodeInstruction(inst);
+  _.decoding_view = false;
+  _.word_index = saved_word_index;
+  return result;
+}
+
 spv_result_t Parser::parseOperand(size_t inst_offset,
                                   spv_parsed_instruction_t* inst,
                                   const spv_operand_type_t type,
@@ -435,17 +1147,19 @@ spv_result_t Parser::parseOperand(size_t inst_offset,
       if (!word)
         return diagnostic(SPV_ERROR_INVALID_ID) << "Error: Result Id is 0";
       inst->result_id = word;
+      // An instruction view has already recorded its result ID.
+      if (_.decoding_view) break;
       // Save the result ID to type ID mapping.
       // In the grammar, type ID always appears before result ID.
-      if (_.id_to_type_id.find(inst->result_id) != _.id_to_type_id.end())
-        return diagnostic(SPV_ERROR_INVALID_ID)
-               << "Id " << inst->result_id << " is defined more than once";
-      // Record it.
       // A regular value maps to its type.  Some instructions (e.g. OpLabel)
       // have no type Id, and will map to 0.  The result Id for a
       // type-generating instruction (e.g. OpTypeInt) maps to itself.
-      _.id_to_type_id[inst->result_id] =
-          spvOpcodeGeneratesType(opcode) ? inst->result_id : inst->type_id;
+      if (!_.id_to_type_id.insert(inst->result_id,
+                                  spvOpcodeGeneratesType(opcode)
+                                      ? inst->result_id
+                                      : inst->type_id))
+        return diagnostic(SPV_ERROR_INVALID_ID)
+               << "Id " << inst->result_id << " is defined more than once";
       break;
 
     case SPV_OPERAND_TYPE_ID:
@@ -532,13 +1246,11 @@ spv_result_t Parser::parseOperand(size_t inst_offset,
         // The literal operands have the same type as the value
         // referenced by the selector Id.
         const uint32_t selector_id = peekAt(inst_offset + 1);
-        const auto type_id_iter = _.id_to_type_id.find(selector_id);
-        if (type_id_iter == _.id_to_type_id.end() ||
-            type_id_iter->second == 0) {
+        uint32_t type_id = 0;
+        if (!_.id_to_type_id.find(selector_id, &type_id) || type_id == 0) {
           return diagnostic() << "Invalid OpSwitch: selector id " << selector_id
                               << " has no type";
         }
-        uint32_t type_id = type_id_iter->second;
 
         if (selector_id == type_id) {
           // Recall that by convention, a result ID that is a type definition
@@ -568,7 +1280,7 @@ spv_result_t Parser::parseOperand(size_t inst_offset,
     case SPV_OPERAND_TYPE_OPTIONAL_LITERAL_STRING: {
       convert_operand_endianness = false;
       const char* string =
-          reinterpret_cast<const char*>(_.words + _.word_index);
+          reinterpret_cast<const char*>(_.original_words + _.word_index);
       // Compute the length of the string, but make sure we don't run off the
       // end of the input.
       const size_t remaining_input_bytes =
@@ -594,6 +1306,12 @@ spv_result_t Parser::parseOperand(size_t inst_offset,
       }
       parsed_operand.num_words = uint16_t(string_num_words);
       parsed_operand.type = SPV_OPERAND_TYPE_LITERAL_STRING;
+      if (_.words != _.original_words) {
+        // Literal strings are not endian converted.
+        std::copy(_.original_words + _.word_index,
+                  _.original_words + _.word_index + string_num_words,
+                  _.native_words.begin() + _.word_index);
+      }
 
       if (SpvOpExtInstImport == opcode) {
         // Record the extended instruction type for the ID for this import.
@@ -783,6 +1501,24 @@ void Parser::recordNumberType(size_t inst_offset,
 
 }  // anonymous namespace
 
+// A parser that keeps its storage across parses.
+struct spv_binary_parser_t {
+  explicit spv_binary_parser_t(const spv_const_context context_arg)
+      : context(*context_arg),
+        consumer(context_arg->consumer),
+        parser(&context, nullptr, nullptr,
+               static_cast<spv_parsed_instruction_fn_t>(nullptr)) {
+    parser.reuseStorage();
+  }
+
+  // The context used by the parser.  Its message consumer is replaced for
+  // each parse that is given a diagnostic.
+  spv_context_t context;
+  // The message consumer of the context the parser was created with.
+  const spvtools::MessageConsumer consumer;
+  Parser parser;
+};
+
 spv_result_t spvBinaryParse(const spv_const_context context, void* user_data,
                             const uint32_t* code, const size_t num_words,
                             spv_parsed_header_fn_t parsed_header,
@@ -797,6 +1533,127 @@ spv_result_t spvBinaryParse(const spv_const_context context, void* user_data,
   return parser.parse(code, num_words, diagnostic);
 }
 
+spv_result_t spvBinaryParseParallel(
+    const spv_const_context context, void* user_data, const uint32_t* code,
+    const size_t num_words, spv_parsed_header_fn_t parsed_header,
+    spv_parsed_instruction_fn_t parsed_instruction, uint32_t num_threads,
+    spv_diagnostic* diagnostic) {
+  spv_context_t hijack_context = *context;
+  if (diagnostic) {
+    *diagnostic = nullptr;
+    spvtools::UseDiagnosticAsMessageConsumer(&hijack_context, diagnostic);
+  }
+
+  {
+    // Decode without a message consumer.  If decoding fails, the sequential
+    // parse below issues the diagnostic.
+    spv_context_t silent_context = hijack_context;
+    silent_context.consumer = nullptr;
+    Parser decoder(&silent_context, nullptr, nullptr,
+                   static_cast<spv_parsed_instruction_fn_t>(nullptr));
+    std::vector<DecodedInstructions> decoded;
+    if (decoder.decodeModule(code, num_words, num_threads, &decoded) ==
+        SPV_SUCCESS) {
+      Parser parser(&hijack_context, user_data, parsed_header,
+                    parsed_instruction);
+      return parser.issueDecoded(code, num_words, &decoded);
+    }
+  }
+
+  Parser parser(&hijack_context, user_data, parsed_header, parsed_instruction);
+  return parser.parse(code, num_words, diagnostic);
+}
+
+spv_result_t spvBinaryParseBatched(
+    const spv_const_context context, void* user_data, const uint32_t* code,
+    const size_t num_words, spv_parsed_header_fn_t parsed_header,
+    spv_parsed_instruction_batch_fn_t parsed_instructions, size_t batch_size,
+    spv_diagnostic* diagnostic) {
+  spv_context_t hijack_context = *context;
+  if (diagnostic) {
+    *diagnostic = nullptr;
+    spvtools::UseDiagnosticAsMessageConsumer(&hijack_context, diagnostic);
+  }
+  if (!parsed_instructions) {
+    Parser parser(&hijack_context, user_data, parsed_header,
+                  static_cast<spv_parsed_instruction_fn_t>(nullptr));
+    return parser.parse(code, num_words, diagnostic);
+  }
+  // Large enough to amortize the callback, small enough to stay in cache.
+  const size_t kDefaultBatchSize = 256;
+  Parser parser(&hijack_context, user_data, parsed_header, parsed_instructions,
+                batch_size ? batch_size : kDefaultBatchSize);
+  return parser.parse(code, num_words, diagnostic);
+}
+
+spv_result_t spvBinaryParseView(const spv_const_context context,
+                                void* user_data, const uint32_t* code,
+                                const size_t num_words,
+                                spv_parsed_header_fn_t parsed_header,
+                                spv_instruction_view_fn_t parsed_view,
+                                spv_diagnostic* diagnostic) {
+  spv_context_t hijack_context = *context;
+  if (diagnostic) {
+    *diagnostic = nullptr;
+    spvtools::UseDiagnosticAsMessageConsumer(&hijack_context, diagnostic);
+  }
+  Parser parser(&hijack_context, user_data, parsed_header, parsed_view);
+  return parser.parse(code, num_words, diagnostic);
+}
+
+spv_binary_parser spvBinaryParserCreate(const spv_const_context context) {
+  if (!context) return nullptr;
+  return new spv_binary_parser_t(context);
+}
+
+void spvBinaryParserDestroy(spv_binary_parser parser) { delete parser; }
+
+spv_result_t spvBinaryParserParse(
+    spv_binary_parser parser, void* user_data, const uint32_t* code,
+    const size_t num_words, spv_parsed_header_fn_t parsed_header,
+    spv_parsed_instruction_fn_t parsed_instruction,
+    spv_diagnostic* diagnostic) {
+  if (!parser) return SPV_ERROR_INVALID_POINTER;
+  parser->context.consumer = parser->consumer;
+  if (diagnostic) {
+    *diagnostic = nullptr;
+    spvtools::UseDiagnosticAsMessageConsumer(&parser->context, diagnostic);
+  }
+  parser->parser.setCallbacks(user_data, parsed_header, parsed_instruction);
+  return parser->parser.parse(code, num_words, diagnostic);
+}
+
+spv_result_t spvBinaryParserBegin(spv_binary_parser parser, void* user_data,
+                                  const uint32_t* header,
+                                  spv_parsed_header_fn_t parsed_header,
+                                  spv_parsed_instruction_fn_t parsed_instruction,
+                                  spv_diagnostic* diagnostic) {
+  if (!parser) return SPV_ERROR_INVALID_POINTER;
+  parser->context.consumer = parser->consumer;
+  if (diagnostic) {
+    *diagnostic = nullptr;
+    spvtools::UseDiagnosticAsMessageConsumer(&parser->context, diagnostic);
+  }
+  parser->parser.setCallbacks(user_data, parsed_header, parsed_instruction);
+  return parser->parser.begin(header, diagnostic);
+}
+
+spv_result_t spvBinaryParserParseInstruction(spv_binary_parser parser,
+                                             const uint32_t* words,
+                                             size_t num_words) {
+  if (!parser) return SPV_ERROR_INVALID_POINTER;
+  return parser->parser.parseNext(words, num_words);
+}
+
+spv_result_t spvInstructionViewDecode(
+    const spv_instruction_view_t* instruction_view,
+    spv_parsed_instruction_t* parsed_instruction) {
+  if (!instruction_view || !instruction_view->parser)
+    return SPV_ERROR_INVALID_POINTER;
+  return static_cast<Parser*>(instruction_view->parser)
+      ->decodeView(instruction_view, parsed_instruction);
+}
+
 // TODO(dneto): This probably belongs in text.cpp since that's the only place
 // that a spv_binary_t value is created.
 void spvBinaryDestroy(spv_binary binary) {
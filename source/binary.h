@@ -27,6 +27,25 @@ spv_result_t spvBinaryHeaderGet(const spv_const_binary binary,
                                 const spv_endianness_t endian,
                                 spv_header_t* header);
 
+// Starts parsing a module with the given parser, where the module is supplied
+// one instruction at a time to spvBinaryParserParseInstruction rather than as
+// a whole binary.  The header is given by the first SPV_INDEX_INSTRUCTION
+// words of header, and the module must be in host native endianness.  The
+// callbacks and diagnostic are used as by spvBinaryParserParse, until the
+// parser is used for another module.
+spv_result_t spvBinaryParserBegin(spv_binary_parser parser, void* user_data,
+                                  const uint32_t* header,
+                                  spv_parsed_header_fn_t parse_header,
+                                  spv_parsed_instruction_fn_t parse_instruction,
+                                  spv_diagnostic* diagnostic);
+
+// Parses the next instruction of the module started by spvBinaryParserBegin.
+// The instruction must be exactly the num_words words at words.  It is
+// decoded and checked exactly as it would be in the binary of the module.
+spv_result_t spvBinaryParserParseInstruction(spv_binary_parser parser,
+                                             const uint32_t* words,
+                                             size_t num_words);
+
 // Returns the number of non-null characters in str before the first null
 // character, or strsz if there is no null character.  Examines at most the
 // first strsz characters in str.  Returns 0 if str is nullptr.  This is a
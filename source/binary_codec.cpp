@@ -0,0 +1,428 @@
+// Copyright (c) 2020 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// The compact encoding of SPIR-V binaries of spvBinaryEncode.
+//
+// An encoded binary starts with the bytes "SPVZ" and the version of the
+// format, followed by the number of words of the module and the words of the
+// header after the magic number.  Then each instruction is written as its
+// opcode, the difference between its word count and the one the grammar
+// predicts, and its operand words.  The grammar also predicts the kind of
+// each operand word from the opcode and the words before it:
+//  - a result id is written relative to the previous result id plus one,
+//  - another id relative to the latest result id,
+//  - a word of a literal string as its four bytes,
+//  - any other word as is.
+// Numbers are written as LEB128 varints, and differences are zigzag encoded
+// so that small negative ones stay short.  The encoder and the decoder make
+// the same predictions from the same words, so a wrong prediction only costs
+// space, and every binary is decoded exactly as it was encoded.
+
+#include <cstdint>
+#include <cstring>
+#include <limits>
+#include <memory>
+#include <vector>
+
+#include "source/diagnostic.h"
+#include "source/opcode.h"
+#include "source/operand.h"
+#include "source/spirv_constant.h"
+#include "source/table.h"
+#include "spirv-tools/libspirv.h"
+
+namespace {
+
+const uint8_t kEncodedMagic[] = {'S', 'P', 'V', 'Z'};
+const uint8_t kEncodedVersion = 1;
+// The size of the magic bytes and the version.
+const size_t kPrefixSize = sizeof(kEncodedMagic) + 1;
+
+// The grammar is looked up for a fixed environment, so that the encoding
+// does not depend on the environment of the context.
+const spv_target_env kGrammarEnv = SPV_ENV_UNIVERSAL_1_5;
+
+// The kinds of operand words, which are encoded differently.
+enum class WordKind { kResultId, kId, kString, kOther };
+
+// Returns true if operands of |type| are literal numbers, and so have no
+// entry in the operand table.
+bool IsLiteralNumber(spv_operand_type_t type) {
+  switch (type) {
+    case SPV_OPERAND_TYPE_LITERAL_INTEGER:
+    case SPV_OPERAND_TYPE_LITERAL_EXT_INST_INTEGER:
+    case SPV_OPERAND_TYPE_LITERAL_SPEC_CONSTANT_OP_INTEGER:
+    case SPV_OPERAND_TYPE_LITERAL_CONTEXT_DEPENDENT_NUMBER:
+    case SPV_OPERAND_TYPE_TYPED_LITERAL_NUMBER:
+    case SPV_OPERAND_TYPE_OPTIONAL_LITERAL_INTEGER:
+    case SPV_OPERAND_TYPE_OPTIONAL_TYPED_LITERAL_INTEGER:
+    case SPV_OPERAND_TYPE_OPTIONAL_CIV:
+      return true;
+    default:
+      return false;
+  }
+}
+
+// Predicts the kind of each word of an instruction from the grammar, as the
+// binary parser would find it, but without checking anything.
+class WordKindPredictor {
+ public:
+  WordKindPredictor(const spv_opcode_table opcode_table,
+                    const spv_operand_table operand_table)
+      : opcode_table_(opcode_table),
+        operand_table_(operand_table),
+        type_(SPV_OPERAND_TYPE_NONE),
+        in_string_(false) {}
+
+  // Starts an instruction with |opcode|.  Returns the word count the grammar
+  // predicts for it: one word for each operand that is always present.
+  uint32_t Begin(uint32_t opcode) {
+    expected_.clear();
+    type_ = SPV_OPERAND_TYPE_NONE;
+    in_string_ = false;
+    spv_opcode_desc desc = nullptr;
+    if (spvOpcodeTableValueLookup(kGrammarEnv, opcode_table_,
+                                  static_cast<SpvOp>(opcode),
+                                  &desc) != SPV_SUCCESS) {
+      return 1;
+    }
+    spvPushOperandTypes(desc->operandTypes, &expected_);
+    uint32_t word_count = 1;
+    for (uint16_t i = 0; i < desc->numTypes; ++i) {
+      const spv_operand_type_t type = desc->operandTypes[i];
+      if (!spvOperandIsOptional(type) && !spvOperandIsVariable(type)) {
+        ++word_count;
+      }
+    }
+    return word_count;
+  }
+
+  // Returns the kind of the next word of the instruction.
+  WordKind Next() {
+    if (in_string_) return WordKind::kString;
+    if (expected_.empty()) {
+      type_ = SPV_OPERAND_TYPE_NONE;
+      return WordKind::kOther;
+    }
+    type_ = spvTakeFirstMatchableOperand(&expected_);
+    if (type_ == SPV_OPERAND_TYPE_RESULT_ID) return WordKind::kResultId;
+    if (spvIsIdType(type_) || type_ == SPV_OPERAND_TYPE_OPTIONAL_ID) {
+      return WordKind::kId;
+    }
+    if (type_ == SPV_OPERAND_TYPE_LITERAL_STRING ||
+        type_ == SPV_OPERAND_TYPE_OPTIONAL_LITERAL_STRING) {
+      in_string_ = true;
+      return WordKind::kString;
+    }
+    return WordKind::kOther;
+  }
+
+  // Takes the value |word| of the word whose kind Next returned into
+  // account: the end of a string, or the operands an enumerant or a mask
+  // adds.
+  void Consume(uint32_t word) {
+    if (in_string_) {
+      // The string ends with the word holding its null terminator.
+      for (int shift = 0; shift < 32; shift += 8) {
+        if (((word >> shift) & 0xff) == 0) in_string_ = false;
+      }
+      return;
+    }
+    if (type_ == SPV_OPERAND_TYPE_NONE || IsLiteralNumber(type_) ||
+        spvIsIdType(type_) || type_ == SPV_OPERAND_TYPE_OPTIONAL_ID) {
+      return;
+    }
+
+    if (type_ == SPV_OPERAND_TYPE_SPEC_CONSTANT_OP_NUMBER) {
+      // The operands of the operation, after its type and result ids.
+      spv_opcode_desc desc = nullptr;
+      if (spvOpcodeTableValueLookup(kGrammarEnv, opcode_table_,
+                                    static_cast<SpvOp>(word),
+                                    &desc) == SPV_SUCCESS &&
+          desc->numTypes >= 2) {
+        spvPushOperandTypes(desc->operandTypes + 2, &expected_);
+      }
+      return;
+    }
+
+    spv_operand_type_t type = type_;
+    if (type == SPV_OPERAND_TYPE_OPTIONAL_IMAGE) {
+      type = SPV_OPERAND_TYPE_IMAGE;
+    } else if (type == SPV_OPERAND_TYPE_OPTIONAL_MEMORY_ACCESS) {
+      type = SPV_OPERAND_TYPE_MEMORY_ACCESS;
+    } else if (type == SPV_OPERAND_TYPE_OPTIONAL_ACCESS_QUALIFIER) {
+      type = SPV_OPERAND_TYPE_ACCESS_QUALIFIER;
+    }
+    if (spvOperandIsConcreteMask(type)) {
+      spvPushOperandTypesForMask(kGrammarEnv, operand_table_, type, word,
+                                 &expected_);
+      return;
+    }
+    spv_operand_desc entry = nullptr;
+    if (spvOperandTableValueLookup(kGrammarEnv, operand_table_, type, word,
+                                   &entry) == SPV_SUCCESS) {
+      spvPushOperandTypes(entry->operandTypes, &expected_);
+    }
+  }
+
+ private:
+  const spv_opcode_table opcode_table_;
+  const spv_operand_table operand_table_;
+  // The operands still expected, in reverse order.
+  spv_operand_pattern_t expected_;
+  // The operand type of the word last returned by Next.
+  spv_operand_type_t type_;
+  // True if the next word continues a literal string.
+  bool in_string_;
+};
+
+// Returns |difference| zigzag encoded: 0, -1, 1, -2, ... become 0, 1, 2,
+// 3, ...
+uint32_t Zigzag(uint32_t difference) {
+  return (difference << 1) ^ (0u - (difference >> 31));
+}
+
+// Returns the difference zigzag encoded as |value|.
+uint32_t Unzigzag(uint32_t value) { return (value >> 1) ^ (0u - (value & 1)); }
+
+// Appends |value| to |out| as a LEB128 varint.
+void WriteVarint(uint32_t value, std::vector<uint8_t>* out) {
+  while (value >= 0x80) {
+    out->push_back(static_cast<uint8_t>(value | 0x80));
+    value >>= 7;
+  }
+  out->push_back(static_cast<uint8_t>(value));
+}
+
+// Reads the bytes of an encoded binary.
+class ByteReader {
+ public:
+  ByteReader(const uint8_t* bytes, size_t num_bytes)
+      : bytes_(bytes), num_bytes_(num_bytes), offset_(0) {}
+
+  // Reads a LEB128 varint into |value|.  Returns false if the bytes end
+  // first, or if the value does not fit in 32 bits.
+  bool ReadVarint(uint32_t* value) {
+    uint32_t result = 0;
+    for (uint32_t shift = 0; shift < 35; shift += 7) {
+      if (offset_ == num_bytes_) return false;
+      const uint8_t byte = bytes_[offset_++];
+      if (shift == 28 && byte > 0x0f) return false;
+      result |= static_cast<uint32_t>(byte & 0x7f) << shift;
+      if ((byte & 0x80) == 0) {
+        *value = result;
+        return true;
+      }
+    }
+    return false;
+  }
+
+  // Reads a word written as its four bytes, least significant first.
+  bool ReadRawWord(uint32_t* word) {
+    if (num_bytes_ - offset_ < 4) return false;
+    const uint8_t* bytes = bytes_ + offset_;
+    *word = static_cast<uint32_t>(bytes[0]) |
+            static_cast<uint32_t>(bytes[1]) << 8 |
+            static_cast<uint32_t>(bytes[2]) << 16 |
+            static_cast<uint32_t>(bytes[3]) << 24;
+    offset_ += 4;
+    return true;
+  }
+
+  size_t offset() const { return offset_; }
+  size_t remaining() const { return num_bytes_ - offset_; }
+
+ private:
+  const uint8_t* bytes_;
+  const size_t num_bytes_;
+  size_t offset_;
+};
+
+}  // namespace
+
+spv_result_t spvBinaryEncode(const spv_const_context context,
+                             const uint32_t* words, const size_t num_words,
+                             spv_encoded_binary* encoded,
+                             spv_diagnostic* diagnostic) {
+  if (!context || !encoded) return SPV_ERROR_INVALID_POINTER;
+  spv_context_t hijack_context = *context;
+  if (diagnostic) {
+    *diagnostic = nullptr;
+    spvtools::UseDiagnosticAsMessageConsumer(&hijack_context, diagnostic);
+  }
+  auto error = [&hijack_context](size_t index) {
+    return spvtools::DiagnosticStream({0, 0, index}, hijack_context.consumer,
+                                      "", SPV_ERROR_INVALID_BINARY);
+  };
+
+  if (!words || num_words < SPV_INDEX_INSTRUCTION ||
+      words[0] != SpvMagicNumber) {
+    return error(0) << "Invalid SPIR-V magic number; the binary must be in "
+                       "host endianness.";
+  }
+  if (num_words > std::numeric_limits<uint32_t>::max()) {
+    return error(0) << "The binary is too large to encode.";
+  }
+
+  std::vector<uint8_t> out;
+  // Most words take one or two bytes.
+  out.reserve(num_words * 2);
+  out.insert(out.end(), kEncodedMagic, kEncodedMagic + sizeof(kEncodedMagic));
+  out.push_back(kEncodedVersion);
+  WriteVarint(static_cast<uint32_t>(num_words), &out);
+  for (size_t i = 1; i < SPV_INDEX_INSTRUCTION; ++i) {
+    WriteVarint(words[i], &out);
+  }
+
+  WordKindPredictor predictor(hijack_context.opcode_table,
+                              hijack_context.operand_table);
+  uint32_t last_result_id = 0;
+  for (size_t index = SPV_INDEX_INSTRUCTION; index < num_words;) {
+    const uint32_t word_count = words[index] >> 16;
+    const uint32_t opcode = words[index] & 0xffff;
+    if (word_count == 0 || word_count > num_words - index) {
+      return error(index) << "Invalid word count " << word_count
+                          << " for the instruction at word " << index << ".";
+    }
+    WriteVarint(opcode, &out);
+    WriteVarint(Zigzag(word_count - predictor.Begin(opcode)), &out);
+    for (size_t i = index + 1; i < index + word_count; ++i) {
+      const uint32_t word = words[i];
+      switch (predictor.Next()) {
+        case WordKind::kResultId:
+          WriteVarint(Zigzag(word - (last_result_id + 1)), &out);
+          last_result_id = word;
+          break;
+        case WordKind::kId:
+          WriteVarint(Zigzag(word - last_result_id), &out);
+          break;
+        case WordKind::kString:
+          for (int shift = 0; shift < 32; shift += 8) {
+            out.push_back(static_cast<uint8_t>(word >> shift));
+          }
+          break;
+        case WordKind::kOther:
+          WriteVarint(word, &out);
+          break;
+      }
+      predictor.Consume(word);
+    }
+    index += word_count;
+  }
+
+  std::unique_ptr<uint8_t[]> bytes(new uint8_t[out.size()]);
+  memcpy(bytes.get(), out.data(), out.size());
+  *encoded = new spv_encoded_binary_t{bytes.release(), out.size()};
+  return SPV_SUCCESS;
+}
+
+spv_result_t spvBinaryDecode(const spv_const_context context,
+                             const uint8_t* bytes, const size_t num_bytes,
+                             spv_binary* binary, spv_diagnostic* diagnostic) {
+  if (!context || !binary) return SPV_ERROR_INVALID_POINTER;
+  spv_context_t hijack_context = *context;
+  if (diagnostic) {
+    *diagnostic = nullptr;
+    spvtools::UseDiagnosticAsMessageConsumer(&hijack_context, diagnostic);
+  }
+  auto error = [&hijack_context](size_t offset) {
+    return spvtools::DiagnosticStream({0, 0, offset}, hijack_context.consumer,
+                                      "", SPV_ERROR_INVALID_BINARY);
+  };
+
+  if (!bytes || num_bytes < kPrefixSize ||
+      memcmp(bytes, kEncodedMagic, sizeof(kEncodedMagic)) != 0) {
+    return error(0) << "Not an encoded SPIR-V binary.";
+  }
+  if (bytes[sizeof(kEncodedMagic)] != kEncodedVersion) {
+    return error(sizeof(kEncodedMagic))
+           << "Unsupported encoding version "
+           << static_cast<uint32_t>(bytes[sizeof(kEncodedMagic)]) << ".";
+  }
+
+  ByteReader reader(bytes + kPrefixSize, num_bytes - kPrefixSize);
+  auto truncated = [&error, &reader]() -> spv_result_t {
+    return error(kPrefixSize + reader.offset())
+           << "The encoded binary is truncated or corrupt.";
+  };
+
+  uint32_t num_words = 0;
+  // Every word but the magic number takes at least one byte, which bounds
+  // the memory a corrupt count can make us allocate.
+  if (!reader.ReadVarint(&num_words) || num_words < SPV_INDEX_INSTRUCTION ||
+      num_words - 1 > reader.remaining()) {
+    return truncated();
+  }
+  std::unique_ptr<uint32_t[]> code(new uint32_t[num_words]);
+  code[0] = SpvMagicNumber;
+  for (size_t i = 1; i < SPV_INDEX_INSTRUCTION; ++i) {
+    if (!reader.ReadVarint(&code[i])) return truncated();
+  }
+
+  WordKindPredictor predictor(hijack_context.opcode_table,
+                              hijack_context.operand_table);
+  uint32_t last_result_id = 0;
+  for (size_t index = SPV_INDEX_INSTRUCTION; index < num_words;) {
+    uint32_t opcode = 0;
+    uint32_t word_count_difference = 0;
+    if (!reader.ReadVarint(&opcode) || opcode > 0xffff ||
+        !reader.ReadVarint(&word_count_difference)) {
+      return truncated();
+    }
+    const uint32_t word_count =
+        predictor.Begin(opcode) + Unzigzag(word_count_difference);
+    if (word_count == 0 || word_count > 0xffff ||
+        word_count > num_words - index) {
+      return truncated();
+    }
+    code[index] = word_count << 16 | opcode;
+    for (size_t i = index + 1; i < index + word_count; ++i) {
+      uint32_t value = 0;
+      const WordKind kind = predictor.Next();
+      const bool read = kind == WordKind::kString
+                            ? reader.ReadRawWord(&value)
+                            : reader.ReadVarint(&value);
+      if (!read) return truncated();
+      switch (kind) {
+        case WordKind::kResultId:
+          value = Unzigzag(value) + last_result_id + 1;
+          last_result_id = value;
+          break;
+        case WordKind::kId:
+          value = Unzigzag(value) + last_result_id;
+          break;
+        case WordKind::kString:
+        case WordKind::kOther:
+          break;
+      }
+      code[i] = value;
+      predictor.Consume(value);
+    }
+    index += word_count;
+  }
+  if (reader.remaining() != 0) {
+    return error(kPrefixSize + reader.offset())
+           << "Unexpected bytes after the encoded binary.";
+  }
+
+  *binary = new spv_binary_t{code.release(), num_words};
+  return SPV_SUCCESS;
+}
+
+void spvEncodedBinaryDestroy(spv_encoded_binary encoded) {
+  if (encoded) {
+    delete[] encoded->bytes;
+    delete encoded;
+  }
+}
@@ -0,0 +1,483 @@
+// Copyright (c) 2020 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// The index of the instructions of a SPIR-V binary of spvBinaryIndexBuild.
+//
+// The index holds the offset of every 64th instruction, from which any
+// instruction is found by following at most 63 word counts, and the offsets
+// of the functions and of their blocks.  It is saved as the words "SPIX" and
+// the version of the format, followed by the number of words of the binary,
+// the end of its global section, a hash of the words before that end, the
+// number of instructions, functions and blocks, and then the offsets of the
+// instructions, the functions and the blocks.
+
+#include "source/binary_index.h"
+
+#include <algorithm>
+#include <limits>
+#include <memory>
+
+#include "source/binary.h"
+#include "source/diagnostic.h"
+#include "source/spirv_constant.h"
+
+namespace {
+
+const uint32_t kIndexMagic = 0x58495053;  // "SPIX" in little endian.
+const uint32_t kIndexVersion = 1;
+// The number of words before the offsets in a saved index.
+const size_t kSavedHeaderSize = 8;
+// The number of words of a function and of a block in a saved index.
+const size_t kSavedFunctionSize = 5;
+const size_t kSavedBlockSize = 2;
+const uint32_t kInstructionsPerCheckpoint = 64;
+
+// Returns the FNV-1a hash of the |num_words| words at |words|.
+uint32_t HashWords(const uint32_t* words, size_t num_words) {
+  uint32_t hash = 2166136261u;
+  for (size_t i = 0; i < num_words; ++i) {
+    hash = (hash ^ words[i]) * 16777619u;
+  }
+  return hash;
+}
+
+// Returns the number of checkpoints of |num_instructions| instructions.
+size_t NumCheckpoints(size_t num_instructions) {
+  return (num_instructions + kInstructionsPerCheckpoint - 1) /
+         kInstructionsPerCheckpoint;
+}
+
+// Returns true if the offsets of |index| are consistent with each other and
+// with the size of its binary, so that a loaded index cannot make lookups go
+// out of bounds.
+bool IsConsistent(const spv_binary_index_t& index) {
+  if (index.num_words < SPV_INDEX_INSTRUCTION ||
+      index.globals_end < SPV_INDEX_INSTRUCTION ||
+      index.globals_end > index.num_words) {
+    return false;
+  }
+  uint32_t last = 0;
+  for (uint32_t offset : index.checkpoints) {
+    if (offset <= last || offset >= index.num_words) return false;
+    last = offset;
+  }
+  uint32_t function_end = index.globals_end;
+  uint32_t next_block = 0;
+  for (const auto& function : index.functions) {
+    if (function.begin < function_end || function.end_inst <= function.begin ||
+        function.end <= function.end_inst || function.end > index.num_words ||
+        function.first_block != next_block) {
+      return false;
+    }
+    for (; next_block < index.blocks.size() &&
+           index.blocks[next_block].begin < function.end;
+         ++next_block) {
+      const uint32_t begin = index.blocks[next_block].begin;
+      if (begin <= function.begin || begin >= function.end_inst) return false;
+    }
+    function_end = function.end;
+  }
+  return next_block == index.blocks.size();
+}
+
+// Returns the offset past the last block of |function| in |index|.
+uint32_t BlocksEnd(const spv_binary_index_t& index, size_t function) {
+  return function + 1 < index.functions.size()
+             ? index.functions[function + 1].first_block
+             : static_cast<uint32_t>(index.blocks.size());
+}
+
+// The state of a ParseBinaryRange call, passed to the parser callbacks.
+struct RangeParse {
+  void* header_user_data;
+  spv_parsed_header_fn_t parse_header;
+  const spvtools::BinaryRangeInstructionFn* parse_instruction;
+  // The offset of the instruction being parsed, and of the range.
+  size_t offset;
+  size_t begin;
+};
+
+spv_result_t ParseRangeHeader(void* user_data, spv_endianness_t endian,
+                              uint32_t magic, uint32_t version,
+                              uint32_t generator, uint32_t id_bound,
+                              uint32_t schema) {
+  const RangeParse* state = static_cast<const RangeParse*>(user_data);
+  if (!state->parse_header) return SPV_SUCCESS;
+  return state->parse_header(state->header_user_data, endian, magic, version,
+                             generator, id_bound, schema);
+}
+
+spv_result_t ParseRangeInstruction(void* user_data,
+                                   const spv_parsed_instruction_t* inst) {
+  const RangeParse* state = static_cast<const RangeParse*>(user_data);
+  return (*state->parse_instruction)(*inst, state->offset,
+                                     state->offset >= state->begin);
+}
+
+// The arguments of spvBinaryParseRange, passed to its instruction callback.
+struct ParseRangeArguments {
+  void* user_data;
+  spv_parsed_instruction_fn_t parse_instruction;
+};
+
+}  // namespace
+
+spv_result_t spvBinaryIndexBuild(const spv_const_context context,
+                                 const uint32_t* words, const size_t num_words,
+                                 spv_binary_index* index,
+                                 spv_diagnostic* diagnostic) {
+  if (!context || !index) return SPV_ERROR_INVALID_POINTER;
+  spv_context_t hijack_context = *context;
+  if (diagnostic) {
+    *diagnostic = nullptr;
+    spvtools::UseDiagnosticAsMessageConsumer(&hijack_context, diagnostic);
+  }
+  auto error = [&hijack_context](size_t offset) {
+    return spvtools::DiagnosticStream({0, 0, offset}, hijack_context.consumer,
+                                      "", SPV_ERROR_INVALID_BINARY);
+  };
+
+  if (!words || num_words < SPV_INDEX_INSTRUCTION ||
+      words[0] != SpvMagicNumber) {
+    return error(0) << "Invalid SPIR-V magic number; the binary must be in "
+                       "host endianness.";
+  }
+  if (num_words > std::numeric_limits<uint32_t>::max()) {
+    return error(0) << "The binary is too large to index.";
+  }
+
+  std::unique_ptr<spv_binary_index_t> result(new spv_binary_index_t());
+  result->num_words = static_cast<uint32_t>(num_words);
+  result->globals_end = result->num_words;
+  uint32_t num_instructions = 0;
+  bool in_function = false;
+  for (uint32_t offset = SPV_INDEX_INSTRUCTION; offset < num_words;) {
+    const uint32_t word_count = words[offset] >> 16;
+    const uint32_t opcode = words[offset] & 0xffff;
+    if (word_count == 0 || word_count > num_words - offset) {
+      return error(offset) << "Invalid word count " << word_count
+                           << " for the instruction at word " << offset
+                           << ".";
+    }
+    if (num_instructions % kInstructionsPerCheckpoint == 0) {
+      result->checkpoints.push_back(offset);
+    }
+    ++num_instructions;
+
+    switch (opcode) {
+      case SpvOpFunction:
+        if (in_function) {
+          return error(offset) << "Missing OpFunctionEnd before the "
+                                  "OpFunction at word "
+                               << offset << ".";
+        }
+        if (word_count < 3) {
+          return error(offset) << "Invalid OpFunction at word " << offset
+                               << ".";
+        }
+        if (result->functions.empty()) result->globals_end = offset;
+        result->functions.push_back(
+            {words[offset + 2], offset, 0, 0,
+             static_cast<uint32_t>(result->blocks.size())});
+        in_function = true;
+        break;
+      case SpvOpLabel:
+        if (!in_function || word_count < 2) {
+          return error(offset) << "Invalid OpLabel at word " << offset
+                               << " outside of a function.";
+        }
+        result->blocks.push_back({words[offset + 1], offset});
+        break;
+      case SpvOpFunctionEnd:
+        if (!in_function) {
+          return error(offset) << "Invalid OpFunctionEnd at word " << offset
+                               << " outside of a function.";
+        }
+        result->functions.back().end_inst = offset;
+        result->functions.back().end = offset + word_count;
+        in_function = false;
+        break;
+      default:
+        break;
+    }
+    offset += word_count;
+  }
+  if (in_function) {
+    return error(num_words) << "Missing OpFunctionEnd at the end of the "
+                               "binary.";
+  }
+
+  result->num_instructions = num_instructions;
+  result->globals_hash = HashWords(words, result->globals_end);
+  *index = result.release();
+  return SPV_SUCCESS;
+}
+
+spv_result_t spvBinaryIndexSave(spv_const_binary_index index,
+                                spv_binary* index_words) {
+  if (!index || !index_words) return SPV_ERROR_INVALID_POINTER;
+  std::vector<uint32_t> out = {
+      kIndexMagic,
+      kIndexVersion,
+      index->num_words,
+      index->globals_end,
+      index->globals_hash,
+      index->num_instructions,
+      static_cast<uint32_t>(index->functions.size()),
+      static_cast<uint32_t>(index->blocks.size())};
+  out.insert(out.end(), index->checkpoints.begin(), index->checkpoints.end());
+  for (const auto& function : index->functions) {
+    out.insert(out.end(), {function.id, function.begin, function.end_inst,
+                           function.end, function.first_block});
+  }
+  for (const auto& block : index->blocks) {
+    out.insert(out.end(), {block.id, block.begin});
+  }
+
+  std::unique_ptr<uint32_t[]> code(new uint32_t[out.size()]);
+  std::copy(out.begin(), out.end(), code.get());
+  *index_words = new spv_binary_t{code.release(), out.size()};
+  return SPV_SUCCESS;
+}
+
+spv_result_t spvBinaryIndexLoad(const spv_const_context context,
+                                const uint32_t* index_words,
+                                const size_t num_index_words,
+                                const uint32_t* words, const size_t num_words,
+                                spv_binary_index* index,
+                                spv_diagnostic* diagnostic) {
+  if (!context || !index) return SPV_ERROR_INVALID_POINTER;
+  spv_context_t hijack_context = *context;
+  if (diagnostic) {
+    *diagnostic = nullptr;
+    spvtools::UseDiagnosticAsMessageConsumer(&hijack_context, diagnostic);
+  }
+  auto error = [&hijack_context]() {
+    return spvtools::DiagnosticStream({0, 0, 0}, hijack_context.consumer, "",
+                                      SPV_ERROR_INVALID_BINARY);
+  };
+
+  if (!index_words || num_index_words < kSavedHeaderSize ||
+      index_words[0] != kIndexMagic) {
+    return error() << "Not a SPIR-V binary index.";
+  }
+  if (index_words[1] != kIndexVersion) {
+    return error() << "Unsupported index version " << index_words[1] << ".";
+  }
+
+  std::unique_ptr<spv_binary_index_t> result(new spv_binary_index_t());
+  result->num_words = index_words[2];
+  result->globals_end = index_words[3];
+  result->globals_hash = index_words[4];
+  result->num_instructions = index_words[5];
+  const size_t num_functions = index_words[6];
+  const size_t num_blocks = index_words[7];
+  const size_t num_checkpoints = NumCheckpoints(result->num_instructions);
+  // The counts are checked one at a time, so that they cannot overflow.
+  const size_t remaining = num_index_words - kSavedHeaderSize;
+  if (num_checkpoints > remaining ||
+      num_functions > (remaining - num_checkpoints) / kSavedFunctionSize ||
+      num_blocks * kSavedBlockSize !=
+          remaining - num_checkpoints - num_functions * kSavedFunctionSize) {
+    return error() << "The index is truncated or corrupt.";
+  }
+
+  const uint32_t* in = index_words + kSavedHeaderSize;
+  result->checkpoints.assign(in, in + num_checkpoints);
+  in += num_checkpoints;
+  for (size_t i = 0; i < num_functions; ++i, in += kSavedFunctionSize) {
+    result->functions.push_back({in[0], in[1], in[2], in[3], in[4]});
+  }
+  for (size_t i = 0; i < num_blocks; ++i, in += kSavedBlockSize) {
+    result->blocks.push_back({in[0], in[1]});
+  }
+  if (!IsConsistent(*result) ||
+      result->num_instructions < result->functions.size() * 2) {
+    return error() << "The index is truncated or corrupt.";
+  }
+
+  if (!words || result->num_words != num_words ||
+      result->globals_hash != HashWords(words, result->globals_end)) {
+    return error() << "The index was built for another binary.";
+  }
+  *index = result.release();
+  return SPV_SUCCESS;
+}
+
+void spvBinaryIndexDestroy(spv_binary_index index) { delete index; }
+
+size_t spvBinaryIndexInstructionCount(spv_const_binary_index index) {
+  return index ? index->num_instructions : 0;
+}
+
+spv_result_t spvBinaryIndexFindInstruction(spv_const_binary_index index,
+                                           const uint32_t* words,
+                                           const size_t instruction,
+                                           size_t* offset) {
+  if (!index || !words || !offset) return SPV_ERROR_INVALID_POINTER;
+  if (instruction >= index->num_instructions) return SPV_ERROR_INVALID_LOOKUP;
+
+  size_t current = index->checkpoints[instruction / kInstructionsPerCheckpoint];
+  for (size_t i = instruction % kInstructionsPerCheckpoint; i > 0; --i) {
+    const uint32_t word_count = words[current] >> 16;
+    if (word_count == 0 || word_count >= index->num_words - current) {
+      return SPV_ERROR_INVALID_BINARY;
+    }
+    current += word_count;
+  }
+  *offset = current;
+  return SPV_SUCCESS;
+}
+
+spv_result_t spvBinaryIndexGetGlobalSection(spv_const_binary_index index,
+                                            spv_binary_range_t* range) {
+  if (!index || !range) return SPV_ERROR_INVALID_POINTER;
+  *range = {0, SPV_INDEX_INSTRUCTION, index->globals_end};
+  return SPV_SUCCESS;
+}
+
+size_t spvBinaryIndexFunctionCount(spv_const_binary_index index) {
+  return index ? index->functions.size() : 0;
+}
+
+spv_result_t spvBinaryIndexGetFunction(spv_const_binary_index index,
+                                       const size_t function,
+                                       spv_binary_range_t* range) {
+  if (!index || !range) return SPV_ERROR_INVALID_POINTER;
+  if (function >= index->functions.size()) return SPV_ERROR_INVALID_LOOKUP;
+  const auto& entry = index->functions[function];
+  *range = {entry.id, entry.begin, entry.end};
+  return SPV_SUCCESS;
+}
+
+size_t spvBinaryIndexBlockCount(spv_const_binary_index index,
+                                const size_t function) {
+  if (!index || function >= index->functions.size()) return 0;
+  return BlocksEnd(*index, function) - index->functions[function].first_block;
+}
+
+spv_result_t spvBinaryIndexGetBlock(spv_const_binary_index index,
+                                    const size_t function, const size_t block,
+                                    spv_binary_range_t* range) {
+  if (!index || !range) return SPV_ERROR_INVALID_POINTER;
+  if (block >= spvBinaryIndexBlockCount(index, function)) {
+    return SPV_ERROR_INVALID_LOOKUP;
+  }
+  const size_t block_index = index->functions[function].first_block + block;
+  const uint32_t end = block_index + 1 < BlocksEnd(*index, function)
+                           ? index->blocks[block_index + 1].begin
+                           : index->functions[function].end_inst;
+  *range = {index->blocks[block_index].id, index->blocks[block_index].begin,
+            end};
+  return SPV_SUCCESS;
+}
+
+spv_result_t spvBinaryParseRange(
+    const spv_const_context context, void* user_data, const uint32_t* words,
+    const size_t num_words, spv_const_binary_index index, const size_t begin,
+    const size_t end, spv_parsed_header_fn_t parse_header,
+    spv_parsed_instruction_fn_t parse_instruction, spv_diagnostic* diagnostic) {
+  ParseRangeArguments arguments = {user_data, parse_instruction};
+  return spvtools::ParseBinaryRange(
+      context, words, num_words, index, begin, end, user_data, parse_header,
+      [&arguments](const spv_parsed_instruction_t& inst, size_t,
+                   bool in_range) -> spv_result_t {
+        if (!in_range || !arguments.parse_instruction) return SPV_SUCCESS;
+        return arguments.parse_instruction(arguments.user_data, &inst);
+      },
+      diagnostic);
+}
+
+namespace spvtools {
+
+spv_result_t ParseBinaryRange(const spv_const_context context,
+                              const uint32_t* words, size_t num_words,
+                              spv_const_binary_index index, size_t begin,
+                              size_t end, void* header_user_data,
+                              spv_parsed_header_fn_t parse_header,
+                              const BinaryRangeInstructionFn& parse_instruction,
+                              spv_diagnostic* diagnostic) {
+  if (!context || !words || !index) return SPV_ERROR_INVALID_POINTER;
+  spv_context_t hijack_context = *context;
+  if (diagnostic) {
+    *diagnostic = nullptr;
+    UseDiagnosticAsMessageConsumer(&hijack_context, diagnostic);
+  }
+  auto error = [&hijack_context](size_t offset) {
+    return DiagnosticStream({0, 0, offset}, hijack_context.consumer, "",
+                            SPV_ERROR_INVALID_BINARY);
+  };
+
+  if (num_words != index->num_words) {
+    return error(0) << "The index was built for another binary.";
+  }
+  if (begin < SPV_INDEX_INSTRUCTION || begin > end || end > num_words) {
+    return error(begin) << "Invalid range from word " << begin << " to word "
+                        << end << ".";
+  }
+
+  // The instructions of the range are parsed after the global section, and
+  // after those of its first function that are before it, so that they are
+  // decoded with the types of the ids they use.  A range starting between
+  // functions is parsed from the end of the function before it.
+  size_t start = SPV_INDEX_INSTRUCTION;
+  if (begin >= index->globals_end) {
+    auto next = std::upper_bound(
+        index->functions.begin(), index->functions.end(), begin,
+        [](size_t offset, const spv_binary_index_t::Function& function) {
+          return offset < function.begin;
+        });
+    start = index->globals_end;
+    if (next != index->functions.begin()) {
+      const auto& function = *(next - 1);
+      start = begin < function.end ? function.begin : function.end;
+    }
+  }
+
+  std::unique_ptr<spv_binary_parser_t, void (*)(spv_binary_parser)> parser(
+      spvBinaryParserCreate(context), spvBinaryParserDestroy);
+  RangeParse state = {header_user_data, parse_header, &parse_instruction,
+                      SPV_INDEX_INSTRUCTION, begin};
+  if (auto result =
+          spvBinaryParserBegin(parser.get(), &state, words, ParseRangeHeader,
+                               ParseRangeInstruction, diagnostic)) {
+    return result;
+  }
+  auto parse = [&parser, &state, &error, words, begin](
+                   size_t from, size_t to) -> spv_result_t {
+    for (size_t offset = from; offset < to;) {
+      const uint32_t word_count = words[offset] >> 16;
+      if (word_count == 0 || word_count > to - offset) {
+        return error(offset) << "The range does not end at an instruction.";
+      }
+      if (offset < begin && offset + word_count > begin) {
+        return error(offset) << "The range does not start at an instruction.";
+      }
+      state.offset = offset;
+      if (auto result = spvBinaryParserParseInstruction(
+              parser.get(), words + offset, word_count)) {
+        return result;
+      }
+      offset += word_count;
+    }
+    return SPV_SUCCESS;
+  };
+  if (start == SPV_INDEX_INSTRUCTION) return parse(start, end);
+  if (auto result = parse(SPV_INDEX_INSTRUCTION, index->globals_end)) {
+    return result;
+  }
+  return parse(start, end);
+}
+
+}  // namespace spvtools
@@ -0,0 +1,78 @@
+// Copyright (c) 2020 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef SOURCE_BINARY_INDEX_H_
+#define SOURCE_BINARY_INDEX_H_
+
+#include <cstdint>
+#include <functional>
+#include <vector>
+
+#include "spirv-tools/libspirv.h"
+
+// The index of a SPIR-V binary built by spvBinaryIndexBuild.  The offsets are
+// in words from the start of the binary.
+struct spv_binary_index_t {
+  struct Function {
+    uint32_t id;
+    // The offsets of the OpFunction, of the OpFunctionEnd, and past its end.
+    uint32_t begin;
+    uint32_t end_inst;
+    uint32_t end;
+    // The index in |blocks| of the first block of the function.
+    uint32_t first_block;
+  };
+
+  struct Block {
+    uint32_t id;
+    // The offset of the OpLabel.
+    uint32_t begin;
+  };
+
+  uint32_t num_words;
+  // The offset of the first function, or the size of the binary.
+  uint32_t globals_end;
+  // A hash of the header and the global section, which tells whether a saved
+  // index was built for a binary.
+  uint32_t globals_hash;
+  uint32_t num_instructions;
+  // The offset of every kInstructionsPerCheckpoint-th instruction, from the
+  // first one.
+  std::vector<uint32_t> checkpoints;
+  std::vector<Function> functions;
+  std::vector<Block> blocks;
+};
+
+namespace spvtools {
+
+// Called by ParseBinaryRange with each instruction parsed, the offset of the
+// instruction, and whether it is in the range rather than only parsed for
+// context.
+using BinaryRangeInstructionFn = std::function<spv_result_t(
+    const spv_parsed_instruction_t& inst, size_t offset, bool in_range)>;
+
+// Parses the instructions of the binary of |num_words| words at |words| as
+// spvBinaryParseRange does, but passes every instruction parsed to
+// |parse_instruction|.  |header_user_data| is passed to |parse_header|.
+spv_result_t ParseBinaryRange(const spv_const_context context,
+                              const uint32_t* words, size_t num_words,
+                              spv_const_binary_index index, size_t begin,
+                              size_t end, void* header_user_data,
+                              spv_parsed_header_fn_t parse_header,
+                              const BinaryRangeInstructionFn& parse_instruction,
+                              spv_diagnostic* diagnostic);
+
+}  // namespace spvtools
+
+#endif  // SOURCE_BINARY_INDEX_H_
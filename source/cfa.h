@@ -33,23 +33,16 @@ class CFA {
   using bb_ptr = BB*;
   using cbb_ptr = const BB*;
   using bb_iter = typename std::vector<BB*>::const_iterator;
-  using get_blocks_func = std::function<const std::vector<BB*>*(const BB*)>;
 
   struct block_info {
     cbb_ptr block;  ///< pointer to the block
     bb_iter iter;   ///< Iterator to the current child node being processed
+    bb_iter end;    ///< End of the child nodes of the block
   };
 
-  /// Returns true if a block with @p id is found in the @p work_list vector
-  ///
-  /// @param[in] work_list  Set of blocks visited in the the depth first
-  /// traversal
-  ///                       of the CFG
-  /// @param[in] id         The ID of the block being checked
-  ///
-  /// @return true if the edge work_list.back().block->id() => id is a back-edge
-  static bool FindInWorkList(const std::vector<block_info>& work_list,
-                             uint32_t id);
+  /// The state of a block in a depth first traversal, by block id.  A block
+  /// is on the work list from its preorder visit to its postorder visit.
+  enum class VisitState : uint8_t { kOnWorkList, kDone };
 
  public:
   /// @brief Depth first traversal starting from the \p entry BasicBlock
@@ -72,194 +65,228 @@ class CFA {
   /// a
   /// collection such that iterators to that collection remain valid for the
   /// lifetime of the algorithm.
-  static void DepthFirstTraversal(
-      const BB* entry, get_blocks_func successor_func,
-      std::function<void(cbb_ptr)> preorder,
-      std::function<void(cbb_ptr)> postorder,
-      std::function<void(cbb_ptr, cbb_ptr)> backedge);
+  ///
+  /// The functions are template parameters, so that lambdas are called
+  /// directly rather than through std::function.  Each block is looked up
+  /// once per edge, and the successors of a block are only asked for once.
+  template <typename SuccessorFunc, typename PreorderFunc,
+            typename PostorderFunc, typename BackedgeFunc>
+  static void DepthFirstTraversal(const BB* entry,
+                                  const SuccessorFunc& successor_func,
+                                  const PreorderFunc& preorder,
+                                  const PostorderFunc& postorder,
+                                  const BackedgeFunc& backedge);
 
   /// @brief Calculates dominator edges for a set of blocks
   ///
-  /// Computes dominators using the algorithm of Cooper, Harvey, and Kennedy
-  /// "A Simple, Fast Dominance Algorithm", 2001.
+  /// Computes dominators using the Semi-NCA algorithm: the semidominators are
+  /// computed as in Lengauer and Tarjan, "A Fast Algorithm for Finding
+  /// Dominators in a Flowgraph", 1979, and the immediate dominators from them
+  /// by nearest common ancestor searches, as in Georgiadis, "Linear Time
+  /// Algorithms for Dominators and Related Problems", 2005.  Unlike the
+  /// iterative algorithm, its running time does not depend on the loop nesting
+  /// of the CFG, and all the work is done on dense block indices.
   ///
   /// The algorithm assumes there is a unique root node (a node without
   /// predecessors), and it is therefore at the end of the postorder vector.
   ///
-  /// This function calculates the dominator edges for a set of blocks in the
-  /// CFG.
-  /// Uses the dominator algorithm by Cooper et al.
-  ///
   /// @param[in] postorder        A vector of blocks in post order traversal
-  /// order
-  ///                             in a CFG
+  ///                             order in a CFG
   /// @param[in] predecessor_func Function used to get the predecessor nodes of
-  /// a
-  ///                             block
+  ///                             a block
   ///
-  /// @return the dominator tree of the graph, as a vector of pairs of nodes.
-  /// The first node in the pair is a node in the graph. The second node in the
-  /// pair is its immediate dominator in the sense of Cooper et.al., where a
-  /// block
-  /// without predecessors (such as the root node) is its own immediate
+  /// @return the dominator tree of the graph, as a vector of pairs of nodes,
+  /// in post order of the first node.  The first node in the pair is a node in
+  /// the graph.  The second node in the pair is its immediate dominator, where
+  /// a block without predecessors (such as the root node) is its own immediate
   /// dominator.
+  template <typename PredecessorFunc>
   static std::vector<std::pair<BB*, BB*>> CalculateDominators(
-      const std::vector<cbb_ptr>& postorder, get_blocks_func predecessor_func);
+      const std::vector<cbb_ptr>& postorder,
+      const PredecessorFunc& predecessor_func);
 
   // Computes a minimal set of root nodes required to traverse, in the forward
   // direction, the CFG represented by the given vector of blocks, and successor
   // and predecessor functions.  When considering adding two nodes, each having
   // predecessors, favour using the one that appears earlier on the input blocks
   // list.
+  template <typename SuccessorFunc, typename PredecessorFunc>
   static std::vector<BB*> TraversalRoots(const std::vector<BB*>& blocks,
-                                         get_blocks_func succ_func,
-                                         get_blocks_func pred_func);
+                                         const SuccessorFunc& succ_func,
+                                         const PredecessorFunc& pred_func);
 
+  template <typename SuccessorFunc, typename PredecessorFunc>
   static void ComputeAugmentedCFG(
       std::vector<BB*>& ordered_blocks, BB* pseudo_entry_block,
       BB* pseudo_exit_block,
       std::unordered_map<const BB*, std::vector<BB*>>* augmented_successors_map,
       std::unordered_map<const BB*, std::vector<BB*>>*
           augmented_predecessors_map,
-      get_blocks_func succ_func, get_blocks_func pred_func);
+      const SuccessorFunc& succ_func, const PredecessorFunc& pred_func);
 };
 
 template <class BB>
-bool CFA<BB>::FindInWorkList(const std::vector<block_info>& work_list,
-                             uint32_t id) {
-  for (const auto b : work_list) {
-    if (b.block->id() == id) return true;
-  }
-  return false;
-}
-
-template <class BB>
-void CFA<BB>::DepthFirstTraversal(
-    const BB* entry, get_blocks_func successor_func,
-    std::function<void(cbb_ptr)> preorder,
-    std::function<void(cbb_ptr)> postorder,
-    std::function<void(cbb_ptr, cbb_ptr)> backedge) {
-  std::unordered_set<uint32_t> processed;
+template <typename SuccessorFunc, typename PreorderFunc, typename PostorderFunc,
+          typename BackedgeFunc>
+void CFA<BB>::DepthFirstTraversal(const BB* entry,
+                                  const SuccessorFunc& successor_func,
+                                  const PreorderFunc& preorder,
+                                  const PostorderFunc& postorder,
+                                  const BackedgeFunc& backedge) {
+  // Whether each block seen so far is still on the work list, which replaces
+  // a search of the work list for each edge.
+  std::unordered_map<uint32_t, VisitState> state;
 
   /// NOTE: work_list is the sequence of nodes from the root node to the node
   /// being processed in the traversal
   std::vector<block_info> work_list;
   work_list.reserve(10);
 
-  work_list.push_back({entry, std::begin(*successor_func(entry))});
-  preorder(entry);
-  processed.insert(entry->id());
+  auto visit = [&successor_func, &preorder, &state, &work_list](cbb_ptr bb) {
+    preorder(bb);
+    const auto* successors = successor_func(bb);
+    work_list.push_back({bb, std::begin(*successors), std::end(*successors)});
+    state[bb->id()] = VisitState::kOnWorkList;
+  };
+  visit(entry);
 
   while (!work_list.empty()) {
     block_info& top = work_list.back();
-    if (top.iter == end(*successor_func(top.block))) {
+    if (top.iter == top.end) {
+      state[top.block->id()] = VisitState::kDone;
       postorder(top.block);
       work_list.pop_back();
     } else {
       BB* child = *top.iter;
       top.iter++;
-      if (FindInWorkList(work_list, child->id())) {
+      auto child_state = state.find(child->id());
+      if (child_state == state.end()) {
+        visit(child);
+      } else if (child_state->second == VisitState::kOnWorkList) {
         backedge(top.block, child);
       }
-      if (processed.count(child->id()) == 0) {
-        preorder(child);
-        work_list.emplace_back(
-            block_info{child, std::begin(*successor_func(child))});
-        processed.insert(child->id());
-      }
     }
   }
 }
 
 template <class BB>
+template <typename PredecessorFunc>
 std::vector<std::pair<BB*, BB*>> CFA<BB>::CalculateDominators(
-    const std::vector<cbb_ptr>& postorder, get_blocks_func predecessor_func) {
-  struct block_detail {
-    size_t dominator;  ///< The index of blocks's dominator in post order array
-    size_t postorder_index;  ///< The index of the block in the post order array
-  };
-  const size_t undefined_dom = postorder.size();
+    const std::vector<cbb_ptr>& postorder,
+    const PredecessorFunc& predecessor_func) {
+  // Blocks are referred to by their index in |postorder| in the first part of
+  // the algorithm, and by their depth first preorder number in the second.
+  const size_t num_blocks = postorder.size();
+  const size_t undefined = num_blocks;
+  std::unordered_map<cbb_ptr, size_t> postorder_index;
+  postorder_index.reserve(num_blocks);
+  for (size_t i = 0; i < num_blocks; ++i) postorder_index[postorder[i]] = i;
+
+  // The predecessors of each block which are in |postorder|, and the
+  // successors given by inverting them.
+  std::vector<std::vector<size_t>> preds(num_blocks);
+  std::vector<std::vector<size_t>> succs(num_blocks);
+  for (size_t i = 0; i < num_blocks; ++i) {
+    for (const BB* pred : *predecessor_func(postorder[i])) {
+      auto it = postorder_index.find(pred);
+      if (it == postorder_index.end()) continue;
+      preds[i].push_back(it->second);
+      succs[it->second].push_back(i);
+    }
+  }
 
-  std::unordered_map<cbb_ptr, block_detail> idoms;
-  for (size_t i = 0; i < postorder.size(); i++) {
-    idoms[postorder[i]] = {undefined_dom, i};
+  // Number the blocks in depth first preorder from the root, which is the last
+  // block in post order.  |vertex| maps a preorder number to a postorder
+  // index, and |parent| gives the preorder number of the parent in the depth
+  // first spanning tree.
+  std::vector<size_t> preorder(num_blocks, undefined);
+  std::vector<size_t> vertex;
+  std::vector<size_t> parent;
+  vertex.reserve(num_blocks);
+  parent.reserve(num_blocks);
+  std::vector<std::pair<size_t, size_t>> stack;  // (block, parent preorder)
+  stack.emplace_back(num_blocks - 1, undefined);
+  while (!stack.empty()) {
+    const size_t block = stack.back().first;
+    const size_t block_parent = stack.back().second;
+    stack.pop_back();
+    if (preorder[block] != undefined) continue;
+    preorder[block] = vertex.size();
+    vertex.push_back(block);
+    parent.push_back(block_parent);
+    for (auto succ = succs[block].rbegin(); succ != succs[block].rend();
+         ++succ) {
+      if (preorder[*succ] == undefined)
+        stack.emplace_back(*succ, preorder[block]);
+    }
   }
-  idoms[postorder.back()].dominator = idoms[postorder.back()].postorder_index;
-
-  bool changed = true;
-  while (changed) {
-    changed = false;
-    for (auto b = postorder.rbegin() + 1; b != postorder.rend(); ++b) {
-      const std::vector<BB*>& predecessors = *predecessor_func(*b);
-      // Find the first processed/reachable predecessor that is reachable
-      // in the forward traversal.
-      auto res = std::find_if(std::begin(predecessors), std::end(predecessors),
-                              [&idoms, undefined_dom](BB* pred) {
-                                return idoms.count(pred) &&
-                                       idoms[pred].dominator != undefined_dom;
-                              });
-      if (res == end(predecessors)) continue;
-      const BB* idom = *res;
-      size_t idom_idx = idoms[idom].postorder_index;
-
-      // all other predecessors
-      for (const auto* p : predecessors) {
-        if (idom == p) continue;
-        // Only consider nodes reachable in the forward traversal.
-        // Otherwise the intersection doesn't make sense and will never
-        // terminate.
-        if (!idoms.count(p)) continue;
-        if (idoms[p].dominator != undefined_dom) {
-          size_t finger1 = idoms[p].postorder_index;
-          size_t finger2 = idom_idx;
-          while (finger1 != finger2) {
-            while (finger1 < finger2) {
-              finger1 = idoms[postorder[finger1]].dominator;
-            }
-            while (finger2 < finger1) {
-              finger2 = idoms[postorder[finger2]].dominator;
-            }
-          }
-          idom_idx = finger1;
-        }
-      }
-      if (idoms[*b].dominator != idom_idx) {
-        idoms[*b].dominator = idom_idx;
-        changed = true;
-      }
+
+  // Compute the semidominators as in Lengauer and Tarjan, "A Fast Algorithm
+  // for Finding Dominators in a Flowgraph", 1979, with the simple version of
+  // EVAL and LINK.  All the vectors are indexed by preorder number.
+  const size_t num_reached = vertex.size();
+  std::vector<size_t> semi(num_reached);
+  std::vector<size_t> label(num_reached);
+  std::vector<size_t> ancestor(num_reached, undefined);
+  for (size_t v = 0; v < num_reached; ++v) semi[v] = label[v] = v;
+
+  std::vector<size_t> path;
+  auto eval = [&semi, &label, &ancestor, &path,
+               undefined](size_t v) -> size_t {
+    if (ancestor[v] == undefined) return v;
+    // Compress the path from |v| to the root of its tree in the forest, so
+    // that |label| gives the minimal semidominator along it.
+    for (size_t u = v; ancestor[ancestor[u]] != undefined; u = ancestor[u]) {
+      path.push_back(u);
+    }
+    while (!path.empty()) {
+      const size_t u = path.back();
+      path.pop_back();
+      const size_t a = ancestor[u];
+      if (semi[label[a]] < semi[label[u]]) label[u] = label[a];
+      ancestor[u] = ancestor[a];
     }
+    return label[v];
+  };
+
+  for (size_t w = num_reached - 1; w > 0; --w) {
+    for (size_t pred : preds[vertex[w]]) {
+      if (preorder[pred] == undefined) continue;
+      const size_t u = eval(preorder[pred]);
+      if (semi[u] < semi[w]) semi[w] = semi[u];
+    }
+    ancestor[w] = parent[w];
   }
 
-  std::vector<std::pair<bb_ptr, bb_ptr>> out;
-  for (auto idom : idoms) {
-    // NOTE: performing a const cast for convenient usage with
-    // UpdateImmediateDominators
-    out.push_back({const_cast<BB*>(std::get<0>(idom)),
-                   const_cast<BB*>(postorder[std::get<1>(idom).dominator])});
+  // The immediate dominator of a block is the nearest common ancestor of its
+  // parent and its semidominator in the dominator tree (Georgiadis, "Linear
+  // Time Algorithms for Dominators and Related Problems", 2005).  Ancestors
+  // have smaller preorder numbers, so they are already final.
+  std::vector<size_t> idom(parent);
+  for (size_t w = 1; w < num_reached; ++w) {
+    while (idom[w] > semi[w]) idom[w] = idom[idom[w]];
   }
 
-  // Sort by postorder index to generate a deterministic ordering of edges.
-  std::sort(
-      out.begin(), out.end(),
-      [&idoms](const std::pair<bb_ptr, bb_ptr>& lhs,
-               const std::pair<bb_ptr, bb_ptr>& rhs) {
-        assert(lhs.first);
-        assert(lhs.second);
-        assert(rhs.first);
-        assert(rhs.second);
-        auto lhs_indices = std::make_pair(idoms[lhs.first].postorder_index,
-                                          idoms[lhs.second].postorder_index);
-        auto rhs_indices = std::make_pair(idoms[rhs.first].postorder_index,
-                                          idoms[rhs.second].postorder_index);
-        return lhs_indices < rhs_indices;
-      });
+  // Blocks without a reachable predecessor, such as the root, are their own
+  // immediate dominator.  The edges are in post order of their first block.
+  // NOTE: performing a const cast for convenient usage with
+  // UpdateImmediateDominators
+  std::vector<std::pair<bb_ptr, bb_ptr>> out;
+  out.reserve(num_blocks);
+  for (size_t i = 0; i < num_blocks; ++i) {
+    const size_t w = preorder[i];
+    const size_t dominator = (w == undefined || w == 0) ? i : vertex[idom[w]];
+    out.push_back({const_cast<BB*>(postorder[i]),
+                   const_cast<BB*>(postorder[dominator])});
+  }
   return out;
 }
 
 template <class BB>
+template <typename SuccessorFunc, typename PredecessorFunc>
 std::vector<BB*> CFA<BB>::TraversalRoots(const std::vector<BB*>& blocks,
-                                         get_blocks_func succ_func,
-                                         get_blocks_func pred_func) {
+                                         const SuccessorFunc& succ_func,
+                                         const PredecessorFunc& pred_func) {
   // The set of nodes which have been visited from any of the roots so far.
   std::unordered_set<const BB*> visited;
 
@@ -296,12 +323,13 @@ std::vector<BB*> CFA<BB>::TraversalRoots(const std::vector<BB*>& blocks,
 }
 
 template <class BB>
+template <typename SuccessorFunc, typename PredecessorFunc>
 void CFA<BB>::ComputeAugmentedCFG(
     std::vector<BB*>& ordered_blocks, BB* pseudo_entry_block,
     BB* pseudo_exit_block,
     std::unordered_map<const BB*, std::vector<BB*>>* augmented_successors_map,
     std::unordered_map<const BB*, std::vector<BB*>>* augmented_predecessors_map,
-    get_blocks_func succ_func, get_blocks_func pred_func) {
+    const SuccessorFunc& succ_func, const PredecessorFunc& pred_func) {
   // Compute the successors of the pseudo-entry block, and
   // the predecessors of the pseudo exit block.
   auto sources = TraversalRoots(ordered_blocks, succ_func, pred_func);
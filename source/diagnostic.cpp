@@ -71,21 +71,17 @@ spv_result_t spvDiagnosticPrint(const spv_diagnostic diagnostic) {
 namespace spvtools {
 
 DiagnosticStream::DiagnosticStream(DiagnosticStream&& other)
-    : stream_(),
+    : stream_(std::move(other.stream_)),
       position_(other.position_),
-      consumer_(other.consumer_),
+      consumer_(std::move(other.consumer_)),
       disassembled_instruction_(std::move(other.disassembled_instruction_)),
       error_(other.error_) {
   // Prevent the other object from emitting output during destruction.
   other.error_ = SPV_FAILED_MATCH;
-  // Some platforms are missing support for std::ostringstream functionality,
-  // including:  move constructor, swap method.  Either would have been a
-  // better choice than copying the string.
-  stream_ << other.stream_.str();
 }
 
 DiagnosticStream::~DiagnosticStream() {
-  if (error_ != SPV_FAILED_MATCH && consumer_ != nullptr) {
+  if (error_ != SPV_FAILED_MATCH && stream_) {
     auto level = SPV_MSG_ERROR;
     switch (error_) {
       case SPV_SUCCESS:
@@ -107,9 +103,9 @@ DiagnosticStream::~DiagnosticStream() {
         break;
     }
     if (disassembled_instruction_.size() > 0)
-      stream_ << std::endl << "  " << disassembled_instruction_ << std::endl;
+      *stream_ << std::endl << "  " << disassembled_instruction_ << std::endl;
 
-    consumer_(level, "input", position_, stream_.str().c_str());
+    consumer_(level, "input", position_, stream_->str().c_str());
   }
 }
 
@@ -15,6 +15,7 @@
 #ifndef SOURCE_DIAGNOSTIC_H_
 #define SOURCE_DIAGNOSTIC_H_
 
+#include <memory>
 #include <sstream>
 #include <string>
 
@@ -25,7 +26,9 @@ namespace spvtools {
 // A DiagnosticStream remembers the current position of the input and an error
 // code, and captures diagnostic messages via the left-shift operator.
 // If the error code is not SPV_FAILED_MATCH, then captured messages are
-// emitted during the destructor.
+// emitted during the destructor.  If there is no consumer, or the error code
+// is SPV_FAILED_MATCH, nothing is formatted: the stream only carries the
+// error code.
 class DiagnosticStream {
  public:
   DiagnosticStream(spv_position_t position, const MessageConsumer& consumer,
@@ -34,7 +37,11 @@ class DiagnosticStream {
       : position_(position),
         consumer_(consumer),
         disassembled_instruction_(disassembled_instruction),
-        error_(error) {}
+        error_(error) {
+    if (consumer_ != nullptr && error_ != SPV_FAILED_MATCH) {
+      stream_.reset(new std::ostringstream);
+    }
+  }
 
   // Creates a DiagnosticStream from an expiring DiagnosticStream.
   // The new object takes the contents of the other, and prevents the
@@ -49,7 +56,7 @@ class DiagnosticStream {
   // Adds the given value to the diagnostic message to be written.
   template <typename T>
   DiagnosticStream& operator<<(const T& val) {
-    stream_ << val;
+    if (stream_) *stream_ << val;
     return *this;
   }
 
@@ -57,7 +64,8 @@ class DiagnosticStream {
   operator spv_result_t() { return error_; }
 
  private:
-  std::ostringstream stream_;
+  // The message, or null if it is not emitted.
+  std::unique_ptr<std::ostringstream> stream_;
   spv_position_t position_;
   MessageConsumer consumer_;  // Message consumer callback.
   std::string disassembled_instruction_;
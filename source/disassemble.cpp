@@ -18,24 +18,29 @@
 #include <algorithm>
 #include <cassert>
 #include <cstring>
-#include <iomanip>
 #include <memory>
+#include <string>
 #include <unordered_map>
 #include <utility>
+#include <vector>
 
 #include "source/assembly_grammar.h"
 #include "source/binary.h"
+#include "source/binary_index.h"
 #include "source/diagnostic.h"
 #include "source/disassemble.h"
 #include "source/ext_inst.h"
 #include "source/name_mapper.h"
 #include "source/opcode.h"
+#include "source/operand.h"
 #include "source/parsed_operand.h"
 #include "source/print.h"
 #include "source/spirv_constant.h"
 #include "source/spirv_endian.h"
 #include "source/util/hex_float.h"
 #include "source/util/make_unique.h"
+#include "source/util/parallel.h"
+#include "source/util/string_utils.h"
 #include "spirv-tools/libspirv.h"
 
 namespace {
@@ -59,7 +64,40 @@ class Disassembler {
         show_byte_offset_(spvIsInBitfield(
             SPV_BINARY_TO_TEXT_OPTION_SHOW_BYTE_OFFSET, options)),
         byte_offset_(0),
-        name_mapper_(std::move(name_mapper)) {}
+        name_mapper_(std::move(name_mapper)),
+        write_user_data_(nullptr),
+        write_text_(nullptr),
+        // Colour printing on Windows changes the console state as the text
+        // is emitted, so it can't be formatted ahead of time.
+        parallel_(spvIsInBitfield(SPV_BINARY_TO_TEXT_OPTION_PARALLEL,
+                                  options) &&
+                  !(print_ && color_)),
+        worker_options_(options & ~(SPV_BINARY_TO_TEXT_OPTION_PRINT |
+                                    SPV_BINARY_TO_TEXT_OPTION_PARALLEL)),
+        num_threads_(spvtools::utils::ResolveNumThreads(0)),
+        in_function_(false),
+        friendly_mapper_(nullptr),
+        in_global_section_(true) {}
+
+  // Passes the text to |write_text| as it is produced, instead of
+  // accumulating it for SaveTextResult.  Has no effect when printing.
+  void SetTextWriter(void* user_data, spv_text_write_fn_t write_text) {
+    write_user_data_ = user_data;
+    write_text_ = write_text;
+  }
+
+  // Sets the offset shown for the next instruction, when disassembling only
+  // part of a binary.
+  void SetByteOffset(size_t byte_offset) { byte_offset_ = byte_offset; }
+
+  // Collects friendly names into |mapper| from the instructions as they are
+  // handled.  |mapper| must be filled in incrementally, and must be the
+  // mapper used by the NameMapper given to the constructor.  The text for
+  // the global section is deferred until all of it has been handled, since
+  // its instructions can refer to names defined later in it.
+  void SetFriendlyNameMapper(spvtools::FriendlyNameMapper* mapper) {
+    friendly_mapper_ = mapper;
+  }
 
   // Emits the assembly header for the module, and sets up internal state
   // so subsequent callbacks can handle the cases where the entire module
@@ -67,15 +105,63 @@ class Disassembler {
   spv_result_t HandleHeader(spv_endianness_t endian, uint32_t version,
                             uint32_t generator, uint32_t id_bound,
                             uint32_t schema);
-  // Emits the assembly text for the given instruction.
+  // Emits the assembly text for the given instruction.  When formatting
+  // functions in parallel, the text for an instruction in a function is only
+  // emitted once a batch of functions is complete.  When collecting friendly
+  // names, the text for the global section is only emitted once it ends.
   spv_result_t HandleInstruction(const spv_parsed_instruction_t& inst);
 
+  // Emits the text for any instructions whose formatting was deferred.  Must
+  // be called after the last instruction has been handled.
+  spv_result_t EmitDeferred() {
+    if (auto error = EmitGlobals()) return error;
+    return EmitFunctions();
+  }
+
   // If not printing, populates text_result with the accumulated text.
   // Returns SPV_SUCCESS on success.
   spv_result_t SaveTextResult(spv_text* text_result) const;
 
+  // If there is a text writer, and at least |min_size| bytes of text have
+  // accumulated, passes the accumulated text to the writer and discards it.
+  // Returns the result of the writer, or SPV_SUCCESS if it was not called.
+  spv_result_t FlushText(size_t min_size);
+
  private:
   enum { kStandardIndent = 15 };
+  // The amount of text to accumulate before passing it to the text writer.
+  enum { kTextWriteSize = 64 * 1024 };
+
+  // A copy of a parsed instruction, kept until its function is formatted.
+  struct CapturedInstruction {
+    spv_parsed_instruction_t inst;
+    std::vector<uint32_t> words;
+    std::vector<spv_parsed_operand_t> operands;
+    size_t byte_offset;  // The offset of the instruction in the binary.
+  };
+  using CapturedFunction = std::vector<CapturedInstruction>;
+
+  // Appends a copy of the given instruction to |instructions|, and advances
+  // past it.
+  void Capture(const spv_parsed_instruction_t& inst,
+               CapturedFunction* instructions);
+
+  // Emits the text for the global section instructions collected so far, and
+  // ends the global section.
+  spv_result_t EmitGlobals();
+
+  // Formats the functions collected since the last call, using multiple
+  // threads, and emits their text in module order.
+  spv_result_t EmitFunctions();
+
+  // Emits the assembly text for the given instruction.
+  void EmitInstruction(const spv_parsed_instruction_t& inst);
+
+  // Emits the assembly text for the given captured instruction.
+  void EmitCaptured(const CapturedInstruction& captured);
+
+  // Returns the assembly text for the given function.
+  std::string FormatFunction(const CapturedFunction& function);
 
   using out_stream = spvtools::out_stream;
 
@@ -87,29 +173,62 @@ class Disassembler {
   // Emits a mask expression for the given mask word of the specified type.
   void EmitMaskOperand(const spv_operand_type_t type, const uint32_t word);
 
+  // Returns the name of the Id, which is looked up in the name mapper only
+  // the first time.
+  const std::string& IdName(uint32_t id);
+
+  // Returns the name of the operand of the given type with the given value,
+  // or nullptr if there is none.  The grammar is searched only the first time.
+  const char* OperandName(spv_operand_type_t type, uint32_t value);
+
+  // Writes the text of the current instruction to the output stream.
+  void FlushLine() {
+    if (line_.empty()) return;
+    stream_.write(line_.data(), line_.size());
+    line_.clear();
+  }
+
   // Resets the output color, if color is turned on.
   void ResetColor() {
-    if (color_) out_.get() << spvtools::clr::reset{print_};
+    if (color_) {
+      FlushLine();
+      out_.get() << spvtools::clr::reset{print_};
+    }
   }
   // Sets the output to grey, if color is turned on.
   void SetGrey() {
-    if (color_) out_.get() << spvtools::clr::grey{print_};
+    if (color_) {
+      FlushLine();
+      out_.get() << spvtools::clr::grey{print_};
+    }
   }
   // Sets the output to blue, if color is turned on.
   void SetBlue() {
-    if (color_) out_.get() << spvtools::clr::blue{print_};
+    if (color_) {
+      FlushLine();
+      out_.get() << spvtools::clr::blue{print_};
+    }
   }
   // Sets the output to yellow, if color is turned on.
   void SetYellow() {
-    if (color_) out_.get() << spvtools::clr::yellow{print_};
+    if (color_) {
+      FlushLine();
+      out_.get() << spvtools::clr::yellow{print_};
+    }
   }
   // Sets the output to red, if color is turned on.
   void SetRed() {
-    if (color_) out_.get() << spvtools::clr::red{print_};
+    if (color_) {
+      FlushLine();
+      out_.get() << spvtools::clr::red{print_};
+    }
   }
   // Sets the output to green, if color is turned on.
   void SetGreen() {
-    if (color_) out_.get() << spvtools::clr::green{print_};
+    if (color_) {
+      FlushLine();
+      out_.get() << spvtools::clr::green{print_};
+    }
   }
 
   const spvtools::AssemblyGrammar& grammar_;
@@ -124,8 +243,40 @@ class Disassembler {
   const bool show_byte_offset_;  // Should we print byte offset, in hex?
   size_t byte_offset_;           // The number of bytes processed so far.
   spvtools::NameMapper name_mapper_;
+  void* write_user_data_;           // Context for the text writer.
+  spv_text_write_fn_t write_text_;  // The text writer, if any.
+  const bool parallel_;  // Should we format functions on multiple threads?
+  const uint32_t worker_options_;  // Options for formatting a function.
+  const uint32_t num_threads_;     // The number of threads to format with.
+  bool in_function_;  // Is the current instruction inside a function?
+  // Functions waiting to be formatted.  When in_function_ is true, the last
+  // one is the function being parsed.
+  std::vector<CapturedFunction> functions_;
+  // Where friendly names are collected, if that is done while disassembling.
+  spvtools::FriendlyNameMapper* friendly_mapper_;
+  bool in_global_section_;  // Are we before the first function?
+  CapturedFunction globals_;  // Global section instructions not yet emitted.
+  // The text of the current instruction, not yet written to the stream.  The
+  // text is appended to it directly, and it keeps its capacity between
+  // instructions, so formatting does not allocate once it has grown.
+  std::string line_;
+  std::unordered_map<uint32_t, std::string> id_names_;  // Names by Id.
+  // Operand names by operand type, in the high 32 bits, and value.
+  std::unordered_map<uint64_t, const char*> operand_names_;
 };
 
+// Appends |value| in hexadecimal to |str|, padded with zeros to |min_digits|.
+void AppendHex(uint64_t value, size_t min_digits, std::string* str) {
+  char digits[16];
+  size_t num_digits = 0;
+  do {
+    digits[num_digits++] = "0123456789abcdef"[value & 0xf];
+    value >>= 4;
+  } while (value);
+  if (num_digits < min_digits) str->append(min_digits - num_digits, '0');
+  while (num_digits) str->push_back(digits[--num_digits]);
+}
+
 spv_result_t Disassembler::HandleHeader(spv_endianness_t endian,
                                         uint32_t version, uint32_t generator,
                                         uint32_t id_bound, uint32_t schema) {
@@ -158,43 +309,165 @@ spv_result_t Disassembler::HandleHeader(spv_endianness_t endian,
 
 spv_result_t Disassembler::HandleInstruction(
     const spv_parsed_instruction_t& inst) {
+  if (friendly_mapper_) {
+    friendly_mapper_->ParseInstruction(inst);
+    if (in_global_section_) {
+      if (inst.opcode != SpvOpFunction) {
+        Capture(inst, &globals_);
+        return SPV_SUCCESS;
+      }
+      if (auto error = EmitGlobals()) return error;
+    }
+  }
+
+  if (parallel_) {
+    if (inst.opcode == SpvOpFunction) {
+      functions_.emplace_back();
+      in_function_ = true;
+    }
+    if (in_function_) {
+      Capture(inst, &functions_.back());
+      if (inst.opcode != SpvOpFunctionEnd) return SPV_SUCCESS;
+      in_function_ = false;
+      // Format a few functions per thread at a time, to bound the number of
+      // instructions held in memory.
+      if (functions_.size() < 4 * num_threads_) return SPV_SUCCESS;
+      return EmitFunctions();
+    }
+    if (auto error = EmitFunctions()) return error;
+  }
+
+  EmitInstruction(inst);
+  return FlushText(kTextWriteSize);
+}
+
+void Disassembler::Capture(const spv_parsed_instruction_t& inst,
+                           CapturedFunction* instructions) {
+  instructions->push_back(
+      {inst, std::vector<uint32_t>(inst.words, inst.words + inst.num_words),
+       std::vector<spv_parsed_operand_t>(inst.operands,
+                                         inst.operands + inst.num_operands),
+       byte_offset_});
+  byte_offset_ += inst.num_words * sizeof(uint32_t);
+}
+
+spv_result_t Disassembler::EmitGlobals() {
+  in_global_section_ = false;
+  const size_t byte_offset = byte_offset_;
+  for (const auto& captured : globals_) {
+    EmitCaptured(captured);
+    if (auto error = FlushText(kTextWriteSize)) return error;
+  }
+  byte_offset_ = byte_offset;
+  CapturedFunction().swap(globals_);
+  return SPV_SUCCESS;
+}
+
+spv_result_t Disassembler::EmitFunctions() {
+  if (functions_.empty()) return SPV_SUCCESS;
+  if (friendly_mapper_) {
+    // Looking up a name for the first time records it, so do that for every
+    // Id here.  The threads then only read the name mapper, and can share it.
+    for (const auto& function : functions_) {
+      for (const auto& captured : function) {
+        for (const auto& operand : captured.operands) {
+          if (spvIsIdType(operand.type)) {
+            friendly_mapper_->NameForId(captured.words[operand.offset]);
+          }
+        }
+      }
+    }
+  }
+  std::vector<std::string> texts(functions_.size());
+  spvtools::utils::ParallelFor(
+      functions_.size(), num_threads_, [this, &texts](size_t i) {
+        Disassembler worker(grammar_, worker_options_, name_mapper_);
+        texts[i] = worker.FormatFunction(functions_[i]);
+      });
+  functions_.clear();
+  in_function_ = false;
+
+  for (const auto& text : texts) {
+    stream_ << text;
+    if (auto error = FlushText(kTextWriteSize)) return error;
+  }
+  return SPV_SUCCESS;
+}
+
+void Disassembler::EmitCaptured(const CapturedInstruction& captured) {
+  spv_parsed_instruction_t inst = captured.inst;
+  inst.words = captured.words.data();
+  inst.operands = captured.operands.data();
+  byte_offset_ = captured.byte_offset;
+  EmitInstruction(inst);
+}
+
+std::string Disassembler::FormatFunction(const CapturedFunction& function) {
+  for (const auto& captured : function) EmitCaptured(captured);
+  return text_.str();
+}
+
+void Disassembler::EmitInstruction(const spv_parsed_instruction_t& inst) {
   if (inst.result_id) {
     SetBlue();
-    const std::string id_name = name_mapper_(inst.result_id);
-    if (indent_)
-      stream_ << std::setw(std::max(0, indent_ - 3 - int(id_name.size())));
-    stream_ << "%" << id_name;
+    const std::string& id_name = IdName(inst.result_id);
+    if (indent_) {
+      const int padding = indent_ - 3 - int(id_name.size());
+      if (padding > 1) line_.append(padding - 1, ' ');
+    }
+    line_ += '%';
+    line_ += id_name;
     ResetColor();
-    stream_ << " = ";
+    line_ += " = ";
   } else {
-    stream_ << std::string(indent_, ' ');
+    line_.append(indent_, ' ');
   }
 
-  stream_ << "Op" << spvOpcodeString(static_cast<SpvOp>(inst.opcode));
+  line_ += "Op";
+  line_ += spvOpcodeString(static_cast<SpvOp>(inst.opcode));
 
   for (uint16_t i = 0; i < inst.num_operands; i++) {
     const spv_operand_type_t type = inst.operands[i].type;
     assert(type != SPV_OPERAND_TYPE_NONE);
     if (type == SPV_OPERAND_TYPE_RESULT_ID) continue;
-    stream_ << " ";
+    line_ += ' ';
     EmitOperand(inst, i);
   }
 
   if (show_byte_offset_) {
     SetGrey();
-    auto saved_flags = stream_.flags();
-    auto saved_fill = stream_.fill();
-    stream_ << " ; 0x" << std::setw(8) << std::hex << std::setfill('0')
-            << byte_offset_;
-    stream_.flags(saved_flags);
-    stream_.fill(saved_fill);
+    line_ += " ; 0x";
+    AppendHex(byte_offset_, 8, &line_);
     ResetColor();
   }
 
   byte_offset_ += inst.num_words * sizeof(uint32_t);
 
-  stream_ << "\n";
-  return SPV_SUCCESS;
+  line_ += '\n';
+  FlushLine();
+}
+
+const std::string& Disassembler::IdName(uint32_t id) {
+  auto it = id_names_.find(id);
+  if (it == id_names_.end()) {
+    it = id_names_.emplace(id, name_mapper_(id)).first;
+  }
+  return it->second;
+}
+
+const char* Disassembler::OperandName(spv_operand_type_t type,
+                                      uint32_t value) {
+  const uint64_t key = (uint64_t(type) << 32) | value;
+  auto it = operand_names_.find(key);
+  if (it == operand_names_.end()) {
+    spv_operand_desc entry;
+    const char* name = nullptr;
+    if (grammar_.lookupOperand(type, value, &entry) == SPV_SUCCESS) {
+      name = entry->name;
+    }
+    it = operand_names_.emplace(key, name).first;
+  }
+  return it->second;
 }
 
 void Disassembler::EmitOperand(const spv_parsed_instruction_t& inst,
@@ -206,27 +479,29 @@ void Disassembler::EmitOperand(const spv_parsed_instruction_t& inst,
     case SPV_OPERAND_TYPE_RESULT_ID:
       assert(false && "<result-id> is not supposed to be handled here");
       SetBlue();
-      stream_ << "%" << name_mapper_(word);
+      line_ += '%';
+      line_ += IdName(word);
       break;
     case SPV_OPERAND_TYPE_ID:
     case SPV_OPERAND_TYPE_TYPE_ID:
     case SPV_OPERAND_TYPE_SCOPE_ID:
     case SPV_OPERAND_TYPE_MEMORY_SEMANTICS_ID:
       SetYellow();
-      stream_ << "%" << name_mapper_(word);
+      line_ += '%';
+      line_ += IdName(word);
       break;
     case SPV_OPERAND_TYPE_EXTENSION_INSTRUCTION_NUMBER: {
       spv_ext_inst_desc ext_inst;
       SetRed();
       if (grammar_.lookupExtInst(inst.ext_inst_type, word, &ext_inst) ==
           SPV_SUCCESS) {
-        stream_ << ext_inst->name;
+        line_ += ext_inst->name;
       } else {
         if (!spvExtInstIsNonSemantic(inst.ext_inst_type)) {
           assert(false && "should have caught this earlier");
         } else {
           // for non-semantic instruction sets we can just print the number
-          stream_ << word;
+          spvtools::utils::AppendUnsigned(word, &line_);
         }
       }
     } break;
@@ -235,27 +510,27 @@ void Disassembler::EmitOperand(const spv_parsed_instruction_t& inst,
       if (grammar_.lookupOpcode(SpvOp(word), &opcode_desc))
         assert(false && "should have caught this earlier");
       SetRed();
-      stream_ << opcode_desc->name;
+      line_ += opcode_desc->name;
     } break;
     case SPV_OPERAND_TYPE_LITERAL_INTEGER:
     case SPV_OPERAND_TYPE_TYPED_LITERAL_NUMBER: {
       SetRed();
-      spvtools::EmitNumericLiteral(&stream_, inst, operand);
+      spvtools::AppendNumericLiteral(&line_, inst, operand);
       ResetColor();
     } break;
     case SPV_OPERAND_TYPE_LITERAL_STRING: {
-      stream_ << "\"";
+      line_ += '"';
       SetGreen();
       // Strings are always little-endian, and null-terminated.
       // Write out the characters, escaping as needed, and without copying
       // the entire string.
       auto c_str = reinterpret_cast<const char*>(inst.words + operand.offset);
       for (auto p = c_str; *p; ++p) {
-        if (*p == '"' || *p == '\\') stream_ << '\\';
-        stream_ << *p;
+        if (*p == '"' || *p == '\\') line_ += '\\';
+        line_ += *p;
       }
       ResetColor();
-      stream_ << '"';
+      line_ += '"';
     } break;
     case SPV_OPERAND_TYPE_CAPABILITY:
     case SPV_OPERAND_TYPE_SOURCE_LANGUAGE:
@@ -286,10 +561,9 @@ void Disassembler::EmitOperand(const spv_parsed_instruction_t& inst,
     case SPV_OPERAND_TYPE_CLDEBUG100_DEBUG_TYPE_QUALIFIER:
     case SPV_OPERAND_TYPE_CLDEBUG100_DEBUG_OPERATION:
     case SPV_OPERAND_TYPE_CLDEBUG100_DEBUG_IMPORTED_ENTITY: {
-      spv_operand_desc entry;
-      if (grammar_.lookupOperand(operand.type, word, &entry))
-        assert(false && "should have caught this earlier");
-      stream_ << entry->name;
+      const char* name = OperandName(operand.type, word);
+      assert(name && "should have caught this earlier");
+      if (name) line_ += name;
     } break;
     case SPV_OPERAND_TYPE_FP_FAST_MATH_MODE:
     case SPV_OPERAND_TYPE_FUNCTION_CONTROL:
@@ -317,20 +591,17 @@ void Disassembler::EmitMaskOperand(const spv_operand_type_t type,
   for (mask = 1; remaining_word; mask <<= 1) {
     if (remaining_word & mask) {
       remaining_word ^= mask;
-      spv_operand_desc entry;
-      if (grammar_.lookupOperand(type, mask, &entry))
-        assert(false && "should have caught this earlier");
-      if (num_emitted) stream_ << "|";
-      stream_ << entry->name;
+      const char* name = OperandName(type, mask);
+      assert(name && "should have caught this earlier");
+      if (num_emitted) line_ += '|';
+      if (name) line_ += name;
       num_emitted++;
     }
   }
   if (!num_emitted) {
     // An operand value of 0 was provided, so represent it by the name
     // of the 0 value. In many cases, that's "None".
-    spv_operand_desc entry;
-    if (SPV_SUCCESS == grammar_.lookupOperand(type, 0, &entry))
-      stream_ << entry->name;
+    if (const char* name = OperandName(type, 0)) line_ += name;
   }
 }
 
@@ -352,6 +623,15 @@ spv_result_t Disassembler::SaveTextResult(spv_text* text_result) const {
   return SPV_SUCCESS;
 }
 
+spv_result_t Disassembler::FlushText(size_t min_size) {
+  if (print_ || !write_text_) return SPV_SUCCESS;
+  const size_t size = static_cast<size_t>(text_.tellp());
+  if (size == 0 || size < min_size) return SPV_SUCCESS;
+  const std::string text = text_.str();
+  text_.str(std::string());
+  return write_text_(write_user_data_, text.data(), text.size());
+}
+
 spv_result_t DisassembleHeader(void* user_data, spv_endianness_t endian,
                                uint32_t /* magic */, uint32_t version,
                                uint32_t generator, uint32_t id_bound,
@@ -415,12 +695,14 @@ spv_result_t DisassembleTargetInstruction(
   return SPV_SUCCESS;
 }
 
-}  // namespace
-
-spv_result_t spvBinaryToText(const spv_const_context context,
-                             const uint32_t* code, const size_t wordCount,
-                             const uint32_t options, spv_text* pText,
-                             spv_diagnostic* pDiagnostic) {
+// Disassembles the given binary.  If |write_text| is not null, the text is
+// passed to it as it is produced.  Otherwise the text is saved to *pText,
+// unless printing.
+spv_result_t BinaryToText(const spv_const_context context, const uint32_t* code,
+                          const size_t wordCount, const uint32_t options,
+                          spv_text* pText, void* user_data,
+                          spv_text_write_fn_t write_text,
+                          spv_diagnostic* pDiagnostic) {
   spv_context_t hijack_context = *context;
   if (pDiagnostic) {
     *pDiagnostic = nullptr;
@@ -433,23 +715,103 @@ spv_result_t spvBinaryToText(const spv_const_context context,
   // Generate friendly names for Ids if requested.
   std::unique_ptr<spvtools::FriendlyNameMapper> friendly_mapper;
   spvtools::NameMapper name_mapper = spvtools::GetTrivialNameMapper();
+  // The names are collected while disassembling, rather than in a separate
+  // parse of the module.
   if (options & SPV_BINARY_TO_TEXT_OPTION_FRIENDLY_NAMES) {
-    friendly_mapper = spvtools::MakeUnique<spvtools::FriendlyNameMapper>(
-        &hijack_context, code, wordCount);
+    friendly_mapper =
+        spvtools::MakeUnique<spvtools::FriendlyNameMapper>(&hijack_context);
     name_mapper = friendly_mapper->GetNameMapper();
   }
 
   // Now disassemble!
   Disassembler disassembler(grammar, options, name_mapper);
+  if (friendly_mapper) {
+    disassembler.SetFriendlyNameMapper(friendly_mapper.get());
+  }
+  if (write_text) disassembler.SetTextWriter(user_data, write_text);
   if (auto error = spvBinaryParse(&hijack_context, &disassembler, code,
                                   wordCount, DisassembleHeader,
                                   DisassembleInstruction, pDiagnostic)) {
+    // Print the instructions parsed before the error, as would have been
+    // done without deferring any of them.
+    if (spvIsInBitfield(SPV_BINARY_TO_TEXT_OPTION_PRINT, options)) {
+      disassembler.EmitDeferred();
+    }
     return error;
   }
+  if (auto error = disassembler.EmitDeferred()) return error;
 
+  if (write_text) return disassembler.FlushText(0);
   return disassembler.SaveTextResult(pText);
 }
 
+}  // namespace
+
+spv_result_t spvBinaryToText(const spv_const_context context,
+                             const uint32_t* code, const size_t wordCount,
+                             const uint32_t options, spv_text* pText,
+                             spv_diagnostic* pDiagnostic) {
+  return BinaryToText(context, code, wordCount, options, pText, nullptr,
+                      nullptr, pDiagnostic);
+}
+
+spv_result_t spvBinaryToTextStream(const spv_const_context context,
+                                   const uint32_t* code,
+                                   const size_t wordCount,
+                                   const uint32_t options, void* user_data,
+                                   spv_text_write_fn_t write_text,
+                                   spv_diagnostic* pDiagnostic) {
+  if (!write_text) return SPV_ERROR_INVALID_POINTER;
+  return BinaryToText(context, code, wordCount, options, nullptr, user_data,
+                      write_text, pDiagnostic);
+}
+
+spv_result_t spvBinaryToTextRange(const spv_const_context context,
+                                  const uint32_t* words, const size_t num_words,
+                                  spv_const_binary_index index,
+                                  const size_t begin, const size_t end,
+                                  const uint32_t options, spv_text* text,
+                                  spv_diagnostic* diagnostic) {
+  if (!context || !words || !index) return SPV_ERROR_INVALID_POINTER;
+  spv_context_t hijack_context = *context;
+  if (diagnostic) {
+    *diagnostic = nullptr;
+    spvtools::UseDiagnosticAsMessageConsumer(&hijack_context, diagnostic);
+  }
+
+  const spvtools::AssemblyGrammar grammar(&hijack_context);
+  if (!grammar.isValid()) return SPV_ERROR_INVALID_TABLE;
+
+  // The friendly names are those of the whole module, since only the global
+  // section can name ids.
+  std::unique_ptr<spvtools::FriendlyNameMapper> friendly_mapper;
+  spvtools::NameMapper name_mapper = spvtools::GetTrivialNameMapper();
+  if (options & SPV_BINARY_TO_TEXT_OPTION_FRIENDLY_NAMES) {
+    friendly_mapper = spvtools::MakeUnique<spvtools::FriendlyNameMapper>(
+        &hijack_context, words, index->globals_end);
+    name_mapper = friendly_mapper->GetNameMapper();
+  }
+
+  Disassembler disassembler(grammar,
+                            (options | SPV_BINARY_TO_TEXT_OPTION_NO_HEADER) &
+                                ~SPV_BINARY_TO_TEXT_OPTION_PARALLEL,
+                            name_mapper);
+  if (auto error = spvtools::ParseBinaryRange(
+          &hijack_context, words, num_words, index, begin, end, &disassembler,
+          DisassembleHeader,
+          [&disassembler](const spv_parsed_instruction_t& inst, size_t offset,
+                          bool in_range) -> spv_result_t {
+            if (!in_range) return SPV_SUCCESS;
+            disassembler.SetByteOffset(offset * sizeof(uint32_t));
+            return disassembler.HandleInstruction(inst);
+          },
+          diagnostic)) {
+    return error;
+  }
+  if (auto error = disassembler.EmitDeferred()) return error;
+  return disassembler.SaveTextResult(text);
+}
+
 std::string spvtools::spvInstructionBinaryToText(const spv_target_env env,
                                                  const uint32_t* instCode,
                                                  const size_t instWordCount,
@@ -477,6 +839,7 @@ std::string spvtools::spvInstructionBinaryToText(const spv_target_env env,
   WrappedDisassembler wrapped(&disassembler, instCode, instWordCount);
   spvBinaryParse(context, &wrapped, code, wordCount, DisassembleTargetHeader,
                  DisassembleTargetInstruction, nullptr);
+  disassembler.EmitDeferred();
 
   spv_text text = nullptr;
   std::string output;
@@ -15,28 +15,36 @@
 #ifndef SOURCE_ENUM_SET_H_
 #define SOURCE_ENUM_SET_H_
 
+#include <algorithm>
 #include <cstdint>
-#include <functional>
-#include <memory>
-#include <set>
+#include <initializer_list>
 #include <utility>
+#include <vector>
 
 #include "source/latest_version_spirv_header.h"
-#include "source/util/make_unique.h"
 
 namespace spvtools {
 
 // A set of values of a 32-bit enum type.
-// It is fast and compact for the common case, where enum values
-// are at most 63.  But it can represent enums with larger values,
-// as may appear in extensions.
+//
+// The values are stored as bits in buckets of 64 consecutive values, kept in
+// order of their values.  SPIR-V enums are allocated in a few dense ranges,
+// such as the core values and the blocks reserved for each vendor, so a set
+// of capabilities or extensions only has a few buckets whatever its values.
+// Looking a value up is a search among the buckets followed by a bit test.
 template <typename EnumType>
 class EnumSet {
  private:
-  // The ForEach method will call the functor on enum values in
-  // enum value order (lowest to highest).  To make that easier, use
-  // an ordered set for the overflow values.
-  using OverflowSetType = std::set<uint32_t>;
+  // The values of a bucket are |start| plus the indices of the bits set in
+  // |mask|.  |start| is a multiple of 64, and |mask| is never 0.
+  struct Bucket {
+    uint32_t start;
+    uint64_t mask;
+
+    bool operator==(const Bucket& other) const {
+      return start == other.start && mask == other.mask;
+    }
+  };
 
  public:
   // Construct an empty set.
@@ -51,38 +59,16 @@ class EnumSet {
     for (uint32_t i = 0; i < count; ++i) Add(ptr[i]);
   }
   // Copy constructor.
-  EnumSet(const EnumSet& other) { *this = other; }
+  EnumSet(const EnumSet& other) = default;
   // Move constructor.  The moved-from set is emptied.
-  EnumSet(EnumSet&& other) {
-    mask_ = other.mask_;
-    overflow_ = std::move(other.overflow_);
-    other.mask_ = 0;
-    other.overflow_.reset(nullptr);
+  EnumSet(EnumSet&& other) : buckets_(std::move(other.buckets_)) {
+    other.buckets_.clear();
   }
   // Assignment operator.
-  EnumSet& operator=(const EnumSet& other) {
-    if (&other != this) {
-      mask_ = other.mask_;
-      overflow_.reset(other.overflow_ ? new OverflowSetType(*other.overflow_)
-                                      : nullptr);
-    }
-    return *this;
-  }
+  EnumSet& operator=(const EnumSet& other) = default;
 
   friend bool operator==(const EnumSet& a, const EnumSet& b) {
-    if (a.mask_ != b.mask_) {
-      return false;
-    }
-
-    if (a.overflow_ == nullptr && b.overflow_ == nullptr) {
-      return true;
-    }
-
-    if (a.overflow_ == nullptr || b.overflow_ == nullptr) {
-      return false;
-    }
-
-    return *a.overflow_ == *b.overflow_;
+    return a.buckets_ == b.buckets_;
   }
 
   friend bool operator!=(const EnumSet& a, const EnumSet& b) {
@@ -91,101 +77,94 @@ class EnumSet {
 
   // Adds the given enum value to the set.  This has no effect if the
   // enum value is already in the set.
-  void Add(EnumType c) { AddWord(ToWord(c)); }
+  void Add(EnumType c) {
+    const uint32_t word = ToWord(c);
+    auto bucket = FindBucket(BucketStart(word));
+    if (bucket == buckets_.end() || bucket->start != BucketStart(word)) {
+      bucket = buckets_.insert(bucket, {BucketStart(word), 0});
+    }
+    bucket->mask |= AsMask(word);
+  }
 
   // Returns true if this enum value is in the set.
-  bool Contains(EnumType c) const { return ContainsWord(ToWord(c)); }
+  bool Contains(EnumType c) const {
+    const uint32_t word = ToWord(c);
+    auto bucket = FindBucket(BucketStart(word));
+    return bucket != buckets_.end() && bucket->start == BucketStart(word) &&
+           (bucket->mask & AsMask(word)) != 0;
+  }
 
   // Applies f to each enum in the set, in order from smallest enum
   // value to largest.
-  void ForEach(std::function<void(EnumType)> f) const {
-    for (uint32_t i = 0; i < 64; ++i) {
-      if (mask_ & AsMask(i)) f(static_cast<EnumType>(i));
-    }
-    if (overflow_) {
-      for (uint32_t c : *overflow_) f(static_cast<EnumType>(c));
+  template <typename Functor>
+  void ForEach(Functor f) const {
+    for (const Bucket& bucket : buckets_) {
+      for (uint32_t i = 0; i < 64; ++i) {
+        if (bucket.mask & AsMask(i)) {
+          f(static_cast<EnumType>(bucket.start + i));
+        }
+      }
     }
   }
 
   // Returns true if the set is empty.
-  bool IsEmpty() const {
-    if (mask_) return false;
-    if (overflow_ && !overflow_->empty()) return false;
-    return true;
-  }
+  bool IsEmpty() const { return buckets_.empty(); }
 
   // Returns true if the set contains ANY of the elements of |in_set|,
   // or if |in_set| is empty.
   bool HasAnyOf(const EnumSet<EnumType>& in_set) const {
     if (in_set.IsEmpty()) return true;
 
-    if (mask_ & in_set.mask_) return true;
-
-    if (!overflow_ || !in_set.overflow_) return false;
-
-    for (uint32_t item : *in_set.overflow_) {
-      if (overflow_->find(item) != overflow_->end()) return true;
+    // Both bucket lists are in order, so they are walked together.
+    auto bucket = buckets_.begin();
+    auto in_bucket = in_set.buckets_.begin();
+    while (bucket != buckets_.end() && in_bucket != in_set.buckets_.end()) {
+      if (bucket->start < in_bucket->start) {
+        ++bucket;
+      } else if (in_bucket->start < bucket->start) {
+        ++in_bucket;
+      } else {
+        if (bucket->mask & in_bucket->mask) return true;
+        ++bucket;
+        ++in_bucket;
+      }
     }
-
     return false;
   }
 
  private:
-  // Adds the given enum value (as a 32-bit word) to the set.  This has no
-  // effect if the enum value is already in the set.
-  void AddWord(uint32_t word) {
-    if (auto new_bits = AsMask(word)) {
-      mask_ |= new_bits;
-    } else {
-      Overflow().insert(word);
-    }
-  }
+  using Buckets = std::vector<Bucket>;
 
-  // Returns true if the enum represented as a 32-bit word is in the set.
-  bool ContainsWord(uint32_t word) const {
-    // We shouldn't call Overflow() since this is a const method.
-    if (auto bits = AsMask(word)) {
-      return (mask_ & bits) != 0;
-    } else if (auto overflow = overflow_.get()) {
-      return overflow->find(word) != overflow->end();
-    }
-    // The word is large, but the set doesn't have large members, so
-    // it doesn't have an overflow set.
-    return false;
+  // Returns the first bucket whose start is not less than |start|.
+  typename Buckets::iterator FindBucket(uint32_t start) {
+    return std::lower_bound(
+        buckets_.begin(), buckets_.end(), start,
+        [](const Bucket& bucket, uint32_t s) { return bucket.start < s; });
+  }
+  typename Buckets::const_iterator FindBucket(uint32_t start) const {
+    return std::lower_bound(
+        buckets_.begin(), buckets_.end(), start,
+        [](const Bucket& bucket, uint32_t s) { return bucket.start < s; });
   }
 
   // Returns the enum value as a uint32_t.
-  uint32_t ToWord(EnumType value) const {
+  static uint32_t ToWord(EnumType value) {
     static_assert(sizeof(EnumType) <= sizeof(uint32_t),
                   "EnumType must statically castable to uint32_t");
     return static_cast<uint32_t>(value);
   }
 
-  // Determines whether the given enum value can be represented
-  // as a bit in a uint64_t mask. If so, then returns that mask bit.
-  // Otherwise, returns 0.
-  uint64_t AsMask(uint32_t word) const {
-    if (word > 63) return 0;
-    return uint64_t(1) << word;
-  }
+  // Returns the start of the bucket of the given enum value.
+  static uint32_t BucketStart(uint32_t word) { return word & ~uint32_t(63); }
 
-  // Ensures that overflow_set_ references a set.  A new empty set is
-  // allocated if one doesn't exist yet.  Returns overflow_set_.
-  OverflowSetType& Overflow() {
-    if (overflow_.get() == nullptr) {
-      overflow_ = MakeUnique<OverflowSetType>();
-    }
-    return *overflow_;
-  }
+  // Returns the bit of the given enum value in the mask of its bucket.
+  static uint64_t AsMask(uint32_t word) { return uint64_t(1) << (word & 63); }
 
-  // Enums with values up to 63 are stored as bits in this mask.
-  uint64_t mask_ = 0;
-  // Enums with values larger than 63 are stored in this set.
-  // This set should normally be empty or very small.
-  std::unique_ptr<OverflowSetType> overflow_ = {};
+  // The buckets holding at least one value, in increasing order of start.
+  Buckets buckets_;
 };
 
-// A set of SpvCapability, optimized for small capability values.
+// A set of SpvCapability.
 using CapabilitySet = EnumSet<SpvCapability>;
 
 }  // namespace spvtools
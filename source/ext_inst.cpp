@@ -14,6 +14,7 @@
 
 #include "source/ext_inst.h"
 
+#include <algorithm>
 #include <cstring>
 
 // DebugInfo extended instruction set.
@@ -38,22 +39,40 @@
 #include "spv-amd-shader-trinary-minmax.insts.inc"
 
 static const spv_ext_inst_group_t kGroups_1_0[] = {
-    {SPV_EXT_INST_TYPE_GLSL_STD_450, ARRAY_SIZE(glsl_entries), glsl_entries},
-    {SPV_EXT_INST_TYPE_OPENCL_STD, ARRAY_SIZE(opencl_entries), opencl_entries},
+    {SPV_EXT_INST_TYPE_GLSL_STD_450, ARRAY_SIZE(glsl_entries), glsl_entries,
+     glsl_name_order, ARRAY_SIZE(glsl_value_index), glsl_value_index},
+    {SPV_EXT_INST_TYPE_OPENCL_STD, ARRAY_SIZE(opencl_entries), opencl_entries,
+     opencl_name_order, ARRAY_SIZE(opencl_value_index), opencl_value_index},
     {SPV_EXT_INST_TYPE_SPV_AMD_SHADER_EXPLICIT_VERTEX_PARAMETER,
      ARRAY_SIZE(spv_amd_shader_explicit_vertex_parameter_entries),
-     spv_amd_shader_explicit_vertex_parameter_entries},
+     spv_amd_shader_explicit_vertex_parameter_entries,
+     spv_amd_shader_explicit_vertex_parameter_name_order,
+     ARRAY_SIZE(spv_amd_shader_explicit_vertex_parameter_value_index),
+     spv_amd_shader_explicit_vertex_parameter_value_index},
     {SPV_EXT_INST_TYPE_SPV_AMD_SHADER_TRINARY_MINMAX,
      ARRAY_SIZE(spv_amd_shader_trinary_minmax_entries),
-     spv_amd_shader_trinary_minmax_entries},
+     spv_amd_shader_trinary_minmax_entries,
+     spv_amd_shader_trinary_minmax_name_order,
+     ARRAY_SIZE(spv_amd_shader_trinary_minmax_value_index),
+     spv_amd_shader_trinary_minmax_value_index},
     {SPV_EXT_INST_TYPE_SPV_AMD_GCN_SHADER,
-     ARRAY_SIZE(spv_amd_gcn_shader_entries), spv_amd_gcn_shader_entries},
+     ARRAY_SIZE(spv_amd_gcn_shader_entries), spv_amd_gcn_shader_entries,
+     spv_amd_gcn_shader_name_order,
+     ARRAY_SIZE(spv_amd_gcn_shader_value_index),
+     spv_amd_gcn_shader_value_index},
     {SPV_EXT_INST_TYPE_SPV_AMD_SHADER_BALLOT,
-     ARRAY_SIZE(spv_amd_shader_ballot_entries), spv_amd_shader_ballot_entries},
+     ARRAY_SIZE(spv_amd_shader_ballot_entries), spv_amd_shader_ballot_entries,
+     spv_amd_shader_ballot_name_order,
+     ARRAY_SIZE(spv_amd_shader_ballot_value_index),
+     spv_amd_shader_ballot_value_index},
     {SPV_EXT_INST_TYPE_DEBUGINFO, ARRAY_SIZE(debuginfo_entries),
-     debuginfo_entries},
+     debuginfo_entries, debuginfo_name_order,
+     ARRAY_SIZE(debuginfo_value_index), debuginfo_value_index},
     {SPV_EXT_INST_TYPE_OPENCL_DEBUGINFO_100,
-     ARRAY_SIZE(opencl_debuginfo_100_entries), opencl_debuginfo_100_entries},
+     ARRAY_SIZE(opencl_debuginfo_100_entries), opencl_debuginfo_100_entries,
+     opencl_debuginfo_100_name_order,
+     ARRAY_SIZE(opencl_debuginfo_100_value_index),
+     opencl_debuginfo_100_value_index},
 };
 
 static const spv_ext_inst_table_t kTable_1_0 = {ARRAY_SIZE(kGroups_1_0),
@@ -146,6 +165,21 @@ bool spvExtInstIsDebugInfo(const spv_ext_inst_type_t type) {
   return false;
 }
 
+namespace {
+
+// Returns the group of |table| for the extended instruction set |type|, or
+// null if there is none.
+const spv_ext_inst_group_t* FindGroup(const spv_ext_inst_table table,
+                                      const spv_ext_inst_type_t type) {
+  for (uint32_t groupIndex = 0; groupIndex < table->count; groupIndex++) {
+    const auto& group = table->groups[groupIndex];
+    if (type == group.type) return &group;
+  }
+  return nullptr;
+}
+
+}  // namespace
+
 spv_result_t spvExtInstTableNameLookup(const spv_ext_inst_table table,
                                        const spv_ext_inst_type_t type,
                                        const char* name,
@@ -153,19 +187,22 @@ spv_result_t spvExtInstTableNameLookup(const spv_ext_inst_table table,
   if (!table) return SPV_ERROR_INVALID_TABLE;
   if (!pEntry) return SPV_ERROR_INVALID_POINTER;
 
-  for (uint32_t groupIndex = 0; groupIndex < table->count; groupIndex++) {
-    const auto& group = table->groups[groupIndex];
-    if (type != group.type) continue;
-    for (uint32_t index = 0; index < group.count; index++) {
-      const auto& entry = group.entries[index];
-      if (!strcmp(name, entry.name)) {
-        *pEntry = &entry;
-        return SPV_SUCCESS;
-      }
-    }
+  const spv_ext_inst_group_t* group = FindGroup(table, type);
+  if (!group) return SPV_ERROR_INVALID_LOOKUP;
+
+  // Binary search the index sorted by name for the first entry with the
+  // given name.
+  const uint16_t* const order_end = group->name_order + group->count;
+  const uint16_t* order = std::lower_bound(
+      group->name_order, order_end, name,
+      [group](uint16_t index, const char* needle) {
+        return strcmp(group->entries[index].name, needle) < 0;
+      });
+  if (order == order_end || strcmp(group->entries[*order].name, name)) {
+    return SPV_ERROR_INVALID_LOOKUP;
   }
-
-  return SPV_ERROR_INVALID_LOOKUP;
+  *pEntry = &group->entries[*order];
+  return SPV_SUCCESS;
 }
 
 spv_result_t spvExtInstTableValueLookup(const spv_ext_inst_table table,
@@ -175,17 +212,11 @@ spv_result_t spvExtInstTableValueLookup(const spv_ext_inst_table table,
   if (!table) return SPV_ERROR_INVALID_TABLE;
   if (!pEntry) return SPV_ERROR_INVALID_POINTER;
 
-  for (uint32_t groupIndex = 0; groupIndex < table->count; groupIndex++) {
-    const auto& group = table->groups[groupIndex];
-    if (type != group.type) continue;
-    for (uint32_t index = 0; index < group.count; index++) {
-      const auto& entry = group.entries[index];
-      if (value == entry.ext_inst) {
-        *pEntry = &entry;
-        return SPV_SUCCESS;
-      }
-    }
-  }
+  const spv_ext_inst_group_t* group = FindGroup(table, type);
+  if (!group || value >= group->value_count) return SPV_ERROR_INVALID_LOOKUP;
 
-  return SPV_ERROR_INVALID_LOOKUP;
+  const uint16_t index = group->value_index[value];
+  if (index == 0xFFFF) return SPV_ERROR_INVALID_LOOKUP;
+  *pEntry = &group->entries[index];
+  return SPV_SUCCESS;
 }
@@ -12,16 +12,17 @@
 // See the License for the specific language governing permissions and
 // limitations under the License.
 
+
 #ifndef SOURCE_FUZZ_EQUIVALENCE_RELATION_H_
 #define SOURCE_FUZZ_EQUIVALENCE_RELATION_H_
 
-#include <memory>
+#include <cassert>
+#include <cstdint>
+#include <deque>
 #include <unordered_map>
-#include <unordered_set>
+#include <utility>
 #include <vector>
 
-#include "source/util/make_unique.h"
-
 namespace spvtools {
 namespace fuzz {
 
@@ -32,20 +33,24 @@ namespace fuzz {
 // of type |T|.
 //
 // A disjoint-set (a.k.a. union-find or merge-find) data structure is used to
-// represent the equivalence relation.  Path compression is used.  Union by
-// rank/size is not used.
+// represent the equivalence relation, with path compression and union by
+// rank, so that finding the representative of a value takes amortized almost
+// constant time.
 //
-// Each disjoint set is represented as a tree, rooted at the representative
-// of the set.
-//
-// Getting the representative of a value simply requires chasing parent pointers
-// from the value until you reach the root.
+// Each unique (up to equality) value added to the relation is copied into
+// |values_|, so there is one canonical memory address per unique value, and
+// is identified by its index in |values_|.  |index_of_| maps a value, via
+// |PointerHashT| and |PointerEqualsT|, to this index.  The links of the
+// disjoint-set forest are kept in arrays indexed by these indices.
 //
-// Checking equivalence of two elements requires checking that the
-// representatives are equal.
+// Each disjoint set is represented as a tree, rooted at the representative
+// of the set.  Getting the representative of a value requires chasing parent
+// links from the value until you reach the root.  Checking equivalence of two
+// elements requires checking that the representatives are equal.
 //
-// Traversing the tree rooted at a value's representative visits the value's
-// equivalence class.
+// The members of each set are also linked in a circular list, so that the
+// equivalence class of a value can be visited without visiting other values.
+// Merging two sets splices their lists together in constant time.
 //
 // |PointerHashT| and |PointerEqualsT| are used to define *equality* between
 // values, and otherwise are *not* used to define the equivalence relation
@@ -58,13 +63,6 @@ namespace fuzz {
 // IDs in a SPIR-V binary that are known to contain the same value at run time,
 // but clearly 1 != 5.  Since 1 and 1 are equal, IsEquivalent(1, 1) will also
 // hold.
-//
-// Each unique (up to equality) value added to the relation is copied into
-// |owned_values_|, so there is one canonical memory address per unique value.
-// Uniqueness is ensured by storing (and checking) a set of pointers to these
-// values in |value_set_|, which uses |PointerHashT| and |PointerEqualsT|.
-//
-// |parent_| and |children_| encode the equivalence relation, i.e., the trees.
 template <typename T, typename PointerHashT, typename PointerEqualsT>
 class EquivalenceRelation {
  public:
@@ -73,76 +71,63 @@ class EquivalenceRelation {
   // is added to the pool of values known to be in the relation.
   void MakeEquivalent(const T& value1, const T& value2) {
     // Register each value if necessary.
-    for (auto value : {value1, value2}) {
-      if (!Exists(value)) {
-        // Register the value in the equivalence relation.  This relies on
-        // T having a copy constructor.
-        auto unique_pointer_to_value = MakeUnique<T>(value);
-        auto pointer_to_value = unique_pointer_to_value.get();
-        owned_values_.push_back(std::move(unique_pointer_to_value));
-        value_set_.insert(pointer_to_value);
-
-        // Initially say that the value is its own parent and that it has no
-        // children.
-        assert(pointer_to_value && "Representatives should never be null.");
-        parent_[pointer_to_value] = pointer_to_value;
-        children_[pointer_to_value] = std::vector<const T*>();
-      }
-    }
+    const uint32_t index1 = RegisterIndex(value1);
+    const uint32_t index2 = RegisterIndex(value2);
 
-    // Look up canonical pointers to each of the values in the value pool.
-    const T* value1_ptr = *value_set_.find(&value1);
-    const T* value2_ptr = *value_set_.find(&value2);
-
-    // If the values turn out to be identical, they are already in the same
-    // equivalence class so there is nothing to do.
-    if (value1_ptr == value2_ptr) {
+    // Find the representative for each value's equivalence class, and if they
+    // are not already in the same class, make the root of lower rank a child
+    // of the other one.
+    uint32_t representative1 = FindIndex(index1);
+    uint32_t representative2 = FindIndex(index2);
+    if (representative1 == representative2) {
       return;
     }
-
-    // Find the representative for each value's equivalence class, and if they
-    // are not already in the same class, make one the parent of the other.
-    const T* representative1 = Find(value1_ptr);
-    const T* representative2 = Find(value2_ptr);
-    assert(representative1 && "Representatives should never be null.");
-    assert(representative2 && "Representatives should never be null.");
-    if (representative1 != representative2) {
-      parent_[representative1] = representative2;
-      children_[representative2].push_back(representative1);
+    if (rank_[representative1] > rank_[representative2]) {
+      std::swap(representative1, representative2);
+    } else if (rank_[representative1] == rank_[representative2]) {
+      ++rank_[representative2];
     }
+    parent_[representative1] = representative2;
+
+    // Splice the circular lists of members of the two classes.
+    std::swap(next_[representative1], next_[representative2]);
+  }
+
+  // Adds |value| to the pool of values known to be in the equivalence
+  // relation, in an equivalence class of its own, if it is not already known.
+  // Returns the canonical pointer to the value in the pool.
+  const T* Register(const T& value) { return &values_[RegisterIndex(value)]; }
+
+  // Returns the representative of the equivalence class of |value|, which must
+  // already be known to the equivalence relation.
+  const T* GetRepresentative(const T& value) const {
+    return &values_[FindIndex(GetIndex(value))];
   }
 
   // Returns exactly one representative per equivalence class.
   std::vector<const T*> GetEquivalenceClassRepresentatives() const {
     std::vector<const T*> result;
-    for (auto& value : owned_values_) {
-      if (parent_[value.get()] == value.get()) {
-        result.push_back(value.get());
+    for (uint32_t index = 0; index < parent_.size(); ++index) {
+      if (parent_[index] == index) {
+        result.push_back(&values_[index]);
       }
     }
     return result;
   }
 
   // Returns pointers to all values in the equivalence class of |value|, which
-  // must already be part of the equivalence relation.
+  // must already be part of the equivalence relation.  The representative of
+  // the class comes first.
   std::vector<const T*> GetEquivalenceClass(const T& value) const {
     assert(Exists(value));
 
     std::vector<const T*> result;
-
-    // Traverse the tree of values rooted at the representative of the
-    // equivalence class to which |value| belongs, and collect up all the values
-    // that are encountered.  This constitutes the whole equivalence class.
-    std::vector<const T*> stack;
-    stack.push_back(Find(*value_set_.find(&value)));
-    while (!stack.empty()) {
-      const T* item = stack.back();
-      result.push_back(item);
-      stack.pop_back();
-      for (auto child : children_[item]) {
-        stack.push_back(child);
-      }
-    }
+    const uint32_t representative = FindIndex(GetIndex(value));
+    uint32_t index = representative;
+    do {
+      result.push_back(&values_[index]);
+      index = next_[index];
+    } while (index != representative);
     return result;
   }
 
@@ -150,14 +135,16 @@ class EquivalenceRelation {
   // equivalence class.  Both values must already be known to the equivalence
   // relation.
   bool IsEquivalent(const T& value1, const T& value2) const {
-    return Find(&value1) == Find(&value2);
+    return FindIndex(GetIndex(value1)) == FindIndex(GetIndex(value2));
   }
 
-  // Returns all values known to be part of the equivalence relation.
+  // Returns all values known to be part of the equivalence relation, in the
+  // order in which they were added.
   std::vector<const T*> GetAllKnownValues() const {
     std::vector<const T*> result;
-    for (auto& value : owned_values_) {
-      result.push_back(value.get());
+    result.reserve(values_.size());
+    for (auto& value : values_) {
+      result.push_back(&value);
     }
     return result;
   }
@@ -165,70 +152,83 @@ class EquivalenceRelation {
   // Returns true if and only if |value| is known to be part of the equivalence
   // relation.
   bool Exists(const T& value) const {
-    return value_set_.find(&value) != value_set_.end();
+    return index_of_.find(&value) != index_of_.end();
   }
 
  private:
-  // Returns the representative of the equivalence class of |value|, which must
-  // already be known to the equivalence relation.  This is the 'Find' operation
-  // in a classic union-find data structure.
-  const T* Find(const T* value) const {
-    assert(Exists(*value));
+  // Returns the index of |value|, adding it to the pool of values in a class
+  // of its own if it is not already known.
+  uint32_t RegisterIndex(const T& value) {
+    auto existing = index_of_.find(&value);
+    if (existing != index_of_.end()) {
+      return existing->second;
+    }
 
-    // Get the canonical pointer to the value from the value pool.
-    const T* known_value = *value_set_.find(value);
-    assert(parent_[known_value] && "Every known value should have a parent.");
+    // Register the value in the equivalence relation.  This relies on T having
+    // a copy constructor.  A deque never moves its elements when it grows, so
+    // the canonical pointer to the value remains valid.
+    const uint32_t index = static_cast<uint32_t>(values_.size());
+    values_.push_back(value);
+    index_of_.emplace(&values_.back(), index);
+
+    // Initially say that the value is its own parent, and the only member of
+    // its class.
+    parent_.push_back(index);
+    rank_.push_back(0);
+    next_.push_back(index);
+    return index;
+  }
 
+  // Returns the index of |value|, which must already be known to the
+  // equivalence relation.
+  uint32_t GetIndex(const T& value) const {
+    assert(Exists(value));
+    return index_of_.find(&value)->second;
+  }
+
+  // Returns the index of the representative of the equivalence class of the
+  // value at |index|.  This is the 'Find' operation in a classic union-find
+  // data structure.
+  uint32_t FindIndex(uint32_t index) const {
     // Compute the result by chasing parents until we find a value that is its
     // own parent.
-    const T* result = known_value;
+    uint32_t result = index;
     while (parent_[result] != result) {
       result = parent_[result];
     }
-    assert(result && "Representatives should never be null.");
 
-    // At this point, |result| is the representative of the equivalence class.
     // Now perform the 'path compression' optimization by doing another pass up
     // the parent chain, setting the parent of each node to be the
-    // representative, and rewriting children correspondingly.
-    const T* current = known_value;
-    while (parent_[current] != result) {
-      const T* next = parent_[current];
-      parent_[current] = result;
-      children_[result].push_back(current);
-      auto child_iterator =
-          std::find(children_[next].begin(), children_[next].end(), current);
-      assert(child_iterator != children_[next].end() &&
-             "'next' is the parent of 'current', so 'current' should be a "
-             "child of 'next'");
-      children_[next].erase(child_iterator);
-      current = next;
+    // representative.
+    while (parent_[index] != result) {
+      const uint32_t next = parent_[index];
+      parent_[index] = result;
+      index = next;
     }
     return result;
   }
 
-  // Maps every value to a parent.  The representative of an equivalence class
-  // is its own parent.  A value's representative can be found by walking its
-  // chain of ancestors.
-  //
-  // Mutable because the intuitively const method, 'Find', performs path
-  // compression.
-  mutable std::unordered_map<const T*, const T*> parent_;
+  // The values known to the equivalence relation.
+  std::deque<T> values_;
+
+  // Maps every known value to its index in |values_|.
+  std::unordered_map<const T*, uint32_t, PointerHashT, PointerEqualsT>
+      index_of_;
 
-  // Stores the children of each value.  This allows the equivalence class of
-  // a value to be calculated by traversing all descendents of the class's
-  // representative.
+  // Maps the index of every value to the index of its parent.  The
+  // representative of an equivalence class is its own parent.
   //
-  // Mutable because the intuitively const method, 'Find', performs path
+  // Mutable because the intuitively const method, 'FindIndex', performs path
   // compression.
-  mutable std::unordered_map<const T*, std::vector<const T*>> children_;
-
-  // The values known to the equivalence relation are allocated in
-  // |owned_values_|, and |value_pool_| provides (via |PointerHashT| and
-  // |PointerEqualsT|) a means for mapping a value of interest to a pointer
-  // into an equivalent value in |owned_values_|.
-  std::unordered_set<const T*, PointerHashT, PointerEqualsT> value_set_;
-  std::vector<std::unique_ptr<T>> owned_values_;
+  mutable std::vector<uint32_t> parent_;
+
+  // Maps the index of every representative to an upper bound on the height of
+  // its tree.
+  std::vector<uint8_t> rank_;
+
+  // Maps the index of every value to the index of the next value of its
+  // equivalence class, in a circular list.
+  std::vector<uint32_t> next_;
 };
 
 }  // namespace fuzz
@@ -14,6 +14,7 @@
 
 #include "source/fuzz/fact_manager.h"
 
+#include <algorithm>
 #include <sstream>
 #include <unordered_map>
 #include <unordered_set>
@@ -28,6 +29,18 @@ namespace fuzz {
 
 namespace {
 
+// Orders the data descriptors by object, and then by indices.
+bool DataDescriptorLess(const protobufs::DataDescriptor& first,
+                        const protobufs::DataDescriptor& second) {
+  if (first.object() != second.object()) {
+    return first.object() < second.object();
+  }
+  return std::lexicographical_compare(first.index().begin(),
+                                      first.index().end(),
+                                      second.index().begin(),
+                                      second.index().end());
+}
+
 std::string ToString(const protobufs::Fact& fact) {
   assert(fact.fact_case() == protobufs::Fact::kConstantUniformFact &&
          "Right now this is the only fact we know how to stringify.");
@@ -355,20 +368,36 @@ class FactManager::DataSynonymFacts {
                     opt::IRContext* context) const;
 
  private:
+  using DataDescriptorPair =
+      std::pair<protobufs::DataDescriptor, protobufs::DataDescriptor>;
+
   // Adds |fact| to the set of managed facts, and recurses into sub-components
   // of the data descriptors referenced in |fact|, if they are composites, to
   // record that their components are pairwise-synonymous.
   void AddFactRecursive(const protobufs::FactDataSynonym& fact,
                         opt::IRContext* context);
 
-  // Inspects all known facts and adds corollary facts; e.g. if we know that
-  // a.x == b.x and a.y == b.y, where a and b have vec2 type, we can record
-  // that a == b holds.
+  // Records that |dd1| and |dd2| are synonymous, and deduces the corollary
+  // facts; e.g. if we know that a.x == b.x and that a.y is now synonymous with
+  // b.y, where a and b have vec2 type, we can record that a == b holds.
   //
-  // This method is expensive, and is thus called on demand: rather than
-  // computing the closure of facts each time a data synonym fact is added, we
-  // compute the closure only when a data synonym fact is *queried*.
-  void ComputeClosureOfFacts(opt::IRContext* context) const;
+  // The facts are deduced as the equivalence classes are merged, rather than
+  // by inspecting all known facts: when two classes are merged, only the pairs
+  // of data descriptors of the two classes become synonymous.
+  void MakeEquivalent(const protobufs::DataDescriptor& dd1,
+                      const protobufs::DataDescriptor& dd2,
+                      opt::IRContext* context);
+
+  // Records that |dd1| and |dd2|, which have the forms
+  //   obj_1[a_1, ..., a_m, i]
+  //   obj_2[b_1, ..., b_n, i]
+  // have become synonymous.  If obj_1[a_1, ..., a_m] and obj_2[b_1, ..., b_n]
+  // are then known to be synonymous at every index, adds the pair to
+  // |worklist| to be made synonymous.
+  void AddComponentSynonym(const protobufs::DataDescriptor& dd1,
+                           const protobufs::DataDescriptor& dd2,
+                           opt::IRContext* context,
+                           std::vector<DataDescriptorPair>* worklist);
 
   // Returns true if and only if |dd1| and |dd2| are valid data descriptors
   // whose associated data have the same type.
@@ -378,28 +407,62 @@ class FactManager::DataSynonymFacts {
 
   // The data descriptors that are known to be synonymous with one another are
   // captured by this equivalence relation.
-  //
-  // This member is mutable in order to allow the closure of facts captured by
-  // the relation to be computed lazily when a question about data synonym
-  // facts is asked.
-  mutable EquivalenceRelation<protobufs::DataDescriptor, DataDescriptorHash,
-                              DataDescriptorEquals>
+  EquivalenceRelation<protobufs::DataDescriptor, DataDescriptorHash,
+                      DataDescriptorEquals>
       synonymous_;
 
-  // When a new synonym fact is added, it may be possible to deduce further
-  // synonym facts by computing a closure of all known facts.  However, there is
-  // no point computing this closure until a question regarding synonym facts is
-  // actually asked: if several facts are added in succession with no questions
-  // asked in between, we can avoid computing fact closures multiple times.
-  //
-  // This boolean tracks whether a closure computation is required - i.e.,
-  // whether a new fact has been added since the last time such a computation
-  // was performed.
+  // The data descriptors with at least one index of an equivalence class,
+  // grouped by their last index.
+  struct IndexedDataDescriptors {
+    size_t size = 0;
+    std::unordered_map<uint32_t, std::vector<const protobufs::DataDescriptor*>>
+        by_last_index;
+  };
+
+  // The data descriptors with at least one index of each equivalence class
+  // which has some, keyed by the representative of the class.
+  std::unordered_map<const protobufs::DataDescriptor*, IndexedDataDescriptors>
+      indexed_data_descriptors_;
+
+  struct DataDescriptorPairHash {
+    std::size_t operator()(const DataDescriptorPair& pair) const {
+      return DataDescriptorHash()(&pair.first) ^
+             DataDescriptorHash()(&pair.second);
+    }
+  };
+
+  struct DataDescriptorPairEquals {
+    bool operator()(const DataDescriptorPair& first,
+                    const DataDescriptorPair& second) const {
+      return DataDescriptorEquals()(&first.first, &second.first) &&
+             DataDescriptorEquals()(&first.second, &second.second);
+    }
+  };
+
+  // This map records, for a given pair of composite data descriptors of the
+  // same type, all the indices at which the data descriptors are known to be
+  // synonymous.  A pair is a key to this map only if we have observed that
+  // the pair are synonymous at *some* index, but not at *all* indices.
+  // Once we find that a pair of data descriptors are equivalent at all indices
+  // we record the fact that they are synonymous and remove them from the map.
+  // The data descriptors of each pair are ordered by DataDescriptorLess.
   //
-  // It is mutable so faciliate having const methods, that provide answers to
-  // questions about data synonym facts, triggering closure computation on
-  // demand.
-  mutable bool closure_computation_required = false;
+  // For example, if m is a mat4x4 and v a vec4, initially the pair (m[2], v)
+  // would not be a key to the map.  If we find that m[2, 2] == v[2] holds, we
+  // would add an entry:
+  //   (m[2], v) -> [false, false, true, false]
+  // to record that they are synonymous at index 2.  If we then find that
+  // m[2, 0] == v[0] holds, we would update this entry to:
+  //   (m[2], v) -> [true, false, true, false]
+  // If we then find that m[2, 3] == v[3] holds, we would update this entry to:
+  //   (m[2], v) -> [true, false, true, true]
+  // Finally, if we then find that m[2, 1] == v[1] holds, which would make the
+  // boolean vector true at every index, we would add the fact:
+  //   m[2] == v
+  // to the equivalence relation and remove (m[2], v) from the map.
+  std::unordered_map<DataDescriptorPair, std::vector<bool>,
+                     DataDescriptorPairHash, DataDescriptorPairEquals>
+      candidate_composite_synonyms_;
 };
 
 void FactManager::DataSynonymFacts::AddFact(
@@ -415,12 +478,7 @@ void FactManager::DataSynonymFacts::AddFactRecursive(
                                                    fact.data2()));
 
   // Record that the data descriptors provided in the fact are equivalent.
-  synonymous_.MakeEquivalent(fact.data1(), fact.data2());
-  // As we have updated the equivalence relation, we might be able to deduce
-  // more facts by performing a closure computation, so we record that such a
-  // computation is required; it will be performed next time a method answering
-  // a data synonym fact-related question is invoked.
-  closure_computation_required = true;
+  MakeEquivalent(fact.data1(), fact.data2(), context);
 
   // We now check whether this is a synonym about composite objects.  If it is,
   // we can recursively add synonym facts about their associated sub-components.
@@ -474,16 +532,13 @@ void FactManager::DataSynonymFacts::AddFactRecursive(
   }
 }
 
-void FactManager::DataSynonymFacts::ComputeClosureOfFacts(
-    opt::IRContext* context) const {
+void FactManager::DataSynonymFacts::MakeEquivalent(
+    const protobufs::DataDescriptor& dd1, const protobufs::DataDescriptor& dd2,
+    opt::IRContext* context) {
   // Suppose that obj_1[a_1, ..., a_m] and obj_2[b_1, ..., b_n] are distinct
   // data descriptors that describe objects of the same composite type, and that
   // the composite type is comprised of k components.
   //
-  // For example, if m is a mat4x4 and v a vec4, we might consider:
-  //   m[2]: describes the 2nd column of m, a vec4
-  //   v[]: describes all of v, a vec4
-  //
   // Suppose that we know, for every 0 <= i < k, that the fact:
   //   obj_1[a_1, ..., a_m, i] == obj_2[b_1, ..., b_n, i]
   // holds - i.e. that the children of the two data descriptors are synonymous.
@@ -492,261 +547,186 @@ void FactManager::DataSynonymFacts::ComputeClosureOfFacts(
   //   obj_1[a_1, ..., a_m] == obj_2[b_1, ..., b_n]
   // holds.
   //
-  // For instance, if we have the facts:
-  //   m[2, 0] == v[0]
-  //   m[2, 1] == v[1]
-  //   m[2, 2] == v[2]
-  //   m[2, 3] == v[3]
-  // then we can conclude that:
-  //   m[2] == v.
-  //
-  // This method repeatedly searches the equivalence relation of data
-  // descriptors, deducing and adding such facts, until a pass over the
-  // relation leads to no further facts being deduced.
-
-  // The method relies on working with pairs of data descriptors, and in
-  // particular being able to hash and compare such pairs.
-
-  using DataDescriptorPair =
-      std::pair<protobufs::DataDescriptor, protobufs::DataDescriptor>;
+  // Each pair of data descriptors becomes synonymous exactly once: when their
+  // equivalence classes are merged.  The pairs of the form
+  //   obj_1[a_1, ..., a_m, i]
+  //   obj_2[b_1, ..., b_n, i]
+  // are found then, from the data descriptors of the two classes indexed by
+  // their last index, and recorded in |candidate_composite_synonyms_|.  The
+  // merges that this deduces are made in turn, from a worklist.
+  std::vector<DataDescriptorPair> worklist;
+  worklist.emplace_back(dd1, dd2);
+  while (!worklist.empty()) {
+    DataDescriptorPair pair = std::move(worklist.back());
+    worklist.pop_back();
+
+    const protobufs::DataDescriptor* values[2];
+    const protobufs::DataDescriptor* representatives[2];
+    for (int i = 0; i < 2; i++) {
+      const protobufs::DataDescriptor& value =
+          i == 0 ? pair.first : pair.second;
+      const bool is_new = !synonymous_.Exists(value);
+      values[i] = synonymous_.Register(value);
+      if (is_new && value.index_size() > 0) {
+        // A new value is in a class of its own.
+        auto& indexed = indexed_data_descriptors_[values[i]];
+        indexed.size = 1;
+        indexed.by_last_index[value.index(value.index_size() - 1)].push_back(
+            values[i]);
+      }
+      representatives[i] = synonymous_.GetRepresentative(*values[i]);
+    }
+    if (representatives[0] == representatives[1]) {
+      continue;
+    }
 
-  struct DataDescriptorPairHash {
-    std::size_t operator()(const DataDescriptorPair& pair) const {
-      return DataDescriptorHash()(&pair.first) ^
-             DataDescriptorHash()(&pair.second);
+    // Take the indexed data descriptors of the two classes, and merge the
+    // smaller group into the larger one, finding the pairs with the same last
+    // index on the way.
+    IndexedDataDescriptors groups[2];
+    for (int i = 0; i < 2; i++) {
+      auto it = indexed_data_descriptors_.find(representatives[i]);
+      if (it != indexed_data_descriptors_.end()) {
+        groups[i] = std::move(it->second);
+        indexed_data_descriptors_.erase(it);
+      }
     }
-  };
+    IndexedDataDescriptors& larger =
+        groups[0].size >= groups[1].size ? groups[0] : groups[1];
+    IndexedDataDescriptors& smaller =
+        groups[0].size >= groups[1].size ? groups[1] : groups[0];
+    for (auto& entry : smaller.by_last_index) {
+      auto& larger_group = larger.by_last_index[entry.first];
+      for (auto smaller_dd : entry.second) {
+        for (auto larger_dd : larger_group) {
+          AddComponentSynonym(*smaller_dd, *larger_dd, context, &worklist);
+        }
+      }
+      larger_group.insert(larger_group.end(), entry.second.begin(),
+                          entry.second.end());
+    }
+    larger.size += smaller.size;
 
-  struct DataDescriptorPairEquals {
-    bool operator()(const DataDescriptorPair& first,
-                    const DataDescriptorPair& second) const {
-      return DataDescriptorEquals()(&first.first, &second.first) &&
-             DataDescriptorEquals()(&first.second, &second.second);
+    synonymous_.MakeEquivalent(*values[0], *values[1]);
+    if (larger.size > 0) {
+      indexed_data_descriptors_[synonymous_.GetRepresentative(*values[0])] =
+          std::move(larger);
     }
-  };
+  }
+}
 
-  // This map records, for a given pair of composite data descriptors of the
-  // same type, all the indices at which the data descriptors are known to be
-  // synonymous.  A pair is a key to this map only if we have observed that
-  // the pair are synonymous at *some* index, but not at *all* indices.
-  // Once we find that a pair of data descriptors are equivalent at all indices
-  // we record the fact that they are synonymous and remove them from the map.
-  //
-  // Using the m and v example from above, initially the pair (m[2], v) would
-  // not be a key to the map.  If we find that m[2, 2] == v[2] holds, we would
-  // add an entry:
-  //   (m[2], v) -> [false, false, true, false]
-  // to record that they are synonymous at index 2.  If we then find that
-  // m[2, 0] == v[0] holds, we would update this entry to:
-  //   (m[2], v) -> [true, false, true, false]
-  // If we then find that m[2, 3] == v[3] holds, we would update this entry to:
-  //   (m[2], v) -> [true, false, true, true]
-  // Finally, if we then find that m[2, 1] == v[1] holds, which would make the
-  // boolean vector true at every index, we would add the fact:
-  //   m[2] == v
-  // to the equivalence relation and remove (m[2], v) from the map.
-  std::unordered_map<DataDescriptorPair, std::vector<bool>,
-                     DataDescriptorPairHash, DataDescriptorPairEquals>
-      candidate_composite_synonyms;
-
-  // We keep looking for new facts until we perform a complete pass over the
-  // equivalence relation without finding any new facts.
-  while (closure_computation_required) {
-    // We have not found any new facts yet during this pass; we set this to
-    // 'true' if we do find a new fact.
-    closure_computation_required = false;
-
-    // Consider each class in the equivalence relation.
-    for (auto representative :
-         synonymous_.GetEquivalenceClassRepresentatives()) {
-      auto equivalence_class = synonymous_.GetEquivalenceClass(*representative);
-
-      // Consider every data descriptor in the equivalence class.
-      for (auto dd1_it = equivalence_class.begin();
-           dd1_it != equivalence_class.end(); ++dd1_it) {
-        // If this data descriptor has no indices then it does not have the form
-        // obj_1[a_1, ..., a_m, i], so move on.
-        auto dd1 = *dd1_it;
-        if (dd1->index_size() == 0) {
-          continue;
-        }
+void FactManager::DataSynonymFacts::AddComponentSynonym(
+    const protobufs::DataDescriptor& dd1, const protobufs::DataDescriptor& dd2,
+    opt::IRContext* context, std::vector<DataDescriptorPair>* worklist) {
+  assert(dd1.index_size() > 0 && dd2.index_size() > 0 &&
+         dd1.index(dd1.index_size() - 1) == dd2.index(dd2.index_size() - 1) &&
+         "The data descriptors should have the same last index.");
+  const uint32_t common_final_index = dd1.index(dd1.index_size() - 1);
+
+  // Make data descriptors |dd1_prefix| and |dd2_prefix| for
+  //   obj_1[a_1, ..., a_m]
+  // and
+  //   obj_2[b_1, ..., b_n]
+  // These are the two data descriptors we might be getting closer to
+  // deducing as being synonymous, due to knowing that they are synonymous
+  // when extended by a particular index.
+  protobufs::DataDescriptor dd1_prefix;
+  dd1_prefix.set_object(dd1.object());
+  for (uint32_t i = 0; i < static_cast<uint32_t>(dd1.index_size() - 1); i++) {
+    dd1_prefix.add_index(dd1.index(i));
+  }
+  protobufs::DataDescriptor dd2_prefix;
+  dd2_prefix.set_object(dd2.object());
+  for (uint32_t i = 0; i < static_cast<uint32_t>(dd2.index_size() - 1); i++) {
+    dd2_prefix.add_index(dd2.index(i));
+  }
+  assert(!DataDescriptorEquals()(&dd1_prefix, &dd2_prefix) &&
+         "By construction these prefixes should be different.");
 
-        // Consider every other data descriptor later in the equivalence class
-        // (due to symmetry, there is no need to compare with previous data
-        // descriptors).
-        auto dd2_it = dd1_it;
-        for (++dd2_it; dd2_it != equivalence_class.end(); ++dd2_it) {
-          auto dd2 = *dd2_it;
-          // If this data descriptor has no indices then it does not have the
-          // form obj_2[b_1, ..., b_n, i], so move on.
-          if (dd2->index_size() == 0) {
-            continue;
-          }
-
-          // At this point we know that:
-          // - |dd1| has the form obj_1[a_1, ..., a_m, i]
-          // - |dd2| has the form obj_2[b_1, ..., b_n, j]
-          assert(dd1->index_size() > 0 && dd2->index_size() > 0 &&
-                 "Control should not reach here if either data descriptor has "
-                 "no indices.");
-
-          // We are only interested if i == j.
-          if (dd1->index(dd1->index_size() - 1) !=
-              dd2->index(dd2->index_size() - 1)) {
-            continue;
-          }
-
-          const uint32_t common_final_index = dd1->index(dd1->index_size() - 1);
-
-          // Make data descriptors |dd1_prefix| and |dd2_prefix| for
-          //   obj_1[a_1, ..., a_m]
-          // and
-          //   obj_2[b_1, ..., b_n]
-          // These are the two data descriptors we might be getting closer to
-          // deducing as being synonymous, due to knowing that they are
-          // synonymous when extended by a particular index.
-          protobufs::DataDescriptor dd1_prefix;
-          dd1_prefix.set_object(dd1->object());
-          for (uint32_t i = 0; i < static_cast<uint32_t>(dd1->index_size() - 1);
-               i++) {
-            dd1_prefix.add_index(dd1->index(i));
-          }
-          protobufs::DataDescriptor dd2_prefix;
-          dd2_prefix.set_object(dd2->object());
-          for (uint32_t i = 0; i < static_cast<uint32_t>(dd2->index_size() - 1);
-               i++) {
-            dd2_prefix.add_index(dd2->index(i));
-          }
-          assert(!DataDescriptorEquals()(&dd1_prefix, &dd2_prefix) &&
-                 "By construction these prefixes should be different.");
-
-          // If we already know that these prefixes are synonymous, move on.
-          if (synonymous_.Exists(dd1_prefix) &&
-              synonymous_.Exists(dd2_prefix) &&
-              synonymous_.IsEquivalent(dd1_prefix, dd2_prefix)) {
-            continue;
-          }
-
-          // Get the type of obj_1
-          auto dd1_root_type_id =
-              context->get_def_use_mgr()->GetDef(dd1->object())->type_id();
-          // Use this type, together with a_1, ..., a_m, to get the type of
-          // obj_1[a_1, ..., a_m].
-          auto dd1_prefix_type = fuzzerutil::WalkCompositeTypeIndices(
-              context, dd1_root_type_id, dd1_prefix.index());
-
-          // Similarly, get the type of obj_2 and use it to get the type of
-          // obj_2[b_1, ..., b_n].
-          auto dd2_root_type_id =
-              context->get_def_use_mgr()->GetDef(dd2->object())->type_id();
-          auto dd2_prefix_type = fuzzerutil::WalkCompositeTypeIndices(
-              context, dd2_root_type_id, dd2_prefix.index());
-
-          // If the types of dd1_prefix and dd2_prefix are not the same, they
-          // cannot be synonymous.
-          if (dd1_prefix_type != dd2_prefix_type) {
-            continue;
-          }
-
-          // At this point, we know we have synonymous data descriptors of the
-          // form:
-          //   obj_1[a_1, ..., a_m, i]
-          //   obj_2[b_1, ..., b_n, i]
-          // with the same last_index i, such that:
-          //   obj_1[a_1, ..., a_m]
-          // and
-          //   obj_2[b_1, ..., b_n]
-          // have the same type.
-
-          // Work out how many components there are in the (common) commposite
-          // type associated with obj_1[a_1, ..., a_m] and obj_2[b_1, ..., b_n].
-          // This depends on whether the composite type is array, matrix, struct
-          // or vector.
-          uint32_t num_components_in_composite;
-          auto composite_type =
-              context->get_type_mgr()->GetType(dd1_prefix_type);
-          auto composite_type_instruction =
-              context->get_def_use_mgr()->GetDef(dd1_prefix_type);
-          if (composite_type->AsArray()) {
-            num_components_in_composite =
-                fuzzerutil::GetArraySize(*composite_type_instruction, context);
-            if (num_components_in_composite == 0) {
-              // This indicates that the array has an unknown size, in which
-              // case we cannot be sure we have matched all of its elements with
-              // synonymous elements of another array.
-              continue;
-            }
-          } else if (composite_type->AsMatrix()) {
-            num_components_in_composite =
-                composite_type->AsMatrix()->element_count();
-          } else if (composite_type->AsStruct()) {
-            num_components_in_composite = fuzzerutil::GetNumberOfStructMembers(
-                *composite_type_instruction);
-          } else {
-            assert(composite_type->AsVector());
-            num_components_in_composite =
-                composite_type->AsVector()->element_count();
-          }
-
-          // We are one step closer to being able to say that |dd1_prefix| and
-          // |dd2_prefix| are synonymous.
-          DataDescriptorPair candidate_composite_synonym(dd1_prefix,
-                                                         dd2_prefix);
-
-          // We look up what we already know about this pair.
-          auto existing_entry =
-              candidate_composite_synonyms.find(candidate_composite_synonym);
-
-          if (existing_entry == candidate_composite_synonyms.end()) {
-            // If this is the first time we have seen the pair, we make a vector
-            // of size |num_components_in_composite| that is 'true' at the
-            // common final index associated with |dd1| and |dd2|, and 'false'
-            // everywhere else, and register this vector as being associated
-            // with the pair.
-            std::vector<bool> entry;
-            for (uint32_t i = 0; i < num_components_in_composite; i++) {
-              entry.push_back(i == common_final_index);
-            }
-            candidate_composite_synonyms[candidate_composite_synonym] = entry;
-            existing_entry =
-                candidate_composite_synonyms.find(candidate_composite_synonym);
-          } else {
-            // We have seen this pair of data descriptors before, and we now
-            // know that they are synonymous at one further index, so we
-            // update the entry to record that.
-            existing_entry->second[common_final_index] = true;
-          }
-          assert(existing_entry != candidate_composite_synonyms.end());
-
-          // Check whether |dd1_prefix| and |dd2_prefix| are now known to match
-          // at every sub-component.
-          bool all_components_match = true;
-          for (uint32_t i = 0; i < num_components_in_composite; i++) {
-            if (!existing_entry->second[i]) {
-              all_components_match = false;
-              break;
-            }
-          }
-          if (all_components_match) {
-            // The two prefixes match on all sub-components, so we know that
-            // they are synonymous.  We add this fact *non-recursively*, as we
-            // have deduced that |dd1_prefix| and |dd2_prefix| are synonymous
-            // by observing that all their sub-components are already
-            // synonymous.
-            assert(DataDescriptorsAreWellFormedAndComparable(
-                context, dd1_prefix, dd2_prefix));
-            synonymous_.MakeEquivalent(dd1_prefix, dd2_prefix);
-            // As we have added a new synonym fact, we might benefit from doing
-            // another pass over the equivalence relation.
-            closure_computation_required = true;
-            // Now that we know this pair of data descriptors are synonymous,
-            // there is no point recording how close they are to being
-            // synonymous.
-            candidate_composite_synonyms.erase(candidate_composite_synonym);
-          }
-        }
-      }
+  // If we already know that these prefixes are synonymous, move on.
+  if (synonymous_.Exists(dd1_prefix) && synonymous_.Exists(dd2_prefix) &&
+      synonymous_.IsEquivalent(dd1_prefix, dd2_prefix)) {
+    return;
+  }
+
+  // Get the type of obj_1
+  auto dd1_root_type_id =
+      context->get_def_use_mgr()->GetDef(dd1.object())->type_id();
+  // Use this type, together with a_1, ..., a_m, to get the type of
+  // obj_1[a_1, ..., a_m].
+  auto dd1_prefix_type = fuzzerutil::WalkCompositeTypeIndices(
+      context, dd1_root_type_id, dd1_prefix.index());
+
+  // Similarly, get the type of obj_2 and use it to get the type of
+  // obj_2[b_1, ..., b_n].
+  auto dd2_root_type_id =
+      context->get_def_use_mgr()->GetDef(dd2.object())->type_id();
+  auto dd2_prefix_type = fuzzerutil::WalkCompositeTypeIndices(
+      context, dd2_root_type_id, dd2_prefix.index());
+
+  // If the types of dd1_prefix and dd2_prefix are not the same, they cannot
+  // be synonymous.
+  if (dd1_prefix_type != dd2_prefix_type) {
+    return;
+  }
+
+  // Work out how many components there are in the (common) commposite type
+  // associated with obj_1[a_1, ..., a_m] and obj_2[b_1, ..., b_n].  This
+  // depends on whether the composite type is array, matrix, struct or vector.
+  uint32_t num_components_in_composite;
+  auto composite_type = context->get_type_mgr()->GetType(dd1_prefix_type);
+  auto composite_type_instruction =
+      context->get_def_use_mgr()->GetDef(dd1_prefix_type);
+  if (composite_type->AsArray()) {
+    num_components_in_composite =
+        fuzzerutil::GetArraySize(*composite_type_instruction, context);
+    if (num_components_in_composite == 0) {
+      // This indicates that the array has an unknown size, in which case we
+      // cannot be sure we have matched all of its elements with synonymous
+      // elements of another array.
+      return;
     }
+  } else if (composite_type->AsMatrix()) {
+    num_components_in_composite = composite_type->AsMatrix()->element_count();
+  } else if (composite_type->AsStruct()) {
+    num_components_in_composite =
+        fuzzerutil::GetNumberOfStructMembers(*composite_type_instruction);
+  } else {
+    assert(composite_type->AsVector());
+    num_components_in_composite = composite_type->AsVector()->element_count();
+  }
+
+  // We are one step closer to being able to say that |dd1_prefix| and
+  // |dd2_prefix| are synonymous.  The pair is ordered, so that it is found
+  // whichever data descriptor comes first.
+  DataDescriptorPair candidate_composite_synonym =
+      DataDescriptorLess(dd2_prefix, dd1_prefix)
+          ? DataDescriptorPair(dd2_prefix, dd1_prefix)
+          : DataDescriptorPair(dd1_prefix, dd2_prefix);
+
+  // We look up what we already know about this pair.  If this is the first
+  // time we have seen the pair, we make a vector of size
+  // |num_components_in_composite| that is 'false' everywhere.
+  auto& entry = candidate_composite_synonyms_[candidate_composite_synonym];
+  if (entry.empty()) {
+    entry.resize(num_components_in_composite, false);
+  }
+  // We now know that they are synonymous at one further index.
+  entry[common_final_index] = true;
+
+  // Check whether |dd1_prefix| and |dd2_prefix| are now known to match at
+  // every sub-component.
+  if (std::find(entry.begin(), entry.end(), false) == entry.end()) {
+    // The two prefixes match on all sub-components, so we know that they are
+    // synonymous.  We add this fact *non-recursively*, as we have deduced that
+    // |dd1_prefix| and |dd2_prefix| are synonymous by observing that all their
+    // sub-components are already synonymous.
+    assert(DataDescriptorsAreWellFormedAndComparable(context, dd1_prefix,
+                                                     dd2_prefix));
+    // Now that we know this pair of data descriptors are synonymous, there is
+    // no point recording how close they are to being synonymous.
+    candidate_composite_synonyms_.erase(candidate_composite_synonym);
+    worklist->emplace_back(std::move(dd1_prefix), std::move(dd2_prefix));
   }
 }
 
@@ -765,8 +745,7 @@ bool FactManager::DataSynonymFacts::DataDescriptorsAreWellFormedAndComparable(
 std::vector<const protobufs::DataDescriptor*>
 FactManager::DataSynonymFacts::GetSynonymsForDataDescriptor(
     const protobufs::DataDescriptor& data_descriptor,
-    opt::IRContext* context) const {
-  ComputeClosureOfFacts(context);
+    opt::IRContext* /*unused*/) const {
   if (synonymous_.Exists(data_descriptor)) {
     return synonymous_.GetEquivalenceClass(data_descriptor);
   }
@@ -775,8 +754,7 @@ FactManager::DataSynonymFacts::GetSynonymsForDataDescriptor(
 
 std::vector<uint32_t>
 FactManager::DataSynonymFacts ::GetIdsForWhichSynonymsAreKnown(
-    opt::IRContext* context) const {
-  ComputeClosureOfFacts(context);
+    opt::IRContext* /*unused*/) const {
   std::vector<uint32_t> result;
   for (auto& data_descriptor : synonymous_.GetAllKnownValues()) {
     if (data_descriptor->index().empty()) {
@@ -789,9 +767,7 @@ FactManager::DataSynonymFacts ::GetIdsForWhichSynonymsAreKnown(
 bool FactManager::DataSynonymFacts::IsSynonymous(
     const protobufs::DataDescriptor& data_descriptor1,
     const protobufs::DataDescriptor& data_descriptor2,
-    opt::IRContext* context) const {
-  const_cast<FactManager::DataSynonymFacts*>(this)->ComputeClosureOfFacts(
-      context);
+    opt::IRContext* /*unused*/) const {
   return synonymous_.Exists(data_descriptor1) &&
          synonymous_.Exists(data_descriptor2) &&
          synonymous_.IsEquivalent(data_descriptor1, data_descriptor2);
@@ -852,18 +828,23 @@ bool FactManager::AddFact(const fuzz::protobufs::Fact& fact,
                           opt::IRContext* context) {
   switch (fact.fact_case()) {
     case protobufs::Fact::kConstantUniformFact:
-      return uniform_constant_facts_->AddFact(fact.constant_uniform_fact(),
-                                              context);
+      if (!uniform_constant_facts_->AddFact(fact.constant_uniform_fact(),
+                                            context)) {
+        return false;
+      }
+      break;
     case protobufs::Fact::kDataSynonymFact:
       data_synonym_facts_->AddFact(fact.data_synonym_fact(), context);
-      return true;
+      break;
     case protobufs::Fact::kBlockIsDeadFact:
       dead_block_facts_->AddFact(fact.block_is_dead_fact());
-      return true;
+      break;
     default:
       assert(false && "Unknown fact type.");
       return false;
   }
+  *added_facts_.add_fact() = fact;
+  return true;
 }
 
 void FactManager::AddFactDataSynonym(const protobufs::DataDescriptor& data1,
@@ -873,6 +854,7 @@ void FactManager::AddFactDataSynonym(const protobufs::DataDescriptor& data1,
   *fact.mutable_data1() = data1;
   *fact.mutable_data2() = data2;
   data_synonym_facts_->AddFact(fact, context);
+  *added_facts_.add_fact()->mutable_data_synonym_fact() = fact;
 }
 
 std::vector<uint32_t> FactManager::GetConstantsAvailableFromUniformsForType(
@@ -939,6 +921,7 @@ void FactManager::AddFactBlockIsDead(uint32_t block_id) {
   protobufs::FactBlockIsDead fact;
   fact.set_block_id(block_id);
   dead_block_facts_->AddFact(fact);
+  *added_facts_.add_fact()->mutable_block_is_dead_fact() = fact;
 }
 
 }  // namespace fuzz
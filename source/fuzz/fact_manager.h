@@ -61,6 +61,11 @@ class FactManager {
   // Records the fact that |block_id| is dead.
   void AddFactBlockIsDead(uint32_t block_id);
 
+  // Returns all the facts that have been added to the fact manager, in order,
+  // leaving out the invalid facts that were ignored.  Adding them to a new
+  // fact manager, with respect to the same module, yields the same facts.
+  const protobufs::FactSequence& GetAddedFacts() const { return added_facts_; }
+
   // The fact manager is responsible for managing a few distinct categories of
   // facts. In principle there could be different fact managers for each kind
   // of fact, but in practice providing one 'go to' place for facts is
@@ -159,6 +164,8 @@ class FactManager {
   class DeadBlockFacts;  // Opaque class for management of dead block facts.
   std::unique_ptr<DeadBlockFacts>
       dead_block_facts_;  // Unique pointer to internal data.
+
+  protobufs::FactSequence added_facts_;  // See GetAddedFacts.
 };
 
 }  // namespace fuzz
@@ -43,6 +43,7 @@
 #include "source/opt/build_module.h"
 #include "source/spirv_fuzzer_options.h"
 #include "source/util/make_unique.h"
+#include "source/val/validate.h"
 
 namespace spvtools {
 namespace fuzz {
@@ -81,9 +82,11 @@ struct Fuzzer::Impl {
         seed(random_seed),
         validate_after_each_fuzzer_pass(validate_after_each_pass) {}
 
+  // Applies |pass|, and then validates the module of |ir_context| with
+  // |validator| if it is not null.  Returns false if the module is invalid.
   bool ApplyPassAndCheckValidity(FuzzerPass* pass,
                                  const opt::IRContext& ir_context,
-                                 const spvtools::SpirvTools& tools) const;
+                                 spv_incremental_validator validator) const;
 
   const spv_target_env target_env;       // Target environment.
   const uint32_t seed;                   // Seed for random number generator.
@@ -104,12 +107,12 @@ void Fuzzer::SetMessageConsumer(MessageConsumer c) {
 
 bool Fuzzer::Impl::ApplyPassAndCheckValidity(
     FuzzerPass* pass, const opt::IRContext& ir_context,
-    const spvtools::SpirvTools& tools) const {
+    spv_incremental_validator validator) const {
   pass->Apply();
-  if (validate_after_each_fuzzer_pass) {
-    std::vector<uint32_t> binary_to_validate;
-    ir_context.module()->ToBinary(&binary_to_validate, false);
-    if (!tools.Validate(&binary_to_validate[0], binary_to_validate.size())) {
+  if (validator) {
+    if (val::ValidateModuleInstructions(
+            validator, opt::GetModuleInstructions(*ir_context.module()),
+            nullptr) != SPV_SUCCESS) {
       consumer(SPV_MSG_INFO, nullptr, {},
                "Binary became invalid during fuzzing (set a breakpoint to "
                "inspect); stopping.");
@@ -165,13 +168,26 @@ Fuzzer::FuzzerResultStatus Fuzzer::Run(
   FactManager fact_manager;
   fact_manager.AddFacts(impl_->consumer, initial_facts, ir_context.get());
 
+  // Validates after each fuzzer pass with an incremental validator, so that
+  // the functions a pass did not change are not checked again.  The module is
+  // validated from its instructions, without making its binary.
+  Context val_context(impl_->target_env);
+  val_context.SetMessageConsumer(impl_->consumer);
+  std::unique_ptr<spv_incremental_validator_t,
+                  decltype(&spvIncrementalValidatorDestroy)>
+      validator(impl_->validate_after_each_fuzzer_pass
+                    ? spvIncrementalValidatorCreate(val_context.CContext(),
+                                                    nullptr)
+                    : nullptr,
+                spvIncrementalValidatorDestroy);
+
   // Add some essential ingredients to the module if they are not already
   // present, such as boolean constants.
   FuzzerPassAddUsefulConstructs add_useful_constructs(
       ir_context.get(), &fact_manager, &fuzzer_context,
       transformation_sequence_out);
   if (!impl_->ApplyPassAndCheckValidity(&add_useful_constructs, *ir_context,
-                                        tools)) {
+                                        validator.get())) {
     return Fuzzer::FuzzerResultStatus::kFuzzerPassLedToInvalidModule;
   }
 
@@ -225,7 +241,7 @@ Fuzzer::FuzzerResultStatus Fuzzer::Run(
     is_first = false;
     if (!impl_->ApplyPassAndCheckValidity(
             passes[fuzzer_context.RandomIndex(passes)].get(), *ir_context,
-            tools)) {
+            validator.get())) {
       return Fuzzer::FuzzerResultStatus::kFuzzerPassLedToInvalidModule;
     }
   }
@@ -249,7 +265,8 @@ Fuzzer::FuzzerResultStatus Fuzzer::Run(
       &final_passes, ir_context.get(), &fact_manager, &fuzzer_context,
       transformation_sequence_out);
   for (auto& pass : final_passes) {
-    if (!impl_->ApplyPassAndCheckValidity(pass.get(), *ir_context, tools)) {
+    if (!impl_->ApplyPassAndCheckValidity(pass.get(), *ir_context,
+                                          validator.get())) {
       return Fuzzer::FuzzerResultStatus::kFuzzerPassLedToInvalidModule;
     }
   }
@@ -14,6 +14,8 @@
 
 #include "source/fuzz/fuzzer_pass.h"
 
+#include <unordered_set>
+
 #include "source/fuzz/instruction_descriptor.h"
 
 namespace spvtools {
@@ -25,7 +27,9 @@ FuzzerPass::FuzzerPass(opt::IRContext* ir_context, FactManager* fact_manager,
     : ir_context_(ir_context),
       fact_manager_(fact_manager),
       fuzzer_context_(fuzzer_context),
-      transformations_(transformations) {}
+      transformations_(transformations),
+      available_instructions_block_(nullptr),
+      available_instructions_position_(nullptr) {}
 
 FuzzerPass::~FuzzerPass() = default;
 
@@ -34,10 +38,6 @@ std::vector<opt::Instruction*> FuzzerPass::FindAvailableInstructions(
     opt::BasicBlock::iterator inst_it,
     std::function<bool(opt::IRContext*, opt::Instruction*)>
         instruction_is_relevant) {
-  // TODO(afd) The following is (relatively) simple, but may end up being
-  //  prohibitively inefficient, as it walks the whole dominator tree for
-  //  every instruction that is considered.
-
   std::vector<opt::Instruction*> result;
   // Consider all global declarations
   for (auto& global : GetIRContext()->module()->types_values()) {
@@ -46,6 +46,18 @@ std::vector<opt::Instruction*> FuzzerPass::FindAvailableInstructions(
     }
   }
 
+  if (block == available_instructions_block_ && inst_it != block->end() &&
+      &*inst_it == available_instructions_position_) {
+    // The instructions of the dominating blocks and the previous instructions
+    // of this block have been collected while walking the dominator tree.
+    for (auto available_inst : available_instructions_) {
+      if (instruction_is_relevant(GetIRContext(), available_inst)) {
+        result.push_back(available_inst);
+      }
+    }
+    return result;
+  }
+
   // Consider all previous instructions in this block
   for (auto prev_inst_it = block->begin(); prev_inst_it != inst_it;
        ++prev_inst_it) {
@@ -78,7 +90,27 @@ void FuzzerPass::MaybeAddTransformationBeforeEachInstruction(
         maybe_apply_transformation) {
   // Consider every block in every function.
   for (auto& function : *GetIRContext()->module()) {
-    for (auto& block : function) {
+    // The blocks are visited in a depth first preorder of the dominator tree,
+    // so that the instructions available in a block are those available at
+    // the end of its immediate dominator, and the instructions of its block.
+    // |scope_starts[d]| is the size of |available_instructions_| when the
+    // block of depth |d| currently being visited was entered.
+    available_instructions_.clear();
+    std::vector<size_t> scope_starts;
+    for (auto& block_and_depth : GetBlocksInDominatorTreeOrder(&function)) {
+      opt::BasicBlock* block = block_and_depth.first;
+      const uint32_t depth = block_and_depth.second;
+      // Forget the instructions of the blocks which do not dominate this one.
+      if (scope_starts.size() > depth) {
+        available_instructions_.resize(scope_starts[depth]);
+        scope_starts.resize(depth);
+      }
+      scope_starts.push_back(available_instructions_.size());
+      available_instructions_block_ = block;
+
+      // The last instruction of the block made available, if any.
+      opt::Instruction* last_available = nullptr;
+
       // We now consider every instruction in the block, randomly deciding
       // whether to apply a transformation before it.
 
@@ -93,7 +125,7 @@ void FuzzerPass::MaybeAddTransformationBeforeEachInstruction(
           base_opcode_skip_triples;
 
       // The initial base instruction is the block label.
-      uint32_t base = block.id();
+      uint32_t base = block->id();
 
       // Counts the number of times we have seen each opcode since we reset the
       // base instruction.
@@ -102,7 +134,7 @@ void FuzzerPass::MaybeAddTransformationBeforeEachInstruction(
       // Consider every instruction in the block.  The label is excluded: it is
       // only necessary to consider it as a base in case the first instruction
       // in the block does not have a result id.
-      for (auto inst_it = block.begin(); inst_it != block.end(); ++inst_it) {
+      for (auto inst_it = block->begin(); inst_it != block->end(); ++inst_it) {
         if (inst_it->HasResultId()) {
           // In the case that the instruction has a result id, we use the
           // instruction as its own base, and clear the skip counts we have
@@ -112,9 +144,14 @@ void FuzzerPass::MaybeAddTransformationBeforeEachInstruction(
         }
         const SpvOp opcode = inst_it->opcode();
 
+        // The previous instructions, including those inserted by the
+        // transformations applied so far, are available at |inst_it|.
+        MakeInstructionsAvailable(block, &last_available, inst_it);
+        available_instructions_position_ = &*inst_it;
+
         // Invoke the provided function, which might apply a transformation.
         maybe_apply_transformation(
-            function, &block, inst_it,
+            function, block, inst_it,
             MakeInstructionDescriptor(
                 base, opcode,
                 skip_count.count(opcode) ? skip_count.at(opcode) : 0));
@@ -124,8 +161,70 @@ void FuzzerPass::MaybeAddTransformationBeforeEachInstruction(
               skip_count.count(opcode) ? skip_count.at(opcode) + 1 : 1;
         }
       }
+
+      // All the instructions of the block are available in the blocks it
+      // dominates.
+      MakeInstructionsAvailable(block, &last_available, block->end());
+    }
+    available_instructions_block_ = nullptr;
+    available_instructions_position_ = nullptr;
+    available_instructions_.clear();
+  }
+}
+
+std::vector<std::pair<opt::BasicBlock*, uint32_t>>
+FuzzerPass::GetBlocksInDominatorTreeOrder(opt::Function* function) const {
+  std::vector<std::pair<opt::BasicBlock*, uint32_t>> result;
+  std::unordered_set<opt::BasicBlock*> function_blocks;
+  for (auto& block : *function) {
+    function_blocks.insert(&block);
+  }
+
+  // The tree is walked with an explicit stack of nodes and depths.  The
+  // pseudo entry block, which is not a block of the function, does not
+  // count towards the depth of its children.
+  std::unordered_set<opt::BasicBlock*> visited;
+  std::vector<std::pair<const opt::DominatorTreeNode*, uint32_t>> to_visit;
+  const auto& dominator_tree =
+      GetIRContext()->GetDominatorAnalysis(function)->GetDomTree();
+  for (auto root = dominator_tree.Roots().rbegin();
+       root != dominator_tree.Roots().rend(); ++root) {
+    to_visit.emplace_back(*root, 0);
+  }
+  while (!to_visit.empty()) {
+    const opt::DominatorTreeNode* node = to_visit.back().first;
+    uint32_t depth = to_visit.back().second;
+    to_visit.pop_back();
+    if (function_blocks.count(node->bb_) && visited.insert(node->bb_).second) {
+      result.emplace_back(node->bb_, depth);
+      depth++;
+    }
+    // The children are pushed in reverse so that they are visited in order.
+    for (auto child = node->children_.rbegin(); child != node->children_.rend();
+         ++child) {
+      to_visit.emplace_back(*child, depth);
     }
   }
+
+  // The unreachable blocks are not dominated by any block.
+  for (auto& block : *function) {
+    if (!visited.count(&block)) {
+      result.emplace_back(&block, 0);
+    }
+  }
+  return result;
+}
+
+void FuzzerPass::MakeInstructionsAvailable(opt::BasicBlock* block,
+                                           opt::Instruction** last_available,
+                                           opt::BasicBlock::iterator end) {
+  auto inst_it = *last_available == nullptr
+                     ? block->begin()
+                     : ++opt::BasicBlock::iterator(*last_available);
+  for (; inst_it != end; ++inst_it) {
+    available_instructions_.push_back(&*inst_it);
+    *last_available = &*inst_it;
+  }
 }
 
 }  // namespace fuzz
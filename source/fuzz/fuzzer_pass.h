@@ -16,6 +16,7 @@
 #define SOURCE_FUZZ_FUZZER_PASS_H_
 
 #include <functional>
+#include <utility>
 #include <vector>
 
 #include "source/fuzz/fact_manager.h"
@@ -60,6 +61,10 @@ class FuzzerPass {
   // Filters said instructions to return only those that satisfy the
   // |instruction_is_relevant| predicate.  This, for instance, could ignore all
   // instructions that have a particular decoration.
+  //
+  // When called from |MaybeAddTransformationBeforeEachInstruction| for the
+  // instruction being considered, the instructions of the dominating blocks
+  // are not searched again: they are kept while walking the dominator tree.
   std::vector<opt::Instruction*> FindAvailableInstructions(
       const opt::Function& function, opt::BasicBlock* block,
       opt::BasicBlock::iterator inst_it,
@@ -74,6 +79,11 @@ class FuzzerPass {
   // point of this method is to avoiding having to duplicate it in multiple
   // transformation passes.
   //
+  // The blocks of each function are considered in a depth first preorder of
+  // its dominator tree, followed by the unreachable blocks.  The
+  // transformations applied by |maybe_apply_transformation| may only insert
+  // instructions before |inst_it|: they must not change the control flow.
+  //
   // The function |maybe_apply_transformation| is invoked for each instruction
   // |inst_it| in block |block| of function |function| that is encountered.  The
   // |instruction_descriptor| parameter to the function object allows |inst_it|
@@ -100,10 +110,32 @@ class FuzzerPass {
   }
 
  private:
+  // Returns the blocks of |function| in a depth first preorder of its
+  // dominator tree, each with its depth in the tree, followed by the blocks
+  // which are not in the tree with a depth of 0.
+  std::vector<std::pair<opt::BasicBlock*, uint32_t>>
+  GetBlocksInDominatorTreeOrder(opt::Function* function) const;
+
+  // Appends to |available_instructions_| the instructions of |block| from the
+  // one following |*last_available| up to, but excluding, |end|.  Updates
+  // |*last_available| to the last instruction appended.
+  void MakeInstructionsAvailable(opt::BasicBlock* block,
+                                 opt::Instruction** last_available,
+                                 opt::BasicBlock::iterator end);
+
   opt::IRContext* ir_context_;
   FactManager* fact_manager_;
   FuzzerContext* fuzzer_context_;
   protobufs::TransformationSequence* transformations_;
+
+  // While |MaybeAddTransformationBeforeEachInstruction| considers the
+  // instruction |available_instructions_position_| of the block
+  // |available_instructions_block_|, the instructions of the dominating blocks
+  // and the previous instructions of the block, which are all available there
+  // besides the global declarations.
+  opt::BasicBlock* available_instructions_block_;
+  opt::Instruction* available_instructions_position_;
+  std::vector<opt::Instruction*> available_instructions_;
 };
 
 }  // namespace fuzz
@@ -44,7 +44,8 @@ FuzzerPassDonateModules::FuzzerPassDonateModules(
     protobufs::TransformationSequence* transformations,
     const std::vector<fuzzerutil::ModuleSupplier>& donor_suppliers)
     : FuzzerPass(ir_context, fact_manager, fuzzer_context, transformations),
-      donor_suppliers_(donor_suppliers) {}
+      donor_suppliers_(donor_suppliers),
+      donor_modules_(donor_suppliers.size()) {}
 
 FuzzerPassDonateModules::~FuzzerPassDonateModules() = default;
 
@@ -58,17 +59,37 @@ void FuzzerPassDonateModules::Apply() {
   // donating modules.
   do {
     // Choose a donor supplier at random, and get the module that it provides.
-    std::unique_ptr<opt::IRContext> donor_ir_context = donor_suppliers_.at(
-        GetFuzzerContext()->RandomIndex(donor_suppliers_))();
-    assert(donor_ir_context != nullptr && "Supplying of donor failed");
+    // The module is only supplied the first time it is chosen.
+    const DonorModule& donor_module = GetDonorModule(
+        GetFuzzerContext()->RandomIndex(donor_suppliers_));
     // Donate the supplied module.
-    DonateSingleModule(donor_ir_context.get());
+    DonateSingleModule(donor_module.ir_context.get(),
+                       donor_module.functions_in_call_graph_order);
   } while (GetFuzzerContext()->ChoosePercentage(
       GetFuzzerContext()->GetChanceOfDonatingAdditionalModule()));
 }
 
+const FuzzerPassDonateModules::DonorModule&
+FuzzerPassDonateModules::GetDonorModule(uint32_t index) {
+  DonorModule& donor_module = donor_modules_.at(index);
+  if (donor_module.ir_context == nullptr) {
+    donor_module.ir_context = donor_suppliers_.at(index)();
+    assert(donor_module.ir_context != nullptr && "Supplying of donor failed");
+    donor_module.functions_in_call_graph_order =
+        GetFunctionsInCallGraphTopologicalOrder(donor_module.ir_context.get());
+  }
+  return donor_module;
+}
+
 void FuzzerPassDonateModules::DonateSingleModule(
     opt::IRContext* donor_ir_context) {
+  DonateSingleModule(donor_ir_context,
+                     GetFunctionsInCallGraphTopologicalOrder(donor_ir_context));
+}
+
+void FuzzerPassDonateModules::DonateSingleModule(
+    opt::IRContext* donor_ir_context,
+    const std::vector<opt::Function*>& functions_in_call_graph_order) {
   // The ids used by the donor module may very well clash with ids defined in
   // the recipient module.  Furthermore, some instructions defined in the donor
   // module will be equivalent to instructions defined in the recipient module,
@@ -91,7 +112,7 @@ void FuzzerPassDonateModules::DonateSingleModule(
   HandleExternalInstructionImports(donor_ir_context,
                                    &original_id_to_donated_id);
   HandleTypesAndValues(donor_ir_context, &original_id_to_donated_id);
-  HandleFunctions(donor_ir_context, &original_id_to_donated_id);
+  HandleFunctions(functions_in_call_graph_order, &original_id_to_donated_id);
 
   // TODO(https://github.com/KhronosGroup/SPIRV-Tools/issues/3115) Handle some
   //  kinds of decoration.
@@ -419,29 +440,16 @@ void FuzzerPassDonateModules::HandleTypesAndValues(
 }
 
 void FuzzerPassDonateModules::HandleFunctions(
-    opt::IRContext* donor_ir_context,
+    const std::vector<opt::Function*>& functions_in_call_graph_order,
     std::map<uint32_t, uint32_t>* original_id_to_donated_id) {
-  // Get the ids of functions in the donor module, topologically sorted
-  // according to the donor's call graph.
-  auto topological_order =
-      GetFunctionsInCallGraphTopologicalOrder(donor_ir_context);
-
   // Donate the functions in reverse topological order.  This ensures that a
   // function gets donated before any function that depends on it.  This allows
   // donation of the functions to be separated into a number of transformations,
   // each adding one function, such that every prefix of transformations leaves
   // the module valid.
-  for (auto function_id = topological_order.rbegin();
-       function_id != topological_order.rend(); ++function_id) {
-    // Find the function to be donated.
-    opt::Function* function_to_donate = nullptr;
-    for (auto& function : *donor_ir_context->module()) {
-      if (function.result_id() == *function_id) {
-        function_to_donate = &function;
-        break;
-      }
-    }
-    assert(function_to_donate && "Function to be donated was not found.");
+  for (auto function = functions_in_call_graph_order.rbegin();
+       function != functions_in_call_graph_order.rend(); ++function) {
+    opt::Function* function_to_donate = *function;
 
     // We will collect up protobuf messages representing the donor function's
     // instructions here, and use them to create an AddFunction transformation.
@@ -510,7 +518,7 @@ void FuzzerPassDonateModules::HandleFunctions(
   }
 }
 
-std::vector<uint32_t>
+std::vector<opt::Function*>
 FuzzerPassDonateModules::GetFunctionsInCallGraphTopologicalOrder(
     opt::IRContext* context) {
   // This is an implementation of Kahn’s algorithm for topological sorting.
@@ -557,8 +565,14 @@ FuzzerPassDonateModules::GetFunctionsInCallGraphTopologicalOrder(
     }
   }
 
-  // This is the sorted order of function ids that we will eventually return.
-  std::vector<uint32_t> result;
+  // Maps each function id to its function, to return the functions.
+  std::map<uint32_t, opt::Function*> id_to_function;
+  for (auto& function : *context->module()) {
+    id_to_function[function.result_id()] = &function;
+  }
+
+  // This is the sorted order of functions that we will eventually return.
+  std::vector<opt::Function*> result;
 
   // Populate a queue with all those function ids with in-degree zero.
   std::queue<uint32_t> queue;
@@ -574,7 +588,7 @@ FuzzerPassDonateModules::GetFunctionsInCallGraphTopologicalOrder(
   while (!queue.empty()) {
     auto next = queue.front();
     queue.pop();
-    result.push_back(next);
+    result.push_back(id_to_function.at(next));
     for (auto successor : call_graph_edges.at(next)) {
       assert(function_in_degree.at(successor) > 0 &&
              "The in-degree cannot be zero if the function is a successor.");
@@ -15,6 +15,7 @@
 #ifndef SOURCE_FUZZ_FUZZER_PASS_DONATE_MODULES_H_
 #define SOURCE_FUZZ_FUZZER_PASS_DONATE_MODULES_H_
 
+#include <memory>
 #include <vector>
 
 #include "source/fuzz/fuzzer_pass.h"
@@ -42,6 +43,29 @@ class FuzzerPassDonateModules : public FuzzerPass {
   void DonateSingleModule(opt::IRContext* donor_ir_context);
 
  private:
+  // A donor module, supplied and parsed once for the lifetime of the pass,
+  // with its functions in a topological order of its call graph.
+  struct DonorModule {
+    std::unique_ptr<opt::IRContext> ir_context;
+    std::vector<opt::Function*> functions_in_call_graph_order;
+  };
+
+  // Returns the module supplied by |donor_suppliers_[index]|, calling the
+  // supplier and sorting the functions of the module the first time.
+  const DonorModule& GetDonorModule(uint32_t index);
+
+  // Donates the global declarations of |donor_ir_context| and its functions
+  // |functions_in_call_graph_order|, which are sorted topologically in
+  // relation to its call graph.  |donor_ir_context| is not modified.
+  void DonateSingleModule(
+      opt::IRContext* donor_ir_context,
+      const std::vector<opt::Function*>& functions_in_call_graph_order);
+
+  // Returns the functions of |context| in a topological order in relation to
+  // the call graph of |context|, which is assumed to be recursion-free.
+  static std::vector<opt::Function*> GetFunctionsInCallGraphTopologicalOrder(
+      opt::IRContext* context);
+
   // Adapts a storage class coming from a donor module so that it will work
   // in a recipient module, e.g. by changing Uniform to Private.
   static SpvStorageClass AdaptStorageClass(SpvStorageClass donor_storage_class);
@@ -64,22 +88,20 @@ class FuzzerPassDonateModules : public FuzzerPass {
       opt::IRContext* donor_ir_context,
       std::map<uint32_t, uint32_t>* original_id_to_donated_id);
 
-  // Assumes that |donor_ir_context| does not exhibit recursion.  Considers the
-  // functions in |donor_ir_context|'s call graph in a reverse-topologically-
-  // sorted order (leaves-to-root), adding each function to the recipient
-  // module, rewritten to use fresh ids and using |original_id_to_donated_id| to
-  // remap ids.
-  void HandleFunctions(opt::IRContext* donor_ir_context,
-                       std::map<uint32_t, uint32_t>* original_id_to_donated_id);
-
-  // Returns the ids of all functions in |context| in a topological order in
-  // relation to the call graph of |context|, which is assumed to be recursion-
-  // free.
-  static std::vector<uint32_t> GetFunctionsInCallGraphTopologicalOrder(
-      opt::IRContext* context);
+  // Considers the donor functions |functions_in_call_graph_order| in a
+  // reverse-topologically-sorted order (leaves-to-root), adding each function
+  // to the recipient module, rewritten to use fresh ids and using
+  // |original_id_to_donated_id| to remap ids.
+  void HandleFunctions(
+      const std::vector<opt::Function*>& functions_in_call_graph_order,
+      std::map<uint32_t, uint32_t>* original_id_to_donated_id);
 
   // Functions that supply SPIR-V modules
   std::vector<fuzzerutil::ModuleSupplier> donor_suppliers_;
+
+  // The modules supplied so far by |donor_suppliers_|, at the same indices;
+  // a module which has not been supplied yet has a null context.
+  std::vector<DonorModule> donor_modules_;
 };
 
 }  // namespace fuzz
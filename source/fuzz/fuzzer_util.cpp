@@ -14,7 +14,7 @@
 
 #include "source/fuzz/fuzzer_util.h"
 
-#include "source/opt/build_module.h"
+#include "source/opt/module_snapshot.h"
 
 namespace spvtools {
 namespace fuzz {
@@ -32,6 +32,40 @@ void UpdateModuleIdBound(opt::IRContext* context, uint32_t id) {
       std::max(context->module()->id_bound(), id + 1));
 }
 
+opt::IRContext::Analysis GetAnalysesPreservedByAddingInstruction() {
+  // The value numbering, scalar evolution, register pressure, uniformity and
+  // module summary analyses describe every instruction, so they do not
+  // survive the addition.
+  return opt::IRContext::kAnalysisDefUse |
+         opt::IRContext::kAnalysisInstrToBlockMapping |
+         opt::IRContext::kAnalysisDecorations |
+         opt::IRContext::kAnalysisCombinators | opt::IRContext::kAnalysisCFG |
+         opt::IRContext::kAnalysisDominatorAnalysis |
+         opt::IRContext::kAnalysisLoopAnalysis |
+         opt::IRContext::kAnalysisNameMap |
+         opt::IRContext::kAnalysisStructuredCFG |
+         opt::IRContext::kAnalysisBuiltinVarId |
+         opt::IRContext::kAnalysisIdToFuncMapping |
+         opt::IRContext::kAnalysisConstants | opt::IRContext::kAnalysisTypes;
+}
+
+void InvalidateAnalysesAfterAddingType(opt::IRContext* context) {
+  // The type has been registered with the def-use manager, but the type
+  // manager, and the constant manager which refers to its types, do not know
+  // it.
+  context->InvalidateAnalysesExceptFor(
+      GetAnalysesPreservedByAddingInstruction());
+  context->InvalidateAnalyses(opt::IRContext::kAnalysisTypes);
+}
+
+void InvalidateAnalysesAfterAddingConstant(opt::IRContext* context) {
+  // The constant has been registered with the def-use manager, but the
+  // constant manager does not know it.
+  context->InvalidateAnalysesExceptFor(
+      GetAnalysesPreservedByAddingInstruction());
+  context->InvalidateAnalyses(opt::IRContext::kAnalysisConstants);
+}
+
 opt::BasicBlock* MaybeFindBlock(opt::IRContext* context,
                                 uint32_t maybe_block_id) {
   auto inst = context->get_def_use_mgr()->GetDef(maybe_block_id);
@@ -168,6 +202,41 @@ void AddUnreachableEdgeAndUpdateOpPhis(
   }
 }
 
+bool IsValidWithUnreachableEdge(
+    opt::IRContext* context, opt::BasicBlock* bb_from, opt::BasicBlock* bb_to,
+    bool condition_value,
+    const google::protobuf::RepeatedField<google::protobuf::uint32>& phi_ids) {
+  // Record what the edge changes: the terminator of |bb_from|, and the
+  // operands of the OpPhi instructions of |bb_to|, to which it only appends.
+  opt::Instruction* terminator = bb_from->terminator();
+  const SpvOp terminator_opcode = terminator->opcode();
+  opt::Instruction::OperandList terminator_in_operands;
+  for (uint32_t i = 0; i < terminator->NumInOperands(); i++) {
+    terminator_in_operands.push_back(terminator->GetInOperand(i));
+  }
+  std::vector<std::pair<opt::Instruction*, uint32_t>> phi_num_operands;
+  for (auto& inst : *bb_to) {
+    if (inst.opcode() != SpvOpPhi) {
+      break;
+    }
+    phi_num_operands.emplace_back(&inst, inst.NumOperands());
+  }
+
+  AddUnreachableEdgeAndUpdateOpPhis(context, bb_from, bb_to, condition_value,
+                                    phi_ids);
+  const bool result = IsValid(context);
+
+  // Remove the edge.  No analysis was updated when adding it.
+  terminator->SetOpcode(terminator_opcode);
+  terminator->SetInOperands(std::move(terminator_in_operands));
+  for (auto& phi : phi_num_operands) {
+    while (phi.first->NumOperands() > phi.second) {
+      phi.first->RemoveOperand(phi.first->NumOperands() - 1);
+    }
+  }
+  return result;
+}
+
 bool BlockIsInLoopContinueConstruct(opt::IRContext* context, uint32_t block_id,
                                     uint32_t maybe_loop_header_id) {
   // We deem a block to be part of a loop's continue construct if the loop's
@@ -321,10 +390,8 @@ bool IsValid(opt::IRContext* context) {
 }
 
 std::unique_ptr<opt::IRContext> CloneIRContext(opt::IRContext* context) {
-  std::vector<uint32_t> binary;
-  context->module()->ToBinary(&binary, false);
-  return BuildModule(context->grammar().target_env(), nullptr, binary.data(),
-                     binary.size());
+  return opt::ModuleSnapshot(*context->module())
+      .Restore(context->grammar().target_env(), nullptr);
 }
 
 bool IsNonFunctionTypeId(opt::IRContext* ir_context, uint32_t id) {
@@ -38,6 +38,21 @@ bool IsFreshId(opt::IRContext* context, uint32_t id);
 // account for the given id.
 void UpdateModuleIdBound(opt::IRContext* context, uint32_t id);
 
+// Returns the analyses that remain valid after an instruction has been added
+// to the module and registered with IRContext::AnalyzeDefUse, provided that
+// it does not affect control flow and is not a type, a constant or an
+// annotation.  An instruction inserted in a block is placed in it by the
+// insertion, so the instruction-to-block mapping also stays valid.
+opt::IRContext::Analysis GetAnalysesPreservedByAddingInstruction();
+
+// Invalidates the analyses that do not know about a type that has just been
+// added to the module with IRContext::AddType.
+void InvalidateAnalysesAfterAddingType(opt::IRContext* context);
+
+// Invalidates the analyses that do not know about a constant that has just
+// been added to the module with IRContext::AddGlobalValue.
+void InvalidateAnalysesAfterAddingConstant(opt::IRContext* context);
+
 // Return the block with id |maybe_block_id| if it exists, and nullptr
 // otherwise.
 opt::BasicBlock* MaybeFindBlock(opt::IRContext* context,
@@ -67,6 +82,16 @@ void AddUnreachableEdgeAndUpdateOpPhis(
     bool condition_value,
     const google::protobuf::RepeatedField<google::protobuf::uint32>& phi_ids);
 
+// Requires the same as AddUnreachableEdgeAndUpdateOpPhis.  Returns true if
+// and only if the module would be valid with the unreachable edge that
+// AddUnreachableEdgeAndUpdateOpPhis would add.  The edge is only added to
+// |context| while the module is validated, and then removed, so that the
+// module is left unchanged and its analyses are preserved without cloning it.
+bool IsValidWithUnreachableEdge(
+    opt::IRContext* context, opt::BasicBlock* bb_from, opt::BasicBlock* bb_to,
+    bool condition_value,
+    const google::protobuf::RepeatedField<google::protobuf::uint32>& phi_ids);
+
 // Returns true if and only if |maybe_loop_header_id| is a loop header and
 // |block_id| is in the continue construct of the associated loop.
 bool BlockIsInLoopContinueConstruct(opt::IRContext* context, uint32_t block_id,
@@ -38,6 +38,8 @@
 // are directly included.  This is so that they can be compiled in a manner
 // where warnings are ignored.
 
+#include "google/protobuf/io/coded_stream.h"
+#include "google/protobuf/io/zero_copy_stream_impl.h"
 #include "google/protobuf/util/json_util.h"
 #include "source/fuzz/protobufs/spvtoolsfuzz.pb.h"
 
@@ -14,6 +14,8 @@
 
 #include "source/fuzz/replayer.h"
 
+#include <functional>
+#include <memory>
 #include <utility>
 
 #include "source/fuzz/fact_manager.h"
@@ -32,14 +34,54 @@
 #include "source/fuzz/transformation_split_block.h"
 #include "source/opt/build_module.h"
 #include "source/util/make_unique.h"
+#include "source/val/validate.h"
 
 namespace spvtools {
 namespace fuzz {
 
+namespace {
+
+// Returns a function returning the transformations of |sequence| one at a
+// time, from index |first_transformation| on, and then null.
+std::function<const protobufs::Transformation*()> ReadSequence(
+    const protobufs::TransformationSequence& sequence,
+    int first_transformation) {
+  int index = first_transformation;
+  return [&sequence, index]() mutable -> const protobufs::Transformation* {
+    return index < sequence.transformation_size()
+               ? &sequence.transformation(index++)
+               : nullptr;
+  };
+}
+
+}  // namespace
+
 struct Replayer::Impl {
   explicit Impl(spv_target_env env, bool validate)
       : target_env(env), validate_during_replay(validate) {}
 
+  // Applies the transformations returned one at a time by
+  // |next_transformation|, which returns null once there are none left, to
+  // |ir_context|, updating |fact_manager|.  |first_transformation| is the
+  // index of the first of them in the sequence being replayed.  See
+  // Replayer::RunWithCheckpoints for the other parameters.
+  ReplayerResultStatus ApplyTransformations(
+      opt::IRContext* ir_context, FactManager* fact_manager,
+      const std::function<const protobufs::Transformation*()>&
+          next_transformation,
+      int first_transformation, uint32_t checkpoint_interval,
+      std::vector<uint32_t>* binary_out,
+      protobufs::TransformationSequence* transformation_sequence_out,
+      std::vector<Checkpoint>* checkpoints_out) const;
+
+  // Checks that |binary_in| is valid, and builds |ir_context| from it and
+  // |fact_manager| from |initial_facts|.  Returns kComplete on success.
+  ReplayerResultStatus BuildInitialModule(
+      const std::vector<uint32_t>& binary_in,
+      const protobufs::FactSequence& initial_facts,
+      std::unique_ptr<opt::IRContext>* ir_context,
+      FactManager* fact_manager) const;
+
   const spv_target_env target_env;  // Target environment.
   MessageConsumer consumer;         // Message consumer.
 
@@ -47,6 +89,101 @@ struct Replayer::Impl {
                                       // be run after every replay step.
 };
 
+Replayer::ReplayerResultStatus Replayer::Impl::ApplyTransformations(
+    opt::IRContext* ir_context, FactManager* fact_manager,
+    const std::function<const protobufs::Transformation*()>&
+        next_transformation,
+    int first_transformation, uint32_t checkpoint_interval,
+    std::vector<uint32_t>* binary_out,
+    protobufs::TransformationSequence* transformation_sequence_out,
+    std::vector<Checkpoint>* checkpoints_out) const {
+  // Validates after each transformation with an incremental validator, so
+  // that the functions a transformation did not change are not checked again.
+  // The module is validated from its instructions, without making its binary.
+  Context val_context(target_env);
+  std::unique_ptr<spv_incremental_validator_t,
+                  decltype(&spvIncrementalValidatorDestroy)>
+      validator(validate_during_replay
+                    ? spvIncrementalValidatorCreate(val_context.CContext(),
+                                                    nullptr)
+                    : nullptr,
+                spvIncrementalValidatorDestroy);
+
+  // Consider the transformation proto messages in turn.
+  int i = first_transformation;
+  for (const protobufs::Transformation* next_message = next_transformation();
+       next_message != nullptr; next_message = next_transformation(), i++) {
+    auto& message = *next_message;
+    auto transformation = Transformation::FromMessage(message);
+
+    // Check whether the transformation can be applied.
+    if (transformation->IsApplicable(ir_context, *fact_manager)) {
+      // The transformation is applicable, so apply it, and copy it to the
+      // sequence of transformations that were applied.
+      transformation->Apply(ir_context, fact_manager);
+      *transformation_sequence_out->add_transformation() = message;
+
+      if (validator) {
+        // Check whether the latest transformation led to a valid module.
+        if (val::ValidateModuleInstructions(
+                validator.get(),
+                opt::GetModuleInstructions(*ir_context->module()),
+                nullptr) != SPV_SUCCESS) {
+          consumer(SPV_MSG_INFO, nullptr, {},
+                   "Binary became invalid during replay (set a "
+                   "breakpoint to inspect); stopping.");
+          return Replayer::ReplayerResultStatus::kReplayValidationFailure;
+        }
+      }
+
+      // A checkpoint is only useful for the sequences sharing the prefix
+      // applied so far, so none is recorded once a transformation has been
+      // skipped.
+      const int num_applied =
+          transformation_sequence_out->transformation_size();
+      if (checkpoints_out && num_applied == i + 1 &&
+          num_applied % checkpoint_interval == 0) {
+        Checkpoint checkpoint;
+        checkpoint.transformations = *transformation_sequence_out;
+        ir_context->module()->ToBinary(&checkpoint.binary, false);
+        checkpoint.facts = fact_manager->GetAddedFacts();
+        checkpoints_out->push_back(std::move(checkpoint));
+      }
+    }
+  }
+
+  // Write out the module as a binary.
+  ir_context->module()->ToBinary(binary_out, false);
+  return Replayer::ReplayerResultStatus::kComplete;
+}
+
+Replayer::ReplayerResultStatus Replayer::Impl::BuildInitialModule(
+    const std::vector<uint32_t>& binary_in,
+    const protobufs::FactSequence& initial_facts,
+    std::unique_ptr<opt::IRContext>* ir_context,
+    FactManager* fact_manager) const {
+  spvtools::SpirvTools tools(target_env);
+  if (!tools.IsValid()) {
+    consumer(SPV_MSG_ERROR, nullptr, {},
+             "Failed to create SPIRV-Tools interface; stopping.");
+    return Replayer::ReplayerResultStatus::kFailedToCreateSpirvToolsInterface;
+  }
+
+  // Initial binary should be valid.
+  if (!tools.Validate(&binary_in[0], binary_in.size())) {
+    consumer(SPV_MSG_INFO, nullptr, {}, "Initial binary is invalid; stopping.");
+    return Replayer::ReplayerResultStatus::kInitialBinaryInvalid;
+  }
+
+  // Build the module from the input binary.
+  *ir_context =
+      BuildModule(target_env, consumer, binary_in.data(), binary_in.size());
+  assert(*ir_context);
+
+  fact_manager->AddFacts(consumer, initial_facts, ir_context->get());
+  return Replayer::ReplayerResultStatus::kComplete;
+}
+
 Replayer::Replayer(spv_target_env env, bool validate_during_replay)
     : impl_(MakeUnique<Impl>(env, validate_during_replay)) {}
 
@@ -62,72 +199,115 @@ Replayer::ReplayerResultStatus Replayer::Run(
     const protobufs::TransformationSequence& transformation_sequence_in,
     std::vector<uint32_t>* binary_out,
     protobufs::TransformationSequence* transformation_sequence_out) const {
+  return RunWithCheckpoints(binary_in, initial_facts,
+                            transformation_sequence_in, 0, binary_out,
+                            transformation_sequence_out, nullptr);
+}
+
+Replayer::ReplayerResultStatus Replayer::RunWithCheckpoints(
+    const std::vector<uint32_t>& binary_in,
+    const protobufs::FactSequence& initial_facts,
+    const protobufs::TransformationSequence& transformation_sequence_in,
+    uint32_t checkpoint_interval, std::vector<uint32_t>* binary_out,
+    protobufs::TransformationSequence* transformation_sequence_out,
+    std::vector<Checkpoint>* checkpoints_out) const {
   // Check compatibility between the library version being linked with and the
   // header files being used.
   GOOGLE_PROTOBUF_VERIFY_VERSION;
 
-  spvtools::SpirvTools tools(impl_->target_env);
-  if (!tools.IsValid()) {
-    impl_->consumer(SPV_MSG_ERROR, nullptr, {},
-                    "Failed to create SPIRV-Tools interface; stopping.");
-    return Replayer::ReplayerResultStatus::kFailedToCreateSpirvToolsInterface;
-  }
+  assert((!checkpoints_out || checkpoint_interval > 0) &&
+         "Checkpoints must be at least one transformation apart.");
 
-  // Initial binary should be valid.
-  if (!tools.Validate(&binary_in[0], binary_in.size())) {
-    impl_->consumer(SPV_MSG_INFO, nullptr, {},
-                    "Initial binary is invalid; stopping.");
-    return Replayer::ReplayerResultStatus::kInitialBinaryInvalid;
+  std::unique_ptr<opt::IRContext> ir_context;
+  FactManager fact_manager;
+  auto status = impl_->BuildInitialModule(binary_in, initial_facts,
+                                          &ir_context, &fact_manager);
+  if (status != Replayer::ReplayerResultStatus::kComplete) {
+    return status;
   }
 
-  // Build the module from the input binary.
-  std::unique_ptr<opt::IRContext> ir_context = BuildModule(
-      impl_->target_env, impl_->consumer, binary_in.data(), binary_in.size());
-  assert(ir_context);
+  return impl_->ApplyTransformations(
+      ir_context.get(), &fact_manager,
+      ReadSequence(transformation_sequence_in, 0), 0, checkpoint_interval,
+      binary_out, transformation_sequence_out, checkpoints_out);
+}
 
-  // For replay validation, we track the last valid SPIR-V binary that was
-  // observed. Initially this is the input binary.
-  std::vector<uint32_t> last_valid_binary;
-  if (impl_->validate_during_replay) {
-    last_valid_binary = binary_in;
-  }
+Replayer::ReplayerResultStatus Replayer::RunFromStream(
+    const std::vector<uint32_t>& binary_in,
+    const protobufs::FactSequence& initial_facts,
+    TransformationStreamReader* transformation_stream_in,
+    std::vector<uint32_t>* binary_out,
+    protobufs::TransformationSequence* transformation_sequence_out) const {
+  GOOGLE_PROTOBUF_VERIFY_VERSION;
 
+  std::unique_ptr<opt::IRContext> ir_context;
   FactManager fact_manager;
-  fact_manager.AddFacts(impl_->consumer, initial_facts, ir_context.get());
-
-  // Consider the transformation proto messages in turn.
-  for (auto& message : transformation_sequence_in.transformation()) {
-    auto transformation = Transformation::FromMessage(message);
+  auto status = impl_->BuildInitialModule(binary_in, initial_facts,
+                                          &ir_context, &fact_manager);
+  if (status != Replayer::ReplayerResultStatus::kComplete) {
+    return status;
+  }
 
-    // Check whether the transformation can be applied.
-    if (transformation->IsApplicable(ir_context.get(), fact_manager)) {
-      // The transformation is applicable, so apply it, and copy it to the
-      // sequence of transformations that were applied.
-      transformation->Apply(ir_context.get(), &fact_manager);
-      *transformation_sequence_out->add_transformation() = message;
+  // Only the transformation being applied is held in memory.
+  protobufs::Transformation message;
+  status = impl_->ApplyTransformations(
+      ir_context.get(), &fact_manager,
+      [transformation_stream_in,
+       &message]() -> const protobufs::Transformation* {
+        return transformation_stream_in->Next(&message) ? &message : nullptr;
+      },
+      0, 0, binary_out, transformation_sequence_out, nullptr);
+  if (status == Replayer::ReplayerResultStatus::kComplete &&
+      transformation_stream_in->failed()) {
+    impl_->consumer(SPV_MSG_ERROR, nullptr, {},
+                    "Malformed transformation stream; stopping.");
+    return Replayer::ReplayerResultStatus::kMalformedTransformationStream;
+  }
+  return status;
+}
 
-      if (impl_->validate_during_replay) {
-        std::vector<uint32_t> binary_to_validate;
-        ir_context->module()->ToBinary(&binary_to_validate, false);
+Replayer::ReplayerResultStatus Replayer::ResumeFromCheckpoint(
+    const Checkpoint& checkpoint,
+    const protobufs::TransformationSequence& transformation_sequence_in,
+    uint32_t checkpoint_interval, std::vector<uint32_t>* binary_out,
+    protobufs::TransformationSequence* transformation_sequence_out,
+    std::vector<Checkpoint>* checkpoints_out) const {
+  GOOGLE_PROTOBUF_VERIFY_VERSION;
 
-        // Check whether the latest transformation led to a valid binary.
-        if (!tools.Validate(&binary_to_validate[0],
-                            binary_to_validate.size())) {
-          impl_->consumer(SPV_MSG_INFO, nullptr, {},
-                          "Binary became invalid during replay (set a "
-                          "breakpoint to inspect); stopping.");
-          return Replayer::ReplayerResultStatus::kReplayValidationFailure;
-        }
+  assert((!checkpoints_out || checkpoint_interval > 0) &&
+         "Checkpoints must be at least one transformation apart.");
+  assert(checkpoint.transformations.transformation_size() <=
+             transformation_sequence_in.transformation_size() &&
+         "The transformations of the checkpoint must be a prefix of the "
+         "sequence.");
 
-        // The binary was valid, so it becomes the latest valid binary.
-        last_valid_binary = std::move(binary_to_validate);
-      }
-    }
+  spvtools::SpirvTools tools(impl_->target_env);
+  if (!tools.IsValid()) {
+    impl_->consumer(SPV_MSG_ERROR, nullptr, {},
+                    "Failed to create SPIRV-Tools interface; stopping.");
+    return Replayer::ReplayerResultStatus::kFailedToCreateSpirvToolsInterface;
   }
 
-  // Write out the module as a binary.
-  ir_context->module()->ToBinary(binary_out, false);
-  return Replayer::ReplayerResultStatus::kComplete;
+  // The binary of the checkpoint was obtained from a valid binary, so it is
+  // not validated again.
+  std::unique_ptr<opt::IRContext> ir_context =
+      BuildModule(impl_->target_env, impl_->consumer, checkpoint.binary.data(),
+                  checkpoint.binary.size());
+  assert(ir_context);
+
+  FactManager fact_manager;
+  fact_manager.AddFacts(impl_->consumer, checkpoint.facts, ir_context.get());
+
+  for (auto& message : checkpoint.transformations.transformation()) {
+    *transformation_sequence_out->add_transformation() = message;
+  }
+  const int first_transformation =
+      checkpoint.transformations.transformation_size();
+  return impl_->ApplyTransformations(
+      ir_context.get(), &fact_manager,
+      ReadSequence(transformation_sequence_in, first_transformation),
+      first_transformation, checkpoint_interval, binary_out,
+      transformation_sequence_out, checkpoints_out);
 }
 
 }  // namespace fuzz
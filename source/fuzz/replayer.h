@@ -19,6 +19,7 @@
 #include <vector>
 
 #include "source/fuzz/protobufs/spirvfuzz_protobufs.h"
+#include "source/fuzz/transformation_stream.h"
 #include "spirv-tools/libspirv.hpp"
 
 namespace spvtools {
@@ -34,6 +35,20 @@ class Replayer {
     kFailedToCreateSpirvToolsInterface,
     kInitialBinaryInvalid,
     kReplayValidationFailure,
+    kMalformedTransformationStream,
+  };
+
+  // The state of a replay after applying a prefix of a sequence of
+  // transformations.  Replay can resume from it for any sequence that starts
+  // with the same prefix, applied to the same input binary and facts, without
+  // applying the prefix again.
+  struct Checkpoint {
+    // The transformations of the prefix, all of which were applied.
+    protobufs::TransformationSequence transformations;
+    // The binary obtained by applying them.
+    std::vector<uint32_t> binary;
+    // The facts known after applying them.
+    protobufs::FactSequence facts;
   };
 
   // Constructs a replayer from the given target environment.
@@ -63,6 +78,41 @@ class Replayer {
       std::vector<uint32_t>* binary_out,
       protobufs::TransformationSequence* transformation_sequence_out) const;
 
+  // As Run, but reads the transformations to apply one at a time from
+  // |transformation_stream_in|, so that the sequence to replay is never held
+  // in memory as a whole.  Returns kMalformedTransformationStream if a
+  // malformed transformation is read, after applying those preceding it.
+  ReplayerResultStatus RunFromStream(
+      const std::vector<uint32_t>& binary_in,
+      const protobufs::FactSequence& initial_facts,
+      TransformationStreamReader* transformation_stream_in,
+      std::vector<uint32_t>* binary_out,
+      protobufs::TransformationSequence* transformation_sequence_out) const;
+
+  // As Run, but also records a checkpoint to |checkpoints_out| after every
+  // |checkpoint_interval| transformations, for as long as all the
+  // transformations considered so far have been applied.
+  ReplayerResultStatus RunWithCheckpoints(
+      const std::vector<uint32_t>& binary_in,
+      const protobufs::FactSequence& initial_facts,
+      const protobufs::TransformationSequence& transformation_sequence_in,
+      uint32_t checkpoint_interval, std::vector<uint32_t>* binary_out,
+      protobufs::TransformationSequence* transformation_sequence_out,
+      std::vector<Checkpoint>* checkpoints_out) const;
+
+  // As RunWithCheckpoints, but resumes the replay from |checkpoint|, whose
+  // transformations must be a prefix of |transformation_sequence_in|.  Only
+  // the rest of |transformation_sequence_in| is applied, so the cost of the
+  // replay is proportional to its length.  The transformations of
+  // |checkpoint| are included in |transformation_sequence_out|, and in the
+  // checkpoints recorded to |checkpoints_out|.
+  ReplayerResultStatus ResumeFromCheckpoint(
+      const Checkpoint& checkpoint,
+      const protobufs::TransformationSequence& transformation_sequence_in,
+      uint32_t checkpoint_interval, std::vector<uint32_t>* binary_out,
+      protobufs::TransformationSequence* transformation_sequence_out,
+      std::vector<Checkpoint>* checkpoints_out) const;
+
  private:
   struct Impl;                  // Opaque struct for holding internal data.
   std::unique_ptr<Impl> impl_;  // Unique pointer to internal data.
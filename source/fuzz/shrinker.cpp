@@ -14,18 +14,27 @@
 
 #include "source/fuzz/shrinker.h"
 
+#include <algorithm>
+#include <chrono>
+#include <iterator>
 #include <sstream>
+#include <string>
 
 #include "source/fuzz/pseudo_random_generator.h"
 #include "source/fuzz/replayer.h"
 #include "source/spirv_fuzzer_options.h"
 #include "source/util/make_unique.h"
+#include "source/util/parallel.h"
 
 namespace spvtools {
 namespace fuzz {
 
 namespace {
 
+// The largest number of checkpoints kept for the replay of the current best
+// sequence of transformations.
+const uint32_t kMaxCheckpoints = 32;
+
 // A helper to get the size of a protobuf transformation sequence in a less
 // verbose manner.
 uint32_t NumRemainingTransformations(
@@ -60,8 +69,12 @@ protobufs::TransformationSequence RemoveChunk(
 }  // namespace
 
 struct Shrinker::Impl {
-  explicit Impl(spv_target_env env, uint32_t limit, bool validate)
-      : target_env(env), step_limit(limit), validate_during_replay(validate) {}
+  explicit Impl(spv_target_env env, uint32_t limit, bool validate,
+                uint32_t threads)
+      : target_env(env),
+        step_limit(limit),
+        validate_during_replay(validate),
+        num_threads(utils::ResolveNumThreads(threads)) {}
 
   const spv_target_env target_env;    // Target environment.
   MessageConsumer consumer;           // Message consumer.
@@ -69,11 +82,15 @@ struct Shrinker::Impl {
   const bool validate_during_replay;  // Determines whether to check for
                                       // validity during the replaying of
                                       // transformations.
+  const uint32_t num_threads;         // The number of removals of chunks
+                                      // tried at the same time.
+  utils::StepStatistics* statistics = nullptr;  // Recorded by Run, if any.
 };
 
 Shrinker::Shrinker(spv_target_env env, uint32_t step_limit,
-                   bool validate_during_replay)
-    : impl_(MakeUnique<Impl>(env, step_limit, validate_during_replay)) {}
+                   bool validate_during_replay, uint32_t num_threads)
+    : impl_(MakeUnique<Impl>(env, step_limit, validate_during_replay,
+                             num_threads)) {}
 
 Shrinker::~Shrinker() = default;
 
@@ -81,6 +98,10 @@ void Shrinker::SetMessageConsumer(MessageConsumer c) {
   impl_->consumer = std::move(c);
 }
 
+void Shrinker::SetStatistics(utils::StepStatistics* statistics) {
+  impl_->statistics = statistics;
+}
+
 Shrinker::ShrinkerResultStatus Shrinker::Run(
     const std::vector<uint32_t>& binary_in,
     const protobufs::FactSequence& initial_facts,
@@ -92,6 +113,9 @@ Shrinker::ShrinkerResultStatus Shrinker::Run(
   // header files being used.
   GOOGLE_PROTOBUF_VERIFY_VERSION;
 
+  utils::StepStatistics* const statistics = impl_->statistics;
+  if (statistics) statistics->Clear();
+
   spvtools::SpirvTools tools(impl_->target_env);
   if (!tools.IsValid()) {
     impl_->consumer(SPV_MSG_ERROR, nullptr, {},
@@ -109,20 +133,48 @@ Shrinker::ShrinkerResultStatus Shrinker::Run(
   std::vector<uint32_t> current_best_binary;
   protobufs::TransformationSequence current_best_transformations;
 
+  // A candidate sequence shares the transformations before the removed chunk
+  // with the current best sequence, so its replay resumes from the last
+  // checkpoint of the replay of the current best sequence before the chunk.
+  // |checkpoints[i]| is the state after the first (i + 1) x
+  // |checkpoint_interval| transformations of the current best sequence.
+  const uint32_t checkpoint_interval = std::max(
+      1u, NumRemainingTransformations(transformation_sequence_in) /
+              kMaxCheckpoints);
+  std::vector<Replayer::Checkpoint> checkpoints;
+
   // Run a replay of the initial transformation sequence to (a) check that it
   // succeeds, (b) get the binary that results from running these
   // transformations, and (c) get the subsequence of the initial transformations
   // that actually apply (in principle this could be a strict subsequence).
-  if (Replayer(impl_->target_env, impl_->validate_during_replay)
-          .Run(binary_in, initial_facts, transformation_sequence_in,
-               &current_best_binary, &current_best_transformations) !=
-      Replayer::ReplayerResultStatus::kComplete) {
+  auto start = std::chrono::steady_clock::now();
+  const bool replayed_initial =
+      Replayer(impl_->target_env, impl_->validate_during_replay)
+          .RunWithCheckpoints(binary_in, initial_facts,
+                              transformation_sequence_in, checkpoint_interval,
+                              &current_best_binary,
+                              &current_best_transformations, &checkpoints) ==
+      Replayer::ReplayerResultStatus::kComplete;
+  if (statistics) {
+    utils::StepStatistics::Phase* phase = statistics->GetPhase("Initial state");
+    phase->attempts = 1;
+    phase->tool_us = utils::StepStatistics::MicrosecondsSince(start);
+  }
+  if (!replayed_initial) {
     return ShrinkerResultStatus::kReplayFailed;
   }
 
   // Check that the binary produced by applying the initial transformations is
   // indeed interesting.
-  if (!interestingness_function(current_best_binary, 0)) {
+  start = std::chrono::steady_clock::now();
+  const bool initially_interesting =
+      interestingness_function(current_best_binary, 0);
+  if (statistics) {
+    utils::StepStatistics::Phase* phase = statistics->GetPhase("Initial state");
+    phase->successes = initially_interesting ? 1 : 0;
+    phase->test_us = utils::StepStatistics::MicrosecondsSince(start);
+  }
+  if (!initially_interesting) {
     impl_->consumer(SPV_MSG_INFO, nullptr, {},
                     "Initial binary is not interesting; stopping.");
     return ShrinkerResultStatus::kInitialBinaryNotInteresting;
@@ -170,44 +222,132 @@ Shrinker::ShrinkerResultStatus Shrinker::Run(
     // We go through the transformations in reverse, in chunks of size
     // |chunk_size|, using |chunk_index| to track which chunk to try removing
     // next.  The loop exits early if we reach the shrinking step limit.
-    for (int chunk_index = num_chunks - 1;
-         attempt < impl_->step_limit && chunk_index >= 0; chunk_index--) {
-      // Remove a chunk of transformations according to the current index and
-      // chunk size.
-      auto transformations_with_chunk_removed =
-          RemoveChunk(current_best_transformations, chunk_index, chunk_size);
-
-      // Replay the smaller sequence of transformations to get a next binary and
-      // transformation sequence. Note that the transformations arising from
-      // replay might be even smaller than the transformations with the chunk
-      // removed, because removing those transformations might make further
-      // transformations inapplicable.
-      std::vector<uint32_t> next_binary;
-      protobufs::TransformationSequence next_transformation_sequence;
-      if (Replayer(impl_->target_env, false)
-              .Run(binary_in, initial_facts, transformations_with_chunk_removed,
-                   &next_binary, &next_transformation_sequence) !=
-          Replayer::ReplayerResultStatus::kComplete) {
-        // Replay should not fail; if it does, we need to abort shrinking.
-        return ShrinkerResultStatus::kReplayFailed;
+    int chunk_index = num_chunks - 1;
+    utils::StepStatistics::Phase* phase =
+        statistics ? statistics->GetPhase("Remove chunks of " +
+                                          std::to_string(chunk_size) +
+                                          " transformations")
+                   : nullptr;
+    while (attempt < impl_->step_limit && chunk_index >= 0) {
+      // The removals of the next few chunks are tried at the same time, each
+      // from the current best sequence.  Removing a chunk does not affect the
+      // earlier chunks, so each removal is the one that would be tried if the
+      // removals of the later chunks were found not to be interesting.  The
+      // first interesting removal in order is thus the one that trying the
+      // chunks in turn would find.
+      const uint32_t num_candidates =
+          std::min({impl_->num_threads, impl_->step_limit - attempt,
+                    static_cast<uint32_t>(chunk_index + 1)});
+      std::vector<std::vector<uint32_t>> next_binaries(num_candidates);
+      std::vector<protobufs::TransformationSequence>
+          next_transformation_sequences(num_candidates);
+      std::vector<size_t> num_checkpoints_kept(num_candidates, 0);
+      std::vector<std::vector<Replayer::Checkpoint>> next_checkpoints(
+          num_candidates);
+      std::vector<char> replayed(num_candidates, 0);
+      std::vector<char> interesting(num_candidates, 0);
+      // The time each removal spends in the replay and in the test.
+      std::vector<uint64_t> replay_us(num_candidates, 0);
+      std::vector<uint64_t> test_us(num_candidates, 0);
+      utils::ParallelFor(
+          num_candidates, impl_->num_threads,
+          [this, &binary_in, &initial_facts, &current_best_transformations,
+           &checkpoints, &interestingness_function, &next_binaries,
+           &next_transformation_sequences, &num_checkpoints_kept,
+           &next_checkpoints, &replayed, &interesting, &replay_us, &test_us,
+           chunk_index, chunk_size, checkpoint_interval, attempt](size_t i) {
+            auto start = std::chrono::steady_clock::now();
+            const uint32_t index = chunk_index - static_cast<uint32_t>(i);
+            // Remove a chunk of transformations according to the index and
+            // chunk size.
+            auto transformations_with_chunk_removed =
+                RemoveChunk(current_best_transformations, index, chunk_size);
+
+            // Replay the smaller sequence of transformations to get a next
+            // binary and transformation sequence. Note that the
+            // transformations arising from replay might be even smaller than
+            // the transformations with the chunk removed, because removing
+            // those transformations might make further transformations
+            // inapplicable.  The replay resumes from the last checkpoint
+            // before the chunk, if any.
+            num_checkpoints_kept[i] =
+                std::min(checkpoints.size(),
+                         static_cast<size_t>(index * chunk_size /
+                                             checkpoint_interval));
+            Replayer replayer(impl_->target_env, false);
+            Replayer::ReplayerResultStatus replay_status;
+            if (num_checkpoints_kept[i] == 0) {
+              replay_status = replayer.RunWithCheckpoints(
+                  binary_in, initial_facts, transformations_with_chunk_removed,
+                  checkpoint_interval, &next_binaries[i],
+                  &next_transformation_sequences[i], &next_checkpoints[i]);
+            } else {
+              replay_status = replayer.ResumeFromCheckpoint(
+                  checkpoints[num_checkpoints_kept[i] - 1],
+                  transformations_with_chunk_removed, checkpoint_interval,
+                  &next_binaries[i], &next_transformation_sequences[i],
+                  &next_checkpoints[i]);
+            }
+            replayed[i] =
+                replay_status == Replayer::ReplayerResultStatus::kComplete;
+            replay_us[i] = utils::StepStatistics::MicrosecondsSince(start);
+            if (!replayed[i]) {
+              return;
+            }
+
+            assert(NumRemainingTransformations(
+                       next_transformation_sequences[i]) >=
+                       index * chunk_size &&
+                   "Removing this chunk of transformations should not have an "
+                   "effect on earlier chunks.");
+
+            start = std::chrono::steady_clock::now();
+            interesting[i] = interestingness_function(
+                next_binaries[i], attempt + static_cast<uint32_t>(i));
+            test_us[i] = utils::StepStatistics::MicrosecondsSince(start);
+          });
+      // The removals discarded after an interesting one count in the times,
+      // but not in the steps.
+      for (uint32_t i = 0; phase && i < num_candidates; i++) {
+        phase->tool_us += replay_us[i];
+        phase->test_us += test_us[i];
       }
 
-      assert(NumRemainingTransformations(next_transformation_sequence) >=
-                 chunk_index * chunk_size &&
-             "Removing this chunk of transformations should not have an effect "
-             "on earlier chunks.");
-
-      if (interestingness_function(next_binary, attempt)) {
-        // If the binary arising from the smaller transformation sequence is
-        // interesting, this becomes our current best binary and transformation
-        // sequence.
-        current_best_binary = next_binary;
-        current_best_transformations = next_transformation_sequence;
-        progress_this_round = true;
+      for (uint32_t i = 0; i < num_candidates; i++) {
+        if (!replayed[i]) {
+          // Replay should not fail; if it does, we need to abort shrinking.
+          return ShrinkerResultStatus::kReplayFailed;
+        }
+        // Whether or not the removal is interesting, this was a shrink
+        // attempt, so increment our count of shrink attempts.
+        attempt++;
+        chunk_index--;
+        if (phase) {
+          ++phase->attempts;
+          if (interesting[i]) {
+            ++phase->successes;
+            phase->bytes_removed +=
+                (static_cast<int64_t>(current_best_binary.size()) -
+                 static_cast<int64_t>(next_binaries[i].size())) *
+                static_cast<int64_t>(sizeof(uint32_t));
+          }
+        }
+        if (interesting[i]) {
+          // If the binary arising from the smaller transformation sequence is
+          // interesting, this becomes our current best binary and
+          // transformation sequence.  The later removals were tried from the
+          // previous sequence, so they are discarded.
+          current_best_binary = std::move(next_binaries[i]);
+          current_best_transformations = next_transformation_sequences[i];
+          // The checkpoints before the removed chunk are still valid, and
+          // the replay of the candidate recorded the next ones.
+          checkpoints.resize(num_checkpoints_kept[i]);
+          std::move(next_checkpoints[i].begin(), next_checkpoints[i].end(),
+                    std::back_inserter(checkpoints));
+          progress_this_round = true;
+          break;
+        }
       }
-      // Either way, this was a shrink attempt, so increment our count of shrink
-      // attempts.
-      attempt++;
     }
     if (!progress_this_round) {
       // If we didn't manage to remove any chunks at this chunk size, try a
@@ -19,6 +19,7 @@
 #include <vector>
 
 #include "source/fuzz/protobufs/spirvfuzz_protobufs.h"
+#include "source/util/profiler.h"
 #include "spirv-tools/libspirv.hpp"
 
 namespace spvtools {
@@ -49,9 +50,13 @@ class Shrinker {
   using InterestingnessFunction = std::function<bool(
       const std::vector<uint32_t>& binary, uint32_t counter)>;
 
-  // Constructs a shrinker from the given target environment.
-  Shrinker(spv_target_env env, uint32_t step_limit,
-           bool validate_during_replay);
+  // Constructs a shrinker from the given target environment.  The removals of
+  // up to |num_threads| chunks of transformations are tried at the same time,
+  // or of one chunk per hardware thread if |num_threads| is 0.  The result is
+  // the same for any number of threads, but the interestingness function is
+  // then called concurrently, and for removals which are then discarded.
+  Shrinker(spv_target_env env, uint32_t step_limit, bool validate_during_replay,
+           uint32_t num_threads = 1);
 
   // Disables copy/move constructor/assignment operations.
   Shrinker(const Shrinker&) = delete;
@@ -65,6 +70,12 @@ class Shrinker {
   // invoked once for each message communicated from the library.
   void SetMessageConsumer(MessageConsumer consumer);
 
+  // Sets the statistics that Run records: the replay and the test of the
+  // initial transformations, and the removals of chunks of each size, with
+  // the time spent replaying and testing them.  Run clears |statistics|
+  // first.  |statistics| must outlive the shrinker, and null records nothing.
+  void SetStatistics(utils::StepStatistics* statistics);
+
   // Requires that when |transformation_sequence_in| is applied to |binary_in|
   // with initial facts |initial_facts|, the resulting binary is interesting
   // according to |interestingness_function|.
@@ -46,12 +46,11 @@ void TransformationAddConstantBoolean::Apply(opt::IRContext* context,
   // Add the boolean constant to the module, ensuring the module's id bound is
   // high enough.
   fuzzerutil::UpdateModuleIdBound(context, message_.fresh_id());
-  context->module()->AddGlobalValue(
-      message_.is_true() ? SpvOpConstantTrue : SpvOpConstantFalse,
-      message_.fresh_id(), context->get_type_mgr()->GetId(&bool_type));
-  // We have added an instruction to the module, so need to be careful about the
-  // validity of existing analyses.
-  context->InvalidateAnalysesExceptFor(opt::IRContext::Analysis::kAnalysisNone);
+  context->AddGlobalValue(MakeUnique<opt::Instruction>(
+      context, message_.is_true() ? SpvOpConstantTrue : SpvOpConstantFalse,
+      context->get_type_mgr()->GetId(&bool_type), message_.fresh_id(),
+      opt::Instruction::OperandList()));
+  fuzzerutil::InvalidateAnalysesAfterAddingConstant(context);
 }
 
 protobufs::Transformation TransformationAddConstantBoolean::ToMessage() const {
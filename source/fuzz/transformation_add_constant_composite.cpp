@@ -110,13 +110,11 @@ void TransformationAddConstantComposite::Apply(
   for (auto constituent_id : message_.constituent_id()) {
     in_operands.push_back({SPV_OPERAND_TYPE_ID, {constituent_id}});
   }
-  context->module()->AddGlobalValue(MakeUnique<opt::Instruction>(
+  context->AddGlobalValue(MakeUnique<opt::Instruction>(
       context, SpvOpConstantComposite, message_.type_id(), message_.fresh_id(),
       in_operands));
   fuzzerutil::UpdateModuleIdBound(context, message_.fresh_id());
-  // We have added an instruction to the module, so need to be careful about the
-  // validity of existing analyses.
-  context->InvalidateAnalysesExceptFor(opt::IRContext::Analysis::kAnalysisNone);
+  fuzzerutil::InvalidateAnalysesAfterAddingConstant(context);
 }
 
 protobufs::Transformation TransformationAddConstantComposite::ToMessage()
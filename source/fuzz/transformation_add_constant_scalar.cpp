@@ -66,15 +66,12 @@ void TransformationAddConstantScalar::Apply(
   for (auto word : message_.word()) {
     operand_list.push_back({SPV_OPERAND_TYPE_LITERAL_INTEGER, {word}});
   }
-  context->module()->AddGlobalValue(
+  context->AddGlobalValue(
       MakeUnique<opt::Instruction>(context, SpvOpConstant, message_.type_id(),
                                    message_.fresh_id(), operand_list));
 
   fuzzerutil::UpdateModuleIdBound(context, message_.fresh_id());
-
-  // We have added an instruction to the module, so need to be careful about the
-  // validity of existing analyses.
-  context->InvalidateAnalysesExceptFor(opt::IRContext::Analysis::kAnalysisNone);
+  fuzzerutil::InvalidateAnalysesAfterAddingConstant(context);
 }
 
 protobufs::Transformation TransformationAddConstantScalar::ToMessage() const {
@@ -170,16 +170,17 @@ bool TransformationAddDeadBreak::IsApplicable(
 
   // Adding the dead break is only valid if SPIR-V rules related to dominance
   // hold.  Rather than checking these rules explicitly, we defer to the
-  // validator.  We make a clone of the module, apply the transformation to the
-  // clone, and check whether the transformed clone is valid.
+  // validator.  We tentatively add the edge to the module, check whether the
+  // module is valid, and remove the edge again; this avoids cloning the
+  // module, and keeps the analyses that were computed for it.
   //
   // In principle some of the above checks could be removed, with more reliance
   // being places on the validator.  This should be revisited if we are sure
   // the validator is complete with respect to checking structured control flow
   // rules.
-  auto cloned_context = fuzzerutil::CloneIRContext(context);
-  ApplyImpl(cloned_context.get());
-  return fuzzerutil::IsValid(cloned_context.get());
+  return fuzzerutil::IsValidWithUnreachableEdge(
+      context, bb_from, bb_to, message_.break_condition_value(),
+      message_.phi_id());
 }
 
 void TransformationAddDeadBreak::Apply(opt::IRContext* context,
@@ -37,20 +37,28 @@ bool TransformationAddFunction::IsApplicable(
   // Because checking all the conditions for a function to be valid is a big
   // job that the SPIR-V validator can already do, a "try it and see" approach
   // is taken here.
-
-  // We first clone the current module, so that we can try adding the new
-  // function without risking wrecking |context|.
-  auto cloned_module = fuzzerutil::CloneIRContext(context);
-
-  // We try to add a function to the cloned module, which may fail if
+  //
+  // The function is tentatively added to |context| itself, rather than to a
+  // clone of it, and removed again once the module has been validated.
+  // Adding the function only appends it to the module and raises the id
+  // bound; no analysis is updated, so the analyses of |context| stay valid.
+  const uint32_t id_bound = context->module()->id_bound();
+
+  // We try to add a function to the module, which may fail if
   // |message_.instruction| is not sufficiently well-formed.
-  if (!TryToAddFunction(cloned_module.get())) {
-    return false;
+  bool result = TryToAddFunction(context);
+  if (result) {
+    // Having managed to add the new function to the module, we ascertain
+    // whether the module is still valid.  If it is, the transformation is
+    // applicable.
+    result = fuzzerutil::IsValid(context);
+    // The function was appended, so it is the last one.
+    auto added_function = context->module()->end();
+    --added_function;
+    added_function.Erase();
   }
-  // Having managed to add the new function to the cloned module, we ascertain
-  // whether the cloned module is still valid.  If it is, the transformation is
-  // applicable.
-  return fuzzerutil::IsValid(cloned_module.get());
+  context->module()->SetIdBound(id_bound);
+  return result;
 }
 
 void TransformationAddFunction::Apply(
@@ -43,13 +43,14 @@ bool TransformationAddGlobalUndef::IsApplicable(
 
 void TransformationAddGlobalUndef::Apply(
     opt::IRContext* context, spvtools::fuzz::FactManager* /*unused*/) const {
-  context->module()->AddGlobalValue(MakeUnique<opt::Instruction>(
+  // Adding the instruction through the context registers it with the def-use
+  // manager, so the other analyses can be kept.
+  context->AddGlobalValue(MakeUnique<opt::Instruction>(
       context, SpvOpUndef, message_.type_id(), message_.fresh_id(),
       opt::Instruction::OperandList()));
   fuzzerutil::UpdateModuleIdBound(context, message_.fresh_id());
-  // We have added an instruction to the module, so need to be careful about the
-  // validity of existing analyses.
-  context->InvalidateAnalysesExceptFor(opt::IRContext::Analysis::kAnalysisNone);
+  context->InvalidateAnalysesExceptFor(
+      fuzzerutil::GetAnalysesPreservedByAddingInstruction());
 }
 
 protobufs::Transformation TransformationAddGlobalUndef::ToMessage() const {
@@ -79,7 +79,7 @@ void TransformationAddGlobalVariable::Apply(
     input_operands.push_back(
         {SPV_OPERAND_TYPE_ID, {message_.initializer_id()}});
   }
-  context->module()->AddGlobalValue(
+  context->AddGlobalValue(
       MakeUnique<opt::Instruction>(context, SpvOpVariable, message_.type_id(),
                                    message_.fresh_id(), input_operands));
   fuzzerutil::UpdateModuleIdBound(context, message_.fresh_id());
@@ -96,12 +96,14 @@ void TransformationAddGlobalVariable::Apply(
     //  this if a more thorough approach to entry point interfaces is taken.
     for (auto& entry_point : context->module()->entry_points()) {
       entry_point.AddOperand({SPV_OPERAND_TYPE_ID, {message_.fresh_id()}});
+      context->UpdateDefUse(&entry_point);
     }
   }
 
-  // We have added an instruction to the module, so need to be careful about the
-  // validity of existing analyses.
-  context->InvalidateAnalysesExceptFor(opt::IRContext::Analysis::kAnalysisNone);
+  // The new variable and the entry points using it have been registered with
+  // the def-use manager, so the other analyses can be kept.
+  context->InvalidateAnalysesExceptFor(
+      fuzzerutil::GetAnalysesPreservedByAddingInstruction());
 }
 
 protobufs::Transformation TransformationAddGlobalVariable::ToMessage() const {
@@ -70,12 +70,10 @@ void TransformationAddTypeArray::Apply(
   opt::Instruction::OperandList in_operands;
   in_operands.push_back({SPV_OPERAND_TYPE_ID, {message_.element_type_id()}});
   in_operands.push_back({SPV_OPERAND_TYPE_ID, {message_.size_id()}});
-  context->module()->AddType(MakeUnique<opt::Instruction>(
+  context->AddType(MakeUnique<opt::Instruction>(
       context, SpvOpTypeArray, 0, message_.fresh_id(), in_operands));
   fuzzerutil::UpdateModuleIdBound(context, message_.fresh_id());
-  // We have added an instruction to the module, so need to be careful about the
-  // validity of existing analyses.
-  context->InvalidateAnalysesExceptFor(opt::IRContext::Analysis::kAnalysisNone);
+  fuzzerutil::InvalidateAnalysesAfterAddingType(context);
 }
 
 protobufs::Transformation TransformationAddTypeArray::ToMessage() const {
@@ -43,12 +43,10 @@ bool TransformationAddTypeBoolean::IsApplicable(
 void TransformationAddTypeBoolean::Apply(
     opt::IRContext* context, spvtools::fuzz::FactManager* /*unused*/) const {
   opt::Instruction::OperandList empty_operands;
-  context->module()->AddType(MakeUnique<opt::Instruction>(
+  context->AddType(MakeUnique<opt::Instruction>(
       context, SpvOpTypeBool, 0, message_.fresh_id(), empty_operands));
   fuzzerutil::UpdateModuleIdBound(context, message_.fresh_id());
-  // We have added an instruction to the module, so need to be careful about the
-  // validity of existing analyses.
-  context->InvalidateAnalysesExceptFor(opt::IRContext::Analysis::kAnalysisNone);
+  fuzzerutil::InvalidateAnalysesAfterAddingType(context);
 }
 
 protobufs::Transformation TransformationAddTypeBoolean::ToMessage() const {
@@ -47,12 +47,10 @@ void TransformationAddTypeFloat::Apply(
     opt::IRContext* context, spvtools::fuzz::FactManager* /*unused*/) const {
   opt::Instruction::OperandList width = {
       {SPV_OPERAND_TYPE_LITERAL_INTEGER, {message_.width()}}};
-  context->module()->AddType(MakeUnique<opt::Instruction>(
+  context->AddType(MakeUnique<opt::Instruction>(
       context, SpvOpTypeFloat, 0, message_.fresh_id(), width));
   fuzzerutil::UpdateModuleIdBound(context, message_.fresh_id());
-  // We have added an instruction to the module, so need to be careful about the
-  // validity of existing analyses.
-  context->InvalidateAnalysesExceptFor(opt::IRContext::Analysis::kAnalysisNone);
+  fuzzerutil::InvalidateAnalysesAfterAddingType(context);
 }
 
 protobufs::Transformation TransformationAddTypeFloat::ToMessage() const {
@@ -95,12 +95,10 @@ void TransformationAddTypeFunction::Apply(
   for (auto argument_type_id : message_.argument_type_id()) {
     in_operands.push_back({SPV_OPERAND_TYPE_ID, {argument_type_id}});
   }
-  context->module()->AddType(MakeUnique<opt::Instruction>(
+  context->AddType(MakeUnique<opt::Instruction>(
       context, SpvOpTypeFunction, 0, message_.fresh_id(), in_operands));
   fuzzerutil::UpdateModuleIdBound(context, message_.fresh_id());
-  // We have added an instruction to the module, so need to be careful about the
-  // validity of existing analyses.
-  context->InvalidateAnalysesExceptFor(opt::IRContext::Analysis::kAnalysisNone);
+  fuzzerutil::InvalidateAnalysesAfterAddingType(context);
 }
 
 protobufs::Transformation TransformationAddTypeFunction::ToMessage() const {
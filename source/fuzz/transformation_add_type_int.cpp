@@ -50,12 +50,10 @@ void TransformationAddTypeInt::Apply(
   opt::Instruction::OperandList in_operands = {
       {SPV_OPERAND_TYPE_LITERAL_INTEGER, {message_.width()}},
       {SPV_OPERAND_TYPE_LITERAL_INTEGER, {message_.is_signed() ? 1u : 0u}}};
-  context->module()->AddType(MakeUnique<opt::Instruction>(
+  context->AddType(MakeUnique<opt::Instruction>(
       context, SpvOpTypeInt, 0, message_.fresh_id(), in_operands));
   fuzzerutil::UpdateModuleIdBound(context, message_.fresh_id());
-  // We have added an instruction to the module, so need to be careful about the
-  // validity of existing analyses.
-  context->InvalidateAnalysesExceptFor(opt::IRContext::Analysis::kAnalysisNone);
+  fuzzerutil::InvalidateAnalysesAfterAddingType(context);
 }
 
 protobufs::Transformation TransformationAddTypeInt::ToMessage() const {
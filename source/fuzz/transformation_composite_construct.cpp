@@ -129,12 +129,14 @@ void TransformationCompositeConstruct::Apply(opt::IRContext* context,
   }
 
   // Insert an OpCompositeConstruct instruction.
-  insert_before.InsertBefore(MakeUnique<opt::Instruction>(
+  auto composite = insert_before.InsertBefore(MakeUnique<opt::Instruction>(
       context, SpvOpCompositeConstruct, message_.composite_type_id(),
       message_.fresh_id(), in_operands));
 
   fuzzerutil::UpdateModuleIdBound(context, message_.fresh_id());
-  context->InvalidateAnalysesExceptFor(opt::IRContext::kAnalysisNone);
+  context->AnalyzeDefUse(&*composite);
+  context->InvalidateAnalysesExceptFor(
+      fuzzerutil::GetAnalysesPreservedByAddingInstruction());
 
   // Inform the fact manager that we now have new synonyms: every component of
   // the composite is synonymous with the id used to construct that component,
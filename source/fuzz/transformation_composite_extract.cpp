@@ -92,14 +92,16 @@ void TransformationCompositeExtract::Apply(
   auto extracted_type = fuzzerutil::WalkCompositeTypeIndices(
       context, composite_instruction->type_id(), message_.index());
 
-  FindInstruction(message_.instruction_to_insert_before(), context)
-      ->InsertBefore(MakeUnique<opt::Instruction>(
-          context, SpvOpCompositeExtract, extracted_type, message_.fresh_id(),
-          extract_operands));
+  opt::Instruction* extract =
+      FindInstruction(message_.instruction_to_insert_before(), context)
+          ->InsertBefore(MakeUnique<opt::Instruction>(
+              context, SpvOpCompositeExtract, extracted_type,
+              message_.fresh_id(), extract_operands));
 
   fuzzerutil::UpdateModuleIdBound(context, message_.fresh_id());
-
-  context->InvalidateAnalysesExceptFor(opt::IRContext::Analysis::kAnalysisNone);
+  context->AnalyzeDefUse(extract);
+  context->InvalidateAnalysesExceptFor(
+      fuzzerutil::GetAnalysesPreservedByAddingInstruction());
 
   // Add the fact that the id storing the extracted element is synonymous with
   // the index into the structure.
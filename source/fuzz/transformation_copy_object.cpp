@@ -95,12 +95,15 @@ void TransformationCopyObject::Apply(opt::IRContext* context,
 
   opt::Instruction::OperandList operands = {
       {SPV_OPERAND_TYPE_ID, {message_.object()}}};
-  insert_before->InsertBefore(MakeUnique<opt::Instruction>(
-      context, SpvOp::SpvOpCopyObject, object_inst->type_id(),
-      message_.fresh_id(), operands));
+  opt::Instruction* copy = insert_before->InsertBefore(
+      MakeUnique<opt::Instruction>(context, SpvOp::SpvOpCopyObject,
+                                   object_inst->type_id(), message_.fresh_id(),
+                                   operands));
 
   fuzzerutil::UpdateModuleIdBound(context, message_.fresh_id());
-  context->InvalidateAnalysesExceptFor(opt::IRContext::Analysis::kAnalysisNone);
+  context->AnalyzeDefUse(copy);
+  context->InvalidateAnalysesExceptFor(
+      fuzzerutil::GetAnalysesPreservedByAddingInstruction());
 
   fact_manager->AddFactDataSynonym(MakeDataDescriptor(message_.object(), {}),
                                    MakeDataDescriptor(message_.fresh_id(), {}),
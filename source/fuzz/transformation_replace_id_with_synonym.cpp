@@ -78,7 +78,11 @@ void TransformationReplaceIdWithSynonym::Apply(
   instruction_to_change->SetInOperand(
       message_.id_use_descriptor().in_operand_index(),
       {message_.synonymous_id()});
-  context->InvalidateAnalysesExceptFor(opt::IRContext::Analysis::kAnalysisNone);
+  // Only a use has changed, so the instruction can be analyzed again in place,
+  // and the analyses of the rest of the module kept.
+  context->UpdateDefUse(instruction_to_change);
+  context->InvalidateAnalysesExceptFor(
+      fuzzerutil::GetAnalysesPreservedByAddingInstruction());
 }
 
 protobufs::Transformation TransformationReplaceIdWithSynonym::ToMessage()
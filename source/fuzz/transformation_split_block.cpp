@@ -103,16 +103,18 @@ void TransformationSplitBlock::Apply(opt::IRContext* context,
       context, SpvOpBranch, 0, 0,
       std::initializer_list<opt::Operand>{opt::Operand(
           spv_operand_type_t::SPV_OPERAND_TYPE_ID, {message_.fresh_id()})}));
+  context->AnalyzeDefUse(block_to_split->terminator());
   // If we split before OpPhi instructions, we need to update their
   // predecessor operand so that the block they used to be inside is now the
   // predecessor.
-  new_bb->ForEachPhiInst([block_to_split](opt::Instruction* phi_inst) {
+  new_bb->ForEachPhiInst([context, block_to_split](opt::Instruction* phi_inst) {
     // The following assertion is a sanity check.  It is guaranteed to hold
     // if IsApplicable holds.
     assert(phi_inst->NumInOperands() == 2 &&
            "We can only split a block before an OpPhi if block has exactly "
            "one predecessor.");
     phi_inst->SetInOperand(1, {block_to_split->id()});
+    context->UpdateDefUse(phi_inst);
   });
 
   // If the block being split was dead, the new block arising from the split is
@@ -121,8 +123,21 @@ void TransformationSplitBlock::Apply(opt::IRContext* context,
     fact_manager->AddFactBlockIsDead(message_.fresh_id());
   }
 
-  // Invalidate all analyses
-  context->InvalidateAnalysesExceptFor(opt::IRContext::Analysis::kAnalysisNone);
+  // The split keeps the def-use manager and the instruction-to-block mapping
+  // up to date.  Only the control flow of the function has changed, so the
+  // CFG is rebuilt for it alone, and the dominator and loop analyses of the
+  // other functions are kept.
+  context->InvalidateAnalysesForFunction(
+      block_to_split->GetParent(),
+      opt::IRContext::kAnalysisCFG |
+          opt::IRContext::kAnalysisDominatorAnalysis |
+          opt::IRContext::kAnalysisLoopAnalysis |
+          opt::IRContext::kAnalysisStructuredCFG |
+          opt::IRContext::kAnalysisValueNumberTable |
+          opt::IRContext::kAnalysisScalarEvolution |
+          opt::IRContext::kAnalysisRegisterPressure |
+          opt::IRContext::kAnalysisUniformity |
+          opt::IRContext::kAnalysisModuleSummary);
 }
 
 protobufs::Transformation TransformationSplitBlock::ToMessage() const {
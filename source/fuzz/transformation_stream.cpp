@@ -0,0 +1,96 @@
+// Copyright (c) 2019 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "source/fuzz/transformation_stream.h"
+
+#include <limits>
+
+namespace spvtools {
+namespace fuzz {
+
+bool WriteTransformationToStream(
+    const protobufs::Transformation& transformation, std::ostream* stream) {
+  const size_t size = transformation.ByteSizeLong();
+  if (size > static_cast<size_t>(std::numeric_limits<int>::max())) {
+    return false;
+  }
+  google::protobuf::io::OstreamOutputStream output(stream);
+  {
+    // The coded stream must be destroyed before |output| is flushed.
+    google::protobuf::io::CodedOutputStream coded_output(&output);
+    coded_output.WriteVarint32(static_cast<uint32_t>(size));
+    transformation.SerializeWithCachedSizes(&coded_output);
+    if (coded_output.HadError()) {
+      return false;
+    }
+  }
+  return output.Flush();
+}
+
+bool WriteTransformationsToStream(
+    const protobufs::TransformationSequence& transformations,
+    std::ostream* stream) {
+  for (auto& transformation : transformations.transformation()) {
+    if (!WriteTransformationToStream(transformation, stream)) {
+      return false;
+    }
+  }
+  return true;
+}
+
+TransformationStreamReader::TransformationStreamReader(std::istream* stream)
+    : input_(stream), failed_(false) {}
+
+bool TransformationStreamReader::Next(
+    protobufs::Transformation* transformation) {
+  if (failed_) {
+    return false;
+  }
+  // A coded stream is made for each transformation, so that the total size of
+  // the stream is not limited.  Its destructor gives back to |input_| the
+  // bytes it read ahead.
+  google::protobuf::io::CodedInputStream coded_input(&input_);
+  uint32_t size;
+  if (!coded_input.ReadVarint32(&size)) {
+    // The stream may only end between two transformations.
+    failed_ = coded_input.CurrentPosition() != 0;
+    return false;
+  }
+  if (size > static_cast<uint32_t>(std::numeric_limits<int>::max())) {
+    failed_ = true;
+    return false;
+  }
+  auto limit = coded_input.PushLimit(static_cast<int>(size));
+  if (!transformation->ParseFromCodedStream(&coded_input) ||
+      !coded_input.ConsumedEntireMessage() ||
+      coded_input.BytesUntilLimit() != 0) {
+    failed_ = true;
+    return false;
+  }
+  coded_input.PopLimit(limit);
+  return true;
+}
+
+bool ReadTransformationsFromStream(
+    std::istream* stream, protobufs::TransformationSequence* transformations) {
+  TransformationStreamReader reader(stream);
+  protobufs::Transformation transformation;
+  while (reader.Next(&transformation)) {
+    *transformations->add_transformation() = transformation;
+  }
+  return !reader.failed();
+}
+
+}  // namespace fuzz
+}  // namespace spvtools
@@ -0,0 +1,73 @@
+// Copyright (c) 2019 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef SOURCE_FUZZ_TRANSFORMATION_STREAM_H_
+#define SOURCE_FUZZ_TRANSFORMATION_STREAM_H_
+
+#include <istream>
+#include <ostream>
+
+#include "source/fuzz/protobufs/spirvfuzz_protobufs.h"
+
+namespace spvtools {
+namespace fuzz {
+
+// A transformation stream is a compact binary form of a sequence of
+// transformations which can be read one transformation at a time: each
+// transformation message is written in the protobuf binary format, preceded
+// by its size in bytes as a varint.  A concatenation of transformation streams
+// is a transformation stream.
+
+// Appends |transformation| to the transformation stream |stream|.  Returns
+// false if it could not be written.
+bool WriteTransformationToStream(
+    const protobufs::Transformation& transformation, std::ostream* stream);
+
+// Appends the transformations of |transformations| to the transformation
+// stream |stream|.  Returns false if they could not be written.
+bool WriteTransformationsToStream(
+    const protobufs::TransformationSequence& transformations,
+    std::ostream* stream);
+
+// Reads the transformations of a transformation stream one at a time.
+class TransformationStreamReader {
+ public:
+  explicit TransformationStreamReader(std::istream* stream);
+
+  TransformationStreamReader(const TransformationStreamReader&) = delete;
+  TransformationStreamReader& operator=(const TransformationStreamReader&) =
+      delete;
+
+  // Reads the next transformation of the stream to |transformation|.  Returns
+  // false at the end of the stream, or if the stream is malformed, in which
+  // case failed() returns true.
+  bool Next(protobufs::Transformation* transformation);
+
+  // Returns true if a malformed transformation was read.
+  bool failed() const { return failed_; }
+
+ private:
+  google::protobuf::io::IstreamInputStream input_;
+  bool failed_;
+};
+
+// Reads all the transformations of the transformation stream |stream| to
+// |transformations|.  Returns false if the stream is malformed.
+bool ReadTransformationsFromStream(
+    std::istream* stream, protobufs::TransformationSequence* transformations);
+
+}  // namespace fuzz
+}  // namespace spvtools
+
+#endif  // SOURCE_FUZZ_TRANSFORMATION_STREAM_H_
@@ -129,12 +129,15 @@ void TransformationVectorShuffle::Apply(
 
   // Add a shuffle instruction right before the instruction identified by
   // |message_.instruction_to_insert_before|.
-  FindInstruction(message_.instruction_to_insert_before(), context)
-      ->InsertBefore(MakeUnique<opt::Instruction>(
-          context, SpvOpVectorShuffle, result_type_id, message_.fresh_id(),
-          shuffle_operands));
+  opt::Instruction* shuffle =
+      FindInstruction(message_.instruction_to_insert_before(), context)
+          ->InsertBefore(MakeUnique<opt::Instruction>(
+              context, SpvOpVectorShuffle, result_type_id, message_.fresh_id(),
+              shuffle_operands));
   fuzzerutil::UpdateModuleIdBound(context, message_.fresh_id());
-  context->InvalidateAnalysesExceptFor(opt::IRContext::Analysis::kAnalysisNone);
+  context->AnalyzeDefUse(shuffle);
+  context->InvalidateAnalysesExceptFor(
+      fuzzerutil::GetAnalysesPreservedByAddingInstruction());
 
   // Add synonym facts relating the defined elements of the shuffle result to
   // the vector components that they come from.
@@ -14,6 +14,7 @@
 
 #include "spirv-tools/libspirv.hpp"
 
+#include <cstdio>
 #include <iostream>
 
 #include <string>
@@ -24,6 +25,27 @@
 
 namespace spvtools {
 
+DirectoryValidationCache::DirectoryValidationCache(const std::string& path)
+    : path_(path) {}
+
+bool DirectoryValidationCache::Contains(const std::string& key) {
+  FILE* file = fopen(FilePath(key).c_str(), "rb");
+  if (!file) return false;
+  fclose(file);
+  return true;
+}
+
+void DirectoryValidationCache::Insert(const std::string& key) {
+  // The file is empty, so a partly written one is as good as a complete one.
+  if (FILE* file = fopen(FilePath(key).c_str(), "wb")) fclose(file);
+}
+
+std::string DirectoryValidationCache::FilePath(const std::string& key) const {
+  if (path_.empty()) return key;
+  const char last = path_.back();
+  return last == '/' || last == '\\' ? path_ + key : path_ + "/" + key;
+}
+
 Context::Context(spv_target_env env) : context_(spvContextCreate(env)) {}
 
 Context::Context(Context&& other) : context_(other.context_) {
@@ -104,6 +126,30 @@ bool SpirvTools::Disassemble(const uint32_t* binary, const size_t binary_size,
   return status == SPV_SUCCESS;
 }
 
+bool SpirvTools::Encode(const std::vector<uint32_t>& binary,
+                        std::vector<uint8_t>* encoded) const {
+  spv_encoded_binary spvencoded = nullptr;
+  spv_result_t status = spvBinaryEncode(impl_->context, binary.data(),
+                                        binary.size(), &spvencoded, nullptr);
+  if (status == SPV_SUCCESS) {
+    encoded->assign(spvencoded->bytes, spvencoded->bytes + spvencoded->size);
+  }
+  spvEncodedBinaryDestroy(spvencoded);
+  return status == SPV_SUCCESS;
+}
+
+bool SpirvTools::Decode(const std::vector<uint8_t>& encoded,
+                        std::vector<uint32_t>* binary) const {
+  spv_binary spvbinary = nullptr;
+  spv_result_t status = spvBinaryDecode(impl_->context, encoded.data(),
+                                        encoded.size(), &spvbinary, nullptr);
+  if (status == SPV_SUCCESS) {
+    binary->assign(spvbinary->code, spvbinary->code + spvbinary->wordCount);
+  }
+  spvBinaryDestroy(spvbinary);
+  return status == SPV_SUCCESS;
+}
+
 bool SpirvTools::Validate(const std::vector<uint32_t>& binary) const {
   return Validate(binary.data(), binary.size());
 }
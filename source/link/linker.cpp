@@ -27,18 +27,80 @@
 
 #include "source/assembly_grammar.h"
 #include "source/diagnostic.h"
+#include "source/opcode.h"
 #include "source/opt/build_module.h"
 #include "source/opt/compact_ids_pass.h"
 #include "source/opt/decoration_manager.h"
+#include "source/opt/eliminate_dead_functions_pass.h"
 #include "source/opt/ir_loader.h"
 #include "source/opt/pass_manager.h"
 #include "source/opt/remove_duplicates_pass.h"
 #include "source/opt/type_manager.h"
+#include "source/operand.h"
 #include "source/spirv_target_env.h"
 #include "source/util/make_unique.h"
+#include "source/util/parallel.h"
 #include "spirv-tools/libspirv.hpp"
 
 namespace spvtools {
+
+struct LinkCache::Impl {
+  // A module loaded from |binary| for |target_env|.  |used| tells if the
+  // module is an input of the current call to Link.
+  struct Entry {
+    spv_target_env target_env;
+    std::vector<uint32_t> binary;
+    std::unique_ptr<opt::IRContext> context;
+    bool used;
+  };
+
+  // Returns the hash of the |size| words of |binary|.
+  static size_t Hash(const uint32_t* binary, size_t size) {
+    size_t hash = size;
+    for (size_t i = 0; i < size; ++i) {
+      hash = hash * 31 + binary[i];
+    }
+    return hash;
+  }
+
+  // Returns the unused entry for the |size| words of |binary|, whose hash is
+  // |hash|, or nullptr if there is none.
+  Entry* Find(spv_target_env target_env, const uint32_t* binary, size_t size,
+              size_t hash) {
+    auto range = entries.equal_range(hash);
+    for (auto it = range.first; it != range.second; ++it) {
+      Entry& entry = it->second;
+      if (!entry.used && entry.target_env == target_env &&
+          entry.binary.size() == size &&
+          std::equal(entry.binary.begin(), entry.binary.end(), binary)) {
+        return &entry;
+      }
+    }
+    return nullptr;
+  }
+
+  // Removes the entries whose |used| is |used|.
+  void RemoveIf(bool used) {
+    for (auto it = entries.begin(); it != entries.end();) {
+      if (it->second.used == used) {
+        it = entries.erase(it);
+      } else {
+        ++it;
+      }
+    }
+  }
+
+  std::unordered_multimap<size_t, Entry> entries;
+};
+
+LinkCache::LinkCache() : impl_(new Impl()) {}
+
+LinkCache::~LinkCache() {}
+
+size_t LinkCache::size() const { return impl_->entries.size(); }
+
+void LinkCache::Clear() { impl_->entries.clear(); }
+
 namespace {
 
 using opt::Instruction;
@@ -70,6 +132,15 @@ struct LinkageEntry {
 };
 using LinkageTable = std::vector<LinkageEntry>;
 
+// A message reported while an input module was built, kept to be passed on
+// to the consumer of the caller once all the modules are built.
+struct BufferedMessage {
+  spv_message_level_t level;
+  std::string source;
+  spv_position_t position;
+  std::string message;
+};
+
 // Shifts the IDs used in each binary of |modules| so that they occupy a
 // disjoint range from the other binaries, and compute the new ID bound which
 // is returned in |max_id_bound|.
@@ -81,6 +152,9 @@ spv_result_t ShiftIdsInModules(const MessageConsumer& consumer,
                                std::vector<opt::Module*>* modules,
                                uint32_t* max_id_bound);
 
+// Undoes the shift of the IDs of |modules| done by ShiftIdsInModules.
+void UnshiftIdsInModules(const std::vector<opt::Module*>& modules);
+
 // Generates the header for the linked module and returns it in |header|.
 //
 // |header| should not be null, |modules| should not be empty and pointers
@@ -93,8 +167,17 @@ spv_result_t GenerateHeader(const MessageConsumer& consumer,
                             const std::vector<opt::Module*>& modules,
                             uint32_t max_id_bound, opt::ModuleHeader* header);
 
+// Finds the types and constants of |modules| which are the same as one found
+// before them, and records the ID of the first one for their ID in
+// |replacements|.  The decorated ones are left to the RemoveDuplicatesPass,
+// since their decorations must be compared too.
+void FindDuplicateGlobalValues(
+    const std::vector<opt::Module*>& modules,
+    std::unordered_map<uint32_t, uint32_t>* replacements);
+
 // Merge all the modules from |in_modules| into a single module owned by
-// |linked_context|.
+// |linked_context|.  The types and constants found by
+// FindDuplicateGlobalValues are only copied once.
 //
 // |linked_context| should not be null.
 spv_result_t MergeModules(const MessageConsumer& consumer,
@@ -189,6 +272,19 @@ spv_result_t ShiftIdsInModules(const MessageConsumer& consumer,
   return SPV_SUCCESS;
 }
 
+void UnshiftIdsInModules(const std::vector<opt::Module*>& modules) {
+  uint32_t id_bound = modules.front()->IdBound() - 1u;
+  for (auto module_iter = modules.begin() + 1; module_iter != modules.end();
+       ++module_iter) {
+    Module* module = *module_iter;
+    module->ForEachInst([&id_bound](Instruction* insn) {
+      insn->ForEachId([&id_bound](uint32_t* id) { *id -= id_bound; });
+    });
+    id_bound += module->IdBound() - 1u;
+    module->context()->InvalidateAnalyses(opt::IRContext::kAnalysisDefUse);
+  }
+}
+
 spv_result_t GenerateHeader(const MessageConsumer& consumer,
                             const std::vector<opt::Module*>& modules,
                             uint32_t max_id_bound, opt::ModuleHeader* header) {
@@ -214,6 +310,91 @@ spv_result_t GenerateHeader(const MessageConsumer& consumer,
   return SPV_SUCCESS;
 }
 
+// Returns true if the instructions with |opcode| that have the same operands
+// define the same type or constant.
+bool IsMergeableGlobalValue(SpvOp opcode) {
+  switch (opcode) {
+    case SpvOpTypeForwardPointer:
+      return false;
+    case SpvOpConstantTrue:
+    case SpvOpConstantFalse:
+    case SpvOpConstant:
+    case SpvOpConstantComposite:
+    case SpvOpConstantSampler:
+    case SpvOpConstantNull:
+      return true;
+    default:
+      return spvOpcodeGeneratesType(opcode) != 0;
+  }
+}
+
+// Hashes the words identifying a type or a constant.
+struct GlobalValueKeyHash {
+  size_t operator()(const std::vector<uint32_t>& words) const {
+    size_t hash = words.size();
+    for (uint32_t word : words) {
+      hash = hash * 31 + word;
+    }
+    return hash;
+  }
+};
+
+void FindDuplicateGlobalValues(
+    const std::vector<opt::Module*>& modules,
+    std::unordered_map<uint32_t, uint32_t>* replacements) {
+  // The words of each type and constant, with the IDs they use replaced, and
+  // the ID of the first one found.
+  std::unordered_map<std::vector<uint32_t>, uint32_t, GlobalValueKeyHash>
+      first_ids;
+  const auto replace = [replacements](uint32_t id) {
+    const auto it = replacements->find(id);
+    return it != replacements->end() ? it->second : id;
+  };
+  std::vector<uint32_t> key;
+  for (const auto& module : modules) {
+    // The decorated IDs, and the pointers declared by an
+    // OpTypeForwardPointer, which may be part of a recursive type, are kept.
+    std::unordered_set<uint32_t> kept_ids;
+    for (const auto& inst : module->annotations()) {
+      if (inst.opcode() == SpvOpGroupDecorate ||
+          inst.opcode() == SpvOpGroupMemberDecorate) {
+        inst.ForEachInId([&kept_ids](const uint32_t* id) {
+          kept_ids.insert(*id);
+        });
+      } else if (inst.NumInOperands() > 0) {
+        kept_ids.insert(inst.GetSingleWordInOperand(0u));
+      }
+    }
+    for (const auto& inst : module->types_values()) {
+      if (inst.opcode() == SpvOpTypeForwardPointer)
+        kept_ids.insert(inst.GetSingleWordInOperand(0u));
+    }
+
+    for (const auto& inst : module->types_values()) {
+      if (!IsMergeableGlobalValue(inst.opcode()) ||
+          kept_ids.count(inst.result_id()))
+        continue;
+
+      key.clear();
+      key.push_back(inst.opcode());
+      key.push_back(inst.type_id());
+      for (uint32_t i = 0; i < inst.NumInOperands(); ++i) {
+        const auto& operand = inst.GetInOperand(i);
+        const bool is_id = spvIsInIdType(operand.type);
+        key.push_back(static_cast<uint32_t>(operand.words.size()));
+        for (uint32_t word : operand.words) {
+          key.push_back(is_id ? replace(word) : word);
+        }
+      }
+      key[1] = replace(key[1]);
+
+      const auto found = first_ids.emplace(key, inst.result_id());
+      if (!found.second)
+        (*replacements)[inst.result_id()] = found.first->second;
+    }
+  }
+}
+
 spv_result_t MergeModules(const MessageConsumer& consumer,
                           const std::vector<Module*>& input_modules,
                           const AssemblyGrammar& grammar,
@@ -227,20 +408,32 @@ spv_result_t MergeModules(const MessageConsumer& consumer,
 
   if (input_modules.empty()) return SPV_SUCCESS;
 
+  std::unordered_map<uint32_t, uint32_t> replacements;
+  FindDuplicateGlobalValues(input_modules, &replacements);
+  const auto replace_ids = [&replacements](Instruction* inst) {
+    inst->ForEachId([&replacements](uint32_t* id) {
+      const auto it = replacements.find(*id);
+      if (it != replacements.end()) *id = it->second;
+    });
+  };
+  const auto clone = [linked_context, &replacements,
+                      &replace_ids](const Instruction& inst) {
+    std::unique_ptr<Instruction> cloned(inst.Clone(linked_context));
+    if (!replacements.empty()) replace_ids(cloned.get());
+    return cloned;
+  };
+
   for (const auto& module : input_modules)
     for (const auto& inst : module->capabilities())
-      linked_module->AddCapability(
-          std::unique_ptr<Instruction>(inst.Clone(linked_context)));
+      linked_module->AddCapability(clone(inst));
 
   for (const auto& module : input_modules)
     for (const auto& inst : module->extensions())
-      linked_module->AddExtension(
-          std::unique_ptr<Instruction>(inst.Clone(linked_context)));
+      linked_module->AddExtension(clone(inst));
 
   for (const auto& module : input_modules)
     for (const auto& inst : module->ext_inst_imports())
-      linked_module->AddExtInstImport(
-          std::unique_ptr<Instruction>(inst.Clone(linked_context)));
+      linked_module->AddExtInstImport(clone(inst));
 
   do {
     const Instruction* memory_model_inst = input_modules[0]->GetMemoryModel();
@@ -299,35 +492,32 @@ spv_result_t MergeModules(const MessageConsumer& consumer,
                << "The entry point \"" << name << "\", with execution model "
                << desc->name << ", was already defined.";
       }
-      linked_module->AddEntryPoint(
-          std::unique_ptr<Instruction>(inst.Clone(linked_context)));
+      linked_module->AddEntryPoint(clone(inst));
       entry_points.emplace_back(model, name);
     }
 
   for (const auto& module : input_modules)
     for (const auto& inst : module->execution_modes())
-      linked_module->AddExecutionMode(
-          std::unique_ptr<Instruction>(inst.Clone(linked_context)));
+      linked_module->AddExecutionMode(clone(inst));
 
   for (const auto& module : input_modules)
     for (const auto& inst : module->debugs1())
-      linked_module->AddDebug1Inst(
-          std::unique_ptr<Instruction>(inst.Clone(linked_context)));
+      linked_module->AddDebug1Inst(clone(inst));
 
   for (const auto& module : input_modules)
-    for (const auto& inst : module->debugs2())
-      linked_module->AddDebug2Inst(
-          std::unique_ptr<Instruction>(inst.Clone(linked_context)));
+    for (const auto& inst : module->debugs2()) {
+      // The names of the duplicates are dropped with them.
+      if (replacements.count(inst.GetSingleWordInOperand(0u))) continue;
+      linked_module->AddDebug2Inst(clone(inst));
+    }
 
   for (const auto& module : input_modules)
     for (const auto& inst : module->debugs3())
-      linked_module->AddDebug3Inst(
-          std::unique_ptr<Instruction>(inst.Clone(linked_context)));
+      linked_module->AddDebug3Inst(clone(inst));
 
   for (const auto& module : input_modules)
     for (const auto& inst : module->ext_inst_debuginfo())
-      linked_module->AddExtInstDebugInfo(
-          std::unique_ptr<Instruction>(inst.Clone(linked_context)));
+      linked_module->AddExtInstDebugInfo(clone(inst));
 
   // If the generated module uses SPIR-V 1.1 or higher, add an
   // OpModuleProcessed instruction about the linking step.
@@ -345,8 +535,7 @@ spv_result_t MergeModules(const MessageConsumer& consumer,
 
   for (const auto& module : input_modules)
     for (const auto& inst : module->annotations())
-      linked_module->AddAnnotationInst(
-          std::unique_ptr<Instruction>(inst.Clone(linked_context)));
+      linked_module->AddAnnotationInst(clone(inst));
 
   // TODO(pierremoreau): Since the modules have not been validate, should we
   //                     expect SpvStorageClassFunction variables outside
@@ -354,8 +543,8 @@ spv_result_t MergeModules(const MessageConsumer& consumer,
   uint32_t num_global_values = 0u;
   for (const auto& module : input_modules) {
     for (const auto& inst : module->types_values()) {
-      linked_module->AddType(
-          std::unique_ptr<Instruction>(inst.Clone(linked_context)));
+      if (replacements.count(inst.result_id())) continue;
+      linked_module->AddType(clone(inst));
       num_global_values += inst.opcode() == SpvOpVariable;
     }
   }
@@ -368,6 +557,7 @@ spv_result_t MergeModules(const MessageConsumer& consumer,
   for (const auto& module : input_modules) {
     for (const auto& func : *module) {
       std::unique_ptr<opt::Function> cloned_func(func.Clone(linked_context));
+      if (!replacements.empty()) cloned_func->ForEachInst(replace_ids, true);
       linked_module->AddFunction(std::move(cloned_func));
     }
   }
@@ -390,6 +580,14 @@ spv_result_t GetImportExportPairs(const MessageConsumer& consumer,
   std::vector<LinkageSymbolInfo> imports;
   std::unordered_map<std::string, std::vector<LinkageSymbolInfo>> exports;
 
+  // The functions of the module by id, to find the parameters of the function
+  // symbols without walking the module for each of them.
+  std::unordered_map<SpvId, const opt::Function*> functions;
+  for (auto func_iter = linked_context.module()->cbegin();
+       func_iter != linked_context.module()->cend(); ++func_iter) {
+    functions[func_iter->result_id()] = &*func_iter;
+  }
+
   // Figure out the imports and exports
   for (const auto& decoration : linked_context.annotations()) {
     if (decoration.opcode() != SpvOpDecorate ||
@@ -431,12 +629,9 @@ spv_result_t GetImportExportPairs(const MessageConsumer& consumer,
     } else if (def_inst->opcode() == SpvOpFunction) {
       symbol_info.type_id = def_inst->GetSingleWordInOperand(1u);
 
-      // range-based for loop calls begin()/end(), but never cbegin()/cend(),
-      // which will not work here.
-      for (auto func_iter = linked_context.module()->cbegin();
-           func_iter != linked_context.module()->cend(); ++func_iter) {
-        if (func_iter->result_id() != id) continue;
-        func_iter->ForEachParam([&symbol_info](const Instruction* inst) {
+      const auto func = functions.find(id);
+      if (func != functions.end()) {
+        func->second->ForEachParam([&symbol_info](const Instruction* inst) {
           symbol_info.parameter_ids.push_back(inst->result_id());
         });
       }
@@ -454,19 +649,18 @@ spv_result_t GetImportExportPairs(const MessageConsumer& consumer,
 
   // Find the import/export pairs
   for (const auto& import : imports) {
-    std::vector<LinkageSymbolInfo> possible_exports;
-    const auto& exp = exports.find(import.name);
-    if (exp != exports.end()) possible_exports = exp->second;
-    if (possible_exports.empty() && !allow_partial_linkage)
+    const auto exp = exports.find(import.name);
+    const size_t num_exports = exp != exports.end() ? exp->second.size() : 0u;
+    if (num_exports == 0u && !allow_partial_linkage)
       return DiagnosticStream(position, consumer, "", SPV_ERROR_INVALID_BINARY)
              << "Unresolved external reference to \"" << import.name << "\".";
-    else if (possible_exports.size() > 1u)
+    else if (num_exports > 1u)
       return DiagnosticStream(position, consumer, "", SPV_ERROR_INVALID_BINARY)
-             << "Too many external references, " << possible_exports.size()
+             << "Too many external references, " << num_exports
              << ", were found for \"" << import.name << "\".";
 
-    if (!possible_exports.empty())
-      linkings_to_do->emplace_back(import, possible_exports.front());
+    if (num_exports != 0u)
+      linkings_to_do->emplace_back(import, exp->second.front());
   }
 
   return SPV_SUCCESS;
@@ -481,11 +675,15 @@ spv_result_t CheckImportExportCompatibility(const MessageConsumer& consumer,
   const DecorationManager& decoration_manager = *context->get_decoration_mgr();
   const TypeManager& type_manager = *context->get_type_mgr();
   for (const auto& linking_entry : linkings_to_do) {
+    // The type manager keeps a single type for the equal types of the input
+    // modules, found by hash, so the types of matching symbols are usually
+    // the same object and need not be compared again.
     Type* imported_symbol_type =
         type_manager.GetType(linking_entry.imported_symbol.type_id);
     Type* exported_symbol_type =
         type_manager.GetType(linking_entry.exported_symbol.type_id);
-    if (!(*imported_symbol_type == *exported_symbol_type))
+    if (imported_symbol_type != exported_symbol_type &&
+        !(*imported_symbol_type == *exported_symbol_type))
       return DiagnosticStream(position, consumer, "", SPV_ERROR_INVALID_BINARY)
              << "Type mismatch on symbol \""
              << linking_entry.imported_symbol.name
@@ -534,26 +732,29 @@ spv_result_t RemoveLinkageSpecificInstructions(
   // TODO(pierremoreau): Remove FuncParamAttr decorations of imported
   // functions' return type.
 
+  // The imported symbols which were matched, so the module is walked once
+  // rather than once per symbol.
+  std::unordered_set<SpvId> imported_ids;
+  imported_ids.reserve(linkings_to_do.size());
+  for (const auto& linking_entry : linkings_to_do)
+    imported_ids.insert(linking_entry.imported_symbol.id);
+
   // Remove prototypes of imported functions
-  for (const auto& linking_entry : linkings_to_do) {
-    for (auto func_iter = linked_context->module()->begin();
-         func_iter != linked_context->module()->end();) {
-      if (func_iter->result_id() == linking_entry.imported_symbol.id)
-        func_iter = func_iter.Erase();
-      else
-        ++func_iter;
-    }
+  for (auto func_iter = linked_context->module()->begin();
+       func_iter != linked_context->module()->end();) {
+    if (imported_ids.count(func_iter->result_id()))
+      func_iter = func_iter.Erase();
+    else
+      ++func_iter;
   }
 
   // Remove declarations of imported variables
-  for (const auto& linking_entry : linkings_to_do) {
-    auto next = linked_context->types_values_begin();
-    for (auto inst = next; inst != linked_context->types_values_end();
-         inst = next) {
-      ++next;
-      if (inst->result_id() == linking_entry.imported_symbol.id) {
-        linked_context->KillInst(&*inst);
-      }
+  auto next_value = linked_context->types_values_begin();
+  for (auto inst = next_value; inst != linked_context->types_values_end();
+       inst = next_value) {
+    ++next_value;
+    if (imported_ids.count(inst->result_id())) {
+      linked_context->KillInst(&*inst);
     }
   }
 
@@ -668,9 +869,6 @@ spv_result_t Link(const Context& context, const uint32_t* const* binaries,
     return DiagnosticStream(position, consumer, "", SPV_ERROR_INVALID_BINARY)
            << "No modules were given.";
 
-  std::vector<std::unique_ptr<IRContext>> ir_contexts;
-  std::vector<Module*> modules;
-  modules.reserve(num_binaries);
   for (size_t i = 0u; i < num_binaries; ++i) {
     const uint32_t schema = binaries[i][4u];
     if (schema != 0u) {
@@ -678,32 +876,112 @@ spv_result_t Link(const Context& context, const uint32_t* const* binaries,
       return DiagnosticStream(position, consumer, "", SPV_ERROR_INVALID_BINARY)
              << "Schema is non-zero for module " << i << ".";
     }
+  }
 
-    std::unique_ptr<IRContext> ir_context = BuildModule(
-        c_context->target_env, consumer, binaries[i], binary_sizes[i]);
-    if (ir_context == nullptr)
-      return DiagnosticStream(position, consumer, "", SPV_ERROR_INVALID_BINARY)
-             << "Failed to build a module out of " << ir_contexts.size() << ".";
-    modules.push_back(ir_context->module());
-    ir_contexts.push_back(std::move(ir_context));
+  // Take the modules which were already loaded from |cache|.  A binary given
+  // twice is only taken once, since the ids of the modules are shifted in
+  // place.
+  LinkCache::Impl* cache =
+      options.GetCache() != nullptr ? options.GetCache()->impl_.get() : nullptr;
+  std::vector<IRContext*> input_contexts(num_binaries, nullptr);
+  std::vector<size_t> hashes(cache != nullptr ? num_binaries : 0u);
+  std::vector<size_t> to_build;
+  if (cache != nullptr) {
+    for (auto& entry : cache->entries) entry.second.used = false;
+  }
+  for (size_t i = 0u; i < num_binaries; ++i) {
+    if (cache != nullptr) {
+      hashes[i] = LinkCache::Impl::Hash(binaries[i], binary_sizes[i]);
+      LinkCache::Impl::Entry* entry =
+          cache->Find(c_context->target_env, binaries[i], binary_sizes[i],
+                      hashes[i]);
+      if (entry != nullptr) {
+        entry->used = true;
+        input_contexts[i] = entry->context.get();
+        continue;
+      }
+    }
+    to_build.push_back(i);
+  }
+
+  // The modules are independent, so they are built concurrently.  Each
+  // thread only writes the context and the messages of its own module.  The
+  // consumer need not be thread safe, so the messages are passed on to it
+  // afterwards, in the order of the modules.
+  std::vector<std::unique_ptr<IRContext>> ir_contexts(num_binaries);
+  std::vector<std::vector<BufferedMessage>> messages(num_binaries);
+  utils::ParallelFor(
+      to_build.size(), options.GetNumThreads(),
+      [&ir_contexts, &messages, &to_build, &c_context, binaries,
+       binary_sizes](size_t k) {
+        const size_t i = to_build[k];
+        std::vector<BufferedMessage>* out = &messages[i];
+        ir_contexts[i] = BuildModule(
+            c_context->target_env,
+            [out](spv_message_level_t level, const char* source,
+                  const spv_position_t& position, const char* message) {
+              out->push_back({level, source ? source : "", position, message});
+            },
+            binaries[i], binary_sizes[i]);
+      });
+  for (size_t i = 0u; i < num_binaries; ++i) {
+    if (consumer) {
+      for (const BufferedMessage& m : messages[i]) {
+        consumer(m.level, m.source.c_str(), m.position, m.message.c_str());
+      }
+    }
+    if (ir_contexts[i] != nullptr) ir_contexts[i]->SetMessageConsumer(consumer);
   }
 
+  std::vector<Module*> modules;
+  modules.reserve(num_binaries);
+  for (size_t i = 0u; i < num_binaries; ++i) {
+    if (input_contexts[i] == nullptr) {
+      if (ir_contexts[i] == nullptr)
+        return DiagnosticStream(position, consumer, "",
+                                SPV_ERROR_INVALID_BINARY)
+               << "Failed to build a module out of " << i << ".";
+      input_contexts[i] = ir_contexts[i].get();
+    }
+    modules.push_back(input_contexts[i]->module());
+  }
+
+  IRContext linked_context(c_context->target_env, consumer);
+
   // Phase 1: Shift the IDs used in each binary so that they occupy a disjoint
   //          range from the other binaries, and compute the new ID bound.
+  //          The cached modules are shifted back once merged; if the link
+  //          fails before, they are dropped from the cache instead.
   uint32_t max_id_bound = 0u;
   spv_result_t res = ShiftIdsInModules(consumer, &modules, &max_id_bound);
-  if (res != SPV_SUCCESS) return res;
-
-  // Phase 2: Generate the header
-  opt::ModuleHeader header;
-  res = GenerateHeader(consumer, modules, max_id_bound, &header);
-  if (res != SPV_SUCCESS) return res;
-  IRContext linked_context(c_context->target_env, consumer);
-  linked_context.module()->SetHeader(header);
+  if (res == SPV_SUCCESS) {
+    // Phase 2: Generate the header
+    opt::ModuleHeader header;
+    res = GenerateHeader(consumer, modules, max_id_bound, &header);
+    if (res == SPV_SUCCESS) linked_context.module()->SetHeader(header);
+  }
 
   // Phase 3: Merge all the binaries into a single one.
   AssemblyGrammar grammar(c_context);
-  res = MergeModules(consumer, modules, grammar, &linked_context);
+  if (res == SPV_SUCCESS)
+    res = MergeModules(consumer, modules, grammar, &linked_context);
+  if (cache != nullptr) {
+    if (res != SPV_SUCCESS) {
+      cache->RemoveIf(true);
+      return res;
+    }
+    UnshiftIdsInModules(modules);
+    cache->RemoveIf(false);
+    for (size_t i = 0u; i < num_binaries; ++i) {
+      if (ir_contexts[i] == nullptr) continue;
+      LinkCache::Impl::Entry entry;
+      entry.target_env = c_context->target_env;
+      entry.binary.assign(binaries[i], binaries[i] + binary_sizes[i]);
+      entry.context = std::move(ir_contexts[i]);
+      entry.used = true;
+      cache->entries.emplace(hashes[i], std::move(entry));
+    }
+  }
   if (res != SPV_SUCCESS) return res;
 
   if (options.GetVerifyIds()) {
@@ -741,10 +1019,12 @@ spv_result_t Link(const Context& context, const uint32_t* const* binaries,
   }
 
   // Phase 8: Rematch import variables/functions to export variables/functions
+  std::unordered_map<uint32_t, uint32_t> replacements;
   for (const auto& linking_entry : linkings_to_do) {
-    linked_context.ReplaceAllUsesWith(linking_entry.imported_symbol.id,
-                                      linking_entry.exported_symbol.id);
+    replacements[linking_entry.imported_symbol.id] =
+        linking_entry.exported_symbol.id;
   }
+  linked_context.ReplaceAllUsesWith(replacements);
 
   // Phase 9: Remove linkage specific instructions, such as import/export
   // attributes, linkage capability, etc. if applicable
@@ -753,9 +1033,16 @@ spv_result_t Link(const Context& context, const uint32_t* const* binaries,
                                           &linked_context);
   if (res != SPV_SUCCESS) return res;
 
-  // Phase 10: Compact the IDs used in the module
-  manager.AddPass<opt::CompactIdsPass>();
-  pass_res = manager.Run(&linked_context);
+  // Phase 10: Remove the functions which cannot be called, if requested, and
+  // compact the IDs used in the module.  This uses a new pass manager, so the
+  // duplicates are not searched for again.  The export attributes of an
+  // executable were removed, so only the entry points are kept then.
+  PassManager compact_manager;
+  compact_manager.SetMessageConsumer(consumer);
+  if (options.GetRemoveUnusedFunctions())
+    compact_manager.AddPass<opt::EliminateDeadFunctionsPass>();
+  compact_manager.AddPass<opt::CompactIdsPass>();
+  pass_res = compact_manager.Run(&linked_context);
   if (pass_res == opt::Pass::Status::Failure) return SPV_ERROR_INVALID_DATA;
 
   // Phase 11: Output the module
@@ -46,7 +46,7 @@ NameMapper GetTrivialNameMapper() { return to_string; }
 FriendlyNameMapper::FriendlyNameMapper(const spv_const_context context,
                                        const uint32_t* code,
                                        const size_t wordCount)
-    : grammar_(AssemblyGrammar(context)) {
+    : grammar_(AssemblyGrammar(context)), incremental_(false) {
   spv_diagnostic diag = nullptr;
   // We don't care if the parse fails.
   spvBinaryParse(context, this, code, wordCount, nullptr,
@@ -54,7 +54,19 @@ FriendlyNameMapper::FriendlyNameMapper(const spv_const_context context,
   spvDiagnosticDestroy(diag);
 }
 
+FriendlyNameMapper::FriendlyNameMapper(const spv_const_context context)
+    : grammar_(AssemblyGrammar(context)), incremental_(true) {}
+
 std::string FriendlyNameMapper::NameForId(uint32_t id) {
+  if (incremental_ && name_for_id_.find(id) == name_for_id_.end()) {
+    // The Id is defined later, in a function, where it would be given its
+    // default name.  Give it that name now, so it stays unique.
+    SaveName(id, to_string(id));
+  }
+  return LookupName(id);
+}
+
+std::string FriendlyNameMapper::LookupName(uint32_t id) const {
   auto iter = name_for_id_.find(id);
   if (iter == name_for_id_.end()) {
     // It must have been an invalid module, so just return a trivial mapping.
@@ -234,25 +246,25 @@ spv_result_t FriendlyNameMapper::ParseInstruction(
     } break;
     case SpvOpTypeVector:
       SaveName(result_id, std::string("v") + to_string(inst.words[3]) +
-                              NameForId(inst.words[2]));
+                              LookupName(inst.words[2]));
       break;
     case SpvOpTypeMatrix:
       SaveName(result_id, std::string("mat") + to_string(inst.words[3]) +
-                              NameForId(inst.words[2]));
+                              LookupName(inst.words[2]));
       break;
     case SpvOpTypeArray:
-      SaveName(result_id, std::string("_arr_") + NameForId(inst.words[2]) +
-                              "_" + NameForId(inst.words[3]));
+      SaveName(result_id, std::string("_arr_") + LookupName(inst.words[2]) +
+                              "_" + LookupName(inst.words[3]));
       break;
     case SpvOpTypeRuntimeArray:
       SaveName(result_id,
-               std::string("_runtimearr_") + NameForId(inst.words[2]));
+               std::string("_runtimearr_") + LookupName(inst.words[2]));
       break;
     case SpvOpTypePointer:
       SaveName(result_id, std::string("_ptr_") +
                               NameForEnumOperand(SPV_OPERAND_TYPE_STORAGE_CLASS,
                                                  inst.words[2]) +
-                              "_" + NameForId(inst.words[3]));
+                              "_" + LookupName(inst.words[3]));
       break;
     case SpvOpTypePipe:
       SaveName(result_id,
@@ -295,14 +307,13 @@ spv_result_t FriendlyNameMapper::ParseInstruction(
       SaveName(result_id, "false");
       break;
     case SpvOpConstant: {
-      std::ostringstream value;
-      EmitNumericLiteral(&value, inst, inst.operands[2]);
-      auto value_str = value.str();
+      std::string value_str;
+      AppendNumericLiteral(&value_str, inst, inst.operands[2]);
       // Use 'n' to signify negative. Other invalid characters will be mapped
       // to underscore.
       for (auto& c : value_str)
         if (c == '-') c = 'n';
-      SaveName(result_id, NameForId(inst.type_id) + "_" + value_str);
+      SaveName(result_id, LookupName(inst.type_id) + "_" + value_str);
     } break;
     default:
       // If this instruction otherwise defines an Id, then save a mapping for
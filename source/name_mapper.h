@@ -67,6 +67,16 @@ class FriendlyNameMapper {
   FriendlyNameMapper(const spv_const_context context, const uint32_t* code,
                      const size_t wordCount);
 
+  // Construct a friendly name mapper that is filled in incrementally, from the
+  // instructions passed to ParseInstruction.  This avoids a separate parse of
+  // the module when the caller is parsing it anyway.  An Id that is looked up
+  // before any instruction has named it is given its default name.  The names
+  // are the same as those determined from the whole module, provided that each
+  // instruction before the first OpFunction has been passed to
+  // ParseInstruction before any name is looked up, and that each later
+  // instruction is passed to ParseInstruction before it is disassembled.
+  explicit FriendlyNameMapper(const spv_const_context context);
+
   // Returns a NameMapper which maps ids to the friendly names parsed from the
   // module provided to the constructor.
   NameMapper GetNameMapper() {
@@ -78,7 +88,15 @@ class FriendlyNameMapper {
   // NameMapper.
   std::string NameForId(uint32_t id);
 
+  // Collects information from the given parsed instruction to populate
+  // name_for_id_.  Returns SPV_SUCCESS;
+  spv_result_t ParseInstruction(const spv_parsed_instruction_t& inst);
+
  private:
+  // Returns the name recorded for the given id, or its decimal representation
+  // if it has none.  Unlike NameForId, never records a name.
+  std::string LookupName(uint32_t id) const;
+
   // Transforms the given string so that it is acceptable as an Id name in
   // assembly language.  Two distinct inputs can map to the same output.
   std::string Sanitize(const std::string& suggested_name);
@@ -93,10 +111,6 @@ class FriendlyNameMapper {
   // has a name then this is a no-op.
   void SaveBuiltInName(uint32_t target_id, uint32_t built_in);
 
-  // Collects information from the given parsed instruction to populate
-  // name_for_id_.  Returns SPV_SUCCESS;
-  spv_result_t ParseInstruction(const spv_parsed_instruction_t& inst);
-
   // Forwards a parsed-instruction callback from the binary parser into the
   // FriendlyNameMapper hidden inside the user_data parameter.
   static spv_result_t ParseInstructionForwarder(
@@ -115,6 +129,8 @@ class FriendlyNameMapper {
   std::unordered_set<std::string> used_names_;
   // The assembly grammar for the current context.
   const AssemblyGrammar grammar_;
+  // Is this mapper filled in incrementally?
+  const bool incremental_;
 };
 
 }  // namespace spvtools
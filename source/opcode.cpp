@@ -19,6 +19,7 @@
 
 #include <algorithm>
 #include <cstdlib>
+#include <vector>
 
 #include "source/instruction.h"
 #include "source/macro.h"
@@ -36,7 +37,8 @@ struct OpcodeDescPtrLen {
 #include "core.insts-unified1.inc"
 
 static const spv_opcode_table_t kOpcodeTable = {ARRAY_SIZE(kOpcodeTableEntries),
-                                                kOpcodeTableEntries};
+                                                kOpcodeTableEntries,
+                                                kOpcodeTableNameOrder};
 
 // Represents a vendor tool entry in the SPIR-V XML Regsitry.
 struct VendorTool {
@@ -93,13 +95,18 @@ spv_result_t spvOpcodeTableNameLookup(spv_target_env env,
   if (!name || !pEntry) return SPV_ERROR_INVALID_POINTER;
   if (!table) return SPV_ERROR_INVALID_TABLE;
 
-  // TODO: This lookup of the Opcode table is suboptimal! Binary sort would be
-  // preferable but the table requires sorting on the Opcode name, but it's
-  // static const initialized and matches the order of the spec.
-  const size_t nameLength = strlen(name);
+  // Binary search the index sorted by name for the first entry with the
+  // given name.  Entries with the same name follow it in table order.
+  const uint16_t* const order_end = table->name_order + table->count;
+  const uint16_t* order = std::lower_bound(
+      table->name_order, order_end, name,
+      [table](uint16_t index, const char* needle) {
+        return strcmp(table->entries[index].name, needle) < 0;
+      });
   const auto version = spvVersionForTargetEnv(env);
-  for (uint64_t opcodeIndex = 0; opcodeIndex < table->count; ++opcodeIndex) {
-    const spv_opcode_desc_t& entry = table->entries[opcodeIndex];
+  for (; order != order_end && !strcmp(table->entries[*order].name, name);
+       ++order) {
+    const spv_opcode_desc_t& entry = table->entries[*order];
     // We considers the current opcode as available as long as
     // 1. The target environment satisfies the minimal requirement of the
     //    opcode; or
@@ -108,10 +115,8 @@ spv_result_t spvOpcodeTableNameLookup(spv_target_env env,
     // Note that the second rule assumes the extension enabling this instruction
     // is indeed requested in the SPIR-V code; checking that should be
     // validator's work.
-    if (((version >= entry.minVersion && version <= entry.lastVersion) ||
-         entry.numExtensions > 0u || entry.numCapabilities > 0u) &&
-        nameLength == strlen(entry.name) &&
-        !strncmp(name, entry.name, nameLength)) {
+    if ((version >= entry.minVersion && version <= entry.lastVersion) ||
+        entry.numExtensions > 0u || entry.numCapabilities > 0u) {
       // NOTE: Found out Opcode!
       *pEntry = &entry;
       return SPV_SUCCESS;
@@ -198,414 +203,336 @@ const char* spvOpcodeString(const SpvOp opcode) {
   return "unknown";
 }
 
+namespace {
+
+// The properties of an opcode, as bits of its entry in the property table.
+enum OpcodeProperty : uint32_t {
+  kOpcodeScalarType = 1u << 0,
+  kOpcodeSpecConstant = 1u << 1,
+  kOpcodeConstant = 1u << 2,
+  kOpcodeConstantOrUndef = 1u << 3,
+  kOpcodeScalarSpecConstant = 1u << 4,
+  kOpcodeComposite = 1u << 5,
+  kOpcodeReturnsLogicalVariablePointer = 1u << 6,
+  kOpcodeReturnsLogicalPointer = 1u << 7,
+  kOpcodeGeneratesType = 1u << 8,
+  kOpcodeDecoration = 1u << 9,
+  kOpcodeLoad = 1u << 10,
+  kOpcodeBranch = 1u << 11,
+  kOpcodeBlockTerminator = 1u << 12,
+  kOpcodeAtomicWithLoad = 1u << 13,
+  kOpcodeAtomicOp = 1u << 14,
+  kOpcodeReturn = 1u << 15,
+  kOpcodeReturnOrAbort = 1u << 16,
+  kOpcodeBaseOpaqueType = 1u << 17,
+  kOpcodeNonUniformGroupOperation = 1u << 18,
+  kOpcodeScalarizable = 1u << 19,
+  kOpcodeDebug = 1u << 20,
+};
+
+const SpvOp kScalarTypeOpcodes[] = {
+    SpvOpTypeInt, SpvOpTypeFloat, SpvOpTypeBool,
+};
+
+const SpvOp kSpecConstantOpcodes[] = {
+    SpvOpSpecConstantTrue, SpvOpSpecConstantFalse, SpvOpSpecConstant,
+    SpvOpSpecConstantComposite, SpvOpSpecConstantOp,
+};
+
+const SpvOp kConstantOpcodes[] = {
+    SpvOpConstantTrue, SpvOpConstantFalse, SpvOpConstant,
+    SpvOpConstantComposite, SpvOpConstantSampler, SpvOpConstantNull,
+    SpvOpSpecConstantTrue, SpvOpSpecConstantFalse, SpvOpSpecConstant,
+    SpvOpSpecConstantComposite, SpvOpSpecConstantOp,
+};
+
+const SpvOp kScalarSpecConstantOpcodes[] = {
+    SpvOpSpecConstantTrue, SpvOpSpecConstantFalse, SpvOpSpecConstant,
+};
+
+const SpvOp kCompositeOpcodes[] = {
+    SpvOpTypeVector, SpvOpTypeMatrix, SpvOpTypeArray, SpvOpTypeStruct,
+    SpvOpTypeCooperativeMatrixNV,
+};
+
+const SpvOp kLogicalVariablePointerOpcodes[] = {
+    SpvOpVariable, SpvOpAccessChain, SpvOpInBoundsAccessChain,
+    SpvOpFunctionParameter, SpvOpImageTexelPointer, SpvOpCopyObject,
+    SpvOpSelect, SpvOpPhi, SpvOpFunctionCall, SpvOpPtrAccessChain, SpvOpLoad,
+    SpvOpConstantNull,
+};
+
+const SpvOp kLogicalPointerOpcodes[] = {
+    SpvOpVariable, SpvOpAccessChain, SpvOpInBoundsAccessChain,
+    SpvOpFunctionParameter, SpvOpImageTexelPointer, SpvOpCopyObject,
+};
+
+// OpTypeForwardPointer does not generate a type, but declares a storage class
+// for a pointer type generated by a different instruction.
+const SpvOp kTypeOpcodes[] = {
+    SpvOpTypeVoid, SpvOpTypeBool, SpvOpTypeInt, SpvOpTypeFloat, SpvOpTypeVector,
+    SpvOpTypeMatrix, SpvOpTypeImage, SpvOpTypeSampler, SpvOpTypeSampledImage,
+    SpvOpTypeArray, SpvOpTypeRuntimeArray, SpvOpTypeStruct, SpvOpTypeOpaque,
+    SpvOpTypePointer, SpvOpTypeFunction, SpvOpTypeEvent, SpvOpTypeDeviceEvent,
+    SpvOpTypeReserveId, SpvOpTypeQueue, SpvOpTypePipe, SpvOpTypePipeStorage,
+    SpvOpTypeNamedBarrier, SpvOpTypeAccelerationStructureNV,
+    SpvOpTypeCooperativeMatrixNV,
+};
+
+const SpvOp kDecorationOpcodes[] = {
+    SpvOpDecorate, SpvOpDecorateId, SpvOpMemberDecorate, SpvOpGroupDecorate,
+    SpvOpGroupMemberDecorate, SpvOpDecorateStringGOOGLE,
+    SpvOpMemberDecorateStringGOOGLE,
+};
+
+const SpvOp kLoadOpcodes[] = {
+    SpvOpLoad, SpvOpImageSampleExplicitLod, SpvOpImageSampleImplicitLod,
+    SpvOpImageSampleDrefImplicitLod, SpvOpImageSampleDrefExplicitLod,
+    SpvOpImageSampleProjImplicitLod, SpvOpImageSampleProjExplicitLod,
+    SpvOpImageSampleProjDrefImplicitLod, SpvOpImageSampleProjDrefExplicitLod,
+    SpvOpImageFetch, SpvOpImageGather, SpvOpImageDrefGather, SpvOpImageRead,
+    SpvOpImageSparseSampleImplicitLod, SpvOpImageSparseSampleExplicitLod,
+    SpvOpImageSparseSampleDrefExplicitLod,
+    SpvOpImageSparseSampleDrefImplicitLod, SpvOpImageSparseFetch,
+    SpvOpImageSparseGather, SpvOpImageSparseDrefGather, SpvOpImageSparseRead,
+};
+
+const SpvOp kBranchOpcodes[] = {
+    SpvOpBranch, SpvOpBranchConditional, SpvOpSwitch,
+};
+
+const SpvOp kAtomicWithLoadOpcodes[] = {
+    SpvOpAtomicLoad, SpvOpAtomicExchange, SpvOpAtomicCompareExchange,
+    SpvOpAtomicCompareExchangeWeak, SpvOpAtomicIIncrement,
+    SpvOpAtomicIDecrement, SpvOpAtomicIAdd, SpvOpAtomicISub, SpvOpAtomicSMin,
+    SpvOpAtomicUMin, SpvOpAtomicSMax, SpvOpAtomicUMax, SpvOpAtomicAnd,
+    SpvOpAtomicOr, SpvOpAtomicXor, SpvOpAtomicFlagTestAndSet,
+};
+
+const SpvOp kReturnOpcodes[] = {
+    SpvOpReturn, SpvOpReturnValue,
+};
+
+const SpvOp kBaseOpaqueTypeOpcodes[] = {
+    SpvOpTypeImage, SpvOpTypeSampler, SpvOpTypeSampledImage, SpvOpTypeOpaque,
+    SpvOpTypeEvent, SpvOpTypeDeviceEvent, SpvOpTypeReserveId, SpvOpTypeQueue,
+    SpvOpTypePipe, SpvOpTypeForwardPointer, SpvOpTypePipeStorage,
+    SpvOpTypeNamedBarrier,
+};
+
+const SpvOp kNonUniformGroupOpcodes[] = {
+    SpvOpGroupNonUniformElect, SpvOpGroupNonUniformAll, SpvOpGroupNonUniformAny,
+    SpvOpGroupNonUniformAllEqual, SpvOpGroupNonUniformBroadcast,
+    SpvOpGroupNonUniformBroadcastFirst, SpvOpGroupNonUniformBallot,
+    SpvOpGroupNonUniformInverseBallot, SpvOpGroupNonUniformBallotBitExtract,
+    SpvOpGroupNonUniformBallotBitCount, SpvOpGroupNonUniformBallotFindLSB,
+    SpvOpGroupNonUniformBallotFindMSB, SpvOpGroupNonUniformShuffle,
+    SpvOpGroupNonUniformShuffleXor, SpvOpGroupNonUniformShuffleUp,
+    SpvOpGroupNonUniformShuffleDown, SpvOpGroupNonUniformIAdd,
+    SpvOpGroupNonUniformFAdd, SpvOpGroupNonUniformIMul,
+    SpvOpGroupNonUniformFMul, SpvOpGroupNonUniformSMin,
+    SpvOpGroupNonUniformUMin, SpvOpGroupNonUniformFMin,
+    SpvOpGroupNonUniformSMax, SpvOpGroupNonUniformUMax,
+    SpvOpGroupNonUniformFMax, SpvOpGroupNonUniformBitwiseAnd,
+    SpvOpGroupNonUniformBitwiseOr, SpvOpGroupNonUniformBitwiseXor,
+    SpvOpGroupNonUniformLogicalAnd, SpvOpGroupNonUniformLogicalOr,
+    SpvOpGroupNonUniformLogicalXor, SpvOpGroupNonUniformQuadBroadcast,
+    SpvOpGroupNonUniformQuadSwap,
+};
+
+const SpvOp kScalarizableOpcodes[] = {
+    SpvOpPhi, SpvOpCopyObject, SpvOpConvertFToU, SpvOpConvertFToS,
+    SpvOpConvertSToF, SpvOpConvertUToF, SpvOpUConvert, SpvOpSConvert,
+    SpvOpFConvert, SpvOpQuantizeToF16, SpvOpVectorInsertDynamic, SpvOpSNegate,
+    SpvOpFNegate, SpvOpIAdd, SpvOpFAdd, SpvOpISub, SpvOpFSub, SpvOpIMul,
+    SpvOpFMul, SpvOpUDiv, SpvOpSDiv, SpvOpFDiv, SpvOpUMod, SpvOpSRem, SpvOpSMod,
+    SpvOpFRem, SpvOpFMod, SpvOpVectorTimesScalar, SpvOpIAddCarry,
+    SpvOpISubBorrow, SpvOpUMulExtended, SpvOpSMulExtended,
+    SpvOpShiftRightLogical, SpvOpShiftRightArithmetic, SpvOpShiftLeftLogical,
+    SpvOpBitwiseOr, SpvOpBitwiseAnd, SpvOpNot, SpvOpBitFieldInsert,
+    SpvOpBitFieldSExtract, SpvOpBitFieldUExtract, SpvOpBitReverse,
+    SpvOpBitCount, SpvOpIsNan, SpvOpIsInf, SpvOpIsFinite, SpvOpIsNormal,
+    SpvOpSignBitSet, SpvOpLessOrGreater, SpvOpOrdered, SpvOpUnordered,
+    SpvOpLogicalEqual, SpvOpLogicalNotEqual, SpvOpLogicalOr, SpvOpLogicalAnd,
+    SpvOpLogicalNot, SpvOpSelect, SpvOpIEqual, SpvOpINotEqual,
+    SpvOpUGreaterThan, SpvOpSGreaterThan, SpvOpUGreaterThanEqual,
+    SpvOpSGreaterThanEqual, SpvOpULessThan, SpvOpSLessThan, SpvOpULessThanEqual,
+    SpvOpSLessThanEqual, SpvOpFOrdEqual, SpvOpFUnordEqual, SpvOpFOrdNotEqual,
+    SpvOpFUnordNotEqual, SpvOpFOrdLessThan, SpvOpFUnordLessThan,
+    SpvOpFOrdGreaterThan, SpvOpFUnordGreaterThan, SpvOpFOrdLessThanEqual,
+    SpvOpFUnordLessThanEqual, SpvOpFOrdGreaterThanEqual,
+    SpvOpFUnordGreaterThanEqual,
+};
+
+const SpvOp kDebugOpcodes[] = {
+    SpvOpName, SpvOpMemberName, SpvOpSource, SpvOpSourceContinued,
+    SpvOpSourceExtension, SpvOpString, SpvOpLine, SpvOpNoLine,
+};
+
+// OpUndef is not a constant, but is treated as one by some predicates.
+const SpvOp kUndefOpcodes[] = {
+    SpvOpUndef,
+};
+
+const SpvOp kAtomicWithoutLoadOpcodes[] = {
+    SpvOpAtomicStore, SpvOpAtomicFlagClear,
+};
+
+const SpvOp kAbortOpcodes[] = {
+    SpvOpKill, SpvOpUnreachable,
+};
+
+// The properties given to each list of opcodes.
+struct OpcodeList {
+  const SpvOp* opcodes;
+  size_t count;
+  uint32_t properties;
+};
+
+const OpcodeList kOpcodeLists[] = {
+    {kScalarTypeOpcodes, ARRAY_SIZE(kScalarTypeOpcodes), kOpcodeScalarType},
+    {kSpecConstantOpcodes, ARRAY_SIZE(kSpecConstantOpcodes),
+     kOpcodeSpecConstant},
+    {kConstantOpcodes, ARRAY_SIZE(kConstantOpcodes),
+     kOpcodeConstant | kOpcodeConstantOrUndef},
+    {kScalarSpecConstantOpcodes, ARRAY_SIZE(kScalarSpecConstantOpcodes),
+     kOpcodeScalarSpecConstant},
+    {kCompositeOpcodes, ARRAY_SIZE(kCompositeOpcodes), kOpcodeComposite},
+    {kLogicalVariablePointerOpcodes, ARRAY_SIZE(kLogicalVariablePointerOpcodes),
+     kOpcodeReturnsLogicalVariablePointer},
+    {kLogicalPointerOpcodes, ARRAY_SIZE(kLogicalPointerOpcodes),
+     kOpcodeReturnsLogicalPointer},
+    {kTypeOpcodes, ARRAY_SIZE(kTypeOpcodes), kOpcodeGeneratesType},
+    {kDecorationOpcodes, ARRAY_SIZE(kDecorationOpcodes), kOpcodeDecoration},
+    {kLoadOpcodes, ARRAY_SIZE(kLoadOpcodes), kOpcodeLoad},
+    {kBranchOpcodes, ARRAY_SIZE(kBranchOpcodes),
+     kOpcodeBranch | kOpcodeBlockTerminator},
+    {kAtomicWithLoadOpcodes, ARRAY_SIZE(kAtomicWithLoadOpcodes),
+     kOpcodeAtomicWithLoad | kOpcodeAtomicOp},
+    {kReturnOpcodes, ARRAY_SIZE(kReturnOpcodes),
+     kOpcodeReturn | kOpcodeReturnOrAbort | kOpcodeBlockTerminator},
+    {kBaseOpaqueTypeOpcodes, ARRAY_SIZE(kBaseOpaqueTypeOpcodes),
+     kOpcodeBaseOpaqueType},
+    {kNonUniformGroupOpcodes, ARRAY_SIZE(kNonUniformGroupOpcodes),
+     kOpcodeNonUniformGroupOperation},
+    {kScalarizableOpcodes, ARRAY_SIZE(kScalarizableOpcodes),
+     kOpcodeScalarizable},
+    {kDebugOpcodes, ARRAY_SIZE(kDebugOpcodes), kOpcodeDebug},
+    {kUndefOpcodes, ARRAY_SIZE(kUndefOpcodes), kOpcodeConstantOrUndef},
+    {kAtomicWithoutLoadOpcodes, ARRAY_SIZE(kAtomicWithoutLoadOpcodes),
+     kOpcodeAtomicOp},
+    {kAbortOpcodes, ARRAY_SIZE(kAbortOpcodes),
+     kOpcodeReturnOrAbort | kOpcodeBlockTerminator},
+};
+
+// Returns the dense table of the properties of each opcode, indexed by
+// opcode, built on first use.  The opcodes past its end have no property.
+const std::vector<uint32_t>& GetOpcodeProperties() {
+  static const std::vector<uint32_t> properties = [] {
+    std::vector<uint32_t> table;
+    for (const OpcodeList& list : kOpcodeLists) {
+      for (size_t i = 0; i < list.count; ++i) {
+        const uint32_t index = static_cast<uint32_t>(list.opcodes[i]);
+        if (index >= table.size()) table.resize(index + 1, 0);
+        table[index] |= list.properties;
+      }
+    }
+    return table;
+  }();
+  return properties;
+}
+
+// Returns true if |opcode| has the property |property|.
+bool HasProperty(SpvOp opcode, uint32_t property) {
+  const std::vector<uint32_t>& properties = GetOpcodeProperties();
+  const uint32_t index = static_cast<uint32_t>(opcode);
+  return index < properties.size() && (properties[index] & property) != 0;
+}
+
+}  // namespace
+
 int32_t spvOpcodeIsScalarType(const SpvOp opcode) {
-  switch (opcode) {
-    case SpvOpTypeInt:
-    case SpvOpTypeFloat:
-    case SpvOpTypeBool:
-      return true;
-    default:
-      return false;
-  }
+  return HasProperty(opcode, kOpcodeScalarType);
 }
 
 int32_t spvOpcodeIsSpecConstant(const SpvOp opcode) {
-  switch (opcode) {
-    case SpvOpSpecConstantTrue:
-    case SpvOpSpecConstantFalse:
-    case SpvOpSpecConstant:
-    case SpvOpSpecConstantComposite:
-    case SpvOpSpecConstantOp:
-      return true;
-    default:
-      return false;
-  }
+  return HasProperty(opcode, kOpcodeSpecConstant);
 }
 
 int32_t spvOpcodeIsConstant(const SpvOp opcode) {
-  switch (opcode) {
-    case SpvOpConstantTrue:
-    case SpvOpConstantFalse:
-    case SpvOpConstant:
-    case SpvOpConstantComposite:
-    case SpvOpConstantSampler:
-    case SpvOpConstantNull:
-    case SpvOpSpecConstantTrue:
-    case SpvOpSpecConstantFalse:
-    case SpvOpSpecConstant:
-    case SpvOpSpecConstantComposite:
-    case SpvOpSpecConstantOp:
-      return true;
-    default:
-      return false;
-  }
+  return HasProperty(opcode, kOpcodeConstant);
 }
 
 bool spvOpcodeIsConstantOrUndef(const SpvOp opcode) {
-  return opcode == SpvOpUndef || spvOpcodeIsConstant(opcode);
+  return HasProperty(opcode, kOpcodeConstantOrUndef);
 }
 
 bool spvOpcodeIsScalarSpecConstant(const SpvOp opcode) {
-  switch (opcode) {
-    case SpvOpSpecConstantTrue:
-    case SpvOpSpecConstantFalse:
-    case SpvOpSpecConstant:
-      return true;
-    default:
-      return false;
-  }
+  return HasProperty(opcode, kOpcodeScalarSpecConstant);
 }
 
 int32_t spvOpcodeIsComposite(const SpvOp opcode) {
-  switch (opcode) {
-    case SpvOpTypeVector:
-    case SpvOpTypeMatrix:
-    case SpvOpTypeArray:
-    case SpvOpTypeStruct:
-    case SpvOpTypeCooperativeMatrixNV:
-      return true;
-    default:
-      return false;
-  }
+  return HasProperty(opcode, kOpcodeComposite);
 }
 
 bool spvOpcodeReturnsLogicalVariablePointer(const SpvOp opcode) {
-  switch (opcode) {
-    case SpvOpVariable:
-    case SpvOpAccessChain:
-    case SpvOpInBoundsAccessChain:
-    case SpvOpFunctionParameter:
-    case SpvOpImageTexelPointer:
-    case SpvOpCopyObject:
-    case SpvOpSelect:
-    case SpvOpPhi:
-    case SpvOpFunctionCall:
-    case SpvOpPtrAccessChain:
-    case SpvOpLoad:
-    case SpvOpConstantNull:
-      return true;
-    default:
-      return false;
-  }
+  return HasProperty(opcode, kOpcodeReturnsLogicalVariablePointer);
 }
 
 int32_t spvOpcodeReturnsLogicalPointer(const SpvOp opcode) {
-  switch (opcode) {
-    case SpvOpVariable:
-    case SpvOpAccessChain:
-    case SpvOpInBoundsAccessChain:
-    case SpvOpFunctionParameter:
-    case SpvOpImageTexelPointer:
-    case SpvOpCopyObject:
-      return true;
-    default:
-      return false;
-  }
+  return HasProperty(opcode, kOpcodeReturnsLogicalPointer);
 }
 
 int32_t spvOpcodeGeneratesType(SpvOp op) {
-  switch (op) {
-    case SpvOpTypeVoid:
-    case SpvOpTypeBool:
-    case SpvOpTypeInt:
-    case SpvOpTypeFloat:
-    case SpvOpTypeVector:
-    case SpvOpTypeMatrix:
-    case SpvOpTypeImage:
-    case SpvOpTypeSampler:
-    case SpvOpTypeSampledImage:
-    case SpvOpTypeArray:
-    case SpvOpTypeRuntimeArray:
-    case SpvOpTypeStruct:
-    case SpvOpTypeOpaque:
-    case SpvOpTypePointer:
-    case SpvOpTypeFunction:
-    case SpvOpTypeEvent:
-    case SpvOpTypeDeviceEvent:
-    case SpvOpTypeReserveId:
-    case SpvOpTypeQueue:
-    case SpvOpTypePipe:
-    case SpvOpTypePipeStorage:
-    case SpvOpTypeNamedBarrier:
-    case SpvOpTypeAccelerationStructureNV:
-    case SpvOpTypeCooperativeMatrixNV:
-      return true;
-    default:
-      // In particular, OpTypeForwardPointer does not generate a type,
-      // but declares a storage class for a pointer type generated
-      // by a different instruction.
-      break;
-  }
-  return 0;
+  return HasProperty(op, kOpcodeGeneratesType);
 }
 
 bool spvOpcodeIsDecoration(const SpvOp opcode) {
-  switch (opcode) {
-    case SpvOpDecorate:
-    case SpvOpDecorateId:
-    case SpvOpMemberDecorate:
-    case SpvOpGroupDecorate:
-    case SpvOpGroupMemberDecorate:
-    case SpvOpDecorateStringGOOGLE:
-    case SpvOpMemberDecorateStringGOOGLE:
-      return true;
-    default:
-      break;
-  }
-  return false;
+  return HasProperty(opcode, kOpcodeDecoration);
 }
 
 bool spvOpcodeIsLoad(const SpvOp opcode) {
-  switch (opcode) {
-    case SpvOpLoad:
-    case SpvOpImageSampleExplicitLod:
-    case SpvOpImageSampleImplicitLod:
-    case SpvOpImageSampleDrefImplicitLod:
-    case SpvOpImageSampleDrefExplicitLod:
-    case SpvOpImageSampleProjImplicitLod:
-    case SpvOpImageSampleProjExplicitLod:
-    case SpvOpImageSampleProjDrefImplicitLod:
-    case SpvOpImageSampleProjDrefExplicitLod:
-    case SpvOpImageFetch:
-    case SpvOpImageGather:
-    case SpvOpImageDrefGather:
-    case SpvOpImageRead:
-    case SpvOpImageSparseSampleImplicitLod:
-    case SpvOpImageSparseSampleExplicitLod:
-    case SpvOpImageSparseSampleDrefExplicitLod:
-    case SpvOpImageSparseSampleDrefImplicitLod:
-    case SpvOpImageSparseFetch:
-    case SpvOpImageSparseGather:
-    case SpvOpImageSparseDrefGather:
-    case SpvOpImageSparseRead:
-      return true;
-    default:
-      return false;
-  }
+  return HasProperty(opcode, kOpcodeLoad);
 }
 
 bool spvOpcodeIsBranch(SpvOp opcode) {
-  switch (opcode) {
-    case SpvOpBranch:
-    case SpvOpBranchConditional:
-    case SpvOpSwitch:
-      return true;
-    default:
-      return false;
-  }
+  return HasProperty(opcode, kOpcodeBranch);
 }
 
 bool spvOpcodeIsAtomicWithLoad(const SpvOp opcode) {
-  switch (opcode) {
-    case SpvOpAtomicLoad:
-    case SpvOpAtomicExchange:
-    case SpvOpAtomicCompareExchange:
-    case SpvOpAtomicCompareExchangeWeak:
-    case SpvOpAtomicIIncrement:
-    case SpvOpAtomicIDecrement:
-    case SpvOpAtomicIAdd:
-    case SpvOpAtomicISub:
-    case SpvOpAtomicSMin:
-    case SpvOpAtomicUMin:
-    case SpvOpAtomicSMax:
-    case SpvOpAtomicUMax:
-    case SpvOpAtomicAnd:
-    case SpvOpAtomicOr:
-    case SpvOpAtomicXor:
-    case SpvOpAtomicFlagTestAndSet:
-      return true;
-    default:
-      return false;
-  }
+  return HasProperty(opcode, kOpcodeAtomicWithLoad);
 }
 
 bool spvOpcodeIsAtomicOp(const SpvOp opcode) {
-  return (spvOpcodeIsAtomicWithLoad(opcode) || opcode == SpvOpAtomicStore ||
-          opcode == SpvOpAtomicFlagClear);
+  return HasProperty(opcode, kOpcodeAtomicOp);
 }
 
 bool spvOpcodeIsReturn(SpvOp opcode) {
-  switch (opcode) {
-    case SpvOpReturn:
-    case SpvOpReturnValue:
-      return true;
-    default:
-      return false;
-  }
+  return HasProperty(opcode, kOpcodeReturn);
 }
 
 bool spvOpcodeIsReturnOrAbort(SpvOp opcode) {
-  return spvOpcodeIsReturn(opcode) || opcode == SpvOpKill ||
-         opcode == SpvOpUnreachable;
+  return HasProperty(opcode, kOpcodeReturnOrAbort);
 }
 
 bool spvOpcodeIsBlockTerminator(SpvOp opcode) {
-  return spvOpcodeIsBranch(opcode) || spvOpcodeIsReturnOrAbort(opcode);
+  return HasProperty(opcode, kOpcodeBlockTerminator);
 }
 
 bool spvOpcodeIsBaseOpaqueType(SpvOp opcode) {
-  switch (opcode) {
-    case SpvOpTypeImage:
-    case SpvOpTypeSampler:
-    case SpvOpTypeSampledImage:
-    case SpvOpTypeOpaque:
-    case SpvOpTypeEvent:
-    case SpvOpTypeDeviceEvent:
-    case SpvOpTypeReserveId:
-    case SpvOpTypeQueue:
-    case SpvOpTypePipe:
-    case SpvOpTypeForwardPointer:
-    case SpvOpTypePipeStorage:
-    case SpvOpTypeNamedBarrier:
-      return true;
-    default:
-      return false;
-  }
+  return HasProperty(opcode, kOpcodeBaseOpaqueType);
 }
 
 bool spvOpcodeIsNonUniformGroupOperation(SpvOp opcode) {
-  switch (opcode) {
-    case SpvOpGroupNonUniformElect:
-    case SpvOpGroupNonUniformAll:
-    case SpvOpGroupNonUniformAny:
-    case SpvOpGroupNonUniformAllEqual:
-    case SpvOpGroupNonUniformBroadcast:
-    case SpvOpGroupNonUniformBroadcastFirst:
-    case SpvOpGroupNonUniformBallot:
-    case SpvOpGroupNonUniformInverseBallot:
-    case SpvOpGroupNonUniformBallotBitExtract:
-    case SpvOpGroupNonUniformBallotBitCount:
-    case SpvOpGroupNonUniformBallotFindLSB:
-    case SpvOpGroupNonUniformBallotFindMSB:
-    case SpvOpGroupNonUniformShuffle:
-    case SpvOpGroupNonUniformShuffleXor:
-    case SpvOpGroupNonUniformShuffleUp:
-    case SpvOpGroupNonUniformShuffleDown:
-    case SpvOpGroupNonUniformIAdd:
-    case SpvOpGroupNonUniformFAdd:
-    case SpvOpGroupNonUniformIMul:
-    case SpvOpGroupNonUniformFMul:
-    case SpvOpGroupNonUniformSMin:
-    case SpvOpGroupNonUniformUMin:
-    case SpvOpGroupNonUniformFMin:
-    case SpvOpGroupNonUniformSMax:
-    case SpvOpGroupNonUniformUMax:
-    case SpvOpGroupNonUniformFMax:
-    case SpvOpGroupNonUniformBitwiseAnd:
-    case SpvOpGroupNonUniformBitwiseOr:
-    case SpvOpGroupNonUniformBitwiseXor:
-    case SpvOpGroupNonUniformLogicalAnd:
-    case SpvOpGroupNonUniformLogicalOr:
-    case SpvOpGroupNonUniformLogicalXor:
-    case SpvOpGroupNonUniformQuadBroadcast:
-    case SpvOpGroupNonUniformQuadSwap:
-      return true;
-    default:
-      return false;
-  }
+  return HasProperty(opcode, kOpcodeNonUniformGroupOperation);
 }
 
 bool spvOpcodeIsScalarizable(SpvOp opcode) {
-  switch (opcode) {
-    case SpvOpPhi:
-    case SpvOpCopyObject:
-    case SpvOpConvertFToU:
-    case SpvOpConvertFToS:
-    case SpvOpConvertSToF:
-    case SpvOpConvertUToF:
-    case SpvOpUConvert:
-    case SpvOpSConvert:
-    case SpvOpFConvert:
-    case SpvOpQuantizeToF16:
-    case SpvOpVectorInsertDynamic:
-    case SpvOpSNegate:
-    case SpvOpFNegate:
-    case SpvOpIAdd:
-    case SpvOpFAdd:
-    case SpvOpISub:
-    case SpvOpFSub:
-    case SpvOpIMul:
-    case SpvOpFMul:
-    case SpvOpUDiv:
-    case SpvOpSDiv:
-    case SpvOpFDiv:
-    case SpvOpUMod:
-    case SpvOpSRem:
-    case SpvOpSMod:
-    case SpvOpFRem:
-    case SpvOpFMod:
-    case SpvOpVectorTimesScalar:
-    case SpvOpIAddCarry:
-    case SpvOpISubBorrow:
-    case SpvOpUMulExtended:
-    case SpvOpSMulExtended:
-    case SpvOpShiftRightLogical:
-    case SpvOpShiftRightArithmetic:
-    case SpvOpShiftLeftLogical:
-    case SpvOpBitwiseOr:
-    case SpvOpBitwiseAnd:
-    case SpvOpNot:
-    case SpvOpBitFieldInsert:
-    case SpvOpBitFieldSExtract:
-    case SpvOpBitFieldUExtract:
-    case SpvOpBitReverse:
-    case SpvOpBitCount:
-    case SpvOpIsNan:
-    case SpvOpIsInf:
-    case SpvOpIsFinite:
-    case SpvOpIsNormal:
-    case SpvOpSignBitSet:
-    case SpvOpLessOrGreater:
-    case SpvOpOrdered:
-    case SpvOpUnordered:
-    case SpvOpLogicalEqual:
-    case SpvOpLogicalNotEqual:
-    case SpvOpLogicalOr:
-    case SpvOpLogicalAnd:
-    case SpvOpLogicalNot:
-    case SpvOpSelect:
-    case SpvOpIEqual:
-    case SpvOpINotEqual:
-    case SpvOpUGreaterThan:
-    case SpvOpSGreaterThan:
-    case SpvOpUGreaterThanEqual:
-    case SpvOpSGreaterThanEqual:
-    case SpvOpULessThan:
-    case SpvOpSLessThan:
-    case SpvOpULessThanEqual:
-    case SpvOpSLessThanEqual:
-    case SpvOpFOrdEqual:
-    case SpvOpFUnordEqual:
-    case SpvOpFOrdNotEqual:
-    case SpvOpFUnordNotEqual:
-    case SpvOpFOrdLessThan:
-    case SpvOpFUnordLessThan:
-    case SpvOpFOrdGreaterThan:
-    case SpvOpFUnordGreaterThan:
-    case SpvOpFOrdLessThanEqual:
-    case SpvOpFUnordLessThanEqual:
-    case SpvOpFOrdGreaterThanEqual:
-    case SpvOpFUnordGreaterThanEqual:
-      return true;
-    default:
-      return false;
-  }
+  return HasProperty(opcode, kOpcodeScalarizable);
 }
 
 bool spvOpcodeIsDebug(SpvOp opcode) {
-  switch (opcode) {
-    case SpvOpName:
-    case SpvOpMemberName:
-    case SpvOpSource:
-    case SpvOpSourceContinued:
-    case SpvOpSourceExtension:
-    case SpvOpString:
-    case SpvOpLine:
-    case SpvOpNoLine:
-      return true;
-    default:
-      return false;
-  }
+  return HasProperty(opcode, kOpcodeDebug);
 }
 
 std::vector<uint32_t> spvOpcodeMemorySemanticsOperandIndices(SpvOp opcode) {
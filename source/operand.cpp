@@ -54,12 +54,29 @@ spv_result_t spvOperandTableNameLookup(spv_target_env env,
   if (!table) return SPV_ERROR_INVALID_TABLE;
   if (!name || !pEntry) return SPV_ERROR_INVALID_POINTER;
 
+  // Compares an entry name with the given name, like strcmp.  The given name
+  // is not null-terminated.
+  auto compare_name = [name, nameLength](const char* entry_name) {
+    const int result = strncmp(entry_name, name, nameLength);
+    if (result != 0) return result;
+    return entry_name[nameLength] == '\0' ? 0 : 1;
+  };
+
   const auto version = spvVersionForTargetEnv(env);
   for (uint64_t typeIndex = 0; typeIndex < table->count; ++typeIndex) {
     const auto& group = table->types[typeIndex];
     if (type != group.type) continue;
-    for (uint64_t index = 0; index < group.count; ++index) {
-      const auto& entry = group.entries[index];
+    // Binary search the index sorted by name for the first entry with the
+    // given name.  Entries with the same name follow it in table order.
+    const uint16_t* const order_end = group.name_order + group.count;
+    const uint16_t* order = std::lower_bound(
+        group.name_order, order_end, name,
+        [&group, &compare_name](uint16_t index, const char*) {
+          return compare_name(group.entries[index].name) < 0;
+        });
+    for (; order != order_end && !compare_name(group.entries[*order].name);
+         ++order) {
+      const auto& entry = group.entries[*order];
       // We consider the current operand as available as long as
       // 1. The target environment satisfies the minimal requirement of the
       //    operand; or
@@ -69,10 +86,8 @@ spv_result_t spvOperandTableNameLookup(spv_target_env env,
       // Note that the second rule assumes the extension enabling this operand
       // is indeed requested in the SPIR-V code; checking that should be
       // validator's work.
-      if (((version >= entry.minVersion && version <= entry.lastVersion) ||
-           entry.numExtensions > 0u || entry.numCapabilities > 0u) &&
-          nameLength == strlen(entry.name) &&
-          !strncmp(entry.name, name, nameLength)) {
+      if ((version >= entry.minVersion && version <= entry.lastVersion) ||
+          entry.numExtensions > 0u || entry.numCapabilities > 0u) {
         *pEntry = &entry;
         return SPV_SUCCESS;
       }
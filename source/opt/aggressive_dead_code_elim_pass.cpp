@@ -25,6 +25,7 @@
 #include "source/opt/iterator.h"
 #include "source/opt/reflect.h"
 #include "source/spirv_constant.h"
+#include "source/util/parallel.h"
 
 namespace spvtools {
 namespace opt {
@@ -172,12 +173,10 @@ bool AggressiveDCEPass::IsTargetDead(Instruction* inst) {
 void AggressiveDCEPass::ProcessLoad(uint32_t varId) {
   // Only process locals
   if (!IsLocalVar(varId)) return;
-  // Return if already processed
-  if (live_local_vars_.find(varId) != live_local_vars_.end()) return;
+  // Return if already processed, and cache varId as processed otherwise
+  if (live_local_vars_.Set(varId)) return;
   // Mark all stores to varId as live
   AddStores(varId);
-  // Cache varId as processed
-  live_local_vars_.insert(varId);
 }
 
 bool AggressiveDCEPass::IsStructuredHeader(BasicBlock* bp,
@@ -312,6 +311,17 @@ void AggressiveDCEPass::AddBreaksAndContinuesToWorklist(
 }
 
 bool AggressiveDCEPass::AggressiveDCE(Function* func) {
+  std::list<BasicBlock*> structuredOrder;
+  cfg()->ComputeStructuredOrder(func, &*func->begin(), &structuredOrder);
+  MarkLiveInstructions(func, structuredOrder);
+  // Perform closure on live instruction set.
+  ProcessWorklist();
+  worklist_.clear();
+  return KillDeadInstructions(func, structuredOrder);
+}
+
+void AggressiveDCEPass::MarkLiveInstructions(
+    Function* func, std::list<BasicBlock*>& structuredOrder) {
   // Mark function parameters as live.
   AddToWorklist(&func->DefInst());
   func->ForEachParam(
@@ -321,10 +331,7 @@ bool AggressiveDCEPass::AggressiveDCE(Function* func) {
       false);
 
   // Compute map from block to controlling conditional branch
-  std::list<BasicBlock*> structuredOrder;
-  cfg()->ComputeStructuredOrder(func, &*func->begin(), &structuredOrder);
   ComputeBlock2HeaderMaps(structuredOrder);
-  bool modified = false;
   // Add instructions with external side effects to worklist. Also add branches
   // EXCEPT those immediately contained in an "if" selection construct or a loop
   // or continue construct.
@@ -417,9 +424,11 @@ bool AggressiveDCEPass::AggressiveDCE(Function* func) {
   // If privates are not like local, add their stores to worklist
   if (!private_like_local_)
     for (auto& ps : private_stores_) AddToWorklist(ps);
-  // Perform closure on live instruction set.
-  while (!worklist_.empty()) {
-    Instruction* liveInst = worklist_.front();
+}
+
+void AggressiveDCEPass::ProcessWorklist() {
+  for (size_t i = 0; i < worklist_.size(); ++i) {
+    Instruction* liveInst = worklist_[i];
     // Add all operand instructions if not already live
     liveInst->ForEachInId([&liveInst, this](const uint32_t* iid) {
       Instruction* inInst = get_def_use_mgr()->GetDef(*iid);
@@ -511,10 +520,12 @@ bool AggressiveDCEPass::AggressiveDCE(Function* func) {
       }
       AddToWorklist(dec);
     }
-
-    worklist_.pop();
   }
+}
 
+bool AggressiveDCEPass::KillDeadInstructions(
+    Function* func, std::list<BasicBlock*>& structuredOrder) {
+  bool modified = false;
   // Kill dead instructions and remember dead blocks
   for (auto bi = structuredOrder.begin(); bi != structuredOrder.end();) {
     uint32_t mergeBlockId = 0;
@@ -646,8 +657,13 @@ Pass::Status AggressiveDCEPass::ProcessImpl() {
   InitializeModuleScopeLiveInstructions();
 
   // Process all entry point functions.
-  ProcessFunction pfn = [this](Function* fp) { return AggressiveDCE(fp); };
-  modified |= context()->ProcessEntryPointCallTree(pfn);
+  const bool processed =
+      utils::ResolveNumThreads(context()->num_threads()) > 1 &&
+      ProcessFunctionsInParallel(&modified);
+  if (!processed) {
+    ProcessFunction pfn = [this](Function* fp) { return AggressiveDCE(fp); };
+    modified |= context()->ProcessEntryPointCallTree(pfn);
+  }
 
   // If the decoration manager is kept live then the context will try to keep it
   // up to date.  ADCE deals with group decorations by changing the operands in
@@ -679,6 +695,98 @@ Pass::Status AggressiveDCEPass::ProcessImpl() {
   return modified ? Status::SuccessWithChange : Status::SuccessWithoutChange;
 }
 
+bool AggressiveDCEPass::ProcessFunctionsInParallel(bool* modified) {
+  std::vector<Function*> functions;
+  ProcessFunction collect = [&functions](Function* fp) {
+    functions.push_back(fp);
+    return false;
+  };
+  context()->ProcessEntryPointCallTree(collect);
+
+  // Build everything the workers read up front, so that they do not change
+  // the context.  The structured orders are cached in the CFG, and the
+  // decorations are loaded below, since the decoration manager otherwise
+  // loads those of an id when it is first queried.
+  context()->BuildInvalidAnalyses(
+      IRContext::kAnalysisDefUse | IRContext::kAnalysisInstrToBlockMapping |
+      IRContext::kAnalysisDecorations | IRContext::kAnalysisCFG);
+  std::vector<std::list<BasicBlock*>> structured_orders(functions.size());
+  for (size_t i = 0; i < functions.size(); ++i) {
+    cfg()->ComputeStructuredOrder(functions[i], &*functions[i]->begin(),
+                                  &structured_orders[i]);
+  }
+
+  // Mark the live instructions of each function on its own.
+  std::vector<std::unique_ptr<AggressiveDCEPass>> workers(functions.size());
+  get_def_use_mgr()->set_concurrent_reads(true);
+  get_decoration_mgr()->LoadAllDecorations();
+  utils::ParallelFor(
+      functions.size(), context()->num_threads(),
+      [this, &functions, &structured_orders, &workers](size_t i) {
+        workers[i].reset(new AggressiveDCEPass(*this, functions[i]));
+        workers[i]->MarkLiveInstructions(functions[i], structured_orders[i]);
+        workers[i]->ProcessWorklist();
+        // Only the live instructions are needed from now on.
+        workers[i]->live_insts_ = utils::BitVector();
+      });
+  get_def_use_mgr()->set_concurrent_reads(false);
+
+  // Merge the results, and mark the instructions outside of the functions.
+  bool independent = true;
+  for (const auto& worker : workers) {
+    independent = independent && !worker->reached_other_function_;
+    for (Instruction* inst : worker->worklist_) {
+      live_insts_.Set(inst->unique_id());
+    }
+  }
+  for (const auto& worker : workers) {
+    for (Instruction* inst : worker->outside_insts_) AddToWorklist(inst);
+  }
+  ProcessWorklist();
+  for (Instruction* inst : worklist_) {
+    if (context()->get_instr_block(inst) != nullptr ||
+        inst->opcode() == SpvOpFunctionParameter) {
+      independent = false;
+    }
+  }
+  worklist_.clear();
+
+  if (!independent) {
+    // The liveness of a function depends on the others, so they have to be
+    // processed in order.
+    live_insts_ = utils::BitVector();
+    InitializeModuleScopeLiveInstructions();
+    return false;
+  }
+
+  for (size_t i = 0; i < functions.size(); ++i) {
+    *modified |= KillDeadInstructions(functions[i], structured_orders[i]);
+  }
+  return true;
+}
+
+bool AggressiveDCEPass::DeferIfOutsideFunction(Instruction* inst) {
+  BasicBlock* block = context()->get_instr_block(inst);
+  if (block != nullptr) {
+    if (block->GetParent() == marked_function_) return false;
+    reached_other_function_ = true;
+    return true;
+  }
+  if (inst->opcode() == SpvOpFunctionParameter) {
+    bool is_param = false;
+    marked_function_->ForEachParam(
+        [inst, &is_param](const Instruction* param) {
+          if (param == inst) is_param = true;
+        },
+        false);
+    if (is_param) return false;
+    reached_other_function_ = true;
+    return true;
+  }
+  outside_insts_.push_back(inst);
+  return true;
+}
+
 bool AggressiveDCEPass::EliminateDeadFunctions() {
   // Identify live functions first. Those that are not live
   // are dead. ADCE is disabled for non-shaders so we do not check for exported
@@ -879,7 +987,14 @@ bool AggressiveDCEPass::ProcessGlobalValues() {
   return modified;
 }
 
-AggressiveDCEPass::AggressiveDCEPass() = default;
+AggressiveDCEPass::AggressiveDCEPass()
+    : marked_function_(nullptr), reached_other_function_(false) {}
+
+AggressiveDCEPass::AggressiveDCEPass(const AggressiveDCEPass& pass,
+                                     Function* func)
+    : MemPass(pass),
+      marked_function_(func),
+      reached_other_function_(false) {}
 
 Pass::Status AggressiveDCEPass::Process() {
   // Initialize extensions whitelist
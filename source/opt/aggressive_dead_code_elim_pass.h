@@ -20,7 +20,6 @@
 #include <algorithm>
 #include <list>
 #include <map>
-#include <queue>
 #include <string>
 #include <unordered_map>
 #include <unordered_set>
@@ -78,8 +77,9 @@ class AggressiveDCEPass : public MemPass {
 
   // Add |inst| to worklist_ and live_insts_.
   void AddToWorklist(Instruction* inst) {
+    if (marked_function_ != nullptr && DeferIfOutsideFunction(inst)) return;
     if (!live_insts_.Set(inst->unique_id())) {
-      worklist_.push(inst);
+      worklist_.push_back(inst);
     }
   }
 
@@ -141,8 +141,42 @@ class AggressiveDCEPass : public MemPass {
   // TODO(): Remove useless control constructs.
   bool AggressiveDCE(Function* func);
 
+  // Marks the instructions with side effects in |func| as live, and adds them
+  // to the worklist.  |structuredOrder| holds the blocks of |func| in
+  // structured order.
+  void MarkLiveInstructions(Function* func,
+                            std::list<BasicBlock*>& structuredOrder);
+
+  // Marks as live the instructions that the instructions in the worklist
+  // depend on, until there are no more.  The worklist is not cleared.
+  void ProcessWorklist();
+
+  // Records the non-live instructions of |func| for deletion, and adds a branch
+  // to the merge block of the deleted structured constructs.  |structuredOrder|
+  // holds the blocks of |func| in structured order.  Returns true if the
+  // function has been modified.
+  bool KillDeadInstructions(Function* func,
+                            std::list<BasicBlock*>& structuredOrder);
+
+  // Runs |AggressiveDCE| on the functions in the call trees of the entry
+  // points, with the live instructions of each function marked concurrently,
+  // on up to |num_threads()| threads.  Sets |*modified| to true if a function
+  // is modified.  Returns false without changing the module if the live
+  // instructions of a function depend on another function, in which case the
+  // functions have to be processed in order.
+  bool ProcessFunctionsInParallel(bool* modified);
+
+  // Returns true if |inst| is not an instruction of |marked_function_|, after
+  // recording it in |outside_insts_|, or setting |reached_other_function_| if
+  // it is in another function.
+  bool DeferIfOutsideFunction(Instruction* inst);
+
   Pass::Status ProcessImpl();
 
+  // Creates a pass that only marks the live instructions of |func|, reading
+  // the context of |pass|.
+  AggressiveDCEPass(const AggressiveDCEPass& pass, Function* func);
+
   // True if current function has a call instruction contained in it
   bool call_in_func_;
 
@@ -155,9 +189,10 @@ class AggressiveDCEPass : public MemPass {
   // Live Instruction Worklist.  An instruction is added to this list
   // if it might have a side effect, either directly or indirectly.
   // If we don't know, then add it to this list.  Instructions are
-  // removed from this list as the algorithm traces side effects,
-  // building up the live instructions set |live_insts_|.
-  std::queue<Instruction*> worklist_;
+  // processed in order as the algorithm traces side effects, building up
+  // the live instructions set |live_insts_|, and the list is cleared once
+  // they all are.
+  std::vector<Instruction*> worklist_;
 
   // Map from block to the branch instruction in the header of the most
   // immediate controlling structured if or loop.  A loop header block points
@@ -183,8 +218,8 @@ class AggressiveDCEPass : public MemPass {
   // Live Instructions
   utils::BitVector live_insts_;
 
-  // Live Local Variables
-  std::unordered_set<uint32_t> live_local_vars_;
+  // Live Local Variables, indexed by id
+  utils::BitVector live_local_vars_;
 
   // List of instructions to delete. Deletion is delayed until debug and
   // annotation instructions are processed.
@@ -192,6 +227,14 @@ class AggressiveDCEPass : public MemPass {
 
   // Extensions supported by this pass.
   std::unordered_set<std::string> extensions_whitelist_;
+
+  // The function whose live instructions are marked when the functions are
+  // processed concurrently, or nullptr.  The instructions outside of it are
+  // not marked, but recorded in |outside_insts_| if they are not in any
+  // function, and make |reached_other_function_| true otherwise.
+  Function* marked_function_;
+  std::vector<Instruction*> outside_insts_;
+  bool reached_other_function_;
 };
 
 }  // namespace opt
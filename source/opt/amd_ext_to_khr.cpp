@@ -884,6 +884,19 @@ class AmdExtConstFoldingRules : public ConstantFoldingRules {
 
 }  // namespace
 
+bool AmdExtensionToKhrPass::IsNoOp(IRContext* ctx) const {
+  const ModuleSummary* summary = ctx->GetModuleSummary();
+  for (const char* set : {"SPV_AMD_shader_ballot",
+                          "SPV_AMD_shader_trinary_minmax",
+                          "SPV_AMD_gcn_shader"}) {
+    if (summary->ImportsExtInstSet(set)) return false;
+  }
+  const FeatureManager* features = ctx->get_feature_mgr();
+  return !features->HasExtension(kSPV_AMD_shader_ballot) &&
+         !features->HasExtension(kSPV_AMD_shader_trinary_minmax) &&
+         !features->HasExtension(kSPV_AMD_gcn_shader);
+}
+
 Pass::Status AmdExtensionToKhrPass::Process() {
   bool changed = false;
 
@@ -29,6 +29,7 @@ class AmdExtensionToKhrPass : public Pass {
  public:
   const char* name() const override { return "amd-ext-to-khr"; }
   Status Process() override;
+  bool IsNoOp(IRContext* ctx) const override;
 
   IRContext::Analysis GetPreservedAnalyses() override {
     return IRContext::kAnalysisInstrToBlockMapping |
@@ -14,6 +14,7 @@
 
 #include "source/opt/basic_block.h"
 
+#include <iterator>
 #include <ostream>
 
 #include "source/opt/function.h"
@@ -32,21 +33,25 @@ const uint32_t kSelectionMergeMergeBlockIdInIdx = 0;
 
 }  // namespace
 
+void* BasicBlock::operator new(size_t size, IRContext* context) {
+  return utils::NodePool::Allocate(
+      context != nullptr ? context->block_pool() : nullptr, size);
+}
+
 BasicBlock* BasicBlock::Clone(IRContext* context) const {
-  BasicBlock* clone = new BasicBlock(
+  if (context != nullptr) {
+    // Keep the copies next to each other, so that scanning the clone reads
+    // them in order.
+    context->instruction_pool()->ReserveRun(
+        1 + static_cast<size_t>(std::distance(insts_.begin(), insts_.end())));
+  }
+  BasicBlock* clone = new (context) BasicBlock(
       std::unique_ptr<Instruction>(GetLabelInst()->Clone(context)));
   for (const auto& inst : insts_) {
     // Use the incoming context
     clone->AddInstruction(std::unique_ptr<Instruction>(inst.Clone(context)));
   }
 
-  if (context->AreAnalysesValid(
-          IRContext::Analysis::kAnalysisInstrToBlockMapping)) {
-    for (auto& inst : *clone) {
-      context->set_instr_block(&inst, clone);
-    }
-  }
-
   return clone;
 }
 
@@ -241,9 +246,10 @@ BasicBlock* BasicBlock::SplitBasicBlock(IRContext* context, uint32_t label_id,
                                         iterator iter) {
   assert(!insts_.empty());
 
-  std::unique_ptr<BasicBlock> new_block_temp =
-      MakeUnique<BasicBlock>(MakeUnique<Instruction>(
-          context, SpvOpLabel, 0, label_id, std::initializer_list<Operand>{}));
+  std::unique_ptr<Instruction> label_inst(new (context) Instruction(
+      context, SpvOpLabel, 0, label_id, std::initializer_list<Operand>{}));
+  std::unique_ptr<BasicBlock> new_block_temp(
+      new (context) BasicBlock(std::move(label_inst)));
   BasicBlock* new_block = new_block_temp.get();
   function_->InsertBasicBlockAfter(std::move(new_block_temp), this);
 
@@ -272,13 +278,6 @@ BasicBlock* BasicBlock::SplitBasicBlock(IRContext* context, uint32_t label_id,
             });
       });
 
-  if (context->AreAnalysesValid(IRContext::kAnalysisInstrToBlockMapping)) {
-    context->set_instr_block(new_block->GetLabelInst(), new_block);
-    new_block->ForEachInst([new_block, context](Instruction* inst) {
-      context->set_instr_block(inst, new_block);
-    });
-  }
-
   return new_block;
 }
 
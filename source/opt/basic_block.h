@@ -29,6 +29,7 @@
 #include "source/opt/instruction.h"
 #include "source/opt/instruction_list.h"
 #include "source/opt/iterator.h"
+#include "source/util/node_pool.h"
 
 namespace spvtools {
 namespace opt {
@@ -50,13 +51,23 @@ class BasicBlock {
 
   explicit BasicBlock(const BasicBlock& bb) = delete;
 
+  // Allocates the basic block in the block pool of |context|, like the
+  // instructions:
+  //
+  //   new (context) BasicBlock(...)
+  static void* operator new(size_t size, IRContext* context);
+  static void* operator new(size_t size) {
+    return utils::NodePool::Allocate(nullptr, size);
+  }
+  static void operator delete(void* block) { utils::NodePool::Free(block); }
+  static void operator delete(void* block, IRContext*) {
+    utils::NodePool::Free(block);
+  }
+
   // Creates a clone of the basic block in the given |context|
   //
   // The parent function will default to null and needs to be explicitly set by
   // the user.
-  //
-  // If the inst-to-block map in |context| is valid, then the new instructions
-  // will be inserted into the map.
   BasicBlock* Clone(IRContext*) const;
 
   // Sets the enclosing function for this basic block.
@@ -131,18 +142,23 @@ class BasicBlock {
   inline bool hasSuccessor() const { return ctail()->IsBranch(); }
 
   // Runs the given function |f| on each instruction in this basic block, and
-  // optionally on the debug line instructions that might precede them.
-  inline void ForEachInst(const std::function<void(Instruction*)>& f,
-                          bool run_on_debug_line_insts = false);
-  inline void ForEachInst(const std::function<void(const Instruction*)>& f,
+  // optionally on the debug line instructions that might precede them.  |f|
+  // may be any callable object, and is inlined like in
+  // |Instruction::ForEachInst|.
+  template <typename Func>
+  inline void ForEachInst(const Func& f, bool run_on_debug_line_insts = false);
+  template <typename Func>
+  inline void ForEachInst(const Func& f,
                           bool run_on_debug_line_insts = false) const;
 
   // Runs the given function |f| on each instruction in this basic block, and
   // optionally on the debug line instructions that might precede them. If |f|
   // returns false, iteration is terminated and this function returns false.
-  inline bool WhileEachInst(const std::function<bool(Instruction*)>& f,
+  template <typename Func>
+  inline bool WhileEachInst(const Func& f,
                             bool run_on_debug_line_insts = false);
-  inline bool WhileEachInst(const std::function<bool(const Instruction*)>& f,
+  template <typename Func>
+  inline bool WhileEachInst(const Func& f,
                             bool run_on_debug_line_insts = false) const;
 
   // Runs the given function |f| on each Phi instruction in this basic block,
@@ -244,7 +260,10 @@ class BasicBlock {
 std::ostream& operator<<(std::ostream& str, const BasicBlock& block);
 
 inline BasicBlock::BasicBlock(std::unique_ptr<Instruction> label)
-    : function_(nullptr), label_(std::move(label)) {}
+    : function_(nullptr), label_(std::move(label)) {
+  if (label_) label_->set_block(this);
+  insts_.set_block(this);
+}
 
 inline void BasicBlock::AddInstruction(std::unique_ptr<Instruction> i) {
   insts_.push_back(std::move(i));
@@ -255,8 +274,9 @@ inline void BasicBlock::AddInstructions(BasicBlock* bp) {
   (void)bEnd.MoveBefore(&bp->insts_);
 }
 
-inline bool BasicBlock::WhileEachInst(
-    const std::function<bool(Instruction*)>& f, bool run_on_debug_line_insts) {
+template <typename Func>
+inline bool BasicBlock::WhileEachInst(const Func& f,
+                                      bool run_on_debug_line_insts) {
   if (label_) {
     if (!label_->WhileEachInst(f, run_on_debug_line_insts)) return false;
   }
@@ -273,9 +293,9 @@ inline bool BasicBlock::WhileEachInst(
   return true;
 }
 
-inline bool BasicBlock::WhileEachInst(
-    const std::function<bool(const Instruction*)>& f,
-    bool run_on_debug_line_insts) const {
+template <typename Func>
+inline bool BasicBlock::WhileEachInst(const Func& f,
+                                      bool run_on_debug_line_insts) const {
   if (label_) {
     if (!static_cast<const Instruction*>(label_.get())
              ->WhileEachInst(f, run_on_debug_line_insts))
@@ -289,7 +309,8 @@ inline bool BasicBlock::WhileEachInst(
   return true;
 }
 
-inline void BasicBlock::ForEachInst(const std::function<void(Instruction*)>& f,
+template <typename Func>
+inline void BasicBlock::ForEachInst(const Func& f,
                                     bool run_on_debug_line_insts) {
   WhileEachInst(
       [&f](Instruction* inst) {
@@ -299,9 +320,9 @@ inline void BasicBlock::ForEachInst(const std::function<void(Instruction*)>& f,
       run_on_debug_line_insts);
 }
 
-inline void BasicBlock::ForEachInst(
-    const std::function<void(const Instruction*)>& f,
-    bool run_on_debug_line_insts) const {
+template <typename Func>
+inline void BasicBlock::ForEachInst(const Func& f,
+                                    bool run_on_debug_line_insts) const {
   WhileEachInst(
       [&f](const Instruction* inst) {
         f(inst);
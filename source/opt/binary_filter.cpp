@@ -0,0 +1,153 @@
+// Copyright (c) 2019 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "source/opt/binary_filter.h"
+
+#include <algorithm>
+
+#include "source/latest_version_spirv_header.h"
+#include "source/operand.h"
+#include "source/opt/reflect.h"
+#include "spirv-tools/libspirv.hpp"
+
+namespace spvtools {
+namespace opt {
+namespace {
+
+const size_t kHeaderWords = 5;
+const size_t kIdBoundIndex = 3;
+
+// The state of one filter while it copies a binary.
+struct FilterRun {
+  BinaryFilter* filter;
+  std::vector<uint32_t>* output;
+  // The words of the debug line instructions kept since the last other
+  // instruction.  They are written or dropped with the next one.
+  std::vector<uint32_t> pending_lines;
+  // The largest id used by the instructions in |pending_lines|.
+  uint32_t pending_highest_id;
+  // The largest id used by the instructions written to |output|.
+  uint32_t highest_id;
+  // True if an instruction other than OpNop was dropped.
+  bool dropped;
+};
+
+// Returns the largest id used by |inst|, or 0 if it uses none.
+uint32_t HighestId(const spv_parsed_instruction_t& inst) {
+  uint32_t highest = 0;
+  for (uint16_t i = 0; i < inst.num_operands; ++i) {
+    const spv_parsed_operand_t& operand = inst.operands[i];
+    if (spvIsIdType(operand.type)) {
+      highest = std::max(highest, inst.words[operand.offset]);
+    }
+  }
+  return highest;
+}
+
+// Writes the pending debug line instructions of |run| to its output.
+void FlushLines(FilterRun* run) {
+  run->output->insert(run->output->end(), run->pending_lines.begin(),
+                      run->pending_lines.end());
+  run->highest_id = std::max(run->highest_id, run->pending_highest_id);
+  run->pending_lines.clear();
+  run->pending_highest_id = 0;
+}
+
+// Lets the filter of the FilterRun at |user_data| look at |inst|.  Meets the
+// interface requirement of spvBinaryParse().
+spv_result_t ScanInst(void* user_data, const spv_parsed_instruction_t* inst) {
+  FilterRun* run = reinterpret_cast<FilterRun*>(user_data);
+  return run->filter->Scan(*inst) ? SPV_SUCCESS : SPV_REQUESTED_TERMINATION;
+}
+
+// Copies |inst| to the output of the FilterRun at |user_data| if its filter
+// keeps it.  Meets the interface requirement of spvBinaryParse().
+spv_result_t FilterInst(void* user_data, const spv_parsed_instruction_t* inst) {
+  FilterRun* run = reinterpret_cast<FilterRun*>(user_data);
+  const SpvOp opcode = static_cast<SpvOp>(inst->opcode);
+  if (!run->filter->Keep(*inst)) {
+    run->dropped = true;
+    if (!IsDebugLineInst(opcode)) {
+      run->pending_lines.clear();
+      run->pending_highest_id = 0;
+    }
+    return SPV_SUCCESS;
+  }
+
+  if (IsDebugLineInst(opcode)) {
+    run->pending_lines.insert(run->pending_lines.end(), inst->words,
+                              inst->words + inst->num_words);
+    run->pending_highest_id =
+        std::max(run->pending_highest_id, HighestId(*inst));
+    return SPV_SUCCESS;
+  }
+
+  FlushLines(run);
+  if (opcode != SpvOpNop) {
+    run->output->insert(run->output->end(), inst->words,
+                        inst->words + inst->num_words);
+    run->highest_id = std::max(run->highest_id, HighestId(*inst));
+  }
+  return SPV_SUCCESS;
+}
+
+}  // namespace
+
+bool RunBinaryFilters(spv_target_env env,
+                      const std::vector<std::unique_ptr<BinaryFilter>>& filters,
+                      const uint32_t* words, size_t num_words,
+                      std::vector<uint32_t>* binary) {
+  // The header is copied as it is, so the words must be in the native
+  // endianness.
+  if (num_words < kHeaderWords || words[0] != SpvMagicNumber) return false;
+
+  // The filters write to the two buffers in turn, each reading what the one
+  // before it wrote.
+  Context context(env);
+  std::vector<uint32_t> buffers[2];
+  const uint32_t* input = words;
+  size_t input_size = num_words;
+  bool dropped = false;
+  for (size_t i = 0; i < filters.size(); ++i) {
+    FilterRun run = {filters[i].get(), &buffers[i % 2], {}, 0, 0, false};
+    if (spvBinaryParse(context.CContext(), &run, input, input_size, nullptr,
+                       ScanInst, nullptr) != SPV_SUCCESS) {
+      return false;
+    }
+
+    run.output->reserve(input_size);
+    run.output->assign(input, input + kHeaderWords);
+    if (spvBinaryParse(context.CContext(), &run, input, input_size, nullptr,
+                       FilterInst, nullptr) != SPV_SUCCESS) {
+      return false;
+    }
+    // The debug line instructions left pending at the end of the module are
+    // dropped, as Module::ToBinary does not write them.
+
+    dropped |= run.dropped;
+    if (dropped) (*run.output)[kIdBoundIndex] = run.highest_id + 1;
+    input = run.output->data();
+    input_size = run.output->size();
+  }
+
+  if (filters.empty()) {
+    binary->assign(words, words + num_words);
+  } else {
+    binary->swap(buffers[(filters.size() - 1) % 2]);
+  }
+  return true;
+}
+
+}  // namespace opt
+}  // namespace spvtools
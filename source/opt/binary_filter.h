@@ -0,0 +1,68 @@
+// Copyright (c) 2019 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef SOURCE_OPT_BINARY_FILTER_H_
+#define SOURCE_OPT_BINARY_FILTER_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#include "spirv-tools/libspirv.h"
+
+namespace spvtools {
+namespace opt {
+
+// A BinaryFilter drops instructions from the binary of a module without
+// building its IR.  The binary is parsed twice: once to let the filter look at
+// every instruction, and once to copy the instructions it keeps to the output.
+//
+// A pass that only deletes instructions can provide one, see
+// Pass::CreateBinaryFilter.  The result must be the binary the pass would
+// give when run on the IR.
+class BinaryFilter {
+ public:
+  virtual ~BinaryFilter() = default;
+
+  // Looks at |inst| before the module is filtered.  Called for each
+  // instruction of the module, in order, debug line instructions included.
+  // Returns false if the filter cannot handle the module, in which case the
+  // pass has to run on the IR.
+  virtual bool Scan(const spv_parsed_instruction_t& inst) = 0;
+
+  // Returns true if |inst| is kept.  Called for each instruction of the
+  // module, in order, once all of them were scanned.  As in the IR, the debug
+  // line instructions right before an instruction go away with it.
+  virtual bool Keep(const spv_parsed_instruction_t& inst) = 0;
+};
+
+// Runs |filters| one after the other on the module of |num_words| words at
+// |words|, and writes the result to |binary|.  OpNop instructions are dropped,
+// as Module::ToBinary does when skipping them, and so are the debug line
+// instructions at the end of the module.  If an instruction was dropped, the
+// id bound is recomputed, as the PassManager does after a change.
+//
+// Returns false, with |binary| left in an unspecified state, if the module
+// cannot be parsed or if one of the filters cannot handle it.  Nothing is
+// reported: the caller is expected to run the passes on the IR instead.
+bool RunBinaryFilters(spv_target_env env,
+                      const std::vector<std::unique_ptr<BinaryFilter>>& filters,
+                      const uint32_t* words, size_t num_words,
+                      std::vector<uint32_t>* binary);
+
+}  // namespace opt
+}  // namespace spvtools
+
+#endif  // SOURCE_OPT_BINARY_FILTER_H_
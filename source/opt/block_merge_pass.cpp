@@ -32,6 +32,7 @@ bool BlockMergePass::MergeBlocks(Function* func) {
       blockmergeutil::MergeWithSuccessor(context(), func, bi);
       // Reprocess block.
       modified = true;
+      RecordChangedFunction(func);
     } else {
       ++bi;
     }
@@ -41,7 +42,9 @@ bool BlockMergePass::MergeBlocks(Function* func) {
 
 Pass::Status BlockMergePass::Process() {
   // Process all entry point functions.
-  ProcessFunction pfn = [this](Function* fp) { return MergeBlocks(fp); };
+  ProcessFunction pfn = [this](Function* fp) {
+    return ShouldProcessFunction(fp) && MergeBlocks(fp);
+  };
   bool modified = context()->ProcessEntryPointCallTree(pfn);
   return modified ? Status::SuccessWithChange : Status::SuccessWithoutChange;
 }
@@ -38,6 +38,7 @@ class BlockMergePass : public Pass {
  public:
   BlockMergePass();
   const char* name() const override { return "merge-blocks"; }
+  bool IsFunctionLocal() const override { return true; }
   Status Process() override;
 
   IRContext::Analysis GetPreservedAnalyses() override {
@@ -45,7 +46,8 @@ class BlockMergePass : public Pass {
            IRContext::kAnalysisInstrToBlockMapping |
            IRContext::kAnalysisDecorations | IRContext::kAnalysisCombinators |
            IRContext::kAnalysisNameMap | IRContext::kAnalysisConstants |
-           IRContext::kAnalysisTypes;
+           IRContext::kAnalysisTypes | IRContext::kAnalysisCFG |
+           IRContext::kAnalysisDominatorAnalysis;
   }
 
  private:
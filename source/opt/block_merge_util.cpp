@@ -175,9 +175,8 @@ void MergeWithSuccessor(IRContext* context, Function* func,
       // the validation error that OpLine is placed between OpLoopMerge
       // and OpBranchConditional.
       auto terminator = bi->terminator();
-      auto& vec = terminator->dbg_line_insts();
-      auto& new_vec = merge_inst->dbg_line_insts();
-      new_vec.insert(new_vec.end(), vec.begin(), vec.end());
+      merge_inst->set_dbg_lines(context->debug_line_table()->Concat(
+          merge_inst->dbg_lines(), terminator->dbg_lines()));
       terminator->clear_dbg_line_insts();
 
       // Move the merge instruction to just before the terminator.
@@ -187,6 +186,7 @@ void MergeWithSuccessor(IRContext* context, Function* func,
   context->ReplaceAllUsesWith(lab_id, bi->id());
   context->KillInst(sbi->GetLabelInst());
   (void)sbi.Erase();
+  context->UpdateAnalysesForMerge(&*bi, lab_id);
 }
 
 }  // namespace blockmergeutil
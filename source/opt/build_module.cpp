@@ -26,7 +26,7 @@ namespace spvtools {
 namespace {
 
 // Sets the module header for IrLoader. Meets the interface requirement of
-// spvBinaryParse().
+// spvBinaryParseBatched().
 spv_result_t SetSpvHeader(void* builder, spv_endianness_t, uint32_t magic,
                           uint32_t version, uint32_t generator,
                           uint32_t id_bound, uint32_t reserved) {
@@ -35,13 +35,35 @@ spv_result_t SetSpvHeader(void* builder, spv_endianness_t, uint32_t magic,
   return SPV_SUCCESS;
 }
 
-// Processes a parsed instruction for IrLoader. Meets the interface requirement
-// of spvBinaryParse().
-spv_result_t SetSpvInst(void* builder, const spv_parsed_instruction_t* inst) {
-  if (reinterpret_cast<opt::IrLoader*>(builder)->AddInstruction(inst)) {
-    return SPV_SUCCESS;
+// Processes a batch of parsed instructions for IrLoader. Meets the interface
+// requirement of spvBinaryParseBatched().
+spv_result_t SetSpvInsts(void* builder, const spv_parsed_instruction_t* insts,
+                         size_t num_insts) {
+  opt::IrLoader* loader = reinterpret_cast<opt::IrLoader*>(builder);
+  for (size_t i = 0; i < num_insts; ++i) {
+    if (!loader->AddInstruction(&insts[i])) return SPV_ERROR_INVALID_BINARY;
   }
-  return SPV_ERROR_INVALID_BINARY;
+  return SPV_SUCCESS;
+}
+
+// Counts the instructions and the basic blocks of |binary| of |size| words
+// from the word counts of its instructions, without decoding them.  Returns
+// false if |binary| is not in the native endianness, or if its word counts are
+// malformed, which the parser reports.
+bool CountInstructions(const uint32_t* binary, size_t size,
+                       size_t* num_instructions, size_t* num_blocks) {
+  const size_t kHeaderSize = 5;
+  if (size < kHeaderSize || binary[0] != SpvMagicNumber) return false;
+  *num_instructions = 0;
+  *num_blocks = 0;
+  for (size_t index = kHeaderSize; index < size;) {
+    const uint32_t word_count = binary[index] >> 16;
+    if (word_count == 0) return false;
+    if ((binary[index] & 0xFFFF) == SpvOpLabel) ++*num_blocks;
+    ++*num_instructions;
+    index += word_count;
+  }
+  return true;
 }
 
 }  // namespace
@@ -50,18 +72,21 @@ std::unique_ptr<opt::IRContext> BuildModule(spv_target_env env,
                                             MessageConsumer consumer,
                                             const uint32_t* binary,
                                             const size_t size) {
-  auto context = spvContextCreate(env);
-  SetContextMessageConsumer(context, consumer);
-
   auto irContext = MakeUnique<opt::IRContext>(env, consumer);
   opt::IrLoader loader(consumer, irContext->module());
+  size_t num_instructions = 0;
+  size_t num_blocks = 0;
+  if (CountInstructions(binary, size, &num_instructions, &num_blocks)) {
+    loader.Reserve(num_instructions, num_blocks);
+  }
 
-  spv_result_t status = spvBinaryParse(context, &loader, binary, size,
-                                       SetSpvHeader, SetSpvInst, nullptr);
+  // The binary is parsed with the context of |irContext|, rather than with a
+  // context of its own.
+  spv_result_t status =
+      spvBinaryParseBatched(irContext->syntax_context(), &loader, binary, size,
+                            SetSpvHeader, SetSpvInsts, 0, nullptr);
   loader.EndModule();
 
-  spvContextDestroy(context);
-
   return status == SPV_SUCCESS ? std::move(irContext) : nullptr;
 }
 
@@ -0,0 +1,256 @@
+// Copyright (c) 2020 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "source/opt/call_graph.h"
+
+#include <algorithm>
+#include <cassert>
+#include <utility>
+
+namespace spvtools {
+namespace opt {
+namespace {
+
+const std::vector<uint32_t>& EmptyIds() {
+  static const std::vector<uint32_t>* const kEmpty =
+      new std::vector<uint32_t>();
+  return *kEmpty;
+}
+
+}  // namespace
+
+CallGraph::CallGraph(Module* module) : components_valid_(false) {
+  // Add every function first, so that |functions_| follows the module even
+  // when a function is called before it is defined.
+  for (auto& func : *module) {
+    GetOrAddNode(func.result_id());
+  }
+  for (auto& func : *module) {
+    UpdateFunction(&func);
+  }
+}
+
+const std::vector<uint32_t>& CallGraph::Callees(uint32_t func_id) const {
+  auto it = nodes_.find(func_id);
+  return it == nodes_.end() ? EmptyIds() : it->second.callees;
+}
+
+const std::vector<uint32_t>& CallGraph::Callers(uint32_t func_id) const {
+  auto it = callers_.find(func_id);
+  return it == callers_.end() ? EmptyIds() : it->second;
+}
+
+uint32_t CallGraph::NumCalls(uint32_t caller_id, uint32_t callee_id) const {
+  auto it = nodes_.find(caller_id);
+  if (it == nodes_.end()) return 0;
+  const Node& node = it->second;
+  auto callee = std::find(node.callees.begin(), node.callees.end(), callee_id);
+  if (callee == node.callees.end()) return 0;
+  return node.num_calls[callee - node.callees.begin()];
+}
+
+void CallGraph::AddCall(uint32_t caller_id, uint32_t callee_id) {
+  components_valid_ = false;
+  Node& node = GetOrAddNode(caller_id);
+  auto callee = std::find(node.callees.begin(), node.callees.end(), callee_id);
+  if (callee != node.callees.end()) {
+    ++node.num_calls[callee - node.callees.begin()];
+    return;
+  }
+  node.callees.push_back(callee_id);
+  node.num_calls.push_back(1);
+  callers_[callee_id].push_back(caller_id);
+}
+
+void CallGraph::RemoveCall(uint32_t caller_id, uint32_t callee_id) {
+  auto it = nodes_.find(caller_id);
+  if (it == nodes_.end()) return;
+  Node& node = it->second;
+  auto callee = std::find(node.callees.begin(), node.callees.end(), callee_id);
+  if (callee == node.callees.end()) return;
+  const size_t index = callee - node.callees.begin();
+  if (--node.num_calls[index] != 0) return;
+
+  components_valid_ = false;
+  node.callees.erase(callee);
+  node.num_calls.erase(node.num_calls.begin() + index);
+  RemoveCaller(callee_id, caller_id);
+}
+
+void CallGraph::UpdateFunction(const Function* func) {
+  components_valid_ = false;
+  const uint32_t func_id = func->result_id();
+  Node& node = GetOrAddNode(func_id);
+  for (uint32_t callee_id : node.callees) {
+    RemoveCaller(callee_id, func_id);
+  }
+  node.callees.clear();
+  node.num_calls.clear();
+
+  for (auto& bb : *func) {
+    for (auto& inst : bb) {
+      if (inst.opcode() == SpvOpFunctionCall) {
+        AddCall(func_id, inst.GetSingleWordInOperand(0));
+      }
+    }
+  }
+}
+
+void CallGraph::RemoveFunction(uint32_t func_id) {
+  auto it = nodes_.find(func_id);
+  if (it == nodes_.end()) return;
+  components_valid_ = false;
+  for (uint32_t callee_id : it->second.callees) {
+    RemoveCaller(callee_id, func_id);
+  }
+  nodes_.erase(it);
+  functions_.erase(std::find(functions_.begin(), functions_.end(), func_id));
+}
+
+const std::vector<std::vector<uint32_t>>&
+CallGraph::StronglyConnectedComponents() {
+  if (!components_valid_) {
+    ComputeComponents();
+  }
+  return components_;
+}
+
+std::vector<uint32_t> CallGraph::BottomUpOrder() {
+  std::vector<uint32_t> order;
+  order.reserve(functions_.size());
+  for (const auto& component : StronglyConnectedComponents()) {
+    order.insert(order.end(), component.begin(), component.end());
+  }
+  return order;
+}
+
+std::vector<uint32_t> CallGraph::TopDownOrder() {
+  std::vector<uint32_t> order;
+  order.reserve(functions_.size());
+  const auto& components = StronglyConnectedComponents();
+  for (auto it = components.rbegin(); it != components.rend(); ++it) {
+    order.insert(order.end(), it->begin(), it->end());
+  }
+  return order;
+}
+
+bool CallGraph::IsRecursive(uint32_t func_id) {
+  if (!HasFunction(func_id)) return false;
+  const std::vector<uint32_t>& callees = Callees(func_id);
+  if (std::find(callees.begin(), callees.end(), func_id) != callees.end()) {
+    return true;
+  }
+  StronglyConnectedComponents();
+  return components_[component_of_[func_id]].size() > 1;
+}
+
+CallGraph::Node& CallGraph::GetOrAddNode(uint32_t func_id) {
+  auto it = nodes_.find(func_id);
+  if (it != nodes_.end()) return it->second;
+  components_valid_ = false;
+  functions_.push_back(func_id);
+  return nodes_[func_id];
+}
+
+void CallGraph::RemoveCaller(uint32_t callee_id, uint32_t caller_id) {
+  auto it = callers_.find(callee_id);
+  assert(it != callers_.end() && "The callee has no callers.");
+  std::vector<uint32_t>& callers = it->second;
+  callers.erase(std::find(callers.begin(), callers.end(), caller_id));
+  if (callers.empty()) callers_.erase(it);
+}
+
+void CallGraph::ComputeComponents() {
+  components_.clear();
+  component_of_.clear();
+
+  std::unordered_map<uint32_t, size_t> position;
+  for (size_t i = 0; i < functions_.size(); ++i) {
+    position[functions_[i]] = i;
+  }
+
+  // Tarjan's algorithm, with an explicit stack of the functions being
+  // visited and the next callee of each to look at.
+  struct Visit {
+    uint32_t index;
+    uint32_t low_link;
+    bool on_stack;
+  };
+  struct Frame {
+    uint32_t func_id;
+    size_t next_callee;
+  };
+  std::unordered_map<uint32_t, Visit> visits;
+  std::vector<uint32_t> stack;
+  std::vector<Frame> frames;
+  uint32_t next_index = 0;
+
+  auto start_visit = [&visits, &stack, &frames, &next_index](uint32_t id) {
+    visits[id] = {next_index, next_index, true};
+    ++next_index;
+    stack.push_back(id);
+    frames.push_back({id, 0});
+  };
+
+  for (uint32_t root : functions_) {
+    if (visits.count(root)) continue;
+    start_visit(root);
+    while (!frames.empty()) {
+      Frame& frame = frames.back();
+      const std::vector<uint32_t>& callees = nodes_[frame.func_id].callees;
+      if (frame.next_callee < callees.size()) {
+        const uint32_t callee_id = callees[frame.next_callee++];
+        if (!HasFunction(callee_id)) continue;
+        auto callee = visits.find(callee_id);
+        if (callee == visits.end()) {
+          start_visit(callee_id);
+        } else if (callee->second.on_stack) {
+          Visit& visit = visits[frame.func_id];
+          visit.low_link = std::min(visit.low_link, callee->second.index);
+        }
+        continue;
+      }
+
+      const uint32_t func_id = frame.func_id;
+      frames.pop_back();
+      const Visit& visit = visits[func_id];
+      if (!frames.empty()) {
+        Visit& parent = visits[frames.back().func_id];
+        parent.low_link = std::min(parent.low_link, visit.low_link);
+      }
+      if (visit.low_link != visit.index) continue;
+
+      // |func_id| is the root of a component, which is made of the functions
+      // above it on the stack.
+      std::vector<uint32_t> component;
+      uint32_t member;
+      do {
+        member = stack.back();
+        stack.pop_back();
+        visits[member].on_stack = false;
+        component_of_[member] = static_cast<uint32_t>(components_.size());
+        component.push_back(member);
+      } while (member != func_id);
+      std::sort(component.begin(), component.end(),
+                [&position](uint32_t a, uint32_t b) {
+                  return position[a] < position[b];
+                });
+      components_.push_back(std::move(component));
+    }
+  }
+  components_valid_ = true;
+}
+
+}  // namespace opt
+}  // namespace spvtools
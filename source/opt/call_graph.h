@@ -0,0 +1,125 @@
+// Copyright (c) 2020 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef SOURCE_OPT_CALL_GRAPH_H_
+#define SOURCE_OPT_CALL_GRAPH_H_
+
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+#include "source/opt/function.h"
+#include "source/opt/module.h"
+
+namespace spvtools {
+namespace opt {
+
+// The call graph of a module: which functions each function calls, and which
+// functions call it.  The strongly connected components of the graph, and the
+// orders derived from them, are computed when they are first needed after a
+// change.
+//
+// The IRContext has a CallGraph.  It is kept up to date when an OpFunctionCall
+// or an OpFunction is killed.  A pass that adds calls to a function, or
+// removes them without killing the instructions, has to call |UpdateFunction|
+// or |AddCall| itself, or leave the graph to be invalidated at the end of the
+// pass.  |IRContext::ProcessCallTreeFromRoots| updates each function its
+// callback reports as modified.
+class CallGraph {
+ public:
+  // Builds the call graph of the functions in |module|.
+  explicit CallGraph(Module* module);
+
+  // Returns true if the function |func_id| is in the graph.
+  bool HasFunction(uint32_t func_id) const {
+    return nodes_.find(func_id) != nodes_.end();
+  }
+
+  // Returns the ids of the functions called by the function |func_id|, each
+  // once, in the order of their first call.
+  const std::vector<uint32_t>& Callees(uint32_t func_id) const;
+
+  // Returns the ids of the functions that call the function |func_id|, each
+  // once.
+  const std::vector<uint32_t>& Callers(uint32_t func_id) const;
+
+  // Returns the number of calls from |caller_id| to |callee_id|.
+  uint32_t NumCalls(uint32_t caller_id, uint32_t callee_id) const;
+
+  // Records one more call from |caller_id| to |callee_id|.
+  void AddCall(uint32_t caller_id, uint32_t callee_id);
+
+  // Records that one call from |caller_id| to |callee_id| was removed.
+  void RemoveCall(uint32_t caller_id, uint32_t callee_id);
+
+  // Scans |func| again, replacing the calls recorded for it.  A function that
+  // is not in the graph yet is added.
+  void UpdateFunction(const Function* func);
+
+  // Removes the function |func_id| and the calls it makes.  Calls to it from
+  // other functions are kept.
+  void RemoveFunction(uint32_t func_id);
+
+  // Returns the strongly connected components of the graph.  The components
+  // of the callees come before those of their callers, and the functions of
+  // each component are in the order the module defines them.
+  const std::vector<std::vector<uint32_t>>& StronglyConnectedComponents();
+
+  // Returns the ids of the functions, the callees before their callers.  The
+  // functions of a recursive component are next to each other.
+  std::vector<uint32_t> BottomUpOrder();
+
+  // Returns the ids of the functions, the callers before their callees.
+  std::vector<uint32_t> TopDownOrder();
+
+  // Returns true if the function |func_id| can call itself, directly or
+  // through other functions.
+  bool IsRecursive(uint32_t func_id);
+
+ private:
+  struct Node {
+    // The functions called, in the order of their first call.
+    std::vector<uint32_t> callees;
+    // The number of calls to each function in |callees|.
+    std::vector<uint32_t> num_calls;
+  };
+
+  // Returns the node of |func_id|, adding an empty one if there is none.
+  Node& GetOrAddNode(uint32_t func_id);
+
+  // Removes |caller_id| from the callers of |callee_id|.
+  void RemoveCaller(uint32_t callee_id, uint32_t caller_id);
+
+  // Computes |components_| and |component_of_| with Tarjan's algorithm.
+  void ComputeComponents();
+
+  // The calls made by each function in the graph.
+  std::unordered_map<uint32_t, Node> nodes_;
+  // The functions that call each function.  A function can have callers
+  // before it is added to the graph.
+  std::unordered_map<uint32_t, std::vector<uint32_t>> callers_;
+  // The functions in the order they were added, which is the order of the
+  // module for the functions found when the graph was built.
+  std::vector<uint32_t> functions_;
+
+  bool components_valid_;
+  std::vector<std::vector<uint32_t>> components_;
+  // The index in |components_| of the component of each function.
+  std::unordered_map<uint32_t, uint32_t> component_of_;
+};
+
+}  // namespace opt
+}  // namespace spvtools
+
+#endif  // SOURCE_OPT_CALL_GRAPH_H_
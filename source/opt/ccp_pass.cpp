@@ -44,7 +44,7 @@ bool CCPPass::IsVaryingValue(uint32_t id) const { return id == kVaryingSSAId; }
 SSAPropagator::PropStatus CCPPass::MarkInstructionVarying(Instruction* instr) {
   assert(instr->result_id() != 0 &&
          "Instructions with no result cannot be marked varying.");
-  values_[instr->result_id()] = kVaryingSSAId;
+  values_.Set(instr->result_id(), kVaryingSSAId);
   return SSAPropagator::kVarying;
 }
 
@@ -60,19 +60,19 @@ SSAPropagator::PropStatus CCPPass::VisitPhi(Instruction* phi) {
       continue;
     }
     uint32_t phi_arg_id = phi->GetSingleWordOperand(i);
-    auto it = values_.find(phi_arg_id);
-    if (it != values_.end()) {
+    uint32_t arg_val_id = values_.Get(phi_arg_id);
+    if (arg_val_id != 0) {
       // We found an argument with a constant value.  Apply the meet operation
       // with the previous arguments.
-      if (it->second == kVaryingSSAId) {
+      if (arg_val_id == kVaryingSSAId) {
         // The "constant" value is actually a placeholder for varying. Return
         // varying for this phi.
         return MarkInstructionVarying(phi);
       } else if (meet_val_id == 0) {
         // This is the first argument we find.  Initialize the result to its
         // constant value id.
-        meet_val_id = it->second;
-      } else if (it->second == meet_val_id) {
+        meet_val_id = arg_val_id;
+      } else if (arg_val_id == meet_val_id) {
         // The argument is the same constant value already computed. Continue
         // looking.
         continue;
@@ -98,7 +98,7 @@ SSAPropagator::PropStatus CCPPass::VisitPhi(Instruction* phi) {
 
   // All the operands have the same constant value represented by |meet_val_id|.
   // Set the Phi's result to that value and declare it interesting.
-  values_[phi->result_id()] = meet_val_id;
+  values_.Set(phi->result_id(), meet_val_id);
   return SSAPropagator::kInteresting;
 }
 
@@ -109,13 +109,12 @@ SSAPropagator::PropStatus CCPPass::VisitAssignment(Instruction* instr) {
   // If this is a copy operation, and the RHS is a known constant, assign its
   // value to the LHS.
   if (instr->opcode() == SpvOpCopyObject) {
-    uint32_t rhs_id = instr->GetSingleWordInOperand(0);
-    auto it = values_.find(rhs_id);
-    if (it != values_.end()) {
-      if (IsVaryingValue(it->second)) {
+    uint32_t rhs_val_id = values_.Get(instr->GetSingleWordInOperand(0));
+    if (rhs_val_id != 0) {
+      if (IsVaryingValue(rhs_val_id)) {
         return MarkInstructionVarying(instr);
       } else {
-        values_[instr->result_id()] = it->second;
+        values_.Set(instr->result_id(), rhs_val_id);
         return SSAPropagator::kInteresting;
       }
     }
@@ -129,11 +128,11 @@ SSAPropagator::PropStatus CCPPass::VisitAssignment(Instruction* instr) {
 
   // See if the RHS of the assignment folds into a constant value.
   auto map_func = [this](uint32_t id) {
-    auto it = values_.find(id);
-    if (it == values_.end() || IsVaryingValue(it->second)) {
+    uint32_t val_id = values_.Get(id);
+    if (val_id == 0 || IsVaryingValue(val_id)) {
       return id;
     }
-    return it->second;
+    return val_id;
   };
   Instruction* folded_inst =
       context()->get_instruction_folder().FoldInstructionToConstant(instr,
@@ -142,15 +141,13 @@ SSAPropagator::PropStatus CCPPass::VisitAssignment(Instruction* instr) {
     // We do not want to change the body of the function by adding new
     // instructions.  When folding we can only generate new constants.
     assert(folded_inst->IsConstant() && "CCP is only interested in constant.");
-    values_[instr->result_id()] = folded_inst->result_id();
+    values_.Set(instr->result_id(), folded_inst->result_id());
     return SSAPropagator::kInteresting;
   }
 
   // Conservatively mark this instruction as varying if any input id is varying.
   if (!instr->WhileEachInId([this](uint32_t* op_id) {
-        auto iter = values_.find(*op_id);
-        if (iter != values_.end() && IsVaryingValue(iter->second)) return false;
-        return true;
+        return !IsVaryingValue(values_.Get(*op_id));
       })) {
     return MarkInstructionVarying(instr);
   }
@@ -158,9 +155,7 @@ SSAPropagator::PropStatus CCPPass::VisitAssignment(Instruction* instr) {
   // If not, see if there is a least one unknown operand to the instruction.  If
   // so, we might be able to fold it later.
   if (!instr->WhileEachInId([this](uint32_t* op_id) {
-        auto it = values_.find(*op_id);
-        if (it == values_.end()) return false;
-        return true;
+        return values_.Has(*op_id);
       })) {
     return SSAPropagator::kNotInteresting;
   }
@@ -183,16 +178,14 @@ SSAPropagator::PropStatus CCPPass::VisitBranch(Instruction* instr,
     // For a conditional branch, determine whether the predicate selector has a
     // known value in |values_|.  If it does, set the destination block
     // according to the selector's boolean value.
-    uint32_t pred_id = instr->GetSingleWordOperand(0);
-    auto it = values_.find(pred_id);
-    if (it == values_.end() || IsVaryingValue(it->second)) {
+    uint32_t pred_val_id = values_.Get(instr->GetSingleWordOperand(0));
+    if (pred_val_id == 0 || IsVaryingValue(pred_val_id)) {
       // The predicate has an unknown value, either branch could be taken.
       return SSAPropagator::kVarying;
     }
 
     // Get the constant value for the predicate selector from the value table.
     // Use it to decide which branch will be taken.
-    uint32_t pred_val_id = it->second;
     const analysis::Constant* c = const_mgr_->FindDeclaredConstant(pred_val_id);
     assert(c && "Expected to find a constant declaration for a known value.");
     // Undef values should have returned as varying above.
@@ -214,16 +207,14 @@ SSAPropagator::PropStatus CCPPass::VisitBranch(Instruction* instr,
       // Add support for wider constants.
       return SSAPropagator::kVarying;
     }
-    uint32_t select_id = instr->GetSingleWordOperand(0);
-    auto it = values_.find(select_id);
-    if (it == values_.end() || IsVaryingValue(it->second)) {
+    uint32_t select_val_id = values_.Get(instr->GetSingleWordOperand(0));
+    if (select_val_id == 0 || IsVaryingValue(select_val_id)) {
       // The selector has an unknown value, any of the branches could be taken.
       return SSAPropagator::kVarying;
     }
 
     // Get the constant value for the selector from the value table. Use it to
     // decide which branch will be taken.
-    uint32_t select_val_id = it->second;
     const analysis::Constant* c =
         const_mgr_->FindDeclaredConstant(select_val_id);
     assert(c && "Expected to find a constant declaration for a known value.");
@@ -267,21 +258,19 @@ SSAPropagator::PropStatus CCPPass::VisitInstruction(Instruction* instr,
 
 bool CCPPass::ReplaceValues() {
   bool retval = false;
-  for (const auto& it : values_) {
-    uint32_t id = it.first;
-    uint32_t cst_id = it.second;
+  values_.ForEach([this, &retval](uint32_t id, uint32_t cst_id) {
     if (!IsVaryingValue(cst_id) && id != cst_id) {
       context()->KillNamesAndDecorates(id);
       retval |= context()->ReplaceAllUsesWith(id, cst_id);
     }
-  }
+  });
   return retval;
 }
 
 bool CCPPass::PropagateConstants(Function* fp) {
   // Mark function parameters as varying.
   fp->ForEachParam([this](const Instruction* inst) {
-    values_[inst->result_id()] = kVaryingSSAId;
+    values_.Set(inst->result_id(), kVaryingSSAId);
   });
 
   const auto visit_fn = [this](Instruction* instr, BasicBlock** dest_bb) {
@@ -300,6 +289,8 @@ bool CCPPass::PropagateConstants(Function* fp) {
 
 void CCPPass::Initialize() {
   const_mgr_ = context()->get_constant_mgr();
+  values_.Clear();
+  values_.Reserve(get_module()->IdBound());
 
   // Populate the constant table with values from constant declarations in the
   // module.  The values of each OpConstant declaration is the identity
@@ -308,9 +299,9 @@ void CCPPass::Initialize() {
     // Record compile time constant ids. Treat all other global values as
     // varying.
     if (inst.IsConstant()) {
-      values_[inst.result_id()] = inst.result_id();
+      values_.Set(inst.result_id(), inst.result_id());
     } else {
-      values_[inst.result_id()] = kVaryingSSAId;
+      values_.Set(inst.result_id(), kVaryingSSAId);
     }
   }
 }
@@ -319,7 +310,11 @@ Pass::Status CCPPass::Process() {
   Initialize();
 
   // Process all entry point functions.
-  ProcessFunction pfn = [this](Function* fp) { return PropagateConstants(fp); };
+  ProcessFunction pfn = [this](Function* fp) {
+    if (!ShouldProcessFunction(fp) || !PropagateConstants(fp)) return false;
+    RecordChangedFunction(fp);
+    return true;
+  };
   bool modified = context()->ProcessReachableCallTree(pfn);
   return modified ? Pass::Status::SuccessWithChange
                   : Pass::Status::SuccessWithoutChange;
@@ -16,7 +16,6 @@
 #define SOURCE_OPT_CCP_PASS_H_
 
 #include <memory>
-#include <unordered_map>
 
 #include "source/opt/constants.h"
 #include "source/opt/function.h"
@@ -30,9 +29,10 @@ namespace opt {
 
 class CCPPass : public MemPass {
  public:
-  CCPPass() = default;
+  CCPPass() : values_(0) {}
 
   const char* name() const override { return "ccp"; }
+  bool IsFunctionLocal() const override { return true; }
   Status Process() override;
 
   IRContext::Analysis GetPreservedAnalyses() override {
@@ -40,8 +40,9 @@ class CCPPass : public MemPass {
            IRContext::kAnalysisInstrToBlockMapping |
            IRContext::kAnalysisDecorations | IRContext::kAnalysisCombinators |
            IRContext::kAnalysisCFG | IRContext::kAnalysisDominatorAnalysis |
-           IRContext::kAnalysisNameMap | IRContext::kAnalysisConstants |
-           IRContext::kAnalysisTypes;
+           IRContext::kAnalysisLoopAnalysis | IRContext::kAnalysisNameMap |
+           IRContext::kAnalysisConstants | IRContext::kAnalysisTypes |
+           IRContext::kAnalysisCallGraph;
   }
 
  private:
@@ -92,8 +93,8 @@ class CCPPass : public MemPass {
   // generated during propagation.
   analysis::ConstantManager* const_mgr_;
 
-  // Constant value table.  Each entry <id, const_decl_id> in this map
-  // represents the compile-time constant value for |id| as declared by
+  // Constant value table, indexed by SSA id.  Each entry <id, const_decl_id>
+  // in this table represents the compile-time constant value for |id| as declared by
   // |const_decl_id|. Each |const_decl_id| in this table is an OpConstant
   // declaration for the current module.
   //
@@ -101,7 +102,8 @@ class CCPPass : public MemPass {
   // SSA ID is found to have a varying value, it will have an entry in this
   // table that maps to the special SSA id kVaryingSSAId.  These values are
   // never replaced in the IR, they are used by CCP during propagation.
-  std::unordered_map<uint32_t, uint32_t> values_;
+  // Ids with no entry map to 0.
+  DenseLattice<uint32_t> values_;
 
   // Propagator engine used.
   std::unique_ptr<SSAPropagator> propagator_;
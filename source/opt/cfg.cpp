@@ -46,7 +46,20 @@ CFG::CFG(Module* module)
   }
 }
 
+void CFG::RebuildFunction(Function* func) {
+  // The edges of a function stay in the function, so only the predecessors
+  // of its own blocks change.
+  ForgetOrders(func);
+  for (auto& blk : *func) {
+    label2preds_[blk.id()].clear();
+  }
+  for (auto& blk : *func) {
+    RegisterBlock(&blk);
+  }
+}
+
 void CFG::AddEdges(BasicBlock* blk) {
+  ForgetOrdersOf(blk);
   uint32_t blk_id = blk->id();
   // Force the creation of an entry, not all basic block have predecessors
   // (such as the entry blocks and some unreachables).
@@ -56,7 +69,33 @@ void CFG::AddEdges(BasicBlock* blk) {
       [blk_id, this](const uint32_t succ_id) { AddEdge(blk_id, succ_id); });
 }
 
+void CFG::MergeSuccessorInto(const BasicBlock* blk, uint32_t succ_id) {
+  ForgetOrdersOf(blk);
+  const uint32_t blk_id = blk->id();
+  blk->ForEachSuccessorLabel([blk_id, succ_id, this](uint32_t id) {
+    auto& preds_list = label2preds_[id];
+    std::replace(preds_list.begin(), preds_list.end(), succ_id, blk_id);
+  });
+  id2block_.erase(succ_id);
+  label2preds_.erase(succ_id);
+}
+
+void CFG::SplitBlock(BasicBlock* blk, BasicBlock* new_blk) {
+  ForgetOrdersOf(blk);
+  const uint32_t blk_id = blk->id();
+  const uint32_t new_blk_id = new_blk->id();
+  id2block_[new_blk_id] = new_blk;
+  label2preds_[new_blk_id] = {blk_id};
+  const auto* const_new_blk = new_blk;
+  const_new_blk->ForEachSuccessorLabel(
+      [blk_id, new_blk_id, this](uint32_t id) {
+        auto& preds_list = label2preds_[id];
+        std::replace(preds_list.begin(), preds_list.end(), blk_id, new_blk_id);
+      });
+}
+
 void CFG::RemoveNonExistingEdges(uint32_t blk_id) {
+  ForgetOrdersOf(blk_id);
   std::vector<uint32_t> updated_pred_list;
   for (uint32_t id : preds(blk_id)) {
     const BasicBlock* pred_blk = block(id);
@@ -78,7 +117,18 @@ void CFG::ComputeStructuredOrder(Function* func, BasicBlock* root,
              SpvCapabilityShader) &&
          "This only works on structured control flow");
 
+  const bool from_entry = root == &*func->begin();
+  if (from_entry) {
+    auto cached = structured_orders_.find(func);
+    if (cached != structured_orders_.end()) {
+      order->insert(order->begin(), cached->second.begin(),
+                    cached->second.end());
+      return;
+    }
+  }
+
   // Compute structured successors and do DFS.
+  std::list<BasicBlock*> new_order;
   ComputeStructuredSuccessors(func);
   auto ignore_block = [](cbb_ptr) {};
   auto ignore_edge = [](cbb_ptr, cbb_ptr) {};
@@ -89,18 +139,20 @@ void CFG::ComputeStructuredOrder(Function* func, BasicBlock* root,
   // TODO(greg-lunarg): Get rid of const_cast by making moving const
   // out of the cfa.h prototypes and into the invoking code.
   auto post_order = [&](cbb_ptr b) {
-    order->push_front(const_cast<BasicBlock*>(b));
+    new_order.push_front(const_cast<BasicBlock*>(b));
   };
   CFA<BasicBlock>::DepthFirstTraversal(root, get_structured_successors,
                                        ignore_block, post_order, ignore_edge);
+  if (from_entry) {
+    structured_orders_[func].assign(new_order.begin(), new_order.end());
+  }
+  order->splice(order->begin(), new_order);
 }
 
 void CFG::ForEachBlockInPostOrder(BasicBlock* bb,
                                   const std::function<void(BasicBlock*)>& f) {
-  std::vector<BasicBlock*> po;
-  std::unordered_set<BasicBlock*> seen;
-  ComputePostOrderTraversal(bb, &po, &seen);
-
+  // A copy of the order is walked, as |f| may change the CFG.
+  const std::vector<BasicBlock*> po = PostOrderFrom(bb);
   for (BasicBlock* current_bb : po) {
     if (!IsPseudoExitBlock(current_bb) && !IsPseudoEntryBlock(current_bb)) {
       f(current_bb);
@@ -118,10 +170,7 @@ void CFG::ForEachBlockInReversePostOrder(
 
 bool CFG::WhileEachBlockInReversePostOrder(
     BasicBlock* bb, const std::function<bool(BasicBlock*)>& f) {
-  std::vector<BasicBlock*> po;
-  std::unordered_set<BasicBlock*> seen;
-  ComputePostOrderTraversal(bb, &po, &seen);
-
+  const std::vector<BasicBlock*> po = PostOrderFrom(bb);
   for (auto current_bb = po.rbegin(); current_bb != po.rend(); ++current_bb) {
     if (!IsPseudoExitBlock(*current_bb) && !IsPseudoEntryBlock(*current_bb)) {
       if (!f(*current_bb)) {
@@ -182,10 +231,25 @@ void CFG::ComputePostOrderTraversal(BasicBlock* bb,
   }
 }
 
+std::vector<BasicBlock*> CFG::PostOrderFrom(BasicBlock* bb) {
+  Function* func = bb->GetParent();
+  const bool from_entry = func != nullptr && bb == &*func->begin();
+  if (from_entry) {
+    auto cached = post_orders_.find(func);
+    if (cached != post_orders_.end()) return cached->second;
+  }
+  std::vector<BasicBlock*> po;
+  std::unordered_set<BasicBlock*> seen;
+  ComputePostOrderTraversal(bb, &po, &seen);
+  if (from_entry) post_orders_[func] = po;
+  return po;
+}
+
 BasicBlock* CFG::SplitLoopHeader(BasicBlock* bb) {
   assert(bb->GetLoopMergeInst() && "Expecting bb to be the header of a loop.");
 
   Function* fn = bb->GetParent();
+  ForgetOrders(fn);
   IRContext* context = module_->context();
 
   // Get the new header id up front.  If we are out of ids, then we cannot split
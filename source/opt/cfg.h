@@ -63,10 +63,16 @@ class CFG {
   // dominate, merge blocks come after all blocks that are in the control
   // constructs of their header, and continue blocks come after all of the
   // blocks in the body of their loop.
+  //
+  // The order from the entry block of |func| is cached until the edges of
+  // |func| change through this class.
   void ComputeStructuredOrder(Function* func, BasicBlock* root,
                               std::list<BasicBlock*>* order);
 
-  // Applies |f| to all blocks that can be reach from |bb| in post order.
+  // Applies |f| to all blocks that can be reach from |bb| in post order.  The
+  // order from the entry block of a function is cached, as for
+  // |ComputeStructuredOrder|, and so is used by the reverse post order
+  // traversals below.
   void ForEachBlockInPostOrder(BasicBlock* bb,
                                const std::function<void(BasicBlock*)>& f);
 
@@ -94,8 +100,23 @@ class CFG {
     AddEdges(blk);
   }
 
+  // Forgets the cached block orders of |func|.  The methods of this class
+  // changing the edges do it; a pass which changes the terminators or the
+  // merge instructions of |func| otherwise, and keeps the CFG, must call it.
+  void ForgetOrders(const Function* func) {
+    post_orders_.erase(func);
+    structured_orders_.erase(func);
+  }
+
+  // Recomputes the predecessors of the blocks of |func| from their
+  // terminators.  The mappings of the blocks that were removed from |func|
+  // without being forgotten are left in place; they are unreachable from the
+  // remaining blocks.
+  void RebuildFunction(Function* func);
+
   // Removes from the CFG any mapping for the basic block id |blk_id|.
   void ForgetBlock(const BasicBlock* blk) {
+    ForgetOrdersOf(blk);
     id2block_.erase(blk->id());
     label2preds_.erase(blk->id());
     RemoveSuccessorEdges(blk);
@@ -104,6 +125,7 @@ class CFG {
   void RemoveEdge(uint32_t pred_blk_id, uint32_t succ_blk_id) {
     auto pred_it = label2preds_.find(succ_blk_id);
     if (pred_it == label2preds_.end()) return;
+    ForgetOrdersOf(pred_blk_id);
     auto& preds_list = pred_it->second;
     auto it = std::find(preds_list.begin(), preds_list.end(), pred_blk_id);
     if (it != preds_list.end()) preds_list.erase(it);
@@ -115,6 +137,7 @@ class CFG {
   // Registers the basic block id |pred_blk_id| as being a predecessor of the
   // basic block id |succ_blk_id|.
   void AddEdge(uint32_t pred_blk_id, uint32_t succ_blk_id) {
+    ForgetOrdersOf(pred_blk_id);
     label2preds_[succ_blk_id].push_back(pred_blk_id);
   }
 
@@ -124,10 +147,20 @@ class CFG {
 
   // Remove all edges that leave |bb|.
   void RemoveSuccessorEdges(const BasicBlock* bb) {
+    ForgetOrdersOf(bb);
     bb->ForEachSuccessorLabel(
         [bb, this](uint32_t succ_id) { RemoveEdge(bb->id(), succ_id); });
   }
 
+  // Updates the CFG after the block |succ_id| was merged into |blk|, its only
+  // predecessor: the successors of |succ_id|, which are now the successors of
+  // |blk|, have |blk| as predecessor instead, and |succ_id| is forgotten.
+  void MergeSuccessorInto(const BasicBlock* blk, uint32_t succ_id);
+
+  // Updates the CFG after the instructions at the end of |blk| were moved to
+  // the new block |new_blk|, and |blk| was made to branch to |new_blk|.
+  void SplitBlock(BasicBlock* blk, BasicBlock* new_blk);
+
   // Divides |block| into two basic blocks.  The first block will have the same
   // id as |block| and will become a preheader for the loop.  The other block
   // is a new block that will be the new loop header.
@@ -153,6 +186,28 @@ class CFG {
                                  std::vector<BasicBlock*>* order,
                                  std::unordered_set<BasicBlock*>* seen);
 
+  // Returns the post-order traversal of the cfg starting at |bb|, from the
+  // cache if |bb| is the entry block of its function.
+  std::vector<BasicBlock*> PostOrderFrom(BasicBlock* bb);
+
+  // Forgets the cached block orders of the function of |blk|, or of all the
+  // functions if |blk| is null or not in a function.
+  void ForgetOrdersOf(const BasicBlock* blk) {
+    if (blk != nullptr && blk->GetParent() != nullptr) {
+      ForgetOrders(blk->GetParent());
+    } else {
+      post_orders_.clear();
+      structured_orders_.clear();
+    }
+  }
+
+  // Forgets the cached block orders of the function of the block |blk_id|,
+  // or of all the functions if the block is unknown.
+  void ForgetOrdersOf(uint32_t blk_id) {
+    auto it = id2block_.find(blk_id);
+    ForgetOrdersOf(it != id2block_.end() ? it->second : nullptr);
+  }
+
   // Module for this CFG.
   Module* module_;
 
@@ -173,6 +228,13 @@ class CFG {
 
   // Map from block's label id to block.
   std::unordered_map<uint32_t, BasicBlock*> id2block_;
+
+  // The post order and the structured order of the blocks of each function
+  // from its entry block, for the functions they were computed for since
+  // their edges last changed.
+  std::unordered_map<const Function*, std::vector<BasicBlock*>> post_orders_;
+  std::unordered_map<const Function*, std::vector<BasicBlock*>>
+      structured_orders_;
 };
 
 }  // namespace opt
@@ -15,6 +15,7 @@
 #include "code_sink.h"
 
 #include <set>
+#include <unordered_set>
 #include <vector>
 
 #include "source/opt/instruction.h"
@@ -54,117 +55,227 @@ bool CodeSinkingPass::SinkInstruction(Instruction* inst) {
     return false;
   }
 
-  if (ReferencesMutableMemory(inst)) {
+  // A load of memory that may change can still be moved if only the current
+  // invocation writes it, and it is not written on the way.
+  const bool references_mutable_memory = ReferencesMutableMemory(inst);
+  if (references_mutable_memory && !IsInvocationLocalLoad(inst)) {
     return false;
   }
 
-  if (BasicBlock* target_bb = FindNewBasicBlockFor(inst)) {
-    Instruction* pos = &*target_bb->begin();
-    while (pos->opcode() == SpvOpPhi) {
-      pos = pos->NextNode();
+  BasicBlock* target_bb = FindNewBasicBlockFor(inst);
+  if (target_bb == nullptr) {
+    return false;
+  }
+
+  if (references_mutable_memory) {
+    // Checking the paths to |target_bb| for writes is only worth it if |inst|
+    // is executed less often there.  It is not if |target_bb| post-dominates
+    // the original block in the same loop.
+    BasicBlock* original_bb = context()->get_instr_block(inst);
+    PostDominatorAnalysis* post_dom =
+        context()->GetPostDominatorAnalysis(original_bb->GetParent());
+    if (GetLoopHeader(target_bb) == GetLoopHeader(original_bb) &&
+        post_dom->Dominates(target_bb, original_bb)) {
+      return false;
     }
+    if (MayBeWrittenBefore(inst, target_bb)) {
+      return false;
+    }
+  }
 
-    inst->InsertBefore(pos);
-    context()->set_instr_block(inst, target_bb);
-    return true;
+  Instruction* pos = &*target_bb->begin();
+  while (pos->opcode() == SpvOpPhi) {
+    pos = pos->NextNode();
   }
-  return false;
+
+  inst->InsertBefore(pos);
+  context()->set_instr_block(inst, target_bb);
+  return true;
 }
 
 BasicBlock* CodeSinkingPass::FindNewBasicBlockFor(Instruction* inst) {
   assert(inst->result_id() != 0 && "Instruction should have a result.");
-  BasicBlock* original_bb = context()->get_instr_block(inst);
-  BasicBlock* bb = original_bb;
+  // The loops are found with the structured CFG analysis, which is only
+  // available for shaders.
+  if (!context()->get_feature_mgr()->HasCapability(SpvCapabilityShader)) {
+    return nullptr;
+  }
 
-  std::unordered_set<uint32_t> bbs_with_uses;
+  BasicBlock* original_bb = context()->get_instr_block(inst);
+  DominatorAnalysis* dom =
+      context()->GetDominatorAnalysis(original_bb->GetParent());
+
+  // Find the nearest block dominating all of the uses of |inst|, however
+  // deeply they are nested in selection constructs.  An OpPhi uses its
+  // operands at the end of the corresponding predecessors.
+  BasicBlock* bb = nullptr;
+  bool has_uses = false;
   get_def_use_mgr()->ForEachUse(
-      inst, [&bbs_with_uses, this](Instruction* use, uint32_t idx) {
-        if (use->opcode() != SpvOpPhi) {
-          BasicBlock* use_bb = context()->get_instr_block(use);
-          if (use_bb) {
-            bbs_with_uses.insert(use_bb->id());
-          }
-        } else {
-          bbs_with_uses.insert(use->GetSingleWordOperand(idx + 1));
+      inst, [&bb, &has_uses, dom, this](Instruction* use, uint32_t idx) {
+        BasicBlock* use_bb =
+            use->opcode() == SpvOpPhi
+                ? context()->get_instr_block(use->GetSingleWordOperand(idx + 1))
+                : context()->get_instr_block(use);
+        if (use_bb == nullptr) {
+          return;
+        }
+        if (!has_uses) {
+          bb = use_bb;
+          has_uses = true;
+        } else if (bb != nullptr) {
+          bb = dom->CommonDominator(bb, use_bb);
         }
       });
+  if (bb == nullptr || bb == original_bb || !dom->Dominates(original_bb, bb)) {
+    return nullptr;
+  }
 
-  while (true) {
-    // If |inst| is used in |bb|, then |inst| cannot be moved any further.
-    if (bbs_with_uses.count(bb->id())) {
-      break;
-    }
+  // Moving |inst| into a loop that does not contain the original block would
+  // execute it on each iteration.  Move it before the outermost such loop
+  // instead.  |bb| is dominated by the original block, so |inst| is executed
+  // at most once per execution of the original block anywhere else.
+  uint32_t header_id = GetLoopHeader(bb);
+  while (header_id != 0 &&
+         dom->StrictlyDominates(original_bb->id(), header_id)) {
+    bb = dom->ImmediateDominator(header_id);
+    header_id = GetLoopHeader(bb);
+  }
+  return (bb != original_bb ? bb : nullptr);
+}
 
-    // If |bb| has one successor (succ_bb), and |bb| is the only predecessor
-    // of succ_bb, then |inst| can be moved to succ_bb.  If succ_bb, has move
-    // then one predecessor, then moving |inst| into succ_bb could cause it to
-    // be executed more often, so the search has to stop.
-    if (bb->terminator()->opcode() == SpvOpBranch) {
-      uint32_t succ_bb_id = bb->terminator()->GetSingleWordInOperand(0);
-      if (cfg()->preds(succ_bb_id).size() == 1) {
-        bb = context()->get_instr_block(succ_bb_id);
-        continue;
-      } else {
-        break;
-      }
-    }
+uint32_t CodeSinkingPass::GetLoopHeader(BasicBlock* bb) {
+  if (bb->IsLoopHeader()) {
+    return bb->id();
+  }
+  return context()->GetStructuredCFGAnalysis()->ContainingLoop(bb->id());
+}
 
-    // The remaining checks need to know the merge node.  If there is no merge
-    // instruction or an OpLoopMerge, then it is a break or continue.  We could
-    // figure it out, but not worth doing it now.
-    Instruction* merge_inst = bb->GetMergeInst();
-    if (merge_inst == nullptr || merge_inst->opcode() != SpvOpSelectionMerge) {
-      break;
-    }
+bool CodeSinkingPass::IsInvocationLocalLoad(Instruction* inst) {
+  if (inst->opcode() != SpvOpLoad) {
+    return false;
+  }
 
-    // Check all of the successors of |bb| it see which lead to a use of |inst|
-    // before reaching the merge node.
-    bool used_in_multiple_blocks = false;
-    uint32_t bb_used_in = 0;
-    bb->ForEachSuccessorLabel([this, bb, &bb_used_in, &used_in_multiple_blocks,
-                               &bbs_with_uses](uint32_t* succ_bb_id) {
-      if (IntersectsPath(*succ_bb_id, bb->MergeBlockIdIfAny(), bbs_with_uses)) {
-        if (bb_used_in == 0) {
-          bb_used_in = *succ_bb_id;
-        } else {
-          used_in_multiple_blocks = true;
-        }
-      }
-    });
+  if (inst->NumInOperands() > 1 &&
+      (inst->GetSingleWordInOperand(1) & SpvMemoryAccessVolatileMask)) {
+    return false;
+  }
 
-    // If more than one successor, which is not the merge block, uses |inst|
-    // then we have to leave |inst| in bb because there is none of the
-    // successors dominate all uses of |inst|.
-    if (used_in_multiple_blocks) {
-      break;
+  Instruction* base_ptr = inst->GetBaseAddress();
+  if (base_ptr->opcode() != SpvOpVariable) {
+    return false;
+  }
+
+  uint32_t storage_class = base_ptr->GetSingleWordInOperand(0);
+  return storage_class == SpvStorageClassFunction ||
+         storage_class == SpvStorageClassPrivate;
+}
+
+bool CodeSinkingPass::MayBeWrittenBefore(Instruction* inst,
+                                         BasicBlock* target_bb) {
+  BasicBlock* original_bb = context()->get_instr_block(inst);
+  const uint32_t var_id = inst->GetBaseAddress()->result_id();
+
+  // The blocks on a path from the original block to |target_bb| are those
+  // reached from the original block which reach |target_bb|.
+  std::unordered_set<uint32_t> reached;
+  std::vector<uint32_t> worklist;
+  original_bb->ForEachSuccessorLabel([&reached, &worklist](uint32_t* succ_id) {
+    if (reached.insert(*succ_id).second) {
+      worklist.push_back(*succ_id);
+    }
+  });
+  while (!worklist.empty()) {
+    uint32_t bb_id = worklist.back();
+    worklist.pop_back();
+    if (bb_id == target_bb->id()) {
+      continue;
     }
+    cfg()->block(bb_id)->ForEachSuccessorLabel(
+        [&reached, &worklist](uint32_t* succ_id) {
+          if (reached.insert(*succ_id).second) {
+            worklist.push_back(*succ_id);
+          }
+        });
+  }
 
-    if (bb_used_in == 0) {
-      // If |inst| is not used before reaching the merge node, then we can move
-      // |inst| to the merge node.
-      bb = context()->get_instr_block(bb->MergeBlockIdIfAny());
-    } else {
-      // If the only successor that leads to a used of |inst| has more than 1
-      // predecessor, then moving |inst| could cause it to be executed more
-      // often, so we cannot move it.
-      if (cfg()->preds(bb_used_in).size() != 1) {
-        break;
+  std::unordered_set<uint32_t> reaching;
+  for (uint32_t pred_id : cfg()->preds(target_bb->id())) {
+    if (reaching.insert(pred_id).second) {
+      worklist.push_back(pred_id);
+    }
+  }
+  while (!worklist.empty()) {
+    uint32_t bb_id = worklist.back();
+    worklist.pop_back();
+    if (bb_id == original_bb->id()) {
+      continue;
+    }
+    for (uint32_t pred_id : cfg()->preds(bb_id)) {
+      if (reaching.insert(pred_id).second) {
+        worklist.push_back(pred_id);
       }
+    }
+  }
 
-      // If |inst| is used after the merge block, then |bb_used_in| does not
-      // dominate all of the uses.  So we cannot move |inst| any further.
-      if (IntersectsPath(bb->MergeBlockIdIfAny(), original_bb->id(),
-                         bbs_with_uses)) {
-        break;
-      }
+  // The original block is entirely on the path if it is reached again,
+  // otherwise only the instructions after |inst| are.
+  Instruction* first = reached.count(original_bb->id())
+                           ? &*original_bb->begin()
+                           : inst->NextNode();
+  for (Instruction* i = first; i != nullptr; i = i->NextNode()) {
+    if (MayWriteVariable(i, var_id)) {
+      return true;
+    }
+  }
 
-      // Otherwise, |bb_used_in| dominates all uses, so move |inst| into that
-      // block.
-      bb = context()->get_instr_block(bb_used_in);
+  for (uint32_t bb_id : reached) {
+    if (bb_id == original_bb->id() || bb_id == target_bb->id() ||
+        reaching.count(bb_id) == 0) {
+      continue;
+    }
+    BasicBlock* bb = cfg()->block(bb_id);
+    if (!bb->WhileEachInst([this, var_id](Instruction* i) {
+          return !MayWriteVariable(i, var_id);
+        })) {
+      return true;
     }
-    continue;
   }
-  return (bb != original_bb ? bb : nullptr);
+  return false;
+}
+
+bool CodeSinkingPass::MayWriteVariable(Instruction* inst, uint32_t var_id) {
+  switch (inst->opcode()) {
+    case SpvOpFunctionCall:
+      // The callee may write private variables, or through its parameters.
+      return true;
+    case SpvOpLoad:
+    case SpvOpAccessChain:
+    case SpvOpInBoundsAccessChain:
+    case SpvOpPtrAccessChain:
+    case SpvOpInBoundsPtrAccessChain:
+    case SpvOpCopyObject:
+      return false;
+    default:
+      break;
+  }
+
+  // Any other instruction is assumed to write through its pointer operands,
+  // unless they point into another variable.
+  return !inst->WhileEachInId([this, var_id](uint32_t* id) {
+    Instruction* def = get_def_use_mgr()->GetDef(*id);
+    Instruction* type = get_def_use_mgr()->GetDef(def->type_id());
+    if (type == nullptr || type->opcode() != SpvOpTypePointer) {
+      return true;
+    }
+    while (def->opcode() == SpvOpAccessChain ||
+           def->opcode() == SpvOpInBoundsAccessChain ||
+           def->opcode() == SpvOpPtrAccessChain ||
+           def->opcode() == SpvOpInBoundsPtrAccessChain ||
+           def->opcode() == SpvOpCopyObject) {
+      def = get_def_use_mgr()->GetDef(def->GetSingleWordInOperand(0));
+    }
+    return def->opcode() == SpvOpVariable && def->result_id() != var_id;
+  });
 }
 
 bool CodeSinkingPass::ReferencesMutableMemory(Instruction* inst) {
@@ -285,34 +396,6 @@ bool CodeSinkingPass::HasPossibleStore(Instruction* var_inst) {
   });
 }
 
-bool CodeSinkingPass::IntersectsPath(uint32_t start, uint32_t end,
-                                     const std::unordered_set<uint32_t>& set) {
-  std::vector<uint32_t> worklist;
-  worklist.push_back(start);
-  std::unordered_set<uint32_t> already_done;
-  already_done.insert(start);
-
-  while (!worklist.empty()) {
-    BasicBlock* bb = context()->get_instr_block(worklist.back());
-    worklist.pop_back();
-
-    if (bb->id() == end) {
-      continue;
-    }
-
-    if (set.count(bb->id())) {
-      return true;
-    }
-
-    bb->ForEachSuccessorLabel([&already_done, &worklist](uint32_t* succ_bb_id) {
-      if (already_done.insert(*succ_bb_id).second) {
-        worklist.push_back(*succ_bb_id);
-      }
-    });
-  }
-  return false;
-}
-
 // namespace opt
 
 }  // namespace opt
@@ -16,6 +16,7 @@
 #define SOURCE_OPT_CODE_SINK_H_
 
 #include <unordered_map>
+#include <unordered_set>
 
 #include "source/opt/ir_context.h"
 #include "source/opt/module.h"
@@ -25,11 +26,16 @@ namespace spvtools {
 namespace opt {
 
 // This pass does code sinking for OpAccessChain and OpLoad on variables in
-// uniform storage or in read only memory.  Code sinking is a transformation
-// where an instruction is moved into a more deeply nested construct.
+// uniform storage or in read only memory, and on function and private
+// variables which are not written between the load and its new position.
+// Code sinking is a transformation where an instruction is moved into a more
+// deeply nested construct.
 //
 // The goal is to move these instructions as close as possible to their uses
 // without having to execute them more often or to replicate the instruction.
+// An instruction is moved to the nearest block dominating all of its uses,
+// across as many levels of selection constructs as needed, unless that block
+// is in a loop which does not contain the instruction.
 // Moving the instruction in this way can lead to shorter live ranges, which can
 // lead to less register pressure.  It can also cause instructions to be
 // executed less often because they could be moved into one path of a selection
@@ -42,6 +48,9 @@ namespace opt {
 // operands are live for a longer time in most cases.
 class CodeSinkingPass : public Pass {
  public:
+  CodeSinkingPass()
+      : checked_for_uniform_sync_(false), has_uniform_sync_(false) {}
+
   const char* name() const override { return "code-sink"; }
   Status Process() override;
 
@@ -55,11 +64,16 @@ class CodeSinkingPass : public Pass {
            IRContext::kAnalysisConstants | IRContext::kAnalysisTypes;
   }
 
- private:
+ protected:
   // Sinks the instructions in |bb| as much as possible.  Returns true if
   // something changes.
   bool SinkInstructionsInBB(BasicBlock* bb);
 
+  // Return true if |inst| reference memory and it is possible that the data in
+  // the memory changes at some point.
+  bool ReferencesMutableMemory(Instruction* inst);
+
+ private:
   // Tries the sink |inst| as much as possible.  Returns true if the instruction
   // is moved.
   bool SinkInstruction(Instruction* inst);
@@ -70,9 +84,21 @@ class CodeSinkingPass : public Pass {
   // |inst|.
   BasicBlock* FindNewBasicBlockFor(Instruction* inst);
 
-  // Return true if |inst| reference memory and it is possible that the data in
-  // the memory changes at some point.
-  bool ReferencesMutableMemory(Instruction* inst);
+  // Returns the id of the header of the innermost loop executing |bb| on each
+  // iteration: |bb| itself if it is a loop header.  Returns 0 if |bb| is not
+  // in a loop.
+  uint32_t GetLoopHeader(BasicBlock* bb);
+
+  // Returns true if |inst| is a non-volatile load from a function or private
+  // variable, which only the current invocation can write.
+  bool IsInvocationLocalLoad(Instruction* inst);
+
+  // Returns true if the variable loaded by |inst| may be written on a path
+  // from |inst| to the start of |target_bb|.
+  bool MayBeWrittenBefore(Instruction* inst, BasicBlock* target_bb);
+
+  // Returns true if |inst| may write to the variable |var_id|.
+  bool MayWriteVariable(Instruction* inst, uint32_t var_id);
 
   // Returns true if the module contains an instruction that has a memory
   // semantics id as an operand, and the memory semantics enforces a
@@ -83,11 +109,6 @@ class CodeSinkingPass : public Pass {
   // Returns true if there may be a store to the variable |var_inst|.
   bool HasPossibleStore(Instruction* var_inst);
 
-  // Returns true if one of the basic blocks in |set| exists on a path from the
-  // basic block |start| to |end|.
-  bool IntersectsPath(uint32_t start, uint32_t end,
-                      const std::unordered_set<uint32_t>& set);
-
   // Returns true if |mem_semantics_id| is the id of a constant that, when
   // interpreted as a memory semantics mask enforces synchronization of uniform
   // memory.  See section 3.25 of the SPIR-V specification.
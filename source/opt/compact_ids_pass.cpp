@@ -15,7 +15,10 @@
 #include "source/opt/compact_ids_pass.h"
 
 #include <cassert>
+#include <memory>
 #include <unordered_map>
+#include <unordered_set>
+#include <utility>
 
 #include "source/opt/ir_context.h"
 
@@ -25,7 +28,9 @@ namespace opt {
 Pass::Status CompactIdsPass::Process() {
   bool modified = false;
   std::unordered_map<uint32_t, uint32_t> result_id_mapping;
+  if (order_by_locality_) MapIdsByLocality(&result_id_mapping, &modified);
 
+  // The ids not mapped yet are numbered in module order, after the others.
   context()->module()->ForEachInst(
       [&result_id_mapping, &modified](Instruction* inst) {
         auto operand = inst->begin();
@@ -59,12 +64,183 @@ Pass::Status CompactIdsPass::Process() {
       },
       true);
 
-  if (modified)
-    context()->module()->SetIdBound(
-        static_cast<uint32_t>(result_id_mapping.size() + 1));
+  // The bound also shrinks when the ids are already in order but some ids
+  // past the last one were never used.
+  const uint32_t bound = static_cast<uint32_t>(result_id_mapping.size() + 1);
+  if (modified || context()->module()->IdBound() != bound) {
+    modified = true;
+    context()->module()->SetIdBound(bound);
+  }
 
   return modified ? Status::SuccessWithChange : Status::SuccessWithoutChange;
 }
 
+std::unordered_map<uint32_t, uint32_t> CompactIdsPass::FindHomeFunctions(
+    const std::vector<Function*>& functions) {
+  std::vector<Instruction*> values;
+  std::unordered_set<uint32_t> value_ids;
+  for (auto& inst : get_module()->types_values()) {
+    values.push_back(&inst);
+    if (inst.HasResultId()) value_ids.insert(inst.result_id());
+  }
+
+  // The first function with the most uses of a value wins.
+  std::unordered_map<uint32_t, uint32_t> homes;
+  std::unordered_map<uint32_t, uint32_t> best_counts;
+  for (uint32_t i = 0; i < functions.size(); ++i) {
+    std::unordered_map<uint32_t, uint32_t> counts;
+    functions[i]->ForEachInst(
+        [&value_ids, &counts](Instruction* inst) {
+          inst->ForEachId([&value_ids, &counts](const uint32_t* id) {
+            if (value_ids.count(*id)) ++counts[*id];
+          });
+        },
+        true);
+    for (const auto& count : counts) {
+      uint32_t& best = best_counts[count.first];
+      if (count.second > best) {
+        best = count.second;
+        homes[count.first] = i;
+      }
+    }
+  }
+
+  // The values used only by other global values, such as the types of the
+  // variables, go with their earliest user.  The users come after the
+  // values they use.
+  for (auto it = values.rbegin(); it != values.rend(); ++it) {
+    Instruction* inst = *it;
+    if (!inst->HasResultId() || homes.count(inst->result_id())) continue;
+    bool has_home = false;
+    uint32_t home = 0;
+    get_def_use_mgr()->ForEachUser(
+        inst, [&homes, &value_ids, &has_home, &home](Instruction* user) {
+          if (!user->HasResultId() || !value_ids.count(user->result_id())) {
+            return;
+          }
+          auto user_home = homes.find(user->result_id());
+          if (user_home == homes.end()) return;
+          if (!has_home || user_home->second < home) home = user_home->second;
+          has_home = true;
+        });
+    if (has_home) homes[inst->result_id()] = home;
+  }
+  return homes;
+}
+
+std::vector<std::vector<Instruction*>> CompactIdsPass::GroupGlobalValues(
+    const std::vector<Function*>& functions, bool* modified) {
+  std::vector<Instruction*> values;
+  std::unordered_map<uint32_t, Instruction*> defs;
+  bool can_reorder = true;
+  for (auto& inst : get_module()->types_values()) {
+    values.push_back(&inst);
+    if (inst.HasResultId()) defs[inst.result_id()] = &inst;
+    if (inst.opcode() == SpvOpTypeForwardPointer ||
+        inst.opcode() == SpvOpExtInst) {
+      can_reorder = false;
+    }
+  }
+
+  // Group 0 holds the values without a home, and group i + 1 the values of
+  // function i.
+  std::unordered_map<uint32_t, uint32_t> homes = FindHomeFunctions(functions);
+  auto group_of = [&homes](const Instruction* inst) -> uint32_t {
+    auto it = homes.find(inst->result_id());
+    return it == homes.end() ? 0 : it->second + 1;
+  };
+  std::vector<std::vector<Instruction*>> groups(functions.size() + 1);
+  if (!can_reorder) {
+    for (Instruction* inst : values) groups[group_of(inst)].push_back(inst);
+    return groups;
+  }
+
+  // Place each value after the values it depends on, which may pull them
+  // into an earlier group.  An explicit stack is used since the chains of
+  // dependencies may be long.
+  std::unordered_set<Instruction*> placed;
+  std::vector<std::pair<Instruction*, bool>> stack;
+  for (uint32_t group = 0; group < groups.size(); ++group) {
+    for (Instruction* root : values) {
+      if (group_of(root) != group) continue;
+      stack.push_back({root, false});
+      while (!stack.empty()) {
+        Instruction* inst = stack.back().first;
+        bool dependencies_placed = stack.back().second;
+        stack.pop_back();
+        if (dependencies_placed) {
+          groups[group].push_back(inst);
+          continue;
+        }
+        if (!placed.insert(inst).second) continue;
+        stack.push_back({inst, true});
+        inst->ForEachId([inst, &defs, &placed, &stack](const uint32_t* id) {
+          auto def = defs.find(*id);
+          if (def != defs.end() && def->second != inst &&
+              !placed.count(def->second)) {
+            stack.push_back({def->second, false});
+          }
+        });
+      }
+    }
+  }
+
+  // Move the values to their new position.
+  std::vector<Instruction*> new_order;
+  for (const auto& group : groups) {
+    new_order.insert(new_order.end(), group.begin(), group.end());
+  }
+  assert(new_order.size() == values.size());
+  if (new_order != values) {
+    *modified = true;
+    for (Instruction* inst : new_order) {
+      inst->RemoveFromList();
+      get_module()->AddGlobalValue(std::unique_ptr<Instruction>(inst));
+    }
+  }
+  return groups;
+}
+
+void CompactIdsPass::MapIdsByLocality(
+    std::unordered_map<uint32_t, uint32_t>* result_id_mapping,
+    bool* modified) {
+  auto map_id = [result_id_mapping](uint32_t id) {
+    if (result_id_mapping->count(id)) return;
+    const uint32_t new_id =
+        static_cast<uint32_t>(result_id_mapping->size()) + 1;
+    result_id_mapping->emplace(id, new_id);
+  };
+
+  std::vector<Function*> functions;
+  for (auto& func : *get_module()) functions.push_back(&func);
+  std::vector<std::vector<Instruction*>> groups =
+      GroupGlobalValues(functions, modified);
+  std::unordered_set<uint32_t> value_ids;
+  for (const auto& group : groups) {
+    for (Instruction* inst : group) {
+      if (inst->HasResultId()) value_ids.insert(inst->result_id());
+    }
+  }
+
+  for (auto& inst : get_module()->ext_inst_imports()) {
+    map_id(inst.result_id());
+  }
+  for (uint32_t group = 0; group < groups.size(); ++group) {
+    for (Instruction* inst : groups[group]) {
+      if (inst->HasResultId()) map_id(inst->result_id());
+    }
+    if (group == 0) continue;
+
+    // The global values used by the function were mapped with their group.
+    functions[group - 1]->ForEachInst(
+        [&value_ids, &map_id](Instruction* inst) {
+          inst->ForEachId([&value_ids, &map_id](const uint32_t* id) {
+            if (!value_ids.count(*id)) map_id(*id);
+          });
+        },
+        true);
+  }
+}
+
 }  // namespace opt
 }  // namespace spvtools
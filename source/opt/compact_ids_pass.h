@@ -15,6 +15,10 @@
 #ifndef SOURCE_OPT_COMPACT_IDS_PASS_H_
 #define SOURCE_OPT_COMPACT_IDS_PASS_H_
 
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
 #include "source/opt/ir_context.h"
 #include "source/opt/module.h"
 #include "source/opt/pass.h"
@@ -25,6 +29,12 @@ namespace opt {
 // See optimizer.hpp for documentation.
 class CompactIdsPass : public Pass {
  public:
+  // If |order_by_locality| is true, the ids are ordered by their first use
+  // in each function, and the global values are grouped by the function
+  // using them the most, instead of being numbered in module order.
+  explicit CompactIdsPass(bool order_by_locality = false)
+      : order_by_locality_(order_by_locality) {}
+
   const char* name() const override { return "compact-ids"; }
   Status Process() override;
 
@@ -34,6 +44,32 @@ class CompactIdsPass : public Pass {
            IRContext::kAnalysisDominatorAnalysis |
            IRContext::kAnalysisLoopAnalysis;
   }
+
+ private:
+  // Returns the index of the function which is the home of each global
+  // value: the function using it the most, or else the home of its first
+  // global user.  The values without a home are not in the map.
+  std::unordered_map<uint32_t, uint32_t> FindHomeFunctions(
+      const std::vector<Function*>& functions);
+
+  // Reorders the types, constants and global variables in groups, first the
+  // values without a home, then the values of each function in order, with
+  // the values they depend on placed first.  Returns the global values in
+  // their new order, by group.  The order of the module is kept if it has
+  // forward pointers or extended instructions in its global section.  Sets
+  // |modified| to true if the order changed.
+  std::vector<std::vector<Instruction*>> GroupGlobalValues(
+      const std::vector<Function*>& functions, bool* modified);
+
+  // Maps the ids of the module to their new ids in locality order, in
+  // |result_id_mapping|, and reorders the global values accordingly.  Some
+  // ids used only in the debug and annotation sections may be left out.  Sets
+  // |modified| to true if the order of the global values changed.
+  void MapIdsByLocality(
+      std::unordered_map<uint32_t, uint32_t>* result_id_mapping,
+      bool* modified);
+
+  bool order_by_locality_;
 };
 
 }  // namespace opt
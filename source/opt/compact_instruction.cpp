@@ -0,0 +1,103 @@
+// Copyright (c) 2019 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "source/opt/compact_instruction.h"
+
+#include <algorithm>
+#include <limits>
+#include <utility>
+
+#include "source/opt/ir_context.h"
+
+namespace spvtools {
+namespace opt {
+
+CompactInstruction::CompactInstruction(const Instruction& inst)
+    : has_type_id_(inst.type_id() != 0), has_result_id_(inst.result_id() != 0) {
+  const uint32_t num_words = 1 + inst.NumOperandWords();
+  assert(num_words <= std::numeric_limits<uint16_t>::max());
+  words_.reserve(num_words);
+  words_.push_back((num_words << 16) | static_cast<uint16_t>(inst.opcode()));
+  operands_.reserve(inst.NumOperands());
+  for (const Operand& operand : inst) {
+    operands_.push_back({static_cast<uint16_t>(operand.type),
+                         static_cast<uint16_t>(words_.size()),
+                         static_cast<uint16_t>(operand.words.size())});
+    words_.insert(words_.end(), operand.words.begin(), operand.words.end());
+  }
+}
+
+std::unique_ptr<Instruction> CompactInstruction::Decode(
+    IRContext* context) const {
+  Instruction::OperandList in_operands;
+  in_operands.reserve(NumInOperands());
+  for (uint32_t i = TypeResultIdCount(); i < operands_.size(); ++i) {
+    const OperandInfo& info = operands_[i];
+    Operand::OperandData words;
+    for (uint32_t j = 0; j < info.length; ++j) {
+      words.push_back(words_[info.offset + j]);
+    }
+    in_operands.emplace_back(static_cast<spv_operand_type_t>(info.type),
+                             std::move(words));
+  }
+  return std::unique_ptr<Instruction>(new (context) Instruction(
+      context, opcode(), type_id(), result_id(), in_operands));
+}
+
+spv_parsed_instruction_t CompactInstruction::ToParsedInstruction(
+    std::vector<spv_parsed_operand_t>* operands) const {
+  operands->clear();
+  for (const OperandInfo& info : operands_) {
+    operands->push_back({info.offset, info.length,
+                         static_cast<spv_operand_type_t>(info.type),
+                         SPV_NUMBER_NONE, 0});
+  }
+  spv_parsed_instruction_t parsed;
+  parsed.words = words_.data();
+  parsed.num_words = static_cast<uint16_t>(words_.size());
+  parsed.opcode = static_cast<uint16_t>(opcode());
+  parsed.ext_inst_type = SPV_EXT_INST_TYPE_NONE;
+  parsed.type_id = type_id();
+  parsed.result_id = result_id();
+  parsed.operands = operands->data();
+  parsed.num_operands = static_cast<uint16_t>(operands->size());
+  return parsed;
+}
+
+void CompactInstruction::SetInOperand(uint32_t index,
+                                      const Operand::OperandData& data) {
+  assert(index < NumInOperands());
+  OperandInfo& info = operands_[index + TypeResultIdCount()];
+  auto first = words_.begin() + info.offset;
+  if (data.size() == info.length) {
+    std::copy(data.begin(), data.end(), first);
+    return;
+  }
+
+  // Replace the words of the operand, and shift the following operands.
+  first = words_.erase(first, first + info.length);
+  words_.insert(first, data.begin(), data.end());
+  assert(words_.size() <= std::numeric_limits<uint16_t>::max());
+  const int delta = static_cast<int>(data.size()) - info.length;
+  info.length = static_cast<uint16_t>(data.size());
+  for (uint32_t i = index + TypeResultIdCount() + 1; i < operands_.size();
+       ++i) {
+    operands_[i].offset = static_cast<uint16_t>(operands_[i].offset + delta);
+  }
+  words_[0] = (static_cast<uint32_t>(words_.size()) << 16) |
+              (words_[0] & SpvOpCodeMask);
+}
+
+}  // namespace opt
+}  // namespace spvtools
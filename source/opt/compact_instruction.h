@@ -0,0 +1,143 @@
+// Copyright (c) 2019 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef SOURCE_OPT_COMPACT_INSTRUCTION_H_
+#define SOURCE_OPT_COMPACT_INSTRUCTION_H_
+
+#include <cassert>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#include "source/opt/instruction.h"
+
+namespace spvtools {
+namespace opt {
+
+// A compact encoding of an instruction: the words of the instruction, as in
+// the binary, in one array, and a parallel array giving the type and position
+// of each operand.  An operand takes 4 bytes per word plus 6 bytes, instead of
+// the 40 bytes of an |Operand| for a single word, and the encoding is written
+// out to a binary with a single copy.
+//
+// It is meant for holding many instructions that are read more than they are
+// changed, such as a saved copy of a module.  It has no context, no unique id
+// and no debug line instructions.  |Decode| turns it back into an
+// |Instruction|.
+class CompactInstruction {
+ public:
+  // Encodes |inst|, without its debug line instructions.
+  explicit CompactInstruction(const Instruction& inst);
+
+  // Returns a new instruction in |context| with the opcode and operands of
+  // this encoding.
+  std::unique_ptr<Instruction> Decode(IRContext* context) const;
+
+  SpvOp opcode() const {
+    return static_cast<SpvOp>(words_[0] & SpvOpCodeMask);
+  }
+  uint32_t type_id() const {
+    return has_type_id_ ? words_[operands_[0].offset] : 0;
+  }
+  uint32_t result_id() const {
+    return has_result_id_ ? words_[operands_[has_type_id_].offset] : 0;
+  }
+
+  // Returns the number of words of the instruction, including the first word
+  // holding the opcode.
+  uint32_t NumWords() const { return static_cast<uint32_t>(words_.size()); }
+
+  uint32_t NumOperands() const {
+    return static_cast<uint32_t>(operands_.size());
+  }
+  uint32_t NumInOperands() const {
+    return NumOperands() - TypeResultIdCount();
+  }
+
+  // Returns the type of the |index|th in-operand.
+  spv_operand_type_t GetInOperandType(uint32_t index) const {
+    return static_cast<spv_operand_type_t>(GetInOperandInfo(index).type);
+  }
+
+  // Returns the words of the |index|th in-operand as a pointer to its first
+  // word and a number of words in |*num_words|.
+  const uint32_t* GetInOperandWords(uint32_t index,
+                                    uint32_t* num_words) const {
+    const OperandInfo& info = GetInOperandInfo(index);
+    *num_words = info.length;
+    return words_.data() + info.offset;
+  }
+
+  // Returns the single word of the |index|th in-operand.
+  uint32_t GetSingleWordInOperand(uint32_t index) const {
+    const OperandInfo& info = GetInOperandInfo(index);
+    assert(info.length == 1 && "expected the operand only taking one word");
+    return words_[info.offset];
+  }
+
+  // Sets the words of the |index|th in-operand to |data|.  The words of the
+  // following operands are moved if the length of the operand changes.
+  void SetInOperand(uint32_t index, const Operand::OperandData& data);
+
+  // Returns the instruction as the binary parser describes it, with its
+  // operands stored in |*operands|.  The result points into this encoding and
+  // into |*operands|.  Its extended instruction set type is
+  // SPV_EXT_INST_TYPE_NONE, and its numeric operands have no number kind.
+  spv_parsed_instruction_t ToParsedInstruction(
+      std::vector<spv_parsed_operand_t>* operands) const;
+
+  // Appends the words of the instruction to |binary|.
+  void ToBinary(std::vector<uint32_t>* binary) const {
+    binary->insert(binary->end(), words_.begin(), words_.end());
+  }
+
+  friend bool operator==(const CompactInstruction& lhs,
+                         const CompactInstruction& rhs) {
+    return lhs.words_ == rhs.words_ && lhs.operands_ == rhs.operands_;
+  }
+
+ private:
+  // The type and position of an operand in |words_|.  An instruction has at
+  // most 0xFFFF words, so 16 bits are enough for each field.
+  struct OperandInfo {
+    uint16_t type;
+    uint16_t offset;
+    uint16_t length;
+
+    friend bool operator==(const OperandInfo& lhs, const OperandInfo& rhs) {
+      return lhs.type == rhs.type && lhs.offset == rhs.offset &&
+             lhs.length == rhs.length;
+    }
+  };
+
+  uint32_t TypeResultIdCount() const {
+    return (has_type_id_ ? 1 : 0) + (has_result_id_ ? 1 : 0);
+  }
+
+  const OperandInfo& GetInOperandInfo(uint32_t index) const {
+    assert(index < NumInOperands());
+    return operands_[index + TypeResultIdCount()];
+  }
+
+  // The words of the instruction, starting with the word count and opcode.
+  std::vector<uint32_t> words_;
+  std::vector<OperandInfo> operands_;
+  bool has_type_id_;
+  bool has_result_id_;
+};
+
+}  // namespace opt
+}  // namespace spvtools
+
+#endif  // SOURCE_OPT_COMPACT_INSTRUCTION_H_
@@ -14,15 +14,46 @@
 
 #include "source/opt/constants.h"
 
+#include <functional>
 #include <unordered_map>
 #include <vector>
 
 #include "source/opt/ir_context.h"
+#include "source/util/hash_combine.h"
 
 namespace spvtools {
 namespace opt {
 namespace analysis {
 
+size_t CompositeConstant::GetComponentsHash() const {
+  if (components_hash_ == 0) {
+    size_t hash = GetComponents().size();
+    for (const Constant* c : GetComponents()) {
+      utils::HashCombine(std::hash<const Constant*>()(c), &hash);
+    }
+    // 0 marks a hash not computed yet.
+    components_hash_ = hash == 0 ? 1 : hash;
+  }
+  return components_hash_;
+}
+
+size_t ConstantHash::operator()(const Constant* const_val) const {
+  size_t hash = std::hash<const Type*>()(const_val->type());
+  if (const auto scalar = const_val->AsScalarConstant()) {
+    for (uint32_t w : scalar->words()) {
+      utils::HashCombine(std::hash<uint32_t>()(w), &hash);
+    }
+  } else if (const auto composite = const_val->AsCompositeConstant()) {
+    utils::HashCombine(composite->GetComponentsHash(), &hash);
+  } else if (const_val->AsNullConstant()) {
+    utils::HashCombine(0, &hash);
+  } else {
+    assert(false &&
+           "Tried to compute the hash value of an invalid Constant instance.");
+  }
+  return hash;
+}
+
 float Constant::GetFloat() const {
   assert(type()->AsFloat() != nullptr && type()->AsFloat()->width() == 32);
 
@@ -293,6 +324,7 @@ std::unique_ptr<Constant> ConstantManager::CreateConstant(
 
 const Constant* ConstantManager::GetConstantFromInst(const Instruction* inst) {
   std::vector<uint32_t> literal_words_or_ids;
+  literal_words_or_ids.reserve(inst->NumInOperandWords());
 
   // Collect the constant defining literals or component ids.
   for (uint32_t i = 0; i < inst->NumInOperands(); i++) {
@@ -307,14 +307,24 @@ class CompositeConstant : public Constant {
     return true;
   }
 
+  // Returns a hash of the components of this constant.  It is computed on the
+  // first call only, so the components must not change after that, which is
+  // the case once the constant is in a constant pool.
+  size_t GetComponentsHash() const;
+
  protected:
-  CompositeConstant(const Type* ty) : Constant(ty), components_() {}
+  CompositeConstant(const Type* ty)
+      : Constant(ty), components_(), components_hash_(0) {}
   CompositeConstant(const Type* ty,
                     const std::vector<const Constant*>& components)
-      : Constant(ty), components_(components) {}
+      : Constant(ty), components_(components), components_hash_(0) {}
   CompositeConstant(const Type* ty, std::vector<const Constant*>&& components)
-      : Constant(ty), components_(std::move(components)) {}
+      : Constant(ty), components_(std::move(components)), components_hash_(0) {}
   std::vector<const Constant*> components_;
+
+ private:
+  // The cached result of GetComponentsHash, or 0 if not computed yet.
+  mutable size_t components_hash_;
 };
 
 // Struct type constant.
@@ -444,40 +454,19 @@ class NullConstant : public Constant {
 };
 
 // Hash function for Constant instances. Use the structure of the constant as
-// the key.
+// the key.  The components of a composite constant are hashed by their
+// addresses, as they are unique within a constant pool.
 struct ConstantHash {
-  void add_pointer(std::u32string* h, const void* p) const {
-    uint64_t ptr_val = reinterpret_cast<uint64_t>(p);
-    h->push_back(static_cast<uint32_t>(ptr_val >> 32));
-    h->push_back(static_cast<uint32_t>(ptr_val));
-  }
-
-  size_t operator()(const Constant* const_val) const {
-    std::u32string h;
-    add_pointer(&h, const_val->type());
-    if (const auto scalar = const_val->AsScalarConstant()) {
-      for (const auto& w : scalar->words()) {
-        h.push_back(w);
-      }
-    } else if (const auto composite = const_val->AsCompositeConstant()) {
-      for (const auto& c : composite->GetComponents()) {
-        add_pointer(&h, c);
-      }
-    } else if (const_val->AsNullConstant()) {
-      h.push_back(0);
-    } else {
-      assert(
-          false &&
-          "Tried to compute the hash value of an invalid Constant instance.");
-    }
-
-    return std::hash<std::u32string>()(h);
-  }
+  size_t operator()(const Constant* const_val) const;
 };
 
 // Equality comparison structure for two constants.
 struct ConstantEqual {
   bool operator()(const Constant* c1, const Constant* c2) const {
+    if (c1 == c2) {
+      return true;
+    }
+
     if (c1->type() != c2->type()) {
       return false;
     }
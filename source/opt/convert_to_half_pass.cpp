@@ -44,11 +44,12 @@ bool ConvertToHalfPass::IsFloat(Instruction* inst, uint32_t width) {
 
 bool ConvertToHalfPass::IsDecoratedRelaxed(Instruction* inst) {
   uint32_t r_id = inst->result_id();
-  for (auto r_inst : get_decoration_mgr()->GetDecorationsFor(r_id, false))
-    if (r_inst->opcode() == SpvOpDecorate &&
-        r_inst->GetSingleWordInOperand(1) == SpvDecorationRelaxedPrecision)
-      return true;
-  return false;
+  return !get_decoration_mgr()->WhileEachDecorationOf(
+      r_id, false, [](const Instruction* r_inst) {
+        return r_inst->opcode() != SpvOpDecorate ||
+               r_inst->GetSingleWordInOperand(1) !=
+                   SpvDecorationRelaxedPrecision;
+      });
 }
 
 bool ConvertToHalfPass::IsRelaxed(uint32_t id) {
@@ -35,6 +35,12 @@ class ConvertToHalfPass : public Pass {
   // See optimizer.hpp for pass user documentation.
   Status Process() override;
 
+  // Only values decorated RelaxedPrecision are converted.
+  bool IsNoOp(IRContext* ctx) const override {
+    return ctx->GetModuleSummary()->NumDecorations(
+               SpvDecorationRelaxedPrecision) == 0;
+  }
+
   const char* name() const override { return "convert-to-half-pass"; }
 
  private:
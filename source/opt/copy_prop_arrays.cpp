@@ -17,6 +17,7 @@
 #include <utility>
 
 #include "source/opt/ir_builder.h"
+#include "source/util/small_vector.h"
 
 namespace spvtools {
 namespace opt {
@@ -137,7 +138,7 @@ Instruction* CopyPropagateArrays::BuildNewAccessChain(
       context(), insertion_point,
       IRContext::kAnalysisDefUse | IRContext::kAnalysisInstrToBlockMapping);
 
-  if (source->AccessChain().size() == 0) {
+  if (!source->IsMember()) {
     return source->GetVariable();
   }
 
@@ -216,24 +217,17 @@ CopyPropagateArrays::GetSourceObjectIfAny(uint32_t result) {
 
 std::unique_ptr<CopyPropagateArrays::MemoryObject>
 CopyPropagateArrays::BuildMemoryObjectFromLoad(Instruction* load_inst) {
-  std::vector<uint32_t> components_in_reverse;
+  utils::SmallVector<Instruction*, 4> access_chains_in_reverse;
   analysis::DefUseManager* def_use_mgr = context()->get_def_use_mgr();
 
   Instruction* current_inst = def_use_mgr->GetDef(
       load_inst->GetSingleWordInOperand(kLoadPointerInOperand));
 
-  // Build the access chain for the memory object by collecting the indices used
-  // in the OpAccessChain instructions.  If we find a variable index, then
-  // return |nullptr| because we cannot know for sure which memory location is
-  // used.
-  //
-  // It is built in reverse order because the different |OpAccessChain|
-  // instructions are visited in reverse order from which they are applied.
+  // Find the OpAccessChain instructions whose indices make up the access chain
+  // for the memory object.  They are visited in reverse order from which they
+  // are applied.
   while (current_inst->opcode() == SpvOpAccessChain) {
-    for (uint32_t i = current_inst->NumInOperands() - 1; i >= 1; --i) {
-      uint32_t element_index_id = current_inst->GetSingleWordInOperand(i);
-      components_in_reverse.push_back(element_index_id);
-    }
+    access_chains_in_reverse.push_back(current_inst);
     current_inst = def_use_mgr->GetDef(current_inst->GetSingleWordInOperand(0));
   }
 
@@ -245,11 +239,17 @@ CopyPropagateArrays::BuildMemoryObjectFromLoad(Instruction* load_inst) {
     return nullptr;
   }
 
-  // Build the memory object.  Use |rbegin| and |rend| to put the access chain
-  // back in the correct order.
-  return std::unique_ptr<CopyPropagateArrays::MemoryObject>(
-      new MemoryObject(current_inst, components_in_reverse.rbegin(),
-                       components_in_reverse.rend()));
+  // Build the memory object, applying the indices of the |OpAccessChain|
+  // instructions in order.
+  std::unique_ptr<CopyPropagateArrays::MemoryObject> result(
+      new MemoryObject(current_inst, &access_chains_, AccessChainTrie::kRoot));
+  for (size_t i = access_chains_in_reverse.size(); i > 0; --i) {
+    Instruction* access_chain = access_chains_in_reverse[i - 1];
+    for (uint32_t j = 1; j < access_chain->NumInOperands(); ++j) {
+      result->GetMember(access_chain->GetSingleWordInOperand(j));
+    }
+  }
+  return result;
 }
 
 std::unique_ptr<CopyPropagateArrays::MemoryObject>
@@ -266,17 +266,15 @@ CopyPropagateArrays::BuildMemoryObjectFromExtract(Instruction* extract_inst) {
     const analysis::Type* uint32_type =
         context()->get_type_mgr()->GetRegisteredType(&int_type);
 
-    std::vector<uint32_t> components;
     // Convert the indices in the extract instruction to a series of ids that
     // can be used by the |OpAccessChain| instruction.
     for (uint32_t i = 1; i < extract_inst->NumInOperands(); ++i) {
       uint32_t index = extract_inst->GetSingleWordInOperand(i);
       const analysis::Constant* index_const =
           const_mgr->GetConstant(uint32_type, {index});
-      components.push_back(
+      result->GetMember(
           const_mgr->GetDefiningInstruction(index_const)->result_id());
     }
-    result->GetMember(components);
     return result;
   }
   return nullptr;
@@ -305,7 +303,7 @@ CopyPropagateArrays::BuildMemoryObjectFromCompositeConstruct(
 
   analysis::ConstantManager* const_mgr = context()->get_constant_mgr();
   const analysis::Constant* last_access =
-      const_mgr->FindDeclaredConstant(memory_object->AccessChain().back());
+      const_mgr->FindDeclaredConstant(memory_object->LastAccess());
   if (!last_access || !last_access->type()->AsInteger()) {
     return nullptr;
   }
@@ -337,8 +335,7 @@ CopyPropagateArrays::BuildMemoryObjectFromCompositeConstruct(
       return nullptr;
     }
 
-    last_access =
-        const_mgr->FindDeclaredConstant(member_object->AccessChain().back());
+    last_access = const_mgr->FindDeclaredConstant(member_object->LastAccess());
     if (!last_access || !last_access->type()->AsInteger()) {
       return nullptr;
     }
@@ -398,7 +395,7 @@ CopyPropagateArrays::BuildMemoryObjectFromInsert(Instruction* insert_inst) {
   }
 
   const analysis::Constant* last_access =
-      const_mgr->FindDeclaredConstant(memory_object->AccessChain().back());
+      const_mgr->FindDeclaredConstant(memory_object->LastAccess());
   if (!last_access || !last_access->type()->AsInteger()) {
     return nullptr;
   }
@@ -435,8 +432,8 @@ CopyPropagateArrays::BuildMemoryObjectFromInsert(Instruction* insert_inst) {
       return nullptr;
     }
 
-    if (memory_object->AccessChain().size() + 1 !=
-        current_memory_object->AccessChain().size()) {
+    if (memory_object->AccessChainLength() + 1 !=
+        current_memory_object->AccessChainLength()) {
       return nullptr;
     }
 
@@ -445,8 +442,7 @@ CopyPropagateArrays::BuildMemoryObjectFromInsert(Instruction* insert_inst) {
     }
 
     const analysis::Constant* current_last_access =
-        const_mgr->FindDeclaredConstant(
-            current_memory_object->AccessChain().back());
+        const_mgr->FindDeclaredConstant(current_memory_object->LastAccess());
     if (!current_last_access || !current_last_access->type()->AsInteger()) {
       return nullptr;
     }
@@ -725,10 +721,24 @@ uint32_t CopyPropagateArrays::GetMemberTypeId(
   return id;
 }
 
-void CopyPropagateArrays::MemoryObject::GetMember(
-    const std::vector<uint32_t>& access_chain) {
-  access_chain_.insert(access_chain_.end(), access_chain.begin(),
-                       access_chain.end());
+uint32_t CopyPropagateArrays::AccessChainTrie::GetChild(uint32_t node,
+                                                       uint32_t id) {
+  const uint64_t key = static_cast<uint64_t>(node) << 32 | id;
+  auto inserted =
+      children_.insert({key, static_cast<uint32_t>(nodes_.size())});
+  if (inserted.second) {
+    nodes_.push_back({node, id, nodes_[node].length + 1});
+  }
+  return inserted.first->second;
+}
+
+uint32_t CopyPropagateArrays::AccessChainTrie::GetPrefix(
+    uint32_t node, uint32_t length) const {
+  assert(length <= GetLength(node) && "The prefix is longer than the chain.");
+  while (GetLength(node) > length) {
+    node = GetParent(node);
+  }
+  return node;
 }
 
 uint32_t CopyPropagateArrays::MemoryObject::GetNumberOfMembers() {
@@ -758,24 +768,29 @@ uint32_t CopyPropagateArrays::MemoryObject::GetNumberOfMembers() {
   }
 }
 
-template <class iterator>
-CopyPropagateArrays::MemoryObject::MemoryObject(Instruction* var_inst,
-                                                iterator begin, iterator end)
-    : variable_inst_(var_inst), access_chain_(begin, end) {}
+std::vector<uint32_t> CopyPropagateArrays::MemoryObject::AccessChain() const {
+  std::vector<uint32_t> access_chain(AccessChainLength());
+  uint32_t node = access_chain_;
+  for (size_t i = access_chain.size(); i > 0; --i) {
+    access_chain[i - 1] = trie_->GetLastId(node);
+    node = trie_->GetParent(node);
+  }
+  return access_chain;
+}
 
 std::vector<uint32_t> CopyPropagateArrays::MemoryObject::GetAccessIds() const {
   analysis::ConstantManager* const_mgr =
       variable_inst_->context()->get_constant_mgr();
 
-  std::vector<uint32_t> access_indices;
-  for (uint32_t id : AccessChain()) {
+  std::vector<uint32_t> access_indices(AccessChainLength());
+  uint32_t node = access_chain_;
+  for (size_t i = access_indices.size(); i > 0; --i) {
     const analysis::Constant* element_index_const =
-        const_mgr->FindDeclaredConstant(id);
-    if (!element_index_const) {
-      access_indices.push_back(0);
-    } else {
-      access_indices.push_back(element_index_const->GetU32());
+        const_mgr->FindDeclaredConstant(trie_->GetLastId(node));
+    if (element_index_const) {
+      access_indices[i - 1] = element_index_const->GetU32();
     }
+    node = trie_->GetParent(node);
   }
   return access_indices;
 }
@@ -786,16 +801,14 @@ bool CopyPropagateArrays::MemoryObject::Contains(
     return false;
   }
 
-  if (AccessChain().size() > other->AccessChain().size()) {
+  if (AccessChainLength() > other->AccessChainLength()) {
     return false;
   }
 
-  for (uint32_t i = 0; i < AccessChain().size(); i++) {
-    if (AccessChain()[i] != other->AccessChain()[i]) {
-      return false;
-    }
-  }
-  return true;
+  // The access chains are interned, so |other| is contained in |this| if its
+  // prefix is the same node.
+  return trie_->GetPrefix(other->access_chain_, AccessChainLength()) ==
+         access_chain_;
 }
 
 }  // namespace opt
@@ -16,6 +16,7 @@
 #define SOURCE_OPT_COPY_PROP_ARRAYS_H_
 
 #include <memory>
+#include <unordered_map>
 #include <vector>
 
 #include "source/opt/mem_pass.h"
@@ -52,37 +53,79 @@ class CopyPropagateArrays : public MemPass {
   }
 
  private:
+  // The access chains of the memory objects, interned in a trie.  Each node
+  // stands for the access chain made of the ids on the path from the root to
+  // it, so that memory objects share the prefixes of their access chains, and
+  // are extended and shortened without allocating.
+  class AccessChainTrie {
+   public:
+    // The node of the empty access chain.
+    static const uint32_t kRoot = 0;
+
+    AccessChainTrie() : nodes_(1, {kRoot, 0, 0}) {}
+
+    // Returns the node of the access chain of |node| followed by |id|.
+    uint32_t GetChild(uint32_t node, uint32_t id);
+
+    // Returns the node of the access chain of |node| without its last id.
+    uint32_t GetParent(uint32_t node) const { return nodes_[node].parent; }
+
+    // Returns the last id of the access chain of |node|.
+    uint32_t GetLastId(uint32_t node) const { return nodes_[node].id; }
+
+    // Returns the number of ids in the access chain of |node|.
+    uint32_t GetLength(uint32_t node) const { return nodes_[node].length; }
+
+    // Returns the node of the first |length| ids of the access chain of
+    // |node|.
+    uint32_t GetPrefix(uint32_t node, uint32_t length) const;
+
+   private:
+    struct Node {
+      uint32_t parent;
+      uint32_t id;
+      uint32_t length;
+    };
+
+    std::vector<Node> nodes_;
+    // Maps the parent node and the last id of each node, packed in a word,
+    // to the node.
+    std::unordered_map<uint64_t, uint32_t> children_;
+  };
+
   // The class used to identify a particular memory object.  This memory object
   // will be owned by a particular variable, meaning that the memory is part of
   // that variable.  It could be the entire variable or a member of the
   // variable.
   class MemoryObject {
    public:
-    // Construction a memory object that is owned by |var_inst|.  The iterator
-    // |begin| and |end| traverse a container of integers that identify which
-    // member of |var_inst| this memory object will represent.  These integers
-    // are interpreted the same way they would be in an |OpAccessChain|
+    // Construction a memory object that is owned by |var_inst|.  The node
+    // |access_chain| of |trie| holds the integers that identify which member
+    // of |var_inst| this memory object will represent.  These integers are
+    // interpreted the same way they would be in an |OpAccessChain|
     // instruction.
-    template <class iterator>
-    MemoryObject(Instruction* var_inst, iterator begin, iterator end);
-
-    // Change |this| to now point to the member identified by |access_chain|
-    // (starting from the current member).  The elements in |access_chain| are
-    // interpreted the same as the indices in the |OpAccessChain|
-    // instruction.
-    void GetMember(const std::vector<uint32_t>& access_chain);
+    MemoryObject(Instruction* var_inst, AccessChainTrie* trie,
+                 uint32_t access_chain)
+        : variable_inst_(var_inst), trie_(trie), access_chain_(access_chain) {}
+
+    // Change |this| to now point to the member identified by |index_id|
+    // (starting from the current member).  |index_id| is interpreted the
+    // same as the indices in the |OpAccessChain| instruction.
+    void GetMember(uint32_t index_id) {
+      access_chain_ = trie_->GetChild(access_chain_, index_id);
+    }
 
     // Change |this| to now represent the first enclosing object to which it
     // belongs.  (Remove the last element off the access_chain). It is invalid
     // to call this function if |this| does not represent a member of its owner.
     void GetParent() {
       assert(IsMember());
-      access_chain_.pop_back();
+      access_chain_ = trie_->GetParent(access_chain_);
     }
 
     // Returns true if |this| represents a member of its owner, and not the
     // entire variable.
-    bool IsMember() const { return !access_chain_.empty(); }
+    bool IsMember() const { return access_chain_ != AccessChainTrie::kRoot; }
 
     // Returns the number of members in the object represented by |this|.  If
     // |this| does not represent a composite type, the return value will be 0.
@@ -95,7 +138,20 @@ class CopyPropagateArrays : public MemPass {
     // member that |this| represents starting from the owning variable.  These
     // values are to be interpreted the same way the indices are in an
     // |OpAccessChain| instruction.
-    const std::vector<uint32_t>& AccessChain() const { return access_chain_; }
+    std::vector<uint32_t> AccessChain() const;
+
+    // Returns the number of integers in the access chain of |this|.
+    uint32_t AccessChainLength() const {
+      return trie_->GetLength(access_chain_);
+    }
+
+    // Returns the last integer of the access chain of |this|.  It is invalid
+    // to call this function if |this| does not represent a member of its
+    // owner.
+    uint32_t LastAccess() const {
+      assert(IsMember());
+      return trie_->GetLastId(access_chain_);
+    }
 
     // Returns the type id of the pointer type that can be used to point to this
     // memory object.
@@ -134,10 +190,13 @@ class CopyPropagateArrays : public MemPass {
     // The variable that owns this memory object.
     Instruction* variable_inst_;
 
-    // The access chain to reach the particular member the memory object
-    // represents.  It should be interpreted the same way the indices in an
-    // |OpAccessChain| are interpreted.
-    std::vector<uint32_t> access_chain_;
+    // The trie holding the access chain of this memory object.
+    AccessChainTrie* trie_;
+
+    // The node of |trie_| of the access chain to reach the particular member
+    // the memory object represents.  It should be interpreted the same way
+    // the indices in an |OpAccessChain| are interpreted.
+    uint32_t access_chain_;
     std::vector<uint32_t> GetAccessIds() const;
   };
 
@@ -227,6 +286,9 @@ class CopyPropagateArrays : public MemPass {
   // same way the indexes are used in an |OpCompositeExtract| instruction.
   uint32_t GetMemberTypeId(uint32_t id,
                            const std::vector<uint32_t>& access_chain) const;
+
+  // The access chains of all the memory objects built by the pass.
+  AccessChainTrie access_chains_;
 };
 
 }  // namespace opt
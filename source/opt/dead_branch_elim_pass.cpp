@@ -192,6 +192,8 @@ bool DeadBranchElimPass::MarkLiveBlocks(
 
 void DeadBranchElimPass::SimplifyBranch(BasicBlock* block,
                                         uint32_t live_lab_id) {
+  CFG* cfg = context()->cfg();
+  cfg->RemoveSuccessorEdges(block);
   Instruction* merge_inst = block->GetMergeInst();
   Instruction* terminator = block->terminator();
   if (merge_inst && merge_inst->opcode() == SpvOpSelectionMerge) {
@@ -231,6 +233,7 @@ void DeadBranchElimPass::SimplifyBranch(BasicBlock* block,
     AddBranch(live_lab_id, block);
     context()->KillInst(terminator);
   }
+  cfg->AddEdges(block);
 }
 
 void DeadBranchElimPass::MarkUnreachableStructuredTargets(
@@ -367,6 +370,7 @@ bool DeadBranchElimPass::EraseDeadBlocks(
     const std::unordered_set<BasicBlock*>& unreachable_merges,
     const std::unordered_map<BasicBlock*, BasicBlock*>& unreachable_continues) {
   bool modified = false;
+  CFG* cfg = context()->cfg();
   for (auto ebi = func->begin(); ebi != func->end();) {
     if (unreachable_continues.count(&*ebi)) {
       uint32_t cont_id = unreachable_continues.find(&*ebi)->second->id();
@@ -374,6 +378,7 @@ bool DeadBranchElimPass::EraseDeadBlocks(
           ebi->terminator()->opcode() != SpvOpBranch ||
           ebi->terminator()->GetSingleWordInOperand(0u) != cont_id) {
         // Make unreachable, but leave the label.
+        cfg->RemoveSuccessorEdges(&*ebi);
         KillAllInsts(&*ebi, false);
         // Add unconditional branch to header.
         assert(unreachable_continues.count(&*ebi));
@@ -382,6 +387,7 @@ bool DeadBranchElimPass::EraseDeadBlocks(
             std::initializer_list<Operand>{{SPV_OPERAND_TYPE_ID, {cont_id}}}));
         get_def_use_mgr()->AnalyzeInstUse(&*ebi->tail());
         context()->set_instr_block(&*ebi->tail(), &*ebi);
+        cfg->AddEdge(ebi->id(), cont_id);
         modified = true;
       }
       ++ebi;
@@ -389,6 +395,7 @@ bool DeadBranchElimPass::EraseDeadBlocks(
       if (ebi->begin() != ebi->tail() ||
           ebi->terminator()->opcode() != SpvOpUnreachable) {
         // Make unreachable, but leave the label.
+        cfg->RemoveSuccessorEdges(&*ebi);
         KillAllInsts(&*ebi, false);
         // Add unreachable terminator.
         ebi->AddInstruction(
@@ -401,6 +408,7 @@ bool DeadBranchElimPass::EraseDeadBlocks(
       ++ebi;
     } else if (!live_blocks.count(&*ebi)) {
       // Kill this block.
+      cfg->ForgetBlock(&*ebi);
       KillAllInsts(&*ebi);
       ebi = ebi.Erase();
       modified = true;
@@ -478,7 +486,14 @@ Pass::Status DeadBranchElimPass::Process() {
     if (ai.opcode() == SpvOpGroupDecorate) return Status::SuccessWithoutChange;
   // Process all entry point functions
   ProcessFunction pfn = [this](Function* fp) {
-    return EliminateDeadBranches(fp);
+    if (!ShouldProcessFunction(fp) || !EliminateDeadBranches(fp)) {
+      return false;
+    }
+    // The CFG is kept up to date, but the dominators of |fp| changed.
+    context()->RemoveDominatorAnalysis(fp);
+    context()->RemovePostDominatorAnalysis(fp);
+    RecordChangedFunction(fp);
+    return true;
   };
   bool modified = context()->ProcessReachableCallTree(pfn);
   if (modified) FixBlockOrder();
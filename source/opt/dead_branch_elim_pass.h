@@ -41,12 +41,14 @@ class DeadBranchElimPass : public MemPass {
   DeadBranchElimPass() = default;
 
   const char* name() const override { return "eliminate-dead-branches"; }
+  bool IsFunctionLocal() const override { return true; }
   Status Process() override;
 
   IRContext::Analysis GetPreservedAnalyses() override {
     return IRContext::kAnalysisDefUse |
            IRContext::kAnalysisInstrToBlockMapping |
-           IRContext::kAnalysisConstants | IRContext::kAnalysisTypes;
+           IRContext::kAnalysisConstants | IRContext::kAnalysisTypes |
+           IRContext::kAnalysisCFG;
   }
 
  private:
@@ -0,0 +1,97 @@
+// Copyright (c) 2019 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "source/opt/debug_line_table.h"
+
+#include <algorithm>
+
+#include "source/util/hash_combine.h"
+
+namespace spvtools {
+namespace opt {
+namespace {
+
+// The number of words of an OpLine and of an OpNoLine.
+const uint32_t kLineWords = 4;
+const uint32_t kNoLineWords = 1;
+
+}  // namespace
+
+DebugLineTable::DebugLineTable() : sequences_(1, Sequence{0, 0}) {
+  indices_.emplace(Hash(nullptr, 0), kNoLines);
+}
+
+uint32_t DebugLineTable::Intern(const DebugLine* lines, size_t count) {
+  if (count == 0) return kNoLines;
+  const size_t hash = Hash(lines, count);
+  auto range = indices_.equal_range(hash);
+  for (auto it = range.first; it != range.second; ++it) {
+    const uint32_t index = it->second;
+    if (NumLines(index) == count &&
+        std::equal(lines, lines + count, begin(index))) {
+      return index;
+    }
+  }
+
+  const uint32_t index = static_cast<uint32_t>(sequences_.size());
+  sequences_.push_back(Sequence{static_cast<uint32_t>(lines_.size()),
+                                static_cast<uint32_t>(count)});
+  lines_.insert(lines_.end(), lines, lines + count);
+  indices_.emplace(hash, index);
+  return index;
+}
+
+uint32_t DebugLineTable::Concat(uint32_t index, uint32_t other) {
+  if (other == kNoLines) return index;
+  if (index == kNoLines) return other;
+  std::vector<DebugLine> lines = Lines(index);
+  lines.insert(lines.end(), begin(other), end(other));
+  return Intern(lines);
+}
+
+uint32_t DebugLineTable::NumWords(uint32_t index) const {
+  uint32_t num_words = 0;
+  for (const DebugLine* line = begin(index); line != end(index); ++line) {
+    num_words += line->opcode == SpvOpLine ? kLineWords : kNoLineWords;
+  }
+  return num_words;
+}
+
+uint32_t* DebugLineTable::ToBinary(uint32_t index, uint32_t* words) const {
+  for (const DebugLine* line = begin(index); line != end(index); ++line) {
+    if (line->opcode == SpvOpLine) {
+      *words++ = (kLineWords << 16) | SpvOpLine;
+      *words++ = line->file_id;
+      *words++ = line->line;
+      *words++ = line->column;
+    } else {
+      *words++ = (kNoLineWords << 16) | SpvOpNoLine;
+    }
+  }
+  return words;
+}
+
+size_t DebugLineTable::Hash(const DebugLine* lines, size_t count) {
+  size_t hash = count;
+  for (size_t i = 0; i < count; ++i) {
+    const uint32_t fields[] = {static_cast<uint32_t>(lines[i].opcode),
+                               lines[i].file_id, lines[i].line,
+                               lines[i].column};
+    for (uint32_t field : fields) utils::HashCombine(field, &hash);
+  }
+  return hash;
+}
+
+}  // namespace opt
+}  // namespace spvtools
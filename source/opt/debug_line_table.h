@@ -0,0 +1,115 @@
+// Copyright (c) 2019 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef SOURCE_OPT_DEBUG_LINE_TABLE_H_
+#define SOURCE_OPT_DEBUG_LINE_TABLE_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+#include "source/latest_version_spirv_header.h"
+
+namespace spvtools {
+namespace opt {
+
+// A debug line instruction: OpLine with its file id, line and column, or
+// OpNoLine, whose other fields are 0.
+struct DebugLine {
+  static DebugLine NoLine() { return {SpvOpNoLine, 0, 0, 0}; }
+
+  bool operator==(const DebugLine& that) const {
+    return opcode == that.opcode && file_id == that.file_id &&
+           line == that.line && column == that.column;
+  }
+  bool operator!=(const DebugLine& that) const { return !(*this == that); }
+
+  SpvOp opcode;
+  uint32_t file_id;
+  uint32_t line;
+  uint32_t column;
+};
+
+// The debug line instructions attached to the instructions of a module.
+//
+// The instructions of a module compiled with debug info nearly all have the
+// same few lines ahead of them, so the sequences of lines are interned: an
+// instruction only holds the index of its sequence in this table, and the
+// lines are written out again when the module is serialized.  Sequences are
+// never removed, so changing the lines of an instruction adds to the table.
+class DebugLineTable {
+ public:
+  // The index of the empty sequence, which every table has.
+  static const uint32_t kNoLines = 0;
+
+  DebugLineTable();
+
+  // Returns the index of the sequence of the |count| lines at |lines|, adding
+  // it to the table if it is not there yet.  |lines| must not point into the
+  // table.
+  uint32_t Intern(const DebugLine* lines, size_t count);
+  uint32_t Intern(const std::vector<DebugLine>& lines) {
+    return Intern(lines.data(), lines.size());
+  }
+
+  // Returns the index of the sequence |index| followed by the lines of the
+  // sequence |other|.
+  uint32_t Concat(uint32_t index, uint32_t other);
+
+  // Returns the number of lines in the sequence |index|.
+  uint32_t NumLines(uint32_t index) const { return sequences_[index].count; }
+
+  // Returns the first line of the sequence |index|, and the one past its end.
+  const DebugLine* begin(uint32_t index) const {
+    return lines_.data() + sequences_[index].begin;
+  }
+  const DebugLine* end(uint32_t index) const {
+    return begin(index) + NumLines(index);
+  }
+
+  // Returns the lines of the sequence |index|.
+  std::vector<DebugLine> Lines(uint32_t index) const {
+    return std::vector<DebugLine>(begin(index), end(index));
+  }
+
+  // Returns the number of words the sequence |index| takes in a binary.
+  uint32_t NumWords(uint32_t index) const;
+
+  // Writes the sequence |index| to |words|, which must have room for
+  // NumWords(index) words.  Returns the word after the last one written.
+  uint32_t* ToBinary(uint32_t index, uint32_t* words) const;
+
+ private:
+  // The place of a sequence in |lines_|.
+  struct Sequence {
+    uint32_t begin;
+    uint32_t count;
+  };
+
+  // Returns the hash of the |count| lines at |lines|.
+  static size_t Hash(const DebugLine* lines, size_t count);
+
+  // The lines of all the sequences, one after the other.
+  std::vector<DebugLine> lines_;
+  // The sequences, by index.
+  std::vector<Sequence> sequences_;
+  // The indices of the sequences, by the hash of their lines.
+  std::unordered_multimap<size_t, uint32_t> indices_;
+};
+
+}  // namespace opt
+}  // namespace spvtools
+
+#endif  // SOURCE_OPT_DEBUG_LINE_TABLE_H_
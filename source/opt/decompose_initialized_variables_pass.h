@@ -35,6 +35,7 @@ class DecomposeInitializedVariablesPass : public Pass {
     return "decompose-initialized-variables";
   }
   Status Process() override;
+  bool IsRequired() const override { return true; }
 
   IRContext::Analysis GetPreservedAnalyses() override {
     return IRContext::kAnalysisInstrToBlockMapping |
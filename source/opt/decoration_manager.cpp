@@ -16,7 +16,6 @@
 
 #include <algorithm>
 #include <memory>
-#include <set>
 #include <stack>
 #include <utility>
 
@@ -24,28 +23,45 @@
 
 namespace {
 using InstructionVector = std::vector<const spvtools::opt::Instruction*>;
-using DecorationSet = std::set<std::u32string>;
 
-// Returns true if |a| is a subet of |b|.
-bool IsSubset(const DecorationSet& a, const DecorationSet& b) {
-  auto it1 = a.begin();
-  auto it2 = b.begin();
-
-  while (it1 != a.end()) {
-    if (it2 == b.end() || *it1 < *it2) {
-      // |*it1| is in |a|, but not in |b|.
-      return false;
+// Compares the decorations |a| and |b| by opcode, then by the words of their
+// operands after the target.  Returns a negative value, 0 or a positive value
+// as |a| orders before, the same as, or after |b|.
+int CompareDecorations(const spvtools::opt::Instruction* a,
+                       const spvtools::opt::Instruction* b) {
+  if (a->opcode() != b->opcode()) return a->opcode() < b->opcode() ? -1 : 1;
+  uint32_t a_operand = 1u;
+  uint32_t b_operand = 1u;
+  size_t a_word = 0;
+  size_t b_word = 0;
+  while (true) {
+    while (a_operand < a->NumInOperands() &&
+           a_word == a->GetInOperand(a_operand).words.size()) {
+      ++a_operand;
+      a_word = 0;
     }
-    if (*it1 == *it2) {
-      // Found the element move to the next one.
-      it1++;
-      it2++;
-    } else /* *it1 > *it2 */ {
-      // Did not find |*it1| yet, check the next element in |b|.
-      it2++;
+    while (b_operand < b->NumInOperands() &&
+           b_word == b->GetInOperand(b_operand).words.size()) {
+      ++b_operand;
+      b_word = 0;
     }
+    const bool a_done = a_operand == a->NumInOperands();
+    const bool b_done = b_operand == b->NumInOperands();
+    if (a_done || b_done) return a_done == b_done ? 0 : (a_done ? -1 : 1);
+    const uint32_t a_value = a->GetInOperand(a_operand).words[a_word++];
+    const uint32_t b_value = b->GetInOperand(b_operand).words[b_word++];
+    if (a_value != b_value) return a_value < b_value ? -1 : 1;
   }
-  return true;
+}
+
+bool DecorationLess(const spvtools::opt::Instruction* a,
+                    const spvtools::opt::Instruction* b) {
+  return CompareDecorations(a, b) < 0;
+}
+
+bool DecorationEqual(const spvtools::opt::Instruction* a,
+                     const spvtools::opt::Instruction* b) {
+  return CompareDecorations(a, b) == 0;
 }
 }  // namespace
 
@@ -55,6 +71,7 @@ namespace analysis {
 
 void DecorationManager::RemoveDecorationsFrom(
     uint32_t id, std::function<bool(const Instruction&)> pred) {
+  LoadDecorationsWithGroups(id);
   const auto ids_iter = id_to_decoration_insts_.find(id);
   if (ids_iter == id_to_decoration_insts_.end()) {
     return;
@@ -185,137 +202,49 @@ std::vector<const Instruction*> DecorationManager::GetDecorationsFor(
       ->InternalGetDecorationsFor<const Instruction*>(id, include_linkage);
 }
 
+std::vector<const Instruction*> DecorationManager::GetComparableDecorations(
+    uint32_t id) const {
+  // Only OpDecorate, OpDecorateId, OpDecorateStringGOOGLE, and
+  // OpMemberDecorate are considered, the other opcodes are ignored.
+  InstructionVector decorations;
+  WhileEachDecorationOf(id, false, [&decorations](const Instruction* inst) {
+    switch (inst->opcode()) {
+      case SpvOpDecorate:
+      case SpvOpMemberDecorate:
+      case SpvOpDecorateId:
+      case SpvOpDecorateStringGOOGLE:
+        decorations.push_back(inst);
+        break;
+      default:
+        break;
+    }
+    return true;
+  });
+  std::sort(decorations.begin(), decorations.end(), DecorationLess);
+  decorations.erase(
+      std::unique(decorations.begin(), decorations.end(), DecorationEqual),
+      decorations.end());
+  return decorations;
+}
+
 bool DecorationManager::HaveTheSameDecorations(uint32_t id1,
                                                uint32_t id2) const {
-  const InstructionVector decorations_for1 = GetDecorationsFor(id1, false);
-  const InstructionVector decorations_for2 = GetDecorationsFor(id2, false);
-
-  // This function splits the decoration instructions into different sets,
-  // based on their opcode; only OpDecorate, OpDecorateId,
-  // OpDecorateStringGOOGLE, and OpMemberDecorate are considered, the other
-  // opcodes are ignored.
-  const auto fillDecorationSets =
-      [](const InstructionVector& decoration_list, DecorationSet* decorate_set,
-         DecorationSet* decorate_id_set, DecorationSet* decorate_string_set,
-         DecorationSet* member_decorate_set) {
-        for (const Instruction* inst : decoration_list) {
-          std::u32string decoration_payload;
-          // Ignore the opcode and the target as we do not want them to be
-          // compared.
-          for (uint32_t i = 1u; i < inst->NumInOperands(); ++i) {
-            for (uint32_t word : inst->GetInOperand(i).words) {
-              decoration_payload.push_back(word);
-            }
-          }
-
-          switch (inst->opcode()) {
-            case SpvOpDecorate:
-              decorate_set->emplace(std::move(decoration_payload));
-              break;
-            case SpvOpMemberDecorate:
-              member_decorate_set->emplace(std::move(decoration_payload));
-              break;
-            case SpvOpDecorateId:
-              decorate_id_set->emplace(std::move(decoration_payload));
-              break;
-            case SpvOpDecorateStringGOOGLE:
-              decorate_string_set->emplace(std::move(decoration_payload));
-              break;
-            default:
-              break;
-          }
-        }
-      };
-
-  DecorationSet decorate_set_for1;
-  DecorationSet decorate_id_set_for1;
-  DecorationSet decorate_string_set_for1;
-  DecorationSet member_decorate_set_for1;
-  fillDecorationSets(decorations_for1, &decorate_set_for1,
-                     &decorate_id_set_for1, &decorate_string_set_for1,
-                     &member_decorate_set_for1);
-
-  DecorationSet decorate_set_for2;
-  DecorationSet decorate_id_set_for2;
-  DecorationSet decorate_string_set_for2;
-  DecorationSet member_decorate_set_for2;
-  fillDecorationSets(decorations_for2, &decorate_set_for2,
-                     &decorate_id_set_for2, &decorate_string_set_for2,
-                     &member_decorate_set_for2);
-
-  const bool result = decorate_set_for1 == decorate_set_for2 &&
-                      decorate_id_set_for1 == decorate_id_set_for2 &&
-                      member_decorate_set_for1 == member_decorate_set_for2 &&
-                      // Compare string sets last in case the strings are long.
-                      decorate_string_set_for1 == decorate_string_set_for2;
-  return result;
+  if (!HasDecorations(id1, false)) return !HasDecorations(id2, false);
+  const InstructionVector decorations_for1 = GetComparableDecorations(id1);
+  const InstructionVector decorations_for2 = GetComparableDecorations(id2);
+  return decorations_for1.size() == decorations_for2.size() &&
+         std::equal(decorations_for1.begin(), decorations_for1.end(),
+                    decorations_for2.begin(), DecorationEqual);
 }
 
 bool DecorationManager::HaveSubsetOfDecorations(uint32_t id1,
                                                 uint32_t id2) const {
-  const InstructionVector decorations_for1 = GetDecorationsFor(id1, false);
-  const InstructionVector decorations_for2 = GetDecorationsFor(id2, false);
-
-  // This function splits the decoration instructions into different sets,
-  // based on their opcode; only OpDecorate, OpDecorateId,
-  // OpDecorateStringGOOGLE, and OpMemberDecorate are considered, the other
-  // opcodes are ignored.
-  const auto fillDecorationSets =
-      [](const InstructionVector& decoration_list, DecorationSet* decorate_set,
-         DecorationSet* decorate_id_set, DecorationSet* decorate_string_set,
-         DecorationSet* member_decorate_set) {
-        for (const Instruction* inst : decoration_list) {
-          std::u32string decoration_payload;
-          // Ignore the opcode and the target as we do not want them to be
-          // compared.
-          for (uint32_t i = 1u; i < inst->NumInOperands(); ++i) {
-            for (uint32_t word : inst->GetInOperand(i).words) {
-              decoration_payload.push_back(word);
-            }
-          }
-
-          switch (inst->opcode()) {
-            case SpvOpDecorate:
-              decorate_set->emplace(std::move(decoration_payload));
-              break;
-            case SpvOpMemberDecorate:
-              member_decorate_set->emplace(std::move(decoration_payload));
-              break;
-            case SpvOpDecorateId:
-              decorate_id_set->emplace(std::move(decoration_payload));
-              break;
-            case SpvOpDecorateStringGOOGLE:
-              decorate_string_set->emplace(std::move(decoration_payload));
-              break;
-            default:
-              break;
-          }
-        }
-      };
-
-  DecorationSet decorate_set_for1;
-  DecorationSet decorate_id_set_for1;
-  DecorationSet decorate_string_set_for1;
-  DecorationSet member_decorate_set_for1;
-  fillDecorationSets(decorations_for1, &decorate_set_for1,
-                     &decorate_id_set_for1, &decorate_string_set_for1,
-                     &member_decorate_set_for1);
-
-  DecorationSet decorate_set_for2;
-  DecorationSet decorate_id_set_for2;
-  DecorationSet decorate_string_set_for2;
-  DecorationSet member_decorate_set_for2;
-  fillDecorationSets(decorations_for2, &decorate_set_for2,
-                     &decorate_id_set_for2, &decorate_string_set_for2,
-                     &member_decorate_set_for2);
-
-  const bool result =
-      IsSubset(decorate_set_for1, decorate_set_for2) &&
-      IsSubset(decorate_id_set_for1, decorate_id_set_for2) &&
-      IsSubset(member_decorate_set_for1, member_decorate_set_for2) &&
-      // Compare string sets last in case the strings are long.
-      IsSubset(decorate_string_set_for1, decorate_string_set_for2);
-  return result;
+  if (!HasDecorations(id1, false)) return true;
+  const InstructionVector decorations_for1 = GetComparableDecorations(id1);
+  const InstructionVector decorations_for2 = GetComparableDecorations(id2);
+  return std::includes(decorations_for2.begin(), decorations_for2.end(),
+                       decorations_for1.begin(), decorations_for1.end(),
+                       DecorationLess);
 }
 
 // TODO(pierremoreau): If OpDecorateId is referencing an OpConstant, one could
@@ -347,13 +276,104 @@ bool DecorationManager::AreDecorationsTheSame(const Instruction* inst1,
 void DecorationManager::AnalyzeDecorations() {
   if (!module_) return;
 
-  // For each group and instruction, collect all their decoration instructions.
+  // For each group and instruction, index all their decoration instructions.
   for (Instruction& inst : module_->annotations()) {
-    AddDecoration(&inst);
+    switch (inst.opcode()) {
+      case SpvOpDecorate:
+      case SpvOpDecorateId:
+      case SpvOpDecorateStringGOOGLE:
+      case SpvOpMemberDecorate:
+        index_.push_back(
+            {inst.GetSingleWordInOperand(0u), IndexKind::kDirect, &inst});
+        break;
+      case SpvOpGroupDecorate:
+      case SpvOpGroupMemberDecorate: {
+        const uint32_t start = inst.opcode() == SpvOpGroupDecorate ? 1u : 2u;
+        const uint32_t stride = start;
+        for (uint32_t i = start; i < inst.NumInOperands(); i += stride) {
+          index_.push_back(
+              {inst.GetSingleWordInOperand(i), IndexKind::kIndirect, &inst});
+        }
+        index_.push_back(
+            {inst.GetSingleWordInOperand(0u), IndexKind::kGroup, &inst});
+        break;
+      }
+      default:
+        break;
+    }
+  }
+  std::stable_sort(index_.begin(), index_.end(),
+                   [](const IndexEntry& lhs, const IndexEntry& rhs) {
+                     return lhs.id < rhs.id;
+                   });
+}
+
+void DecorationManager::LoadDecorations(uint32_t id) {
+  if (index_.empty()) return;
+  auto entry = std::lower_bound(
+      index_.begin(), index_.end(), id,
+      [](const IndexEntry& e, uint32_t value) { return e.id < value; });
+  for (; entry != index_.end() && entry->id == id; ++entry) {
+    if (entry->inst == nullptr) continue;
+    TargetData& target_data = id_to_decoration_insts_[id];
+    switch (entry->kind) {
+      case IndexKind::kDirect:
+        target_data.direct_decorations.push_back(entry->inst);
+        break;
+      case IndexKind::kIndirect:
+        target_data.indirect_decorations.push_back(entry->inst);
+        break;
+      case IndexKind::kGroup:
+        target_data.decorate_insts.push_back(entry->inst);
+        break;
+    }
+    entry->inst = nullptr;
+  }
+}
+
+void DecorationManager::LoadDecorationsWithGroups(uint32_t id) {
+  LoadDecorations(id);
+  const auto ids_iter = id_to_decoration_insts_.find(id);
+  if (ids_iter == id_to_decoration_insts_.end()) return;
+  // Copy the groups, since loading them may rehash the map.
+  std::vector<uint32_t> group_ids;
+  for (const Instruction* inst : ids_iter->second.indirect_decorations) {
+    group_ids.push_back(inst->GetSingleWordInOperand(0u));
+  }
+  for (uint32_t group_id : group_ids) LoadDecorations(group_id);
+}
+
+void DecorationManager::LoadDecorationsOf(const Instruction* inst) {
+  switch (inst->opcode()) {
+    case SpvOpDecorate:
+    case SpvOpDecorateId:
+    case SpvOpDecorateStringGOOGLE:
+    case SpvOpMemberDecorate:
+      LoadDecorations(inst->GetSingleWordInOperand(0u));
+      break;
+    case SpvOpGroupDecorate:
+    case SpvOpGroupMemberDecorate: {
+      const uint32_t start = inst->opcode() == SpvOpGroupDecorate ? 1u : 2u;
+      const uint32_t stride = start;
+      for (uint32_t i = start; i < inst->NumInOperands(); i += stride) {
+        LoadDecorations(inst->GetSingleWordInOperand(i));
+      }
+      LoadDecorations(inst->GetSingleWordInOperand(0u));
+      break;
+    }
+    default:
+      break;
   }
 }
 
+void DecorationManager::LoadAllDecorations() {
+  for (const IndexEntry& entry : index_) LoadDecorations(entry.id);
+  index_.clear();
+}
+
 void DecorationManager::AddDecoration(Instruction* inst) {
+  // The decorations already in the index come first.
+  LoadDecorationsOf(inst);
   switch (inst->opcode()) {
     case SpvOpDecorate:
     case SpvOpDecorateId:
@@ -422,60 +442,77 @@ template <typename T>
 std::vector<T> DecorationManager::InternalGetDecorationsFor(
     uint32_t id, bool include_linkage) {
   std::vector<T> decorations;
+  WhileEachDecorationOf(id, include_linkage,
+                        [&decorations](Instruction* inst) {
+                          decorations.push_back(inst);
+                          return true;
+                        });
+  return decorations;
+}
 
+bool DecorationManager::WhileEachDecorationOf(
+    uint32_t id, bool include_linkage,
+    const std::function<bool(Instruction*)>& f) {
+  LoadDecorationsWithGroups(id);
   const auto ids_iter = id_to_decoration_insts_.find(id);
   // |id| has no decorations
-  if (ids_iter == id_to_decoration_insts_.end()) return decorations;
-
-  const TargetData& target_data = ids_iter->second;
+  if (ids_iter == id_to_decoration_insts_.end()) return true;
 
-  const auto process_direct_decorations =
+  const auto while_each_direct_decoration =
       [include_linkage,
-       &decorations](const std::vector<Instruction*>& direct_decorations) {
+       &f](const std::vector<Instruction*>& direct_decorations) {
         for (Instruction* inst : direct_decorations) {
           const bool is_linkage = inst->opcode() == SpvOpDecorate &&
                                   inst->GetSingleWordInOperand(1u) ==
                                       SpvDecorationLinkageAttributes;
-          if (include_linkage || !is_linkage) decorations.push_back(inst);
+          if ((include_linkage || !is_linkage) && !f(inst)) return false;
         }
+        return true;
       };
 
   // Process |id|'s decorations.
-  process_direct_decorations(ids_iter->second.direct_decorations);
+  if (!while_each_direct_decoration(ids_iter->second.direct_decorations)) {
+    return false;
+  }
 
   // Process the decorations of all groups applied to |id|.
-  for (const Instruction* inst : target_data.indirect_decorations) {
+  for (const Instruction* inst : ids_iter->second.indirect_decorations) {
     const uint32_t group_id = inst->GetSingleWordInOperand(0u);
     const auto group_iter = id_to_decoration_insts_.find(group_id);
     assert(group_iter != id_to_decoration_insts_.end() && "Unknown group ID");
-    process_direct_decorations(group_iter->second.direct_decorations);
+    if (!while_each_direct_decoration(group_iter->second.direct_decorations)) {
+      return false;
+    }
   }
+  return true;
+}
 
-  return decorations;
+bool DecorationManager::WhileEachDecorationOf(
+    uint32_t id, bool include_linkage,
+    const std::function<bool(const Instruction*)>& f) const {
+  return const_cast<DecorationManager*>(this)->WhileEachDecorationOf(
+      id, include_linkage, [&f](Instruction* inst) { return f(inst); });
 }
 
 bool DecorationManager::WhileEachDecoration(
     uint32_t id, uint32_t decoration,
     std::function<bool(const Instruction&)> f) {
-  for (const Instruction* inst : GetDecorationsFor(id, true)) {
-    switch (inst->opcode()) {
-      case SpvOpMemberDecorate:
-        if (inst->GetSingleWordInOperand(2) == decoration) {
-          if (!f(*inst)) return false;
+  return WhileEachDecorationOf(
+      id, true, [decoration, &f](Instruction* inst) {
+        switch (inst->opcode()) {
+          case SpvOpMemberDecorate:
+            if (inst->GetSingleWordInOperand(2) == decoration) return f(*inst);
+            break;
+          case SpvOpDecorate:
+          case SpvOpDecorateId:
+          case SpvOpDecorateStringGOOGLE:
+            if (inst->GetSingleWordInOperand(1) == decoration) return f(*inst);
+            break;
+          default:
+            assert(false && "Unexpected decoration instruction");
         }
-        break;
-      case SpvOpDecorate:
-      case SpvOpDecorateId:
-      case SpvOpDecorateStringGOOGLE:
-        if (inst->GetSingleWordInOperand(1) == decoration) {
-          if (!f(*inst)) return false;
-        }
-        break;
-      default:
-        assert(false && "Unexpected decoration instruction");
-    }
-  }
-  return true;
+        return true;
+      });
 }
 
 void DecorationManager::ForEachDecoration(
@@ -488,6 +525,8 @@ void DecorationManager::ForEachDecoration(
 }
 
 void DecorationManager::CloneDecorations(uint32_t from, uint32_t to) {
+  LoadDecorationsWithGroups(from);
+  LoadDecorations(to);
   const auto decoration_list = id_to_decoration_insts_.find(from);
   if (decoration_list == id_to_decoration_insts_.end()) return;
   auto context = module_->context();
@@ -537,6 +576,8 @@ void DecorationManager::CloneDecorations(uint32_t from, uint32_t to) {
 void DecorationManager::CloneDecorations(
     uint32_t from, uint32_t to,
     const std::vector<SpvDecoration>& decorations_to_copy) {
+  LoadDecorationsWithGroups(from);
+  LoadDecorations(to);
   const auto decoration_list = id_to_decoration_insts_.find(from);
   if (decoration_list == id_to_decoration_insts_.end()) return;
   auto context = module_->context();
@@ -580,6 +621,9 @@ void DecorationManager::RemoveDecoration(Instruction* inst) {
     v.erase(std::remove(v.begin(), v.end(), inst), v.end());
   };
 
+  // Otherwise |inst| would be analyzed from the index later.
+  LoadDecorationsOf(inst);
+
   switch (inst->opcode()) {
     case SpvOpDecorate:
     case SpvOpDecorateId:
@@ -610,6 +654,9 @@ void DecorationManager::RemoveDecoration(Instruction* inst) {
 }
 
 bool operator==(const DecorationManager& lhs, const DecorationManager& rhs) {
+  // Loading the decorations does not change the result of the queries.
+  const_cast<DecorationManager&>(lhs).LoadAllDecorations();
+  const_cast<DecorationManager&>(rhs).LoadAllDecorations();
   return lhs.id_to_decoration_insts_ == rhs.id_to_decoration_insts_;
 }
 
@@ -30,7 +30,12 @@ namespace analysis {
 // A class for analyzing and managing decorations in an Module.
 class DecorationManager {
  public:
-  // Constructs a decoration manager from the given |module|
+  // Constructs a decoration manager from the given |module|.  Only an index of
+  // the annotations sorted by id is built up front.  The decorations of each
+  // id are analyzed from the index when the id is first queried or changed,
+  // so that querying a few ids does not pay for all the annotations.  A query
+  // may therefore change the manager: threads may only query it concurrently
+  // after |LoadAllDecorations| has been called.
   explicit DecorationManager(Module* module) : module_(module) {
     AnalyzeDecorations();
   }
@@ -70,6 +75,24 @@ class DecorationManager {
                                               bool include_linkage);
   std::vector<const Instruction*> GetDecorationsFor(uint32_t id,
                                                     bool include_linkage) const;
+
+  // |f| is run on each decoration affecting |id|, in the order of
+  // GetDecorationsFor, without making a vector of them.  If |f| returns
+  // false, iteration is terminated and this function returns false.  |f|
+  // must not change the decorations of |id|.
+  bool WhileEachDecorationOf(uint32_t id, bool include_linkage,
+                             const std::function<bool(Instruction*)>& f);
+  bool WhileEachDecorationOf(
+      uint32_t id, bool include_linkage,
+      const std::function<bool(const Instruction*)>& f) const;
+
+  // Returns true if a decoration affects |id|.  Linkage decorations only
+  // count if |include_linkage| is set.
+  bool HasDecorations(uint32_t id, bool include_linkage) const {
+    return !WhileEachDecorationOf(id, include_linkage,
+                                  [](const Instruction*) { return false; });
+  }
+
   // Returns whether two IDs have the same decorations. Two SpvOpGroupDecorate
   // instructions that apply the same decorations but to different IDs, still
   // count as being the same.
@@ -131,6 +154,10 @@ class DecorationManager {
   void AddMemberDecoration(uint32_t member, uint32_t inst_id,
                            uint32_t decoration, uint32_t decoration_value);
 
+  // Analyzes the decorations of all the ids in the index.  Queries no longer
+  // change the manager afterwards, so they may run concurrently.
+  void LoadAllDecorations();
+
   friend bool operator==(const DecorationManager&, const DecorationManager&);
   friend bool operator!=(const DecorationManager& lhs,
                          const DecorationManager& rhs) {
@@ -138,13 +165,27 @@ class DecorationManager {
   }
 
  private:
-  // Analyzes the defs and uses in the given |module| and populates data
-  // structures in this class. Does nothing if |module| is nullptr.
+  // Builds the index of the annotations of the given |module| by id. Does
+  // nothing if |module| is nullptr.
   void AnalyzeDecorations();
 
+  // Analyzes the decorations of |id| from the index, if it was not done yet.
+  // Must be called before the decorations of |id| are read or changed.
+  void LoadDecorations(uint32_t id);
+
+  // Analyzes the decorations of |id| and of the groups applied to it.
+  void LoadDecorationsWithGroups(uint32_t id);
+
+  // Analyzes the decorations of the ids referenced by the annotation |inst|.
+  void LoadDecorationsOf(const Instruction* inst);
+
   template <typename T>
   std::vector<T> InternalGetDecorationsFor(uint32_t id, bool include_linkage);
 
+  // Returns the decorations of |id| compared by HaveTheSameDecorations,
+  // sorted and without duplicates.
+  std::vector<const Instruction*> GetComparableDecorations(uint32_t id) const;
+
   // Tracks decoration information of an ID.
   struct TargetData {
     std::vector<Instruction*> direct_decorations;    // All decorate
@@ -187,6 +228,29 @@ class DecorationManager {
   // and SpvOpDecorateId), or indirectly (SpvOpGroupDecorate,
   // SpvOpMemberGroupDecorate).
   std::unordered_map<uint32_t, TargetData> id_to_decoration_insts_;
+
+  // How an annotation relates to an id in the index.
+  enum class IndexKind {
+    // The annotation decorates the id.
+    kDirect,
+    // The annotation applies a group to the id.
+    kIndirect,
+    // The annotation applies the id, a group, to other ids.
+    kGroup,
+  };
+
+  // An entry of the index of the annotations.  |inst| is null once the entry
+  // was moved to |id_to_decoration_insts_|.
+  struct IndexEntry {
+    uint32_t id;
+    IndexKind kind;
+    Instruction* inst;
+  };
+
+  // The annotations of the module by id, in module order for each id, whose
+  // ids were not analyzed yet.
+  std::vector<IndexEntry> index_;
+
   // The enclosing module.
   Module* module_;
 };
@@ -14,6 +14,7 @@
 
 #include "source/opt/def_use_manager.h"
 
+#include <algorithm>
 #include <iostream>
 
 #include "source/opt/log.h"
@@ -26,13 +27,15 @@ namespace analysis {
 void DefUseManager::AnalyzeInstDef(Instruction* inst) {
   const uint32_t def_id = inst->result_id();
   if (def_id != 0) {
-    auto iter = id_to_def_.find(def_id);
-    if (iter != id_to_def_.end()) {
+    Instruction* old_def = GetDef(def_id);
+    if (old_def != nullptr) {
       // Clear the original instruction that defining the same result id of the
       // new instruction.
-      ClearInst(iter->second);
+      ClearInst(old_def);
+      // The users recorded so far are the users of the original instruction.
+      if (old_def != inst) ClearUsers(def_id);
     }
-    id_to_def_[def_id] = inst;
+    SetDef(def_id, inst);
   } else {
     ClearInst(inst);
   }
@@ -42,6 +45,7 @@ void DefUseManager::AnalyzeInstUse(Instruction* inst) {
   // Create entry for the given instruction. Note that the instruction may
   // not have any in-operands. In such cases, we still need a entry for those
   // instructions so this manager knows it has seen the instruction later.
+  if (changed_insts_) changed_insts_->insert(inst);
   auto* used_ids = &inst_to_used_ids_[inst];
   if (used_ids->size()) {
     EraseUseRecordsOfOperandIds(inst);
@@ -57,9 +61,8 @@ void DefUseManager::AnalyzeInstUse(Instruction* inst) {
       case SPV_OPERAND_TYPE_MEMORY_SEMANTICS_ID:
       case SPV_OPERAND_TYPE_SCOPE_ID: {
         uint32_t use_id = inst->GetSingleWordOperand(i);
-        Instruction* def = GetDef(use_id);
-        assert(def && "Definition is not registered.");
-        id_to_users_.insert(UserEntry(def, inst));
+        assert(GetDef(use_id) && "Definition is not registered.");
+        AddUser(use_id, inst);
         used_ids->push_back(use_id);
       } break;
       default:
@@ -76,8 +79,7 @@ void DefUseManager::AnalyzeInstDefUse(Instruction* inst) {
 void DefUseManager::UpdateDefUse(Instruction* inst) {
   const uint32_t def_id = inst->result_id();
   if (def_id != 0) {
-    auto iter = id_to_def_.find(def_id);
-    if (iter == id_to_def_.end()) {
+    if (GetDef(def_id) == nullptr) {
       AnalyzeInstDef(inst);
     }
   }
@@ -85,32 +87,123 @@ void DefUseManager::UpdateDefUse(Instruction* inst) {
 }
 
 Instruction* DefUseManager::GetDef(uint32_t id) {
-  auto iter = id_to_def_.find(id);
-  if (iter == id_to_def_.end()) return nullptr;
-  return iter->second;
+  return id < id_to_def_.size() ? id_to_def_[id] : nullptr;
 }
 
 const Instruction* DefUseManager::GetDef(uint32_t id) const {
-  const auto iter = id_to_def_.find(id);
-  if (iter == id_to_def_.end()) return nullptr;
-  return iter->second;
+  return id < id_to_def_.size() ? id_to_def_[id] : nullptr;
 }
 
-DefUseManager::IdToUsersMap::const_iterator DefUseManager::UsersBegin(
-    const Instruction* def) const {
-  return id_to_users_.lower_bound(
-      UserEntry(const_cast<Instruction*>(def), nullptr));
+void DefUseManager::SetDef(uint32_t id, Instruction* def) {
+  if (id >= id_to_def_.size()) {
+    if (def == nullptr) return;
+    id_to_def_.resize(id + 1, nullptr);
+  }
+  id_to_def_[id] = def;
+}
+
+const DefUseManager::UserList* DefUseManager::GetUsers(uint32_t id) const {
+  return id < id_to_users_.size() ? &id_to_users_[id] : nullptr;
+}
+
+namespace {
+
+// Orders user slots by the unique id of the user.
+struct UniqueIdLess {
+  template <typename Slot>
+  bool operator()(const Slot& slot, uint32_t unique_id) const {
+    return slot.unique_id < unique_id;
+  }
+  template <typename Slot>
+  bool operator()(uint32_t unique_id, const Slot& slot) const {
+    return unique_id < slot.unique_id;
+  }
+};
+
+}  // namespace
+
+void DefUseManager::AddUser(uint32_t id, Instruction* user) {
+  if (id >= id_to_users_.size()) id_to_users_.resize(id + 1);
+  UserList& users = id_to_users_[id];
+  const uint32_t unique_id = user->unique_id();
+  // Users are mostly recorded in increasing order of unique id.
+  if (users.slots.empty() || users.slots.back().unique_id < unique_id) {
+    users.slots.push_back({unique_id, user});
+    return;
+  }
+  auto iter = std::lower_bound(users.slots.begin(), users.slots.end(),
+                               unique_id, UniqueIdLess());
+  if (iter != users.slots.end() && iter->unique_id == unique_id) {
+    if (iter->user == nullptr) {
+      iter->user = user;
+      --users.num_tombstones;
+    }
+    return;
+  }
+  users.slots.insert(iter, {unique_id, user});
 }
 
-bool DefUseManager::UsersNotEnd(const IdToUsersMap::const_iterator& iter,
-                                const IdToUsersMap::const_iterator& cached_end,
-                                const Instruction* inst) const {
-  return (iter != cached_end && iter->first == inst);
+void DefUseManager::RemoveUser(uint32_t id, const Instruction* user) {
+  if (id >= id_to_users_.size()) return;
+  UserList& users = id_to_users_[id];
+  auto iter = std::lower_bound(users.slots.begin(), users.slots.end(),
+                               user->unique_id(), UniqueIdLess());
+  if (iter == users.slots.end() || iter->unique_id != user->unique_id() ||
+      iter->user == nullptr) {
+    return;
+  }
+  iter->user = nullptr;
+  ++users.num_tombstones;
+  if (2 * users.num_tombstones >= users.slots.size()) CompactUsers(&users);
 }
 
-bool DefUseManager::UsersNotEnd(const IdToUsersMap::const_iterator& iter,
-                                const Instruction* inst) const {
-  return UsersNotEnd(iter, id_to_users_.end(), inst);
+void DefUseManager::ClearUsers(uint32_t id) {
+  if (id >= id_to_users_.size()) return;
+  UserList& users = id_to_users_[id];
+  for (UserSlot& slot : users.slots) slot.user = nullptr;
+  users.num_tombstones = static_cast<uint32_t>(users.slots.size());
+  CompactUsers(&users);
+}
+
+void DefUseManager::CompactUsers(UserList* users) {
+  if (num_iterations_ != 0) return;
+  if (users->num_tombstones == users->slots.size()) {
+    // Release the memory of lists that are emptied, typically those of
+    // killed instructions.
+    std::vector<UserSlot>().swap(users->slots);
+  } else {
+    users->slots.erase(
+        std::remove_if(users->slots.begin(), users->slots.end(),
+                       [](const UserSlot& slot) { return !slot.user; }),
+        users->slots.end());
+  }
+  users->num_tombstones = 0;
+}
+
+bool DefUseManager::WhileEachUserOfId(
+    uint32_t id, const std::function<bool(Instruction*)>& f) const {
+  IterationScope scope(concurrent_reads_ ? nullptr : &num_iterations_);
+  // |f| may add or remove users of |id|, so the list is looked up again after
+  // each call, and the iteration resumes after the last user visited.
+  // Tombstones are kept during the iteration, so the position of that user
+  // only changes if users are inserted before it.
+  size_t next = 0;
+  uint32_t last_unique_id = 0;
+  while (const UserList* users = GetUsers(id)) {
+    const std::vector<UserSlot>& slots = users->slots;
+    if (next > 0 &&
+        (next > slots.size() || slots[next - 1].unique_id != last_unique_id)) {
+      next = static_cast<size_t>(
+          std::upper_bound(slots.begin(), slots.end(), last_unique_id,
+                           UniqueIdLess()) -
+          slots.begin());
+    }
+    if (next == slots.size()) break;
+    const UserSlot slot = slots[next++];
+    last_unique_id = slot.unique_id;
+    if (slot.user != nullptr && !f(slot.user)) return false;
+  }
+  return true;
 }
 
 bool DefUseManager::WhileEachUser(
@@ -119,12 +212,7 @@ bool DefUseManager::WhileEachUser(
   assert(def && (!def->HasResultId() || def == GetDef(def->result_id())) &&
          "Definition is not registered.");
   if (!def->HasResultId()) return true;
-
-  auto end = id_to_users_.end();
-  for (auto iter = UsersBegin(def); UsersNotEnd(iter, end, def); ++iter) {
-    if (!f(iter->second)) return false;
-  }
-  return true;
+  return WhileEachUserOfId(def->result_id(), f);
 }
 
 bool DefUseManager::WhileEachUser(
@@ -153,19 +241,18 @@ bool DefUseManager::WhileEachUse(
          "Definition is not registered.");
   if (!def->HasResultId()) return true;
 
-  auto end = id_to_users_.end();
-  for (auto iter = UsersBegin(def); UsersNotEnd(iter, end, def); ++iter) {
-    Instruction* user = iter->second;
+  const uint32_t id = def->result_id();
+  return WhileEachUserOfId(id, [id, &f](Instruction* user) {
     for (uint32_t idx = 0; idx != user->NumOperands(); ++idx) {
       const Operand& op = user->GetOperand(idx);
       if (op.type != SPV_OPERAND_TYPE_RESULT_ID && spvIsIdType(op.type)) {
-        if (def->result_id() == op.words[0]) {
+        if (id == op.words[0]) {
           if (!f(user, idx)) return false;
         }
       }
     }
-  }
-  return true;
+    return true;
+  });
 }
 
 bool DefUseManager::WhileEachUse(
@@ -223,25 +310,20 @@ std::vector<Instruction*> DefUseManager::GetAnnotations(uint32_t id) const {
 void DefUseManager::AnalyzeDefUse(Module* module) {
   if (!module) return;
   // Analyze all the defs before any uses to catch forward references.
-  module->ForEachInst(
-      std::bind(&DefUseManager::AnalyzeInstDef, this, std::placeholders::_1));
-  module->ForEachInst(
-      std::bind(&DefUseManager::AnalyzeInstUse, this, std::placeholders::_1));
+  module->ForEachInst([this](Instruction* inst) { AnalyzeInstDef(inst); });
+  module->ForEachInst([this](Instruction* inst) { AnalyzeInstUse(inst); });
 }
 
 void DefUseManager::ClearInst(Instruction* inst) {
+  if (changed_insts_) changed_insts_->erase(inst);
   auto iter = inst_to_used_ids_.find(inst);
   if (iter != inst_to_used_ids_.end()) {
     EraseUseRecordsOfOperandIds(inst);
-    if (inst->result_id() != 0) {
+    const uint32_t result_id = inst->result_id();
+    if (result_id != 0) {
       // Remove all uses of this inst.
-      auto users_begin = UsersBegin(inst);
-      auto end = id_to_users_.end();
-      auto new_end = users_begin;
-      for (; UsersNotEnd(new_end, end, inst); ++new_end) {
-      }
-      id_to_users_.erase(users_begin, new_end);
-      id_to_def_.erase(inst->result_id());
+      if (GetDef(result_id) == inst) ClearUsers(result_id);
+      SetDef(result_id, nullptr);
     }
   }
 }
@@ -252,30 +334,61 @@ void DefUseManager::EraseUseRecordsOfOperandIds(const Instruction* inst) {
   auto iter = inst_to_used_ids_.find(inst);
   if (iter != inst_to_used_ids_.end()) {
     for (auto use_id : iter->second) {
-      id_to_users_.erase(
-          UserEntry(GetDef(use_id), const_cast<Instruction*>(inst)));
+      RemoveUser(use_id, inst);
     }
     inst_to_used_ids_.erase(inst);
   }
 }
 
-bool operator==(const DefUseManager& lhs, const DefUseManager& rhs) {
-  if (lhs.id_to_def_ != rhs.id_to_def_) {
-    return false;
+DefUseManager::IdToDefMap DefUseManager::id_to_defs() const {
+  IdToDefMap defs;
+  for (uint32_t id = 0; id < id_to_def_.size(); ++id) {
+    if (id_to_def_[id] != nullptr) defs[id] = id_to_def_[id];
   }
+  return defs;
+}
 
-  if (lhs.id_to_users_ != rhs.id_to_users_) {
-    for (auto p : lhs.id_to_users_) {
-      if (rhs.id_to_users_.count(p) == 0) {
-        return false;
-      }
+DefUseManager::IdToUsersMap DefUseManager::id_to_users() const {
+  IdToUsersMap users;
+  for (uint32_t id = 0; id < id_to_users_.size(); ++id) {
+    Instruction* def = id < id_to_def_.size() ? id_to_def_[id] : nullptr;
+    if (def == nullptr) continue;
+    for (const UserSlot& slot : id_to_users_[id].slots) {
+      if (slot.user != nullptr) users.insert(UserEntry(def, slot.user));
     }
-    for (auto p : rhs.id_to_users_) {
-      if (lhs.id_to_users_.count(p) == 0) {
-        return false;
-      }
+  }
+  return users;
+}
+
+bool operator==(const DefUseManager& lhs, const DefUseManager& rhs) {
+  const size_t num_ids =
+      std::max(lhs.id_to_def_.size(), rhs.id_to_def_.size());
+  for (uint32_t id = 0; id < num_ids; ++id) {
+    if (lhs.GetDef(id) != rhs.GetDef(id)) {
+      return false;
+    }
+  }
+
+  const size_t num_used_ids =
+      std::max(lhs.id_to_users_.size(), rhs.id_to_users_.size());
+  std::vector<const Instruction*> lhs_users;
+  std::vector<const Instruction*> rhs_users;
+  for (uint32_t id = 0; id < num_used_ids; ++id) {
+    // Users of ids without a definition are never visited.
+    if (lhs.GetDef(id) == nullptr) continue;
+    lhs_users.clear();
+    rhs_users.clear();
+    lhs.WhileEachUserOfId(id, [&lhs_users](Instruction* user) {
+      lhs_users.push_back(user);
+      return true;
+    });
+    rhs.WhileEachUserOfId(id, [&rhs_users](Instruction* user) {
+      rhs_users.push_back(user);
+      return true;
+    });
+    if (lhs_users != rhs_users) {
+      return false;
     }
-    return false;
   }
 
   if (lhs.inst_to_used_ids_ != rhs.inst_to_used_ids_) {
@@ -18,6 +18,7 @@
 #include <list>
 #include <set>
 #include <unordered_map>
+#include <unordered_set>
 #include <utility>
 #include <vector>
 
@@ -195,10 +196,12 @@ class DefUseManager {
   // instructions which decorate the decoration group will not be returned.
   std::vector<Instruction*> GetAnnotations(uint32_t id) const;
 
-  // Returns the map from ids to their def instructions.
-  const IdToDefMap& id_to_defs() const { return id_to_def_; }
-  // Returns the map from instructions to their users.
-  const IdToUsersMap& id_to_users() const { return id_to_users_; }
+  // Returns the map from ids to their def instructions.  The map is built on
+  // each call, so this is meant for testing and debugging only.
+  IdToDefMap id_to_defs() const;
+  // Returns the map from instructions to their users.  The map is built on
+  // each call, so this is meant for testing and debugging only.
+  IdToUsersMap id_to_users() const;
 
   // Clear the internal def-use record of the given instruction |inst|. This
   // method will update the use information of the operand ids of |inst|. The
@@ -219,34 +222,102 @@ class DefUseManager {
   // uses.
   void UpdateDefUse(Instruction* inst);
 
+  // Adds to |*changed| the instructions whose uses are analyzed from now on,
+  // and removes from it the instructions that are cleared.  Stops if |changed|
+  // is nullptr.
+  void RecordChangedInstructions(std::unordered_set<Instruction*>* changed) {
+    changed_insts_ = changed;
+  }
+
+  // Allows several threads to read the manager at once while
+  // |concurrent_reads| is true, by not counting the iterations over users.
+  // Neither the manager nor the users iterated over may change in the
+  // meantime.
+  void set_concurrent_reads(bool concurrent_reads) {
+    concurrent_reads_ = concurrent_reads;
+  }
+
  private:
   using InstToUsedIdsMap =
       std::unordered_map<const Instruction*, std::vector<uint32_t>>;
 
-  // Returns the first location that {|def|, nullptr} could be inserted into the
-  // users map without violating ordering.
-  IdToUsersMap::const_iterator UsersBegin(const Instruction* def) const;
+  // A user of a definition, keyed by the unique id of the user.  A null |user|
+  // is a tombstone left by a removed user.
+  struct UserSlot {
+    uint32_t unique_id;
+    Instruction* user;
+  };
+
+  // The users of a definition, in increasing order of unique id, which is the
+  // order in which they are visited.  Removed users are left as tombstones
+  // while the list is being iterated over, so that positions stay valid, and
+  // the list is compacted once they make up half of it.
+  struct UserList {
+    std::vector<UserSlot> slots;
+    uint32_t num_tombstones = 0;
+  };
+
+  // Counts the iterations over user lists in progress during its lifetime.
+  // Does nothing if |num_iterations| is nullptr.
+  class IterationScope {
+   public:
+    explicit IterationScope(uint32_t* num_iterations)
+        : num_iterations_(num_iterations) {
+      if (num_iterations_) ++*num_iterations_;
+    }
+    ~IterationScope() {
+      if (num_iterations_) --*num_iterations_;
+    }
 
-  // Returns true if |iter| has not reached the end of |def|'s users.
-  //
-  // In the first version |iter| is compared against the end of the map for
-  // validity before other checks. In the second version, |iter| is compared
-  // against |cached_end| for validity before other checks. This allows caching
-  // the map's end which is a performance improvement on some platforms.
-  bool UsersNotEnd(const IdToUsersMap::const_iterator& iter,
-                   const Instruction* def) const;
-  bool UsersNotEnd(const IdToUsersMap::const_iterator& iter,
-                   const IdToUsersMap::const_iterator& cached_end,
-                   const Instruction* def) const;
+   private:
+    uint32_t* num_iterations_;
+  };
+
+  // Records |def| as the definition of |id|.  A null |def| removes the
+  // definition.
+  void SetDef(uint32_t id, Instruction* def);
+
+  // Returns the users of |id|, or nullptr if none were ever recorded.
+  const UserList* GetUsers(uint32_t id) const;
+
+  // Records |user| as a user of |id|.  Does nothing if a user with the same
+  // unique id is already recorded.
+  void AddUser(uint32_t id, Instruction* user);
+
+  // Removes the record that |user| is a user of |id|, if any.
+  void RemoveUser(uint32_t id, const Instruction* user);
+
+  // Removes all the users recorded for |id|.
+  void ClearUsers(uint32_t id);
+
+  // Removes the tombstones of |users| unless an iteration is in progress.
+  void CompactUsers(UserList* users);
+
+  // Runs |f| on each user recorded for |id|, stopping and returning false as
+  // soon as |f| returns false.  Users added or removed by |f| are visited or
+  // skipped as they would be when iterating over an ordered set.
+  bool WhileEachUserOfId(uint32_t id,
+                         const std::function<bool(Instruction*)>& f) const;
 
   // Analyzes the defs and uses in the given |module| and populates data
   // structures in this class. Does nothing if |module| is nullptr.
   void AnalyzeDefUse(Module* module);
 
-  IdToDefMap id_to_def_;      // Mapping from ids to their definitions
-  IdToUsersMap id_to_users_;  // Mapping from ids to their users
+  // Mapping from ids to their definitions, or nullptr for the ids without
+  // one.  Ids beyond the end of the vector have no definition.
+  std::vector<Instruction*> id_to_def_;
+  // Mapping from ids to their users.  Ids beyond the end of the vector have
+  // no users.
+  std::vector<UserList> id_to_users_;
   // Mapping from instructions to the ids used in the instruction.
   InstToUsedIdsMap inst_to_used_ids_;
+  // The number of iterations over user lists in progress.  Tombstones are
+  // not removed while it is not zero.
+  mutable uint32_t num_iterations_ = 0;
+  // True if the manager may be read by several threads at once.
+  bool concurrent_reads_ = false;
+  // The set recording the changed instructions, if any.
+  std::unordered_set<Instruction*>* changed_insts_ = nullptr;
 };
 
 }  // namespace analysis
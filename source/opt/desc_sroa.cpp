@@ -14,6 +14,8 @@
 
 #include "source/opt/desc_sroa.h"
 
+#include <algorithm>
+
 #include "source/util/string_utils.h"
 
 namespace spvtools {
@@ -26,11 +28,16 @@ Pass::Status DescriptorScalarReplacement::Process() {
 
   for (Instruction& var : context()->types_values()) {
     if (IsCandidate(&var)) {
-      modified = true;
-      if (!ReplaceCandidate(&var)) {
+      bool has_residual = false;
+      if (!ReplaceCandidate(&var, &has_residual)) {
         return Status::Failure;
       }
-      vars_to_kill.push_back(&var);
+      if (!has_residual) {
+        vars_to_kill.push_back(&var);
+        modified = true;
+      } else if (replacement_variables_.count(&var)) {
+        modified = true;
+      }
     }
   }
 
@@ -56,7 +63,8 @@ bool DescriptorScalarReplacement::IsCandidate(Instruction* var) {
   uint32_t var_type_id = ptr_type_inst->GetSingleWordInOperand(1);
   Instruction* var_type_inst =
       context()->get_def_use_mgr()->GetDef(var_type_id);
-  if (var_type_inst->opcode() != SpvOpTypeArray) {
+  if (var_type_inst->opcode() != SpvOpTypeArray &&
+      (!partial_ || var_type_inst->opcode() != SpvOpTypeRuntimeArray)) {
     return false;
   }
 
@@ -83,10 +91,12 @@ bool DescriptorScalarReplacement::IsCandidate(Instruction* var) {
   return true;
 }
 
-bool DescriptorScalarReplacement::ReplaceCandidate(Instruction* var) {
+bool DescriptorScalarReplacement::ReplaceCandidate(Instruction* var,
+                                                   bool* has_residual) {
+  *has_residual = false;
   std::vector<Instruction*> work_list;
   bool failed = !get_def_use_mgr()->WhileEachUser(
-      var->result_id(), [this, &work_list](Instruction* use) {
+      var->result_id(), [this, &work_list, has_residual](Instruction* use) {
         if (use->opcode() == SpvOpName) {
           return true;
         }
@@ -98,9 +108,17 @@ bool DescriptorScalarReplacement::ReplaceCandidate(Instruction* var) {
         switch (use->opcode()) {
           case SpvOpAccessChain:
           case SpvOpInBoundsAccessChain:
+            if (partial_ && !HasConstantFirstIndex(use)) {
+              *has_residual = true;
+              return true;
+            }
             work_list.push_back(use);
             return true;
           default:
+            if (partial_) {
+              *has_residual = true;
+              return true;
+            }
             context()->EmitErrorMessage(
                 "Variable cannot be replaced: invalid instruction", use);
             return false;
@@ -112,6 +130,18 @@ bool DescriptorScalarReplacement::ReplaceCandidate(Instruction* var) {
     return false;
   }
 
+  if (*has_residual && !work_list.empty()) {
+    // The array keeps its binding, so its elements need new ones.
+    uint32_t count = 0;
+    for (Instruction* use : work_list) {
+      const analysis::Constant* idx_const =
+          context()->get_constant_mgr()->FindDeclaredConstant(
+              use->GetSingleWordInOperand(1));
+      count = std::max(count, idx_const->GetU32() + 1);
+    }
+    first_element_bindings_[var] = AllocateBindings(var, count);
+  }
+
   for (Instruction* use : work_list) {
     if (!ReplaceAccessChain(var, use)) {
       return false;
@@ -180,20 +210,29 @@ uint32_t DescriptorScalarReplacement::GetReplacementVariable(Instruction* var,
            "Variable should be a pointer to an array.");
     uint32_t arr_type_id = ptr_type_inst->GetSingleWordInOperand(1);
     Instruction* arr_type_inst = get_def_use_mgr()->GetDef(arr_type_id);
-    assert(arr_type_inst->opcode() == SpvOpTypeArray &&
+    assert((arr_type_inst->opcode() == SpvOpTypeArray ||
+            arr_type_inst->opcode() == SpvOpTypeRuntimeArray) &&
            "Variable should be a pointer to an array.");
 
-    uint32_t array_len_id = arr_type_inst->GetSingleWordInOperand(1);
-    const analysis::Constant* array_len_const =
-        context()->get_constant_mgr()->FindDeclaredConstant(array_len_id);
-    assert(array_len_const != nullptr && "Array length must be a constant.");
-    uint32_t array_len = array_len_const->GetU32();
+    // The variables of the elements of a runtime array are added as needed.
+    uint32_t array_len = 0;
+    if (arr_type_inst->opcode() == SpvOpTypeArray) {
+      uint32_t array_len_id = arr_type_inst->GetSingleWordInOperand(1);
+      const analysis::Constant* array_len_const =
+          context()->get_constant_mgr()->FindDeclaredConstant(array_len_id);
+      assert(array_len_const != nullptr && "Array length must be a constant.");
+      array_len = array_len_const->GetU32();
+    }
 
     replacement_vars = replacement_variables_
                            .insert({var, std::vector<uint32_t>(array_len, 0)})
                            .first;
   }
 
+  if (idx >= replacement_vars->second.size()) {
+    replacement_vars->second.resize(idx + 1, 0);
+  }
+
   if (replacement_vars->second[idx] == 0) {
     replacement_vars->second[idx] = CreateReplacementVariable(var, idx);
   }
@@ -215,7 +254,8 @@ uint32_t DescriptorScalarReplacement::CreateReplacementVariable(
          "Variable should be a pointer to an array.");
   uint32_t arr_type_id = ptr_type_inst->GetSingleWordInOperand(1);
   Instruction* arr_type_inst = get_def_use_mgr()->GetDef(arr_type_id);
-  assert(arr_type_inst->opcode() == SpvOpTypeArray &&
+  assert((arr_type_inst->opcode() == SpvOpTypeArray ||
+          arr_type_inst->opcode() == SpvOpTypeRuntimeArray) &&
          "Variable should be a pointer to an array.");
   uint32_t element_type_id = arr_type_inst->GetSingleWordInOperand(0);
 
@@ -233,6 +273,7 @@ uint32_t DescriptorScalarReplacement::CreateReplacementVariable(
 
   // Copy all of the decorations to the new variable.  The only difference is
   // the Binding decoration needs to be adjusted.
+  auto first_element_binding = first_element_bindings_.find(var);
   for (auto old_decoration :
        get_decoration_mgr()->GetDecorationsFor(var->result_id(), true)) {
     assert(old_decoration->opcode() == SpvOpDecorate);
@@ -242,7 +283,10 @@ uint32_t DescriptorScalarReplacement::CreateReplacementVariable(
 
     uint32_t decoration = new_decoration->GetSingleWordInOperand(1u);
     if (decoration == SpvDecorationBinding) {
-      uint32_t new_binding = new_decoration->GetSingleWordInOperand(2) + idx;
+      uint32_t new_binding =
+          first_element_binding != first_element_bindings_.end()
+              ? first_element_binding->second + idx
+              : new_decoration->GetSingleWordInOperand(2) + idx;
       new_decoration->SetInOperand(2, {new_binding});
     }
     context()->AddAnnotationInst(std::move(new_decoration));
@@ -269,5 +313,69 @@ uint32_t DescriptorScalarReplacement::CreateReplacementVariable(
   return id;
 }
 
+uint32_t DescriptorScalarReplacement::AllocateBindings(Instruction* var,
+                                                       uint32_t count) {
+  uint32_t set = 0;
+  GetDecorationValue(var->result_id(), SpvDecorationDescriptorSet, &set);
+  auto next_binding = next_bindings_.find(set);
+  if (next_binding == next_bindings_.end()) {
+    uint32_t first = 0;
+    if (first_binding_ >= 0) {
+      first = static_cast<uint32_t>(first_binding_);
+    } else {
+      // The elements of the arrays which are replaced take the bindings
+      // following the binding of the array.
+      for (Instruction& other : context()->types_values()) {
+        uint32_t other_set = 0;
+        uint32_t other_binding = 0;
+        if (other.opcode() != SpvOpVariable ||
+            !GetDecorationValue(other.result_id(), SpvDecorationDescriptorSet,
+                                &other_set) ||
+            other_set != set ||
+            !GetDecorationValue(other.result_id(), SpvDecorationBinding,
+                                &other_binding)) {
+          continue;
+        }
+        uint32_t num_bindings = 1;
+        Instruction* ptr_type_inst = get_def_use_mgr()->GetDef(other.type_id());
+        Instruction* type_inst =
+            get_def_use_mgr()->GetDef(ptr_type_inst->GetSingleWordInOperand(1));
+        if (type_inst->opcode() == SpvOpTypeArray) {
+          const analysis::Constant* length =
+              context()->get_constant_mgr()->FindDeclaredConstant(
+                  type_inst->GetSingleWordInOperand(1));
+          if (length != nullptr) {
+            num_bindings = std::max(num_bindings, length->GetU32());
+          }
+        }
+        first = std::max(first, other_binding + num_bindings);
+      }
+    }
+    next_binding = next_bindings_.insert({set, first}).first;
+  }
+
+  const uint32_t binding = next_binding->second;
+  next_binding->second += count;
+  return binding;
+}
+
+bool DescriptorScalarReplacement::GetDecorationValue(uint32_t id,
+                                                     SpvDecoration decoration,
+                                                     uint32_t* value) {
+  bool found = false;
+  get_decoration_mgr()->ForEachDecoration(
+      id, decoration, [value, &found](const Instruction& inst) {
+        *value = inst.GetSingleWordInOperand(2u);
+        found = true;
+      });
+  return found;
+}
+
+bool DescriptorScalarReplacement::HasConstantFirstIndex(Instruction* use) {
+  return use->NumInOperands() > 1 &&
+         context()->get_constant_mgr()->FindDeclaredConstant(
+             use->GetSingleWordInOperand(1)) != nullptr;
+}
+
 }  // namespace opt
 }  // namespace spvtools
@@ -32,12 +32,31 @@ namespace opt {
 // Documented in optimizer.hpp
 class DescriptorScalarReplacement : public Pass {
  public:
-  DescriptorScalarReplacement() {}
+  DescriptorScalarReplacement() : partial_(false), first_binding_(-1) {}
+
+  // Creates the pass in the partial mode, where the arrays also accessed with
+  // non constant indices, runtime arrays included, are split as well: each
+  // element accessed with a constant index gets its own variable, and the
+  // array is kept for the other accesses.  The elements of such an array get
+  // consecutive bindings, element i at the binding of element 0 plus i, after
+  // the elements of the arrays split before it in the same descriptor set.
+  // Element 0 of the first array split in each set is at |first_binding|, or,
+  // if it is negative, right after the largest binding of the set.
+  explicit DescriptorScalarReplacement(bool partial, int32_t first_binding)
+      : partial_(partial), first_binding_(first_binding) {}
 
   const char* name() const override { return "descriptor-scalar-replacement"; }
 
   Status Process() override;
 
+  // Only arrays of descriptors are candidates, see IsCandidate.
+  bool IsNoOp(IRContext* ctx) const override {
+    const ModuleSummary* summary = ctx->GetModuleSummary();
+    if (summary->NumDecorations(SpvDecorationDescriptorSet) == 0) return true;
+    return !summary->HasInstruction(SpvOpTypeArray) &&
+           (!partial_ || !summary->HasInstruction(SpvOpTypeRuntimeArray));
+  }
+
   IRContext::Analysis GetPreservedAnalyses() override {
     return IRContext::kAnalysisDefUse |
            IRContext::kAnalysisInstrToBlockMapping |
@@ -53,7 +72,23 @@ class DescriptorScalarReplacement : public Pass {
   // Replaces all references to |var| by new variables, one for each element of
   // the array |var|.  The binding for the new variables corresponding to
   // element i will be the binding of |var| plus i.  Returns true if successful.
-  bool ReplaceCandidate(Instruction* var);
+  // In the partial mode, only the access chains with a constant first index
+  // are replaced.  |*has_residual| is set to true if other references remain,
+  // and the new variables are then bound as described in the constructor.
+  bool ReplaceCandidate(Instruction* var, bool* has_residual);
+
+  // Returns the binding of the variable of element 0 of the array |var|, and
+  // reserves |count| consecutive bindings from it in the descriptor set of
+  // |var|.
+  uint32_t AllocateBindings(Instruction* var, uint32_t count);
+
+  // Returns true and sets |value| to the value of the |decoration| of |id| if
+  // it has one.  Returns false otherwise.
+  bool GetDecorationValue(uint32_t id, SpvDecoration decoration,
+                          uint32_t* value);
+
+  // Returns true if the first index of the access chain |use| is a constant.
+  bool HasConstantFirstIndex(Instruction* use);
 
   // Replaces the base address |var| in the OpAccessChain or
   // OpInBoundsAccessChain instruction |use| by the variable that the access
@@ -76,6 +111,19 @@ class DescriptorScalarReplacement : public Pass {
   // array |var|. If the entry is |0|, then the variable has not been
   // created yet.
   std::map<Instruction*, std::vector<uint32_t>> replacement_variables_;
+
+  // Whether the arrays with non constant indices are split too.
+  bool partial_;
+
+  // The binding of the first split element in each descriptor set, or
+  // negative to follow the largest binding of the set.
+  int32_t first_binding_;
+
+  // The binding of the variable of element 0 of each array which is kept.
+  std::unordered_map<Instruction*, uint32_t> first_element_bindings_;
+
+  // The next binding to allocate in each descriptor set.
+  std::unordered_map<uint32_t, uint32_t> next_bindings_;
 };
 
 }  // namespace opt
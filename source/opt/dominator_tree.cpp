@@ -273,8 +273,7 @@ BasicBlock* DominatorTree::ImmediateDominator(uint32_t a) const {
 DominatorTreeNode* DominatorTree::GetOrInsertNode(BasicBlock* bb) {
   DominatorTreeNode* dtn = nullptr;
 
-  std::map<uint32_t, DominatorTreeNode>::iterator node_iter =
-      nodes_.find(bb->id());
+  DominatorTreeNodeMap::iterator node_iter = nodes_.find(bb->id());
   if (node_iter == nodes_.end()) {
     dtn = &nodes_.emplace(std::make_pair(bb->id(), DominatorTreeNode{bb}))
                .first->second;
@@ -333,6 +332,7 @@ void DominatorTree::InitializeTree(const CFG& cfg, const Function* f) {
   // Get the immediate dominator for each node.
   std::vector<std::pair<BasicBlock*, BasicBlock*>> edges;
   GetDominatorEdges(f, dummy_start_node, &edges);
+  nodes_.reserve(edges.size());
 
   // Transform the vector<pair> into the tree structure which we can use to
   // efficiently query dominance.
@@ -368,6 +368,68 @@ void DominatorTree::ResetDFNumbering() {
   for (auto root : roots_) DepthFirstSearch(root, getSucc, preFunc, postFunc);
 }
 
+void DominatorTree::MergeNodes(uint32_t kept, uint32_t removed) {
+  DominatorTreeNode* removed_node = GetTreeNode(removed);
+  if (removed_node == nullptr) {
+    // Neither block is reachable.
+    return;
+  }
+  DominatorTreeNode* kept_node = GetTreeNode(kept);
+  assert(kept_node != nullptr &&
+         "Merged blocks must both be in the tree or neither be.");
+
+  auto& kept_children = kept_node->children_;
+  if (removed_node->parent_ == kept_node) {
+    kept_children.erase(
+        std::find(kept_children.begin(), kept_children.end(), removed_node));
+  } else {
+    assert(kept_node->parent_ == removed_node &&
+           "Merged blocks must immediately dominate one another.");
+    ReplaceChild(removed_node->parent_, removed_node, kept_node);
+    kept_node->parent_ = removed_node->parent_;
+  }
+  for (DominatorTreeNode* child : removed_node->children_) {
+    if (child == kept_node) continue;
+    child->parent_ = kept_node;
+    kept_children.push_back(child);
+  }
+  nodes_.erase(removed);
+  ResetDFNumbering();
+}
+
+void DominatorTree::SplitNode(BasicBlock* bb, BasicBlock* new_bb) {
+  DominatorTreeNode* node = GetTreeNode(bb);
+  if (node == nullptr) {
+    return;
+  }
+  DominatorTreeNode* new_node = GetOrInsertNode(new_bb);
+
+  if (postdominator_) {
+    // |new_bb| post-dominates |bb| immediately and takes its place.
+    ReplaceChild(node->parent_, node, new_node);
+    new_node->parent_ = node->parent_;
+    new_node->children_.push_back(node);
+    node->parent_ = new_node;
+  } else {
+    // |bb| dominates |new_bb| immediately, which dominates all that |bb|
+    // dominated.
+    new_node->children_ = std::move(node->children_);
+    for (DominatorTreeNode* child : new_node->children_) {
+      child->parent_ = new_node;
+    }
+    node->children_ = {new_node};
+    new_node->parent_ = node;
+  }
+  ResetDFNumbering();
+}
+
+void DominatorTree::ReplaceChild(DominatorTreeNode* parent,
+                                 DominatorTreeNode* child,
+                                 DominatorTreeNode* new_child) {
+  auto& siblings = parent ? parent->children_ : roots_;
+  std::replace(siblings.begin(), siblings.end(), child, new_child);
+}
+
 void DominatorTree::DumpTreeAsDot(std::ostream& out_stream) const {
   out_stream << "digraph {\n";
   Visit([&out_stream](const DominatorTreeNode* node) {
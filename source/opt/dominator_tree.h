@@ -17,7 +17,7 @@
 
 #include <algorithm>
 #include <cstdint>
-#include <map>
+#include <unordered_map>
 #include <utility>
 #include <vector>
 
@@ -93,7 +93,7 @@ struct DominatorTreeNode {
 class DominatorTree {
  public:
   // Map OpLabel ids to dominator tree nodes
-  using DominatorTreeNodeMap = std::map<uint32_t, DominatorTreeNode>;
+  using DominatorTreeNodeMap = std::unordered_map<uint32_t, DominatorTreeNode>;
   using iterator = TreeDFIterator<DominatorTreeNode>;
   using const_iterator = TreeDFIterator<const DominatorTreeNode>;
   using post_iterator = PostOrderTreeDFIterator<DominatorTreeNode>;
@@ -276,7 +276,22 @@ class DominatorTree {
   // Recomputes the DF numbering of the tree.
   void ResetDFNumbering();
 
+  // Updates the tree after the block |removed| was merged into the block
+  // |kept|, where one of them is the only successor of the other and its only
+  // predecessor.  The node of |kept| takes the children of the node of
+  // |removed|, and its place in the tree if it was the parent.
+  void MergeNodes(uint32_t kept, uint32_t removed);
+
+  // Updates the tree after the instructions at the end of the block |bb| were
+  // moved to the new block |new_bb|, and |bb| was made to branch to |new_bb|.
+  void SplitNode(BasicBlock* bb, BasicBlock* new_bb);
+
  private:
+  // Replaces |child| by |new_child| among the children of |parent|, or among
+  // the roots if |parent| is null.
+  void ReplaceChild(DominatorTreeNode* parent, DominatorTreeNode* child,
+                    DominatorTreeNode* new_child);
+
   // Wrapper function which gets the list of pairs of each BasicBlocks to its
   // immediately  dominating BasicBlock and stores the result in the the edges
   // parameter.
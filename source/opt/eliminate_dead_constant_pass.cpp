@@ -93,9 +93,8 @@ Pass::Status EliminateDeadConstantPass::Process() {
   }
 
   // Turn all dead instructions and uses of them to nop
-  for (auto* dc : dead_consts) {
-    context()->KillDef(dc->result_id());
-  }
+  context()->KillInsts(
+      std::vector<Instruction*>(dead_consts.begin(), dead_consts.end()));
   return dead_consts.empty() ? Status::SuccessWithoutChange
                              : Status::SuccessWithChange;
 }
@@ -118,6 +118,11 @@ void EliminateDeadMembersPass::MarkMembersAsLiveForStore(
 }
 
 void EliminateDeadMembersPass::MarkTypeAsFullyUsed(uint32_t type_id) {
+  // The members of the type and of its subtypes are already all used.
+  if (fully_used_types_.Set(type_id)) {
+    return;
+  }
+
   Instruction* type_inst = get_def_use_mgr()->GetDef(type_id);
   assert(type_inst != nullptr);
   if (type_inst->opcode() != SpvOpTypeStruct) {
@@ -125,8 +130,9 @@ void EliminateDeadMembersPass::MarkTypeAsFullyUsed(uint32_t type_id) {
   }
 
   // Mark every member of the current struct as used.
+  utils::BitVector& used_members = GetUsedMembers(type_id);
   for (uint32_t i = 0; i < type_inst->NumInOperands(); ++i) {
-    used_members_[type_id].insert(i);
+    used_members.Set(i);
   }
 
   // Mark any sub struct as fully used.
@@ -164,7 +170,7 @@ void EliminateDeadMembersPass::MarkMembersAsLiveForExtract(
     uint32_t member_idx = inst->GetSingleWordInOperand(i);
     switch (type_inst->opcode()) {
       case SpvOpTypeStruct:
-        used_members_[type_id].insert(member_idx);
+        MarkMemberAsUsed(type_id, member_idx);
         type_id = type_inst->GetSingleWordInOperand(member_idx);
         break;
       case SpvOpTypeArray:
@@ -209,11 +215,11 @@ void EliminateDeadMembersPass::MarkMembersAsLiveForAccessChain(
                 ->AsIntConstant();
         assert(member_idx);
         if (member_idx->type()->AsInteger()->width() == 32) {
-          used_members_[type_id].insert(member_idx->GetU32());
+          MarkMemberAsUsed(type_id, member_idx->GetU32());
           type_id = type_inst->GetSingleWordInOperand(member_idx->GetU32());
         } else {
-          used_members_[type_id].insert(
-              static_cast<uint32_t>(member_idx->GetU64()));
+          MarkMemberAsUsed(type_id,
+                           static_cast<uint32_t>(member_idx->GetU64()));
           type_id = type_inst->GetSingleWordInOperand(
               static_cast<uint32_t>(member_idx->GetU64()));
         }
@@ -245,7 +251,7 @@ void EliminateDeadMembersPass::MarkMembersAsLiveForArrayLength(
   uint32_t pointer_type_id = object_inst->type_id();
   Instruction* pointer_type_inst = get_def_use_mgr()->GetDef(pointer_type_id);
   uint32_t type_id = pointer_type_inst->GetSingleWordInOperand(1);
-  used_members_[type_id].insert(inst->GetSingleWordInOperand(1));
+  MarkMemberAsUsed(type_id, inst->GetSingleWordInOperand(1));
 }
 
 bool EliminateDeadMembersPass::RemoveDeadMembers() {
@@ -310,15 +316,15 @@ bool EliminateDeadMembersPass::RemoveDeadMembers() {
 bool EliminateDeadMembersPass::UpdateOpTypeStruct(Instruction* inst) {
   assert(inst->opcode() == SpvOpTypeStruct);
 
-  const auto& live_members = used_members_[inst->result_id()];
-  if (live_members.size() == inst->NumInOperands()) {
+  const utils::BitVector& live_members = GetUsedMembers(inst->result_id());
+  if (live_members.Count() == inst->NumInOperands()) {
     return false;
   }
 
   Instruction::OperandList new_operands;
-  for (uint32_t idx : live_members) {
+  live_members.ForEachSetBit([inst, &new_operands](uint32_t idx) {
     new_operands.emplace_back(inst->GetInOperand(idx));
-  }
+  });
 
   inst->SetInOperands(std::move(new_operands));
   context()->UpdateDefUse(inst);
@@ -496,13 +502,21 @@ uint32_t EliminateDeadMembersPass::GetNewMemberIndex(uint32_t type_id,
     return member_idx;
   }
 
-  auto current_member = live_members->second.find(member_idx);
-  if (current_member == live_members->second.end()) {
+  if (!live_members->second.Get(member_idx)) {
     return kRemovedMember;
   }
 
-  return static_cast<uint32_t>(
-      std::distance(live_members->second.begin(), current_member));
+  return live_members->second.CountBefore(member_idx);
+}
+
+void EliminateDeadMembersPass::MarkMemberAsUsed(uint32_t type_id,
+                                                uint32_t member_idx) {
+  GetUsedMembers(type_id).Set(member_idx);
+}
+
+utils::BitVector& EliminateDeadMembersPass::GetUsedMembers(uint32_t type_id) {
+  // Most structs have at most 64 members, whose bits are stored inline.
+  return used_members_.emplace(type_id, utils::BitVector(64)).first->second;
 }
 
 bool EliminateDeadMembersPass::UpdateCompsiteExtract(Instruction* inst) {
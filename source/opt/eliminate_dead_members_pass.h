@@ -19,6 +19,7 @@
 #include "source/opt/function.h"
 #include "source/opt/mem_pass.h"
 #include "source/opt/module.h"
+#include "source/util/bit_vector.h"
 
 namespace spvtools {
 namespace opt {
@@ -133,9 +134,20 @@ class EliminateDeadMembersPass : public MemPass {
   // |type_id|.  If the member has been removed, |kRemovedMember| is returned.
   uint32_t GetNewMemberIndex(uint32_t type_id, uint32_t member_idx);
 
+  // Adds the |member_idx|th member of the struct |type_id| to
+  // |used_members_|.
+  void MarkMemberAsUsed(uint32_t type_id, uint32_t member_idx);
+
+  // Returns the members of the struct |type_id| that are used, adding an
+  // empty set for it if it has none.
+  utils::BitVector& GetUsedMembers(uint32_t type_id);
+
   // A map from a type id to a set of indices representing the members of the
   // type that are used, and must be kept.
-  std::unordered_map<uint32_t, std::set<uint32_t>> used_members_;
+  std::unordered_map<uint32_t, utils::BitVector> used_members_;
+
+  // The ids of the types passed to MarkTypeAsFullyUsed so far.
+  utils::BitVector fully_used_types_;
   void MarkStructOperandsAsFullyUsed(const Instruction* inst);
   void MarkPointeeTypeAsFullUsed(uint32_t ptr_type_id);
 };
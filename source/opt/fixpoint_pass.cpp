@@ -0,0 +1,57 @@
+// Copyright (c) 2019 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#include "source/opt/fixpoint_pass.h"
+
+#include <unordered_set>
+#include <utility>
+
+namespace spvtools {
+namespace opt {
+
+Pass::Status FixpointPass::Process() {
+  Status status = Status::SuccessWithoutChange;
+  std::unordered_set<Function*> functions;
+  bool all_functions = true;
+  for (num_rounds_ = 0; num_rounds_ < max_rounds_;) {
+    ++num_rounds_;
+    std::unordered_set<Function*> changed;
+    bool all_changed = false;
+    for (const PassFactory& factory : factories_) {
+      std::unique_ptr<Pass> pass = factory();
+      pass->SetMessageConsumer(consumer());
+      pass->RestrictToFunctions(all_functions ? nullptr : &functions);
+      Status one_status = pass->Run(context());
+      if (one_status == Status::Failure) return one_status;
+      if (one_status == Status::SuccessWithoutChange) continue;
+
+      status = Status::SuccessWithChange;
+      if (pass->changed_functions().empty()) {
+        all_changed = true;
+      } else {
+        changed.insert(pass->changed_functions().begin(),
+                       pass->changed_functions().end());
+      }
+    }
+
+    if (!all_changed && changed.empty()) break;
+    all_functions = all_changed;
+    functions = std::move(changed);
+  }
+  return status;
+}
+
+}  // namespace opt
+}  // namespace spvtools
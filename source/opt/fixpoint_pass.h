@@ -0,0 +1,69 @@
+// Copyright (c) 2019 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#ifndef SOURCE_OPT_FIXPOINT_PASS_H_
+#define SOURCE_OPT_FIXPOINT_PASS_H_
+
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <utility>
+#include <vector>
+
+#include "source/opt/pass.h"
+
+namespace spvtools {
+namespace opt {
+
+// Runs a group of passes again and again, until a round of them makes no
+// change or |max_rounds| rounds were run.  The first round processes every
+// function.  The next rounds only process the functions changed in the
+// previous round, so that the opportunities a pass exposes to the others are
+// taken without processing the whole module again.
+//
+// A pass is created anew for each round, since a pass runs only once.  The
+// passes which do not record the functions they change, or which are not
+// restricted to some functions, see |Pass::RestrictToFunctions|, are taken to
+// change every function when they report a change.
+class FixpointPass : public Pass {
+ public:
+  using PassFactory = std::function<std::unique_ptr<Pass>()>;
+
+  FixpointPass(std::vector<PassFactory> factories, uint32_t max_rounds)
+      : factories_(std::move(factories)),
+        max_rounds_(max_rounds),
+        num_rounds_(0) {}
+
+  const char* name() const override { return "fixpoint"; }
+  Status Process() override;
+
+  // Each pass of the group keeps the analyses up to date.
+  IRContext::Analysis GetPreservedAnalyses() override {
+    return IRContext::Analysis(IRContext::kAnalysisEnd - 1);
+  }
+
+  // Returns the number of rounds run.
+  uint32_t num_rounds() const { return num_rounds_; }
+
+ private:
+  std::vector<PassFactory> factories_;
+  uint32_t max_rounds_;
+  uint32_t num_rounds_;
+};
+
+}  // namespace opt
+}  // namespace spvtools
+
+#endif  // SOURCE_OPT_FIXPOINT_PASS_H_
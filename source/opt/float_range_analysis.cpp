@@ -0,0 +1,347 @@
+// Copyright (c) 2019 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "source/opt/float_range_analysis.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+#include "source/latest_version_glsl_std_450_header.h"
+#include "source/opcode.h"
+#include "source/opt/ir_context.h"
+
+namespace spvtools {
+namespace opt {
+namespace {
+
+const uint32_t kExtInstSetIdInIdx = 0;
+const uint32_t kExtInstInstructionInIdx = 1;
+const uint32_t kExtInstFirstOperandInIdx = 2;
+const uint32_t kShuffleUndefComponent = 0xFFFFFFFF;
+
+FloatRange Unbounded() {
+  return {-std::numeric_limits<double>::infinity(),
+          std::numeric_limits<double>::infinity()};
+}
+
+FloatRange Hull(const FloatRange& a, const FloatRange& b) {
+  return {std::min(a.min, b.min), std::max(a.max, b.max)};
+}
+
+FloatRange Add(const FloatRange& a, const FloatRange& b) {
+  return {a.min + b.min, a.max + b.max};
+}
+
+FloatRange Negate(const FloatRange& a) { return {-a.max, -a.min}; }
+
+FloatRange Multiply(const FloatRange& a, const FloatRange& b) {
+  const double products[] = {a.min * b.min, a.min * b.max, a.max * b.min,
+                             a.max * b.max};
+  FloatRange result = {products[0], products[0]};
+  for (double product : products) {
+    // An infinite bound times zero.
+    if (std::isnan(product)) return Unbounded();
+    result.min = std::min(result.min, product);
+    result.max = std::max(result.max, product);
+  }
+  return result;
+}
+
+FloatRange Divide(const FloatRange& a, const FloatRange& b) {
+  if (b.min <= 0 && b.max >= 0) return Unbounded();
+  return Multiply(a, {1 / b.max, 1 / b.min});
+}
+
+// Returns the range of a sum of |count| values of range |a|.
+FloatRange Scale(const FloatRange& a, uint32_t count) {
+  return {a.min * count, a.max * count};
+}
+
+FloatRange Absolute(const FloatRange& a) {
+  const double max = std::max(std::fabs(a.min), std::fabs(a.max));
+  if (a.min >= 0) return {a.min, max};
+  if (a.max <= 0) return {-a.max, max};
+  return {0, max};
+}
+
+bool IsNormalizedFormat(SpvImageFormat format, bool* is_signed) {
+  switch (format) {
+    case SpvImageFormatRgba8:
+    case SpvImageFormatRgba16:
+    case SpvImageFormatRgb10A2:
+    case SpvImageFormatRg8:
+    case SpvImageFormatRg16:
+    case SpvImageFormatR8:
+    case SpvImageFormatR16:
+      *is_signed = false;
+      return true;
+    case SpvImageFormatRgba8Snorm:
+    case SpvImageFormatRgba16Snorm:
+    case SpvImageFormatRg8Snorm:
+    case SpvImageFormatRg16Snorm:
+    case SpvImageFormatR8Snorm:
+    case SpvImageFormatR16Snorm:
+      *is_signed = true;
+      return true;
+    default:
+      return false;
+  }
+}
+
+}  // namespace
+
+FloatRangeAnalysis::FloatRangeAnalysis(IRContext* context, Function* func)
+    : context_(context) {
+  // The values of the back edges are not known yet, so the OpPhi instructions
+  // using them are unbounded.
+  context_->cfg()->ForEachBlockInReversePostOrder(
+      func->entry().get(), [this](BasicBlock* bb) {
+        bb->ForEachInst([this](Instruction* inst) {
+          if (inst->result_id() != 0 && inst->type_id() != 0) {
+            ranges_[inst->result_id()] = ComputeRange(inst);
+          }
+        });
+      });
+}
+
+FloatRange FloatRangeAnalysis::GetRange(uint32_t id) const {
+  auto it = ranges_.find(id);
+  if (it != ranges_.end()) return it->second;
+  Instruction* def = context_->get_def_use_mgr()->GetDef(id);
+  // The values of specialization constants are not known.
+  if (def != nullptr && spvOpcodeIsConstant(def->opcode()) &&
+      !spvOpcodeIsSpecConstant(def->opcode())) {
+    return GetConstantRange(def);
+  }
+  return Unbounded();
+}
+
+FloatRange FloatRangeAnalysis::ComputeRange(Instruction* inst) const {
+  auto operand = [this, inst](uint32_t index) {
+    return GetRange(inst->GetSingleWordInOperand(index));
+  };
+  // The number of products summed by the vector and matrix products.
+  auto count = [this, inst](uint32_t index) {
+    return GetComponentCount(
+        context_->get_def_use_mgr()
+            ->GetDef(inst->GetSingleWordInOperand(index))
+            ->type_id());
+  };
+  switch (inst->opcode()) {
+    case SpvOpPhi: {
+      FloatRange range = operand(0);
+      for (uint32_t i = 2; i < inst->NumInOperands(); i += 2) {
+        range = Hull(range, operand(i));
+      }
+      return range;
+    }
+    case SpvOpCompositeConstruct: {
+      if (inst->NumInOperands() == 0) return Unbounded();
+      FloatRange range = operand(0);
+      for (uint32_t i = 1; i < inst->NumInOperands(); ++i) {
+        range = Hull(range, operand(i));
+      }
+      return range;
+    }
+    case SpvOpCopyObject:
+    case SpvOpCompositeExtract:
+    case SpvOpVectorExtractDynamic:
+    case SpvOpTranspose:
+    case SpvOpFConvert:
+      return operand(0);
+    case SpvOpSelect:
+      return Hull(operand(1), operand(2));
+    case SpvOpCompositeInsert:
+    case SpvOpVectorInsertDynamic:
+      return Hull(operand(0), operand(1));
+    case SpvOpVectorShuffle:
+      for (uint32_t i = 2; i < inst->NumInOperands(); ++i) {
+        if (inst->GetSingleWordInOperand(i) == kShuffleUndefComponent) {
+          return Unbounded();
+        }
+      }
+      return Hull(operand(0), operand(1));
+    case SpvOpFNegate:
+      return Negate(operand(0));
+    case SpvOpFAdd:
+      return Add(operand(0), operand(1));
+    case SpvOpFSub:
+      return Add(operand(0), Negate(operand(1)));
+    case SpvOpFMul:
+    case SpvOpVectorTimesScalar:
+    case SpvOpMatrixTimesScalar:
+      return Multiply(operand(0), operand(1));
+    case SpvOpFDiv:
+      return Divide(operand(0), operand(1));
+    case SpvOpDot:
+    case SpvOpMatrixTimesVector:
+      return Scale(Multiply(operand(0), operand(1)), count(1));
+    case SpvOpVectorTimesMatrix:
+    case SpvOpMatrixTimesMatrix:
+      return Scale(Multiply(operand(0), operand(1)), count(0));
+    case SpvOpImageSampleImplicitLod:
+    case SpvOpImageSampleExplicitLod:
+    case SpvOpImageSampleProjImplicitLod:
+    case SpvOpImageSampleProjExplicitLod:
+    case SpvOpImageFetch:
+    case SpvOpImageGather:
+    case SpvOpImageRead:
+      return GetImageRange(inst->GetSingleWordInOperand(0));
+    case SpvOpImageSampleDrefImplicitLod:
+    case SpvOpImageSampleDrefExplicitLod:
+    case SpvOpImageSampleProjDrefImplicitLod:
+    case SpvOpImageSampleProjDrefExplicitLod:
+    case SpvOpImageDrefGather:
+      // The results of depth comparisons.
+      return {0, 1};
+    case SpvOpExtInst:
+      if (inst->GetSingleWordInOperand(kExtInstSetIdInIdx) ==
+          context_->get_feature_mgr()->GetExtInstImportId_GLSLstd450()) {
+        return ComputeExtInstRange(inst);
+      }
+      return Unbounded();
+    default:
+      return Unbounded();
+  }
+}
+
+FloatRange FloatRangeAnalysis::ComputeExtInstRange(Instruction* inst) const {
+  auto operand = [this, inst](uint32_t index) {
+    return GetRange(
+        inst->GetSingleWordInOperand(kExtInstFirstOperandInIdx + index));
+  };
+  switch (inst->GetSingleWordInOperand(kExtInstInstructionInIdx)) {
+    case GLSLstd450FSign:
+    case GLSLstd450Sin:
+    case GLSLstd450Cos:
+    case GLSLstd450Tanh:
+    case GLSLstd450Normalize:
+      return {-1, 1};
+    case GLSLstd450Fract:
+    case GLSLstd450Step:
+    case GLSLstd450SmoothStep:
+      return {0, 1};
+    case GLSLstd450FAbs:
+      return Absolute(operand(0));
+    case GLSLstd450Floor:
+    case GLSLstd450Ceil:
+    case GLSLstd450Round:
+    case GLSLstd450RoundEven:
+    case GLSLstd450Trunc: {
+      const FloatRange x = operand(0);
+      return {std::floor(x.min), std::ceil(x.max)};
+    }
+    case GLSLstd450FMin:
+    case GLSLstd450NMin: {
+      const FloatRange x = operand(0);
+      const FloatRange y = operand(1);
+      return {std::min(x.min, y.min), std::min(x.max, y.max)};
+    }
+    case GLSLstd450FMax:
+    case GLSLstd450NMax: {
+      const FloatRange x = operand(0);
+      const FloatRange y = operand(1);
+      return {std::max(x.min, y.min), std::max(x.max, y.max)};
+    }
+    case GLSLstd450FClamp:
+    case GLSLstd450NClamp: {
+      const FloatRange x = operand(0);
+      const FloatRange low = operand(1);
+      const FloatRange high = operand(2);
+      return {std::min(std::max(x.min, low.min), high.min),
+              std::min(std::max(x.max, low.max), high.max)};
+    }
+    case GLSLstd450FMix: {
+      const FloatRange a = operand(2);
+      if (a.min < 0 || a.max > 1) return Unbounded();
+      return Hull(operand(0), operand(1));
+    }
+    case GLSLstd450Sqrt: {
+      const FloatRange x = operand(0);
+      if (x.min < 0) return Unbounded();
+      return {std::sqrt(x.min), std::sqrt(x.max)};
+    }
+    case GLSLstd450Length:
+    case GLSLstd450Distance: {
+      FloatRange x = operand(0);
+      if (inst->GetSingleWordInOperand(kExtInstInstructionInIdx) ==
+          GLSLstd450Distance) {
+        x = Add(x, Negate(operand(1)));
+      }
+      const uint32_t count = GetComponentCount(
+          context_->get_def_use_mgr()
+              ->GetDef(inst->GetSingleWordInOperand(kExtInstFirstOperandInIdx))
+              ->type_id());
+      return {0, Absolute(x).max * std::sqrt(static_cast<double>(count))};
+    }
+    case GLSLstd450Fma:
+      return Add(Multiply(operand(0), operand(1)), operand(2));
+    default:
+      return Unbounded();
+  }
+}
+
+FloatRange FloatRangeAnalysis::GetImageRange(uint32_t image_id) const {
+  const analysis::Type* type = context_->get_type_mgr()->GetType(
+      context_->get_def_use_mgr()->GetDef(image_id)->type_id());
+  if (type->AsSampledImage() != nullptr) {
+    type = type->AsSampledImage()->image_type();
+  }
+  bool is_signed = false;
+  if (type->AsImage() == nullptr ||
+      !IsNormalizedFormat(type->AsImage()->format(), &is_signed)) {
+    return Unbounded();
+  }
+  return {is_signed ? -1.0 : 0.0, 1.0};
+}
+
+FloatRange FloatRangeAnalysis::GetConstantRange(Instruction* inst) const {
+  const analysis::Constant* constant =
+      context_->get_constant_mgr()->GetConstantFromInst(inst);
+  if (constant == nullptr) return Unbounded();
+
+  std::vector<const analysis::Constant*> work_list = {constant};
+  FloatRange range = {std::numeric_limits<double>::infinity(),
+                      -std::numeric_limits<double>::infinity()};
+  while (!work_list.empty()) {
+    const analysis::Constant* c = work_list.back();
+    work_list.pop_back();
+    const analysis::Float* float_type = c->type()->AsFloat();
+    if (c->AsNullConstant() != nullptr) {
+      range = Hull(range, {0, 0});
+    } else if (c->AsCompositeConstant() != nullptr) {
+      const auto& components = c->AsCompositeConstant()->GetComponents();
+      work_list.insert(work_list.end(), components.begin(), components.end());
+    } else if (float_type != nullptr &&
+               (float_type->width() == 32 || float_type->width() == 64)) {
+      const double value = c->GetValueAsDouble();
+      if (std::isnan(value)) return Unbounded();
+      range = Hull(range, {value, value});
+    } else {
+      return Unbounded();
+    }
+  }
+  return range;
+}
+
+uint32_t FloatRangeAnalysis::GetComponentCount(uint32_t type_id) const {
+  const analysis::Type* type = context_->get_type_mgr()->GetType(type_id);
+  if (type->AsVector() != nullptr) return type->AsVector()->element_count();
+  if (type->AsMatrix() != nullptr) return type->AsMatrix()->element_count();
+  return 1;
+}
+
+}  // namespace opt
+}  // namespace spvtools
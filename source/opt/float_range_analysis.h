@@ -0,0 +1,79 @@
+// Copyright (c) 2019 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef SOURCE_OPT_FLOAT_RANGE_ANALYSIS_H_
+#define SOURCE_OPT_FLOAT_RANGE_ANALYSIS_H_
+
+#include <unordered_map>
+
+#include "source/opt/function.h"
+#include "source/opt/instruction.h"
+
+namespace spvtools {
+namespace opt {
+
+class IRContext;
+
+// The range of the values of a float scalar, or of all the components of a
+// float vector or matrix.  The bounds are infinite if they are not known.
+struct FloatRange {
+  double min;
+  double max;
+
+  // Returns true if the values are known to be within [-|magnitude|,
+  // |magnitude|].
+  bool IsWithin(double magnitude) const {
+    return min >= -magnitude && max <= magnitude;
+  }
+};
+
+// An analysis that bounds the values of the float computations of a function
+// with interval arithmetic.  The ranges start from the constants, the
+// results of the operations with a bounded result, such as sin, normalize or
+// clamp, and the texels of images with a normalized format.  The values
+// coming from memory or from a back edge are unbounded.
+class FloatRangeAnalysis {
+ public:
+  FloatRangeAnalysis(IRContext* context, Function* func);
+
+  // Returns the range of the float value |id|.
+  FloatRange GetRange(uint32_t id) const;
+
+ private:
+  // Returns the range of the result of |inst|, from the ranges of its
+  // operands.
+  FloatRange ComputeRange(Instruction* inst) const;
+
+  // Returns the range of the result of the GLSL.std.450 instruction |inst|.
+  FloatRange ComputeExtInstRange(Instruction* inst) const;
+
+  // Returns the range of the texels read from the image |image_id|, or of
+  // the image of the sampled image |image_id|.
+  FloatRange GetImageRange(uint32_t image_id) const;
+
+  // Returns the range of the constant |inst|.
+  FloatRange GetConstantRange(Instruction* inst) const;
+
+  // Returns the number of components of the vector or the number of columns
+  // of the matrix of type |type_id|, or 1 for other types.
+  uint32_t GetComponentCount(uint32_t type_id) const;
+
+  IRContext* context_;
+  std::unordered_map<uint32_t, FloatRange> ranges_;
+};
+
+}  // namespace opt
+}  // namespace spvtools
+
+#endif  // SOURCE_OPT_FLOAT_RANGE_ANALYSIS_H_
@@ -2416,113 +2416,135 @@ FoldingRule UpdateImageOperands() {
   };
 }
 
-}  // namespace
-
-void FoldingRules::AddFoldingRules() {
+// Returns the folding rules for core instructions.  They do not depend on the
+// module.
+FoldingRules::RuleTable BuildCoreRules() {
+  FoldingRules::RuleTable rules;
   // Add all folding rules to the list for the opcodes to which they apply.
   // Note that the order in which rules are added to the list matters. If a rule
   // applies to the instruction, the rest of the rules will not be attempted.
   // Take that into consideration.
-  rules_[SpvOpCompositeConstruct].push_back(CompositeExtractFeedingConstruct);
-
-  rules_[SpvOpCompositeExtract].push_back(InsertFeedingExtract());
-  rules_[SpvOpCompositeExtract].push_back(CompositeConstructFeedingExtract());
-  rules_[SpvOpCompositeExtract].push_back(VectorShuffleFeedingExtract());
-  rules_[SpvOpCompositeExtract].push_back(FMixFeedingExtract());
-
-  rules_[SpvOpDot].push_back(DotProductDoingExtract());
-
-  rules_[SpvOpEntryPoint].push_back(RemoveRedundantOperands());
-
-  rules_[SpvOpFAdd].push_back(RedundantFAdd());
-  rules_[SpvOpFAdd].push_back(MergeAddNegateArithmetic());
-  rules_[SpvOpFAdd].push_back(MergeAddAddArithmetic());
-  rules_[SpvOpFAdd].push_back(MergeAddSubArithmetic());
-  rules_[SpvOpFAdd].push_back(MergeGenericAddSubArithmetic());
-  rules_[SpvOpFAdd].push_back(FactorAddMuls());
-
-  rules_[SpvOpFDiv].push_back(RedundantFDiv());
-  rules_[SpvOpFDiv].push_back(ReciprocalFDiv());
-  rules_[SpvOpFDiv].push_back(MergeDivDivArithmetic());
-  rules_[SpvOpFDiv].push_back(MergeDivMulArithmetic());
-  rules_[SpvOpFDiv].push_back(MergeDivNegateArithmetic());
-
-  rules_[SpvOpFMul].push_back(RedundantFMul());
-  rules_[SpvOpFMul].push_back(MergeMulMulArithmetic());
-  rules_[SpvOpFMul].push_back(MergeMulDivArithmetic());
-  rules_[SpvOpFMul].push_back(MergeMulNegateArithmetic());
-
-  rules_[SpvOpFNegate].push_back(MergeNegateArithmetic());
-  rules_[SpvOpFNegate].push_back(MergeNegateAddSubArithmetic());
-  rules_[SpvOpFNegate].push_back(MergeNegateMulDivArithmetic());
-
-  rules_[SpvOpFSub].push_back(RedundantFSub());
-  rules_[SpvOpFSub].push_back(MergeSubNegateArithmetic());
-  rules_[SpvOpFSub].push_back(MergeSubAddArithmetic());
-  rules_[SpvOpFSub].push_back(MergeSubSubArithmetic());
-
-  rules_[SpvOpIAdd].push_back(RedundantIAdd());
-  rules_[SpvOpIAdd].push_back(MergeAddNegateArithmetic());
-  rules_[SpvOpIAdd].push_back(MergeAddAddArithmetic());
-  rules_[SpvOpIAdd].push_back(MergeAddSubArithmetic());
-  rules_[SpvOpIAdd].push_back(MergeGenericAddSubArithmetic());
-  rules_[SpvOpIAdd].push_back(FactorAddMuls());
-
-  rules_[SpvOpIMul].push_back(IntMultipleBy1());
-  rules_[SpvOpIMul].push_back(MergeMulMulArithmetic());
-  rules_[SpvOpIMul].push_back(MergeMulNegateArithmetic());
-
-  rules_[SpvOpISub].push_back(MergeSubNegateArithmetic());
-  rules_[SpvOpISub].push_back(MergeSubAddArithmetic());
-  rules_[SpvOpISub].push_back(MergeSubSubArithmetic());
-
-  rules_[SpvOpPhi].push_back(RedundantPhi());
-
-  rules_[SpvOpSDiv].push_back(MergeDivNegateArithmetic());
-
-  rules_[SpvOpSNegate].push_back(MergeNegateArithmetic());
-  rules_[SpvOpSNegate].push_back(MergeNegateMulDivArithmetic());
-  rules_[SpvOpSNegate].push_back(MergeNegateAddSubArithmetic());
-
-  rules_[SpvOpSelect].push_back(RedundantSelect());
-
-  rules_[SpvOpStore].push_back(StoringUndef());
-
-  rules_[SpvOpUDiv].push_back(MergeDivNegateArithmetic());
-
-  rules_[SpvOpVectorShuffle].push_back(VectorShuffleFeedingShuffle());
-
-  rules_[SpvOpImageSampleImplicitLod].push_back(UpdateImageOperands());
-  rules_[SpvOpImageSampleExplicitLod].push_back(UpdateImageOperands());
-  rules_[SpvOpImageSampleDrefImplicitLod].push_back(UpdateImageOperands());
-  rules_[SpvOpImageSampleDrefExplicitLod].push_back(UpdateImageOperands());
-  rules_[SpvOpImageSampleProjImplicitLod].push_back(UpdateImageOperands());
-  rules_[SpvOpImageSampleProjExplicitLod].push_back(UpdateImageOperands());
-  rules_[SpvOpImageSampleProjDrefImplicitLod].push_back(UpdateImageOperands());
-  rules_[SpvOpImageSampleProjDrefExplicitLod].push_back(UpdateImageOperands());
-  rules_[SpvOpImageFetch].push_back(UpdateImageOperands());
-  rules_[SpvOpImageGather].push_back(UpdateImageOperands());
-  rules_[SpvOpImageDrefGather].push_back(UpdateImageOperands());
-  rules_[SpvOpImageRead].push_back(UpdateImageOperands());
-  rules_[SpvOpImageWrite].push_back(UpdateImageOperands());
-  rules_[SpvOpImageSparseSampleImplicitLod].push_back(UpdateImageOperands());
-  rules_[SpvOpImageSparseSampleExplicitLod].push_back(UpdateImageOperands());
-  rules_[SpvOpImageSparseSampleDrefImplicitLod].push_back(
+  rules[SpvOpCompositeConstruct].push_back(CompositeExtractFeedingConstruct);
+
+  rules[SpvOpCompositeExtract].push_back(InsertFeedingExtract());
+  rules[SpvOpCompositeExtract].push_back(CompositeConstructFeedingExtract());
+  rules[SpvOpCompositeExtract].push_back(VectorShuffleFeedingExtract());
+  rules[SpvOpCompositeExtract].push_back(FMixFeedingExtract());
+
+  rules[SpvOpDot].push_back(DotProductDoingExtract());
+
+  rules[SpvOpEntryPoint].push_back(RemoveRedundantOperands());
+
+  rules[SpvOpFAdd].push_back(RedundantFAdd());
+  rules[SpvOpFAdd].push_back(MergeAddNegateArithmetic());
+  rules[SpvOpFAdd].push_back(MergeAddAddArithmetic());
+  rules[SpvOpFAdd].push_back(MergeAddSubArithmetic());
+  rules[SpvOpFAdd].push_back(MergeGenericAddSubArithmetic());
+  rules[SpvOpFAdd].push_back(FactorAddMuls());
+
+  rules[SpvOpFDiv].push_back(RedundantFDiv());
+  rules[SpvOpFDiv].push_back(ReciprocalFDiv());
+  rules[SpvOpFDiv].push_back(MergeDivDivArithmetic());
+  rules[SpvOpFDiv].push_back(MergeDivMulArithmetic());
+  rules[SpvOpFDiv].push_back(MergeDivNegateArithmetic());
+
+  rules[SpvOpFMul].push_back(RedundantFMul());
+  rules[SpvOpFMul].push_back(MergeMulMulArithmetic());
+  rules[SpvOpFMul].push_back(MergeMulDivArithmetic());
+  rules[SpvOpFMul].push_back(MergeMulNegateArithmetic());
+
+  rules[SpvOpFNegate].push_back(MergeNegateArithmetic());
+  rules[SpvOpFNegate].push_back(MergeNegateAddSubArithmetic());
+  rules[SpvOpFNegate].push_back(MergeNegateMulDivArithmetic());
+
+  rules[SpvOpFSub].push_back(RedundantFSub());
+  rules[SpvOpFSub].push_back(MergeSubNegateArithmetic());
+  rules[SpvOpFSub].push_back(MergeSubAddArithmetic());
+  rules[SpvOpFSub].push_back(MergeSubSubArithmetic());
+
+  rules[SpvOpIAdd].push_back(RedundantIAdd());
+  rules[SpvOpIAdd].push_back(MergeAddNegateArithmetic());
+  rules[SpvOpIAdd].push_back(MergeAddAddArithmetic());
+  rules[SpvOpIAdd].push_back(MergeAddSubArithmetic());
+  rules[SpvOpIAdd].push_back(MergeGenericAddSubArithmetic());
+  rules[SpvOpIAdd].push_back(FactorAddMuls());
+
+  rules[SpvOpIMul].push_back(IntMultipleBy1());
+  rules[SpvOpIMul].push_back(MergeMulMulArithmetic());
+  rules[SpvOpIMul].push_back(MergeMulNegateArithmetic());
+
+  rules[SpvOpISub].push_back(MergeSubNegateArithmetic());
+  rules[SpvOpISub].push_back(MergeSubAddArithmetic());
+  rules[SpvOpISub].push_back(MergeSubSubArithmetic());
+
+  rules[SpvOpPhi].push_back(RedundantPhi());
+
+  rules[SpvOpSDiv].push_back(MergeDivNegateArithmetic());
+
+  rules[SpvOpSNegate].push_back(MergeNegateArithmetic());
+  rules[SpvOpSNegate].push_back(MergeNegateMulDivArithmetic());
+  rules[SpvOpSNegate].push_back(MergeNegateAddSubArithmetic());
+
+  rules[SpvOpSelect].push_back(RedundantSelect());
+
+  rules[SpvOpStore].push_back(StoringUndef());
+
+  rules[SpvOpUDiv].push_back(MergeDivNegateArithmetic());
+
+  rules[SpvOpVectorShuffle].push_back(VectorShuffleFeedingShuffle());
+
+  rules[SpvOpImageSampleImplicitLod].push_back(UpdateImageOperands());
+  rules[SpvOpImageSampleExplicitLod].push_back(UpdateImageOperands());
+  rules[SpvOpImageSampleDrefImplicitLod].push_back(UpdateImageOperands());
+  rules[SpvOpImageSampleDrefExplicitLod].push_back(UpdateImageOperands());
+  rules[SpvOpImageSampleProjImplicitLod].push_back(UpdateImageOperands());
+  rules[SpvOpImageSampleProjExplicitLod].push_back(UpdateImageOperands());
+  rules[SpvOpImageSampleProjDrefImplicitLod].push_back(UpdateImageOperands());
+  rules[SpvOpImageSampleProjDrefExplicitLod].push_back(UpdateImageOperands());
+  rules[SpvOpImageFetch].push_back(UpdateImageOperands());
+  rules[SpvOpImageGather].push_back(UpdateImageOperands());
+  rules[SpvOpImageDrefGather].push_back(UpdateImageOperands());
+  rules[SpvOpImageRead].push_back(UpdateImageOperands());
+  rules[SpvOpImageWrite].push_back(UpdateImageOperands());
+  rules[SpvOpImageSparseSampleImplicitLod].push_back(UpdateImageOperands());
+  rules[SpvOpImageSparseSampleExplicitLod].push_back(UpdateImageOperands());
+  rules[SpvOpImageSparseSampleDrefImplicitLod].push_back(
       UpdateImageOperands());
-  rules_[SpvOpImageSparseSampleDrefExplicitLod].push_back(
+  rules[SpvOpImageSparseSampleDrefExplicitLod].push_back(
       UpdateImageOperands());
-  rules_[SpvOpImageSparseSampleProjImplicitLod].push_back(
+  rules[SpvOpImageSparseSampleProjImplicitLod].push_back(
       UpdateImageOperands());
-  rules_[SpvOpImageSparseSampleProjExplicitLod].push_back(
+  rules[SpvOpImageSparseSampleProjExplicitLod].push_back(
       UpdateImageOperands());
-  rules_[SpvOpImageSparseSampleProjDrefImplicitLod].push_back(
+  rules[SpvOpImageSparseSampleProjDrefImplicitLod].push_back(
       UpdateImageOperands());
-  rules_[SpvOpImageSparseSampleProjDrefExplicitLod].push_back(
+  rules[SpvOpImageSparseSampleProjDrefExplicitLod].push_back(
       UpdateImageOperands());
-  rules_[SpvOpImageSparseFetch].push_back(UpdateImageOperands());
-  rules_[SpvOpImageSparseGather].push_back(UpdateImageOperands());
-  rules_[SpvOpImageSparseDrefGather].push_back(UpdateImageOperands());
-  rules_[SpvOpImageSparseRead].push_back(UpdateImageOperands());
+  rules[SpvOpImageSparseFetch].push_back(UpdateImageOperands());
+  rules[SpvOpImageSparseGather].push_back(UpdateImageOperands());
+  rules[SpvOpImageSparseDrefGather].push_back(UpdateImageOperands());
+  rules[SpvOpImageSparseRead].push_back(UpdateImageOperands());
+  return rules;
+}
+
+}  // namespace
+
+FoldingRules::FoldingRuleSet& FoldingRules::RuleTable::operator[](
+    uint32_t opcode) {
+  if (!rules_) {
+    rules_ = std::make_shared<std::vector<FoldingRuleSet>>();
+  } else if (rules_.use_count() > 1) {
+    rules_ = std::make_shared<std::vector<FoldingRuleSet>>(*rules_);
+  }
+  if (opcode >= rules_->size()) rules_->resize(opcode + 1);
+  return (*rules_)[opcode];
+}
+
+void FoldingRules::AddFoldingRules() {
+  // The rules for core instructions are built once and shared by every
+  // context.
+  static const RuleTable core_rules = BuildCoreRules();
+  rules_ = core_rules;
 
   FeatureManager* feature_manager = context_->get_feature_mgr();
   // Add rules for GLSLstd450
@@ -16,7 +16,8 @@
 #define SOURCE_OPT_FOLDING_RULES_H_
 
 #include <cstdint>
-#include <unordered_map>
+#include <map>
+#include <memory>
 #include <vector>
 
 #include "source/opt/constants.h"
@@ -46,28 +47,48 @@ namespace opt {
 // instruction that feed it, then |inst| should be changed to an OpCopyObject
 // that copies that id.
 //
+// A folding rule is a plain function, so that calling one costs no more than
+// an indirect call.
+//
 // Be sure to add new folding rules to the table of folding rules in the
 // constructor for FoldingRules.  The new rule should be added to the list for
 // every opcode that it applies to.  Note that earlier rules in the list are
 // given priority.  That is, if an earlier rule is able to fold an instruction,
 // the later rules will not be attempted.
 
-using FoldingRule = std::function<bool(
-    IRContext* context, Instruction* inst,
-    const std::vector<const analysis::Constant*>& constants)>;
+using FoldingRule =
+    bool (*)(IRContext* context, Instruction* inst,
+             const std::vector<const analysis::Constant*>& constants);
 
 class FoldingRules {
  public:
   using FoldingRuleSet = std::vector<FoldingRule>;
 
+  // The folding rules of each core opcode, in an array indexed by opcode.
+  // Copies of a table share the array until one of them is changed.
+  class RuleTable {
+   public:
+    // Returns the rules for |opcode|, or nullptr if there is none.
+    const FoldingRuleSet* Find(uint32_t opcode) const {
+      if (!rules_ || opcode >= rules_->size()) return nullptr;
+      return &(*rules_)[opcode];
+    }
+
+    // Returns the rules for |opcode|, to add rules to them.
+    FoldingRuleSet& operator[](uint32_t opcode);
+
+   private:
+    std::shared_ptr<std::vector<FoldingRuleSet>> rules_;
+  };
+
   explicit FoldingRules(IRContext* ctx) : context_(ctx) {}
   virtual ~FoldingRules() = default;
 
   const FoldingRuleSet& GetRulesForInstruction(Instruction* inst) const {
     if (inst->opcode() != SpvOpExtInst) {
-      auto it = rules_.find(inst->opcode());
-      if (it != rules_.end()) {
-        return it->second;
+      const FoldingRuleSet* rules = rules_.Find(inst->opcode());
+      if (rules != nullptr) {
+        return *rules;
       }
     } else {
       uint32_t ext_inst_id = inst->GetSingleWordInOperand(0);
@@ -87,7 +108,7 @@ class FoldingRules {
 
  protected:
   // The folding rules for core instructions.
-  std::unordered_map<uint32_t, FoldingRuleSet> rules_;
+  RuleTable rules_;
 
   // The folding rules for extended instructions.
   struct Key {
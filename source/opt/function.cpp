@@ -45,81 +45,6 @@ Function* Function::Clone(IRContext* ctx) const {
   return clone;
 }
 
-void Function::ForEachInst(const std::function<void(Instruction*)>& f,
-                           bool run_on_debug_line_insts) {
-  WhileEachInst(
-      [&f](Instruction* inst) {
-        f(inst);
-        return true;
-      },
-      run_on_debug_line_insts);
-}
-
-void Function::ForEachInst(const std::function<void(const Instruction*)>& f,
-                           bool run_on_debug_line_insts) const {
-  WhileEachInst(
-      [&f](const Instruction* inst) {
-        f(inst);
-        return true;
-      },
-      run_on_debug_line_insts);
-}
-
-bool Function::WhileEachInst(const std::function<bool(Instruction*)>& f,
-                             bool run_on_debug_line_insts) {
-  if (def_inst_) {
-    if (!def_inst_->WhileEachInst(f, run_on_debug_line_insts)) {
-      return false;
-    }
-  }
-
-  for (auto& param : params_) {
-    if (!param->WhileEachInst(f, run_on_debug_line_insts)) {
-      return false;
-    }
-  }
-
-  for (auto& bb : blocks_) {
-    if (!bb->WhileEachInst(f, run_on_debug_line_insts)) {
-      return false;
-    }
-  }
-
-  if (end_inst_) return end_inst_->WhileEachInst(f, run_on_debug_line_insts);
-
-  return true;
-}
-
-bool Function::WhileEachInst(const std::function<bool(const Instruction*)>& f,
-                             bool run_on_debug_line_insts) const {
-  if (def_inst_) {
-    if (!static_cast<const Instruction*>(def_inst_.get())
-             ->WhileEachInst(f, run_on_debug_line_insts)) {
-      return false;
-    }
-  }
-
-  for (const auto& param : params_) {
-    if (!static_cast<const Instruction*>(param.get())
-             ->WhileEachInst(f, run_on_debug_line_insts)) {
-      return false;
-    }
-  }
-
-  for (const auto& bb : blocks_) {
-    if (!static_cast<const BasicBlock*>(bb.get())->WhileEachInst(
-            f, run_on_debug_line_insts)) {
-      return false;
-    }
-  }
-
-  if (end_inst_)
-    return static_cast<const Instruction*>(end_inst_.get())
-        ->WhileEachInst(f, run_on_debug_line_insts);
-
-  return true;
-}
-
 void Function::ForEachParam(const std::function<void(Instruction*)>& f,
                             bool run_on_debug_line_insts) {
   for (auto& param : params_)
@@ -163,15 +88,11 @@ BasicBlock* Function::InsertBasicBlockBefore(
 
 bool Function::IsRecursive() const {
   IRContext* ctx = blocks_.front()->GetLabel()->context();
-  IRContext::ProcessFunction mark_visited = [this](Function* fp) {
-    return fp == this;
-  };
-
-  // Process the call tree from all of the function called by |this|.  If it get
-  // back to |this|, then we have a recursive function.
-  std::queue<uint32_t> roots;
-  ctx->AddCalls(this, &roots);
-  return ctx->ProcessCallTreeFromRoots(mark_visited, &roots);
+  CallGraph* call_graph = ctx->GetCallGraph();
+  if (!call_graph->HasFunction(result_id())) {
+    call_graph->UpdateFunction(this);
+  }
+  return call_graph->IsRecursive(result_id());
 }
 
 std::ostream& operator<<(std::ostream& str, const Function& func) {
@@ -105,19 +105,23 @@ class Function {
   }
 
   // Runs the given function |f| on instructions in this function, in order,
-  // and optionally on debug line instructions that might precede them.
-  void ForEachInst(const std::function<void(Instruction*)>& f,
-                   bool run_on_debug_line_insts = false);
-  void ForEachInst(const std::function<void(const Instruction*)>& f,
-                   bool run_on_debug_line_insts = false) const;
+  // and optionally on debug line instructions that might precede them.  |f|
+  // may be any callable object, and is inlined into the traversal.
+  template <typename Func>
+  inline void ForEachInst(const Func& f, bool run_on_debug_line_insts = false);
+  template <typename Func>
+  inline void ForEachInst(const Func& f,
+                          bool run_on_debug_line_insts = false) const;
   // Runs the given function |f| on instructions in this function, in order,
   // and optionally on debug line instructions that might precede them.
   // If |f| returns false, iteration is terminated and this function returns
   // false.
-  bool WhileEachInst(const std::function<bool(Instruction*)>& f,
-                     bool run_on_debug_line_insts = false);
-  bool WhileEachInst(const std::function<bool(const Instruction*)>& f,
-                     bool run_on_debug_line_insts = false) const;
+  template <typename Func>
+  inline bool WhileEachInst(const Func& f,
+                            bool run_on_debug_line_insts = false);
+  template <typename Func>
+  inline bool WhileEachInst(const Func& f,
+                            bool run_on_debug_line_insts = false) const;
 
   // Runs the given function |f| on each parameter instruction in this function,
   // in order, and optionally on debug line instructions that might precede
@@ -205,6 +209,85 @@ inline void Function::SetFunctionEnd(std::unique_ptr<Instruction> end_inst) {
   end_inst_ = std::move(end_inst);
 }
 
+template <typename Func>
+inline void Function::ForEachInst(const Func& f,
+                                  bool run_on_debug_line_insts) {
+  WhileEachInst(
+      [&f](Instruction* inst) {
+        f(inst);
+        return true;
+      },
+      run_on_debug_line_insts);
+}
+
+template <typename Func>
+inline void Function::ForEachInst(const Func& f,
+                                  bool run_on_debug_line_insts) const {
+  WhileEachInst(
+      [&f](const Instruction* inst) {
+        f(inst);
+        return true;
+      },
+      run_on_debug_line_insts);
+}
+
+template <typename Func>
+inline bool Function::WhileEachInst(const Func& f,
+                                    bool run_on_debug_line_insts) {
+  if (def_inst_) {
+    if (!def_inst_->WhileEachInst(f, run_on_debug_line_insts)) {
+      return false;
+    }
+  }
+
+  for (auto& param : params_) {
+    if (!param->WhileEachInst(f, run_on_debug_line_insts)) {
+      return false;
+    }
+  }
+
+  for (auto& bb : blocks_) {
+    if (!bb->WhileEachInst(f, run_on_debug_line_insts)) {
+      return false;
+    }
+  }
+
+  if (end_inst_) return end_inst_->WhileEachInst(f, run_on_debug_line_insts);
+
+  return true;
+}
+
+template <typename Func>
+inline bool Function::WhileEachInst(const Func& f,
+                                    bool run_on_debug_line_insts) const {
+  if (def_inst_) {
+    if (!static_cast<const Instruction*>(def_inst_.get())
+             ->WhileEachInst(f, run_on_debug_line_insts)) {
+      return false;
+    }
+  }
+
+  for (const auto& param : params_) {
+    if (!static_cast<const Instruction*>(param.get())
+             ->WhileEachInst(f, run_on_debug_line_insts)) {
+      return false;
+    }
+  }
+
+  for (const auto& bb : blocks_) {
+    if (!static_cast<const BasicBlock*>(bb.get())->WhileEachInst(
+            f, run_on_debug_line_insts)) {
+      return false;
+    }
+  }
+
+  if (end_inst_)
+    return static_cast<const Instruction*>(end_inst_.get())
+        ->WhileEachInst(f, run_on_debug_line_insts);
+
+  return true;
+}
+
 }  // namespace opt
 }  // namespace spvtools
 
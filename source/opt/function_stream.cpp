@@ -0,0 +1,410 @@
+// Copyright (c) 2020 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "source/opt/function_stream.h"
+
+#include <cassert>
+#include <unordered_set>
+#include <utility>
+
+#include "source/binary.h"
+#include "source/opt/log.h"
+#include "source/operand.h"
+#include "source/spirv_constant.h"
+#include "source/util/make_unique.h"
+
+namespace spvtools {
+namespace opt {
+namespace {
+
+// Marks no offset in the words of a module.
+const size_t kNoOffset = ~size_t(0);
+
+// Returns the number of words of the instruction at |inst|.
+uint32_t WordCount(const uint32_t* inst) { return inst[0] >> 16; }
+
+// Returns the opcode of the instruction at |inst|.
+SpvOp Opcode(const uint32_t* inst) {
+  return static_cast<SpvOp>(inst[0] & 0xFFFF);
+}
+
+// Returns true if |type| is the type of an operand that uses an id defined
+// outside of the type declarations.
+bool UsesValueId(spv_operand_type_t type) {
+  return spvIsIdType(type) && type != SPV_OPERAND_TYPE_RESULT_ID &&
+         type != SPV_OPERAND_TYPE_TYPE_ID;
+}
+
+}  // namespace
+
+FunctionStream::FunctionStream(spv_target_env env,
+                               const MessageConsumer& consumer)
+    : consumer_(consumer),
+      context_(MakeUnique<IRContext>(env, consumer)),
+      parser_(nullptr),
+      words_(nullptr),
+      num_words_(0),
+      globals_end_(0),
+      line_run_begin_(kNoOffset),
+      scan_offset_(SPV_INDEX_INSTRUCTION),
+      next_function_(0),
+      loaded_function_(nullptr) {}
+
+FunctionStream::~FunctionStream() { spvBinaryParserDestroy(parser_); }
+
+bool FunctionStream::Begin(const uint32_t* words, size_t num_words) {
+  words_ = words;
+  num_words_ = num_words;
+  globals_end_ = num_words;
+  if (num_words >= SPV_INDEX_INSTRUCTION) {
+    if (words[0] != SpvMagicNumber) {
+      Error(consumer_, nullptr, {},
+            "Only a module in the native endianness can be streamed.");
+      return false;
+    }
+    id_owners_.assign(words[SPV_INDEX_BOUND], 0);
+  }
+
+  if (spvBinaryParse(context_->syntax_context(), this, words, num_words,
+                     nullptr, ScanInstruction, nullptr) != SPV_SUCCESS) {
+    return false;
+  }
+  if (!functions_.empty() && functions_.back().end == 0) {
+    Error(consumer_, nullptr, {}, "The last function has no OpFunctionEnd.");
+    return false;
+  }
+  if (!ClassifyGlobalUses()) return false;
+
+  // The global section is parsed once, and the set aside instructions are
+  // parsed with their function.
+  parser_ = spvBinaryParserCreate(context_->syntax_context());
+  loader_ = MakeUnique<IrLoader>(consumer_, context_->module());
+  loader_->SetModuleHeader(words[0], words[1], words[2], words[3], words[4]);
+  if (spvBinaryParserBegin(parser_, this, words, nullptr, LoadInstruction,
+                           nullptr) != SPV_SUCCESS) {
+    return false;
+  }
+  size_t next_set_aside = 0;
+  for (size_t offset = SPV_INDEX_INSTRUCTION; offset < globals_end_;
+       offset += WordCount(words + offset)) {
+    if (next_set_aside < set_aside_offsets_.size() &&
+        set_aside_offsets_[next_set_aside] == offset) {
+      ++next_set_aside;
+      continue;
+    }
+    if (!Parse(words + offset, words + offset + WordCount(words + offset))) {
+      return false;
+    }
+  }
+  set_aside_offsets_.clear();
+
+  for (size_t index = 0; index < functions_.size(); ++index) {
+    context_->AddFunction(MakeDeclaration(index));
+  }
+  return true;
+}
+
+Function* FunctionStream::LoadNextFunction() {
+  assert(loaded_function_ == nullptr && "A function is already loaded.");
+  const size_t index = next_function_++;
+  const FunctionRange& range = functions_[index];
+
+  // The analyses may point into the declaration.
+  context_->InvalidateAnalysesExceptFor(IRContext::kAnalysisTypes |
+                                        IRContext::kAnalysisConstants);
+  FindFunction(range.id).Erase();
+  std::vector<uint32_t> annotations;
+  annotations.swap(local_annotations_[index]);
+  if (!Parse(annotations.data(), annotations.data() + annotations.size()) ||
+      !Parse(words_ + range.begin, words_ + range.end)) {
+    return nullptr;
+  }
+  loader_->EndModule();
+  loaded_function_ = &*FindFunction(range.id);
+
+  call_trees_.entry_point_tree.assign(in_entry_point_tree_[index] ? 1 : 0,
+                                      range.id);
+  call_trees_.reachable_tree.assign(in_reachable_tree_[index] ? 1 : 0,
+                                    range.id);
+  context_->set_call_trees(&call_trees_);
+  return loaded_function_;
+}
+
+void FunctionStream::UnloadFunction() {
+  assert(loaded_function_ != nullptr && "No function is loaded.");
+  const size_t index = next_function_ - 1;
+
+  size_t size = functions_binary_.size();
+  loaded_function_->ForEachInst([&size](const Instruction* inst) {
+    size += inst->NumDbgLineWords();
+    if (!inst->IsNop()) size += 1 + inst->NumOperandWords();
+  });
+  const size_t begin = functions_binary_.size();
+  functions_binary_.resize(size);
+  uint32_t* words = functions_binary_.data() + begin;
+  loaded_function_->ForEachInst([&words](const Instruction* inst) {
+    words = inst->DbgLineInstsToBinary(words);
+    if (!inst->IsNop()) words = inst->ToBinaryWithoutAttachedDebugInsts(words);
+  });
+
+  // The names and decorations of the ids defined in the body are set aside
+  // again, since the passes may have changed them.
+  std::unordered_set<uint32_t> local_ids;
+  for (BasicBlock& block : *loaded_function_) {
+    block.ForEachInst([&local_ids](Instruction* inst) {
+      if (inst->result_id() != 0) local_ids.insert(inst->result_id());
+    });
+  }
+  std::vector<Instruction*> set_aside;
+  auto set_aside_if_local = [this, &local_ids, &set_aside,
+                             index](Instruction* inst) {
+    for (uint32_t i = 0; i < inst->NumOperands(); ++i) {
+      const Operand& operand = inst->GetOperand(i);
+      if (UsesValueId(operand.type) && local_ids.count(operand.words[0])) {
+        inst->ToBinaryWithoutAttachedDebugInsts(&local_annotations_[index]);
+        set_aside.push_back(inst);
+        return;
+      }
+    }
+  };
+  for (Instruction& inst : context_->module()->debugs2()) {
+    set_aside_if_local(&inst);
+  }
+  for (Instruction& inst : context_->annotations()) {
+    set_aside_if_local(&inst);
+  }
+  for (Instruction* inst : set_aside) context_->KillInst(inst);
+
+  context_->set_call_trees(nullptr);
+  context_->InvalidateAnalysesExceptFor(IRContext::kAnalysisTypes |
+                                        IRContext::kAnalysisConstants);
+  FindFunction(functions_[index].id).Erase();
+  loaded_function_ = nullptr;
+  context_->AddFunction(MakeDeclaration(index));
+}
+
+void FunctionStream::Finish(std::vector<uint32_t>* binary) {
+  assert(!HasNextFunction() && loaded_function_ == nullptr &&
+         "Some function was not streamed.");
+  for (const std::vector<uint32_t>& annotations : local_annotations_) {
+    const bool parsed =
+        Parse(annotations.data(), annotations.data() + annotations.size());
+    assert(parsed && "The set aside instructions were parsed before.");
+    (void)parsed;
+  }
+  loader_->EndModule();
+  context_->InvalidateAnalysesExceptFor(IRContext::kAnalysisNone);
+  Module* module = context_->module();
+  for (auto iter = module->begin(); iter != module->end();) {
+    iter = iter.Erase();
+  }
+
+  binary->clear();
+  module->ToBinary(binary, /* skip_nop = */ true);
+  binary->insert(binary->end(), functions_binary_.begin(),
+                 functions_binary_.end());
+  // The debug line instructions following the last function.
+  if (!functions_.empty()) {
+    binary->insert(binary->end(), words_ + functions_.back().end,
+                   words_ + num_words_);
+  }
+}
+
+spv_result_t FunctionStream::ScanInstruction(
+    void* user_data, const spv_parsed_instruction_t* inst) {
+  FunctionStream* stream = static_cast<FunctionStream*>(user_data);
+  const size_t offset = stream->scan_offset_;
+  stream->scan_offset_ += inst->num_words;
+  const SpvOp opcode = static_cast<SpvOp>(inst->opcode);
+  if (opcode == SpvOpLine || opcode == SpvOpNoLine) {
+    if (stream->line_run_begin_ == kNoOffset) {
+      stream->line_run_begin_ = offset;
+    }
+    return SPV_SUCCESS;
+  }
+  // The debug line instructions belong to the instruction they precede.
+  const size_t begin =
+      stream->line_run_begin_ == kNoOffset ? offset : stream->line_run_begin_;
+  stream->line_run_begin_ = kNoOffset;
+
+  std::vector<FunctionRange>& functions = stream->functions_;
+  if (opcode == SpvOpFunction) {
+    FunctionRange range;
+    if (functions.empty()) {
+      stream->globals_end_ = begin;
+      range.begin = begin;
+    } else {
+      range.begin = functions.back().end;
+    }
+    range.end = 0;
+    range.def = offset;
+    range.id = inst->result_id;
+    stream->function_indices_[range.id] = functions.size();
+    functions.push_back(std::move(range));
+    return SPV_SUCCESS;
+  }
+
+  const bool in_function = !functions.empty() && functions.back().end == 0;
+  if (in_function) {
+    if (opcode == SpvOpFunctionEnd) {
+      functions.back().end = offset + inst->num_words;
+    } else if (opcode == SpvOpFunctionCall) {
+      functions.back().callees.push_back(inst->words[3]);
+    }
+    if (opcode != SpvOpFunctionParameter && inst->result_id != 0 &&
+        inst->result_id < stream->id_owners_.size()) {
+      stream->id_owners_[inst->result_id] =
+          static_cast<uint32_t>(functions.size());
+    }
+    return SPV_SUCCESS;
+  }
+  if (!functions.empty()) {
+    Error(stream->consumer_, nullptr, {},
+          "Unexpected instruction after the function definitions.");
+    return SPV_ERROR_INVALID_BINARY;
+  }
+
+  switch (opcode) {
+    case SpvOpDecorationGroup:
+    case SpvOpGroupDecorate:
+    case SpvOpGroupMemberDecorate:
+      Error(stream->consumer_, nullptr, {},
+            "A module with decoration groups cannot be streamed.");
+      return SPV_ERROR_INVALID_BINARY;
+    case SpvOpEntryPoint:
+      stream->entry_point_ids_.push_back(inst->words[2]);
+      break;
+    case SpvOpDecorate:
+      if (inst->words[2] == SpvDecorationLinkageAttributes &&
+          inst->words[inst->num_words - 1] == SpvLinkageTypeExport) {
+        stream->exported_ids_.push_back(inst->words[1]);
+      }
+      break;
+    default:
+      break;
+  }
+
+  // Only the instructions without a result id, and the extended instructions,
+  // can use the ids defined in a function.
+  if (inst->result_id != 0 && opcode != SpvOpExtInst) return SPV_SUCCESS;
+  GlobalUse use;
+  use.offset = offset;
+  use.has_result_id = inst->result_id != 0;
+  for (uint16_t i = 0; i < inst->num_operands; ++i) {
+    const spv_parsed_operand_t& operand = inst->operands[i];
+    if (UsesValueId(operand.type)) {
+      use.ids.push_back(inst->words[operand.offset]);
+    }
+  }
+  if (!use.ids.empty()) stream->global_uses_.push_back(std::move(use));
+  return SPV_SUCCESS;
+}
+
+spv_result_t FunctionStream::LoadInstruction(
+    void* user_data, const spv_parsed_instruction_t* inst) {
+  FunctionStream* stream = static_cast<FunctionStream*>(user_data);
+  return stream->loader_->AddInstruction(inst) ? SPV_SUCCESS
+                                               : SPV_ERROR_INVALID_BINARY;
+}
+
+bool FunctionStream::ClassifyGlobalUses() {
+  local_annotations_.assign(functions_.size(), {});
+  for (const GlobalUse& use : global_uses_) {
+    uint32_t owner = 0;
+    for (uint32_t id : use.ids) {
+      const uint32_t id_owner = id < id_owners_.size() ? id_owners_[id] : 0;
+      if (id_owner == 0 || id_owner == owner) continue;
+      if (owner != 0 || use.has_result_id) {
+        Error(consumer_, nullptr, {},
+              "A module in which a global instruction uses the ids defined in "
+              "a function cannot be streamed.");
+        return false;
+      }
+      owner = id_owner;
+    }
+    if (owner == 0) continue;
+    set_aside_offsets_.push_back(use.offset);
+    const uint32_t* inst = words_ + use.offset;
+    local_annotations_[owner - 1].insert(local_annotations_[owner - 1].end(),
+                                         inst, inst + WordCount(inst));
+  }
+  std::vector<GlobalUse>().swap(global_uses_);
+  std::vector<uint32_t>().swap(id_owners_);
+
+  // Marks the functions in the call trees rooted at |roots| in |reached|.
+  auto mark_call_trees = [this](const std::vector<uint32_t>& roots,
+                                std::vector<bool>* reached) {
+    std::vector<uint32_t> todo(roots);
+    while (!todo.empty()) {
+      const auto index = function_indices_.find(todo.back());
+      todo.pop_back();
+      if (index == function_indices_.end() || (*reached)[index->second]) {
+        continue;
+      }
+      (*reached)[index->second] = true;
+      const std::vector<uint32_t>& callees = functions_[index->second].callees;
+      todo.insert(todo.end(), callees.begin(), callees.end());
+    }
+  };
+  in_entry_point_tree_.assign(functions_.size(), false);
+  in_reachable_tree_.assign(functions_.size(), false);
+  mark_call_trees(entry_point_ids_, &in_entry_point_tree_);
+  mark_call_trees(entry_point_ids_, &in_reachable_tree_);
+  mark_call_trees(exported_ids_, &in_reachable_tree_);
+  for (FunctionRange& range : functions_) {
+    std::vector<uint32_t>().swap(range.callees);
+  }
+  return true;
+}
+
+bool FunctionStream::Parse(const uint32_t* begin, const uint32_t* end) {
+  for (const uint32_t* inst = begin; inst < end; inst += WordCount(inst)) {
+    if (spvBinaryParserParseInstruction(parser_, inst, WordCount(inst)) !=
+        SPV_SUCCESS) {
+      return false;
+    }
+  }
+  return true;
+}
+
+std::unique_ptr<Function> FunctionStream::MakeDeclaration(size_t index) {
+  IRContext* context = context_.get();
+  const uint32_t* inst = words_ + functions_[index].def;
+  std::unique_ptr<Instruction> def_inst(new (context) Instruction(
+      context, SpvOpFunction, inst[1], inst[2],
+      {{SPV_OPERAND_TYPE_FUNCTION_CONTROL, {inst[3]}},
+       {SPV_OPERAND_TYPE_ID, {inst[4]}}}));
+  auto function = MakeUnique<Function>(std::move(def_inst));
+  for (inst += WordCount(inst);; inst += WordCount(inst)) {
+    const SpvOp opcode = Opcode(inst);
+    if (opcode == SpvOpLine || opcode == SpvOpNoLine) continue;
+    if (opcode != SpvOpFunctionParameter) break;
+    std::unique_ptr<Instruction> param(new (context) Instruction(
+        context, SpvOpFunctionParameter, inst[1], inst[2], {}));
+    function->AddParameter(std::move(param));
+  }
+  function->SetFunctionEnd(std::unique_ptr<Instruction>(
+      new (context) Instruction(context, SpvOpFunctionEnd)));
+  return function;
+}
+
+Module::iterator FunctionStream::FindFunction(uint32_t id) {
+  Module* module = context_->module();
+  auto iter = module->begin();
+  while (iter != module->end() && iter->result_id() != id) ++iter;
+  return iter;
+}
+
+}  // namespace opt
+}  // namespace spvtools
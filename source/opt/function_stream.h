@@ -0,0 +1,165 @@
+// Copyright (c) 2020 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef SOURCE_OPT_FUNCTION_STREAM_H_
+#define SOURCE_OPT_FUNCTION_STREAM_H_
+
+#include <cstdint>
+#include <memory>
+#include <unordered_map>
+#include <vector>
+
+#include "source/opt/function.h"
+#include "source/opt/ir_context.h"
+#include "source/opt/ir_loader.h"
+#include "spirv-tools/libspirv.h"
+
+namespace spvtools {
+namespace opt {
+
+// Holds a module as IR one function definition at a time, so that function
+// local passes can optimize it in the memory of its global section and its
+// largest function.
+//
+// The global section is built once, with each function definition replaced
+// by a declaration: its OpFunction, OpFunctionParameter and OpFunctionEnd.
+// The definitions are then loaded in order, each in place of its declaration,
+// and unloaded once optimized: the function is serialized and replaced by its
+// declaration again.  The names and decorations of the ids defined in a
+// function are only held as IR while it is loaded.
+class FunctionStream {
+ public:
+  FunctionStream(spv_target_env env, const MessageConsumer& consumer);
+  ~FunctionStream();
+
+  // Scans the module of |num_words| words at |words| and builds its global
+  // section.  |words| must outlive the stream.  Returns false if the module
+  // fails to parse, or cannot be held one function at a time: it is not in
+  // the native endianness, it has decoration groups, or an instruction of
+  // the global section uses ids defined in a function, other than a name or
+  // a decoration of ids of a single function.
+  bool Begin(const uint32_t* words, size_t num_words);
+
+  // Returns the context holding the global section and the loaded function.
+  IRContext* context() { return context_.get(); }
+
+  // Returns true if some function definition is still to be loaded.
+  bool HasNextFunction() const { return next_function_ < functions_.size(); }
+
+  // Loads the next function definition, and makes the call tree walks of the
+  // context process it if the module reaches it.  Returns the function, or
+  // null if it fails to parse.
+  Function* LoadNextFunction();
+
+  // Serializes the loaded function and replaces it by its declaration.
+  void UnloadFunction();
+
+  // Writes the module to |binary|: the global section as changed by the
+  // passes, followed by the serialized functions.  All the functions must
+  // have been loaded and unloaded.
+  void Finish(std::vector<uint32_t>* binary);
+
+ private:
+  // A function definition of the module.
+  struct FunctionRange {
+    // The offsets of the words of the function in the module, including the
+    // debug line instructions preceding it.
+    size_t begin;
+    size_t end;
+    // The offset of the OpFunction instruction.
+    size_t def;
+    uint32_t id;
+    // The ids of the functions it calls.
+    std::vector<uint32_t> callees;
+  };
+
+  // An instruction of the global section which uses ids.
+  struct GlobalUse {
+    size_t offset;
+    bool has_result_id;
+    std::vector<uint32_t> ids;
+  };
+
+  // Records the instruction |inst| of the scanned module.
+  static spv_result_t ScanInstruction(void* user_data,
+                                      const spv_parsed_instruction_t* inst);
+
+  // Adds the instruction |inst| to the module of the context.
+  static spv_result_t LoadInstruction(void* user_data,
+                                      const spv_parsed_instruction_t* inst);
+
+  // Sets aside the names and decorations of the ids defined in functions,
+  // and finds the functions in the call trees.  Returns false if a global
+  // instruction uses the ids of a function but cannot be set aside.
+  bool ClassifyGlobalUses();
+
+  // Parses the instructions in the words from |begin| to |end| into the
+  // module of the context.
+  bool Parse(const uint32_t* begin, const uint32_t* end);
+
+  // Returns the declaration of the function |index|.
+  std::unique_ptr<Function> MakeDeclaration(size_t index);
+
+  // Returns an iterator to the function |id| in the module of the context.
+  Module::iterator FindFunction(uint32_t id);
+
+  const MessageConsumer& consumer_;
+  std::unique_ptr<IRContext> context_;
+  std::unique_ptr<IrLoader> loader_;
+  // The parser of the instructions loaded.  It has parsed the global section,
+  // so that the functions are decoded with its types.
+  spv_binary_parser parser_;
+
+  const uint32_t* words_;
+  size_t num_words_;
+  // The offset of the end of the global section.
+  size_t globals_end_;
+  std::vector<FunctionRange> functions_;
+  std::unordered_map<uint32_t, size_t> function_indices_;
+  // For each id, one plus the index of the function it is defined in, or 0
+  // for the ids defined outside of the function bodies.
+  std::vector<uint32_t> id_owners_;
+  // The offset of the first of the debug line instructions preceding the
+  // instruction scanned next, if any.
+  size_t line_run_begin_;
+  // The offset of the instruction scanned next.
+  size_t scan_offset_;
+  std::vector<GlobalUse> global_uses_;
+  // The functions of the entry points, and the exported functions.
+  std::vector<uint32_t> entry_point_ids_;
+  std::vector<uint32_t> exported_ids_;
+  // The offsets of the global instructions set aside, in order.
+  std::vector<size_t> set_aside_offsets_;
+  // The words of the names and decorations of the ids defined in each
+  // function, held while the function is not loaded.
+  std::vector<std::vector<uint32_t>> local_annotations_;
+  // Whether each function is in the call trees of the entry points, and of
+  // the entry points and exported functions.
+  std::vector<bool> in_entry_point_tree_;
+  std::vector<bool> in_reachable_tree_;
+  // The call trees of the context, made of the loaded function if the module
+  // reaches it.
+  IRContext::CallTrees call_trees_;
+
+  size_t next_function_;
+  Function* loaded_function_;
+  // The serialized functions, in order.  They are held until the global
+  // section, which the passes may change, is written before them.
+  std::vector<uint32_t> functions_binary_;
+};
+
+}  // namespace opt
+}  // namespace spvtools
+
+#endif  // SOURCE_OPT_FUNCTION_STREAM_H_
@@ -31,6 +31,7 @@ class GenerateWebGPUInitializersPass : public Pass {
  public:
   const char* name() const override { return "generate-webgpu-initializers"; }
   Status Process() override;
+  bool IsRequired() const override { return true; }
 
   IRContext::Analysis GetPreservedAnalyses() override {
     return IRContext::kAnalysisInstrToBlockMapping |
@@ -363,6 +363,11 @@ void GraphicsRobustAccessPass::ClampIndicesForAccessChain(
                              GetValueForType(maxval, maxval_type));
       }
     } else {
+      // Leave the index alone if it is already known to be in bounds.
+      if (IsIndexInRange(index_inst, &inst, index_type, maxval)) {
+        return SPV_SUCCESS;
+      }
+
       // Generate a clamp instruction.
       assert(maxval >= 1);
       assert(index_width <= 64);  // Otherwise, already returned above.
@@ -798,6 +803,25 @@ Instruction* GraphicsRobustAccessPass::MakeRuntimeArrayLengthInst(
   return array_len;
 }
 
+bool GraphicsRobustAccessPass::IsIndexInRange(
+    Instruction* index, Instruction* access_chain,
+    const analysis::Integer* index_type, uint64_t max_index) {
+  const BasicBlock* bb = context()->get_instr_block(access_chain);
+  if (bb == nullptr || index_type->width() > 64) return false;
+
+  int64_t min_value = 0;
+  int64_t max_value = 0;
+  if (!context()->GetScalarEvolutionAnalysis()->GetValueRange(
+          index, bb, &min_value, &max_value)) {
+    return false;
+  }
+  // The index is treated as signed.  A value below its sign bit is also the
+  // value of the index modulo the width of its type.
+  const uint64_t max_signed = (uint64_t(1) << (index_type->width() - 1)) - 1;
+  return min_value >= 0 &&
+         uint64_t(max_value) <= std::min(max_index, max_signed);
+}
+
 spv_result_t GraphicsRobustAccessPass::ClampCoordinateForImageTexelPointer(
     opt::Instruction* image_texel_pointer) {
   // TODO(dneto): Write tests for this code.
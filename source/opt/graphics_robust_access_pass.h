@@ -68,6 +68,13 @@ class GraphicsRobustAccessPass : public Pass {
   // analyses and records that the module is modified.  This can log a failure.
   void ClampIndicesForAccessChain(Instruction* access_chain);
 
+  // Returns true if |index|, an integer of type |index_type|, is known to be
+  // between 0 and |max_index| whenever |access_chain| executes, in which case
+  // it needs no clamp.  The bounds come from the scalar evolution analysis.
+  bool IsIndexInRange(Instruction* index, Instruction* access_chain,
+                      const analysis::Integer* index_type,
+                      uint64_t max_index);
+
   // Returns the id of the instruction importing the "GLSL.std.450" extended
   // instruction set. If it does not yet exist, the import instruction is
   // created and inserted into the module, and updates |_.modified| and
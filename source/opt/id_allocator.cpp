@@ -0,0 +1,56 @@
+// Copyright (c) 2019 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "source/opt/id_allocator.h"
+
+#include <algorithm>
+#include <cassert>
+
+#include "source/opt/compact_ids_pass.h"
+
+namespace spvtools {
+namespace opt {
+
+IdAllocator::IdAllocator(IRContext* context, uint32_t block_size)
+    : context_(context),
+      block_size_(block_size),
+      max_id_bound_(context->max_id_bound()),
+      next_block_(context->module()->IdBound()),
+      unused_ids_(0) {
+  assert(block_size_ != 0 && "Blocks of ids cannot be empty.");
+}
+
+bool IdAllocator::Reserve(uint32_t* begin, uint32_t* end) {
+  const uint64_t start = next_block_.fetch_add(block_size_);
+  if (start >= max_id_bound_) return false;
+  *begin = static_cast<uint32_t>(start);
+  *end = static_cast<uint32_t>(
+      std::min(start + block_size_, static_cast<uint64_t>(max_id_bound_)));
+  return true;
+}
+
+bool IdAllocator::Finish(bool compact) {
+  const uint64_t bound =
+      std::min(next_block_.load(), static_cast<uint64_t>(max_id_bound_));
+  if (bound > context_->module()->IdBound()) {
+    context_->module()->SetIdBound(static_cast<uint32_t>(bound));
+  }
+  if (!compact || unused_ids_ == 0) return true;
+  unused_ids_ = 0;
+  CompactIdsPass compact_ids;
+  return compact_ids.Run(context_) != Pass::Status::Failure;
+}
+
+}  // namespace opt
+}  // namespace spvtools
@@ -0,0 +1,99 @@
+// Copyright (c) 2019 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef SOURCE_OPT_ID_ALLOCATOR_H_
+#define SOURCE_OPT_ID_ALLOCATOR_H_
+
+#include <atomic>
+#include <cstdint>
+
+#include "source/opt/ir_context.h"
+
+namespace spvtools {
+namespace opt {
+
+// Allocates new ids for the module of a context from several threads at once.
+// Each thread takes its ids from its own |IdAllocator::Range|, which reserves
+// blocks of consecutive ids with a single atomic operation and hands them out
+// without synchronization.
+//
+// The id bound of the module is only updated by |Finish|, once every thread is
+// done.  Ids that were reserved but not handed out leave holes in the id
+// space, which |Finish| can remove with CompactIdsPass.
+class IdAllocator {
+ public:
+  // The ids of one thread.
+  class Range {
+   public:
+    explicit Range(IdAllocator* allocator)
+        : allocator_(allocator), next_id_(0), end_id_(0) {}
+    ~Range() { allocator_->unused_ids_ += end_id_ - next_id_; }
+
+    Range(const Range&) = delete;
+    Range& operator=(const Range&) = delete;
+
+    // Returns a new id, or 0 if the maximum id bound of the context has been
+    // reached.
+    uint32_t TakeNextId() {
+      if (next_id_ == end_id_ && !allocator_->Reserve(&next_id_, &end_id_)) {
+        return 0;
+      }
+      return next_id_++;
+    }
+
+   private:
+    IdAllocator* allocator_;
+    // The ids of the current block that have not been handed out are
+    // [next_id_, end_id_).
+    uint32_t next_id_;
+    uint32_t end_id_;
+  };
+
+  // Creates an allocator of the ids from the current id bound of the module of
+  // |context| up to the maximum id bound of |context|, reserved |block_size|
+  // at a time.
+  explicit IdAllocator(IRContext* context, uint32_t block_size = 64);
+
+  IdAllocator(const IdAllocator&) = delete;
+  IdAllocator& operator=(const IdAllocator&) = delete;
+
+  // Sets the id bound of the module past every id reserved.  Every range must
+  // have been destroyed.  If |compact| is true and some reserved ids were not
+  // handed out, the module is then renumbered by CompactIdsPass, which
+  // invalidates the ids taken from the ranges.  Returns false if the
+  // compaction failed.
+  bool Finish(bool compact);
+
+  // Returns the number of ids reserved by the destroyed ranges but not handed
+  // out.
+  uint32_t unused_ids() const { return unused_ids_; }
+
+ private:
+  // Reserves the next block of ids as [|*begin|, |*end|).  Returns false if no
+  // id is left below the maximum id bound.
+  bool Reserve(uint32_t* begin, uint32_t* end);
+
+  IRContext* context_;
+  const uint32_t block_size_;
+  const uint32_t max_id_bound_;
+  // The first id of the next block.  It is 64-bit so that it cannot wrap
+  // around when threads keep reserving blocks past the maximum id bound.
+  std::atomic<uint64_t> next_block_;
+  std::atomic<uint32_t> unused_ids_;
+};
+
+}  // namespace opt
+}  // namespace spvtools
+
+#endif  // SOURCE_OPT_ID_ALLOCATOR_H_
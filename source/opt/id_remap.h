@@ -0,0 +1,88 @@
+// Copyright (c) 2020 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef SOURCE_OPT_ID_REMAP_H_
+#define SOURCE_OPT_ID_REMAP_H_
+
+#include <cstdint>
+#include <vector>
+
+namespace spvtools {
+namespace opt {
+
+// A map from the ids of a copied piece of code, such as a loop or a function,
+// to the ids of the copy.  The new ids are kept in a vector indexed by the
+// distance of the old id to the smallest id mapped so far.  The ids of a
+// function are close to each other, so this is much faster than a hash map
+// for the many lookups of remapping the operands of a copy.
+//
+// Id 0 is never mapped, and is returned for the ids which are not mapped.
+class IdRemap {
+ public:
+  IdRemap() : first_id_(0) {}
+
+  // Maps |old_id| to |new_id|.
+  void Set(uint32_t old_id, uint32_t new_id) {
+    if (new_ids_.empty()) {
+      first_id_ = old_id;
+    } else if (old_id < first_id_) {
+      // Make room at the front for the ids from |old_id|, and shift the
+      // indices of the mapped ids accordingly.
+      const uint32_t shift = first_id_ - old_id;
+      new_ids_.insert(new_ids_.begin(), shift, 0);
+      for (uint32_t& index : mapped_) index += shift;
+      first_id_ = old_id;
+    }
+    const uint32_t index = old_id - first_id_;
+    if (index >= new_ids_.size()) new_ids_.resize(index + 1, 0);
+    if (new_ids_[index] == 0) mapped_.push_back(index);
+    new_ids_[index] = new_id;
+  }
+
+  // Returns the id |old_id| is mapped to, or 0 if it is not mapped.
+  uint32_t Get(uint32_t old_id) const {
+    const uint32_t index = old_id - first_id_;
+    return old_id >= first_id_ && index < new_ids_.size() ? new_ids_[index]
+                                                           : 0;
+  }
+
+  // Replaces |*id| with the id it is mapped to, if it is mapped.  Returns true
+  // if it is.
+  bool Remap(uint32_t* id) const {
+    const uint32_t new_id = Get(*id);
+    if (new_id == 0) return false;
+    *id = new_id;
+    return true;
+  }
+
+  // Forgets all the mappings.  The table keeps its range, so that mapping the
+  // same ids again, as for each copy of a loop body, does not allocate.
+  void clear() {
+    for (uint32_t index : mapped_) new_ids_[index] = 0;
+    mapped_.clear();
+  }
+
+ private:
+  // The smallest id which may be mapped.
+  uint32_t first_id_;
+  // The id each id from |first_id_| is mapped to, or 0.
+  std::vector<uint32_t> new_ids_;
+  // The indices in |new_ids_| of the mapped ids.
+  std::vector<uint32_t> mapped_;
+};
+
+}  // namespace opt
+}  // namespace spvtools
+
+#endif  // SOURCE_OPT_ID_REMAP_H_
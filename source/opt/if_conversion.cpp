@@ -28,6 +28,7 @@ Pass::Status IfConversion::Process() {
   }
 
   const ValueNumberTable& vn_table = *context()->GetValueNumberTable();
+  context()->BuildDominatorAnalyses(/* post_dominators = */ false);
   bool modified = false;
   std::vector<Instruction*> to_kill;
   for (auto& func : *get_module()) {
@@ -38,6 +39,11 @@ Pass::Status IfConversion::Process() {
       BasicBlock* common = nullptr;
       if (!CheckBlock(&block, dominators, &common)) continue;
 
+      // A biased branch is cheap, while selecting would hoist the values of
+      // the rare side, and let later passes flatten the branch, on every
+      // execution.
+      if (IsBiasedBranch(common)) continue;
+
       // Get an insertion point.
       auto iter = block.begin();
       while (iter != block.end() && iter->opcode() == SpvOpPhi) {
@@ -172,6 +178,27 @@ bool IfConversion::CheckBlock(BasicBlock* block, DominatorAnalysis* dominators,
   return true;
 }
 
+bool IfConversion::IsBiasedBranch(BasicBlock* header) {
+  uint64_t header_count = 0;
+  if (!context()->GetBlockCount(header->id(), &header_count)) return false;
+
+  // An edge straight to the merge block is taken whenever the other is not.
+  Instruction* branch = header->terminator();
+  for (uint32_t i = 1; i < 3; ++i) {
+    const uint32_t target = branch->GetSingleWordInOperand(i);
+    if (target == header->MergeBlockIdIfAny()) continue;
+    uint64_t count = 0;
+    if (!context()->GetBlockCount(target, &count)) return false;
+    const uint64_t other_count =
+        header_count > count ? header_count - count : 0;
+    if (IRContext::IsColdCount(count, header_count) ||
+        IRContext::IsColdCount(other_count, header_count)) {
+      return true;
+    }
+  }
+  return false;
+}
+
 bool IfConversion::CheckPhiUsers(Instruction* phi, BasicBlock* block) {
   return get_def_use_mgr()->WhileEachUser(phi, [block,
                                                 this](Instruction* user) {
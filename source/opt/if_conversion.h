@@ -32,8 +32,8 @@ class IfConversion : public Pass {
   IRContext::Analysis GetPreservedAnalyses() override {
     return IRContext::kAnalysisDefUse | IRContext::kAnalysisDominatorAnalysis |
            IRContext::kAnalysisInstrToBlockMapping | IRContext::kAnalysisCFG |
-           IRContext::kAnalysisNameMap | IRContext::kAnalysisConstants |
-           IRContext::kAnalysisTypes;
+           IRContext::kAnalysisLoopAnalysis | IRContext::kAnalysisNameMap |
+           IRContext::kAnalysisConstants | IRContext::kAnalysisTypes;
   }
 
  private:
@@ -69,6 +69,10 @@ class IfConversion : public Pass {
   bool CheckBlock(BasicBlock* block, DominatorAnalysis* dominators,
                   BasicBlock** common);
 
+  // Returns true if the block counts of the profile show that one side of the
+  // conditional branch ending |header| is rarely taken.
+  bool IsBiasedBranch(BasicBlock* header);
+
   // Moves |inst| to |target_block| if it does not already dominate the block.
   // Any instructions that |inst| depends on are move if necessary.  It is
   // assumed that |inst| can be hoisted to |target_block| as defined by
@@ -0,0 +1,226 @@
+// Copyright (c) 2019 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "source/opt/inline_cost_pass.h"
+
+#include <cassert>
+#include <memory>
+#include <utility>
+
+#include "source/opt/ir_context.h"
+
+namespace spvtools {
+namespace opt {
+namespace {
+
+const uint32_t kEntryPointFunctionIdInIdx = 1;
+const uint32_t kFunctionCallFunctionIdInIdx = 0;
+
+// The cost of the call instruction itself, which inlining removes.
+const int32_t kCallCost = 1;
+
+// The cost saved by a constant argument, which usually lets some of the
+// inlined code be folded.
+const int32_t kConstantArgumentBonus = 4;
+
+// Inlining calls that are not required for legality grows a function by at
+// most this many times the budget.
+const uint32_t kMaxGrowthFactor = 8;
+
+// Returns the result ids of the functions called by |func|, once per call.
+std::vector<uint32_t> GetCallees(const Function& func) {
+  std::vector<uint32_t> callees;
+  func.ForEachInst([&callees](const Instruction* inst) {
+    if (inst->opcode() == SpvOpFunctionCall) {
+      callees.push_back(
+          inst->GetSingleWordInOperand(kFunctionCallFunctionIdInIdx));
+    }
+  });
+  return callees;
+}
+
+}  // namespace
+
+std::vector<Function*> InlineCostPass::BottomUpOrder() {
+  std::vector<Function*> order;
+  std::unordered_set<uint32_t> visited;
+  // The functions being visited, each with the callees left to visit.
+  std::vector<std::pair<Function*, std::vector<uint32_t>>> stack;
+  for (auto& root : *get_module()) {
+    if (!visited.insert(root.result_id()).second) continue;
+    stack.emplace_back(&root, GetCallees(root));
+    while (!stack.empty()) {
+      std::vector<uint32_t>& callees = stack.back().second;
+      if (callees.empty()) {
+        order.push_back(stack.back().first);
+        stack.pop_back();
+        continue;
+      }
+      const uint32_t callee_id = callees.back();
+      callees.pop_back();
+      auto callee = id2function_.find(callee_id);
+      if (callee == id2function_.end() || !visited.insert(callee_id).second) {
+        continue;
+      }
+      stack.emplace_back(callee->second, GetCallees(*callee->second));
+    }
+  }
+  return order;
+}
+
+uint32_t InlineCostPass::FunctionSize(const Function& func) {
+  uint32_t size = 0;
+  func.ForEachInst([&size](const Instruction*) { ++size; });
+  return size;
+}
+
+bool InlineCostPass::MustInline(const Instruction* call_inst) {
+  if (HasOpaqueArgsOrReturn(call_inst)) return true;
+  analysis::DefUseManager* def_use_mgr = get_def_use_mgr();
+  for (uint32_t i = kFunctionCallFunctionIdInIdx + 1;
+       i < call_inst->NumInOperands(); ++i) {
+    const Instruction* arg =
+        def_use_mgr->GetDef(call_inst->GetSingleWordInOperand(i));
+    if (arg->opcode() == SpvOpVariable ||
+        arg->opcode() == SpvOpFunctionParameter) {
+      continue;
+    }
+    const Instruction* type = def_use_mgr->GetDef(arg->type_id());
+    if (type->opcode() == SpvOpTypePointer) return true;
+  }
+  return false;
+}
+
+int32_t InlineCostPass::InlineCost(const Instruction* call_inst) {
+  const uint32_t callee_id =
+      call_inst->GetSingleWordInOperand(kFunctionCallFunctionIdInIdx);
+  auto size = function_sizes_.find(callee_id);
+  assert(size != function_sizes_.end() &&
+         "Callees are processed before their callers.");
+  int32_t cost = static_cast<int32_t>(size->second) - kCallCost;
+  analysis::DefUseManager* def_use_mgr = get_def_use_mgr();
+  for (uint32_t i = kFunctionCallFunctionIdInIdx + 1;
+       i < call_inst->NumInOperands(); ++i) {
+    // The argument no longer needs to be passed.
+    --cost;
+    const Instruction* arg =
+        def_use_mgr->GetDef(call_inst->GetSingleWordInOperand(i));
+    if (arg->IsConstant()) cost -= kConstantArgumentBonus;
+  }
+  return cost;
+}
+
+bool InlineCostPass::IsOnlyCallSite(const Instruction* call_inst) {
+  if (has_linkage_) return false;
+  const uint32_t callee_id =
+      call_inst->GetSingleWordInOperand(kFunctionCallFunctionIdInIdx);
+  return call_counts_[callee_id] == 1 && entry_point_ids_.count(callee_id) == 0;
+}
+
+void InlineCostPass::UpdateCallCounts(const Function& callee) {
+  --call_counts_[callee.result_id()];
+  for (uint32_t id : GetCallees(callee)) ++call_counts_[id];
+}
+
+Pass::Status InlineCostPass::InlineCalls(Function* func) {
+  bool modified = false;
+  uint32_t size = FunctionSize(*func);
+  const uint32_t max_size = size + kMaxGrowthFactor * budget_;
+  // Using block iterators here because of block erasures and insertions.
+  for (auto bi = func->begin(); bi != func->end(); ++bi) {
+    for (auto ii = bi->begin(); ii != bi->end();) {
+      if (!IsInlinableFunctionCall(&*ii)) {
+        ++ii;
+        continue;
+      }
+      // Calls that are required for legality are always inlined.  The others
+      // are inlined if they are cheap enough, or if the callee can be
+      // removed afterwards, until the function has grown too much.
+      const bool inline_call =
+          MustInline(&*ii) ||
+          (size <= max_size &&
+           (IsOnlyCallSite(&*ii) ||
+            InlineCost(&*ii) <= static_cast<int32_t>(budget_)));
+      if (!inline_call) {
+        ++ii;
+        continue;
+      }
+
+      const Function& callee = *id2function_[ii->GetSingleWordInOperand(
+          kFunctionCallFunctionIdInIdx)];
+      std::vector<std::unique_ptr<BasicBlock>> newBlocks;
+      std::vector<std::unique_ptr<Instruction>> newVars;
+      if (!GenInlineCode(&newBlocks, &newVars, ii, bi)) {
+        return Status::Failure;
+      }
+      // If call block is replaced with more than one block, point
+      // succeeding phis at new last block.
+      if (newBlocks.size() > 1) UpdateSucceedingPhis(newBlocks);
+
+      // Replace old calling block with new block(s).
+      context()->KillNamesAndDecorates(&*ii);
+      bi = bi.Erase();
+      for (auto& bb : newBlocks) {
+        bb->SetParent(func);
+      }
+      bi = bi.InsertBefore(&newBlocks);
+      // Insert new function variables.
+      if (newVars.size() > 0)
+        func->begin()->begin().InsertBefore(std::move(newVars));
+
+      size += function_sizes_[callee.result_id()];
+      UpdateCallCounts(callee);
+      // Restart inlining at beginning of calling block, so that the calls
+      // left in the inlined code are considered in turn.
+      ii = bi->begin();
+      modified = true;
+    }
+  }
+  return (modified ? Status::SuccessWithChange : Status::SuccessWithoutChange);
+}
+
+Pass::Status InlineCostPass::Process() {
+  InitializeInline();
+  has_linkage_ =
+      context()->get_feature_mgr()->HasCapability(SpvCapabilityLinkage);
+  entry_point_ids_.clear();
+  for (auto& entry_point : get_module()->entry_points()) {
+    entry_point_ids_.insert(
+        entry_point.GetSingleWordInOperand(kEntryPointFunctionIdInIdx));
+  }
+  call_counts_.clear();
+  for (auto& func : *get_module()) {
+    for (uint32_t id : GetCallees(func)) ++call_counts_[id];
+  }
+  function_sizes_.clear();
+
+  // Process callees before their callers, so that the cost of a call is the
+  // size of the callee after its own calls were inlined.
+  Status status = Status::SuccessWithoutChange;
+  for (Function* func : BottomUpOrder()) {
+    if (ShouldProcessFunction(func)) {
+      Status func_status = InlineCalls(func);
+      if (func_status == Status::Failure) return func_status;
+      if (func_status == Status::SuccessWithChange) {
+        RecordChangedFunction(func);
+        status = func_status;
+      }
+    }
+    function_sizes_[func->result_id()] = FunctionSize(*func);
+  }
+  return status;
+}
+
+}  // namespace opt
+}  // namespace spvtools
@@ -0,0 +1,90 @@
+// Copyright (c) 2019 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef SOURCE_OPT_INLINE_COST_PASS_H_
+#define SOURCE_OPT_INLINE_COST_PASS_H_
+
+#include <cstdint>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+#include "source/opt/inline_pass.h"
+#include "source/opt/module.h"
+
+namespace spvtools {
+namespace opt {
+
+// See optimizer.hpp for documentation.
+class InlineCostPass : public InlinePass {
+ public:
+  explicit InlineCostPass(uint32_t budget)
+      : budget_(budget), has_linkage_(false) {}
+  Status Process() override;
+
+  const char* name() const override { return "inline-budget"; }
+
+ private:
+  // Returns the functions of the module ordered so that every function comes
+  // after the functions it calls.  The call graph of a SPIR-V module has no
+  // cycles, so this is the bottom-up order of its strongly connected
+  // components.
+  std::vector<Function*> BottomUpOrder();
+
+  // Returns the number of instructions of |func|.
+  static uint32_t FunctionSize(const Function& func);
+
+  // Returns true if |call_inst| must be inlined for the module to be legal:
+  // it passes or returns an opaque type, or passes a pointer which is not a
+  // memory object declaration.
+  bool MustInline(const Instruction* call_inst);
+
+  // Returns the cost of inlining |call_inst|: the size of the callee, less the
+  // instructions of the call itself and a bonus for each constant argument.
+  // The cost may be negative.
+  int32_t InlineCost(const Instruction* call_inst);
+
+  // Returns true if the callee of |call_inst| has no other call site and can
+  // be removed once it is inlined.
+  bool IsOnlyCallSite(const Instruction* call_inst);
+
+  // Inlines the calls in |func| that are required for legality, and the
+  // other calls whose cost is within the budget as long as |func| has not
+  // grown too much.  Returns the status.
+  Status InlineCalls(Function* func);
+
+  // Updates the call counts after a call to |callee| was inlined.
+  void UpdateCallCounts(const Function& callee);
+
+  // The largest cost of a call that is inlined.
+  uint32_t budget_;
+
+  // The number of call sites of each function, by result id.
+  std::unordered_map<uint32_t, uint32_t> call_counts_;
+
+  // The size of each function that was already processed, by result id.
+  std::unordered_map<uint32_t, uint32_t> function_sizes_;
+
+  // True if functions can be called from outside the module, in which case
+  // a function cannot be assumed dead once its last call is inlined.
+  bool has_linkage_;
+
+  // The result ids of the entry point functions.
+  std::unordered_set<uint32_t> entry_point_ids_;
+};
+
+}  // namespace opt
+}  // namespace spvtools
+
+#endif  // SOURCE_OPT_INLINE_COST_PASS_H_
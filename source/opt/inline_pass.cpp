@@ -27,10 +27,13 @@
 static const int kSpvFunctionCallFunctionId = 2;
 static const int kSpvFunctionCallArgumentId = 3;
 static const int kSpvReturnValueId = 0;
+static const int kSpvTypePointerTypeId = 1;
 
 namespace spvtools {
 namespace opt {
 
+const uint32_t InlinePass::kNotInCallee;
+
 uint32_t InlinePass::AddPointerToType(uint32_t type_id,
                                       SpvStorageClass storage_class) {
   uint32_t resultId = context()->TakeNextId();
@@ -125,35 +128,72 @@ uint32_t InlinePass::GetFalseId() {
   return false_id_;
 }
 
-void InlinePass::MapParams(
-    Function* calleeFn, BasicBlock::iterator call_inst_itr,
-    std::unordered_map<uint32_t, uint32_t>* callee2caller) {
+const InlinePass::InlineTemplate& InlinePass::GetInlineTemplate(
+    Function* calleeFn) {
+  auto existing = inline_templates_.find(calleeFn->result_id());
+  if (existing != inline_templates_.end()) return existing->second;
+
+  InlineTemplate& callee = inline_templates_[calleeFn->result_id()];
+  std::unordered_map<uint32_t, uint32_t> numbers;
+  calleeFn->ForEachInst([&callee, &numbers](const Instruction* cpi) {
+    callee.insts.push_back(cpi);
+    const uint32_t rid = cpi->result_id();
+    if (rid == 0) {
+      callee.result_numbers.push_back(kNotInCallee);
+      return;
+    }
+    const uint32_t number = static_cast<uint32_t>(numbers.size());
+    numbers[rid] = number;
+    callee.result_numbers.push_back(number);
+  });
+  callee.num_ids = static_cast<uint32_t>(numbers.size());
+
+  // Resolve the operands once all ids are numbered, since they may be forward
+  // references.
+  for (const Instruction* cpi : callee.insts) {
+    callee.first_in_id.push_back(
+        static_cast<uint32_t>(callee.in_id_numbers.size()));
+    cpi->ForEachInId([&callee, &numbers](const uint32_t* iid) {
+      const auto number = numbers.find(*iid);
+      callee.in_id_numbers.push_back(
+          number == numbers.end() ? kNotInCallee : number->second);
+    });
+  }
+  return callee;
+}
+
+void InlinePass::MapParams(const InlineTemplate& callee,
+                           BasicBlock::iterator call_inst_itr,
+                           std::vector<uint32_t>* callee2caller) {
+  // The parameters follow the OpFunction instruction.
   int param_idx = 0;
-  calleeFn->ForEachParam(
-      [&call_inst_itr, &param_idx, &callee2caller](const Instruction* cpi) {
-        const uint32_t pid = cpi->result_id();
-        (*callee2caller)[pid] = call_inst_itr->GetSingleWordOperand(
-            kSpvFunctionCallArgumentId + param_idx);
-        ++param_idx;
-      });
+  for (uint32_t i = 1; callee.insts[i]->opcode() == SpvOpFunctionParameter;
+       ++i) {
+    (*callee2caller)[callee.result_numbers[i]] =
+        call_inst_itr->GetSingleWordOperand(kSpvFunctionCallArgumentId +
+                                            param_idx);
+    ++param_idx;
+  }
 }
 
 bool InlinePass::CloneAndMapLocals(
-    Function* calleeFn, std::vector<std::unique_ptr<Instruction>>* new_vars,
-    std::unordered_map<uint32_t, uint32_t>* callee2caller) {
-  auto callee_block_itr = calleeFn->begin();
-  auto callee_var_itr = callee_block_itr->begin();
-  while (callee_var_itr->opcode() == SpvOp::SpvOpVariable) {
-    std::unique_ptr<Instruction> var_inst(callee_var_itr->Clone(context()));
+    const InlineTemplate& callee,
+    std::vector<std::unique_ptr<Instruction>>* new_vars,
+    std::vector<uint32_t>* callee2caller) {
+  // The variables follow the label of the first block.
+  uint32_t i = 1;
+  while (callee.insts[i]->opcode() != SpvOpLabel) ++i;
+  for (++i; callee.insts[i]->opcode() == SpvOp::SpvOpVariable; ++i) {
+    const Instruction* callee_var = callee.insts[i];
+    std::unique_ptr<Instruction> var_inst(callee_var->Clone(context()));
     uint32_t newId = context()->TakeNextId();
     if (newId == 0) {
       return false;
     }
-    get_decoration_mgr()->CloneDecorations(callee_var_itr->result_id(), newId);
+    get_decoration_mgr()->CloneDecorations(callee_var->result_id(), newId);
     var_inst->SetResultId(newId);
-    (*callee2caller)[callee_var_itr->result_id()] = newId;
+    (*callee2caller)[callee.result_numbers[i]] = newId;
     new_vars->push_back(std::move(var_inst));
-    ++callee_var_itr;
   }
   return true;
 }
@@ -197,13 +237,12 @@ bool InlinePass::IsSameBlockOp(const Instruction* inst) const {
 
 bool InlinePass::CloneSameBlockOps(
     std::unique_ptr<Instruction>* inst,
-    std::unordered_map<uint32_t, uint32_t>* postCallSB,
-    std::unordered_map<uint32_t, Instruction*>* preCallSB,
+    IdRemap* postCallSB, std::unordered_map<uint32_t, Instruction*>* preCallSB,
     std::unique_ptr<BasicBlock>* block_ptr) {
   return (*inst)->WhileEachInId([&postCallSB, &preCallSB, &block_ptr,
                                  this](uint32_t* iid) {
-    const auto mapItr = (*postCallSB).find(*iid);
-    if (mapItr == (*postCallSB).end()) {
+    // Reset same-block op operand, if it was already cloned.
+    if (!postCallSB->Remap(iid)) {
       const auto mapItr2 = (*preCallSB).find(*iid);
       if (mapItr2 != (*preCallSB).end()) {
         // Clone pre-call same-block ops, map result id.
@@ -220,13 +259,10 @@ bool InlinePass::CloneSameBlockOps(
         }
         get_decoration_mgr()->CloneDecorations(rid, nid);
         sb_inst->SetResultId(nid);
-        (*postCallSB)[rid] = nid;
+        postCallSB->Set(rid, nid);
         *iid = nid;
         (*block_ptr)->AddInstruction(std::move(sb_inst));
       }
-    } else {
-      // Reset same-block op operand.
-      *iid = mapItr->second;
     }
     return true;
   });
@@ -237,13 +273,10 @@ bool InlinePass::GenInlineCode(
     std::vector<std::unique_ptr<Instruction>>* new_vars,
     BasicBlock::iterator call_inst_itr,
     UptrVectorIterator<BasicBlock> call_block_itr) {
-  // Map from all ids in the callee to their equivalent id in the caller
-  // as callee instructions are copied into caller.
-  std::unordered_map<uint32_t, uint32_t> callee2caller;
   // Pre-call same-block insts
   std::unordered_map<uint32_t, Instruction*> preCallSB;
   // Post-call same-block op ids
-  std::unordered_map<uint32_t, uint32_t> postCallSB;
+  IdRemap postCallSB;
 
   // Invalidate the def-use chains.  They are not kept up to date while
   // inlining.  However, certain calls try to keep them up-to-date if they are
@@ -253,16 +286,28 @@ bool InlinePass::GenInlineCode(
   Function* calleeFn = id2function_[call_inst_itr->GetSingleWordOperand(
       kSpvFunctionCallFunctionId)];
 
+  // The caller is about to change, so its template is no longer valid.
+  inline_templates_.erase(call_block_itr->GetParent()->result_id());
+  const InlineTemplate& callee = GetInlineTemplate(calleeFn);
+  // The copies of the callee instructions are allocated next to each other,
+  // so that the inlined blocks are scanned sequentially.
+  context()->instruction_pool()->ReserveRun(callee.insts.size());
+
+  // Map from the number of each id in the callee to its equivalent id in the
+  // caller as callee instructions are copied into caller, or 0 if the id is
+  // not mapped yet.
+  std::vector<uint32_t> callee2caller(callee.num_ids, 0);
+
   // Check for multiple returns in the callee.
   auto fi = early_return_funcs_.find(calleeFn->result_id());
   const bool earlyReturn = fi != early_return_funcs_.end();
 
   // Map parameters to actual arguments.
-  MapParams(calleeFn, call_inst_itr, &callee2caller);
+  MapParams(callee, call_inst_itr, &callee2caller);
 
   // Define caller local variables for all callee variables and create map to
   // them.
-  if (!CloneAndMapLocals(calleeFn, new_vars, &callee2caller)) {
+  if (!CloneAndMapLocals(callee, new_vars, &callee2caller)) {
     return false;
   }
 
@@ -277,13 +322,6 @@ bool InlinePass::GenInlineCode(
     }
   }
 
-  // Create set of callee result ids. Used to detect forward references
-  std::unordered_set<uint32_t> callee_result_ids;
-  calleeFn->ForEachInst([&callee_result_ids](const Instruction* cpi) {
-    const uint32_t rid = cpi->result_id();
-    if (rid != 0) callee_result_ids.insert(rid);
-  });
-
   // If the caller is a loop header and the callee has multiple blocks, then the
   // normal inlining logic will place the OpLoopMerge in the last of several
   // blocks in the loop.  Instead, it should be placed at the end of the first
@@ -309,13 +347,16 @@ bool InlinePass::GenInlineCode(
   // of the first callee block.  It is appended to new_blocks only when
   // it is complete.
   std::unique_ptr<BasicBlock> new_blk_ptr;
-  bool successful = calleeFn->WhileEachInst(
-      [&new_blocks, &callee2caller, &call_block_itr, &call_inst_itr,
+  auto inline_inst =
+      [&new_blocks, &callee, &callee2caller, &call_block_itr, &call_inst_itr,
        &new_blk_ptr, &prevInstWasReturn, &returnLabelId, &returnVarId,
        caller_is_loop_header, callee_begins_with_structured_header,
        &calleeTypeId, &multiBlocks, &postCallSB, &preCallSB, earlyReturn,
-       &singleTripLoopHeaderId, &singleTripLoopContinueId, &callee_result_ids,
-       this](const Instruction* cpi) {
+       &singleTripLoopHeaderId, &singleTripLoopContinueId,
+       this](uint32_t inst_idx) {
+        const Instruction* cpi = callee.insts[inst_idx];
+        const uint32_t* in_id_numbers =
+            callee.in_id_numbers.data() + callee.first_in_id[inst_idx];
         switch (cpi->opcode()) {
           case SpvOpFunction:
           case SpvOpFunctionParameter:
@@ -323,9 +364,10 @@ bool InlinePass::GenInlineCode(
             break;
           case SpvOpVariable:
             if (cpi->NumInOperands() == 2) {
-              assert(callee2caller.count(cpi->result_id()) &&
+              uint32_t new_var_id =
+                  callee2caller[callee.result_numbers[inst_idx]];
+              assert(new_var_id != 0 &&
                      "Expected the variable to have already been mapped.");
-              uint32_t new_var_id = callee2caller.at(cpi->result_id());
 
               // The initializer must be a constant or global value.  No mapped
               // should be used.
@@ -368,11 +410,8 @@ bool InlinePass::GenInlineCode(
               new_blocks->push_back(std::move(new_blk_ptr));
               // If result id is already mapped, use it, otherwise get a new
               // one.
-              const uint32_t rid = cpi->result_id();
-              const auto mapItr = callee2caller.find(rid);
-              labelId = (mapItr != callee2caller.end())
-                            ? mapItr->second
-                            : context()->TakeNextId();
+              labelId = callee2caller[callee.result_numbers[inst_idx]];
+              if (labelId == 0) labelId = context()->TakeNextId();
               if (labelId == 0) {
                 return false;
               }
@@ -380,7 +419,7 @@ bool InlinePass::GenInlineCode(
               // First block needs to use label of original block
               // but map callee label in case of phi reference.
               labelId = call_block_itr->id();
-              callee2caller[cpi->result_id()] = labelId;
+              callee2caller[callee.result_numbers[inst_idx]] = labelId;
               firstBlock = true;
             }
             // Create first/next block.
@@ -419,7 +458,8 @@ bool InlinePass::GenInlineCode(
                 // Reset the mapping of the callee's entry block to point to
                 // the guard block.  Do this so we can fix up phis later on to
                 // satisfy dominance.
-                callee2caller[cpi->result_id()] = guard_block_id;
+                callee2caller[callee.result_numbers[inst_idx]] =
+                    guard_block_id;
               }
               // If callee has early return, insert a header block for
               // single-trip loop that will encompass callee code.  Start
@@ -459,7 +499,7 @@ bool InlinePass::GenInlineCode(
                 // Reset the mapping of the callee's entry block to point to
                 // the post-header block.  Do this so we can fix up phis later
                 // on to satisfy dominance.
-                callee2caller[cpi->result_id()] = postHeaderId;
+                callee2caller[callee.result_numbers[inst_idx]] = postHeaderId;
               }
             } else {
               multiBlocks = true;
@@ -469,9 +509,9 @@ bool InlinePass::GenInlineCode(
             // Store return value to return variable.
             assert(returnVarId != 0);
             uint32_t valId = cpi->GetInOperand(kSpvReturnValueId).words[0];
-            const auto mapItr = callee2caller.find(valId);
-            if (mapItr != callee2caller.end()) {
-              valId = mapItr->second;
+            const uint32_t valNumber = in_id_numbers[kSpvReturnValueId];
+            if (valNumber != kNotInCallee && callee2caller[valNumber] != 0) {
+              valId = callee2caller[valNumber];
             }
             AddStore(returnVarId, valId, &new_blk_ptr);
 
@@ -533,7 +573,7 @@ bool InlinePass::GenInlineCode(
                 // Remember same-block ops in this block.
                 if (IsSameBlockOp(&*cp_inst)) {
                   const uint32_t rid = cp_inst->result_id();
-                  postCallSB[rid] = rid;
+                  postCallSB.Set(rid, rid);
                 }
               }
               new_blk_ptr->AddInstruction(std::move(cp_inst));
@@ -545,21 +585,19 @@ bool InlinePass::GenInlineCode(
             // Copy callee instruction and remap all input Ids.
             std::unique_ptr<Instruction> cp_inst(cpi->Clone(context()));
             bool succeeded = cp_inst->WhileEachInId(
-                [&callee2caller, &callee_result_ids, this](uint32_t* iid) {
-                  const auto mapItr = callee2caller.find(*iid);
-                  if (mapItr != callee2caller.end()) {
-                    *iid = mapItr->second;
-                  } else if (callee_result_ids.find(*iid) !=
-                             callee_result_ids.end()) {
+                [&callee2caller, &in_id_numbers, this](uint32_t* iid) {
+                  const uint32_t number = *in_id_numbers++;
+                  if (number == kNotInCallee) return true;
+                  if (callee2caller[number] == 0) {
                     // Forward reference. Allocate a new id, map it,
                     // use it and check for it when remapping result ids
                     const uint32_t nid = context()->TakeNextId();
                     if (nid == 0) {
                       return false;
                     }
-                    callee2caller[*iid] = nid;
-                    *iid = nid;
+                    callee2caller[number] = nid;
                   }
+                  *iid = callee2caller[number];
                   return true;
                 });
             if (!succeeded) {
@@ -569,16 +607,14 @@ bool InlinePass::GenInlineCode(
             // value, else use next id.
             const uint32_t rid = cp_inst->result_id();
             if (rid != 0) {
-              const auto mapItr = callee2caller.find(rid);
-              uint32_t nid;
-              if (mapItr != callee2caller.end()) {
-                nid = mapItr->second;
-              } else {
+              const uint32_t number = callee.result_numbers[inst_idx];
+              uint32_t nid = callee2caller[number];
+              if (nid == 0) {
                 nid = context()->TakeNextId();
                 if (nid == 0) {
                   return false;
                 }
-                callee2caller[rid] = nid;
+                callee2caller[number] = nid;
               }
               cp_inst->SetResultId(nid);
               get_decoration_mgr()->CloneDecorations(rid, nid);
@@ -587,10 +623,10 @@ bool InlinePass::GenInlineCode(
           } break;
         }
         return true;
-      });
+      };
 
-  if (!successful) {
-    return false;
+  for (uint32_t i = 0; i < callee.insts.size(); ++i) {
+    if (!inline_inst(i)) return false;
   }
 
   if (caller_is_loop_header && (new_blocks->size() > 1)) {
@@ -627,6 +663,43 @@ bool InlinePass::IsInlinableFunctionCall(const Instruction* inst) {
   return ci != inlinable_.cend();
 }
 
+bool InlinePass::IsOpaqueType(uint32_t typeId) {
+  const Instruction* typeInst = get_def_use_mgr()->GetDef(typeId);
+  switch (typeInst->opcode()) {
+    case SpvOpTypeSampler:
+    case SpvOpTypeImage:
+    case SpvOpTypeSampledImage:
+      return true;
+    case SpvOpTypePointer:
+      return IsOpaqueType(
+          typeInst->GetSingleWordInOperand(kSpvTypePointerTypeId));
+    default:
+      break;
+  }
+  // TODO(greg-lunarg): Handle arrays containing opaque type
+  if (typeInst->opcode() != SpvOpTypeStruct) return false;
+  // Return true if any member is opaque
+  return !typeInst->WhileEachInId([this](const uint32_t* tid) {
+    if (IsOpaqueType(*tid)) return false;
+    return true;
+  });
+}
+
+bool InlinePass::HasOpaqueArgsOrReturn(const Instruction* callInst) {
+  // Check return type
+  if (IsOpaqueType(callInst->type_id())) return true;
+  // Check args
+  int icnt = 0;
+  return !callInst->WhileEachInId([&icnt, this](const uint32_t* iid) {
+    if (icnt > 0) {
+      const Instruction* argInst = get_def_use_mgr()->GetDef(*iid);
+      if (IsOpaqueType(argInst->type_id())) return false;
+    }
+    ++icnt;
+    return true;
+  });
+}
+
 void InlinePass::UpdateSucceedingPhis(
     std::vector<std::unique_ptr<BasicBlock>>& new_blocks) {
   const auto firstBlk = new_blocks.begin();
@@ -735,6 +808,7 @@ void InlinePass::InitializeInline() {
   id2function_.clear();
   id2block_.clear();
   inlinable_.clear();
+  inline_templates_.clear();
   no_return_in_loop_.clear();
   early_return_funcs_.clear();
   funcs_called_from_continue_ =
@@ -18,6 +18,7 @@
 #define SOURCE_OPT_INLINE_PASS_H_
 
 #include <algorithm>
+#include <cstdint>
 #include <list>
 #include <memory>
 #include <set>
@@ -25,6 +26,7 @@
 #include <vector>
 
 #include "source/opt/decoration_manager.h"
+#include "source/opt/id_remap.h"
 #include "source/opt/module.h"
 #include "source/opt/pass.h"
 
@@ -39,6 +41,28 @@ class InlinePass : public Pass {
   virtual ~InlinePass() = default;
 
  protected:
+  // A callee prepared for being inlined, shared by all the calls to it.  The
+  // ids defined in the callee are numbered densely in order of definition,
+  // and the operands are resolved to these numbers once, so that the ids of
+  // each inlined copy are mapped through a vector indexed by number.
+  struct InlineTemplate {
+    // The instructions of the callee, in order.
+    std::vector<const Instruction*> insts;
+    // The number of ids defined in the callee.
+    uint32_t num_ids;
+    // The number of the result id of each instruction, or |kNotInCallee|.
+    std::vector<uint32_t> result_numbers;
+    // The numbers of the in-operand ids of all instructions, in order, with
+    // |kNotInCallee| for the ids defined outside of the callee.
+    std::vector<uint32_t> in_id_numbers;
+    // The position in |in_id_numbers| of the in-operand ids of each
+    // instruction.
+    std::vector<uint32_t> first_in_id;
+  };
+
+  // The number of the ids which are not defined in the callee.
+  static const uint32_t kNotInCallee = UINT32_MAX;
+
   InlinePass();
 
   // Add pointer to type to module and return resultId.  Returns 0 if the type
@@ -72,14 +96,18 @@ class InlinePass : public Pass {
   // the value could not be created.
   uint32_t GetFalseId();
 
+  // Returns the template of |calleeFn|, building it on first use.
+  const InlineTemplate& GetInlineTemplate(Function* calleeFn);
+
   // Map callee params to caller args
-  void MapParams(Function* calleeFn, BasicBlock::iterator call_inst_itr,
-                 std::unordered_map<uint32_t, uint32_t>* callee2caller);
+  void MapParams(const InlineTemplate& callee,
+                 BasicBlock::iterator call_inst_itr,
+                 std::vector<uint32_t>* callee2caller);
 
   // Clone and map callee locals.  Return true if successful.
-  bool CloneAndMapLocals(Function* calleeFn,
+  bool CloneAndMapLocals(const InlineTemplate& callee,
                          std::vector<std::unique_ptr<Instruction>>* new_vars,
-                         std::unordered_map<uint32_t, uint32_t>* callee2caller);
+                         std::vector<uint32_t>* callee2caller);
 
   // Create return variable for callee clone code.  The return type of
   // |calleeFn| must not be void.  Returns  the id of the return variable if
@@ -96,7 +124,7 @@ class InlinePass : public Pass {
   // postCallSB for instructions already cloned. Add cloned instruction
   // to postCallSB.
   bool CloneSameBlockOps(std::unique_ptr<Instruction>* inst,
-                         std::unordered_map<uint32_t, uint32_t>* postCallSB,
+                         IdRemap* postCallSB,
                          std::unordered_map<uint32_t, Instruction*>* preCallSB,
                          std::unique_ptr<BasicBlock>* block_ptr);
 
@@ -124,6 +152,12 @@ class InlinePass : public Pass {
   // Return true if |inst| is a function call that can be inlined.
   bool IsInlinableFunctionCall(const Instruction* inst);
 
+  // Return true if |typeId| is or contains opaque type
+  bool IsOpaqueType(uint32_t typeId);
+
+  // Return true if function call |callInst| has opaque argument or return type
+  bool HasOpaqueArgsOrReturn(const Instruction* callInst);
+
   // Return true if |func| does not have a return that is
   // nested in a structured if, switch or loop.
   bool HasNoReturnInStructuredConstruct(Function* func);
@@ -156,6 +190,10 @@ class InlinePass : public Pass {
   // CFG. It has functionality not present in CFG. Consolidate.
   std::unordered_map<uint32_t, BasicBlock*> id2block_;
 
+  // The template of each callee inlined so far, by function id.  The
+  // template of a function is dropped when a call is inlined into it.
+  std::unordered_map<uint32_t, InlineTemplate> inline_templates_;
+
   // Set of ids of functions with early return.
   std::set<uint32_t> early_return_funcs_;
 
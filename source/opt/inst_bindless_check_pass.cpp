@@ -16,6 +16,13 @@
 
 #include "inst_bindless_check_pass.h"
 
+#include <map>
+#include <utility>
+#include <vector>
+
+#include "source/opt/value_number_table.h"
+#include "source/spirv_constant.h"
+
 namespace {
 
 // Input Operand Indices
@@ -259,6 +266,9 @@ void InstBindlessCheckPass::GenCheckCode(
   InstructionBuilder builder(
       context(), back_blk_ptr,
       IRContext::kAnalysisDefUse | IRContext::kAnalysisInstrToBlockMapping);
+  if (sample_rate_ > 1) {
+    check_id = GenSampleCheckCode(check_id, stage_idx, &builder);
+  }
   // Gen conditional branch on check_id. Valid branch generates original
   // reference. Invalid generates debug output and zero result (if needed).
   uint32_t merge_blk_id = TakeNextId();
@@ -279,9 +289,40 @@ void InstBindlessCheckPass::GenCheckCode(
   // Gen invalid block
   new_blk_ptr.reset(new BasicBlock(std::move(invalid_label)));
   builder.SetInsertPoint(&*new_blk_ptr);
-  uint32_t u_index_id = GenUintCastCode(ref->index_id, &builder);
-  GenDebugStreamWrite(uid2offset_[ref->ref_inst->unique_id()], stage_idx,
-                      {error_id, u_index_id, length_id}, &builder);
+  if (sample_rate_ > 1) {
+    // Only write the first error of the reference in each invocation. Gen
+    // a branch around the write if the error was already reported.
+    uint32_t reported_var_id = GenReportedVar();
+    uint32_t reported_id = GenVarLoad(reported_var_id, &builder);
+    uint32_t write_blk_id = TakeNextId();
+    uint32_t write_merge_blk_id = TakeNextId();
+    std::unique_ptr<Instruction> write_label(NewLabel(write_blk_id));
+    std::unique_ptr<Instruction> write_merge_label(
+        NewLabel(write_merge_blk_id));
+    (void)builder.AddConditionalBranch(reported_id, write_merge_blk_id,
+                                       write_blk_id, write_merge_blk_id,
+                                       SpvSelectionControlMaskNone);
+    new_blocks->push_back(std::move(new_blk_ptr));
+    new_blk_ptr.reset(new BasicBlock(std::move(write_label)));
+    builder.SetInsertPoint(&*new_blk_ptr);
+    analysis::ConstantManager* const_mgr = context()->get_constant_mgr();
+    const analysis::Constant* true_const = const_mgr->GetConstant(
+        context()->get_type_mgr()->GetType(GetBoolId()), {true});
+    (void)builder.AddStore(
+        reported_var_id,
+        const_mgr->GetDefiningInstruction(true_const)->result_id());
+    uint32_t u_index_id = GenUintCastCode(ref->index_id, &builder);
+    GenDebugStreamWrite(uid2offset_[ref->ref_inst->unique_id()], stage_idx,
+                        {error_id, u_index_id, length_id}, &builder);
+    (void)builder.AddBranch(write_merge_blk_id);
+    new_blocks->push_back(std::move(new_blk_ptr));
+    new_blk_ptr.reset(new BasicBlock(std::move(write_merge_label)));
+    builder.SetInsertPoint(&*new_blk_ptr);
+  } else {
+    uint32_t u_index_id = GenUintCastCode(ref->index_id, &builder);
+    GenDebugStreamWrite(uid2offset_[ref->ref_inst->unique_id()], stage_idx,
+                        {error_id, u_index_id, length_id}, &builder);
+  }
   // Remember last invalid block id
   uint32_t last_invalid_blk_id = new_blk_ptr->GetLabelInst()->result_id();
   // Gen zero for invalid  reference
@@ -305,6 +346,44 @@ void InstBindlessCheckPass::GenCheckCode(
   context()->KillInst(ref->ref_inst);
 }
 
+uint32_t InstBindlessCheckPass::GenSampleCheckCode(
+    uint32_t check_id, uint32_t stage_idx, InstructionBuilder* builder) {
+  uint32_t hash_id = GenInvocationHashCode(stage_idx, builder);
+  Instruction* rem_inst =
+      builder->AddBinaryOp(GetUintId(), SpvOpUMod, hash_id,
+                           builder->GetUintConstantId(sample_rate_));
+  // Invocations which are not sampled pass every check.
+  Instruction* skip_inst =
+      builder->AddBinaryOp(GetBoolId(), SpvOpINotEqual, rem_inst->result_id(),
+                           builder->GetUintConstantId(0u));
+  return builder
+      ->AddBinaryOp(GetBoolId(), SpvOpLogicalOr, skip_inst->result_id(),
+                    check_id)
+      ->result_id();
+}
+
+uint32_t InstBindlessCheckPass::GenReportedVar() {
+  uint32_t bool_id = GetBoolId();
+  uint32_t ptr_id = context()->get_type_mgr()->FindPointerToType(
+      bool_id, SpvStorageClassPrivate);
+  uint32_t false_id = GetNullId(bool_id);
+  uint32_t var_id = TakeNextId();
+  std::unique_ptr<Instruction> var_inst(new Instruction(
+      context(), SpvOpVariable, ptr_id, var_id,
+      {{spv_operand_type_t::SPV_OPERAND_TYPE_LITERAL_INTEGER,
+        {SpvStorageClassPrivate}},
+       {spv_operand_type_t::SPV_OPERAND_TYPE_ID, {false_id}}}));
+  context()->AddGlobalValue(std::move(var_inst));
+  if (get_module()->version() >= SPV_SPIRV_VERSION_WORD(1, 4)) {
+    // Add the new variable to all entry points.
+    for (auto& entry : get_module()->entry_points()) {
+      entry.AddOperand({SPV_OPERAND_TYPE_ID, {var_id}});
+      context()->AnalyzeUses(&entry);
+    }
+  }
+  return var_id;
+}
+
 void InstBindlessCheckPass::GenBoundsCheckCode(
     BasicBlock::iterator ref_inst_itr,
     UptrVectorIterator<BasicBlock> ref_block_itr, uint32_t stage_idx,
@@ -313,6 +392,7 @@ void InstBindlessCheckPass::GenBoundsCheckCode(
   // save components. If not, return.
   ref_analysis ref;
   if (!AnalyzeDescriptorReference(&*ref_inst_itr, &ref)) return;
+  if (redundant_refs_.count(ref_inst_itr->unique_id())) return;
   Instruction* ptr_inst = get_def_use_mgr()->GetDef(ref.ptr_id);
   if (ptr_inst->opcode() != SpvOp::SpvOpAccessChain) return;
   // If index and bound both compile-time constants and index < bound,
@@ -369,6 +449,7 @@ void InstBindlessCheckPass::GenInitCheckCode(
   // Look for reference through descriptor. If not, return.
   ref_analysis ref;
   if (!AnalyzeDescriptorReference(&*ref_inst_itr, &ref)) return;
+  if (redundant_refs_.count(ref_inst_itr->unique_id())) return;
   // Move original block's preceding instructions into first new block
   std::unique_ptr<BasicBlock> new_blk_ptr;
   MovePreludeCode(ref_inst_itr, ref_block_itr, &new_blk_ptr);
@@ -395,6 +476,43 @@ void InstBindlessCheckPass::GenInitCheckCode(
   MovePostludeCode(ref_block_itr, back_blk_ptr);
 }
 
+void InstBindlessCheckPass::FindRedundantReferences(bool bounds) {
+  redundant_refs_.clear();
+  ValueNumberTable vn_table(context());
+  for (auto& func : *get_module()) {
+    DominatorAnalysis* dom = context()->GetDominatorAnalysis(&func);
+    // The references of |func| seen so far, by variable and index value
+    // number. Blocks appear after their dominators, so a reference is seen
+    // after the references dominating it.
+    std::map<std::pair<uint32_t, uint32_t>, std::vector<Instruction*>> refs;
+    func.ForEachInst([this, bounds, dom, &vn_table, &refs](Instruction* inst) {
+      ref_analysis ref;
+      if (!AnalyzeDescriptorReference(inst, &ref)) return;
+      if (bounds && get_def_use_mgr()->GetDef(ref.ptr_id)->opcode() !=
+                        SpvOp::SpvOpAccessChain) {
+        return;
+      }
+      uint32_t index_vn = 0;
+      if (ref.index_id != 0) {
+        index_vn = vn_table.GetValueNumber(ref.index_id);
+        if (index_vn == 0) return;
+      }
+      std::vector<Instruction*>& same_refs = refs[{ref.var_id, index_vn}];
+      for (Instruction* dom_ref : same_refs) {
+        if (dom->Dominates(dom_ref, inst)) {
+          redundant_refs_.insert(inst->unique_id());
+          return;
+        }
+      }
+      same_refs.push_back(inst);
+    });
+  }
+  // Instrumenting splits blocks without updating these analyses.
+  context()->InvalidateAnalyses(IRContext::kAnalysisCFG |
+                                IRContext::kAnalysisDominatorAnalysis |
+                                IRContext::kAnalysisValueNumberTable);
+}
+
 void InstBindlessCheckPass::InitializeInstBindlessCheck() {
   // Initialize base class
   InitializeInstrument();
@@ -421,6 +539,7 @@ Pass::Status InstBindlessCheckPass::ProcessImpl() {
         return GenBoundsCheckCode(ref_inst_itr, ref_block_itr, stage_idx,
                                   new_blocks);
       };
+  if (dedup_checks_) FindRedundantReferences(true);
   bool modified = InstProcessEntryPointCallTree(pfn);
   if (input_init_enabled_) {
     // Perform descriptor initialization check on each entry point function in
@@ -432,6 +551,7 @@ Pass::Status InstBindlessCheckPass::ProcessImpl() {
       return GenInitCheckCode(ref_inst_itr, ref_block_itr, stage_idx,
                               new_blocks);
     };
+    if (dedup_checks_) FindRedundantReferences(false);
     modified |= InstProcessEntryPointCallTree(pfn);
   }
   return modified ? Status::SuccessWithChange : Status::SuccessWithoutChange;
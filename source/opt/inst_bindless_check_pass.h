@@ -17,6 +17,8 @@
 #ifndef LIBSPIRV_OPT_INST_BINDLESS_CHECK_PASS_H_
 #define LIBSPIRV_OPT_INST_BINDLESS_CHECK_PASS_H_
 
+#include <unordered_set>
+
 #include "instrument_pass.h"
 
 namespace spvtools {
@@ -31,16 +33,21 @@ class InstBindlessCheckPass : public InstrumentPass {
   // Deprecated interface
   InstBindlessCheckPass(uint32_t desc_set, uint32_t shader_id,
                         bool input_length_enable, bool input_init_enable,
-                        uint32_t version)
+                        uint32_t version, uint32_t sample_rate = 1,
+                        bool dedup_checks = false)
       : InstrumentPass(desc_set, shader_id, kInstValidationIdBindless, version),
         input_length_enabled_(input_length_enable),
-        input_init_enabled_(input_init_enable) {}
+        input_init_enabled_(input_init_enable),
+        sample_rate_(sample_rate),
+        dedup_checks_(dedup_checks) {}
   // Preferred Interface
   InstBindlessCheckPass(uint32_t desc_set, uint32_t shader_id,
                         bool input_length_enable, bool input_init_enable)
       : InstrumentPass(desc_set, shader_id, kInstValidationIdBindless),
         input_length_enabled_(input_length_enable),
-        input_init_enabled_(input_init_enable) {}
+        input_init_enabled_(input_init_enable),
+        sample_rate_(1),
+        dedup_checks_(false) {}
 
   ~InstBindlessCheckPass() override = default;
 
@@ -156,6 +163,23 @@ class InstBindlessCheckPass : public InstrumentPass {
                     uint32_t stage_idx, ref_analysis* ref,
                     std::vector<std::unique_ptr<BasicBlock>>* new_blocks);
 
+  // Generate in |builder| instructions combining the check result |check_id|
+  // with the sampling test of |stage_idx|, so that only the invocations whose
+  // hash is a multiple of the sample rate can fail. Return the id of the
+  // combined result.
+  uint32_t GenSampleCheckCode(uint32_t check_id, uint32_t stage_idx,
+                              InstructionBuilder* builder);
+
+  // Return the id of a new private boolean variable, initialized to false,
+  // recording whether an invocation has reported an error at one reference.
+  uint32_t GenReportedVar();
+
+  // Record in |redundant_refs_| the descriptor references whose check is
+  // implied by the check of a dominating reference through the same variable
+  // with an index of the same value number. |bounds| selects the references
+  // checked by GenBoundsCheckCode, else those checked by GenInitCheckCode.
+  void FindRedundantReferences(bool bounds);
+
   // Initialize state for instrumenting bindless checking
   void InitializeInstBindlessCheck();
 
@@ -169,6 +193,17 @@ class InstBindlessCheckPass : public InstrumentPass {
   // Enable instrumentation of descriptor initialization checking
   bool input_init_enabled_;
 
+  // Check one in |sample_rate_| invocations, and write at most one error
+  // record per reference in each of them. 1 checks every invocation and
+  // writes every error.
+  uint32_t sample_rate_;
+
+  // Only check the first of the identical references along each path.
+  bool dedup_checks_;
+
+  // Unique ids of the references left unchecked, when |dedup_checks_| is set
+  std::unordered_set<uint32_t> redundant_refs_;
+
   // Mapping from variable to descriptor set
   std::unordered_map<uint32_t, uint32_t> var2desc_set_;
 
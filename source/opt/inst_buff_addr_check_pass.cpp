@@ -188,7 +188,8 @@ uint32_t InstBuffAddrCheckPass::GetSearchAndTestFuncId() {
     // Add ref_ptr and length parameters
     AddParam(GetUint64Id(), &param_vec, &input_func);
     AddParam(GetUintId(), &param_vec, &input_func);
-    // Empty first block.
+    // First block. Load the index of the first buffer length, which is one
+    // past the index of the 0xffffffffffffffff address ending the list.
     uint32_t first_blk_id = TakeNextId();
     std::unique_ptr<Instruction> first_blk_label(NewLabel(first_blk_id));
     std::unique_ptr<BasicBlock> first_blk_ptr =
@@ -197,45 +198,70 @@ uint32_t InstBuffAddrCheckPass::GetSearchAndTestFuncId() {
         context(), &*first_blk_ptr,
         IRContext::kAnalysisDefUse | IRContext::kAnalysisInstrToBlockMapping);
     uint32_t hdr_blk_id = TakeNextId();
-    // Branch to search loop header
     std::unique_ptr<Instruction> hdr_blk_label(NewLabel(hdr_blk_id));
+    uint32_t ibuf_id = GetInputBufferId();
+    uint32_t ibuf_ptr_id = GetInputBufferPtrId();
+    uint32_t ibuf_type_id = GetInputBufferTypeId();
+    uint32_t data_offset_id = builder.GetUintConstantId(kDebugInputDataOffset);
+    uint32_t len_offset_id =
+        builder.GetUintConstantId(kDebugInputBuffAddrLengthOffset);
+    Instruction* len_start_ac_inst = builder.AddTernaryOp(
+        ibuf_ptr_id, SpvOpAccessChain, ibuf_id, data_offset_id, len_offset_id);
+    Instruction* len_start_load_inst = builder.AddUnaryOp(
+        ibuf_type_id, SpvOpLoad, len_start_ac_inst->result_id());
+    Instruction* len_start_32_inst = builder.AddUnaryOp(
+        GetUintId(), SpvOpUConvert, len_start_load_inst->result_id());
+    uint32_t one_id = builder.GetUintConstantId(1u);
+    Instruction* last_idx_inst =
+        builder.AddBinaryOp(GetUintId(), SpvOpISub,
+                            len_start_32_inst->result_id(), one_id);
+    // Branch to search loop header
     (void)builder.AddInstruction(MakeUnique<Instruction>(
         context(), SpvOpBranch, 0, 0,
         std::initializer_list<Operand>{{SPV_OPERAND_TYPE_ID, {hdr_blk_id}}}));
     first_blk_ptr->SetParent(&*input_func);
     input_func->AddBasicBlock(std::move(first_blk_ptr));
-    // Linear search loop header block
-    // TODO(greg-lunarg): Implement binary search
+    // Binary search loop header block. The search looks for the last buffer
+    // address not greater than ref_ptr between a lower bound, which starts at
+    // the 0x0 address beginning the list, and an upper bound, which starts at
+    // the 0xffffffffffffffff address ending it.
     std::unique_ptr<BasicBlock> hdr_blk_ptr =
         MakeUnique<BasicBlock>(std::move(hdr_blk_label));
     builder.SetInsertPoint(&*hdr_blk_ptr);
-    // Phi for search index. Starts with 1.
     uint32_t cont_blk_id = TakeNextId();
     std::unique_ptr<Instruction> cont_blk_label(NewLabel(cont_blk_id));
-    // Deal with def-use cycle caused by search loop index computation.
-    // Create Add and Phi instructions first, then do Def analysis on Add.
-    // Add Phi and Add instructions and do Use analysis later.
-    uint32_t idx_phi_id = TakeNextId();
-    uint32_t idx_inc_id = TakeNextId();
-    std::unique_ptr<Instruction> idx_inc_inst(new Instruction(
-        context(), SpvOpIAdd, GetUintId(), idx_inc_id,
-        {{spv_operand_type_t::SPV_OPERAND_TYPE_ID, {idx_phi_id}},
-         {spv_operand_type_t::SPV_OPERAND_TYPE_ID,
-          {builder.GetUintConstantId(1u)}}}));
-    std::unique_ptr<Instruction> idx_phi_inst(new Instruction(
-        context(), SpvOpPhi, GetUintId(), idx_phi_id,
-        {{spv_operand_type_t::SPV_OPERAND_TYPE_ID,
-          {builder.GetUintConstantId(1u)}},
-         {spv_operand_type_t::SPV_OPERAND_TYPE_ID, {first_blk_id}},
-         {spv_operand_type_t::SPV_OPERAND_TYPE_ID, {idx_inc_id}},
-         {spv_operand_type_t::SPV_OPERAND_TYPE_ID, {cont_blk_id}}}));
-    get_def_use_mgr()->AnalyzeInstDef(&*idx_inc_inst);
-    // Add (previously created) search index phi
-    (void)builder.AddInstruction(std::move(idx_phi_inst));
-    // LoopMerge
     uint32_t bound_test_blk_id = TakeNextId();
     std::unique_ptr<Instruction> bound_test_blk_label(
         NewLabel(bound_test_blk_id));
+    // Deal with def-use cycle caused by search bounds computation.
+    // Create the Select instructions computing the next bounds first, and do
+    // Def analysis on them. Fill in their operands once the Phi instructions
+    // and the midpoint test exist.
+    uint32_t lo_phi_id = TakeNextId();
+    uint32_t hi_phi_id = TakeNextId();
+    uint32_t lo_next_id = TakeNextId();
+    uint32_t hi_next_id = TakeNextId();
+    std::unique_ptr<Instruction> lo_next_inst(
+        new Instruction(context(), SpvOpSelect, GetUintId(), lo_next_id, {}));
+    std::unique_ptr<Instruction> hi_next_inst(
+        new Instruction(context(), SpvOpSelect, GetUintId(), hi_next_id, {}));
+    get_def_use_mgr()->AnalyzeInstDef(&*lo_next_inst);
+    get_def_use_mgr()->AnalyzeInstDef(&*hi_next_inst);
+    (void)builder.AddInstruction(MakeUnique<Instruction>(
+        context(), SpvOpPhi, GetUintId(), lo_phi_id,
+        std::initializer_list<Operand>{
+            {SPV_OPERAND_TYPE_ID, {one_id}},
+            {SPV_OPERAND_TYPE_ID, {first_blk_id}},
+            {SPV_OPERAND_TYPE_ID, {lo_next_id}},
+            {SPV_OPERAND_TYPE_ID, {cont_blk_id}}}));
+    (void)builder.AddInstruction(MakeUnique<Instruction>(
+        context(), SpvOpPhi, GetUintId(), hi_phi_id,
+        std::initializer_list<Operand>{
+            {SPV_OPERAND_TYPE_ID, {last_idx_inst->result_id()}},
+            {SPV_OPERAND_TYPE_ID, {first_blk_id}},
+            {SPV_OPERAND_TYPE_ID, {hi_next_id}},
+            {SPV_OPERAND_TYPE_ID, {cont_blk_id}}}));
+    // LoopMerge
     (void)builder.AddInstruction(MakeUnique<Instruction>(
         context(), SpvOpLoopMerge, 0, 0,
         std::initializer_list<Operand>{
@@ -248,28 +274,42 @@ uint32_t InstBuffAddrCheckPass::GetSearchAndTestFuncId() {
         std::initializer_list<Operand>{{SPV_OPERAND_TYPE_ID, {cont_blk_id}}}));
     hdr_blk_ptr->SetParent(&*input_func);
     input_func->AddBasicBlock(std::move(hdr_blk_ptr));
-    // Continue/Work Block. Read next buffer pointer and break if greater
-    // than ref_ptr arg.
+    // Continue/Work Block. Read the buffer address midway between the bounds
+    // and move the upper bound to it if it is greater than ref_ptr arg, else
+    // the lower bound. Break once the bounds are adjacent, else branch back
+    // to loop header. The upper bound starts past the lower bound, so the
+    // midway index is always a new candidate or the lower bound itself.
     std::unique_ptr<BasicBlock> cont_blk_ptr =
         MakeUnique<BasicBlock>(std::move(cont_blk_label));
     builder.SetInsertPoint(&*cont_blk_ptr);
-    // Add (previously created) search index increment now.
-    (void)builder.AddInstruction(std::move(idx_inc_inst));
-    // Load next buffer address from debug input buffer
-    uint32_t ibuf_id = GetInputBufferId();
-    uint32_t ibuf_ptr_id = GetInputBufferPtrId();
-    Instruction* uptr_ac_inst = builder.AddTernaryOp(
-        ibuf_ptr_id, SpvOpAccessChain, ibuf_id,
-        builder.GetUintConstantId(kDebugInputDataOffset), idx_inc_id);
-    uint32_t ibuf_type_id = GetInputBufferTypeId();
-    Instruction* uptr_load_inst =
-        builder.AddUnaryOp(ibuf_type_id, SpvOpLoad, uptr_ac_inst->result_id());
-    // If loaded address greater than ref_ptr arg, break, else branch back to
-    // loop header
-    Instruction* uptr_test_inst =
+    Instruction* sum_inst =
+        builder.AddBinaryOp(GetUintId(), SpvOpIAdd, lo_phi_id, hi_phi_id);
+    Instruction* mid_idx_inst = builder.AddBinaryOp(
+        GetUintId(), SpvOpShiftRightLogical, sum_inst->result_id(), one_id);
+    Instruction* mid_ac_inst = builder.AddTernaryOp(
+        ibuf_ptr_id, SpvOpAccessChain, ibuf_id, data_offset_id,
+        mid_idx_inst->result_id());
+    Instruction* mid_load_inst =
+        builder.AddUnaryOp(ibuf_type_id, SpvOpLoad, mid_ac_inst->result_id());
+    Instruction* mid_test_inst =
         builder.AddBinaryOp(GetBoolId(), SpvOpUGreaterThan,
-                            uptr_load_inst->result_id(), param_vec[0]);
-    (void)builder.AddConditionalBranch(uptr_test_inst->result_id(),
+                            mid_load_inst->result_id(), param_vec[0]);
+    // Add (previously created) next bounds now.
+    lo_next_inst->SetInOperands(
+        {{SPV_OPERAND_TYPE_ID, {mid_test_inst->result_id()}},
+         {SPV_OPERAND_TYPE_ID, {lo_phi_id}},
+         {SPV_OPERAND_TYPE_ID, {mid_idx_inst->result_id()}}});
+    hi_next_inst->SetInOperands(
+        {{SPV_OPERAND_TYPE_ID, {mid_test_inst->result_id()}},
+         {SPV_OPERAND_TYPE_ID, {mid_idx_inst->result_id()}},
+         {SPV_OPERAND_TYPE_ID, {hi_phi_id}}});
+    (void)builder.AddInstruction(std::move(lo_next_inst));
+    (void)builder.AddInstruction(std::move(hi_next_inst));
+    Instruction* lo_inc_inst =
+        builder.AddBinaryOp(GetUintId(), SpvOpIAdd, lo_next_id, one_id);
+    Instruction* adjacent_test_inst = builder.AddBinaryOp(
+        GetBoolId(), SpvOpIEqual, lo_inc_inst->result_id(), hi_next_id);
+    (void)builder.AddConditionalBranch(adjacent_test_inst->result_id(),
                                        bound_test_blk_id, hdr_blk_id,
                                        kInvalidId, SpvSelectionControlMaskNone);
     cont_blk_ptr->SetParent(&*input_func);
@@ -279,14 +319,10 @@ uint32_t InstBuffAddrCheckPass::GetSearchAndTestFuncId() {
     std::unique_ptr<BasicBlock> bound_test_blk_ptr =
         MakeUnique<BasicBlock>(std::move(bound_test_blk_label));
     builder.SetInsertPoint(&*bound_test_blk_ptr);
-    // Decrement index to point to previous/candidate buffer address
-    Instruction* cand_idx_inst = builder.AddBinaryOp(
-        GetUintId(), SpvOpISub, idx_inc_id, builder.GetUintConstantId(1u));
-    // Load candidate buffer address
+    // Load candidate buffer address, at the lower bound
     Instruction* cand_ac_inst =
         builder.AddTernaryOp(ibuf_ptr_id, SpvOpAccessChain, ibuf_id,
-                             builder.GetUintConstantId(kDebugInputDataOffset),
-                             cand_idx_inst->result_id());
+                             data_offset_id, lo_next_id);
     Instruction* cand_load_inst =
         builder.AddUnaryOp(ibuf_type_id, SpvOpLoad, cand_ac_inst->result_id());
     // Compute offset of ref_ptr from candidate buffer address
@@ -299,19 +335,9 @@ uint32_t InstBuffAddrCheckPass::GetSearchAndTestFuncId() {
     Instruction* ref_end_inst =
         builder.AddBinaryOp(ibuf_type_id, SpvOpIAdd, offset_inst->result_id(),
                             ref_len_64_inst->result_id());
-    // Load starting index of lengths in input buffer and convert to uint32
-    Instruction* len_start_ac_inst =
-        builder.AddTernaryOp(ibuf_ptr_id, SpvOpAccessChain, ibuf_id,
-                             builder.GetUintConstantId(kDebugInputDataOffset),
-                             builder.GetUintConstantId(0u));
-    Instruction* len_start_load_inst = builder.AddUnaryOp(
-        ibuf_type_id, SpvOpLoad, len_start_ac_inst->result_id());
-    Instruction* len_start_32_inst = builder.AddUnaryOp(
-        GetUintId(), SpvOpUConvert, len_start_load_inst->result_id());
     // Decrement search index to get candidate buffer length index
     Instruction* cand_len_idx_inst =
-        builder.AddBinaryOp(GetUintId(), SpvOpISub, cand_idx_inst->result_id(),
-                            builder.GetUintConstantId(1u));
+        builder.AddBinaryOp(GetUintId(), SpvOpISub, lo_next_id, one_id);
     // Add candidate length index to start index
     Instruction* len_idx_inst = builder.AddBinaryOp(
         GetUintId(), SpvOpIAdd, cand_len_idx_inst->result_id(),
@@ -319,8 +345,7 @@ uint32_t InstBuffAddrCheckPass::GetSearchAndTestFuncId() {
     // Load candidate buffer length
     Instruction* len_ac_inst =
         builder.AddTernaryOp(ibuf_ptr_id, SpvOpAccessChain, ibuf_id,
-                             builder.GetUintConstantId(kDebugInputDataOffset),
-                             len_idx_inst->result_id());
+                             data_offset_id, len_idx_inst->result_id());
     Instruction* len_load_inst =
         builder.AddUnaryOp(ibuf_type_id, SpvOpLoad, len_ac_inst->result_id());
     // Test if reference end within candidate buffer length
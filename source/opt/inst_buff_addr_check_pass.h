@@ -53,6 +53,8 @@ class InstBuffAddrCheckPass : public InstrumentPass {
                 std::unique_ptr<Function>* input_func);
 
   // Return id for search and test function. Generate it if not already gen'd.
+  // The function does a binary search of the sorted buffer addresses in the
+  // input buffer.
   uint32_t GetSearchAndTestFuncId();
 
   // Generate code into |builder| to do search of the BDA debug input buffer
@@ -0,0 +1,304 @@
+// Copyright (c) 2019 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "source/opt/inst_profile_pass.h"
+
+namespace spvtools {
+namespace opt {
+namespace {
+
+// Parameters of the profile function
+static const int kProfileParamSiteIdx = 0;
+static const int kProfileParamInstructionIdx = 1;
+static const int kProfileParamStartClock = 2;
+static const int kProfileParamCnt = 3;
+
+}  // namespace
+
+uint32_t InstProfilePass::GenClockLoCode(InstructionBuilder* builder) {
+  Instruction* clock_inst =
+      builder->AddUnaryOp(GetVecUintId(2u), SpvOpReadClockKHR,
+                          builder->GetUintConstantId(SpvScopeSubgroup));
+  return builder
+      ->AddIdLiteralOp(GetUintId(), SpvOpCompositeExtract,
+                       clock_inst->result_id(), 0u)
+      ->result_id();
+}
+
+uint32_t InstProfilePass::GenSubgroupSumCode(uint32_t value_id,
+                                             InstructionBuilder* builder) {
+  std::unique_ptr<Instruction> sum_inst(new Instruction(
+      context(), SpvOpGroupNonUniformIAdd, GetUintId(), TakeNextId(),
+      {{spv_operand_type_t::SPV_OPERAND_TYPE_ID,
+        {builder->GetUintConstantId(SpvScopeSubgroup)}},
+       {spv_operand_type_t::SPV_OPERAND_TYPE_GROUP_OPERATION,
+        {SpvGroupOperationReduce}},
+       {spv_operand_type_t::SPV_OPERAND_TYPE_ID, {value_id}}}));
+  return builder->AddInstruction(std::move(sum_inst))->result_id();
+}
+
+uint32_t InstProfilePass::GenRecordFieldPtrCode(uint32_t base_offset_id,
+                                                uint32_t field,
+                                                InstructionBuilder* builder) {
+  Instruction* data_idx_inst =
+      builder->AddBinaryOp(GetUintId(), SpvOpIAdd, base_offset_id,
+                           builder->GetUintConstantId(field));
+  return builder
+      ->AddTernaryOp(GetOutputBufferPtrId(), SpvOpAccessChain,
+                     GetOutputBufferId(),
+                     builder->GetUintConstantId(kDebugOutputDataOffset),
+                     data_idx_inst->result_id())
+      ->result_id();
+}
+
+uint32_t InstProfilePass::GetProfileFunctionId() {
+  if (profile_func_id_ != 0) return profile_func_id_;
+  // Add capabilities and extension needed by the clock reads and the
+  // subgroup reductions.
+  context()->AddCapability(SpvCapabilityShaderClockKHR);
+  context()->AddCapability(SpvCapabilityGroupNonUniform);
+  context()->AddCapability(SpvCapabilityGroupNonUniformArithmetic);
+  if (!get_feature_mgr()->HasExtension(kSPV_KHR_shader_clock)) {
+    context()->AddExtension("SPV_KHR_shader_clock");
+  }
+  // Create function
+  profile_func_id_ = TakeNextId();
+  analysis::TypeManager* type_mgr = context()->get_type_mgr();
+  std::vector<const analysis::Type*> param_types(
+      kProfileParamCnt, type_mgr->GetType(GetUintId()));
+  analysis::Function func_ty(type_mgr->GetType(GetVoidId()), param_types);
+  analysis::Type* reg_func_ty = type_mgr->GetRegisteredType(&func_ty);
+  std::unique_ptr<Instruction> func_inst(new Instruction(
+      get_module()->context(), SpvOpFunction, GetVoidId(), profile_func_id_,
+      {{spv_operand_type_t::SPV_OPERAND_TYPE_LITERAL_INTEGER,
+        {SpvFunctionControlMaskNone}},
+       {spv_operand_type_t::SPV_OPERAND_TYPE_ID,
+        {type_mgr->GetTypeInstruction(reg_func_ty)}}}));
+  get_def_use_mgr()->AnalyzeInstDefUse(&*func_inst);
+  std::unique_ptr<Function> profile_func =
+      MakeUnique<Function>(std::move(func_inst));
+  // Add parameters
+  std::vector<uint32_t> param_vec;
+  for (int c = 0; c < kProfileParamCnt; ++c) {
+    uint32_t pid = TakeNextId();
+    param_vec.push_back(pid);
+    std::unique_ptr<Instruction> param_inst(
+        new Instruction(get_module()->context(), SpvOpFunctionParameter,
+                        GetUintId(), pid, {}));
+    get_def_use_mgr()->AnalyzeInstDefUse(&*param_inst);
+    profile_func->AddParameter(std::move(param_inst));
+  }
+  // Create first block
+  uint32_t sum_blk_id = TakeNextId();
+  std::unique_ptr<Instruction> sum_label(NewLabel(sum_blk_id));
+  std::unique_ptr<BasicBlock> new_blk_ptr =
+      MakeUnique<BasicBlock>(std::move(sum_label));
+  InstructionBuilder builder(
+      context(), &*new_blk_ptr,
+      IRContext::kAnalysisDefUse | IRContext::kAnalysisInstrToBlockMapping);
+  // Sum the time spent in the site and the number of passes through it over
+  // the active invocations of the subgroup.
+  uint32_t clock_id = GenClockLoCode(&builder);
+  Instruction* delta_inst =
+      builder.AddBinaryOp(GetUintId(), SpvOpISub, clock_id,
+                          param_vec[kProfileParamStartClock]);
+  uint32_t cycles_id = GenSubgroupSumCode(delta_inst->result_id(), &builder);
+  uint32_t count_id =
+      GenSubgroupSumCode(builder.GetUintConstantId(1u), &builder);
+  // Only let one invocation of the subgroup write, and only if the record
+  // fits in the output buffer.
+  Instruction* elect_inst =
+      builder.AddUnaryOp(GetBoolId(), SpvOpGroupNonUniformElect,
+                         builder.GetUintConstantId(SpvScopeSubgroup));
+  Instruction* base_offset_inst = builder.AddBinaryOp(
+      GetUintId(), SpvOpIMul, param_vec[kProfileParamSiteIdx],
+      builder.GetUintConstantId(kInstProfileOutCnt));
+  uint32_t base_offset_id = base_offset_inst->result_id();
+  Instruction* record_end_inst =
+      builder.AddBinaryOp(GetUintId(), SpvOpIAdd, base_offset_id,
+                          builder.GetUintConstantId(kInstProfileOutCnt));
+  Instruction* obuf_bnd_inst =
+      builder.AddIdLiteralOp(GetUintId(), SpvOpArrayLength,
+                             GetOutputBufferId(), kDebugOutputDataOffset);
+  Instruction* obuf_safe_inst = builder.AddBinaryOp(
+      GetBoolId(), SpvOpULessThanEqual, record_end_inst->result_id(),
+      obuf_bnd_inst->result_id());
+  Instruction* write_inst =
+      builder.AddBinaryOp(GetBoolId(), SpvOpLogicalAnd,
+                          elect_inst->result_id(), obuf_safe_inst->result_id());
+  uint32_t merge_blk_id = TakeNextId();
+  uint32_t write_blk_id = TakeNextId();
+  std::unique_ptr<Instruction> merge_label(NewLabel(merge_blk_id));
+  std::unique_ptr<Instruction> write_label(NewLabel(write_blk_id));
+  (void)builder.AddConditionalBranch(write_inst->result_id(), write_blk_id,
+                                     merge_blk_id, merge_blk_id,
+                                     SpvSelectionControlMaskNone);
+  // Close sum block and gen write block
+  new_blk_ptr->SetParent(&*profile_func);
+  profile_func->AddBasicBlock(std::move(new_blk_ptr));
+  new_blk_ptr = MakeUnique<BasicBlock>(std::move(write_label));
+  builder.SetInsertPoint(&*new_blk_ptr);
+  uint32_t scope_device_id = builder.GetUintConstantId(SpvScopeDevice);
+  uint32_t mask_none_id =
+      builder.GetUintConstantId(SpvMemorySemanticsMaskNone);
+  (void)builder.AddQuadOp(
+      0, SpvOpAtomicStore,
+      GenRecordFieldPtrCode(base_offset_id, kInstProfileOutInstructionIdx,
+                            &builder),
+      scope_device_id, mask_none_id, param_vec[kProfileParamInstructionIdx]);
+  (void)builder.AddQuadOp(
+      GetUintId(), SpvOpAtomicIAdd,
+      GenRecordFieldPtrCode(base_offset_id, kInstProfileOutCount, &builder),
+      scope_device_id, mask_none_id, count_id);
+  // Add the cycles to the low word, then carry into the high word if the
+  // low word wrapped around.
+  Instruction* old_lo_inst = builder.AddQuadOp(
+      GetUintId(), SpvOpAtomicIAdd,
+      GenRecordFieldPtrCode(base_offset_id, kInstProfileOutCyclesLo, &builder),
+      scope_device_id, mask_none_id, cycles_id);
+  Instruction* new_lo_inst = builder.AddBinaryOp(
+      GetUintId(), SpvOpIAdd, old_lo_inst->result_id(), cycles_id);
+  Instruction* wrapped_inst =
+      builder.AddBinaryOp(GetBoolId(), SpvOpULessThan, new_lo_inst->result_id(),
+                          old_lo_inst->result_id());
+  Instruction* carry_inst = builder.AddSelect(
+      GetUintId(), wrapped_inst->result_id(), builder.GetUintConstantId(1u),
+      builder.GetUintConstantId(0u));
+  (void)builder.AddQuadOp(
+      GetUintId(), SpvOpAtomicIAdd,
+      GenRecordFieldPtrCode(base_offset_id, kInstProfileOutCyclesHi, &builder),
+      scope_device_id, mask_none_id, carry_inst->result_id());
+  // Close write block and gen merge block
+  (void)builder.AddBranch(merge_blk_id);
+  new_blk_ptr->SetParent(&*profile_func);
+  profile_func->AddBasicBlock(std::move(new_blk_ptr));
+  new_blk_ptr = MakeUnique<BasicBlock>(std::move(merge_label));
+  builder.SetInsertPoint(&*new_blk_ptr);
+  // Close merge block and function and add function to module
+  (void)builder.AddNullaryOp(0, SpvOpReturn);
+  new_blk_ptr->SetParent(&*profile_func);
+  profile_func->AddBasicBlock(std::move(new_blk_ptr));
+  std::unique_ptr<Instruction> func_end_inst(
+      new Instruction(get_module()->context(), SpvOpFunctionEnd, 0, 0, {}));
+  get_def_use_mgr()->AnalyzeInstDefUse(&*func_end_inst);
+  profile_func->SetFunctionEnd(std::move(func_end_inst));
+  context()->AddFunction(std::move(profile_func));
+  return profile_func_id_;
+}
+
+void InstProfilePass::AddConstructSite(BasicBlock* header,
+                                       DominatorAnalysis* dom,
+                                       std::vector<Site>* sites) {
+  Instruction* merge_inst = header->GetMergeInst();
+  BasicBlock* merge_blk = context()->get_instr_block(header->MergeBlockId());
+  if (!dom->Dominates(header, merge_blk)) return;
+  Instruction* start_inst = merge_inst;
+  if (merge_inst->opcode() == SpvOpLoopMerge) {
+    // The time of a loop is measured from its entering block, so that all
+    // of its iterations count. Give up on loops entered from several blocks.
+    BasicBlock* entering_blk = nullptr;
+    for (uint32_t pred_id : cfg()->preds(header->id())) {
+      if (dom->Dominates(header->id(), pred_id)) continue;
+      if (entering_blk != nullptr) return;
+      entering_blk = cfg()->block(pred_id);
+    }
+    if (entering_blk == nullptr) return;
+    start_inst = entering_blk->GetMergeInst();
+    if (start_inst == nullptr) start_inst = entering_blk->terminator();
+  }
+  // End the site when entering the merge block, after its phis.
+  auto end_itr = merge_blk->begin();
+  while (end_itr->opcode() == SpvOpPhi) ++end_itr;
+  sites->push_back(
+      {start_inst, {&*end_itr}, uid2offset_[merge_inst->unique_id()]});
+}
+
+void InstProfilePass::GenProfileCode(Function* func) {
+  // Find all the sites before changing the function.
+  std::vector<Site> sites;
+  DominatorAnalysis* dom = context()->GetDominatorAnalysis(func);
+  BasicBlock* entry_blk = &*func->begin();
+  auto start_itr = entry_blk->begin();
+  while (start_itr->opcode() == SpvOpVariable) ++start_itr;
+  sites.push_back(
+      {&*start_itr, {}, uid2offset_[entry_blk->begin()->unique_id()]});
+  for (auto& blk : *func) {
+    Instruction* term_inst = blk.terminator();
+    if (term_inst->opcode() == SpvOpReturn ||
+        term_inst->opcode() == SpvOpReturnValue) {
+      sites.front().ends.push_back(term_inst);
+    }
+    if (blk.GetMergeInst() != nullptr) AddConstructSite(&blk, dom, &sites);
+  }
+  // Read the clock at the start of each site and pass it to the profile
+  // function at each of its ends.
+  for (auto& site : sites) {
+    if (site.ends.empty()) continue;
+    InstructionBuilder builder(
+        context(), site.start,
+        IRContext::kAnalysisDefUse | IRContext::kAnalysisInstrToBlockMapping);
+    uint32_t start_clock_id = GenClockLoCode(&builder);
+    uint32_t site_idx_id = builder.GetUintConstantId(site_cnt_);
+    uint32_t inst_idx_id = builder.GetUintConstantId(site.instruction_idx);
+    for (Instruction* end_inst : site.ends) {
+      builder.SetInsertPoint(end_inst);
+      (void)builder.AddFunctionCall(GetVoidId(), GetProfileFunctionId(),
+                                    {site_idx_id, inst_idx_id, start_clock_id});
+    }
+    ++site_cnt_;
+  }
+}
+
+void InstProfilePass::InitInstProfile() {
+  // Initialize base class
+  InitializeInstrument();
+  // Initialize class
+  profile_func_id_ = 0;
+  site_cnt_ = 0;
+}
+
+Pass::Status InstProfilePass::ProcessImpl() {
+  // Instrument each function of the entry point call trees when reaching
+  // its first instruction. No block is added, so the function is not
+  // changed behind the back of the caller.
+  InstProcessFunction pfn =
+      [this](BasicBlock::iterator ref_inst_itr,
+             UptrVectorIterator<BasicBlock> ref_block_itr, uint32_t,
+             std::vector<std::unique_ptr<BasicBlock>>*) {
+        Function* func = ref_block_itr->GetParent();
+        if (&*ref_block_itr == &*func->begin() &&
+            ref_inst_itr == ref_block_itr->begin()) {
+          GenProfileCode(func);
+        }
+      };
+  (void)InstProcessEntryPointCallTree(pfn);
+  return site_cnt_ != 0 ? Status::SuccessWithChange
+                        : Status::SuccessWithoutChange;
+}
+
+Pass::Status InstProfilePass::Process() {
+  // The subgroup reductions need SPIR-V 1.3.
+  if (get_module()->version() < SPV_SPIRV_VERSION_WORD(1, 3)) {
+    if (consumer()) {
+      std::string message = "Profiling instrumentation requires SPIR-V 1.3";
+      consumer()(SPV_MSG_ERROR, 0, {0, 0, 0}, message.c_str());
+    }
+    return Status::SuccessWithoutChange;
+  }
+  InitInstProfile();
+  return ProcessImpl();
+}
+
+}  // namespace opt
+}  // namespace spvtools
@@ -0,0 +1,101 @@
+// Copyright (c) 2019 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef SOURCE_OPT_INST_PROFILE_PASS_H_
+#define SOURCE_OPT_INST_PROFILE_PASS_H_
+
+#include <vector>
+
+#include "source/opt/instrument_pass.h"
+
+namespace spvtools {
+namespace opt {
+
+// This class/pass instruments a shader to measure the time spent in its
+// functions and structured constructs with the shader clock. Each of these
+// profiled sites gets a record in the profile output buffer, see
+// include/spirv-tools/instrument.hpp for its format.
+class InstProfilePass : public InstrumentPass {
+ public:
+  InstProfilePass(uint32_t desc_set, uint32_t shader_id)
+      : InstrumentPass(desc_set, shader_id, kInstValidationIdProfile) {}
+
+  ~InstProfilePass() override = default;
+
+  // See optimizer.hpp for pass user documentation.
+  Status Process() override;
+
+  const char* name() const override { return "inst-profile-pass"; }
+
+ private:
+  // A site whose time is measured: the clock is read before |start| and the
+  // time since then is added to the record of the site before each of |ends|.
+  struct Site {
+    Instruction* start;
+    std::vector<Instruction*> ends;
+    uint32_t instruction_idx;
+  };
+
+  // Instrument all the sites of |func|: its body, each of its selection
+  // constructs and each of its loops which has a single entering block.
+  // The clock reads and the calls to the profile function are inserted before
+  // existing instructions, so no block is added.
+  void GenProfileCode(Function* func);
+
+  // Add to |sites| the structured construct headed by |header|, if it can be
+  // measured. A construct whose merge block is unreachable cannot.
+  void AddConstructSite(BasicBlock* header, DominatorAnalysis* dom,
+                        std::vector<Site>* sites);
+
+  // Generate a read of the subgroup clock with |builder| and return the id
+  // of its low 32 bits.
+  uint32_t GenClockLoCode(InstructionBuilder* builder);
+
+  // Generate the subgroup reduction of |value_id| with |builder| and return
+  // the id of the sum of the values of all active invocations.
+  uint32_t GenSubgroupSumCode(uint32_t value_id, InstructionBuilder* builder);
+
+  // Generate with |builder| the access chain to the member |field| of the
+  // profile record at the offset |base_offset_id| in the output buffer and
+  // return its id.
+  uint32_t GenRecordFieldPtrCode(uint32_t base_offset_id, uint32_t field,
+                                 InstructionBuilder* builder);
+
+  // Return the id of the function which adds the time since a clock value
+  // to the record of a site. Its parameters are the index of the site, the
+  // index of the instruction which starts it and the low 32 bits of the
+  // clock at its start. The time and the number of passes through the site
+  // are summed over the subgroup, so that a single invocation of each
+  // subgroup updates the record with atomics. Generate the function and add
+  // the capabilities it needs if not done already.
+  uint32_t GetProfileFunctionId();
+
+  // Initialize state for profiling instrumentation.
+  void InitInstProfile();
+
+  // Apply GenProfileCode to every function in the call trees of the entry
+  // points of the module.
+  Pass::Status ProcessImpl();
+
+  // Id of profile function, if already gen'd, else zero.
+  uint32_t profile_func_id_;
+
+  // Number of sites instrumented so far. Also the index of the next site.
+  uint32_t site_cnt_;
+};
+
+}  // namespace opt
+}  // namespace spvtools
+
+#endif  // SOURCE_OPT_INST_PROFILE_PASS_H_
@@ -14,6 +14,7 @@
 
 #include "source/opt/instruction.h"
 
+#include <algorithm>
 #include <initializer_list>
 
 #include "source/disassemble.h"
@@ -38,7 +39,8 @@ Instruction::Instruction(IRContext* c)
       opcode_(SpvOpNop),
       has_type_id_(false),
       has_result_id_(false),
-      unique_id_(c->TakeNextUniqueId()) {}
+      unique_id_(c->TakeNextUniqueId()),
+      dbg_lines_(DebugLineTable::kNoLines) {}
 
 Instruction::Instruction(IRContext* c, SpvOp op)
     : utils::IntrusiveNodeBase<Instruction>(),
@@ -46,24 +48,26 @@ Instruction::Instruction(IRContext* c, SpvOp op)
       opcode_(op),
       has_type_id_(false),
       has_result_id_(false),
-      unique_id_(c->TakeNextUniqueId()) {}
+      unique_id_(c->TakeNextUniqueId()),
+      dbg_lines_(DebugLineTable::kNoLines) {}
 
 Instruction::Instruction(IRContext* c, const spv_parsed_instruction_t& inst,
-                         std::vector<Instruction>&& dbg_line)
+                         uint32_t dbg_lines)
     : context_(c),
       opcode_(static_cast<SpvOp>(inst.opcode)),
       has_type_id_(inst.type_id != 0),
       has_result_id_(inst.result_id != 0),
       unique_id_(c->TakeNextUniqueId()),
-      dbg_line_insts_(std::move(dbg_line)) {
-  assert((!IsDebugLineInst(opcode_) || dbg_line.empty()) &&
+      dbg_lines_(dbg_lines) {
+  assert((!IsDebugLineInst(opcode_) || dbg_lines == DebugLineTable::kNoLines) &&
          "Op(No)Line attaching to Op(No)Line found");
+  operands_.reserve(inst.num_operands);
   for (uint32_t i = 0; i < inst.num_operands; ++i) {
     const auto& current_payload = inst.operands[i];
-    std::vector<uint32_t> words(
-        inst.words + current_payload.offset,
-        inst.words + current_payload.offset + current_payload.num_words);
-    operands_.emplace_back(current_payload.type, std::move(words));
+    const uint32_t* words = inst.words + current_payload.offset;
+    operands_.emplace_back(
+        current_payload.type,
+        Operand::OperandData(words, words + current_payload.num_words));
   }
 }
 
@@ -75,7 +79,8 @@ Instruction::Instruction(IRContext* c, SpvOp op, uint32_t ty_id,
       has_type_id_(ty_id != 0),
       has_result_id_(res_id != 0),
       unique_id_(c->TakeNextUniqueId()),
-      operands_() {
+      operands_(),
+      dbg_lines_(DebugLineTable::kNoLines) {
   if (has_type_id_) {
     operands_.emplace_back(spv_operand_type_t::SPV_OPERAND_TYPE_TYPE_ID,
                            std::initializer_list<uint32_t>{ty_id});
@@ -89,34 +94,103 @@ Instruction::Instruction(IRContext* c, SpvOp op, uint32_t ty_id,
 
 Instruction::Instruction(Instruction&& that)
     : utils::IntrusiveNodeBase<Instruction>(),
+      context_(that.context_),
       opcode_(that.opcode_),
       has_type_id_(that.has_type_id_),
       has_result_id_(that.has_result_id_),
       unique_id_(that.unique_id_),
       operands_(std::move(that.operands_)),
-      dbg_line_insts_(std::move(that.dbg_line_insts_)) {}
+      dbg_lines_(that.dbg_lines_) {}
 
 Instruction& Instruction::operator=(Instruction&& that) {
+  // The lines are only meaningful in the table of the context they come from.
+  context_ = that.context_;
   opcode_ = that.opcode_;
   has_type_id_ = that.has_type_id_;
   has_result_id_ = that.has_result_id_;
   unique_id_ = that.unique_id_;
   operands_ = std::move(that.operands_);
-  dbg_line_insts_ = std::move(that.dbg_line_insts_);
+  dbg_lines_ = that.dbg_lines_;
   return *this;
 }
 
+void* Instruction::operator new(size_t size, IRContext* context) {
+  return utils::NodePool::Allocate(
+      context != nullptr ? context->instruction_pool() : nullptr, size);
+}
+
 Instruction* Instruction::Clone(IRContext* c) const {
-  Instruction* clone = new Instruction(c);
+  Instruction* clone = new (c) Instruction(c);
   clone->opcode_ = opcode_;
   clone->has_type_id_ = has_type_id_;
   clone->has_result_id_ = has_result_id_;
   clone->unique_id_ = c->TakeNextUniqueId();
   clone->operands_ = operands_;
-  clone->dbg_line_insts_ = dbg_line_insts_;
+  if (c == context_ || dbg_lines_ == DebugLineTable::kNoLines) {
+    clone->dbg_lines_ = dbg_lines_;
+  } else {
+    clone->dbg_lines_ = c->debug_line_table()->Intern(
+        context_->debug_line_table()->Lines(dbg_lines_));
+  }
   return clone;
 }
 
+std::vector<Instruction> Instruction::dbg_line_insts() const {
+  std::vector<Instruction> insts;
+  if (dbg_lines_ == DebugLineTable::kNoLines) return insts;
+  const DebugLineTable* table = context_->debug_line_table();
+  insts.resize(table->NumLines(dbg_lines_));
+  auto inst = insts.begin();
+  for (const DebugLine* line = table->begin(dbg_lines_);
+       line != table->end(dbg_lines_); ++line, ++inst) {
+    // The copies are not part of the module, so they take no unique id.
+    inst->context_ = context_;
+    inst->opcode_ = line->opcode;
+    if (line->opcode == SpvOpLine) {
+      inst->operands_ = {
+          {SPV_OPERAND_TYPE_ID, {line->file_id}},
+          {SPV_OPERAND_TYPE_LITERAL_INTEGER, {line->line}},
+          {SPV_OPERAND_TYPE_LITERAL_INTEGER, {line->column}}};
+    }
+  }
+  return insts;
+}
+
+void Instruction::set_dbg_line_insts(const std::vector<Instruction>& lines) {
+  std::vector<DebugLine> dbg_lines;
+  dbg_lines.reserve(lines.size());
+  for (const Instruction& inst : lines) {
+    assert(IsDebugLineInst(inst.opcode()) && "expected a debug line inst");
+    if (inst.opcode() == SpvOpLine) {
+      dbg_lines.push_back({SpvOpLine, inst.GetSingleWordInOperand(0),
+                           inst.GetSingleWordInOperand(1),
+                           inst.GetSingleWordInOperand(2)});
+    } else {
+      dbg_lines.push_back(DebugLine::NoLine());
+    }
+  }
+  dbg_lines_ = dbg_lines.empty()
+                   ? DebugLineTable::kNoLines
+                   : context_->debug_line_table()->Intern(dbg_lines);
+}
+
+uint32_t Instruction::NumDbgLineInsts() const {
+  if (dbg_lines_ == DebugLineTable::kNoLines) return 0;
+  return context_->debug_line_table()->NumLines(dbg_lines_);
+}
+
+const DebugLine* Instruction::last_dbg_line() const {
+  if (dbg_lines_ == DebugLineTable::kNoLines) return nullptr;
+  return context_->debug_line_table()->end(dbg_lines_) - 1;
+}
+
+void Instruction::AddDbgLine(const DebugLine& line) {
+  // |line| may be in the table, which interning can move.
+  const DebugLine added = line;
+  DebugLineTable* table = context_->debug_line_table();
+  dbg_lines_ = table->Concat(dbg_lines_, table->Intern(&added, 1));
+}
+
 uint32_t Instruction::GetSingleWordOperand(uint32_t index) const {
   const auto& words = GetOperand(index).words;
   assert(words.size() == 1 && "expected the operand only taking one word");
@@ -132,10 +206,31 @@ uint32_t Instruction::NumInOperandWords() const {
 
 void Instruction::ToBinaryWithoutAttachedDebugInsts(
     std::vector<uint32_t>* binary) const {
-  const uint32_t num_words = 1 + NumOperandWords();
-  binary->push_back((num_words << 16) | static_cast<uint16_t>(opcode_));
-  for (const auto& operand : operands_)
-    binary->insert(binary->end(), operand.words.begin(), operand.words.end());
+  const size_t size = binary->size();
+  binary->resize(size + 1 + NumOperandWords());
+  ToBinaryWithoutAttachedDebugInsts(binary->data() + size);
+}
+
+uint32_t* Instruction::ToBinaryWithoutAttachedDebugInsts(
+    uint32_t* words) const {
+  // The word count is only known once the operands are written.
+  uint32_t* end = words + 1;
+  for (const auto& operand : operands_) {
+    end = std::copy(operand.words.begin(), operand.words.end(), end);
+  }
+  const uint32_t num_words = static_cast<uint32_t>(end - words);
+  words[0] = (num_words << 16) | static_cast<uint16_t>(opcode_);
+  return end;
+}
+
+uint32_t Instruction::NumDbgLineWords() const {
+  if (dbg_lines_ == DebugLineTable::kNoLines) return 0;
+  return context_->debug_line_table()->NumWords(dbg_lines_);
+}
+
+uint32_t* Instruction::DbgLineInstsToBinary(uint32_t* words) const {
+  if (dbg_lines_ == DebugLineTable::kNoLines) return words;
+  return context_->debug_line_table()->ToBinary(dbg_lines_, words);
 }
 
 void Instruction::ReplaceOperands(const OperandList& new_operands) {
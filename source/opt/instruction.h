@@ -25,16 +25,19 @@
 #include "source/opcode.h"
 #include "source/operand.h"
 #include "source/util/ilist_node.h"
+#include "source/util/node_pool.h"
 #include "source/util/small_vector.h"
 
 #include "source/latest_version_glsl_std_450_header.h"
 #include "source/latest_version_spirv_header.h"
+#include "source/opt/debug_line_table.h"
 #include "source/opt/reflect.h"
 #include "spirv-tools/libspirv.h"
 
 namespace spvtools {
 namespace opt {
 
+class BasicBlock;
 class Function;
 class IRContext;
 class Module;
@@ -111,7 +114,8 @@ class Instruction : public utils::IntrusiveNodeBase<Instruction> {
         opcode_(SpvOpNop),
         has_type_id_(false),
         has_result_id_(false),
-        unique_id_(0) {}
+        unique_id_(0),
+        dbg_lines_(DebugLineTable::kNoLines) {}
 
   // Creates a default OpNop instruction.
   Instruction(IRContext*);
@@ -120,10 +124,11 @@ class Instruction : public utils::IntrusiveNodeBase<Instruction> {
   Instruction(IRContext*, SpvOp);
   // Creates an instruction using the given spv_parsed_instruction_t |inst|. All
   // the data inside |inst| will be copied and owned in this instance. And keep
-  // record of line-related debug instructions |dbg_line| ahead of this
-  // instruction, if any.
+  // record of line-related debug instructions ahead of this instruction, if
+  // any: |dbg_lines| is the index of their sequence in the debug line table of
+  // |c|.
   Instruction(IRContext* c, const spv_parsed_instruction_t& inst,
-              std::vector<Instruction>&& dbg_line = {});
+              uint32_t dbg_lines = DebugLineTable::kNoLines);
 
   // Creates an instruction with the given opcode |op|, type id: |ty_id|,
   // result id: |res_id| and input operands: |in_operands|.
@@ -140,6 +145,22 @@ class Instruction : public utils::IntrusiveNodeBase<Instruction> {
 
   virtual ~Instruction() = default;
 
+  // Allocates the instruction in the instruction pool of |context|, which is
+  // much faster to free than the heap:
+  //
+  //   new (context) Instruction(context, ...)
+  //
+  // Instructions allocated with the plain |new| come from the heap.  Either
+  // kind is freed with |delete|.
+  static void* operator new(size_t size, IRContext* context);
+  static void* operator new(size_t size) {
+    return utils::NodePool::Allocate(nullptr, size);
+  }
+  static void operator delete(void* inst) { utils::NodePool::Free(inst); }
+  static void operator delete(void* inst, IRContext*) {
+    utils::NodePool::Free(inst);
+  }
+
   // Returns a newly allocated instruction that has the same operands, result,
   // and type as |this|.  The new instruction is not linked into any list.
   // It is the responsibility of the caller to make sure that the storage is
@@ -165,15 +186,35 @@ class Instruction : public utils::IntrusiveNodeBase<Instruction> {
     assert(unique_id_ != 0);
     return unique_id_;
   }
-  // Returns the vector of line-related debug instructions attached to this
-  // instruction and the caller can directly modify them.
-  std::vector<Instruction>& dbg_line_insts() { return dbg_line_insts_; }
-  const std::vector<Instruction>& dbg_line_insts() const {
-    return dbg_line_insts_;
-  }
+  // Returns the line-related debug instructions attached to this instruction.
+  // They are kept in the debug line table of the context, so these are
+  // copies: the lines are changed with set_dbg_line_insts or AddDbgLine.
+  std::vector<Instruction> dbg_line_insts() const;
+  // Attaches |lines| to this instruction in place of the lines it has.
+  void set_dbg_line_insts(const std::vector<Instruction>& lines);
+
+  // Returns the index of the line-related debug instructions attached to this
+  // instruction in the debug line table of the context.
+  uint32_t dbg_lines() const { return dbg_lines_; }
+  // Attaches the lines at |index| in the debug line table of the context.
+  void set_dbg_lines(uint32_t index) { dbg_lines_ = index; }
+  // Returns the number of line-related debug instructions attached to this
+  // instruction.
+  uint32_t NumDbgLineInsts() const;
+  // Returns the last line-related debug instruction attached to this
+  // instruction, or nullptr if there is none.
+  const DebugLine* last_dbg_line() const;
+  // Attaches |line| after the lines this instruction already has.
+  void AddDbgLine(const DebugLine& line);
 
   // Clear line-related debug instructions attached to this instruction.
-  void clear_dbg_line_insts() { dbg_line_insts_.clear(); }
+  void clear_dbg_line_insts() { dbg_lines_ = DebugLineTable::kNoLines; }
+
+  // Returns the basic block containing this instruction, or nullptr if it is
+  // not in a basic block.  The label of a block is in that block.  The block
+  // is kept up to date as the instruction is inserted and moved, so unlike
+  // other analyses it never has to be rebuilt.
+  BasicBlock* block() const { return block_; }
 
   // Same semantics as in the base class except the list the InstructionList
   // containing |pos| will now assume ownership of |this|.
@@ -253,52 +294,78 @@ class Instruction : public utils::IntrusiveNodeBase<Instruction> {
   // Runs the given function |f| on this instruction and optionally on the
   // preceding debug line instructions.  The function will always be run
   // if this is itself a debug line instruction.
-  inline void ForEachInst(const std::function<void(Instruction*)>& f,
-                          bool run_on_debug_line_insts = false);
-  inline void ForEachInst(const std::function<void(const Instruction*)>& f,
+  //
+  // The visitors below take |f| as a template argument rather than as a
+  // std::function, so that it is inlined into the loop over the operands
+  // instead of being called indirectly.  |f| may be any callable object.
+  template <typename Func>
+  inline void ForEachInst(const Func& f, bool run_on_debug_line_insts = false);
+  template <typename Func>
+  inline void ForEachInst(const Func& f,
                           bool run_on_debug_line_insts = false) const;
 
   // Runs the given function |f| on this instruction and optionally on the
   // preceding debug line instructions.  The function will always be run
   // if this is itself a debug line instruction. If |f| returns false,
   // iteration is terminated and this function returns false.
-  inline bool WhileEachInst(const std::function<bool(Instruction*)>& f,
+  template <typename Func>
+  inline bool WhileEachInst(const Func& f,
                             bool run_on_debug_line_insts = false);
-  inline bool WhileEachInst(const std::function<bool(const Instruction*)>& f,
+  template <typename Func>
+  inline bool WhileEachInst(const Func& f,
                             bool run_on_debug_line_insts = false) const;
 
   // Runs the given function |f| on all operand ids.
   //
   // |f| should not transform an ID into 0, as 0 is an invalid ID.
-  inline void ForEachId(const std::function<void(uint32_t*)>& f);
-  inline void ForEachId(const std::function<void(const uint32_t*)>& f) const;
+  template <typename Func>
+  inline void ForEachId(const Func& f);
+  template <typename Func>
+  inline void ForEachId(const Func& f) const;
 
   // Runs the given function |f| on all "in" operand ids.
-  inline void ForEachInId(const std::function<void(uint32_t*)>& f);
-  inline void ForEachInId(const std::function<void(const uint32_t*)>& f) const;
+  template <typename Func>
+  inline void ForEachInId(const Func& f);
+  template <typename Func>
+  inline void ForEachInId(const Func& f) const;
 
   // Runs the given function |f| on all "in" operand ids. If |f| returns false,
   // iteration is terminated and this function returns false.
-  inline bool WhileEachInId(const std::function<bool(uint32_t*)>& f);
-  inline bool WhileEachInId(
-      const std::function<bool(const uint32_t*)>& f) const;
+  template <typename Func>
+  inline bool WhileEachInId(const Func& f);
+  template <typename Func>
+  inline bool WhileEachInId(const Func& f) const;
 
   // Runs the given function |f| on all "in" operands.
-  inline void ForEachInOperand(const std::function<void(uint32_t*)>& f);
-  inline void ForEachInOperand(
-      const std::function<void(const uint32_t*)>& f) const;
+  template <typename Func>
+  inline void ForEachInOperand(const Func& f);
+  template <typename Func>
+  inline void ForEachInOperand(const Func& f) const;
 
   // Runs the given function |f| on all "in" operands. If |f| returns false,
   // iteration is terminated and this function return false.
-  inline bool WhileEachInOperand(const std::function<bool(uint32_t*)>& f);
-  inline bool WhileEachInOperand(
-      const std::function<bool(const uint32_t*)>& f) const;
+  template <typename Func>
+  inline bool WhileEachInOperand(const Func& f);
+  template <typename Func>
+  inline bool WhileEachInOperand(const Func& f) const;
 
   // Returns true if any operands can be labels
   inline bool HasLabels() const;
 
   // Pushes the binary segments for this instruction into the back of *|binary|.
   void ToBinaryWithoutAttachedDebugInsts(std::vector<uint32_t>* binary) const;
+  // Writes the binary segments for this instruction starting at |words|, which
+  // must have room for |NumOperandWords() + 1| words.  Returns the word past
+  // the last one written.
+  uint32_t* ToBinaryWithoutAttachedDebugInsts(uint32_t* words) const;
+
+  // Returns the number of words of the debug line instructions attached to
+  // this instruction in a binary.
+  uint32_t NumDbgLineWords() const;
+  // Writes the debug line instructions attached to this instruction starting
+  // at |words|, which must have room for |NumDbgLineWords()| words.  Returns
+  // the word past the last one written.
+  uint32_t* DbgLineInstsToBinary(uint32_t* words) const;
 
   // Replaces the operands to the instruction with |new_operands|. The caller
   // is responsible for building a complete and valid list of operands for
@@ -408,7 +475,11 @@ class Instruction : public utils::IntrusiveNodeBase<Instruction> {
   // immediately before |this|.  Returns the first inserted instruction.
   // Assumes the list is non-empty.
   Instruction* InsertBefore(std::vector<std::unique_ptr<Instruction>>&& list);
-  using utils::IntrusiveNodeBase<Instruction>::InsertBefore;
+
+  // Same semantics as in the base class, except that |this| is now in the
+  // basic block containing |pos|.
+  inline void InsertBefore(Instruction* pos);
+  inline void InsertAfter(Instruction* pos);
 
   // Returns true if |this| is an instruction defining a constant, but not a
   // Spec constant.
@@ -461,6 +532,9 @@ class Instruction : public utils::IntrusiveNodeBase<Instruction> {
   // instruction that samples a image, reads an image, or writes to an image.
   bool IsValidBaseImage() const;
 
+  // Sets the basic block containing this instruction.
+  void set_block(BasicBlock* block) { block_ = block; }
+
   IRContext* context_;  // IR Context
   SpvOp opcode_;        // Opcode
   bool has_type_id_;    // True if the instruction has a type id
@@ -468,12 +542,18 @@ class Instruction : public utils::IntrusiveNodeBase<Instruction> {
   uint32_t unique_id_;  // Unique instruction id
   // All logical operands, including result type id and result id.
   OperandList operands_;
-  // Opline and OpNoLine instructions preceding this instruction. Note that for
+  // The index of the OpLine and OpNoLine instructions preceding this
+  // instruction in the debug line table of the context. Note that for
   // Instructions representing OpLine or OpNonLine itself, this field should be
-  // empty.
-  std::vector<Instruction> dbg_line_insts_;
+  // kNoLines.
+  uint32_t dbg_lines_;
+  // The basic block containing this instruction.  For the sentinel of an
+  // InstructionList, the block owning the list.
+  BasicBlock* block_ = nullptr;
 
+  friend BasicBlock;
   friend InstructionList;
+  friend IRContext;
 };
 
 // Pretty-prints |inst| to |str| and returns |str|.
@@ -484,6 +564,16 @@ class Instruction : public utils::IntrusiveNodeBase<Instruction> {
 // Disassembly uses raw ids (not pretty printed names).
 std::ostream& operator<<(std::ostream& str, const Instruction& inst);
 
+inline void Instruction::InsertBefore(Instruction* pos) {
+  utils::IntrusiveNodeBase<Instruction>::InsertBefore(pos);
+  block_ = pos->block_;
+}
+
+inline void Instruction::InsertAfter(Instruction* pos) {
+  utils::IntrusiveNodeBase<Instruction>::InsertAfter(pos);
+  block_ = pos->block_;
+}
+
 inline bool Instruction::operator==(const Instruction& other) const {
   return unique_id() == other.unique_id();
 }
@@ -570,28 +660,38 @@ inline void Instruction::ToNop() {
   operands_.clear();
 }
 
-inline bool Instruction::WhileEachInst(
-    const std::function<bool(Instruction*)>& f, bool run_on_debug_line_insts) {
-  if (run_on_debug_line_insts) {
-    for (auto& dbg_line : dbg_line_insts_) {
-      if (!f(&dbg_line)) return false;
+template <typename Func>
+inline bool Instruction::WhileEachInst(const Func& f,
+                                       bool run_on_debug_line_insts) {
+  if (run_on_debug_line_insts && dbg_lines_ != DebugLineTable::kNoLines) {
+    // |f| runs on copies of the lines, which are kept as they are left.
+    std::vector<Instruction> dbg_line_insts = this->dbg_line_insts();
+    bool keep_going = true;
+    for (auto& dbg_line : dbg_line_insts) {
+      if (!f(&dbg_line)) {
+        keep_going = false;
+        break;
+      }
     }
+    set_dbg_line_insts(dbg_line_insts);
+    if (!keep_going) return false;
   }
   return f(this);
 }
 
-inline bool Instruction::WhileEachInst(
-    const std::function<bool(const Instruction*)>& f,
-    bool run_on_debug_line_insts) const {
-  if (run_on_debug_line_insts) {
-    for (auto& dbg_line : dbg_line_insts_) {
+template <typename Func>
+inline bool Instruction::WhileEachInst(const Func& f,
+                                       bool run_on_debug_line_insts) const {
+  if (run_on_debug_line_insts && dbg_lines_ != DebugLineTable::kNoLines) {
+    for (auto& dbg_line : dbg_line_insts()) {
       if (!f(&dbg_line)) return false;
     }
   }
   return f(this);
 }
 
-inline void Instruction::ForEachInst(const std::function<void(Instruction*)>& f,
+template <typename Func>
+inline void Instruction::ForEachInst(const Func& f,
                                      bool run_on_debug_line_insts) {
   WhileEachInst(
       [&f](Instruction* inst) {
@@ -601,9 +701,9 @@ inline void Instruction::ForEachInst(const std::function<void(Instruction*)>& f,
       run_on_debug_line_insts);
 }
 
-inline void Instruction::ForEachInst(
-    const std::function<void(const Instruction*)>& f,
-    bool run_on_debug_line_insts) const {
+template <typename Func>
+inline void Instruction::ForEachInst(const Func& f,
+                                     bool run_on_debug_line_insts) const {
   WhileEachInst(
       [&f](const Instruction* inst) {
         f(inst);
@@ -612,19 +712,20 @@ inline void Instruction::ForEachInst(
       run_on_debug_line_insts);
 }
 
-inline void Instruction::ForEachId(const std::function<void(uint32_t*)>& f) {
+template <typename Func>
+inline void Instruction::ForEachId(const Func& f) {
   for (auto& opnd : operands_)
     if (spvIsIdType(opnd.type)) f(&opnd.words[0]);
 }
 
-inline void Instruction::ForEachId(
-    const std::function<void(const uint32_t*)>& f) const {
+template <typename Func>
+inline void Instruction::ForEachId(const Func& f) const {
   for (const auto& opnd : operands_)
     if (spvIsIdType(opnd.type)) f(&opnd.words[0]);
 }
 
-inline bool Instruction::WhileEachInId(
-    const std::function<bool(uint32_t*)>& f) {
+template <typename Func>
+inline bool Instruction::WhileEachInId(const Func& f) {
   for (auto& opnd : operands_) {
     if (spvIsInIdType(opnd.type)) {
       if (!f(&opnd.words[0])) return false;
@@ -633,8 +734,8 @@ inline bool Instruction::WhileEachInId(
   return true;
 }
 
-inline bool Instruction::WhileEachInId(
-    const std::function<bool(const uint32_t*)>& f) const {
+template <typename Func>
+inline bool Instruction::WhileEachInId(const Func& f) const {
   for (const auto& opnd : operands_) {
     if (spvIsInIdType(opnd.type)) {
       if (!f(&opnd.words[0])) return false;
@@ -643,23 +744,24 @@ inline bool Instruction::WhileEachInId(
   return true;
 }
 
-inline void Instruction::ForEachInId(const std::function<void(uint32_t*)>& f) {
+template <typename Func>
+inline void Instruction::ForEachInId(const Func& f) {
   WhileEachInId([&f](uint32_t* id) {
     f(id);
     return true;
   });
 }
 
-inline void Instruction::ForEachInId(
-    const std::function<void(const uint32_t*)>& f) const {
+template <typename Func>
+inline void Instruction::ForEachInId(const Func& f) const {
   WhileEachInId([&f](const uint32_t* id) {
     f(id);
     return true;
   });
 }
 
-inline bool Instruction::WhileEachInOperand(
-    const std::function<bool(uint32_t*)>& f) {
+template <typename Func>
+inline bool Instruction::WhileEachInOperand(const Func& f) {
   for (auto& opnd : operands_) {
     switch (opnd.type) {
       case SPV_OPERAND_TYPE_RESULT_ID:
@@ -673,8 +775,8 @@ inline bool Instruction::WhileEachInOperand(
   return true;
 }
 
-inline bool Instruction::WhileEachInOperand(
-    const std::function<bool(const uint32_t*)>& f) const {
+template <typename Func>
+inline bool Instruction::WhileEachInOperand(const Func& f) const {
   for (const auto& opnd : operands_) {
     switch (opnd.type) {
       case SPV_OPERAND_TYPE_RESULT_ID:
@@ -688,16 +790,16 @@ inline bool Instruction::WhileEachInOperand(
   return true;
 }
 
-inline void Instruction::ForEachInOperand(
-    const std::function<void(uint32_t*)>& f) {
+template <typename Func>
+inline void Instruction::ForEachInOperand(const Func& f) {
   WhileEachInOperand([&f](uint32_t* op) {
     f(op);
     return true;
   });
 }
 
-inline void Instruction::ForEachInOperand(
-    const std::function<void(const uint32_t*)>& f) const {
+template <typename Func>
+inline void Instruction::ForEachInOperand(const Func& f) const {
   WhileEachInOperand([&f](const uint32_t* op) {
     f(op);
     return true;
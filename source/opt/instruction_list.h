@@ -45,10 +45,13 @@ class InstructionList : public utils::IntrusiveList<Instruction> {
  public:
   InstructionList() = default;
   InstructionList(InstructionList&& that)
-      : utils::IntrusiveList<Instruction>(std::move(that)) {}
+      : utils::IntrusiveList<Instruction>(std::move(that)) {
+    SetBlock(begin(), end(), block());
+  }
   InstructionList& operator=(InstructionList&& that) {
     auto p = static_cast<utils::IntrusiveList<Instruction>*>(this);
     *p = std::move(that);
+    SetBlock(begin(), end(), block());
     return *this;
   }
 
@@ -75,6 +78,18 @@ class InstructionList : public utils::IntrusiveList<Instruction> {
     // |*i| becomes |*this|
     iterator InsertBefore(std::unique_ptr<Instruction>&& i);
 
+    // Moves the nodes in |list| immediately before the element pointed to by
+    // the iterator, as in the base class, and places them in the basic block
+    // of that element.  Returns an iterator pointing to the first of the
+    // moved nodes.
+    iterator MoveBefore(InstructionList* list) {
+      Instruction* block_node = node_;
+      iterator first =
+          utils::IntrusiveList<Instruction>::iterator::MoveBefore(list);
+      SetBlock(first, *this, block_node->block());
+      return first;
+    }
+
     // Removes the node from the list, and deletes the storage.  Returns a valid
     // iterator to the next node.
     iterator Erase() {
@@ -99,19 +114,46 @@ class InstructionList : public utils::IntrusiveList<Instruction> {
     utils::IntrusiveList<Instruction>::push_back(inst.release());
   }
 
+  // Transfers [|first|, |last|) from |other| into the list at |where|, as in
+  // the base class, and places them in the basic block owning this list.
+  void Splice(iterator where, InstructionList* other, iterator first,
+              iterator last) {
+    SetBlock(first, last, block());
+    utils::IntrusiveList<Instruction>::Splice(where, other, first, last);
+  }
+
+  // Returns the basic block owning this list, or nullptr if it is not owned
+  // by a basic block.
+  BasicBlock* block() const { return sentinel_.block(); }
+
+  // Sets the basic block owning this list to |block|, and places the
+  // instructions in the list in it.
+  void set_block(BasicBlock* block) {
+    sentinel_.block_ = block;
+    SetBlock(begin(), end(), block);
+  }
+
   // Same as in the base class, except it will delete the data as well.
   inline void clear();
 
   // Runs the given function |f| on the instructions in the list and optionally
   // on the preceding debug line instructions.
-  inline void ForEachInst(const std::function<void(Instruction*)>& f,
-                          bool run_on_debug_line_insts) {
+  template <typename Func>
+  inline void ForEachInst(const Func& f, bool run_on_debug_line_insts) {
     auto next = begin();
     for (auto i = next; i != end(); i = next) {
       ++next;
       i->ForEachInst(f, run_on_debug_line_insts);
     }
   }
+
+ private:
+  // Places the instructions in the range [|first|, |last|) in |block|.
+  static void SetBlock(iterator first, iterator last, BasicBlock* block) {
+    for (auto i = first; i != last; ++i) {
+      i->block_ = block;
+    }
+  }
 };
 
 InstructionList::~InstructionList() { clear(); }
@@ -29,6 +29,10 @@ static const int kInstCommonParamCnt = 1;
 static const int kEntryPointExecutionModelInIdx = 0;
 static const int kEntryPointFunctionIdInIdx = 1;
 
+// Multiplier of the invocation hash: 2^32 divided by the golden ratio, which
+// spreads consecutive invocation ids over the whole range.
+static const uint32_t kInstHashMultiplier = 0x9E3779B1;
+
 }  // anonymous namespace
 
 namespace spvtools {
@@ -266,6 +270,94 @@ void InstrumentPass::GenStageStreamWriteCode(uint32_t stage_idx,
   }
 }
 
+uint32_t InstrumentPass::GenInvocationHashCode(uint32_t stage_idx,
+                                               InstructionBuilder* builder) {
+  // Gather the words identifying the invocation.
+  std::vector<uint32_t> word_ids;
+  auto gen_builtin_words = [this, &word_ids, builder](SpvBuiltIn builtin) {
+    uint32_t load_id =
+        GenVarLoad(context()->GetBuiltinInputVarId(builtin), builder);
+    word_ids.push_back(GenUintCastCode(load_id, builder));
+  };
+  auto gen_vector_words = [this, &word_ids, builder](uint32_t vec_id,
+                                                     uint32_t count) {
+    for (uint32_t u = 0; u < count; ++u) {
+      word_ids.push_back(
+          builder->AddIdLiteralOp(GetUintId(), SpvOpCompositeExtract, vec_id, u)
+              ->result_id());
+    }
+  };
+  switch (stage_idx) {
+    case SpvExecutionModelVertex: {
+      gen_builtin_words(SpvBuiltInVertexIndex);
+      gen_builtin_words(SpvBuiltInInstanceIndex);
+    } break;
+    case SpvExecutionModelGLCompute: {
+      gen_vector_words(
+          GenVarLoad(
+              context()->GetBuiltinInputVarId(SpvBuiltInGlobalInvocationId),
+              builder),
+          3u);
+    } break;
+    case SpvExecutionModelGeometry:
+    case SpvExecutionModelTessellationControl: {
+      gen_builtin_words(SpvBuiltInPrimitiveId);
+      gen_builtin_words(SpvBuiltInInvocationId);
+    } break;
+    case SpvExecutionModelTessellationEvaluation: {
+      gen_builtin_words(SpvBuiltInPrimitiveId);
+      uint32_t load_id = GenVarLoad(
+          context()->GetBuiltinInputVarId(SpvBuiltInTessCoord), builder);
+      gen_vector_words(
+          builder->AddUnaryOp(GetVec3UintId(), SpvOpBitcast, load_id)
+              ->result_id(),
+          2u);
+    } break;
+    case SpvExecutionModelFragment: {
+      Instruction* frag_coord_inst = builder->AddUnaryOp(
+          GetVec4FloatId(), SpvOpLoad,
+          context()->GetBuiltinInputVarId(SpvBuiltInFragCoord));
+      gen_vector_words(
+          builder
+              ->AddUnaryOp(GetVec4UintId(), SpvOpBitcast,
+                           frag_coord_inst->result_id())
+              ->result_id(),
+          2u);
+    } break;
+    case SpvExecutionModelRayGenerationNV:
+    case SpvExecutionModelIntersectionNV:
+    case SpvExecutionModelAnyHitNV:
+    case SpvExecutionModelClosestHitNV:
+    case SpvExecutionModelMissNV:
+    case SpvExecutionModelCallableNV: {
+      gen_vector_words(
+          GenVarLoad(context()->GetBuiltinInputVarId(SpvBuiltInLaunchIdNV),
+                     builder),
+          3u);
+    } break;
+    default: { assert(false && "unsupported stage"); } break;
+  }
+  // Combine the words with a multiplicative hash, then fold the high bits,
+  // which depend on all the words, into the low ones.
+  uint32_t mult_id = builder->GetUintConstantId(kInstHashMultiplier);
+  uint32_t hash_id = 0;
+  for (uint32_t word_id : word_ids) {
+    if (hash_id != 0) {
+      word_id = builder->AddBinaryOp(GetUintId(), SpvOpBitwiseXor, hash_id,
+                                     word_id)
+                    ->result_id();
+    }
+    hash_id = builder->AddBinaryOp(GetUintId(), SpvOpIMul, word_id, mult_id)
+                  ->result_id();
+  }
+  uint32_t shift_id = builder->AddBinaryOp(GetUintId(), SpvOpShiftRightLogical,
+                                           hash_id,
+                                           builder->GetUintConstantId(16u))
+                          ->result_id();
+  return builder->AddBinaryOp(GetUintId(), SpvOpBitwiseXor, hash_id, shift_id)
+      ->result_id();
+}
+
 void InstrumentPass::GenDebugStreamWrite(
     uint32_t instruction_idx, uint32_t stage_idx,
     const std::vector<uint32_t>& validation_ids, InstructionBuilder* builder) {
@@ -380,6 +472,8 @@ uint32_t InstrumentPass::GetOutputBufferBinding() {
       return kDebugOutputBindingStream;
     case kInstValidationIdBuffAddr:
       return kDebugOutputBindingStream;
+    case kInstValidationIdProfile:
+      return kDebugOutputBindingProfile;
     default:
       assert(false && "unexpected validation id");
   }
@@ -857,7 +951,12 @@ bool InstrumentPass::InstProcessCallTreeFromRoots(InstProcessFunction& pfn,
       Function* fn = id2function_.at(fi);
       // Add calls first so we don't add new output function
       context()->AddCalls(fn, roots);
-      modified = InstrumentFunction(fn, stage_idx, pfn) || modified;
+      if (InstrumentFunction(fn, stage_idx, pfn)) {
+        modified = true;
+        if (context()->AreAnalysesValid(IRContext::kAnalysisCallGraph)) {
+          context()->GetCallGraph()->UpdateFunction(fn);
+        }
+      }
     }
   }
   return modified;
@@ -998,7 +1097,7 @@ void InstrumentPass::InitializeInstrument() {
   }
   for (auto& i : module->types_values()) {
     module_offset += 1;
-    module_offset += static_cast<uint32_t>(i.dbg_line_insts().size());
+    module_offset += i.NumDbgLineInsts();
   }
 
   auto curr_fn = get_module()->begin();
@@ -1011,7 +1110,7 @@ void InstrumentPass::InitializeInstrument() {
       // Count label
       module_offset += 1;
       for (auto& inst : blk) {
-        module_offset += static_cast<uint32_t>(inst.dbg_line_insts().size());
+        module_offset += inst.NumDbgLineInsts();
         uid2offset_[inst.unique_id()] = module_offset;
         module_offset += 1;
       }
@@ -61,6 +61,7 @@ namespace opt {
 // its output buffers.
 static const uint32_t kInstValidationIdBindless = 0;
 static const uint32_t kInstValidationIdBuffAddr = 1;
+static const uint32_t kInstValidationIdProfile = 2;
 
 class InstrumentPass : public Pass {
   using cbb_ptr = const BasicBlock*;
@@ -78,6 +79,10 @@ class InstrumentPass : public Pass {
            IRContext::kAnalysisBuiltinVarId | IRContext::kAnalysisConstants;
   }
 
+  // The instrumentation is what the layers running the shader rely on, so it
+  // is never dropped to save time.
+  bool IsRequired() const override { return true; }
+
  protected:
   // Create instrumentation pass for |validation_id| which utilizes descriptor
   // set |desc_set| for debug input and output buffers and writes |shader_id|
@@ -206,6 +211,12 @@ class InstrumentPass : public Pass {
                            const std::vector<uint32_t>& validation_ids,
                            InstructionBuilder* builder);
 
+  // Generate in |builder| instructions to hash the builtins identifying the
+  // current invocation of stage |stage_idx|, which are the stage-specific
+  // words of its error records. Return the id of the unsigned hash value.
+  uint32_t GenInvocationHashCode(uint32_t stage_idx,
+                                 InstructionBuilder* builder);
+
   // Generate in |builder| instructions to read the unsigned integer from the
   // input buffer specified by the offsets in |offset_ids|. Given offsets
   // o0, o1, ... oN, and input buffer ibuf, return the id for the value:
@@ -67,7 +67,8 @@ class InstructionBuilder {
       }
     }
     std::unique_ptr<Instruction> new_inst(
-        new Instruction(GetContext(), opcode, type_id, result_id, {}));
+        new (GetContext()) Instruction(GetContext(), opcode, type_id, result_id,
+                                       {}));
     return AddInstruction(std::move(new_inst));
   }
 
@@ -79,7 +80,7 @@ class InstructionBuilder {
         return nullptr;
       }
     }
-    std::unique_ptr<Instruction> newUnOp(new Instruction(
+    std::unique_ptr<Instruction> newUnOp(new (GetContext()) Instruction(
         GetContext(), opcode, type_id, result_id,
         {{spv_operand_type_t::SPV_OPERAND_TYPE_ID, {operand1}}}));
     return AddInstruction(std::move(newUnOp));
@@ -94,7 +95,7 @@ class InstructionBuilder {
         return nullptr;
       }
     }
-    std::unique_ptr<Instruction> newBinOp(new Instruction(
+    std::unique_ptr<Instruction> newBinOp(new (GetContext()) Instruction(
         GetContext(), opcode, type_id, opcode == SpvOpStore ? 0 : result_id,
         {{spv_operand_type_t::SPV_OPERAND_TYPE_ID, {operand1}},
          {spv_operand_type_t::SPV_OPERAND_TYPE_ID, {operand2}}}));
@@ -110,7 +111,7 @@ class InstructionBuilder {
         return nullptr;
       }
     }
-    std::unique_ptr<Instruction> newTernOp(new Instruction(
+    std::unique_ptr<Instruction> newTernOp(new (GetContext()) Instruction(
         GetContext(), opcode, type_id, result_id,
         {{spv_operand_type_t::SPV_OPERAND_TYPE_ID, {operand1}},
          {spv_operand_type_t::SPV_OPERAND_TYPE_ID, {operand2}},
@@ -128,7 +129,7 @@ class InstructionBuilder {
         return nullptr;
       }
     }
-    std::unique_ptr<Instruction> newQuadOp(new Instruction(
+    std::unique_ptr<Instruction> newQuadOp(new (GetContext()) Instruction(
         GetContext(), opcode, type_id, result_id,
         {{spv_operand_type_t::SPV_OPERAND_TYPE_ID, {operand1}},
          {spv_operand_type_t::SPV_OPERAND_TYPE_ID, {operand2}},
@@ -146,7 +147,7 @@ class InstructionBuilder {
         return nullptr;
       }
     }
-    std::unique_ptr<Instruction> newBinOp(new Instruction(
+    std::unique_ptr<Instruction> newBinOp(new (GetContext()) Instruction(
         GetContext(), opcode, type_id, result_id,
         {{spv_operand_type_t::SPV_OPERAND_TYPE_ID, {id}},
          {spv_operand_type_t::SPV_OPERAND_TYPE_LITERAL_INTEGER, {uliteral}}}));
@@ -165,7 +166,7 @@ class InstructionBuilder {
       ops.push_back({SPV_OPERAND_TYPE_ID, {operands[i]}});
     }
     // TODO(1841): Handle id overflow.
-    std::unique_ptr<Instruction> new_inst(new Instruction(
+    std::unique_ptr<Instruction> new_inst(new (GetContext()) Instruction(
         GetContext(), opcode, type_id,
         result != 0 ? result : GetContext()->TakeNextId(), ops));
     return AddInstruction(std::move(new_inst));
@@ -176,11 +177,12 @@ class InstructionBuilder {
   Instruction* AddSelectionMerge(
       uint32_t merge_id,
       uint32_t selection_control = SpvSelectionControlMaskNone) {
-    std::unique_ptr<Instruction> new_branch_merge(new Instruction(
-        GetContext(), SpvOpSelectionMerge, 0, 0,
-        {{spv_operand_type_t::SPV_OPERAND_TYPE_ID, {merge_id}},
-         {spv_operand_type_t::SPV_OPERAND_TYPE_SELECTION_CONTROL,
-          {selection_control}}}));
+    std::unique_ptr<Instruction> new_branch_merge(
+        new (GetContext()) Instruction(
+            GetContext(), SpvOpSelectionMerge, 0, 0,
+            {{spv_operand_type_t::SPV_OPERAND_TYPE_ID, {merge_id}},
+             {spv_operand_type_t::SPV_OPERAND_TYPE_SELECTION_CONTROL,
+              {selection_control}}}));
     return AddInstruction(std::move(new_branch_merge));
   }
 
@@ -190,11 +192,13 @@ class InstructionBuilder {
   // |loop_control| are the loop control flags to be added to the instruction.
   Instruction* AddLoopMerge(uint32_t merge_id, uint32_t continue_id,
                             uint32_t loop_control = SpvLoopControlMaskNone) {
-    std::unique_ptr<Instruction> new_branch_merge(new Instruction(
-        GetContext(), SpvOpLoopMerge, 0, 0,
-        {{spv_operand_type_t::SPV_OPERAND_TYPE_ID, {merge_id}},
-         {spv_operand_type_t::SPV_OPERAND_TYPE_ID, {continue_id}},
-         {spv_operand_type_t::SPV_OPERAND_TYPE_LOOP_CONTROL, {loop_control}}}));
+    std::unique_ptr<Instruction> new_branch_merge(
+        new (GetContext()) Instruction(
+            GetContext(), SpvOpLoopMerge, 0, 0,
+            {{spv_operand_type_t::SPV_OPERAND_TYPE_ID, {merge_id}},
+             {spv_operand_type_t::SPV_OPERAND_TYPE_ID, {continue_id}},
+             {spv_operand_type_t::SPV_OPERAND_TYPE_LOOP_CONTROL,
+              {loop_control}}}));
     return AddInstruction(std::move(new_branch_merge));
   }
 
@@ -202,7 +206,7 @@ class InstructionBuilder {
   // Note that the user must make sure the final basic block is
   // well formed.
   Instruction* AddBranch(uint32_t label_id) {
-    std::unique_ptr<Instruction> new_branch(new Instruction(
+    std::unique_ptr<Instruction> new_branch(new (GetContext()) Instruction(
         GetContext(), SpvOpBranch, 0, 0,
         {{spv_operand_type_t::SPV_OPERAND_TYPE_ID, {label_id}}}));
     return AddInstruction(std::move(new_branch));
@@ -230,7 +234,7 @@ class InstructionBuilder {
     if (merge_id != kInvalidId) {
       AddSelectionMerge(merge_id, selection_control);
     }
-    std::unique_ptr<Instruction> new_branch(new Instruction(
+    std::unique_ptr<Instruction> new_branch(new (GetContext()) Instruction(
         GetContext(), SpvOpBranchConditional, 0, 0,
         {{spv_operand_type_t::SPV_OPERAND_TYPE_ID, {cond_id}},
          {spv_operand_type_t::SPV_OPERAND_TYPE_ID, {true_id}},
@@ -272,7 +276,8 @@ class InstructionBuilder {
           Operand{spv_operand_type_t::SPV_OPERAND_TYPE_ID, {target.second}});
     }
     std::unique_ptr<Instruction> new_switch(
-        new Instruction(GetContext(), SpvOpSwitch, 0, 0, operands));
+        new (GetContext())
+            Instruction(GetContext(), SpvOpSwitch, 0, 0, operands));
     return AddInstruction(std::move(new_switch));
   }
 
@@ -293,7 +298,7 @@ class InstructionBuilder {
   // The id |op2| is the right hand side of the operation.
   Instruction* AddIAdd(uint32_t type, uint32_t op1, uint32_t op2) {
     // TODO(1841): Handle id overflow.
-    std::unique_ptr<Instruction> inst(new Instruction(
+    std::unique_ptr<Instruction> inst(new (GetContext()) Instruction(
         GetContext(), SpvOpIAdd, type, GetContext()->TakeNextId(),
         {{SPV_OPERAND_TYPE_ID, {op1}}, {SPV_OPERAND_TYPE_ID, {op2}}}));
     return AddInstruction(std::move(inst));
@@ -307,7 +312,7 @@ class InstructionBuilder {
     analysis::Bool bool_type;
     uint32_t type = GetContext()->get_type_mgr()->GetId(&bool_type);
     // TODO(1841): Handle id overflow.
-    std::unique_ptr<Instruction> inst(new Instruction(
+    std::unique_ptr<Instruction> inst(new (GetContext()) Instruction(
         GetContext(), SpvOpULessThan, type, GetContext()->TakeNextId(),
         {{SPV_OPERAND_TYPE_ID, {op1}}, {SPV_OPERAND_TYPE_ID, {op2}}}));
     return AddInstruction(std::move(inst));
@@ -321,7 +326,7 @@ class InstructionBuilder {
     analysis::Bool bool_type;
     uint32_t type = GetContext()->get_type_mgr()->GetId(&bool_type);
     // TODO(1841): Handle id overflow.
-    std::unique_ptr<Instruction> inst(new Instruction(
+    std::unique_ptr<Instruction> inst(new (GetContext()) Instruction(
         GetContext(), SpvOpSLessThan, type, GetContext()->TakeNextId(),
         {{SPV_OPERAND_TYPE_ID, {op1}}, {SPV_OPERAND_TYPE_ID, {op2}}}));
     return AddInstruction(std::move(inst));
@@ -351,7 +356,7 @@ class InstructionBuilder {
   Instruction* AddSelect(uint32_t type, uint32_t cond, uint32_t true_value,
                          uint32_t false_value) {
     // TODO(1841): Handle id overflow.
-    std::unique_ptr<Instruction> select(new Instruction(
+    std::unique_ptr<Instruction> select(new (GetContext()) Instruction(
         GetContext(), SpvOpSelect, type, GetContext()->TakeNextId(),
         std::initializer_list<Operand>{{SPV_OPERAND_TYPE_ID, {cond}},
                                        {SPV_OPERAND_TYPE_ID, {true_value}},
@@ -377,8 +382,8 @@ class InstructionBuilder {
     }
     // TODO(1841): Handle id overflow.
     std::unique_ptr<Instruction> construct(
-        new Instruction(GetContext(), SpvOpCompositeConstruct, type,
-                        GetContext()->TakeNextId(), ops));
+        new (GetContext()) Instruction(GetContext(), SpvOpCompositeConstruct,
+                                       type, GetContext()->TakeNextId(), ops));
     return AddInstruction(std::move(construct));
   }
   // Adds an unsigned int32 constant to the binary.
@@ -439,16 +444,17 @@ class InstructionBuilder {
 
     // TODO(1841): Handle id overflow.
     std::unique_ptr<Instruction> new_inst(
-        new Instruction(GetContext(), SpvOpCompositeExtract, type,
-                        GetContext()->TakeNextId(), operands));
+        new (GetContext()) Instruction(GetContext(), SpvOpCompositeExtract,
+                                       type, GetContext()->TakeNextId(),
+                                       operands));
     return AddInstruction(std::move(new_inst));
   }
 
   // Creates an unreachable instruction.
   Instruction* AddUnreachable() {
     std::unique_ptr<Instruction> select(
-        new Instruction(GetContext(), SpvOpUnreachable, 0, 0,
-                        std::initializer_list<Operand>{}));
+        new (GetContext()) Instruction(GetContext(), SpvOpUnreachable, 0, 0,
+                                       std::initializer_list<Operand>{}));
     return AddInstruction(std::move(select));
   }
 
@@ -463,8 +469,8 @@ class InstructionBuilder {
 
     // TODO(1841): Handle id overflow.
     std::unique_ptr<Instruction> new_inst(
-        new Instruction(GetContext(), SpvOpAccessChain, type_id,
-                        GetContext()->TakeNextId(), operands));
+        new (GetContext()) Instruction(GetContext(), SpvOpAccessChain, type_id,
+                                       GetContext()->TakeNextId(), operands));
     return AddInstruction(std::move(new_inst));
   }
 
@@ -474,8 +480,8 @@ class InstructionBuilder {
 
     // TODO(1841): Handle id overflow.
     std::unique_ptr<Instruction> new_inst(
-        new Instruction(GetContext(), SpvOpLoad, type_id,
-                        GetContext()->TakeNextId(), operands));
+        new (GetContext()) Instruction(GetContext(), SpvOpLoad, type_id,
+                                       GetContext()->TakeNextId(), operands));
     return AddInstruction(std::move(new_inst));
   }
 
@@ -485,7 +491,8 @@ class InstructionBuilder {
     operands.push_back({SPV_OPERAND_TYPE_ID, {obj_id}});
 
     std::unique_ptr<Instruction> new_inst(
-        new Instruction(GetContext(), SpvOpStore, 0, 0, operands));
+        new (GetContext())
+            Instruction(GetContext(), SpvOpStore, 0, 0, operands));
     return AddInstruction(std::move(new_inst));
   }
 
@@ -501,7 +508,7 @@ class InstructionBuilder {
     if (result_id == 0) {
       return nullptr;
     }
-    std::unique_ptr<Instruction> new_inst(new Instruction(
+    std::unique_ptr<Instruction> new_inst(new (GetContext()) Instruction(
         GetContext(), SpvOpFunctionCall, result_type, result_id, operands));
     return AddInstruction(std::move(new_inst));
   }
@@ -521,7 +528,7 @@ class InstructionBuilder {
       return nullptr;
     }
 
-    std::unique_ptr<Instruction> new_inst(new Instruction(
+    std::unique_ptr<Instruction> new_inst(new (GetContext()) Instruction(
         GetContext(), SpvOpVectorShuffle, result_type, result_id, operands));
     return AddInstruction(std::move(new_inst));
   }
@@ -542,7 +549,7 @@ class InstructionBuilder {
       return nullptr;
     }
 
-    std::unique_ptr<Instruction> new_inst(new Instruction(
+    std::unique_ptr<Instruction> new_inst(new (GetContext()) Instruction(
         GetContext(), SpvOpExtInst, result_type, result_id, operands));
     return AddInstruction(std::move(new_inst));
   }
@@ -20,6 +20,7 @@
 #include "source/opt/log.h"
 #include "source/opt/mem_pass.h"
 #include "source/opt/reflect.h"
+#include "source/util/parallel.h"
 
 namespace {
 
@@ -34,6 +35,52 @@ static const int kEntryPointFunctionIdInIdx = 1;
 namespace spvtools {
 namespace opt {
 
+const char* IRContext::GetAnalysisName(Analysis analysis) {
+  switch (analysis) {
+    case kAnalysisDefUse:
+      return "def-use";
+    case kAnalysisInstrToBlockMapping:
+      return "instr-to-block";
+    case kAnalysisDecorations:
+      return "decorations";
+    case kAnalysisCombinators:
+      return "combinators";
+    case kAnalysisCFG:
+      return "cfg";
+    case kAnalysisDominatorAnalysis:
+      return "dominators";
+    case kAnalysisLoopAnalysis:
+      return "loops";
+    case kAnalysisNameMap:
+      return "name-map";
+    case kAnalysisScalarEvolution:
+      return "scalar-evolution";
+    case kAnalysisRegisterPressure:
+      return "register-pressure";
+    case kAnalysisValueNumberTable:
+      return "value-numbers";
+    case kAnalysisStructuredCFG:
+      return "structured-cfg";
+    case kAnalysisBuiltinVarId:
+      return "builtin-vars";
+    case kAnalysisIdToFuncMapping:
+      return "id-to-func";
+    case kAnalysisConstants:
+      return "constants";
+    case kAnalysisTypes:
+      return "types";
+    case kAnalysisUniformity:
+      return "uniformity";
+    case kAnalysisModuleSummary:
+      return "module-summary";
+    case kAnalysisCallGraph:
+      return "call-graph";
+    default:
+      assert(false && "Expected a single analysis.");
+      return "";
+  }
+}
+
 void IRContext::BuildInvalidAnalyses(IRContext::Analysis set) {
   if (set & kAnalysisDefUse) {
     BuildDefUseManager();
@@ -80,6 +127,51 @@ void IRContext::BuildInvalidAnalyses(IRContext::Analysis set) {
   if (set & kAnalysisTypes) {
     BuildTypeManager();
   }
+  if (set & kAnalysisUniformity) {
+    BuildUniformityAnalysis();
+  }
+  if (set & kAnalysisModuleSummary) {
+    BuildModuleSummary();
+  }
+  if (set & kAnalysisCallGraph) {
+    BuildCallGraph();
+  }
+}
+
+void IRContext::Freeze(IRContext::Analysis set) {
+  BuildInvalidAnalyses(Analysis(set & ~valid_analyses_));
+  if ((set & kAnalysisCombinators) && !AreAnalysesValid(kAnalysisCombinators)) {
+    InitializeCombinators();
+  }
+  get_feature_mgr();
+  if (set & kAnalysisDefUse) {
+    get_def_use_mgr()->set_concurrent_reads(true);
+  }
+  if (set & kAnalysisDecorations) {
+    get_decoration_mgr()->LoadAllDecorations();
+  }
+  if (set & kAnalysisDominatorAnalysis) {
+    BuildDominatorAnalyses(true);
+  }
+  if (set & kAnalysisLoopAnalysis) {
+    for (const Function& function : *module()) {
+      GetLoopDescriptor(&function);
+    }
+  }
+  if (set & kAnalysisNameMap) {
+    for (const auto& entry : name_index_) {
+      if (entry.second) id_to_name_->insert(entry);
+    }
+    name_index_.clear();
+  }
+  frozen_ = true;
+}
+
+void IRContext::Unfreeze() {
+  if (AreAnalysesValid(kAnalysisDefUse)) {
+    get_def_use_mgr()->set_concurrent_reads(false);
+  }
+  frozen_ = false;
 }
 
 void IRContext::InvalidateAnalysesExceptFor(
@@ -89,6 +181,7 @@ void IRContext::InvalidateAnalysesExceptFor(
 }
 
 void IRContext::InvalidateAnalyses(IRContext::Analysis analyses_to_invalidate) {
+  assert(!frozen_ && "No analysis is invalidated while frozen.");
   // The ConstantManager contains Type pointers. If the TypeManager goes
   // away, the ConstantManager has to go away.
   if (analyses_to_invalidate & kAnalysisTypes) {
@@ -105,9 +198,10 @@ void IRContext::InvalidateAnalyses(IRContext::Analysis analyses_to_invalidate) {
   if (analyses_to_invalidate & kAnalysisDefUse) {
     def_use_mgr_.reset(nullptr);
   }
-  if (analyses_to_invalidate & kAnalysisInstrToBlockMapping) {
-    instr_to_block_.clear();
-  }
+  // The instruction-block mapping is kept in the instructions, so it stays
+  // valid.
+  analyses_to_invalidate =
+      Analysis(analyses_to_invalidate & ~kAnalysisInstrToBlockMapping);
   if (analyses_to_invalidate & kAnalysisDecorations) {
     decoration_mgr_.reset(nullptr);
   }
@@ -126,6 +220,7 @@ void IRContext::InvalidateAnalyses(IRContext::Analysis analyses_to_invalidate) {
   }
   if (analyses_to_invalidate & kAnalysisNameMap) {
     id_to_name_.reset(nullptr);
+    name_index_.clear();
   }
   if (analyses_to_invalidate & kAnalysisValueNumberTable) {
     vn_table_.reset(nullptr);
@@ -142,10 +237,43 @@ void IRContext::InvalidateAnalyses(IRContext::Analysis analyses_to_invalidate) {
   if (analyses_to_invalidate & kAnalysisTypes) {
     type_mgr_.reset(nullptr);
   }
+  if (analyses_to_invalidate & kAnalysisUniformity) {
+    uniformity_analysis_.reset(nullptr);
+  }
+  if (analyses_to_invalidate & kAnalysisModuleSummary) {
+    module_summary_.reset(nullptr);
+  }
+  if (analyses_to_invalidate & kAnalysisCallGraph) {
+    call_graph_.reset(nullptr);
+  }
 
   valid_analyses_ = Analysis(valid_analyses_ & ~analyses_to_invalidate);
 }
 
+void IRContext::InvalidateAnalysesForFunction(
+    Function* function, IRContext::Analysis analyses_to_invalidate) {
+  assert(!frozen_ && "No analysis is invalidated while frozen.");
+  // As in |InvalidateAnalyses|, the dominators change with the CFG.
+  if (analyses_to_invalidate & kAnalysisCFG) {
+    analyses_to_invalidate |= kAnalysisDominatorAnalysis;
+    if (AreAnalysesValid(kAnalysisCFG)) {
+      cfg_->RebuildFunction(function);
+    }
+  }
+  if (analyses_to_invalidate & kAnalysisDominatorAnalysis) {
+    dominator_trees_.erase(function);
+    post_dominator_trees_.erase(function);
+  }
+  if (analyses_to_invalidate & kAnalysisLoopAnalysis) {
+    loop_descriptors_.erase(function);
+  }
+
+  const uint32_t per_function_analyses =
+      kAnalysisCFG | kAnalysisDominatorAnalysis | kAnalysisLoopAnalysis;
+  InvalidateAnalyses(
+      Analysis(analyses_to_invalidate & ~per_function_analyses));
+}
+
 Instruction* IRContext::KillInst(Instruction* inst) {
   if (!inst) {
     return nullptr;
@@ -156,14 +284,28 @@ Instruction* IRContext::KillInst(Instruction* inst) {
   if (AreAnalysesValid(kAnalysisDefUse)) {
     get_def_use_mgr()->ClearInst(inst);
   }
-  if (AreAnalysesValid(kAnalysisInstrToBlockMapping)) {
-    instr_to_block_.erase(inst);
+  if (AreAnalysesValid(kAnalysisCallGraph)) {
+    if (inst->opcode() == SpvOpFunctionCall) {
+      BasicBlock* bb = inst->block();
+      if (bb != nullptr && bb->GetParent() != nullptr) {
+        call_graph_->RemoveCall(bb->GetParent()->result_id(),
+                                inst->GetSingleWordInOperand(0));
+      } else {
+        InvalidateAnalyses(kAnalysisCallGraph);
+      }
+    } else if (inst->opcode() == SpvOpFunction) {
+      call_graph_->RemoveFunction(inst->result_id());
+    }
   }
+  inst->set_block(nullptr);
   if (AreAnalysesValid(kAnalysisDecorations)) {
     if (inst->IsDecoration()) {
       decoration_mgr_->RemoveDecoration(inst);
     }
   }
+  if (AreAnalysesValid(kAnalysisValueNumberTable) && inst->result_id() != 0) {
+    vn_table_->ClearInstruction(inst);
+  }
   if (type_mgr_ && IsTypeInst(inst->opcode())) {
     type_mgr_->RemoveId(inst->result_id());
   }
@@ -194,6 +336,41 @@ Instruction* IRContext::KillInst(Instruction* inst) {
   return next_instruction;
 }
 
+void IRContext::KillInsts(const std::vector<Instruction*>& insts) {
+  for (Instruction* inst : insts) KillInst(inst);
+}
+
+void IRContext::UpdateAnalysesForMerge(BasicBlock* block, uint32_t succ_id) {
+  if (AreAnalysesValid(kAnalysisCFG)) {
+    cfg_->MergeSuccessorInto(block, succ_id);
+  }
+  const Function* function = block->GetParent();
+  auto dominators = dominator_trees_.find(function);
+  if (dominators != dominator_trees_.end()) {
+    dominators->second.GetDomTree().MergeNodes(block->id(), succ_id);
+  }
+  auto post_dominators = post_dominator_trees_.find(function);
+  if (post_dominators != post_dominator_trees_.end()) {
+    post_dominators->second.GetDomTree().MergeNodes(block->id(), succ_id);
+  }
+}
+
+void IRContext::UpdateAnalysesForSplit(BasicBlock* block,
+                                       BasicBlock* new_block) {
+  if (AreAnalysesValid(kAnalysisCFG)) {
+    cfg_->SplitBlock(block, new_block);
+  }
+  const Function* function = block->GetParent();
+  auto dominators = dominator_trees_.find(function);
+  if (dominators != dominator_trees_.end()) {
+    dominators->second.GetDomTree().SplitNode(block, new_block);
+  }
+  auto post_dominators = post_dominator_trees_.find(function);
+  if (post_dominators != post_dominator_trees_.end()) {
+    post_dominators->second.GetDomTree().SplitNode(block, new_block);
+  }
+}
+
 bool IRContext::KillDef(uint32_t id) {
   Instruction* def = get_def_use_mgr()->GetDef(id);
   if (def != nullptr) {
@@ -262,6 +439,46 @@ bool IRContext::ReplaceAllUsesWithPredicate(
   return true;
 }
 
+bool IRContext::ReplaceAllUsesWith(
+    const std::unordered_map<uint32_t, uint32_t>& replacements) {
+  if (replacements.empty()) return false;
+#ifndef NDEBUG
+  for (const auto& replacement : replacements) {
+    assert(replacements.count(replacement.second) == 0 &&
+           "An id is replaced with an id that is replaced too.");
+  }
+#endif
+
+  bool modified = false;
+  module()->ForEachInst([this, &replacements, &modified](Instruction* inst) {
+    modified |= ReplaceUsesIn(inst, replacements);
+  });
+  return modified;
+}
+
+bool IRContext::ReplaceUsesIn(
+    Instruction* inst,
+    const std::unordered_map<uint32_t, uint32_t>& replacements) {
+  const bool uses_replaced_id =
+      replacements.count(inst->type_id()) != 0 ||
+      !inst->WhileEachInId([&replacements](const uint32_t* id) {
+        return replacements.count(*id) == 0;
+      });
+  if (!uses_replaced_id) return false;
+
+  ForgetUses(inst);
+  auto type_iter = replacements.find(inst->type_id());
+  if (type_iter != replacements.end()) {
+    inst->SetResultType(type_iter->second);
+  }
+  inst->ForEachInId([&replacements](uint32_t* id) {
+    auto iter = replacements.find(*id);
+    if (iter != replacements.end()) *id = iter->second;
+  });
+  AnalyzeUses(inst);
+  return true;
+}
+
 bool IRContext::IsConsistent() {
 #ifndef SPIRV_CHECK_CONTEXT
   return true;
@@ -299,6 +516,10 @@ bool IRContext::IsConsistent() {
     return false;
   }
 
+  if (!CheckDominators()) {
+    return false;
+  }
+
   if (AreAnalysesValid(kAnalysisDecorations)) {
     analysis::DecorationManager* dec_mgr = get_decoration_mgr();
     analysis::DecorationManager current(module());
@@ -342,6 +563,7 @@ void IRContext::AnalyzeUses(Instruction* inst) {
   }
   if (id_to_name_ &&
       (inst->opcode() == SpvOpName || inst->opcode() == SpvOpMemberName)) {
+    LoadNames(inst->GetSingleWordInOperand(0));
     id_to_name_->insert({inst->GetSingleWordInOperand(0), inst});
   }
 }
@@ -634,6 +856,7 @@ void IRContext::InitializeCombinators() {
 void IRContext::RemoveFromIdToName(const Instruction* inst) {
   if (id_to_name_ &&
       (inst->opcode() == SpvOpName || inst->opcode() == SpvOpMemberName)) {
+    LoadNames(inst->GetSingleWordInOperand(0));
     auto range = id_to_name_->equal_range(inst->GetSingleWordInOperand(0));
     for (auto it = range.first; it != range.second; ++it) {
       if (it->second == inst) {
@@ -652,6 +875,7 @@ LoopDescriptor* IRContext::GetLoopDescriptor(const Function* f) {
   std::unordered_map<const Function*, LoopDescriptor>::iterator it =
       loop_descriptors_.find(f);
   if (it == loop_descriptors_.end()) {
+    AnalysisBuild build(this, kAnalysisLoopAnalysis, "loops", f->result_id());
     return &loop_descriptors_
                 .emplace(std::make_pair(f, LoopDescriptor(this, f)))
                 .first->second;
@@ -693,6 +917,24 @@ void IRContext::AddVarToEntryPoints(uint32_t var_id) {
   }
 }
 
+const uint64_t IRContext::kColdBlockRatio;
+
+bool IRContext::GetBlockCount(uint32_t id, uint64_t* count) const {
+  if (block_counts_ == nullptr) return false;
+  auto it = block_counts_->find(id);
+  if (it == block_counts_->end()) return false;
+  *count = it->second;
+  return true;
+}
+
+bool IRContext::IsColdBlock(uint32_t id, uint32_t reference_id) const {
+  uint64_t count = 0;
+  uint64_t reference_count = 0;
+  return GetBlockCount(id, &count) &&
+         GetBlockCount(reference_id, &reference_count) &&
+         IsColdCount(count, reference_count);
+}
+
 uint32_t IRContext::GetBuiltinInputVarId(uint32_t builtin) {
   if (!AreAnalysesValid(kAnalysisBuiltinVarId)) ResetBuiltinAnalysis();
   // If cached, return it.
@@ -770,13 +1012,19 @@ uint32_t IRContext::GetBuiltinInputVarId(uint32_t builtin) {
 }
 
 void IRContext::AddCalls(const Function* func, std::queue<uint32_t>* todo) {
-  for (auto bi = func->begin(); bi != func->end(); ++bi)
-    for (auto ii = bi->begin(); ii != bi->end(); ++ii)
-      if (ii->opcode() == SpvOpFunctionCall)
-        todo->push(ii->GetSingleWordInOperand(0));
+  CallGraph* call_graph = GetCallGraph();
+  // A function added since the graph was built is scanned on first use.
+  if (!call_graph->HasFunction(func->result_id())) {
+    call_graph->UpdateFunction(func);
+  }
+  for (uint32_t callee_id : call_graph->Callees(func->result_id())) {
+    todo->push(callee_id);
+  }
 }
 
 bool IRContext::ProcessEntryPointCallTree(ProcessFunction& pfn) {
+  if (call_trees_) return ProcessFunctions(pfn, call_trees_->entry_point_tree);
+
   // Collect all of the entry points as the roots.
   std::queue<uint32_t> roots;
   for (auto& e : module()->entry_points()) {
@@ -786,6 +1034,8 @@ bool IRContext::ProcessEntryPointCallTree(ProcessFunction& pfn) {
 }
 
 bool IRContext::ProcessReachableCallTree(ProcessFunction& pfn) {
+  if (call_trees_) return ProcessFunctions(pfn, call_trees_->reachable_tree);
+
   std::queue<uint32_t> roots;
 
   // Add all entry points since they can be reached from outside the module.
@@ -827,24 +1077,52 @@ bool IRContext::ProcessCallTreeFromRoots(ProcessFunction& pfn,
     if (done.insert(fi).second) {
       Function* fn = GetFunction(fi);
       assert(fn && "Trying to process a function that does not exist.");
-      modified = pfn(fn) || modified;
+      {
+        utils::ProfileScope scope(profiler_, "function", "function", fi);
+        if (pfn(fn)) {
+          modified = true;
+          // If |pfn| invalidated the call graph, the next one is built from
+          // the changed module.
+          if (AreAnalysesValid(kAnalysisCallGraph)) {
+            call_graph_->UpdateFunction(fn);
+          }
+        }
+      }
       AddCalls(fn, roots);
     }
   }
   return modified;
 }
 
+bool IRContext::ProcessFunctions(ProcessFunction& pfn,
+                                 const std::vector<uint32_t>& ids) {
+  bool modified = false;
+  for (uint32_t id : ids) {
+    Function* fn = GetFunction(id);
+    assert(fn && "Trying to process a function that does not exist.");
+    utils::ProfileScope scope(profiler_, "function", "function", id);
+    if (pfn(fn)) {
+      modified = true;
+      if (AreAnalysesValid(kAnalysisCallGraph)) {
+        call_graph_->UpdateFunction(fn);
+      }
+    }
+  }
+  return modified;
+}
+
 void IRContext::EmitErrorMessage(std::string message, Instruction* inst) {
   if (!consumer()) {
     return;
   }
 
+  const DebugLine* line = nullptr;
   Instruction* line_inst = inst;
   while (line_inst != nullptr) {  // Stop at the beginning of the basic block.
-    if (!line_inst->dbg_line_insts().empty()) {
-      line_inst = &line_inst->dbg_line_insts().back();
-      if (line_inst->opcode() == SpvOpNoLine) {
-        line_inst = nullptr;
+    line = line_inst->last_dbg_line();
+    if (line != nullptr) {
+      if (line->opcode == SpvOpNoLine) {
+        line = nullptr;
       }
       break;
     }
@@ -854,14 +1132,13 @@ void IRContext::EmitErrorMessage(std::string message, Instruction* inst) {
   uint32_t line_number = 0;
   uint32_t col_number = 0;
   char* source = nullptr;
-  if (line_inst != nullptr) {
-    Instruction* file_name =
-        get_def_use_mgr()->GetDef(line_inst->GetSingleWordInOperand(0));
+  if (line != nullptr) {
+    Instruction* file_name = get_def_use_mgr()->GetDef(line->file_id);
     source = reinterpret_cast<char*>(&file_name->GetInOperand(0).words[0]);
 
     // Get the line number and column number.
-    line_number = line_inst->GetSingleWordInOperand(1);
-    col_number = line_inst->GetSingleWordInOperand(2);
+    line_number = line->line;
+    col_number = line->column;
   }
 
   message +=
@@ -876,11 +1153,47 @@ DominatorAnalysis* IRContext::GetDominatorAnalysis(const Function* f) {
     ResetDominatorAnalysis();
   }
 
-  if (dominator_trees_.find(f) == dominator_trees_.end()) {
-    dominator_trees_[f].InitializeTree(*cfg(), f);
+  // Only |find| is used on a built tree, so that frozen contexts may be
+  // queried concurrently.
+  auto it = dominator_trees_.find(f);
+  if (it == dominator_trees_.end()) {
+    const CFG& function_cfg = *cfg();
+    AnalysisBuild build(this, kAnalysisDominatorAnalysis, "dominators",
+                        f->result_id());
+    DominatorAnalysis* tree = &dominator_trees_[f];
+    tree->InitializeTree(function_cfg, f);
+    return tree;
+  }
+
+  return &it->second;
+}
+
+void IRContext::BuildDominatorAnalyses(bool post_dominators) {
+  if (!AreAnalysesValid(kAnalysisDominatorAnalysis)) {
+    ResetDominatorAnalysis();
+  }
+  const CFG& function_cfg = *cfg();
+  AnalysisBuild build(this, kAnalysisDominatorAnalysis);
+
+  // The trees are added to the caches up front, so that the threads only
+  // write to their own tree.
+  std::vector<std::pair<const Function*, DominatorAnalysisBase*>> to_build;
+  for (const Function& function : *module()) {
+    if (dominator_trees_.find(&function) == dominator_trees_.end()) {
+      to_build.emplace_back(&function, &dominator_trees_[&function]);
+    }
+    if (post_dominators &&
+        post_dominator_trees_.find(&function) == post_dominator_trees_.end()) {
+      to_build.emplace_back(&function, &post_dominator_trees_[&function]);
+    }
   }
 
-  return &dominator_trees_[f];
+  build.set_num_builds(to_build.size());
+  utils::ParallelFor(to_build.size(), num_threads_,
+                     [&function_cfg, &to_build](size_t i) {
+                       to_build[i].second->InitializeTree(function_cfg,
+                                                          to_build[i].first);
+                     });
 }
 
 // Gets the postdominator analysis for function |f|.
@@ -889,11 +1202,17 @@ PostDominatorAnalysis* IRContext::GetPostDominatorAnalysis(const Function* f) {
     ResetDominatorAnalysis();
   }
 
-  if (post_dominator_trees_.find(f) == post_dominator_trees_.end()) {
-    post_dominator_trees_[f].InitializeTree(*cfg(), f);
+  auto it = post_dominator_trees_.find(f);
+  if (it == post_dominator_trees_.end()) {
+    const CFG& function_cfg = *cfg();
+    AnalysisBuild build(this, kAnalysisDominatorAnalysis, "post-dominators",
+                        f->result_id());
+    PostDominatorAnalysis* tree = &post_dominator_trees_[f];
+    tree->InitializeTree(function_cfg, f);
+    return tree;
   }
 
-  return &post_dominator_trees_[f];
+  return &it->second;
 }
 
 bool IRContext::CheckCFG() {
@@ -947,5 +1266,65 @@ bool IRContext::CheckCFG() {
 
   return true;
 }
+
+namespace {
+
+// Returns true if every block of |function| has the same immediate dominator
+// in |recorded| as in |real|.  Otherwise reports the first block that differs.
+template <typename DominatorAnalysisType>
+bool SameImmediateDominators(Function* function,
+                             const DominatorAnalysisType& recorded,
+                             const DominatorAnalysisType& real,
+                             const char* kind) {
+  for (auto& bb : *function) {
+    BasicBlock* recorded_dom = recorded.ImmediateDominator(&bb);
+    BasicBlock* real_dom = real.ImmediateDominator(&bb);
+    if (recorded_dom != real_dom) {
+      std::cerr << "Immediate " << kind << " of " << bb.id()
+                << " is different:\n";
+      std::cerr << "Real: " << (real_dom ? real_dom->id() : 0) << std::endl;
+      std::cerr << "Recorded: "
+                << (recorded_dom ? recorded_dom->id() : 0) << std::endl;
+      return false;
+    }
+  }
+  return true;
+}
+
+}  // namespace
+
+bool IRContext::CheckDominators() {
+  if (!AreAnalysesValid(kAnalysisDominatorAnalysis)) {
+    return true;
+  }
+
+  // Build the trees from the current control flow rather than |cfg()|, which
+  // has been checked only if it is valid.
+  CFG real_cfg(module());
+  for (Function& function : *module()) {
+    auto dom_iter = dominator_trees_.find(&function);
+    if (dom_iter != dominator_trees_.end()) {
+      DominatorAnalysis real;
+      real.InitializeTree(real_cfg, &function);
+      if (!SameImmediateDominators(&function, dom_iter->second, real,
+                                   "dominator")) {
+        return false;
+      }
+    }
+
+    auto post_dom_iter = post_dominator_trees_.find(&function);
+    if (post_dom_iter != post_dominator_trees_.end()) {
+      PostDominatorAnalysis real;
+      real.InitializeTree(real_cfg, &function);
+      if (!SameImmediateDominators(&function, post_dom_iter->second, real,
+                                   "post-dominator")) {
+        return false;
+      }
+    }
+  }
+
+  return true;
+}
+
 }  // namespace opt
 }  // namespace spvtools
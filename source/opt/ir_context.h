@@ -16,6 +16,8 @@
 #define SOURCE_OPT_IR_CONTEXT_H_
 
 #include <algorithm>
+#include <chrono>
+#include <functional>
 #include <iostream>
 #include <limits>
 #include <map>
@@ -27,8 +29,10 @@
 #include <vector>
 
 #include "source/assembly_grammar.h"
+#include "source/opt/call_graph.h"
 #include "source/opt/cfg.h"
 #include "source/opt/constants.h"
+#include "source/opt/debug_line_table.h"
 #include "source/opt/decoration_manager.h"
 #include "source/opt/def_use_manager.h"
 #include "source/opt/dominator_analysis.h"
@@ -36,12 +40,16 @@
 #include "source/opt/fold.h"
 #include "source/opt/loop_descriptor.h"
 #include "source/opt/module.h"
+#include "source/opt/module_summary.h"
 #include "source/opt/register_pressure.h"
 #include "source/opt/scalar_analysis.h"
 #include "source/opt/struct_cfg_analysis.h"
 #include "source/opt/type_manager.h"
+#include "source/opt/uniformity_analysis.h"
 #include "source/opt/value_number_table.h"
 #include "source/util/make_unique.h"
+#include "source/util/node_pool.h"
+#include "source/util/profiler.h"
 
 namespace spvtools {
 namespace opt {
@@ -78,7 +86,31 @@ class IRContext {
     kAnalysisIdToFuncMapping = 1 << 13,
     kAnalysisConstants = 1 << 14,
     kAnalysisTypes = 1 << 15,
-    kAnalysisEnd = 1 << 16
+    kAnalysisUniformity = 1 << 16,
+    kAnalysisModuleSummary = 1 << 17,
+    kAnalysisCallGraph = 1 << 18,
+    kAnalysisEnd = 1 << 19
+  };
+
+  // The work done to build one analysis.
+  struct AnalysisStatistics {
+    AnalysisStatistics() : builds(0), nanoseconds(0) {}
+
+    // The number of times the analysis was built.  The dominator and loop
+    // analyses count each tree they build for a function.
+    uint64_t builds;
+    // The time spent building the analysis, including any analysis it
+    // needed to build first.
+    uint64_t nanoseconds;
+  };
+
+  // The functions of the call trees of a module that only declares some of
+  // the functions in them.
+  struct CallTrees {
+    // The functions |ProcessEntryPointCallTree| processes.
+    std::vector<uint32_t> entry_point_tree;
+    // The functions |ProcessReachableCallTree| processes.
+    std::vector<uint32_t> reachable_tree;
   };
 
   using ProcessFunction = std::function<bool(Function*)>;
@@ -93,16 +125,24 @@ class IRContext {
       : syntax_context_(spvContextCreate(env)),
         grammar_(syntax_context_),
         unique_id_(0),
+        instruction_pool_(new utils::NodePool(sizeof(Instruction))),
+        block_pool_(new utils::NodePool(sizeof(BasicBlock))),
         module_(new Module()),
         consumer_(std::move(c)),
         def_use_mgr_(nullptr),
-        valid_analyses_(kAnalysisNone),
+        valid_analyses_(kAnalysisInstrToBlockMapping),
+        track_changed_insts_(false),
         constant_mgr_(nullptr),
         type_mgr_(nullptr),
         id_to_name_(nullptr),
         max_id_bound_(kDefaultMaxIdBound),
         preserve_bindings_(false),
-        preserve_spec_constants_(false) {
+        preserve_spec_constants_(false),
+        num_threads_(1),
+        profiler_(nullptr),
+        block_counts_(nullptr),
+        call_trees_(nullptr),
+        frozen_(false) {
     SetContextMessageConsumer(syntax_context_, consumer_);
     module_->SetContext(this);
   }
@@ -111,24 +151,47 @@ class IRContext {
       : syntax_context_(spvContextCreate(env)),
         grammar_(syntax_context_),
         unique_id_(0),
+        instruction_pool_(new utils::NodePool(sizeof(Instruction))),
+        block_pool_(new utils::NodePool(sizeof(BasicBlock))),
         module_(std::move(m)),
         consumer_(std::move(c)),
         def_use_mgr_(nullptr),
-        valid_analyses_(kAnalysisNone),
+        valid_analyses_(kAnalysisInstrToBlockMapping),
+        track_changed_insts_(false),
         type_mgr_(nullptr),
         id_to_name_(nullptr),
         max_id_bound_(kDefaultMaxIdBound),
         preserve_bindings_(false),
-        preserve_spec_constants_(false) {
+        preserve_spec_constants_(false),
+        num_threads_(1),
+        profiler_(nullptr),
+        block_counts_(nullptr),
+        call_trees_(nullptr),
+        frozen_(false) {
     SetContextMessageConsumer(syntax_context_, consumer_);
     module_->SetContext(this);
     InitializeCombinators();
   }
 
-  ~IRContext() { spvContextDestroy(syntax_context_); }
+  ~IRContext() {
+    spvContextDestroy(syntax_context_);
+    // The pools are freed with their last node, once |module_| is destroyed.
+    instruction_pool_->Release();
+    block_pool_->Release();
+  }
 
   Module* module() const { return module_.get(); }
 
+  // Returns the pools holding the instructions and basic blocks allocated in
+  // this context.
+  utils::NodePool* instruction_pool() const { return instruction_pool_; }
+  utils::NodePool* block_pool() const { return block_pool_; }
+
+  // Returns the table of the debug line instructions attached to the
+  // instructions of this context.
+  DebugLineTable* debug_line_table() { return &debug_line_table_; }
+  const DebugLineTable* debug_line_table() const { return &debug_line_table_; }
+
   // Returns a vector of pointers to constant-creation instructions in this
   // context.
   inline std::vector<Instruction*> GetConstants();
@@ -261,6 +324,33 @@ class IRContext {
     return struct_cfg_analysis_.get();
   }
 
+  // Returns a pointer to a UniformityAnalysis.  If the analysis is invalid, it
+  // is rebuilt first.
+  UniformityAnalysis* GetUniformityAnalysis() {
+    if (!AreAnalysesValid(kAnalysisUniformity)) {
+      BuildUniformityAnalysis();
+    }
+    return uniformity_analysis_.get();
+  }
+
+  // Returns the summary of the module.  If the summary is invalid, it is
+  // rebuilt first.
+  const ModuleSummary* GetModuleSummary() {
+    if (!AreAnalysesValid(kAnalysisModuleSummary)) {
+      BuildModuleSummary();
+    }
+    return module_summary_.get();
+  }
+
+  // Returns the call graph of the module.  If the call graph is invalid, it is
+  // rebuilt first.
+  CallGraph* GetCallGraph() {
+    if (!AreAnalysesValid(kAnalysisCallGraph)) {
+      BuildCallGraph();
+    }
+    return call_graph_.get();
+  }
+
   // Returns a pointer to a liveness analysis.  If the liveness analysis is
   // invalid, it is rebuilt first.
   LivenessAnalysis* GetLivenessAnalysis() {
@@ -270,18 +360,11 @@ class IRContext {
     return reg_pressure_.get();
   }
 
-  // Returns the basic block for instruction |instr|. Re-builds the instruction
-  // block map, if needed.
-  BasicBlock* get_instr_block(Instruction* instr) {
-    if (!AreAnalysesValid(kAnalysisInstrToBlockMapping)) {
-      BuildInstrToBlockMapping();
-    }
-    auto entry = instr_to_block_.find(instr);
-    return (entry != instr_to_block_.end()) ? entry->second : nullptr;
-  }
+  // Returns the basic block for instruction |instr|.  The block is recorded in
+  // the instruction itself, so the instruction-block mapping is always valid.
+  BasicBlock* get_instr_block(Instruction* instr) { return instr->block(); }
 
-  // Returns the basic block for |id|. Re-builds the instruction block map, if
-  // needed.
+  // Returns the basic block for |id|.
   //
   // |id| must be a registered definition.
   BasicBlock* get_instr_block(uint32_t id) {
@@ -289,12 +372,11 @@ class IRContext {
     return get_instr_block(def);
   }
 
-  // Sets the basic block for |inst|. Re-builds the mapping if it has become
-  // invalid.
+  // Sets the basic block for |inst|.  Inserting or moving |inst| in a block
+  // already does this, so this is only needed for an instruction that is
+  // about to be placed in |block|.
   void set_instr_block(Instruction* inst, BasicBlock* block) {
-    if (AreAnalysesValid(kAnalysisInstrToBlockMapping)) {
-      instr_to_block_[inst] = block;
-    }
+    inst->set_block(block);
   }
 
   // Returns a pointer the decoration manager.  If the decoration manger is
@@ -336,7 +418,9 @@ class IRContext {
   }
 
   // Build the map from the ids to the OpName and OpMemberName instruction
-  // associated with it.
+  // associated with it.  Only an index of the names sorted by id is built up
+  // front.  The names of each id are added to the map from the index when the
+  // id is first queried or changed.
   inline void BuildIdToNameMap();
 
   // Returns a range of instrucions that contain all of the OpName and
@@ -346,20 +430,71 @@ class IRContext {
 
   // Sets the message consumer to the given |consumer|. |consumer| which will be
   // invoked every time there is a message to be communicated to the outside.
-  void SetMessageConsumer(MessageConsumer c) { consumer_ = std::move(c); }
+  void SetMessageConsumer(MessageConsumer c) {
+    consumer_ = std::move(c);
+    SetContextMessageConsumer(syntax_context_, consumer_);
+  }
 
   // Returns the reference to the message consumer for this pass.
   const MessageConsumer& consumer() const { return consumer_; }
 
+  // Returns the context of the target environment, with its grammar tables,
+  // which reports to the message consumer given at construction.
+  spv_context syntax_context() const { return syntax_context_; }
+
   // Rebuilds the analyses in |set| that are invalid.
   void BuildInvalidAnalyses(Analysis set);
 
+  // Builds the analyses in |set| that are invalid, and the feature manager,
+  // then freezes the context.  The dominator and post-dominator trees and
+  // the loop descriptors are built for every function, every name and
+  // decoration is loaded, and the def-use manager allows concurrent reads.
+  // Until |Unfreeze| is called, no analysis may be built or invalidated, and
+  // the module must not change.  The analyses of |set| may then be queried
+  // from several threads concurrently, as long as the queries do not cache
+  // results themselves, as those of the scalar evolution analysis, the value
+  // number table and the register pressure analysis do.
+  void Freeze(Analysis set);
+
+  // Ends the freeze started by |Freeze|.  Must not be called while other
+  // threads still query the analyses.
+  void Unfreeze();
+
+  // Returns true if the context is frozen.
+  bool IsFrozen() const { return frozen_; }
+
+  // Returns the statistics of the builds of |analysis|, a single analysis,
+  // since the context was created.
+  const AnalysisStatistics& GetAnalysisStatistics(Analysis analysis) const {
+    return analysis_statistics_[GetAnalysisIndex(analysis)];
+  }
+
+  // Returns the name of |analysis|, a single analysis, such as "def-use".
+  static const char* GetAnalysisName(Analysis analysis);
+
   // Invalidates all of the analyses except for those in |preserved_analyses|.
   void InvalidateAnalysesExceptFor(Analysis preserved_analyses);
 
   // Invalidates the analyses marked in |analyses_to_invalidate|.
   void InvalidateAnalyses(Analysis analyses_to_invalidate);
 
+  // Invalidates the analyses marked in |analyses_to_invalidate| after a change
+  // to |function| only.  The CFG is updated for |function|, and the dominator
+  // and loop analyses are removed for |function|, without affecting the other
+  // functions.  The other analyses are invalidated for the whole module.
+  void InvalidateAnalysesForFunction(Function* function,
+                                     Analysis analyses_to_invalidate);
+
+  // Updates the CFG and the dominator and post-dominator trees that are built
+  // after the block |succ_id| was merged into |block|, its only predecessor,
+  // which only branched to it.
+  void UpdateAnalysesForMerge(BasicBlock* block, uint32_t succ_id);
+
+  // Updates the CFG and the dominator and post-dominator trees that are built
+  // after the instructions at the end of |block| were moved to the new block
+  // |new_block|, and |block| was made to branch to |new_block|.
+  void UpdateAnalysesForSplit(BasicBlock* block, BasicBlock* new_block);
+
   // Deletes the instruction defining the given |id|. Returns true on
   // success, false if the given |id| is not defined at all. This method also
   // erases the name, decorations, and defintion of |id|.
@@ -383,6 +518,10 @@ class IRContext {
   // instruction exists.
   Instruction* KillInst(Instruction* inst);
 
+  // Deletes the instructions in |insts|, as KillInst does.  The instructions
+  // may use one another.
+  void KillInsts(const std::vector<Instruction*>& insts);
+
   // Returns true if all of the given analyses are valid.
   bool AreAnalysesValid(Analysis set) { return (set & valid_analyses_) == set; }
 
@@ -403,6 +542,23 @@ class IRContext {
       uint32_t before, uint32_t after,
       const std::function<bool(Instruction*, uint32_t)>& predicate);
 
+  // Replaces all uses of each id in |replacements| with the id it maps to, as
+  // calling ReplaceAllUsesWith for each of them would.  The module is swept
+  // once, and each instruction that changes is re-analyzed once, however many
+  // of its operands are replaced, so this is the way to replace many ids at a
+  // time.  Returns true if any replacement happens.  The ids mapped to must
+  // not be replaced themselves.  The definitions are not killed, see
+  // KillInsts.
+  bool ReplaceAllUsesWith(
+      const std::unordered_map<uint32_t, uint32_t>& replacements);
+
+  // Replaces the uses in |inst| of the ids in |replacements| with the ids they
+  // map to, and updates the valid analyses.  Returns true if any replacement
+  // happens.
+  bool ReplaceUsesIn(
+      Instruction* inst,
+      const std::unordered_map<uint32_t, uint32_t>& replacements);
+
   // Returns true if all of the analyses that are suppose to be valid are
   // actually valid.
   bool IsConsistent();
@@ -420,6 +576,30 @@ class IRContext {
   // will be updated accordingly.
   void AnalyzeUses(Instruction* inst);
 
+  // Starts tracking the instructions whose uses are analyzed by the def-use
+  // manager, which are the instructions that were added or changed, and
+  // forgets the ones tracked before.  The tracking stops when the def-use
+  // manager is invalidated.
+  void StartTrackingChangedInstructions() {
+    changed_insts_.clear();
+    get_def_use_mgr()->RecordChangedInstructions(&changed_insts_);
+    track_changed_insts_ = true;
+  }
+
+  // Returns true if the instructions that changed since the last call to
+  // |StartTrackingChangedInstructions| are known.
+  bool AreChangedInstructionsTracked() {
+    return track_changed_insts_ && AreAnalysesValid(kAnalysisDefUse);
+  }
+
+  // Returns the instructions that changed since the last call to
+  // |StartTrackingChangedInstructions|, and were not killed since.  The caller
+  // may remove the ones it has dealt with.  Only meaningful if
+  // |AreChangedInstructionsTracked| returns true.
+  std::unordered_set<Instruction*>* changed_instructions() {
+    return &changed_insts_;
+  }
+
   // Kill all name and decorate ops targeting |id|.
   void KillNamesAndDecorates(uint32_t id);
 
@@ -469,6 +649,13 @@ class IRContext {
   // Gets the postdominator analysis for function |f|.
   PostDominatorAnalysis* GetPostDominatorAnalysis(const Function* f);
 
+  // Builds the dominator trees of all the functions in the module that do not
+  // have one yet, and their post-dominator trees too if |post_dominators| is
+  // true.  The trees of different functions are built concurrently on up to
+  // |num_threads()| threads.  This is meant for passes that query the trees of
+  // every function, before they start changing the module.
+  void BuildDominatorAnalyses(bool post_dominators);
+
   // Remove the dominator tree of |f| from the cache.
   inline void RemoveDominatorAnalysis(const Function* f) {
     dominator_trees_.erase(f);
@@ -528,6 +715,52 @@ class IRContext {
     preserve_spec_constants_ = should_preserve_spec_constants;
   }
 
+  // The number of threads that may be used to build the analyses of different
+  // functions concurrently.  0 means one thread per hardware thread.
+  uint32_t num_threads() const { return num_threads_; }
+  void set_num_threads(uint32_t num_threads) { num_threads_ = num_threads; }
+
+  // The profiler that records the analyses built and the functions processed,
+  // or null if none.
+  utils::Profiler* profiler() const { return profiler_; }
+  void set_profiler(utils::Profiler* profiler) { profiler_ = profiler; }
+
+  // The execution counts of the blocks of |module_|, by label id, measured by
+  // a profiler, or null if there is no profile.  The blocks created by the
+  // passes have no count.
+  const std::unordered_map<uint32_t, uint64_t>* block_counts() const {
+    return block_counts_;
+  }
+  void set_block_counts(const std::unordered_map<uint32_t, uint64_t>* counts) {
+    block_counts_ = counts;
+  }
+
+  // The functions the call tree walks process, or null if the call trees are
+  // walked from the entry points and exported functions.  They are set when
+  // the module only declares some of the functions in the call trees, so
+  // that the walks cannot find the others.
+  const CallTrees* call_trees() const { return call_trees_; }
+  void set_call_trees(const CallTrees* call_trees) { call_trees_ = call_trees; }
+
+  // Returns true and sets |count| to the execution count of the block |id| if
+  // the profile has one.  Returns false otherwise.
+  bool GetBlockCount(uint32_t id, uint64_t* count) const;
+
+  // Returns true if the profile shows that the block |id| executes less than
+  // once per |kColdBlockRatio| executions of the block |reference_id|.
+  // Returns false if either has no count.
+  bool IsColdBlock(uint32_t id, uint32_t reference_id) const;
+
+  // Returns true if |count| is less than |reference_count| divided by
+  // |kColdBlockRatio|.
+  static bool IsColdCount(uint64_t count, uint64_t reference_count) {
+    return count < reference_count / kColdBlockRatio;
+  }
+
+  // How many times less often than a reference block a block must execute to
+  // be considered cold.
+  static const uint64_t kColdBlockRatio = 16;
+
   // Return id of input variable only decorated with |builtin|, if in module.
   // Create variable and return its id otherwise. If builtin not currently
   // supported, return 0.
@@ -550,7 +783,8 @@ class IRContext {
     return GetFunction(inst->result_id());
   }
 
-  // Add to |todo| all ids of functions called directly from |func|.
+  // Add to |todo| all ids of functions called directly from |func|, each once.
+  // The calls are taken from the call graph.
   void AddCalls(const Function* func, std::queue<uint32_t>* todo);
 
   // Applies |pfn| to every function in the call trees that are rooted at the
@@ -565,8 +799,9 @@ class IRContext {
 
   // Applies |pfn| to every function in the call trees rooted at the elements of
   // |roots|.  Returns true if any call to |pfn| returns true.  By convention
-  // |pfn| should return true if it modified the module.  After returning
-  // |roots| will be empty.
+  // |pfn| should return true if it modified the module, and the calls of the
+  // functions for which it does are updated in the call graph.  After
+  // returning |roots| will be empty.
   bool ProcessCallTreeFromRoots(ProcessFunction& pfn,
                                 std::queue<uint32_t>* roots);
 
@@ -575,27 +810,87 @@ class IRContext {
   void EmitErrorMessage(std::string message, Instruction* inst);
 
  private:
+  // Applies |pfn| to each function in |ids|, in the same way as
+  // |ProcessCallTreeFromRoots| but without following the calls.
+  bool ProcessFunctions(ProcessFunction& pfn, const std::vector<uint32_t>& ids);
+
+  // The number of analyses in |Analysis|.
+  static const size_t kNumAnalyses = 19;
+  static_assert(kAnalysisEnd == 1 << kNumAnalyses,
+                "kNumAnalyses must match the analyses.");
+
+  // Returns the index of |analysis|, a single analysis, among the analyses.
+  static size_t GetAnalysisIndex(Analysis analysis) {
+    assert(analysis != kAnalysisNone && (analysis & (analysis - 1)) == 0 &&
+           "Expected a single analysis.");
+    size_t index = 0;
+    while ((analysis >> index) != 1) ++index;
+    return index;
+  }
+
+  // Records a build of an analysis, for the lifetime of the object, in the
+  // statistics and the profiler of a context.
+  class AnalysisBuild {
+   public:
+    AnalysisBuild(IRContext* context, Analysis analysis)
+        : statistics_(
+              &context->analysis_statistics_[GetAnalysisIndex(analysis)]),
+          num_builds_(1),
+          scope_(context->profiler_, "analysis", GetAnalysisName(analysis)),
+          start_(std::chrono::steady_clock::now()) {
+      assert(!context->frozen_ && "No analysis is built while frozen.");
+    }
+
+    // Records the build of |name| for the function |function_id|.
+    AnalysisBuild(IRContext* context, Analysis analysis, const char* name,
+                  uint32_t function_id)
+        : statistics_(
+              &context->analysis_statistics_[GetAnalysisIndex(analysis)]),
+          num_builds_(1),
+          scope_(context->profiler_, "analysis", name, function_id),
+          start_(std::chrono::steady_clock::now()) {
+      assert(!context->frozen_ && "No analysis is built while frozen.");
+    }
+
+    AnalysisBuild(const AnalysisBuild&) = delete;
+    AnalysisBuild& operator=(const AnalysisBuild&) = delete;
+
+    ~AnalysisBuild() {
+      statistics_->builds += num_builds_;
+      statistics_->nanoseconds += static_cast<uint64_t>(
+          std::chrono::duration_cast<std::chrono::nanoseconds>(
+              std::chrono::steady_clock::now() - start_)
+              .count());
+    }
+
+    // Counts the work as |num_builds| builds, as when it builds the trees of
+    // several functions.
+    void set_num_builds(uint64_t num_builds) { num_builds_ = num_builds; }
+
+   private:
+    AnalysisStatistics* statistics_;
+    uint64_t num_builds_;
+    utils::ProfileScope scope_;
+    const std::chrono::steady_clock::time_point start_;
+  };
+
   // Builds the def-use manager from scratch, even if it was already valid.
   void BuildDefUseManager() {
+    AnalysisBuild build(this, kAnalysisDefUse);
     def_use_mgr_ = MakeUnique<analysis::DefUseManager>(module());
     valid_analyses_ = valid_analyses_ | kAnalysisDefUse;
+    track_changed_insts_ = false;
   }
 
-  // Builds the instruction-block map for the whole module.
+  // Marks the instruction-block map valid.  There is nothing to build: each
+  // instruction records its block, and the blocks keep them up to date.
   void BuildInstrToBlockMapping() {
-    instr_to_block_.clear();
-    for (auto& fn : *module_) {
-      for (auto& block : fn) {
-        block.ForEachInst([this, &block](Instruction* inst) {
-          instr_to_block_[inst] = &block;
-        });
-      }
-    }
     valid_analyses_ = valid_analyses_ | kAnalysisInstrToBlockMapping;
   }
 
   // Builds the instruction-function map for the whole module.
   void BuildIdToFuncMapping() {
+    AnalysisBuild build(this, kAnalysisIdToFuncMapping);
     id_to_func_.clear();
     for (auto& fn : *module_) {
       id_to_func_[fn.result_id()] = &fn;
@@ -604,22 +899,26 @@ class IRContext {
   }
 
   void BuildDecorationManager() {
+    AnalysisBuild build(this, kAnalysisDecorations);
     decoration_mgr_ = MakeUnique<analysis::DecorationManager>(module());
     valid_analyses_ = valid_analyses_ | kAnalysisDecorations;
   }
 
   void BuildCFG() {
+    AnalysisBuild build(this, kAnalysisCFG);
     cfg_ = MakeUnique<CFG>(module());
     valid_analyses_ = valid_analyses_ | kAnalysisCFG;
   }
 
   void BuildScalarEvolutionAnalysis() {
+    AnalysisBuild build(this, kAnalysisScalarEvolution);
     scalar_evolution_analysis_ = MakeUnique<ScalarEvolutionAnalysis>(this);
     valid_analyses_ = valid_analyses_ | kAnalysisScalarEvolution;
   }
 
   // Builds the liveness analysis from scratch, even if it was already valid.
   void BuildRegPressureAnalysis() {
+    AnalysisBuild build(this, kAnalysisRegisterPressure);
     reg_pressure_ = MakeUnique<LivenessAnalysis>(this);
     valid_analyses_ = valid_analyses_ | kAnalysisRegisterPressure;
   }
@@ -627,6 +926,7 @@ class IRContext {
   // Builds the value number table analysis from scratch, even if it was already
   // valid.
   void BuildValueNumberTable() {
+    AnalysisBuild build(this, kAnalysisValueNumberTable);
     vn_table_ = MakeUnique<ValueNumberTable>(this);
     valid_analyses_ = valid_analyses_ | kAnalysisValueNumberTable;
   }
@@ -634,13 +934,37 @@ class IRContext {
   // Builds the structured CFG analysis from scratch, even if it was already
   // valid.
   void BuildStructuredCFGAnalysis() {
+    AnalysisBuild build(this, kAnalysisStructuredCFG);
     struct_cfg_analysis_ = MakeUnique<StructuredCFGAnalysis>(this);
     valid_analyses_ = valid_analyses_ | kAnalysisStructuredCFG;
   }
 
+  // Builds the uniformity analysis from scratch, even if it was already
+  // valid.
+  void BuildUniformityAnalysis() {
+    AnalysisBuild build(this, kAnalysisUniformity);
+    uniformity_analysis_ = MakeUnique<UniformityAnalysis>(this);
+    valid_analyses_ = valid_analyses_ | kAnalysisUniformity;
+  }
+
+  // Builds the module summary from scratch, even if it was already valid.
+  void BuildModuleSummary() {
+    AnalysisBuild build(this, kAnalysisModuleSummary);
+    module_summary_ = MakeUnique<ModuleSummary>(module());
+    valid_analyses_ = valid_analyses_ | kAnalysisModuleSummary;
+  }
+
+  // Builds the call graph from scratch, even if it was already valid.
+  void BuildCallGraph() {
+    AnalysisBuild build(this, kAnalysisCallGraph);
+    call_graph_ = MakeUnique<CallGraph>(module());
+    valid_analyses_ = valid_analyses_ | kAnalysisCallGraph;
+  }
+
   // Builds the constant manager from scratch, even if it was already
   // valid.
   void BuildConstantManager() {
+    AnalysisBuild build(this, kAnalysisConstants);
     constant_mgr_ = MakeUnique<analysis::ConstantManager>(this);
     valid_analyses_ = valid_analyses_ | kAnalysisConstants;
   }
@@ -648,6 +972,7 @@ class IRContext {
   // Builds the type manager from scratch, even if it was already
   // valid.
   void BuildTypeManager() {
+    AnalysisBuild build(this, kAnalysisTypes);
     type_mgr_ = MakeUnique<analysis::TypeManager>(consumer(), this);
     valid_analyses_ = valid_analyses_ | kAnalysisTypes;
   }
@@ -694,10 +1019,19 @@ class IRContext {
   // Remove |inst| from |id_to_name_| if it is in map.
   void RemoveFromIdToName(const Instruction* inst);
 
+  // Adds the names of |id| in |name_index_| to |id_to_name_|, if it was not
+  // done yet.  Must be called before the names of |id| are read or changed.
+  inline void LoadNames(uint32_t id);
+
   // Returns true if it is suppose to be valid but it is incorrect.  Returns
   // true if the cfg is invalidated.
   bool CheckCFG();
 
+  // Returns false if the dominator or post-dominator trees are supposed to be
+  // valid but differ from the ones rebuilt from the module.  Returns true if
+  // the dominator analysis is invalidated.
+  bool CheckDominators();
+
   // Return id of input variable only decorated with |builtin|, if in module.
   // Return 0 otherwise.
   uint32_t FindBuiltinInputVar(uint32_t builtin);
@@ -719,6 +1053,16 @@ class IRContext {
   // Therefore, 0 is not a valid unique id for an instruction.
   uint32_t unique_id_;
 
+  // The pools of the instructions and basic blocks allocated with
+  // |new (context)|.  Destroying a large module gives the memory back a slab
+  // at a time instead of one node at a time.  Each pool is shared with its
+  // nodes, so it is released rather than owned.
+  utils::NodePool* instruction_pool_;
+  utils::NodePool* block_pool_;
+
+  // The OpLine and OpNoLine instructions attached to the instructions.
+  DebugLineTable debug_line_table_;
+
   // The module being processed within this IR context.
   std::unique_ptr<Module> module_;
 
@@ -732,13 +1076,6 @@ class IRContext {
   std::unique_ptr<analysis::DecorationManager> decoration_mgr_;
   std::unique_ptr<FeatureManager> feature_mgr_;
 
-  // A map from instructions to the basic block they belong to. This mapping is
-  // built on-demand when get_instr_block() is called.
-  //
-  // NOTE: Do not traverse this map. Ever. Use the function and basic block
-  // iterators to traverse instructions.
-  std::unordered_map<Instruction*, BasicBlock*> instr_to_block_;
-
   // A map from ids to the function they define. This mapping is
   // built on-demand when GetFunction() is called.
   //
@@ -749,6 +1086,11 @@ class IRContext {
   // A bitset indicating which analyes are currently valid.
   Analysis valid_analyses_;
 
+  // The instructions that changed since the tracking started, and whether they
+  // are being tracked.  See |StartTrackingChangedInstructions|.
+  std::unordered_set<Instruction*> changed_insts_;
+  bool track_changed_insts_;
+
   // Opcodes of shader capability core executable instructions
   // without side-effect.
   std::unordered_map<uint32_t, std::unordered_set<uint32_t>> combinator_ops_;
@@ -777,6 +1119,11 @@ class IRContext {
   // A map from an id to its corresponding OpName and OpMemberName instructions.
   std::unique_ptr<std::multimap<uint32_t, Instruction*>> id_to_name_;
 
+  // The OpName and OpMemberName instructions by id, in module order for each
+  // id, which are not in |id_to_name_| yet.  The instruction of an entry is
+  // null once it was added to |id_to_name_|.
+  std::vector<std::pair<uint32_t, Instruction*>> name_index_;
+
   // The cache scalar evolution analysis node.
   std::unique_ptr<ScalarEvolutionAnalysis> scalar_evolution_analysis_;
 
@@ -789,6 +1136,14 @@ class IRContext {
 
   std::unique_ptr<StructuredCFGAnalysis> struct_cfg_analysis_;
 
+  std::unique_ptr<UniformityAnalysis> uniformity_analysis_;
+
+  // The summary of the module.
+  std::unique_ptr<ModuleSummary> module_summary_;
+
+  // The call graph of the module.
+  std::unique_ptr<CallGraph> call_graph_;
+
   // The maximum legal value for the id bound.
   uint32_t max_id_bound_;
 
@@ -798,6 +1153,24 @@ class IRContext {
   // Whether all specialization constants within |module_|
   // should be preserved.
   bool preserve_spec_constants_;
+
+  // The number of threads used by |BuildDominatorAnalyses|.
+  uint32_t num_threads_;
+
+  // The profiler of the analyses and functions, or null.
+  utils::Profiler* profiler_;
+
+  // The execution counts of the blocks, or null.
+  const std::unordered_map<uint32_t, uint64_t>* block_counts_;
+
+  // The functions the call tree walks process, or null.
+  const CallTrees* call_trees_;
+
+  // Whether the analyses are frozen.  See |Freeze|.
+  bool frozen_;
+
+  // The statistics of the builds of each analysis, by index.
+  AnalysisStatistics analysis_statistics_[kNumAnalyses];
 };
 
 inline IRContext::Analysis operator|(IRContext::Analysis lhs,
@@ -1035,7 +1408,9 @@ void IRContext::AddDebug1Inst(std::unique_ptr<Instruction>&& d) {
 void IRContext::AddDebug2Inst(std::unique_ptr<Instruction>&& d) {
   if (AreAnalysesValid(kAnalysisNameMap)) {
     if (d->opcode() == SpvOpName || d->opcode() == SpvOpMemberName) {
-      id_to_name_->insert({d->result_id(), d.get()});
+      const uint32_t target_id = d->GetSingleWordInOperand(0);
+      LoadNames(target_id);
+      id_to_name_->insert({target_id, d.get()});
     }
   }
   module()->AddDebug2Inst(std::move(d));
@@ -1090,13 +1465,21 @@ void IRContext::UpdateDefUse(Instruction* inst) {
 }
 
 void IRContext::BuildIdToNameMap() {
+  AnalysisBuild build(this, kAnalysisNameMap);
   id_to_name_ = MakeUnique<std::multimap<uint32_t, Instruction*>>();
+  name_index_.clear();
   for (Instruction& debug_inst : debugs2()) {
     if (debug_inst.opcode() == SpvOpMemberName ||
         debug_inst.opcode() == SpvOpName) {
-      id_to_name_->insert({debug_inst.GetSingleWordInOperand(0), &debug_inst});
+      name_index_.emplace_back(debug_inst.GetSingleWordInOperand(0),
+                               &debug_inst);
     }
   }
+  std::stable_sort(name_index_.begin(), name_index_.end(),
+                   [](const std::pair<uint32_t, Instruction*>& lhs,
+                      const std::pair<uint32_t, Instruction*>& rhs) {
+                     return lhs.first < rhs.first;
+                   });
   valid_analyses_ = valid_analyses_ | kAnalysisNameMap;
 }
 
@@ -1105,10 +1488,25 @@ IRContext::GetNames(uint32_t id) {
   if (!AreAnalysesValid(kAnalysisNameMap)) {
     BuildIdToNameMap();
   }
+  LoadNames(id);
   auto result = id_to_name_->equal_range(id);
   return make_range(std::move(result.first), std::move(result.second));
 }
 
+void IRContext::LoadNames(uint32_t id) {
+  if (name_index_.empty()) return;
+  auto entry = std::lower_bound(
+      name_index_.begin(), name_index_.end(), id,
+      [](const std::pair<uint32_t, Instruction*>& e, uint32_t value) {
+        return e.first < value;
+      });
+  for (; entry != name_index_.end() && entry->first == id; ++entry) {
+    if (entry->second == nullptr) continue;
+    id_to_name_->insert({id, entry->second});
+    entry->second = nullptr;
+  }
+}
+
 }  // namespace opt
 }  // namespace spvtools
 
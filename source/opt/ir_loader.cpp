@@ -19,6 +19,7 @@
 #include "DebugInfo.h"
 #include "OpenCLDebugInfo100.h"
 #include "source/ext_inst.h"
+#include "source/opt/ir_context.h"
 #include "source/opt/log.h"
 #include "source/opt/reflect.h"
 #include "source/util/make_unique.h"
@@ -32,16 +33,30 @@ IrLoader::IrLoader(const MessageConsumer& consumer, Module* m)
       source_("<instruction>"),
       inst_index_(0) {}
 
+void IrLoader::Reserve(size_t num_instructions, size_t num_blocks) {
+  IRContext* context = module()->context();
+  if (context == nullptr) return;
+  context->instruction_pool()->Reserve(num_instructions);
+  context->block_pool()->Reserve(num_blocks);
+}
+
 bool IrLoader::AddInstruction(const spv_parsed_instruction_t* inst) {
   ++inst_index_;
   const auto opcode = static_cast<SpvOp>(inst->opcode);
   if (IsDebugLineInst(opcode)) {
-    dbg_line_info_.push_back(Instruction(module()->context(), *inst));
+    if (opcode == SpvOpLine) {
+      dbg_line_info_.push_back(
+          {SpvOpLine, inst->words[1], inst->words[2], inst->words[3]});
+    } else {
+      dbg_line_info_.push_back(DebugLine::NoLine());
+    }
     return true;
   }
 
+  IRContext* context = module()->context();
   std::unique_ptr<Instruction> spv_inst(
-      new Instruction(module()->context(), *inst, std::move(dbg_line_info_)));
+      new (context) Instruction(
+          context, *inst, context->debug_line_table()->Intern(dbg_line_info_)));
   dbg_line_info_.clear();
 
   const char* src = source_.c_str();
@@ -77,7 +92,7 @@ bool IrLoader::AddInstruction(const spv_parsed_instruction_t* inst) {
       Error(consumer_, src, loc, "OpLabel inside basic block");
       return false;
     }
-    block_ = MakeUnique<BasicBlock>(std::move(spv_inst));
+    block_.reset(new (module()->context()) BasicBlock(std::move(spv_inst)));
   } else if (IsTerminatorInst(opcode)) {
     if (function_ == nullptr) {
       Error(consumer_, src, loc, "terminator instruction outside function");
@@ -203,7 +218,21 @@ void IrLoader::EndModule() {
   }
 
   // Copy any trailing Op*Line instruction into the module
-  module_->SetTrailingDbgLineInfo(std::move(dbg_line_info_));
+  std::vector<Instruction> trailing_lines;
+  for (const DebugLine& line : dbg_line_info_) {
+    if (line.opcode == SpvOpLine) {
+      trailing_lines.emplace_back(
+          module()->context(), SpvOpLine, 0, 0,
+          Instruction::OperandList{
+              {SPV_OPERAND_TYPE_ID, {line.file_id}},
+              {SPV_OPERAND_TYPE_LITERAL_INTEGER, {line.line}},
+              {SPV_OPERAND_TYPE_LITERAL_INTEGER, {line.column}}});
+    } else {
+      trailing_lines.emplace_back(module()->context(), SpvOpNoLine);
+    }
+  }
+  dbg_line_info_.clear();
+  module_->SetTrailingDbgLineInfo(std::move(trailing_lines));
 }
 
 }  // namespace opt
@@ -53,6 +53,10 @@ class IrLoader {
                        uint32_t bound, uint32_t reserved) {
     module_->SetHeader({magic, version, generator, bound, reserved});
   }
+  // Makes room for |num_instructions| instructions and |num_blocks| basic
+  // blocks in the pools of the context of the module, so that they are
+  // allocated in bulk.
+  void Reserve(size_t num_instructions, size_t num_blocks);
   // Adds an instruction to the module. Returns true if no error occurs. This
   // method will properly capture and store the data provided in |inst| so that
   // |inst| is no longer needed after returning.
@@ -77,7 +81,7 @@ class IrLoader {
   // The current BasicBlock under construction.
   std::unique_ptr<BasicBlock> block_;
   // Line related debug instructions accumulated thus far.
-  std::vector<Instruction> dbg_line_info_;
+  std::vector<DebugLine> dbg_line_info_;
 };
 
 }  // namespace opt
@@ -31,6 +31,7 @@ class LegalizeVectorShufflePass : public Pass {
  public:
   const char* name() const override { return "legalize-vector-shuffle"; }
   Status Process() override;
+  bool IsRequired() const override { return true; }
 
   IRContext::Analysis GetPreservedAnalyses() override {
     return IRContext::kAnalysisInstrToBlockMapping |
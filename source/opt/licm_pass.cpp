@@ -17,13 +17,39 @@
 #include <queue>
 #include <utility>
 
+#include "source/opcode.h"
 #include "source/opt/module.h"
 #include "source/opt/pass.h"
 
 namespace spvtools {
 namespace opt {
+namespace {
 
-Pass::Status LICMPass::Process() { return ProcessIRContext(); }
+const uint32_t kLoadMemoryAccessInIdx = 1;
+const uint32_t kVariableStorageClassInIdx = 0;
+
+// Returns true if the variable |var| is a buffer.
+bool IsBufferVariable(const Instruction* var) {
+  const uint32_t storage_class =
+      var->GetSingleWordInOperand(kVariableStorageClassInIdx);
+  return storage_class == SpvStorageClassStorageBuffer ||
+         storage_class == SpvStorageClassUniform;
+}
+
+// Returns true if the variable |var| may be written by other invocations.
+bool IsSharedVariable(const Instruction* var) {
+  const uint32_t storage_class =
+      var->GetSingleWordInOperand(kVariableStorageClassInIdx);
+  return storage_class != SpvStorageClassFunction &&
+         storage_class != SpvStorageClassPrivate;
+}
+
+}  // namespace
+
+Pass::Status LICMPass::Process() {
+  loop_writes_.clear();
+  return ProcessIRContext();
+}
 
 Pass::Status LICMPass::ProcessIRContext() {
   Status status = Status::SuccessWithoutChange;
@@ -51,6 +77,7 @@ Pass::Status LICMPass::ProcessFunction(Function* f) {
     }
     status = CombineStatus(status, ProcessLoop(&loop, f));
   }
+  if (status == Status::SuccessWithChange) RecordChangedFunction(f);
   return status;
 }
 
@@ -84,8 +111,9 @@ Pass::Status LICMPass::AnalyseAndHoistFromBB(
     std::vector<BasicBlock*>* loop_bbs) {
   bool modified = false;
   std::function<bool(Instruction*)> hoist_inst =
-      [this, &loop, &modified](Instruction* inst) {
-        if (loop->ShouldHoistInstruction(this->context(), inst)) {
+      [this, &loop, f, &modified](Instruction* inst) {
+        if (loop->ShouldHoistInstruction(this->context(), inst) ||
+            IsInvariantLoad(loop, f, inst)) {
           if (!HoistInstruction(loop, inst)) {
             return false;
           }
@@ -136,5 +164,87 @@ bool LICMPass::HoistInstruction(Loop* loop, Instruction* inst) {
   return true;
 }
 
+bool LICMPass::IsInvariantLoad(Loop* loop, Function* f, Instruction* inst) {
+  if (inst->opcode() != SpvOpLoad ||
+      !loop->AreAllOperandsOutsideLoop(context(), inst)) {
+    return false;
+  }
+  if (inst->NumInOperands() > kLoadMemoryAccessInIdx &&
+      (inst->GetSingleWordInOperand(kLoadMemoryAccessInIdx) &
+       SpvMemoryAccessVolatileMask)) {
+    return false;
+  }
+  Instruction* var = inst->GetBaseAddress();
+  if (var->opcode() != SpvOpVariable) return false;
+
+  // The load must not be speculated: it must execute in the first iteration,
+  // before the loop can exit.
+  DominatorAnalysis* dom_analysis = context()->GetDominatorAnalysis(f);
+  BasicBlock* bb = context()->get_instr_block(inst);
+  std::unordered_set<uint32_t> exit_blocks;
+  loop->GetExitBlocks(&exit_blocks);
+  for (uint32_t exit_id : exit_blocks) {
+    for (uint32_t pred_id : cfg()->preds(exit_id)) {
+      if (loop->IsInsideLoop(pred_id) &&
+          !dom_analysis->Dominates(bb->id(), pred_id)) {
+        return false;
+      }
+    }
+  }
+
+  if (var->IsReadOnlyVariable()) return true;
+
+  bool is_volatile = false;
+  for (SpvDecoration decoration :
+       {SpvDecorationCoherent, SpvDecorationVolatile}) {
+    get_decoration_mgr()->ForEachDecoration(
+        var->result_id(), decoration,
+        [&is_volatile](const Instruction&) { is_volatile = true; });
+  }
+  if (is_volatile) return false;
+
+  const LoopWrites& writes = GetLoopWrites(loop);
+  return !writes.unknown && !(writes.barrier && IsSharedVariable(var)) &&
+         !(writes.buffers && IsBufferVariable(var)) &&
+         !writes.variables.count(var->result_id());
+}
+
+const LICMPass::LoopWrites& LICMPass::GetLoopWrites(Loop* loop) {
+  auto it = loop_writes_.find(loop);
+  if (it != loop_writes_.end()) return it->second;
+
+  LoopWrites& writes = loop_writes_[loop];
+  for (uint32_t bb_id : loop->GetBlocks()) {
+    cfg()->block(bb_id)->ForEachInst([&writes](Instruction* inst) {
+      switch (inst->opcode()) {
+        case SpvOpFunctionCall:
+          writes.unknown = true;
+          return;
+        case SpvOpControlBarrier:
+        case SpvOpMemoryBarrier:
+          writes.barrier = true;
+          return;
+        case SpvOpStore:
+        case SpvOpCopyMemory:
+        case SpvOpCopyMemorySized:
+          break;
+        default:
+          if (!spvOpcodeIsAtomicOp(inst->opcode())) return;
+          break;
+      }
+
+      // The pointer written is the first in-operand.
+      Instruction* var = inst->GetBaseAddress();
+      if (var->opcode() != SpvOpVariable) {
+        writes.unknown = true;
+      } else {
+        writes.variables.insert(var->result_id());
+        if (IsBufferVariable(var)) writes.buffers = true;
+      }
+    });
+  }
+  return writes;
+}
+
 }  // namespace opt
 }  // namespace spvtools
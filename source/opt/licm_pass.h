@@ -16,6 +16,8 @@
 #define SOURCE_OPT_LICM_PASS_H_
 
 #include <queue>
+#include <unordered_map>
+#include <unordered_set>
 #include <vector>
 
 #include "source/opt/basic_block.h"
@@ -33,6 +35,10 @@ class LICMPass : public Pass {
   const char* name() const override { return "loop-invariant-code-motion"; }
   Status Process() override;
 
+  bool IsNoOp(IRContext* ctx) const override {
+    return ctx->GetModuleSummary()->NumLoops() == 0;
+  }
+
  private:
   // Searches the IRContext for functions and processes each, moving invariants
   // outside loops within the function where possible.
@@ -64,6 +70,34 @@ class LICMPass : public Pass {
   // Move the instruction to the preheader of |loop|.
   // This method will update the instruction to block mapping for the context
   bool HoistInstruction(Loop* loop, Instruction* inst);
+
+  // The memory written in a loop, nested loops included.
+  struct LoopWrites {
+    // True if the loop may write any memory: through a pointer which is not
+    // based on a variable, or in a function call.
+    bool unknown = false;
+    // True if the loop has a barrier, after which the memory shared with
+    // other invocations may hold their writes.
+    bool barrier = false;
+    // True if the loop writes a buffer.  Buffer variables may be bound to
+    // the same memory, so they all alias.
+    bool buffers = false;
+    // The ids of the variables the loop writes.
+    std::unordered_set<uint32_t> variables;
+  };
+
+  // Returns true if |inst| is a load which reads the same value in every
+  // iteration of |loop|, and executes whenever the loop is entered, so that
+  // it can be hoisted to the preheader.  The memory it reads must be read
+  // only, or not written in the loop.
+  bool IsInvariantLoad(Loop* loop, Function* f, Instruction* inst);
+
+  // Returns the memory written in |loop|.  It is computed once per loop:
+  // hoisting instructions out of a loop does not change it.
+  const LoopWrites& GetLoopWrites(Loop* loop);
+
+  // The memory written in each loop processed so far.
+  std::unordered_map<const Loop*, LoopWrites> loop_writes_;
 };
 
 }  // namespace opt
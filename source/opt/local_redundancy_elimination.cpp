@@ -21,16 +21,19 @@ namespace opt {
 
 Pass::Status LocalRedundancyEliminationPass::Process() {
   bool modified = false;
-  ValueNumberTable vnTable(context());
+  const ValueNumberTable& vnTable = *context()->GetValueNumberTable();
 
   for (auto& func : *get_module()) {
+    if (!ShouldProcessFunction(&func)) continue;
     for (auto& bb : func) {
       // Keeps track of all ids that contain a given value number. We keep
       // track of multiple values because they could have the same value, but
       // different decorations.
       std::map<uint32_t, uint32_t> value_to_ids;
-      if (EliminateRedundanciesInBB(&bb, vnTable, &value_to_ids))
+      if (EliminateRedundanciesInBB(&bb, vnTable, &value_to_ids)) {
         modified = true;
+        RecordChangedFunction(&func);
+      }
     }
   }
   return (modified ? Status::SuccessWithChange : Status::SuccessWithoutChange);
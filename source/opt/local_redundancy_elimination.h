@@ -34,6 +34,7 @@ namespace opt {
 class LocalRedundancyEliminationPass : public Pass {
  public:
   const char* name() const override { return "local-redundancy-elimination"; }
+  bool IsFunctionLocal() const override { return true; }
   Status Process() override;
 
   IRContext::Analysis GetPreservedAnalyses() override {
@@ -41,8 +42,9 @@ class LocalRedundancyEliminationPass : public Pass {
            IRContext::kAnalysisInstrToBlockMapping |
            IRContext::kAnalysisDecorations | IRContext::kAnalysisCombinators |
            IRContext::kAnalysisCFG | IRContext::kAnalysisDominatorAnalysis |
-           IRContext::kAnalysisNameMap | IRContext::kAnalysisConstants |
-           IRContext::kAnalysisTypes;
+           IRContext::kAnalysisLoopAnalysis | IRContext::kAnalysisNameMap |
+           IRContext::kAnalysisConstants | IRContext::kAnalysisTypes |
+           IRContext::kAnalysisValueNumberTable | IRContext::kAnalysisCallGraph;
   }
 
  protected:
@@ -198,7 +198,11 @@ Pass::Status LocalSingleBlockLoadStoreElimPass::ProcessImpl() {
   if (!AllExtensionsSupported()) return Status::SuccessWithoutChange;
   // Process all entry point functions
   ProcessFunction pfn = [this](Function* fp) {
-    return LocalSingleBlockLoadStoreElim(fp);
+    if (!ShouldProcessFunction(fp) || !LocalSingleBlockLoadStoreElim(fp)) {
+      return false;
+    }
+    RecordChangedFunction(fp);
+    return true;
   };
 
   bool modified = context()->ProcessEntryPointCallTree(pfn);
@@ -39,6 +39,7 @@ class LocalSingleBlockLoadStoreElimPass : public MemPass {
   LocalSingleBlockLoadStoreElimPass();
 
   const char* name() const override { return "eliminate-local-single-block"; }
+  bool IsFunctionLocal() const override { return true; }
   Status Process() override;
 
   IRContext::Analysis GetPreservedAnalyses() override {
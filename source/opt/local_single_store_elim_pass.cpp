@@ -65,7 +65,9 @@ Pass::Status LocalSingleStoreElimPass::ProcessImpl() {
   if (!AllExtensionsSupported()) return Status::SuccessWithoutChange;
   // Process all entry point functions
   ProcessFunction pfn = [this](Function* fp) {
-    return LocalSingleStoreElim(fp);
+    if (!ShouldProcessFunction(fp) || !LocalSingleStoreElim(fp)) return false;
+    RecordChangedFunction(fp);
+    return true;
   };
   bool modified = context()->ProcessEntryPointCallTree(pfn);
   return modified ? Status::SuccessWithChange : Status::SuccessWithoutChange;
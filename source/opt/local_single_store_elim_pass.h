@@ -42,6 +42,7 @@ class LocalSingleStoreElimPass : public Pass {
   LocalSingleStoreElimPass();
 
   const char* name() const override { return "eliminate-local-single-store"; }
+  bool IsFunctionLocal() const override { return true; }
   Status Process() override;
 
   IRContext::Analysis GetPreservedAnalyses() override {
@@ -274,10 +274,8 @@ bool LoopDependenceAnalysis::GetDependence(const Instruction* source,
     auto source_subscript = std::get<0>(*(*it).begin());
     auto destination_subscript = std::get<1>(*(*it).begin());
 
-    SENode* source_node = scalar_evolution_.SimplifyExpression(
-        scalar_evolution_.AnalyzeInstruction(source_subscript));
-    SENode* destination_node = scalar_evolution_.SimplifyExpression(
-        scalar_evolution_.AnalyzeInstruction(destination_subscript));
+    SENode* source_node = GetSubscriptNode(source_subscript);
+    SENode* destination_node = GetSubscriptNode(destination_subscript);
 
     // Check the loops are in a form we support.
     auto subscript_pair = std::make_pair(source_node, destination_node);
@@ -356,10 +354,8 @@ bool LoopDependenceAnalysis::GetDependence(const Instruction* source,
       auto source_subscript = std::get<0>(elem);
       auto destination_subscript = std::get<1>(elem);
 
-      SENode* source_node = scalar_evolution_.SimplifyExpression(
-          scalar_evolution_.AnalyzeInstruction(source_subscript));
-      SENode* destination_node = scalar_evolution_.SimplifyExpression(
-          scalar_evolution_.AnalyzeInstruction(destination_subscript));
+      SENode* source_node = GetSubscriptNode(source_subscript);
+      SENode* destination_node = GetSubscriptNode(destination_subscript);
 
       coupled_subscripts.push_back({source_node, destination_node});
     }
@@ -1138,21 +1134,15 @@ PartitionedSubscripts LoopDependenceAnalysis::PartitionSubscripts(
           current_partition.begin(), current_partition.end(),
           [loop,
            this](const std::pair<Instruction*, Instruction*>& elem) -> bool {
-            auto source_recurrences =
-                scalar_evolution_.AnalyzeInstruction(std::get<0>(elem))
-                    ->CollectRecurrentNodes();
-            auto destination_recurrences =
-                scalar_evolution_.AnalyzeInstruction(std::get<1>(elem))
-                    ->CollectRecurrentNodes();
-
-            source_recurrences.insert(source_recurrences.end(),
-                                      destination_recurrences.begin(),
-                                      destination_recurrences.end());
-
-            auto loops_in_pair = CollectLoops(source_recurrences);
-            auto end_it = loops_in_pair.end();
-
-            return std::find(loops_in_pair.begin(), end_it, loop) != end_it;
+            const auto& source_loops = GetLoops(
+                scalar_evolution_.AnalyzeInstruction(std::get<0>(elem)));
+            const auto& destination_loops = GetLoops(
+                scalar_evolution_.AnalyzeInstruction(std::get<1>(elem)));
+
+            return std::binary_search(source_loops.begin(), source_loops.end(),
+                                      loop) ||
+                   std::binary_search(destination_loops.begin(),
+                                      destination_loops.end(), loop);
           });
 
       auto has_loop = it != current_partition.end();
@@ -23,6 +23,7 @@
 #include <ostream>
 #include <set>
 #include <string>
+#include <unordered_map>
 #include <utility>
 #include <vector>
 
@@ -312,6 +313,18 @@ class LoopDependenceAnalysis {
   bool GetDependence(const Instruction* source, const Instruction* destination,
                      DistanceVector* distance_vector);
 
+  // Returns true if the loads or stores |source| and |destination| access the
+  // same memory at most |max_distance| iterations of |loop| apart.  |loop|
+  // must be one of the loops of the analysis.  The accesses of a loop
+  // invariant location, and those whose distance is unknown, are not reuses.
+  bool IsReuseWithin(const Instruction* source, const Instruction* destination,
+                     const Loop* loop, int64_t max_distance);
+
+  // Returns true if the load or store |memory_access| accesses a variable in
+  // the StorageBuffer or Uniform storage class: a buffer that loops usually
+  // stream through.
+  bool IsBufferAccess(const Instruction* memory_access);
+
   // Returns true if |subscript_pair| represents a Zero Index Variable pair
   // (ZIV)
   bool IsZIV(const std::pair<SENode*, SENode*>& subscript_pair);
@@ -351,12 +364,13 @@ class LoopDependenceAnalysis {
   SENode* GetFinalTripInductionNode(const Loop* loop,
                                     SENode* induction_coefficient);
 
-  // Returns all the distinct loops that appear in |nodes|.
-  std::set<const Loop*> CollectLoops(
+  // Returns all the distinct loops that appear in |nodes|, sorted.
+  std::vector<const Loop*> CollectLoops(
       const std::vector<SERecurrentNode*>& nodes);
 
-  // Returns all the distinct loops that appear in |source| and |destination|.
-  std::set<const Loop*> CollectLoops(SENode* source, SENode* destination);
+  // Returns all the distinct loops that appear in |source| and |destination|,
+  // sorted.
+  std::vector<const Loop*> CollectLoops(SENode* source, SENode* destination);
 
   // Returns true if |distance| is provably outside the loop bounds.
   // |coefficient| must be an SENode representing the coefficient of the
@@ -463,6 +477,22 @@ class LoopDependenceAnalysis {
   // Stores all the constraints created by the analysis.
   std::list<std::unique_ptr<Constraint>> constraints_;
 
+  // The simplified SENode of each subscript seen so far.  Every pair of
+  // accesses a pass queries analyzes the same subscripts again, so they are
+  // only simplified once.  The loops to pretend are the same must be set
+  // before the first query.
+  std::unordered_map<const Instruction*, SENode*> subscript_nodes_;
+
+  // The distinct loops of the recurrent nodes of each SENode seen so far,
+  // sorted.
+  std::unordered_map<const SENode*, std::vector<const Loop*>> node_loops_;
+
+  // Returns the simplified SENode of |subscript|.
+  SENode* GetSubscriptNode(const Instruction* subscript);
+
+  // Returns the distinct loops that appear in |node|, sorted.
+  const std::vector<const Loop*>& GetLoops(SENode* node);
+
   // Returns true if independence can be proven and false if it can't be proven.
   bool ZIVTest(const std::pair<SENode*, SENode*>& subscript_pair);
 
@@ -14,10 +14,10 @@
 
 #include "source/opt/loop_dependence.h"
 
+#include <algorithm>
+#include <iterator>
 #include <ostream>
-#include <set>
 #include <string>
-#include <unordered_set>
 #include <utility>
 #include <vector>
 
@@ -198,23 +198,9 @@ bool LoopDependenceAnalysis::IsProvablyOutsideOfLoopBounds(
 
 const Loop* LoopDependenceAnalysis::GetLoopForSubscriptPair(
     const std::pair<SENode*, SENode*>& subscript_pair) {
-  // Collect all the SERecurrentNodes.
-  std::vector<SERecurrentNode*> source_nodes =
-      std::get<0>(subscript_pair)->CollectRecurrentNodes();
-  std::vector<SERecurrentNode*> destination_nodes =
-      std::get<1>(subscript_pair)->CollectRecurrentNodes();
-
-  // Collect all the loops stored by the SERecurrentNodes.
-  std::unordered_set<const Loop*> loops{};
-  for (auto source_nodes_it = source_nodes.begin();
-       source_nodes_it != source_nodes.end(); ++source_nodes_it) {
-    loops.insert((*source_nodes_it)->GetLoop());
-  }
-  for (auto destination_nodes_it = destination_nodes.begin();
-       destination_nodes_it != destination_nodes.end();
-       ++destination_nodes_it) {
-    loops.insert((*destination_nodes_it)->GetLoop());
-  }
+  // Collect all the loops of the SERecurrentNodes.
+  std::vector<const Loop*> loops =
+      CollectLoops(std::get<0>(subscript_pair), std::get<1>(subscript_pair));
 
   // If we didn't find 1 loop |subscript_pair| is a subscript over multiple or 0
   // loops. We don't handle this so return nullptr.
@@ -222,7 +208,7 @@ const Loop* LoopDependenceAnalysis::GetLoopForSubscriptPair(
     PrintDebug("GetLoopForSubscriptPair found loops.size() != 1.");
     return nullptr;
   }
-  return *loops.begin();
+  return loops.front();
 }
 
 DistanceEntry* LoopDependenceAnalysis::GetDistanceEntryForLoop(
@@ -316,16 +302,19 @@ SENode* LoopDependenceAnalysis::GetFinalTripInductionNode(
       scalar_evolution_.CreateMultiplyNode(trip_count, induction_coefficient)));
 }
 
-std::set<const Loop*> LoopDependenceAnalysis::CollectLoops(
+std::vector<const Loop*> LoopDependenceAnalysis::CollectLoops(
     const std::vector<SERecurrentNode*>& recurrent_nodes) {
   // We don't handle loops with more than one induction variable. Therefore we
   // can identify the number of induction variables by collecting all of the
   // loops the collected recurrent nodes belong to.
-  std::set<const Loop*> loops{};
+  std::vector<const Loop*> loops{};
+  loops.reserve(recurrent_nodes.size());
   for (auto recurrent_nodes_it = recurrent_nodes.begin();
        recurrent_nodes_it != recurrent_nodes.end(); ++recurrent_nodes_it) {
-    loops.insert((*recurrent_nodes_it)->GetLoop());
+    loops.push_back((*recurrent_nodes_it)->GetLoop());
   }
+  std::sort(loops.begin(), loops.end());
+  loops.erase(std::unique(loops.begin(), loops.end()), loops.end());
 
   return loops;
 }
@@ -335,30 +324,26 @@ int64_t LoopDependenceAnalysis::CountInductionVariables(SENode* node) {
     return -1;
   }
 
-  std::vector<SERecurrentNode*> recurrent_nodes = node->CollectRecurrentNodes();
-
   // We don't handle loops with more than one induction variable. Therefore we
   // can identify the number of induction variables by collecting all of the
   // loops the collected recurrent nodes belong to.
-  std::set<const Loop*> loops = CollectLoops(recurrent_nodes);
-
-  return static_cast<int64_t>(loops.size());
+  return static_cast<int64_t>(GetLoops(node).size());
 }
 
-std::set<const Loop*> LoopDependenceAnalysis::CollectLoops(
+std::vector<const Loop*> LoopDependenceAnalysis::CollectLoops(
     SENode* source, SENode* destination) {
   if (!source || !destination) {
-    return std::set<const Loop*>{};
+    return std::vector<const Loop*>{};
   }
 
-  std::vector<SERecurrentNode*> source_nodes = source->CollectRecurrentNodes();
-  std::vector<SERecurrentNode*> destination_nodes =
-      destination->CollectRecurrentNodes();
-
-  std::set<const Loop*> loops = CollectLoops(source_nodes);
-  std::set<const Loop*> destination_loops = CollectLoops(destination_nodes);
+  const std::vector<const Loop*>& source_loops = GetLoops(source);
+  const std::vector<const Loop*>& destination_loops = GetLoops(destination);
 
-  loops.insert(std::begin(destination_loops), std::end(destination_loops));
+  std::vector<const Loop*> loops{};
+  loops.reserve(source_loops.size() + destination_loops.size());
+  std::set_union(source_loops.begin(), source_loops.end(),
+                 destination_loops.begin(), destination_loops.end(),
+                 std::back_inserter(loops));
 
   return loops;
 }
@@ -369,9 +354,29 @@ int64_t LoopDependenceAnalysis::CountInductionVariables(SENode* source,
     return -1;
   }
 
-  std::set<const Loop*> loops = CollectLoops(source, destination);
+  return static_cast<int64_t>(CollectLoops(source, destination).size());
+}
+
+SENode* LoopDependenceAnalysis::GetSubscriptNode(const Instruction* subscript) {
+  auto it = subscript_nodes_.find(subscript);
+  if (it != subscript_nodes_.end()) {
+    return it->second;
+  }
+
+  SENode* node = scalar_evolution_.SimplifyExpression(
+      scalar_evolution_.AnalyzeInstruction(subscript));
+  subscript_nodes_[subscript] = node;
+  return node;
+}
+
+const std::vector<const Loop*>& LoopDependenceAnalysis::GetLoops(SENode* node) {
+  auto it = node_loops_.find(node);
+  if (it != node_loops_.end()) {
+    return it->second;
+  }
 
-  return static_cast<int64_t>(loops.size());
+  std::vector<const Loop*> loops = CollectLoops(node->CollectRecurrentNodes());
+  return node_loops_.emplace(node, std::move(loops)).first->second;
 }
 
 Instruction* LoopDependenceAnalysis::GetOperandDefinition(
@@ -380,6 +385,36 @@ Instruction* LoopDependenceAnalysis::GetOperandDefinition(
       instruction->GetSingleWordInOperand(id));
 }
 
+bool LoopDependenceAnalysis::IsReuseWithin(const Instruction* source,
+                                           const Instruction* destination,
+                                           const Loop* loop,
+                                           int64_t max_distance) {
+  DistanceVector distance_vector(loops_.size());
+  if (GetDependence(source, destination, &distance_vector)) {
+    return false;
+  }
+
+  DistanceEntry* entry = GetDistanceEntryForLoop(loop, &distance_vector);
+  return entry != nullptr &&
+         entry->dependence_information ==
+             DistanceEntry::DependenceInformation::DISTANCE &&
+         entry->distance <= max_distance && entry->distance >= -max_distance;
+}
+
+bool LoopDependenceAnalysis::IsBufferAccess(const Instruction* memory_access) {
+  Instruction* location = GetOperandDefinition(memory_access, 0);
+  while (location->opcode() == SpvOpAccessChain) {
+    location = GetOperandDefinition(location, 0);
+  }
+  if (location->opcode() != SpvOpVariable) {
+    return false;
+  }
+
+  uint32_t storage_class = location->GetSingleWordInOperand(0);
+  return storage_class == SpvStorageClassStorageBuffer ||
+         storage_class == SpvStorageClassUniform;
+}
+
 std::vector<Instruction*> LoopDependenceAnalysis::GetSubscripts(
     const Instruction* instruction) {
   Instruction* access_chain = GetOperandDefinition(instruction, 0);
@@ -421,30 +456,24 @@ void LoopDependenceAnalysis::MarkUnsusedDistanceEntriesAsIrrelevant(
   std::vector<Instruction*> source_subscripts = GetSubscripts(source);
   std::vector<Instruction*> destination_subscripts = GetSubscripts(destination);
 
-  std::set<const Loop*> used_loops{};
+  std::vector<const Loop*> used_loops{};
 
   for (Instruction* source_inst : source_subscripts) {
-    SENode* source_node = scalar_evolution_.SimplifyExpression(
-        scalar_evolution_.AnalyzeInstruction(source_inst));
-    std::vector<SERecurrentNode*> recurrent_nodes =
-        source_node->CollectRecurrentNodes();
-    for (SERecurrentNode* recurrent_node : recurrent_nodes) {
-      used_loops.insert(recurrent_node->GetLoop());
-    }
+    const std::vector<const Loop*>& loops =
+        GetLoops(GetSubscriptNode(source_inst));
+    used_loops.insert(used_loops.end(), loops.begin(), loops.end());
   }
 
   for (Instruction* destination_inst : destination_subscripts) {
-    SENode* destination_node = scalar_evolution_.SimplifyExpression(
-        scalar_evolution_.AnalyzeInstruction(destination_inst));
-    std::vector<SERecurrentNode*> recurrent_nodes =
-        destination_node->CollectRecurrentNodes();
-    for (SERecurrentNode* recurrent_node : recurrent_nodes) {
-      used_loops.insert(recurrent_node->GetLoop());
-    }
+    const std::vector<const Loop*>& loops =
+        GetLoops(GetSubscriptNode(destination_inst));
+    used_loops.insert(used_loops.end(), loops.begin(), loops.end());
   }
 
+  std::sort(used_loops.begin(), used_loops.end());
   for (size_t i = 0; i < loops_.size(); ++i) {
-    if (used_loops.find(loops_[i]) == used_loops.end()) {
+    if (!std::binary_search(used_loops.begin(), used_loops.end(),
+                            loops_[i])) {
       distance_vector->GetEntries()[i].dependence_information =
           DistanceEntry::DependenceInformation::IRRELEVANT;
     }
@@ -501,10 +501,18 @@ LoopDescriptor::LoopDescriptor(IRContext* context, const Function* f)
 LoopDescriptor::~LoopDescriptor() { ClearLoops(); }
 
 void LoopDescriptor::PopulateList(IRContext* context, const Function* f) {
-  DominatorAnalysis* dom_analysis = context->GetDominatorAnalysis(f);
-
   ClearLoops();
 
+  // Most functions have no loop, and do not need a dominator tree to find it
+  // out.
+  if (std::none_of(f->begin(), f->end(), [](const BasicBlock& bb) {
+        return bb.IsLoopHeader();
+      })) {
+    return;
+  }
+
+  DominatorAnalysis* dom_analysis = context->GetDominatorAnalysis(f);
+
   // Post-order traversal of the dominator tree to find all the OpLoopMerge
   // instructions.
   DominatorTree& dom_tree = dom_analysis->GetDomTree();
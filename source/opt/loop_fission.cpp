@@ -71,6 +71,10 @@ class LoopFissionImpl {
   // dependence rules.
   bool CanPerformSplit();
 
+  // Returns true if the two sets built by GroupInstructionsByUseDef access the
+  // same buffer elements at most |max_reuse_distance| iterations apart.
+  bool SplitsReusedData(int64_t max_reuse_distance);
+
   // Split the loop and return a pointer to the new loop.
   Loop* SplitLoop();
 
@@ -357,6 +361,34 @@ bool LoopFissionImpl::CanPerformSplit() {
   return true;
 }
 
+bool LoopFissionImpl::SplitsReusedData(int64_t max_reuse_distance) {
+  std::vector<const Loop*> loops;
+  Loop* parent_loop = loop_;
+  while (parent_loop) {
+    loops.push_back(parent_loop);
+    parent_loop = parent_loop->GetParent();
+  }
+
+  LoopDependenceAnalysis analysis{context_, loops};
+
+  auto is_buffer_access = [&analysis](Instruction* inst) {
+    return (inst->opcode() == SpvOp::SpvOpLoad ||
+            inst->opcode() == SpvOp::SpvOpStore) &&
+           analysis.IsBufferAccess(inst);
+  };
+
+  for (Instruction* first : cloned_loop_instructions_) {
+    if (!is_buffer_access(first)) continue;
+    for (Instruction* second : original_loop_instructions_) {
+      if (is_buffer_access(second) &&
+          analysis.IsReuseWithin(first, second, loop_, max_reuse_distance)) {
+        return true;
+      }
+    }
+  }
+  return false;
+}
+
 Loop* LoopFissionImpl::SplitLoop() {
   // Clone the loop.
   LoopUtils util{context_, loop_};
@@ -389,7 +421,7 @@ Loop* LoopFissionImpl::SplitLoop() {
         instructions_to_kill.push_back(&inst);
         if (inst.opcode() == SpvOp::SpvOpPhi) {
           context_->ReplaceAllUsesWith(
-              inst.result_id(), clone_results.value_map_[inst.result_id()]);
+              inst.result_id(), clone_results.value_map_.Get(inst.result_id()));
         }
       }
     }
@@ -417,9 +449,14 @@ Loop* LoopFissionImpl::SplitLoop() {
   return cloned_loop;
 }
 
+const size_t LoopFissionPass::kDefaultRegisterThreshold;
+const int64_t LoopFissionPass::kMaxReuseDistance;
+
 LoopFissionPass::LoopFissionPass(const size_t register_threshold_to_split,
-                                 bool split_multiple_times)
-    : split_multiple_times_(split_multiple_times) {
+                                 bool split_multiple_times,
+                                 bool keep_reused_data)
+    : split_multiple_times_(split_multiple_times),
+      keep_reused_data_(keep_reused_data) {
   // Split if the number of registers in the loop exceeds
   // |register_threshold_to_split|.
   split_criteria_ =
@@ -429,7 +466,8 @@ LoopFissionPass::LoopFissionPass(const size_t register_threshold_to_split,
       };
 }
 
-LoopFissionPass::LoopFissionPass() : split_multiple_times_(false) {
+LoopFissionPass::LoopFissionPass()
+    : split_multiple_times_(false), keep_reused_data_(false) {
   // Split by default.
   split_criteria_ = [](const RegisterLiveness::RegionRegisterLiveness&) {
     return true;
@@ -476,9 +514,16 @@ Pass::Status LoopFissionPass::Process() {
           continue;
         }
 
+        // Keep the loop whole if splitting it would move the reuses of buffer
+        // data a whole trip count apart.
+        if (keep_reused_data_ && impl.SplitsReusedData(kMaxReuseDistance)) {
+          continue;
+        }
+
         if (impl.CanPerformSplit()) {
           Loop* second_loop = impl.SplitLoop();
           changed = true;
+          RecordChangedFunction(&f);
           context()->InvalidateAnalysesExceptFor(
               IRContext::kAnalysisLoopAnalysis);
 
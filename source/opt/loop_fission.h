@@ -33,6 +33,13 @@ namespace opt {
 
 class LoopFissionPass : public Pass {
  public:
+  // The register pressure above which loops are split in automatic mode.
+  static const size_t kDefaultRegisterThreshold = 64;
+
+  // The largest distance, in iterations, between two accesses of a buffer
+  // element for a loop to reuse the data.
+  static const int64_t kMaxReuseDistance = 8;
+
   // Fuction used to determine if a given loop should be split. Takes register
   // pressure region for that loop as a parameter and returns true if the loop
   // should be split.
@@ -46,19 +53,29 @@ class LoopFissionPass : public Pass {
   // Split the loop if the number of registers used in the loop exceeds
   // |register_threshold_to_split|. |split_multiple_times| flag determines
   // whether or not the pass should split loops after already splitting them
-  // once.
+  // once.  If |keep_reused_data| is true, a loop is not split if both loops
+  // would access the same buffer elements at most |kMaxReuseDistance|
+  // iterations apart, since splitting would move the reuses a whole trip
+  // count apart.
   LoopFissionPass(size_t register_threshold_to_split,
-                  bool split_multiple_times = true);
+                  bool split_multiple_times = true,
+                  bool keep_reused_data = false);
 
   // Split loops whose register pressure meets the criteria of |functor|.
   LoopFissionPass(FissionCriteriaFunction functor,
                   bool split_multiple_times = true)
-      : split_criteria_(functor), split_multiple_times_(split_multiple_times) {}
+      : split_criteria_(functor),
+        split_multiple_times_(split_multiple_times),
+        keep_reused_data_(false) {}
 
   const char* name() const override { return "loop-fission"; }
 
   Pass::Status Process() override;
 
+  bool IsNoOp(IRContext* ctx) const override {
+    return ctx->GetModuleSummary()->NumLoops() == 0;
+  }
+
   // Checks if |loop| meets the register pressure criteria to be split.
   bool ShouldSplitLoop(const Loop& loop, IRContext* context);
 
@@ -70,6 +87,10 @@ class LoopFissionPass : public Pass {
   // Flag designating whether or not we should also split the result of
   // previously split loops if they meet the register presure criteria.
   bool split_multiple_times_;
+
+  // Flag designating whether or not the loops reusing buffer data across the
+  // two parts of the split are kept whole.
+  bool keep_reused_data_;
 };
 
 }  // namespace opt
@@ -464,19 +464,7 @@ bool LoopFusion::IsLegal() {
 
   // Find all the loops in this loop nest for the dependency analysis.
   std::vector<const Loop*> loops{};
-
-  // Find the parents.
-  for (auto current_loop = loop_0_; current_loop != nullptr;
-       current_loop = current_loop->GetParent()) {
-    loops.push_back(current_loop);
-  }
-
-  auto this_loop_position = loops.size() - 1;
-  std::reverse(std::begin(loops), std::end(loops));
-
-  // Find the children.
-  CollectChildren(loop_0_, &loops);
-  CollectChildren(loop_1_, &loops);
+  auto this_loop_position = GetLoopNest(&loops);
 
   // Check that any dependes created are legal. That means the fused loops do
   // not have any dependencies with dependence distance greater than 0 that did
@@ -519,6 +507,58 @@ bool LoopFusion::IsLegal() {
   return true;
 }
 
+bool LoopFusion::SharesStreamedData(int64_t max_reuse_distance) {
+  auto loads_stores_0 = GetLoadsAndStoresInLoop(loop_0_);
+  auto loads_stores_1 = GetLoadsAndStoresInLoop(loop_1_);
+
+  std::vector<Instruction*> accesses_0 = std::get<0>(loads_stores_0);
+  accesses_0.insert(accesses_0.end(), std::get<1>(loads_stores_0).begin(),
+                    std::get<1>(loads_stores_0).end());
+  std::vector<Instruction*> accesses_1 = std::get<0>(loads_stores_1);
+  accesses_1.insert(accesses_1.end(), std::get<1>(loads_stores_1).begin(),
+                    std::get<1>(loads_stores_1).end());
+
+  std::vector<const Loop*> loops{};
+  GetLoopNest(&loops);
+  LoopDependenceAnalysis analysis(context_, loops);
+  analysis.GetScalarEvolution()->AddLoopsToPretendAreTheSame(
+      {loop_0_, loop_1_});
+
+  // Without fusion, an element accessed by both loops is reused a whole trip
+  // count later.  Once fused, the reuse distance is the dependence distance.
+  for (auto access_0 : accesses_0) {
+    if (!analysis.IsBufferAccess(access_0)) {
+      continue;
+    }
+    for (auto access_1 : accesses_1) {
+      if (analysis.IsBufferAccess(access_1) &&
+          analysis.IsReuseWithin(access_0, access_1, loop_0_,
+                                 max_reuse_distance)) {
+        return true;
+      }
+    }
+  }
+
+  return false;
+}
+
+size_t LoopFusion::GetLoopNest(std::vector<const Loop*>* loops) {
+  // Find the parents.
+  for (auto current_loop = loop_0_; current_loop != nullptr;
+       current_loop = current_loop->GetParent()) {
+    loops->push_back(current_loop);
+  }
+
+  auto this_loop_position = loops->size() - 1;
+  std::reverse(std::begin(*loops), std::end(*loops));
+
+  // Find the children.
+  CollectChildren(loop_0_, loops);
+  CollectChildren(loop_1_, loops);
+
+  return this_loop_position;
+}
+
 void ReplacePhiParentWith(Instruction* inst, uint32_t orig_block,
                           uint32_t new_block) {
   if (inst->GetSingleWordInOperand(1) == orig_block) {
@@ -532,6 +572,15 @@ void LoopFusion::Fuse() {
   assert(AreCompatible() && "Can't fuse, loops aren't compatible");
   assert(IsLegal() && "Can't fuse, illegal");
 
+  // Only the scalar evolution of the two loops, and of the code using them,
+  // changes.
+  if (context_->AreAnalysesValid(IRContext::kAnalysisScalarEvolution)) {
+    ScalarEvolutionAnalysis* scalar_analysis =
+        context_->GetScalarEvolutionAnalysis();
+    scalar_analysis->InvalidateLoop(loop_0_);
+    scalar_analysis->InvalidateLoop(loop_1_);
+  }
+
   // Save the pointers/ids, won't be found in the middle of doing modifications.
   auto header_1 = loop_1_->GetHeaderBlock()->id();
   auto condition_1 = loop_1_->FindConditionBlock()->id();
@@ -723,7 +772,8 @@ void LoopFusion::Fuse() {
   context_->InvalidateAnalysesExceptFor(
       IRContext::Analysis::kAnalysisInstrToBlockMapping |
       IRContext::Analysis::kAnalysisLoopAnalysis |
-      IRContext::Analysis::kAnalysisDefUse | IRContext::Analysis::kAnalysisCFG);
+      IRContext::Analysis::kAnalysisDefUse | IRContext::Analysis::kAnalysisCFG |
+      IRContext::Analysis::kAnalysisScalarEvolution);
 }
 
 }  // namespace opt
@@ -55,11 +55,22 @@ class LoopFusion {
   // * there are no function calls in the loops (could have side-effects)
   bool IsLegal();
 
+  // Returns true if |loop_0| and |loop_1| access the same elements of a
+  // buffer, at most |max_reuse_distance| iterations apart once fused.  Fusing
+  // such loops brings the reuses of the elements closer together.
+  bool SharesStreamedData(int64_t max_reuse_distance);
+
   // Perform the actual fusion of |loop_0_| and |loop_1_|. The loops have to be
   // compatible and the fusion has to be legal.
   void Fuse();
 
  private:
+  // Appends the loops of the nest of |loop_0_| and |loop_1_| to |loops| for
+  // the dependence analysis: the parents of |loop_0_| from the outermost,
+  // |loop_0_|, and the children of both loops.  Returns the position of
+  // |loop_0_| in |loops|.
+  size_t GetLoopNest(std::vector<const Loop*>* loops);
+
   // Check that the initial values are the same.
   bool CheckInit();
 
@@ -22,13 +22,19 @@
 namespace spvtools {
 namespace opt {
 
+const size_t LoopFusionPass::kDefaultMaxRegistersPerLoop;
+const int64_t LoopFusionPass::kMaxReuseDistance;
+
 Pass::Status LoopFusionPass::Process() {
   bool modified = false;
   Module* module = context()->module();
 
   // Process each function in the module
   for (Function& f : *module) {
-    modified |= ProcessFunction(&f);
+    if (ProcessFunction(&f)) {
+      modified = true;
+      RecordChangedFunction(&f);
+    }
   }
 
   return modified ? Status::SuccessWithChange : Status::SuccessWithoutChange;
@@ -47,7 +53,9 @@ bool LoopFusionPass::ProcessFunction(Function* function) {
     for (auto& loop_1 : ld) {
       LoopFusion fusion(context(), &loop_0, &loop_1);
 
-      if (fusion.AreCompatible() && fusion.IsLegal()) {
+      if (fusion.AreCompatible() && fusion.IsLegal() &&
+          (!shared_data_only_ ||
+           fusion.SharesStreamedData(kMaxReuseDistance))) {
         RegisterLiveness liveness(context(), function);
         RegisterLiveness::RegionRegisterLiveness reg_pressure{};
         liveness.SimulateFusion(loop_0, loop_1, &reg_pressure);
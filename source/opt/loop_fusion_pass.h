@@ -15,6 +15,8 @@
 #ifndef SOURCE_OPT_LOOP_FUSION_PASS_H_
 #define SOURCE_OPT_LOOP_FUSION_PASS_H_
 
+#include <cstdint>
+
 #include "source/opt/pass.h"
 
 namespace spvtools {
@@ -24,10 +26,23 @@ namespace opt {
 // This pass will look for adjacent loops that are compatible and legal to be
 // fused. It will fuse all such loops as long as the register usage for the
 // fused loop stays under the threshold defined by |max_registers_per_loop|.
+// If |shared_data_only| is true, only the loops sharing streamed data are
+// fused: those accessing the same buffer elements at most
+// |kMaxReuseDistance| iterations apart once fused.
 class LoopFusionPass : public Pass {
  public:
-  explicit LoopFusionPass(size_t max_registers_per_loop)
-      : Pass(), max_registers_per_loop_(max_registers_per_loop) {}
+  // The register budget of a fused loop in automatic mode.
+  static const size_t kDefaultMaxRegistersPerLoop = 64;
+
+  // The largest distance, in iterations, between two accesses of a buffer
+  // element by fused loops for them to share the data.
+  static const int64_t kMaxReuseDistance = 8;
+
+  explicit LoopFusionPass(size_t max_registers_per_loop,
+                          bool shared_data_only = false)
+      : Pass(),
+        max_registers_per_loop_(max_registers_per_loop),
+        shared_data_only_(shared_data_only) {}
 
   const char* name() const override { return "loop-fusion"; }
 
@@ -36,6 +51,10 @@ class LoopFusionPass : public Pass {
   // succesful to indicate whether changes have been made to the modue.
   Status Process() override;
 
+  bool IsNoOp(IRContext* ctx) const override {
+    return ctx->GetModuleSummary()->NumLoops() == 0;
+  }
+
  private:
   // Fuse loops in |function| if compatible, legal and the fused loop won't use
   // too many registers.
@@ -43,6 +62,9 @@ class LoopFusionPass : public Pass {
 
   // The maximum number of registers a fused loop is allowed to use.
   size_t max_registers_per_loop_;
+
+  // True if only the loops sharing streamed data are fused.
+  bool shared_data_only_;
 };
 
 }  // namespace opt
@@ -121,7 +121,7 @@ void LoopPeeling::DuplicateAndConnectLoop(
     for (uint32_t i = 0; i < phi->NumInOperands(); i += 2) {
       if (!loop_->IsInsideLoop(phi->GetSingleWordInOperand(i + 1))) {
         phi->SetInOperand(i,
-                          {clone_results->value_map_.at(
+                          {clone_results->value_map_.Get(
                               exit_value_.at(phi->result_id())->result_id())});
         phi->SetInOperand(i + 1, {cloned_loop_exit});
         def_use_mgr->AnalyzeInstUse(phi);
@@ -140,7 +140,7 @@ void LoopPeeling::InsertCanonicalInductionVariable(
     LoopUtils::LoopCloningResult* clone_results) {
   if (original_loop_canonical_induction_variable_) {
     canonical_induction_variable_ =
-        context_->get_def_use_mgr()->GetDef(clone_results->value_map_.at(
+        context_->get_def_use_mgr()->GetDef(clone_results->value_map_.Get(
             original_loop_canonical_induction_variable_->result_id()));
     return;
   }
@@ -458,9 +458,7 @@ void LoopPeeling::PeelBefore(uint32_t peel_factor) {
       [&clone_results, if_block, this](Instruction* phi) {
         // if_merge_block had previously only 1 predecessor.
         uint32_t incoming_value = phi->GetSingleWordInOperand(0);
-        auto def_in_loop = clone_results.value_map_.find(incoming_value);
-        if (def_in_loop != clone_results.value_map_.end())
-          incoming_value = def_in_loop->second;
+        clone_results.value_map_.Remap(&incoming_value);
         phi->AddOperand(
             {spv_operand_type_t::SPV_OPERAND_TYPE_ID, {incoming_value}});
         phi->AddOperand(
@@ -540,7 +538,7 @@ void LoopPeeling::PeelAfter(uint32_t peel_factor) {
         };
 
         Instruction* cloned_phi =
-            def_use_mgr->GetDef(clone_results.value_map_.at(phi->result_id()));
+            def_use_mgr->GetDef(clone_results.value_map_.Get(phi->result_id()));
         uint32_t cloned_preheader_value = cloned_phi->GetSingleWordInOperand(
             find_value_idx(cloned_phi, GetClonedLoop()));
 
@@ -587,9 +585,13 @@ bool LoopPeelingPass::ProcessFunction(Function* f) {
     to_process_loop.push_back(&l);
   }
 
-  ScalarEvolutionAnalysis scev_analysis(context());
-
   for (Loop* loop : to_process_loop) {
+    // Peeling a loop the profile shows to be cold only grows the code.
+    if (context()->IsColdBlock(loop->GetHeaderBlock()->id(),
+                               f->entry()->id())) {
+      continue;
+    }
+
     CodeMetrics loop_size;
     loop_size.Analyze(*loop);
 
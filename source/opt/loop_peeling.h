@@ -264,6 +264,10 @@ class LoopPeelingPass : public Pass {
   // succesful to indicate whether changes have been made to the modue.
   Pass::Status Process() override;
 
+  bool IsNoOp(IRContext* ctx) const override {
+    return ctx->GetModuleSummary()->NumLoops() == 0;
+  }
+
  private:
   // Describes the peeling direction.
   enum class CmpOperator {
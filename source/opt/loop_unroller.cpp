@@ -14,6 +14,7 @@
 
 #include "source/opt/loop_unroller.h"
 
+#include <algorithm>
 #include <limits>
 #include <map>
 #include <memory>
@@ -21,8 +22,10 @@
 #include <utility>
 #include <vector>
 
+#include "source/opt/id_remap.h"
 #include "source/opt/ir_builder.h"
 #include "source/opt/loop_utils.h"
+#include "source/opt/register_pressure.h"
 
 // Implements loop util unrolling functionality for fully and partially
 // unrolling loops. Given a factor it will duplicate the loop that many times,
@@ -73,6 +76,13 @@ static const uint32_t kLoopControlDontUnrollIndex = 2;
 // Operand index of the loop control parameter of the OpLoopMerge.
 static const uint32_t kLoopControlIndex = 2;
 
+// The largest number of instructions of a loop once it is unrolled with an
+// automatically picked factor.
+static const size_t kMaxUnrolledLoopSize = 256;
+
+// The largest factor picked automatically to partially unroll a loop.
+static const size_t kMaxPartialUnrollFactor = 8;
+
 // This utility class encapsulates some of the state we need to maintain between
 // loop unrolls. Specifically it maintains key blocks and the induction variable
 // in the current loop duplication step and the blocks from the previous one.
@@ -157,7 +167,7 @@ struct LoopUnrollState {
 
   // A mapping of the original instruction ids to the instruction ids to their
   // copies.
-  std::unordered_map<uint32_t, uint32_t> new_inst;
+  IdRemap new_inst;
 
   std::unordered_map<uint32_t, Instruction*> ids_to_new_inst;
 };
@@ -678,17 +688,19 @@ void LoopUnrollerUtilsImpl::CopyBody(Loop* loop, bool eliminate_conditions) {
 
     assert(master_copy->result_id() != 0);
     Instruction* induction_clone =
-        state_.ids_to_new_inst[state_.new_inst[master_copy->result_id()]];
+        state_.ids_to_new_inst[state_.new_inst.Get(master_copy->result_id())];
 
     state_.new_phis_.push_back(induction_clone);
     assert(induction_clone->result_id() != 0);
 
     if (!state_.previous_phis_.empty()) {
-      state_.new_inst[master_copy->result_id()] = GetPhiDefID(
-          state_.previous_phis_[index], state_.previous_latch_block_->id());
+      state_.new_inst.Set(
+          master_copy->result_id(),
+          GetPhiDefID(state_.previous_phis_[index],
+                      state_.previous_latch_block_->id()));
     } else {
       // Do not replace the first phi block ids.
-      state_.new_inst[master_copy->result_id()] = master_copy->result_id();
+      state_.new_inst.Set(master_copy->result_id(), master_copy->result_id());
     }
   }
 
@@ -699,7 +711,8 @@ void LoopUnrollerUtilsImpl::CopyBody(Loop* loop, bool eliminate_conditions) {
 
   // Only reference to the header block is the backedge in the latch block,
   // don't change this.
-  state_.new_inst[loop->GetHeaderBlock()->id()] = loop->GetHeaderBlock()->id();
+  state_.new_inst.Set(loop->GetHeaderBlock()->id(),
+                      loop->GetHeaderBlock()->id());
 
   for (auto& pair : state_.new_blocks) {
     RemapOperands(pair.second);
@@ -765,7 +778,7 @@ void LoopUnrollerUtilsImpl::CloseUnrolledLoop(Loop* loop) {
     uint32_t initalizer_id =
         GetPhiDefID(induction, loop->GetPreHeaderBlock()->id());
 
-    state_.new_inst[induction->result_id()] = initalizer_id;
+    state_.new_inst.Set(induction->result_id(), initalizer_id);
   }
 
   for (BasicBlock* block : loop_blocks_inorder_) {
@@ -839,7 +852,7 @@ void LoopUnrollerUtilsImpl::AssignNewResultIds(BasicBlock* basic_block) {
   uint32_t new_label_id = context_->TakeNextId();
 
   // Assign a new id to the label.
-  state_.new_inst[basic_block->GetLabelInst()->result_id()] = new_label_id;
+  state_.new_inst.Set(basic_block->GetLabelInst()->result_id(), new_label_id);
   basic_block->GetLabelInst()->SetResultId(new_label_id);
   def_use_mgr->AnalyzeInstDefUse(basic_block->GetLabelInst());
 
@@ -857,7 +870,7 @@ void LoopUnrollerUtilsImpl::AssignNewResultIds(BasicBlock* basic_block) {
     def_use_mgr->AnalyzeInstDef(&inst);
 
     // Save the mapping of old_id -> new_id.
-    state_.new_inst[old_id] = inst.result_id();
+    state_.new_inst.Set(old_id, inst.result_id());
     // Check if this instruction is the induction variable.
     if (loop_induction_variable_->result_id() == old_id) {
       // Save a pointer to the new copy of it.
@@ -869,11 +882,7 @@ void LoopUnrollerUtilsImpl::AssignNewResultIds(BasicBlock* basic_block) {
 
 void LoopUnrollerUtilsImpl::RemapOperands(Instruction* inst) {
   auto remap_operands_to_new_ids = [this](uint32_t* id) {
-    auto itr = state_.new_inst.find(*id);
-
-    if (itr != state_.new_inst.end()) {
-      *id = itr->second;
-    }
+    state_.new_inst.Remap(id);
   };
 
   inst->ForEachInId(remap_operands_to_new_ids);
@@ -1065,6 +1074,53 @@ void LoopUtils::Finalize() {
  *
  */
 
+size_t LoopUnroller::ChooseUnrollFactor(const Loop& loop) {
+  const BasicBlock* condition = loop.FindConditionBlock();
+  const Instruction* induction = loop.FindConditionVariable(condition);
+  size_t iterations = 0;
+  if (!loop.FindNumberOfIterations(induction, &*condition->ctail(),
+                                   &iterations) ||
+      iterations < 2) {
+    return 0;
+  }
+
+  CodeMetrics metrics;
+  metrics.Analyze(loop);
+  const size_t size = std::max<size_t>(metrics.roi_size_, 1);
+
+  // The values live on entry to the loop are live through all the copies of
+  // the body, while the other registers of the loop are needed once per copy.
+  RegisterLiveness::RegionRegisterLiveness liveness;
+  Function* function = loop.GetHeaderBlock()->GetParent();
+  context()->GetLivenessAnalysis()->Get(function)->ComputeLoopRegisterPressure(
+      loop, &liveness);
+  const size_t carried = liveness.live_in_.size();
+  if (carried >= max_registers_) return 0;
+  const size_t per_copy = liveness.used_registers_ > carried
+                              ? liveness.used_registers_ - carried
+                              : 1;
+  const size_t register_limit = (max_registers_ - carried) / per_copy;
+  const size_t size_limit = kMaxUnrolledLoopSize / size;
+
+  // Fully unroll the loop if it is small enough.
+  if (iterations <= register_limit && iterations <= size_limit) {
+    return iterations;
+  }
+
+  size_t factor =
+      std::min(std::min(register_limit, size_limit), kMaxPartialUnrollFactor);
+  if (factor < 2) return 0;
+
+  // Prefer a factor dividing the trip count, which needs no residual loop.
+  for (size_t divisor = factor; divisor * 2 > factor; --divisor) {
+    if (iterations % divisor == 0) {
+      factor = divisor;
+      break;
+    }
+  }
+  return factor < 2 ? 0 : factor;
+}
+
 Pass::Status LoopUnroller::Process() {
   bool changed = false;
   for (Function& f : *context()->module()) {
@@ -1077,10 +1133,15 @@ Pass::Status LoopUnroller::Process() {
 
       if (fully_unroll_) {
         loop_utils.FullyUnroll();
+      } else if (max_registers_ > 0) {
+        const size_t factor = ChooseUnrollFactor(loop);
+        if (factor == 0) continue;
+        loop_utils.PartiallyUnroll(factor);
       } else {
         loop_utils.PartiallyUnroll(unroll_factor_);
       }
       changed = true;
+      RecordChangedFunction(&f);
     }
     LD->PostModificationCleanup();
   }
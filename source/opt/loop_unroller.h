@@ -15,6 +15,9 @@
 #ifndef SOURCE_OPT_LOOP_UNROLLER_H_
 #define SOURCE_OPT_LOOP_UNROLLER_H_
 
+#include <cstddef>
+
+#include "source/opt/loop_descriptor.h"
 #include "source/opt/pass.h"
 
 namespace spvtools {
@@ -22,14 +25,31 @@ namespace opt {
 
 class LoopUnroller : public Pass {
  public:
-  LoopUnroller() : Pass(), fully_unroll_(true), unroll_factor_(0) {}
+  LoopUnroller()
+      : Pass(), fully_unroll_(true), unroll_factor_(0), max_registers_(0) {}
   LoopUnroller(bool fully_unroll, int unroll_factor)
-      : Pass(), fully_unroll_(fully_unroll), unroll_factor_(unroll_factor) {}
+      : Pass(),
+        fully_unroll_(fully_unroll),
+        unroll_factor_(unroll_factor),
+        max_registers_(0) {}
+
+  // Creates a pass which picks the unroll factor of each loop from its trip
+  // count, its size and its register pressure, so that the unrolled loop is
+  // expected to use at most |max_registers| registers.
+  explicit LoopUnroller(size_t max_registers)
+      : Pass(),
+        fully_unroll_(false),
+        unroll_factor_(0),
+        max_registers_(max_registers) {}
 
   const char* name() const override { return "loop-unroll"; }
 
   Status Process() override;
 
+  bool IsNoOp(IRContext* ctx) const override {
+    return ctx->GetModuleSummary()->NumLoops() == 0;
+  }
+
   IRContext::Analysis GetPreservedAnalyses() override {
     return IRContext::kAnalysisDefUse |
            IRContext::kAnalysisInstrToBlockMapping |
@@ -39,8 +59,16 @@ class LoopUnroller : public Pass {
   }
 
  private:
+  // Returns the factor by which |loop| should be unrolled when the factor is
+  // picked automatically, or 0 if it should not be unrolled.  A factor which
+  // is at least the trip count of |loop| fully unrolls it.  |loop| must be
+  // unrollable.
+  size_t ChooseUnrollFactor(const Loop& loop);
+
   bool fully_unroll_;
   int unroll_factor_;
+  // The register budget of the automatic mode, or 0 if the factor is given.
+  size_t max_registers_;
 };
 
 }  // namespace opt
@@ -40,6 +40,11 @@ namespace {
 
 static const uint32_t kTypePointerStorageClassInIdx = 0;
 
+// The number of iterations assumed for a loop when there is no profile, and
+// the bound on the estimates built from it.
+static const uint64_t kAssumedTripCount = 10;
+static const uint64_t kMaxEstimatedBenefit = 1000000;
+
 }  // anonymous namespace
 
 namespace {
@@ -64,23 +69,28 @@ class LoopUnswitch {
   //  - The loop has one conditional branch or switch that do not depends on the
   //  loop;
   //  - The loop invariant condition is uniform;
+  // When several conditions qualify, the one with the largest benefit, as
+  // estimated by |GetUnswitchBenefit|, is chosen.
   bool CanUnswitchLoop() {
     if (switch_block_) return true;
     if (loop_->IsSafeToClone()) return false;
 
-    CFG& cfg = *context_->cfg();
-
-    for (uint32_t bb_id : loop_->GetBlocks()) {
-      BasicBlock* bb = cfg.block(bb_id);
-      if (loop_->GetLatchBlock() == bb) {
+    // The blocks are visited in function order so that ties are broken the
+    // same way on every run.
+    uint64_t best_benefit = 0;
+    for (BasicBlock& bb : *function_) {
+      if (!loop_->IsInsideLoop(&bb) || loop_->GetLatchBlock() == &bb) {
         continue;
       }
 
-      if (bb->terminator()->IsBranch() &&
-          bb->terminator()->opcode() != SpvOpBranch) {
-        if (IsConditionNonConstantLoopInvariant(bb->terminator())) {
-          switch_block_ = bb;
-          break;
+      if (bb.terminator()->IsBranch() &&
+          bb.terminator()->opcode() != SpvOpBranch) {
+        if (IsConditionNonConstantLoopInvariant(bb.terminator())) {
+          uint64_t benefit = GetUnswitchBenefit(&bb);
+          if (!switch_block_ || benefit > best_benefit) {
+            switch_block_ = &bb;
+            best_benefit = benefit;
+          }
         }
       }
     }
@@ -88,7 +98,29 @@ class LoopUnswitch {
     return switch_block_;
   }
 
-  // Return the iterator to the basic block |bb|.
+  // Returns the number of instructions that unswitching |loop_| on the
+  // condition chosen by |CanUnswitchLoop| adds to the function: one copy of
+  // the loop for each value of the condition but the one kept by the
+  // original loop.
+  uint64_t GetUnswitchCost() {
+    assert(CanUnswitchLoop() &&
+           "Cannot unswitch if there is not constant condition");
+    CFG& cfg = *context_->cfg();
+    uint64_t loop_size = 0;
+    for (uint32_t bb_id : loop_->GetBlocks()) {
+      cfg.block(bb_id)->ForEachInst(
+          [&loop_size](const Instruction*) { ++loop_size; });
+    }
+
+    const Instruction* branch = switch_block_->terminator();
+    uint64_t num_copies = 1;
+    if (branch->opcode() == SpvOpSwitch) {
+      num_copies = (branch->NumInOperands() - 2) / 2;
+    }
+    return loop_size * num_copies;
+  }
+
+  // Return the iterator to the basic block |bb|.  // Return the iterator to the basic block |bb|.
   Function::iterator FindBasicBlockPosition(BasicBlock* bb_to_find) {
     Function::iterator it = function_->FindBlock(bb_to_find->id());
     assert(it != function_->end() && "Basic Block not found");
@@ -370,14 +402,10 @@ class LoopUnswitch {
                 for (uint32_t i = 0; i < num_in_operands; i += 2) {
                   uint32_t pred = phi->GetSingleWordInOperand(i + 1);
                   if (is_from_original_loop(pred)) {
-                    pred = clone_result.value_map_.at(pred);
+                    pred = clone_result.value_map_.Get(pred);
                     uint32_t incoming_value_id = phi->GetSingleWordInOperand(i);
                     // Not all the incoming values are coming from the loop.
-                    ValueMapTy::iterator new_value =
-                        clone_result.value_map_.find(incoming_value_id);
-                    if (new_value != clone_result.value_map_.end()) {
-                      incoming_value_id = new_value->second;
-                    }
+                    clone_result.value_map_.Remap(&incoming_value_id);
                     phi->AddOperand({SPV_OPERAND_TYPE_ID, {incoming_value_id}});
                     phi->AddOperand({SPV_OPERAND_TYPE_ID, {pred}});
                   }
@@ -426,7 +454,6 @@ class LoopUnswitch {
   }
 
  private:
-  using ValueMapTy = std::unordered_map<uint32_t, uint32_t>;
   using BlockMapTy = std::unordered_map<uint32_t, BasicBlock*>;
 
   Function* function_;
@@ -549,6 +576,22 @@ class LoopUnswitch {
     });
   }
 
+  // Returns an estimate of how often the branch ending |bb| executes, which
+  // is how many branches unswitching removes.  The profile count of |bb| is
+  // used when there is one.  Otherwise each loop nested in |loop_| that
+  // contains |bb| is assumed to run |kAssumedTripCount| iterations.
+  uint64_t GetUnswitchBenefit(const BasicBlock* bb) const {
+    uint64_t count = 0;
+    if (context_->GetBlockCount(bb->id(), &count)) return count;
+
+    const size_t depth = loop_desc_[bb->id()]->GetDepth() - loop_->GetDepth();
+    uint64_t benefit = 1;
+    for (size_t i = 0; i < depth && benefit < kMaxEstimatedBenefit; ++i) {
+      benefit *= kAssumedTripCount;
+    }
+    return benefit;
+  }
+
   // Returns true if |insn| is not a constant, but is loop invariant and
   // dynamically uniform.
   bool IsConditionNonConstantLoopInvariant(Instruction* insn) {
@@ -579,7 +622,10 @@ Pass::Status LoopUnswitchPass::Process() {
 
   // Process each function in the module
   for (Function& f : *module) {
-    modified |= ProcessFunction(&f);
+    if (ProcessFunction(&f)) {
+      modified = true;
+      RecordChangedFunction(&f);
+    }
   }
 
   return modified ? Status::SuccessWithChange : Status::SuccessWithoutChange;
@@ -588,6 +634,8 @@ Pass::Status LoopUnswitchPass::Process() {
 bool LoopUnswitchPass::ProcessFunction(Function* f) {
   bool modified = false;
   std::unordered_set<Loop*> processed_loop;
+  // The number of instructions unswitching has added to |f|.
+  uint64_t added_size = 0;
 
   LoopDescriptor& loop_descriptor = *context()->GetLoopDescriptor(f);
 
@@ -599,9 +647,19 @@ bool LoopUnswitchPass::ProcessFunction(Function* f) {
                     TreeDFIterator<Loop>())) {
       if (processed_loop.count(&loop)) continue;
       processed_loop.insert(&loop);
+      // Duplicating a loop the profile shows to be cold only grows the code.
+      if (context()->IsColdBlock(loop.GetHeaderBlock()->id(),
+                                 f->entry()->id())) {
+        continue;
+      }
 
       LoopUnswitch unswitcher(context(), f, &loop, &loop_descriptor);
       while (unswitcher.CanUnswitchLoop()) {
+        // Each unswitch at least doubles the loop, so the budget is what
+        // bounds the growth of loops with many invariant conditions.
+        const uint64_t cost = unswitcher.GetUnswitchCost();
+        if (size_budget_ != 0 && added_size + cost > size_budget_) break;
+        added_size += cost;
         if (!loop.IsLCSSA()) {
           LoopUtils(context(), &loop).MakeLoopClosedSSA();
         }
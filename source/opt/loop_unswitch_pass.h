@@ -15,6 +15,8 @@
 #ifndef SOURCE_OPT_LOOP_UNSWITCH_PASS_H_
 #define SOURCE_OPT_LOOP_UNSWITCH_PASS_H_
 
+#include <cstdint>
+
 #include "source/opt/loop_descriptor.h"
 #include "source/opt/pass.h"
 
@@ -26,6 +28,13 @@ namespace opt {
 // constant within the loop and clones the loop for each branch.
 class LoopUnswitchPass : public Pass {
  public:
+  static const uint32_t kDefaultSizeBudget = 1000;
+
+  // |size_budget| is the number of instructions unswitching may add to each
+  // function.  0 means no limit.
+  explicit LoopUnswitchPass(uint32_t size_budget = kDefaultSizeBudget)
+      : size_budget_(size_budget) {}
+
   const char* name() const override { return "loop-unswitch"; }
 
   // Processes the given |module|. Returns Status::Failure if errors occur when
@@ -33,8 +42,14 @@ class LoopUnswitchPass : public Pass {
   // succesful to indicate whether changes have been made to the modue.
   Pass::Status Process() override;
 
+  bool IsNoOp(IRContext* ctx) const override {
+    return ctx->GetModuleSummary()->NumLoops() == 0;
+  }
+
  private:
   bool ProcessFunction(Function* f);
+
+  uint32_t size_budget_;
 };
 
 }  // namespace opt
@@ -571,7 +571,7 @@ Loop* LoopUtils::CloneLoop(
 
     cloning_result->old_to_new_bb_[old_bb->id()] = new_bb;
     cloning_result->new_to_old_bb_[new_bb->id()] = old_bb;
-    cloning_result->value_map_[old_bb->id()] = new_bb->id();
+    cloning_result->value_map_.Set(old_bb->id(), new_bb->id());
 
     if (loop_->IsInsideLoop(old_bb)) new_loop->AddBasicBlock(new_bb);
 
@@ -581,8 +581,8 @@ Loop* LoopUtils::CloneLoop(
       if (new_inst->HasResultId()) {
         // TODO(1841): Handle id overflow.
         new_inst->SetResultId(context_->TakeNextId());
-        cloning_result->value_map_[old_inst->result_id()] =
-            new_inst->result_id();
+        cloning_result->value_map_.Set(old_inst->result_id(),
+                                       new_inst->result_id());
 
         // Only look at the defs for now, uses are not updated yet.
         def_use_mgr->AnalyzeInstDef(&*new_inst);
@@ -598,10 +598,7 @@ Loop* LoopUtils::CloneLoop(
     for (Instruction& insn : *bb) {
       insn.ForEachInId([cloning_result](uint32_t* old_id) {
         // If the operand is defined in the loop, remap the id.
-        auto id_it = cloning_result->value_map_.find(*old_id);
-        if (id_it != cloning_result->value_map_.end()) {
-          *old_id = id_it->second;
-        }
+        cloning_result->value_map_.Remap(old_id);
       });
       // Only look at what the instruction uses. All defs are register, so all
       // should be fine now.
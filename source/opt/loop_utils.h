@@ -20,6 +20,7 @@
 #include <unordered_map>
 #include <vector>
 
+#include "source/opt/id_remap.h"
 #include "source/opt/ir_context.h"
 #include "source/opt/loop_descriptor.h"
 
@@ -47,7 +48,7 @@ class LoopUtils {
  public:
   // Holds a auxiliary results of the loop cloning procedure.
   struct LoopCloningResult {
-    using ValueMapTy = std::unordered_map<uint32_t, uint32_t>;
+    using ValueMapTy = IdRemap;
     using BlockMapTy = std::unordered_map<uint32_t, BasicBlock*>;
     using PtrMap = std::unordered_map<Instruction*, Instruction*>;
 
@@ -0,0 +1,149 @@
+// Copyright (c) 2019 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "source/opt/memory_load_store_elim_pass.h"
+
+#include <unordered_set>
+#include <vector>
+
+#include "source/opt/ir_builder.h"
+
+namespace spvtools {
+namespace opt {
+namespace {
+
+const uint32_t kLoadMemoryAccessInIdx = 1;
+const uint32_t kStoreObjectInIdx = 1;
+const uint32_t kStoreMemoryAccessInIdx = 2;
+
+}  // namespace
+
+Pass::Status MemoryLoadStoreElimPass::Process() {
+  bool modified = false;
+  for (auto& func : *get_module()) {
+    if (!ShouldProcessFunction(&func)) continue;
+    Status status = ForwardStores(&func);
+    if (status == Status::Failure) return status;
+    bool changed = status == Status::SuccessWithChange;
+    // The memory SSA form is built again, without the forwarded loads.
+    if (EliminateDeadStores(&func)) changed = true;
+    if (changed) {
+      modified = true;
+      RecordChangedFunction(&func);
+    }
+  }
+  return modified ? Status::SuccessWithChange : Status::SuccessWithoutChange;
+}
+
+Pass::Status MemoryLoadStoreElimPass::ForwardStores(Function* func) {
+  MemorySSA memory_ssa(context(), func);
+  std::vector<Instruction*> loads;
+  func->ForEachInst([&memory_ssa, &loads](Instruction* inst) {
+    if (inst->opcode() == SpvOpLoad && memory_ssa.GetAccess(inst)) {
+      loads.push_back(inst);
+    }
+  });
+
+  Status status = Status::SuccessWithoutChange;
+  for (Instruction* load : loads) {
+    MemoryAccess* use = memory_ssa.GetAccess(load);
+    if (IsVolatile(load) || !use->location.exact) continue;
+    MemoryAccess* def = memory_ssa.GetClobberingAccess(use);
+    if (def->kind != MemoryAccess::Kind::kDef || def->IsCall() ||
+        IsVolatile(def->inst) || !def->location.Covers(use->location)) {
+      continue;
+    }
+
+    uint32_t value_id = def->inst->GetSingleWordInOperand(kStoreObjectInIdx);
+    const size_t depth = def->location.indices.size();
+    if (depth == use->location.indices.size()) {
+      if (get_def_use_mgr()->GetDef(value_id)->type_id() != load->type_id()) {
+        continue;
+      }
+    } else {
+      // The load reads a part of the stored composite.
+      InstructionBuilder builder(
+          context(), load,
+          IRContext::kAnalysisDefUse | IRContext::kAnalysisInstrToBlockMapping);
+      Instruction* extract = builder.AddCompositeExtract(
+          load->type_id(), value_id,
+          std::vector<uint32_t>(use->location.indices.begin() + depth,
+                                use->location.indices.end()));
+      if (extract->result_id() == 0) return Status::Failure;
+      value_id = extract->result_id();
+    }
+
+    context()->KillNamesAndDecorates(load);
+    context()->ReplaceAllUsesWith(load->result_id(), value_id);
+    context()->KillInst(load);
+    status = Status::SuccessWithChange;
+  }
+  return status;
+}
+
+bool MemoryLoadStoreElimPass::EliminateDeadStores(Function* func) {
+  MemorySSA memory_ssa(context(), func);
+  std::vector<Instruction*> dead_stores;
+  func->ForEachInst([this, &memory_ssa, &dead_stores](Instruction* inst) {
+    if (inst->opcode() != SpvOpStore) return;
+    MemoryAccess* def = memory_ssa.GetAccess(inst);
+    if (def != nullptr && !IsVolatile(inst) && IsDeadStore(def)) {
+      dead_stores.push_back(inst);
+    }
+  });
+
+  // Removing a dead store cannot make another one read: a store covering a
+  // location read later is not dead.
+  for (Instruction* store : dead_stores) {
+    context()->KillInst(store);
+  }
+  return !dead_stores.empty();
+}
+
+bool MemoryLoadStoreElimPass::IsDeadStore(MemoryAccess* store) const {
+  std::vector<MemoryAccess*> work_list = store->users;
+  std::unordered_set<MemoryAccess*> visited;
+  while (!work_list.empty()) {
+    MemoryAccess* access = work_list.back();
+    work_list.pop_back();
+    if (!visited.insert(access).second) continue;
+    switch (access->kind) {
+      case MemoryAccess::Kind::kUse:
+        if (access->location.MayAlias(store->location)) return false;
+        continue;
+      case MemoryAccess::Kind::kDef:
+        // A function call may read the variable.
+        if (access->IsCall()) return false;
+        if (access->location.Covers(store->location)) continue;
+        break;
+      default:
+        break;
+    }
+    work_list.insert(work_list.end(), access->users.begin(),
+                     access->users.end());
+  }
+  return true;
+}
+
+bool MemoryLoadStoreElimPass::IsVolatile(const Instruction* inst) const {
+  const uint32_t memory_access_idx = inst->opcode() == SpvOpLoad
+                                         ? kLoadMemoryAccessInIdx
+                                         : kStoreMemoryAccessInIdx;
+  return inst->NumInOperands() > memory_access_idx &&
+         (inst->GetSingleWordInOperand(memory_access_idx) &
+          SpvMemoryAccessVolatileMask);
+}
+
+}  // namespace opt
+}  // namespace spvtools
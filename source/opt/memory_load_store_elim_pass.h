@@ -0,0 +1,72 @@
+// Copyright (c) 2019 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef SOURCE_OPT_MEMORY_LOAD_STORE_ELIM_PASS_H_
+#define SOURCE_OPT_MEMORY_LOAD_STORE_ELIM_PASS_H_
+
+#include "source/opt/ir_context.h"
+#include "source/opt/memory_ssa.h"
+#include "source/opt/pass.h"
+
+namespace spvtools {
+namespace opt {
+
+// This pass uses the memory SSA form of the function scope and private
+// variables to remove loads and stores across blocks:
+//
+//  - A load reading the value of a single store, through the same access
+//    chain or through an access chain into the stored composite, is replaced
+//    by the stored value, or by an OpCompositeExtract of it.
+//  - A store whose value is overwritten by other stores before being read on
+//    every path, or is never read, is removed.
+//
+// Only the accesses through access chains with constant indices are
+// precise; the others are assumed to access any part of the variable within
+// the constant indices preceding their first non constant index.
+class MemoryLoadStoreElimPass : public Pass {
+ public:
+  const char* name() const override { return "eliminate-memory-load-store"; }
+  Status Process() override;
+
+  IRContext::Analysis GetPreservedAnalyses() override {
+    return IRContext::kAnalysisDefUse |
+           IRContext::kAnalysisInstrToBlockMapping |
+           IRContext::kAnalysisDecorations | IRContext::kAnalysisCombinators |
+           IRContext::kAnalysisCFG | IRContext::kAnalysisDominatorAnalysis |
+           IRContext::kAnalysisLoopAnalysis | IRContext::kAnalysisNameMap |
+           IRContext::kAnalysisConstants | IRContext::kAnalysisTypes;
+  }
+
+ private:
+  // Replaces the loads of |func| reading the value of a single store by that
+  // value.  Returns the status.
+  Status ForwardStores(Function* func);
+
+  // Removes the stores of |func| whose value is never read.  Returns true if
+  // a store is removed.
+  bool EliminateDeadStores(Function* func);
+
+  // Returns true if the value stored by |store| is never read: every path
+  // from it reaches a store covering its location before any access which
+  // may read the location.
+  bool IsDeadStore(MemoryAccess* store) const;
+
+  // Returns true if the load or store |inst| is volatile.
+  bool IsVolatile(const Instruction* inst) const;
+};
+
+}  // namespace opt
+}  // namespace spvtools
+
+#endif  // SOURCE_OPT_MEMORY_LOAD_STORE_ELIM_PASS_H_
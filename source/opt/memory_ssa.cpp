@@ -0,0 +1,341 @@
+// Copyright (c) 2019 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "source/opt/memory_ssa.h"
+
+#include <algorithm>
+#include <cassert>
+
+#include "source/opt/ir_context.h"
+
+namespace spvtools {
+namespace opt {
+namespace {
+
+const uint32_t kAccessChainBaseInIdx = 0;
+const uint32_t kLoadPtrInIdx = 0;
+const uint32_t kStorePtrInIdx = 0;
+const uint32_t kStoreObjectInIdx = 1;
+const uint32_t kVariableStorageClassInIdx = 0;
+
+// Returns true if the first |size| indices of |a| and |b| are equal.
+bool SamePrefix(const std::vector<uint32_t>& a, const std::vector<uint32_t>& b,
+                size_t size) {
+  return std::equal(a.begin(), a.begin() + size, b.begin());
+}
+
+}  // namespace
+
+bool MemoryLocation::MayAlias(const MemoryLocation& other) const {
+  return var_id == other.var_id &&
+         SamePrefix(indices, other.indices,
+                    std::min(indices.size(), other.indices.size()));
+}
+
+bool MemoryLocation::Covers(const MemoryLocation& other) const {
+  return exact && var_id == other.var_id &&
+         indices.size() <= other.indices.size() &&
+         SamePrefix(indices, other.indices, indices.size());
+}
+
+MemorySSA::MemorySSA(IRContext* context, Function* function)
+    : context_(context) {
+  FindTrackedVariables(function);
+  if (tracked_vars_.empty()) return;
+
+  std::vector<BasicBlock*> blocks;
+  context_->cfg()->ForEachBlockInReversePostOrder(
+      function->entry().get(),
+      [&blocks](BasicBlock* bb) { blocks.push_back(bb); });
+  for (uint32_t var_id : tracked_vars_) {
+    const Instruction* var = context_->get_def_use_mgr()->GetDef(var_id);
+    BuildVariable(var_id,
+                  var->GetSingleWordInOperand(kVariableStorageClassInIdx) ==
+                      SpvStorageClassPrivate,
+                  blocks);
+  }
+}
+
+MemoryAccess* MemorySSA::GetAccess(const Instruction* inst) const {
+  auto access = inst_to_access_.find(inst);
+  return access == inst_to_access_.end() ? nullptr : access->second;
+}
+
+MemoryAccess* MemorySSA::GetClobberingAccess(MemoryAccess* use) {
+  std::unordered_map<MemoryAccess*, MemoryAccess*> phi_results;
+  MemoryAccess* result = Walk(use->defining, use->location, &phi_results);
+  return result == nullptr ? use->defining : result;
+}
+
+bool MemorySSA::GetLocation(uint32_t ptr_id, MemoryLocation* location) const {
+  analysis::DefUseManager* def_use_mgr = context_->get_def_use_mgr();
+  std::vector<const Instruction*> chains;
+  const Instruction* ptr = def_use_mgr->GetDef(ptr_id);
+  while (ptr->opcode() == SpvOpAccessChain ||
+         ptr->opcode() == SpvOpInBoundsAccessChain) {
+    chains.push_back(ptr);
+    ptr =
+        def_use_mgr->GetDef(ptr->GetSingleWordInOperand(kAccessChainBaseInIdx));
+  }
+  if (ptr->opcode() != SpvOpVariable || !IsTracked(ptr->result_id())) {
+    return false;
+  }
+
+  location->var_id = ptr->result_id();
+  location->indices.clear();
+  location->exact = true;
+  analysis::ConstantManager* const_mgr = context_->get_constant_mgr();
+  for (auto chain = chains.rbegin(); chain != chains.rend(); ++chain) {
+    for (uint32_t i = kAccessChainBaseInIdx + 1; i < (*chain)->NumInOperands();
+         ++i) {
+      const analysis::Constant* index = const_mgr->GetConstantFromInst(
+          def_use_mgr->GetDef((*chain)->GetSingleWordInOperand(i)));
+      if (index == nullptr || index->AsIntConstant() == nullptr) {
+        location->exact = false;
+        return true;
+      }
+      location->indices.push_back(
+          static_cast<uint32_t>(index->GetZeroExtendedValue()));
+    }
+  }
+  return true;
+}
+
+void MemorySSA::FindTrackedVariables(Function* function) {
+  for (Instruction& inst : *function->entry()) {
+    if (inst.opcode() == SpvOpVariable && HasOnlySupportedUses(&inst)) {
+      tracked_vars_.insert(inst.result_id());
+    }
+  }
+  for (Instruction& inst : context_->types_values()) {
+    if (inst.opcode() == SpvOpVariable &&
+        inst.GetSingleWordInOperand(kVariableStorageClassInIdx) ==
+            SpvStorageClassPrivate &&
+        HasOnlySupportedUses(&inst)) {
+      tracked_vars_.insert(inst.result_id());
+    }
+  }
+}
+
+bool MemorySSA::HasOnlySupportedUses(Instruction* ptr) const {
+  const uint32_t ptr_id = ptr->result_id();
+  return context_->get_def_use_mgr()->WhileEachUser(
+      ptr, [this, ptr_id](Instruction* user) {
+        switch (user->opcode()) {
+          case SpvOpLoad:
+          case SpvOpName:
+          case SpvOpEntryPoint:
+            return true;
+          case SpvOpStore:
+            return user->GetSingleWordInOperand(kStoreObjectInIdx) != ptr_id;
+          case SpvOpAccessChain:
+          case SpvOpInBoundsAccessChain:
+            return user->GetSingleWordInOperand(kAccessChainBaseInIdx) ==
+                       ptr_id &&
+                   HasOnlySupportedUses(user);
+          default:
+            return IsAnnotationInst(user->opcode());
+        }
+      });
+}
+
+void MemorySSA::BuildVariable(uint32_t var_id, bool is_private,
+                              const std::vector<BasicBlock*>& blocks) {
+  CFG* cfg = context_->cfg();
+  const size_t first_access = accesses_.size();
+  std::unordered_set<uint32_t> reachable;
+  for (BasicBlock* bb : blocks) reachable.insert(bb->id());
+  auto reachable_preds = [cfg, &reachable](BasicBlock* bb) {
+    std::vector<uint32_t> preds;
+    for (uint32_t pred : cfg->preds(bb->id())) {
+      if (reachable.count(pred) &&
+          std::find(preds.begin(), preds.end(), pred) == preds.end()) {
+        preds.push_back(pred);
+      }
+    }
+    return preds;
+  };
+
+  // The blocks are visited in reverse post order, so the only predecessor of
+  // a block is visited before it.  The incoming values of the phis are set
+  // once every block is visited.
+  std::unordered_map<uint32_t, MemoryAccess*> exit_defs;
+  std::vector<MemoryAccess*> phis;
+  for (BasicBlock* bb : blocks) {
+    MemoryAccess* current = nullptr;
+    const std::vector<uint32_t> preds = reachable_preds(bb);
+    if (bb == blocks.front()) {
+      current = NewAccess(MemoryAccess::Kind::kLiveOnEntry, bb);
+    } else if (preds.size() == 1) {
+      assert(exit_defs.count(preds[0]) && "Predecessor not visited.");
+      current = exit_defs[preds[0]];
+    } else {
+      current = NewAccess(MemoryAccess::Kind::kPhi, bb);
+      phis.push_back(current);
+    }
+
+    for (Instruction& inst : *bb) {
+      MemoryAccess* access = nullptr;
+      switch (inst.opcode()) {
+        case SpvOpLoad:
+        case SpvOpStore: {
+          MemoryLocation location;
+          const uint32_t ptr_id = inst.GetSingleWordInOperand(
+              inst.opcode() == SpvOpLoad ? kLoadPtrInIdx : kStorePtrInIdx);
+          if (!GetLocation(ptr_id, &location) || location.var_id != var_id) {
+            break;
+          }
+          access = NewAccess(inst.opcode() == SpvOpLoad
+                                 ? MemoryAccess::Kind::kUse
+                                 : MemoryAccess::Kind::kDef,
+                             bb);
+          access->location = location;
+          inst_to_access_[&inst] = access;
+          break;
+        }
+        case SpvOpFunctionCall:
+        case SpvOpReturn:
+        case SpvOpReturnValue:
+          // The callee, and the code run after returning, may access the
+          // whole private variable.
+          if (!is_private) break;
+          access = NewAccess(inst.opcode() == SpvOpFunctionCall
+                                 ? MemoryAccess::Kind::kDef
+                                 : MemoryAccess::Kind::kUse,
+                             bb);
+          access->location.var_id = var_id;
+          access->location.exact = false;
+          break;
+        default:
+          break;
+      }
+      if (access == nullptr) continue;
+      access->inst = &inst;
+      access->defining = current;
+      if (access->kind == MemoryAccess::Kind::kDef) current = access;
+    }
+    exit_defs[bb->id()] = current;
+  }
+
+  for (MemoryAccess* phi : phis) {
+    for (uint32_t pred : reachable_preds(phi->block)) {
+      phi->incoming.push_back(exit_defs[pred]);
+    }
+  }
+
+  // Remove the phis merging a single value, which may make other phis
+  // trivial.
+  std::unordered_map<MemoryAccess*, MemoryAccess*> replacements;
+  auto resolve = [&replacements](MemoryAccess* access) {
+    auto replacement = replacements.find(access);
+    while (replacement != replacements.end()) {
+      access = replacement->second;
+      replacement = replacements.find(access);
+    }
+    return access;
+  };
+  bool changed = true;
+  while (changed) {
+    changed = false;
+    for (MemoryAccess* phi : phis) {
+      if (replacements.count(phi)) continue;
+      MemoryAccess* same = nullptr;
+      bool trivial = true;
+      for (MemoryAccess* incoming : phi->incoming) {
+        incoming = resolve(incoming);
+        if (incoming == phi || incoming == same) continue;
+        if (same != nullptr) {
+          trivial = false;
+          break;
+        }
+        same = incoming;
+      }
+      if (trivial && same != nullptr) {
+        replacements[phi] = same;
+        changed = true;
+      }
+    }
+  }
+
+  for (size_t i = first_access; i < accesses_.size(); ++i) {
+    MemoryAccess* access = accesses_[i].get();
+    if (replacements.count(access)) continue;
+    if (access->defining != nullptr) {
+      access->defining = resolve(access->defining);
+      access->defining->users.push_back(access);
+    }
+    for (MemoryAccess*& incoming : access->incoming) {
+      incoming = resolve(incoming);
+      std::vector<MemoryAccess*>& users = incoming->users;
+      if (std::find(users.begin(), users.end(), access) == users.end()) {
+        users.push_back(access);
+      }
+    }
+  }
+}
+
+MemoryAccess* MemorySSA::NewAccess(MemoryAccess::Kind kind,
+                                   BasicBlock* block) {
+  accesses_.emplace_back(new MemoryAccess());
+  MemoryAccess* access = accesses_.back().get();
+  access->kind = kind;
+  access->block = block;
+  return access;
+}
+
+MemoryAccess* MemorySSA::Walk(
+    MemoryAccess* access, const MemoryLocation& location,
+    std::unordered_map<MemoryAccess*, MemoryAccess*>* phi_results) {
+  while (true) {
+    switch (access->kind) {
+      case MemoryAccess::Kind::kLiveOnEntry:
+        return access;
+      case MemoryAccess::Kind::kDef:
+        if (access->IsCall() || access->location.MayAlias(location)) {
+          return access;
+        }
+        access = access->defining;
+        break;
+      case MemoryAccess::Kind::kUse:
+        access = access->defining;
+        break;
+      case MemoryAccess::Kind::kPhi: {
+        auto phi_result = phi_results->find(access);
+        if (phi_result != phi_results->end()) return phi_result->second;
+        // A path coming back to a phi being walked does not reach any other
+        // def.
+        (*phi_results)[access] = nullptr;
+        MemoryAccess* result = nullptr;
+        for (MemoryAccess* incoming : access->incoming) {
+          MemoryAccess* incoming_result =
+              Walk(incoming, location, phi_results);
+          if (incoming_result == nullptr || incoming_result == result) {
+            continue;
+          }
+          if (result != nullptr) {
+            result = access;
+            break;
+          }
+          result = incoming_result;
+        }
+        if (result == nullptr) result = access;
+        (*phi_results)[access] = result;
+        return result;
+      }
+    }
+  }
+}
+
+}  // namespace opt
+}  // namespace spvtools
@@ -0,0 +1,154 @@
+// Copyright (c) 2019 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef SOURCE_OPT_MEMORY_SSA_H_
+#define SOURCE_OPT_MEMORY_SSA_H_
+
+#include <memory>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+#include "source/opt/function.h"
+#include "source/opt/instruction.h"
+
+namespace spvtools {
+namespace opt {
+
+class IRContext;
+
+// The memory location accessed through a pointer: a variable, and the
+// constant indices of the access chains leading from it to the pointer.  If
+// some index is not constant, |indices| stops before it and |exact| is false:
+// the location is then somewhere within the one given by |indices|.
+struct MemoryLocation {
+  uint32_t var_id = 0;
+  std::vector<uint32_t> indices;
+  bool exact = true;
+
+  // Returns true if |this| and |other| may overlap.
+  bool MayAlias(const MemoryLocation& other) const;
+
+  // Returns true if |this| contains all of |other|.
+  bool Covers(const MemoryLocation& other) const;
+};
+
+// A node of the memory SSA form of a variable.
+struct MemoryAccess {
+  enum class Kind {
+    // The value of the variable on entry to the function.
+    kLiveOnEntry,
+    // A store to the variable, or a function call which may read and write
+    // it.
+    kDef,
+    // A load from the variable, or a return after which it may be read.
+    kUse,
+    // The merge of the values of the variable at the start of a block.
+    kPhi,
+  };
+
+  Kind kind;
+  // The load, store, call or return, or nullptr.
+  Instruction* inst = nullptr;
+  // The block of |inst|, or of the phi.
+  BasicBlock* block = nullptr;
+  // The location accessed by a load or a store.  A call or a return accesses
+  // the whole variable.
+  MemoryLocation location;
+  // The def, phi or live on entry value that a def or use follows.
+  MemoryAccess* defining = nullptr;
+  // The incoming values of a phi, one per predecessor of |block|.
+  std::vector<MemoryAccess*> incoming;
+  // The defs, uses and phis following this access.
+  std::vector<MemoryAccess*> users;
+
+  bool IsCall() const {
+    return inst != nullptr && inst->opcode() == SpvOpFunctionCall;
+  }
+};
+
+// Memory SSA form of the function scope and private variables of a function
+// whose address is only used by loads, stores and access chains.  Each such
+// variable gets its own chain of memory accesses: its stores and the
+// function calls are defs, its loads and the returns are uses, and phis merge
+// the defs reaching the blocks with several predecessors.  Function calls and
+// returns are only accesses of the private variables.
+//
+// This is used to find the store a load reads, and the stores whose value is
+// never read, across blocks and through access chains with constant indices.
+class MemorySSA {
+ public:
+  MemorySSA(IRContext* context, Function* function);
+
+  // Returns true if the memory accesses of the variable |var_id| are
+  // tracked.
+  bool IsTracked(uint32_t var_id) const {
+    return tracked_vars_.count(var_id) != 0;
+  }
+
+  // Returns the memory access of the load or store |inst| of a tracked
+  // variable, or nullptr.
+  MemoryAccess* GetAccess(const Instruction* inst) const;
+
+  // Returns the access defining the location read by the use |use|, skipping
+  // the defs which do not alias it and the phis whose incoming values are
+  // all defined by the same access.  The result is a def, a phi or a live on
+  // entry value.
+  MemoryAccess* GetClobberingAccess(MemoryAccess* use);
+
+  // Fills |location| with the location the pointer |ptr_id| points to.
+  // Returns false if it does not point into a tracked variable.
+  bool GetLocation(uint32_t ptr_id, MemoryLocation* location) const;
+
+ private:
+  // Adds to |tracked_vars_| the variables of |function| and the private
+  // variables whose uses are all loads, stores and access chains.
+  void FindTrackedVariables(Function* function);
+
+  // Returns true if the uses of the pointer |ptr| are all loads, stores to
+  // it and access chains whose uses are too.
+  bool HasOnlySupportedUses(Instruction* ptr) const;
+
+  // Builds the memory SSA form of the variable |var_id| in |function|.
+  // |blocks| are the reachable blocks in reverse post order.
+  void BuildVariable(uint32_t var_id, bool is_private,
+                     const std::vector<BasicBlock*>& blocks);
+
+  // Returns a new access of kind |kind|.
+  MemoryAccess* NewAccess(MemoryAccess::Kind kind, BasicBlock* block);
+
+  // Walks from |access| up to the access defining |location|, see
+  // GetClobberingAccess.  |phi_results| holds the result of the phis already
+  // walked, which is nullptr while a phi is being walked.  Returns nullptr if
+  // only a phi being walked is found.
+  MemoryAccess* Walk(
+      MemoryAccess* access, const MemoryLocation& location,
+      std::unordered_map<MemoryAccess*, MemoryAccess*>* phi_results);
+
+  IRContext* context_;
+
+  // The variables whose accesses are tracked.
+  std::unordered_set<uint32_t> tracked_vars_;
+
+  // The accesses of the loads and stores.
+  std::unordered_map<const Instruction*, MemoryAccess*> inst_to_access_;
+
+  // All the accesses.
+  std::vector<std::unique_ptr<MemoryAccess>> accesses_;
+};
+
+}  // namespace opt
+}  // namespace spvtools
+
+#endif  // SOURCE_OPT_MEMORY_SSA_H_
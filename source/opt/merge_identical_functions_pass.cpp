@@ -0,0 +1,180 @@
+// Copyright (c) 2020 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "source/opt/merge_identical_functions_pass.h"
+
+#include <functional>
+#include <unordered_map>
+#include <unordered_set>
+#include <utility>
+
+#include "source/opt/eliminate_dead_functions_util.h"
+#include "source/operand.h"
+#include "source/util/hash_combine.h"
+
+namespace spvtools {
+namespace opt {
+namespace {
+
+// Marks the ids in a canonical form as defined outside or inside the
+// function.
+const uint32_t kGlobalId = 0;
+const uint32_t kLocalId = 1;
+
+}  // namespace
+
+Pass::Status MergeIdenticalFunctionsPass::Process() {
+  // Merging functions can make their callers identical, so this is repeated
+  // until no function is removed.
+  bool modified = false;
+  while (MergeFunctions()) {
+    modified = true;
+  }
+  return modified ? Status::SuccessWithChange : Status::SuccessWithoutChange;
+}
+
+bool MergeIdenticalFunctionsPass::MergeFunctions() {
+  std::vector<Function*> functions;
+  std::vector<std::vector<uint32_t>> forms;
+  std::vector<size_t> hashes;
+  std::unordered_map<size_t, std::vector<size_t>> functions_by_hash;
+  for (auto& func : *get_module()) {
+    // Function declarations are left alone.
+    if (func.begin() == func.end()) continue;
+
+    std::vector<uint32_t> form = GetCanonicalForm(&func);
+    size_t hash = form.size();
+    for (uint32_t word : form) {
+      utils::HashCombine(std::hash<uint32_t>()(word), &hash);
+    }
+    functions_by_hash[hash].push_back(functions.size());
+    functions.push_back(&func);
+    forms.push_back(std::move(form));
+    hashes.push_back(hash);
+  }
+
+  // Maps each function to remove to the function its calls are redirected to.
+  std::unordered_map<uint32_t, uint32_t> replacements;
+  std::vector<bool> grouped(functions.size(), false);
+  for (size_t i = 0; i < functions.size(); ++i) {
+    if (grouped[i]) continue;
+
+    std::vector<size_t> group;
+    for (size_t j : functions_by_hash[hashes[i]]) {
+      if (j >= i && !grouped[j] && forms[j] == forms[i]) {
+        group.push_back(j);
+        grouped[j] = true;
+      }
+    }
+    if (group.size() < 2) continue;
+
+    // Keep a function that cannot be removed if there is one, and the first
+    // function otherwise.
+    std::vector<bool> removable(group.size());
+    size_t kept = 0;
+    for (size_t k = group.size(); k-- > 0;) {
+      removable[k] = IsRemovable(functions[group[k]]);
+      if (!removable[k]) kept = k;
+    }
+    const uint32_t kept_id = functions[group[kept]]->result_id();
+    for (size_t k = 0; k < group.size(); ++k) {
+      if (k != kept && removable[k]) {
+        replacements[functions[group[k]]->result_id()] = kept_id;
+      }
+    }
+  }
+
+  if (replacements.empty()) return false;
+
+  // The names of the removed functions must not be moved to the kept ones.
+  for (const auto& removed_and_kept : replacements) {
+    context()->KillNamesAndDecorates(removed_and_kept.first);
+  }
+  context()->ReplaceAllUsesWith(replacements);
+  for (auto func_iter = get_module()->begin();
+       func_iter != get_module()->end();) {
+    if (replacements.count(func_iter->result_id())) {
+      func_iter =
+          eliminatedeadfunctionsutil::EliminateFunction(context(), &func_iter);
+    } else {
+      ++func_iter;
+    }
+  }
+  return true;
+}
+
+std::vector<uint32_t> MergeIdenticalFunctionsPass::GetCanonicalForm(
+    Function* func) {
+  std::unordered_set<uint32_t> local_ids;
+  func->ForEachInst([&local_ids](Instruction* inst) {
+    if (inst->HasResultId()) local_ids.insert(inst->result_id());
+  });
+
+  std::vector<uint32_t> form;
+  std::unordered_map<uint32_t, uint32_t> local_numbers;
+  std::vector<uint32_t> ordered_local_ids;
+  auto append_id = [&form, &local_ids, &local_numbers,
+                    &ordered_local_ids](uint32_t id) {
+    if (local_ids.count(id) == 0) {
+      form.push_back(kGlobalId);
+      form.push_back(id);
+      return;
+    }
+    auto number = local_numbers.insert(
+        {id, static_cast<uint32_t>(local_numbers.size())});
+    if (number.second) ordered_local_ids.push_back(id);
+    form.push_back(kLocalId);
+    form.push_back(number.first->second);
+  };
+
+  func->ForEachInst([&form, &append_id](Instruction* inst) {
+    form.push_back(inst->opcode());
+    form.push_back(inst->NumOperands());
+    for (uint32_t i = 0; i < inst->NumOperands(); ++i) {
+      const Operand& operand = inst->GetOperand(i);
+      if (spvIsIdType(operand.type)) {
+        append_id(operand.words[0]);
+      } else {
+        form.push_back(static_cast<uint32_t>(operand.words.size()));
+        form.insert(form.end(), operand.words.begin(), operand.words.end());
+      }
+    }
+  });
+
+  // The decorations are part of the function, but the names are not.
+  for (uint32_t id : ordered_local_ids) {
+    for (const Instruction* decoration :
+         get_decoration_mgr()->GetDecorationsFor(id, false)) {
+      form.push_back(local_numbers[id]);
+      form.push_back(decoration->opcode());
+      for (uint32_t i = 1; i < decoration->NumInOperands(); ++i) {
+        const Operand& operand = decoration->GetInOperand(i);
+        form.push_back(static_cast<uint32_t>(operand.words.size()));
+        form.insert(form.end(), operand.words.begin(), operand.words.end());
+      }
+    }
+  }
+  return form;
+}
+
+bool MergeIdenticalFunctionsPass::IsRemovable(const Function* func) {
+  return get_def_use_mgr()->WhileEachUse(
+      func->result_id(), [](Instruction* user, uint32_t index) {
+        return (user->opcode() == SpvOpFunctionCall && index == 2) ||
+               user->opcode() == SpvOpName;
+      });
+}
+
+}  // namespace opt
+}  // namespace spvtools
@@ -0,0 +1,60 @@
+// Copyright (c) 2020 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef SOURCE_OPT_MERGE_IDENTICAL_FUNCTIONS_PASS_H_
+#define SOURCE_OPT_MERGE_IDENTICAL_FUNCTIONS_PASS_H_
+
+#include <cstdint>
+#include <vector>
+
+#include "source/opt/function.h"
+#include "source/opt/ir_context.h"
+#include "source/opt/pass.h"
+
+namespace spvtools {
+namespace opt {
+
+// See optimizer.hpp for documentation.
+class MergeIdenticalFunctionsPass : public Pass {
+ public:
+  const char* name() const override { return "merge-identical-functions"; }
+  Status Process() override;
+
+  IRContext::Analysis GetPreservedAnalyses() override {
+    return IRContext::kAnalysisDefUse | IRContext::kAnalysisConstants |
+           IRContext::kAnalysisTypes;
+  }
+
+ private:
+  // Returns the canonical form of |func|: the words of its instructions and
+  // of the decorations of the ids it defines, in which each id defined in
+  // |func| is replaced by the order of its first appearance.  Two functions
+  // have the same canonical form if and only if they are the same up to the
+  // renaming of the ids they define.  The debug line instructions and the
+  // names are left out.
+  std::vector<uint32_t> GetCanonicalForm(Function* func);
+
+  // Returns true if the only uses of |func| are calls and names, so that the
+  // calls can be redirected to another function and |func| removed.
+  bool IsRemovable(const Function* func);
+
+  // Merges each group of identical functions into one of them.  Returns true
+  // if any function was removed.
+  bool MergeFunctions();
+};
+
+}  // namespace opt
+}  // namespace spvtools
+
+#endif  // SOURCE_OPT_MERGE_IDENTICAL_FUNCTIONS_PASS_H_
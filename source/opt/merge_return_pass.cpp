@@ -14,6 +14,7 @@
 
 #include "source/opt/merge_return_pass.h"
 
+#include <iterator>
 #include <list>
 #include <memory>
 #include <utility>
@@ -49,6 +50,9 @@ Pass::Status MergeReturnPass::Process() {
     return_flag_ = nullptr;
     return_value_ = nullptr;
     final_return_block_ = nullptr;
+    original_dominator_.clear();
+    new_edges_.clear();
+    return_blocks_.clear();
 
     if (is_shader) {
       if (!ProcessStructured(function, return_blocks)) {
@@ -57,6 +61,7 @@ Pass::Status MergeReturnPass::Process() {
     } else {
       MergeReturnBlocks(function, return_blocks);
     }
+    RecordChangedFunction(function);
     return true;
   };
 
@@ -133,6 +138,15 @@ bool MergeReturnPass::ProcessStructured(
     GenerateState(block);
   }
 
+  // The original return blocks, by id, to predicate their successors.
+  utils::BitVector is_return_block;
+  for (BasicBlock* block : return_blocks) is_return_block.Set(block->id());
+
+  order_positions_.clear();
+  for (auto iter = order.begin(); iter != order.end(); ++iter) {
+    order_positions_[*iter] = iter;
+  }
+
   state_.clear();
   state_.emplace_back(nullptr, nullptr);
   std::unordered_set<BasicBlock*> predicated;
@@ -147,9 +161,10 @@ bool MergeReturnPass::ProcessStructured(
       state_.pop_back();
     }
 
-    // Predicate successors of the original return blocks as necessary.
-    if (std::find(return_blocks.begin(), return_blocks.end(), block) !=
-        return_blocks.end()) {
+    // Predicate successors of the original return blocks as necessary.  The
+    // blocks split off a return block take new ids, so only the original
+    // block is found here.
+    if (is_return_block.Get(blockId)) {
       if (!PredicateBlocks(block, &predicated, &order)) {
         return false;
       }
@@ -301,7 +316,7 @@ void MergeReturnPass::CreatePhiNodesForInst(BasicBlock* merge_block,
         IRContext::kAnalysisDefUse | IRContext::kAnalysisInstrToBlockMapping);
     uint32_t undef_id = Type2Undef(inst.type_id());
     std::vector<uint32_t> phi_operands;
-    const std::set<uint32_t>& new_edges = new_edges_[merge_block];
+    const std::unordered_set<uint32_t>& new_edges = new_edges_[merge_block];
 
     // Add the OpPhi operands. If the predecessor is a return block use undef,
     // otherwise use |inst|'s id.
@@ -352,7 +367,6 @@ bool MergeReturnPass::PredicateBlocks(
          "unconditional branch.");
 
   auto state = state_.rbegin();
-  std::unordered_set<BasicBlock*> seen;
   if (block->id() == state->CurrentMergeId()) {
     state++;
   } else if (block->id() == state->BreakMergeId()) {
@@ -720,10 +734,10 @@ void MergeReturnPass::RecordImmediateDominators(Function* function) {
 void MergeReturnPass::InsertAfterElement(BasicBlock* element,
                                          BasicBlock* new_element,
                                          std::list<BasicBlock*>* list) {
-  auto pos = std::find(list->begin(), list->end(), element);
-  assert(pos != list->end());
-  ++pos;
-  list->insert(pos, new_element);
+  auto pos = order_positions_.find(element);
+  assert(pos != order_positions_.end());
+  auto new_pos = list->insert(std::next(pos->second), new_element);
+  order_positions_[new_element] = new_pos;
 }
 
 void MergeReturnPass::AddDummySwitchAroundFunction() {
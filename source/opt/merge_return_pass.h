@@ -15,6 +15,7 @@
 #ifndef SOURCE_OPT_MERGE_RETURN_PASS_H_
 #define SOURCE_OPT_MERGE_RETURN_PASS_H_
 
+#include <list>
 #include <unordered_map>
 #include <unordered_set>
 #include <vector>
@@ -268,8 +269,9 @@ class MergeReturnPass : public MemPass {
 
   StructuredControlState& CurrentState() { return state_.back(); }
 
-  // Inserts |new_element| into |list| after the first occurrence of |element|.
-  // |element| must be in |list| at least once.
+  // Inserts |new_element| into |list| after |element|, which must be in
+  // |list|.  |order_positions_| must hold the positions of the elements of
+  // |list|, and is updated.
   void InsertAfterElement(BasicBlock* element, BasicBlock* new_element,
                           std::list<BasicBlock*>* list);
 
@@ -323,7 +325,13 @@ class MergeReturnPass : public MemPass {
 
   // A map from a basic block, bb, to the set of basic blocks which represent
   // the new edges that reach |bb|.
-  std::unordered_map<BasicBlock*, std::set<uint32_t>> new_edges_;
+  std::unordered_map<BasicBlock*, std::unordered_set<uint32_t>> new_edges_;
+
+  // The position of each block in the structured order the blocks are
+  // predicated in, so that the blocks split off can be inserted after the
+  // block they come from without searching the order.
+  std::unordered_map<BasicBlock*, std::list<BasicBlock*>::iterator>
+      order_positions_;
 
   // Contains all return blocks that are merged. This is set is populated while
   // processing structured blocks and used to properly construct OpPhi
@@ -16,14 +16,23 @@
 
 #include <algorithm>
 #include <cstring>
+#include <functional>
 #include <ostream>
 
 #include "source/operand.h"
 #include "source/opt/ir_context.h"
 #include "source/opt/reflect.h"
+#include "source/spirv_constant.h"
+#include "source/val/validate.h"
 
 namespace spvtools {
 namespace opt {
+namespace {
+
+// The number of words in the header of a module.
+const size_t kHeaderWords = 5;
+
+}  // namespace
 
 uint32_t Module::TakeNextIdBound() {
   if (context()) {
@@ -83,78 +92,91 @@ void Module::AddGlobalValue(SpvOp opcode, uint32_t result_id,
   AddGlobalValue(std::move(newGlobal));
 }
 
-void Module::ForEachInst(const std::function<void(Instruction*)>& f,
-                         bool run_on_debug_line_insts) {
-#define DELEGATE(list) list.ForEachInst(f, run_on_debug_line_insts)
-  DELEGATE(capabilities_);
-  DELEGATE(extensions_);
-  DELEGATE(ext_inst_imports_);
-  if (memory_model_) memory_model_->ForEachInst(f, run_on_debug_line_insts);
-  DELEGATE(entry_points_);
-  DELEGATE(execution_modes_);
-  DELEGATE(debugs1_);
-  DELEGATE(debugs2_);
-  DELEGATE(debugs3_);
-  DELEGATE(ext_inst_debuginfo_);
-  DELEGATE(annotations_);
-  DELEGATE(types_values_);
-  for (auto& i : functions_) i->ForEachInst(f, run_on_debug_line_insts);
-#undef DELEGATE
-}
-
-void Module::ForEachInst(const std::function<void(const Instruction*)>& f,
-                         bool run_on_debug_line_insts) const {
-#define DELEGATE(i) i.ForEachInst(f, run_on_debug_line_insts)
-  for (auto& i : capabilities_) DELEGATE(i);
-  for (auto& i : extensions_) DELEGATE(i);
-  for (auto& i : ext_inst_imports_) DELEGATE(i);
-  if (memory_model_)
-    static_cast<const Instruction*>(memory_model_.get())
-        ->ForEachInst(f, run_on_debug_line_insts);
-  for (auto& i : entry_points_) DELEGATE(i);
-  for (auto& i : execution_modes_) DELEGATE(i);
-  for (auto& i : debugs1_) DELEGATE(i);
-  for (auto& i : debugs2_) DELEGATE(i);
-  for (auto& i : debugs3_) DELEGATE(i);
-  for (auto& i : annotations_) DELEGATE(i);
-  for (auto& i : types_values_) DELEGATE(i);
-  for (auto& i : ext_inst_debuginfo_) DELEGATE(i);
-  for (auto& i : functions_) {
-    static_cast<const Function*>(i.get())->ForEachInst(f,
-                                                       run_on_debug_line_insts);
-  }
-  if (run_on_debug_line_insts) {
-    for (auto& i : trailing_dbg_line_info_) DELEGATE(i);
-  }
-#undef DELEGATE
+void Module::ToBinary(std::vector<uint32_t>* binary, bool skip_nop) const {
+  // Size the binary first, so that it is allocated once and the instructions
+  // are written straight into it.
+  const size_t size = binary->size();
+  binary->resize(size + BinarySize(skip_nop));
+  ToBinary(binary->data() + size, skip_nop);
 }
 
-void Module::ToBinary(std::vector<uint32_t>* binary, bool skip_nop) const {
-  binary->push_back(header_.magic_number);
-  binary->push_back(header_.version);
+size_t Module::BinarySize(bool skip_nop) const {
+  size_t size = kHeaderWords;
+  // The debug line instructions are written from the debug line table rather
+  // than visited as instructions.
+  ForEachInst([&size, skip_nop](const Instruction* i) {
+    size += i->NumDbgLineWords();
+    if (!(skip_nop && i->IsNop())) size += 1 + i->NumOperandWords();
+  });
+  return size;
+}
+
+void Module::ToBinary(uint32_t* words, bool skip_nop) const {
+  words[0] = header_.magic_number;
+  words[1] = header_.version;
   // TODO(antiagainst): should we change the generator number?
-  binary->push_back(header_.generator);
-  binary->push_back(header_.bound);
-  binary->push_back(header_.reserved);
+  words[2] = header_.generator;
+  words[3] = header_.bound;
+  words[4] = header_.reserved;
+  words += kHeaderWords;
+
+  ForEachInst([&words, skip_nop](const Instruction* i) {
+    words = i->DbgLineInstsToBinary(words);
+    if (!(skip_nop && i->IsNop())) {
+      words = i->ToBinaryWithoutAttachedDebugInsts(words);
+    }
+  });
+}
 
-  auto write_inst = [binary, skip_nop](const Instruction* i) {
-    if (!(skip_nop && i->IsNop())) i->ToBinaryWithoutAttachedDebugInsts(binary);
-  };
-  ForEachInst(write_inst, true);
+bool Module::ToBinary(
+    const std::function<bool(const uint32_t* words, size_t num_words)>& write,
+    bool skip_nop, size_t chunk_words) const {
+  std::vector<uint32_t> chunk = {header_.magic_number, header_.version,
+                                 header_.generator, header_.bound,
+                                 header_.reserved};
+  chunk.reserve(std::max(chunk_words, chunk.size()));
+  bool keep_writing = true;
+  ForEachInst(
+      [&chunk, &write, &keep_writing, skip_nop,
+       chunk_words](const Instruction* i) {
+        if (!keep_writing) return;
+        const bool skip = skip_nop && i->IsNop();
+        const size_t num_words =
+            i->NumDbgLineWords() + (skip ? 0 : 1 + i->NumOperandWords());
+        if (num_words == 0) return;
+        if (!chunk.empty() && chunk.size() + num_words > chunk_words) {
+          keep_writing = write(chunk.data(), chunk.size());
+          chunk.clear();
+          if (!keep_writing) return;
+        }
+        const size_t size = chunk.size();
+        chunk.resize(size + num_words);
+        uint32_t* words = i->DbgLineInstsToBinary(chunk.data() + size);
+        if (!skip) i->ToBinaryWithoutAttachedDebugInsts(words);
+      });
+  if (keep_writing && !chunk.empty()) {
+    keep_writing = write(chunk.data(), chunk.size());
+  }
+  return keep_writing;
 }
 
 uint32_t Module::ComputeIdBound() const {
   uint32_t highest = 0;
 
-  ForEachInst(
-      [&highest](const Instruction* inst) {
-        for (const auto& operand : *inst) {
-          if (spvIsIdType(operand.type)) {
-            highest = std::max(highest, operand.words[0]);
-          }
-        }
-      },
-      true /* scan debug line insts as well */);
+  const DebugLineTable* lines = context()->debug_line_table();
+  ForEachInst([&highest, lines](const Instruction* inst) {
+    for (const auto& operand : *inst) {
+      if (spvIsIdType(operand.type)) {
+        highest = std::max(highest, operand.words[0]);
+      }
+    }
+    // Scan the debug line insts as well.
+    const uint32_t index = inst->dbg_lines();
+    for (const DebugLine* line = lines->begin(index); line != lines->end(index);
+         ++line) {
+      highest = std::max(highest, line->file_id);
+    }
+  });
 
   return highest + 1;
 }
@@ -187,5 +209,47 @@ std::ostream& operator<<(std::ostream& str, const Module& module) {
   return str;
 }
 
+val::ModuleInstructions GetModuleInstructions(const Module& module) {
+  val::ModuleInstructions instructions;
+  const ModuleHeader& header = module.header();
+  instructions.header[SPV_INDEX_MAGIC_NUMBER] = header.magic_number;
+  instructions.header[SPV_INDEX_VERSION_NUMBER] = header.version;
+  instructions.header[SPV_INDEX_GENERATOR_NUMBER] = header.generator;
+  instructions.header[SPV_INDEX_BOUND] = header.bound;
+  instructions.header[SPV_INDEX_SCHEMA] = header.reserved;
+  instructions.num_instructions = 0;
+  instructions.num_words = 0;
+  instructions.num_functions = 0;
+  module.ForEachInst(
+      [&instructions](const Instruction* inst) {
+        if (inst->IsNop()) return;
+        ++instructions.num_instructions;
+        instructions.num_words += 1 + inst->NumOperandWords();
+        if (inst->opcode() == SpvOpFunction) ++instructions.num_functions;
+      },
+      true);
+  instructions.for_each_instruction =
+      [&module](
+          const std::function<spv_result_t(const uint32_t*, size_t)>& parse) {
+        spv_result_t result = SPV_SUCCESS;
+        std::vector<uint32_t> words;
+        module.ForEachInst(
+            [&parse, &result, &words](const Instruction* inst) {
+              if (result != SPV_SUCCESS || inst->IsNop()) return;
+              words.clear();
+              inst->ToBinaryWithoutAttachedDebugInsts(&words);
+              result = parse(words.data(), words.size());
+            },
+            true);
+        return result;
+      };
+  instructions.to_binary = [&module]() {
+    std::vector<uint32_t> binary;
+    module.ToBinary(&binary, true);
+    return binary;
+  };
+  return instructions;
+}
+
 }  // namespace opt
 }  // namespace spvtools
@@ -25,6 +25,10 @@
 #include "source/opt/iterator.h"
 
 namespace spvtools {
+namespace val {
+struct ModuleInstructions;
+}  // namespace val
+
 namespace opt {
 
 class IRContext;
@@ -53,6 +57,9 @@ class Module {
   // Sets the header to the given |header|.
   void SetHeader(const ModuleHeader& header) { header_ = header; }
 
+  // Returns the header.
+  const ModuleHeader& header() const { return header_; }
+
   // Sets the Id bound.  The Id bound cannot be set to 0.
   void SetIdBound(uint32_t bound) {
     assert(bound != 0);
@@ -231,16 +238,32 @@ class Module {
   inline const_iterator cend() const;
 
   // Invokes function |f| on all instructions in this module, and optionally on
-  // the debug line instructions that precede them.
-  void ForEachInst(const std::function<void(Instruction*)>& f,
-                   bool run_on_debug_line_insts = false);
-  void ForEachInst(const std::function<void(const Instruction*)>& f,
-                   bool run_on_debug_line_insts = false) const;
+  // the debug line instructions that precede them.  |f| may be any callable
+  // object, and is inlined into the traversal.
+  template <typename Func>
+  inline void ForEachInst(const Func& f, bool run_on_debug_line_insts = false);
+  template <typename Func>
+  inline void ForEachInst(const Func& f,
+                          bool run_on_debug_line_insts = false) const;
 
   // Pushes the binary segments for this instruction into the back of *|binary|.
   // If |skip_nop| is true and this is a OpNop, do nothing.
   void ToBinary(std::vector<uint32_t>* binary, bool skip_nop) const;
 
+  // Returns the number of words written by |ToBinary| for the same |skip_nop|.
+  size_t BinarySize(bool skip_nop) const;
+
+  // Writes the binary of the module starting at |words|, which must have room
+  // for |BinarySize(skip_nop)| words.
+  void ToBinary(uint32_t* words, bool skip_nop) const;
+
+  // Passes the binary of the module to |write| in order, in chunks of at most
+  // |chunk_words| words, or a single instruction if it is larger.  Stops and
+  // returns false as soon as |write| returns false.
+  bool ToBinary(const std::function<bool(const uint32_t* words,
+                                         size_t num_words)>& write,
+                bool skip_nop, size_t chunk_words = 4096) const;
+
   // Returns 1 more than the maximum Id value mentioned in the module.
   uint32_t ComputeIdBound() const;
 
@@ -300,6 +323,11 @@ class Module {
 // Pretty-prints |module| to |str|. Returns |str|.
 std::ostream& operator<<(std::ostream& str, const Module& module);
 
+// Returns the instructions of |module| other than OpNop, in the form the
+// validator accepts without the binary of the module.  The result refers to
+// |module|, and must not be used after it is changed.
+val::ModuleInstructions GetModuleInstructions(const Module& module);
+
 inline void Module::AddCapability(std::unique_ptr<Instruction> c) {
   capabilities_.push_back(std::move(c));
 }
@@ -514,6 +542,46 @@ inline Module::const_iterator Module::cend() const {
   return const_iterator(&functions_, functions_.cend());
 }
 
+template <typename Func>
+inline void Module::ForEachInst(const Func& f, bool run_on_debug_line_insts) {
+  capabilities_.ForEachInst(f, run_on_debug_line_insts);
+  extensions_.ForEachInst(f, run_on_debug_line_insts);
+  ext_inst_imports_.ForEachInst(f, run_on_debug_line_insts);
+  if (memory_model_) memory_model_->ForEachInst(f, run_on_debug_line_insts);
+  entry_points_.ForEachInst(f, run_on_debug_line_insts);
+  execution_modes_.ForEachInst(f, run_on_debug_line_insts);
+  debugs1_.ForEachInst(f, run_on_debug_line_insts);
+  debugs2_.ForEachInst(f, run_on_debug_line_insts);
+  debugs3_.ForEachInst(f, run_on_debug_line_insts);
+  ext_inst_debuginfo_.ForEachInst(f, run_on_debug_line_insts);
+  annotations_.ForEachInst(f, run_on_debug_line_insts);
+  types_values_.ForEachInst(f, run_on_debug_line_insts);
+  for (auto& i : functions_) i->ForEachInst(f, run_on_debug_line_insts);
+}
+
+template <typename Func>
+inline void Module::ForEachInst(const Func& f,
+                                bool run_on_debug_line_insts) const {
+  for (auto& i : capabilities_) i.ForEachInst(f, run_on_debug_line_insts);
+  for (auto& i : extensions_) i.ForEachInst(f, run_on_debug_line_insts);
+  for (auto& i : ext_inst_imports_) i.ForEachInst(f, run_on_debug_line_insts);
+  if (memory_model_)
+    static_cast<const Instruction*>(memory_model_.get())
+        ->ForEachInst(f, run_on_debug_line_insts);
+  for (auto& i : entry_points_) i.ForEachInst(f, run_on_debug_line_insts);
+  for (auto& i : execution_modes_) i.ForEachInst(f, run_on_debug_line_insts);
+  for (auto& i : debugs1_) i.ForEachInst(f, run_on_debug_line_insts);
+  for (auto& i : debugs2_) i.ForEachInst(f, run_on_debug_line_insts);
+  for (auto& i : debugs3_) i.ForEachInst(f, run_on_debug_line_insts);
+  for (auto& i : annotations_) i.ForEachInst(f, run_on_debug_line_insts);
+  for (auto& i : types_values_) i.ForEachInst(f, run_on_debug_line_insts);
+  for (auto& i : ext_inst_debuginfo_) i.ForEachInst(f, run_on_debug_line_insts);
+  for (auto& i : functions_) {
+    static_cast<const Function*>(i.get())->ForEachInst(f,
+                                                       run_on_debug_line_insts);
+  }
+}
+
 }  // namespace opt
 }  // namespace spvtools
 
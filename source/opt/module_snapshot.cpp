@@ -0,0 +1,153 @@
+// Copyright (c) 2019 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "source/opt/module_snapshot.h"
+
+#include <unordered_map>
+
+#include "source/ext_inst.h"
+#include "source/opt/ir_loader.h"
+#include "source/util/make_unique.h"
+
+namespace spvtools {
+namespace opt {
+namespace {
+
+// Appends the encoding of |inst| and of the debug line instructions preceding
+// it to |insts|.
+void Save(const Instruction& inst, std::vector<CompactInstruction>* insts) {
+  inst.ForEachInst(
+      [insts](const Instruction* i) { insts->emplace_back(*i); },
+      /* run_on_debug_line_insts = */ true);
+}
+
+template <typename Range>
+void SaveAll(const Range& range, std::vector<CompactInstruction>* insts) {
+  for (const Instruction& inst : range) Save(inst, insts);
+}
+
+// Feeds saved instructions to an |IrLoader|, as the binary parser would.
+class Loader {
+ public:
+  Loader(const MessageConsumer& consumer, Module* module)
+      : loader_(consumer, module) {}
+
+  IrLoader* loader() { return &loader_; }
+
+  // Loads |insts|.  Returns false if the loader rejects one of them.
+  bool Load(const std::vector<CompactInstruction>& insts) {
+    for (const CompactInstruction& inst : insts) {
+      spv_parsed_instruction_t parsed = inst.ToParsedInstruction(&operands_);
+      if (inst.opcode() == SpvOpExtInstImport) {
+        uint32_t num_words = 0;
+        const uint32_t* name = inst.GetInOperandWords(0, &num_words);
+        ext_inst_types_[inst.result_id()] =
+            spvExtInstImportTypeGet(reinterpret_cast<const char*>(name));
+      } else if (inst.opcode() == SpvOpExtInst) {
+        parsed.ext_inst_type = ext_inst_types_[inst.GetSingleWordInOperand(0)];
+      }
+      if (!loader_.AddInstruction(&parsed)) return false;
+    }
+    return true;
+  }
+
+ private:
+  IrLoader loader_;
+  std::vector<spv_parsed_operand_t> operands_;
+  // The extended instruction set imported by each OpExtInstImport.
+  std::unordered_map<uint32_t, spv_ext_inst_type_t> ext_inst_types_;
+};
+
+}  // namespace
+
+ModuleSnapshot::ModuleSnapshot(const Module& module) {
+  SaveGlobals(module);
+  for (const Function& function : module) {
+    functions_.emplace_back(function.result_id(), SaveFunction(function));
+  }
+}
+
+ModuleSnapshot::ModuleSnapshot(
+    const Module& module, const ModuleSnapshot& base,
+    const std::unordered_set<uint32_t>& changed_functions) {
+  SaveGlobals(module);
+  std::unordered_map<uint32_t, std::shared_ptr<const Instructions>>
+      base_functions(base.functions_.begin(), base.functions_.end());
+  for (const Function& function : module) {
+    const uint32_t id = function.result_id();
+    auto base_function = base_functions.find(id);
+    if (base_function != base_functions.end() &&
+        changed_functions.count(id) == 0) {
+      functions_.emplace_back(id, base_function->second);
+    } else {
+      functions_.emplace_back(id, SaveFunction(function));
+    }
+  }
+}
+
+std::unique_ptr<IRContext> ModuleSnapshot::Restore(
+    spv_target_env env, MessageConsumer consumer) const {
+  auto context = MakeUnique<IRContext>(env, consumer);
+  Loader loader(consumer, context->module());
+  loader.loader()->SetModuleHeader(header_.magic_number, header_.version,
+                                   header_.generator, header_.bound,
+                                   header_.reserved);
+  if (!loader.Load(globals_)) return nullptr;
+  for (const auto& function : functions_) {
+    if (!loader.Load(*function.second)) return nullptr;
+  }
+  if (!loader.Load(trailing_lines_)) return nullptr;
+  loader.loader()->EndModule();
+  return context;
+}
+
+bool ModuleSnapshot::SharesFunctionWith(size_t index,
+                                        const ModuleSnapshot& other) const {
+  for (const auto& function : other.functions_) {
+    if (function.second == functions_[index].second) return true;
+  }
+  return false;
+}
+
+std::shared_ptr<const ModuleSnapshot::Instructions>
+ModuleSnapshot::SaveFunction(const Function& function) {
+  auto insts = std::make_shared<Instructions>();
+  function.ForEachInst(
+      [&insts](const Instruction* inst) { insts->emplace_back(*inst); },
+      /* run_on_debug_line_insts = */ true);
+  return insts;
+}
+
+void ModuleSnapshot::SaveGlobals(const Module& module) {
+  header_ = module.header();
+  // The same order as |Module::ToBinary|.
+  SaveAll(module.capabilities(), &globals_);
+  SaveAll(module.extensions(), &globals_);
+  SaveAll(module.ext_inst_imports(), &globals_);
+  if (module.GetMemoryModel()) Save(*module.GetMemoryModel(), &globals_);
+  SaveAll(module.entry_points(), &globals_);
+  SaveAll(module.execution_modes(), &globals_);
+  SaveAll(module.debugs1(), &globals_);
+  SaveAll(module.debugs2(), &globals_);
+  SaveAll(module.debugs3(), &globals_);
+  SaveAll(module.annotations(), &globals_);
+  SaveAll(module.types_values(), &globals_);
+  SaveAll(module.ext_inst_debuginfo(), &globals_);
+  for (const Instruction& line : module.trailing_dbg_line_info()) {
+    trailing_lines_.emplace_back(line);
+  }
+}
+
+}  // namespace opt
+}  // namespace spvtools
@@ -0,0 +1,92 @@
+// Copyright (c) 2019 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef SOURCE_OPT_MODULE_SNAPSHOT_H_
+#define SOURCE_OPT_MODULE_SNAPSHOT_H_
+
+#include <cstdint>
+#include <memory>
+#include <unordered_set>
+#include <utility>
+#include <vector>
+
+#include "source/opt/compact_instruction.h"
+#include "source/opt/ir_context.h"
+#include "source/opt/module.h"
+
+namespace spvtools {
+namespace opt {
+
+// An immutable copy of a module, from which new contexts holding the same
+// module can be restored.  Restoring builds the IR directly from the saved
+// instructions, without writing and parsing a binary.
+//
+// The instructions of each function are saved separately and shared between
+// snapshots.  A snapshot taken from a |base| snapshot only saves again the
+// functions that changed since |base| was taken, so trying a transformation
+// and rolling it back costs the size of the functions it touched plus the
+// global instructions, rather than the size of the module.  Copying a
+// snapshot shares all of it.
+class ModuleSnapshot {
+ public:
+  // Takes a snapshot of |module|.
+  explicit ModuleSnapshot(const Module& module);
+
+  // Takes a snapshot of |module|, which was restored from |base| and then
+  // changed.  The functions whose result ids are in |changed_functions|, or
+  // which are not in |base|, are saved again.  The others are shared with
+  // |base|, so the caller must make sure they did not change.
+  ModuleSnapshot(const Module& module, const ModuleSnapshot& base,
+                 const std::unordered_set<uint32_t>& changed_functions);
+
+  // Returns a new context for |env| holding a copy of the saved module.  The
+  // messages of the loader go to |consumer|.  Returns nullptr if the module
+  // could not be loaded.
+  std::unique_ptr<IRContext> Restore(spv_target_env env,
+                                     MessageConsumer consumer) const;
+
+  // Returns the number of functions saved in the snapshot.
+  size_t num_functions() const { return functions_.size(); }
+
+  // Returns true if the saved instructions of the |index|th function are
+  // shared with |other|.
+  bool SharesFunctionWith(size_t index, const ModuleSnapshot& other) const;
+
+ private:
+  using Instructions = std::vector<CompactInstruction>;
+
+  // Returns the instructions of |function|, and the debug line instructions
+  // preceding them.
+  static std::shared_ptr<const Instructions> SaveFunction(
+      const Function& function);
+
+  // Saves the header and the instructions outside of the functions of
+  // |module|.
+  void SaveGlobals(const Module& module);
+
+  ModuleHeader header_;
+  // The instructions preceding the functions.  They are saved with every
+  // snapshot, since most transformations add types or constants.
+  Instructions globals_;
+  // The result id and the instructions of each function, in order.
+  std::vector<std::pair<uint32_t, std::shared_ptr<const Instructions>>>
+      functions_;
+  // The debug line instructions following the last instruction.
+  Instructions trailing_lines_;
+};
+
+}  // namespace opt
+}  // namespace spvtools
+
+#endif  // SOURCE_OPT_MODULE_SNAPSHOT_H_
@@ -0,0 +1,55 @@
+// Copyright (c) 2019 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "source/opt/module_summary.h"
+
+#include <string>
+
+namespace spvtools {
+namespace opt {
+
+ModuleSummary::ModuleSummary(Module* module) {
+  std::unordered_map<uint32_t, std::string> set_names;
+  for (const auto& import : module->ext_inst_imports()) {
+    const std::string name =
+        reinterpret_cast<const char*>(import.GetInOperand(0).words.data());
+    set_names[import.result_id()] = name;
+    ext_inst_counts_[name] = 0;
+  }
+
+  module->ForEachInst([this, &set_names](const Instruction* inst) {
+    ++opcode_counts_[inst->opcode()];
+    switch (inst->opcode()) {
+      case SpvOpDecorate:
+      case SpvOpDecorateId:
+      case SpvOpDecorateStringGOOGLE:
+        ++decoration_counts_[inst->GetSingleWordInOperand(1)];
+        break;
+      case SpvOpMemberDecorate:
+      case SpvOpMemberDecorateStringGOOGLE:
+        ++decoration_counts_[inst->GetSingleWordInOperand(2)];
+        break;
+      case SpvOpExtInst: {
+        auto it = set_names.find(inst->GetSingleWordInOperand(0));
+        if (it != set_names.end()) ++ext_inst_counts_[it->second];
+        break;
+      }
+      default:
+        break;
+    }
+  });
+}
+
+}  // namespace opt
+}  // namespace spvtools
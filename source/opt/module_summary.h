@@ -0,0 +1,94 @@
+// Copyright (c) 2019 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef SOURCE_OPT_MODULE_SUMMARY_H_
+#define SOURCE_OPT_MODULE_SUMMARY_H_
+
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+
+#include "source/latest_version_spirv_header.h"
+#include "source/opt/module.h"
+
+namespace spvtools {
+namespace opt {
+
+// A summary of what a module contains: how many instructions of each opcode,
+// how many decorations of each kind and how many extended instructions of
+// each set it has.  It is built in one walk over the module, and lets a pass
+// find out in constant time that it has nothing to do.  The extensions and
+// capabilities of the module are in its FeatureManager.
+//
+// The IRContext has a ModuleSummary.  It is not updated as the module
+// changes, so it describes the module as it was between passes: a pass that
+// changes the module invalidates it, unless the pass preserves it.
+class ModuleSummary {
+ public:
+  // Summarizes |module|.  The debug line instructions are not counted.
+  explicit ModuleSummary(Module* module);
+
+  // Returns the number of instructions with opcode |opcode| in the module.
+  uint32_t NumInstructions(SpvOp opcode) const {
+    return Lookup(opcode_counts_, opcode);
+  }
+
+  // Returns true if the module has an instruction with opcode |opcode|.
+  bool HasInstruction(SpvOp opcode) const {
+    return NumInstructions(opcode) != 0;
+  }
+
+  // Returns the number of times |decoration| is applied, by any of the
+  // decoration instructions except OpGroupDecorate and OpGroupMemberDecorate.
+  uint32_t NumDecorations(SpvDecoration decoration) const {
+    return Lookup(decoration_counts_, decoration);
+  }
+
+  // Returns the number of OpExtInst instructions of the extended instruction
+  // set imported as |set_name|.
+  uint32_t NumExtInsts(const std::string& set_name) const {
+    auto it = ext_inst_counts_.find(set_name);
+    return it != ext_inst_counts_.end() ? it->second : 0;
+  }
+
+  // Returns true if the module imports the extended instruction set named
+  // |set_name|.
+  bool ImportsExtInstSet(const std::string& set_name) const {
+    return ext_inst_counts_.count(set_name) != 0;
+  }
+
+  // Returns the number of structured loops in the module.
+  uint32_t NumLoops() const { return NumInstructions(SpvOpLoopMerge); }
+
+ private:
+  static uint32_t Lookup(const std::unordered_map<uint32_t, uint32_t>& counts,
+                         uint32_t key) {
+    auto it = counts.find(key);
+    return it != counts.end() ? it->second : 0;
+  }
+
+  // The number of instructions of each opcode.
+  std::unordered_map<uint32_t, uint32_t> opcode_counts_;
+
+  // The number of times each decoration is applied.
+  std::unordered_map<uint32_t, uint32_t> decoration_counts_;
+
+  // The number of extended instructions of each imported set, by set name.
+  std::unordered_map<std::string, uint32_t> ext_inst_counts_;
+};
+
+}  // namespace opt
+}  // namespace spvtools
+
+#endif  // SOURCE_OPT_MODULE_SUMMARY_H_
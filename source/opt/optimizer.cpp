@@ -14,23 +14,125 @@
 
 #include "spirv-tools/optimizer.hpp"
 
+#include <algorithm>
 #include <cassert>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
 #include <memory>
 #include <string>
 #include <unordered_map>
+#include <unordered_set>
 #include <utility>
 #include <vector>
 
 #include "source/opt/build_module.h"
+#include "source/opt/function_stream.h"
 #include "source/opt/graphics_robust_access_pass.h"
 #include "source/opt/log.h"
+#include "source/opt/module_snapshot.h"
 #include "source/opt/pass_manager.h"
 #include "source/opt/passes.h"
 #include "source/spirv_optimizer_options.h"
 #include "source/util/make_unique.h"
+#include "source/util/parallel.h"
+#include "source/util/profiler.h"
+#include "source/util/sha256.h"
 #include "source/util/string_utils.h"
 
 namespace spvtools {
+namespace {
+
+// The profile of one run of the optimizer.  If |out| is not null, it is
+// recorded and written as a Chrome trace to |out| at the end of the run.
+class RunProfile {
+ public:
+  explicit RunProfile(std::ostream* out) : out_(out) {}
+  ~RunProfile() {
+    if (out_) profiler_.WriteChromeTrace(out_);
+  }
+
+  // Returns the profiler of the run, or null if it is not recorded.
+  utils::Profiler* profiler() { return out_ ? &profiler_ : nullptr; }
+
+ private:
+  std::ostream* out_;
+  utils::Profiler profiler_;
+};
+
+template <typename T>
+std::unique_ptr<opt::Pass> MakePass() {
+  return MakeUnique<T>();
+}
+
+// Returns a simplification pass that only revisits the instructions changed
+// since the previous one.
+std::unique_ptr<opt::Pass> MakeIncrementalSimplificationPass() {
+  return MakeUnique<opt::SimplificationPass>(/* incremental = */ true);
+}
+
+// The maximal number of rounds of the passes cleaning up at the end of -O.
+const uint32_t kMaxCleanupRounds = 4;
+
+// Returns the passes cleaning up at the end of -O.  They are run again on the
+// functions they changed, as long as they find something to simplify.
+Optimizer::PassToken CreateCleanupPasses() {
+  std::vector<opt::FixpointPass::PassFactory> factories = {
+      MakePass<opt::RedundancyEliminationPass>,
+      MakePass<opt::DeadBranchElimPass>, MakePass<opt::BlockMergePass>,
+      MakeIncrementalSimplificationPass};
+  return Optimizer::PassToken(
+      MakeUnique<opt::FixpointPass>(std::move(factories), kMaxCleanupRounds));
+}
+
+// Appends the message |message| of level |level| about |position| to |out|,
+// as a line.
+void AppendMessage(spv_message_level_t level, const spv_position_t& position,
+                   const char* message, std::string* out) {
+  switch (level) {
+    case SPV_MSG_FATAL:
+    case SPV_MSG_INTERNAL_ERROR:
+    case SPV_MSG_ERROR:
+      *out += "error";
+      break;
+    case SPV_MSG_WARNING:
+      *out += "warning";
+      break;
+    case SPV_MSG_INFO:
+      *out += "info";
+      break;
+    case SPV_MSG_DEBUG:
+      *out += "debug";
+      break;
+  }
+  *out += ": line " + std::to_string(position.index) + ": " + message + "\n";
+}
+
+// Removes the entry points of the module of |context| other than the
+// |index|th one, and their execution modes.
+void KeepOnlyEntryPoint(opt::IRContext* context, size_t index) {
+  std::vector<opt::Instruction*> to_kill;
+  uint32_t kept_function_id = 0;
+  size_t entry_point_index = 0;
+  for (auto& entry_point : context->module()->entry_points()) {
+    if (entry_point_index++ == index) {
+      kept_function_id = entry_point.GetSingleWordInOperand(1);
+    } else {
+      to_kill.push_back(&entry_point);
+    }
+  }
+  for (auto& mode : context->module()->execution_modes()) {
+    if (mode.GetSingleWordInOperand(0) != kept_function_id) {
+      to_kill.push_back(&mode);
+    }
+  }
+  for (opt::Instruction* inst : to_kill) {
+    context->KillInst(inst);
+  }
+}
+
+}  // namespace
 
 struct Optimizer::PassToken::Impl {
   Impl(std::unique_ptr<opt::Pass> p) : pass(std::move(p)) {}
@@ -56,22 +158,288 @@ Optimizer::PassToken& Optimizer::PassToken::operator=(PassToken&& that) {
 Optimizer::PassToken::~PassToken() {}
 
 struct Optimizer::Impl {
-  explicit Impl(spv_target_env env) : target_env(env), pass_manager() {}
+  explicit Impl(spv_target_env env)
+      : target_env(env),
+        pass_manager(),
+        validator(env),
+        num_passes_from_flags(0),
+        cache(nullptr),
+        profile_stream(nullptr) {
+    for (opt::IRContext::Analysis analysis = opt::IRContext::kAnalysisBegin;
+         analysis < opt::IRContext::kAnalysisEnd; analysis <<= 1) {
+      statistics.analyses.push_back(
+          {opt::IRContext::GetAnalysisName(analysis), 0, 0});
+    }
+  }
+
+  // Validates the module of |num_words| words at |words| if |options| say so.
+  // Returns false if it fails to validate.  The work is recorded in
+  // |profiler|, if not null.
+  bool Validate(const uint32_t* words, size_t num_words,
+                spv_optimizer_options options, utils::Profiler* profiler);
+
+  // Parses the module of |num_words| words at |words|.  Returns null if it
+  // fails to parse.  The work is recorded in |profiler|, if not null.
+  std::unique_ptr<opt::IRContext> Parse(const uint32_t* words,
+                                        size_t num_words,
+                                        utils::Profiler* profiler);
+
+  // Validates the module of |num_words| words at |words| if |options| say so,
+  // and parses it.  Returns null if it fails to validate or to parse.  The
+  // work is recorded in |profiler|, if not null.
+  std::unique_ptr<opt::IRContext> BuildContext(const uint32_t* words,
+                                               size_t num_words,
+                                               spv_optimizer_options options,
+                                               utils::Profiler* profiler);
+
+  // Sets the options of |context| from |options| and runs the passes on it.
+  // The passes, and the analyses and functions of |context|, are recorded in
+  // |profiler|, if not null.
+  opt::Pass::Status RunPasses(opt::IRContext* context,
+                              spv_optimizer_options options,
+                              utils::Profiler* profiler);
+
+  // Returns the key of the module of |num_words| words at |words| in the
+  // optimization cache: the SHA-256 digest of everything that decides the
+  // result of optimizing it with |options|.
+  std::string CacheKey(const uint32_t* words, size_t num_words,
+                       const spv_optimizer_options_t& options) const;
+
+  // Sets the message consumer of the pass manager and of all the passes.
+  void SetMessageConsumer(MessageConsumer c);
+
+  // Returns a new optimizer with the passes of this one registered again from
+  // their flags, with the same settings, which reports to |consumer|.  A pass
+  // can only run once, so each of several modules needs its own optimizer.
+  // Returns null, with an error, if some pass was not registered from a flag.
+  std::unique_ptr<Optimizer> CopyFromFlags(
+      const MessageConsumer& consumer) const;
+
+  // Adds the work of the runs of |other| to the statistics.
+  void AddStatistics(const Statistics& other);
 
   spv_target_env target_env;      // Target environment.
   opt::PassManager pass_manager;  // Internal implementation pass manager.
+  // The validator of the modules, kept across runs so that its tables are only
+  // built once.
+  SpirvTools validator;
+  // The flags the passes were registered from, in order.
+  std::vector<std::string> pass_flags;
+  // The number of passes registered before the first one which was not
+  // registered from a flag.
+  uint32_t num_passes_from_flags;
+  OptimizationCache* cache;  // The cache of the results, or null.
+  // The stream to write the Chrome trace of each run to, or null.
+  std::ostream* profile_stream;
+  // The execution counts of the blocks of the modules, by label id.
+  std::unordered_map<uint32_t, uint64_t> block_counts;
+  // The work done by the runs so far.
+  Statistics statistics;
+};
+
+bool Optimizer::Impl::Validate(const uint32_t* words, size_t num_words,
+                               spv_optimizer_options options,
+                               utils::Profiler* profiler) {
+  if (!options->run_validator_) return true;
+  utils::ProfileScope scope(profiler, "module", "validate");
+  return validator.Validate(words, num_words, &options->val_options_);
+}
+
+std::unique_ptr<opt::IRContext> Optimizer::Impl::Parse(
+    const uint32_t* words, size_t num_words, utils::Profiler* profiler) {
+  utils::ProfileScope scope(profiler, "module", "parse");
+  return BuildModule(target_env, pass_manager.consumer(), words, num_words);
+}
+
+std::unique_ptr<opt::IRContext> Optimizer::Impl::BuildContext(
+    const uint32_t* words, size_t num_words, spv_optimizer_options options,
+    utils::Profiler* profiler) {
+  if (!Validate(words, num_words, options, profiler)) return nullptr;
+  return Parse(words, num_words, profiler);
+}
+
+opt::Pass::Status Optimizer::Impl::RunPasses(opt::IRContext* context,
+                                             spv_optimizer_options options,
+                                             utils::Profiler* profiler) {
+  context->set_max_id_bound(options->max_id_bound_);
+  context->set_preserve_bindings(options->preserve_bindings_);
+  context->set_preserve_spec_constants(options->preserve_spec_constants_);
+  context->set_num_threads(options->num_threads_);
+  context->set_profiler(profiler);
+  context->set_block_counts(block_counts.empty() ? nullptr : &block_counts);
+
+  // The context may have been used by other optimizers, so only the work of
+  // this run is added to the statistics.
+  std::vector<opt::IRContext::AnalysisStatistics> before;
+  for (opt::IRContext::Analysis analysis = opt::IRContext::kAnalysisBegin;
+       analysis < opt::IRContext::kAnalysisEnd; analysis <<= 1) {
+    before.push_back(context->GetAnalysisStatistics(analysis));
+  }
+
+  pass_manager.SetValidatorOptions(&options->val_options_);
+  pass_manager.SetTargetEnv(target_env);
+  pass_manager.SetTimeBudget(std::chrono::microseconds(options->time_budget_));
+  const opt::Pass::Status status = pass_manager.Run(context);
+  context->set_profiler(nullptr);
+  context->set_block_counts(nullptr);
+
+  size_t index = 0;
+  for (opt::IRContext::Analysis analysis = opt::IRContext::kAnalysisBegin;
+       analysis < opt::IRContext::kAnalysisEnd; analysis <<= 1, ++index) {
+    const opt::IRContext::AnalysisStatistics& after =
+        context->GetAnalysisStatistics(analysis);
+    statistics.analyses[index].builds += after.builds - before[index].builds;
+    statistics.analyses[index].nanoseconds +=
+        after.nanoseconds - before[index].nanoseconds;
+  }
+  return status;
+}
+
+std::string Optimizer::Impl::CacheKey(
+    const uint32_t* words, size_t num_words,
+    const spv_optimizer_options_t& options) const {
+  utils::Sha256 sha;
+  const std::string version = spvSoftwareVersionDetailsString();
+  sha.Update(version.c_str(), version.size() + 1);
+  const uint32_t settings[] = {static_cast<uint32_t>(target_env),
+                               options.run_validator_,
+                               options.max_id_bound_,
+                               options.preserve_bindings_,
+                               options.preserve_spec_constants_,
+                               pass_manager.validate_after_all(),
+                               pass_manager.NumPasses(),
+                               static_cast<uint32_t>(pass_flags.size())};
+  sha.Update(settings, sizeof(settings));
+  // The validator options decide whether the module is accepted.
+  if (options.run_validator_ || pass_manager.validate_after_all()) {
+    HashValidatorOptions(options.val_options_, &sha);
+  }
+  for (uint32_t i = 0; i < pass_manager.NumPasses(); ++i) {
+    const char* name = pass_manager.GetPass(i)->name();
+    sha.Update(name, strlen(name) + 1);
+  }
+  for (const std::string& flag : pass_flags) {
+    sha.Update(flag.c_str(), flag.size() + 1);
+  }
+  // The profile guides the passes, in the order of the block ids.
+  std::vector<std::pair<uint32_t, uint64_t>> counts(block_counts.begin(),
+                                                    block_counts.end());
+  std::sort(counts.begin(), counts.end());
+  for (const auto& count : counts) {
+    const uint64_t words[] = {count.first, count.second};
+    sha.Update(words, sizeof(words));
+  }
+  sha.Update(words, num_words * sizeof(uint32_t));
+  return sha.HexDigest();
+}
+
+struct Optimizer::IRHandle::Impl {
+  explicit Impl(std::unique_ptr<opt::IRContext> c) : context(std::move(c)) {}
+
+  std::unique_ptr<opt::IRContext> context;  // The module and its analyses.
 };
 
+Optimizer::IRHandle::IRHandle() {}
+
+Optimizer::IRHandle::IRHandle(IRHandle&& that) : impl_(std::move(that.impl_)) {}
+
+Optimizer::IRHandle& Optimizer::IRHandle::operator=(IRHandle&& that) {
+  impl_ = std::move(that.impl_);
+  return *this;
+}
+
+Optimizer::IRHandle::~IRHandle() {}
+
+bool Optimizer::IRHandle::HasModule() const { return impl_ != nullptr; }
+
+void Optimizer::IRHandle::ToBinary(std::vector<uint32_t>* binary) const {
+  assert(HasModule() && "The handle holds no module.");
+  binary->clear();
+  impl_->context->module()->ToBinary(binary, /* skip_nop = */ true);
+}
+
+DirectoryOptimizationCache::DirectoryOptimizationCache(const std::string& path)
+    : path_(path) {}
+
+bool DirectoryOptimizationCache::Lookup(const std::string& key,
+                                        std::vector<uint32_t>* binary) {
+  FILE* file = fopen(FilePath(key).c_str(), "rb");
+  if (!file) return false;
+  // The file holds the number of words, then the words.  It is complete only
+  // if its size matches.
+  fseek(file, 0, SEEK_END);
+  const long size = ftell(file);
+  fseek(file, 0, SEEK_SET);
+  uint32_t num_words = 0;
+  bool found = size >= 0 &&
+               fread(&num_words, sizeof(num_words), 1, file) == 1 &&
+               static_cast<unsigned long long>(size) ==
+                   (num_words + 1ull) * sizeof(uint32_t);
+  if (found) {
+    binary->resize(num_words);
+    found = fread(binary->data(), sizeof(uint32_t), num_words, file) ==
+            num_words;
+  }
+  fclose(file);
+  return found;
+}
+
+void DirectoryOptimizationCache::Insert(const std::string& key,
+                                        const std::vector<uint32_t>& binary) {
+  FILE* file = fopen(FilePath(key).c_str(), "wb");
+  if (!file) return;
+  const uint32_t num_words = static_cast<uint32_t>(binary.size());
+  fwrite(&num_words, sizeof(num_words), 1, file);
+  fwrite(binary.data(), sizeof(uint32_t), binary.size(), file);
+  fclose(file);
+}
+
+std::string DirectoryOptimizationCache::FilePath(const std::string& key) const {
+  if (path_.empty()) return key;
+  const char last = path_.back();
+  return last == '/' || last == '\\' ? path_ + key : path_ + "/" + key;
+}
+
 Optimizer::Optimizer(spv_target_env env) : impl_(new Impl(env)) {}
 
 Optimizer::~Optimizer() {}
 
-void Optimizer::SetMessageConsumer(MessageConsumer c) {
+void Optimizer::Impl::SetMessageConsumer(MessageConsumer c) {
   // All passes' message consumer needs to be updated.
-  for (uint32_t i = 0; i < impl_->pass_manager.NumPasses(); ++i) {
-    impl_->pass_manager.GetPass(i)->SetMessageConsumer(c);
+  for (uint32_t i = 0; i < pass_manager.NumPasses(); ++i) {
+    pass_manager.GetPass(i)->SetMessageConsumer(c);
   }
-  impl_->pass_manager.SetMessageConsumer(std::move(c));
+  validator.SetMessageConsumer(c);
+  pass_manager.SetMessageConsumer(std::move(c));
+}
+
+std::unique_ptr<Optimizer> Optimizer::Impl::CopyFromFlags(
+    const MessageConsumer& consumer) const {
+  if (num_passes_from_flags != pass_manager.NumPasses()) {
+    Error(consumer, nullptr, {},
+          "Only passes registered from flags can be run on several "
+          "modules.");
+    return nullptr;
+  }
+  std::unique_ptr<Optimizer> optimizer = MakeUnique<Optimizer>(target_env);
+  optimizer->SetMessageConsumer(consumer);
+  optimizer->SetValidateAfterAll(pass_manager.validate_after_all());
+  optimizer->impl_->block_counts = block_counts;
+  optimizer->impl_->cache = cache;
+  if (!optimizer->RegisterPassesFromFlags(pass_flags)) return nullptr;
+  return optimizer;
+}
+
+void Optimizer::Impl::AddStatistics(const Statistics& other) {
+  for (size_t index = 0; index < statistics.analyses.size(); ++index) {
+    statistics.analyses[index].builds += other.analyses[index].builds;
+    statistics.analyses[index].nanoseconds +=
+        other.analyses[index].nanoseconds;
+  }
+}
+
+void Optimizer::SetMessageConsumer(MessageConsumer c) {
+  impl_->SetMessageConsumer(std::move(c));
 }
 
 const MessageConsumer& Optimizer::consumer() const {
@@ -177,20 +545,19 @@ Optimizer& Optimizer::RegisterPerformancePasses() {
       .RegisterPass(CreateAggressiveDCEPass())
       .RegisterPass(CreateRedundancyEliminationPass())
       .RegisterPass(CreateCombineAccessChainsPass())
-      .RegisterPass(CreateSimplificationPass())
+      .RegisterPass(
+          Optimizer::PassToken(MakeIncrementalSimplificationPass()))
       .RegisterPass(CreateVectorDCEPass())
       .RegisterPass(CreateDeadInsertElimPass())
       .RegisterPass(CreateDeadBranchElimPass())
-      .RegisterPass(CreateSimplificationPass())
+      .RegisterPass(
+          Optimizer::PassToken(MakeIncrementalSimplificationPass()))
       .RegisterPass(CreateIfConversionPass())
       .RegisterPass(CreateCopyPropagateArraysPass())
       .RegisterPass(CreateReduceLoadSizePass())
       .RegisterPass(CreateAggressiveDCEPass())
       .RegisterPass(CreateBlockMergePass())
-      .RegisterPass(CreateRedundancyEliminationPass())
-      .RegisterPass(CreateDeadBranchElimPass())
-      .RegisterPass(CreateBlockMergePass())
-      .RegisterPass(CreateSimplificationPass());
+      .RegisterPass(CreateCleanupPasses());
 }
 
 Optimizer& Optimizer::RegisterSizePasses() {
@@ -275,6 +642,8 @@ bool Optimizer::RegisterPassFromFlag(const std::string& flag) {
   if (!FlagHasValidForm(flag)) {
     return false;
   }
+  const bool all_from_flags =
+      impl_->num_passes_from_flags == impl_->pass_manager.NumPasses();
 
   // Split flags of the form --pass_name=pass_args.
   auto p = utils::SplitFlagArgs(flag);
@@ -322,12 +691,43 @@ bool Optimizer::RegisterPassFromFlag(const std::string& flag) {
     RegisterPass(CreateInlineExhaustivePass());
   } else if (pass_name == "inline-entry-points-opaque") {
     RegisterPass(CreateInlineOpaquePass());
+  } else if (pass_name == "inline-budget") {
+    if (pass_args.size() == 0) {
+      RegisterPass(CreateInlineCostPass());
+    } else {
+      int budget = -1;
+      if (pass_args.find_first_not_of("0123456789") == std::string::npos) {
+        budget = atoi(pass_args.c_str());
+      }
+
+      if (budget >= 0) {
+        RegisterPass(CreateInlineCostPass(budget));
+      } else {
+        Error(consumer(), nullptr, {},
+              "--inline-budget must have no arguments or a non-negative "
+              "integer argument");
+        return false;
+      }
+    }
   } else if (pass_name == "combine-access-chains") {
     RegisterPass(CreateCombineAccessChainsPass());
   } else if (pass_name == "convert-local-access-chains") {
     RegisterPass(CreateLocalAccessChainConvertPass());
   } else if (pass_name == "descriptor-scalar-replacement") {
     RegisterPass(CreateDescriptorScalarReplacementPass());
+  } else if (pass_name == "descriptor-scalar-replacement-partial") {
+    if (pass_args.size() == 0) {
+      RegisterPass(CreatePartialDescriptorScalarReplacementPass());
+    } else if (pass_args.find_first_not_of("0123456789") ==
+               std::string::npos) {
+      RegisterPass(CreatePartialDescriptorScalarReplacementPass(
+          atoi(pass_args.c_str())));
+    } else {
+      Error(consumer(), nullptr, {},
+            "--descriptor-scalar-replacement-partial must have no arguments or "
+            "a non-negative integer argument");
+      return false;
+    }
   } else if (pass_name == "eliminate-dead-code-aggressive") {
     RegisterPass(CreateAggressiveDCEPass());
   } else if (pass_name == "propagate-line-info") {
@@ -340,8 +740,12 @@ bool Optimizer::RegisterPassFromFlag(const std::string& flag) {
     RegisterPass(CreateLocalSingleBlockLoadStoreElimPass());
   } else if (pass_name == "eliminate-local-single-store") {
     RegisterPass(CreateLocalSingleStoreElimPass());
+  } else if (pass_name == "eliminate-memory-load-store") {
+    RegisterPass(CreateMemoryLoadStoreElimPass());
   } else if (pass_name == "merge-blocks") {
     RegisterPass(CreateBlockMergePass());
+  } else if (pass_name == "merge-identical-functions") {
+    RegisterPass(CreateMergeIdenticalFunctionsPass());
   } else if (pass_name == "merge-return") {
     RegisterPass(CreateMergeReturnPass());
   } else if (pass_name == "eliminate-dead-branches") {
@@ -361,7 +765,17 @@ bool Optimizer::RegisterPassFromFlag(const std::string& flag) {
   } else if (pass_name == "fold-spec-const-op-composite") {
     RegisterPass(CreateFoldSpecConstantOpAndCompositePass());
   } else if (pass_name == "loop-unswitch") {
-    RegisterPass(CreateLoopUnswitchPass());
+    if (pass_args.size() == 0) {
+      RegisterPass(CreateLoopUnswitchPass());
+    } else if (pass_args.find_first_not_of("0123456789") ==
+               std::string::npos) {
+      RegisterPass(CreateLoopUnswitchPass(atoi(pass_args.c_str())));
+    } else {
+      Error(consumer(), nullptr, {},
+            "--loop-unswitch must have no arguments or a non-negative integer "
+            "argument");
+      return false;
+    }
   } else if (pass_name == "scalar-replacement") {
     if (pass_args.size() == 0) {
       RegisterPass(CreateScalarReplacementPass());
@@ -380,6 +794,8 @@ bool Optimizer::RegisterPassFromFlag(const std::string& flag) {
         return false;
       }
     }
+  } else if (pass_name == "slp-vectorize") {
+    RegisterPass(CreateSLPVectorizePass());
   } else if (pass_name == "strength-reduction") {
     RegisterPass(CreateStrengthReductionPass());
   } else if (pass_name == "unify-const") {
@@ -387,7 +803,16 @@ bool Optimizer::RegisterPassFromFlag(const std::string& flag) {
   } else if (pass_name == "flatten-decorations") {
     RegisterPass(CreateFlattenDecorationPass());
   } else if (pass_name == "compact-ids") {
-    RegisterPass(CreateCompactIdsPass());
+    if (pass_args.size() == 0) {
+      RegisterPass(CreateCompactIdsPass());
+    } else if (pass_args == "locality") {
+      RegisterPass(CreateCompactIdsPass(true));
+    } else {
+      Error(consumer(), nullptr, {},
+            "--compact-ids must have no arguments or the argument "
+            "\"locality\"");
+      return false;
+    }
   } else if (pass_name == "cfg-cleanup") {
     RegisterPass(CreateCFGCleanupPass());
   } else if (pass_name == "local-redundancy-elimination") {
@@ -398,6 +823,8 @@ bool Optimizer::RegisterPassFromFlag(const std::string& flag) {
     RegisterPass(CreateReduceLoadSizePass());
   } else if (pass_name == "redundancy-elimination") {
     RegisterPass(CreateRedundancyEliminationPass());
+  } else if (pass_name == "partial-redundancy-elimination") {
+    RegisterPass(CreatePartialRedundancyEliminationPass());
   } else if (pass_name == "private-to-local") {
     RegisterPass(CreatePrivateToLocalPass());
   } else if (pass_name == "remove-duplicates") {
@@ -412,6 +839,27 @@ bool Optimizer::RegisterPassFromFlag(const std::string& flag) {
     RegisterPass(CreateDeadBranchElimPass());
     RegisterPass(CreateBlockMergePass());
     RegisterPass(CreateAggressiveDCEPass());
+  } else if (pass_name == "inst-bindless-check-dedup") {
+    RegisterPass(CreateInstBindlessCheckPass(7, 23, false, false, 2, 1, true));
+    RegisterPass(CreateSimplificationPass());
+    RegisterPass(CreateDeadBranchElimPass());
+    RegisterPass(CreateBlockMergePass());
+    RegisterPass(CreateAggressiveDCEPass());
+  } else if (pass_name == "inst-bindless-check-sample") {
+    int sample_rate = (pass_args.size() > 0) ? atoi(pass_args.c_str()) : 0;
+    if (sample_rate > 0) {
+      RegisterPass(CreateInstBindlessCheckPass(
+          7, 23, false, false, 2, static_cast<uint32_t>(sample_rate)));
+      RegisterPass(CreateSimplificationPass());
+      RegisterPass(CreateDeadBranchElimPass());
+      RegisterPass(CreateBlockMergePass());
+      RegisterPass(CreateAggressiveDCEPass());
+    } else {
+      Error(consumer(), nullptr, {},
+            "--inst-bindless-check-sample must have a positive integer "
+            "argument");
+      return false;
+    }
   } else if (pass_name == "inst-desc-idx-check") {
     RegisterPass(CreateInstBindlessCheckPass(7, 23, true, true, 2));
     RegisterPass(CreateSimplificationPass());
@@ -421,10 +869,26 @@ bool Optimizer::RegisterPassFromFlag(const std::string& flag) {
   } else if (pass_name == "inst-buff-addr-check") {
     RegisterPass(CreateInstBuffAddrCheckPass(7, 23, 2));
     RegisterPass(CreateAggressiveDCEPass());
+  } else if (pass_name == "inst-profile") {
+    RegisterPass(CreateInstProfilePass(7, 23));
   } else if (pass_name == "convert-relaxed-to-half") {
     RegisterPass(CreateConvertRelaxedToHalfPass());
   } else if (pass_name == "relax-float-ops") {
     RegisterPass(CreateRelaxFloatOpsPass());
+  } else if (pass_name == "relax-float-ops-in-range") {
+    if (pass_args.size() == 0) {
+      RegisterPass(CreateRelaxFloatOpsInRangePass());
+    } else {
+      char* end = nullptr;
+      const float max_magnitude = strtof(pass_args.c_str(), &end);
+      if (*end != '\0' || !(max_magnitude > 0)) {
+        Error(consumer(), nullptr, {},
+              "--relax-float-ops-in-range must have no arguments or a "
+              "positive number argument");
+        return false;
+      }
+      RegisterPass(CreateRelaxFloatOpsInRangePass(max_magnitude));
+    }
   } else if (pass_name == "simplify-instructions") {
     RegisterPass(CreateSimplificationPass());
   } else if (pass_name == "ssa-rewrite") {
@@ -434,23 +898,31 @@ bool Optimizer::RegisterPassFromFlag(const std::string& flag) {
   } else if (pass_name == "loop-fission") {
     int register_threshold_to_split =
         (pass_args.size() > 0) ? atoi(pass_args.c_str()) : -1;
-    if (register_threshold_to_split > 0) {
+    if (pass_args == "auto") {
+      RegisterPass(CreateLoopFissionPass(
+          opt::LoopFissionPass::kDefaultRegisterThreshold, true));
+    } else if (register_threshold_to_split > 0) {
       RegisterPass(CreateLoopFissionPass(
           static_cast<size_t>(register_threshold_to_split)));
     } else {
       Error(consumer(), nullptr, {},
-            "--loop-fission must have a positive integer argument");
+            "--loop-fission must have a positive integer argument or "
+            "'auto'");
       return false;
     }
   } else if (pass_name == "loop-fusion") {
     int max_registers_per_loop =
         (pass_args.size() > 0) ? atoi(pass_args.c_str()) : -1;
-    if (max_registers_per_loop > 0) {
+    if (pass_args == "auto") {
+      RegisterPass(CreateLoopFusionPass(
+          opt::LoopFusionPass::kDefaultMaxRegistersPerLoop, true));
+    } else if (max_registers_per_loop > 0) {
       RegisterPass(
           CreateLoopFusionPass(static_cast<size_t>(max_registers_per_loop)));
     } else {
       Error(consumer(), nullptr, {},
-            "--loop-fusion must have a positive integer argument");
+            "--loop-fusion must have a positive integer argument or "
+            "'auto'");
       return false;
     }
   } else if (pass_name == "loop-unroll") {
@@ -468,6 +940,16 @@ bool Optimizer::RegisterPassFromFlag(const std::string& flag) {
             "--loop-unroll-partial must have a positive integer argument");
       return false;
     }
+  } else if (pass_name == "loop-unroll-auto") {
+    int max_registers = (pass_args.size() > 0) ? atoi(pass_args.c_str()) : 0;
+    if (max_registers > 0) {
+      RegisterPass(
+          CreateLoopUnrollAutoPass(static_cast<size_t>(max_registers)));
+    } else {
+      Error(consumer(), nullptr, {},
+            "--loop-unroll-auto must have a positive integer argument");
+      return false;
+    }
   } else if (pass_name == "loop-peeling") {
     RegisterPass(CreateLoopPeelingPass());
   } else if (pass_name == "loop-peeling-threshold") {
@@ -483,6 +965,17 @@ bool Optimizer::RegisterPassFromFlag(const std::string& flag) {
     RegisterPass(CreateCCPPass());
   } else if (pass_name == "code-sink") {
     RegisterPass(CreateCodeSinkingPass());
+  } else if (pass_name == "reduce-register-pressure") {
+    int max_registers = (pass_args.size() > 0) ? atoi(pass_args.c_str()) : 0;
+    if (max_registers > 0) {
+      RegisterPass(CreateReduceRegisterPressurePass(
+          static_cast<size_t>(max_registers)));
+    } else {
+      Error(consumer(), nullptr, {},
+            "--reduce-register-pressure must have a positive integer "
+            "argument");
+      return false;
+    }
   } else if (pass_name == "fix-storage-class") {
     RegisterPass(CreateFixStorageClassPass());
   } else if (pass_name == "O") {
@@ -512,6 +1005,10 @@ bool Optimizer::RegisterPassFromFlag(const std::string& flag) {
     return false;
   }
 
+  impl_->pass_flags.push_back(flag);
+  if (all_from_flags) {
+    impl_->num_passes_from_flags = impl_->pass_manager.NumPasses();
+  }
   return true;
 }
 
@@ -542,25 +1039,51 @@ bool Optimizer::Run(const uint32_t* original_binary,
                     const size_t original_binary_size,
                     std::vector<uint32_t>* optimized_binary,
                     const spv_optimizer_options opt_options) const {
-  spvtools::SpirvTools tools(impl_->target_env);
-  tools.SetMessageConsumer(impl_->pass_manager.consumer());
-  if (opt_options->run_validator_ &&
-      !tools.Validate(original_binary, original_binary_size,
-                      &opt_options->val_options_)) {
-    return false;
+  // A pass registered other than from a flag may have been created with
+  // arguments that the key cannot see, so such passes are never cached.
+  const bool cached =
+      impl_->cache != nullptr &&
+      impl_->num_passes_from_flags == impl_->pass_manager.NumPasses();
+  std::string cache_key;
+  if (cached) {
+    cache_key =
+        impl_->CacheKey(original_binary, original_binary_size, *opt_options);
+    std::vector<uint32_t> cached_binary;
+    if (impl_->cache->Lookup(cache_key, &cached_binary)) {
+      optimized_binary->swap(cached_binary);
+      return true;
+    }
   }
 
-  std::unique_ptr<opt::IRContext> context = BuildModule(
-      impl_->target_env, consumer(), original_binary, original_binary_size);
-  if (context == nullptr) return false;
+  RunProfile profile(impl_->profile_stream);
+  if (!impl_->Validate(original_binary, original_binary_size, opt_options,
+                       profile.profiler())) {
+    return false;
+  }
 
-  context->set_max_id_bound(opt_options->max_id_bound_);
-  context->set_preserve_bindings(opt_options->preserve_bindings_);
-  context->set_preserve_spec_constants(opt_options->preserve_spec_constants_);
+  // Passes that only delete instructions are run on the binary if they all
+  // can be, which saves building the IR.
+  {
+    std::vector<uint32_t> filtered_binary;
+    bool filtered;
+    {
+      utils::ProfileScope scope(profile.profiler(), "module", "filter");
+      filtered = impl_->pass_manager.RunAsBinaryFilters(
+          impl_->target_env, original_binary, original_binary_size,
+          &filtered_binary);
+    }
+    if (filtered) {
+      optimized_binary->swap(filtered_binary);
+      if (cached) impl_->cache->Insert(cache_key, *optimized_binary);
+      return true;
+    }
+  }
 
-  impl_->pass_manager.SetValidatorOptions(&opt_options->val_options_);
-  impl_->pass_manager.SetTargetEnv(impl_->target_env);
-  auto status = impl_->pass_manager.Run(context.get());
+  std::unique_ptr<opt::IRContext> context = impl_->Parse(
+      original_binary, original_binary_size, profile.profiler());
+  if (context == nullptr) return false;
+  auto status =
+      impl_->RunPasses(context.get(), opt_options, profile.profiler());
 
   if (status == opt::Pass::Status::Failure) {
     return false;
@@ -584,11 +1107,312 @@ bool Optimizer::Run(const uint32_t* original_binary,
   // Note that |original_binary| and |optimized_binary| may share the same
   // buffer and the below will invalidate |original_binary|.
   optimized_binary->clear();
-  context->module()->ToBinary(optimized_binary, /* skip_nop = */ true);
+  {
+    utils::ProfileScope scope(profile.profiler(), "module", "serialize");
+    context->module()->ToBinary(optimized_binary, /* skip_nop = */ true);
+  }
+
+  // A module left partly optimized for lack of time is not cached, so that a
+  // later run can do better.
+  if (cached && impl_->pass_manager.NumSkippedPasses() == 0) {
+    impl_->cache->Insert(cache_key, *optimized_binary);
+  }
+  return true;
+}
 
+bool Optimizer::BuildIR(const uint32_t* original_binary,
+                        size_t original_binary_size, IRHandle* ir,
+                        const spv_optimizer_options opt_options) const {
+  ir->impl_.reset();
+  RunProfile profile(impl_->profile_stream);
+  std::unique_ptr<opt::IRContext> context = impl_->BuildContext(
+      original_binary, original_binary_size, opt_options, profile.profiler());
+  if (context == nullptr) return false;
+  ir->impl_ = MakeUnique<IRHandle::Impl>(std::move(context));
   return true;
 }
 
+bool Optimizer::Run(IRHandle* ir,
+                    const spv_optimizer_options opt_options) const {
+  assert(ir->HasModule() && "The handle holds no module.");
+  opt::IRContext* context = ir->impl_->context.get();
+  context->SetMessageConsumer(consumer());
+  RunProfile profile(impl_->profile_stream);
+  return impl_->RunPasses(context, opt_options, profile.profiler()) !=
+         opt::Pass::Status::Failure;
+}
+
+bool Optimizer::RunSpecializations(
+    const IRHandle& ir,
+    const std::vector<std::unordered_map<uint32_t, std::string>>&
+        specializations,
+    std::vector<std::vector<uint32_t>>* optimized_binaries,
+    const spv_optimizer_options opt_options) const {
+  assert(ir.HasModule() && "The handle holds no module.");
+  const opt::ModuleSnapshot snapshot(*ir.impl_->context->module());
+  optimized_binaries->assign(specializations.size(), {});
+
+  // Specializes a copy of the module with the values of |index|, and runs
+  // the passes of |optimizer| on it.
+  auto specialize = [this, &snapshot, &specializations, optimized_binaries,
+                     opt_options](size_t index, const Optimizer& optimizer,
+                                  utils::Profiler* profiler) {
+    std::unique_ptr<opt::IRContext> context =
+        snapshot.Restore(impl_->target_env, optimizer.consumer());
+    if (context == nullptr) return false;
+    opt::SetSpecConstantDefaultValuePass set_values(specializations[index]);
+    opt::FreezeSpecConstantValuePass freeze;
+    opt::FoldSpecConstantOpAndCompositePass fold;
+    for (opt::Pass* pass :
+         std::initializer_list<opt::Pass*>{&set_values, &freeze, &fold}) {
+      pass->SetMessageConsumer(optimizer.consumer());
+      if (pass->Run(context.get()) == opt::Pass::Status::Failure) {
+        return false;
+      }
+    }
+    if (optimizer.impl_->RunPasses(context.get(), opt_options, profiler) ==
+        opt::Pass::Status::Failure) {
+      return false;
+    }
+    context->module()->ToBinary(&(*optimized_binaries)[index],
+                                /* skip_nop = */ true);
+    return true;
+  };
+
+  // The passes hold the context they run on, so each thread needs its own.
+  const bool concurrent =
+      utils::ResolveNumThreads(opt_options->num_threads_) > 1 &&
+      impl_->num_passes_from_flags == impl_->pass_manager.NumPasses();
+  std::vector<char> succeeded(specializations.size(), 0);
+  if (concurrent) {
+    utils::ParallelFor(
+        specializations.size(), opt_options->num_threads_,
+        [this, &specialize, &succeeded](size_t index) {
+          std::unique_ptr<Optimizer> optimizer =
+              impl_->CopyFromFlags(consumer());
+          succeeded[index] =
+              optimizer && specialize(index, *optimizer, nullptr);
+        });
+  } else {
+    RunProfile profile(impl_->profile_stream);
+    for (size_t index = 0; index < specializations.size(); ++index) {
+      std::unique_ptr<Optimizer> optimizer = impl_->CopyFromFlags(consumer());
+      if (!optimizer) continue;
+      succeeded[index] = specialize(index, *optimizer, profile.profiler());
+      impl_->AddStatistics(optimizer->impl_->statistics);
+    }
+  }
+
+  bool ok = true;
+  for (size_t index = 0; index < specializations.size(); ++index) {
+    if (!succeeded[index]) {
+      (*optimized_binaries)[index].clear();
+      ok = false;
+    }
+  }
+  return ok;
+}
+
+bool Optimizer::RunEntryPoints(
+    const IRHandle& ir, std::vector<std::string>* names,
+    std::vector<std::vector<uint32_t>>* optimized_binaries,
+    const spv_optimizer_options opt_options) const {
+  assert(ir.HasModule() && "The handle holds no module.");
+  names->clear();
+  for (const auto& entry_point : ir.impl_->context->module()->entry_points()) {
+    names->push_back(utils::MakeString(entry_point.GetInOperand(2).words));
+  }
+  const opt::ModuleSnapshot snapshot(*ir.impl_->context->module());
+  optimized_binaries->assign(names->size(), {});
+
+  // Extracts the call tree of the entry point |index| from a copy of the
+  // module, and runs the passes of |optimizer| on it.
+  auto extract = [this, &snapshot, optimized_binaries, opt_options](
+                     size_t index, const Optimizer& optimizer,
+                     utils::Profiler* profiler) {
+    std::unique_ptr<opt::IRContext> context =
+        snapshot.Restore(impl_->target_env, optimizer.consumer());
+    if (context == nullptr) return false;
+    KeepOnlyEntryPoint(context.get(), index);
+    opt::EliminateDeadFunctionsPass eliminate_dead_functions;
+    eliminate_dead_functions.SetMessageConsumer(optimizer.consumer());
+    if (eliminate_dead_functions.Run(context.get()) ==
+        opt::Pass::Status::Failure) {
+      return false;
+    }
+    if (optimizer.impl_->RunPasses(context.get(), opt_options, profiler) ==
+        opt::Pass::Status::Failure) {
+      return false;
+    }
+    context->module()->ToBinary(&(*optimized_binaries)[index],
+                                /* skip_nop = */ true);
+    return true;
+  };
+
+  // The passes hold the context they run on, so each thread needs its own.
+  const bool concurrent =
+      names->size() > 1 &&
+      utils::ResolveNumThreads(opt_options->num_threads_) > 1 &&
+      impl_->num_passes_from_flags == impl_->pass_manager.NumPasses();
+  std::vector<char> succeeded(names->size(), 0);
+  if (concurrent) {
+    utils::ParallelFor(names->size(), opt_options->num_threads_,
+                       [this, &extract, &succeeded](size_t index) {
+                         std::unique_ptr<Optimizer> optimizer =
+                             impl_->CopyFromFlags(consumer());
+                         succeeded[index] =
+                             optimizer && extract(index, *optimizer, nullptr);
+                       });
+  } else {
+    RunProfile profile(impl_->profile_stream);
+    for (size_t index = 0; index < names->size(); ++index) {
+      std::unique_ptr<Optimizer> optimizer = impl_->CopyFromFlags(consumer());
+      if (!optimizer) continue;
+      succeeded[index] = extract(index, *optimizer, profile.profiler());
+      impl_->AddStatistics(optimizer->impl_->statistics);
+    }
+  }
+
+  bool ok = true;
+  for (size_t index = 0; index < names->size(); ++index) {
+    if (!succeeded[index]) {
+      (*optimized_binaries)[index].clear();
+      ok = false;
+    }
+  }
+  return ok;
+}
+
+bool Optimizer::RunStreaming(const uint32_t* original_binary,
+                             size_t original_binary_size,
+                             std::vector<uint32_t>* optimized_binary,
+                             const spv_optimizer_options opt_options) const {
+  if (impl_->num_passes_from_flags != impl_->pass_manager.NumPasses()) {
+    Error(consumer(), nullptr, {},
+          "Only passes registered from flags can be run one function at a "
+          "time.");
+    return false;
+  }
+  for (uint32_t i = 0; i < impl_->pass_manager.NumPasses(); ++i) {
+    const opt::Pass* pass = impl_->pass_manager.GetPass(i);
+    if (!pass->IsFunctionLocal()) {
+      Errorf(consumer(), nullptr, {},
+             "The pass %s cannot be run one function at a time.",
+             pass->name());
+      return false;
+    }
+  }
+
+  RunProfile profile(impl_->profile_stream);
+  if (!impl_->Validate(original_binary, original_binary_size, opt_options,
+                       profile.profiler())) {
+    return false;
+  }
+  opt::FunctionStream stream(impl_->target_env, consumer());
+  {
+    utils::ProfileScope scope(profile.profiler(), "module", "parse");
+    if (!stream.Begin(original_binary, original_binary_size)) return false;
+  }
+
+  // A pass can only run once, so the passes of each function are registered
+  // again from the flags.
+  while (stream.HasNextFunction()) {
+    opt::Function* function = stream.LoadNextFunction();
+    if (function == nullptr) return false;
+    Optimizer optimizer(impl_->target_env);
+    optimizer.SetMessageConsumer(consumer());
+    optimizer.impl_->block_counts = impl_->block_counts;
+    if (!optimizer.RegisterPassesFromFlags(impl_->pass_flags)) return false;
+    // The other functions are only declared.
+    const std::unordered_set<opt::Function*> functions = {function};
+    opt::PassManager& pass_manager = optimizer.impl_->pass_manager;
+    for (uint32_t i = 0; i < pass_manager.NumPasses(); ++i) {
+      pass_manager.GetPass(i)->RestrictToFunctions(&functions);
+    }
+    if (optimizer.impl_->RunPasses(stream.context(), opt_options,
+                                   profile.profiler()) ==
+        opt::Pass::Status::Failure) {
+      return false;
+    }
+    stream.UnloadFunction();
+  }
+
+  // |original_binary| and |optimized_binary| may share the same buffer, which
+  // the stream reads until it is finished.
+  std::vector<uint32_t> binary;
+  {
+    utils::ProfileScope scope(profile.profiler(), "module", "serialize");
+    stream.Finish(&binary);
+  }
+  optimized_binary->swap(binary);
+  return true;
+}
+
+bool Optimizer::RunBatch(
+    const std::vector<std::vector<uint32_t>>& original_binaries,
+    std::vector<std::vector<uint32_t>>* optimized_binaries,
+    std::vector<std::string>* messages,
+    const spv_optimizer_options opt_options) const {
+  const size_t count = original_binaries.size();
+  optimized_binaries->assign(count, {});
+  if (messages) messages->assign(count, "");
+
+  // Returns the consumer of the messages of the binary |index|.
+  auto consumer_for = [this, messages](size_t index) -> MessageConsumer {
+    if (!messages) return consumer();
+    std::string* out = &(*messages)[index];
+    return [out](spv_message_level_t level, const char*,
+                 const spv_position_t& position, const char* message) {
+      AppendMessage(level, position, message, out);
+    };
+  };
+
+  // The passes hold the context they run on, so each thread needs its own.
+  const bool concurrent =
+      count > 1 && utils::ResolveNumThreads(opt_options->num_threads_) > 1 &&
+      impl_->num_passes_from_flags == impl_->pass_manager.NumPasses();
+  std::vector<char> succeeded(count, 0);
+  if (concurrent) {
+    // The binaries are the unit of parallelism.
+    spv_optimizer_options_t module_options = *opt_options;
+    module_options.num_threads_ = 1;
+    module_options.val_options_.num_threads = 1;
+    utils::ParallelFor(
+        count, opt_options->num_threads_,
+        [this, &original_binaries, optimized_binaries, &consumer_for,
+         &module_options, &succeeded](size_t index) {
+          std::unique_ptr<Optimizer> optimizer =
+              impl_->CopyFromFlags(consumer_for(index));
+          const std::vector<uint32_t>& binary = original_binaries[index];
+          succeeded[index] =
+              optimizer &&
+              optimizer->Run(binary.data(), binary.size(),
+                             &(*optimized_binaries)[index], &module_options);
+        });
+  } else {
+    for (size_t index = 0; index < count; ++index) {
+      std::unique_ptr<Optimizer> optimizer =
+          impl_->CopyFromFlags(consumer_for(index));
+      if (!optimizer) continue;
+      optimizer->impl_->profile_stream = impl_->profile_stream;
+      const std::vector<uint32_t>& binary = original_binaries[index];
+      succeeded[index] = optimizer->Run(binary.data(), binary.size(),
+                                        &(*optimized_binaries)[index],
+                                        opt_options);
+      impl_->AddStatistics(optimizer->impl_->statistics);
+    }
+  }
+
+  bool ok = true;
+  for (size_t index = 0; index < count; ++index) {
+    if (!succeeded[index]) {
+      (*optimized_binaries)[index].clear();
+      ok = false;
+    }
+  }
+  return ok;
+}
+
 Optimizer& Optimizer::SetPrintAll(std::ostream* out) {
   impl_->pass_manager.SetPrintAll(out);
   return *this;
@@ -604,6 +1428,22 @@ Optimizer& Optimizer::SetValidateAfterAll(bool validate) {
   return *this;
 }
 
+Optimizer& Optimizer::SetProfileTrace(std::ostream* out) {
+  impl_->profile_stream = out;
+  return *this;
+}
+
+Optimizer& Optimizer::SetBlockCounts(
+    const std::unordered_map<uint32_t, uint64_t>& counts) {
+  impl_->block_counts = counts;
+  return *this;
+}
+
+Optimizer& Optimizer::SetCache(OptimizationCache* cache) {
+  impl_->cache = cache;
+  return *this;
+}
+
 Optimizer::PassToken CreateNullPass() {
   return MakeUnique<Optimizer::PassToken::Impl>(MakeUnique<opt::NullPass>());
 }
@@ -695,6 +1535,11 @@ Optimizer::PassToken CreateInlineOpaquePass() {
       MakeUnique<opt::InlineOpaquePass>());
 }
 
+Optimizer::PassToken CreateInlineCostPass(uint32_t budget) {
+  return MakeUnique<Optimizer::PassToken::Impl>(
+      MakeUnique<opt::InlineCostPass>(budget));
+}
+
 Optimizer::PassToken CreateLocalAccessChainConvertPass() {
   return MakeUnique<Optimizer::PassToken::Impl>(
       MakeUnique<opt::LocalAccessChainConvertPass>());
@@ -710,6 +1555,11 @@ Optimizer::PassToken CreateLocalSingleStoreElimPass() {
       MakeUnique<opt::LocalSingleStoreElimPass>());
 }
 
+Optimizer::PassToken CreateMemoryLoadStoreElimPass() {
+  return MakeUnique<Optimizer::PassToken::Impl>(
+      MakeUnique<opt::MemoryLoadStoreElimPass>());
+}
+
 Optimizer::PassToken CreateInsertExtractElimPass() {
   return MakeUnique<Optimizer::PassToken::Impl>(
       MakeUnique<opt::SimplificationPass>());
@@ -745,9 +1595,14 @@ Optimizer::PassToken CreateRedundantLineInfoElimPass() {
       MakeUnique<opt::ProcessLinesPass>(opt::kLinesEliminateDeadLines));
 }
 
-Optimizer::PassToken CreateCompactIdsPass() {
+Optimizer::PassToken CreateCompactIdsPass(bool order_by_locality) {
   return MakeUnique<Optimizer::PassToken::Impl>(
-      MakeUnique<opt::CompactIdsPass>());
+      MakeUnique<opt::CompactIdsPass>(order_by_locality));
+}
+
+Optimizer::PassToken CreateMergeIdenticalFunctionsPass() {
+  return MakeUnique<Optimizer::PassToken::Impl>(
+      MakeUnique<opt::MergeIdenticalFunctionsPass>());
 }
 
 Optimizer::PassToken CreateMergeReturnPass() {
@@ -755,6 +1610,10 @@ Optimizer::PassToken CreateMergeReturnPass() {
       MakeUnique<opt::MergeReturnPass>());
 }
 
+Optimizer::Statistics Optimizer::GetStatistics() const {
+  return impl_->statistics;
+}
+
 std::vector<const char*> Optimizer::GetPassNames() const {
   std::vector<const char*> v;
   for (uint32_t i = 0; i < impl_->pass_manager.NumPasses(); i++) {
@@ -773,14 +1632,17 @@ Optimizer::PassToken CreateLocalRedundancyEliminationPass() {
       MakeUnique<opt::LocalRedundancyEliminationPass>());
 }
 
-Optimizer::PassToken CreateLoopFissionPass(size_t threshold) {
+Optimizer::PassToken CreateLoopFissionPass(size_t threshold,
+                                           bool keep_reused_data) {
   return MakeUnique<Optimizer::PassToken::Impl>(
-      MakeUnique<opt::LoopFissionPass>(threshold));
+      MakeUnique<opt::LoopFissionPass>(threshold, true, keep_reused_data));
 }
 
-Optimizer::PassToken CreateLoopFusionPass(size_t max_registers_per_loop) {
+Optimizer::PassToken CreateLoopFusionPass(size_t max_registers_per_loop,
+                                          bool shared_data_only) {
   return MakeUnique<Optimizer::PassToken::Impl>(
-      MakeUnique<opt::LoopFusionPass>(max_registers_per_loop));
+      MakeUnique<opt::LoopFusionPass>(max_registers_per_loop,
+                                      shared_data_only));
 }
 
 Optimizer::PassToken CreateLoopInvariantCodeMotionPass() {
@@ -792,9 +1654,9 @@ Optimizer::PassToken CreateLoopPeelingPass() {
       MakeUnique<opt::LoopPeelingPass>());
 }
 
-Optimizer::PassToken CreateLoopUnswitchPass() {
+Optimizer::PassToken CreateLoopUnswitchPass(uint32_t size_budget) {
   return MakeUnique<Optimizer::PassToken::Impl>(
-      MakeUnique<opt::LoopUnswitchPass>());
+      MakeUnique<opt::LoopUnswitchPass>(size_budget));
 }
 
 Optimizer::PassToken CreateRedundancyEliminationPass() {
@@ -802,6 +1664,11 @@ Optimizer::PassToken CreateRedundancyEliminationPass() {
       MakeUnique<opt::RedundancyEliminationPass>());
 }
 
+Optimizer::PassToken CreatePartialRedundancyEliminationPass() {
+  return MakeUnique<Optimizer::PassToken::Impl>(
+      MakeUnique<opt::PartialRedundancyEliminationPass>());
+}
+
 Optimizer::PassToken CreateRemoveDuplicatesPass() {
   return MakeUnique<Optimizer::PassToken::Impl>(
       MakeUnique<opt::RemoveDuplicatesPass>());
@@ -812,6 +1679,11 @@ Optimizer::PassToken CreateScalarReplacementPass(uint32_t size_limit) {
       MakeUnique<opt::ScalarReplacementPass>(size_limit));
 }
 
+Optimizer::PassToken CreateSLPVectorizePass() {
+  return MakeUnique<Optimizer::PassToken::Impl>(
+      MakeUnique<opt::SLPVectorizePass>());
+}
+
 Optimizer::PassToken CreatePrivateToLocalPass() {
   return MakeUnique<Optimizer::PassToken::Impl>(
       MakeUnique<opt::PrivateToLocalPass>());
@@ -846,6 +1718,11 @@ Optimizer::PassToken CreateLoopUnrollPass(bool fully_unroll, int factor) {
       MakeUnique<opt::LoopUnroller>(fully_unroll, factor));
 }
 
+Optimizer::PassToken CreateLoopUnrollAutoPass(size_t max_registers) {
+  return MakeUnique<Optimizer::PassToken::Impl>(
+      MakeUnique<opt::LoopUnroller>(max_registers));
+}
+
 Optimizer::PassToken CreateSSARewritePass() {
   return MakeUnique<Optimizer::PassToken::Impl>(
       MakeUnique<opt::SSARewritePass>());
@@ -879,11 +1756,13 @@ Optimizer::PassToken CreateInstBindlessCheckPass(uint32_t desc_set,
                                                  uint32_t shader_id,
                                                  bool input_length_enable,
                                                  bool input_init_enable,
-                                                 uint32_t version) {
+                                                 uint32_t version,
+                                                 uint32_t sample_rate,
+                                                 bool dedup_checks) {
   return MakeUnique<Optimizer::PassToken::Impl>(
-      MakeUnique<opt::InstBindlessCheckPass>(desc_set, shader_id,
-                                             input_length_enable,
-                                             input_init_enable, version));
+      MakeUnique<opt::InstBindlessCheckPass>(
+          desc_set, shader_id, input_length_enable, input_init_enable, version,
+          sample_rate, dedup_checks));
 }
 
 Optimizer::PassToken CreateInstBuffAddrCheckPass(uint32_t desc_set,
@@ -893,6 +1772,12 @@ Optimizer::PassToken CreateInstBuffAddrCheckPass(uint32_t desc_set,
       MakeUnique<opt::InstBuffAddrCheckPass>(desc_set, shader_id, version));
 }
 
+Optimizer::PassToken CreateInstProfilePass(uint32_t desc_set,
+                                           uint32_t shader_id) {
+  return MakeUnique<Optimizer::PassToken::Impl>(
+      MakeUnique<opt::InstProfilePass>(desc_set, shader_id));
+}
+
 Optimizer::PassToken CreateConvertRelaxedToHalfPass() {
   return MakeUnique<Optimizer::PassToken::Impl>(
       MakeUnique<opt::ConvertToHalfPass>());
@@ -903,11 +1788,21 @@ Optimizer::PassToken CreateRelaxFloatOpsPass() {
       MakeUnique<opt::RelaxFloatOpsPass>());
 }
 
+Optimizer::PassToken CreateRelaxFloatOpsInRangePass(float max_magnitude) {
+  return MakeUnique<Optimizer::PassToken::Impl>(
+      MakeUnique<opt::RelaxFloatOpsPass>(max_magnitude));
+}
+
 Optimizer::PassToken CreateCodeSinkingPass() {
   return MakeUnique<Optimizer::PassToken::Impl>(
       MakeUnique<opt::CodeSinkingPass>());
 }
 
+Optimizer::PassToken CreateReduceRegisterPressurePass(size_t max_registers) {
+  return MakeUnique<Optimizer::PassToken::Impl>(
+      MakeUnique<opt::ReduceRegisterPressurePass>(max_registers));
+}
+
 Optimizer::PassToken CreateGenerateWebGPUInitializersPass() {
   return MakeUnique<Optimizer::PassToken::Impl>(
       MakeUnique<opt::GenerateWebGPUInitializersPass>());
@@ -943,6 +1838,12 @@ Optimizer::PassToken CreateDescriptorScalarReplacementPass() {
       MakeUnique<opt::DescriptorScalarReplacement>());
 }
 
+Optimizer::PassToken CreatePartialDescriptorScalarReplacementPass(
+    int32_t first_binding) {
+  return MakeUnique<Optimizer::PassToken::Impl>(
+      MakeUnique<opt::DescriptorScalarReplacement>(true, first_binding));
+}
+
 Optimizer::PassToken CreateWrapOpKillPass() {
   return MakeUnique<Optimizer::PassToken::Impl>(MakeUnique<opt::WrapOpKill>());
 }
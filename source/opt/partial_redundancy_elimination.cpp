@@ -0,0 +1,201 @@
+// Copyright (c) 2019 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "source/opt/partial_redundancy_elimination.h"
+
+#include <algorithm>
+#include <memory>
+
+namespace spvtools {
+namespace opt {
+namespace {
+
+// Returns true if the values of |type| may be merged by an OpPhi.
+bool IsMergeableType(const analysis::Type* type) {
+  return type->AsBool() || type->AsInteger() || type->AsFloat() ||
+         type->AsVector() || type->AsMatrix();
+}
+
+}  // namespace
+
+Pass::Status PartialRedundancyEliminationPass::Process() {
+  bool modified = false;
+  const ValueNumberTable& vn_table = *context()->GetValueNumberTable();
+  for (auto& func : *get_module()) {
+    if (!ShouldProcessFunction(&func)) continue;
+    Status status = ProcessFunction(&func, vn_table);
+    if (status == Status::Failure) return status;
+    if (status == Status::SuccessWithChange) {
+      modified = true;
+      RecordChangedFunction(&func);
+    }
+  }
+  return modified ? Status::SuccessWithChange : Status::SuccessWithoutChange;
+}
+
+Pass::Status PartialRedundancyEliminationPass::ProcessFunction(
+    Function* func, const ValueNumberTable& vn_table) {
+  ValueToInsts value_to_insts;
+  func->ForEachInst([&vn_table, &value_to_insts](Instruction* inst) {
+    if (!inst->HasResultId()) return;
+    const uint32_t value = vn_table.GetValueNumber(inst);
+    if (value != 0) value_to_insts[value].push_back(inst);
+  });
+
+  // Visiting the blocks in reverse post order lets the values merged in a
+  // block be available in the blocks it dominates.
+  std::vector<BasicBlock*> blocks;
+  cfg()->ForEachBlockInReversePostOrder(
+      func->entry().get(), [&blocks](BasicBlock* bb) { blocks.push_back(bb); });
+
+  DominatorAnalysis* dom = context()->GetDominatorAnalysis(func);
+  Status status = Status::SuccessWithoutChange;
+  for (BasicBlock* bb : blocks) {
+    // A block branching twice to |bb| is a single predecessor for OpPhi.
+    std::vector<uint32_t> preds;
+    for (uint32_t pred : cfg()->preds(bb->id())) {
+      if (std::find(preds.begin(), preds.end(), pred) == preds.end()) {
+        preds.push_back(pred);
+      }
+    }
+    if (preds.size() < 2) continue;
+    const bool reachable_preds =
+        std::all_of(preds.begin(), preds.end(), [dom](uint32_t pred) {
+          return dom->GetDomTree().ReachableFromRoots(pred);
+        });
+    if (!reachable_preds) continue;
+
+    std::vector<Instruction*> candidates;
+    for (Instruction& inst : *bb) {
+      if (IsCandidate(&inst, bb, dom)) candidates.push_back(&inst);
+    }
+    for (Instruction* inst : candidates) {
+      Status inst_status = EliminatePartialRedundancy(
+          inst, bb, preds, dom, vn_table, &value_to_insts);
+      if (inst_status == Status::Failure) return inst_status;
+      if (inst_status == Status::SuccessWithChange) status = inst_status;
+    }
+  }
+  return status;
+}
+
+bool PartialRedundancyEliminationPass::IsCandidate(
+    Instruction* inst, BasicBlock* bb, DominatorAnalysis* dom) const {
+  if (!inst->IsOpcodeCodeMotionSafe() || inst->type_id() == 0) return false;
+  switch (inst->opcode()) {
+    case SpvOpNop:
+    case SpvOpUndef:
+    case SpvOpLoad:
+      return false;
+    default:
+      break;
+  }
+  if (!IsMergeableType(context()->get_type_mgr()->GetType(inst->type_id()))) {
+    return false;
+  }
+  return inst->WhileEachInId([this, bb, dom](const uint32_t* id) {
+    Instruction* def = get_def_use_mgr()->GetDef(*id);
+    BasicBlock* def_bb = context()->get_instr_block(def);
+    return def_bb == nullptr || dom->StrictlyDominates(def_bb, bb);
+  });
+}
+
+Pass::Status PartialRedundancyEliminationPass::EliminatePartialRedundancy(
+    Instruction* inst, BasicBlock* bb, const std::vector<uint32_t>& preds,
+    DominatorAnalysis* dom, const ValueNumberTable& vn_table,
+    ValueToInsts* value_to_insts) {
+  const uint32_t value = vn_table.GetValueNumber(inst);
+  if (value == 0) return Status::SuccessWithoutChange;
+  std::vector<Instruction*>& same_insts = (*value_to_insts)[value];
+  if (same_insts.size() < 2) return Status::SuccessWithoutChange;
+
+  // The id of the value available at the end of each predecessor, or 0.
+  std::vector<uint32_t> available_ids;
+  bool partially_available = false;
+  for (uint32_t pred : preds) {
+    BasicBlock* pred_bb = cfg()->block(pred);
+    uint32_t available_id = 0;
+    for (Instruction* other : same_insts) {
+      if (other == inst) continue;
+      BasicBlock* other_bb = context()->get_instr_block(other);
+      if (other_bb != nullptr && dom->Dominates(other_bb, pred_bb)) {
+        available_id = other->result_id();
+        break;
+      }
+    }
+    if (available_id != 0) {
+      partially_available = true;
+    } else if (pred_bb->terminator()->opcode() != SpvOpBranch) {
+      // A copy at the end of |pred_bb| would be computed on the paths not
+      // going through |bb| too.
+      return Status::SuccessWithoutChange;
+    }
+    available_ids.push_back(available_id);
+  }
+  if (!partially_available) return Status::SuccessWithoutChange;
+
+  for (size_t i = 0; i < preds.size(); ++i) {
+    if (available_ids[i] != 0) continue;
+    Instruction* copy = InsertCopyAtEnd(inst, cfg()->block(preds[i]));
+    if (copy == nullptr) return Status::Failure;
+    available_ids[i] = copy->result_id();
+    same_insts.push_back(copy);
+  }
+
+  uint32_t replacement_id = available_ids[0];
+  if (std::any_of(available_ids.begin(), available_ids.end(),
+                  [replacement_id](uint32_t id) {
+                    return id != replacement_id;
+                  })) {
+    replacement_id = TakeNextId();
+    if (replacement_id == 0) return Status::Failure;
+    std::vector<Operand> phi_operands;
+    for (size_t i = 0; i < preds.size(); ++i) {
+      phi_operands.push_back({SPV_OPERAND_TYPE_ID, {available_ids[i]}});
+      phi_operands.push_back({SPV_OPERAND_TYPE_ID, {preds[i]}});
+    }
+    std::unique_ptr<Instruction> phi(new Instruction(
+        context(), SpvOpPhi, inst->type_id(), replacement_id, phi_operands));
+    Instruction* added = bb->begin()->InsertBefore(std::move(phi));
+    get_def_use_mgr()->AnalyzeInstDefUse(added);
+    context()->set_instr_block(added, bb);
+    get_decoration_mgr()->CloneDecorations(inst->result_id(), replacement_id);
+    same_insts.push_back(added);
+  }
+
+  same_insts.erase(std::find(same_insts.begin(), same_insts.end(), inst));
+  context()->KillNamesAndDecorates(inst);
+  context()->ReplaceAllUsesWith(inst->result_id(), replacement_id);
+  context()->KillInst(inst);
+  return Status::SuccessWithChange;
+}
+
+Instruction* PartialRedundancyEliminationPass::InsertCopyAtEnd(
+    Instruction* inst, BasicBlock* bb) {
+  std::unique_ptr<Instruction> copy(inst->Clone(context()));
+  const uint32_t copy_id = TakeNextId();
+  if (copy_id == 0) return nullptr;
+  copy->SetResultId(copy_id);
+
+  Instruction* insert_before = bb->GetMergeInst();
+  if (insert_before == nullptr) insert_before = bb->terminator();
+  Instruction* added = insert_before->InsertBefore(std::move(copy));
+  get_decoration_mgr()->CloneDecorations(inst->result_id(), copy_id);
+  get_def_use_mgr()->AnalyzeInstDefUse(added);
+  context()->set_instr_block(added, bb);
+  return added;
+}
+
+}  // namespace opt
+}  // namespace spvtools
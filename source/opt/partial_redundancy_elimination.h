@@ -0,0 +1,89 @@
+// Copyright (c) 2019 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef SOURCE_OPT_PARTIAL_REDUNDANCY_ELIMINATION_H_
+#define SOURCE_OPT_PARTIAL_REDUNDANCY_ELIMINATION_H_
+
+#include <unordered_map>
+#include <vector>
+
+#include "source/opt/dominator_analysis.h"
+#include "source/opt/ir_context.h"
+#include "source/opt/pass.h"
+#include "source/opt/value_number_table.h"
+
+namespace spvtools {
+namespace opt {
+
+// This pass removes the computations of a block with several predecessors
+// whose value, as given by |ValueNumberTable|, is already available at the end
+// of some of the predecessors.  A copy of the computation is inserted at the
+// end of each predecessor where the value is not available, and the
+// computation is replaced by an OpPhi merging the values of the
+// predecessors.  This covers the values computed on some of the paths to a
+// block, and the values computed in a loop and again in its header.
+//
+// A copy is only inserted in a predecessor whose only successor is the block,
+// so no path computes the value more often than before.  The operands of the
+// computation must be defined in blocks strictly dominating the block, and
+// its result must be a scalar, a vector or a matrix.  Loads are left alone,
+// since the memory could change before them in the block.
+class PartialRedundancyEliminationPass : public Pass {
+ public:
+  const char* name() const override { return "partial-redundancy-elimination"; }
+  Status Process() override;
+
+  IRContext::Analysis GetPreservedAnalyses() override {
+    return IRContext::kAnalysisDefUse |
+           IRContext::kAnalysisInstrToBlockMapping |
+           IRContext::kAnalysisDecorations | IRContext::kAnalysisCombinators |
+           IRContext::kAnalysisCFG | IRContext::kAnalysisDominatorAnalysis |
+           IRContext::kAnalysisLoopAnalysis | IRContext::kAnalysisNameMap |
+           IRContext::kAnalysisConstants | IRContext::kAnalysisTypes;
+  }
+
+ private:
+  // The instructions of a function computing each value number.
+  using ValueToInsts = std::unordered_map<uint32_t, std::vector<Instruction*>>;
+
+  // Removes the partial redundancies of |func|.  |vn_table| must have
+  // computed a value number for every result id defined in |func|.  Returns
+  // the status.
+  Status ProcessFunction(Function* func, const ValueNumberTable& vn_table);
+
+  // Returns true if |inst| of |bb| may be computed at the end of the
+  // predecessors of |bb| instead.  |dom| is the dominator analysis of the
+  // function.
+  bool IsCandidate(Instruction* inst, BasicBlock* bb,
+                   DominatorAnalysis* dom) const;
+
+  // Replaces |inst| of |bb| by an OpPhi if its value is available at the end
+  // of some of |preds|, the predecessors of |bb|, inserting copies of |inst|
+  // in the others.  |value_to_insts| is updated with the new instructions.
+  // Returns the status.
+  Status EliminatePartialRedundancy(Instruction* inst, BasicBlock* bb,
+                                    const std::vector<uint32_t>& preds,
+                                    DominatorAnalysis* dom,
+                                    const ValueNumberTable& vn_table,
+                                    ValueToInsts* value_to_insts);
+
+  // Inserts a copy of |inst| at the end of |bb|, before its merge instruction
+  // if any.  Returns the copy, or nullptr if the ids overflow.
+  Instruction* InsertCopyAtEnd(Instruction* inst, BasicBlock* bb);
+};
+
+}  // namespace opt
+}  // namespace spvtools
+
+#endif  // SOURCE_OPT_PARTIAL_REDUNDANCY_ELIMINATION_H_
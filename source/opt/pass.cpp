@@ -28,7 +28,11 @@ const uint32_t kTypePointerTypeIdInIdx = 1;
 
 }  // namespace
 
-Pass::Pass() : consumer_(nullptr), context_(nullptr), already_run_(false) {}
+Pass::Pass()
+    : consumer_(nullptr),
+      context_(nullptr),
+      already_run_(false),
+      functions_to_process_(nullptr) {}
 
 Pass::Status Pass::Run(IRContext* ctx) {
   if (already_run_) {
@@ -36,12 +40,24 @@ Pass::Status Pass::Run(IRContext* ctx) {
   }
   already_run_ = true;
 
+  if (IsNoOp(ctx)) {
+    return Status::SuccessWithoutChange;
+  }
+
   context_ = ctx;
   Pass::Status status = Process();
   context_ = nullptr;
 
   if (status == Status::SuccessWithChange) {
-    ctx->InvalidateAnalysesExceptFor(GetPreservedAnalyses());
+    if (changed_functions_.empty()) {
+      ctx->InvalidateAnalysesExceptFor(GetPreservedAnalyses());
+    } else {
+      const IRContext::Analysis not_preserved = IRContext::Analysis(
+          (IRContext::kAnalysisEnd - 1) & ~GetPreservedAnalyses());
+      for (Function* function : changed_functions_) {
+        ctx->InvalidateAnalysesForFunction(function, not_preserved);
+      }
+    }
   }
   assert((status == Status::Failure || ctx->IsConsistent()) &&
          "An analysis in the context is out of date.");
@@ -17,11 +17,13 @@
 
 #include <algorithm>
 #include <map>
+#include <memory>
 #include <unordered_map>
 #include <unordered_set>
 #include <utility>
 
 #include "source/opt/basic_block.h"
+#include "source/opt/binary_filter.h"
 #include "source/opt/def_use_manager.h"
 #include "source/opt/ir_context.h"
 #include "source/opt/module.h"
@@ -101,11 +103,50 @@ class Pass {
   // If this happens the return value will be |Failure|.
   Status Run(IRContext* ctx);
 
+  // Returns true if the pass is known to leave the module of the given context
+  // unchanged, so that it need not run.  This must be cheap: passes override
+  // it with checks of the module summary and the features of the module.  By
+  // default a pass may always change the module.
+  virtual bool IsNoOp(IRContext*) const { return false; }
+
+  // Returns true if the pass must run even once the time budget of the pass
+  // manager is spent, because the module is not fit for its target
+  // environment without it.  Optimizations are not required: skipping one
+  // leaves a valid module, only less optimized.
+  virtual bool IsRequired() const { return false; }
+
+  // Returns true if the pass processes each function on its own and changes
+  // nothing outside it but the global values it uses, so that it can run on a
+  // module in which the other functions are only declared.  See
+  // Optimizer::RunStreaming.
+  virtual bool IsFunctionLocal() const { return false; }
+
+  // Returns a filter that does the work of the pass on the binary of a module,
+  // or null if the pass has to run on the IR.  Only passes that delete
+  // instructions one by one can have one.  See BinaryFilter.
+  virtual std::unique_ptr<BinaryFilter> CreateBinaryFilter() const {
+    return nullptr;
+  }
+
   // Returns the set of analyses that the pass is guaranteed to preserve.
   virtual IRContext::Analysis GetPreservedAnalyses() {
     return IRContext::kAnalysisNone;
   }
 
+  // Restricts the pass to the functions in |*functions|, or lets it process
+  // every function if |functions| is null.  Only the passes that process each
+  // function on its own and record the functions they change honor the
+  // restriction.  The others process the module as usual.
+  void RestrictToFunctions(const std::unordered_set<Function*>* functions) {
+    functions_to_process_ = functions;
+  }
+
+  // Returns the functions changed by the pass.  It is empty if the pass does
+  // not record the functions it changes, even if it changed the module.
+  const std::unordered_set<Function*>& changed_functions() const {
+    return changed_functions_;
+  }
+
   // Return type id for |ptrInst|'s pointee
   uint32_t GetPointeeTypeId(const Instruction* ptrInst) const;
 
@@ -142,6 +183,21 @@ class Pass {
   uint32_t GenerateCopy(Instruction* object_to_copy, uint32_t new_type_id,
                         Instruction* insertion_position);
 
+  // Records that the pass changed |function|.  If a pass records the functions
+  // it changes, the CFG, dominator and loop analyses it does not preserve are
+  // only invalidated for those functions.  Such a pass must record every
+  // function it changes, and must not add or remove functions.
+  void RecordChangedFunction(Function* function) {
+    changed_functions_.insert(function);
+  }
+
+  // Returns true if the pass should process |function|.  See
+  // |RestrictToFunctions|.
+  bool ShouldProcessFunction(Function* function) const {
+    return functions_to_process_ == nullptr ||
+           functions_to_process_->count(function) != 0;
+  }
+
  private:
   MessageConsumer consumer_;  // Message consumer.
 
@@ -152,6 +208,13 @@ class Pass {
   // enforce proper resetting of internal state for each instance.  This member
   // is used to check that we do not run the same instance twice.
   bool already_run_;
+
+  // The functions changed by the pass, if it records them.
+  std::unordered_set<Function*> changed_functions_;
+
+  // The functions the pass is restricted to, or null if it processes every
+  // function.
+  const std::unordered_set<Function*>* functions_to_process_;
 };
 
 inline Pass::Status CombineStatus(Pass::Status a, Pass::Status b) {
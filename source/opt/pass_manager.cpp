@@ -14,12 +14,17 @@
 
 #include "source/opt/pass_manager.h"
 
+#include <chrono>
+#include <functional>
 #include <iostream>
+#include <memory>
 #include <string>
 #include <vector>
 
 #include "source/opt/ir_context.h"
+#include "source/util/profiler.h"
 #include "source/util/timer.h"
+#include "source/val/validate.h"
 #include "spirv-tools/libspirv.hpp"
 
 namespace spvtools {
@@ -43,20 +48,52 @@ Pass::Status PassManager::Run(IRContext* context) {
     }
   };
 
+  // Validates after each pass with an incremental validator, so that the
+  // functions a pass did not change are not checked again.  The module is
+  // validated from its instructions, without making its binary.
+  Context val_context(target_env_);
+  val_context.SetMessageConsumer(consumer());
+  std::unique_ptr<spv_incremental_validator_t,
+                  decltype(&spvIncrementalValidatorDestroy)>
+      validator(validate_after_all_
+                    ? spvIncrementalValidatorCreate(val_context.CContext(),
+                                                    val_options_)
+                    : nullptr,
+                spvIncrementalValidatorDestroy);
+
+  const auto start_time = std::chrono::steady_clock::now();
+  num_skipped_passes_ = 0;
+
   SPIRV_TIMER_DESCRIPTION(time_report_stream_, /* measure_mem_usage = */ true);
   for (auto& pass : passes_) {
+    if (time_budget_.count() != 0 && !pass->IsRequired() &&
+        std::chrono::steady_clock::now() - start_time >= time_budget_) {
+      // Out of time: the module is left as optimized so far.
+      ++num_skipped_passes_;
+      pass.reset(nullptr);
+      continue;
+    }
     print_disassembly("; IR before pass ", pass.get());
     SPIRV_TIMER_SCOPED(time_report_stream_, (pass ? pass->name() : ""), true);
-    const auto one_status = pass->Run(context);
+    if (pass->IsNoOp(context)) {
+      // The pass would leave the module as it is, so there is nothing to run
+      // or to validate.
+      pass.reset(nullptr);
+      continue;
+    }
+    Pass::Status one_status;
+    {
+      utils::ProfileScope scope(context->profiler(), "pass", pass->name());
+      one_status = pass->Run(context);
+    }
     if (one_status == Pass::Status::Failure) return one_status;
     if (one_status == Pass::Status::SuccessWithChange) status = one_status;
 
-    if (validate_after_all_) {
-      spvtools::SpirvTools tools(target_env_);
-      tools.SetMessageConsumer(consumer());
-      std::vector<uint32_t> binary;
-      context->module()->ToBinary(&binary, true);
-      if (!tools.Validate(binary.data(), binary.size(), val_options_)) {
+    if (validator) {
+      utils::ProfileScope scope(context->profiler(), "module", "validate");
+      if (val::ValidateModuleInstructions(
+              validator.get(), GetModuleInstructions(*context->module()),
+              nullptr) != SPV_SUCCESS) {
         std::string msg = "Validation failed after pass ";
         msg += pass->name();
         spv_position_t null_pos{0, 0, 0};
@@ -69,6 +106,13 @@ Pass::Status PassManager::Run(IRContext* context) {
     pass.reset(nullptr);
   }
   print_disassembly("; IR after last pass", nullptr);
+  if (num_skipped_passes_ != 0 && consumer()) {
+    std::string msg = "Time budget spent, skipped ";
+    msg += std::to_string(num_skipped_passes_);
+    msg += num_skipped_passes_ == 1 ? " pass" : " passes";
+    spv_position_t null_pos{0, 0, 0};
+    consumer()(SPV_MSG_INFO, "", null_pos, msg.c_str());
+  }
 
   // Set the Id bound in the header in case a pass forgot to do so.
   //
@@ -81,5 +125,26 @@ Pass::Status PassManager::Run(IRContext* context) {
   return status;
 }
 
+bool PassManager::RunAsBinaryFilters(spv_target_env target_env,
+                                     const uint32_t* words, size_t num_words,
+                                     std::vector<uint32_t>* binary) {
+  if (passes_.empty() || print_all_stream_ || time_report_stream_ ||
+      validate_after_all_) {
+    return false;
+  }
+
+  std::vector<std::unique_ptr<BinaryFilter>> filters;
+  for (auto& pass : passes_) {
+    std::unique_ptr<BinaryFilter> filter = pass->CreateBinaryFilter();
+    if (!filter) return false;
+    filters.push_back(std::move(filter));
+  }
+  if (!RunBinaryFilters(target_env, filters, words, num_words, binary)) {
+    return false;
+  }
+  passes_.clear();
+  return true;
+}
+
 }  // namespace opt
 }  // namespace spvtools
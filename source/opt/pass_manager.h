@@ -15,6 +15,7 @@
 #ifndef SOURCE_OPT_PASS_MANAGER_H_
 #define SOURCE_OPT_PASS_MANAGER_H_
 
+#include <chrono>
 #include <memory>
 #include <ostream>
 #include <utility>
@@ -46,7 +47,9 @@ class PassManager {
         time_report_stream_(nullptr),
         target_env_(SPV_ENV_UNIVERSAL_1_2),
         val_options_(nullptr),
-        validate_after_all_(false) {}
+        validate_after_all_(false),
+        time_budget_(0),
+        num_skipped_passes_(0) {}
 
   // Sets the message consumer to the given |consumer|.
   void SetMessageConsumer(MessageConsumer c) { consumer_ = std::move(c); }
@@ -76,6 +79,16 @@ class PassManager {
   // After running all the passes, they are removed from the list.
   Pass::Status Run(IRContext* context);
 
+  // Runs all passes on the module of |num_words| words at |words| for
+  // |target_env| without building its IR, and writes the result to |binary|.
+  // This is only possible if every pass has a BinaryFilter, and if nothing is
+  // to be printed or validated after each pass.  Returns false, with no pass
+  // run, if it is not possible or if a filter cannot handle the module.
+  //
+  // On success, the passes are removed from the list, as with Run().
+  bool RunAsBinaryFilters(spv_target_env target_env, const uint32_t* words,
+                          size_t num_words, std::vector<uint32_t>* binary);
+
   // Sets the option to print the disassembly before each pass and after the
   // last pass.   Output is written to |out| if that is not null.  No output
   // is generated if |out| is null.
@@ -110,6 +123,22 @@ class PassManager {
     return *this;
   }
 
+  // Returns true if the module is validated after each pass.
+  bool validate_after_all() const { return validate_after_all_; }
+
+  // Sets the time Run() may spend running passes.  Once it is spent, the
+  // passes left which are not required are skipped, see Pass::IsRequired.
+  // The check is made before each pass, so the budget can be exceeded by the
+  // time of one pass.  A budget of 0 means no limit.
+  PassManager& SetTimeBudget(std::chrono::microseconds budget) {
+    time_budget_ = budget;
+    return *this;
+  }
+
+  // Returns the number of passes the last call to Run() skipped because the
+  // time budget was spent.
+  uint32_t NumSkippedPasses() const { return num_skipped_passes_; }
+
  private:
   // Consumer for messages.
   MessageConsumer consumer_;
@@ -127,6 +156,10 @@ class PassManager {
   spv_validator_options val_options_;
   // Controls whether validation occurs after every pass.
   bool validate_after_all_;
+  // The time the passes may take, or 0 for no limit.
+  std::chrono::microseconds time_budget_;
+  // The number of passes skipped by the last run for lack of time.
+  uint32_t num_skipped_passes_;
 };
 
 inline void PassManager::AddPass(std::unique_ptr<Pass> pass) {
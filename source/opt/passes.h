@@ -36,16 +36,19 @@
 #include "source/opt/eliminate_dead_functions_pass.h"
 #include "source/opt/eliminate_dead_members_pass.h"
 #include "source/opt/fix_storage_class.h"
+#include "source/opt/fixpoint_pass.h"
 #include "source/opt/flatten_decoration_pass.h"
 #include "source/opt/fold_spec_constant_op_and_composite_pass.h"
 #include "source/opt/freeze_spec_constant_value_pass.h"
 #include "source/opt/generate_webgpu_initializers_pass.h"
 #include "source/opt/graphics_robust_access_pass.h"
 #include "source/opt/if_conversion.h"
+#include "source/opt/inline_cost_pass.h"
 #include "source/opt/inline_exhaustive_pass.h"
 #include "source/opt/inline_opaque_pass.h"
 #include "source/opt/inst_bindless_check_pass.h"
 #include "source/opt/inst_buff_addr_check_pass.h"
+#include "source/opt/inst_profile_pass.h"
 #include "source/opt/legalize_vector_shuffle_pass.h"
 #include "source/opt/licm_pass.h"
 #include "source/opt/local_access_chain_convert_pass.h"
@@ -57,17 +60,22 @@
 #include "source/opt/loop_peeling.h"
 #include "source/opt/loop_unroller.h"
 #include "source/opt/loop_unswitch_pass.h"
+#include "source/opt/memory_load_store_elim_pass.h"
+#include "source/opt/merge_identical_functions_pass.h"
 #include "source/opt/merge_return_pass.h"
 #include "source/opt/null_pass.h"
+#include "source/opt/partial_redundancy_elimination.h"
 #include "source/opt/private_to_local_pass.h"
 #include "source/opt/process_lines_pass.h"
 #include "source/opt/reduce_load_size.h"
+#include "source/opt/reduce_register_pressure.h"
 #include "source/opt/redundancy_elimination.h"
 #include "source/opt/relax_float_ops_pass.h"
 #include "source/opt/remove_duplicates_pass.h"
 #include "source/opt/replace_invalid_opc.h"
 #include "source/opt/scalar_replacement_pass.h"
 #include "source/opt/set_spec_constant_default_value_pass.h"
+#include "source/opt/slp_vectorize_pass.h"
 #include "source/opt/simplification_pass.h"
 #include "source/opt/split_invalid_unreachable_pass.h"
 #include "source/opt/ssa_rewrite_pass.h"
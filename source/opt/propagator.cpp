@@ -17,8 +17,17 @@
 namespace spvtools {
 namespace opt {
 
-void SSAPropagator::AddControlEdge(const Edge& edge) {
-  BasicBlock* dest_bb = edge.dest;
+uint32_t SSAPropagator::FindEdge(BasicBlock* source, BasicBlock* dest) const {
+  const auto range = SuccessorEdges(source);
+  for (uint32_t i = range.first; i < range.second; ++i) {
+    if (edges_[i].dest == dest) return i;
+  }
+  assert(false && "No CFG edge between the blocks.");
+  return static_cast<uint32_t>(edges_.size());
+}
+
+void SSAPropagator::AddControlEdge(uint32_t edge) {
+  BasicBlock* dest_bb = edges_[edge].dest;
 
   // Refuse to add the exit block to the work list.
   if (dest_bb == ctx_->cfg()->pseudo_exit_block()) {
@@ -64,7 +73,7 @@ bool SSAPropagator::IsPhiArgExecutable(Instruction* phi, uint32_t i) const {
   Instruction* in_label_instr = get_def_use_mgr()->GetDef(in_label_id);
   BasicBlock* in_bb = ctx_->get_instr_block(in_label_instr);
 
-  return IsEdgeExecutable(Edge(in_bb, phi_bb));
+  return IsEdgeExecutable(FindEdge(in_bb, phi_bb));
 }
 
 bool SSAPropagator::SetStatus(Instruction* inst, PropStatus status) {
@@ -79,7 +88,7 @@ bool SSAPropagator::SetStatus(Instruction* inst, PropStatus status) {
          "Invalid lattice transition");
 
   bool status_changed = !has_old_status || (old_status != status);
-  if (status_changed) statuses_[inst] = status;
+  if (status_changed) statuses_.Set(inst->unique_id(), status);
 
   return status_changed;
 }
@@ -107,8 +116,8 @@ bool SSAPropagator::Simulate(Instruction* instr) {
     // If |instr| is a block terminator, add all the control edges out of its
     // block.
     if (instr->IsBlockTerminator()) {
-      BasicBlock* block = ctx_->get_instr_block(instr);
-      for (const auto& e : bb_succs_.at(block)) {
+      const auto range = SuccessorEdges(ctx_->get_instr_block(instr));
+      for (uint32_t e = range.first; e < range.second; ++e) {
         AddControlEdge(e);
       }
     }
@@ -123,7 +132,7 @@ bool SSAPropagator::Simulate(Instruction* instr) {
     // If there are multiple outgoing control flow edges and we know which one
     // will be taken, add the destination block to the CFG work list.
     if (dest_bb) {
-      AddControlEdge(Edge(ctx_->get_instr_block(instr), dest_bb));
+      AddControlEdge(FindEdge(ctx_->get_instr_block(instr), dest_bb));
     }
     changed = true;
   }
@@ -198,8 +207,9 @@ bool SSAPropagator::Simulate(BasicBlock* block) {
 
     // If this block has exactly one successor, mark the edge to its successor
     // as executable.
-    if (bb_succs_.at(block).size() == 1) {
-      AddControlEdge(bb_succs_.at(block).at(0));
+    const auto range = SuccessorEdges(block);
+    if (range.second - range.first == 1) {
+      AddControlEdge(range.first);
     }
   }
 
@@ -207,31 +217,36 @@ bool SSAPropagator::Simulate(BasicBlock* block) {
 }
 
 void SSAPropagator::Initialize(Function* fn) {
-  // Compute predecessor and successor blocks for every block in |fn|'s CFG.
+  // Compute the successor edges for every block in |fn|'s CFG.  The edges of
+  // each block are stored contiguously, so they can be numbered densely.
   // TODO(dnovillo): Move this to CFG and always build them. Alternately,
   // move it to IRContext and build CFG preds/succs on-demand.
-  bb_succs_[ctx_->cfg()->pseudo_entry_block()].push_back(
-      Edge(ctx_->cfg()->pseudo_entry_block(), fn->entry().get()));
+  BasicBlock* pseudo_entry = ctx_->cfg()->pseudo_entry_block();
+  BasicBlock* pseudo_exit = ctx_->cfg()->pseudo_exit_block();
+  edges_.clear();
+  executable_edges_ = utils::BitVector();
+  succ_edges_.assign(ctx_->module()->IdBound(), {0, 0});
+
+  edges_.push_back(Edge(pseudo_entry, fn->entry().get()));
+  succ_edges_[pseudo_entry->id()] = {0, 1};
 
   for (auto& block : *fn) {
+    const uint32_t first = static_cast<uint32_t>(edges_.size());
     const auto& const_block = block;
     const_block.ForEachSuccessorLabel([this, &block](const uint32_t label_id) {
       BasicBlock* succ_bb =
           ctx_->get_instr_block(get_def_use_mgr()->GetDef(label_id));
-      bb_succs_[&block].push_back(Edge(&block, succ_bb));
-      bb_preds_[succ_bb].push_back(Edge(succ_bb, &block));
+      edges_.push_back(Edge(&block, succ_bb));
     });
     if (block.IsReturnOrAbort()) {
-      bb_succs_[&block].push_back(
-          Edge(&block, ctx_->cfg()->pseudo_exit_block()));
-      bb_preds_[ctx_->cfg()->pseudo_exit_block()].push_back(
-          Edge(ctx_->cfg()->pseudo_exit_block(), &block));
+      edges_.push_back(Edge(&block, pseudo_exit));
     }
+    succ_edges_[block.id()] = {first, static_cast<uint32_t>(edges_.size())};
   }
 
   // Add the edges out of the entry block to seed the propagator.
-  const auto& entry_succs = bb_succs_[ctx_->cfg()->pseudo_entry_block()];
-  for (const auto& e : entry_succs) {
+  const auto entry_succs = SuccessorEdges(pseudo_entry);
+  for (uint32_t e = entry_succs.first; e < entry_succs.second; ++e) {
     AddControlEdge(e);
   }
 }
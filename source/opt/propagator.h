@@ -17,14 +17,12 @@
 
 #include <functional>
 #include <queue>
-#include <set>
-#include <unordered_map>
-#include <unordered_set>
 #include <utility>
 #include <vector>
 
 #include "source/opt/ir_context.h"
 #include "source/opt/module.h"
+#include "source/util/bit_vector.h"
 
 namespace spvtools {
 namespace opt {
@@ -43,6 +41,52 @@ struct Edge {
   }
 };
 
+// A table of lattice values indexed by a dense id, such as an SSA result id or
+// an instruction's unique id.  Ids that have no entry read as |unset_value|,
+// which must not be used as a real value.  The table grows on demand, so ids
+// created during propagation can be recorded as well.
+template <typename T>
+class DenseLattice {
+ public:
+  explicit DenseLattice(T unset_value) : unset_value_(unset_value) {}
+
+  // Makes room for the ids below |bound| so that recording them does not
+  // reallocate.
+  void Reserve(uint32_t bound) {
+    if (bound > values_.size()) values_.resize(bound, unset_value_);
+  }
+
+  // Returns true if |id| has a recorded value.
+  bool Has(uint32_t id) const { return Get(id) != unset_value_; }
+
+  // Returns the value recorded for |id|, or the unset value if there is none.
+  T Get(uint32_t id) const {
+    return id < values_.size() ? values_[id] : unset_value_;
+  }
+
+  // Records |value| for |id|.
+  void Set(uint32_t id, T value) {
+    if (id >= values_.size()) values_.resize(id + 1, unset_value_);
+    values_[id] = value;
+  }
+
+  // Calls |f| on each id with a recorded value and that value, in increasing
+  // order of id.
+  template <typename Functor>
+  void ForEach(Functor f) const {
+    for (uint32_t id = 0; id < values_.size(); ++id) {
+      if (values_[id] != unset_value_) f(id, values_[id]);
+    }
+  }
+
+  // Removes every recorded value.
+  void Clear() { values_.clear(); }
+
+ private:
+  T unset_value_;
+  std::vector<T> values_;
+};
+
 // This class implements a generic value propagation algorithm based on the
 // conditional constant propagation algorithm proposed in
 //
@@ -187,7 +231,7 @@ class SSAPropagator {
   using VisitFunction = std::function<PropStatus(Instruction*, BasicBlock**)>;
 
   SSAPropagator(IRContext* context, const VisitFunction& visit_fn)
-      : ctx_(context), visit_fn_(visit_fn) {}
+      : ctx_(context), visit_fn_(visit_fn), statuses_(kNoStatus) {}
 
   // Runs the propagator on function |fn|. Returns true if changes were made to
   // the function. Otherwise, it returns false.
@@ -200,12 +244,14 @@ class SSAPropagator {
 
   // Returns true if |inst| has a recorded status. This will be true once |inst|
   // has been simulated once.
-  bool HasStatus(Instruction* inst) const { return statuses_.count(inst); }
+  bool HasStatus(Instruction* inst) const {
+    return statuses_.Has(inst->unique_id());
+  }
 
   // Returns the current propagation status of |inst|. Assumes
   // |HasStatus(inst)| returns true.
   PropStatus Status(Instruction* inst) const {
-    return statuses_.find(inst)->second;
+    return static_cast<PropStatus>(statuses_.Get(inst->unique_id()));
   }
 
   // Records the propagation status |status| for |inst|. Returns true if the
@@ -213,6 +259,9 @@ class SSAPropagator {
   bool SetStatus(Instruction* inst, PropStatus status);
 
  private:
+  // Value of |statuses_| for instructions that have not been simulated yet.
+  enum : uint8_t { kNoStatus = 0xff };
+
   // Initialize processing.
   void Initialize(Function* fn);
 
@@ -228,41 +277,53 @@ class SSAPropagator {
 
   // Returns true if |instr| should be simulated again.
   bool ShouldSimulateAgain(Instruction* instr) const {
-    return do_not_simulate_.find(instr) == do_not_simulate_.end();
+    return !do_not_simulate_.Get(instr->unique_id());
   }
 
   // Add |instr| to the set of instructions not to simulate again.
-  void DontSimulateAgain(Instruction* instr) { do_not_simulate_.insert(instr); }
+  void DontSimulateAgain(Instruction* instr) {
+    do_not_simulate_.Set(instr->unique_id());
+  }
 
   // Returns true if |block| has been simulated already.
   bool BlockHasBeenSimulated(BasicBlock* block) const {
-    return simulated_blocks_.find(block) != simulated_blocks_.end();
+    return simulated_blocks_.Get(block->id());
   }
 
   // Marks block |block| as simulated.
   void MarkBlockSimulated(BasicBlock* block) {
-    simulated_blocks_.insert(block);
+    simulated_blocks_.Set(block->id());
   }
 
-  // Marks |edge| as executable.  Returns false if the edge was already marked
-  // as executable.
-  bool MarkEdgeExecutable(const Edge& edge) {
-    return executable_edges_.insert(edge).second;
+  // Marks the edge with index |edge| as executable.  Returns false if the edge
+  // was already marked as executable.
+  bool MarkEdgeExecutable(uint32_t edge) {
+    return !executable_edges_.Set(edge);
   }
 
-  // Returns true if |edge| has been marked as executable.
-  bool IsEdgeExecutable(const Edge& edge) const {
-    return executable_edges_.find(edge) != executable_edges_.end();
+  // Returns true if the edge with index |edge| has been marked as executable.
+  bool IsEdgeExecutable(uint32_t edge) const {
+    return executable_edges_.Get(edge);
   }
 
+  // Returns the indices in |edges_| of the successor edges of |block|, as a
+  // half-open range.
+  std::pair<uint32_t, uint32_t> SuccessorEdges(BasicBlock* block) const {
+    assert(block->id() < succ_edges_.size() && "Unknown block");
+    return succ_edges_[block->id()];
+  }
+
+  // Returns the index in |edges_| of the CFG edge from |source| to |dest|.
+  uint32_t FindEdge(BasicBlock* source, BasicBlock* dest) const;
+
   // Returns a pointer to the def-use manager for |ctx_|.
   analysis::DefUseManager* get_def_use_mgr() const {
     return ctx_->get_def_use_mgr();
   }
 
-  // If the CFG edge |e| has not been executed, this function adds |e|'s
-  // destination block to the work list.
-  void AddControlEdge(const Edge& e);
+  // If the CFG edge with index |edge| has not been executed, this function
+  // adds its destination block to the work list.
+  void AddControlEdge(uint32_t edge);
 
   // Adds all the instructions that use the result of |instr| to the SSA edges
   // work list. If |instr| produces no result id, this does nothing.
@@ -284,28 +345,28 @@ class SSAPropagator {
   // Blocks to simulate.
   std::queue<BasicBlock*> blocks_;
 
-  // Blocks simulated during propagation.
-  std::unordered_set<BasicBlock*> simulated_blocks_;
+  // Ids of the blocks simulated during propagation.
+  utils::BitVector simulated_blocks_;
 
-  // Set of instructions that should not be simulated again because they have
-  // been found to be in the kVarying state.
-  std::unordered_set<Instruction*> do_not_simulate_;
+  // Unique ids of the instructions that should not be simulated again because
+  // they have been found to be in the kVarying state.
+  utils::BitVector do_not_simulate_;
 
-  // Map between a basic block and its predecessor edges.
+  // CFG edges of the function being propagated, grouped by source block.  An
+  // edge is identified by its index in this vector.
   // TODO(dnovillo): Move this to CFG and always build them. Alternately,
   // move it to IRContext and build CFG preds/succs on-demand.
-  std::unordered_map<BasicBlock*, std::vector<Edge>> bb_preds_;
+  std::vector<Edge> edges_;
 
-  // Map between a basic block and its successor edges.
-  // TODO(dnovillo): Move this to CFG and always build them. Alternately,
-  // move it to IRContext and build CFG preds/succs on-demand.
-  std::unordered_map<BasicBlock*, std::vector<Edge>> bb_succs_;
+  // Range of indices in |edges_| of the successor edges of each block, indexed
+  // by block id.  The pseudo entry block has id 0.
+  std::vector<std::pair<uint32_t, uint32_t>> succ_edges_;
 
-  // Set of executable CFG edges.
-  std::set<Edge> executable_edges_;
+  // Indices of the executable CFG edges.
+  utils::BitVector executable_edges_;
 
-  // Tracks instruction propagation status.
-  std::unordered_map<Instruction*, SSAPropagator::PropStatus> statuses_;
+  // Tracks instruction propagation status, indexed by unique id.
+  DenseLattice<uint8_t> statuses_;
 };
 
 std::ostream& operator<<(std::ostream& str,
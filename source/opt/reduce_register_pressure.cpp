@@ -0,0 +1,326 @@
+// Copyright (c) 2019 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "source/opt/reduce_register_pressure.h"
+
+#include <algorithm>
+#include <limits>
+#include <memory>
+#include <unordered_set>
+#include <vector>
+
+#include "source/opt/ir_context.h"
+#include "source/opt/loop_descriptor.h"
+
+namespace spvtools {
+namespace opt {
+namespace {
+
+const uint32_t kLoadMemoryAccessInIdx = 1;
+
+// Returns the depth of the innermost loop containing |bb|, or 0 if it is not
+// in a loop.
+size_t LoopDepth(const LoopDescriptor& loops, const BasicBlock* bb) {
+  const Loop* loop = loops[bb];
+  return loop == nullptr ? 0 : loop->GetDepth();
+}
+
+}  // namespace
+
+Pass::Status ReduceRegisterPressurePass::Process() {
+  bool modified = false;
+  for (Function& function : *get_module()) {
+    if (!ShouldProcessFunction(&function) || !ExceedsBudget(&function)) {
+      continue;
+    }
+
+    Status status = RematerializeValues(&function);
+    if (status == Status::Failure) return status;
+    bool changed = status == Status::SuccessWithChange;
+
+    cfg()->ForEachBlockInPostOrder(function.entry().get(),
+                                   [&changed, this](BasicBlock* bb) {
+                                     if (SinkInstructionsInBB(bb)) {
+                                       changed = true;
+                                     }
+                                   });
+    if (changed) {
+      context()->InvalidateAnalyses(IRContext::kAnalysisRegisterPressure);
+    }
+
+    // Moving instructions within a block does not change its live-in and
+    // live-out sets, so the liveness of each block stays valid for the
+    // others.
+    const RegisterLiveness* liveness =
+        context()->GetLivenessAnalysis()->Get(&function);
+    for (BasicBlock& bb : function) {
+      const RegisterLiveness::RegionRegisterLiveness* bb_liveness =
+          liveness->Get(&bb);
+      if (bb_liveness != nullptr &&
+          bb_liveness->used_registers_ > max_registers_ &&
+          ReorderInstructions(&bb, *bb_liveness)) {
+        changed = true;
+      }
+    }
+
+    if (changed) {
+      context()->InvalidateAnalyses(IRContext::kAnalysisRegisterPressure);
+      RecordChangedFunction(&function);
+      modified = true;
+    }
+  }
+  return modified ? Status::SuccessWithChange : Status::SuccessWithoutChange;
+}
+
+bool ReduceRegisterPressurePass::ExceedsBudget(Function* function) {
+  const RegisterLiveness* liveness =
+      context()->GetLivenessAnalysis()->Get(function);
+  for (BasicBlock& bb : *function) {
+    const RegisterLiveness::RegionRegisterLiveness* bb_liveness =
+        liveness->Get(&bb);
+    if (bb_liveness != nullptr &&
+        bb_liveness->used_registers_ > max_registers_) {
+      return true;
+    }
+  }
+  return false;
+}
+
+bool ReduceRegisterPressurePass::IsRematerializable(Instruction* inst) {
+  switch (inst->opcode()) {
+    case SpvOpAccessChain:
+    case SpvOpInBoundsAccessChain:
+      break;
+    case SpvOpLoad:
+      if (inst->NumInOperands() > kLoadMemoryAccessInIdx &&
+          (inst->GetSingleWordInOperand(kLoadMemoryAccessInIdx) &
+           SpvMemoryAccessVolatileMask)) {
+        return false;
+      }
+      if (ReferencesMutableMemory(inst)) return false;
+      break;
+    default:
+      return false;
+  }
+  return inst->WhileEachInId([this](uint32_t* id) {
+    Instruction* def = get_def_use_mgr()->GetDef(*id);
+    return context()->get_instr_block(def) == nullptr ||
+           IsRematerializable(def);
+  });
+}
+
+Pass::Status ReduceRegisterPressurePass::RematerializeValues(
+    Function* function) {
+  const RegisterLiveness* liveness =
+      context()->GetLivenessAnalysis()->Get(function);
+  std::unordered_set<Instruction*> candidates;
+  for (BasicBlock& bb : *function) {
+    const RegisterLiveness::RegionRegisterLiveness* bb_liveness =
+        liveness->Get(&bb);
+    if (bb_liveness == nullptr ||
+        bb_liveness->used_registers_ <= max_registers_) {
+      continue;
+    }
+    for (Instruction* inst : bb_liveness->live_in_) {
+      if (IsRematerializable(inst)) candidates.insert(inst);
+    }
+  }
+  if (candidates.empty()) return Status::SuccessWithoutChange;
+
+  // Visit the candidates in the order of the function, so that the result
+  // does not depend on the order of the live sets.
+  std::vector<uint32_t> candidate_ids;
+  function->ForEachInst([&candidates, &candidate_ids](Instruction* inst) {
+    if (candidates.count(inst)) candidate_ids.push_back(inst->result_id());
+  });
+
+  Status status = Status::SuccessWithoutChange;
+  for (uint32_t id : candidate_ids) {
+    // The candidate may have been removed along with a value using it.
+    Instruction* inst = get_def_use_mgr()->GetDef(id);
+    if (inst == nullptr) continue;
+    Status inst_status = Rematerialize(inst);
+    if (inst_status == Status::Failure) return inst_status;
+    if (inst_status == Status::SuccessWithChange) status = inst_status;
+  }
+  return status;
+}
+
+Pass::Status ReduceRegisterPressurePass::Rematerialize(Instruction* inst) {
+  BasicBlock* def_block = context()->get_instr_block(inst);
+  Function* function = def_block->GetParent();
+  const LoopDescriptor& loops = *context()->GetLoopDescriptor(function);
+  const size_t def_depth = LoopDepth(loops, def_block);
+
+  // Copying |inst| into a deeper loop would execute it more often.
+  std::unordered_map<BasicBlock*, std::vector<Instruction*>> users;
+  get_def_use_mgr()->ForEachUser(inst, [&](Instruction* user) {
+    if (user->opcode() == SpvOpPhi) return;
+    BasicBlock* bb = context()->get_instr_block(user);
+    if (bb == nullptr || bb == def_block) return;
+    if (LoopDepth(loops, bb) > def_depth) return;
+    users[bb].push_back(user);
+  });
+  if (users.empty()) return Status::SuccessWithoutChange;
+
+  const uint32_t id = inst->result_id();
+  for (BasicBlock& bb : *function) {
+    auto block_users = users.find(&bb);
+    if (block_users == users.end()) continue;
+
+    const std::unordered_set<Instruction*> user_set(block_users->second.begin(),
+                                                    block_users->second.end());
+    Instruction* first_user = nullptr;
+    for (Instruction& block_inst : bb) {
+      if (user_set.count(&block_inst)) {
+        first_user = &block_inst;
+        break;
+      }
+    }
+
+    Instruction* copy = CloneBefore(inst, first_user);
+    if (copy == nullptr) return Status::Failure;
+    const uint32_t copy_id = copy->result_id();
+    for (Instruction* user : block_users->second) {
+      user->ForEachInId([id, copy_id](uint32_t* operand) {
+        if (*operand == id) *operand = copy_id;
+      });
+      get_def_use_mgr()->AnalyzeInstUse(user);
+    }
+  }
+
+  KillIfUnused(inst);
+  return Status::SuccessWithChange;
+}
+
+Instruction* ReduceRegisterPressurePass::CloneBefore(
+    Instruction* inst, Instruction* insert_before) {
+  std::unique_ptr<Instruction> copy(inst->Clone(context()));
+  const uint32_t copy_id = TakeNextId();
+  if (copy_id == 0) return nullptr;
+  copy->SetResultId(copy_id);
+
+  // The operands defined in the function are rematerializable too, and are
+  // copied first so that they dominate the copy of |inst|.
+  bool ok = copy->WhileEachInId([this, insert_before](uint32_t* id) {
+    Instruction* def = get_def_use_mgr()->GetDef(*id);
+    if (context()->get_instr_block(def) == nullptr) return true;
+    Instruction* def_copy = CloneBefore(def, insert_before);
+    if (def_copy == nullptr) return false;
+    *id = def_copy->result_id();
+    return true;
+  });
+  if (!ok) return nullptr;
+
+  Instruction* added = insert_before->InsertBefore(std::move(copy));
+  get_decoration_mgr()->CloneDecorations(inst->result_id(), copy_id);
+  get_def_use_mgr()->AnalyzeInstDefUse(added);
+  context()->set_instr_block(added, context()->get_instr_block(insert_before));
+  return added;
+}
+
+void ReduceRegisterPressurePass::KillIfUnused(Instruction* inst) {
+  const bool unused =
+      get_def_use_mgr()->WhileEachUser(inst, [](Instruction* user) {
+        return IsAnnotationInst(user->opcode()) ||
+               IsDebug2Inst(user->opcode());
+      });
+  if (!unused) return;
+
+  std::vector<uint32_t> operand_ids;
+  inst->ForEachInId([this, &operand_ids](uint32_t* id) {
+    Instruction* def = get_def_use_mgr()->GetDef(*id);
+    if (context()->get_instr_block(def) != nullptr) operand_ids.push_back(*id);
+  });
+  context()->KillInst(inst);
+  for (uint32_t id : operand_ids) {
+    // An operand used twice may already be gone.
+    Instruction* def = get_def_use_mgr()->GetDef(id);
+    if (def != nullptr) KillIfUnused(def);
+  }
+}
+
+bool ReduceRegisterPressurePass::ReorderInstructions(
+    BasicBlock* bb, const RegisterLiveness::RegionRegisterLiveness& liveness) {
+  std::vector<Instruction*> order;
+  std::unordered_map<const Instruction*, size_t> position;
+  for (Instruction& inst : *bb) {
+    position[&inst] = order.size();
+    order.push_back(&inst);
+  }
+
+  // Visiting the block backward lets a chain of instructions each used by
+  // the next one follow its last user down.
+  bool modified = false;
+  for (size_t index = order.size(); index-- > 0;) {
+    const size_t target =
+        FindReorderPosition(order[index], index, bb, liveness, position);
+    if (target == 0) continue;
+    order[index]->InsertBefore(order[target]);
+    std::rotate(order.begin() + index, order.begin() + index + 1,
+                order.begin() + target);
+    for (size_t i = index; i < target; ++i) position[order[i]] = i;
+    modified = true;
+  }
+  return modified;
+}
+
+size_t ReduceRegisterPressurePass::FindReorderPosition(
+    Instruction* inst, size_t index, BasicBlock* bb,
+    const RegisterLiveness::RegionRegisterLiveness& liveness,
+    const std::unordered_map<const Instruction*, size_t>& position) {
+  if (!inst->HasResultId() || !inst->IsOpcodeCodeMotionSafe()) return 0;
+  switch (inst->opcode()) {
+    case SpvOpNop:
+    case SpvOpUndef:
+    case SpvOpLoad:
+      // A load may not be moved past a store.
+      return 0;
+    default:
+      break;
+  }
+
+  size_t first_use = std::numeric_limits<size_t>::max();
+  const bool local = get_def_use_mgr()->WhileEachUser(
+      inst, [this, bb, &position, &first_use](Instruction* user) {
+        BasicBlock* user_block = context()->get_instr_block(user);
+        if (user_block == nullptr) return true;
+        if (user_block != bb || user->opcode() == SpvOpPhi) return false;
+        first_use = std::min(first_use, position.at(user));
+        return true;
+      });
+  if (!local || first_use == std::numeric_limits<size_t>::max() ||
+      first_use <= index + 1) {
+    return 0;
+  }
+
+  // Each register operand must stay live up to the new position, or moving
+  // |inst| would extend its live range instead.
+  const bool operands_live = inst->WhileEachInId([&](uint32_t* id) {
+    Instruction* def = get_def_use_mgr()->GetDef(*id);
+    if (def->opcode() != SpvOpFunctionParameter &&
+        context()->get_instr_block(def) == nullptr) {
+      return true;
+    }
+    if (liveness.live_out_.count(def)) return true;
+    return !get_def_use_mgr()->WhileEachUser(def, [&](Instruction* user) {
+      if (user == inst || context()->get_instr_block(user) != bb) return true;
+      return position.at(user) < first_use;
+    });
+  });
+  return operands_live ? first_use : 0;
+}
+
+}  // namespace opt
+}  // namespace spvtools
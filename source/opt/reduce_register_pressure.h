@@ -0,0 +1,108 @@
+// Copyright (c) 2019 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef SOURCE_OPT_REDUCE_REGISTER_PRESSURE_H_
+#define SOURCE_OPT_REDUCE_REGISTER_PRESSURE_H_
+
+#include <cstddef>
+#include <unordered_map>
+
+#include "source/opt/code_sink.h"
+#include "source/opt/register_pressure.h"
+
+namespace spvtools {
+namespace opt {
+
+// This pass shortens the live ranges of the values of the functions whose
+// register pressure, as estimated by |RegisterLiveness|, exceeds a budget:
+//
+//  - Values loaded from read only memory, and pointers into it, which are
+//    live into a block over the budget are rematerialized in each block using
+//    them, as long as that does not move them into a deeper loop.
+//  - Loads and access chains are sunk into the blocks using them, as the code
+//    sinking pass does.
+//  - Within the blocks still over the budget, each instruction computing a
+//    value from its operands only is moved right before its first user, if its
+//    operands are still live there.
+//
+// None of these transformations makes a value live longer, so the register
+// pressure does not grow.
+class ReduceRegisterPressurePass : public CodeSinkingPass {
+ public:
+  explicit ReduceRegisterPressurePass(size_t max_registers)
+      : max_registers_(max_registers) {}
+
+  const char* name() const override { return "reduce-register-pressure"; }
+  Status Process() override;
+
+  IRContext::Analysis GetPreservedAnalyses() override {
+    return IRContext::kAnalysisDefUse |
+           IRContext::kAnalysisInstrToBlockMapping |
+           IRContext::kAnalysisDecorations | IRContext::kAnalysisCombinators |
+           IRContext::kAnalysisCFG | IRContext::kAnalysisDominatorAnalysis |
+           IRContext::kAnalysisLoopAnalysis | IRContext::kAnalysisNameMap |
+           IRContext::kAnalysisConstants | IRContext::kAnalysisTypes;
+  }
+
+ private:
+  // Returns true if the register pressure of some block of |function| exceeds
+  // the budget.
+  bool ExceedsBudget(Function* function);
+
+  // Returns true if |inst| can be computed again anywhere in its function:
+  // it is a load from read only memory or an access chain, whose operands are
+  // global values or rematerializable.
+  bool IsRematerializable(Instruction* inst);
+
+  // Rematerializes the values live into the blocks of |function| over the
+  // budget.  Returns the status.
+  Status RematerializeValues(Function* function);
+
+  // Replaces the uses of |inst| in the other blocks of its function, which are
+  // not in a deeper loop, by copies of |inst| placed in each of these blocks.
+  // Returns the status.
+  Status Rematerialize(Instruction* inst);
+
+  // Inserts a copy of |inst|, and of the rematerializable instructions it
+  // uses in its function, before |insert_before|.  Returns the copy of |inst|,
+  // or nullptr if the ids overflow.
+  Instruction* CloneBefore(Instruction* inst, Instruction* insert_before);
+
+  // Removes |inst| if its result is no longer used, and then the
+  // instructions of its function it was the last user of.
+  void KillIfUnused(Instruction* inst);
+
+  // Moves the instructions of |bb| computing a value from their operands only
+  // right before their first user when this shortens their live range without
+  // extending the live range of their operands.  |liveness| is the liveness
+  // of |bb|.  Returns true if something changes.
+  bool ReorderInstructions(
+      BasicBlock* bb, const RegisterLiveness::RegionRegisterLiveness& liveness);
+
+  // Returns the index of the instruction of |bb| before which |inst|, which
+  // is at index |index|, is moved by |ReorderInstructions|, or 0 if it is not
+  // moved.  |position| is the index of each instruction of |bb|.
+  size_t FindReorderPosition(
+      Instruction* inst, size_t index, BasicBlock* bb,
+      const RegisterLiveness::RegionRegisterLiveness& liveness,
+      const std::unordered_map<const Instruction*, size_t>& position);
+
+  // The number of registers above which the register pressure is reduced.
+  size_t max_registers_;
+};
+
+}  // namespace opt
+}  // namespace spvtools
+
+#endif  // SOURCE_OPT_REDUCE_REGISTER_PRESSURE_H_
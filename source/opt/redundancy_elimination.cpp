@@ -21,9 +21,12 @@ namespace opt {
 
 Pass::Status RedundancyEliminationPass::Process() {
   bool modified = false;
-  ValueNumberTable vnTable(context());
+  const ValueNumberTable& vnTable = *context()->GetValueNumberTable();
+  context()->BuildDominatorAnalyses(/* post_dominators = */ false);
 
   for (auto& func : *get_module()) {
+    if (!ShouldProcessFunction(&func)) continue;
+
     // Build the dominator tree for this function. It is how the code is
     // traversed.
     DominatorTree& dom_tree =
@@ -36,6 +39,7 @@ Pass::Status RedundancyEliminationPass::Process() {
 
     if (EliminateRedundanciesFrom(dom_tree.GetRoot(), vnTable, value_to_ids)) {
       modified = true;
+      RecordChangedFunction(&func);
     }
   }
   return (modified ? Status::SuccessWithChange : Status::SuccessWithoutChange);
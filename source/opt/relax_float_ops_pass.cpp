@@ -16,6 +16,8 @@
 
 #include "relax_float_ops_pass.h"
 
+#include <cmath>
+
 #include "source/opt/ir_builder.h"
 
 namespace spvtools {
@@ -45,29 +47,51 @@ bool RelaxFloatOpsPass::IsFloat32(Instruction* inst) {
 }
 
 bool RelaxFloatOpsPass::IsRelaxed(uint32_t r_id) {
-  for (auto r_inst : get_decoration_mgr()->GetDecorationsFor(r_id, false))
-    if (r_inst->opcode() == SpvOpDecorate &&
-        r_inst->GetSingleWordInOperand(1) == SpvDecorationRelaxedPrecision)
-      return true;
-  return false;
+  return !get_decoration_mgr()->WhileEachDecorationOf(
+      r_id, false, [](const Instruction* r_inst) {
+        return r_inst->opcode() != SpvOpDecorate ||
+               r_inst->GetSingleWordInOperand(1) !=
+                   SpvDecorationRelaxedPrecision;
+      });
+}
+
+bool RelaxFloatOpsPass::IsInRange(Instruction* inst,
+                                  const FloatRangeAnalysis& ranges) {
+  if (IsFloat(inst->type_id(), 32) &&
+      !ranges.GetRange(inst->result_id()).IsWithin(max_magnitude_)) {
+    return false;
+  }
+  // The operands of the image operations are not converted.
+  if (sample_ops_.count(inst->opcode()) != 0) return true;
+  return inst->WhileEachInId([this, &ranges](const uint32_t* id) {
+    const uint32_t type_id = get_def_use_mgr()->GetDef(*id)->type_id();
+    return type_id == 0 || !IsFloat(type_id, 32) ||
+           ranges.GetRange(*id).IsWithin(max_magnitude_);
+  });
 }
 
-bool RelaxFloatOpsPass::ProcessInst(Instruction* r_inst) {
+bool RelaxFloatOpsPass::ProcessInst(Instruction* r_inst,
+                                    const FloatRangeAnalysis* ranges) {
   uint32_t r_id = r_inst->result_id();
   if (r_id == 0) return false;
   if (!IsFloat32(r_inst)) return false;
   if (IsRelaxed(r_id)) return false;
   if (!IsRelaxable(r_inst)) return false;
+  if (ranges != nullptr && !IsInRange(r_inst, *ranges)) return false;
   get_decoration_mgr()->AddDecoration(r_id, SpvDecorationRelaxedPrecision);
   return true;
 }
 
 bool RelaxFloatOpsPass::ProcessFunction(Function* func) {
+  std::unique_ptr<FloatRangeAnalysis> ranges;
+  if (!std::isinf(max_magnitude_)) {
+    ranges.reset(new FloatRangeAnalysis(context(), func));
+  }
   bool modified = false;
   cfg()->ForEachBlockInReversePostOrder(
-      func->entry().get(), [&modified, this](BasicBlock* bb) {
+      func->entry().get(), [&modified, &ranges, this](BasicBlock* bb) {
         for (auto ii = bb->begin(); ii != bb->end(); ++ii)
-          modified |= ProcessInst(&*ii);
+          modified |= ProcessInst(&*ii, ranges.get());
       });
   return modified;
 }
@@ -16,6 +16,9 @@
 #ifndef LIBSPIRV_OPT_RELAX_FLOAT_OPS_PASS_H_
 #define LIBSPIRV_OPT_RELAX_FLOAT_OPS_PASS_H_
 
+#include <limits>
+
+#include "source/opt/float_range_analysis.h"
 #include "source/opt/ir_builder.h"
 #include "source/opt/pass.h"
 
@@ -24,7 +27,13 @@ namespace opt {
 
 class RelaxFloatOpsPass : public Pass {
  public:
-  RelaxFloatOpsPass() : Pass() {}
+  RelaxFloatOpsPass()
+      : Pass(), max_magnitude_(std::numeric_limits<double>::infinity()) {}
+
+  // Only relaxes the instructions whose result and float operands are known
+  // to stay within [-|max_magnitude|, |max_magnitude|].
+  explicit RelaxFloatOpsPass(double max_magnitude)
+      : Pass(), max_magnitude_(max_magnitude) {}
 
   ~RelaxFloatOpsPass() override = default;
 
@@ -49,9 +58,14 @@ class RelaxFloatOpsPass : public Pass {
   // Return true if |r_id| is decorated with RelaxedPrecision
   bool IsRelaxed(uint32_t r_id);
 
+  // Return true if the float32 result and operands of |inst| are within
+  // |max_magnitude_| according to |ranges|.
+  bool IsInRange(Instruction* inst, const FloatRangeAnalysis& ranges);
+
   // If |inst| is an instruction of float32-based type and is not decorated
-  // RelaxedPrecision, add such a decoration to the module.
-  bool ProcessInst(Instruction* inst);
+  // RelaxedPrecision, add such a decoration to the module.  If |ranges| is
+  // not null, |inst| must also be in range.
+  bool ProcessInst(Instruction* inst, const FloatRangeAnalysis* ranges);
 
   // Call ProcessInst on every instruction in |func|.
   bool ProcessFunction(Function* func);
@@ -72,6 +86,10 @@ class RelaxFloatOpsPass : public Pass {
 
   // Set of sample operations
   std::unordered_set<uint32_t> sample_ops_;
+
+  // The largest magnitude of the values of the relaxed instructions, or
+  // infinity to relax all of them.
+  double max_magnitude_;
 };
 
 }  // namespace opt
@@ -14,7 +14,6 @@
 
 #include "source/opt/remove_duplicates_pass.h"
 
-#include <algorithm>
 #include <cstring>
 #include <limits>
 #include <string>
@@ -29,6 +28,24 @@
 
 namespace spvtools {
 namespace opt {
+namespace {
+
+// Returns a key which is the same for two decorations if and only if they
+// have the same opcode and operands, as compared by
+// |DecorationManager::AreDecorationsTheSame|.
+std::u32string GetDecorationKey(const Instruction& inst) {
+  std::u32string key;
+  key.push_back(static_cast<uint32_t>(inst.opcode()));
+  for (uint32_t i = 0; i < inst.NumInOperands(); ++i) {
+    const Operand& operand = inst.GetInOperand(i);
+    key.push_back(static_cast<uint32_t>(operand.type));
+    key.push_back(static_cast<uint32_t>(operand.words.size()));
+    for (uint32_t word : operand.words) key.push_back(word);
+  }
+  return key;
+}
+
+}  // namespace
 
 Pass::Status RemoveDuplicatesPass::Process() {
   bool modified = RemoveDuplicateCapabilities();
@@ -71,21 +88,22 @@ bool RemoveDuplicatesPass::RemoveDuplicatesExtInstImports() const {
   }
 
   std::unordered_map<std::string, SpvId> ext_inst_imports;
-  for (auto* i = &*context()->ext_inst_import_begin(); i;) {
+  std::unordered_map<uint32_t, uint32_t> replacements;
+  std::vector<Instruction*> to_delete;
+  for (auto* i = &*context()->ext_inst_import_begin(); i; i = i->NextNode()) {
     auto res = ext_inst_imports.emplace(
         reinterpret_cast<const char*>(i->GetInOperand(0u).words.data()),
         i->result_id());
-    if (res.second) {
-      // Never seen before, keep it.
-      i = i->NextNode();
-    } else {
+    if (!res.second) {
       // It's a duplicate, remove it.
-      context()->ReplaceAllUsesWith(i->result_id(), res.first->second);
-      i = context()->KillInst(i);
+      replacements[i->result_id()] = res.first->second;
+      to_delete.push_back(i);
       modified = true;
     }
   }
 
+  context()->ReplaceAllUsesWith(replacements);
+  context()->KillInsts(to_delete);
   return modified;
 }
 
@@ -98,8 +116,19 @@ bool RemoveDuplicatesPass::RemoveDuplicateTypes() const {
 
   analysis::TypeManager type_manager(context()->consumer(), context());
 
-  std::vector<Instruction*> visited_types;
-  std::vector<analysis::ForwardPointer> visited_forward_pointers;
+  // The types already visited, with the id of the first instruction declaring
+  // each of them.
+  std::unordered_map<const analysis::Type*, SpvId, analysis::HashTypePointer,
+                     analysis::CompareTypePointers>
+      visited_types;
+  // The target pointer types of the forward pointers already visited, by
+  // storage class.
+  std::unordered_map<uint32_t,
+                     std::unordered_set<const analysis::Type*,
+                                        analysis::HashTypePointer,
+                                        analysis::CompareTypePointers>>
+      visited_forward_pointers;
+  std::unordered_map<uint32_t, uint32_t> replacements;
   std::vector<Instruction*> to_delete;
   for (auto* i = &*context()->types_values_begin(); i; i = i->NextNode()) {
     const bool is_i_forward_pointer = i->opcode() == SpvOpTypeForwardPointer;
@@ -111,48 +140,29 @@ bool RemoveDuplicatesPass::RemoveDuplicateTypes() const {
 
     if (!is_i_forward_pointer) {
       // Is the current type equal to one of the types we have already visited?
-      SpvId id_to_keep = 0u;
-      analysis::Type* i_type = type_manager.GetType(i->result_id());
+      const analysis::Type* i_type = type_manager.GetType(i->result_id());
       assert(i_type);
-      // TODO(dneto0): Use a trie to avoid quadratic behaviour? Extract the
-      // ResultIdTrie from unify_const_pass.cpp for this.
-      for (auto j : visited_types) {
-        analysis::Type* j_type = type_manager.GetType(j->result_id());
-        assert(j_type);
-        if (*i_type == *j_type) {
-          id_to_keep = j->result_id();
-          break;
-        }
-      }
+      auto res = visited_types.emplace(i_type, i->result_id());
 
-      if (id_to_keep == 0u) {
+      if (res.second) {
         // This is a never seen before type, keep it around.
-        visited_types.emplace_back(i);
-      } else {
-        // The same type has already been seen before, remove this one.
-        context()->KillNamesAndDecorates(i->result_id());
-        context()->ReplaceAllUsesWith(i->result_id(), id_to_keep);
-        modified = true;
-        to_delete.emplace_back(i);
+        continue;
       }
+      // The same type has already been seen before, remove this one.
+      context()->KillNamesAndDecorates(i->result_id());
+      replacements[i->result_id()] = res.first->second;
+      modified = true;
+      to_delete.emplace_back(i);
     } else {
-      analysis::ForwardPointer i_type(
-          i->GetSingleWordInOperand(0u),
-          (SpvStorageClass)i->GetSingleWordInOperand(1u));
-      i_type.SetTargetPointer(
-          type_manager.GetType(i_type.target_id())->AsPointer());
-
-      // TODO(dneto0): Use a trie to avoid quadratic behaviour? Extract the
-      // ResultIdTrie from unify_const_pass.cpp for this.
+      const analysis::Type* target_pointer =
+          type_manager.GetType(i->GetSingleWordInOperand(0u))->AsPointer();
+      assert(target_pointer);
       const bool found_a_match =
-          std::find(std::begin(visited_forward_pointers),
-                    std::end(visited_forward_pointers),
-                    i_type) != std::end(visited_forward_pointers);
+          !visited_forward_pointers[i->GetSingleWordInOperand(1u)]
+               .insert(target_pointer)
+               .second;
 
-      if (!found_a_match) {
-        // This is a never seen before type, keep it around.
-        visited_forward_pointers.emplace_back(i_type);
-      } else {
+      if (found_a_match) {
         // The same type has already been seen before, remove this one.
         modified = true;
         to_delete.emplace_back(i);
@@ -160,9 +170,9 @@ bool RemoveDuplicatesPass::RemoveDuplicateTypes() const {
     }
   }
 
-  for (auto i : to_delete) {
-    context()->KillInst(i);
-  }
+  // The uses are replaced once all the duplicates are known, in one sweep.
+  context()->ReplaceAllUsesWith(replacements);
+  context()->KillInsts(to_delete);
 
   return modified;
 }
@@ -179,25 +189,28 @@ bool RemoveDuplicatesPass::RemoveDuplicateTypes() const {
 bool RemoveDuplicatesPass::RemoveDuplicateDecorations() const {
   bool modified = false;
 
-  std::vector<const Instruction*> visited_decorations;
+  // The decorations already visited, each keyed by its opcode and operands.
+  // Only the direct decorations can be duplicates of one another.
+  std::unordered_set<std::u32string> visited_decorations;
 
-  analysis::DecorationManager decoration_manager(context()->module());
   for (auto* i = &*context()->annotation_begin(); i;) {
     // Is the current decoration equal to one of the decorations we have
     // already visited?
     bool already_visited = false;
-    // TODO(dneto0): Use a trie to avoid quadratic behaviour? Extract the
-    // ResultIdTrie from unify_const_pass.cpp for this.
-    for (const Instruction* j : visited_decorations) {
-      if (decoration_manager.AreDecorationsTheSame(&*i, j, false)) {
-        already_visited = true;
+    switch (i->opcode()) {
+      case SpvOpDecorate:
+      case SpvOpMemberDecorate:
+      case SpvOpDecorateId:
+      case SpvOpDecorateStringGOOGLE:
+        already_visited =
+            !visited_decorations.insert(GetDecorationKey(*i)).second;
+        break;
+      default:
         break;
-      }
     }
 
     if (!already_visited) {
       // This is a never seen before decoration, keep it around.
-      visited_decorations.emplace_back(&*i);
       i = i->NextNode();
     } else {
       // The same decoration has already been seen before, remove this one.
@@ -67,17 +67,17 @@ SpvExecutionModel ReplaceInvalidOpcodePass::GetExecutionModel() {
 bool ReplaceInvalidOpcodePass::RewriteFunction(Function* function,
                                                SpvExecutionModel model) {
   bool modified = false;
-  Instruction* last_line_dbg_inst = nullptr;
+  DebugLine last_line = DebugLine::NoLine();
   function->ForEachInst(
-      [model, &modified, &last_line_dbg_inst, this](Instruction* inst) {
+      [model, &modified, &last_line, this](Instruction* inst) {
         // Track the debug information so we can have a meaningful message.
-        if (inst->opcode() == SpvOpLabel || inst->opcode() == SpvOpNoLine) {
-          last_line_dbg_inst = nullptr;
-          return;
-        } else if (inst->opcode() == SpvOpLine) {
-          last_line_dbg_inst = inst;
+        if (inst->opcode() == SpvOpLabel) {
+          last_line = DebugLine::NoLine();
           return;
         }
+        if (const DebugLine* line = inst->last_dbg_line()) {
+          last_line = *line;
+        }
 
         bool replace = false;
         if (model != SpvExecutionModelFragment &&
@@ -96,26 +96,20 @@ bool ReplaceInvalidOpcodePass::RewriteFunction(Function* function,
 
         if (replace) {
           modified = true;
-          if (last_line_dbg_inst == nullptr) {
+          if (last_line.opcode == SpvOpNoLine) {
             ReplaceInstruction(inst, nullptr, 0, 0);
           } else {
             // Get the name of the source file.
-            Instruction* file_name = context()->get_def_use_mgr()->GetDef(
-                last_line_dbg_inst->GetSingleWordInOperand(0));
+            Instruction* file_name =
+                context()->get_def_use_mgr()->GetDef(last_line.file_id);
             const char* source = reinterpret_cast<const char*>(
                 &file_name->GetInOperand(0).words[0]);
 
-            // Get the line number and column number.
-            uint32_t line_number =
-                last_line_dbg_inst->GetSingleWordInOperand(1);
-            uint32_t col_number = last_line_dbg_inst->GetSingleWordInOperand(2);
-
             // Replace the instruction.
-            ReplaceInstruction(inst, source, line_number, col_number);
+            ReplaceInstruction(inst, source, last_line.line, last_line.column);
           }
         }
-      },
-      /* run_on_debug_line_insts = */ true);
+      });
   return modified;
 }
 
@@ -31,6 +31,15 @@ class ReplaceInvalidOpcodePass : public Pass {
   const char* name() const override { return "replace-invalid-opcode"; }
   Status Process() override;
 
+  IRContext::Analysis GetPreservedAnalyses() override {
+    return IRContext::kAnalysisDefUse |
+           IRContext::kAnalysisInstrToBlockMapping |
+           IRContext::kAnalysisDecorations | IRContext::kAnalysisCFG |
+           IRContext::kAnalysisDominatorAnalysis |
+           IRContext::kAnalysisLoopAnalysis | IRContext::kAnalysisNameMap |
+           IRContext::kAnalysisConstants | IRContext::kAnalysisTypes;
+  }
+
  private:
   // Returns the execution model that is used by every entry point in the
   // module. If more than one execution model is used in the module, then the
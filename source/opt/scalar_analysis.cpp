@@ -20,6 +20,7 @@
 #include <utility>
 
 #include "source/opt/ir_context.h"
+#include "source/util/hash_combine.h"
 
 // Transforms a given scalar operation instruction into a DAG representation.
 //
@@ -49,7 +50,7 @@ namespace opt {
 uint32_t SENode::NumberOfNodes = 0;
 
 ScalarEvolutionAnalysis::ScalarEvolutionAnalysis(IRContext* context)
-    : context_(context), pretend_equal_{} {
+    : context_(context), phis_in_progress_(0), pretend_equal_{} {
   // Create and cached the CantComputeNode.
   cached_cant_compute_ =
       GetCachedOrAdd(std::unique_ptr<SECantCompute>(new SECantCompute(this)));
@@ -163,13 +164,15 @@ SENode* ScalarEvolutionAnalysis::CreateAddNode(SENode* operand_1,
 }
 
 SENode* ScalarEvolutionAnalysis::AnalyzeInstruction(const Instruction* inst) {
-  auto itr = recurrent_node_map_.find(inst);
-  if (itr != recurrent_node_map_.end()) return itr->second;
+  auto itr = instruction_nodes_.find(inst->result_id());
+  if (itr != instruction_nodes_.end()) return itr->second;
 
   SENode* output = nullptr;
   switch (inst->opcode()) {
     case SpvOp::SpvOpPhi: {
+      ++phis_in_progress_;
       output = AnalyzePhiInstruction(inst);
+      --phis_in_progress_;
       break;
     }
     case SpvOp::SpvOpConstant:
@@ -192,9 +195,46 @@ SENode* ScalarEvolutionAnalysis::AnalyzeInstruction(const Instruction* inst) {
     }
   }
 
+  if (phis_in_progress_ == 0 && inst->result_id() != 0) {
+    instruction_nodes_[inst->result_id()] = output;
+  }
   return output;
 }
 
+void ScalarEvolutionAnalysis::InvalidateLoop(const Loop* loop) {
+  if (instruction_nodes_.empty()) return;
+  std::vector<const Instruction*> worklist;
+  for (uint32_t block_id : loop->GetBlocks()) {
+    for (const Instruction& inst : *context_->cfg()->block(block_id)) {
+      worklist.push_back(&inst);
+    }
+  }
+  InvalidateUsers(&worklist);
+}
+
+void ScalarEvolutionAnalysis::InvalidateInstruction(const Instruction* inst) {
+  if (instruction_nodes_.empty()) return;
+  std::vector<const Instruction*> worklist{inst};
+  InvalidateUsers(&worklist);
+}
+
+void ScalarEvolutionAnalysis::InvalidateUsers(
+    std::vector<const Instruction*>* worklist) {
+  analysis::DefUseManager* def_use = context_->get_def_use_mgr();
+  // The users are followed even from the instructions without a node, since
+  // the nodes built while analyzing a phi are not kept.
+  std::unordered_set<const Instruction*> visited;
+  while (!worklist->empty()) {
+    const Instruction* inst = worklist->back();
+    worklist->pop_back();
+    if (!visited.insert(inst).second || inst->result_id() == 0) continue;
+    instruction_nodes_.erase(inst->result_id());
+    def_use->ForEachUser(inst, [worklist](Instruction* user) {
+      worklist->push_back(user);
+    });
+  }
+}
+
 SENode* ScalarEvolutionAnalysis::AnalyzeConstant(const Instruction* inst) {
   if (inst->opcode() == SpvOp::SpvOpConstantNull) return CreateConstant(0);
 
@@ -253,6 +293,7 @@ SENode* ScalarEvolutionAnalysis::AnalyzePhiInstruction(const Instruction* phi) {
   }
 
   analysis::DefUseManager* def_use = context_->get_def_use_mgr();
+  const uint32_t phi_id = phi->result_id();
 
   // Get the basic block this instruction belongs to.
   BasicBlock* basic_block =
@@ -274,7 +315,7 @@ SENode* ScalarEvolutionAnalysis::AnalyzePhiInstruction(const Instruction* phi) {
   // out.
   if (!loop || !loop->GetLatchBlock() || !loop->GetPreHeaderBlock() ||
       loop->GetHeaderBlock() != basic_block)
-    return recurrent_node_map_[phi] = CreateCantComputeNode();
+    return instruction_nodes_[phi_id] = CreateCantComputeNode();
 
   const Loop* loop_to_use = nullptr;
   if (pretend_equal_[loop]) {
@@ -289,7 +330,7 @@ SENode* ScalarEvolutionAnalysis::AnalyzePhiInstruction(const Instruction* phi) {
   // fully built. This is needed as the subsequent call to AnalyzeInstruction
   // could lead back to this |phi| instruction so we return the pointer
   // immediately in AnalyzeInstruction to break the recursion.
-  recurrent_node_map_[phi] = phi_node.get();
+  instruction_nodes_[phi_id] = phi_node.get();
 
   // Traverse the operands of the instruction an create new nodes for each one.
   for (uint32_t i = 0; i < phi->NumInOperands(); i += 2) {
@@ -301,7 +342,7 @@ SENode* ScalarEvolutionAnalysis::AnalyzePhiInstruction(const Instruction* phi) {
 
     // If any operand is CantCompute then the whole graph is CantCompute.
     if (value_node->IsCantCompute())
-      return recurrent_node_map_[phi] = CreateCantComputeNode();
+      return instruction_nodes_[phi_id] = CreateCantComputeNode();
 
     // If the value is coming from the preheader block then the value is the
     // initial value of the phi.
@@ -310,7 +351,7 @@ SENode* ScalarEvolutionAnalysis::AnalyzePhiInstruction(const Instruction* phi) {
     } else if (incoming_label_id == loop->GetLatchBlock()->id()) {
       // Assumed to be in the form of step + phi.
       if (value_node->GetType() != SENode::Add)
-        return recurrent_node_map_[phi] = CreateCantComputeNode();
+        return instruction_nodes_[phi_id] = CreateCantComputeNode();
 
       SENode* step_node = nullptr;
       SENode* phi_operand = nullptr;
@@ -331,14 +372,14 @@ SENode* ScalarEvolutionAnalysis::AnalyzePhiInstruction(const Instruction* phi) {
 
       // If it is not in the form step + phi exit out.
       if (!(step_node && phi_operand))
-        return recurrent_node_map_[phi] = CreateCantComputeNode();
+        return instruction_nodes_[phi_id] = CreateCantComputeNode();
 
       // If the phi operand is not the same phi node exit out.
       if (phi_operand != phi_node.get())
-        return recurrent_node_map_[phi] = CreateCantComputeNode();
+        return instruction_nodes_[phi_id] = CreateCantComputeNode();
 
       if (!IsLoopInvariant(loop, step_node))
-        return recurrent_node_map_[phi] = CreateCantComputeNode();
+        return instruction_nodes_[phi_id] = CreateCantComputeNode();
 
       phi_node->AddCoefficient(step_node);
     }
@@ -346,7 +387,7 @@ SENode* ScalarEvolutionAnalysis::AnalyzePhiInstruction(const Instruction* phi) {
 
   // Once the node is fully built we update the map with the version from the
   // cache (if it has already been added to the cache).
-  return recurrent_node_map_[phi] = GetCachedOrAdd(std::move(phi_node));
+  return instruction_nodes_[phi_id] = GetCachedOrAdd(std::move(phi_node));
 }
 
 SENode* ScalarEvolutionAnalysis::CreateValueUnknownNode(
@@ -363,16 +404,22 @@ SENode* ScalarEvolutionAnalysis::CreateCantComputeNode() {
 // Add the created node into the cache of nodes. If it already exists return it.
 SENode* ScalarEvolutionAnalysis::GetCachedOrAdd(
     std::unique_ptr<SENode> prospective_node) {
-  auto itr = node_cache_.find(prospective_node);
+  auto itr = node_cache_.find(prospective_node.get());
   if (itr != node_cache_.end()) {
-    return (*itr).get();
+    return *itr;
   }
 
   SENode* raw_ptr_to_node = prospective_node.get();
-  node_cache_.insert(std::move(prospective_node));
+  node_cache_.insert(raw_ptr_to_node);
+  node_pool_.push_back(std::move(prospective_node));
   return raw_ptr_to_node;
 }
 
+bool ScalarEvolutionAnalysis::IsCached(const SENode* node) const {
+  auto itr = node_cache_.find(const_cast<SENode*>(node));
+  return itr != node_cache_.end() && *itr == node;
+}
+
 bool ScalarEvolutionAnalysis::IsLoopInvariant(const Loop* loop,
                                               const SENode* node) const {
   for (auto itr = node->graph_cbegin(); itr != node->graph_cend(); ++itr) {
@@ -547,88 +594,52 @@ bool SENode::operator==(const SENode& other) const {
 
 bool SENode::operator!=(const SENode& other) const { return !(*this == other); }
 
-namespace {
-// Helper functions to insert 32/64 bit values into the 32 bit hash string. This
-// allows us to add pointers to the string by reinterpreting the pointers as
-// uintptr_t. PushToString will deduce the type, call sizeof on it and use
-// that size to call into the correct PushToStringImpl functor depending on
-// whether it is 32 or 64 bit.
-
-template <typename T, size_t size_of_t>
-struct PushToStringImpl;
-
-template <typename T>
-struct PushToStringImpl<T, 8> {
-  void operator()(T id, std::u32string* str) {
-    str->push_back(static_cast<uint32_t>(id >> 32));
-    str->push_back(static_cast<uint32_t>(id));
-  }
-};
-
-template <typename T>
-struct PushToStringImpl<T, 4> {
-  void operator()(T id, std::u32string* str) {
-    str->push_back(static_cast<uint32_t>(id));
-  }
-};
-
-template <typename T>
-static void PushToString(T id, std::u32string* str) {
-  PushToStringImpl<T, sizeof(T)>{}(id, str);
-}
-
-}  // namespace
-
-// Implements the hashing of SENodes.
+// Implements the hashing of SENodes.  The hash is computed from the fields
+// compared by |SENode::operator==|, without building any intermediate string,
+// since it is computed every time a node is created.
 size_t SENodeHash::operator()(const SENode* node) const {
-  // Concatinate the terms into a string which we can hash.
-  std::u32string hash_string{};
-
-  // Hashing the type as a string is safer than hashing the enum as the enum is
-  // very likely to collide with constants.
-  for (char ch : node->AsString()) {
-    hash_string.push_back(static_cast<char32_t>(ch));
-  }
+  size_t hash = std::hash<uint32_t>{}(static_cast<uint32_t>(node->GetType()));
 
   // We just ignore the literal value unless it is a constant.
-  if (node->GetType() == SENode::Constant)
-    PushToString(node->AsSEConstantNode()->FoldToSingleValue(), &hash_string);
+  if (node->GetType() == SENode::Constant) {
+    utils::HashCombine(
+        std::hash<int64_t>{}(node->AsSEConstantNode()->FoldToSingleValue()),
+        &hash);
+  }
 
   const SERecurrentNode* recurrent = node->AsSERecurrentNode();
 
   // If we're dealing with a recurrent expression hash the loop as well so that
   // nested inductions like i=0,i++ and j=0,j++ correspond to different nodes.
   if (recurrent) {
-    PushToString(reinterpret_cast<uintptr_t>(recurrent->GetLoop()),
-                 &hash_string);
+    utils::HashCombine(std::hash<const Loop*>{}(recurrent->GetLoop()), &hash);
 
     // Recurrent expressions can't be hashed using the normal method as the
     // order of coefficient and offset matters to the hash.
-    PushToString(reinterpret_cast<uintptr_t>(recurrent->GetCoefficient()),
-                 &hash_string);
-    PushToString(reinterpret_cast<uintptr_t>(recurrent->GetOffset()),
-                 &hash_string);
-
-    return std::hash<std::u32string>{}(hash_string);
+    utils::HashCombine(
+        std::hash<const SENode*>{}(recurrent->GetCoefficient()), &hash);
+    utils::HashCombine(std::hash<const SENode*>{}(recurrent->GetOffset()),
+                       &hash);
+    return hash;
   }
 
   // Hash the result id of the original instruction which created this node if
   // it is a value unknown node.
   if (node->GetType() == SENode::ValueUnknown) {
-    PushToString(node->AsSEValueUnknown()->ResultId(), &hash_string);
+    utils::HashCombine(
+        std::hash<uint32_t>{}(node->AsSEValueUnknown()->ResultId()), &hash);
   }
 
   // Hash the pointers of the child nodes, each SENode has a unique pointer
   // associated with it.
-  const std::vector<SENode*>& children = node->GetChildren();
-  for (const SENode* child : children) {
-    PushToString(reinterpret_cast<uintptr_t>(child), &hash_string);
+  for (const SENode* child : node->GetChildren()) {
+    utils::HashCombine(std::hash<const SENode*>{}(child), &hash);
   }
 
-  return std::hash<std::u32string>{}(hash_string);
+  return hash;
 }
 
-// This overload is the actual overload used by the node_cache_ set.
+// Hashes the node owned by |node|.
 size_t SENodeHash::operator()(const std::unique_ptr<SENode>& node) const {
   return this->operator()(node.get());
 }
@@ -924,6 +935,53 @@ bool ScalarEvolutionAnalysis::IsAlwaysGreaterOrEqualToZero(
   return IsGreaterThanZero(context_).Eval(node, true, is_ge_zero);
 }
 
+bool ScalarEvolutionAnalysis::GetValueRange(const Instruction* inst,
+                                            const BasicBlock* bb,
+                                            int64_t* min_value,
+                                            int64_t* max_value) {
+  SENode* node = SimplifyExpression(AnalyzeInstruction(inst));
+  if (SEConstantNode* constant = node->AsSEConstantNode()) {
+    *min_value = *max_value = constant->FoldToSingleValue();
+    return true;
+  }
+
+  SERecurrentNode* recurrent = node->AsSERecurrentNode();
+  if (!recurrent) return false;
+  SEConstantNode* offset = recurrent->GetOffset()->AsSEConstantNode();
+  SEConstantNode* coefficient =
+      recurrent->GetCoefficient()->AsSEConstantNode();
+  if (!offset || !coefficient) return false;
+
+  // The header is the only block of the loop executed once more than the
+  // number of iterations, after the condition fails.
+  const Loop* loop = recurrent->GetLoop();
+  if (!loop->IsInsideLoop(bb) || bb == loop->GetHeaderBlock()) return false;
+  const BasicBlock* condition = loop->FindConditionBlock();
+  if (condition != loop->GetHeaderBlock()) return false;
+  const Instruction* induction = loop->FindConditionVariable(condition);
+  size_t iterations = 0;
+  if (!induction ||
+      !loop->FindNumberOfIterations(induction, &*condition->ctail(),
+                                    &iterations) ||
+      iterations == 0) {
+    return false;
+  }
+
+  // Keep the products below in range.
+  const int64_t kMaxMagnitude = int64_t(1) << 31;
+  const int64_t start = offset->FoldToSingleValue();
+  const int64_t step = coefficient->FoldToSingleValue();
+  if (iterations > uint64_t(kMaxMagnitude) || start > kMaxMagnitude ||
+      start < -kMaxMagnitude || step > kMaxMagnitude ||
+      step < -kMaxMagnitude) {
+    return false;
+  }
+  const int64_t end = start + step * static_cast<int64_t>(iterations - 1);
+  *min_value = std::min(start, end);
+  *max_value = std::max(start, end);
+  return true;
+}
+
 namespace {
 
 // Remove |node| from the |mul| chain (of the form A * ... * |node| * ... * Z),
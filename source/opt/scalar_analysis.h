@@ -19,6 +19,7 @@
 #include <cstdint>
 #include <map>
 #include <memory>
+#include <unordered_map>
 #include <unordered_set>
 #include <utility>
 #include <vector>
@@ -39,6 +40,11 @@ class Loop;
 // two induction variables i=0,i++ and j=0,j++) become the same node. After
 // creating a DAG with AnalyzeInstruction it can the be simplified into a more
 // usable form with SimplifyExpression.
+//
+// The nodes of the analyzed instructions and the simplified form of each node
+// are kept, so the analysis can be shared by the passes and utilities working
+// on the loops of a module.  A transformation that changes a loop calls
+// |InvalidateLoop| before changing it, rather than discarding the analysis.
 class ScalarEvolutionAnalysis {
  public:
   explicit ScalarEvolutionAnalysis(IRContext* context);
@@ -75,6 +81,15 @@ class ScalarEvolutionAnalysis {
   // Construct the DAG by traversing use def chain of |inst|.
   SENode* AnalyzeInstruction(const Instruction* inst);
 
+  // Forgets the nodes of the instructions of |loop|, and of the instructions
+  // using them, directly or not.  Must be called before |loop| is changed,
+  // while the def-use manager still knows the users of its instructions.
+  void InvalidateLoop(const Loop* loop);
+
+  // Forgets the node of |inst|, and of the instructions using it, directly or
+  // not.
+  void InvalidateInstruction(const Instruction* inst);
+
   // Simplify the |node| by grouping like terms or if contains a recurrent
   // expression, rewrite the graph so the whole DAG (from |node| down) is in
   // terms of that recurrent expression.
@@ -103,6 +118,16 @@ class ScalarEvolutionAnalysis {
   // 0. The result of |is_ge_zero| is valid only if the function returns true.
   bool IsAlwaysGreaterOrEqualToZero(SENode* node, bool* is_ge_zero) const;
 
+  // Sets |*min_value| and |*max_value| to the bounds of the values |inst|
+  // takes when |bb| executes, which |inst| must dominate.  Returns false if no
+  // bounds are known.  |inst| is bounded if it is a constant, or a recurrence
+  // with a constant offset and coefficient, in a loop which contains |bb|, is
+  // only left from its header, and has a known number of iterations.  The
+  // bounds are those of the mathematical value of |inst|: they ignore the
+  // width of its type.
+  bool GetValueRange(const Instruction* inst, const BasicBlock* bb,
+                     int64_t* min_value, int64_t* max_value);
+
   // Find the recurrent term belonging to |loop| in the graph starting from
   // |node| and return the coefficient of that recurrent term. Constant zero
   // will be returned if no recurrent could be found. |node| should be in
@@ -125,6 +150,8 @@ class ScalarEvolutionAnalysis {
   void AddLoopsToPretendAreTheSame(
       const std::pair<const Loop*, const Loop*>& loop_pair) {
     pretend_equal_[std::get<1>(loop_pair)] = std::get<0>(loop_pair);
+    // The recurrences already built refer to the loops themselves.
+    instruction_nodes_.clear();
   }
 
  private:
@@ -139,32 +166,48 @@ class ScalarEvolutionAnalysis {
 
   SENode* AnalyzePhiInstruction(const Instruction* phi);
 
+  // Returns true if |node| is owned by the cache of nodes.
+  bool IsCached(const SENode* node) const;
+
+  // Forgets the nodes of the instructions in |worklist|, and of the
+  // instructions using them, directly or not.
+  void InvalidateUsers(std::vector<const Instruction*>* worklist);
+
   IRContext* context_;
 
-  // A map of instructions to SENodes. This is used to track recurrent
-  // expressions as they are added when analyzing instructions. Recurrent
-  // expressions come from phi nodes which by nature can include recursion so we
-  // check if nodes have already been built when analyzing instructions.
-  std::map<const Instruction*, SENode*> recurrent_node_map_;
+  // A map of result ids to SENodes.  This holds the node of every instruction
+  // analyzed so far, and is also used to track recurrent expressions as they
+  // are added when analyzing instructions. Recurrent expressions come from phi
+  // nodes which by nature can include recursion so we check if nodes have
+  // already been built when analyzing instructions.
+  std::unordered_map<uint32_t, SENode*> instruction_nodes_;
+
+  // The number of phi instructions being analyzed.  The nodes built meanwhile
+  // may refer to an unfinished recurrent node, so only those of the phis
+  // themselves are kept in |instruction_nodes_|.
+  uint32_t phis_in_progress_;
+
+  // The simplified form of the nodes of the cache which were simplified.
+  std::unordered_map<const SENode*, SENode*> simplified_nodes_;
 
   // On creation we create and cache the CantCompute node so we not need to
   // perform a needless create step.
   SENode* cached_cant_compute_;
 
-  // Helper functor to allow two unique_ptr to nodes to be compare. Only
-  // needed
+  // Helper functor to allow two pointers to nodes to be compare. Only needed
   // for the unordered_set implementation.
   struct NodePointersEquality {
-    bool operator()(const std::unique_ptr<SENode>& lhs,
-                    const std::unique_ptr<SENode>& rhs) const {
+    bool operator()(const SENode* lhs, const SENode* rhs) const {
       return *lhs == *rhs;
     }
   };
 
-  // Cache of nodes. All pointers to the nodes are references to the memory
-  // managed by they set.
-  std::unordered_set<std::unique_ptr<SENode>, SENodeHash, NodePointersEquality>
-      node_cache_;
+  // All the nodes created by the analysis.  The nodes are never released
+  // before the analysis, so their addresses identify them.
+  std::vector<std::unique_ptr<SENode>> node_pool_;
+
+  // Cache of nodes, interning the nodes of |node_pool_| by value.
+  std::unordered_set<SENode*, SENodeHash, NodePointersEquality> node_cache_;
 
   // Loops that should be considered the same for performing analysis for loop
   // fusion.
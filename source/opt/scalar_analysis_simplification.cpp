@@ -530,9 +530,19 @@ SENode* SENodeSimplifyImpl::SimplifyRecurrentAddExpression(
  */
 
 SENode* ScalarEvolutionAnalysis::SimplifyExpression(SENode* node) {
+  auto itr = simplified_nodes_.find(node);
+  if (itr != simplified_nodes_.end()) return itr->second;
+
   SENodeSimplifyImpl impl{this, node};
+  SENode* simplified = impl.Simplify();
 
-  return impl.Simplify();
+  // The simplified form only depends on the node, so it is kept as long as
+  // both nodes outlive the query.  The temporary nodes built by the
+  // simplification itself are not cached.
+  if (IsCached(node) && IsCached(simplified)) {
+    simplified_nodes_[node] = simplified;
+  }
+  return simplified;
 }
 
 }  // namespace opt
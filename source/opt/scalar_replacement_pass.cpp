@@ -15,6 +15,8 @@
 #include "source/opt/scalar_replacement_pass.h"
 
 #include <algorithm>
+#include <map>
+#include <memory>
 #include <queue>
 #include <tuple>
 #include <utility>
@@ -72,6 +74,10 @@ Pass::Status ScalarReplacementPass::ProcessFunction(Function* function) {
 
 Pass::Status ScalarReplacementPass::ReplaceVariable(
     Instruction* inst, std::queue<Instruction*>* worklist) {
+  if (IsLargerThanSizeLimit(GetMaxLegalIndex(inst))) {
+    return ReplaceVariableLazily(inst, worklist);
+  }
+
   std::vector<Instruction*> replacements;
   if (!CreateReplacementVariables(inst, &replacements)) {
     return Status::Failure;
@@ -144,6 +150,83 @@ Pass::Status ScalarReplacementPass::ReplaceVariable(
   return Status::SuccessWithChange;
 }
 
+Pass::Status ScalarReplacementPass::ReplaceVariableLazily(
+    Instruction* inst, std::queue<Instruction*>* worklist) {
+  // Only the elements accessed through an access chain get a variable.
+  Instruction* type = GetStorageType(inst);
+  std::vector<Instruction*> new_vars;
+  std::map<uint32_t, Instruction*> replacements;
+  for (uint32_t element : GetAccessedElements(inst)) {
+    CreateVariable(GetElementTypeId(type, element), inst, element, &new_vars);
+    replacements[element] = new_vars.back();
+  }
+  if (std::find(new_vars.begin(), new_vars.end(), nullptr) != new_vars.end()) {
+    return Status::Failure;
+  }
+  TransferAnnotations(inst, &new_vars);
+
+  // The users are collected first, because rewriting the whole loads adds
+  // users to |inst|.
+  std::vector<Instruction*> users;
+  get_def_use_mgr()->ForEachUser(
+      inst, [&users](Instruction* user) { users.push_back(user); });
+
+  std::vector<Instruction*> dead;
+  bool is_residual = false;
+  for (Instruction* user : users) {
+    switch (user->opcode()) {
+      case SpvOpLoad:
+        if (!InsertReplacedElements(user, replacements)) {
+          return Status::Failure;
+        }
+        dead.push_back(user);
+        is_residual = true;
+        break;
+      case SpvOpStore:
+        for (const auto& element_and_var : replacements) {
+          if (!StoreElement(user, element_and_var.first,
+                            element_and_var.second)) {
+            return Status::Failure;
+          }
+        }
+        is_residual = true;
+        break;
+      case SpvOpAccessChain:
+      case SpvOpInBoundsAccessChain: {
+        const uint32_t element =
+            static_cast<uint32_t>(GetAccessChainElement(user));
+        if (!ReplaceAccessChainWith(user, replacements[element])) {
+          return Status::Failure;
+        }
+        dead.push_back(user);
+        break;
+      }
+      default:
+        // Names and decorations.
+        break;
+    }
+  }
+
+  // Without whole loads and stores, the other elements are never used.
+  if (!is_residual) dead.push_back(inst);
+
+  while (!dead.empty()) {
+    Instruction* toKill = dead.back();
+    dead.pop_back();
+    context()->KillInst(toKill);
+  }
+
+  for (auto var : new_vars) {
+    if (get_def_use_mgr()->NumUsers(var) == 0) {
+      context()->KillInst(var);
+    } else if (CanReplaceVariable(var)) {
+      worklist->push(var);
+    }
+  }
+
+  return Status::SuccessWithChange;
+}
+
 bool ScalarReplacementPass::ReplaceWholeLoad(
     Instruction* load, const std::vector<Instruction*>& replacements) {
   // Replaces the load of the entire composite with a load from each replacement
@@ -204,47 +287,112 @@ bool ScalarReplacementPass::ReplaceWholeStore(
     Instruction* store, const std::vector<Instruction*>& replacements) {
   // Replaces a store to the whole composite with a series of extract and stores
   // to each element.
-  uint32_t storeInput = store->GetSingleWordInOperand(1u);
-  BasicBlock* block = context()->get_instr_block(store);
-  BasicBlock::iterator where(store);
   uint32_t elementIndex = 0;
   for (auto var : replacements) {
-    // Create the extract.
-    if (var->opcode() != SpvOpVariable) {
-      elementIndex++;
-      continue;
+    if (var->opcode() == SpvOpVariable &&
+        !StoreElement(store, elementIndex, var)) {
+      return false;
     }
+    elementIndex++;
+  }
+  return true;
+}
+
+bool ScalarReplacementPass::StoreElement(Instruction* store, uint32_t element,
+                                         Instruction* var) {
+  uint32_t storeInput = store->GetSingleWordInOperand(1u);
+  BasicBlock* block = context()->get_instr_block(store);
+  BasicBlock::iterator where(store);
 
+  // Create the extract.
+  Instruction* type = GetStorageType(var);
+  uint32_t extractId = TakeNextId();
+  if (extractId == 0) {
+    return false;
+  }
+  std::unique_ptr<Instruction> extract(new Instruction(
+      context(), SpvOpCompositeExtract, type->result_id(), extractId,
+      std::initializer_list<Operand>{
+          {SPV_OPERAND_TYPE_ID, {storeInput}},
+          {SPV_OPERAND_TYPE_LITERAL_INTEGER, {element}}}));
+  auto iter = where.InsertBefore(std::move(extract));
+  get_def_use_mgr()->AnalyzeInstDefUse(&*iter);
+  context()->set_instr_block(&*iter, block);
+
+  // Create the store.
+  std::unique_ptr<Instruction> newStore(
+      new Instruction(context(), SpvOpStore, 0, 0,
+                      std::initializer_list<Operand>{
+                          {SPV_OPERAND_TYPE_ID, {var->result_id()}},
+                          {SPV_OPERAND_TYPE_ID, {extractId}}}));
+  // Copy memory access attributes which start at index 2. Index 0 is the
+  // pointer and index 1 is the data.
+  for (uint32_t i = 2; i < store->NumInOperands(); ++i) {
+    Operand copy(store->GetInOperand(i));
+    newStore->AddOperand(std::move(copy));
+  }
+  iter = where.InsertBefore(std::move(newStore));
+  get_def_use_mgr()->AnalyzeInstDefUse(&*iter);
+  context()->set_instr_block(&*iter, block);
+  return true;
+}
+
+bool ScalarReplacementPass::InsertReplacedElements(
+    Instruction* load, const std::map<uint32_t, Instruction*>& replacements) {
+  // Loads the residual variable again, and inserts the value of each
+  // replacement variable into the composite.  The original load is left to be
+  // killed.
+  BasicBlock* block = context()->get_instr_block(load);
+  BasicBlock::iterator where(load);
+  uint32_t compositeId = TakeNextId();
+  if (compositeId == 0) {
+    return false;
+  }
+  std::unique_ptr<Instruction> residualLoad(load->Clone(context()));
+  residualLoad->SetResultId(compositeId);
+  where = where.InsertBefore(std::move(residualLoad));
+  get_def_use_mgr()->AnalyzeInstDefUse(&*where);
+  context()->set_instr_block(&*where, block);
+  ++where;
+
+  for (const auto& element_and_var : replacements) {
+    Instruction* var = element_and_var.second;
     Instruction* type = GetStorageType(var);
-    uint32_t extractId = TakeNextId();
-    if (extractId == 0) {
+    uint32_t loadId = TakeNextId();
+    if (loadId == 0) {
       return false;
     }
-    std::unique_ptr<Instruction> extract(new Instruction(
-        context(), SpvOpCompositeExtract, type->result_id(), extractId,
-        std::initializer_list<Operand>{
-            {SPV_OPERAND_TYPE_ID, {storeInput}},
-            {SPV_OPERAND_TYPE_LITERAL_INTEGER, {elementIndex++}}}));
-    auto iter = where.InsertBefore(std::move(extract));
+    std::unique_ptr<Instruction> newLoad(
+        new Instruction(context(), SpvOpLoad, type->result_id(), loadId,
+                        std::initializer_list<Operand>{
+                            {SPV_OPERAND_TYPE_ID, {var->result_id()}}}));
+    // Copy memory access attributes which start at index 1. Index 0 is the
+    // pointer to load.
+    for (uint32_t i = 1; i < load->NumInOperands(); ++i) {
+      Operand copy(load->GetInOperand(i));
+      newLoad->AddOperand(std::move(copy));
+    }
+    auto iter = where.InsertBefore(std::move(newLoad));
     get_def_use_mgr()->AnalyzeInstDefUse(&*iter);
     context()->set_instr_block(&*iter, block);
 
-    // Create the store.
-    std::unique_ptr<Instruction> newStore(
-        new Instruction(context(), SpvOpStore, 0, 0,
-                        std::initializer_list<Operand>{
-                            {SPV_OPERAND_TYPE_ID, {var->result_id()}},
-                            {SPV_OPERAND_TYPE_ID, {extractId}}}));
-    // Copy memory access attributes which start at index 2. Index 0 is the
-    // pointer and index 1 is the data.
-    for (uint32_t i = 2; i < store->NumInOperands(); ++i) {
-      Operand copy(store->GetInOperand(i));
-      newStore->AddOperand(std::move(copy));
+    uint32_t insertId = TakeNextId();
+    if (insertId == 0) {
+      return false;
     }
-    iter = where.InsertBefore(std::move(newStore));
+    std::unique_ptr<Instruction> insert(new Instruction(
+        context(), SpvOpCompositeInsert, load->type_id(), insertId,
+        std::initializer_list<Operand>{
+            {SPV_OPERAND_TYPE_ID, {loadId}},
+            {SPV_OPERAND_TYPE_ID, {compositeId}},
+            {SPV_OPERAND_TYPE_LITERAL_INTEGER, {element_and_var.first}}}));
+    iter = where.InsertBefore(std::move(insert));
     get_def_use_mgr()->AnalyzeInstDefUse(&*iter);
     context()->set_instr_block(&*iter, block);
+    compositeId = insertId;
   }
+
+  context()->ReplaceAllUsesWith(load->result_id(), compositeId);
   return true;
 }
 
@@ -263,32 +411,36 @@ bool ScalarReplacementPass::ReplaceAccessChain(
     // Out of bounds access, this is illegal IR.  Notice that OpAccessChain
     // indexing is 0-based, so we should also reject index == size-of-array.
     return false;
-  } else {
-    const Instruction* var = replacements[static_cast<size_t>(indexValue)];
-    if (chain->NumInOperands() > 2) {
-      // Replace input access chain with another access chain.
-      BasicBlock::iterator chainIter(chain);
-      uint32_t replacementId = TakeNextId();
-      if (replacementId == 0) {
-        return false;
-      }
-      std::unique_ptr<Instruction> replacementChain(new Instruction(
-          context(), chain->opcode(), chain->type_id(), replacementId,
-          std::initializer_list<Operand>{
-              {SPV_OPERAND_TYPE_ID, {var->result_id()}}}));
-      // Add the remaining indexes.
-      for (uint32_t i = 2; i < chain->NumInOperands(); ++i) {
-        Operand copy(chain->GetInOperand(i));
-        replacementChain->AddOperand(std::move(copy));
-      }
-      auto iter = chainIter.InsertBefore(std::move(replacementChain));
-      get_def_use_mgr()->AnalyzeInstDefUse(&*iter);
-      context()->set_instr_block(&*iter, context()->get_instr_block(chain));
-      context()->ReplaceAllUsesWith(chain->result_id(), replacementId);
-    } else {
-      // Replace with a use of the variable.
-      context()->ReplaceAllUsesWith(chain->result_id(), var->result_id());
+  }
+  return ReplaceAccessChainWith(
+      chain, replacements[static_cast<size_t>(indexValue)]);
+}
+
+bool ScalarReplacementPass::ReplaceAccessChainWith(Instruction* chain,
+                                                   const Instruction* var) {
+  if (chain->NumInOperands() > 2) {
+    // Replace input access chain with another access chain.
+    BasicBlock::iterator chainIter(chain);
+    uint32_t replacementId = TakeNextId();
+    if (replacementId == 0) {
+      return false;
     }
+    std::unique_ptr<Instruction> replacementChain(new Instruction(
+        context(), chain->opcode(), chain->type_id(), replacementId,
+        std::initializer_list<Operand>{
+            {SPV_OPERAND_TYPE_ID, {var->result_id()}}}));
+    // Add the remaining indexes.
+    for (uint32_t i = 2; i < chain->NumInOperands(); ++i) {
+      Operand copy(chain->GetInOperand(i));
+      replacementChain->AddOperand(std::move(copy));
+    }
+    auto iter = chainIter.InsertBefore(std::move(replacementChain));
+    get_def_use_mgr()->AnalyzeInstDefUse(&*iter);
+    context()->set_instr_block(&*iter, context()->get_instr_block(chain));
+    context()->ReplaceAllUsesWith(chain->result_id(), replacementId);
+  } else {
+    // Replace with a use of the variable.
+    context()->ReplaceAllUsesWith(chain->result_id(), var->result_id());
   }
 
   return true;
@@ -453,7 +605,7 @@ uint32_t ScalarReplacementPass::GetOrCreatePointerType(uint32_t id) {
     if (global.opcode() == SpvOpTypePointer &&
         global.GetSingleWordInOperand(0u) == SpvStorageClassFunction &&
         global.GetSingleWordInOperand(1u) == id) {
-      if (get_decoration_mgr()->GetDecorationsFor(id, false).empty()) {
+      if (!get_decoration_mgr()->HasDecorations(id, false)) {
         // Only reuse a decoration-less pointer of the correct type.
         ptrId = global.result_id();
         break;
@@ -599,6 +751,13 @@ bool ScalarReplacementPass::CanReplaceVariable(
     return false;
   }
 
+  // An aggregate over the size limit is replaced lazily, and only if few of
+  // its elements are accessed individually.
+  if (IsLargerThanSizeLimit(GetMaxLegalIndex(varInst))) {
+    size_t num_accessed = GetAccessedElements(varInst).size();
+    return num_accessed != 0 && !IsLargerThanSizeLimit(num_accessed);
+  }
+
   return true;
 }
 
@@ -609,9 +768,8 @@ bool ScalarReplacementPass::CheckType(const Instruction* typeInst) const {
 
   switch (typeInst->opcode()) {
     case SpvOpTypeStruct:
-      // Don't bother with empty structs or very large structs.
-      if (typeInst->NumInOperands() == 0 ||
-          IsLargerThanSizeLimit(typeInst->NumInOperands())) {
+      // Don't bother with empty structs.
+      if (typeInst->NumInOperands() == 0) {
         return false;
       }
       return true;
@@ -619,9 +777,6 @@ bool ScalarReplacementPass::CheckType(const Instruction* typeInst) const {
       if (IsSpecConstant(typeInst->GetSingleWordInOperand(1u))) {
         return false;
       }
-      if (IsLargerThanSizeLimit(GetArrayLength(typeInst))) {
-        return false;
-      }
       return true;
       // TODO(alanbaker): Develop some heuristics for when this should be
       // re-enabled.
@@ -640,56 +795,52 @@ bool ScalarReplacementPass::CheckType(const Instruction* typeInst) const {
 
 bool ScalarReplacementPass::CheckTypeAnnotations(
     const Instruction* typeInst) const {
-  for (auto inst :
-       get_decoration_mgr()->GetDecorationsFor(typeInst->result_id(), false)) {
-    uint32_t decoration;
-    if (inst->opcode() == SpvOpDecorate) {
-      decoration = inst->GetSingleWordInOperand(1u);
-    } else {
-      assert(inst->opcode() == SpvOpMemberDecorate);
-      decoration = inst->GetSingleWordInOperand(2u);
-    }
-
-    switch (decoration) {
-      case SpvDecorationRowMajor:
-      case SpvDecorationColMajor:
-      case SpvDecorationArrayStride:
-      case SpvDecorationMatrixStride:
-      case SpvDecorationCPacked:
-      case SpvDecorationInvariant:
-      case SpvDecorationRestrict:
-      case SpvDecorationOffset:
-      case SpvDecorationAlignment:
-      case SpvDecorationAlignmentId:
-      case SpvDecorationMaxByteOffset:
-      case SpvDecorationRelaxedPrecision:
-        break;
-      default:
-        return false;
-    }
-  }
+  return get_decoration_mgr()->WhileEachDecorationOf(
+      typeInst->result_id(), false, [](const Instruction* inst) {
+        uint32_t decoration;
+        if (inst->opcode() == SpvOpDecorate) {
+          decoration = inst->GetSingleWordInOperand(1u);
+        } else {
+          assert(inst->opcode() == SpvOpMemberDecorate);
+          decoration = inst->GetSingleWordInOperand(2u);
+        }
 
-  return true;
+        switch (decoration) {
+          case SpvDecorationRowMajor:
+          case SpvDecorationColMajor:
+          case SpvDecorationArrayStride:
+          case SpvDecorationMatrixStride:
+          case SpvDecorationCPacked:
+          case SpvDecorationInvariant:
+          case SpvDecorationRestrict:
+          case SpvDecorationOffset:
+          case SpvDecorationAlignment:
+          case SpvDecorationAlignmentId:
+          case SpvDecorationMaxByteOffset:
+          case SpvDecorationRelaxedPrecision:
+            return true;
+          default:
+            return false;
+        }
+      });
 }
 
 bool ScalarReplacementPass::CheckAnnotations(const Instruction* varInst) const {
-  for (auto inst :
-       get_decoration_mgr()->GetDecorationsFor(varInst->result_id(), false)) {
-    assert(inst->opcode() == SpvOpDecorate);
-    uint32_t decoration = inst->GetSingleWordInOperand(1u);
-    switch (decoration) {
-      case SpvDecorationInvariant:
-      case SpvDecorationRestrict:
-      case SpvDecorationAlignment:
-      case SpvDecorationAlignmentId:
-      case SpvDecorationMaxByteOffset:
-        break;
-      default:
-        return false;
-    }
-  }
-
-  return true;
+  return get_decoration_mgr()->WhileEachDecorationOf(
+      varInst->result_id(), false, [](const Instruction* inst) {
+        assert(inst->opcode() == SpvOpDecorate);
+        uint32_t decoration = inst->GetSingleWordInOperand(1u);
+        switch (decoration) {
+          case SpvDecorationInvariant:
+          case SpvDecorationRestrict:
+          case SpvDecorationAlignment:
+          case SpvDecorationAlignmentId:
+          case SpvDecorationMaxByteOffset:
+            return true;
+          default:
+            return false;
+        }
+      });
 }
 
 bool ScalarReplacementPass::CheckUses(const Instruction* inst) const {
@@ -880,6 +1031,42 @@ Instruction* ScalarReplacementPass::CreateNullConstant(uint32_t type_id) {
   return null_inst;
 }
 
+std::vector<uint32_t> ScalarReplacementPass::GetAccessedElements(
+    const Instruction* var_inst) const {
+  std::vector<uint32_t> elements;
+  get_def_use_mgr()->ForEachUser(
+      var_inst, [this, &elements](const Instruction* user) {
+        if (user->opcode() == SpvOpAccessChain ||
+            user->opcode() == SpvOpInBoundsAccessChain) {
+          elements.push_back(
+              static_cast<uint32_t>(GetAccessChainElement(user)));
+        }
+      });
+  std::sort(elements.begin(), elements.end());
+  elements.erase(std::unique(elements.begin(), elements.end()),
+                 elements.end());
+  return elements;
+}
+
+uint64_t ScalarReplacementPass::GetAccessChainElement(
+    const Instruction* chain) const {
+  const Instruction* index =
+      get_def_use_mgr()->GetDef(chain->GetSingleWordInOperand(1u));
+  return context()
+      ->get_constant_mgr()
+      ->GetConstantFromInst(index)
+      ->GetZeroExtendedValue();
+}
+
+uint32_t ScalarReplacementPass::GetElementTypeId(const Instruction* type,
+                                                 uint32_t index) const {
+  if (type->opcode() == SpvOpTypeStruct) {
+    return type->GetSingleWordInOperand(index);
+  }
+  assert(type->opcode() == SpvOpTypeArray && "Unexpected type.");
+  return type->GetSingleWordInOperand(0u);
+}
+
 uint64_t ScalarReplacementPass::GetMaxLegalIndex(
     const Instruction* var_inst) const {
   assert(var_inst->opcode() == SpvOpVariable &&
@@ -16,6 +16,7 @@
 #define SOURCE_OPT_SCALAR_REPLACEMENT_PASS_H_
 
 #include <cstdio>
+#include <map>
 #include <memory>
 #include <queue>
 #include <unordered_map>
@@ -77,8 +78,9 @@ class ScalarReplacementPass : public Pass {
 
   // Returns true if |typeInst| is an acceptable type to scalarize.
   //
-  // Allows all aggregate types except runtime arrays. Additionally, checks the
-  // that the number of elements that would be scalarized is within bounds.
+  // Allows all aggregate types except runtime arrays, empty structs and arrays
+  // with a specialization constant length.  The size limit is checked by
+  // |CanReplaceVariable|.
   bool CheckType(const Instruction* typeInst) const;
 
   // Returns true if all the decorations for |varInst| are acceptable for
@@ -124,6 +126,30 @@ class ScalarReplacementPass : public Pass {
   Pass::Status ReplaceVariable(Instruction* inst,
                                std::queue<Instruction*>* worklist);
 
+  // Scalarizes the elements of |inst| that are accessed through an access
+  // chain, and updates the uses of |inst|.
+  //
+  // This is how a variable with more elements than the size limit is
+  // replaced.  If |inst| has whole loads or stores, it stays as a residual
+  // variable holding the other elements: a whole store also stores to each
+  // replacement variable, and a whole load inserts their values into what it
+  // loads from the residual.  Returns the same as |ReplaceVariable|.
+  Pass::Status ReplaceVariableLazily(Instruction* inst,
+                                     std::queue<Instruction*>* worklist);
+
+  // Returns the indexes of the elements of |var_inst| that are accessed
+  // through an access chain, in increasing order.  The uses of |var_inst|
+  // must have been checked by |CheckUses|.
+  std::vector<uint32_t> GetAccessedElements(const Instruction* var_inst) const;
+
+  // Returns the value of the first index of |chain|, which must be a
+  // constant.
+  uint64_t GetAccessChainElement(const Instruction* chain) const;
+
+  // Returns the id of the type of the element |index| of the struct or array
+  // type |type|.
+  uint32_t GetElementTypeId(const Instruction* type, uint32_t index) const;
+
   // Returns the underlying storage type for |inst|.
   //
   // |inst| must be an OpVariable. Returns the type that is pointed to by
@@ -199,6 +225,18 @@ class ScalarReplacementPass : public Pass {
   bool ReplaceWholeStore(Instruction* store,
                          const std::vector<Instruction*>& replacements);
 
+  // Generates a composite extract of the element |element| of the data stored
+  // by |store|, and a store of it to |var|, before |store|.  Returns true if
+  // successful.
+  bool StoreElement(Instruction* store, uint32_t element, Instruction* var);
+
+  // Replaces the whole load |load| from a residual variable by a load of the
+  // residual followed by the insertion of the value of each variable in
+  // |replacements|, which maps element indexes to their replacement variable.
+  // |load| is left without uses.  Returns true if successful.
+  bool InsertReplacedElements(
+      Instruction* load, const std::map<uint32_t, Instruction*>& replacements);
+
   // Replaces an access chain to the composite variable with either a direct use
   // of the appropriate replacement variable or another access chain with the
   // replacement variable as the base and one fewer indexes. Returns true if
@@ -206,6 +244,12 @@ class ScalarReplacementPass : public Pass {
   bool ReplaceAccessChain(Instruction* chain,
                           const std::vector<Instruction*>& replacements);
 
+  // Replaces the access chain |chain| to a composite variable with either a
+  // direct use of |var|, the replacement variable of the element it accesses,
+  // or another access chain with |var| as the base and one fewer indexes.
+  // Returns true if successful.
+  bool ReplaceAccessChainWith(Instruction* chain, const Instruction* var);
+
   // Returns a set containing the which components of the result of |inst| are
   // potentially used.  If the return value is |nullptr|, then every components
   // is possibly used.
@@ -14,6 +14,7 @@
 
 #include "source/opt/simplification_pass.h"
 
+#include <algorithm>
 #include <set>
 #include <unordered_set>
 #include <vector>
@@ -26,12 +27,78 @@ namespace opt {
 Pass::Status SimplificationPass::Process() {
   bool modified = false;
 
+  if (incremental_ && context()->AreChangedInstructionsTracked()) {
+    std::unordered_map<Function*, std::vector<Instruction*>> changed_insts =
+        GetChangedInstructions();
+    std::unordered_set<Function*> processed;
+    for (Function& function : *get_module()) {
+      if (!ShouldProcessFunction(&function)) continue;
+      processed.insert(&function);
+      auto changed = changed_insts.find(&function);
+      if (changed == changed_insts.end()) continue;
+      if (SimplifyChangedInstructions(changed->second)) {
+        modified = true;
+        RecordChangedFunction(&function);
+      }
+    }
+    ForgetChangedInstructions(processed);
+    return (modified ? Status::SuccessWithChange
+                     : Status::SuccessWithoutChange);
+  }
+
+  bool skipped = false;
   for (Function& function : *get_module()) {
-    modified |= SimplifyFunction(&function);
+    if (!ShouldProcessFunction(&function)) {
+      skipped = true;
+      continue;
+    }
+    if (SimplifyFunction(&function)) {
+      modified = true;
+      RecordChangedFunction(&function);
+    }
+  }
+  // The changes can only be tracked from a point where all of the functions
+  // are simplified.
+  if (incremental_ && !skipped) {
+    context()->StartTrackingChangedInstructions();
   }
   return (modified ? Status::SuccessWithChange : Status::SuccessWithoutChange);
 }
 
+std::unordered_map<Function*, std::vector<Instruction*>>
+SimplificationPass::GetChangedInstructions() {
+  std::unordered_map<Function*, std::vector<Instruction*>> changed_insts;
+  for (Instruction* inst : *context()->changed_instructions()) {
+    BasicBlock* block = context()->get_instr_block(inst);
+    if (block != nullptr) {
+      changed_insts[block->GetParent()].push_back(inst);
+    }
+  }
+  // Sort the instructions, so that the result does not depend on the order of
+  // the set.
+  for (auto& function_insts : changed_insts) {
+    std::sort(function_insts.second.begin(), function_insts.second.end(),
+              [](const Instruction* lhs, const Instruction* rhs) {
+                return lhs->unique_id() < rhs->unique_id();
+              });
+  }
+  return changed_insts;
+}
+
+void SimplificationPass::ForgetChangedInstructions(
+    const std::unordered_set<Function*>& processed) {
+  std::unordered_set<Instruction*>* changed_insts =
+      context()->changed_instructions();
+  for (auto iter = changed_insts->begin(); iter != changed_insts->end();) {
+    BasicBlock* block = context()->get_instr_block(*iter);
+    if (block == nullptr || processed.count(block->GetParent())) {
+      iter = changed_insts->erase(iter);
+    } else {
+      ++iter;
+    }
+  }
+}
+
 void SimplificationPass::AddNewOperands(
     Instruction* folded_inst, std::unordered_set<Instruction*>* inst_seen,
     std::vector<Instruction*>* work_list) {
@@ -111,10 +178,55 @@ bool SimplificationPass::SimplifyFunction(Function* function) {
   // Phase 2: process the instructions in the work list until all of the work is
   //          done.  This time we add all users to the work list because phase 1
   //          has already finished.
-  for (size_t i = 0; i < work_list.size(); ++i) {
-    Instruction* inst = work_list[i];
-    in_work_list.erase(inst);
-    inst_seen.insert(inst);
+  if (ProcessWorkList(&work_list, &in_work_list, &inst_seen, &inst_to_kill)) {
+    modified = true;
+  }
+
+  // Phase 3: Kill instructions we know are no longer needed.
+  for (Instruction* inst : inst_to_kill) {
+    context()->KillInst(inst);
+  }
+
+  return modified;
+}
+
+bool SimplificationPass::SimplifyChangedInstructions(
+    const std::vector<Instruction*>& changed_insts) {
+  std::vector<Instruction*> work_list;
+  std::unordered_set<Instruction*> inst_to_kill;
+  std::unordered_set<Instruction*> in_work_list;
+  std::unordered_set<Instruction*> inst_seen;
+  analysis::DefUseManager* def_use_mgr = get_def_use_mgr();
+  auto add_to_work_list = [&work_list, &in_work_list](Instruction* inst) {
+    if (!inst->IsDecoration() && inst->opcode() != SpvOpName &&
+        in_work_list.insert(inst).second) {
+      work_list.push_back(inst);
+    }
+  };
+  for (Instruction* inst : changed_insts) {
+    add_to_work_list(inst);
+    def_use_mgr->ForEachUser(inst, add_to_work_list);
+  }
+
+  bool modified =
+      ProcessWorkList(&work_list, &in_work_list, &inst_seen, &inst_to_kill);
+  for (Instruction* inst : inst_to_kill) {
+    context()->KillInst(inst);
+  }
+  return modified;
+}
+
+bool SimplificationPass::ProcessWorkList(
+    std::vector<Instruction*>* work_list,
+    std::unordered_set<Instruction*>* in_work_list,
+    std::unordered_set<Instruction*>* inst_seen,
+    std::unordered_set<Instruction*>* inst_to_kill) {
+  bool modified = false;
+  const InstructionFolder& folder = context()->get_instruction_folder();
+  for (size_t i = 0; i < work_list->size(); ++i) {
+    Instruction* inst = (*work_list)[i];
+    in_work_list->erase(inst);
+    inst_seen->insert(inst);
 
     bool is_foldable_copy =
         inst->opcode() == SpvOpCopyObject &&
@@ -125,14 +237,14 @@ bool SimplificationPass::SimplifyFunction(Function* function) {
       modified = true;
       context()->AnalyzeUses(inst);
       get_def_use_mgr()->ForEachUser(
-          inst, [&work_list, &in_work_list](Instruction* use) {
+          inst, [work_list, in_work_list](Instruction* use) {
             if (!use->IsDecoration() && use->opcode() != SpvOpName &&
-                in_work_list.insert(use).second) {
-              work_list.push_back(use);
+                in_work_list->insert(use).second) {
+              work_list->push_back(use);
             }
           });
 
-      AddNewOperands(inst, &inst_seen, &work_list);
+      AddNewOperands(inst, inst_seen, work_list);
 
       if (inst->opcode() == SpvOpCopyObject) {
         context()->ReplaceAllUsesWithPredicate(
@@ -144,20 +256,14 @@ bool SimplificationPass::SimplifyFunction(Function* function) {
               }
               return false;
             });
-        inst_to_kill.insert(inst);
-        in_work_list.insert(inst);
+        inst_to_kill->insert(inst);
+        in_work_list->insert(inst);
       } else if (inst->opcode() == SpvOpNop) {
-        inst_to_kill.insert(inst);
-        in_work_list.insert(inst);
+        inst_to_kill->insert(inst);
+        in_work_list->insert(inst);
       }
     }
   }
-
-  // Phase 3: Kill instructions we know are no longer needed.
-  for (Instruction* inst : inst_to_kill) {
-    context()->KillInst(inst);
-  }
-
   return modified;
 }
 
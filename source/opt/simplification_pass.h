@@ -15,6 +15,10 @@
 #ifndef SOURCE_OPT_SIMPLIFICATION_PASS_H_
 #define SOURCE_OPT_SIMPLIFICATION_PASS_H_
 
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
 #include "source/opt/function.h"
 #include "source/opt/ir_context.h"
 #include "source/opt/pass.h"
@@ -25,7 +29,15 @@ namespace opt {
 // See optimizer.hpp for documentation.
 class SimplificationPass : public Pass {
  public:
+  // Creates a pass simplifying every instruction.  If |incremental| is true,
+  // the pass tracks the instructions that change after it is run, and the next
+  // run of an incremental pass on the same context only starts from those
+  // instructions and their users.
+  explicit SimplificationPass(bool incremental = false)
+      : incremental_(incremental) {}
+
   const char* name() const override { return "simplify-instructions"; }
+  bool IsFunctionLocal() const override { return true; }
   Status Process() override;
 
   IRContext::Analysis GetPreservedAnalyses() override {
@@ -33,8 +45,9 @@ class SimplificationPass : public Pass {
            IRContext::kAnalysisInstrToBlockMapping |
            IRContext::kAnalysisDecorations | IRContext::kAnalysisCombinators |
            IRContext::kAnalysisCFG | IRContext::kAnalysisDominatorAnalysis |
-           IRContext::kAnalysisNameMap | IRContext::kAnalysisConstants |
-           IRContext::kAnalysisTypes;
+           IRContext::kAnalysisLoopAnalysis | IRContext::kAnalysisNameMap |
+           IRContext::kAnalysisConstants | IRContext::kAnalysisTypes |
+           IRContext::kAnalysisCallGraph;
   }
 
  private:
@@ -43,6 +56,33 @@ class SimplificationPass : public Pass {
   // simplified.
   bool SimplifyFunction(Function* function);
 
+  // Returns true if the module was changed.  The simplifier is called on
+  // |changed_insts|, the instructions of a function that changed since the
+  // last simplification, on their users, and on the instructions whose inputs
+  // change, until nothing else can be simplified.
+  bool SimplifyChangedInstructions(
+      const std::vector<Instruction*>& changed_insts);
+
+  // Simplifies the instructions in |work_list|, adding to it the users of the
+  // simplified ones, until it is empty.  |in_work_list| holds the instructions
+  // waiting in |work_list|, |inst_seen| the instructions already visited, and
+  // the instructions that are no longer needed are added to |inst_to_kill|.
+  // Returns true if an instruction was simplified.
+  bool ProcessWorkList(std::vector<Instruction*>* work_list,
+                       std::unordered_set<Instruction*>* in_work_list,
+                       std::unordered_set<Instruction*>* inst_seen,
+                       std::unordered_set<Instruction*>* inst_to_kill);
+
+  // Returns the instructions that changed since the last simplification,
+  // grouped by function, in the order in which they were created.
+  std::unordered_map<Function*, std::vector<Instruction*>>
+  GetChangedInstructions();
+
+  // Forgets the changed instructions of the functions in |processed|, and of
+  // no function, since they were simplified.
+  void ForgetChangedInstructions(
+      const std::unordered_set<Function*>& processed);
+
   // FactorAddMul can create |folded_inst| Mul of new Add. If Mul, push any Add
   // operand not in |seen_inst| into |worklist|. This is heavily restricted to
   // improve compile time but can be expanded for future simplifications which
@@ -50,6 +90,10 @@ class SimplificationPass : public Pass {
   void AddNewOperands(Instruction* folded_inst,
                       std::unordered_set<Instruction*>* inst_seen,
                       std::vector<Instruction*>* work_list);
+
+  // Whether the pass only starts from the instructions that changed since the
+  // last incremental simplification, when they are known.
+  bool incremental_;
 };
 
 }  // namespace opt
@@ -0,0 +1,316 @@
+// Copyright (c) 2019 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "source/opt/slp_vectorize_pass.h"
+
+#include <algorithm>
+#include <unordered_set>
+
+namespace spvtools {
+namespace opt {
+namespace {
+
+const uint32_t kExtractCompositeIdInIdx = 0;
+const uint32_t kExtractFirstIndexInIdx = 1;
+
+// The maximum depth of the trees matched from a construct.
+const uint32_t kMaxDepth = 8;
+
+// Returns true if |opcode| computes each component of a vector result from
+// the same components of its vector operands.
+bool IsVectorizableOpcode(SpvOp opcode) {
+  switch (opcode) {
+    case SpvOpFNegate:
+    case SpvOpSNegate:
+    case SpvOpNot:
+    case SpvOpIAdd:
+    case SpvOpFAdd:
+    case SpvOpISub:
+    case SpvOpFSub:
+    case SpvOpIMul:
+    case SpvOpFMul:
+    case SpvOpUDiv:
+    case SpvOpSDiv:
+    case SpvOpFDiv:
+    case SpvOpUMod:
+    case SpvOpSRem:
+    case SpvOpSMod:
+    case SpvOpFRem:
+    case SpvOpFMod:
+    case SpvOpShiftRightLogical:
+    case SpvOpShiftRightArithmetic:
+    case SpvOpShiftLeftLogical:
+    case SpvOpBitwiseOr:
+    case SpvOpBitwiseXor:
+    case SpvOpBitwiseAnd:
+      return true;
+    default:
+      return false;
+  }
+}
+
+}  // namespace
+
+Pass::Status SLPVectorizePass::Process() {
+  bool modified = false;
+  analysis::TypeManager* type_mgr = context()->get_type_mgr();
+  for (auto& func : *get_module()) {
+    if (!ShouldProcessFunction(&func)) continue;
+
+    // The seeds are the vectors constructed from one scalar per component.
+    std::vector<Instruction*> seeds;
+    func.ForEachInst([this, type_mgr, &seeds](Instruction* inst) {
+      if (inst->opcode() != SpvOpCompositeConstruct) return;
+      const analysis::Vector* vector_type =
+          type_mgr->GetType(inst->type_id())->AsVector();
+      if (vector_type == nullptr ||
+          inst->NumInOperands() != vector_type->element_count()) {
+        return;
+      }
+      const uint32_t element_type_id =
+          type_mgr->GetId(vector_type->element_type());
+      const bool scalars = inst->WhileEachInId(
+          [this, element_type_id](const uint32_t* id) {
+            return get_def_use_mgr()->GetDef(*id)->type_id() ==
+                   element_type_id;
+          });
+      if (scalars) seeds.push_back(inst);
+    });
+
+    bool changed = false;
+    for (Instruction* seed : seeds) {
+      Status status = VectorizeTree(seed);
+      if (status == Status::Failure) return status;
+      if (status == Status::SuccessWithChange) changed = true;
+    }
+    if (changed) {
+      modified = true;
+      RecordChangedFunction(&func);
+    }
+  }
+  return modified ? Status::SuccessWithChange : Status::SuccessWithoutChange;
+}
+
+Pass::Status SLPVectorizePass::VectorizeTree(Instruction* seed) {
+  analysis::TypeManager* type_mgr = context()->get_type_mgr();
+  const analysis::Vector* vector_type =
+      type_mgr->GetType(seed->type_id())->AsVector();
+  std::vector<uint32_t> lanes;
+  seed->ForEachInId([&lanes](const uint32_t* id) { lanes.push_back(*id); });
+  std::unique_ptr<Node> root =
+      BuildNode(lanes, type_mgr->GetId(vector_type->element_type()), 0);
+  if (root->kind != Node::Kind::kVectorize) {
+    return Status::SuccessWithoutChange;
+  }
+
+  // The construct itself is replaced.
+  uint32_t num_instructions = 0;
+  uint32_t num_dead = 1;
+  CountInstructions(*root, std::vector<bool>(lanes.size(), true),
+                    &num_instructions, &num_dead);
+  if (num_instructions >= num_dead) return Status::SuccessWithoutChange;
+
+  InstructionBuilder builder(
+      context(), seed,
+      IRContext::kAnalysisDefUse | IRContext::kAnalysisInstrToBlockMapping);
+  const uint32_t vector_id = GenerateNode(*root, seed->type_id(), &builder);
+  if (vector_id == 0) return Status::Failure;
+  context()->KillNamesAndDecorates(seed);
+  context()->ReplaceAllUsesWith(seed->result_id(), vector_id);
+  context()->KillInst(seed);
+  KillDeadLanes(*root);
+  return Status::SuccessWithChange;
+}
+
+std::unique_ptr<SLPVectorizePass::Node> SLPVectorizePass::BuildNode(
+    const std::vector<uint32_t>& lanes, uint32_t scalar_type_id,
+    uint32_t depth) {
+  std::unique_ptr<Node> node(new Node());
+  node->lanes = lanes;
+  node->scalar_type_id = scalar_type_id;
+  std::vector<Instruction*> insts;
+  for (uint32_t lane : lanes) insts.push_back(get_def_use_mgr()->GetDef(lane));
+
+  // Components of the same vector.
+  const Instruction* first = insts.front();
+  const uint32_t source_id =
+      first->opcode() == SpvOpCompositeExtract
+          ? first->GetSingleWordInOperand(kExtractCompositeIdInIdx)
+          : 0;
+  const analysis::Vector* source_type =
+      source_id == 0
+          ? nullptr
+          : context()
+                ->get_type_mgr()
+                ->GetType(get_def_use_mgr()->GetDef(source_id)->type_id())
+                ->AsVector();
+  if (source_type != nullptr &&
+      std::all_of(insts.begin(), insts.end(),
+                  [source_id](const Instruction* inst) {
+                    return inst->opcode() == SpvOpCompositeExtract &&
+                           inst->NumInOperands() == 2 &&
+                           inst->GetSingleWordInOperand(
+                               kExtractCompositeIdInIdx) == source_id;
+                  })) {
+    node->source = source_id;
+    bool identity = source_type->element_count() == lanes.size();
+    for (uint32_t i = 0; i < insts.size(); ++i) {
+      const uint32_t component =
+          insts[i]->GetSingleWordInOperand(kExtractFirstIndexInIdx);
+      node->components.push_back(component);
+      if (component != i) identity = false;
+    }
+    node->kind = identity ? Node::Kind::kIdentity : Node::Kind::kShuffle;
+    return node;
+  }
+
+  if (std::all_of(insts.begin(), insts.end(), [](const Instruction* inst) {
+        return inst->opcode() == SpvOpConstant;
+      })) {
+    node->kind = Node::Kind::kConstant;
+    return node;
+  }
+
+  if (depth < kMaxDepth && AreIsomorphic(insts)) {
+    node->kind = Node::Kind::kVectorize;
+    node->opcode = first->opcode();
+    for (uint32_t i = 0; i < first->NumInOperands(); ++i) {
+      std::vector<uint32_t> operand_lanes;
+      for (const Instruction* inst : insts) {
+        operand_lanes.push_back(inst->GetSingleWordInOperand(i));
+      }
+      node->operands.push_back(BuildNode(
+          operand_lanes,
+          get_def_use_mgr()->GetDef(operand_lanes.front())->type_id(),
+          depth + 1));
+    }
+    return node;
+  }
+
+  node->kind = Node::Kind::kGather;
+  return node;
+}
+
+bool SLPVectorizePass::AreIsomorphic(
+    const std::vector<Instruction*>& lanes) const {
+  const Instruction* first = lanes.front();
+  if (!IsVectorizableOpcode(first->opcode())) return false;
+  analysis::DefUseManager* def_use_mgr = context()->get_def_use_mgr();
+  for (const Instruction* inst : lanes) {
+    if (inst->opcode() != first->opcode() ||
+        inst->type_id() != first->type_id() ||
+        !context()->get_decoration_mgr()->HaveTheSameDecorations(
+            inst->result_id(), first->result_id())) {
+      return false;
+    }
+    // The operands of each lane must have the same type to be vectorized.
+    for (uint32_t i = 0; i < first->NumInOperands(); ++i) {
+      if (def_use_mgr->GetDef(inst->GetSingleWordInOperand(i))->type_id() !=
+          def_use_mgr->GetDef(first->GetSingleWordInOperand(i))->type_id()) {
+        return false;
+      }
+    }
+  }
+  return true;
+}
+
+void SLPVectorizePass::CountInstructions(const Node& node,
+                                         const std::vector<bool>& parents_dead,
+                                         uint32_t* num_instructions,
+                                         uint32_t* num_dead) const {
+  if (node.kind != Node::Kind::kIdentity &&
+      node.kind != Node::Kind::kConstant) {
+    ++*num_instructions;
+  }
+  if (node.kind == Node::Kind::kConstant || node.kind == Node::Kind::kGather) {
+    return;
+  }
+
+  // A lane becomes dead if its only user does.
+  std::vector<bool> lanes_dead;
+  std::unordered_set<uint32_t> counted;
+  for (size_t i = 0; i < node.lanes.size(); ++i) {
+    const bool dead = parents_dead[i] &&
+                      get_def_use_mgr()->NumUsers(node.lanes[i]) == 1;
+    lanes_dead.push_back(dead);
+    if (dead && counted.insert(node.lanes[i]).second) ++*num_dead;
+  }
+  for (const auto& operand : node.operands) {
+    CountInstructions(*operand, lanes_dead, num_instructions, num_dead);
+  }
+}
+
+uint32_t SLPVectorizePass::GenerateNode(const Node& node,
+                                        uint32_t vector_type_id,
+                                        InstructionBuilder* builder) {
+  switch (node.kind) {
+    case Node::Kind::kIdentity:
+      return node.source;
+    case Node::Kind::kShuffle: {
+      Instruction* shuffle = builder->AddVectorShuffle(
+          vector_type_id, node.source, node.source, node.components);
+      return shuffle == nullptr ? 0 : shuffle->result_id();
+    }
+    case Node::Kind::kConstant: {
+      analysis::ConstantManager* const_mgr = context()->get_constant_mgr();
+      const analysis::Constant* vector = const_mgr->GetConstant(
+          context()->get_type_mgr()->GetType(vector_type_id), node.lanes);
+      if (vector == nullptr) return 0;
+      return const_mgr->GetDefiningInstruction(vector, vector_type_id)
+          ->result_id();
+    }
+    case Node::Kind::kGather:
+      return builder->AddCompositeConstruct(vector_type_id, node.lanes)
+          ->result_id();
+    case Node::Kind::kVectorize:
+      break;
+  }
+
+  analysis::TypeManager* type_mgr = context()->get_type_mgr();
+  std::vector<uint32_t> operand_ids;
+  for (const auto& operand : node.operands) {
+    analysis::Vector operand_type(type_mgr->GetType(operand->scalar_type_id),
+                                  static_cast<uint32_t>(node.lanes.size()));
+    const uint32_t operand_id = GenerateNode(
+        *operand,
+        type_mgr->GetTypeInstruction(
+            type_mgr->GetRegisteredType(&operand_type)),
+        builder);
+    if (operand_id == 0) return 0;
+    operand_ids.push_back(operand_id);
+  }
+  Instruction* vector_inst =
+      builder->AddNaryOp(vector_type_id, node.opcode, operand_ids);
+  if (vector_inst->result_id() == 0) return 0;
+  get_decoration_mgr()->CloneDecorations(node.lanes.front(),
+                                         vector_inst->result_id());
+  return vector_inst->result_id();
+}
+
+void SLPVectorizePass::KillDeadLanes(const Node& node) {
+  if (node.kind == Node::Kind::kConstant || node.kind == Node::Kind::kGather) {
+    return;
+  }
+  for (uint32_t lane : node.lanes) {
+    Instruction* inst = get_def_use_mgr()->GetDef(lane);
+    if (inst != nullptr && get_def_use_mgr()->NumUsers(inst) == 0) {
+      context()->KillNamesAndDecorates(inst);
+      context()->KillInst(inst);
+    }
+  }
+  for (const auto& operand : node.operands) KillDeadLanes(*operand);
+}
+
+}  // namespace opt
+}  // namespace spvtools
@@ -0,0 +1,112 @@
+// Copyright (c) 2019 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef SOURCE_OPT_SLP_VECTORIZE_PASS_H_
+#define SOURCE_OPT_SLP_VECTORIZE_PASS_H_
+
+#include <memory>
+#include <vector>
+
+#include "source/opt/ir_builder.h"
+#include "source/opt/ir_context.h"
+#include "source/opt/pass.h"
+
+namespace spvtools {
+namespace opt {
+
+// This pass rebuilds scalarized arithmetic as vector arithmetic.  Starting
+// from each OpCompositeConstruct of a vector from scalars, it matches the
+// trees of isomorphic scalar instructions computing the components, lane by
+// lane.  The leaves of the trees are:
+//
+//  - the components of a vector, taken by OpCompositeExtract, which become
+//    the vector itself or an OpVectorShuffle of it;
+//  - constants, which become a constant vector;
+//  - any other values, gathered by an OpCompositeConstruct.
+//
+// A tree is only rebuilt if it has fewer vector instructions than the scalar
+// instructions it makes dead.
+class SLPVectorizePass : public Pass {
+ public:
+  const char* name() const override { return "slp-vectorize"; }
+  Status Process() override;
+
+  IRContext::Analysis GetPreservedAnalyses() override {
+    return IRContext::kAnalysisDefUse |
+           IRContext::kAnalysisInstrToBlockMapping |
+           IRContext::kAnalysisCombinators | IRContext::kAnalysisCFG |
+           IRContext::kAnalysisDominatorAnalysis |
+           IRContext::kAnalysisLoopAnalysis | IRContext::kAnalysisNameMap |
+           IRContext::kAnalysisConstants | IRContext::kAnalysisTypes;
+  }
+
+ private:
+  // A node of the tree of a vector value, whose components are |lanes|.
+  struct Node {
+    enum class Kind {
+      // |source| itself.
+      kIdentity,
+      // An OpVectorShuffle of |source| with |components|.
+      kShuffle,
+      // A constant vector.
+      kConstant,
+      // An OpCompositeConstruct of |lanes|.
+      kGather,
+      // A vector instruction of |opcode| on the vectors of |operands|.
+      kVectorize,
+    };
+
+    Kind kind;
+    std::vector<uint32_t> lanes;
+    uint32_t scalar_type_id = 0;
+    uint32_t source = 0;
+    std::vector<uint32_t> components;
+    SpvOp opcode = SpvOpNop;
+    std::vector<std::unique_ptr<Node>> operands;
+  };
+
+  // Rebuilds the tree of the construct |seed| if it is profitable.  Returns
+  // the status.
+  Status VectorizeTree(Instruction* seed);
+
+  // Returns the node of the vector whose components are |lanes|, of type
+  // |scalar_type_id|.  |depth| is the depth of the node in the tree.
+  std::unique_ptr<Node> BuildNode(const std::vector<uint32_t>& lanes,
+                                  uint32_t scalar_type_id, uint32_t depth);
+
+  // Returns true if the instructions |lanes| have the same vectorizable
+  // opcode and decorations.
+  bool AreIsomorphic(const std::vector<Instruction*>& lanes) const;
+
+  // Adds to |num_instructions| the number of vector instructions to generate
+  // for |node|, and to |num_dead| the number of scalar instructions they
+  // make dead.  |parents_dead| tells, for each lane, if the instruction
+  // using it in the parent node becomes dead.
+  void CountInstructions(const Node& node,
+                         const std::vector<bool>& parents_dead,
+                         uint32_t* num_instructions, uint32_t* num_dead) const;
+
+  // Generates the vector instructions of |node| of type |vector_type_id|
+  // with |builder|.  Returns the id of the vector, or 0 if the ids overflow.
+  uint32_t GenerateNode(const Node& node, uint32_t vector_type_id,
+                        InstructionBuilder* builder);
+
+  // Removes the scalar instructions of |node| which are no longer used.
+  void KillDeadLanes(const Node& node);
+};
+
+}  // namespace opt
+}  // namespace spvtools
+
+#endif  // SOURCE_OPT_SLP_VECTORIZE_PASS_H_
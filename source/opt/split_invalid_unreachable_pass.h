@@ -29,6 +29,7 @@ class SplitInvalidUnreachablePass : public Pass {
  public:
   const char* name() const override { return "split-invalid-unreachable"; }
   Status Process() override;
+  bool IsRequired() const override { return true; }
 
   IRContext::Analysis GetPreservedAnalyses() override {
     return IRContext::kAnalysisInstrToBlockMapping |
@@ -66,6 +66,10 @@ namespace opt {
 namespace {
 const uint32_t kStoreValIdInIdx = 1;
 const uint32_t kVariableInitIdInIdx = 1;
+
+// The largest number of entries in the dense table of definitions, which
+// takes 4 bytes per entry.
+const size_t kMaxDenseDefs = 1 << 22;
 }  // namespace
 
 std::string SSARewriter::PhiCandidate::PrettyPrint(const CFG* cfg) const {
@@ -88,21 +92,24 @@ std::string SSARewriter::PhiCandidate::PrettyPrint(const CFG* cfg) const {
   return str.str();
 }
 
-SSARewriter::PhiCandidate& SSARewriter::CreatePhiCandidate(uint32_t var_id,
-                                                           BasicBlock* bb) {
+SSARewriter::PhiCandidate& SSARewriter::CreatePhiCandidate(
+    uint32_t var_index, uint32_t bb_index) {
   // TODO(1841): Handle id overflow.
   uint32_t phi_result_id = pass_->context()->TakeNextId();
-  auto result = phi_candidates_.emplace(
-      phi_result_id, PhiCandidate(var_id, phi_result_id, bb));
-  PhiCandidate& phi_candidate = result.first->second;
-  return phi_candidate;
+  assert(phi_result_id >= first_phi_id_);
+  const uint32_t index = phi_result_id - first_phi_id_;
+  if (index >= phi_candidates_.size()) phi_candidates_.resize(index + 1);
+  phi_candidates_[index].reset(
+      new PhiCandidate(target_vars_[var_index], var_index, phi_result_id,
+                       blocks_[bb_index], bb_index));
+  return *phi_candidates_[index];
 }
 
 void SSARewriter::ReplacePhiUsersWith(const PhiCandidate& phi_to_remove,
                                       uint32_t repl_id) {
   for (uint32_t user_id : phi_to_remove.users()) {
     PhiCandidate* user_phi = GetPhiCandidate(user_id);
-    BasicBlock* bb = pass_->context()->get_instr_block(user_id);
+    const auto user_block = block_index_.find(user_id);
     if (user_phi) {
       // If the user is a Phi candidate, replace all arguments that refer to
       // |phi_to_remove.result_id()| with |repl_id|.
@@ -111,10 +118,10 @@ void SSARewriter::ReplacePhiUsersWith(const PhiCandidate& phi_to_remove,
           arg = repl_id;
         }
       }
-    } else if (bb->id() == user_id) {
-      // The phi candidate is the definition of the variable at basic block
-      // |bb|.  We must change this to the replacement.
-      WriteVariable(phi_to_remove.var_id(), bb, repl_id);
+    } else if (user_block != block_index_.end()) {
+      // The phi candidate is the definition of the variable at the basic
+      // block |user_id|.  We must change this to the replacement.
+      WriteVariable(phi_to_remove.var_index(), user_block->second, repl_id);
     } else {
       // For regular loads, traverse the |load_replacement_| table looking for
       // instances of |phi_to_remove|.
@@ -168,16 +175,14 @@ uint32_t SSARewriter::AddPhiOperands(PhiCandidate* phi_candidate) {
          "Phi candidate already has arguments");
 
   bool found_0_arg = false;
-  for (uint32_t pred : pass_->cfg()->preds(phi_candidate->bb()->id())) {
-    BasicBlock* pred_bb = pass_->cfg()->block(pred);
-
-    // If |pred_bb| is not sealed, use %0 to indicate that
+  for (uint32_t pred_index : block_preds_[phi_candidate->bb_index()]) {
+    // If the predecessor is not sealed, use %0 to indicate that
     // |phi_candidate| needs to be completed after the whole CFG has
     // been processed.
     //
     // Note that we cannot call GetReachingDef() in these cases
     // because this would generate an empty Phi candidate in
-    // |pred_bb|.  When |pred_bb| is later processed, a new definition
+    // the predecessor.  When it is later processed, a new definition
     // for |phi_candidate->var_id_| will be lost because
     // |phi_candidate| will still be reached by the empty Phi.
     //
@@ -204,9 +209,10 @@ uint32_t SSARewriter::AddPhiOperands(PhiCandidate* phi_candidate) {
     // By making the argument %0, we make |phi_candidate| incomplete,
     // which will cause it to be completed after the whole CFG has
     // been scanned.
-    uint32_t arg_id = IsBlockSealed(pred_bb)
-                          ? GetReachingDef(phi_candidate->var_id(), pred_bb)
-                          : 0;
+    uint32_t arg_id =
+        IsBlockSealed(pred_index)
+            ? GetReachingDef(phi_candidate->var_index(), pred_index)
+            : 0;
     phi_candidate->phi_args().push_back(arg_id);
 
     if (arg_id == 0) {
@@ -241,57 +247,52 @@ uint32_t SSARewriter::AddPhiOperands(PhiCandidate* phi_candidate) {
   return repl_id;
 }
 
-uint32_t SSARewriter::GetReachingDef(uint32_t var_id, BasicBlock* bb) {
-  // If |var_id| has a definition in |bb|, return it.
-  const auto& bb_it = defs_at_block_.find(bb);
-  if (bb_it != defs_at_block_.end()) {
-    const auto& current_defs = bb_it->second;
-    const auto& var_it = current_defs.find(var_id);
-    if (var_it != current_defs.end()) {
-      return var_it->second;
-    }
+uint32_t SSARewriter::GetReachingDef(uint32_t var_index, uint32_t bb_index) {
+  // If the variable has a definition in the block, return it.
+  uint32_t val_id = ReadVariable(var_index, bb_index);
+  if (val_id != 0) {
+    return val_id;
   }
 
-  // Otherwise, look up the value for |var_id| in |bb|'s predecessors.
-  uint32_t val_id = 0;
-  auto& predecessors = pass_->cfg()->preds(bb->id());
+  // Otherwise, look up the value for the variable in the block's
+  // predecessors.
+  const std::vector<uint32_t>& predecessors = block_preds_[bb_index];
   if (predecessors.size() == 1) {
-    // If |bb| has exactly one predecessor, we look for |var_id|'s definition
-    // there.
-    val_id = GetReachingDef(var_id, pass_->cfg()->block(predecessors[0]));
+    // If the block has exactly one predecessor, we look for the variable's
+    // definition there.
+    val_id = GetReachingDef(var_index, predecessors[0]);
   } else if (predecessors.size() > 1) {
     // If there is more than one predecessor, this is a join block which may
-    // require a Phi instruction.  This will act as |var_id|'s current
+    // require a Phi instruction.  This will act as the variable's current
     // definition to break potential cycles.
-    PhiCandidate& phi_candidate = CreatePhiCandidate(var_id, bb);
+    PhiCandidate& phi_candidate = CreatePhiCandidate(var_index, bb_index);
 
-    // Set the value for |bb| to avoid an infinite recursion.
-    WriteVariable(var_id, bb, phi_candidate.result_id());
+    // Set the value for the block to avoid an infinite recursion.
+    WriteVariable(var_index, bb_index, phi_candidate.result_id());
     val_id = AddPhiOperands(&phi_candidate);
   }
 
   // If we could not find a store for this variable in the path from the root
   // of the CFG, the variable is not defined, so we use undef.
   if (val_id == 0) {
-    val_id = pass_->GetUndefVal(var_id);
+    val_id = pass_->GetUndefVal(target_vars_[var_index]);
     if (val_id == 0) {
       return 0;
     }
   }
 
-  WriteVariable(var_id, bb, val_id);
+  WriteVariable(var_index, bb_index, val_id);
 
   return val_id;
 }
 
-void SSARewriter::SealBlock(BasicBlock* bb) {
-  auto result = sealed_blocks_.insert(bb);
-  (void)result;
-  assert(result.second == true &&
+void SSARewriter::SealBlock(uint32_t bb_index) {
+  assert(!sealed_blocks_[bb_index] &&
          "Tried to seal the same basic block more than once.");
+  sealed_blocks_[bb_index] = true;
 }
 
-void SSARewriter::ProcessStore(Instruction* inst, BasicBlock* bb) {
+void SSARewriter::ProcessStore(Instruction* inst, uint32_t bb_index) {
   auto opcode = inst->opcode();
   assert((opcode == SpvOpStore || opcode == SpvOpVariable) &&
          "Expecting a store or a variable definition instruction.");
@@ -305,8 +306,9 @@ void SSARewriter::ProcessStore(Instruction* inst, BasicBlock* bb) {
     var_id = inst->result_id();
     val_id = inst->GetSingleWordInOperand(kVariableInitIdInIdx);
   }
-  if (pass_->IsTargetVar(var_id)) {
-    WriteVariable(var_id, bb, val_id);
+  const auto var = var_index_.find(var_id);
+  if (var != var_index_.end()) {
+    WriteVariable(var->second, bb_index, val_id);
 
 #if SSA_REWRITE_DEBUGGING_LEVEL > 1
     std::cerr << "\tFound store '%" << var_id << " = %" << val_id << "': "
@@ -316,12 +318,13 @@ void SSARewriter::ProcessStore(Instruction* inst, BasicBlock* bb) {
   }
 }
 
-bool SSARewriter::ProcessLoad(Instruction* inst, BasicBlock* bb) {
+bool SSARewriter::ProcessLoad(Instruction* inst, uint32_t bb_index) {
   uint32_t var_id = 0;
   (void)pass_->GetPtr(inst, &var_id);
-  if (pass_->IsTargetVar(var_id)) {
+  const auto var = var_index_.find(var_id);
+  if (var != var_index_.end()) {
     // Get the immediate reaching definition for |var_id|.
-    uint32_t val_id = GetReachingDef(var_id, bb);
+    uint32_t val_id = GetReachingDef(var->second, bb_index);
     if (val_id == 0) {
       return false;
     }
@@ -348,9 +351,10 @@ bool SSARewriter::ProcessLoad(Instruction* inst, BasicBlock* bb) {
 
 void SSARewriter::PrintPhiCandidates() const {
   std::cerr << "\nPhi candidates:\n";
-  for (const auto& phi_it : phi_candidates_) {
-    std::cerr << "\tBB %" << phi_it.second.bb()->id() << ": "
-              << phi_it.second.PrettyPrint(pass_->cfg()) << "\n";
+  for (const auto& phi_candidate : phi_candidates_) {
+    if (!phi_candidate) continue;
+    std::cerr << "\tBB %" << phi_candidate->bb()->id() << ": "
+              << phi_candidate->PrettyPrint(pass_->cfg()) << "\n";
   }
   std::cerr << "\n";
 }
@@ -370,12 +374,13 @@ bool SSARewriter::GenerateSSAReplacements(BasicBlock* bb) {
             << "\n";
 #endif
 
+  const uint32_t bb_index = block_index_[bb->id()];
   for (auto& inst : *bb) {
     auto opcode = inst.opcode();
     if (opcode == SpvOpStore || opcode == SpvOpVariable) {
-      ProcessStore(&inst, bb);
+      ProcessStore(&inst, bb_index);
     } else if (inst.opcode() == SpvOpLoad) {
-      if (!ProcessLoad(&inst, bb)) {
+      if (!ProcessLoad(&inst, bb_index)) {
         return false;
       }
     }
@@ -383,7 +388,7 @@ bool SSARewriter::GenerateSSAReplacements(BasicBlock* bb) {
 
   // Seal |bb|. This means that all the stores in it have been scanned and it's
   // ready to feed them into its successors.
-  SealBlock(bb);
+  SealBlock(bb_index);
 
 #if SSA_REWRITE_DEBUGGING_LEVEL > 1
   PrintPhiCandidates();
@@ -531,14 +536,13 @@ void SSARewriter::FinalizePhiCandidate(PhiCandidate* phi_candidate) {
          "Phi candidate should have arguments");
 
   uint32_t ix = 0;
-  for (uint32_t pred : pass_->cfg()->preds(phi_candidate->bb()->id())) {
-    BasicBlock* pred_bb = pass_->cfg()->block(pred);
+  for (uint32_t pred_index : block_preds_[phi_candidate->bb_index()]) {
     uint32_t& arg_id = phi_candidate->phi_args()[ix++];
     if (arg_id == 0) {
-      // If |pred_bb| is still not sealed, it means it's unreachable. In this
-      // case, we just use Undef as an argument.
-      arg_id = IsBlockSealed(pred_bb)
-                   ? GetReachingDef(phi_candidate->var_id(), pred_bb)
+      // If the predecessor is still not sealed, it means it's unreachable. In
+      // this case, we just use Undef as an argument.
+      arg_id = IsBlockSealed(pred_index)
+                   ? GetReachingDef(phi_candidate->var_index(), pred_index)
                    : pass_->GetUndefVal(phi_candidate->var_id());
     }
   }
@@ -570,6 +574,37 @@ void SSARewriter::FinalizePhiCandidates() {
   }
 }
 
+void SSARewriter::InitializeTables(Function* fp) {
+  for (auto& inst : *fp->entry()) {
+    if (inst.opcode() != SpvOpVariable) continue;
+    const uint32_t var_id = inst.result_id();
+    if (!pass_->IsTargetVar(var_id)) continue;
+    var_index_[var_id] = static_cast<uint32_t>(target_vars_.size());
+    target_vars_.push_back(var_id);
+  }
+
+  for (auto& bb : *fp) {
+    block_index_[bb.id()] = static_cast<uint32_t>(blocks_.size());
+    blocks_.push_back(&bb);
+  }
+  block_preds_.resize(blocks_.size());
+  for (size_t i = 0; i < blocks_.size(); ++i) {
+    for (uint32_t pred : pass_->cfg()->preds(blocks_[i]->id())) {
+      assert(block_index_.count(pred) && "Predecessor outside the function.");
+      block_preds_[i].push_back(block_index_[pred]);
+    }
+  }
+
+  const size_t num_defs = blocks_.size() * target_vars_.size();
+  use_dense_defs_ = num_defs <= kMaxDenseDefs;
+  if (use_dense_defs_) {
+    dense_defs_.assign(num_defs, 0);
+  } else {
+    sparse_defs_.resize(blocks_.size());
+  }
+  sealed_blocks_.assign(blocks_.size(), false);
+}
+
 Pass::Status SSARewriter::RewriteFunctionIntoSSA(Function* fp) {
 #if SSA_REWRITE_DEBUGGING_LEVEL > 0
   std::cerr << "Function before SSA rewrite:\n"
@@ -578,6 +613,7 @@ Pass::Status SSARewriter::RewriteFunctionIntoSSA(Function* fp) {
 
   // Collect variables that can be converted into SSA IDs.
   pass_->CollectTargetVars(fp);
+  InitializeTables(fp);
 
   // Generate all the SSA replacements and Phi candidates. This will
   // generate incomplete and trivial Phis.
@@ -611,8 +647,10 @@ Pass::Status SSARewriter::RewriteFunctionIntoSSA(Function* fp) {
 Pass::Status SSARewritePass::Process() {
   Status status = Status::SuccessWithoutChange;
   for (auto& fn : *get_module()) {
-    status =
-        CombineStatus(status, SSARewriter(this).RewriteFunctionIntoSSA(&fn));
+    if (!ShouldProcessFunction(&fn)) continue;
+    const Status fn_status = SSARewriter(this).RewriteFunctionIntoSSA(&fn);
+    if (fn_status == Status::SuccessWithChange) RecordChangedFunction(&fn);
+    status = CombineStatus(status, fn_status);
     if (status == Status::Failure) {
       break;
     }
@@ -15,10 +15,10 @@
 #ifndef SOURCE_OPT_SSA_REWRITE_PASS_H_
 #define SOURCE_OPT_SSA_REWRITE_PASS_H_
 
+#include <memory>
 #include <queue>
 #include <string>
 #include <unordered_map>
-#include <unordered_set>
 #include <utility>
 #include <vector>
 
@@ -40,7 +40,9 @@ namespace opt {
 class SSARewriter {
  public:
   SSARewriter(MemPass* pass)
-      : pass_(pass), first_phi_id_(pass_->get_module()->IdBound()) {}
+      : use_dense_defs_(true),
+        pass_(pass),
+        first_phi_id_(pass_->get_module()->IdBound()) {}
 
   // Rewrites SSA-target variables in function |fp| into SSA.  This is the
   // entry point for the SSA rewrite algorithm.  SSA-target variables are
@@ -53,18 +55,23 @@ class SSARewriter {
  private:
   class PhiCandidate {
    public:
-    explicit PhiCandidate(uint32_t var, uint32_t result, BasicBlock* block)
+    explicit PhiCandidate(uint32_t var, uint32_t var_index, uint32_t result,
+                          BasicBlock* block, uint32_t block_index)
         : var_id_(var),
+          var_index_(var_index),
           result_id_(result),
           bb_(block),
+          bb_index_(block_index),
           phi_args_(),
           copy_of_(0),
           is_complete_(false),
           users_() {}
 
     uint32_t var_id() const { return var_id_; }
+    uint32_t var_index() const { return var_index_; }
     uint32_t result_id() const { return result_id_; }
     BasicBlock* bb() const { return bb_; }
+    uint32_t bb_index() const { return bb_index_; }
     std::vector<uint32_t>& phi_args() { return phi_args_; }
     const std::vector<uint32_t>& phi_args() const { return phi_args_; }
     uint32_t copy_of() const { return copy_of_; }
@@ -95,6 +102,9 @@ class SSARewriter {
     // Variable ID that this Phi is merging.
     uint32_t var_id_;
 
+    // Index of |var_id_| in the table of SSA-target variables.
+    uint32_t var_index_;
+
     // SSA ID generated by this Phi (i.e., this is the result ID of the eventual
     // Phi instruction).
     uint32_t result_id_;
@@ -102,6 +112,9 @@ class SSARewriter {
     // Basic block to hold this Phi.
     BasicBlock* bb_;
 
+    // Index of |bb_| in the table of basic blocks.
+    uint32_t bb_index_;
+
     // Vector of operands for every predecessor block of |bb|.  This vector is
     // organized so that the Ith slot contains the argument coming from the Ith
     // predecessor of |bb|.
@@ -121,28 +134,32 @@ class SSARewriter {
     std::vector<uint32_t> users_;
   };
 
-  // Type used to keep track of store operations in each basic block.
-  typedef std::unordered_map<BasicBlock*,
-                             std::unordered_map<uint32_t, uint32_t>>
-      BlockDefsMap;
+  // Numbers the SSA-target variables and the basic blocks of |fp| densely,
+  // records the predecessors of each block by index, and sizes the tables
+  // indexed by these numbers.
+  void InitializeTables(Function* fp);
 
   // Generates all the SSA rewriting decisions for basic block |bb|.  This
   // populates the Phi candidate table (|phi_candidate_|) and the load
   // replacement table (|load_replacement_).  Returns true if successful.
   bool GenerateSSAReplacements(BasicBlock* bb);
 
-  // Seals block |bb|.  Sealing a basic block means |bb| and all its
-  // predecessors of |bb| have been scanned for loads/stores.
-  void SealBlock(BasicBlock* bb);
+  // Seals the block with index |bb_index|.  Sealing a basic block means the
+  // block and all its predecessors have been scanned for loads/stores.
+  void SealBlock(uint32_t bb_index);
 
-  // Returns true if |bb| has been sealed.
-  bool IsBlockSealed(BasicBlock* bb) { return sealed_blocks_.count(bb) != 0; }
+  // Returns true if the block with index |bb_index| has been sealed.
+  bool IsBlockSealed(uint32_t bb_index) const {
+    return sealed_blocks_[bb_index];
+  }
 
   // Returns the Phi candidate with result ID |id| if it exists in the table
   // |phi_candidates_|. If no such Phi candidate exists, it returns nullptr.
   PhiCandidate* GetPhiCandidate(uint32_t id) {
-    auto it = phi_candidates_.find(id);
-    return (it != phi_candidates_.end()) ? &it->second : nullptr;
+    if (id < first_phi_id_) return nullptr;
+    const uint32_t index = id - first_phi_id_;
+    return index < phi_candidates_.size() ? phi_candidates_[index].get()
+                                          : nullptr;
   }
 
   // Replaces all the users of Phi candidate |phi_cand| to be users of
@@ -184,34 +201,50 @@ class SSARewriter {
   // instructions for them.
   bool ApplyReplacements();
 
-  // Registers a definition for variable |var_id| in basic block |bb| with
-  // value |val_id|.
-  void WriteVariable(uint32_t var_id, BasicBlock* bb, uint32_t val_id) {
-    defs_at_block_[bb][var_id] = val_id;
+  // Returns the value of the variable with index |var_index| defined in the
+  // block with index |bb_index|, or 0 if the block does not define it.
+  uint32_t ReadVariable(uint32_t var_index, uint32_t bb_index) const {
+    if (use_dense_defs_) {
+      return dense_defs_[bb_index * target_vars_.size() + var_index];
+    }
+    const auto& defs = sparse_defs_[bb_index];
+    const auto it = defs.find(var_index);
+    return it != defs.end() ? it->second : 0;
+  }
+
+  // Registers a definition for the variable with index |var_index| in the
+  // block with index |bb_index| with value |val_id|.
+  void WriteVariable(uint32_t var_index, uint32_t bb_index, uint32_t val_id) {
+    if (use_dense_defs_) {
+      dense_defs_[bb_index * target_vars_.size() + var_index] = val_id;
+    } else {
+      sparse_defs_[bb_index][var_index] = val_id;
+    }
     if (auto* pc = GetPhiCandidate(val_id)) {
-      pc->AddUser(bb->id());
+      pc->AddUser(blocks_[bb_index]->id());
     }
   }
 
-  // Processes the store operation |inst| in basic block |bb|. This extracts
-  // the variable ID being stored into, determines whether the variable is an
-  // SSA-target variable, and, if it is, it stores its value in the
-  // |defs_at_block_| map.
-  void ProcessStore(Instruction* inst, BasicBlock* bb);
-
-  // Processes the load operation |inst| in basic block |bb|. This extracts
-  // the variable ID being stored into, determines whether the variable is an
-  // SSA-target variable, and, if it is, it reads its reaching definition by
-  // calling |GetReachingDef|.  Returns true if successful.
-  bool ProcessLoad(Instruction* inst, BasicBlock* bb);
-
-  // Reads the current definition for variable |var_id| in basic block |bb|.
-  // If |var_id| is not defined in block |bb| it walks up the predecessors of
-  // |bb|, creating new Phi candidates along the way, if needed.
+  // Processes the store operation |inst| in the block with index |bb_index|.
+  // This extracts the variable ID being stored into, determines whether the
+  // variable is an SSA-target variable, and, if it is, it records its value
+  // as the definition of the variable in the block.
+  void ProcessStore(Instruction* inst, uint32_t bb_index);
+
+  // Processes the load operation |inst| in the block with index |bb_index|.
+  // This extracts the variable ID being stored into, determines whether the
+  // variable is an SSA-target variable, and, if it is, it reads its reaching
+  // definition by calling |GetReachingDef|.  Returns true if successful.
+  bool ProcessLoad(Instruction* inst, uint32_t bb_index);
+
+  // Reads the current definition for the variable with index |var_index| in
+  // the block with index |bb_index|.  If the variable is not defined in the
+  // block it walks up the predecessors of the block, creating new Phi
+  // candidates along the way, if needed.
   //
-  // It returns the value for |var_id| from the RHS of the current reaching
-  // definition for |var_id|.
-  uint32_t GetReachingDef(uint32_t var_id, BasicBlock* bb);
+  // It returns the value for the variable from the RHS of its current
+  // reaching definition.
+  uint32_t GetReachingDef(uint32_t var_index, uint32_t bb_index);
 
   // Adds arguments to |phi_candidate| by getting the reaching definition of
   // |phi_candidate|'s variable on each of the predecessors of its basic
@@ -220,8 +253,8 @@ class SSARewriter {
   // this Phi copies.
   uint32_t AddPhiOperands(PhiCandidate* phi_candidate);
 
-  // Creates a Phi candidate instruction for variable |var_id| in basic block
-  // |bb|.
+  // Creates a Phi candidate instruction for the variable with index
+  // |var_index| in the block with index |bb_index|.
   //
   // Since the rewriting algorithm may remove Phi candidates when it finds
   // them to be trivial, we avoid the expense of creating actual Phi
@@ -229,7 +262,7 @@ class SSARewriter {
   // during rewriting.
   //
   // Once the candidate Phi is created, it returns its ID.
-  PhiCandidate& CreatePhiCandidate(uint32_t var_id, BasicBlock* bb);
+  PhiCandidate& CreatePhiCandidate(uint32_t var_index, uint32_t bb_index);
 
   // Attempts to remove a trivial Phi candidate |phi_cand|. Trivial Phis are
   // those that only reference themselves and one other value |val| any number
@@ -256,16 +289,30 @@ class SSARewriter {
   // Prints the load replacement table to std::cerr.
   void PrintReplacementTable() const;
 
-  // Map holding the value of every SSA-target variable at every basic block
-  // where the variable is stored. defs_at_block_[block][var_id] = val_id
-  // means that there is a store or Phi instruction for variable |var_id| at
-  // basic block |block| with value |val_id|.
-  BlockDefsMap defs_at_block_;
-
-  // Map, indexed by Phi ID, holding all the Phi candidates created during SSA
-  // rewriting.  |phi_candidates_[id]| returns the Phi candidate whose result
-  // is |id|.
-  std::unordered_map<uint32_t, PhiCandidate> phi_candidates_;
+  // The SSA-target variables of the function, and the index of each of them.
+  std::vector<uint32_t> target_vars_;
+  std::unordered_map<uint32_t, uint32_t> var_index_;
+
+  // The basic blocks of the function, the index of each of them by label ID,
+  // and the indices of the predecessors of each of them, in the order of the
+  // CFG.
+  std::vector<BasicBlock*> blocks_;
+  std::unordered_map<uint32_t, uint32_t> block_index_;
+  std::vector<std::vector<uint32_t>> block_preds_;
+
+  // The value of every SSA-target variable at every basic block where the
+  // variable is stored.  A value for variable |var_index| at block |bb_index|
+  // means that there is a store or Phi instruction for the variable in the
+  // block with that value.  The table is a dense matrix of blocks by
+  // variables when it is small enough, and a map per block otherwise.
+  bool use_dense_defs_;
+  std::vector<uint32_t> dense_defs_;
+  std::vector<std::unordered_map<uint32_t, uint32_t>> sparse_defs_;
+
+  // All the Phi candidates created during SSA rewriting, indexed by their
+  // result ID minus |first_phi_id_|.  The entries of the IDs taken for other
+  // purposes are null.
+  std::vector<std::unique_ptr<PhiCandidate>> phi_candidates_;
 
   // Queue of incomplete Phi candidates. These are Phi candidates created at
   // unsealed blocks. They need to be completed before they are instantiated
@@ -282,8 +329,8 @@ class SSARewriter {
   // is done to replace all uses of the original load ID with the value ID.
   std::unordered_map<uint32_t, uint32_t> load_replacement_;
 
-  // Set of blocks that have been sealed already.
-  std::unordered_set<BasicBlock*> sealed_blocks_;
+  // Whether each block has been sealed already, by index.
+  std::vector<bool> sealed_blocks_;
 
   // Memory pass requesting the SSA rewriter.
   MemPass* pass_;
@@ -298,7 +345,18 @@ class SSARewritePass : public MemPass {
   SSARewritePass() = default;
 
   const char* name() const override { return "ssa-rewrite"; }
+  bool IsFunctionLocal() const override { return true; }
   Status Process() override;
+
+  IRContext::Analysis GetPreservedAnalyses() override {
+    return IRContext::kAnalysisDefUse |
+           IRContext::kAnalysisInstrToBlockMapping |
+           IRContext::kAnalysisDecorations | IRContext::kAnalysisCFG |
+           IRContext::kAnalysisDominatorAnalysis |
+           IRContext::kAnalysisLoopAnalysis | IRContext::kAnalysisNameMap |
+           IRContext::kAnalysisConstants | IRContext::kAnalysisTypes |
+           IRContext::kAnalysisCallGraph;
+  }
 };
 
 }  // namespace opt
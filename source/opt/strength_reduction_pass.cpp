@@ -15,6 +15,8 @@
 #include "source/opt/strength_reduction_pass.h"
 
 #include <algorithm>
+#include <cmath>
+#include <cstdint>
 #include <cstdio>
 #include <cstring>
 #include <memory>
@@ -24,9 +26,12 @@
 #include <vector>
 
 #include "source/opt/def_use_manager.h"
+#include "source/opt/ir_builder.h"
 #include "source/opt/ir_context.h"
 #include "source/opt/log.h"
 #include "source/opt/reflect.h"
+#include "source/opt/scalar_analysis.h"
+#include "source/util/hex_float.h"
 
 namespace {
 // Count the number of trailing zeros in the binary representation of
@@ -51,6 +56,94 @@ bool IsPowerOf2(uint32_t val) {
   return ((val - 1) & val) == 0;
 }
 
+// The magic number of a 32-bit unsigned division by a constant.  The
+// quotient of n is the high word of n * |multiplier| shifted right by
+// |shift|.  If |add| is true, the multiplier is 2^32 too small, so the
+// quotient is (t + ((n - t) >> 1)) >> |shift|, where t is that high word.
+struct UnsignedMagic {
+  uint32_t multiplier;
+  uint32_t shift;
+  bool add;
+};
+
+// Returns the magic number of the unsigned division by |divisor|, which must
+// be greater than 1.  See Granlund and Montgomery, "Division by Invariant
+// Integers using Multiplication".
+UnsignedMagic ComputeUnsignedMagic(uint32_t divisor) {
+  assert(divisor > 1);
+  // Look for the smallest shift with a multiplier fitting in 32 bits, for
+  // which the error of the multiplier is small enough for all the 32-bit
+  // dividends.
+  for (uint32_t p = 32; p < 64; ++p) {
+    uint64_t two_p = uint64_t(1) << p;
+    uint64_t multiplier = (two_p + divisor - 1) / divisor;
+    if (multiplier > UINT32_MAX) break;
+    if (multiplier * divisor - two_p <= (uint64_t(1) << (p - 32))) {
+      return {static_cast<uint32_t>(multiplier), p - 32, false};
+    }
+  }
+
+  // Otherwise use the 33-bit multiplier 2^32 + m for the shift
+  // ceil(log2(divisor)).
+  uint32_t log2 = 0;
+  while ((uint64_t(1) << log2) < divisor) ++log2;
+  uint64_t multiplier =
+      (((uint64_t(1) << log2) - divisor) << 32) / divisor + 1;
+  return {static_cast<uint32_t>(multiplier), log2 - 1, true};
+}
+
+// The magic number of a 32-bit signed division by a constant.
+struct SignedMagic {
+  uint32_t multiplier;
+  uint32_t shift;
+};
+
+// Returns the magic number of the signed division by |divisor|, whose
+// absolute value must be at least 2 and not a power of 2.  See Warren,
+// "Hacker's Delight", section 10-4.
+SignedMagic ComputeSignedMagic(int32_t divisor) {
+  const uint32_t two31 = 0x80000000u;
+  uint32_t abs_divisor = divisor < 0 ? 0u - static_cast<uint32_t>(divisor)
+                                     : static_cast<uint32_t>(divisor);
+  uint32_t t = two31 + (static_cast<uint32_t>(divisor) >> 31);
+  uint32_t abs_nc = t - 1 - t % abs_divisor;
+  uint32_t p = 31;
+  uint32_t q1 = two31 / abs_nc;
+  uint32_t r1 = two31 - q1 * abs_nc;
+  uint32_t q2 = two31 / abs_divisor;
+  uint32_t r2 = two31 - q2 * abs_divisor;
+  uint32_t delta = 0;
+  do {
+    ++p;
+    q1 *= 2;
+    r1 *= 2;
+    if (r1 >= abs_nc) {
+      ++q1;
+      r1 -= abs_nc;
+    }
+    q2 *= 2;
+    r2 *= 2;
+    if (r2 >= abs_divisor) {
+      ++q2;
+      r2 -= abs_divisor;
+    }
+    delta = abs_divisor - r2;
+  } while (q1 < delta || (q1 == delta && r1 == 0));
+
+  uint32_t multiplier = q2 + 1;
+  if (divisor < 0) multiplier = 0u - multiplier;
+  return {multiplier, p - 32};
+}
+
+// Returns true if |value| is a normal float with a normal and exact
+// reciprocal, that is a power of 2.
+template <typename T>
+bool HasExactReciprocal(T value) {
+  int exponent = 0;
+  return std::isnormal(value) && std::isnormal(T(1) / value) &&
+         std::fabs(std::frexp(value, &exponent)) == T(0.5);
+}
+
 }  // namespace
 
 namespace spvtools {
@@ -58,18 +151,16 @@ namespace opt {
 
 Pass::Status StrengthReductionPass::Process() {
   // Initialize the member variables on a per module basis.
-  bool modified = false;
   int32_type_id_ = 0;
   uint32_type_id_ = 0;
   std::memset(constant_ids_, 0, sizeof(constant_ids_));
 
   FindIntTypesAndConstants();
-  modified = ScanFunctions();
-  return (modified ? Status::SuccessWithChange : Status::SuccessWithoutChange);
+  return ScanFunctions();
 }
 
 bool StrengthReductionPass::ReplaceMultiplyByPowerOf2(
-    BasicBlock::iterator* inst) {
+    BasicBlock* bb, BasicBlock::iterator* inst) {
   assert((*inst)->opcode() == SpvOp::SpvOpIMul &&
          "Only works for multiplication of integers.");
   bool modified = false;
@@ -107,6 +198,7 @@ bool StrengthReductionPass::ReplaceMultiplyByPowerOf2(
         // Insert the new instruction and update the data structures.
         (*inst) = (*inst).InsertBefore(std::move(newInstruction));
         get_def_use_mgr()->AnalyzeInstDefUse(&*(*inst));
+        context()->set_instr_block(&*(*inst), bb);
         ++(*inst);
         context()->ReplaceAllUsesWith((*inst)->result_id(), newResultId);
 
@@ -155,27 +247,374 @@ uint32_t StrengthReductionPass::GetConstantId(uint32_t val) {
       uint32_type_id_ = context()->get_type_mgr()->GetTypeInstruction(&uint);
     }
 
-    // Construct the constant.
-    uint32_t resultId = TakeNextId();
-    Operand constant(spv_operand_type_t::SPV_OPERAND_TYPE_LITERAL_INTEGER,
-                     {val});
-    std::unique_ptr<Instruction> newConstant(
-        new Instruction(context(), SpvOp::SpvOpConstant, uint32_type_id_,
-                        resultId, {constant}));
-    get_module()->AddGlobalValue(std::move(newConstant));
+    // Construct the constant through the constant manager, which also
+    // creates the other constants of this pass, and store the result id for
+    // next time.
+    constant_ids_[val] = GetIntConstantId(uint32_type_id_, val);
+  }
 
-    // Notify the DefUseManager about this constant.
-    auto constantIter = --get_module()->types_values_end();
-    get_def_use_mgr()->AnalyzeInstDef(&*constantIter);
+  return constant_ids_[val];
+}
 
-    // Store the result id for next time.
-    constant_ids_[val] = resultId;
+Pass::Status StrengthReductionPass::ReduceInductionMultiply(
+    Instruction* inst) {
+  assert(inst->opcode() == SpvOp::SpvOpIMul &&
+         "Only works for multiplication of integers.");
+  uint32_t type_id = inst->type_id();
+  if (type_id != int32_type_id_ && type_id != uint32_type_id_) {
+    return Status::SuccessWithoutChange;
   }
 
-  return constant_ids_[val];
+  BasicBlock* bb = context()->get_instr_block(inst);
+  Loop* loop = (*context()->GetLoopDescriptor(bb->GetParent()))[bb->id()];
+  if (loop == nullptr || loop->GetPreHeaderBlock() == nullptr ||
+      loop->GetLatchBlock() == nullptr) {
+    return Status::SuccessWithoutChange;
+  }
+
+  // The value must be a recurrence of the innermost loop containing the
+  // multiplication, so that it changes exactly once per iteration.
+  ScalarEvolutionAnalysis* scev = context()->GetScalarEvolutionAnalysis();
+  SENode* node = scev->SimplifyExpression(scev->AnalyzeInstruction(inst));
+  SERecurrentNode* recurrent = node->AsSERecurrentNode();
+  if (recurrent == nullptr || recurrent->GetLoop() != loop) {
+    return Status::SuccessWithoutChange;
+  }
+  SEConstantNode* offset = recurrent->GetOffset()->AsSEConstantNode();
+  SEConstantNode* step = recurrent->GetCoefficient()->AsSEConstantNode();
+  if (offset == nullptr || step == nullptr) {
+    return Status::SuccessWithoutChange;
+  }
+
+  // The constants are truncated to 32 bits, since the arithmetic wraps.
+  uint32_t offset_id = GetIntConstantId(
+      type_id, static_cast<uint32_t>(offset->FoldToSingleValue()));
+  uint32_t step_id = GetIntConstantId(
+      type_id, static_cast<uint32_t>(step->FoldToSingleValue()));
+  if (offset_id == 0 || step_id == 0) return Status::Failure;
+
+  // The phi temporarily takes the offset from the latch, until the
+  // increment is created.
+  BasicBlock* preheader = loop->GetPreHeaderBlock();
+  BasicBlock* latch = loop->GetLatchBlock();
+  InstructionBuilder phi_builder(
+      context(), &*loop->GetHeaderBlock()->begin(),
+      IRContext::kAnalysisDefUse | IRContext::kAnalysisInstrToBlockMapping);
+  Instruction* phi = phi_builder.AddPhi(
+      type_id, {offset_id, preheader->id(), offset_id, latch->id()});
+  if (phi == nullptr) return Status::Failure;
+
+  InstructionBuilder add_builder(
+      context(), latch->terminator(),
+      IRContext::kAnalysisDefUse | IRContext::kAnalysisInstrToBlockMapping);
+  Instruction* next = add_builder.AddBinaryOp(type_id, SpvOp::SpvOpIAdd,
+                                              phi->result_id(), step_id);
+  if (next == nullptr) return Status::Failure;
+  phi->SetInOperand(2, {next->result_id()});
+  get_def_use_mgr()->AnalyzeInstUse(phi);
+
+  ReplaceInstruction(inst, phi->result_id());
+  return Status::SuccessWithChange;
+}
+
+Pass::Status StrengthReductionPass::ReduceUnsignedDivision(Instruction* inst) {
+  assert((inst->opcode() == SpvOp::SpvOpUDiv ||
+          inst->opcode() == SpvOp::SpvOpUMod) &&
+         "Only works for unsigned divisions.");
+  uint32_t type_id = inst->type_id();
+  if (type_id == 0 || type_id != uint32_type_id_) {
+    return Status::SuccessWithoutChange;
+  }
+
+  uint32_t dividend_id = inst->GetSingleWordInOperand(0);
+  uint32_t divisor_id = inst->GetSingleWordInOperand(1);
+  Instruction* dividend = get_def_use_mgr()->GetDef(dividend_id);
+  Instruction* divisor = get_def_use_mgr()->GetDef(divisor_id);
+  if (dividend->type_id() != type_id || divisor->type_id() != type_id ||
+      divisor->opcode() != SpvOp::SpvOpConstant) {
+    return Status::SuccessWithoutChange;
+  }
+
+  // The divisions by 0 and 1 are left to the folding rules.
+  uint32_t value = divisor->GetSingleWordInOperand(0);
+  if (value <= 1) return Status::SuccessWithoutChange;
+
+  InstructionBuilder builder(
+      context(), inst,
+      IRContext::kAnalysisDefUse | IRContext::kAnalysisInstrToBlockMapping);
+  bool is_mod = inst->opcode() == SpvOp::SpvOpUMod;
+  Instruction* result = nullptr;
+  if (IsPowerOf2(value)) {
+    if (is_mod) {
+      uint32_t mask_id = GetIntConstantId(type_id, value - 1);
+      if (mask_id == 0) return Status::Failure;
+      result = builder.AddBinaryOp(type_id, SpvOp::SpvOpBitwiseAnd,
+                                   dividend_id, mask_id);
+    } else {
+      result = builder.AddBinaryOp(type_id, SpvOp::SpvOpShiftRightLogical,
+                                   dividend_id,
+                                   GetConstantId(CountTrailingZeros(value)));
+    }
+    if (result == nullptr) return Status::Failure;
+    ReplaceInstruction(inst, result->result_id());
+    return Status::SuccessWithChange;
+  }
+
+  UnsignedMagic magic = ComputeUnsignedMagic(value);
+  uint32_t multiplier_id = GetIntConstantId(type_id, magic.multiplier);
+  uint32_t struct_type_id = GetMulExtendedTypeId(type_id);
+  if (multiplier_id == 0 || struct_type_id == 0) return Status::Failure;
+  Instruction* product =
+      builder.AddBinaryOp(struct_type_id, SpvOp::SpvOpUMulExtended,
+                          dividend_id, multiplier_id);
+  if (product == nullptr) return Status::Failure;
+  Instruction* quotient =
+      builder.AddCompositeExtract(type_id, product->result_id(), {1});
+  if (quotient == nullptr) return Status::Failure;
+
+  if (magic.add) {
+    Instruction* diff = builder.AddBinaryOp(type_id, SpvOp::SpvOpISub,
+                                            dividend_id, quotient->result_id());
+    if (diff == nullptr) return Status::Failure;
+    Instruction* half =
+        builder.AddBinaryOp(type_id, SpvOp::SpvOpShiftRightLogical,
+                            diff->result_id(), GetConstantId(1));
+    if (half == nullptr) return Status::Failure;
+    quotient = builder.AddBinaryOp(type_id, SpvOp::SpvOpIAdd,
+                                   quotient->result_id(), half->result_id());
+    if (quotient == nullptr) return Status::Failure;
+  }
+  if (magic.shift != 0) {
+    quotient = builder.AddBinaryOp(type_id, SpvOp::SpvOpShiftRightLogical,
+                                   quotient->result_id(),
+                                   GetConstantId(magic.shift));
+    if (quotient == nullptr) return Status::Failure;
+  }
+
+  result = quotient;
+  if (is_mod) {
+    Instruction* multiple = builder.AddBinaryOp(
+        type_id, SpvOp::SpvOpIMul, quotient->result_id(), divisor_id);
+    if (multiple == nullptr) return Status::Failure;
+    result = builder.AddBinaryOp(type_id, SpvOp::SpvOpISub, dividend_id,
+                                 multiple->result_id());
+    if (result == nullptr) return Status::Failure;
+  }
+  ReplaceInstruction(inst, result->result_id());
+  return Status::SuccessWithChange;
 }
 
-bool StrengthReductionPass::ScanFunctions() {
+Pass::Status StrengthReductionPass::ReduceSignedDivision(Instruction* inst) {
+  assert((inst->opcode() == SpvOp::SpvOpSDiv ||
+          inst->opcode() == SpvOp::SpvOpSRem) &&
+         "Only works for signed divisions.");
+  uint32_t type_id = inst->type_id();
+  if (type_id == 0 || type_id != int32_type_id_) {
+    return Status::SuccessWithoutChange;
+  }
+
+  uint32_t dividend_id = inst->GetSingleWordInOperand(0);
+  uint32_t divisor_id = inst->GetSingleWordInOperand(1);
+  Instruction* dividend = get_def_use_mgr()->GetDef(dividend_id);
+  Instruction* divisor = get_def_use_mgr()->GetDef(divisor_id);
+  if (dividend->type_id() != type_id || divisor->type_id() != type_id ||
+      divisor->opcode() != SpvOp::SpvOpConstant) {
+    return Status::SuccessWithoutChange;
+  }
+
+  // The divisions by 0, 1 and -1 are left to the folding rules, and the
+  // division by INT32_MIN, whose absolute value does not fit, is kept.
+  int32_t value = static_cast<int32_t>(divisor->GetSingleWordInOperand(0));
+  if ((value >= -1 && value <= 1) || value == INT32_MIN) {
+    return Status::SuccessWithoutChange;
+  }
+  uint32_t abs_value = static_cast<uint32_t>(value < 0 ? -value : value);
+
+  InstructionBuilder builder(
+      context(), inst,
+      IRContext::kAnalysisDefUse | IRContext::kAnalysisInstrToBlockMapping);
+  Instruction* quotient = nullptr;
+  if (IsPowerOf2(abs_value)) {
+    // Round toward 0 by adding |abs_value| - 1 to the negative dividends
+    // before the arithmetic shift.
+    uint32_t log2 = CountTrailingZeros(abs_value);
+    Instruction* sign =
+        builder.AddBinaryOp(type_id, SpvOp::SpvOpShiftRightArithmetic,
+                            dividend_id, GetConstantId(31));
+    if (sign == nullptr) return Status::Failure;
+    Instruction* bias =
+        builder.AddBinaryOp(type_id, SpvOp::SpvOpShiftRightLogical,
+                            sign->result_id(), GetConstantId(32 - log2));
+    if (bias == nullptr) return Status::Failure;
+    Instruction* biased = builder.AddBinaryOp(type_id, SpvOp::SpvOpIAdd,
+                                              dividend_id, bias->result_id());
+    if (biased == nullptr) return Status::Failure;
+    quotient = builder.AddBinaryOp(type_id, SpvOp::SpvOpShiftRightArithmetic,
+                                   biased->result_id(), GetConstantId(log2));
+    if (quotient == nullptr) return Status::Failure;
+    if (value < 0) {
+      quotient = builder.AddUnaryOp(type_id, SpvOp::SpvOpSNegate,
+                                    quotient->result_id());
+      if (quotient == nullptr) return Status::Failure;
+    }
+  } else {
+    SignedMagic magic = ComputeSignedMagic(value);
+    uint32_t multiplier_id = GetIntConstantId(type_id, magic.multiplier);
+    uint32_t struct_type_id = GetMulExtendedTypeId(type_id);
+    if (multiplier_id == 0 || struct_type_id == 0) return Status::Failure;
+    Instruction* product =
+        builder.AddBinaryOp(struct_type_id, SpvOp::SpvOpSMulExtended,
+                            dividend_id, multiplier_id);
+    if (product == nullptr) return Status::Failure;
+    quotient = builder.AddCompositeExtract(type_id, product->result_id(), {1});
+    if (quotient == nullptr) return Status::Failure;
+
+    // Correct the high word when the sign of the multiplier is not the sign
+    // of the divisor.
+    bool negative_multiplier = (magic.multiplier & 0x80000000u) != 0;
+    if (value > 0 && negative_multiplier) {
+      quotient = builder.AddBinaryOp(type_id, SpvOp::SpvOpIAdd,
+                                     quotient->result_id(), dividend_id);
+    } else if (value < 0 && !negative_multiplier) {
+      quotient = builder.AddBinaryOp(type_id, SpvOp::SpvOpISub,
+                                     quotient->result_id(), dividend_id);
+    }
+    if (quotient == nullptr) return Status::Failure;
+    if (magic.shift != 0) {
+      quotient = builder.AddBinaryOp(
+          type_id, SpvOp::SpvOpShiftRightArithmetic, quotient->result_id(),
+          GetConstantId(magic.shift));
+      if (quotient == nullptr) return Status::Failure;
+    }
+
+    // Add 1 to the negative quotients to round them toward 0.
+    Instruction* sign =
+        builder.AddBinaryOp(type_id, SpvOp::SpvOpShiftRightLogical,
+                            quotient->result_id(), GetConstantId(31));
+    if (sign == nullptr) return Status::Failure;
+    quotient = builder.AddBinaryOp(type_id, SpvOp::SpvOpIAdd,
+                                   quotient->result_id(), sign->result_id());
+    if (quotient == nullptr) return Status::Failure;
+  }
+
+  Instruction* result = quotient;
+  if (inst->opcode() == SpvOp::SpvOpSRem) {
+    Instruction* multiple = builder.AddBinaryOp(
+        type_id, SpvOp::SpvOpIMul, quotient->result_id(), divisor_id);
+    if (multiple == nullptr) return Status::Failure;
+    result = builder.AddBinaryOp(type_id, SpvOp::SpvOpISub, dividend_id,
+                                 multiple->result_id());
+    if (result == nullptr) return Status::Failure;
+  }
+  ReplaceInstruction(inst, result->result_id());
+  return Status::SuccessWithChange;
+}
+
+Pass::Status StrengthReductionPass::ReduceFloatDivision(Instruction* inst) {
+  assert(inst->opcode() == SpvOp::SpvOpFDiv && "Only works for FDiv.");
+  Instruction* divisor =
+      get_def_use_mgr()->GetDef(inst->GetSingleWordInOperand(1));
+  if (divisor->opcode() != SpvOp::SpvOpConstant &&
+      divisor->opcode() != SpvOp::SpvOpConstantComposite) {
+    return Status::SuccessWithoutChange;
+  }
+  const analysis::Constant* constant =
+      context()->get_constant_mgr()->GetConstantFromInst(divisor);
+  if (constant == nullptr) return Status::SuccessWithoutChange;
+
+  // A rounded reciprocal is only used where the shader rules for floating
+  // point folding apply, or where the fast-math flags allow it.
+  bool allow_inexact = inst->IsFloatingPointFoldingAllowed();
+  get_decoration_mgr()->ForEachDecoration(
+      inst->result_id(), SpvDecorationFPFastMathMode,
+      [&allow_inexact](const Instruction& decoration) {
+        uint32_t mode = decoration.GetSingleWordInOperand(2);
+        if (mode & (SpvFPFastMathModeAllowRecipMask |
+                    SpvFPFastMathModeFastMask)) {
+          allow_inexact = true;
+        }
+      });
+
+  uint32_t reciprocal_id = GetReciprocalId(constant, allow_inexact);
+  if (reciprocal_id == 0) return Status::SuccessWithoutChange;
+
+  // The decorations of the division still apply to the multiplication.
+  inst->SetOpcode(SpvOp::SpvOpFMul);
+  inst->SetInOperand(1, {reciprocal_id});
+  get_def_use_mgr()->AnalyzeInstUse(inst);
+  return Status::SuccessWithChange;
+}
+
+uint32_t StrengthReductionPass::GetReciprocalId(const analysis::Constant* c,
+                                                bool allow_inexact) {
+  analysis::ConstantManager* const_mgr = context()->get_constant_mgr();
+  const analysis::Constant* reciprocal = nullptr;
+  if (const analysis::VectorConstant* vector_const = c->AsVectorConstant()) {
+    std::vector<uint32_t> ids;
+    for (const analysis::Constant* component :
+         vector_const->GetComponents()) {
+      uint32_t id = GetReciprocalId(component, allow_inexact);
+      if (id == 0) return 0;
+      ids.push_back(id);
+    }
+    reciprocal = const_mgr->GetConstant(c->type(), ids);
+  } else if (const analysis::FloatConstant* float_const =
+                 c->AsFloatConstant()) {
+    uint32_t width = float_const->type()->AsFloat()->width();
+    std::vector<uint32_t> words;
+    if (width == 32) {
+      float value = float_const->GetFloatValue();
+      if (!HasExactReciprocal(value) &&
+          (!allow_inexact || !std::isnormal(1.0f / value))) {
+        return 0;
+      }
+      words = utils::FloatProxy<float>(1.0f / value).GetWords();
+    } else if (width == 64) {
+      double value = float_const->GetDoubleValue();
+      if (!HasExactReciprocal(value) &&
+          (!allow_inexact || !std::isnormal(1.0 / value))) {
+        return 0;
+      }
+      words = utils::FloatProxy<double>(1.0 / value).GetWords();
+    } else {
+      return 0;
+    }
+    reciprocal = const_mgr->GetConstant(c->type(), words);
+  } else {
+    return 0;
+  }
+
+  Instruction* def = const_mgr->GetDefiningInstruction(reciprocal);
+  return def == nullptr ? 0 : def->result_id();
+}
+
+void StrengthReductionPass::ReplaceInstruction(Instruction* inst,
+                                               uint32_t new_id) {
+  if (context()->AreAnalysesValid(IRContext::kAnalysisScalarEvolution)) {
+    context()->GetScalarEvolutionAnalysis()->InvalidateInstruction(inst);
+  }
+  context()->ReplaceAllUsesWith(inst->result_id(), new_id);
+  dead_instructions_.push_back(inst);
+}
+
+uint32_t StrengthReductionPass::GetIntConstantId(uint32_t type_id,
+                                                 uint32_t value) {
+  analysis::ConstantManager* const_mgr = context()->get_constant_mgr();
+  const analysis::Constant* constant =
+      const_mgr->GetConstant(context()->get_type_mgr()->GetType(type_id),
+                             std::vector<uint32_t>{value});
+  Instruction* def = const_mgr->GetDefiningInstruction(constant);
+  return def == nullptr ? 0 : def->result_id();
+}
+
+uint32_t StrengthReductionPass::GetMulExtendedTypeId(uint32_t type_id) {
+  analysis::TypeManager* type_mgr = context()->get_type_mgr();
+  const analysis::Type* member_type = type_mgr->GetType(type_id);
+  analysis::Struct struct_type({member_type, member_type});
+  return type_mgr->GetTypeInstruction(&struct_type);
+}
+
+Pass::Status StrengthReductionPass::ScanFunctions() {
   // I did not use |ForEachInst| in the module because the function that acts on
   // the instruction gets a pointer to the instruction.  We cannot use that to
   // insert a new instruction.  I want an iterator.
@@ -183,17 +622,42 @@ bool StrengthReductionPass::ScanFunctions() {
   for (auto& func : *get_module()) {
     for (auto& bb : func) {
       for (auto inst = bb.begin(); inst != bb.end(); ++inst) {
+        Status status = Status::SuccessWithoutChange;
         switch (inst->opcode()) {
           case SpvOp::SpvOpIMul:
-            if (ReplaceMultiplyByPowerOf2(&inst)) modified = true;
+            if (ReplaceMultiplyByPowerOf2(&bb, &inst)) {
+              status = Status::SuccessWithChange;
+            } else {
+              status = ReduceInductionMultiply(&*inst);
+            }
+            break;
+          case SpvOp::SpvOpUDiv:
+          case SpvOp::SpvOpUMod:
+            status = ReduceUnsignedDivision(&*inst);
+            break;
+          case SpvOp::SpvOpSDiv:
+          case SpvOp::SpvOpSRem:
+            status = ReduceSignedDivision(&*inst);
+            break;
+          case SpvOp::SpvOpFDiv:
+            status = ReduceFloatDivision(&*inst);
             break;
           default:
             break;
         }
+        if (status == Status::Failure) return Status::Failure;
+        if (status == Status::SuccessWithChange) modified = true;
       }
     }
+
+    // The replaced instructions are killed once the iterators over the
+    // blocks are no longer used.
+    for (Instruction* dead : dead_instructions_) {
+      context()->KillInst(dead);
+    }
+    dead_instructions_.clear();
   }
-  return modified;
+  return (modified ? Status::SuccessWithChange : Status::SuccessWithoutChange);
 }
 
 }  // namespace opt
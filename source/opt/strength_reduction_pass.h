@@ -15,6 +15,8 @@
 #ifndef SOURCE_OPT_STRENGTH_REDUCTION_PASS_H_
 #define SOURCE_OPT_STRENGTH_REDUCTION_PASS_H_
 
+#include <vector>
+
 #include "source/opt/def_use_manager.h"
 #include "source/opt/ir_context.h"
 #include "source/opt/module.h"
@@ -29,10 +31,57 @@ class StrengthReductionPass : public Pass {
   const char* name() const override { return "strength-reduction"; }
   Status Process() override;
 
+  IRContext::Analysis GetPreservedAnalyses() override {
+    return IRContext::kAnalysisDefUse |
+           IRContext::kAnalysisInstrToBlockMapping |
+           IRContext::kAnalysisDecorations | IRContext::kAnalysisCFG |
+           IRContext::kAnalysisDominatorAnalysis |
+           IRContext::kAnalysisLoopAnalysis | IRContext::kAnalysisNameMap |
+           IRContext::kAnalysisTypes | IRContext::kAnalysisCallGraph;
+  }
+
  private:
-  // Replaces multiple by power of 2 with an equivalent bit shift.
+  // Replaces multiple by power of 2 with an equivalent bit shift.  |bb| is
+  // the block containing the instruction.
   // Returns true if something changed.
-  bool ReplaceMultiplyByPowerOf2(BasicBlock::iterator*);
+  bool ReplaceMultiplyByPowerOf2(BasicBlock* bb, BasicBlock::iterator*);
+
+  // Replaces the multiplication |inst| in a loop, whose value is an affine
+  // function of the iteration count with constant coefficients, with a new
+  // induction variable incremented by an addition.  Returns the status.
+  Status ReduceInductionMultiply(Instruction* inst);
+
+  // Replaces the 32-bit unsigned division or modulo |inst| by a constant
+  // with a shift or a mask for a power of 2, and with a multiplication by a
+  // magic number otherwise.  Returns the status.
+  Status ReduceUnsignedDivision(Instruction* inst);
+
+  // Replaces the 32-bit signed division or remainder |inst| by a constant
+  // with shifts for a power of 2, and with a multiplication by a magic number
+  // otherwise.  Returns the status.
+  Status ReduceSignedDivision(Instruction* inst);
+
+  // Replaces the float division |inst| by a constant with a multiplication
+  // by its reciprocal, if the reciprocal is exact or the fast-math flags
+  // allow it.  Returns the status.
+  Status ReduceFloatDivision(Instruction* inst);
+
+  // Returns the id of the reciprocal of the float constant |c|, or 0 if it
+  // cannot be used.  |allow_inexact| tells if a rounded reciprocal can be
+  // used.
+  uint32_t GetReciprocalId(const analysis::Constant* c, bool allow_inexact);
+
+  // Replaces the uses of |inst| with |new_id|, and records |inst| to be
+  // killed once its function is scanned.
+  void ReplaceInstruction(Instruction* inst, uint32_t new_id);
+
+  // Returns the id of the integer constant of type |type_id| with |value|,
+  // or 0 if the ids overflow.
+  uint32_t GetIntConstantId(uint32_t type_id, uint32_t value);
+
+  // Returns the id of the result type of OpUMulExtended or OpSMulExtended on
+  // values of type |type_id|, or 0 if the ids overflow.
+  uint32_t GetMulExtendedTypeId(uint32_t type_id);
 
   // Scan the types and constants in the module looking for the the integer
   // types that we are
@@ -46,8 +95,8 @@ class StrengthReductionPass : public Pass {
   uint32_t GetConstantId(uint32_t);
 
   // Replaces certain instructions in function bodies with presumably cheaper
-  // ones. Returns true if something changed.
-  bool ScanFunctions();
+  // ones. Returns the status.
+  Status ScanFunctions();
 
   // Type ids for the types of interest, or 0 if they do not exist.
   uint32_t int32_type_id_;
@@ -57,6 +106,9 @@ class StrengthReductionPass : public Pass {
   // We set the limit at 32 because a bit shift of a 32-bit integer does not
   // need a value larger than 32.
   uint32_t constant_ids_[33];
+
+  // The instructions replaced in the function being scanned.
+  std::vector<Instruction*> dead_instructions_;
 };
 
 }  // namespace opt
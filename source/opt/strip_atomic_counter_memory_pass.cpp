@@ -13,10 +13,70 @@
 // limitations under the License.
 
 #include "source/opt/strip_atomic_counter_memory_pass.h"
+
+#include "source/ext_inst.h"
+#include "source/opcode.h"
 #include "source/opt/ir_context.h"
+#include "source/util/bit_vector.h"
+#include "source/util/make_unique.h"
 
 namespace spvtools {
 namespace opt {
+namespace {
+
+// Does the work of StripAtomicCounterMemoryPass on the binary of a module,
+// which it can only do if there is nothing to strip: the pass would have to
+// make new constants.  The module is then copied as it is.
+class StripAtomicCounterMemoryFilter : public BinaryFilter {
+ public:
+  bool Scan(const spv_parsed_instruction_t& inst) override {
+    const SpvOp opcode = static_cast<SpvOp>(inst.opcode);
+    switch (opcode) {
+      case SpvOpConstant:
+      case SpvOpSpecConstant:
+        if (inst.num_words == 4 &&
+            (inst.words[3] & SpvMemorySemanticsAtomicCounterMemoryMask)) {
+          with_atomic_counter_memory_.Set(inst.result_id);
+        }
+        return true;
+      case SpvOpFunction:
+        in_function_ = true;
+        return true;
+      case SpvOpFunctionEnd:
+        in_function_ = false;
+        return true;
+      case SpvOpExtInst:
+        // The IR moves the debug info instructions outside of functions after
+        // the types and values.
+        return in_function_ || !spvExtInstIsDebugInfo(inst.ext_inst_type);
+      default:
+        break;
+    }
+
+    for (uint32_t index : spvOpcodeMemorySemanticsOperandIndices(opcode)) {
+      if (index < inst.num_operands &&
+          with_atomic_counter_memory_.Get(
+              inst.words[inst.operands[index].offset])) {
+        return false;
+      }
+    }
+    return true;
+  }
+
+  bool Keep(const spv_parsed_instruction_t&) override { return true; }
+
+ private:
+  bool in_function_ = false;
+  // The result ids of the 32-bit constants with the AtomicCounterMemory bit.
+  utils::BitVector with_atomic_counter_memory_;
+};
+
+}  // namespace
+
+std::unique_ptr<BinaryFilter>
+StripAtomicCounterMemoryPass::CreateBinaryFilter() const {
+  return MakeUnique<StripAtomicCounterMemoryFilter>();
+}
 
 Pass::Status StripAtomicCounterMemoryPass::Process() {
   bool changed = false;
@@ -29,6 +29,8 @@ class StripAtomicCounterMemoryPass : public Pass {
  public:
   const char* name() const override { return "strip-atomic-counter-memory"; }
   Status Process() override;
+  std::unique_ptr<BinaryFilter> CreateBinaryFilter() const override;
+  bool IsRequired() const override { return true; }
 
   IRContext::Analysis GetPreservedAnalyses() override {
     return IRContext::kAnalysisInstrToBlockMapping |
@@ -13,10 +13,103 @@
 // limitations under the License.
 
 #include "source/opt/strip_debug_info_pass.h"
+
+#include <cstring>
+
+#include "source/ext_inst.h"
+#include "source/operand.h"
 #include "source/opt/ir_context.h"
+#include "source/opt/reflect.h"
+#include "source/util/bit_vector.h"
+#include "source/util/make_unique.h"
 
 namespace spvtools {
 namespace opt {
+namespace {
+
+// Does the work of StripDebugInfoPass on the binary of a module.
+class StripDebugInfoFilter : public BinaryFilter {
+ public:
+  bool Scan(const spv_parsed_instruction_t& inst) override {
+    switch (inst.opcode) {
+      case SpvOpExtension:
+        if (0 == std::strcmp(reinterpret_cast<const char*>(&inst.words[1]),
+                             "SPV_KHR_non_semantic_info")) {
+          uses_non_semantic_info_ = true;
+        }
+        break;
+      case SpvOpString:
+        strings_.Set(inst.result_id);
+        break;
+      case SpvOpGroupDecorate:
+      case SpvOpGroupMemberDecorate:
+        // Removing the decorations of a killed instruction would rewrite
+        // these.
+        return false;
+      case SpvOpFunction:
+        in_function_ = true;
+        break;
+      case SpvOpFunctionEnd:
+        in_function_ = false;
+        break;
+      case SpvOpExtInst:
+        if (spvExtInstIsNonSemantic(inst.ext_inst_type)) {
+          for (uint16_t i = 0; i < inst.num_operands; ++i) {
+            const spv_parsed_operand_t& operand = inst.operands[i];
+            if (spvIsIdType(operand.type)) {
+              used_by_non_semantic_.Set(inst.words[operand.offset]);
+            }
+          }
+        } else if (!in_function_ &&
+                   spvExtInstIsDebugInfo(inst.ext_inst_type)) {
+          debug_info_.Set(inst.result_id);
+        }
+        break;
+      default:
+        break;
+    }
+    return true;
+  }
+
+  bool Keep(const spv_parsed_instruction_t& inst) override {
+    const SpvOp opcode = static_cast<SpvOp>(inst.opcode);
+    if (opcode == SpvOpString) return KeepsString(inst.result_id);
+    if (IsDebug1Inst(opcode) || IsDebug2Inst(opcode) || IsDebug3Inst(opcode) ||
+        IsDebugLineInst(opcode)) {
+      return false;
+    }
+    if (opcode == SpvOpExtInst) return !debug_info_.Get(inst.result_id);
+    if (IsAnnotationInst(opcode)) {
+      // The decorations of a killed instruction are killed with it.
+      const uint32_t target = inst.words[1];
+      return !debug_info_.Get(target) &&
+             (!strings_.Get(target) || KeepsString(target));
+    }
+    return true;
+  }
+
+ private:
+  // Returns true if the OpString |id| is kept: only those used by
+  // non-semantic instructions are, as in StripDebugInfoPass::Process.
+  bool KeepsString(uint32_t id) const {
+    return uses_non_semantic_info_ && used_by_non_semantic_.Get(id);
+  }
+
+  bool uses_non_semantic_info_ = false;
+  bool in_function_ = false;
+  // The result ids of the OpString instructions.
+  utils::BitVector strings_;
+  // The ids used by the instructions of non-semantic instruction sets.
+  utils::BitVector used_by_non_semantic_;
+  // The result ids of the debug info instructions outside of functions.
+  utils::BitVector debug_info_;
+};
+
+}  // namespace
+
+std::unique_ptr<BinaryFilter> StripDebugInfoPass::CreateBinaryFilter() const {
+  return MakeUnique<StripDebugInfoFilter>();
+}
 
 Pass::Status StripDebugInfoPass::Process() {
   bool uses_non_semantic_info = false;
@@ -93,8 +186,8 @@ Pass::Status StripDebugInfoPass::Process() {
 
   // clear OpLine information
   context()->module()->ForEachInst([&modified](Instruction* inst) {
-    modified |= !inst->dbg_line_insts().empty();
-    inst->dbg_line_insts().clear();
+    modified |= inst->NumDbgLineInsts() != 0;
+    inst->clear_dbg_line_insts();
   });
 
   if (!get_module()->trailing_dbg_line_info().empty()) {
@@ -27,6 +27,7 @@ class StripDebugInfoPass : public Pass {
  public:
   const char* name() const override { return "strip-debug"; }
   Status Process() override;
+  std::unique_ptr<BinaryFilter> CreateBinaryFilter() const override;
 };
 
 }  // namespace opt
@@ -17,11 +17,115 @@
 #include <cstring>
 #include <vector>
 
+#include "source/ext_inst.h"
 #include "source/opt/instruction.h"
 #include "source/opt/ir_context.h"
+#include "source/opt/reflect.h"
+#include "source/util/bit_vector.h"
+#include "source/util/make_unique.h"
 
 namespace spvtools {
 namespace opt {
+namespace {
+
+// Does the work of StripReflectInfoPass on the binary of a module.
+class StripReflectInfoFilter : public BinaryFilter {
+ public:
+  bool Scan(const spv_parsed_instruction_t& inst) override {
+    switch (inst.opcode) {
+      case SpvOpDecorateStringGOOGLE:
+        if (inst.words[2] != SpvDecorationHlslSemanticGOOGLE) {
+          other_uses_for_decorate_string_ = true;
+        }
+        break;
+      case SpvOpMemberDecorateStringGOOGLE:
+        if (inst.words[3] != SpvDecorationHlslSemanticGOOGLE) {
+          other_uses_for_decorate_string_ = true;
+        }
+        break;
+      case SpvOpGroupDecorate:
+      case SpvOpGroupMemberDecorate:
+        // Removing the decorations of a killed instruction would rewrite
+        // these.
+        return false;
+      case SpvOpString:
+        killed_.Set(inst.result_id);
+        break;
+      case SpvOpExtInstImport:
+        if (0 == std::strncmp(reinterpret_cast<const char*>(&inst.words[2]),
+                              "NonSemantic.", 12)) {
+          non_semantic_sets_.Set(inst.result_id);
+          killed_.Set(inst.result_id);
+        }
+        break;
+      case SpvOpFunction:
+        in_function_ = true;
+        break;
+      case SpvOpFunctionEnd:
+        in_function_ = false;
+        break;
+      case SpvOpExtInst:
+        if (non_semantic_sets_.Get(inst.words[3]) ||
+            (!in_function_ && spvExtInstIsDebugInfo(inst.ext_inst_type))) {
+          killed_.Set(inst.result_id);
+        }
+        break;
+      default:
+        break;
+    }
+    return true;
+  }
+
+  bool Keep(const spv_parsed_instruction_t& inst) override {
+    const SpvOp opcode = static_cast<SpvOp>(inst.opcode);
+    switch (opcode) {
+      case SpvOpDecorateStringGOOGLE:
+        if (inst.words[2] == SpvDecorationHlslSemanticGOOGLE) return false;
+        break;
+      case SpvOpMemberDecorateStringGOOGLE:
+        if (inst.words[3] == SpvDecorationHlslSemanticGOOGLE) return false;
+        break;
+      case SpvOpDecorateId:
+        if (inst.words[2] == SpvDecorationHlslCounterBufferGOOGLE) {
+          return false;
+        }
+        break;
+      case SpvOpExtension: {
+        const char* ext_name = reinterpret_cast<const char*>(&inst.words[1]);
+        return 0 != std::strcmp(ext_name, "SPV_GOOGLE_hlsl_functionality1") &&
+               (other_uses_for_decorate_string_ ||
+                0 != std::strcmp(ext_name, "SPV_GOOGLE_decorate_string")) &&
+               0 != std::strcmp(ext_name, "SPV_KHR_non_semantic_info");
+      }
+      case SpvOpExtInstImport:
+      case SpvOpExtInst:
+        return !killed_.Get(inst.result_id);
+      default:
+        break;
+    }
+    if (IsDebug1Inst(opcode) || IsDebug2Inst(opcode) || IsDebug3Inst(opcode)) {
+      return false;
+    }
+    // The decorations of a killed instruction are killed with it.
+    if (IsAnnotationInst(opcode)) return !killed_.Get(inst.words[1]);
+    return true;
+  }
+
+ private:
+  bool other_uses_for_decorate_string_ = false;
+  bool in_function_ = false;
+  // The result ids of the imports of non-semantic instruction sets.
+  utils::BitVector non_semantic_sets_;
+  // The result ids of the instructions the pass kills.
+  utils::BitVector killed_;
+};
+
+}  // namespace
+
+std::unique_ptr<BinaryFilter>
+StripReflectInfoPass::CreateBinaryFilter() const {
+  return MakeUnique<StripReflectInfoFilter>();
+}
 
 Pass::Status StripReflectInfoPass::Process() {
   bool modified = false;
@@ -27,6 +27,7 @@ class StripReflectInfoPass : public Pass {
  public:
   const char* name() const override { return "strip-reflect"; }
   Status Process() override;
+  std::unique_ptr<BinaryFilter> CreateBinaryFilter() const override;
 
   // Return the mask of preserved Analyses.
   IRContext::Analysis GetPreservedAnalyses() override {
@@ -24,13 +24,17 @@ const uint32_t kContinueNodeIndex = 1;
 namespace spvtools {
 namespace opt {
 
-StructuredCFGAnalysis::StructuredCFGAnalysis(IRContext* ctx) : context_(ctx) {
+StructuredCFGAnalysis::StructuredCFGAnalysis(IRContext* ctx)
+    : context_(ctx), found_funcs_called_from_continue_(false) {
   // If this is not a shader, there are no merge instructions, and not
   // structured CFG to analyze.
   if (!context_->get_feature_mgr()->HasCapability(SpvCapabilityShader)) {
     return;
   }
 
+  bb_to_construct_.resize(context_->module()->IdBound());
+  header_to_blocks_.resize(context_->module()->IdBound());
+
   for (auto& func : *context_->module()) {
     AddBlocksInFunction(&func);
   }
@@ -74,7 +78,7 @@ void StructuredCFGAnalysis::AddBlocksInFunction(Function* func) {
       state.back().cinfo.in_continue = true;
     }
 
-    bb_to_construct_.emplace(std::make_pair(block->id(), state.back().cinfo));
+    bb_to_construct_[block->id()] = state.back().cinfo;
 
     if (Instruction* merge_inst = block->GetMergeInst()) {
       TraversalInfo new_state;
@@ -82,7 +86,13 @@ void StructuredCFGAnalysis::AddBlocksInFunction(Function* func) {
           merge_inst->GetSingleWordInOperand(kMergeNodeIndex);
       new_state.cinfo.containing_construct = block->id();
 
+      HeaderInfo& header_info = header_to_blocks_[block->id()];
+      header_info.merge_block = new_state.merge_node;
+      header_info.continue_block = 0;
+
       if (merge_inst->opcode() == SpvOpLoopMerge) {
+        header_info.continue_block =
+            merge_inst->GetSingleWordInOperand(kContinueNodeIndex);
         new_state.cinfo.containing_loop = block->id();
         new_state.cinfo.containing_switch = 0;
         new_state.cinfo.in_continue = false;
@@ -118,9 +128,7 @@ uint32_t StructuredCFGAnalysis::MergeBlock(uint32_t bb_id) {
     return 0;
   }
 
-  BasicBlock* header = context_->cfg()->block(header_id);
-  Instruction* merge_inst = header->GetMergeInst();
-  return merge_inst->GetSingleWordInOperand(kMergeNodeIndex);
+  return header_to_blocks_[header_id].merge_block;
 }
 
 uint32_t StructuredCFGAnalysis::LoopMergeBlock(uint32_t bb_id) {
@@ -129,9 +137,7 @@ uint32_t StructuredCFGAnalysis::LoopMergeBlock(uint32_t bb_id) {
     return 0;
   }
 
-  BasicBlock* header = context_->cfg()->block(header_id);
-  Instruction* merge_inst = header->GetMergeInst();
-  return merge_inst->GetSingleWordInOperand(kMergeNodeIndex);
+  return header_to_blocks_[header_id].merge_block;
 }
 
 uint32_t StructuredCFGAnalysis::LoopContinueBlock(uint32_t bb_id) {
@@ -140,9 +146,7 @@ uint32_t StructuredCFGAnalysis::LoopContinueBlock(uint32_t bb_id) {
     return 0;
   }
 
-  BasicBlock* header = context_->cfg()->block(header_id);
-  Instruction* merge_inst = header->GetMergeInst();
-  return merge_inst->GetSingleWordInOperand(kContinueNodeIndex);
+  return header_to_blocks_[header_id].continue_block;
 }
 
 uint32_t StructuredCFGAnalysis::SwitchMergeBlock(uint32_t bb_id) {
@@ -151,9 +155,7 @@ uint32_t StructuredCFGAnalysis::SwitchMergeBlock(uint32_t bb_id) {
     return 0;
   }
 
-  BasicBlock* header = context_->cfg()->block(header_id);
-  Instruction* merge_inst = header->GetMergeInst();
-  return merge_inst->GetSingleWordInOperand(kMergeNodeIndex);
+  return header_to_blocks_[header_id].merge_block;
 }
 
 bool StructuredCFGAnalysis::IsContinueBlock(uint32_t bb_id) {
@@ -163,11 +165,7 @@ bool StructuredCFGAnalysis::IsContinueBlock(uint32_t bb_id) {
 
 bool StructuredCFGAnalysis::IsInContainingLoopsContinueConstruct(
     uint32_t bb_id) {
-  auto it = bb_to_construct_.find(bb_id);
-  if (it == bb_to_construct_.end()) {
-    return false;
-  }
-  return it->second.in_continue;
+  return GetConstructInfo(bb_id).in_continue;
 }
 
 bool StructuredCFGAnalysis::IsInContinueConstruct(uint32_t bb_id) {
@@ -184,9 +182,15 @@ bool StructuredCFGAnalysis::IsMergeBlock(uint32_t bb_id) {
   return merge_blocks_.Get(bb_id);
 }
 
-std::unordered_set<uint32_t>
+const std::unordered_set<uint32_t>&
 StructuredCFGAnalysis::FindFuncsCalledFromContinue() {
-  std::unordered_set<uint32_t> called_from_continue;
+  if (found_funcs_called_from_continue_) {
+    return funcs_called_from_continue_;
+  }
+  found_funcs_called_from_continue_ = true;
+
+  std::unordered_set<uint32_t>& called_from_continue =
+      funcs_called_from_continue_;
   std::queue<uint32_t> funcs_to_process;
 
   // First collect the functions that are called directly from a continue
@@ -15,8 +15,8 @@
 #ifndef SOURCE_OPT_STRUCT_CFG_ANALYSIS_H_
 #define SOURCE_OPT_STRUCT_CFG_ANALYSIS_H_
 
-#include <unordered_map>
 #include <unordered_set>
+#include <vector>
 
 #include "source/opt/function.h"
 #include "source/util/bit_vector.h"
@@ -27,7 +27,8 @@ namespace opt {
 class IRContext;
 
 // An analysis that, for each basic block, finds the constructs in which it is
-// contained, so we can easily get headers and merge nodes.
+// contained, so we can easily get headers and merge nodes.  The constructs are
+// stored in arrays indexed by id, so that each query takes constant time.
 class StructuredCFGAnalysis {
  public:
   explicit StructuredCFGAnalysis(IRContext* ctx);
@@ -36,11 +37,7 @@ class StructuredCFGAnalysis {
   // that contains |bb_id|.  Returns |0| if |bb_id| is not contained in any
   // merge construct.
   uint32_t ContainingConstruct(uint32_t bb_id) {
-    auto it = bb_to_construct_.find(bb_id);
-    if (it == bb_to_construct_.end()) {
-      return 0;
-    }
-    return it->second.containing_construct;
+    return GetConstructInfo(bb_id).containing_construct;
   }
 
   // Returns the id of the header of the innermost merge construct
@@ -57,11 +54,7 @@ class StructuredCFGAnalysis {
   // that contains |bb_id|.  Return |0| if |bb_id| is not contained in any loop
   // construct.
   uint32_t ContainingLoop(uint32_t bb_id) {
-    auto it = bb_to_construct_.find(bb_id);
-    if (it == bb_to_construct_.end()) {
-      return 0;
-    }
-    return it->second.containing_loop;
+    return GetConstructInfo(bb_id).containing_loop;
   }
 
   // Returns the id of the merge block of the innermost loop construct
@@ -78,11 +71,7 @@ class StructuredCFGAnalysis {
   // that contains |bb_id| as long as there is no intervening loop.  Returns |0|
   // if no such construct exists.
   uint32_t ContainingSwitch(uint32_t bb_id) {
-    auto it = bb_to_construct_.find(bb_id);
-    if (it == bb_to_construct_.end()) {
-      return 0;
-    }
-    return it->second.containing_switch;
+    return GetConstructInfo(bb_id).containing_switch;
   }
   // Returns the id of the merge block of the innermost switch construct
   // that contains |bb_id| as long as there is no intervening loop.  Return |0|
@@ -104,8 +93,9 @@ class StructuredCFGAnalysis {
   bool IsMergeBlock(uint32_t bb_id);
 
   // Returns the set of function ids that are called directly or indirectly from
-  // a continue construct.
-  std::unordered_set<uint32_t> FindFuncsCalledFromContinue();
+  // a continue construct.  The set is computed on the first call, and kept
+  // until the analysis is invalidated.
+  const std::unordered_set<uint32_t>& FindFuncsCalledFromContinue();
 
  private:
   // Struct used to hold the information for a basic block.
@@ -131,16 +121,42 @@ class StructuredCFGAnalysis {
     bool in_continue;
   };
 
+  // Struct used to hold the blocks named by the merge instruction of a header.
+  // |continue_block| is 0 for a selection construct.
+  struct HeaderInfo {
+    uint32_t merge_block;
+    uint32_t continue_block;
+  };
+
+  // Returns the information for the basic block |bb_id|.  The blocks that are
+  // not in any construct, or were added after the analysis, have all the
+  // headers 0.
+  const ConstructInfo& GetConstructInfo(uint32_t bb_id) const {
+    static const ConstructInfo kNotInConstruct = {0, 0, 0, false};
+    return bb_id < bb_to_construct_.size() ? bb_to_construct_[bb_id]
+                                           : kNotInConstruct;
+  }
+
   // Populates |bb_to_construct_| with the innermost containing merge and loop
   // constructs for each basic block in |func|.
   void AddBlocksInFunction(Function* func);
 
   IRContext* context_;
 
-  // A map from a basic block to the headers of its inner most containing
-  // constructs.
-  std::unordered_map<uint32_t, ConstructInfo> bb_to_construct_;
+  // The headers of the inner most containing constructs of each basic block,
+  // indexed by the id of the block.
+  std::vector<ConstructInfo> bb_to_construct_;
+
+  // The merge and continue blocks of each header, indexed by the id of the
+  // header.
+  std::vector<HeaderInfo> header_to_blocks_;
+
   utils::BitVector merge_blocks_;
+
+  // The functions called from a continue construct, and whether they were
+  // found yet.
+  std::unordered_set<uint32_t> funcs_called_from_continue_;
+  bool found_funcs_called_from_continue_;
 };
 
 }  // namespace opt
@@ -138,6 +138,7 @@ std::unique_ptr<Type> Type::Clone() const {
 std::unique_ptr<Type> Type::RemoveDecorations() const {
   std::unique_ptr<Type> type(Clone());
   type->ClearDecorations();
+  type->ResetHashValue();
   return type;
 }
 
@@ -182,10 +183,25 @@ bool Type::operator==(const Type& other) const {
 
 void Type::GetHashWords(std::vector<uint32_t>* words,
                         std::unordered_set<const Type*>* seen) const {
+  if (!ContainsPointer()) {
+    // The type cannot be recursive, so its words do not depend on |seen|, and
+    // its kept hash value can stand for them.
+    const uint64_t hash = HashValue();
+    words->push_back(static_cast<uint32_t>(hash));
+    words->push_back(static_cast<uint32_t>(hash >> 32));
+    return;
+  }
+
   if (!seen->insert(this).second) {
     return;
   }
 
+  GetHashWordsImpl(words, seen);
+  seen->erase(this);
+}
+
+void Type::GetHashWordsImpl(std::vector<uint32_t>* words,
+                            std::unordered_set<const Type*>* seen) const {
   words->push_back(kind_);
   for (const auto& d : decorations_) {
     for (auto w : d) {
@@ -228,19 +244,79 @@ void Type::GetHashWords(std::vector<uint32_t>* words,
       assert(false && "Unhandled type");
       break;
   }
-
-  seen->erase(this);
 }
 
 size_t Type::HashValue() const {
+  if (hash_value_ != 0) {
+    return hash_value_;
+  }
+
   std::u32string h;
   std::vector<uint32_t> words;
-  GetHashWords(&words);
+  std::unordered_set<const Type*> seen;
+  seen.insert(this);
+  GetHashWordsImpl(&words, &seen);
   for (auto w : words) {
     h.push_back(w);
   }
 
-  return std::hash<std::u32string>()(h);
+  const size_t hash = std::hash<std::u32string>()(h);
+  if (!ContainsPointer()) {
+    hash_value_ = hash;
+  }
+  return hash;
+}
+
+bool Type::ContainsPointer() const {
+  if (pointer_use_ != PointerUse::kUnknown) {
+    return pointer_use_ == PointerUse::kSome;
+  }
+
+  // A recursive type goes through a pointer, so this does not loop.
+  bool contains_pointer = false;
+  switch (kind_) {
+    case kPointer:
+    case kForwardPointer:
+      contains_pointer = true;
+      break;
+    case kVector:
+      contains_pointer = AsVector()->element_type()->ContainsPointer();
+      break;
+    case kMatrix:
+      contains_pointer = AsMatrix()->element_type()->ContainsPointer();
+      break;
+    case kImage:
+      contains_pointer = AsImage()->sampled_type()->ContainsPointer();
+      break;
+    case kSampledImage:
+      contains_pointer = AsSampledImage()->image_type()->ContainsPointer();
+      break;
+    case kArray:
+      contains_pointer = AsArray()->element_type()->ContainsPointer();
+      break;
+    case kRuntimeArray:
+      contains_pointer = AsRuntimeArray()->element_type()->ContainsPointer();
+      break;
+    case kStruct:
+      for (const Type* element_type : AsStruct()->element_types()) {
+        contains_pointer = contains_pointer || element_type->ContainsPointer();
+      }
+      break;
+    case kFunction:
+      contains_pointer = AsFunction()->return_type()->ContainsPointer();
+      for (const Type* param_type : AsFunction()->param_types()) {
+        contains_pointer = contains_pointer || param_type->ContainsPointer();
+      }
+      break;
+    case kCooperativeMatrixNV:
+      contains_pointer =
+          AsCooperativeMatrixNV()->component_type()->ContainsPointer();
+      break;
+    default:
+      break;
+  }
+  pointer_use_ = contains_pointer ? PointerUse::kSome : PointerUse::kNone;
+  return contains_pointer;
 }
 
 bool Integer::IsSameImpl(const Type* that, IsSameCache*) const {
@@ -427,7 +503,10 @@ void Array::GetExtraHashWords(std::vector<uint32_t>* words,
                 length_info_.words.end());
 }
 
-void Array::ReplaceElementType(const Type* type) { element_type_ = type; }
+void Array::ReplaceElementType(const Type* type) {
+  element_type_ = type;
+  ResetHashValue();
+}
 
 RuntimeArray::RuntimeArray(const Type* type)
     : Type(kRuntimeArray), element_type_(type) {
@@ -454,6 +533,7 @@ void RuntimeArray::GetExtraHashWords(
 
 void RuntimeArray::ReplaceElementType(const Type* type) {
   element_type_ = type;
+  ResetHashValue();
 }
 
 Struct::Struct(const std::vector<const Type*>& types)
@@ -472,6 +552,7 @@ void Struct::AddMemberDecoration(uint32_t index,
   }
 
   element_decorations_[index].push_back(std::move(decoration));
+  ResetHashValue();
 }
 
 bool Struct::IsSameImpl(const Type* that, IsSameCache* seen) const {
@@ -572,7 +653,10 @@ void Pointer::GetExtraHashWords(std::vector<uint32_t>* words,
   words->push_back(storage_class_);
 }
 
-void Pointer::SetPointeeType(const Type* type) { pointee_type_ = type; }
+void Pointer::SetPointeeType(const Type* type) {
+  pointee_type_ = type;
+  ResetHashValue();
+}
 
 Function::Function(const Type* ret_type, const std::vector<const Type*>& params)
     : Type(kFunction), return_type_(ret_type), param_types_(params) {}
@@ -611,7 +695,10 @@ void Function::GetExtraHashWords(std::vector<uint32_t>* words,
   }
 }
 
-void Function::SetReturnType(const Type* type) { return_type_ = type; }
+void Function::SetReturnType(const Type* type) {
+  return_type_ = type;
+  ResetHashValue();
+}
 
 bool Pipe::IsSameImpl(const Type* that, IsSameCache*) const {
   const Pipe* pt = that->AsPipe();
@@ -97,13 +97,14 @@ class Type {
     kCooperativeMatrixNV
   };
 
-  Type(Kind k) : kind_(k) {}
+  Type(Kind k) : kind_(k), hash_value_(0), pointer_use_(PointerUse::kUnknown) {}
 
   virtual ~Type() {}
 
   // Attaches a decoration directly on this type.
   void AddDecoration(std::vector<uint32_t>&& d) {
     decorations_.push_back(std::move(d));
+    ResetHashValue();
   }
   // Returns the decorations on this type as a string.
   std::string GetDecorationStr() const;
@@ -112,6 +113,7 @@ class Type {
   // Returns true if this type is exactly the same as |that| type, including
   // decorations.
   bool IsSame(const Type* that) const {
+    if (this == that) return true;
     IsSameCache seen;
     return IsSameImpl(that, &seen);
   }
@@ -150,8 +152,18 @@ class Type {
   bool operator==(const Type& other) const;
 
   // Returns the hash value of this type.
+  //
+  // The hash value of a type that does not contain a pointer is computed once
+  // and kept in the type, and the types containing it hash that value instead
+  // of its whole structure.  So looking up a type built from types of a pool
+  // costs a hash of its own words.  A type must not be changed after it is
+  // hashed, except through its setters.
   size_t HashValue() const;
 
+  // Returns true if this type is or contains a pointer or a forward pointer.
+  // Only such types can be recursive.
+  bool ContainsPointer() const;
+
   // Adds the necessary words to compute a hash value of this type to |words|.
   void GetHashWords(std::vector<uint32_t>* words) const {
     std::unordered_set<const Type*> seen;
@@ -207,12 +219,29 @@ class Type {
   // and the rest are the parameters to the decoration (if exists).
   std::vector<std::vector<uint32_t>> decorations_;
 
+  // Forgets the kept hash value of this type, after it was changed.
+  void ResetHashValue() {
+    hash_value_ = 0;
+    pointer_use_ = PointerUse::kUnknown;
+  }
+
  private:
+  enum class PointerUse : uint8_t { kUnknown, kNone, kSome };
+
   // Removes decorations on this type. For struct types, also removes element
   // decorations.
   virtual void ClearDecorations() { decorations_.clear(); }
 
+  // Adds the words of this type to |words|.  |this| must be in |seen|.
+  void GetHashWordsImpl(std::vector<uint32_t>* words,
+                        std::unordered_set<const Type*>* seen) const;
+
   Kind kind_;
+  // The hash value of this type, if it was computed and it does not contain a
+  // pointer, or 0.
+  mutable size_t hash_value_;
+  // Whether this type contains a pointer, if it is known.
+  mutable PointerUse pointer_use_;
 };
 // clang-format on
 
@@ -580,7 +609,10 @@ class ForwardPointer : public Type {
   ForwardPointer(const ForwardPointer&) = default;
 
   uint32_t target_id() const { return target_id_; }
-  void SetTargetPointer(const Pointer* pointer) { pointer_ = pointer; }
+  void SetTargetPointer(const Pointer* pointer) {
+    pointer_ = pointer;
+    ResetHashValue();
+  }
   SpvStorageClass storage_class() const { return storage_class_; }
   const Pointer* target_pointer() const { return pointer_; }
 
@@ -0,0 +1,348 @@
+// Copyright (c) 2019 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "source/opt/uniformity_analysis.h"
+
+#include "source/opcode.h"
+#include "source/opt/ir_context.h"
+
+namespace spvtools {
+namespace opt {
+namespace {
+
+const uint32_t kLoadPointerInIdx = 0;
+const uint32_t kStorePointerInIdx = 0;
+const uint32_t kPointerStorageClassInIdx = 0;
+const uint32_t kVariableStorageClassInIdx = 0;
+const uint32_t kDecorationBuiltInInIdx = 2;
+const uint32_t kGroupOperationInIdx = 1;
+
+// Returns true if |opcode| is a group operation taking a GroupOperation
+// operand, which only gives the same result to all the invocations for a
+// reduction.
+bool HasGroupOperation(SpvOp opcode) {
+  switch (opcode) {
+    case SpvOpGroupNonUniformBallotBitCount:
+    case SpvOpGroupNonUniformIAdd:
+    case SpvOpGroupNonUniformFAdd:
+    case SpvOpGroupNonUniformIMul:
+    case SpvOpGroupNonUniformFMul:
+    case SpvOpGroupNonUniformSMin:
+    case SpvOpGroupNonUniformUMin:
+    case SpvOpGroupNonUniformFMin:
+    case SpvOpGroupNonUniformSMax:
+    case SpvOpGroupNonUniformUMax:
+    case SpvOpGroupNonUniformFMax:
+    case SpvOpGroupNonUniformBitwiseAnd:
+    case SpvOpGroupNonUniformBitwiseOr:
+    case SpvOpGroupNonUniformBitwiseXor:
+    case SpvOpGroupNonUniformLogicalAnd:
+    case SpvOpGroupNonUniformLogicalOr:
+    case SpvOpGroupNonUniformLogicalXor:
+      return true;
+    default:
+      return false;
+  }
+}
+
+}  // namespace
+
+UniformityAnalysis::UniformityAnalysis(IRContext* context)
+    : context_(context) {
+  FindTrackedVariables();
+  for (auto& func : *context_->module()) {
+    func.ForEachInst([this](Instruction* inst) {
+      if (inst->result_id() != 0 && IsDivergentSource(inst)) {
+        MarkDivergent(inst);
+      }
+    });
+  }
+
+  while (!work_list_.empty()) {
+    Instruction* inst = work_list_.back();
+    work_list_.pop_back();
+    context_->get_def_use_mgr()->ForEachUser(
+        inst, [this](Instruction* user) { PropagateToUser(user); });
+  }
+}
+
+void UniformityAnalysis::FindTrackedVariables() {
+  analysis::DefUseManager* def_use_mgr = context_->get_def_use_mgr();
+  auto track = [this, def_use_mgr](Instruction* var) {
+    std::vector<Instruction*>& loads = variable_loads_[var->result_id()];
+    bool escapes = false;
+    std::vector<Instruction*> pointers = {var};
+    while (!pointers.empty()) {
+      Instruction* pointer = pointers.back();
+      pointers.pop_back();
+      def_use_mgr->ForEachUser(
+          pointer, [pointer, &loads, &escapes, &pointers](Instruction* user) {
+            switch (user->opcode()) {
+              case SpvOpAccessChain:
+              case SpvOpInBoundsAccessChain:
+              case SpvOpCopyObject:
+                pointers.push_back(user);
+                break;
+              case SpvOpLoad:
+                loads.push_back(user);
+                break;
+              case SpvOpEntryPoint:
+                break;
+              case SpvOpStore:
+                // Storing the pointer itself lets it be used anywhere.
+                if (user->GetSingleWordInOperand(kStorePointerInIdx) !=
+                    pointer->result_id()) {
+                  escapes = true;
+                }
+                break;
+              default:
+                if (!spvOpcodeIsDecoration(user->opcode()) &&
+                    !spvOpcodeIsDebug(user->opcode())) {
+                  escapes = true;
+                }
+                break;
+            }
+          });
+    }
+    if (escapes) divergent_variables_.insert(var->result_id());
+  };
+
+  for (auto& inst : context_->module()->types_values()) {
+    if (inst.opcode() == SpvOpVariable &&
+        inst.GetSingleWordInOperand(kVariableStorageClassInIdx) ==
+            SpvStorageClassPrivate) {
+      track(&inst);
+    }
+  }
+  for (auto& func : *context_->module()) {
+    if (func.begin() == func.end()) continue;
+    for (auto& inst : *func.begin()) {
+      if (inst.opcode() != SpvOpVariable) break;
+      track(&inst);
+    }
+  }
+}
+
+bool UniformityAnalysis::IsDivergentSource(Instruction* inst) const {
+  switch (inst->opcode()) {
+    case SpvOpFunctionParameter:
+    case SpvOpFunctionCall:
+    case SpvOpGroupNonUniformElect:
+    case SpvOpGroupNonUniformInverseBallot:
+      return true;
+    case SpvOpImageRead:
+    case SpvOpImageSparseRead:
+      // Other invocations may write the image.
+      return true;
+    case SpvOpLoad:
+      return IsDivergentLoad(inst);
+    default:
+      break;
+  }
+  if (HasGroupOperation(inst->opcode())) {
+    return inst->GetSingleWordInOperand(kGroupOperationInIdx) !=
+           SpvGroupOperationReduce;
+  }
+  return spvOpcodeIsAtomicOp(inst->opcode());
+}
+
+bool UniformityAnalysis::IsUniformResult(Instruction* inst) const {
+  switch (inst->opcode()) {
+    case SpvOpGroupNonUniformAll:
+    case SpvOpGroupNonUniformAny:
+    case SpvOpGroupNonUniformAllEqual:
+    case SpvOpGroupNonUniformBroadcast:
+    case SpvOpGroupNonUniformBroadcastFirst:
+    case SpvOpGroupNonUniformBallot:
+    case SpvOpSubgroupBallotKHR:
+    case SpvOpSubgroupFirstInvocationKHR:
+    case SpvOpSubgroupAllKHR:
+    case SpvOpSubgroupAnyKHR:
+    case SpvOpSubgroupAllEqualKHR:
+    case SpvOpSubgroupReadInvocationKHR:
+      return true;
+    default:
+      break;
+  }
+  return HasGroupOperation(inst->opcode()) &&
+         inst->GetSingleWordInOperand(kGroupOperationInIdx) ==
+             SpvGroupOperationReduce;
+}
+
+bool UniformityAnalysis::IsDivergentLoad(Instruction* load) const {
+  analysis::DefUseManager* def_use_mgr = context_->get_def_use_mgr();
+  Instruction* pointer =
+      def_use_mgr->GetDef(load->GetSingleWordInOperand(kLoadPointerInIdx));
+  const uint32_t storage_class =
+      def_use_mgr->GetDef(pointer->type_id())
+          ->GetSingleWordInOperand(kPointerStorageClassInIdx);
+  Instruction* base = load->GetBaseAddress();
+  const bool is_variable = base->opcode() == SpvOpVariable;
+
+  switch (storage_class) {
+    case SpvStorageClassUniformConstant:
+    case SpvStorageClassPushConstant:
+      // Descriptors and push constants are the same for all the invocations.
+      return false;
+    case SpvStorageClassInput:
+      return !is_variable || !IsUniformBuiltIn(base);
+    case SpvStorageClassFunction:
+    case SpvStorageClassPrivate:
+      return !is_variable || variable_loads_.count(base->result_id()) == 0 ||
+             divergent_variables_.count(base->result_id()) != 0;
+    default:
+      // Other invocations may write the memory, unless it is read-only.
+      return !is_variable || !base->IsReadOnlyVariable();
+  }
+}
+
+bool UniformityAnalysis::IsUniformBuiltIn(Instruction* var) const {
+  bool uniform = false;
+  context_->get_decoration_mgr()->ForEachDecoration(
+      var->result_id(), SpvDecorationBuiltIn,
+      [&uniform](const Instruction& decoration) {
+        switch (decoration.GetSingleWordInOperand(kDecorationBuiltInInIdx)) {
+          case SpvBuiltInNumWorkgroups:
+          case SpvBuiltInWorkgroupSize:
+          case SpvBuiltInWorkgroupId:
+          case SpvBuiltInSubgroupSize:
+          case SpvBuiltInNumSubgroups:
+          case SpvBuiltInSubgroupId:
+          case SpvBuiltInBaseVertex:
+          case SpvBuiltInBaseInstance:
+          case SpvBuiltInDrawIndex:
+          case SpvBuiltInDeviceIndex:
+            uniform = true;
+            break;
+          default:
+            break;
+        }
+      });
+  return uniform;
+}
+
+void UniformityAnalysis::MarkDivergent(Instruction* inst) {
+  if (divergent_values_.insert(inst->result_id()).second) {
+    work_list_.push_back(inst);
+  }
+}
+
+void UniformityAnalysis::MarkDivergentVariable(uint32_t var_id) {
+  auto loads = variable_loads_.find(var_id);
+  if (loads == variable_loads_.end() ||
+      !divergent_variables_.insert(var_id).second) {
+    return;
+  }
+  for (Instruction* load : loads->second) MarkDivergent(load);
+}
+
+void UniformityAnalysis::PropagateToUser(Instruction* user) {
+  switch (user->opcode()) {
+    case SpvOpBranchConditional:
+    case SpvOpSwitch:
+      MarkDivergentBranch(context_->get_instr_block(user));
+      return;
+    case SpvOpStore: {
+      Instruction* base = user->GetBaseAddress();
+      if (base->opcode() == SpvOpVariable) {
+        MarkDivergentVariable(base->result_id());
+      }
+      return;
+    }
+    default:
+      break;
+  }
+  if (user->result_id() == 0 || IsUniformResult(user)) return;
+  MarkDivergent(user);
+}
+
+void UniformityAnalysis::MarkDivergentBranch(BasicBlock* block) {
+  if (!divergent_branches_.insert(block->id()).second) return;
+  Function* func = block->GetParent();
+  BasicBlock* join =
+      context_->GetPostDominatorAnalysis(func)->ImmediateDominator(block);
+  if (join != nullptr && context_->cfg()->IsPseudoExitBlock(join)) {
+    join = nullptr;
+  }
+
+  // The invocations go around the loops containing |block| together, so the
+  // values of their headers only depend on the values of their back edges.
+  // Some of them may leave the loops which do not contain |join|.
+  std::unordered_set<uint32_t> headers;
+  std::vector<Loop*> exited_loops;
+  for (Loop* loop = (*context_->GetLoopDescriptor(func))[block];
+       loop != nullptr; loop = loop->GetParent()) {
+    headers.insert(loop->GetHeaderBlock()->id());
+    if (join == nullptr || !loop->IsInsideLoop(join)) {
+      exited_loops.push_back(loop);
+    }
+  }
+
+  std::vector<BasicBlock*> stack;
+  std::unordered_set<uint32_t> visited;
+  auto push_successors = [this, &stack](BasicBlock* bb) {
+    bb->ForEachSuccessorLabel([this, &stack](const uint32_t id) {
+      stack.push_back(context_->cfg()->block(id));
+    });
+  };
+  push_successors(block);
+  while (!stack.empty()) {
+    BasicBlock* bb = stack.back();
+    stack.pop_back();
+    if (bb == join || !visited.insert(bb->id()).second) continue;
+    MarkDivergentBlock(bb);
+    if (headers.count(bb->id()) == 0) {
+      bb->ForEachPhiInst([this](Instruction* phi) { MarkDivergent(phi); });
+    }
+    push_successors(bb);
+  }
+  if (join != nullptr) {
+    join->ForEachPhiInst([this](Instruction* phi) { MarkDivergent(phi); });
+  }
+
+  analysis::DefUseManager* def_use_mgr = context_->get_def_use_mgr();
+  for (Loop* loop : exited_loops) {
+    std::vector<Instruction*> outside_users;
+    for (uint32_t bb_id : loop->GetBlocks()) {
+      context_->cfg()->block(bb_id)->ForEachInst(
+          [this, def_use_mgr, loop, &outside_users](Instruction* inst) {
+            if (inst->result_id() == 0) return;
+            def_use_mgr->ForEachUser(
+                inst, [this, loop, &outside_users](Instruction* user) {
+                  BasicBlock* user_block = context_->get_instr_block(user);
+                  if (user_block != nullptr &&
+                      !loop->IsInsideLoop(user_block)) {
+                    outside_users.push_back(user);
+                  }
+                });
+          });
+    }
+    for (Instruction* user : outside_users) PropagateToUser(user);
+  }
+}
+
+void UniformityAnalysis::MarkDivergentBlock(BasicBlock* block) {
+  if (!divergent_blocks_.insert(block->id()).second) return;
+  // The variables stored by some of the invocations only are divergent.
+  block->ForEachInst([this](Instruction* inst) {
+    if (inst->opcode() != SpvOpStore) return;
+    Instruction* base = inst->GetBaseAddress();
+    if (base->opcode() == SpvOpVariable) {
+      MarkDivergentVariable(base->result_id());
+    }
+  });
+}
+
+}  // namespace opt
+}  // namespace spvtools
@@ -0,0 +1,125 @@
+// Copyright (c) 2019 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef SOURCE_OPT_UNIFORMITY_ANALYSIS_H_
+#define SOURCE_OPT_UNIFORMITY_ANALYSIS_H_
+
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+#include "source/opt/basic_block.h"
+#include "source/opt/instruction.h"
+
+namespace spvtools {
+namespace opt {
+
+class IRContext;
+
+// An analysis that finds the values which are dynamically uniform: the values
+// which are the same for all the invocations of a subgroup executing the
+// instruction together.  Each function is analyzed for the invocations which
+// enter it together, so the parameters and the results of function calls are
+// assumed to be divergent.
+//
+// The values of the built-ins which are the same for a whole subgroup, such
+// as WorkgroupId, and the values loaded from push constants, descriptors and
+// read-only buffers through uniform pointers are uniform.  The results of the
+// group operations which broadcast or reduce a value are uniform.  The
+// contents of function and private variables are uniform if they are only
+// stored uniform values from uniform control flow.
+//
+// Other values are uniform if their operands are, except where the control
+// flow is divergent:
+//
+//  - The blocks reached from a branch on a divergent condition, before its
+//    immediate post-dominator, are only executed by some of the invocations,
+//    and the OpPhi instructions joining their paths are divergent.
+//  - If some of the invocations leave a loop by such a branch, the values
+//    defined in the loop are divergent where they are used after it, since
+//    the invocations may have left it in different iterations.
+class UniformityAnalysis {
+ public:
+  explicit UniformityAnalysis(IRContext* context);
+
+  UniformityAnalysis(const UniformityAnalysis&) = delete;
+  UniformityAnalysis& operator=(const UniformityAnalysis&) = delete;
+
+  // Returns true if the value |id| is dynamically uniform.  The ids which are
+  // not defined in a function, such as constants, are uniform.
+  bool IsUniform(uint32_t id) const { return divergent_values_.count(id) == 0; }
+
+  // Returns true if the block |block_id| is executed by all the invocations
+  // which enter its function together.
+  bool IsUniformBlock(uint32_t block_id) const {
+    return divergent_blocks_.count(block_id) == 0;
+  }
+
+ private:
+  // Records the variables whose contents are tracked, and the loads and
+  // stores through pointers into them.  The variables whose address escapes
+  // are divergent.
+  void FindTrackedVariables();
+
+  // Returns true if the result of |inst| is divergent, whatever its operands.
+  bool IsDivergentSource(Instruction* inst) const;
+
+  // Returns true if the result of |inst| is uniform, whatever its operands.
+  bool IsUniformResult(Instruction* inst) const;
+
+  // Returns true if the value loaded by |load|, through a uniform pointer, is
+  // divergent.
+  bool IsDivergentLoad(Instruction* load) const;
+
+  // Returns true if the variable |var| is a built-in with the same value for
+  // all the invocations of a subgroup.
+  bool IsUniformBuiltIn(Instruction* var) const;
+
+  // Records that the result of |inst| is divergent.
+  void MarkDivergent(Instruction* inst);
+
+  // Records that the contents of the variable |var_id| are divergent.
+  void MarkDivergentVariable(uint32_t var_id);
+
+  // Updates the analysis for a divergent operand of |user|.
+  void PropagateToUser(Instruction* user);
+
+  // Records that the terminator of |block| branches on a divergent
+  // condition.
+  void MarkDivergentBranch(BasicBlock* block);
+
+  // Records that |block| is only executed by some of the invocations.
+  void MarkDivergentBlock(BasicBlock* block);
+
+  IRContext* context_;
+
+  // The values found to be divergent.
+  std::unordered_set<uint32_t> divergent_values_;
+  // The blocks found to be executed by some of the invocations only.
+  std::unordered_set<uint32_t> divergent_blocks_;
+  // The blocks whose branch was found to be divergent.
+  std::unordered_set<uint32_t> divergent_branches_;
+  // The function and private variables whose contents are tracked, with the
+  // loads from them, and those found to be divergent.
+  std::unordered_map<uint32_t, std::vector<Instruction*>> variable_loads_;
+  std::unordered_set<uint32_t> divergent_variables_;
+  // The instructions whose result was found to be divergent, and whose users
+  // must be updated.
+  std::vector<Instruction*> work_list_;
+};
+
+}  // namespace opt
+}  // namespace spvtools
+
+#endif  // SOURCE_OPT_UNIFORMITY_ANALYSIS_H_
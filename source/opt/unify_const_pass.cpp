@@ -14,81 +14,55 @@
 
 #include "source/opt/unify_const_pass.h"
 
-#include <memory>
+#include <functional>
 #include <unordered_map>
 #include <utility>
 #include <vector>
 
 #include "source/opt/def_use_manager.h"
 #include "source/opt/ir_context.h"
-#include "source/util/make_unique.h"
+#include "source/util/hash_combine.h"
 
 namespace spvtools {
 namespace opt {
 
 namespace {
 
-// The trie that stores a bunch of result ids and, for a given instruction,
+// The table that stores a bunch of result ids and, for a given instruction,
 // searches the result id that has been defined with the same opcode, type and
 // operands.
-class ResultIdTrie {
+class ResultIdTable {
  public:
-  ResultIdTrie() : root_(new Node) {}
-
   // For a given instruction, extracts its opcode, type id and operand words
-  // as an array of keys, looks up the trie to find a result id which is stored
-  // with the same opcode, type id and operand words. If none of such result id
-  // is found, creates a trie node with those keys, stores the instruction's
-  // result id and returns that result id. If an existing result id is found,
-  // returns the existing result id.
+  // as an array of keys, looks up the table to find a result id which is
+  // stored with the same opcode, type id and operand words. If none of such
+  // result id is found, stores the instruction's result id with those keys
+  // and returns that result id. If an existing result id is found, returns
+  // the existing result id.
   uint32_t LookupEquivalentResultFor(const Instruction& inst) {
-    auto keys = GetLookUpKeys(inst);
-    auto* node = root_.get();
-    for (uint32_t key : keys) {
-      node = node->GetOrCreateTrieNodeFor(key);
-    }
-    if (node->result_id() == 0) {
-      node->SetResultId(inst.result_id());
-    }
-    return node->result_id();
+    // A large constant composite is a single entry hashed once, rather than
+    // a chain of trie nodes, one per component.
+    return result_ids_.insert({GetLookUpKeys(inst), inst.result_id()})
+        .first->second;
   }
 
  private:
-  // The trie node to store result ids.
-  class Node {
-   public:
-    using TrieNodeMap = std::unordered_map<uint32_t, std::unique_ptr<Node>>;
-
-    Node() : result_id_(0), next_() {}
-    uint32_t result_id() const { return result_id_; }
-
-    // Sets the result id stored in this node.
-    void SetResultId(uint32_t id) { result_id_ = id; }
-
-    // Searches for the child trie node with the given key. If the node is
-    // found, returns that node. Otherwise creates an empty child node with
-    // that key and returns that newly created node.
-    Node* GetOrCreateTrieNodeFor(uint32_t key) {
-      auto iter = next_.find(key);
-      if (iter == next_.end()) {
-        // insert a new node and return the node.
-        return next_.insert(std::make_pair(key, MakeUnique<Node>()))
-            .first->second.get();
+  // Hash function for the arrays of keys.
+  struct KeysHash {
+    size_t operator()(const std::vector<uint32_t>& keys) const {
+      size_t hash = keys.size();
+      for (uint32_t key : keys) {
+        utils::HashCombine(std::hash<uint32_t>()(key), &hash);
       }
-      return iter->second.get();
+      return hash;
     }
-
-   private:
-    // The result id stored in this node. 0 means this node is empty.
-    uint32_t result_id_;
-    // The mapping from the keys to the child nodes of this node.
-    TrieNodeMap next_;
   };
 
   // Returns a vector of the opcode followed by the words in the raw SPIR-V
   // instruction encoding but without the result id.
   std::vector<uint32_t> GetLookUpKeys(const Instruction& inst) {
     std::vector<uint32_t> keys;
+    keys.reserve(inst.NumOperandWords() + 1);
     // Need to use the opcode, otherwise there might be a conflict with the
     // following case when <op>'s binary value equals xx's id:
     //  OpSpecConstantOp tt <op> yy zz
@@ -101,13 +75,18 @@ class ResultIdTrie {
     return keys;
   }
 
-  std::unique_ptr<Node> root_;  // The root node of the trie.
+  // The result ids of the constants found so far, keyed by their opcode, type
+  // id and operand words.
+  std::unordered_map<std::vector<uint32_t>, uint32_t, KeysHash> result_ids_;
 };
 }  // anonymous namespace
 
 Pass::Status UnifyConstantPass::Process() {
   bool modified = false;
-  ResultIdTrie defined_constants;
+  ResultIdTable defined_constants;
+  // The duplicated constants, and the constants replacing them.
+  std::unordered_map<uint32_t, uint32_t> replacements;
+  std::vector<Instruction*> to_kill;
 
   for (Instruction *next_instruction,
        *inst = &*(context()->types_values_begin());
@@ -121,15 +100,15 @@ Pass::Status UnifyConstantPass::Process() {
     }
 
     // The overall algorithm is to store the result ids of all the eligible
-    // constants encountered so far in a trie. For a constant defining
+    // constants encountered so far in a table. For a constant defining
     // instruction under consideration, use its opcode, result type id and
-    // words in operands as an array of keys to lookup the trie. If a result id
+    // words in operands as an array of keys to lookup the table. If a result id
     // can be found for that array of keys, a constant with exactly the same
     // value must has been defined before, the constant under processing
     // should be replaced by the constant previously defined. If no such result
     // id can be found for that array of keys, this must be the first time a
-    // constant with its value be defined, we then create a new trie node to
-    // store the result id with the keys. When replacing a duplicated constant
+    // constant with its value be defined, we then store the result id with
+    // the keys. When replacing a duplicated constant
     // with a previously defined constant, all the uses of the duplicated
     // constant, which must be placed after the duplicated constant defining
     // instruction, will be updated. This way, the descendants of the
@@ -137,7 +116,9 @@ Pass::Status UnifyConstantPass::Process() {
     // to the previously defined constant. So that the operand ids which are
     // used in key arrays will be the ids of the unified constants, when
     // processing is up to a descendant. This makes comparing the key array
-    // always valid for judging duplication.
+    // always valid for judging duplication. The uses are replaced in one sweep
+    // at the end, so the operands of the instruction under processing are
+    // brought up to date first.
     switch (inst->opcode()) {
       case SpvOp::SpvOpConstantTrue:
       case SpvOp::SpvOpConstantFalse:
@@ -156,12 +137,13 @@ Pass::Status UnifyConstantPass::Process() {
       // same so are unifiable.
       case SpvOp::SpvOpSpecConstantOp:
       case SpvOp::SpvOpSpecConstantComposite: {
+        context()->ReplaceUsesIn(inst, replacements);
         uint32_t id = defined_constants.LookupEquivalentResultFor(*inst);
         if (id != inst->result_id()) {
           // The constant is a duplicated one, use the cached constant to
           // replace the uses of this duplicated one, then turn it to nop.
-          context()->ReplaceAllUsesWith(inst->result_id(), id);
-          context()->KillInst(inst);
+          replacements[inst->result_id()] = id;
+          to_kill.push_back(inst);
           modified = true;
         }
         break;
@@ -170,6 +152,8 @@ Pass::Status UnifyConstantPass::Process() {
         break;
     }
   }
+  context()->ReplaceAllUsesWith(replacements);
+  context()->KillInsts(to_kill);
   return modified ? Status::SuccessWithChange : Status::SuccessWithoutChange;
 }
 
@@ -111,42 +111,58 @@ uint32_t ValueNumberTable::AssignValueNumber(Instruction* inst) {
     }
   }
 
-  // Replace all of the operands by their value number.  The sign bit will be
-  // set to distinguish between an id and a value number.
-  Instruction value_ins(context(), inst->opcode(), inst->type_id(),
-                        inst->result_id(), {});
-  for (uint32_t o = 0; o < inst->NumInOperands(); ++o) {
-    const Operand& op = inst->GetInOperand(o);
-    if (spvIsIdType(op.type)) {
-      uint32_t id_value = op.words[0];
-      auto use_id_to_val = id_to_value_.find(id_value);
-      if (use_id_to_val != id_to_value_.end()) {
-        id_value = (1 << 31) | use_id_to_val->second;
-      }
-      value_ins.AddOperand(Operand(op.type, {id_value}));
-    } else {
-      value_ins.AddOperand(Operand(op.type, op.words));
-    }
-  }
-
   // TODO: Implement a normal form for opcodes that commute like integer
   // addition.  This will let us know that a+b is the same value as b+a.
 
   // Otherwise, we check if this value has been computed before.
-  auto value_iterator = instruction_to_value_.find(value_ins);
-  if (value_iterator != instruction_to_value_.end()) {
-    value = id_to_value_[value_iterator->first.result_id()];
-    id_to_value_[inst->result_id()] = value;
-    return value;
+  std::vector<uint32_t>& ids = key_to_ids_[GetValueKey(*inst)];
+  for (auto id = ids.begin(); id != ids.end();) {
+    auto id_to_val = id_to_value_.find(*id);
+    if (id_to_val == id_to_value_.end()) {
+      // The instruction was killed.
+      id = ids.erase(id);
+      continue;
+    }
+    if (dec_mgr->HaveTheSameDecorations(inst->result_id(), *id)) {
+      // Also record |inst|, so the value can still be found after the
+      // instruction that computed it first is killed.
+      value = id_to_val->second;
+      id_to_value_[inst->result_id()] = value;
+      ids.push_back(inst->result_id());
+      return value;
+    }
+    ++id;
   }
 
   // If not, assign it a new value number.
   value = TakeNextValueNumber();
   id_to_value_[inst->result_id()] = value;
-  instruction_to_value_[value_ins] = value;
+  ids.push_back(inst->result_id());
   return value;
 }
 
+std::u32string ValueNumberTable::GetValueKey(const Instruction& inst) const {
+  std::u32string key;
+  key.push_back(inst.opcode());
+  key.push_back(inst.type_id());
+  for (uint32_t o = 0; o < inst.NumInOperands(); ++o) {
+    const Operand& op = inst.GetInOperand(o);
+    key.push_back((static_cast<uint32_t>(op.type) << 16) |
+                  static_cast<uint32_t>(op.words.size()));
+    if (spvIsIdType(op.type)) {
+      uint32_t id_value = op.words[0];
+      auto use_id_to_val = id_to_value_.find(id_value);
+      if (use_id_to_val != id_to_value_.end()) {
+        id_value = (1u << 31) | use_id_to_val->second;
+      }
+      key.push_back(id_value);
+    } else {
+      key.append(op.words.begin(), op.words.end());
+    }
+  }
+  return key;
+}
+
 void ValueNumberTable::BuildDominatorTreeValueNumberTable() {
   // First value number the headers.
   for (auto& inst : context()->annotations()) {
@@ -186,48 +202,5 @@ void ValueNumberTable::BuildDominatorTreeValueNumberTable() {
   }
 }
 
-bool ComputeSameValue::operator()(const Instruction& lhs,
-                                  const Instruction& rhs) const {
-  if (lhs.result_id() == 0 || rhs.result_id() == 0) {
-    return false;
-  }
-
-  if (lhs.opcode() != rhs.opcode()) {
-    return false;
-  }
-
-  if (lhs.type_id() != rhs.type_id()) {
-    return false;
-  }
-
-  if (lhs.NumInOperands() != rhs.NumInOperands()) {
-    return false;
-  }
-
-  for (uint32_t i = 0; i < lhs.NumInOperands(); ++i) {
-    if (lhs.GetInOperand(i) != rhs.GetInOperand(i)) {
-      return false;
-    }
-  }
-
-  return lhs.context()->get_decoration_mgr()->HaveTheSameDecorations(
-      lhs.result_id(), rhs.result_id());
-}
-
-std::size_t ValueTableHash::operator()(const Instruction& inst) const {
-  // We hash the opcode and in-operands, not the result, because we want
-  // instructions that are the same except for the result to hash to the
-  // same value.
-  std::u32string h;
-  h.push_back(inst.opcode());
-  h.push_back(inst.type_id());
-  for (uint32_t i = 0; i < inst.NumInOperands(); ++i) {
-    const auto& opnd = inst.GetInOperand(i);
-    for (uint32_t word : opnd.words) {
-      h.push_back(word);
-    }
-  }
-  return std::hash<std::u32string>()(h);
-}
 }  // namespace opt
 }  // namespace spvtools
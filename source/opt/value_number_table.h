@@ -16,7 +16,9 @@
 #define SOURCE_OPT_VALUE_NUMBER_TABLE_H_
 
 #include <cstdint>
+#include <string>
 #include <unordered_map>
+#include <vector>
 
 #include "source/opt/instruction.h"
 
@@ -25,19 +27,6 @@ namespace opt {
 
 class IRContext;
 
-// Returns true if the two instructions compute the same value.  Used by the
-// value number table to compare two instructions.
-class ComputeSameValue {
- public:
-  bool operator()(const Instruction& lhs, const Instruction& rhs) const;
-};
-
-// The hash function used in the value number table.
-class ValueTableHash {
- public:
-  std::size_t operator()(const Instruction& inst) const;
-};
-
 // This class implements the value number analysis.  It is using a hash-based
 // approach to value numbering.  It is essentially doing dominator-tree value
 // numbering described in
@@ -49,6 +38,11 @@ class ValueTableHash {
 // The main difference is that because we do not perform redundancy elimination
 // as we build the value number table, we do not have to deal with cleaning up
 // the scope.
+//
+// The table is kept by the context as |kAnalysisValueNumberTable|.  Killing an
+// instruction removes it from the table, so passes that only replace values
+// by other ids with the same value number, and kill the replaced
+// instructions, can preserve the table.
 class ValueNumberTable {
  public:
   ValueNumberTable(IRContext* ctx) : context_(ctx), next_value_number_(1) {
@@ -64,6 +58,19 @@ class ValueNumberTable {
   // has not been assigned a value number.
   uint32_t GetValueNumber(uint32_t id) const;
 
+  // Assigns a value number to the result of |inst|, which was added to the
+  // module after the table was built, if it does not already have one.
+  // Returns the value number of |inst|.  The operands of |inst| should
+  // already have value numbers.
+  uint32_t AnalyzeInstruction(Instruction* inst) {
+    return AssignValueNumber(inst);
+  }
+
+  // Removes the value number of the result of |inst|, which is being killed.
+  void ClearInstruction(Instruction* inst) {
+    id_to_value_.erase(inst->result_id());
+  }
+
   IRContext* context() const { return context_; }
 
  private:
@@ -78,8 +85,17 @@ class ValueNumberTable {
   // id.
   uint32_t AssignValueNumber(Instruction* inst);
 
-  std::unordered_map<Instruction, uint32_t, ValueTableHash, ComputeSameValue>
-      instruction_to_value_;
+  // Returns the key of the value computed by |inst|: its opcode, type and
+  // in-operands, with the ids that have a value number replaced by their value
+  // number with the sign bit set.  Instructions that are the same except for
+  // their result id have the same key.
+  std::u32string GetValueKey(const Instruction& inst) const;
+
+  // The result ids of all the instructions computing each key, in the order
+  // they were numbered.  The ids of killed instructions are removed lazily.
+  // Instructions with the same key compute the same value only if their
+  // results have the same decorations.
+  std::unordered_map<std::u32string, std::vector<uint32_t>> key_to_ids_;
   std::unordered_map<uint32_t, uint32_t> id_to_value_;
   IRContext* context_;
   uint32_t next_value_number_;
@@ -298,7 +298,7 @@ bool VectorDCE::RewriteInstructions(
     Function* function, const VectorDCE::LiveComponentMap& live_components) {
   bool modified = false;
   function->ForEachInst(
-      [&modified, this, live_components](Instruction* current_inst) {
+      [&modified, this, &live_components](Instruction* current_inst) {
         if (!context()->IsCombinatorInstruction(current_inst)) {
           return;
         }
@@ -378,13 +378,12 @@ bool VectorDCE::RewriteInsertInstruction(
 }
 
 void VectorDCE::AddItemToWorkListIfNeeded(
-    WorkListItem work_item, VectorDCE::LiveComponentMap* live_components,
+    const WorkListItem& work_item, VectorDCE::LiveComponentMap* live_components,
     std::vector<WorkListItem>* work_list) {
   Instruction* current_inst = work_item.instruction;
   auto it = live_components->find(current_inst->result_id());
   if (it == live_components->end()) {
-    live_components->emplace(
-        std::make_pair(current_inst->result_id(), work_item.components));
+    live_components->emplace(current_inst->result_id(), work_item.components);
     work_list->emplace_back(work_item);
   } else {
     if (it->second.Or(work_item.components)) {
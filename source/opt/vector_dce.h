@@ -32,6 +32,8 @@ class VectorDCE : public MemPass {
   // rules in the universal validation rules (section 2.16.1).
   enum { kMaxVectorSize = 16 };
 
+  // The components fit in the inline bits of a BitVector, so work list items
+  // are copied without allocating.
   struct WorkListItem {
     WorkListItem() : instruction(nullptr), components(kMaxVectorSize) {}
 
@@ -97,7 +99,7 @@ class VectorDCE : public MemPass {
   // Adds |work_item| to |work_list| if it is not already live according to
   // |live_components|.  |live_components| is updated to indicate that
   // |work_item| is now live.
-  void AddItemToWorkListIfNeeded(WorkListItem work_item,
+  void AddItemToWorkListIfNeeded(const WorkListItem& work_item,
                                  LiveComponentMap* live_components,
                                  std::vector<WorkListItem>* work_list);
 
@@ -53,6 +53,7 @@ bool Workaround1209::RemoveOpUnreachableInLoops() {
                               {{spv_operand_type_t::SPV_OPERAND_TYPE_ID,
                                 {loop_merges.top()}}}));
           context()->AnalyzeDefUse(&*new_branch);
+          context()->set_instr_block(&*new_branch, bb);
           bb->AddInstruction(std::move(new_branch));
           modified = true;
         }
@@ -26,6 +26,13 @@ class Workaround1209 : public Pass {
   const char* name() const override { return "workaround-1209"; }
   Status Process() override;
 
+  IRContext::Analysis GetPreservedAnalyses() override {
+    return IRContext::kAnalysisDefUse |
+           IRContext::kAnalysisInstrToBlockMapping |
+           IRContext::kAnalysisDecorations | IRContext::kAnalysisNameMap |
+           IRContext::kAnalysisConstants | IRContext::kAnalysisTypes;
+  }
+
  private:
   // There is at least one driver where an OpUnreachable found in a loop is not
   // handled correctly.  Workaround that by changing the OpUnreachable into a
@@ -17,12 +17,35 @@
 #include "source/parsed_operand.h"
 
 #include <cassert>
+#include <sstream>
+
 #include "source/util/hex_float.h"
+#include "source/util/string_utils.h"
 
 namespace spvtools {
 
 void EmitNumericLiteral(std::ostream* out, const spv_parsed_instruction_t& inst,
                         const spv_parsed_operand_t& operand) {
+  std::string text;
+  AppendNumericLiteral(&text, inst, operand);
+  *out << text;
+}
+
+namespace {
+
+// Appends the text of |value| as written to a stream to |out|.
+template <typename T>
+void AppendStreamed(std::string* out, const T& value) {
+  std::ostringstream stream;
+  stream << value;
+  out->append(stream.str());
+}
+
+}  // namespace
+
+void AppendNumericLiteral(std::string* out,
+                          const spv_parsed_instruction_t& inst,
+                          const spv_parsed_operand_t& operand) {
   if (operand.type != SPV_OPERAND_TYPE_LITERAL_INTEGER &&
       operand.type != SPV_OPERAND_TYPE_TYPED_LITERAL_NUMBER)
     return;
@@ -34,18 +57,18 @@ void EmitNumericLiteral(std::ostream* out, const spv_parsed_instruction_t& inst,
   if (operand.num_words == 1) {
     switch (operand.number_kind) {
       case SPV_NUMBER_SIGNED_INT:
-        *out << int32_t(word);
+        utils::AppendSigned(int32_t(word), out);
         break;
       case SPV_NUMBER_UNSIGNED_INT:
-        *out << word;
+        utils::AppendUnsigned(word, out);
         break;
       case SPV_NUMBER_FLOATING:
         if (operand.number_bit_width == 16) {
-          *out << spvtools::utils::FloatProxy<spvtools::utils::Float16>(
-              uint16_t(word & 0xFFFF));
+          AppendStreamed(out, utils::FloatProxy<utils::Float16>(
+                                  uint16_t(word & 0xFFFF)));
         } else {
           // Assume 32-bit floats.
-          *out << spvtools::utils::FloatProxy<float>(word);
+          AppendStreamed(out, utils::FloatProxy<float>(word));
         }
         break;
       default:
@@ -57,14 +80,14 @@ void EmitNumericLiteral(std::ostream* out, const spv_parsed_instruction_t& inst,
         uint64_t(word) | (uint64_t(inst.words[operand.offset + 1]) << 32);
     switch (operand.number_kind) {
       case SPV_NUMBER_SIGNED_INT:
-        *out << int64_t(bits);
+        utils::AppendSigned(int64_t(bits), out);
         break;
       case SPV_NUMBER_UNSIGNED_INT:
-        *out << bits;
+        utils::AppendUnsigned(bits, out);
         break;
       case SPV_NUMBER_FLOATING:
         // Assume only 64-bit floats.
-        *out << spvtools::utils::FloatProxy<double>(bits);
+        AppendStreamed(out, utils::FloatProxy<double>(bits));
         break;
       default:
         break;
@@ -16,6 +16,7 @@
 #define SOURCE_PARSED_OPERAND_H_
 
 #include <ostream>
+#include <string>
 
 #include "spirv-tools/libspirv.h"
 
@@ -28,6 +29,12 @@ namespace spvtools {
 void EmitNumericLiteral(std::ostream* out, const spv_parsed_instruction_t& inst,
                         const spv_parsed_operand_t& operand);
 
+// Appends the same text as EmitNumericLiteral to |out|.  Integers are
+// formatted directly into the string, without going through a stream.
+void AppendNumericLiteral(std::string* out,
+                          const spv_parsed_instruction_t& inst,
+                          const spv_parsed_operand_t& operand);
+
 }  // namespace spvtools
 
 #endif  // SOURCE_PARSED_OPERAND_H_
@@ -34,10 +34,10 @@ ConditionalBranchToSimpleConditionalBranchOpportunityFinder::
   // reducer is improved by avoiding contiguous opportunities that disable one
   // another.
   for (bool redirect_to_true : {true, false}) {
-    // Consider every function.
-    for (auto& function : *context->module()) {
+    // Consider every target function.
+    for (auto* function : GetTargetFunctions(context)) {
       // Consider every block in the function.
-      for (auto& block : function) {
+      for (auto& block : *function) {
         // The terminator must be SpvOpBranchConditional.
         Instruction* terminator = block.terminator();
         if (terminator->opcode() != SpvOpBranchConditional) {
@@ -14,9 +14,14 @@
 
 #include "source/reduce/reducer.h"
 
+#include <algorithm>
 #include <cassert>
+#include <chrono>
+#include <cstdio>
 #include <sstream>
+#include <string>
 
+#include "source/opt/build_module.h"
 #include "source/reduce/conditional_branch_to_simple_conditional_branch_opportunity_finder.h"
 #include "source/reduce/merge_blocks_reduction_opportunity_finder.h"
 #include "source/reduce/operand_to_const_reduction_opportunity_finder.h"
@@ -29,9 +34,77 @@
 #include "source/reduce/simple_conditional_branch_to_branch_opportunity_finder.h"
 #include "source/reduce/structured_loop_to_selection_reduction_opportunity_finder.h"
 #include "source/spirv_reducer_options.h"
+#include "source/spirv_validator_options.h"
+#include "source/util/parallel.h"
+#include "source/util/sha256.h"
 
 namespace spvtools {
 namespace reduce {
+namespace {
+
+// Returns the key of |binary| in an interestingness cache: the SHA-256
+// digest of the binary and of what decides whether it is valid.  Only valid
+// binaries are tested.
+std::string InterestingnessKey(spv_target_env target_env,
+                               const spv_validator_options_t& options,
+                               const std::vector<uint32_t>& binary) {
+  utils::Sha256 sha;
+  const uint32_t env = static_cast<uint32_t>(target_env);
+  sha.Update(&env, sizeof(env));
+  HashValidatorOptions(options, &sha);
+  sha.Update(binary.data(), binary.size() * sizeof(uint32_t));
+  return sha.HexDigest();
+}
+
+}  // namespace
+
+bool MemoryInterestingnessCache::Lookup(const std::string& key,
+                                        bool* interesting) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  auto it = results_.find(key);
+  if (it == results_.end()) return false;
+  *interesting = it->second;
+  return true;
+}
+
+void MemoryInterestingnessCache::Insert(const std::string& key,
+                                        bool interesting) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  results_[key] = interesting;
+}
+
+DirectoryInterestingnessCache::DirectoryInterestingnessCache(
+    const std::string& path)
+    : path_(path) {}
+
+bool DirectoryInterestingnessCache::Lookup(const std::string& key,
+                                           bool* interesting) {
+  for (bool result : {true, false}) {
+    if (FILE* file = fopen(FilePath(key, result).c_str(), "rb")) {
+      fclose(file);
+      *interesting = result;
+      return true;
+    }
+  }
+  return false;
+}
+
+void DirectoryInterestingnessCache::Insert(const std::string& key,
+                                           bool interesting) {
+  // The file is empty, so a partly written one is as good as a complete one.
+  if (FILE* file = fopen(FilePath(key, interesting).c_str(), "wb")) {
+    fclose(file);
+  }
+}
+
+std::string DirectoryInterestingnessCache::FilePath(const std::string& key,
+                                                    bool interesting) const {
+  const std::string name =
+      key + (interesting ? ".interesting" : ".uninteresting");
+  if (path_.empty()) return name;
+  const char last = path_.back();
+  return last == '/' || last == '\\' ? path_ + name : path_ + "/" + name;
+}
 
 Reducer::Reducer(spv_target_env target_env) : target_env_(target_env) {}
 
@@ -52,11 +125,33 @@ void Reducer::SetInterestingnessFunction(
   interestingness_function_ = std::move(interestingness_function);
 }
 
+void Reducer::SetInterestingnessCache(InterestingnessCache* cache) {
+  interestingness_cache_ = cache;
+}
+
+void Reducer::SetStatistics(utils::StepStatistics* statistics) {
+  statistics_ = statistics;
+}
+
+bool Reducer::LookupInterestingness(const std::string& key,
+                                    bool* interesting) {
+  return interestingness_cache_ &&
+         interestingness_cache_->Lookup(key, interesting);
+}
+
+void Reducer::RecordInterestingness(const std::string& key,
+                                    bool interesting) {
+  if (interestingness_cache_) interestingness_cache_->Insert(key, interesting);
+}
+
 Reducer::ReductionResultStatus Reducer::Run(
     std::vector<uint32_t>&& binary_in, std::vector<uint32_t>* binary_out,
     spv_const_reducer_options options,
     spv_validator_options validator_options) {
   std::vector<uint32_t> current_binary(std::move(binary_in));
+  interestingness_cache_hits_ = 0;
+  interestingness_cache_misses_ = 0;
+  if (statistics_) statistics_->Clear();
 
   spvtools::SpirvTools tools(target_env_);
   assert(tools.IsValid() && "Failed to create SPIRV-Tools interface");
@@ -66,23 +161,48 @@ Reducer::ReductionResultStatus Reducer::Run(
   uint32_t reductions_applied = 0;
 
   // Initial state should be valid.
-  if (!tools.Validate(&current_binary[0], current_binary.size(),
-                      validator_options)) {
+  utils::StepStatistics::Phase* initial_state =
+      statistics_ ? statistics_->GetPhase("Initial state") : nullptr;
+  auto start = std::chrono::steady_clock::now();
+  const bool initially_valid = tools.Validate(
+      &current_binary[0], current_binary.size(), validator_options);
+  if (initial_state) {
+    initial_state->attempts = 1;
+    initial_state->validate_us =
+        utils::StepStatistics::MicrosecondsSince(start);
+  }
+  if (!initially_valid) {
     consumer_(SPV_MSG_INFO, nullptr, {},
               "Initial binary is invalid; stopping.");
     return Reducer::ReductionResultStatus::kInitialStateInvalid;
   }
 
-  // Initial state should be interesting.
-  if (!interestingness_function_(current_binary, reductions_applied)) {
+  // Initial state should be interesting.  It is always tested, as a check of
+  // the interestingness function.
+  start = std::chrono::steady_clock::now();
+  const bool initially_interesting =
+      interestingness_function_(current_binary, reductions_applied);
+  if (initial_state) {
+    initial_state->successes = initially_interesting ? 1 : 0;
+    initial_state->test_us = utils::StepStatistics::MicrosecondsSince(start);
+  }
+  if (interestingness_cache_) {
+    RecordInterestingness(
+        InterestingnessKey(target_env_, *validator_options, current_binary),
+        initially_interesting);
+  }
+  if (!initially_interesting) {
     consumer_(SPV_MSG_INFO, nullptr, {},
               "Initial state was not interesting; stopping.");
     return Reducer::ReductionResultStatus::kInitialStateNotInteresting;
   }
 
   Reducer::ReductionResultStatus result =
-      RunPasses(&passes_, options, validator_options, tools, &current_binary,
-                &reductions_applied);
+      options->function_by_function
+          ? RunPassesFunctionByFunction(options, validator_options, tools,
+                                        &current_binary, &reductions_applied)
+          : RunPasses(&passes_, options, validator_options, tools,
+                      &current_binary, &reductions_applied);
 
   if (result == Reducer::ReductionResultStatus::kComplete) {
     // Cleanup passes.
@@ -94,6 +214,13 @@ Reducer::ReductionResultStatus Reducer::Run(
     consumer_(SPV_MSG_INFO, nullptr, {}, "No more to reduce; stopping.");
   }
 
+  if (interestingness_cache_) {
+    std::stringstream stringstream;
+    stringstream << "Interestingness cache: " << interestingness_cache_hits_
+                 << " hits, " << interestingness_cache_misses_ << " misses.";
+    consumer_(SPV_MSG_INFO, nullptr, {}, stringstream.str().c_str());
+  }
+
   // Even if the reduction has failed by this point (e.g. due to producing an
   // invalid binary), we still update the output binary for better debugging.
   *binary_out = std::move(current_binary);
@@ -146,6 +273,58 @@ void Reducer::AddCleanupReductionPass(
       spvtools::MakeUnique<ReductionPass>(target_env_, std::move(finder)));
 }
 
+Reducer::ReductionResultStatus Reducer::RunPassesFunctionByFunction(
+    spv_const_reducer_options options, spv_validator_options validator_options,
+    const SpirvTools& tools, std::vector<uint32_t>* current_binary,
+    uint32_t* const reductions_applied) {
+  std::vector<std::unique_ptr<ReductionPass>> remove_functions;
+  remove_functions.push_back(spvtools::MakeUnique<ReductionPass>(
+      target_env_,
+      spvtools::MakeUnique<RemoveFunctionReductionOpportunityFinder>()));
+  remove_functions[0]->SetMessageConsumer(consumer_);
+
+  // Removing the functions which are not needed first saves reducing them.
+  Reducer::ReductionResultStatus result =
+      RunPasses(&remove_functions, options, validator_options, tools,
+                current_binary, reductions_applied);
+
+  std::vector<uint32_t> function_ids;
+  {
+    std::unique_ptr<opt::IRContext> context =
+        BuildModule(target_env_, consumer_, current_binary->data(),
+                    current_binary->size());
+    assert(context);
+    for (auto& function : *context->module()) {
+      function_ids.push_back(function.result_id());
+    }
+  }
+
+  for (uint32_t function_id : function_ids) {
+    if (result != Reducer::ReductionResultStatus::kComplete) {
+      break;
+    }
+    consumer_(SPV_MSG_INFO, nullptr, {},
+              ("Reducing function " + std::to_string(function_id) + ".")
+                  .c_str());
+    for (auto& pass : passes_) {
+      pass->SetTargetFunction(function_id);
+    }
+    result = RunPasses(&passes_, options, validator_options, tools,
+                       current_binary, reductions_applied);
+  }
+  for (auto& pass : passes_) {
+    pass->SetTargetFunction(0);
+  }
+
+  // Reducing the functions may have left some of them unused.
+  if (result == Reducer::ReductionResultStatus::kComplete) {
+    remove_functions[0]->SetTargetFunction(0);
+    result = RunPasses(&remove_functions, options, validator_options, tools,
+                       current_binary, reductions_applied);
+  }
+  return result;
+}
+
 bool Reducer::ReachedStepLimit(uint32_t current_step,
                                spv_const_reducer_options options) {
   return current_step >= options->step_limit;
@@ -160,6 +339,16 @@ Reducer::ReductionResultStatus Reducer::RunPasses(
   // worthwhile trying a further round.
   bool another_round_worthwhile = true;
 
+  // The number of reduction steps tested at the same time.
+  const uint32_t num_threads = utils::ResolveNumThreads(options->num_threads);
+
+  // The passes in the order in which they run in the current round.
+  std::vector<ReductionPass*> pass_order;
+  for (auto& pass : *passes) {
+    pass->SetTryComplements(options->adaptive_scheduling);
+    pass_order.push_back(pass.get());
+  }
+
   // Apply round after round of reduction passes until we hit the reduction
   // step limit, or deem that another round is not going to be worthwhile.
   while (!ReachedStepLimit(*reductions_applied, options) &&
@@ -168,8 +357,25 @@ Reducer::ReductionResultStatus Reducer::RunPasses(
     // not be worthwhile unless we find evidence to the contrary.
     another_round_worthwhile = false;
 
+    if (options->adaptive_scheduling) {
+      // Run the passes whose steps have most often been interesting first.
+      // The passes which have not been tried yet count as always
+      // interesting, so the first round keeps the order of the passes.
+      std::stable_sort(
+          pass_order.begin(), pass_order.end(),
+          [](const ReductionPass* a, const ReductionPass* b) {
+            const uint64_t a_steps = std::max<uint64_t>(a->GetNumSteps(), 1);
+            const uint64_t b_steps = std::max<uint64_t>(b->GetNumSteps(), 1);
+            const uint64_t a_interesting =
+                a->GetNumSteps() ? a->GetNumInterestingSteps() : 1;
+            const uint64_t b_interesting =
+                b->GetNumSteps() ? b->GetNumInterestingSteps() : 1;
+            return a_interesting * b_steps > b_interesting * a_steps;
+          });
+    }
+
     // Iterate through the available passes.
-    for (auto& pass : *passes) {
+    for (ReductionPass* pass : pass_order) {
       // If this pass hasn't reached its minimum granularity then it's
       // worth eventually doing another round of reductions, in order to
       // try this pass at a finer granularity.
@@ -179,9 +385,29 @@ Reducer::ReductionResultStatus Reducer::RunPasses(
       // working or we hit the reduction step limit.
       consumer_(SPV_MSG_INFO, nullptr, {},
                 ("Trying pass " + pass->GetName() + ".").c_str());
+      utils::StepStatistics::Phase* phase =
+          statistics_ ? statistics_->GetPhase(
+                            (passes == &cleanup_passes_ ? "Cleanup " : "") +
+                            pass->GetName())
+                      : nullptr;
       do {
-        auto maybe_result = pass->TryApplyReduction(*current_binary);
-        if (maybe_result.empty()) {
+        // With several threads, the steps that would follow if this one
+        // were not interesting are tested at the same time.  The steps are
+        // then considered in order, up to the first interesting one, so the
+        // reduction is the same as with a single thread.
+        const uint32_t num_candidates =
+            ReachedStepLimit(*reductions_applied, options)
+                ? 1
+                : std::min(num_threads,
+                           options->step_limit - *reductions_applied);
+        const auto make_start = std::chrono::steady_clock::now();
+        auto candidates =
+            pass->TryApplyReductions(*current_binary, num_candidates);
+        if (phase) {
+          phase->tool_us +=
+              utils::StepStatistics::MicrosecondsSince(make_start);
+        }
+        if (candidates.empty()) {
           // For this round, the pass has no more opportunities (chunks) to
           // apply, so move on to the next pass.
           consumer_(
@@ -190,37 +416,104 @@ Reducer::ReductionResultStatus Reducer::RunPasses(
                   .c_str());
           break;
         }
-        bool interesting = false;
-        std::stringstream stringstream;
-        (*reductions_applied)++;
-        stringstream << "Pass " << pass->GetName() << " made reduction step "
-                     << *reductions_applied << ".";
-        consumer_(SPV_MSG_INFO, nullptr, {}, (stringstream.str().c_str()));
-        if (!tools.Validate(&maybe_result[0], maybe_result.size(),
-                            validator_options)) {
-          // The reduction step went wrong and an invalid binary was produced.
-          // By design, this shouldn't happen; this is a safeguard to stop an
-          // invalid binary from being regarded as interesting.
-          consumer_(SPV_MSG_INFO, nullptr, {},
-                    "Reduction step produced an invalid binary.");
-          if (options->fail_on_validation_error) {
-            // In this mode, we fail, so we update the current binary so it is
-            // output for debugging.
-            *current_binary = std::move(maybe_result);
-            return Reducer::ReductionResultStatus::kStateInvalid;
+        std::vector<char> valid(candidates.size(), 0);
+        std::vector<char> interesting(candidates.size(), 0);
+        // The candidates whose result is already known are neither validated
+        // nor tested again.
+        std::vector<std::string> keys(candidates.size());
+        std::vector<char> known(candidates.size(), 0);
+        for (size_t i = 0; interestingness_cache_ && i < candidates.size();
+             ++i) {
+          keys[i] = InterestingnessKey(target_env_, *validator_options,
+                                       candidates[i]);
+          bool result = false;
+          if (LookupInterestingness(keys[i], &result)) {
+            known[i] = 1;
+            valid[i] = 1;
+            interesting[i] = result;
+            ++interestingness_cache_hits_;
+          }
+        }
+        // The time each candidate spends in validation and in the test.
+        std::vector<uint64_t> validate_us(candidates.size(), 0);
+        std::vector<uint64_t> test_us(candidates.size(), 0);
+        const uint32_t first_step = *reductions_applied + 1;
+        utils::ParallelFor(
+            candidates.size(), num_threads,
+            [this, &candidates, &known, &valid, &interesting, &validate_us,
+             &test_us, &tools, validator_options, first_step](size_t i) {
+              if (known[i]) return;
+              auto start = std::chrono::steady_clock::now();
+              valid[i] = tools.Validate(&candidates[i][0],
+                                        candidates[i].size(),
+                                        validator_options);
+              validate_us[i] = utils::StepStatistics::MicrosecondsSince(start);
+              if (!valid[i]) return;
+              start = std::chrono::steady_clock::now();
+              interesting[i] = interestingness_function_(
+                  candidates[i], first_step + static_cast<uint32_t>(i));
+              test_us[i] = utils::StepStatistics::MicrosecondsSince(start);
+            });
+        // The candidates discarded after an interesting one count in the
+        // times, but not in the steps.
+        for (size_t i = 0; phase && i < candidates.size(); ++i) {
+          phase->validate_us += validate_us[i];
+          phase->test_us += test_us[i];
+        }
+        for (size_t i = 0; i < candidates.size(); ++i) {
+          if (!interestingness_cache_ || known[i] || !valid[i]) continue;
+          RecordInterestingness(keys[i], interesting[i] != 0);
+          ++interestingness_cache_misses_;
+        }
+
+        for (size_t i = 0; i < candidates.size(); ++i) {
+          std::stringstream stringstream;
+          (*reductions_applied)++;
+          stringstream << "Pass " << pass->GetName()
+                       << " made reduction step " << *reductions_applied
+                       << ".";
+          consumer_(SPV_MSG_INFO, nullptr, {}, (stringstream.str().c_str()));
+          if (phase) {
+            ++phase->attempts;
+            if (known[i]) ++phase->cache_hits;
+            if (valid[i] && interesting[i]) {
+              ++phase->successes;
+              phase->bytes_removed +=
+                  (static_cast<int64_t>(current_binary->size()) -
+                   static_cast<int64_t>(candidates[i].size())) *
+                  static_cast<int64_t>(sizeof(uint32_t));
+            }
+          }
+          if (known[i]) {
+            consumer_(SPV_MSG_INFO, nullptr, {},
+                      "Reduction step result found in the interestingness "
+                      "cache.");
+          }
+          if (!valid[i]) {
+            // The reduction step went wrong and an invalid binary was
+            // produced. By design, this shouldn't happen; this is a safeguard
+            // to stop an invalid binary from being regarded as interesting.
+            consumer_(SPV_MSG_INFO, nullptr, {},
+                      "Reduction step produced an invalid binary.");
+            if (options->fail_on_validation_error) {
+              // In this mode, we fail, so we update the current binary so it
+              // is output for debugging.
+              *current_binary = std::move(candidates[i]);
+              return Reducer::ReductionResultStatus::kStateInvalid;
+            }
+          } else if (interesting[i]) {
+            // Success!  The binary produced by this reduction step is
+            // interesting, so make it the binary of interest henceforth, and
+            // note that it's worth doing another round of reduction passes.
+            consumer_(SPV_MSG_INFO, nullptr, {}, "Reduction step succeeded.");
+            *current_binary = std::move(candidates[i]);
+            another_round_worthwhile = true;
           }
-        } else if (interestingness_function_(maybe_result,
-                                             *reductions_applied)) {
-          // Success!  The binary produced by this reduction step is
-          // interesting, so make it the binary of interest henceforth, and
-          // note that it's worth doing another round of reduction passes.
-          consumer_(SPV_MSG_INFO, nullptr, {}, "Reduction step succeeded.");
-          *current_binary = std::move(maybe_result);
-          interesting = true;
-          another_round_worthwhile = true;
+          // We must call this before the next call to TryApplyReduction.
+          pass->NotifyInteresting(interesting[i] != 0);
+          // The later candidates were built from the previous binary.
+          if (interesting[i]) break;
         }
-        // We must call this before the next call to TryApplyReduction.
-        pass->NotifyInteresting(interesting);
         // Bail out if the reduction step limit has been reached.
       } while (!ReachedStepLimit(*reductions_applied, options));
     }
@@ -16,14 +16,64 @@
 #define SOURCE_REDUCE_REDUCER_H_
 
 #include <functional>
+#include <mutex>
 #include <string>
+#include <unordered_map>
 
 #include "source/reduce/reduction_pass.h"
+#include "source/util/profiler.h"
 #include "spirv-tools/libspirv.hpp"
 
 namespace spvtools {
 namespace reduce {
 
+// A store of the results of the interestingness test, for
+// Reducer::SetInterestingnessCache.  Each binary is identified by a key, which
+// is a string of hexadecimal digits.  Its methods may be called concurrently
+// by different reducers.
+class InterestingnessCache {
+ public:
+  virtual ~InterestingnessCache() {}
+
+  // Returns true and sets |*interesting| to the result stored for |key|, if
+  // there is one.
+  virtual bool Lookup(const std::string& key, bool* interesting) = 0;
+
+  // Stores |interesting| as the result for |key|.
+  virtual void Insert(const std::string& key, bool interesting) = 0;
+};
+
+// An interestingness cache kept in memory.
+class MemoryInterestingnessCache : public InterestingnessCache {
+ public:
+  bool Lookup(const std::string& key, bool* interesting) override;
+  void Insert(const std::string& key, bool interesting) override;
+
+ private:
+  std::mutex mutex_;
+  std::unordered_map<std::string, bool> results_;
+};
+
+// An interestingness cache that keeps an empty file, named after its key and
+// the result, for each binary in the existing directory |path|.  The
+// directory may persist across runs, but must only be shared by reductions
+// with the same interestingness test.  Failures to write to it are ignored,
+// so at worst binaries are tested again.
+class DirectoryInterestingnessCache : public InterestingnessCache {
+ public:
+  explicit DirectoryInterestingnessCache(const std::string& path);
+
+  bool Lookup(const std::string& key, bool* interesting) override;
+  void Insert(const std::string& key, bool interesting) override;
+
+ private:
+  // Returns the path of the file recording that the binary of |key| is
+  // |interesting|.
+  std::string FilePath(const std::string& key, bool interesting) const;
+
+  const std::string path_;
+};
+
 // This class manages the process of applying a reduction -- parameterized by a
 // number of reduction passes and an interestingness test, to a SPIR-V binary.
 class Reducer {
@@ -79,6 +129,22 @@ class Reducer {
   void SetInterestingnessFunction(
       InterestingnessFunction interestingness_function);
 
+  // Sets the cache of the results of the interestingness function.  Run
+  // stores the result for each binary it tests in |cache|, and neither
+  // validates nor tests a binary found in it, which happens when different
+  // passes produce the same binary.  The interestingness function must then
+  // always give the same result for the same binary.  The key is a SHA-256
+  // hash of the binary, of the target environment and of the validator
+  // options.  |cache| must outlive the reducer, and null removes the cache.
+  void SetInterestingnessCache(InterestingnessCache* cache);
+
+  // Sets the statistics that Run records: the steps of each reduction pass,
+  // and those of the initial state, with the time spent making them,
+  // validating them and testing them.  Run clears |statistics| first.  The
+  // cleanup passes are named with the prefix "Cleanup ".  |statistics| must
+  // outlive the reducer, and null records nothing.
+  void SetStatistics(utils::StepStatistics* statistics);
+
   // Adds all default reduction passes.
   void AddDefaultReductionPasses();
 
@@ -103,17 +169,41 @@ class Reducer {
   static bool ReachedStepLimit(uint32_t current_step,
                                spv_const_reducer_options options);
 
+  // Returns true and sets |*interesting| to the known result of the
+  // interestingness function for the binary of |key|, if there is one.
+  bool LookupInterestingness(const std::string& key, bool* interesting);
+
+  // Records |interesting| as the result of the interestingness function for
+  // the binary of |key|.
+  void RecordInterestingness(const std::string& key, bool interesting);
+
   ReductionResultStatus RunPasses(
       std::vector<std::unique_ptr<ReductionPass>>* passes,
       spv_const_reducer_options options,
       spv_validator_options validator_options, const SpirvTools& tools,
       std::vector<uint32_t>* current_binary, uint32_t* reductions_applied);
 
+  // Runs the reduction passes on one function of |current_binary| at a
+  // time, after and before removing the functions which are not needed.
+  ReductionResultStatus RunPassesFunctionByFunction(
+      spv_const_reducer_options options,
+      spv_validator_options validator_options, const SpirvTools& tools,
+      std::vector<uint32_t>* current_binary, uint32_t* reductions_applied);
+
   const spv_target_env target_env_;
   MessageConsumer consumer_;
   InterestingnessFunction interestingness_function_;
   std::vector<std::unique_ptr<ReductionPass>> passes_;
   std::vector<std::unique_ptr<ReductionPass>> cleanup_passes_;
+
+  // The cache of the results of the interestingness function, if any, and
+  // the number of tests it saved and did not save in the current run.
+  InterestingnessCache* interestingness_cache_ = nullptr;
+  uint32_t interestingness_cache_hits_ = 0;
+  uint32_t interestingness_cache_misses_ = 0;
+
+  // The statistics recorded by Run, if any.
+  utils::StepStatistics* statistics_ = nullptr;
 };
 
 }  // namespace reduce
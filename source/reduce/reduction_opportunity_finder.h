@@ -15,6 +15,8 @@
 #ifndef SOURCE_REDUCE_REDUCTION_OPPORTUNITY_FINDER_H_
 #define SOURCE_REDUCE_REDUCTION_OPPORTUNITY_FINDER_H_
 
+#include <vector>
+
 #include "source/opt/ir_context.h"
 #include "source/reduce/reduction_opportunity.h"
 
@@ -24,7 +26,7 @@ namespace reduce {
 // Abstract class for finding opportunities for reducing a SPIR-V module.
 class ReductionOpportunityFinder {
  public:
-  ReductionOpportunityFinder() = default;
+  ReductionOpportunityFinder() : target_function_(0) {}
 
   virtual ~ReductionOpportunityFinder() = default;
 
@@ -35,6 +37,34 @@ class ReductionOpportunityFinder {
 
   // Provides a name for the finder.
   virtual std::string GetName() const = 0;
+
+  // Restricts the opportunities found to those within the function whose
+  // result id is |function_id|, or lifts the restriction if it is 0.  The
+  // opportunities which concern the module as a whole, such as removing a
+  // function or a global instruction, are not found while the restriction
+  // holds.
+  void SetTargetFunction(uint32_t function_id) {
+    target_function_ = function_id;
+  }
+
+ protected:
+  // Returns true if the opportunities are not restricted to a function.
+  bool TargetsWholeModule() const { return target_function_ == 0; }
+
+  // Returns the functions of |context| in which to look for opportunities.
+  std::vector<opt::Function*> GetTargetFunctions(
+      opt::IRContext* context) const {
+    std::vector<opt::Function*> result;
+    for (auto& function : *context->module()) {
+      if (TargetsWholeModule() || function.result_id() == target_function_) {
+        result.push_back(&function);
+      }
+    }
+    return result;
+  }
+
+ private:
+  uint32_t target_function_;
 };
 
 }  // namespace reduce
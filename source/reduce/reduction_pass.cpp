@@ -15,54 +15,177 @@
 #include "source/reduce/reduction_pass.h"
 
 #include <algorithm>
+#include <memory>
+#include <utility>
+#include <vector>
 
 #include "source/opt/build_module.h"
+#include "source/util/make_unique.h"
 
 namespace spvtools {
 namespace reduce {
+namespace {
+
+// Returns a new context holding a copy of the module of |context|, which is
+// equivalent to parsing the binary of that module again.
+std::unique_ptr<opt::IRContext> CloneContext(const opt::IRContext& context,
+                                             spv_target_env target_env,
+                                             MessageConsumer consumer) {
+  std::unique_ptr<opt::IRContext> clone =
+      MakeUnique<opt::IRContext>(target_env, std::move(consumer));
+  const opt::Module& module = *context.module();
+  opt::Module* cloned_module = clone->module();
+  opt::IRContext* ctx = clone.get();
+  const auto clone_inst = [ctx](const opt::Instruction& inst) {
+    return std::unique_ptr<opt::Instruction>(inst.Clone(ctx));
+  };
+
+  cloned_module->SetHeader(module.header());
+  for (const auto& inst : module.capabilities())
+    cloned_module->AddCapability(clone_inst(inst));
+  for (const auto& inst : module.extensions())
+    cloned_module->AddExtension(clone_inst(inst));
+  for (const auto& inst : module.ext_inst_imports())
+    cloned_module->AddExtInstImport(clone_inst(inst));
+  if (module.GetMemoryModel())
+    cloned_module->SetMemoryModel(clone_inst(*module.GetMemoryModel()));
+  for (const auto& inst : module.entry_points())
+    cloned_module->AddEntryPoint(clone_inst(inst));
+  for (const auto& inst : module.execution_modes())
+    cloned_module->AddExecutionMode(clone_inst(inst));
+  for (const auto& inst : module.debugs1())
+    cloned_module->AddDebug1Inst(clone_inst(inst));
+  for (const auto& inst : module.debugs2())
+    cloned_module->AddDebug2Inst(clone_inst(inst));
+  for (const auto& inst : module.debugs3())
+    cloned_module->AddDebug3Inst(clone_inst(inst));
+  for (const auto& inst : module.ext_inst_debuginfo())
+    cloned_module->AddExtInstDebugInfo(clone_inst(inst));
+  for (const auto& inst : module.annotations())
+    cloned_module->AddAnnotationInst(clone_inst(inst));
+  for (const auto& inst : module.types_values())
+    cloned_module->AddType(clone_inst(inst));
+  for (const auto& func : module) {
+    cloned_module->AddFunction(std::unique_ptr<opt::Function>(func.Clone(ctx)));
+  }
+  std::vector<opt::Instruction> trailing_dbg_line_info =
+      module.trailing_dbg_line_info();
+  cloned_module->SetTrailingDbgLineInfo(std::move(trailing_dbg_line_info));
+  return clone;
+}
+
+}  // namespace
 
 std::vector<uint32_t> ReductionPass::TryApplyReduction(
     const std::vector<uint32_t>& binary) {
-  // We represent modules as binaries because (a) attempts at reduction need to
-  // end up in binary form to be passed on to SPIR-V-consuming tools, and (b)
-  // when we apply a reduction step we need to do it on a fresh version of the
-  // module as if the reduction step proves to be uninteresting we need to
-  // backtrack; re-parsing from binary provides a very clean way of cloning the
-  // module.
-  std::unique_ptr<opt::IRContext> context =
-      BuildModule(target_env_, consumer_, binary.data(), binary.size());
-  assert(context);
-
-  std::vector<std::unique_ptr<ReductionOpportunity>> opportunities =
-      finder_->GetAvailableOpportunities(context.get());
-
-  // There is no point in having a granularity larger than the number of
-  // opportunities, so reduce the granularity in this case.
-  if (granularity_ > opportunities.size()) {
-    granularity_ = std::max((uint32_t)1, (uint32_t)opportunities.size());
+  std::vector<std::vector<uint32_t>> results = TryApplyReductions(binary, 1);
+  if (results.empty()) {
+    return std::vector<uint32_t>();
   }
+  return std::move(results[0]);
+}
 
-  assert(granularity_ > 0);
-
-  if (index_ >= opportunities.size()) {
-    // We have reached the end of the available opportunities and, therefore,
-    // the end of the round for this pass, so reset the index and decrease the
-    // granularity for the next round. Return an empty vector to signal the end
-    // of the round.
-    index_ = 0;
-    granularity_ = std::max((uint32_t)1, granularity_ / 2);
-    return std::vector<uint32_t>();
+std::vector<std::vector<uint32_t>> ReductionPass::TryApplyReductions(
+    const std::vector<uint32_t>& binary, uint32_t max_candidates) {
+  // We represent modules as binaries because attempts at reduction need to
+  // end up in binary form to be passed on to SPIR-V-consuming tools.  When
+  // we apply a reduction step we need to do it on a fresh version of the
+  // module, as if the reduction step proves to be uninteresting we need to
+  // backtrack.  The binary is only parsed when it changes, and each step
+  // works on a copy of the parsed module, which is cheaper than parsing it
+  // again.
+  if (!pristine_context_ || pristine_binary_ != binary) {
+    pristine_context_ =
+        BuildModule(target_env_, consumer_, binary.data(), binary.size());
+    assert(pristine_context_);
+    pristine_binary_ = binary;
   }
 
-  for (uint32_t i = index_;
-       i < std::min(index_ + granularity_, (uint32_t)opportunities.size());
-       ++i) {
-    opportunities[i]->TryToApply();
+  std::vector<std::vector<uint32_t>> results;
+  for (uint32_t candidate = 0; candidate < max_candidates; ++candidate) {
+    std::unique_ptr<opt::IRContext> context =
+        CloneContext(*pristine_context_, target_env_, consumer_);
+
+    std::vector<std::unique_ptr<ReductionOpportunity>> opportunities =
+        finder_->GetAvailableOpportunities(context.get());
+
+    // There is no point in having a granularity larger than the number of
+    // opportunities, so reduce the granularity in this case.
+    if (granularity_ > opportunities.size()) {
+      granularity_ = std::max((uint32_t)1, (uint32_t)opportunities.size());
+    }
+
+    assert(granularity_ > 0);
+    num_opportunities_ = opportunities.size();
+
+    // The chunk that TryApplyReduction would apply after the previous
+    // candidates were found not interesting.
+    bool complement = false;
+    uint64_t index = 0;
+    if (!GetStep(candidate, opportunities.size(), &complement, &index)) {
+      if (candidate == 0) {
+        // We have reached the end of the available opportunities and,
+        // therefore, the end of the round for this pass, so reset the index
+        // and decrease the granularity for the next round. Return no binaries
+        // to signal the end of the round.
+        index_ = 0;
+        granularity_ = std::max((uint32_t)1, granularity_ / 2);
+        const uint64_t num_chunks =
+            (opportunities.size() + granularity_ - 1) / granularity_;
+        complement_phase_ =
+            try_complements_ && complements_pay_off_ && num_chunks > 2;
+        pristine_context_.reset();
+        pristine_binary_.clear();
+      }
+      break;
+    }
+
+    const uint64_t chunk_end =
+        std::min(index + granularity_, (uint64_t)opportunities.size());
+    for (uint64_t i = 0; i < opportunities.size(); ++i) {
+      if ((i >= index && i < chunk_end) != complement) {
+        opportunities[i]->TryToApply();
+      }
+    }
+
+    results.emplace_back();
+    context->module()->ToBinary(&results.back(), false);
   }
+  return results;
+}
+
+void ReductionPass::SetTargetFunction(uint32_t function_id) {
+  finder_->SetTargetFunction(function_id);
+  index_ = 0;
+  granularity_ = std::numeric_limits<uint32_t>::max();
+  complement_phase_ = false;
+  complements_pay_off_ = true;
+  pristine_context_.reset();
+  pristine_binary_.clear();
+}
 
-  std::vector<uint32_t> result;
-  context->module()->ToBinary(&result, false);
-  return result;
+bool ReductionPass::GetStep(uint32_t candidate, uint64_t num_opportunities,
+                            bool* complement, uint64_t* index) const {
+  uint64_t step = candidate;
+  uint64_t next_index = index_;
+  if (complement_phase_) {
+    // The complements come first, then the chunks from the start.
+    const uint64_t num_complements =
+        next_index >= num_opportunities
+            ? 0
+            : (num_opportunities - next_index + granularity_ - 1) /
+                  granularity_;
+    if (step < num_complements) {
+      *complement = true;
+      *index = next_index + step * granularity_;
+      return true;
+    }
+    step -= num_complements;
+    next_index = 0;
+  }
+  *complement = false;
+  *index = next_index + step * granularity_;
+  return *index < num_opportunities;
 }
 
 void ReductionPass::SetMessageConsumer(MessageConsumer consumer) {
@@ -77,6 +200,26 @@ bool ReductionPass::ReachedMinimumGranularity() const {
 std::string ReductionPass::GetName() const { return finder_->GetName(); }
 
 void ReductionPass::NotifyInteresting(bool interesting) {
+  ++num_steps_;
+  if (interesting) ++num_interesting_steps_;
+  if (complement_phase_) {
+    if (interesting) {
+      // Only the opportunities of one chunk were left out, so go on with
+      // smaller chunks.
+      index_ = 0;
+      granularity_ = std::max((uint32_t)1, granularity_ / 2);
+      complement_phase_ = false;
+      return;
+    }
+    index_ += granularity_;
+    if (index_ >= num_opportunities_) {
+      // No complement was interesting; go on with the chunks.
+      index_ = 0;
+      complement_phase_ = false;
+      complements_pay_off_ = false;
+    }
+    return;
+  }
   if (!interesting) {
     index_ += granularity_;
   }
@@ -16,6 +16,8 @@
 #define SOURCE_REDUCE_REDUCTION_PASS_H_
 
 #include <limits>
+#include <memory>
+#include <vector>
 
 #include "source/opt/ir_context.h"
 #include "source/reduce/reduction_opportunity_finder.h"
@@ -31,6 +33,13 @@ namespace reduce {
 // opportunities at a given granularity.  When an iteration over available
 // opportunities completes, the granularity is reduced and iteration starts
 // again, until the minimum granularity is reached.
+//
+// If complements are enabled, a round in which the opportunities form more
+// than two chunks starts by applying, in turn, all the opportunities but
+// those of each chunk, as delta debugging (ddmin) tests the complements of
+// the chunks.  Such a step leaves little to reduce when it is interesting,
+// and the granularity is then halved at once.  The pass stops trying
+// complements once a whole round of them was not interesting.
 class ReductionPass {
  public:
   // Constructs a reduction pass with a given target environment, |target_env|,
@@ -40,7 +49,13 @@ class ReductionPass {
       : target_env_(target_env),
         finder_(std::move(finder)),
         index_(0),
-        granularity_(std::numeric_limits<uint32_t>::max()) {}
+        granularity_(std::numeric_limits<uint32_t>::max()),
+        try_complements_(false),
+        complement_phase_(false),
+        complements_pay_off_(true),
+        num_opportunities_(0),
+        num_steps_(0),
+        num_interesting_steps_(0) {}
 
   // Applies the reduction pass to the given binary by applying a "chunk" of
   // reduction opportunities. Returns the new binary if a chunk was applied; in
@@ -51,6 +66,15 @@ class ReductionPass {
   // round.
   std::vector<uint32_t> TryApplyReduction(const std::vector<uint32_t>& binary);
 
+  // Returns the binaries that TryApplyReduction would return for up to
+  // |max_candidates| calls, if the binary returned by each call was found
+  // not interesting.  Each binary applies the next chunk of opportunities to
+  // |binary|.  The caller must then invoke NotifyInteresting(...) for each
+  // binary in order, up to the first interesting one.  Returns no binaries if
+  // there are no more chunks left to apply, as TryApplyReduction does.
+  std::vector<std::vector<uint32_t>> TryApplyReductions(
+      const std::vector<uint32_t>& binary, uint32_t max_candidates);
+
   // Notifies the reduction pass whether the binary returned from
   // TryApplyReduction is interesting, so that the next call to
   // TryApplyReduction will avoid applying the same chunk of opportunities.
@@ -59,6 +83,23 @@ class ReductionPass {
   // Sets a consumer to which relevant messages will be directed.
   void SetMessageConsumer(MessageConsumer consumer);
 
+  // Sets whether the pass tries the complements of the chunks, as described
+  // above.  They are not tried by default.
+  void SetTryComplements(bool try_complements) {
+    try_complements_ = try_complements;
+  }
+
+  // Restricts the opportunities of the pass to those within the function
+  // |function_id|, or lifts the restriction if it is 0, as
+  // ReductionOpportunityFinder::SetTargetFunction does.  The pass then starts
+  // again from the largest granularity.
+  void SetTargetFunction(uint32_t function_id);
+
+  // Returns the number of steps of this pass that were tested, and the
+  // number of those that were interesting.
+  uint64_t GetNumSteps() const { return num_steps_; }
+  uint64_t GetNumInterestingSteps() const { return num_interesting_steps_; }
+
   // Returns true if the granularity with which reduction opportunities are
   // applied has reached a minimum.
   bool ReachedMinimumGranularity() const;
@@ -68,11 +109,38 @@ class ReductionPass {
   std::string GetName() const;
 
  private:
+  // Finds the step that TryApplyReduction would take after |candidate| steps
+  // were found not interesting, for |num_opportunities| opportunities.
+  // Returns false if the round ends before.  Otherwise sets |*complement|
+  // to whether the step applies all the opportunities but those of the chunk
+  // at |*index|, rather than those of the chunk.
+  bool GetStep(uint32_t candidate, uint64_t num_opportunities,
+               bool* complement, uint64_t* index) const;
+
   const spv_target_env target_env_;
   const std::unique_ptr<ReductionOpportunityFinder> finder_;
   MessageConsumer consumer_;
   uint32_t index_;
   uint32_t granularity_;
+
+  // Whether complements are enabled, whether the current steps apply
+  // complements, and whether they have been interesting so far.
+  bool try_complements_;
+  bool complement_phase_;
+  bool complements_pay_off_;
+  // The number of opportunities of the binary last given to
+  // TryApplyReductions.
+  uint64_t num_opportunities_;
+  // The statistics of the steps, for GetNumSteps.
+  uint64_t num_steps_;
+  uint64_t num_interesting_steps_;
+
+  // The binary last given to TryApplyReductions, and its module, from which
+  // the module of each step is cloned.  The binary only changes once a step
+  // is found interesting, so it is parsed once for all the steps that are
+  // not.  They are released at the end of each round.
+  std::vector<uint32_t> pristine_binary_;
+  std::unique_ptr<opt::IRContext> pristine_context_;
 };
 
 }  // namespace reduce
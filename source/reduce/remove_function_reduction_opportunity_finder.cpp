@@ -23,6 +23,10 @@ std::vector<std::unique_ptr<ReductionOpportunity>>
 RemoveFunctionReductionOpportunityFinder::GetAvailableOpportunities(
     opt::IRContext* context) const {
   std::vector<std::unique_ptr<ReductionOpportunity>> result;
+  if (!TargetsWholeModule()) {
+    // Removing a function concerns the module as a whole.
+    return result;
+  }
   // Consider each function.
   for (auto& function : *context->module()) {
     if (context->get_def_use_mgr()->NumUses(function.result_id()) > 0) {
@@ -55,8 +55,8 @@ RemoveSelectionReductionOpportunityFinder::GetAvailableOpportunities(
   // Return all selection headers where the OpSelectionMergeInstruction can be
   // removed.
   std::vector<std::unique_ptr<ReductionOpportunity>> result;
-  for (auto& function : *context->module()) {
-    for (auto& block : function) {
+  for (auto* function : GetTargetFunctions(context)) {
+    for (auto& block : *function) {
       if (auto merge_instruction = block.GetMergeInst()) {
         if (merge_instruction->opcode() == SpvOpSelectionMerge) {
           if (CanOpSelectionMergeBeRemoved(
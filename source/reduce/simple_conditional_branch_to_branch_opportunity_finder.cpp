@@ -28,10 +28,10 @@ SimpleConditionalBranchToBranchOpportunityFinder::GetAvailableOpportunities(
     IRContext* context) const {
   std::vector<std::unique_ptr<ReductionOpportunity>> result;
 
-  // Consider every function.
-  for (auto& function : *context->module()) {
+  // Consider every target function.
+  for (auto* function : GetTargetFunctions(context)) {
     // Consider every block in the function.
-    for (auto& block : function) {
+    for (auto& block : *function) {
       // The terminator must be SpvOpBranchConditional.
       Instruction* terminator = block.terminator();
       if (terminator->opcode() != SpvOpBranchConditional) {
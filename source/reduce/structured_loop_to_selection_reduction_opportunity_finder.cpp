@@ -41,9 +41,9 @@ StructuredLoopToSelectionReductionOpportunityFinder::GetAvailableOpportunities(
     }
   }
 
-  // Consider each loop construct header in the module.
-  for (auto& function : *context->module()) {
-    for (auto& block : function) {
+  // Consider each loop construct header in the target functions.
+  for (auto* function : GetTargetFunctions(context)) {
+    for (auto& block : *function) {
       auto loop_merge_inst = block.GetLoopMergeInst();
       if (!loop_merge_inst) {
         // This is not a loop construct header.
@@ -71,7 +71,7 @@ StructuredLoopToSelectionReductionOpportunityFinder::GetAvailableOpportunities(
       // so we cautiously do not consider applying a transformation.
       auto merge_block_id =
           loop_merge_inst->GetSingleWordInOperand(kMergeNodeIndex);
-      if (!context->GetDominatorAnalysis(&function)->Dominates(
+      if (!context->GetDominatorAnalysis(function)->Dominates(
               block.id(), merge_block_id)) {
         continue;
       }
@@ -80,7 +80,7 @@ StructuredLoopToSelectionReductionOpportunityFinder::GetAvailableOpportunities(
       // construct header.  If not (e.g. because the loop contains OpReturn,
       // OpKill or OpUnreachable), we cautiously do not consider applying
       // a transformation.
-      if (!context->GetPostDominatorAnalysis(&function)->Dominates(
+      if (!context->GetPostDominatorAnalysis(function)->Dominates(
               merge_block_id, block.id())) {
         continue;
       }
@@ -89,7 +89,7 @@ StructuredLoopToSelectionReductionOpportunityFinder::GetAvailableOpportunities(
       // opportunity to do so.
       result.push_back(
           MakeUnique<StructuredLoopToSelectionReductionOpportunity>(
-              context, &block, &function));
+              context, &block, function));
     }
   }
   return result;
@@ -0,0 +1,437 @@
+// Copyright (c) 2020 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "spirv-tools/reflection.hpp"
+
+#include <algorithm>
+#include <map>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "source/latest_version_spirv_header.h"
+#include "source/opcode.h"
+#include "source/spirv_constant.h"
+#include "source/spirv_endian.h"
+
+namespace spvtools {
+namespace {
+
+// The literal of each decoration of an id or of a struct member, by
+// decoration.  Decorations without a literal map to 0.
+using DecorationValues = std::unordered_map<uint32_t, uint32_t>;
+
+// The instructions of the global section of a module that reflection needs,
+// collected while parsing it.
+struct GlobalSection {
+  ModuleReflection* reflection;
+  // The words of each type, constant and variable declaration, by result id.
+  std::unordered_map<uint32_t, std::vector<uint32_t>> declarations;
+  // The ids of the variables and of the scalar specialization constants, in
+  // module order.
+  std::vector<uint32_t> variable_ids;
+  std::vector<uint32_t> spec_constant_ids;
+  // The decorations of the ids, and of the members of the structs by struct
+  // id and member index.
+  std::unordered_map<uint32_t, DecorationValues> decorations;
+  std::map<std::pair<uint32_t, uint32_t>, DecorationValues> member_decorations;
+};
+
+// Returns the number of words of the module |binary| of |size| words before
+// its first function.  Returns |size| if it has no function, or if its
+// instructions cannot be walked, so that parsing it reports the problem.
+size_t GlobalSectionSize(const uint32_t* binary, size_t size) {
+  const spv_const_binary_t module = {binary, size};
+  spv_endianness_t endian;
+  if (size < SPV_INDEX_INSTRUCTION ||
+      spvBinaryEndianness(&module, &endian) != SPV_SUCCESS) {
+    return size;
+  }
+  for (size_t index = SPV_INDEX_INSTRUCTION; index < size;) {
+    uint16_t word_count = 0;
+    uint16_t opcode = 0;
+    spvOpcodeSplit(spvFixWord(binary[index], endian), &word_count, &opcode);
+    if (word_count == 0) return size;
+    if (opcode == SpvOpFunction) return index;
+    index += word_count;
+  }
+  return size;
+}
+
+// Records the words of |inst| as the declaration of its result id.
+void Declare(GlobalSection* section, const spv_parsed_instruction_t* inst) {
+  section->declarations[inst->result_id].assign(
+      inst->words, inst->words + inst->num_words);
+}
+
+// Collects |inst| into the GlobalSection at |user_data|, if reflection needs
+// it.  Meets the interface requirement of spvBinaryParse().
+spv_result_t CollectInstruction(void* user_data,
+                                const spv_parsed_instruction_t* inst) {
+  GlobalSection* section = static_cast<GlobalSection*>(user_data);
+  const uint32_t* words = inst->words;
+  const SpvOp opcode = static_cast<SpvOp>(inst->opcode);
+  switch (opcode) {
+    case SpvOpEntryPoint: {
+      ReflectedEntryPoint entry_point;
+      entry_point.execution_model = words[1];
+      entry_point.function_id = words[2];
+      entry_point.name =
+          reinterpret_cast<const char*>(words + inst->operands[2].offset);
+      for (uint16_t i = 3; i < inst->num_operands; ++i) {
+        entry_point.interface_ids.push_back(words[inst->operands[i].offset]);
+      }
+      section->reflection->entry_points.push_back(std::move(entry_point));
+    } break;
+    case SpvOpDecorate:
+      section->decorations[words[1]][words[2]] =
+          inst->num_words > 3 ? words[3] : 0;
+      break;
+    case SpvOpMemberDecorate:
+      section->member_decorations[{words[1], words[2]}][words[3]] =
+          inst->num_words > 4 ? words[4] : 0;
+      break;
+    case SpvOpGroupDecorate: {
+      // Copy the decorations of the group, which precede it, to each target.
+      const DecorationValues group = section->decorations[words[1]];
+      for (uint16_t i = 2; i < inst->num_words; ++i) {
+        for (const auto& decoration : group) {
+          section->decorations[words[i]].insert(decoration);
+        }
+      }
+    } break;
+    case SpvOpGroupMemberDecorate: {
+      const DecorationValues group = section->decorations[words[1]];
+      for (uint16_t i = 2; i + 1 < inst->num_words; i += 2) {
+        for (const auto& decoration : group) {
+          section->member_decorations[{words[i], words[i + 1]}].insert(
+              decoration);
+        }
+      }
+    } break;
+    case SpvOpVariable:
+      section->variable_ids.push_back(inst->result_id);
+      Declare(section, inst);
+      break;
+    case SpvOpSpecConstantTrue:
+    case SpvOpSpecConstantFalse:
+    case SpvOpSpecConstant:
+      section->spec_constant_ids.push_back(inst->result_id);
+      Declare(section, inst);
+      break;
+    case SpvOpConstant:
+      Declare(section, inst);
+      break;
+    default:
+      if (spvOpcodeGeneratesType(opcode)) Declare(section, inst);
+      break;
+  }
+  return SPV_SUCCESS;
+}
+
+// Walks the declarations collected in a GlobalSection to fill the reflection.
+class ReflectionBuilder {
+ public:
+  explicit ReflectionBuilder(const GlobalSection& section)
+      : section_(section) {}
+
+  // Adds the descriptors, push constants, interface variables and
+  // specialization constants of the section to its reflection.
+  void Build() {
+    for (uint32_t id : section_.variable_ids) AddVariable(id);
+    for (uint32_t id : section_.spec_constant_ids) AddSpecConstant(id);
+  }
+
+ private:
+  // Returns the words declaring |id|, or nullptr if it is not declared in
+  // the global section.
+  const std::vector<uint32_t>* Find(uint32_t id) const {
+    const auto it = section_.declarations.find(id);
+    return it == section_.declarations.end() ? nullptr : &it->second;
+  }
+
+  // Returns the opcode declaring |id|, or SpvOpNop if there is none.
+  SpvOp GetOpcode(uint32_t id) const {
+    const std::vector<uint32_t>* words = Find(id);
+    return words ? static_cast<SpvOp>(words->front() & SpvOpCodeMask)
+                 : SpvOpNop;
+  }
+
+  // Returns the literal of |decoration| in |values|, or |default_value| if
+  // it is not there.
+  static uint32_t GetValue(const DecorationValues& values, uint32_t decoration,
+                           uint32_t default_value) {
+    const auto it = values.find(decoration);
+    return it == values.end() ? default_value : it->second;
+  }
+
+  // Returns the literal of |decoration| on |id|, or |default_value| if |id|
+  // does not have it.
+  uint32_t GetDecoration(uint32_t id, uint32_t decoration,
+                         uint32_t default_value) const {
+    const auto it = section_.decorations.find(id);
+    if (it == section_.decorations.end()) return default_value;
+    return GetValue(it->second, decoration, default_value);
+  }
+
+  bool HasDecoration(uint32_t id, uint32_t decoration) const {
+    const auto it = section_.decorations.find(id);
+    return it != section_.decorations.end() && it->second.count(decoration);
+  }
+
+  // Returns the literal of |decoration| on the member |member| of the struct
+  // |struct_id|, or |default_value| if the member does not have it.
+  uint32_t GetMemberDecoration(uint32_t struct_id, uint32_t member,
+                               uint32_t decoration,
+                               uint32_t default_value) const {
+    const auto it = section_.member_decorations.find({struct_id, member});
+    if (it == section_.member_decorations.end()) return default_value;
+    return GetValue(it->second, decoration, default_value);
+  }
+
+  bool HasMemberDecoration(uint32_t struct_id, uint32_t member,
+                           uint32_t decoration) const {
+    const auto it = section_.member_decorations.find({struct_id, member});
+    return it != section_.member_decorations.end() &&
+           it->second.count(decoration);
+  }
+
+  // Returns the value of the integer constant |id|, or of the default value
+  // of the specialization constant |id|.  Returns 0 for any other id.
+  uint32_t GetConstantValue(uint32_t id) const {
+    const std::vector<uint32_t>* words = Find(id);
+    if (!words || words->size() < 4) return 0;
+    const SpvOp opcode = static_cast<SpvOp>(words->front() & SpvOpCodeMask);
+    if (opcode != SpvOpConstant && opcode != SpvOpSpecConstant) return 0;
+    return (*words)[3];
+  }
+
+  // Returns the size in bytes of a value of type |type_id| in a block.  A
+  // matrix, or an array of them, has the layout given by |matrix_stride|,
+  // if not 0, and |row_major|.  Runtime arrays and types which cannot be
+  // in a block have size 0.
+  uint32_t GetSize(uint32_t type_id, uint32_t matrix_stride,
+                   bool row_major) const {
+    const std::vector<uint32_t>* found = Find(type_id);
+    if (!found) return 0;
+    const std::vector<uint32_t>& words = *found;
+    switch (static_cast<SpvOp>(words[0] & SpvOpCodeMask)) {
+      case SpvOpTypeBool:
+        return 4;
+      case SpvOpTypeInt:
+      case SpvOpTypeFloat:
+        return words[2] / 8;
+      case SpvOpTypeVector:
+        return words[3] * GetSize(words[2], 0, false);
+      case SpvOpTypeMatrix: {
+        const uint32_t num_columns = words[3];
+        if (matrix_stride == 0) {
+          return num_columns * GetSize(words[2], 0, false);
+        }
+        const std::vector<uint32_t>* column = Find(words[2]);
+        const uint32_t num_rows = column ? (*column)[3] : 0;
+        return (row_major ? num_rows : num_columns) * matrix_stride;
+      }
+      case SpvOpTypeArray: {
+        const uint32_t stride =
+            GetDecoration(type_id, SpvDecorationArrayStride,
+                          GetSize(words[2], matrix_stride, row_major));
+        return GetConstantValue(words[3]) * stride;
+      }
+      case SpvOpTypeStruct: {
+        uint32_t size = 0;
+        for (uint32_t member = 0; member + 2 < words.size(); ++member) {
+          size = std::max(size, GetMemberEnd(type_id, member));
+        }
+        return size;
+      }
+      case SpvOpTypePointer:
+        // A physical storage buffer pointer.
+        return 8;
+      default:
+        return 0;
+    }
+  }
+
+  // Returns the offset and the size of the member |member| of the struct
+  // |struct_id|.
+  ReflectedBlockMember GetMember(uint32_t struct_id, uint32_t member) const {
+    const uint32_t member_type = (*Find(struct_id))[2 + member];
+    ReflectedBlockMember result;
+    result.offset =
+        GetMemberDecoration(struct_id, member, SpvDecorationOffset, 0);
+    result.size = GetSize(
+        member_type,
+        GetMemberDecoration(struct_id, member, SpvDecorationMatrixStride, 0),
+        HasMemberDecoration(struct_id, member, SpvDecorationRowMajor));
+    return result;
+  }
+
+  // Returns the offset of the end of the member |member| of |struct_id|.
+  uint32_t GetMemberEnd(uint32_t struct_id, uint32_t member) const {
+    const ReflectedBlockMember result = GetMember(struct_id, member);
+    return result.offset + result.size;
+  }
+
+  // Returns the kind of descriptor through which a resource of type
+  // |type_id| is accessed, for a variable in |storage_class|.
+  DescriptorKind GetDescriptorKind(uint32_t type_id,
+                                   uint32_t storage_class) const {
+    const std::vector<uint32_t>* words = Find(type_id);
+    if (!words) return DescriptorKind::kUnknown;
+    switch (static_cast<SpvOp>(words->front() & SpvOpCodeMask)) {
+      case SpvOpTypeSampler:
+        return DescriptorKind::kSampler;
+      case SpvOpTypeSampledImage:
+        return DescriptorKind::kCombinedImageSampler;
+      case SpvOpTypeImage: {
+        const uint32_t dim = (*words)[3];
+        const bool is_storage = (*words)[7] == 2;
+        if (dim == SpvDimBuffer) {
+          return is_storage ? DescriptorKind::kStorageTexelBuffer
+                            : DescriptorKind::kUniformTexelBuffer;
+        }
+        if (dim == SpvDimSubpassData) return DescriptorKind::kInputAttachment;
+        return is_storage ? DescriptorKind::kStorageImage
+                          : DescriptorKind::kSampledImage;
+      }
+      case SpvOpTypeAccelerationStructureNV:
+        return DescriptorKind::kAccelerationStructure;
+      case SpvOpTypeStruct:
+        if (storage_class == SpvStorageClassStorageBuffer ||
+            HasDecoration(type_id, SpvDecorationBufferBlock)) {
+          return DescriptorKind::kStorageBuffer;
+        }
+        return DescriptorKind::kUniformBuffer;
+      default:
+        return DescriptorKind::kUnknown;
+    }
+  }
+
+  // Adds the variable |id| to the reflection, if it is part of the shader
+  // interface.
+  void AddVariable(uint32_t id) {
+    const std::vector<uint32_t>& words = *Find(id);
+    const uint32_t storage_class = words[3];
+    const std::vector<uint32_t>* pointer_type = Find(words[1]);
+    if (!pointer_type || GetOpcode(words[1]) != SpvOpTypePointer) return;
+    const uint32_t type_id = (*pointer_type)[3];
+    ModuleReflection* reflection = section_.reflection;
+
+    switch (storage_class) {
+      case SpvStorageClassUniformConstant:
+      case SpvStorageClassUniform:
+      case SpvStorageClassStorageBuffer: {
+        // Kernel arguments and other variables without a binding are not
+        // accessed through descriptors.
+        if (!HasDecoration(id, SpvDecorationDescriptorSet) &&
+            !HasDecoration(id, SpvDecorationBinding)) {
+          return;
+        }
+        ReflectedDescriptor descriptor;
+        descriptor.variable_id = id;
+        descriptor.set = GetDecoration(id, SpvDecorationDescriptorSet, 0);
+        descriptor.binding = GetDecoration(id, SpvDecorationBinding, 0);
+        descriptor.count = 1;
+        descriptor.type_id = type_id;
+        const SpvOp opcode = GetOpcode(type_id);
+        if (opcode == SpvOpTypeArray || opcode == SpvOpTypeRuntimeArray) {
+          const std::vector<uint32_t>& array = *Find(type_id);
+          descriptor.count =
+              opcode == SpvOpTypeArray ? GetConstantValue(array[3]) : 0;
+          descriptor.type_id = array[2];
+        }
+        descriptor.kind =
+            GetDescriptorKind(descriptor.type_id, storage_class);
+        reflection->descriptors.push_back(descriptor);
+      } break;
+      case SpvStorageClassPushConstant: {
+        ReflectedPushConstant push_constant;
+        push_constant.variable_id = id;
+        push_constant.type_id = type_id;
+        push_constant.size = 0;
+        if (GetOpcode(type_id) == SpvOpTypeStruct) {
+          const size_t num_members = Find(type_id)->size() - 2;
+          for (uint32_t member = 0; member < num_members; ++member) {
+            const ReflectedBlockMember block_member =
+                GetMember(type_id, member);
+            push_constant.members.push_back(block_member);
+            push_constant.size = std::max(
+                push_constant.size, block_member.offset + block_member.size);
+          }
+        }
+        reflection->push_constants.push_back(std::move(push_constant));
+      } break;
+      case SpvStorageClassInput:
+      case SpvStorageClassOutput: {
+        const uint32_t kNone = ReflectedInterfaceVariable::kNone;
+        ReflectedInterfaceVariable variable;
+        variable.variable_id = id;
+        variable.storage_class = storage_class;
+        variable.type_id = type_id;
+        variable.location = GetDecoration(id, SpvDecorationLocation, kNone);
+        variable.component = GetDecoration(id, SpvDecorationComponent, kNone);
+        variable.built_in = GetDecoration(id, SpvDecorationBuiltIn, kNone);
+        reflection->interface_variables.push_back(variable);
+      } break;
+      default:
+        break;
+    }
+  }
+
+  // Adds the specialization constant |id| to the reflection, if it has a
+  // specialization id.
+  void AddSpecConstant(uint32_t id) {
+    if (!HasDecoration(id, SpvDecorationSpecId)) return;
+    const std::vector<uint32_t>& words = *Find(id);
+    ReflectedSpecConstant spec_constant;
+    spec_constant.id = id;
+    spec_constant.spec_id = GetDecoration(id, SpvDecorationSpecId, 0);
+    spec_constant.type_id = words[1];
+    switch (static_cast<SpvOp>(words[0] & SpvOpCodeMask)) {
+      case SpvOpSpecConstantTrue:
+        spec_constant.default_value.push_back(1);
+        break;
+      case SpvOpSpecConstantFalse:
+        spec_constant.default_value.push_back(0);
+        break;
+      default:
+        spec_constant.default_value.assign(words.begin() + 3, words.end());
+        break;
+    }
+    section_.reflection->spec_constants.push_back(std::move(spec_constant));
+  }
+
+  const GlobalSection& section_;
+};
+
+}  // namespace
+
+spv_result_t Reflect(const Context& context, const uint32_t* binary,
+                     size_t binary_size, ModuleReflection* reflection) {
+  *reflection = ModuleReflection();
+  GlobalSection section;
+  section.reflection = reflection;
+  // Everything reflected is declared before the first function, so the
+  // functions are not decoded at all.
+  const spv_result_t result = spvBinaryParse(
+      context.CContext(), &section, binary,
+      GlobalSectionSize(binary, binary_size), nullptr, CollectInstruction,
+      nullptr);
+  if (result != SPV_SUCCESS) return result;
+  ReflectionBuilder(section).Build();
+  return SPV_SUCCESS;
+}
+
+}  // namespace spvtools
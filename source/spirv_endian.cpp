@@ -16,6 +16,15 @@
 
 #include <cstring>
 
+#if defined(__SSE2__) || defined(_M_X64) || \
+    (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define SPIRV_ENDIAN_SSE2 1
+#elif defined(__ARM_NEON)
+#include <arm_neon.h>
+#define SPIRV_ENDIAN_NEON 1
+#endif
+
 enum {
   I32_ENDIAN_LITTLE = 0x03020100ul,
   I32_ENDIAN_BIG = 0x00010203ul,
@@ -41,6 +50,36 @@ uint32_t spvFixWord(const uint32_t word, const spv_endianness_t endian) {
   return word;
 }
 
+void spvFixWords(const uint32_t* words, size_t num_words,
+                 const spv_endianness_t endian, uint32_t* out) {
+  if (spvIsHostEndian(endian)) {
+    if (words != out) memcpy(out, words, num_words * sizeof(uint32_t));
+    return;
+  }
+
+  size_t i = 0;
+#if defined(SPIRV_ENDIAN_SSE2)
+  for (; i + 4 <= num_words; i += 4) {
+    __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(words + i));
+    // Swap the bytes in each 16-bit lane, then the 16-bit lanes in each word.
+    v = _mm_or_si128(_mm_slli_epi16(v, 8), _mm_srli_epi16(v, 8));
+    v = _mm_shufflelo_epi16(v, _MM_SHUFFLE(2, 3, 0, 1));
+    v = _mm_shufflehi_epi16(v, _MM_SHUFFLE(2, 3, 0, 1));
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(out + i), v);
+  }
+#elif defined(SPIRV_ENDIAN_NEON)
+  for (; i + 4 <= num_words; i += 4) {
+    const uint8x16_t v = vreinterpretq_u8_u32(vld1q_u32(words + i));
+    vst1q_u32(out + i, vreinterpretq_u32_u8(vrev32q_u8(v)));
+  }
+#endif
+  for (; i < num_words; ++i) {
+    const uint32_t word = words[i];
+    out[i] = (word & 0x000000ff) << 24 | (word & 0x0000ff00) << 8 |
+             (word & 0x00ff0000) >> 8 | (word & 0xff000000) >> 24;
+  }
+}
+
 uint64_t spvFixDoubleWord(const uint32_t low, const uint32_t high,
                           const spv_endianness_t endian) {
   return (uint64_t(spvFixWord(high, endian)) << 32) | spvFixWord(low, endian);
@@ -20,6 +20,13 @@
 // Converts a word in the specified endianness to the host native endianness.
 uint32_t spvFixWord(const uint32_t word, const spv_endianness_t endianness);
 
+// Converts num_words words in the specified endianness to the host native
+// endianness, writing them to out.  The input and output arrays may be the
+// same, but must not otherwise overlap.  This is much faster than calling
+// spvFixWord on each word.
+void spvFixWords(const uint32_t* words, size_t num_words,
+                 const spv_endianness_t endianness, uint32_t* out);
+
 // Converts a pair of words in the specified endianness to the host native
 // endianness.
 uint64_t spvFixDoubleWord(const uint32_t low, const uint32_t high,
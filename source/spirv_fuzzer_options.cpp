@@ -24,6 +24,7 @@ spv_fuzzer_options_t::spv_fuzzer_options_t()
       random_seed(0),
       replay_validation_enabled(false),
       shrinker_step_limit(kDefaultStepLimit),
+      shrinker_num_threads(1),
       fuzzer_pass_validation_enabled(false) {}
 
 SPIRV_TOOLS_EXPORT spv_fuzzer_options spvFuzzerOptionsCreate() {
@@ -50,6 +51,11 @@ SPIRV_TOOLS_EXPORT void spvFuzzerOptionsSetShrinkerStepLimit(
   options->shrinker_step_limit = shrinker_step_limit;
 }
 
+SPIRV_TOOLS_EXPORT void spvFuzzerOptionsSetShrinkerNumThreads(
+    spv_fuzzer_options options, uint32_t shrinker_num_threads) {
+  options->shrinker_num_threads = shrinker_num_threads;
+}
+
 SPIRV_TOOLS_EXPORT void spvFuzzerOptionsEnableFuzzerPassValidation(
     spv_fuzzer_options options) {
   options->fuzzer_pass_validation_enabled = true;
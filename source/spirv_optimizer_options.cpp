@@ -49,3 +49,13 @@ SPIRV_TOOLS_EXPORT void spvOptimizerOptionsSetPreserveSpecConstants(
     spv_optimizer_options options, bool val) {
   options->preserve_spec_constants_ = val;
 }
+
+SPIRV_TOOLS_EXPORT void spvOptimizerOptionsSetNumThreads(
+    spv_optimizer_options options, uint32_t num_threads) {
+  options->num_threads_ = num_threads;
+}
+
+SPIRV_TOOLS_EXPORT void spvOptimizerOptionsSetTimeBudget(
+    spv_optimizer_options options, uint32_t microseconds) {
+  options->time_budget_ = microseconds;
+}
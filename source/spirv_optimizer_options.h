@@ -19,14 +19,18 @@
 #include "spirv-tools/libspirv.h"
 
 // Manages command line options passed to the SPIR-V Validator. New struct
-// members may be added for any new option.
+// members may be added for any new option.  Members that change the result of
+// optimization must also be added to the key of the optimization cache, in
+// Optimizer::Impl::CacheKey.
 struct spv_optimizer_options_t {
   spv_optimizer_options_t()
       : run_validator_(true),
         val_options_(),
         max_id_bound_(kDefaultMaxIdBound),
         preserve_bindings_(false),
-        preserve_spec_constants_(false) {}
+        preserve_spec_constants_(false),
+        num_threads_(1),
+        time_budget_(0) {}
 
   // When true the validator will be run before optimizations are run.
   bool run_validator_;
@@ -45,5 +49,14 @@ struct spv_optimizer_options_t {
   // When true, all specialization constants within the module should be
   // preserved.
   bool preserve_spec_constants_;
+
+  // The number of threads the optimizer may use, or 0 for one per hardware
+  // thread.
+  uint32_t num_threads_;
+
+  // The time in microseconds after which the passes which are not required
+  // are skipped, or 0 for no limit.  It is not part of the cache key, as a
+  // run which skips passes is not cached.
+  uint32_t time_budget_;
 };
 #endif  // SOURCE_SPIRV_OPTIMIZER_OPTIONS_H_
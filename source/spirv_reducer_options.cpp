@@ -23,7 +23,11 @@ const uint32_t kDefaultStepLimit = 250;
 }  // namespace
 
 spv_reducer_options_t::spv_reducer_options_t()
-    : step_limit(kDefaultStepLimit), fail_on_validation_error(false) {}
+    : step_limit(kDefaultStepLimit),
+      fail_on_validation_error(false),
+      num_threads(1),
+      adaptive_scheduling(false),
+      function_by_function(false) {}
 
 SPIRV_TOOLS_EXPORT spv_reducer_options spvReducerOptionsCreate() {
   return new spv_reducer_options_t();
@@ -42,3 +46,18 @@ SPIRV_TOOLS_EXPORT void spvReducerOptionsSetFailOnValidationError(
     spv_reducer_options options, bool fail_on_validation_error) {
   options->fail_on_validation_error = fail_on_validation_error;
 }
+
+SPIRV_TOOLS_EXPORT void spvReducerOptionsSetNumThreads(
+    spv_reducer_options options, uint32_t num_threads) {
+  options->num_threads = num_threads;
+}
+
+SPIRV_TOOLS_EXPORT void spvReducerOptionsSetAdaptiveScheduling(
+    spv_reducer_options options, bool adaptive_scheduling) {
+  options->adaptive_scheduling = adaptive_scheduling;
+}
+
+SPIRV_TOOLS_EXPORT void spvReducerOptionsSetFunctionByFunction(
+    spv_reducer_options options, bool function_by_function) {
+  options->function_by_function = function_by_function;
+}
@@ -30,6 +30,15 @@ struct spv_reducer_options_t {
 
   // See spvReducerOptionsSetFailOnValidationError.
   bool fail_on_validation_error;
+
+  // See spvReducerOptionsSetNumThreads.
+  uint32_t num_threads;
+
+  // See spvReducerOptionsSetAdaptiveScheduling.
+  bool adaptive_scheduling;
+
+  // See spvReducerOptionsSetFunctionByFunction.
+  bool function_by_function;
 };
 
 #endif  // SOURCE_SPIRV_REDUCER_OPTIONS_H_
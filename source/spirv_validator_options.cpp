@@ -17,6 +17,8 @@
 #include <cassert>
 #include <cstring>
 
+#include "source/util/sha256.h"
+
 bool spvParseUniversalLimitsOptions(const char* s, spv_validator_limit* type) {
   auto match = [s](const char* b) {
     return s && (0 == strncmp(s, b, strlen(b)));
@@ -115,3 +117,56 @@ void spvValidatorOptionsSetSkipBlockLayout(spv_validator_options options,
                                            bool val) {
   options->skip_block_layout = val;
 }
+
+void spvValidatorOptionsSetStructuralOnly(spv_validator_options options,
+                                          bool val) {
+  options->structural_only = val;
+}
+
+void spvValidatorOptionsSetNumThreads(spv_validator_options options,
+                                      uint32_t num_threads) {
+  options->num_threads = num_threads;
+}
+
+void spvValidatorOptionsSetCache(spv_validator_options options,
+                                 spv_validation_cache_lookup_fn_t lookup,
+                                 spv_validation_cache_store_fn_t store,
+                                 void* user_data) {
+  options->cache_lookup = lookup;
+  options->cache_store = store;
+  options->cache_user_data = user_data;
+}
+
+void spvValidatorOptionsSetTimeReport(spv_validator_options options,
+                                      spv_validator_time_report_fn_t report,
+                                      void* user_data) {
+  options->time_report = report;
+  options->time_report_user_data = user_data;
+}
+
+namespace spvtools {
+
+void HashValidatorOptions(const spv_validator_options_t& options,
+                          utils::Sha256* sha) {
+  const validator_universal_limits_t& limits = options.universal_limits_;
+  const uint32_t settings[] = {limits.max_struct_members,
+                               limits.max_struct_depth,
+                               limits.max_local_variables,
+                               limits.max_global_variables,
+                               limits.max_switch_branches,
+                               limits.max_function_args,
+                               limits.max_control_flow_nesting_depth,
+                               limits.max_access_chain_indexes,
+                               limits.max_id_bound,
+                               options.relax_struct_store,
+                               options.relax_logical_pointer,
+                               options.relax_block_layout,
+                               options.uniform_buffer_standard_layout,
+                               options.scalar_block_layout,
+                               options.skip_block_layout,
+                               options.before_hlsl_legalization,
+                               options.structural_only};
+  sha->Update(settings, sizeof(settings));
+}
+
+}  // namespace spvtools
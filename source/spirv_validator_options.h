@@ -36,7 +36,9 @@ struct validator_universal_limits_t {
 };
 
 // Manages command line options passed to the SPIR-V Validator. New struct
-// members may be added for any new option.
+// members may be added for any new option.  Members that change the result of
+// validation must also be added to the keys of the caches, in
+// HashValidatorOptions.
 struct spv_validator_options_t {
   spv_validator_options_t()
       : universal_limits_(),
@@ -46,7 +48,14 @@ struct spv_validator_options_t {
         uniform_buffer_standard_layout(false),
         scalar_block_layout(false),
         skip_block_layout(false),
-        before_hlsl_legalization(false) {}
+        before_hlsl_legalization(false),
+        structural_only(false),
+        num_threads(1),
+        cache_lookup(nullptr),
+        cache_store(nullptr),
+        cache_user_data(nullptr),
+        time_report(nullptr),
+        time_report_user_data(nullptr) {}
 
   validator_universal_limits_t universal_limits_;
   bool relax_struct_store;
@@ -56,6 +65,32 @@ struct spv_validator_options_t {
   bool scalar_block_layout;
   bool skip_block_layout;
   bool before_hlsl_legalization;
+  // Only the checks of the structure of the module are performed.
+  bool structural_only;
+  // The number of threads used to check the functions, or 0 for one per
+  // hardware thread.
+  uint32_t num_threads;
+  // The cache of the modules known to be valid, if |cache_lookup| is not
+  // null.
+  spv_validation_cache_lookup_fn_t cache_lookup;
+  spv_validation_cache_store_fn_t cache_store;
+  void* cache_user_data;
+  // Receives the times of the phases and checks of each validation, if not
+  // null.
+  spv_validator_time_report_fn_t time_report;
+  void* time_report_user_data;
 };
 
+namespace spvtools {
+namespace utils {
+class Sha256;
+}  // namespace utils
+
+// Adds the members of |options| that change the result of validation to
+// |sha|.
+void HashValidatorOptions(const spv_validator_options_t& options,
+                          utils::Sha256* sha);
+
+}  // namespace spvtools
+
 #endif  // SOURCE_SPIRV_VALIDATOR_OPTIONS_H_
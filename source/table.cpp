@@ -16,6 +16,31 @@
 
 #include <utility>
 
+namespace {
+
+// The grammar tables of a context.
+struct GrammarTables {
+  spv_opcode_table opcode_table;
+  spv_operand_table operand_table;
+  spv_ext_inst_table ext_inst_table;
+};
+
+// Returns the grammar tables shared by all the contexts.  The tables are
+// immutable and the same for all the target environments, so they are looked
+// up once per process.
+const GrammarTables& GetGrammarTables() {
+  static const GrammarTables tables = [] {
+    GrammarTables t = {nullptr, nullptr, nullptr};
+    spvOpcodeTableGet(&t.opcode_table, SPV_ENV_UNIVERSAL_1_0);
+    spvOperandTableGet(&t.operand_table, SPV_ENV_UNIVERSAL_1_0);
+    spvExtInstTableGet(&t.ext_inst_table, SPV_ENV_UNIVERSAL_1_0);
+    return t;
+  }();
+  return tables;
+}
+
+}  // namespace
+
 spv_context spvContextCreate(spv_target_env env) {
   switch (env) {
     case SPV_ENV_UNIVERSAL_1_0:
@@ -47,15 +72,11 @@ spv_context spvContextCreate(spv_target_env env) {
       return nullptr;
   }
 
-  spv_opcode_table opcode_table;
-  spv_operand_table operand_table;
-  spv_ext_inst_table ext_inst_table;
-
-  spvOpcodeTableGet(&opcode_table, env);
-  spvOperandTableGet(&operand_table, env);
-  spvExtInstTableGet(&ext_inst_table, env);
-
-  return new spv_context_t{env, opcode_table, operand_table, ext_inst_table,
+  // The only allocation is the context itself, since the tables are shared
+  // and a null consumer does not allocate.
+  const GrammarTables& tables = GetGrammarTables();
+  return new spv_context_t{env, tables.opcode_table, tables.operand_table,
+                           tables.ext_inst_table,
                            nullptr /* a null default consumer */};
 }
 
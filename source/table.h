@@ -67,6 +67,9 @@ typedef struct spv_operand_desc_group_t {
   const spv_operand_type_t type;
   const uint32_t count;
   const spv_operand_desc_t* entries;
+  // Indices into entries, sorted by name.  Indices of entries with the same
+  // name are in increasing order.
+  const uint16_t* name_order;
 } spv_operand_desc_group_t;
 
 typedef struct spv_ext_inst_desc_t {
@@ -81,11 +84,21 @@ typedef struct spv_ext_inst_group_t {
   const spv_ext_inst_type_t type;
   const uint32_t count;
   const spv_ext_inst_desc_t* entries;
+  // Indices into entries, sorted by name.  Indices of entries with the same
+  // name are in increasing order.
+  const uint16_t* name_order;
+  // Indices into entries of the first entry with each instruction number, or
+  // 0xFFFF for the numbers without an entry.
+  const uint32_t value_count;
+  const uint16_t* value_index;
 } spv_ext_inst_group_t;
 
 typedef struct spv_opcode_table_t {
   const uint32_t count;
   const spv_opcode_desc_t* entries;
+  // Indices into entries, sorted by name.  Indices of entries with the same
+  // name are in increasing order.
+  const uint16_t* name_order;
 } spv_opcode_table_t;
 
 typedef struct spv_operand_table_t {
@@ -106,6 +119,8 @@ typedef const spv_opcode_table_t* spv_opcode_table;
 typedef const spv_operand_table_t* spv_operand_table;
 typedef const spv_ext_inst_table_t* spv_ext_inst_table;
 
+// A context refers to the grammar tables, which are immutable and shared by
+// all the contexts of the process.
 struct spv_context_t {
   const spv_target_env target_env;
   const spv_opcode_table opcode_table;
@@ -121,6 +136,9 @@ namespace spvtools {
 void SetContextMessageConsumer(spv_context context, MessageConsumer consumer);
 }  // namespace spvtools
 
+// The tables populated by the functions below are statically allocated and
+// immutable, so they may be shared between threads and outlive any context.
+
 // Populates *table with entries for env.
 spv_result_t spvOpcodeTableGet(spv_opcode_table* table, spv_target_env env);
 
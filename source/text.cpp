@@ -800,6 +800,156 @@ spv_result_t spvTextToBinaryInternal(const spvtools::AssemblyGrammar& grammar,
   return SPV_SUCCESS;
 }
 
+// Holds assembly text read incrementally for spvTextToBinaryStream.  The text
+// that has been read is kept in a buffer, which is available through text().
+class TextStream {
+ public:
+  TextStream(void* user_data, spv_text_read_fn_t read_text)
+      : user_data_(user_data),
+        read_text_(read_text),
+        text_({nullptr, 0}),
+        at_end_(false) {
+    update();
+  }
+
+  // Returns the text in the buffer.  The returned object remains valid for
+  // the lifetime of the stream, and its contents are updated as text is read
+  // or discarded.
+  spv_text text() { return &text_; }
+
+  // Returns true if all the text has been read.
+  bool at_end() const { return at_end_; }
+
+  // Discards the text before |position|, and updates |position| to refer to
+  // the same text afterward.
+  void discardBefore(spv_position_t* position) {
+    buffer_.erase(0, position->index);
+    position->index = 0;
+    update();
+  }
+
+  // Appends more text to the buffer.
+  void read() {
+    const size_t chunk_size = 64 * 1024;
+    const size_t old_size = buffer_.size();
+    buffer_.resize(old_size + chunk_size);
+    const size_t count =
+        std::min(read_text_(user_data_, &buffer_[old_size], chunk_size),
+                 chunk_size);
+    buffer_.resize(old_size + count);
+    if (count == 0) at_end_ = true;
+    update();
+  }
+
+ private:
+  void update() {
+    text_.str = buffer_.c_str();
+    text_.length = buffer_.size();
+  }
+
+  void* user_data_;
+  spv_text_read_fn_t read_text_;
+  std::string buffer_;
+  spv_text_t text_;
+  bool at_end_;
+};
+
+// Returns true if the text at the current position of |context| holds the
+// whole of the next instruction.  That is only known when the instruction is
+// followed by the start of another instruction, since otherwise the end of the
+// text might be in the middle of the instruction.  The position of |context|
+// is left unchanged.
+bool HoldsWholeInstruction(spvtools::AssemblyContext* context) {
+  const spv_position_t start = context->position();
+  bool result = false;
+  std::string word;
+  spv_position_t next_position = {};
+  // The words at the start of the instruction itself are skipped: the opcode
+  // or !<integer>, or the <result-id>, the '=' sign and the opcode.
+  size_t num_leading_words = 1;
+  for (size_t i = 0; context->advance() == SPV_SUCCESS; ++i) {
+    if (i >= num_leading_words && context->isStartOfNewInst()) {
+      result = true;
+      break;
+    }
+    context->getWord(&word, &next_position);
+    if (i == 0 && '%' == word.front()) num_leading_words = 3;
+    context->setPosition(next_position);
+  }
+  context->setPosition(start);
+  return result;
+}
+
+// Translates an assembly language module read from |read_text| into binary
+// form, and writes the binary to |write_binary|.  If a diagnostic is
+// generated, it is not yet marked as being for a text-based input.
+spv_result_t spvTextToBinaryStreamInternal(
+    const spvtools::AssemblyGrammar& grammar,
+    const spvtools::MessageConsumer& consumer, void* user_data,
+    spv_text_read_fn_t read_text, spv_binary_write_fn_t write_binary,
+    const uint32_t options) {
+  if (!read_text || !write_binary) return SPV_ERROR_INVALID_POINTER;
+
+  TextStream stream(user_data, read_text);
+  spvtools::AssemblyContext context(stream.text(), consumer);
+
+  if (!grammar.isValid()) {
+    return SPV_ERROR_INVALID_TABLE;
+  }
+  if (options & SPV_TEXT_TO_BINARY_OPTION_PRESERVE_NUMERIC_IDS) {
+    return context.diagnostic(SPV_UNSUPPORTED)
+           << "Preserving numeric ids is not supported when assembling a "
+              "stream.";
+  }
+
+  // The Id bound is not known until the end, so the header is written again
+  // then.
+  uint32_t header[SPV_INDEX_INSTRUCTION];
+  if (auto error = SetHeader(grammar.target_env(), 0, header)) return error;
+  if (auto error = write_binary(user_data, 0, header, SPV_INDEX_INSTRUCTION)) {
+    return context.diagnostic(error)
+           << "Error from binary callback: " << error;
+  }
+
+  size_t offset = SPV_INDEX_INSTRUCTION;
+  spv_instruction_t inst;
+  while (true) {
+    // Make sure the whole of the next instruction has been read, so it is
+    // encoded exactly as it would be if the whole text were in memory.
+    while (!stream.at_end() && !HoldsWholeInstruction(&context)) {
+      spv_position_t position = context.position();
+      stream.discardBefore(&position);
+      context.setPosition(position);
+      stream.read();
+    }
+
+    // Skip past whitespace and comments.
+    if (context.advance()) break;
+
+    inst = spv_instruction_t();
+    if (spvTextEncodeOpcode(grammar, &context, &inst)) {
+      return SPV_ERROR_INVALID_TEXT;
+    }
+    if (auto error = write_binary(user_data, offset, inst.words.data(),
+                                  inst.words.size())) {
+      return context.diagnostic(error)
+             << "Error from binary callback: " << error;
+    }
+    offset += inst.words.size();
+  }
+
+  if (auto error =
+          SetHeader(grammar.target_env(), context.getBound(), header)) {
+    return error;
+  }
+  if (auto error = write_binary(user_data, 0, header, SPV_INDEX_INSTRUCTION)) {
+    return context.diagnostic(error)
+           << "Error from binary callback: " << error;
+  }
+
+  return SPV_SUCCESS;
+}
+
 }  // anonymous namespace
 
 spv_result_t spvTextToBinary(const spv_const_context context,
@@ -833,6 +983,28 @@ spv_result_t spvTextToBinaryWithOptions(const spv_const_context context,
   return result;
 }
 
+spv_result_t spvTextToBinaryStream(const spv_const_context context,
+                                   void* user_data,
+                                   spv_text_read_fn_t read_text,
+                                   spv_binary_write_fn_t write_binary,
+                                   const uint32_t options,
+                                   spv_diagnostic* pDiagnostic) {
+  spv_context_t hijack_context = *context;
+  if (pDiagnostic) {
+    *pDiagnostic = nullptr;
+    spvtools::UseDiagnosticAsMessageConsumer(&hijack_context, pDiagnostic);
+  }
+
+  spvtools::AssemblyGrammar grammar(&hijack_context);
+
+  spv_result_t result =
+      spvTextToBinaryStreamInternal(grammar, hijack_context.consumer, user_data,
+                                    read_text, write_binary, options);
+  if (pDiagnostic && *pDiagnostic) (*pDiagnostic)->isTextSource = true;
+
+  return result;
+}
+
 void spvTextDestroy(spv_text text) {
   if (text) {
     if (text->str) delete[] text->str;
@@ -18,6 +18,7 @@
 #include <cassert>
 #include <cstdlib>
 #include <cstring>
+#include <set>
 #include <tuple>
 
 #include "source/assembly_grammar.h"
@@ -30,61 +31,117 @@
 #include "source/util/hex_float.h"
 #include "source/util/parse_number.h"
 
+#if defined(__SSE2__) || defined(_M_X64) || \
+    (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define SPIRV_TEXT_SSE2 1
+#elif defined(__ARM_NEON)
+#include <arm_neon.h>
+#define SPIRV_TEXT_NEON 1
+#endif
+
 namespace spvtools {
 namespace {
 
+// The characters which end a line.
+const char kLineEnds[] = {'\n', '\0'};
+
+// The characters which may end a word or change how the rest of it is read.
+const char kWordBoundaries[] = {' ', '\t', '\n', '\r', ';', '"', '\\', '\0'};
+
+const size_t kMaxTargets = sizeof(kWordBoundaries);
+
+// Returns the index of the first character of |str| in [|index|, |length|)
+// which is one of the |num_targets| characters of |targets|, or |length| if
+// there is none.  Sixteen characters are compared at a time where the target
+// supports it.
+size_t FindFirstOf(const char* str, size_t index, size_t length,
+                   const char* targets, size_t num_targets) {
+  assert(num_targets <= kMaxTargets);
+#if defined(SPIRV_TEXT_SSE2)
+  __m128i target_vectors[kMaxTargets];
+  for (size_t t = 0; t < num_targets; ++t) {
+    target_vectors[t] = _mm_set1_epi8(targets[t]);
+  }
+  for (; index + 16 <= length; index += 16) {
+    const __m128i chars =
+        _mm_loadu_si128(reinterpret_cast<const __m128i*>(str + index));
+    __m128i matches = _mm_setzero_si128();
+    for (size_t t = 0; t < num_targets; ++t) {
+      matches = _mm_or_si128(matches, _mm_cmpeq_epi8(chars, target_vectors[t]));
+    }
+    // The block has a match: find it below.
+    if (_mm_movemask_epi8(matches)) break;
+  }
+#elif defined(SPIRV_TEXT_NEON)
+  uint8x16_t target_vectors[kMaxTargets];
+  for (size_t t = 0; t < num_targets; ++t) {
+    target_vectors[t] = vdupq_n_u8(static_cast<uint8_t>(targets[t]));
+  }
+  for (; index + 16 <= length; index += 16) {
+    const uint8x16_t chars =
+        vld1q_u8(reinterpret_cast<const uint8_t*>(str + index));
+    uint8x16_t matches = vdupq_n_u8(0);
+    for (size_t t = 0; t < num_targets; ++t) {
+      matches = vorrq_u8(matches, vceqq_u8(chars, target_vectors[t]));
+    }
+    const uint8x8_t folded =
+        vorr_u8(vget_low_u8(matches), vget_high_u8(matches));
+    if (vget_lane_u64(vreinterpret_u64_u8(folded), 0)) break;
+  }
+#endif
+  while (index < length && !memchr(targets, str[index], num_targets)) {
+    ++index;
+  }
+  return index;
+}
+
 // Advances |text| to the start of the next line and writes the new position to
 // |position|.
 spv_result_t advanceLine(spv_text text, spv_position position) {
+  const size_t end = FindFirstOf(text->str, position->index, text->length,
+                                 kLineEnds, sizeof(kLineEnds));
+  position->column += end - position->index;
+  position->index = end;
+  if (end >= text->length || text->str[end] == '\0') return SPV_END_OF_STREAM;
+  position->column = 0;
+  position->line++;
+  position->index++;
+  return SPV_SUCCESS;
+}
+
+// Advances |text| to first non white space character and writes the new
+// position to |position|.
+// If a null terminator is found during the text advance, SPV_END_OF_STREAM is
+// returned, SPV_SUCCESS otherwise. No error checking is performed on the
+// parameters, its the users responsibility to ensure these are non null.
+spv_result_t advance(spv_text text, spv_position position) {
+  // NOTE: Consume white space, otherwise don't advance.
   while (true) {
     if (position->index >= text->length) return SPV_END_OF_STREAM;
     switch (text->str[position->index]) {
       case '\0':
         return SPV_END_OF_STREAM;
+      case ';':
+        if (spv_result_t error = advanceLine(text, position)) return error;
+        break;
+      case ' ':
+      case '\t':
+      case '\r':
+        position->column++;
+        position->index++;
+        break;
       case '\n':
         position->column = 0;
         position->line++;
         position->index++;
-        return SPV_SUCCESS;
-      default:
-        position->column++;
-        position->index++;
         break;
+      default:
+        return SPV_SUCCESS;
     }
   }
 }
 
-// Advances |text| to first non white space character and writes the new
-// position to |position|.
-// If a null terminator is found during the text advance, SPV_END_OF_STREAM is
-// returned, SPV_SUCCESS otherwise. No error checking is performed on the
-// parameters, its the users responsibility to ensure these are non null.
-spv_result_t advance(spv_text text, spv_position position) {
-  // NOTE: Consume white space, otherwise don't advance.
-  if (position->index >= text->length) return SPV_END_OF_STREAM;
-  switch (text->str[position->index]) {
-    case '\0':
-      return SPV_END_OF_STREAM;
-    case ';':
-      if (spv_result_t error = advanceLine(text, position)) return error;
-      return advance(text, position);
-    case ' ':
-    case '\t':
-    case '\r':
-      position->column++;
-      position->index++;
-      return advance(text, position);
-    case '\n':
-      position->column = 0;
-      position->line++;
-      position->index++;
-      return advance(text, position);
-    default:
-      break;
-  }
-  return SPV_SUCCESS;
-}
-
 // Fetches the next word from the given text stream starting from the given
 // *position. On success, writes the decoded word into *word and updates
 // *position to the location past the returned word.
@@ -102,6 +159,15 @@ spv_result_t getWord(spv_text text, spv_position position, std::string* word) {
 
   // NOTE: Assumes first character is not white space!
   while (true) {
+    if (!escaping) {
+      // Skip the run of characters which can neither end the word nor change
+      // how it is read.
+      const size_t next =
+          FindFirstOf(text->str, position->index, text->length,
+                      kWordBoundaries, sizeof(kWordBoundaries));
+      position->column += next - position->index;
+      position->index = next;
+    }
     if (position->index >= text->length) {
       word->assign(text->str + start_index, text->str + position->index);
       return SPV_SUCCESS;
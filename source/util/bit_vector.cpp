@@ -14,23 +14,39 @@
 
 #include "source/util/bit_vector.h"
 
+#include <algorithm>
 #include <cassert>
 #include <iostream>
 
 namespace spvtools {
 namespace utils {
 
-void BitVector::ReportDensity(std::ostream& out) {
-  uint32_t count = 0;
+uint32_t BitVector::CountSetBits(BitContainer word) {
+#if defined(__GNUC__) || defined(__clang__)
+  return static_cast<uint32_t>(__builtin_popcountll(word));
+#else
+  // Adds the bits in parallel within 2, 4 and 8 bit fields, then sums the
+  // bytes with a multiplication.
+  word = word - ((word >> 1) & 0x5555555555555555ULL);
+  word = (word & 0x3333333333333333ULL) + ((word >> 2) & 0x3333333333333333ULL);
+  word = (word + (word >> 4)) & 0x0F0F0F0F0F0F0F0FULL;
+  return static_cast<uint32_t>((word * 0x0101010101010101ULL) >> 56);
+#endif
+}
 
-  for (BitContainer e : bits_) {
-    while (e != 0) {
-      if ((e & 1) != 0) {
-        ++count;
-      }
-      e = e >> 1;
-    }
-  }
+uint32_t BitVector::CountTrailingZeros(BitContainer word) {
+  assert(word != 0 && "There is no bit set.");
+#if defined(__GNUC__) || defined(__clang__)
+  return static_cast<uint32_t>(__builtin_ctzll(word));
+#else
+  // The bits below the lowest bit set are the ones set in |word| - 1 and not
+  // in |word|.
+  return CountSetBits((word & (0 - word)) - 1);
+#endif
+}
+
+void BitVector::ReportDensity(std::ostream& out) {
+  uint32_t count = Count();
 
   out << "count=" << count
       << ", total size (bytes)=" << bits_.size() * sizeof(BitContainer)
@@ -61,19 +77,64 @@ bool BitVector::Or(const BitVector& other) {
   return modified;
 }
 
+bool BitVector::And(const BitVector& other) {
+  bool modified = false;
+  size_t common_size = std::min(bits_.size(), other.bits_.size());
+
+  for (size_t i = 0; i < common_size; ++i) {
+    BitContainer temp = bits_[i] & other.bits_[i];
+    modified |= temp != bits_[i];
+    bits_[i] = temp;
+  }
+
+  // The words past the end of |other| are all 0.
+  for (size_t i = common_size; i < bits_.size(); ++i) {
+    modified |= bits_[i] != 0;
+    bits_[i] = 0;
+  }
+
+  return modified;
+}
+
+bool BitVector::AndNot(const BitVector& other) {
+  bool modified = false;
+  size_t common_size = std::min(bits_.size(), other.bits_.size());
+
+  for (size_t i = 0; i < common_size; ++i) {
+    BitContainer temp = bits_[i] & ~other.bits_[i];
+    modified |= temp != bits_[i];
+    bits_[i] = temp;
+  }
+
+  return modified;
+}
+
+uint32_t BitVector::Count() const {
+  uint32_t count = 0;
+  for (BitContainer e : bits_) {
+    count += CountSetBits(e);
+  }
+  return count;
+}
+
+uint32_t BitVector::CountBefore(uint32_t i) const {
+  uint32_t element_index = i / kBitContainerSize;
+  uint32_t bit_in_element = i % kBitContainerSize;
+
+  uint32_t count = 0;
+  for (uint32_t e = 0; e < element_index && e < bits_.size(); ++e) {
+    count += CountSetBits(bits_[e]);
+  }
+  if (element_index < bits_.size()) {
+    BitContainer below = (static_cast<BitContainer>(1) << bit_in_element) - 1;
+    count += CountSetBits(bits_[element_index] & below);
+  }
+  return count;
+}
+
 std::ostream& operator<<(std::ostream& out, const BitVector& bv) {
   out << "{";
-  for (uint32_t i = 0; i < bv.bits_.size(); ++i) {
-    BitVector::BitContainer b = bv.bits_[i];
-    uint32_t j = 0;
-    while (b != 0) {
-      if (b & 1) {
-        out << ' ' << i * BitVector::kBitContainerSize + j;
-      }
-      ++j;
-      b = b >> 1;
-    }
-  }
+  bv.ForEachSetBit([&out](uint32_t i) { out << ' ' << i; });
   out << "}";
   return out;
 }
@@ -17,14 +17,17 @@
 
 #include <cstdint>
 #include <iosfwd>
-#include <vector>
+
+#include "source/util/small_vector.h"
 
 namespace spvtools {
 namespace utils {
 
 // Implements a bit vector class.
 //
-// All bits default to zero, and the upper bound is 2^32-1.
+// All bits default to zero, and the upper bound is 2^32-1.  The first 64 bits
+// are stored inline, so a bit vector created with a |reserved_size| of at most
+// 64 does not allocate until a bit past them is set.
 class BitVector {
  private:
   using BitContainer = uint64_t;
@@ -109,8 +112,43 @@ class BitVector {
   // |this|.  Return true if |this| changed.
   bool Or(const BitVector& that);
 
+  // Performs a bitwise-and operation on |this| and |that|, storing the result
+  // in |this|.  Return true if |this| changed.
+  bool And(const BitVector& that);
+
+  // Clears in |this| the bits which are set in |that|.  Return true if |this|
+  // changed.
+  bool AndNot(const BitVector& that);
+
+  // Returns the number of bits set to 1.
+  uint32_t Count() const;
+
+  // Returns the number of bits set to 1 before the |i|th bit.
+  uint32_t CountBefore(uint32_t i) const;
+
+  // Calls |f| on the index of each bit set to 1, in increasing order.  |f|
+  // must not modify the bit vector.
+  template <typename Functor>
+  void ForEachSetBit(Functor f) const {
+    for (uint32_t i = 0; i < bits_.size(); ++i) {
+      BitContainer word = bits_[i];
+      while (word != 0) {
+        f(i * kBitContainerSize + CountTrailingZeros(word));
+        // Clear the lowest bit set.
+        word &= word - 1;
+      }
+    }
+  }
+
  private:
-  std::vector<BitContainer> bits_;
+  // Returns the number of bits set to 1 in |word|.
+  static uint32_t CountSetBits(BitContainer word);
+
+  // Returns the index of the lowest bit set to 1 in |word|, which must not be
+  // 0.
+  static uint32_t CountTrailingZeros(BitContainer word);
+
+  SmallVector<BitContainer, 1> bits_;
 };
 
 }  // namespace utils
@@ -0,0 +1,124 @@
+// Copyright (c) 2019 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "source/util/node_pool.h"
+
+#include <algorithm>
+#include <cassert>
+#include <new>
+
+namespace spvtools {
+namespace utils {
+namespace {
+
+// The number of nodes in the first slab of a pool, and in its largest slabs.
+// Each slab is twice as large as the previous one, so that small modules do
+// not take much memory, and large ones do not take many slabs.
+const size_t kMinSlabNodes = 64;
+const size_t kMaxSlabNodes = 4096;
+
+}  // namespace
+
+NodePool::NodePool(size_t node_size)
+    : node_size_(node_size),
+      slot_size_(sizeof(Header) +
+                 (std::max(node_size, sizeof(FreeSlot)) + sizeof(Header) - 1) /
+                     sizeof(Header) * sizeof(Header)),
+      slab_next_(nullptr),
+      slab_end_(nullptr),
+      free_slots_(nullptr),
+      num_run_nodes_(0),
+      num_live_nodes_(0),
+      released_(false) {}
+
+void* NodePool::Allocate(NodePool* pool, size_t size) {
+  Header* header;
+  if (pool != nullptr && size == pool->node_size_) {
+    header = static_cast<Header*>(pool->AllocateNode());
+  } else {
+    header = static_cast<Header*>(::operator new(sizeof(Header) + size));
+    pool = nullptr;
+  }
+  header->pool = pool;
+  return header + 1;
+}
+
+void NodePool::Free(void* node) {
+  if (node == nullptr) return;
+  Header* header = static_cast<Header*>(node) - 1;
+  if (header->pool == nullptr) {
+    ::operator delete(header);
+  } else {
+    header->pool->FreeSlotOf(header);
+  }
+}
+
+void NodePool::Release() {
+  assert(!released_ && "The pool is released twice.");
+  released_ = true;
+  if (num_live_nodes_ == 0) delete this;
+}
+
+void NodePool::Reserve(size_t num_nodes) {
+  const size_t num_free_nodes =
+      static_cast<size_t>(slab_end_ - slab_next_) / slot_size_;
+  if (num_free_nodes >= num_nodes) return;
+  slabs_.emplace_back(new char[num_nodes * slot_size_]);
+  slab_next_ = slabs_.back().get();
+  slab_end_ = slab_next_ + num_nodes * slot_size_;
+}
+
+void NodePool::ReserveRun(size_t num_nodes) {
+  num_run_nodes_ = std::max(num_run_nodes_, num_nodes);
+  Reserve(num_run_nodes_);
+}
+
+void* NodePool::AllocateNode() {
+  ++num_live_nodes_;
+  if (num_run_nodes_ > 0) {
+    --num_run_nodes_;
+  } else if (free_slots_ != nullptr) {
+    Header* header = reinterpret_cast<Header*>(free_slots_) - 1;
+    free_slots_ = free_slots_->next;
+    return header;
+  }
+  if (slab_next_ == slab_end_) {
+    const size_t num_nodes =
+        std::min(kMinSlabNodes << std::min(slabs_.size(), size_t(6)),
+                 kMaxSlabNodes);
+    slabs_.emplace_back(new char[num_nodes * slot_size_]);
+    slab_next_ = slabs_.back().get();
+    slab_end_ = slab_next_ + num_nodes * slot_size_;
+  }
+  void* slot = slab_next_;
+  slab_next_ += slot_size_;
+  return slot;
+}
+
+void NodePool::FreeSlotOf(Header* header) {
+  assert(num_live_nodes_ > 0 && "A node is freed twice.");
+  --num_live_nodes_;
+  if (released_) {
+    // Nobody allocates from the pool any more, so the node is only given back
+    // with the slabs.
+    if (num_live_nodes_ == 0) delete this;
+    return;
+  }
+  FreeSlot* slot = reinterpret_cast<FreeSlot*>(header + 1);
+  slot->next = free_slots_;
+  free_slots_ = slot;
+}
+
+}  // namespace utils
+}  // namespace spvtools
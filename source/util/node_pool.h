@@ -0,0 +1,111 @@
+// Copyright (c) 2019 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef SOURCE_UTIL_NODE_POOL_H_
+#define SOURCE_UTIL_NODE_POOL_H_
+
+#include <cstddef>
+#include <memory>
+#include <vector>
+
+namespace spvtools {
+namespace utils {
+
+// A pool of memory for many nodes of the same size, such as the instructions
+// of a module.  The nodes are carved out of large slabs, and a freed node is
+// kept for the next allocation instead of being given back to the heap.  The
+// slabs are released all at once when the pool is destroyed.
+//
+// Every node starts with a header naming its pool, so that |Free| does not
+// need to be told where a node comes from.  A node of another size, or one
+// allocated without a pool, comes from the heap.
+//
+// The pool is destroyed once its owner called |Release| and every node is
+// freed, so nodes may outlive the owner.  It is not thread-safe.
+class NodePool {
+ public:
+  // Creates a pool for nodes of |node_size| bytes.
+  explicit NodePool(size_t node_size);
+
+  NodePool(const NodePool&) = delete;
+  NodePool& operator=(const NodePool&) = delete;
+
+  // Returns memory for a node of |size| bytes from |pool|, or from the heap if
+  // |pool| is null.
+  static void* Allocate(NodePool* pool, size_t size);
+
+  // Frees |node|, returned by |Allocate|.  Does nothing if |node| is null.
+  static void Free(void* node);
+
+  // Makes room for |num_nodes| more nodes in a single slab, when many nodes
+  // are about to be allocated, such as when a module is loaded.
+  void Reserve(size_t num_nodes);
+
+  // Makes the next |num_nodes| nodes adjacent in a single slab, instead of
+  // reusing the freed nodes scattered over the slabs.  A run of nodes which
+  // are allocated together and read in order, such as the instructions of a
+  // cloned block, is then read sequentially.
+  void ReserveRun(size_t num_nodes);
+
+  // Gives up the ownership of the pool.  Must be called exactly once, instead
+  // of deleting the pool.
+  void Release();
+
+  // Returns the number of nodes allocated from the pool and not freed.
+  size_t num_live_nodes() const { return num_live_nodes_; }
+
+  // Returns the number of slabs allocated by the pool.
+  size_t num_slabs() const { return slabs_.size(); }
+
+ private:
+  // The header preceding each node.  Its size keeps the node aligned like
+  // memory from the heap.
+  union Header {
+    NodePool* pool;
+    std::max_align_t alignment;
+  };
+
+  // A freed node, in the list of the nodes to reuse.
+  struct FreeSlot {
+    FreeSlot* next;
+  };
+
+  ~NodePool() = default;
+
+  // Returns memory for a node of |node_size_| bytes.
+  void* AllocateNode();
+
+  // Puts the node following |header| back in the pool.
+  void FreeSlotOf(Header* header);
+
+  // The size of the nodes, and the size of the memory of each node, including
+  // its header.
+  const size_t node_size_;
+  const size_t slot_size_;
+  std::vector<std::unique_ptr<char[]>> slabs_;
+  // The part of the last slab that no node has used yet.
+  char* slab_next_;
+  char* slab_end_;
+  FreeSlot* free_slots_;
+  // The number of nodes still to allocate from the slab, as asked by
+  // |ReserveRun|.
+  size_t num_run_nodes_;
+  size_t num_live_nodes_;
+  bool released_;
+};
+
+}  // namespace utils
+}  // namespace spvtools
+
+#endif  // SOURCE_UTIL_NODE_POOL_H_
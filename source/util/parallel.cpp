@@ -0,0 +1,56 @@
+// Copyright (c) 2019 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "source/util/parallel.h"
+
+#include <algorithm>
+#include <atomic>
+#include <thread>
+#include <vector>
+
+namespace spvtools {
+namespace utils {
+
+uint32_t ResolveNumThreads(uint32_t num_threads) {
+  if (num_threads == 0) {
+    // hardware_concurrency() may return 0 if the value is not computable.
+    num_threads = std::thread::hardware_concurrency();
+  }
+  return std::max(num_threads, 1u);
+}
+
+void ParallelFor(size_t count, uint32_t num_threads,
+                 const std::function<void(size_t)>& fn) {
+  const size_t num_workers =
+      std::min(static_cast<size_t>(ResolveNumThreads(num_threads)), count);
+  if (num_workers <= 1) {
+    for (size_t i = 0; i < count; ++i) fn(i);
+    return;
+  }
+
+  // Each thread repeatedly claims the next unprocessed index.
+  std::atomic<size_t> next_index(0);
+  auto work = [&next_index, count, &fn]() {
+    for (size_t i = next_index++; i < count; i = next_index++) fn(i);
+  };
+
+  std::vector<std::thread> threads;
+  threads.reserve(num_workers - 1);
+  for (size_t i = 1; i < num_workers; ++i) threads.emplace_back(work);
+  work();
+  for (auto& thread : threads) thread.join();
+}
+
+}  // namespace utils
+}  // namespace spvtools
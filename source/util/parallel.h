@@ -0,0 +1,41 @@
+// Copyright (c) 2019 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef SOURCE_UTIL_PARALLEL_H_
+#define SOURCE_UTIL_PARALLEL_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+
+namespace spvtools {
+namespace utils {
+
+// Returns the number of threads to use when |num_threads| threads are
+// requested.  A request for 0 threads means one thread per hardware thread.
+// The result is always at least 1.
+uint32_t ResolveNumThreads(uint32_t num_threads);
+
+// Calls |fn| once for each index in [0, |count|), spreading the calls over at
+// most |num_threads| threads, one of which is the calling thread.  Returns
+// once every call has completed.  Calls for different indices may run
+// concurrently, in any order, so |fn| must only write to state owned by its
+// index.  If |num_threads| is 0, one thread per hardware thread is used.
+void ParallelFor(size_t count, uint32_t num_threads,
+                 const std::function<void(size_t)>& fn);
+
+}  // namespace utils
+}  // namespace spvtools
+
+#endif  // SOURCE_UTIL_PARALLEL_H_
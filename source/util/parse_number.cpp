@@ -14,12 +14,15 @@
 
 #include "source/util/parse_number.h"
 
+#include <cfloat>
 #include <functional>
 #include <iomanip>
+#include <limits>
 #include <memory>
 #include <sstream>
 #include <string>
 #include <tuple>
+#include <type_traits>
 
 #include "source/util/hex_float.h"
 #include "source/util/make_unique.h"
@@ -52,6 +55,155 @@ class ErrorMsgStream {
   // destructor is called.
   std::string* error_msg_sink_;
 };
+
+// The result of parsing a literal without a stream.
+enum class FastParseResult {
+  kSuccess,
+  kFailure,
+  // The literal is not in one of the forms handled without a stream.
+  kNotHandled,
+};
+
+// Returns the value of the digit |c| in base |base|, or -1 if |c| is not a
+// digit in that base.
+int DigitValue(char c, uint64_t base) {
+  if (c >= '0' && c <= '9') return c - '0';
+  if (base == 16) {
+    if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+    if (c >= 'A' && c <= 'F') return c - 'A' + 10;
+  }
+  return -1;
+}
+
+// Parses |text| as an integer of type |T|, int64_t or uint64_t, without
+// allocating or using a stream, if it is a decimal integer, or a hexadecimal
+// integer without a sign.  Other forms, such as octal integers, are left to
+// ParseNumber.
+template <typename T>
+FastParseResult ParseIntegerFast(const char* text, T* value) {
+  const char* p = text;
+  const bool is_negative = *p == '-';
+  if (is_negative) {
+    if (!std::is_signed<T>::value) return FastParseResult::kNotHandled;
+    ++p;
+  }
+
+  uint64_t base = 10;
+  if (p[0] == '0' && (p[1] == 'x' || p[1] == 'X')) {
+    if (is_negative) return FastParseResult::kNotHandled;
+    base = 16;
+    p += 2;
+  } else if (p[0] == '0' && p[1] != '\0') {
+    return FastParseResult::kNotHandled;
+  }
+  if (*p == '\0') return FastParseResult::kNotHandled;
+
+  uint64_t magnitude = 0;
+  for (; *p != '\0'; ++p) {
+    const int digit = DigitValue(*p, base);
+    if (digit < 0) return FastParseResult::kNotHandled;
+    if (magnitude > (std::numeric_limits<uint64_t>::max() - digit) / base) {
+      return FastParseResult::kFailure;
+    }
+    magnitude = magnitude * base + digit;
+  }
+
+  const uint64_t max_magnitude =
+      static_cast<uint64_t>(std::numeric_limits<T>::max()) +
+      (is_negative ? 1 : 0);
+  if (magnitude > max_magnitude) return FastParseResult::kFailure;
+  *value = static_cast<T>(is_negative ? 0 - magnitude : magnitude);
+  return FastParseResult::kSuccess;
+}
+
+// Parses |text| into the integer |value|, without a stream if possible.
+// Returns true on success.
+template <typename T>
+bool ParseInteger(const char* text, T* value) {
+  switch (ParseIntegerFast(text, value)) {
+    case FastParseResult::kSuccess:
+      return true;
+    case FastParseResult::kFailure:
+      return false;
+    case FastParseResult::kNotHandled:
+      break;
+  }
+  return ParseNumber(text, value);
+}
+
+// Parses the decimal literal |text| into the float or double |value|, without
+// allocating or using a stream, if its digits fit exactly in the significand
+// of |T| and the power of ten of its exponent is exact in |T|.  Then the
+// value is a single multiplication or division of exact values, which IEEE
+// arithmetic rounds correctly.  Hexadecimal floats and the other literals are
+// left to the stream operators of HexFloat.
+template <typename T>
+FastParseResult ParseFloatFast(const char* text, T* value) {
+#if defined(FLT_EVAL_METHOD) && FLT_EVAL_METHOD == 0
+  // The largest significand and power of ten which are exact in |T|.
+  const uint64_t max_significand = uint64_t(1)
+                                   << std::numeric_limits<T>::digits;
+  const int max_exponent = sizeof(T) == sizeof(float) ? 10 : 22;
+
+  const char* p = text;
+  const bool is_negative = *p == '-';
+  if (is_negative) ++p;
+
+  // Reads the significand, as an integer with |exponent| the power of ten to
+  // scale it by.
+  uint64_t significand = 0;
+  int exponent = 0;
+  bool seen_digit = false;
+  for (; *p >= '0' && *p <= '9'; ++p) {
+    significand = significand * 10 + (*p - '0');
+    if (significand > max_significand) return FastParseResult::kNotHandled;
+    seen_digit = true;
+  }
+  if (!seen_digit) return FastParseResult::kNotHandled;
+  if (*p == '.') {
+    ++p;
+    if (*p < '0' || *p > '9') return FastParseResult::kNotHandled;
+    for (; *p >= '0' && *p <= '9'; ++p) {
+      significand = significand * 10 + (*p - '0');
+      if (significand > max_significand) return FastParseResult::kNotHandled;
+      --exponent;
+    }
+  }
+  if (*p == 'e' || *p == 'E') {
+    ++p;
+    const bool exponent_is_negative = *p == '-';
+    if (*p == '-' || *p == '+') ++p;
+    if (*p < '0' || *p > '9') return FastParseResult::kNotHandled;
+    int written_exponent = 0;
+    for (; *p >= '0' && *p <= '9'; ++p) {
+      written_exponent = written_exponent * 10 + (*p - '0');
+      if (written_exponent > 2 * max_exponent) {
+        return FastParseResult::kNotHandled;
+      }
+    }
+    exponent += exponent_is_negative ? -written_exponent : written_exponent;
+  }
+  if (*p != '\0') return FastParseResult::kNotHandled;
+  if (exponent > max_exponent || exponent < -max_exponent) {
+    return FastParseResult::kNotHandled;
+  }
+
+  T power_of_ten = 1;
+  for (int i = 0; i < (exponent < 0 ? -exponent : exponent); ++i) {
+    power_of_ten *= 10;
+  }
+  T result = static_cast<T>(significand);
+  result = exponent < 0 ? result / power_of_ten : result * power_of_ten;
+  *value = is_negative ? -result : result;
+  return FastParseResult::kSuccess;
+#else
+  // Without IEEE evaluation of |T|, the fast path could round twice.
+  (void)text;
+  (void)value;
+  return FastParseResult::kNotHandled;
+#endif
+}
+
 }  // namespace
 
 EncodeNumberStatus ParseAndEncodeIntegerNumber(
@@ -91,7 +243,7 @@ EncodeNumberStatus ParseAndEncodeIntegerNumber(
   if (is_negative) {
     int64_t decoded_signed = 0;
 
-    if (!ParseNumber(text, &decoded_signed)) {
+    if (!ParseInteger(text, &decoded_signed)) {
       ErrorMsgStream(error_msg) << "Invalid signed integer literal: " << text;
       return EncodeNumberStatus::kInvalidText;
     }
@@ -107,7 +259,7 @@ EncodeNumberStatus ParseAndEncodeIntegerNumber(
     decoded_bits = decoded_signed;
   } else {
     // There's no leading minus sign, so parse it as an unsigned integer.
-    if (!ParseNumber(text, &decoded_bits)) {
+    if (!ParseInteger(text, &decoded_bits)) {
       ErrorMsgStream(error_msg) << "Invalid unsigned integer literal: " << text;
       return EncodeNumberStatus::kInvalidText;
     }
@@ -160,6 +312,11 @@ EncodeNumberStatus ParseAndEncodeFloatingPointNumber(
       return EncodeNumberStatus::kSuccess;
     } break;
     case 32: {
+      float fast_value = 0.0f;
+      if (ParseFloatFast(text, &fast_value) == FastParseResult::kSuccess) {
+        emit(BitwiseCast<uint32_t>(fast_value));
+        return EncodeNumberStatus::kSuccess;
+      }
       HexFloat<FloatProxy<float>> fVal(0.0f);
       if (!ParseNumber(text, &fVal)) {
         ErrorMsgStream(error_msg) << "Invalid 32-bit float literal: " << text;
@@ -169,12 +326,18 @@ EncodeNumberStatus ParseAndEncodeFloatingPointNumber(
       return EncodeNumberStatus::kSuccess;
     } break;
     case 64: {
-      HexFloat<FloatProxy<double>> dVal(0.0);
-      if (!ParseNumber(text, &dVal)) {
-        ErrorMsgStream(error_msg) << "Invalid 64-bit float literal: " << text;
-        return EncodeNumberStatus::kInvalidText;
+      uint64_t decoded_val = 0;
+      double fast_value = 0.0;
+      if (ParseFloatFast(text, &fast_value) == FastParseResult::kSuccess) {
+        decoded_val = BitwiseCast<uint64_t>(fast_value);
+      } else {
+        HexFloat<FloatProxy<double>> dVal(0.0);
+        if (!ParseNumber(text, &dVal)) {
+          ErrorMsgStream(error_msg) << "Invalid 64-bit float literal: " << text;
+          return EncodeNumberStatus::kInvalidText;
+        }
+        decoded_val = BitwiseCast<uint64_t>(dVal);
       }
-      uint64_t decoded_val = BitwiseCast<uint64_t>(dVal);
       uint32_t low = uint32_t(0x00000000ffffffff & decoded_val);
       uint32_t high = uint32_t((0xffffffff00000000 & decoded_val) >> 32);
       emit(low);
@@ -0,0 +1,184 @@
+// Copyright (c) 2019 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "source/util/profiler.h"
+
+#include <cassert>
+#include <cstdio>
+#include <utility>
+
+#if defined(SPIRV_TIMER_ENABLED)
+#include <sys/resource.h>
+#endif
+
+namespace spvtools {
+namespace utils {
+namespace {
+
+// Sets |*max_rss_kb| to the peak resident set size and |*page_faults| to the
+// page faults of the process so far, or both to -1 if they are not known.
+void GetMemoryUsage(int64_t* max_rss_kb, int64_t* page_faults) {
+  *max_rss_kb = -1;
+  *page_faults = -1;
+#if defined(SPIRV_TIMER_ENABLED)
+  rusage usage;
+  if (getrusage(RUSAGE_SELF, &usage) == 0) {
+    *max_rss_kb = usage.ru_maxrss;
+    *page_faults = usage.ru_minflt + usage.ru_majflt;
+  }
+#endif
+}
+
+// Writes |value| to |out| as a JSON string.
+void WriteJsonString(std::ostream* out, const std::string& value) {
+  *out << '"';
+  for (const char c : value) {
+    if (c == '"' || c == '\\') {
+      *out << '\\' << c;
+    } else if (static_cast<unsigned char>(c) < 0x20) {
+      char escape[8];
+      snprintf(escape, sizeof(escape), "\\u%04x", c);
+      *out << escape;
+    } else {
+      *out << c;
+    }
+  }
+  *out << '"';
+}
+
+// Writes the counts and times of |phase| to |out| as JSON object members.
+void WriteStepCounts(std::ostream* out, const StepStatistics::Phase& phase) {
+  *out << "\"attempts\":" << phase.attempts
+       << ",\"successes\":" << phase.successes
+       << ",\"cache_hits\":" << phase.cache_hits
+       << ",\"bytes_removed\":" << phase.bytes_removed
+       << ",\"tool_us\":" << phase.tool_us
+       << ",\"validate_us\":" << phase.validate_us
+       << ",\"test_us\":" << phase.test_us;
+}
+
+}  // namespace
+
+Profiler::Profiler() : origin_(std::chrono::steady_clock::now()) {}
+
+uint64_t Profiler::Now() const {
+  return static_cast<uint64_t>(
+      std::chrono::duration_cast<std::chrono::microseconds>(
+          std::chrono::steady_clock::now() - origin_)
+          .count());
+}
+
+void Profiler::BeginScope(const char* category, std::string name) {
+  Scope scope;
+  scope.category = category;
+  scope.name = std::move(name);
+  scope.duration_us = 0;
+  scope.ended = false;
+  // The memory usage is read first, so that reading it is not timed.
+  GetMemoryUsage(&scope.max_rss_kb, &scope.page_faults);
+  scope.begin_us = Now();
+  open_scopes_.push_back(scopes_.size());
+  scopes_.push_back(std::move(scope));
+}
+
+void Profiler::EndScope() {
+  assert(!open_scopes_.empty() && "No scope to end.");
+  const uint64_t end_us = Now();
+  Scope& scope = scopes_[open_scopes_.back()];
+  open_scopes_.pop_back();
+  scope.duration_us = end_us - scope.begin_us;
+  int64_t max_rss_kb = 0;
+  int64_t page_faults = 0;
+  GetMemoryUsage(&max_rss_kb, &page_faults);
+  if (scope.max_rss_kb >= 0 && max_rss_kb >= 0) {
+    scope.max_rss_kb = max_rss_kb - scope.max_rss_kb;
+    scope.page_faults = page_faults - scope.page_faults;
+  } else {
+    scope.max_rss_kb = -1;
+  }
+  scope.ended = true;
+}
+
+void Profiler::WriteChromeTrace(std::ostream* out) const {
+  // Each scope is a complete event.  The viewer nests the events of a thread
+  // by their times.
+  *out << "{\"traceEvents\":[";
+  const char* separator = "\n";
+  for (const Scope& scope : scopes_) {
+    if (!scope.ended) continue;
+    *out << separator << "{\"name\":";
+    WriteJsonString(out, scope.name);
+    *out << ",\"cat\":";
+    WriteJsonString(out, scope.category);
+    *out << ",\"ph\":\"X\",\"pid\":1,\"tid\":1,\"ts\":" << scope.begin_us
+         << ",\"dur\":" << scope.duration_us;
+    if (scope.max_rss_kb >= 0) {
+      *out << ",\"args\":{\"max_rss_kb_delta\":" << scope.max_rss_kb
+           << ",\"page_faults\":" << scope.page_faults << "}";
+    }
+    *out << "}";
+    separator = ",\n";
+  }
+  *out << "\n],\"displayTimeUnit\":\"ms\"}\n";
+}
+
+StepStatistics::StepStatistics() : start_(std::chrono::steady_clock::now()) {}
+
+StepStatistics::Phase* StepStatistics::GetPhase(const std::string& name) {
+  for (Phase& phase : phases_) {
+    if (phase.name == name) return &phase;
+  }
+  phases_.emplace_back(name);
+  return &phases_.back();
+}
+
+void StepStatistics::Clear() {
+  phases_.clear();
+  start_ = std::chrono::steady_clock::now();
+}
+
+void StepStatistics::WriteJson(std::ostream* out) const {
+  Phase total("total");
+  *out << "{\"phases\":[";
+  const char* separator = "\n";
+  for (const Phase& phase : phases_) {
+    *out << separator << "{\"name\":";
+    WriteJsonString(out, phase.name);
+    *out << ",";
+    WriteStepCounts(out, phase);
+    *out << "}";
+    separator = ",\n";
+    total.attempts += phase.attempts;
+    total.successes += phase.successes;
+    total.cache_hits += phase.cache_hits;
+    total.bytes_removed += phase.bytes_removed;
+    total.tool_us += phase.tool_us;
+    total.validate_us += phase.validate_us;
+    total.test_us += phase.test_us;
+  }
+  *out << "\n],\"total\":{";
+  WriteStepCounts(out, total);
+  *out << "},\"wall_us\":" << MicrosecondsSince(start_) << "}\n";
+}
+
+uint64_t StepStatistics::MicrosecondsSince(
+    std::chrono::steady_clock::time_point start) {
+  return static_cast<uint64_t>(
+      std::chrono::duration_cast<std::chrono::microseconds>(
+          std::chrono::steady_clock::now() - start)
+          .count());
+}
+
+}  // namespace utils
+}  // namespace spvtools
@@ -0,0 +1,168 @@
+// Copyright (c) 2019 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef SOURCE_UTIL_PROFILER_H_
+#define SOURCE_UTIL_PROFILER_H_
+
+#include <chrono>
+#include <cstdint>
+#include <ostream>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace spvtools {
+namespace utils {
+
+// Records nested scopes of work with their wall time and writes them as a
+// Chrome trace, the JSON format read by chrome://tracing and Perfetto.  On
+// the platforms of |Timer|, each scope also records the growth of the peak
+// resident set size and the page faults it caused.
+//
+// Unlike |Timer|, the profiler only needs the standard library, so it is
+// always available.  It is not thread-safe: every scope must be on the thread
+// that owns the profiler.
+class Profiler {
+ public:
+  Profiler();
+
+  // Starts a scope named |name| in |category|.  It is nested in the scopes
+  // that are started and not ended yet.  |category| must outlive the
+  // profiler.
+  void BeginScope(const char* category, std::string name);
+
+  // Ends the scope started last.
+  void EndScope();
+
+  // Returns the number of scopes started.
+  size_t num_scopes() const { return scopes_.size(); }
+
+  // Writes the ended scopes to |out| as a Chrome trace.
+  void WriteChromeTrace(std::ostream* out) const;
+
+ private:
+  struct Scope {
+    const char* category;
+    std::string name;
+    // The microseconds from the creation of the profiler to the start of the
+    // scope, and from its start to its end.
+    uint64_t begin_us;
+    uint64_t duration_us;
+    // The growth of the peak resident set size in kilobytes, and the page
+    // faults, during the scope.  A negative |max_rss_kb| means that memory is
+    // not measured.
+    int64_t max_rss_kb;
+    int64_t page_faults;
+    bool ended;
+  };
+
+  // Returns the microseconds since the creation of the profiler.
+  uint64_t Now() const;
+
+  const std::chrono::steady_clock::time_point origin_;
+  std::vector<Scope> scopes_;
+  // The indices in |scopes_| of the scopes started and not ended yet.
+  std::vector<size_t> open_scopes_;
+};
+
+// Records the scope surrounding it in a profiler:
+//
+//   {
+//     ProfileScope scope(profiler, "analysis", "cfg");
+//     /* ... the work to measure ... */
+//   }
+//
+// It does nothing if the profiler is null, so that code can be instrumented
+// at no cost when no profile is requested.
+class ProfileScope {
+ public:
+  ProfileScope(Profiler* profiler, const char* category, const char* name)
+      : profiler_(profiler) {
+    if (profiler_) profiler_->BeginScope(category, name);
+  }
+
+  // Names the scope |name| followed by the id |id|, as in "function %4".
+  ProfileScope(Profiler* profiler, const char* category, const char* name,
+               uint32_t id)
+      : profiler_(profiler) {
+    if (profiler_) {
+      profiler_->BeginScope(category,
+                            std::string(name) + " %" + std::to_string(id));
+    }
+  }
+
+  ProfileScope(const ProfileScope&) = delete;
+  ProfileScope& operator=(const ProfileScope&) = delete;
+
+  ~ProfileScope() {
+    if (profiler_) profiler_->EndScope();
+  }
+
+ private:
+  Profiler* profiler_;
+};
+
+// Counts the steps of a reduction, such as those of spirv-reduce and of the
+// shrinker of spirv-fuzz, and the time they take, by phase, and writes them as
+// JSON.  A phase is a reduction pass, or a stage of the reduction.  The times
+// of the steps are summed over the threads that take them, so they can exceed
+// the wall time of the run.
+class StepStatistics {
+ public:
+  struct Phase {
+    explicit Phase(std::string phase_name) : name(std::move(phase_name)) {}
+
+    std::string name;
+    // The steps tried, those whose result was interesting, and those whose
+    // result was known without testing it.
+    uint64_t attempts = 0;
+    uint64_t successes = 0;
+    uint64_t cache_hits = 0;
+    // The bytes by which the interesting steps shrank the binary.
+    int64_t bytes_removed = 0;
+    // The microseconds spent making the steps, validating their results, and
+    // in the interestingness test.
+    uint64_t tool_us = 0;
+    uint64_t validate_us = 0;
+    uint64_t test_us = 0;
+  };
+
+  StepStatistics();
+
+  // Returns the phase named |name|, which is added after the others if it is
+  // new.  The pointer is valid until the next phase is added.
+  Phase* GetPhase(const std::string& name);
+
+  // Removes the phases, and restarts the wall time.
+  void Clear();
+
+  const std::vector<Phase>& phases() const { return phases_; }
+
+  // Writes the phases to |out| as a JSON object, with their totals and the
+  // wall time since the statistics were created or cleared.
+  void WriteJson(std::ostream* out) const;
+
+  // Returns the microseconds elapsed since |start|.
+  static uint64_t MicrosecondsSince(
+      std::chrono::steady_clock::time_point start);
+
+ private:
+  std::chrono::steady_clock::time_point start_;
+  std::vector<Phase> phases_;
+};
+
+}  // namespace utils
+}  // namespace spvtools
+
+#endif  // SOURCE_UTIL_PROFILER_H_
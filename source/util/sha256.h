@@ -0,0 +1,53 @@
+// Copyright (c) 2019 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef SOURCE_UTIL_SHA256_H_
+#define SOURCE_UTIL_SHA256_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+namespace spvtools {
+namespace utils {
+
+// Computes the SHA-256 digest, as specified by FIPS 180-4, of a message that
+// is supplied in pieces.
+class Sha256 {
+ public:
+  Sha256();
+
+  // Appends the |size| bytes at |data| to the message.
+  void Update(const void* data, size_t size);
+
+  // Returns the digest of the message as 64 lowercase hexadecimal digits.
+  // The message must not be updated afterwards.
+  std::string HexDigest();
+
+ private:
+  // Updates the state with the 64 bytes of |block|.
+  void ProcessBlock(const uint8_t* block);
+
+  uint32_t state_[8];
+  // The bytes of the message that do not yet fill a block.
+  uint8_t buffer_[64];
+  size_t buffer_size_;
+  // The number of bytes of the message.
+  uint64_t message_size_;
+};
+
+}  // namespace utils
+}  // namespace spvtools
+
+#endif  // SOURCE_UTIL_SHA256_H_
@@ -76,6 +76,17 @@ class SmallVector {
     vec.clear();
   }
 
+  SmallVector(const T* first, const T* last) : SmallVector() {
+    const size_t count = static_cast<size_t>(last - first);
+    if (count > small_size) {
+      large_data_ = MakeUnique<std::vector<T>>(first, last);
+    } else {
+      for (; first != last; ++first) {
+        new (small_data_ + (size_++)) T(*first);
+      }
+    }
+  }
+
   SmallVector(std::initializer_list<T> init_list) : SmallVector() {
     if (init_list.size() < small_size) {
       for (auto it = init_list.begin(); it != init_list.end(); ++it) {
@@ -0,0 +1,82 @@
+// Copyright (c) 2019 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef SOURCE_UTIL_SPAN_H_
+#define SOURCE_UTIL_SPAN_H_
+
+#include <algorithm>
+#include <cassert>
+#include <cstddef>
+
+namespace spvtools {
+namespace utils {
+
+// The |Span| class is a read-only view of |size| contiguous elements starting
+// at |data|.  It does not own the elements, which must outlive it.  It has the
+// const member functions of |std::vector| that are needed to replace a
+// |const std::vector<T>&|.
+template <class T>
+class Span {
+ public:
+  using value_type = T;
+  using iterator = const T*;
+  using const_iterator = const T*;
+
+  Span() : data_(nullptr), size_(0) {}
+  Span(const T* data, size_t size) : data_(data), size_(size) {}
+
+  const T* data() const { return data_; }
+  size_t size() const { return size_; }
+  bool empty() const { return size_ == 0; }
+
+  const T& operator[](size_t i) const {
+    assert(i < size_);
+    return data_[i];
+  }
+
+  const T& front() const {
+    assert(size_ > 0);
+    return data_[0];
+  }
+
+  const T& back() const {
+    assert(size_ > 0);
+    return data_[size_ - 1];
+  }
+
+  const_iterator begin() const { return data_; }
+  const_iterator end() const { return data_ + size_; }
+  const_iterator cbegin() const { return data_; }
+  const_iterator cend() const { return data_ + size_; }
+
+ private:
+  const T* data_;
+  size_t size_;
+};
+
+template <class T>
+bool operator==(const Span<T>& lhs, const Span<T>& rhs) {
+  return lhs.size() == rhs.size() &&
+         std::equal(lhs.begin(), lhs.end(), rhs.begin());
+}
+
+template <class T>
+bool operator!=(const Span<T>& lhs, const Span<T>& rhs) {
+  return !(lhs == rhs);
+}
+
+}  // namespace utils
+}  // namespace spvtools
+
+#endif  // SOURCE_UTIL_SPAN_H_
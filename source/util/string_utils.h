@@ -36,6 +36,29 @@ std::string ToString(T val) {
   return os.str();
 }
 
+// Appends the decimal representation of |value| to |str|.  Unlike ToString,
+// this does not allocate beyond growing |str|.
+inline void AppendUnsigned(uint64_t value, std::string* str) {
+  char digits[20];
+  size_t num_digits = 0;
+  do {
+    digits[num_digits++] = static_cast<char>('0' + value % 10);
+    value /= 10;
+  } while (value);
+  while (num_digits) str->push_back(digits[--num_digits]);
+}
+
+// Appends the decimal representation of |value| to |str|.
+inline void AppendSigned(int64_t value, std::string* str) {
+  if (value < 0) {
+    str->push_back('-');
+    // Negate in unsigned arithmetic, which is defined for the minimum value.
+    AppendUnsigned(uint64_t(0) - static_cast<uint64_t>(value), str);
+  } else {
+    AppendUnsigned(static_cast<uint64_t>(value), str);
+  }
+}
+
 // Converts cardinal number to ordinal number string.
 std::string CardinalToOrdinal(size_t cardinal);
 
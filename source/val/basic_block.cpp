@@ -25,6 +25,8 @@ BasicBlock::BasicBlock(uint32_t label_id)
     : id_(label_id),
       immediate_dominator_(nullptr),
       immediate_post_dominator_(nullptr),
+      dominator_interval_(0, 0),
+      post_dominator_interval_(0, 0),
       predecessors_(),
       successors_(),
       type_(0),
@@ -34,10 +36,12 @@ BasicBlock::BasicBlock(uint32_t label_id)
 
 void BasicBlock::SetImmediateDominator(BasicBlock* dom_block) {
   immediate_dominator_ = dom_block;
+  dominator_interval_ = {0, 0};
 }
 
 void BasicBlock::SetImmediatePostDominator(BasicBlock* pdom_block) {
   immediate_post_dominator_ = pdom_block;
+  post_dominator_interval_ = {0, 0};
 }
 
 const BasicBlock* BasicBlock::immediate_dominator() const {
@@ -67,13 +71,13 @@ void BasicBlock::RegisterBranchInstruction(SpvOp branch_instruction) {
   return;
 }
 
-bool BasicBlock::dominates(const BasicBlock& other) const {
+bool BasicBlock::DominatesByWalk(const BasicBlock& other) const {
   return (this == &other) ||
          !(other.dom_end() ==
            std::find(other.dom_begin(), other.dom_end(), this));
 }
 
-bool BasicBlock::postdominates(const BasicBlock& other) const {
+bool BasicBlock::PostDominatesByWalk(const BasicBlock& other) const {
   return (this == &other) ||
          !(other.pdom_end() ==
            std::find(other.pdom_begin(), other.pdom_end(), this));
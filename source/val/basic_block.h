@@ -19,6 +19,7 @@
 #include <cstdint>
 #include <functional>
 #include <memory>
+#include <utility>
 #include <vector>
 
 #include "source/latest_version_spirv_header.h"
@@ -106,6 +107,21 @@ class BasicBlock {
   /// Returns the immedate post dominator of this basic block
   const BasicBlock* immediate_post_dominator() const;
 
+  /// Sets the interval of this block in a depth-first numbering of the
+  /// dominator tree: @p begin is its own number, and @p end is one past the
+  /// number of its last descendant.  Once all the blocks of the tree are
+  /// numbered, dominates() is a constant time test.  The interval is cleared
+  /// by SetImmediateDominator.
+  void set_dominator_interval(uint32_t begin, uint32_t end) {
+    dominator_interval_ = {begin, end};
+  }
+
+  /// Sets the interval of this block in a depth-first numbering of the post
+  /// dominator tree.  See set_dominator_interval.
+  void set_post_dominator_interval(uint32_t begin, uint32_t end) {
+    post_dominator_interval_ = {begin, end};
+  }
+
   /// Ends the block without a successor
   void RegisterBranchInstruction(SpvOp branch_instruction);
 
@@ -133,11 +149,28 @@ class BasicBlock {
 
   /// Returns true if this block dominates the other block.
   /// Assumes dominators have been computed.
-  bool dominates(const BasicBlock& other) const;
+  bool dominates(const BasicBlock& other) const {
+    if (dominator_interval_.first < dominator_interval_.second &&
+        other.dominator_interval_.first < other.dominator_interval_.second) {
+      return dominator_interval_.first <= other.dominator_interval_.first &&
+             other.dominator_interval_.second <= dominator_interval_.second;
+    }
+    return DominatesByWalk(other);
+  }
 
   /// Returns true if this block postdominates the other block.
   /// Assumes dominators have been computed.
-  bool postdominates(const BasicBlock& other) const;
+  bool postdominates(const BasicBlock& other) const {
+    if (post_dominator_interval_.first < post_dominator_interval_.second &&
+        other.post_dominator_interval_.first <
+            other.post_dominator_interval_.second) {
+      return post_dominator_interval_.first <=
+                 other.post_dominator_interval_.first &&
+             other.post_dominator_interval_.second <=
+                 post_dominator_interval_.second;
+    }
+    return PostDominatesByWalk(other);
+  }
 
   /// @brief A BasicBlock dominator iterator class
   ///
@@ -203,6 +236,11 @@ class BasicBlock {
   DominatorIterator pdom_end();
 
  private:
+  /// Returns true if this block is on the immediate (post) dominator chain of
+  /// @p other, for the blocks whose trees are not numbered.
+  bool DominatesByWalk(const BasicBlock& other) const;
+  bool PostDominatesByWalk(const BasicBlock& other) const;
+
   /// Id of the BasicBlock
   const uint32_t id_;
 
@@ -212,6 +250,12 @@ class BasicBlock {
   /// Pointer to the immediate dominator of the BasicBlock
   BasicBlock* immediate_post_dominator_;
 
+  /// The interval of the numbers of this block and its descendants in the
+  /// (post) dominator tree, or [0, 0) if the block is not numbered.  One
+  /// block dominates another if its interval contains the other's.
+  std::pair<uint32_t, uint32_t> dominator_interval_;
+  std::pair<uint32_t, uint32_t> post_dominator_interval_;
+
   /// The set of predecessors of the BasicBlock
   std::vector<BasicBlock*> predecessors_;
 
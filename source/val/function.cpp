@@ -16,10 +16,12 @@
 
 #include <algorithm>
 #include <cassert>
+#include <functional>
 #include <sstream>
 #include <unordered_map>
 #include <unordered_set>
 #include <utility>
+#include <vector>
 
 #include "source/cfa.h"
 #include "source/val/basic_block.h"
@@ -301,6 +303,71 @@ Construct& Function::FindConstructForEntryBlock(const BasicBlock* entry_block,
   return *construct_ptr;
 }
 
+namespace {
+
+// Numbers the nodes of the forest over |blocks| in which the parent of a block
+// is given by |parent|.  A block without a parent, or which is its own
+// parent, is a root.  Each block is numbered in depth-first pre-order, and
+// |set_interval| is called with the block, its number, and one past the
+// number of its last descendant.
+void NumberTree(const std::vector<BasicBlock*>& blocks,
+                const std::function<BasicBlock*(BasicBlock*)>& parent,
+                const std::function<void(BasicBlock*, uint32_t, uint32_t)>&
+                    set_interval) {
+  std::unordered_map<const BasicBlock*, std::vector<BasicBlock*>> children;
+  std::vector<BasicBlock*> roots;
+  for (auto block : blocks) {
+    BasicBlock* p = parent(block);
+    if (p && p != block) {
+      children[p].push_back(block);
+    } else {
+      roots.push_back(block);
+    }
+  }
+
+  // The blocks on the path from the current root, each with its number and
+  // the index of its next child to visit.
+  struct Visit {
+    BasicBlock* block;
+    uint32_t number;
+    size_t next_child;
+  };
+  uint32_t next_number = 0;
+  std::vector<Visit> stack;
+  for (auto root : roots) {
+    stack.push_back({root, next_number++, 0});
+    while (!stack.empty()) {
+      Visit& top = stack.back();
+      const auto it = children.find(top.block);
+      if (it != children.end() && top.next_child < it->second.size()) {
+        BasicBlock* child = it->second[top.next_child++];
+        stack.push_back({child, next_number++, 0});
+      } else {
+        set_interval(top.block, top.number, next_number);
+        stack.pop_back();
+      }
+    }
+  }
+}
+
+}  // namespace
+
+void Function::NumberDominatorTrees() {
+  std::vector<BasicBlock*> blocks(ordered_blocks_);
+  blocks.push_back(&pseudo_entry_block_);
+  blocks.push_back(&pseudo_exit_block_);
+  NumberTree(
+      blocks, [](BasicBlock* b) { return b->immediate_dominator(); },
+      [](BasicBlock* b, uint32_t begin, uint32_t end) {
+        b->set_dominator_interval(begin, end);
+      });
+  NumberTree(
+      blocks, [](BasicBlock* b) { return b->immediate_post_dominator(); },
+      [](BasicBlock* b, uint32_t begin, uint32_t end) {
+        b->set_post_dominator_interval(begin, end);
+      });
+}
+
 int Function::GetBlockDepth(BasicBlock* bb) {
   // Guard against nullptr.
   if (!bb) {
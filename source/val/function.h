@@ -193,6 +193,13 @@ class Function {
   /// Returns the block predecessors function for the augmented CFG.
   GetBlocksFunction AugmentedCFGPredecessorsFunction() const;
 
+  /// Numbers the blocks of the dominator and post dominator trees depth-first,
+  /// so that BasicBlock::dominates and BasicBlock::postdominates become
+  /// constant time tests.  This should be called once the immediate
+  /// (post) dominators of all the blocks have been set, and again if they
+  /// change.
+  void NumberDominatorTrees();
+
   /// Returns the control flow nesting depth of the given basic block.
   /// This function only works when you have structured control flow.
   /// This function should only be called after the control flow constructs have
@@ -223,6 +230,17 @@ class Function {
     limitations_.push_back(is_compatible);
   }
 
+  /// Registers all the limitations registered with |other| with this function
+  /// too.
+  void RegisterLimitationsOf(const Function& other) {
+    execution_model_limitations_.insert(
+        execution_model_limitations_.end(),
+        other.execution_model_limitations_.begin(),
+        other.execution_model_limitations_.end());
+    limitations_.insert(limitations_.end(), other.limitations_.begin(),
+                        other.limitations_.end());
+  }
+
   bool CheckLimitations(const ValidationState_t& _, const Function* entry_point,
                         std::string* reason) const;
 
@@ -238,7 +256,7 @@ class Function {
   }
 
   // Returns a set with ids of all functions called from this function.
-  const std::set<uint32_t> function_call_targets() const {
+  const std::set<uint32_t>& function_call_targets() const {
     return function_call_targets_;
   }
 
@@ -23,6 +23,7 @@
 
 #include "source/ext_inst.h"
 #include "source/table.h"
+#include "source/util/span.h"
 #include "spirv-tools/libspirv.h"
 
 namespace spvtools {
@@ -32,13 +33,23 @@ class BasicBlock;
 class Function;
 
 /// Wraps the spv_parsed_instruction struct along with use and definition of the
-/// instruction's result id
+/// instruction's result id.  The words, operands and uses are not owned by the
+/// Instruction: they live in storage shared by the whole module, which must
+/// outlive it.
 class Instruction {
  public:
+  /// A reference to an instruction's result id: the instruction in which it
+  /// was referenced and the index of the word where it appeared.
+  using Use = std::pair<const Instruction*, uint32_t>;
+
+  /// Wraps \p inst, whose words and operands must outlive the Instruction.
   explicit Instruction(const spv_parsed_instruction_t* inst);
 
-  /// Registers the use of the Instruction in instruction \p inst at \p index
-  void RegisterUse(const Instruction* inst, uint32_t index);
+  /// Sets the uses of the Instruction to the \p num_uses uses at \p uses,
+  /// which must outlive it.
+  void SetUses(const Use* uses, size_t num_uses) {
+    uses_ = utils::Span<Use>(uses, num_uses);
+  }
 
   uint32_t id() const { return inst_.result_id; }
   uint32_t type_id() const { return inst_.type_id; }
@@ -54,28 +65,30 @@ class Instruction {
   const BasicBlock* block() const { return block_; }
   void set_block(BasicBlock* b) { block_ = b; }
 
-  /// Returns a vector of pairs of all references to this instruction's result
-  /// id. The first element is the instruction in which this result id was
-  /// referenced and the second is the index of the word in that instruction
-  /// where this result id appeared
-  const std::vector<std::pair<const Instruction*, uint32_t>>& uses() const {
-    return uses_;
-  }
+  /// Returns all references to this instruction's result id, in module
+  /// order. The first element of each is the instruction in which this result
+  /// id was referenced and the second is the index of the word in that
+  /// instruction where this result id appeared
+  utils::Span<Use> uses() const { return uses_; }
 
   /// The word used to define the Instruction
-  uint32_t word(size_t index) const { return words_[index]; }
+  uint32_t word(size_t index) const { return inst_.words[index]; }
 
   /// The words used to define the Instruction
-  const std::vector<uint32_t>& words() const { return words_; }
+  utils::Span<uint32_t> words() const {
+    return utils::Span<uint32_t>(inst_.words, inst_.num_words);
+  }
 
   /// Returns the operand at |idx|.
   const spv_parsed_operand_t& operand(size_t idx) const {
-    return operands_[idx];
+    assert(idx < inst_.num_operands);
+    return inst_.operands[idx];
   }
 
   /// The operands of the Instruction
-  const std::vector<spv_parsed_operand_t>& operands() const {
-    return operands_;
+  utils::Span<spv_parsed_operand_t> operands() const {
+    return utils::Span<spv_parsed_operand_t>(inst_.operands,
+                                             inst_.num_operands);
   }
 
   /// Provides direct access to the stored C instruction object.
@@ -100,18 +113,16 @@ class Instruction {
   // Casts the words belonging to the operand under |index| to |T| and returns.
   template <typename T>
   T GetOperandAs(size_t index) const {
-    const spv_parsed_operand_t& o = operands_.at(index);
+    const spv_parsed_operand_t& o = operand(index);
     assert(o.num_words * 4 >= sizeof(T));
     assert(o.offset + o.num_words <= inst_.num_words);
-    return *reinterpret_cast<const T*>(&words_[o.offset]);
+    return *reinterpret_cast<const T*>(&inst_.words[o.offset]);
   }
 
   size_t LineNum() const { return line_num_; }
   void SetLineNum(size_t pos) { line_num_ = pos; }
 
  private:
-  const std::vector<uint32_t> words_;
-  const std::vector<spv_parsed_operand_t> operands_;
   spv_parsed_instruction_t inst_;
   size_t line_num_ = 0;
 
@@ -121,11 +132,11 @@ class Instruction {
   /// The basic block in which this instruction was declared
   BasicBlock* block_ = nullptr;
 
-  /// This is a vector of pairs of all references to this instruction's result
-  /// id. The first element is the instruction in which this result id was
-  /// referenced and the second is the index of the word in the referencing
-  /// instruction where this instruction appeared
-  std::vector<std::pair<const Instruction*, uint32_t>> uses_;
+  /// All references to this instruction's result id. The first element of
+  /// each is the instruction in which this result id was referenced and the
+  /// second is the index of the word in the referencing instruction where this
+  /// instruction appeared
+  utils::Span<Use> uses_;
 };
 
 bool operator<(const Instruction& lhs, const Instruction& rhs);
@@ -15,13 +15,20 @@
 #include "source/val/validate.h"
 
 #include <algorithm>
+#include <atomic>
 #include <cassert>
+#include <chrono>
+#include <cstdint>
 #include <cstdio>
+#include <cstring>
 #include <functional>
 #include <iterator>
+#include <map>
 #include <memory>
 #include <sstream>
 #include <string>
+#include <unordered_map>
+#include <unordered_set>
 #include <vector>
 
 #include "source/binary.h"
@@ -35,6 +42,9 @@
 #include "source/spirv_endian.h"
 #include "source/spirv_target_env.h"
 #include "source/spirv_validator_options.h"
+#include "source/table.h"
+#include "source/util/parallel.h"
+#include "source/util/sha256.h"
 #include "source/val/construct.h"
 #include "source/val/function.h"
 #include "source/val/instruction.h"
@@ -209,9 +219,481 @@ spv_result_t ValidateEntryPoints(ValidationState_t& _) {
   return SPV_SUCCESS;
 }
 
-spv_result_t ValidateBinaryUsingContextAndValidationState(
-    const spv_context_t& context, const uint32_t* words, const size_t num_words,
-    spv_diagnostic* pDiagnostic, ValidationState_t* vstate) {
+// A check of individual instructions, with its name in the time reports.
+struct NamedCheck {
+  const char* name;
+  spv_result_t (*check)(ValidationState_t& _, const Instruction* inst);
+  // Returns true if |check| applies to the instructions of |opcode|, or null
+  // if it applies to every instruction.
+  bool (*applies)(SpvOp opcode);
+};
+
+// A range of checks, run in order.
+struct CheckList {
+  const NamedCheck* begin;
+  const NamedCheck* end;
+};
+
+template <size_t N>
+CheckList MakeCheckList(const NamedCheck (&checks)[N]) {
+  return {checks, checks + N};
+}
+
+spv_result_t IdCheck(ValidationState_t& _, const Instruction* inst) {
+  // The id checks record the uses of the instruction on it.
+  return IdPass(_, const_cast<Instruction*>(inst));
+}
+
+// The checks for individual opcodes.  Keep these passes in the order they
+// appear in the SPIR-V specification sections to maintain test consistency.
+const NamedCheck kOpcodeChecks[] = {
+    {"Misc", MiscPass, MiscPassApplies},
+    {"Debug", DebugPass, DebugPassApplies},
+    {"Annotation", AnnotationPass, AnnotationPassApplies},
+    {"Extension", ExtensionPass, ExtensionPassApplies},
+    {"ModeSetting", ModeSettingPass, ModeSettingPassApplies},
+    {"Type", TypePass, TypePassApplies},
+    {"Constant", ConstantPass, ConstantPassApplies},
+    {"Memory", MemoryPass, MemoryPassApplies},
+    {"Function", FunctionPass, FunctionPassApplies},
+    {"Image", ImagePass, ImagePassApplies},
+    {"Conversion", ConversionPass, ConversionPassApplies},
+    {"Composites", CompositesPass, CompositesPassApplies},
+    {"Arithmetics", ArithmeticsPass, ArithmeticsPassApplies},
+    {"Bitwise", BitwisePass, BitwisePassApplies},
+    {"Logicals", LogicalsPass, LogicalsPassApplies},
+    {"ControlFlow", ControlFlowPass, ControlFlowPassApplies},
+    {"Derivatives", DerivativesPass, DerivativesPassApplies},
+    {"Atomics", AtomicsPass, AtomicsPassApplies},
+    {"Primitives", PrimitivesPass, PrimitivesPassApplies},
+    {"Barriers", BarriersPass, BarriersPassApplies},
+    // Group
+    // Device-Side Enqueue
+    // Pipe
+    {"NonUniform", NonUniformPass, NonUniformPassApplies},
+    {"Literals", LiteralsPass},
+};
+
+// The checks for individual opcodes when the options ask for structural
+// checks only: the rules on type, constant and function declarations and on
+// control flow.
+const NamedCheck kStructuralOpcodeChecks[] = {
+    {"Type", TypePass, TypePassApplies},
+    {"Constant", ConstantPass, ConstantPassApplies},
+    {"Function", FunctionPass, FunctionPassApplies},
+    {"ControlFlow", ControlFlowPass, ControlFlowPassApplies},
+};
+
+// The checks of each instruction as it is registered, in module order.
+const NamedCheck kInstructionChecks[] = {
+    {"Id", IdCheck},
+    {"Capability", CapabilityPass},
+    {"ModuleLayout", ModuleLayoutPass},
+    {"Cfg", CfgPass},
+    {"Instruction", InstructionPass},
+};
+
+// The checks of the limitations registered by the opcode checks.
+const NamedCheck kLimitationChecks[] = {
+    {"ExecutionLimitations", ValidateExecutionLimitations},
+    {"SmallTypeUses", ValidateSmallTypeUses},
+};
+
+// Times the phases of a validation and the checks of the instructions within
+// each phase, and passes the report to |report| on destruction.  The checks
+// may be timed from different threads concurrently, so the times of the
+// checks of a phase run on several threads add up to more than the phase.
+class TimeReport {
+ public:
+  TimeReport(spv_validator_time_report_fn_t report, void* user_data)
+      : report_(report),
+        user_data_(user_data),
+        start_(Clock::now()),
+        phase_name_(nullptr),
+        checks_() {
+    out_ << "Phase                                  Time (ms)\n";
+  }
+
+  ~TimeReport() {
+    EndPhase();
+    AddLine("total", "", NanosecondsSince(start_));
+    report_(user_data_, out_.str().c_str());
+  }
+
+  // Ends the current phase, and starts the phase |name|, whose instructions
+  // are checked by |checks|.
+  void StartPhase(const char* name, CheckList checks) {
+    EndPhase();
+    phase_name_ = name;
+    phase_start_ = Clock::now();
+    checks_ = checks;
+    const size_t num_checks = size_t(checks.end - checks.begin);
+    check_nanoseconds_.reset(new std::atomic<uint64_t>[num_checks]);
+    for (size_t i = 0; i < num_checks; ++i) check_nanoseconds_[i] = 0;
+  }
+
+  // Runs the check |index| of the current phase on |inst|, and times it.
+  spv_result_t RunCheck(size_t index, ValidationState_t& _,
+                        const Instruction* inst) {
+    const Clock::time_point check_start = Clock::now();
+    const spv_result_t result = checks_.begin[index].check(_, inst);
+    check_nanoseconds_[index] += NanosecondsSince(check_start);
+    return result;
+  }
+
+ private:
+  using Clock = std::chrono::steady_clock;
+
+  static uint64_t NanosecondsSince(Clock::time_point start) {
+    return uint64_t(std::chrono::duration_cast<std::chrono::nanoseconds>(
+                        Clock::now() - start)
+                        .count());
+  }
+
+  void AddLine(const char* name, const char* indent, uint64_t nanoseconds) {
+    char line[128];
+    snprintf(line, sizeof(line), "%s%-*s %12.3f\n", indent,
+             int(36 - strlen(indent)), name, double(nanoseconds) / 1e6);
+    out_ << line;
+  }
+
+  // Adds the times of the current phase and of its checks to the report.
+  void EndPhase() {
+    if (!phase_name_) return;
+    AddLine(phase_name_, "", NanosecondsSince(phase_start_));
+    for (const NamedCheck* check = checks_.begin; check != checks_.end;
+         ++check) {
+      AddLine(check->name, "  ",
+              check_nanoseconds_[size_t(check - checks_.begin)]);
+    }
+    phase_name_ = nullptr;
+  }
+
+  spv_validator_time_report_fn_t report_;
+  void* user_data_;
+  Clock::time_point start_;
+  const char* phase_name_;
+  Clock::time_point phase_start_;
+  CheckList checks_;
+  std::unique_ptr<std::atomic<uint64_t>[]> check_nanoseconds_;
+  std::ostringstream out_;
+};
+
+// Runs |checks| on |inst| in order, until one fails.  They are timed in
+// |report| if it is not null.
+spv_result_t RunChecks(const CheckList& checks, ValidationState_t& _,
+                       const Instruction* inst, TimeReport* report) {
+  for (const NamedCheck* check = checks.begin; check != checks.end; ++check) {
+    const spv_result_t error =
+        report ? report->RunCheck(size_t(check - checks.begin), _, inst)
+               : check->check(_, inst);
+    if (error) return error;
+  }
+  return SPV_SUCCESS;
+}
+
+// The checks of a list which apply to each opcode, so that each instruction
+// is only given to the checks which handle its opcode.
+class CheckDispatch {
+ public:
+  explicit CheckDispatch(const CheckList& checks) {
+    const size_t num_checks = size_t(checks.end - checks.begin);
+    // The opcodes missing from the grammar are given to every check.
+    std::vector<uint8_t> all_checks;
+    for (size_t i = 0; i < num_checks; ++i) all_checks.push_back(uint8_t(i));
+    std::map<std::vector<uint8_t>, uint16_t> list_indices;
+    list_indices[all_checks] = 0;
+    lists_.push_back(all_checks);
+
+    spv_opcode_table table = nullptr;
+    spvOpcodeTableGet(&table, SPV_ENV_UNIVERSAL_1_0);
+    for (uint32_t entry = 0; entry < table->count; ++entry) {
+      const SpvOp opcode = table->entries[entry].opcode;
+      std::vector<uint8_t> list;
+      for (size_t i = 0; i < num_checks; ++i) {
+        const NamedCheck& check = checks.begin[i];
+        if (!check.applies || check.applies(opcode)) {
+          list.push_back(uint8_t(i));
+        }
+      }
+      const auto inserted =
+          list_indices.insert({list, uint16_t(lists_.size())});
+      if (inserted.second) lists_.push_back(list);
+      if (size_t(opcode) >= list_of_opcode_.size()) {
+        list_of_opcode_.resize(size_t(opcode) + 1, 0);
+      }
+      list_of_opcode_[size_t(opcode)] = inserted.first->second;
+    }
+  }
+
+  // Returns the indices of the checks which apply to |opcode|, in order.
+  const std::vector<uint8_t>& ChecksFor(SpvOp opcode) const {
+    const size_t index = size_t(opcode);
+    return lists_[index < list_of_opcode_.size() ? list_of_opcode_[index]
+                                                 : 0];
+  }
+
+ private:
+  // The index in |lists_| of the checks of each opcode.
+  std::vector<uint16_t> list_of_opcode_;
+  // The distinct lists of checks.
+  std::vector<std::vector<uint8_t>> lists_;
+};
+
+// Returns the checks for individual opcodes of the validation in |_|.
+CheckList OpcodeChecks(const ValidationState_t& _) {
+  return _.options()->structural_only ? MakeCheckList(kStructuralOpcodeChecks)
+                                      : MakeCheckList(kOpcodeChecks);
+}
+
+// Returns the dispatch of OpcodeChecks(_).
+const CheckDispatch& OpcodeDispatch(const ValidationState_t& _) {
+  static const CheckDispatch* const kOpcodeDispatch =
+      new CheckDispatch(MakeCheckList(kOpcodeChecks));
+  static const CheckDispatch* const kStructuralOpcodeDispatch =
+      new CheckDispatch(MakeCheckList(kStructuralOpcodeChecks));
+  return _.options()->structural_only ? *kStructuralOpcodeDispatch
+                                      : *kOpcodeDispatch;
+}
+
+// Validates the given instruction with the checks for individual opcodes
+// which apply to it, timing them in |report| if it is not null.
+spv_result_t ValidateOpcode(ValidationState_t& _, const Instruction* inst,
+                            TimeReport* report) {
+  const CheckList checks = OpcodeChecks(_);
+  for (uint8_t index : OpcodeDispatch(_).ChecksFor(inst->opcode())) {
+    const spv_result_t error =
+        report ? report->RunCheck(index, _, inst)
+               : checks.begin[index].check(_, inst);
+    if (error) return error;
+  }
+  return SPV_SUCCESS;
+}
+
+// Returns the index in |instructions| of the end of the function starting at
+// index |function_starts[f]|.
+size_t FunctionEnd(const std::vector<Instruction>& instructions,
+                   const std::vector<size_t>& function_starts, size_t f) {
+  return f + 1 < function_starts.size() ? function_starts[f + 1]
+                                        : instructions.size();
+}
+
+// Returns the index of the OpFunction of each function in |instructions|.
+std::vector<size_t> FunctionStarts(
+    const std::vector<Instruction>& instructions) {
+  std::vector<size_t> function_starts;
+  for (size_t i = 0; i < instructions.size(); ++i) {
+    if (instructions[i].opcode() == SpvOpFunction) function_starts.push_back(i);
+  }
+  return function_starts;
+}
+
+// Returns true if the instructions [a_begin, a_end) of |a| have the same words
+// as the instructions [b_begin, b_end) of |b|.
+bool SameInstructions(const std::vector<Instruction>& a, size_t a_begin,
+                      size_t a_end, const std::vector<Instruction>& b,
+                      size_t b_begin, size_t b_end) {
+  if (a_end - a_begin != b_end - b_begin) return false;
+  for (size_t i = 0; i < a_end - a_begin; ++i) {
+    if (a[a_begin + i].words() != b[b_begin + i].words()) return false;
+  }
+  return true;
+}
+
+// Returns whether the opcode checks of the instructions of each function of
+// the module in |_| are known to pass, because |previous| is the state of a
+// valid module with the same version and global section, and with the same
+// function, calling and called by the same functions.  The opcode checks of
+// a function only depend on those, including the checks of its OpFunction,
+// which look at its calls.
+std::vector<bool> FindCheckedFunctions(
+    const ValidationState_t& _, const std::vector<size_t>& function_starts,
+    const ValidationState_t& previous) {
+  const std::vector<Instruction>& instructions = _.ordered_instructions();
+  const std::vector<Instruction>& previous_instructions =
+      previous.ordered_instructions();
+  const std::vector<size_t> previous_starts =
+      FunctionStarts(previous_instructions);
+  std::vector<bool> checked(function_starts.size(), false);
+  if (_.version() != previous.version() ||
+      !SameInstructions(
+          instructions, 0,
+          function_starts.empty() ? instructions.size()
+                                  : function_starts.front(),
+          previous_instructions, 0,
+          previous_starts.empty() ? previous_instructions.size()
+                                  : previous_starts.front())) {
+    return checked;
+  }
+
+  std::unordered_map<uint32_t, size_t> previous_functions;
+  for (size_t f = 0; f < previous_starts.size(); ++f) {
+    previous_functions[previous_instructions[previous_starts[f]].id()] = f;
+  }
+  // Maps the id of each function of the module to whether it is unchanged.
+  std::unordered_map<uint32_t, bool> unchanged;
+  for (size_t f = 0; f < function_starts.size(); ++f) {
+    const uint32_t id = instructions[function_starts[f]].id();
+    const auto previous_function = previous_functions.find(id);
+    unchanged[id] =
+        previous_function != previous_functions.end() &&
+        SameInstructions(
+            instructions, function_starts[f],
+            FunctionEnd(instructions, function_starts, f),
+            previous_instructions, previous_starts[previous_function->second],
+            FunctionEnd(previous_instructions, previous_starts,
+                        previous_function->second));
+  }
+
+  std::unordered_set<uint32_t> called_by_changed;
+  for (size_t f = 0; f < function_starts.size(); ++f) {
+    const uint32_t id = instructions[function_starts[f]].id();
+    if (unchanged[id]) continue;
+    for (uint32_t callee : _.function(id)->function_call_targets()) {
+      called_by_changed.insert(callee);
+    }
+  }
+  for (size_t f = 0; f < function_starts.size(); ++f) {
+    const uint32_t id = instructions[function_starts[f]].id();
+    if (!unchanged[id] || called_by_changed.count(id)) continue;
+    bool calls_changed = false;
+    for (uint32_t callee : _.function(id)->function_call_targets()) {
+      const auto callee_unchanged = unchanged.find(callee);
+      if (callee_unchanged == unchanged.end() || !callee_unchanged->second) {
+        calls_changed = true;
+      }
+    }
+    checked[f] = !calls_changed;
+  }
+  return checked;
+}
+
+// Runs |check| on the instructions of each function starting at
+// |function_starts| which is not |skipped|, on |num_threads| threads.  The
+// checks of an instruction in a function must only modify the state of that
+// function, so that different functions can be checked concurrently.  Their
+// diagnostics are suppressed meanwhile.  Only the first failure in module
+// order is reported, by checking that instruction again afterwards.
+spv_result_t CheckFunctionsConcurrently(
+    ValidationState_t& _, const std::vector<size_t>& function_starts,
+    const std::vector<bool>& skipped, uint32_t num_threads,
+    const std::function<spv_result_t(const Instruction*)>& check) {
+  const std::vector<Instruction>& instructions = _.ordered_instructions();
+  const size_t no_failure = instructions.size();
+  std::vector<size_t> first_failures(function_starts.size(), no_failure);
+  _.set_diagnostics_suppressed(true);
+  utils::ParallelFor(
+      function_starts.size(), num_threads,
+      [&instructions, &function_starts, &skipped, &first_failures,
+       &check](size_t f) {
+        if (skipped[f]) return;
+        const size_t end = FunctionEnd(instructions, function_starts, f);
+        for (size_t i = function_starts[f]; i < end; ++i) {
+          if (check(&instructions[i]) != SPV_SUCCESS) {
+            first_failures[f] = i;
+            return;
+          }
+        }
+      });
+  _.set_diagnostics_suppressed(false);
+  for (size_t failure : first_failures) {
+    if (failure == no_failure) continue;
+    if (auto error = check(&instructions[failure])) return error;
+  }
+  return SPV_SUCCESS;
+}
+
+// Validates every instruction with the checks for individual opcodes, in
+// module order.  The functions are checked on the number of threads given by
+// the validator options.  If |previous| is not null, it is the state of a
+// module found valid before, and the functions found unchanged since are not
+// checked again.  The limitations they registered then are registered again
+// instead.  The checks are timed in |report| if it is not null.
+spv_result_t ValidateOpcodes(ValidationState_t& _,
+                             const ValidationState_t* previous,
+                             TimeReport* report) {
+  const std::vector<Instruction>& instructions = _.ordered_instructions();
+  const std::vector<size_t> function_starts = FunctionStarts(instructions);
+  std::vector<bool> checked(function_starts.size(), false);
+  if (previous) {
+    checked = FindCheckedFunctions(_, function_starts, *previous);
+    for (size_t f = 0; f < function_starts.size(); ++f) {
+      if (!checked[f]) continue;
+      const uint32_t id = instructions[function_starts[f]].id();
+      _.function(id)->RegisterLimitationsOf(*previous->function(id));
+    }
+  }
+
+  // The checks of the global section register types and decorations, so
+  // run them first, on this thread.
+  const size_t globals_end =
+      function_starts.empty() ? instructions.size() : function_starts.front();
+  for (size_t i = 0; i < globals_end; ++i) {
+    if (auto error = ValidateOpcode(_, &instructions[i], report)) return error;
+  }
+
+  const uint32_t num_threads =
+      utils::ResolveNumThreads(_.options()->num_threads);
+  if (num_threads == 1 || function_starts.size() < 2) {
+    for (size_t f = 0; f < function_starts.size(); ++f) {
+      if (checked[f]) continue;
+      const size_t end = FunctionEnd(instructions, function_starts, f);
+      for (size_t i = function_starts[f]; i < end; ++i) {
+        if (auto error = ValidateOpcode(_, &instructions[i], report)) {
+          return error;
+        }
+      }
+    }
+    return SPV_SUCCESS;
+  }
+
+  return CheckFunctionsConcurrently(
+      _, function_starts, checked, num_threads,
+      [&_, report](const Instruction* inst) {
+        return ValidateOpcode(_, inst, report);
+      });
+}
+
+// Validates every instruction with the checks of the limitations registered
+// by the opcode checks, in module order.  The checks only read the state, so
+// the functions are checked on the number of threads given by the validator
+// options.  The checks are timed in |report| if it is not null.
+spv_result_t ValidateLimitations(ValidationState_t& _, TimeReport* report) {
+  const CheckList checks = MakeCheckList(kLimitationChecks);
+  const std::vector<Instruction>& instructions = _.ordered_instructions();
+  const std::vector<size_t> function_starts = FunctionStarts(instructions);
+  const uint32_t num_threads =
+      utils::ResolveNumThreads(_.options()->num_threads);
+  if (num_threads == 1 || function_starts.size() < 2) {
+    for (const auto& inst : instructions) {
+      if (auto error = RunChecks(checks, _, &inst, report)) return error;
+    }
+    return SPV_SUCCESS;
+  }
+
+  for (size_t i = 0; i < function_starts.front(); ++i) {
+    if (auto error = RunChecks(checks, _, &instructions[i], report)) {
+      return error;
+    }
+  }
+  return CheckFunctionsConcurrently(
+      _, function_starts, std::vector<bool>(function_starts.size(), false),
+      num_threads, [&_, &checks, report](const Instruction* inst) {
+        return RunChecks(checks, _, inst, report);
+      });
+}
+
+// Parses the instructions of the module being validated with |context|,
+// issuing |parse_instruction| with |user_data| for each instruction, until
+// that returns other than SPV_SUCCESS.  Returns the result of the parse.
+using ParseModuleFn = std::function<spv_result_t(
+    const spv_context_t& context, void* user_data,
+    spv_parsed_instruction_fn_t parse_instruction, spv_diagnostic* diagnostic)>;
+
+// Checks the header of the module, given by the |num_words| words at |words|.
+spv_result_t ValidateHeader(const spv_context_t& context,
+                            const uint32_t* words, const size_t num_words,
+                            ValidationState_t* vstate) {
   auto binary = std::unique_ptr<spv_const_binary_t>(
       new spv_const_binary_t{words, num_words});
 
@@ -253,25 +735,44 @@ spv_result_t ValidateBinaryUsingContextAndValidationState(
            << vstate->options()->universal_limits_.max_id_bound << ".";
   }
 
+  return SPV_SUCCESS;
+}
+
+// Validates the module whose instructions are parsed by |parse|, and whose
+// header has been checked.
+spv_result_t ValidateModuleUsingContextAndValidationState(
+    const spv_context_t& context, const ParseModuleFn& parse,
+    spv_diagnostic* pDiagnostic, ValidationState_t* vstate,
+    const ValidationState_t* previous) {
+  const spv_validator_options_t& options = *vstate->options();
+  std::unique_ptr<TimeReport> report;
+  if (options.time_report) {
+    report.reset(new TimeReport(options.time_report,
+                                options.time_report_user_data));
+  }
+  const auto start_phase = [&report](const char* name, CheckList checks) {
+    if (report) report->StartPhase(name, checks);
+  };
+
   // Look for OpExtension instructions and register extensions.
   // This parse should not produce any error messages. Hijack the context and
   // replace the message consumer so that we do not pollute any state in input
   // consumer.
+  start_phase("extensions", CheckList());
   spv_context_t hijacked_context = context;
   hijacked_context.consumer = [](spv_message_level_t, const char*,
                                  const spv_position_t&, const char*) {};
-  spvBinaryParse(&hijacked_context, vstate, words, num_words,
-                 /* parsed_header = */ nullptr, ProcessExtensions,
-                 /* diagnostic = */ nullptr);
+  parse(hijacked_context, vstate, ProcessExtensions,
+        /* diagnostic = */ nullptr);
 
   // Parse the module and perform inline validation checks. These checks do
   // not require the the knowledge of the whole module.
-  if (auto error = spvBinaryParse(&context, vstate, words, num_words,
-                                  /*parsed_header =*/nullptr,
-                                  ProcessInstruction, pDiagnostic)) {
+  start_phase("parse", CheckList());
+  if (auto error = parse(context, vstate, ProcessInstruction, pDiagnostic)) {
     return error;
   }
 
+  start_phase("instructions", MakeCheckList(kInstructionChecks));
   std::vector<Instruction*> visited_entry_points;
   for (auto& instruction : vstate->ordered_instructions()) {
     {
@@ -338,14 +839,12 @@ spv_result_t ValidateBinaryUsingContextAndValidationState(
           vstate->current_function().current_block()->set_terminator(inst);
         }
       }
-
-      if (auto error = IdPass(*vstate, inst)) return error;
     }
 
-    if (auto error = CapabilityPass(*vstate, &instruction)) return error;
-    if (auto error = ModuleLayoutPass(*vstate, &instruction)) return error;
-    if (auto error = CfgPass(*vstate, &instruction)) return error;
-    if (auto error = InstructionPass(*vstate, &instruction)) return error;
+    if (auto error = RunChecks(MakeCheckList(kInstructionChecks), *vstate,
+                               &instruction, report.get())) {
+      return error;
+    }
 
     // Now that all of the checks are done, update the state.
     {
@@ -366,6 +865,7 @@ spv_result_t ValidateBinaryUsingContextAndValidationState(
            << "Missing OpFunctionEnd at end of module.";
 
   // Catch undefined forward references before performing further checks.
+  start_phase("forward declarations", CheckList());
   if (auto error = ValidateForwardDecls(*vstate)) return error;
 
   // ID usage needs be handled in its own iteration of the instructions,
@@ -376,67 +876,114 @@ spv_result_t ValidateBinaryUsingContextAndValidationState(
   // It should also live after the forward declaration check, since it will
   // have problems with missing forward declarations, but give less useful error
   // messages.
-  for (size_t i = 0; i < vstate->ordered_instructions().size(); ++i) {
-    auto& instruction = vstate->ordered_instructions()[i];
-    if (auto error = UpdateIdUse(*vstate, &instruction)) return error;
-  }
+  start_phase("uses", CheckList());
+  vstate->RegisterUses();
 
   // Validate individual opcodes.
-  for (size_t i = 0; i < vstate->ordered_instructions().size(); ++i) {
-    auto& instruction = vstate->ordered_instructions()[i];
-
-    // Keep these passes in the order they appear in the SPIR-V specification
-    // sections to maintain test consistency.
-    if (auto error = MiscPass(*vstate, &instruction)) return error;
-    if (auto error = DebugPass(*vstate, &instruction)) return error;
-    if (auto error = AnnotationPass(*vstate, &instruction)) return error;
-    if (auto error = ExtensionPass(*vstate, &instruction)) return error;
-    if (auto error = ModeSettingPass(*vstate, &instruction)) return error;
-    if (auto error = TypePass(*vstate, &instruction)) return error;
-    if (auto error = ConstantPass(*vstate, &instruction)) return error;
-    if (auto error = MemoryPass(*vstate, &instruction)) return error;
-    if (auto error = FunctionPass(*vstate, &instruction)) return error;
-    if (auto error = ImagePass(*vstate, &instruction)) return error;
-    if (auto error = ConversionPass(*vstate, &instruction)) return error;
-    if (auto error = CompositesPass(*vstate, &instruction)) return error;
-    if (auto error = ArithmeticsPass(*vstate, &instruction)) return error;
-    if (auto error = BitwisePass(*vstate, &instruction)) return error;
-    if (auto error = LogicalsPass(*vstate, &instruction)) return error;
-    if (auto error = ControlFlowPass(*vstate, &instruction)) return error;
-    if (auto error = DerivativesPass(*vstate, &instruction)) return error;
-    if (auto error = AtomicsPass(*vstate, &instruction)) return error;
-    if (auto error = PrimitivesPass(*vstate, &instruction)) return error;
-    if (auto error = BarriersPass(*vstate, &instruction)) return error;
-    // Group
-    // Device-Side Enqueue
-    // Pipe
-    if (auto error = NonUniformPass(*vstate, &instruction)) return error;
-
-    if (auto error = LiteralsPass(*vstate, &instruction)) return error;
+  start_phase("opcodes", OpcodeChecks(*vstate));
+  if (auto error = ValidateOpcodes(*vstate, previous, report.get())) {
+    return error;
   }
 
   // Validate the preconditions involving adjacent instructions. e.g. SpvOpPhi
   // must only be preceeded by SpvOpLabel, SpvOpPhi, or SpvOpLine.
+  start_phase("adjacency", CheckList());
   if (auto error = ValidateAdjacency(*vstate)) return error;
 
+  start_phase("entry points", CheckList());
   if (auto error = ValidateEntryPoints(*vstate)) return error;
   // CFG checks are performed after the binary has been parsed
   // and the CFGPass has collected information about the control flow
+  start_phase("cfg", CheckList());
   if (auto error = PerformCfgChecks(*vstate)) return error;
+  start_phase("dominance", CheckList());
   if (auto error = CheckIdDefinitionDominateUse(*vstate)) return error;
+  // The remaining checks are not about the structure of the module.
+  if (vstate->options()->structural_only) return SPV_SUCCESS;
+  start_phase("decorations", CheckList());
   if (auto error = ValidateDecorations(*vstate)) return error;
+  start_phase("interfaces", CheckList());
   if (auto error = ValidateInterfaces(*vstate)) return error;
   // TODO(dsinclair): Restructure ValidateBuiltins so we can move into the
   // for() above as it loops over all ordered_instructions internally.
+  start_phase("built-ins", CheckList());
   if (auto error = ValidateBuiltIns(*vstate)) return error;
   // These checks must be performed after individual opcode checks because
   // those checks register the limitation checked here.
-  for (const auto inst : vstate->ordered_instructions()) {
-    if (auto error = ValidateExecutionLimitations(*vstate, &inst)) return error;
-    if (auto error = ValidateSmallTypeUses(*vstate, &inst)) return error;
+  start_phase("limitations", MakeCheckList(kLimitationChecks));
+  return ValidateLimitations(*vstate, report.get());
+}
+
+spv_result_t ValidateBinaryUsingContextAndValidationState(
+    const spv_context_t& context, const uint32_t* words, const size_t num_words,
+    spv_diagnostic* pDiagnostic, ValidationState_t* vstate,
+    const ValidationState_t* previous = nullptr) {
+  if (auto error = ValidateHeader(context, words, num_words, vstate)) {
+    return error;
   }
+  return ValidateModuleUsingContextAndValidationState(
+      context,
+      [words, num_words](const spv_context_t& parse_context, void* user_data,
+                         spv_parsed_instruction_fn_t parse_instruction,
+                         spv_diagnostic* diagnostic) {
+        return spvBinaryParse(&parse_context, user_data, words, num_words,
+                              /* parsed_header = */ nullptr,
+                              parse_instruction, diagnostic);
+      },
+      pDiagnostic, vstate, previous);
+}
 
-  return SPV_SUCCESS;
+// Validates the module supplied one instruction at a time by |module|.
+spv_result_t ValidateInstructionsUsingContext(
+    const spv_context_t& context, spv_const_validator_options options,
+    const ModuleInstructions& module, spv_diagnostic* pDiagnostic,
+    std::unique_ptr<ValidationState_t>* vstate,
+    const ValidationState_t* previous) {
+  vstate->reset(new ValidationState_t(
+      &context, options, module.header, module.num_instructions,
+      module.num_words, module.num_functions, module.to_binary,
+      kDefaultMaxNumOfWarnings));
+  if (auto error = ValidateHeader(context, module.header,
+                                  SPV_INDEX_INSTRUCTION, vstate->get())) {
+    return error;
+  }
+  return ValidateModuleUsingContextAndValidationState(
+      context,
+      [&module](const spv_context_t& parse_context, void* user_data,
+                spv_parsed_instruction_fn_t parse_instruction,
+                spv_diagnostic* diagnostic) {
+        std::unique_ptr<spv_binary_parser_t, void (*)(spv_binary_parser)>
+            parser(spvBinaryParserCreate(&parse_context),
+                   spvBinaryParserDestroy);
+        if (auto error =
+                spvBinaryParserBegin(parser.get(), user_data, module.header,
+                                     /* parsed_header = */ nullptr,
+                                     parse_instruction, diagnostic)) {
+          return error;
+        }
+        return module.for_each_instruction(
+            [&parser](const uint32_t* words, size_t num_words) {
+              return spvBinaryParserParseInstruction(parser.get(), words,
+                                                     num_words);
+            });
+      },
+      pDiagnostic, vstate->get(), previous);
+}
+
+// Returns the key of the module of |num_words| words at |words| in a
+// validation cache: the SHA-256 digest of everything that decides whether
+// it is valid.
+std::string ValidationCacheKey(const spv_context_t& context,
+                               const spv_validator_options_t& options,
+                               const uint32_t* words, size_t num_words) {
+  utils::Sha256 sha;
+  const std::string version = spvSoftwareVersionDetailsString();
+  sha.Update(version.c_str(), version.size() + 1);
+  const uint32_t target_env = static_cast<uint32_t>(context.target_env);
+  sha.Update(&target_env, sizeof(target_env));
+  HashValidatorOptions(options, &sha);
+  sha.Update(words, num_words * sizeof(uint32_t));
+  return sha.HexDigest();
 }
 
 }  // namespace
@@ -458,6 +1005,21 @@ spv_result_t ValidateBinaryAndKeepValidationState(
       hijack_context, words, num_words, pDiagnostic, vstate->get());
 }
 
+spv_result_t ValidateModuleInstructions(const spv_const_context context,
+                                        spv_const_validator_options options,
+                                        const ModuleInstructions& module,
+                                        spv_diagnostic* pDiagnostic) {
+  spv_context_t hijack_context = *context;
+  if (pDiagnostic) {
+    *pDiagnostic = nullptr;
+    UseDiagnosticAsMessageConsumer(&hijack_context, pDiagnostic);
+  }
+
+  std::unique_ptr<ValidationState_t> vstate;
+  return ValidateInstructionsUsingContext(hijack_context, options, module,
+                                          pDiagnostic, &vstate, nullptr);
+}
+
 }  // namespace val
 }  // namespace spvtools
 
@@ -503,11 +1065,129 @@ spv_result_t spvValidateWithOptions(const spv_const_context context,
     spvtools::UseDiagnosticAsMessageConsumer(&hijack_context, pDiagnostic);
   }
 
+  std::string cache_key;
+  if (options->cache_lookup) {
+    cache_key = spvtools::val::ValidationCacheKey(
+        *context, *options, binary->code, binary->wordCount);
+    if (options->cache_lookup(options->cache_user_data, cache_key.c_str())) {
+      return SPV_SUCCESS;
+    }
+  }
+
   // Create the ValidationState using the context.
   spvtools::val::ValidationState_t vstate(&hijack_context, options,
                                           binary->code, binary->wordCount,
                                           kDefaultMaxNumOfWarnings);
 
-  return spvtools::val::ValidateBinaryUsingContextAndValidationState(
-      hijack_context, binary->code, binary->wordCount, pDiagnostic, &vstate);
+  const spv_result_t result =
+      spvtools::val::ValidateBinaryUsingContextAndValidationState(
+          hijack_context, binary->code, binary->wordCount, pDiagnostic,
+          &vstate);
+  if (result == SPV_SUCCESS && options->cache_lookup &&
+      options->cache_store) {
+    options->cache_store(options->cache_user_data, cache_key.c_str());
+  }
+  return result;
 }
+
+spv_result_t spvValidateBatchWithOptions(
+    const spv_const_context context, spv_const_validator_options options,
+    const spv_const_binary_t* binaries, size_t count, uint32_t num_threads,
+    spv_result_t* results, spv_diagnostic* diagnostics) {
+  // The binaries are the unit of parallelism: when several are validated at
+  // once, the functions of each are validated on the thread of the binary.
+  spv_validator_options_t module_options = *options;
+  if (spvtools::utils::ResolveNumThreads(num_threads) > 1 && count > 1) {
+    module_options.num_threads = 1;
+  }
+
+  spvtools::utils::ParallelFor(
+      count, num_threads,
+      [context, &module_options, binaries, results, diagnostics](size_t i) {
+        results[i] = spvValidateWithOptions(
+            context, &module_options, &binaries[i],
+            diagnostics ? &diagnostics[i] : nullptr);
+      });
+
+  for (size_t i = 0; i < count; ++i) {
+    if (results[i] != SPV_SUCCESS) return results[i];
+  }
+  return SPV_SUCCESS;
+}
+
+// An incremental validator remembers the last module it found valid, so that
+// the functions that did not change since are not checked again.
+struct spv_incremental_validator_t {
+  spv_incremental_validator_t(const spv_context_t& c,
+                              const spv_validator_options_t& o)
+      : context(c), hijack_context(c), options(o) {}
+
+  const spv_context_t context;
+  // The context used by the last validation, which may redirect the messages
+  // to its diagnostic.
+  spv_context_t hijack_context;
+  const spv_validator_options_t options;
+  // The state of the last module found valid, or null.  Only its
+  // instructions and functions are used: the binary it was made from may
+  // have been released since.
+  std::unique_ptr<spvtools::val::ValidationState_t> previous;
+};
+
+spv_incremental_validator spvIncrementalValidatorCreate(
+    const spv_const_context context,
+    const spv_const_validator_options options) {
+  if (!context) return nullptr;
+  return new spv_incremental_validator_t(
+      *context, options ? *options : spv_validator_options_t());
+}
+
+void spvIncrementalValidatorDestroy(spv_incremental_validator validator) {
+  delete validator;
+}
+
+spv_result_t spvIncrementalValidatorValidate(
+    spv_incremental_validator validator, const uint32_t* words,
+    const size_t num_words, spv_diagnostic* pDiagnostic) {
+  if (!validator) return SPV_ERROR_INVALID_POINTER;
+  validator->hijack_context.consumer = validator->context.consumer;
+  if (pDiagnostic) {
+    *pDiagnostic = nullptr;
+    spvtools::UseDiagnosticAsMessageConsumer(&validator->hijack_context,
+                                             pDiagnostic);
+  }
+
+  std::unique_ptr<spvtools::val::ValidationState_t> vstate(
+      new spvtools::val::ValidationState_t(
+          &validator->hijack_context, &validator->options, words, num_words,
+          kDefaultMaxNumOfWarnings));
+  const spv_result_t result =
+      spvtools::val::ValidateBinaryUsingContextAndValidationState(
+          validator->hijack_context, words, num_words, pDiagnostic,
+          vstate.get(), validator->previous.get());
+  if (result == SPV_SUCCESS) validator->previous = std::move(vstate);
+  return result;
+}
+
+namespace spvtools {
+namespace val {
+
+spv_result_t ValidateModuleInstructions(spv_incremental_validator validator,
+                                        const ModuleInstructions& module,
+                                        spv_diagnostic* pDiagnostic) {
+  if (!validator) return SPV_ERROR_INVALID_POINTER;
+  validator->hijack_context.consumer = validator->context.consumer;
+  if (pDiagnostic) {
+    *pDiagnostic = nullptr;
+    UseDiagnosticAsMessageConsumer(&validator->hijack_context, pDiagnostic);
+  }
+
+  std::unique_ptr<ValidationState_t> vstate;
+  const spv_result_t result = ValidateInstructionsUsingContext(
+      validator->hijack_context, &validator->options, module, pDiagnostic,
+      &vstate, validator->previous.get());
+  if (result == SPV_SUCCESS) validator->previous = std::move(vstate);
+  return result;
+}
+
+}  // namespace val
+}  // namespace spvtools
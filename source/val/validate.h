@@ -21,6 +21,7 @@
 #include <vector>
 
 #include "source/instruction.h"
+#include "source/spirv_constant.h"
 #include "source/table.h"
 #include "spirv-tools/libspirv.h"
 
@@ -43,16 +44,6 @@ using get_blocks_func =
 /// @return SPV_SUCCESS if no errors are found. SPV_ERROR_INVALID_CFG otherwise
 spv_result_t PerformCfgChecks(ValidationState_t& _);
 
-/// @brief Updates the use vectors of all instructions that can be referenced
-///
-/// This function will update the vector which define where an instruction was
-/// referenced in the binary.
-///
-/// @param[in] _ the validation state of the module
-///
-/// @return SPV_SUCCESS if no errors are found.
-spv_result_t UpdateIdUse(ValidationState_t& _, const Instruction* inst);
-
 /// @brief This function checks all ID definitions dominate their use in the
 /// CFG.
 ///
@@ -197,6 +188,31 @@ spv_result_t FunctionPass(ValidationState_t& _, const Instruction* inst);
 /// Validates correctness of miscellaneous instructions.
 spv_result_t MiscPass(ValidationState_t& _, const Instruction* inst);
 
+/// Returns true if the pass of the same name checks instructions of |opcode|.
+/// The validator only runs each of those passes on the instructions it
+/// applies to.
+bool MiscPassApplies(SpvOp opcode);
+bool DebugPassApplies(SpvOp opcode);
+bool AnnotationPassApplies(SpvOp opcode);
+bool ExtensionPassApplies(SpvOp opcode);
+bool ModeSettingPassApplies(SpvOp opcode);
+bool TypePassApplies(SpvOp opcode);
+bool ConstantPassApplies(SpvOp opcode);
+bool MemoryPassApplies(SpvOp opcode);
+bool FunctionPassApplies(SpvOp opcode);
+bool ImagePassApplies(SpvOp opcode);
+bool ConversionPassApplies(SpvOp opcode);
+bool CompositesPassApplies(SpvOp opcode);
+bool ArithmeticsPassApplies(SpvOp opcode);
+bool BitwisePassApplies(SpvOp opcode);
+bool LogicalsPassApplies(SpvOp opcode);
+bool ControlFlowPassApplies(SpvOp opcode);
+bool DerivativesPassApplies(SpvOp opcode);
+bool AtomicsPassApplies(SpvOp opcode);
+bool PrimitivesPassApplies(SpvOp opcode);
+bool BarriersPassApplies(SpvOp opcode);
+bool NonUniformPassApplies(SpvOp opcode);
+
 /// Validates execution limitations.
 ///
 /// Verifies execution models are allowed for all functionality they contain.
@@ -233,6 +249,43 @@ spv_result_t ValidateBinaryAndKeepValidationState(
     const uint32_t* words, const size_t num_words, spv_diagnostic* pDiagnostic,
     std::unique_ptr<ValidationState_t>* vstate);
 
+// A module supplied to the validator one instruction at a time, such as from
+// an in-memory representation, rather than as a binary.
+struct ModuleInstructions {
+  // The words of the header of the module, in host native endianness.
+  uint32_t header[SPV_INDEX_INSTRUCTION];
+  // The number of instructions of the module.
+  size_t num_instructions;
+  // The number of words of the instructions of the module.
+  size_t num_words;
+  // The number of OpFunction instructions of the module.
+  size_t num_functions;
+  // Calls its argument with the words of each instruction of the module in
+  // order, exactly as they would be in the binary of the module, until it
+  // returns other than SPV_SUCCESS.  Returns the last result.
+  std::function<spv_result_t(
+      const std::function<spv_result_t(const uint32_t*, size_t)>&)>
+      for_each_instruction;
+  // Returns the binary of the module.  It is only called when a diagnostic
+  // names an id or disassembles an instruction.
+  std::function<std::vector<uint32_t>()> to_binary;
+};
+
+// Validates the module supplied by |module| exactly as spvValidateWithOptions
+// validates its binary, but without making the binary unless a diagnostic
+// needs it.  Each instruction is still decoded and checked by the binary
+// parser, one at a time.
+spv_result_t ValidateModuleInstructions(const spv_const_context context,
+                                        spv_const_validator_options options,
+                                        const ModuleInstructions& module,
+                                        spv_diagnostic* pDiagnostic);
+
+// Like ValidateModuleInstructions, but validates with |validator| as
+// spvIncrementalValidatorValidate does.
+spv_result_t ValidateModuleInstructions(spv_incremental_validator validator,
+                                        const ModuleInstructions& module,
+                                        spv_diagnostic* pDiagnostic);
+
 }  // namespace val
 }  // namespace spvtools
 
@@ -443,6 +443,22 @@ spv_result_t RegisterDecorations(ValidationState_t& _,
 
 }  // namespace
 
+// Keep in sync with the opcodes handled by AnnotationPass.
+bool AnnotationPassApplies(SpvOp opcode) {
+  switch (opcode) {
+    case SpvOpDecorate:
+    case SpvOpDecorateId:
+    case SpvOpMemberDecorate:
+    case SpvOpDecorationGroup:
+    case SpvOpGroupDecorate:
+    case SpvOpGroupMemberDecorate:
+      return true;
+    default:
+      break;
+  }
+  return false;
+}
+
 spv_result_t AnnotationPass(ValidationState_t& _, const Instruction* inst) {
   switch (inst->opcode()) {
     case SpvOpDecorate:
@@ -27,6 +27,44 @@ namespace spvtools {
 namespace val {
 
 // Validates correctness of arithmetic instructions.
+// Keep in sync with the opcodes handled by ArithmeticsPass.
+bool ArithmeticsPassApplies(SpvOp opcode) {
+  switch (opcode) {
+    case SpvOpFAdd:
+    case SpvOpFSub:
+    case SpvOpFMul:
+    case SpvOpFDiv:
+    case SpvOpFRem:
+    case SpvOpFMod:
+    case SpvOpFNegate:
+    case SpvOpUDiv:
+    case SpvOpUMod:
+    case SpvOpISub:
+    case SpvOpIAdd:
+    case SpvOpIMul:
+    case SpvOpSDiv:
+    case SpvOpSMod:
+    case SpvOpSRem:
+    case SpvOpSNegate:
+    case SpvOpDot:
+    case SpvOpVectorTimesScalar:
+    case SpvOpMatrixTimesScalar:
+    case SpvOpVectorTimesMatrix:
+    case SpvOpMatrixTimesVector:
+    case SpvOpMatrixTimesMatrix:
+    case SpvOpOuterProduct:
+    case SpvOpIAddCarry:
+    case SpvOpISubBorrow:
+    case SpvOpUMulExtended:
+    case SpvOpSMulExtended:
+    case SpvOpCooperativeMatrixMulAddNV:
+      return true;
+    default:
+      break;
+  }
+  return false;
+}
+
 spv_result_t ArithmeticsPass(ValidationState_t& _, const Instruction* inst) {
   const SpvOp opcode = inst->opcode();
   const uint32_t result_type = inst->type_id();
@@ -31,6 +31,20 @@ namespace spvtools {
 namespace val {
 
 // Validates correctness of barrier instructions.
+// Keep in sync with the opcodes handled by BarriersPass.
+bool BarriersPassApplies(SpvOp opcode) {
+  switch (opcode) {
+    case SpvOpControlBarrier:
+    case SpvOpMemoryBarrier:
+    case SpvOpNamedBarrierInitialize:
+    case SpvOpMemoryNamedBarrier:
+      return true;
+    default:
+      break;
+  }
+  return false;
+}
+
 spv_result_t BarriersPass(ValidationState_t& _, const Instruction* inst) {
   const SpvOp opcode = inst->opcode();
   const uint32_t result_type = inst->type_id();
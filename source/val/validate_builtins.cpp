@@ -16,6 +16,7 @@
 
 #include "source/val/validate.h"
 
+#include <algorithm>
 #include <functional>
 #include <list>
 #include <map>
@@ -470,7 +471,10 @@ class BuiltInsValidator {
   const std::vector<uint32_t>* entry_points_ = &no_entry_points;
 
   // Execution models with which the current function can be called.
-  std::set<SpvExecutionModel> execution_models_;
+  // The pointer either points to a set owned by the validation state
+  // or to no_execution_models. The pointer is guaranteed to never be null.
+  const std::set<SpvExecutionModel> no_execution_models;
+  const std::set<SpvExecutionModel>* execution_models_ = &no_execution_models;
 };
 
 void BuiltInsValidator::Update(const Instruction& inst) {
@@ -479,15 +483,8 @@ void BuiltInsValidator::Update(const Instruction& inst) {
     // Entering a function.
     assert(function_id_ == 0);
     function_id_ = inst.id();
-    execution_models_.clear();
     entry_points_ = &_.FunctionEntryPoints(function_id_);
-    // Collect execution models from all entry points from which the current
-    // function can be called.
-    for (const uint32_t entry_point : *entry_points_) {
-      if (const auto* models = _.GetExecutionModels(entry_point)) {
-        execution_models_.insert(models->begin(), models->end());
-      }
-    }
+    execution_models_ = &_.FunctionExecutionModels(function_id_);
   }
 
   if (opcode == SpvOpFunctionEnd) {
@@ -495,7 +492,7 @@ void BuiltInsValidator::Update(const Instruction& inst) {
     assert(function_id_ != 0);
     function_id_ = 0;
     entry_points_ = &no_entry_points;
-    execution_models_.clear();
+    execution_models_ = &no_execution_models;
   }
 }
 
@@ -869,7 +866,7 @@ spv_result_t BuiltInsValidator::ValidateNotCalledWithExecutionModel(
     const Instruction& referenced_inst,
     const Instruction& referenced_from_inst) {
   if (function_id_) {
-    if (execution_models_.count(execution_model)) {
+    if (execution_models_->count(execution_model)) {
       const char* execution_model_str = _.grammar().lookupOperandName(
           SPV_OPERAND_TYPE_EXECUTION_MODEL, execution_model);
       const char* built_in_str = _.grammar().lookupOperandName(
@@ -941,7 +938,7 @@ spv_result_t BuiltInsValidator::ValidateClipOrCullDistanceAtReference(
           referenced_from_inst, std::placeholders::_1));
     }
 
-    for (const SpvExecutionModel execution_model : execution_models_) {
+    for (const SpvExecutionModel execution_model : *execution_models_) {
       switch (execution_model) {
         case SpvExecutionModelFragment:
         case SpvExecutionModelVertex: {
@@ -1067,7 +1064,7 @@ spv_result_t BuiltInsValidator::ValidateFragCoordAtReference(
              << " " << GetStorageClassDesc(referenced_from_inst);
     }
 
-    for (const SpvExecutionModel execution_model : execution_models_) {
+    for (const SpvExecutionModel execution_model : *execution_models_) {
       if (execution_model != SpvExecutionModelFragment) {
         return _.diag(SPV_ERROR_INVALID_DATA, &referenced_from_inst)
                << spvLogStringForEnv(_.context()->target_env)
@@ -1127,7 +1124,7 @@ spv_result_t BuiltInsValidator::ValidateFragDepthAtReference(
              << " " << GetStorageClassDesc(referenced_from_inst);
     }
 
-    for (const SpvExecutionModel execution_model : execution_models_) {
+    for (const SpvExecutionModel execution_model : *execution_models_) {
       if (execution_model != SpvExecutionModelFragment) {
         return _.diag(SPV_ERROR_INVALID_DATA, &referenced_from_inst)
                << spvLogStringForEnv(_.context()->target_env)
@@ -1201,7 +1198,7 @@ spv_result_t BuiltInsValidator::ValidateFrontFacingAtReference(
              << " " << GetStorageClassDesc(referenced_from_inst);
     }
 
-    for (const SpvExecutionModel execution_model : execution_models_) {
+    for (const SpvExecutionModel execution_model : *execution_models_) {
       if (execution_model != SpvExecutionModelFragment) {
         return _.diag(SPV_ERROR_INVALID_DATA, &referenced_from_inst)
                << spvLogStringForEnv(_.context()->target_env)
@@ -1258,7 +1255,7 @@ spv_result_t BuiltInsValidator::ValidateHelperInvocationAtReference(
              << " " << GetStorageClassDesc(referenced_from_inst);
     }
 
-    for (const SpvExecutionModel execution_model : execution_models_) {
+    for (const SpvExecutionModel execution_model : *execution_models_) {
       if (execution_model != SpvExecutionModelFragment) {
         return _.diag(SPV_ERROR_INVALID_DATA, &referenced_from_inst)
                << "Vulkan spec allows BuiltIn HelperInvocation to be used only "
@@ -1315,7 +1312,7 @@ spv_result_t BuiltInsValidator::ValidateInvocationIdAtReference(
              << " " << GetStorageClassDesc(referenced_from_inst);
     }
 
-    for (const SpvExecutionModel execution_model : execution_models_) {
+    for (const SpvExecutionModel execution_model : *execution_models_) {
       if (execution_model != SpvExecutionModelTessellationControl &&
           execution_model != SpvExecutionModelGeometry) {
         return _.diag(SPV_ERROR_INVALID_DATA, &referenced_from_inst)
@@ -1375,7 +1372,7 @@ spv_result_t BuiltInsValidator::ValidateInstanceIndexAtReference(
              << " " << GetStorageClassDesc(referenced_from_inst);
     }
 
-    for (const SpvExecutionModel execution_model : execution_models_) {
+    for (const SpvExecutionModel execution_model : *execution_models_) {
       if (execution_model != SpvExecutionModelVertex) {
         return _.diag(SPV_ERROR_INVALID_DATA, &referenced_from_inst)
                << spvLogStringForEnv(_.context()->target_env)
@@ -1432,7 +1429,7 @@ spv_result_t BuiltInsValidator::ValidatePatchVerticesAtReference(
              << " " << GetStorageClassDesc(referenced_from_inst);
     }
 
-    for (const SpvExecutionModel execution_model : execution_models_) {
+    for (const SpvExecutionModel execution_model : *execution_models_) {
       if (execution_model != SpvExecutionModelTessellationControl &&
           execution_model != SpvExecutionModelTessellationEvaluation) {
         return _.diag(SPV_ERROR_INVALID_DATA, &referenced_from_inst)
@@ -1491,7 +1488,7 @@ spv_result_t BuiltInsValidator::ValidatePointCoordAtReference(
              << " " << GetStorageClassDesc(referenced_from_inst);
     }
 
-    for (const SpvExecutionModel execution_model : execution_models_) {
+    for (const SpvExecutionModel execution_model : *execution_models_) {
       if (execution_model != SpvExecutionModelFragment) {
         return _.diag(SPV_ERROR_INVALID_DATA, &referenced_from_inst)
                << "Vulkan spec allows BuiltIn PointCoord to be used only with "
@@ -1545,7 +1542,7 @@ spv_result_t BuiltInsValidator::ValidatePointSizeAtReference(
           referenced_from_inst, std::placeholders::_1));
     }
 
-    for (const SpvExecutionModel execution_model : execution_models_) {
+    for (const SpvExecutionModel execution_model : *execution_models_) {
       switch (execution_model) {
         case SpvExecutionModelVertex: {
           if (spv_result_t error = ValidateF32(
@@ -1656,7 +1653,7 @@ spv_result_t BuiltInsValidator::ValidatePositionAtReference(
           referenced_from_inst, std::placeholders::_1));
     }
 
-    for (const SpvExecutionModel execution_model : execution_models_) {
+    for (const SpvExecutionModel execution_model : *execution_models_) {
       switch (execution_model) {
         case SpvExecutionModelVertex: {
           if (spv_result_t error = ValidateF32Vec(
@@ -1739,7 +1736,7 @@ spv_result_t BuiltInsValidator::ValidatePositionAtReference(
              << " " << GetStorageClassDesc(referenced_from_inst);
     }
 
-    for (const SpvExecutionModel execution_model : execution_models_) {
+    for (const SpvExecutionModel execution_model : *execution_models_) {
       switch (execution_model) {
         case SpvExecutionModelVertex: {
           if (spv_result_t error = ValidateF32Vec(
@@ -1854,7 +1851,7 @@ spv_result_t BuiltInsValidator::ValidatePrimitiveIdAtReference(
           referenced_from_inst, std::placeholders::_1));
     }
 
-    for (const SpvExecutionModel execution_model : execution_models_) {
+    for (const SpvExecutionModel execution_model : *execution_models_) {
       switch (execution_model) {
         case SpvExecutionModelFragment:
         case SpvExecutionModelTessellationControl:
@@ -1928,7 +1925,7 @@ spv_result_t BuiltInsValidator::ValidateSampleIdAtReference(
              << " " << GetStorageClassDesc(referenced_from_inst);
     }
 
-    for (const SpvExecutionModel execution_model : execution_models_) {
+    for (const SpvExecutionModel execution_model : *execution_models_) {
       if (execution_model != SpvExecutionModelFragment) {
         return _.diag(SPV_ERROR_INVALID_DATA, &referenced_from_inst)
                << "Vulkan spec allows BuiltIn SampleId to be used only with "
@@ -1985,7 +1982,7 @@ spv_result_t BuiltInsValidator::ValidateSampleMaskAtReference(
              << " " << GetStorageClassDesc(referenced_from_inst);
     }
 
-    for (const SpvExecutionModel execution_model : execution_models_) {
+    for (const SpvExecutionModel execution_model : *execution_models_) {
       if (execution_model != SpvExecutionModelFragment) {
         return _.diag(SPV_ERROR_INVALID_DATA, &referenced_from_inst)
                << "Vulkan spec allows BuiltIn SampleMask to be used only "
@@ -2044,7 +2041,7 @@ spv_result_t BuiltInsValidator::ValidateSamplePositionAtReference(
              << " " << GetStorageClassDesc(referenced_from_inst);
     }
 
-    for (const SpvExecutionModel execution_model : execution_models_) {
+    for (const SpvExecutionModel execution_model : *execution_models_) {
       if (execution_model != SpvExecutionModelFragment) {
         return _.diag(SPV_ERROR_INVALID_DATA, &referenced_from_inst)
                << "Vulkan spec allows BuiltIn SamplePosition to be used only "
@@ -2102,7 +2099,7 @@ spv_result_t BuiltInsValidator::ValidateTessCoordAtReference(
              << " " << GetStorageClassDesc(referenced_from_inst);
     }
 
-    for (const SpvExecutionModel execution_model : execution_models_) {
+    for (const SpvExecutionModel execution_model : *execution_models_) {
       if (execution_model != SpvExecutionModelTessellationEvaluation) {
         return _.diag(SPV_ERROR_INVALID_DATA, &referenced_from_inst)
                << "Vulkan spec allows BuiltIn TessCoord to be used only with "
@@ -2207,7 +2204,7 @@ spv_result_t BuiltInsValidator::ValidateTessLevelAtReference(
           referenced_from_inst, std::placeholders::_1));
     }
 
-    for (const SpvExecutionModel execution_model : execution_models_) {
+    for (const SpvExecutionModel execution_model : *execution_models_) {
       switch (execution_model) {
         case SpvExecutionModelTessellationControl:
         case SpvExecutionModelTessellationEvaluation: {
@@ -2282,7 +2279,7 @@ spv_result_t BuiltInsValidator::ValidateInstanceIdAtReference(
     const Instruction& referenced_inst,
     const Instruction& referenced_from_inst) {
   if (spvIsVulkanEnv(_.context()->target_env)) {
-    for (const SpvExecutionModel execution_model : execution_models_) {
+    for (const SpvExecutionModel execution_model : *execution_models_) {
       switch (execution_model) {
         case SpvExecutionModelIntersectionNV:
         case SpvExecutionModelClosestHitNV:
@@ -2347,7 +2344,7 @@ spv_result_t BuiltInsValidator::ValidateLocalInvocationIndexAtReference(
              << " " << GetStorageClassDesc(referenced_from_inst);
     }
 
-    for (const SpvExecutionModel execution_model : execution_models_) {
+    for (const SpvExecutionModel execution_model : *execution_models_) {
       if (execution_model != SpvExecutionModelGLCompute) {
         return _.diag(SPV_ERROR_INVALID_DATA, &referenced_from_inst)
                << "WebGPU spec allows BuiltIn VertexIndex to be used only "
@@ -2386,7 +2383,7 @@ spv_result_t BuiltInsValidator::ValidateVertexIndexAtReference(
              << " " << GetStorageClassDesc(referenced_from_inst);
     }
 
-    for (const SpvExecutionModel execution_model : execution_models_) {
+    for (const SpvExecutionModel execution_model : *execution_models_) {
       if (execution_model != SpvExecutionModelVertex) {
         return _.diag(SPV_ERROR_INVALID_DATA, &referenced_from_inst)
                << spvLogStringForEnv(_.context()->target_env)
@@ -2500,7 +2497,7 @@ spv_result_t BuiltInsValidator::ValidateLayerOrViewportIndexAtReference(
           referenced_from_inst, std::placeholders::_1));
     }
 
-    for (const SpvExecutionModel execution_model : execution_models_) {
+    for (const SpvExecutionModel execution_model : *execution_models_) {
       switch (execution_model) {
         case SpvExecutionModelGeometry:
         case SpvExecutionModelFragment:
@@ -2589,7 +2586,7 @@ spv_result_t BuiltInsValidator::ValidateComputeShaderI32Vec3InputAtReference(
              << " " << GetStorageClassDesc(referenced_from_inst);
     }
 
-    for (const SpvExecutionModel execution_model : execution_models_) {
+    for (const SpvExecutionModel execution_model : *execution_models_) {
       bool has_vulkan_model = execution_model == SpvExecutionModelGLCompute ||
                               execution_model == SpvExecutionModelTaskNV ||
                               execution_model == SpvExecutionModelMeshNV;
@@ -2670,7 +2667,7 @@ spv_result_t BuiltInsValidator::ValidateComputeI32InputAtReference(
              << " " << GetStorageClassDesc(referenced_from_inst);
     }
 
-    for (const SpvExecutionModel execution_model : execution_models_) {
+    for (const SpvExecutionModel execution_model : *execution_models_) {
       bool has_vulkan_model = execution_model == SpvExecutionModelGLCompute ||
                               execution_model == SpvExecutionModelTaskNV ||
                               execution_model == SpvExecutionModelMeshNV;
@@ -2818,7 +2815,7 @@ spv_result_t BuiltInsValidator::ValidateWorkgroupSizeAtReference(
     const Instruction& referenced_inst,
     const Instruction& referenced_from_inst) {
   if (spvIsVulkanOrWebGPUEnv(_.context()->target_env)) {
-    for (const SpvExecutionModel execution_model : execution_models_) {
+    for (const SpvExecutionModel execution_model : *execution_models_) {
       if (execution_model != SpvExecutionModelGLCompute) {
         return _.diag(SPV_ERROR_INVALID_DATA, &referenced_from_inst)
                << spvLogStringForEnv(_.context()->target_env)
@@ -3094,25 +3091,13 @@ spv_result_t BuiltInsValidator::ValidateSingleBuiltInAtDefinition(
 }
 
 spv_result_t BuiltInsValidator::ValidateBuiltInsAtDefinition() {
-  for (const auto& kv : _.id_decorations()) {
-    const uint32_t id = kv.first;
-    const auto& decorations = kv.second;
-    if (decorations.empty()) {
-      continue;
-    }
-
-    const Instruction* inst = _.FindDef(id);
+  for (const auto& ref : _.decorations_of_kinds({SpvDecorationBuiltIn})) {
+    const Instruction* inst = _.FindDef(ref.id);
     assert(inst);
 
-    for (const auto& decoration : kv.second) {
-      if (decoration.dec_type() != SpvDecorationBuiltIn) {
-        continue;
-      }
-
-      if (spv_result_t error =
-              ValidateSingleBuiltInAtDefinition(decoration, *inst)) {
-        return error;
-      }
+    if (spv_result_t error =
+            ValidateSingleBuiltInAtDefinition(_.decoration(ref), *inst)) {
+      return error;
     }
   }
 
@@ -3133,10 +3118,11 @@ spv_result_t BuiltInsValidator::Run() {
 
   // Second pass: validate every id reference in the module using
   // rules in id_to_at_reference_checks_.
+  std::vector<uint32_t> already_checked;
   for (const Instruction& inst : _.ordered_instructions()) {
     Update(inst);
 
-    std::set<uint32_t> already_checked;
+    already_checked.clear();
 
     for (const auto& operand : inst.operands()) {
       if (!spvIsIdType(operand.type)) {
@@ -3150,20 +3136,26 @@ spv_result_t BuiltInsValidator::Run() {
         continue;
       }
 
-      if (!already_checked.insert(id).second) {
-        // The instruction has already referenced this id.
-        continue;
-      }
-
       // Instruction references the id. Run all checks associated with the id
       // on the instruction. id_to_at_reference_checks_ can be modified in the
       // process, iterators are safe because it's a tree-based map.
       const auto it = id_to_at_reference_checks_.find(id);
-      if (it != id_to_at_reference_checks_.end()) {
-        for (const auto& check : it->second) {
-          if (spv_result_t error = check(inst)) {
-            return error;
-          }
+      if (it == id_to_at_reference_checks_.end()) {
+        continue;
+      }
+
+      // Few of the ids of an instruction have checks, so a linear search is
+      // enough to skip those already checked.
+      if (std::find(already_checked.begin(), already_checked.end(), id) !=
+          already_checked.end()) {
+        // The instruction has already referenced this id.
+        continue;
+      }
+      already_checked.push_back(id);
+
+      for (const auto& check : it->second) {
+        if (spv_result_t error = check(inst)) {
+          return error;
         }
       }
     }
@@ -962,6 +962,7 @@ spv_result_t PerformCfgChecks(ValidationState_t& _) {
       for (auto edge : postdom_edges) {
         edge.first->SetImmediatePostDominator(edge.second);
       }
+      function.NumberDominatorTrees();
       /// calculate back edges.
       CFA<BasicBlock>::DepthFirstTraversal(
           function.pseudo_entry_block(),
@@ -978,10 +979,17 @@ spv_result_t PerformCfgChecks(ValidationState_t& _) {
     if (!blocks.empty()) {
       // Check if the order of blocks in the binary appear before the blocks
       // they dominate
+      std::unordered_map<const BasicBlock*, size_t> block_positions;
+      for (size_t i = 0; i < blocks.size(); ++i) {
+        block_positions.emplace(blocks[i], i);
+      }
       for (auto block = begin(blocks) + 1; block != end(blocks); ++block) {
         if (auto idom = (*block)->immediate_dominator()) {
+          const auto idom_position = block_positions.find(idom);
           if (idom != function.pseudo_entry_block() &&
-              block == std::find(begin(blocks), block, idom)) {
+              (idom_position == block_positions.end() ||
+               idom_position->second >=
+                   size_t(std::distance(begin(blocks), block)))) {
             return _.diag(SPV_ERROR_INVALID_CFG, _.FindDef(idom->id()))
                    << "Block " << _.getIdName((*block)->id())
                    << " appears in the binary before its dominator "
@@ -1099,6 +1107,22 @@ spv_result_t CfgPass(ValidationState_t& _, const Instruction* inst) {
   return SPV_SUCCESS;
 }
 
+// Keep in sync with the opcodes handled by ControlFlowPass.
+bool ControlFlowPassApplies(SpvOp opcode) {
+  switch (opcode) {
+    case SpvOpPhi:
+    case SpvOpBranch:
+    case SpvOpBranchConditional:
+    case SpvOpReturnValue:
+    case SpvOpSwitch:
+    case SpvOpLoopMerge:
+      return true;
+    default:
+      break;
+  }
+  return false;
+}
+
 spv_result_t ControlFlowPass(ValidationState_t& _, const Instruction* inst) {
   switch (inst->opcode()) {
     case SpvOpPhi:
@@ -588,6 +588,25 @@ spv_result_t ValidateCopyLogical(ValidationState_t& _,
 }  // anonymous namespace
 
 // Validates correctness of composite instructions.
+// Keep in sync with the opcodes handled by CompositesPass.
+bool CompositesPassApplies(SpvOp opcode) {
+  switch (opcode) {
+    case SpvOpVectorExtractDynamic:
+    case SpvOpVectorInsertDynamic:
+    case SpvOpVectorShuffle:
+    case SpvOpCompositeConstruct:
+    case SpvOpCompositeExtract:
+    case SpvOpCompositeInsert:
+    case SpvOpCopyObject:
+    case SpvOpTranspose:
+    case SpvOpCopyLogical:
+      return true;
+    default:
+      break;
+  }
+  return false;
+}
+
 spv_result_t CompositesPass(ValidationState_t& _, const Instruction* inst) {
   switch (inst->opcode()) {
     case SpvOpVectorExtractDynamic:
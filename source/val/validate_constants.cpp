@@ -295,7 +295,7 @@ spv_result_t ValidateConstantSampler(ValidationState_t& _,
 // True if instruction defines a type that can have a null value, as defined by
 // the SPIR-V spec.  Tracks composite-type components through module to check
 // nullability transitively.
-bool IsTypeNullable(const std::vector<uint32_t>& instruction,
+bool IsTypeNullable(utils::Span<uint32_t> instruction,
                     const ValidationState_t& _) {
   uint16_t opcode;
   uint16_t word_count;
@@ -423,6 +423,27 @@ spv_result_t ValidateSpecConstantOp(ValidationState_t& _,
 
 }  // namespace
 
+// Keep in sync with the opcodes handled by ConstantPass.
+bool ConstantPassApplies(SpvOp opcode) {
+  if (spvOpcodeIsConstant(opcode)) return true;
+  switch (opcode) {
+    case SpvOpConstantTrue:
+    case SpvOpConstantFalse:
+    case SpvOpSpecConstantTrue:
+    case SpvOpSpecConstantFalse:
+    case SpvOpConstantComposite:
+    case SpvOpSpecConstantComposite:
+    case SpvOpConstantSampler:
+    case SpvOpConstantNull:
+    case SpvOpSpecConstant:
+    case SpvOpSpecConstantOp:
+      return true;
+    default:
+      break;
+  }
+  return false;
+}
+
 spv_result_t ConstantPass(ValidationState_t& _, const Instruction* inst) {
   switch (inst->opcode()) {
     case SpvOpConstantTrue:
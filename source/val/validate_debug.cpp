@@ -55,6 +55,18 @@ spv_result_t ValidateLine(ValidationState_t& _, const Instruction* inst) {
 
 }  // namespace
 
+// Keep in sync with the opcodes handled by DebugPass.
+bool DebugPassApplies(SpvOp opcode) {
+  switch (opcode) {
+    case SpvOpMemberName:
+    case SpvOpLine:
+      return true;
+    default:
+      break;
+  }
+  return false;
+}
+
 spv_result_t DebugPass(ValidationState_t& _, const Instruction* inst) {
   switch (inst->opcode()) {
     case SpvOpMemberName:
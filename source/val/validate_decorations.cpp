@@ -205,6 +205,10 @@ uint32_t getBaseAlignment(uint32_t member_id, bool roundUp,
       if (roundUp) baseAlignment = align(baseAlignment, 16u);
       break;
     case SpvOpTypeStruct: {
+      const auto property =
+          roundUp ? ValidationState_t::StructLayout::kExtendedAlignment
+                  : ValidationState_t::StructLayout::kBaseAlignment;
+      if (vstate.GetStructLayout(member_id, property, &baseAlignment)) break;
       const auto members = getStructMembers(member_id, vstate);
       for (uint32_t memberIdx = 0, numMembers = uint32_t(members.size());
            memberIdx < numMembers; ++memberIdx) {
@@ -216,6 +220,7 @@ uint32_t getBaseAlignment(uint32_t member_id, bool roundUp,
             getBaseAlignment(id, roundUp, constraint, constraints, vstate));
       }
       if (roundUp) baseAlignment = align(baseAlignment, 16u);
+      vstate.SetStructLayout(member_id, property, baseAlignment);
       break;
     }
     case SpvOpTypePointer:
@@ -245,8 +250,13 @@ uint32_t getScalarAlignment(uint32_t type_id, ValidationState_t& vstate) {
       return getScalarAlignment(compositeMemberTypeId, vstate);
     }
     case SpvOpTypeStruct: {
-      const auto members = getStructMembers(type_id, vstate);
       uint32_t max_member_alignment = 1;
+      if (vstate.GetStructLayout(
+              type_id, ValidationState_t::StructLayout::kScalarAlignment,
+              &max_member_alignment)) {
+        return max_member_alignment;
+      }
+      const auto members = getStructMembers(type_id, vstate);
       for (uint32_t memberIdx = 0, numMembers = uint32_t(members.size());
            memberIdx < numMembers; ++memberIdx) {
         const auto id = members[memberIdx];
@@ -255,6 +265,9 @@ uint32_t getScalarAlignment(uint32_t type_id, ValidationState_t& vstate) {
           max_member_alignment = member_alignment;
         }
       }
+      vstate.SetStructLayout(type_id,
+                             ValidationState_t::StructLayout::kScalarAlignment,
+                             max_member_alignment);
       return max_member_alignment;
     } break;
     case SpvOpTypePointer:
@@ -318,6 +331,12 @@ uint32_t getSize(uint32_t member_id, const LayoutConstraints& inherited,
       }
     }
     case SpvOpTypeStruct: {
+      uint32_t size = 0;
+      if (vstate.GetStructLayout(member_id,
+                                 ValidationState_t::StructLayout::kSize,
+                                 &size)) {
+        return size;
+      }
       const auto& members = getStructMembers(member_id, vstate);
       if (members.empty()) return 0;
       const auto lastIdx = uint32_t(members.size() - 1);
@@ -334,7 +353,10 @@ uint32_t getSize(uint32_t member_id, const LayoutConstraints& inherited,
       // has been checked earlier in the flow.
       assert(offset != 0xffffffff);
       const auto& constraint = constraints[std::make_pair(lastMember, lastIdx)];
-      return offset + getSize(lastMember, constraint, constraints, vstate);
+      size = offset + getSize(lastMember, constraint, constraints, vstate);
+      vstate.SetStructLayout(member_id, ValidationState_t::StructLayout::kSize,
+                             size);
+      return size;
     }
     case SpvOpTypePointer:
       return vstate.pointer_size_and_alignment();
@@ -388,6 +410,12 @@ spv_result_t checkLayout(uint32_t struct_id, const char* storage_class_str,
   // standard layout extension is being used.
   if (vstate.options()->uniform_buffer_standard_layout) blockRules = false;
 
+  // The result only depends on the struct, the rules and the offset, and
+  // failures end the validation, so each layout is checked once.
+  if (vstate.IsStructLayoutChecked(struct_id, blockRules, incoming_offset)) {
+    return SPV_SUCCESS;
+  }
+
   // Relaxed layout and scalar layout can both be in effect at the same time.
   // For example, relaxed layout is implied by Vulkan 1.1.  But scalar layout
   // is more permissive than relaxed layout.
@@ -583,6 +611,7 @@ spv_result_t checkLayout(uint32_t struct_id, const char* storage_class_str,
       nextValidOffset = align(nextValidOffset, alignment);
     }
   }
+  vstate.RegisterCheckedStructLayout(struct_id, blockRules, incoming_offset);
   return SPV_SUCCESS;
 }
 
@@ -797,6 +826,12 @@ void ComputeMemberConstraintsForStruct(MemberConstraints* constraints,
                                        ValidationState_t& vstate) {
   assert(constraints);
   const auto& members = getStructMembers(struct_id, vstate);
+  // The constraints of the members of a struct do not depend on where it is
+  // used, so they are only computed the first time it is reached.
+  if (!members.empty() &&
+      constraints->count(std::make_pair(struct_id, 0u)) != 0) {
+    return;
+  }
   for (uint32_t memberIdx = 0, numMembers = uint32_t(members.size());
        memberIdx < numMembers; memberIdx++) {
     LayoutConstraints& constraint =
@@ -866,6 +901,8 @@ void ComputeMemberConstraintsForArray(MemberConstraints* constraints,
 spv_result_t CheckDecorationsOfBuffers(ValidationState_t& vstate) {
   // Set of entry points that are known to use a push constant.
   std::unordered_set<uint32_t> uses_push_constant;
+  // The layout constraints of the members of all the structs used by buffers.
+  MemberConstraints constraints;
   for (const auto& inst : vstate.ordered_instructions()) {
     const auto& words = inst.words();
     if (SpvOpVariable == inst.opcode()) {
@@ -883,7 +920,7 @@ spv_result_t CheckDecorationsOfBuffers(ValidationState_t& vstate) {
         // Vulkan 14.5.1: There must be no more than one PushConstant block
         // per entry point.
         if (push_constant) {
-          auto entry_points = vstate.EntryPointReferences(var_id);
+          const auto& entry_points = vstate.EntryPointReferences(var_id);
           for (auto ep_id : entry_points) {
             const bool already_used = !uses_push_constant.insert(ep_id).second;
             if (already_used) {
@@ -899,7 +936,7 @@ spv_result_t CheckDecorationsOfBuffers(ValidationState_t& vstate) {
         // Vulkan 14.5.2: Check DescriptorSet and Binding decoration for
         // UniformConstant which cannot be a struct.
         if (uniform_constant) {
-          auto entry_points = vstate.EntryPointReferences(var_id);
+          const auto& entry_points = vstate.EntryPointReferences(var_id);
           if (!entry_points.empty() &&
               !hasDecoration(var_id, SpvDecorationDescriptorSet, vstate)) {
             return vstate.diag(SPV_ERROR_INVALID_ID, vstate.FindDef(var_id))
@@ -927,7 +964,7 @@ spv_result_t CheckDecorationsOfBuffers(ValidationState_t& vstate) {
             hasDecoration(var_id, SpvDecorationBufferBlock, vstate);
         if ((uniform && (has_block || has_buffer_block)) ||
             (storage_buffer && has_block)) {
-          auto entry_points = vstate.EntryPointReferences(var_id);
+          const auto& entry_points = vstate.EntryPointReferences(var_id);
           if (!entry_points.empty() &&
               !hasDecoration(var_id, SpvDecorationBinding, vstate)) {
             return vstate.diag(SPV_ERROR_INVALID_ID, vstate.FindDef(var_id))
@@ -955,7 +992,6 @@ spv_result_t CheckDecorationsOfBuffers(ValidationState_t& vstate) {
         }
         // Struct requirement is checked on variables so just move on here.
         if (SpvOpTypeStruct != id_inst->opcode()) continue;
-        MemberConstraints constraints;
         ComputeMemberConstraintsForStruct(&constraints, id, LayoutConstraints(),
                                           vstate);
         // Prepare for messages
@@ -1002,7 +1038,7 @@ spv_result_t CheckDecorationsOfBuffers(ValidationState_t& vstate) {
           // Vulkan 14.5.2: Check DescriptorSet and Binding decoration for
           // Uniform and StorageBuffer variables.
           if (uniform || storage_buffer) {
-            auto entry_points = vstate.EntryPointReferences(var_id);
+            const auto& entry_points = vstate.EntryPointReferences(var_id);
             if (!entry_points.empty() &&
                 !hasDecoration(var_id, SpvDecorationDescriptorSet, vstate)) {
               return vstate.diag(SPV_ERROR_INVALID_ID, vstate.FindDef(var_id))
@@ -1233,27 +1269,34 @@ spv_result_t CheckVulkanMemoryModelDeprecatedDecorations(
     ValidationState_t& vstate) {
   if (vstate.memory_model() != SpvMemoryModelVulkanKHR) return SPV_SUCCESS;
 
-  std::string msg;
-  std::ostringstream str(msg);
-  for (const auto& def : vstate.all_definitions()) {
-    const auto inst = def.second;
-    const auto id = inst->id();
-    for (const auto& dec : vstate.id_decorations(id)) {
-      const auto member = dec.struct_member_index();
-      if (dec.dec_type() == SpvDecorationCoherent ||
-          dec.dec_type() == SpvDecorationVolatile) {
-        str << (dec.dec_type() == SpvDecorationCoherent ? "Coherent"
-                                                        : "Volatile");
-        str << " decoration targeting " << vstate.getIdName(id);
-        if (member != Decoration::kInvalidMember) {
-          str << " (member index " << member << ")";
-        }
-        str << " is banned when using the Vulkan memory model.";
-        return vstate.diag(SPV_ERROR_INVALID_ID, inst) << str.str();
+  // Reports the decoration whose target comes first in the module, and the
+  // first of the decorations of that target.
+  const Instruction* inst = nullptr;
+  const ValidationState_t::DecorationRef* first = nullptr;
+  for (const auto dec_type : {SpvDecorationCoherent, SpvDecorationVolatile}) {
+    for (const auto& ref : vstate.decorations_of_kind(dec_type)) {
+      const Instruction* target = vstate.FindDef(ref.id);
+      if (!target) continue;
+      if (!first || target < inst ||
+          (target == inst && ref.index < first->index)) {
+        inst = target;
+        first = &ref;
       }
     }
   }
-  return SPV_SUCCESS;
+  if (!first) return SPV_SUCCESS;
+
+  const auto& dec = vstate.decoration(*first);
+  const auto member = dec.struct_member_index();
+  std::string msg;
+  std::ostringstream str(msg);
+  str << (dec.dec_type() == SpvDecorationCoherent ? "Coherent" : "Volatile");
+  str << " decoration targeting " << vstate.getIdName(first->id);
+  if (member != Decoration::kInvalidMember) {
+    str << " (member index " << member << ")";
+  }
+  str << " is banned when using the Vulkan memory model.";
+  return vstate.diag(SPV_ERROR_INVALID_ID, inst) << str.str();
 }
 
 // Returns SPV_SUCCESS if validation rules are satisfied for FPRoundingMode
@@ -1538,41 +1581,42 @@ spv_result_t CheckDecorationsFromDecoration(ValidationState_t& vstate) {
   // Some rules are only checked for shaders.
   const bool is_shader = vstate.HasCapability(SpvCapabilityShader);
 
-  for (const auto& kv : vstate.id_decorations()) {
-    const uint32_t id = kv.first;
-    const auto& decorations = kv.second;
-    if (decorations.empty()) continue;
-
-    const Instruction* inst = vstate.FindDef(id);
+  // Only the decorations of the kinds checked here are visited, in the order
+  // of their targets.
+  const auto refs = vstate.decorations_of_kinds(
+      {SpvDecorationComponent, SpvDecorationFPRoundingMode,
+       SpvDecorationNonWritable, SpvDecorationUniform, SpvDecorationUniformId,
+       SpvDecorationNoSignedWrap, SpvDecorationNoUnsignedWrap});
+  for (const auto& ref : refs) {
+    const Instruction* inst = vstate.FindDef(ref.id);
     assert(inst);
 
     // We assume the decorations applied to a decoration group have already
     // been propagated down to the group members.
     if (inst->opcode() == SpvOpDecorationGroup) continue;
 
-    for (const auto& decoration : decorations) {
-      switch (decoration.dec_type()) {
-        case SpvDecorationComponent:
-          PASS_OR_BAIL(CheckComponentDecoration(vstate, *inst, decoration));
-          break;
-        case SpvDecorationFPRoundingMode:
-          if (is_shader)
-            PASS_OR_BAIL(CheckFPRoundingModeForShaders(vstate, *inst));
-          break;
-        case SpvDecorationNonWritable:
-          PASS_OR_BAIL(CheckNonWritableDecoration(vstate, *inst, decoration));
-          break;
-        case SpvDecorationUniform:
-        case SpvDecorationUniformId:
-          PASS_OR_BAIL(CheckUniformDecoration(vstate, *inst, decoration));
-          break;
-        case SpvDecorationNoSignedWrap:
-        case SpvDecorationNoUnsignedWrap:
-          PASS_OR_BAIL(CheckIntegerWrapDecoration(vstate, *inst, decoration));
-          break;
-        default:
-          break;
-      }
+    const auto& decoration = vstate.decoration(ref);
+    switch (decoration.dec_type()) {
+      case SpvDecorationComponent:
+        PASS_OR_BAIL(CheckComponentDecoration(vstate, *inst, decoration));
+        break;
+      case SpvDecorationFPRoundingMode:
+        if (is_shader)
+          PASS_OR_BAIL(CheckFPRoundingModeForShaders(vstate, *inst));
+        break;
+      case SpvDecorationNonWritable:
+        PASS_OR_BAIL(CheckNonWritableDecoration(vstate, *inst, decoration));
+        break;
+      case SpvDecorationUniform:
+      case SpvDecorationUniformId:
+        PASS_OR_BAIL(CheckUniformDecoration(vstate, *inst, decoration));
+        break;
+      case SpvDecorationNoSignedWrap:
+      case SpvDecorationNoUnsignedWrap:
+        PASS_OR_BAIL(CheckIntegerWrapDecoration(vstate, *inst, decoration));
+        break;
+      default:
+        break;
     }
   }
   return SPV_SUCCESS;
@@ -27,6 +27,25 @@ namespace spvtools {
 namespace val {
 
 // Validates correctness of derivative instructions.
+// Keep in sync with the opcodes handled by DerivativesPass.
+bool DerivativesPassApplies(SpvOp opcode) {
+  switch (opcode) {
+    case SpvOpDPdx:
+    case SpvOpDPdy:
+    case SpvOpFwidth:
+    case SpvOpDPdxFine:
+    case SpvOpDPdyFine:
+    case SpvOpFwidthFine:
+    case SpvOpDPdxCoarse:
+    case SpvOpDPdyCoarse:
+    case SpvOpFwidthCoarse:
+      return true;
+    default:
+      break;
+  }
+  return false;
+}
+
 spv_result_t DerivativesPass(ValidationState_t& _, const Instruction* inst) {
   const SpvOp opcode = inst->opcode();
   const uint32_t result_type = inst->type_id();
@@ -14,6 +14,10 @@
 
 #include "source/val/validate.h"
 
+#include <algorithm>
+#include <string>
+#include <vector>
+
 #include "source/val/function.h"
 #include "source/val/validation_state.h"
 
@@ -32,6 +36,9 @@ spv_result_t ValidateExecutionLimitations(ValidationState_t& _,
            << "Internal error: missing function id " << inst->id() << ".";
   }
 
+  // The entry points calling a function share few execution models, so each
+  // model is checked once for the function.
+  std::vector<SpvExecutionModel> compatible_models;
   for (uint32_t entry_id : _.FunctionEntryPoints(inst->id())) {
     const auto* models = _.GetExecutionModels(entry_id);
     if (models) {
@@ -41,21 +48,30 @@ spv_result_t ValidateExecutionLimitations(ValidationState_t& _,
                << entry_id << ".";
       }
       for (const auto model : *models) {
-        std::string reason;
-        if (!func->IsCompatibleWithExecutionModel(model, &reason)) {
-          return _.diag(SPV_ERROR_INVALID_ID, inst)
-                 << "OpEntryPoint Entry Point <id> '" << _.getIdName(entry_id)
-                 << "'s callgraph contains function <id> "
-                 << _.getIdName(inst->id())
-                 << ", which cannot be used with the current execution "
-                    "model:\n"
-                 << reason;
+        if (std::find(compatible_models.begin(), compatible_models.end(),
+                      model) != compatible_models.end()) {
+          continue;
         }
+        // The reason is only gathered for the diagnostic.
+        if (func->IsCompatibleWithExecutionModel(model, nullptr)) {
+          compatible_models.push_back(model);
+          continue;
+        }
+        std::string reason;
+        func->IsCompatibleWithExecutionModel(model, &reason);
+        return _.diag(SPV_ERROR_INVALID_ID, inst)
+               << "OpEntryPoint Entry Point <id> '" << _.getIdName(entry_id)
+               << "'s callgraph contains function <id> "
+               << _.getIdName(inst->id())
+               << ", which cannot be used with the current execution "
+                  "model:\n"
+               << reason;
       }
     }
 
-    std::string reason;
-    if (!func->CheckLimitations(_, _.function(entry_id), &reason)) {
+    if (!func->CheckLimitations(_, _.function(entry_id), nullptr)) {
+      std::string reason;
+      func->CheckLimitations(_, _.function(entry_id), &reason);
       return _.diag(SPV_ERROR_INVALID_ID, inst)
              << "OpEntryPoint Entry Point <id> '" << _.getIdName(entry_id)
              << "'s callgraph contains function <id> "
@@ -2033,6 +2033,19 @@ spv_result_t ValidateExtInst(ValidationState_t& _, const Instruction* inst) {
   return SPV_SUCCESS;
 }
 
+// Keep in sync with the opcodes handled by ExtensionPass.
+bool ExtensionPassApplies(SpvOp opcode) {
+  switch (opcode) {
+    case SpvOpExtension:
+    case SpvOpExtInstImport:
+    case SpvOpExtInst:
+      return true;
+    default:
+      break;
+  }
+  return false;
+}
+
 spv_result_t ExtensionPass(ValidationState_t& _, const Instruction* inst) {
   const SpvOp opcode = inst->opcode();
   if (opcode == SpvOpExtension) return ValidateExtension(_, inst);
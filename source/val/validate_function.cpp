@@ -335,6 +335,19 @@ spv_result_t ValidateFunctionCall(ValidationState_t& _,
 
 }  // namespace
 
+// Keep in sync with the opcodes handled by FunctionPass.
+bool FunctionPassApplies(SpvOp opcode) {
+  switch (opcode) {
+    case SpvOpFunction:
+    case SpvOpFunctionParameter:
+    case SpvOpFunctionCall:
+      return true;
+    default:
+      break;
+  }
+  return false;
+}
+
 spv_result_t FunctionPass(ValidationState_t& _, const Instruction* inst) {
   switch (inst->opcode()) {
     case SpvOpFunction:
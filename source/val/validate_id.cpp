@@ -37,19 +37,6 @@
 namespace spvtools {
 namespace val {
 
-spv_result_t UpdateIdUse(ValidationState_t& _, const Instruction* inst) {
-  for (auto& operand : inst->operands()) {
-    const spv_operand_type_t& type = operand.type;
-    const uint32_t operand_id = inst->word(operand.offset);
-    if (spvIsIdType(type) && type != SPV_OPERAND_TYPE_RESULT_ID) {
-      if (auto def = _.FindDef(operand_id))
-        def->RegisterUse(inst, operand.offset);
-    }
-  }
-
-  return SPV_SUCCESS;
-}
-
 /// This function checks all ID definitions dominate their use in the CFG.
 ///
 /// This function will iterate over all ID definitions that are defined in the
@@ -75,7 +62,7 @@ spv_result_t CheckIdDefinitionDominateUse(ValidationState_t& _) {
               if (phi_ids.insert(use->id()).second) {
                 phi_instructions.push_back(use);
               }
-            } else if (!block->dominates(*use->block())) {
+            } else if (use_block != block && !block->dominates(*use_block)) {
               return _.diag(SPV_ERROR_INVALID_ID, use_block->label())
                      << "ID " << _.getIdName(inst.id()) << " defined in block "
                      << _.getIdName(block->id())
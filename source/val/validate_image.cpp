@@ -70,51 +70,6 @@ bool CheckAllImageOperandsHandled() {
   return false;
 }
 
-// Used by GetImageTypeInfo. See OpTypeImage spec for more information.
-struct ImageTypeInfo {
-  uint32_t sampled_type = 0;
-  SpvDim dim = SpvDimMax;
-  uint32_t depth = 0;
-  uint32_t arrayed = 0;
-  uint32_t multisampled = 0;
-  uint32_t sampled = 0;
-  SpvImageFormat format = SpvImageFormatMax;
-  SpvAccessQualifier access_qualifier = SpvAccessQualifierMax;
-};
-
-// Provides information on image type. |id| should be object of either
-// OpTypeImage or OpTypeSampledImage type. Returns false in case of failure
-// (not a valid id, failed to parse the instruction, etc).
-bool GetImageTypeInfo(const ValidationState_t& _, uint32_t id,
-                      ImageTypeInfo* info) {
-  if (!id || !info) return false;
-
-  const Instruction* inst = _.FindDef(id);
-  assert(inst);
-
-  if (inst->opcode() == SpvOpTypeSampledImage) {
-    inst = _.FindDef(inst->word(2));
-    assert(inst);
-  }
-
-  if (inst->opcode() != SpvOpTypeImage) return false;
-
-  const size_t num_words = inst->words().size();
-  if (num_words != 9 && num_words != 10) return false;
-
-  info->sampled_type = inst->word(2);
-  info->dim = static_cast<SpvDim>(inst->word(3));
-  info->depth = inst->word(4);
-  info->arrayed = inst->word(5);
-  info->multisampled = inst->word(6);
-  info->sampled = inst->word(7);
-  info->format = static_cast<SpvImageFormat>(inst->word(8));
-  info->access_qualifier = num_words < 10
-                               ? SpvAccessQualifierMax
-                               : static_cast<SpvAccessQualifier>(inst->word(9));
-  return true;
-}
-
 bool IsImplicitLod(SpvOp opcode) {
   switch (opcode) {
     case SpvOpImageSampleImplicitLod:
@@ -705,7 +660,7 @@ spv_result_t ValidateTypeImage(ValidationState_t& _, const Instruction* inst) {
   assert(inst->type_id() == 0);
 
   ImageTypeInfo info;
-  if (!GetImageTypeInfo(_, inst->word(1), &info)) {
+  if (!_.GetImageTypeInfo(inst->word(1), &info)) {
     return _.diag(SPV_ERROR_INVALID_DATA, inst)
            << "Corrupt image type definition";
   }
@@ -855,7 +810,7 @@ spv_result_t ValidateSampledImage(ValidationState_t& _,
   }
 
   ImageTypeInfo info;
-  if (!GetImageTypeInfo(_, image_type, &info)) {
+  if (!_.GetImageTypeInfo(image_type, &info)) {
     return _.diag(SPV_ERROR_INVALID_DATA, inst)
            << "Corrupt image type definition";
   }
@@ -973,7 +928,7 @@ spv_result_t ValidateImageTexelPointer(ValidationState_t& _,
   }
 
   ImageTypeInfo info;
-  if (!GetImageTypeInfo(_, image_type, &info)) {
+  if (!_.GetImageTypeInfo(image_type, &info)) {
     return _.diag(SPV_ERROR_INVALID_DATA, inst)
            << "Corrupt image type definition";
   }
@@ -1067,7 +1022,7 @@ spv_result_t ValidateImageLod(ValidationState_t& _, const Instruction* inst) {
   }
 
   ImageTypeInfo info;
-  if (!GetImageTypeInfo(_, image_type, &info)) {
+  if (!_.GetImageTypeInfo(image_type, &info)) {
     return _.diag(SPV_ERROR_INVALID_DATA, inst)
            << "Corrupt image type definition";
   }
@@ -1154,7 +1109,7 @@ spv_result_t ValidateImageDrefLod(ValidationState_t& _,
   }
 
   ImageTypeInfo info;
-  if (!GetImageTypeInfo(_, image_type, &info)) {
+  if (!_.GetImageTypeInfo(image_type, &info)) {
     return _.diag(SPV_ERROR_INVALID_DATA, inst)
            << "Corrupt image type definition";
   }
@@ -1227,7 +1182,7 @@ spv_result_t ValidateImageFetch(ValidationState_t& _, const Instruction* inst) {
   }
 
   ImageTypeInfo info;
-  if (!GetImageTypeInfo(_, image_type, &info)) {
+  if (!_.GetImageTypeInfo(image_type, &info)) {
     return _.diag(SPV_ERROR_INVALID_DATA, inst)
            << "Corrupt image type definition";
   }
@@ -1302,7 +1257,7 @@ spv_result_t ValidateImageGather(ValidationState_t& _,
   }
 
   ImageTypeInfo info;
-  if (!GetImageTypeInfo(_, image_type, &info)) {
+  if (!_.GetImageTypeInfo(image_type, &info)) {
     return _.diag(SPV_ERROR_INVALID_DATA, inst)
            << "Corrupt image type definition";
   }
@@ -1395,7 +1350,7 @@ spv_result_t ValidateImageRead(ValidationState_t& _, const Instruction* inst) {
   }
 
   ImageTypeInfo info;
-  if (!GetImageTypeInfo(_, image_type, &info)) {
+  if (!_.GetImageTypeInfo(image_type, &info)) {
     return _.diag(SPV_ERROR_INVALID_DATA, inst)
            << "Corrupt image type definition";
   }
@@ -1475,7 +1430,7 @@ spv_result_t ValidateImageWrite(ValidationState_t& _, const Instruction* inst) {
   }
 
   ImageTypeInfo info;
-  if (!GetImageTypeInfo(_, image_type, &info)) {
+  if (!_.GetImageTypeInfo(image_type, &info)) {
     return _.diag(SPV_ERROR_INVALID_DATA, inst)
            << "Corrupt image type definition";
   }
@@ -1594,7 +1549,7 @@ spv_result_t ValidateImageQuerySizeLod(ValidationState_t& _,
   }
 
   ImageTypeInfo info;
-  if (!GetImageTypeInfo(_, image_type, &info)) {
+  if (!_.GetImageTypeInfo(image_type, &info)) {
     return _.diag(SPV_ERROR_INVALID_DATA, inst)
            << "Corrupt image type definition";
   }
@@ -1650,7 +1605,7 @@ spv_result_t ValidateImageQuerySize(ValidationState_t& _,
   }
 
   ImageTypeInfo info;
-  if (!GetImageTypeInfo(_, image_type, &info)) {
+  if (!_.GetImageTypeInfo(image_type, &info)) {
     return _.diag(SPV_ERROR_INVALID_DATA, inst)
            << "Corrupt image type definition";
   }
@@ -1762,7 +1717,7 @@ spv_result_t ValidateImageQueryLod(ValidationState_t& _,
   }
 
   ImageTypeInfo info;
-  if (!GetImageTypeInfo(_, image_type, &info)) {
+  if (!_.GetImageTypeInfo(image_type, &info)) {
     return _.diag(SPV_ERROR_INVALID_DATA, inst)
            << "Corrupt image type definition";
   }
@@ -1818,7 +1773,7 @@ spv_result_t ValidateImageQueryLevelsOrSamples(ValidationState_t& _,
   }
 
   ImageTypeInfo info;
-  if (!GetImageTypeInfo(_, image_type, &info)) {
+  if (!_.GetImageTypeInfo(image_type, &info)) {
     return _.diag(SPV_ERROR_INVALID_DATA, inst)
            << "Corrupt image type definition";
   }
@@ -1862,6 +1817,54 @@ spv_result_t ValidateImageSparseTexelsResident(ValidationState_t& _,
 }  // namespace
 
 // Validates correctness of image instructions.
+// Keep in sync with the opcodes handled by ImagePass.
+bool ImagePassApplies(SpvOp opcode) {
+  switch (opcode) {
+    case SpvOpTypeImage:
+    case SpvOpTypeSampledImage:
+    case SpvOpSampledImage:
+    case SpvOpImageTexelPointer:
+    case SpvOpImageSampleImplicitLod:
+    case SpvOpImageSampleExplicitLod:
+    case SpvOpImageSampleProjImplicitLod:
+    case SpvOpImageSampleProjExplicitLod:
+    case SpvOpImageSparseSampleImplicitLod:
+    case SpvOpImageSparseSampleExplicitLod:
+    case SpvOpImageSampleDrefImplicitLod:
+    case SpvOpImageSampleDrefExplicitLod:
+    case SpvOpImageSampleProjDrefImplicitLod:
+    case SpvOpImageSampleProjDrefExplicitLod:
+    case SpvOpImageSparseSampleDrefImplicitLod:
+    case SpvOpImageSparseSampleDrefExplicitLod:
+    case SpvOpImageFetch:
+    case SpvOpImageSparseFetch:
+    case SpvOpImageGather:
+    case SpvOpImageDrefGather:
+    case SpvOpImageSparseGather:
+    case SpvOpImageSparseDrefGather:
+    case SpvOpImageRead:
+    case SpvOpImageSparseRead:
+    case SpvOpImageWrite:
+    case SpvOpImage:
+    case SpvOpImageQueryFormat:
+    case SpvOpImageQueryOrder:
+    case SpvOpImageQuerySizeLod:
+    case SpvOpImageQuerySize:
+    case SpvOpImageQueryLod:
+    case SpvOpImageQueryLevels:
+    case SpvOpImageQuerySamples:
+    case SpvOpImageSparseSampleProjImplicitLod:
+    case SpvOpImageSparseSampleProjExplicitLod:
+    case SpvOpImageSparseSampleProjDrefImplicitLod:
+    case SpvOpImageSparseSampleProjDrefExplicitLod:
+    case SpvOpImageSparseTexelsResident:
+      return true;
+    default:
+      break;
+  }
+  return false;
+}
+
 spv_result_t ImagePass(ValidationState_t& _, const Instruction* inst) {
   const SpvOp opcode = inst->opcode();
   if (IsImplicitLod(opcode)) {
@@ -161,6 +161,10 @@ bool HasConflictingMemberOffsets(
 // it.
 bool ContainsInvalidBool(ValidationState_t& _, const Instruction* storage,
                          bool skip_builtin) {
+  if (!_.ContainsTypeProperty(storage->id(),
+                              ValidationState_t::TypeProperty::kBool)) {
+    return false;
+  }
   if (skip_builtin) {
     for (const Decoration& decoration : _.id_decorations(storage->id())) {
       if (decoration.dec_type() == SpvDecorationBuiltIn) return false;
@@ -196,36 +200,6 @@ bool ContainsInvalidBool(ValidationState_t& _, const Instruction* storage,
   return false;
 }
 
-bool ContainsCooperativeMatrix(ValidationState_t& _,
-                               const Instruction* storage) {
-  const size_t elem_type_index = 1;
-  uint32_t elem_type_id;
-  Instruction* elem_type;
-
-  switch (storage->opcode()) {
-    case SpvOpTypeCooperativeMatrixNV:
-      return true;
-    case SpvOpTypeArray:
-    case SpvOpTypeRuntimeArray:
-      elem_type_id = storage->GetOperandAs<uint32_t>(elem_type_index);
-      elem_type = _.FindDef(elem_type_id);
-      return ContainsCooperativeMatrix(_, elem_type);
-    case SpvOpTypeStruct:
-      for (size_t member_type_index = 1;
-           member_type_index < storage->operands().size();
-           ++member_type_index) {
-        auto member_type_id =
-            storage->GetOperandAs<uint32_t>(member_type_index);
-        auto member_type = _.FindDef(member_type_id);
-        if (ContainsCooperativeMatrix(_, member_type)) return true;
-      }
-      break;
-    default:
-      break;
-  }
-  return false;
-}
-
 std::pair<SpvStorageClass, SpvStorageClass> GetStorageClass(
     ValidationState_t& _, const Instruction* inst) {
   SpvStorageClass dst_sc = SpvStorageClassMax;
@@ -735,7 +709,8 @@ spv_result_t ValidateVariable(ValidationState_t& _, const Instruction* inst) {
   // Cooperative matrix types can only be allocated in Function or Private
   if ((storage_class != SpvStorageClassFunction &&
        storage_class != SpvStorageClassPrivate) &&
-      ContainsCooperativeMatrix(_, pointee)) {
+      _.ContainsTypeProperty(
+          pointee->id(), ValidationState_t::TypeProperty::kCooperativeMatrix)) {
     return _.diag(SPV_ERROR_INVALID_ID, inst)
            << "Cooperative matrix types (or types containing them) can only be "
               "allocated "
@@ -1612,6 +1587,34 @@ spv_result_t ValidatePtrComparison(ValidationState_t& _,
 
 }  // namespace
 
+// Keep in sync with the opcodes handled by MemoryPass.
+bool MemoryPassApplies(SpvOp opcode) {
+  switch (opcode) {
+    case SpvOpVariable:
+    case SpvOpLoad:
+    case SpvOpStore:
+    case SpvOpCopyMemory:
+    case SpvOpCopyMemorySized:
+    case SpvOpPtrAccessChain:
+    case SpvOpAccessChain:
+    case SpvOpInBoundsAccessChain:
+    case SpvOpInBoundsPtrAccessChain:
+    case SpvOpArrayLength:
+    case SpvOpCooperativeMatrixLoadNV:
+    case SpvOpCooperativeMatrixStoreNV:
+    case SpvOpCooperativeMatrixLengthNV:
+    case SpvOpPtrEqual:
+    case SpvOpPtrNotEqual:
+    case SpvOpPtrDiff:
+    case SpvOpImageTexelPointer:
+    case SpvOpGenericPtrMemSemantics:
+      return true;
+    default:
+      break;
+  }
+  return false;
+}
+
 spv_result_t MemoryPass(ValidationState_t& _, const Instruction* inst) {
   switch (inst->opcode()) {
     case SpvOpVariable:
@@ -74,6 +74,22 @@ spv_result_t ValidateShaderClock(ValidationState_t& _,
 
 }  // namespace
 
+// Keep in sync with the opcodes handled by MiscPass.
+bool MiscPassApplies(SpvOp opcode) {
+  switch (opcode) {
+    case SpvOpUndef:
+    case SpvOpBeginInvocationInterlockEXT:
+    case SpvOpEndInvocationInterlockEXT:
+    case SpvOpDemoteToHelperInvocationEXT:
+    case SpvOpIsHelperInvocationEXT:
+    case SpvOpReadClockKHR:
+      return true;
+    default:
+      break;
+  }
+  return false;
+}
+
 spv_result_t MiscPass(ValidationState_t& _, const Instruction* inst) {
   switch (inst->opcode()) {
     case SpvOpUndef:
@@ -525,6 +525,20 @@ spv_result_t ValidateMemoryModel(ValidationState_t& _,
 
 }  // namespace
 
+// Keep in sync with the opcodes handled by ModeSettingPass.
+bool ModeSettingPassApplies(SpvOp opcode) {
+  switch (opcode) {
+    case SpvOpEntryPoint:
+    case SpvOpExecutionMode:
+    case SpvOpExecutionModeId:
+    case SpvOpMemoryModel:
+      return true;
+    default:
+      break;
+  }
+  return false;
+}
+
 spv_result_t ModeSettingPass(ValidationState_t& _, const Instruction* inst) {
   switch (inst->opcode()) {
     case SpvOpEntryPoint:
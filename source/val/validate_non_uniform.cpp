@@ -53,6 +53,18 @@ spv_result_t ValidateGroupNonUniformBallotBitCount(ValidationState_t& _,
 }  // namespace
 
 // Validates correctness of non-uniform group instructions.
+// Keep in sync with the opcodes handled by NonUniformPass.
+bool NonUniformPassApplies(SpvOp opcode) {
+  if (spvOpcodeIsNonUniformGroupOperation(opcode)) return true;
+  switch (opcode) {
+    case SpvOpGroupNonUniformBallotBitCount:
+      return true;
+    default:
+      break;
+  }
+  return false;
+}
+
 spv_result_t NonUniformPass(ValidationState_t& _, const Instruction* inst) {
   const SpvOp opcode = inst->opcode();
 
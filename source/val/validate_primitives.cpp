@@ -27,6 +27,20 @@ namespace spvtools {
 namespace val {
 
 // Validates correctness of primitive instructions.
+// Keep in sync with the opcodes handled by PrimitivesPass.
+bool PrimitivesPassApplies(SpvOp opcode) {
+  switch (opcode) {
+    case SpvOpEmitVertex:
+    case SpvOpEndPrimitive:
+    case SpvOpEmitStreamVertex:
+    case SpvOpEndStreamPrimitive:
+      return true;
+    default:
+      break;
+  }
+  return false;
+}
+
 spv_result_t PrimitivesPass(ValidationState_t& _, const Instruction* inst) {
   const SpvOp opcode = inst->opcode();
 
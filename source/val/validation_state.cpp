@@ -14,13 +14,22 @@
 
 #include "source/val/validation_state.h"
 
+#include <algorithm>
 #include <cassert>
+#include <numeric>
 #include <stack>
+#include <unordered_map>
+#include <unordered_set>
 #include <utility>
+#include <vector>
 
+#include "source/binary.h"
 #include "source/opcode.h"
+#include "source/operand.h"
 #include "source/spirv_constant.h"
+#include "source/spirv_endian.h"
 #include "source/spirv_target_env.h"
+#include "source/util/hash_combine.h"
 #include "source/val/basic_block.h"
 #include "source/val/construct.h"
 #include "source/val/function.h"
@@ -140,28 +149,6 @@ bool IsInstructionInLayoutSection(ModuleLayoutSection layout, SpvOp op) {
   return out;
 }
 
-// Counts the number of instructions and functions in the file.
-spv_result_t CountInstructions(void* user_data,
-                               const spv_parsed_instruction_t* inst) {
-  ValidationState_t& _ = *(reinterpret_cast<ValidationState_t*>(user_data));
-  if (inst->opcode == SpvOpFunction) _.increment_total_functions();
-  _.increment_total_instructions();
-
-  return SPV_SUCCESS;
-}
-
-spv_result_t setHeader(void* user_data, spv_endianness_t, uint32_t,
-                       uint32_t version, uint32_t generator, uint32_t id_bound,
-                       uint32_t) {
-  ValidationState_t& vstate =
-      *(reinterpret_cast<ValidationState_t*>(user_data));
-  vstate.setIdBound(id_bound);
-  vstate.setGenerator(generator);
-  vstate.setVersion(version);
-
-  return SPV_SUCCESS;
-}
-
 // Add features based on SPIR-V core version number.
 void UpdateFeaturesBasedOnSpirvVersion(ValidationState_t::Feature* features,
                                        uint32_t version) {
@@ -174,6 +161,43 @@ void UpdateFeaturesBasedOnSpirvVersion(ValidationState_t::Feature* features,
   }
 }
 
+// The smallest block of instruction words or operands that is allocated when
+// the size of the module is not known.
+const size_t kMinInstructionBlockSize = 1024;
+
+// Copies the |count| elements at |data| to the end of the last block of
+// |blocks| and returns the copy.  Starts a new block with room for at least
+// |block_size| elements when the last one does not have room for them.  Blocks
+// are never reallocated, so the copy does not move.
+template <typename T>
+const T* AppendToBlocks(const T* data, size_t count, size_t block_size,
+                        std::vector<std::vector<T>>* blocks) {
+  if (blocks->empty() ||
+      blocks->back().capacity() - blocks->back().size() < count) {
+    blocks->emplace_back();
+    blocks->back().reserve(std::max(block_size, count));
+  }
+  std::vector<T>& block = blocks->back();
+  const size_t offset = block.size();
+  block.insert(block.end(), data, data + count);
+  return block.data() + offset;
+}
+
+// Calls |f| with the definition, the instruction and the word index of each
+// reference to a result id by the instructions of |_|, in module order.
+template <typename F>
+void ForEachIdUse(const ValidationState_t& _, F f) {
+  for (const auto& inst : _.ordered_instructions()) {
+    for (const auto& operand : inst.operands()) {
+      const spv_operand_type_t type = operand.type;
+      if (spvIsIdType(type) && type != SPV_OPERAND_TYPE_RESULT_ID) {
+        if (const Instruction* def = _.FindDef(inst.word(operand.offset)))
+          f(def, &inst, operand.offset);
+      }
+    }
+  }
+}
+
 }  // namespace
 
 ValidationState_t::ValidationState_t(const spv_const_context ctx,
@@ -192,7 +216,7 @@ ValidationState_t::ValidationState_t(const spv_const_context ctx,
       module_capabilities_(),
       module_extensions_(),
       ordered_instructions_(),
-      all_definitions_(),
+      id_definitions_(),
       global_vars_(),
       local_vars_(),
       struct_nesting_depth_(),
@@ -203,7 +227,8 @@ ValidationState_t::ValidationState_t(const spv_const_context ctx,
       pointer_size_and_alignment_(0),
       in_function_(false),
       num_of_warnings_(0),
-      max_num_of_warnings_(max_warnings) {
+      max_num_of_warnings_(max_warnings),
+      diagnostics_suppressed_(false) {
   assert(opt && "Validator options may not be Null.");
 
   const auto env = context_->target_env;
@@ -218,28 +243,73 @@ ValidationState_t::ValidationState_t(const spv_const_context ctx,
   // Only attempt to count if we have words, otherwise let the other validation
   // fail and generate an error.
   if (num_words > 0) {
-    // Count the number of instructions in the binary.
-    // This parse should not produce any error messages. Hijack the context and
-    // replace the message consumer so that we do not pollute any state in input
-    // consumer.
-    spv_context_t hijacked_context = *ctx;
-    hijacked_context.consumer = [](spv_message_level_t, const char*,
-                                   const spv_position_t&, const char*) {};
-    spvBinaryParse(&hijacked_context, this, words, num_words, setHeader,
-                   CountInstructions,
-                   /* diagnostic = */ nullptr);
+    PrescanModule(words, num_words);
     preallocateStorage();
   }
   UpdateFeaturesBasedOnSpirvVersion(&features_, version_);
+}
 
-  friendly_mapper_ = spvtools::MakeUnique<spvtools::FriendlyNameMapper>(
-      context_, words_, num_words_);
-  name_mapper_ = friendly_mapper_->GetNameMapper();
+ValidationState_t::ValidationState_t(
+    const spv_const_context ctx, const spv_const_validator_options opt,
+    const uint32_t* header, size_t num_instructions, size_t num_words,
+    size_t num_functions, std::function<std::vector<uint32_t>()> get_binary,
+    const uint32_t max_warnings)
+    : ValidationState_t(ctx, opt, nullptr, 0, max_warnings) {
+  get_binary_ = std::move(get_binary);
+  setGenerator(header[SPV_INDEX_GENERATOR_NUMBER]);
+  setVersion(header[SPV_INDEX_VERSION_NUMBER]);
+  setIdBound(header[SPV_INDEX_BOUND]);
+  total_instructions_ = num_instructions;
+  total_words_ = num_words;
+  total_functions_ = num_functions;
+  preallocateStorage();
+  UpdateFeaturesBasedOnSpirvVersion(&features_, version_);
+}
+
+void ValidationState_t::PrepareNames() const {
+  std::call_once(names_prepared_, [this]() {
+    if (get_binary_) {
+      binary_ = get_binary_();
+      words_ = binary_.data();
+      num_words_ = binary_.size();
+    }
+    friendly_mapper_ = spvtools::MakeUnique<spvtools::FriendlyNameMapper>(
+        context_, words_, num_words_);
+  });
+}
+
+void ValidationState_t::PrescanModule(const uint32_t* words,
+                                      size_t num_words) {
+  spv_const_binary_t binary{words, num_words};
+  spv_endianness_t endian;
+  if (num_words < SPV_INDEX_INSTRUCTION ||
+      spvBinaryEndianness(&binary, &endian) != SPV_SUCCESS) {
+    return;
+  }
+  spv_header_t header;
+  if (spvBinaryHeaderGet(&binary, endian, &header) != SPV_SUCCESS) return;
+  setIdBound(header.bound);
+  setGenerator(header.generator);
+  setVersion(header.version);
+
+  total_words_ = num_words - SPV_INDEX_INSTRUCTION;
+  for (size_t index = SPV_INDEX_INSTRUCTION; index < num_words;) {
+    const uint32_t first_word = spvFixWord(words[index], endian);
+    const uint32_t word_count = first_word >> 16;
+    if (word_count == 0) break;
+    if ((first_word & 0xFFFF) == SpvOpFunction) ++total_functions_;
+    ++total_instructions_;
+    index += word_count;
+  }
 }
 
 void ValidationState_t::preallocateStorage() {
   ordered_instructions_.reserve(total_instructions_);
   module_functions_.reserve(total_functions_);
+  // Each defined id has an instruction, so only a bound much larger than the
+  // size of the module makes the ids sparse.
+  id_definitions_.reserve(std::min(static_cast<size_t>(id_bound_),
+                                   total_instructions_ + 1));
 }
 
 spv_result_t ValidationState_t::ForwardDeclareId(uint32_t id) {
@@ -266,7 +336,8 @@ void ValidationState_t::AssignNameToId(uint32_t id, std::string name) {
 }
 
 std::string ValidationState_t::getIdName(uint32_t id) const {
-  const std::string id_name = name_mapper_(id);
+  PrepareNames();
+  const std::string id_name = friendly_mapper_->NameForId(id);
 
   std::stringstream out;
   out << id << "[%" << id_name << "]";
@@ -284,19 +355,15 @@ std::vector<uint32_t> ValidationState_t::UnresolvedForwardIds() const {
 }
 
 bool ValidationState_t::IsDefinedId(uint32_t id) const {
-  return all_definitions_.find(id) != std::end(all_definitions_);
+  return FindDef(id) != nullptr;
 }
 
 const Instruction* ValidationState_t::FindDef(uint32_t id) const {
-  auto it = all_definitions_.find(id);
-  if (it == all_definitions_.end()) return nullptr;
-  return it->second;
+  return id < id_definitions_.size() ? id_definitions_[id] : nullptr;
 }
 
 Instruction* ValidationState_t::FindDef(uint32_t id) {
-  auto it = all_definitions_.find(id);
-  if (it == all_definitions_.end()) return nullptr;
-  return it->second;
+  return id < id_definitions_.size() ? id_definitions_[id] : nullptr;
 }
 
 ModuleLayoutSection ValidationState_t::current_layout_section() const {
@@ -317,6 +384,11 @@ bool ValidationState_t::IsOpcodeInCurrentLayoutSection(SpvOp op) {
 
 DiagnosticStream ValidationState_t::diag(spv_result_t error_code,
                                          const Instruction* inst) {
+  // Nothing is formatted when there is no one to report the message to.
+  if (diagnostics_suppressed_ || context_->consumer == nullptr) {
+    return DiagnosticStream({0, 0, 0}, nullptr, "", error_code);
+  }
+
   if (error_code == SPV_WARNING) {
     if (num_of_warnings_ == max_num_of_warnings_) {
       DiagnosticStream({0, 0, 0}, context_->consumer, "", error_code)
@@ -516,11 +588,47 @@ spv_result_t ValidationState_t::RegisterFunctionEnd() {
 
 Instruction* ValidationState_t::AddOrderedInstruction(
     const spv_parsed_instruction_t* inst) {
-  ordered_instructions_.emplace_back(inst);
+  // Each operand has at least one word, and the opcode word is not one.
+  const size_t words_size = std::max(total_words_, kMinInstructionBlockSize);
+  const size_t operands_size =
+      std::max(total_words_ > total_instructions_
+                   ? total_words_ - total_instructions_
+                   : 0,
+               kMinInstructionBlockSize);
+  spv_parsed_instruction_t stored = *inst;
+  stored.words = AppendToBlocks(inst->words, inst->num_words, words_size,
+                                &instruction_words_);
+  stored.operands = AppendToBlocks(inst->operands, inst->num_operands,
+                                   operands_size, &instruction_operands_);
+  ordered_instructions_.emplace_back(&stored);
   ordered_instructions_.back().SetLineNum(ordered_instructions_.size());
   return &ordered_instructions_.back();
 }
 
+void ValidationState_t::RegisterUses() {
+  // The uses of the |i|th instruction are [offsets[i], offsets[i + 1]) of
+  // |instruction_uses_|.
+  const Instruction* first = ordered_instructions_.data();
+  std::vector<size_t> offsets(ordered_instructions_.size() + 1, 0);
+  ForEachIdUse(*this, [first, &offsets](const Instruction* def,
+                                        const Instruction*, uint32_t) {
+    ++offsets[static_cast<size_t>(def - first) + 1];
+  });
+  std::partial_sum(offsets.begin(), offsets.end(), offsets.begin());
+
+  instruction_uses_.resize(offsets.back());
+  for (size_t i = 0; i < ordered_instructions_.size(); ++i) {
+    ordered_instructions_[i].SetUses(instruction_uses_.data() + offsets[i],
+                                     offsets[i + 1] - offsets[i]);
+  }
+  ForEachIdUse(*this, [this, first, &offsets](const Instruction* def,
+                                              const Instruction* user,
+                                              uint32_t index) {
+    instruction_uses_[offsets[static_cast<size_t>(def - first)]++] =
+        Instruction::Use(user, index);
+  });
+}
+
 // Improves diagnostic messages by collecting names of IDs
 void ValidationState_t::RegisterDebugInstruction(const Instruction* inst) {
   switch (inst->opcode()) {
@@ -550,7 +658,15 @@ void ValidationState_t::RegisterDebugInstruction(const Instruction* inst) {
 }
 
 void ValidationState_t::RegisterInstruction(Instruction* inst) {
-  if (inst->id()) all_definitions_.insert(std::make_pair(inst->id(), inst));
+  if (const uint32_t id = inst->id()) {
+    // The id is below the bound, which InstructionPass has checked.
+    if (id >= id_definitions_.size()) id_definitions_.resize(id + 1, nullptr);
+    if (!id_definitions_[id]) {
+      id_definitions_[id] = inst;
+      RegisterTypeInfo(inst);
+      RegisterTypeProperties(inst);
+    }
+  }
 
   // If the instruction is using an OpTypeSampledImage as an operand, it should
   // be recorded. The validator will ensure that all usages of an
@@ -567,6 +683,170 @@ void ValidationState_t::RegisterInstruction(Instruction* inst) {
   }
 }
 
+void ValidationState_t::RegisterTypeInfo(const Instruction* inst) {
+  TypeInfo info;
+  switch (inst->opcode()) {
+    case SpvOpTypeInt:
+    case SpvOpTypeFloat:
+      info.component_type = inst->id();
+      info.dimension = 1;
+      info.bit_width = inst->word(2);
+      break;
+    case SpvOpTypeBool:
+      info.component_type = inst->id();
+      info.dimension = 1;
+      info.bit_width = 1;
+      break;
+    case SpvOpTypeVector:
+      info.component_type = inst->word(2);
+      info.dimension = inst->word(3);
+      break;
+    case SpvOpTypeMatrix: {
+      const TypeInfo* column = FindTypeInfo(inst->word(2));
+      if (!column || !column->component_type) return;
+      info.component_type = column->component_type;
+      info.dimension = inst->word(3);
+      break;
+    }
+    case SpvOpTypeCooperativeMatrixNV:
+      info.component_type = inst->word(2);
+      // Actual dimension isn't known.
+      info.dimension = 0;
+      break;
+    case SpvOpTypeImage: {
+      const size_t num_words = inst->words().size();
+      if (num_words != 9 && num_words != 10) return;
+      info.is_image = true;
+      info.image.sampled_type = inst->word(2);
+      info.image.dim = static_cast<SpvDim>(inst->word(3));
+      info.image.depth = inst->word(4);
+      info.image.arrayed = inst->word(5);
+      info.image.multisampled = inst->word(6);
+      info.image.sampled = inst->word(7);
+      info.image.format = static_cast<SpvImageFormat>(inst->word(8));
+      info.image.access_qualifier =
+          num_words < 10 ? SpvAccessQualifierMax
+                         : static_cast<SpvAccessQualifier>(inst->word(9));
+      break;
+    }
+    case SpvOpTypeSampledImage: {
+      const TypeInfo* image = FindTypeInfo(inst->word(2));
+      if (!image || !image->is_image) return;
+      info.is_image = true;
+      info.image = image->image;
+      break;
+    }
+    default:
+      return;
+  }
+
+  const uint32_t id = inst->id();
+  if (id >= id_type_info_index_.size()) id_type_info_index_.resize(id + 1, 0);
+  type_infos_.push_back(info);
+  id_type_info_index_[id] = static_cast<uint32_t>(type_infos_.size());
+}
+
+bool ValidationState_t::GetSizedTypeProperty(SpvOp type, uint32_t width,
+                                             TypeProperty* property) {
+  const bool is_int = type == SpvOpTypeInt;
+  if (!is_int && type != SpvOpTypeFloat) return false;
+  switch (width) {
+    case 8:
+      if (!is_int) return false;
+      *property = TypeProperty::kInt8;
+      return true;
+    case 16:
+      *property = is_int ? TypeProperty::kInt16 : TypeProperty::kFloat16;
+      return true;
+    case 32:
+      *property = is_int ? TypeProperty::kInt32 : TypeProperty::kFloat32;
+      return true;
+    case 64:
+      *property = is_int ? TypeProperty::kInt64 : TypeProperty::kFloat64;
+      return true;
+    default:
+      return false;
+  }
+}
+
+void ValidationState_t::RegisterTypeProperties(const Instruction* inst) {
+  const SpvOp opcode = inst->opcode();
+  if (!spvOpcodeGeneratesType(opcode)) return;
+
+  const uint32_t sized = TypePropertyMask(TypeProperty::kInt8) |
+                         TypePropertyMask(TypeProperty::kInt16) |
+                         TypePropertyMask(TypeProperty::kInt32) |
+                         TypePropertyMask(TypeProperty::kInt64) |
+                         TypePropertyMask(TypeProperty::kFloat16) |
+                         TypePropertyMask(TypeProperty::kFloat32) |
+                         TypePropertyMask(TypeProperty::kFloat64);
+  uint32_t properties = 0;
+  if (spvOpcodeIsBaseOpaqueType(opcode)) {
+    properties |= TypePropertyMask(TypeProperty::kOpaque);
+  }
+  // The properties which the types of the operands in [first, last) pass on
+  // to this type.
+  uint32_t passed_on = 0;
+  size_t first = 1;
+  size_t last = 2;
+  switch (opcode) {
+    case SpvOpTypeInt:
+    case SpvOpTypeFloat: {
+      TypeProperty property;
+      if (GetSizedTypeProperty(opcode, inst->word(2), &property)) {
+        properties |= TypePropertyMask(property);
+      }
+      break;
+    }
+    case SpvOpTypeBool:
+      properties |= TypePropertyMask(TypeProperty::kBool);
+      break;
+    case SpvOpTypeVector:
+    case SpvOpTypeMatrix:
+      passed_on = sized | TypePropertyMask(TypeProperty::kBool);
+      break;
+    case SpvOpTypeArray:
+    case SpvOpTypeRuntimeArray:
+      passed_on = ~0u;
+      break;
+    case SpvOpTypeStruct:
+      passed_on = ~0u;
+      last = inst->operands().size();
+      break;
+    case SpvOpTypeCooperativeMatrixNV:
+      properties |= TypePropertyMask(TypeProperty::kCooperativeMatrix);
+      passed_on = sized;
+      break;
+    case SpvOpTypeImage:
+    case SpvOpTypeSampledImage:
+      passed_on = sized;
+      break;
+    case SpvOpTypePointer:
+      // The pointee of a forward pointer may contain the pointer itself.
+      if (!IsForwardPointer(inst->id())) passed_on = sized;
+      first = 2;
+      last = 3;
+      break;
+    case SpvOpTypeFunction:
+      passed_on = sized;
+      last = inst->operands().size();
+      break;
+    default:
+      break;
+  }
+  if (passed_on) {
+    for (size_t i = first; i < last && i < inst->operands().size(); ++i) {
+      properties |=
+          TypePropertiesOf(inst->GetOperandAs<uint32_t>(i)) & passed_on;
+    }
+  }
+  if (!properties) return;
+
+  const uint32_t id = inst->id();
+  if (id >= type_properties_.size()) type_properties_.resize(id + 1, 0);
+  type_properties_[id] = properties;
+}
+
 std::vector<Instruction*> ValidationState_t::getSampledImageConsumers(
     uint32_t sampled_image_id) const {
   std::vector<Instruction*> result;
@@ -586,6 +866,64 @@ uint32_t ValidationState_t::getIdBound() const { return id_bound_; }
 
 void ValidationState_t::setIdBound(const uint32_t bound) { id_bound_ = bound; }
 
+std::vector<Decoration>& ValidationState_t::MutableDecorations(uint32_t id) {
+  if (id >= id_decorations_index_.size()) id_decorations_index_.resize(id + 1);
+  if (!id_decorations_index_[id]) {
+    decorations_.emplace_back();
+    id_decorations_index_[id] = static_cast<uint32_t>(decorations_.size());
+  }
+  return decorations_[id_decorations_index_[id] - 1];
+}
+
+void ValidationState_t::IndexDecorations(uint32_t id, size_t first) {
+  const std::vector<Decoration>& decorations = id_decorations(id);
+  for (size_t i = first; i < decorations.size(); ++i) {
+    decorations_by_kind_[decorations[i].dec_type()].push_back(
+        {id, static_cast<uint32_t>(i)});
+  }
+}
+
+const std::vector<ValidationState_t::DecorationRef>&
+ValidationState_t::decorations_of_kind(SpvDecoration dec) const {
+  const auto it = decorations_by_kind_.find(dec);
+  if (it == decorations_by_kind_.end()) return empty_decoration_refs_;
+  return it->second;
+}
+
+std::vector<ValidationState_t::DecorationRef>
+ValidationState_t::decorations_of_kinds(
+    std::initializer_list<SpvDecoration> decs) const {
+  std::vector<DecorationRef> refs;
+  for (const SpvDecoration dec : decs) {
+    const auto& of_kind = decorations_of_kind(dec);
+    refs.insert(refs.end(), of_kind.begin(), of_kind.end());
+  }
+  std::sort(refs.begin(), refs.end(),
+            [](const DecorationRef& lhs, const DecorationRef& rhs) {
+              return lhs.id != rhs.id ? lhs.id < rhs.id
+                                      : lhs.index < rhs.index;
+            });
+  return refs;
+}
+
+std::vector<uint32_t> ValidationState_t::decorated_ids() const {
+  std::vector<uint32_t> ids;
+  ids.reserve(decorations_.size());
+  for (uint32_t id = 0; id < id_decorations_index_.size(); ++id) {
+    if (id_decorations_index_[id]) ids.push_back(id);
+  }
+  return ids;
+}
+
+size_t ValidationState_t::TypeDeclarationHash::operator()(
+    const std::vector<uint32_t>& words) const {
+  size_t hash = words.size();
+  for (uint32_t word : words) {
+    utils::HashCombine(std::hash<uint32_t>()(word), &hash);
+  }
+  return hash;
+}
+
 bool ValidationState_t::RegisterUniqueTypeDeclaration(const Instruction* inst) {
   std::vector<uint32_t> key;
   key.push_back(static_cast<uint32_t>(inst->opcode()));
@@ -616,6 +954,10 @@ SpvOp ValidationState_t::GetIdOpcode(uint32_t id) const {
 }
 
 uint32_t ValidationState_t::GetComponentType(uint32_t id) const {
+  if (const TypeInfo* info = FindTypeInfo(id)) {
+    if (info->component_type) return info->component_type;
+  }
+
   const Instruction* inst = FindDef(id);
   assert(inst);
 
@@ -645,6 +987,10 @@ uint32_t ValidationState_t::GetComponentType(uint32_t id) const {
 }
 
 uint32_t ValidationState_t::GetDimension(uint32_t id) const {
+  if (const TypeInfo* info = FindTypeInfo(id)) {
+    if (info->component_type) return info->dimension;
+  }
+
   const Instruction* inst = FindDef(id);
   assert(inst);
 
@@ -674,6 +1020,10 @@ uint32_t ValidationState_t::GetDimension(uint32_t id) const {
 
 uint32_t ValidationState_t::GetBitWidth(uint32_t id) const {
   const uint32_t component_type_id = GetComponentType(id);
+  if (const TypeInfo* info = FindTypeInfo(component_type_id)) {
+    if (info->bit_width) return info->bit_width;
+  }
+
   const Instruction* inst = FindDef(component_type_id);
   assert(inst);
 
@@ -883,6 +1233,14 @@ bool ValidationState_t::IsPointerType(uint32_t id) const {
   return inst->opcode() == SpvOpTypePointer;
 }
 
+bool ValidationState_t::GetImageTypeInfo(uint32_t id,
+                                         ImageTypeInfo* info) const {
+  const TypeInfo* type_info = FindTypeInfo(id);
+  if (!type_info || !type_info->is_image) return false;
+  *info = type_info->image;
+  return true;
+}
+
 bool ValidationState_t::GetPointerTypeInfo(uint32_t id, uint32_t* data_type,
                                            uint32_t* storage_class) const {
   if (!id) return false;
@@ -1049,35 +1407,86 @@ void ValidationState_t::ComputeFunctionToEntryPointMapping() {
       }
     }
   }
-}
 
-void ValidationState_t::ComputeRecursiveEntryPoints() {
-  for (const Function func : functions()) {
-    std::stack<uint32_t> call_stack;
-    std::set<uint32_t> visited;
-
-    for (const uint32_t new_call : func.function_call_targets()) {
-      call_stack.push(new_call);
+  for (const auto& func_and_entry_points : function_to_entry_points_) {
+    auto& models = function_to_execution_models_[func_and_entry_points.first];
+    for (const uint32_t entry_point : func_and_entry_points.second) {
+      if (const auto* entry_point_models = GetExecutionModels(entry_point)) {
+        models.insert(entry_point_models->begin(), entry_point_models->end());
+      }
     }
+  }
 
-    while (!call_stack.empty()) {
-      const uint32_t called_func_id = call_stack.top();
-      call_stack.pop();
-
-      if (!visited.insert(called_func_id).second) continue;
+  ComputeEntryPointReferences();
+}
 
-      if (called_func_id == func.id()) {
-        for (const uint32_t entry_point :
-             function_to_entry_points_[called_func_id])
-          recursive_entry_points_.insert(entry_point);
-        break;
+void ValidationState_t::ComputeRecursiveEntryPoints() {
+  // A function is recursive if it is on a cycle of the call graph: either it
+  // calls itself, or its strongly connected component has other functions.
+  // The components are found with Tarjan's algorithm, which visits each
+  // function and each call once.
+  struct Visit {
+    const Function* func;
+    std::set<uint32_t>::const_iterator next_call;
+  };
+  std::unordered_map<uint32_t, uint32_t> discovery_index;
+  std::unordered_map<uint32_t, uint32_t> low_link;
+  std::unordered_set<uint32_t> on_stack;
+  std::vector<uint32_t> component_stack;
+  std::vector<Visit> visits;
+  const auto discover = [&](const Function* func) {
+    const uint32_t index = uint32_t(discovery_index.size());
+    discovery_index[func->id()] = index;
+    low_link[func->id()] = index;
+    component_stack.push_back(func->id());
+    on_stack.insert(func->id());
+    visits.push_back({func, func->function_call_targets().begin()});
+  };
+
+  for (const Function& root : functions()) {
+    if (discovery_index.count(root.id())) continue;
+    discover(&root);
+    while (!visits.empty()) {
+      const Function* func = visits.back().func;
+      const uint32_t func_id = func->id();
+      auto& next_call = visits.back().next_call;
+      if (next_call != func->function_call_targets().end()) {
+        const uint32_t called_func_id = *next_call++;
+        const Function* called_func = function(called_func_id);
+        // Other checks should error out on this invalid SPIR-V.
+        if (!called_func) continue;
+        const auto it = discovery_index.find(called_func_id);
+        if (it == discovery_index.end()) {
+          discover(called_func);
+        } else if (on_stack.count(called_func_id)) {
+          low_link[func_id] = std::min(low_link[func_id], it->second);
+        }
+        continue;
       }
 
-      const Function* called_func = function(called_func_id);
-      if (called_func) {
-        // Other checks should error out on this invalid SPIR-V.
-        for (const uint32_t new_call : called_func->function_call_targets()) {
-          call_stack.push(new_call);
+      // All the calls of |func| have been visited.
+      visits.pop_back();
+      if (!visits.empty()) {
+        const uint32_t caller_id = visits.back().func->id();
+        low_link[caller_id] = std::min(low_link[caller_id], low_link[func_id]);
+      }
+      if (low_link[func_id] != discovery_index[func_id]) continue;
+
+      // |func| is the first function discovered in its component.
+      std::vector<uint32_t> component;
+      do {
+        component.push_back(component_stack.back());
+        component_stack.pop_back();
+        on_stack.erase(component.back());
+      } while (component.back() != func_id);
+      const bool calls_itself =
+          func->function_call_targets().count(func_id) != 0;
+      if (component.size() > 1 || calls_itself) {
+        for (const uint32_t recursive_func_id : component) {
+          for (const uint32_t entry_point :
+               FunctionEntryPoints(recursive_func_id)) {
+            recursive_entry_points_.insert(entry_point);
+          }
         }
       }
     }
@@ -1094,32 +1503,68 @@ const std::vector<uint32_t>& ValidationState_t::FunctionEntryPoints(
   }
 }
 
-std::set<uint32_t> ValidationState_t::EntryPointReferences(uint32_t id) const {
-  std::set<uint32_t> referenced_entry_points;
-  const auto inst = FindDef(id);
-  if (!inst) return referenced_entry_points;
-
-  std::vector<const Instruction*> stack;
-  stack.push_back(inst);
-  while (!stack.empty()) {
-    const auto current_inst = stack.back();
-    stack.pop_back();
-
-    if (const auto func = current_inst->function()) {
-      // Instruction lives in a function, we can stop searching.
-      const auto function_entry_points = FunctionEntryPoints(func->id());
-      referenced_entry_points.insert(function_entry_points.begin(),
-                                     function_entry_points.end());
-    } else {
-      // Instruction is in the global scope, keep searching its uses.
-      for (auto pair : current_inst->uses()) {
-        const auto next_inst = pair.first;
-        stack.push_back(next_inst);
+const std::set<SpvExecutionModel>& ValidationState_t::FunctionExecutionModels(
+    uint32_t func) const {
+  auto iter = function_to_execution_models_.find(func);
+  if (iter == function_to_execution_models_.end()) {
+    return empty_execution_models_;
+  } else {
+    return iter->second;
+  }
+}
+
+void ValidationState_t::ComputeEntryPointReferences() {
+  // A global instruction is referenced by the entry points of the functions
+  // that use it, and by those referencing the global instructions that use
+  // it.  Those mostly come later in the module, so one pass in reverse
+  // order computes them.  Only cycles through forward pointers use earlier
+  // instructions, in which case the passes are repeated until nothing
+  // changes.
+  std::vector<uint32_t> referenced;
+  bool repeat = true;
+  while (repeat) {
+    bool used_earlier = false;
+    bool changed = false;
+    for (size_t i = ordered_instructions_.size(); i-- > 0;) {
+      const Instruction& inst = ordered_instructions_[i];
+      if (!inst.id() || inst.function()) continue;
+      referenced.clear();
+      for (const auto& use : inst.uses()) {
+        const Instruction* user = use.first;
+        const std::vector<uint32_t>& user_entry_points =
+            user->function() ? FunctionEntryPoints(user->function()->id())
+                             : EntryPointReferences(user->id());
+        referenced.insert(referenced.end(), user_entry_points.begin(),
+                          user_entry_points.end());
+        if (!user->function() && user->id() && user < &inst) {
+          used_earlier = true;
+        }
+      }
+      if (referenced.empty()) continue;
+      std::sort(referenced.begin(), referenced.end());
+      referenced.erase(std::unique(referenced.begin(), referenced.end()),
+                       referenced.end());
+      std::vector<uint32_t>& entry_points = entry_point_references_[inst.id()];
+      if (entry_points != referenced) {
+        entry_points = referenced;
+        changed = true;
       }
     }
+    repeat = used_earlier && changed;
   }
+}
 
-  return referenced_entry_points;
+const std::vector<uint32_t>& ValidationState_t::EntryPointReferences(
+    uint32_t id) const {
+  const Instruction* inst = FindDef(id);
+  if (!inst) return empty_ids_;
+  // An instruction in a function is referenced by the entry points of the
+  // function.
+  if (const Function* func = inst->function()) {
+    return FunctionEntryPoints(func->id());
+  }
+  const auto it = entry_point_references_.find(id);
+  return it == entry_point_references_.end() ? empty_ids_ : it->second;
 }
 
 std::string ValidationState_t::Disassemble(const Instruction& inst) const {
@@ -1132,6 +1577,8 @@ std::string ValidationState_t::Disassemble(const uint32_t* words,
   uint32_t disassembly_options = SPV_BINARY_TO_TEXT_OPTION_NO_HEADER |
                                  SPV_BINARY_TO_TEXT_OPTION_FRIENDLY_NAMES;
 
+  PrepareNames();
+
   return spvInstructionBinaryToText(context()->target_env, words, num_words,
                                     words_, num_words_, disassembly_options);
 }
@@ -1225,6 +1672,12 @@ bool ValidationState_t::ContainsSizedIntOrFloatType(uint32_t id, SpvOp type,
                                                     uint32_t width) const {
   if (type != SpvOpTypeInt && type != SpvOpTypeFloat) return false;
 
+  TypeProperty property;
+  if (GetSizedTypeProperty(type, width, &property)) {
+    return ContainsTypeProperty(id, property);
+  }
+
+  // Other widths are rare, so they are not memoized.
   const auto inst = FindDef(id);
   if (!inst) return false;
 
@@ -16,7 +16,11 @@
 #define SOURCE_VAL_VALIDATION_STATE_H_
 
 #include <algorithm>
-#include <map>
+#include <deque>
+#include <functional>
+#include <initializer_list>
+#include <memory>
+#include <mutex>
 #include <set>
 #include <string>
 #include <tuple>
@@ -59,6 +63,19 @@ enum ModuleLayoutSection {
   kLayoutFunctionDefinitions    /// < Section 2.4 #11
 };
 
+/// The operands of an OpTypeImage. See the OpTypeImage spec for more
+/// information.
+struct ImageTypeInfo {
+  uint32_t sampled_type = 0;
+  SpvDim dim = SpvDimMax;
+  uint32_t depth = 0;
+  uint32_t arrayed = 0;
+  uint32_t multisampled = 0;
+  uint32_t sampled = 0;
+  SpvImageFormat format = SpvImageFormatMax;
+  SpvAccessQualifier access_qualifier = SpvAccessQualifierMax;
+};
+
 /// This class manages the state of the SPIR-V validation as it is being parsed.
 class ValidationState_t {
  public:
@@ -124,6 +141,19 @@ class ValidationState_t {
                     const uint32_t* words, const size_t num_words,
                     const uint32_t max_warnings);
 
+  /// Constructs the state of a module that is supplied one instruction at a
+  /// time rather than as a binary.  |header| holds the SPV_INDEX_INSTRUCTION
+  /// words of the header of the module, which has |num_instructions|
+  /// instructions of |num_words| words in total, |num_functions| of which are
+  /// OpFunction.  |get_binary| returns the binary of the module.  It is only
+  /// called when a diagnostic names an id or disassembles an instruction.
+  ValidationState_t(const spv_const_context context,
+                    const spv_const_validator_options opt,
+                    const uint32_t* header, size_t num_instructions,
+                    size_t num_words, size_t num_functions,
+                    std::function<std::vector<uint32_t>()> get_binary,
+                    const uint32_t max_warnings);
+
   /// Returns the context
   spv_const_context context() const { return context_; }
 
@@ -178,12 +208,6 @@ class ValidationState_t {
   /// Returns true if the id has been defined
   bool IsDefinedId(uint32_t id) const;
 
-  /// Increments the total number of instructions in the file.
-  void increment_total_instructions() { total_instructions_++; }
-
-  /// Increments the total number of functions in the file.
-  void increment_total_functions() { total_functions_++; }
-
   /// Allocates internal storage. Note, calling this will invalidate any
   /// pointers to |ordered_instructions_| or |module_functions_| and, hence,
   /// should only be called at the beginning of validation.
@@ -200,6 +224,12 @@ class ValidationState_t {
 
   DiagnosticStream diag(spv_result_t error_code, const Instruction* inst);
 
+  /// Sets whether diagnostics are suppressed.  While they are, diag returns a
+  /// stream that discards its message, and does not count warnings.
+  void set_diagnostics_suppressed(bool suppressed) {
+    diagnostics_suppressed_ = suppressed;
+  }
+
   /// Returns the function states
   std::vector<Function>& functions();
 
@@ -276,8 +306,9 @@ class ValidationState_t {
     return &it->second;
   }
 
-  /// Traverses call tree and computes function_to_entry_points_.
-  /// Note: called after fully parsing the binary.
+  /// Traverses call tree and computes function_to_entry_points_, and the
+  /// entry points that reference each global <id>.
+  /// Note: called after fully parsing the binary and registering the uses.
   void ComputeFunctionToEntryPointMapping();
 
   /// Traverse call tree and computes recursive_entry_points_.
@@ -288,10 +319,18 @@ class ValidationState_t {
   /// Returns all the entry points that can call |func|.
   const std::vector<uint32_t>& FunctionEntryPoints(uint32_t func) const;
 
-  /// Returns all the entry points that statically use |id|.
+  /// Returns the execution models of all the entry points that can call
+  /// |func|.
   ///
   /// Note: requires ComputeFunctionToEntryPointMapping to have been called.
-  std::set<uint32_t> EntryPointReferences(uint32_t id) const;
+  const std::set<SpvExecutionModel>& FunctionExecutionModels(
+      uint32_t func) const;
+
+  /// Returns all the entry points that statically use |id|, in increasing
+  /// order.
+  ///
+  /// Note: requires ComputeFunctionToEntryPointMapping to have been called.
+  const std::vector<uint32_t>& EntryPointReferences(uint32_t id) const;
 
   /// Inserts an <id> to the set of functions that are target of OpFunctionCall.
   void AddFunctionCallTarget(const uint32_t id) {
@@ -374,6 +413,11 @@ class ValidationState_t {
   /// Inserts the instruction into the list of ordered instructions in the file.
   Instruction* AddOrderedInstruction(const spv_parsed_instruction_t* inst);
 
+  /// Records, for each instruction, where its result id is referenced by the
+  /// other instructions. Must be called once all the instructions have been
+  /// added and registered.
+  void RegisterUses();
+
   /// Registers the instruction. This will add the instruction to the list of
   /// definitions and register sampled image consumers.
   void RegisterInstruction(Instruction* inst);
@@ -383,18 +427,21 @@ class ValidationState_t {
 
   /// Registers the decoration for the given <id>
   void RegisterDecorationForId(uint32_t id, const Decoration& dec) {
-    auto& dec_list = id_decorations_[id];
+    auto& dec_list = MutableDecorations(id);
     auto lb = std::find(dec_list.begin(), dec_list.end(), dec);
     if (lb == dec_list.end()) {
       dec_list.push_back(dec);
+      IndexDecorations(id, dec_list.size() - 1);
     }
   }
 
   /// Registers the list of decorations for the given <id>
   template <class InputIt>
   void RegisterDecorationsForId(uint32_t id, InputIt begin, InputIt end) {
-    std::vector<Decoration>& cur_decs = id_decorations_[id];
+    std::vector<Decoration>& cur_decs = MutableDecorations(id);
+    const size_t first = cur_decs.size();
     cur_decs.insert(cur_decs.end(), begin, end);
+    IndexDecorations(id, first);
   }
 
   /// Registers the list of decorations for the given member of the given
@@ -404,31 +451,54 @@ class ValidationState_t {
                                           uint32_t member_index, InputIt begin,
                                           InputIt end) {
     RegisterDecorationsForId(struct_id, begin, end);
-    for (auto& decoration : id_decorations_[struct_id]) {
+    for (auto& decoration : MutableDecorations(struct_id)) {
       decoration.set_struct_member_index(member_index);
     }
   }
 
   /// Returns all the decorations for the given <id>. If no decorations exist
-  /// for the <id>, it registers an empty vector for it in the map and
-  /// returns the empty vector.
+  /// for the <id>, returns an empty vector, which must not be modified.  Does
+  /// not modify the state, so that functions can be checked concurrently.
   std::vector<Decoration>& id_decorations(uint32_t id) {
-    return id_decorations_[id];
+    if (id >= id_decorations_index_.size() || !id_decorations_index_[id]) {
+      assert(empty_decorations_.empty());
+      return empty_decorations_;
+    }
+    return decorations_[id_decorations_index_[id] - 1];
   }
 
-  // Returns const pointer to the internal decoration container.
-  const std::map<uint32_t, std::vector<Decoration>>& id_decorations() const {
-    return id_decorations_;
+  /// Returns the <id>s that have been decorated, in increasing order.
+  std::vector<uint32_t> decorated_ids() const;
+
+  /// A decoration of an <id>: the <id>, and the position of the decoration
+  /// in id_decorations(id).
+  struct DecorationRef {
+    uint32_t id;
+    uint32_t index;
+  };
+
+  /// Returns the decorations of kind |dec| of all <id>s, in the order in
+  /// which they were registered.  Does not modify the state.
+  const std::vector<DecorationRef>& decorations_of_kind(
+      SpvDecoration dec) const;
+
+  /// Returns the decorations of the kinds |decs| of all <id>s, ordered by
+  /// <id> and then as in id_decorations, so that checks of a few kinds of
+  /// decorations need not look at the others.
+  std::vector<DecorationRef> decorations_of_kinds(
+      std::initializer_list<SpvDecoration> decs) const;
+
+  /// Returns the decoration |ref|.
+  const Decoration& decoration(const DecorationRef& ref) {
+    return id_decorations(ref.id)[ref.index];
   }
 
   /// Returns true if the given id <id> has the given decoration <dec>,
   /// otherwise returns false.
   bool HasDecoration(uint32_t id, SpvDecoration dec) {
-    const auto& decorations = id_decorations_.find(id);
-    if (decorations == id_decorations_.end()) return false;
-
+    const auto& decorations = id_decorations(id);
     return std::any_of(
-        decorations->second.begin(), decorations->second.end(),
+        decorations.begin(), decorations.end(),
         [dec](const Decoration& d) { return dec == d.dec_type(); });
   }
 
@@ -445,11 +515,6 @@ class ValidationState_t {
     return ordered_instructions_;
   }
 
-  /// Returns a map of instructions mapped by their result id
-  const std::unordered_map<uint32_t, Instruction*>& all_definitions() const {
-    return all_definitions_;
-  }
-
   /// Returns a vector containing the instructions that consume the given
   /// SampledImage id.
   std::vector<Instruction*> getSampledImageConsumers(uint32_t id) const;
@@ -576,6 +641,37 @@ class ValidationState_t {
   bool IsIntCooperativeMatrixType(uint32_t id) const;
   bool IsUnsignedIntCooperativeMatrixType(uint32_t id) const;
 
+  /// The properties of a type which its containing types have too, as far as
+  /// the containers of each property go.  They are computed once for each
+  /// type when it is registered, from the properties of the types it
+  /// contains, so that the recursive queries on types take constant time.
+  enum class TypeProperty : uint32_t {
+    /// Contains an integer or floating point type of the given width, through
+    /// the composite, image, cooperative matrix, function and non-forward
+    /// pointer types.
+    kInt8,
+    kInt16,
+    kInt32,
+    kInt64,
+    kFloat16,
+    kFloat32,
+    kFloat64,
+    /// Contains OpTypeBool, through the vector, matrix, array and structure
+    /// types.
+    kBool,
+    /// Contains an opaque type, through the array and structure types.
+    kOpaque,
+    /// Contains a cooperative matrix type, through the array and structure
+    /// types.
+    kCooperativeMatrix,
+  };
+
+  /// Returns true if the type |id| has |property|, or false if |id| is not a
+  /// registered type.
+  bool ContainsTypeProperty(uint32_t id, TypeProperty property) const {
+    return (TypePropertiesOf(id) & TypePropertyMask(property)) != 0;
+  }
+
   // Returns true if |id| is a type id that contains |type| (or integer or
   // floating point type) of |width| bits.
   bool ContainsSizedIntOrFloatType(uint32_t id, SpvOp type,
@@ -601,6 +697,11 @@ class ValidationState_t {
   uint32_t GetOperandTypeId(const Instruction* inst,
                             size_t operand_index) const;
 
+  // Provides information on image type. |id| should be either OpTypeImage or
+  // OpTypeSampledImage.  Returns false in case of failure (not an image type,
+  // wrong number of operands, etc).
+  bool GetImageTypeInfo(uint32_t id, ImageTypeInfo* info) const;
+
   // Provides information on pointer type. Returns false iff not pointer type.
   bool GetPointerTypeInfo(uint32_t id, uint32_t* data_type,
                           uint32_t* storage_class) const;
@@ -662,6 +763,47 @@ class ValidationState_t {
     pointer_to_storage_image_.insert(type_id);
   }
 
+  // The layout properties of struct types that the block layout checks of
+  // ValidateDecorations memoize.  They only depend on the struct and on the
+  // module, so each is computed at most once.
+  enum class StructLayout {
+    kSize,
+    kBaseAlignment,
+    // The base alignment rounded up to a multiple of 16 bytes, as in the
+    // uniform buffer layout rules.
+    kExtendedAlignment,
+    kScalarAlignment,
+  };
+  // Returns true and sets |*value| if |property| of the struct |struct_id|
+  // has been memoized.
+  bool GetStructLayout(uint32_t struct_id, StructLayout property,
+                       uint32_t* value) const {
+    const auto it = struct_layouts_.find(StructLayoutKey(struct_id, property));
+    if (it == struct_layouts_.end()) return false;
+    *value = it->second;
+    return true;
+  }
+  // Memoizes |value| as |property| of the struct |struct_id|.
+  void SetStructLayout(uint32_t struct_id, StructLayout property,
+                       uint32_t value) {
+    struct_layouts_[StructLayoutKey(struct_id, property)] = value;
+  }
+  // Is the layout of the struct |struct_id| known to satisfy the uniform
+  // buffer rules if |block_rules|, or else the storage buffer rules, when it
+  // is placed at |offset|?
+  bool IsStructLayoutChecked(uint32_t struct_id, bool block_rules,
+                             uint32_t offset) const {
+    return checked_struct_layouts_.count(
+               std::make_tuple(struct_id, block_rules, offset)) != 0;
+  }
+  // Save that the layout of the struct |struct_id| satisfies the rules at
+  // |offset|.
+  void RegisterCheckedStructLayout(uint32_t struct_id, bool block_rules,
+                                   uint32_t offset) {
+    checked_struct_layouts_.insert(
+        std::make_tuple(struct_id, block_rules, offset));
+  }
+
   // Tries to evaluate a 32-bit signed or unsigned scalar integer constant.
   // Returns tuple <is_int32, is_const_int32, value>.
   // OpSpecConstant* return |is_const_int32| as false since their values cannot
@@ -715,9 +857,14 @@ class ValidationState_t {
   /// Stores the Validator command line options. Must be a valid options object.
   const spv_const_validator_options options_;
 
-  /// The SPIR-V binary module we're validating.
-  const uint32_t* words_;
-  const size_t num_words_;
+  /// The SPIR-V binary module we're validating.  If the module is supplied
+  /// one instruction at a time, these are only set by PrepareNames.
+  mutable const uint32_t* words_;
+  mutable size_t num_words_;
+  /// Returns the binary of a module supplied one instruction at a time.
+  std::function<std::vector<uint32_t>()> get_binary_;
+  /// The binary returned by get_binary_.
+  mutable std::vector<uint32_t> binary_;
 
   /// The generator of the SPIR-V.
   uint32_t generator_ = 0;
@@ -725,8 +872,17 @@ class ValidationState_t {
   /// The version of the SPIR-V.
   uint32_t version_ = 0;
 
+  /// Reads the header of the module of |num_words| |words|, and counts its
+  /// instructions, words and functions from the word counts of its
+  /// instructions, without decoding them.  Does nothing if the header is
+  /// invalid, and stops counting at a malformed word count, which the parser
+  /// reports.
+  void PrescanModule(const uint32_t* words, size_t num_words);
+
   /// The total number of instructions in the binary.
   size_t total_instructions_ = 0;
+  /// The total number of words of the instructions in the binary.
+  size_t total_words_ = 0;
   /// The total number of functions in the binary.
   size_t total_functions_ = 0;
 
@@ -761,8 +917,20 @@ class ValidationState_t {
   /// List of all instructions in the order they appear in the binary
   std::vector<Instruction> ordered_instructions_;
 
-  /// Instructions that can be referenced by Ids
-  std::unordered_map<uint32_t, Instruction*> all_definitions_;
+  /// The words and operands of |ordered_instructions_|, in order.  Each block
+  /// is allocated once, with room for those of the whole module when its size
+  /// is known, so the instructions can point into it.
+  std::vector<std::vector<uint32_t>> instruction_words_;
+  std::vector<std::vector<spv_parsed_operand_t>> instruction_operands_;
+
+  /// The uses of the result ids of |ordered_instructions_|, grouped by the
+  /// instruction that defines the id.
+  std::vector<Instruction::Use> instruction_uses_;
+
+  /// Instructions that can be referenced by Ids, indexed by their result id.
+  /// Ids are dense and below the bound, so this is sized to the largest id
+  /// defined.
+  std::vector<Instruction*> id_definitions_;
 
   /// IDs that are entry points, ie, arguments to OpEntryPoint.
   std::vector<uint32_t> entry_points_;
@@ -797,14 +965,94 @@ class ValidationState_t {
   std::unordered_map<uint32_t, bool>
       struct_has_nested_blockorbufferblock_struct_;
 
-  /// Stores the list of decorations for a given <id>
-  std::map<uint32_t, std::vector<Decoration>> id_decorations_;
+  /// Returns the decorations of |id|, adding an empty list if it has none.
+  std::vector<Decoration>& MutableDecorations(uint32_t id);
+
+  /// Adds the decorations of |id| from position |first| on to
+  /// |decorations_by_kind_|.
+  void IndexDecorations(uint32_t id, size_t first);
+
+  /// The operands of a type declaration, decoded once when it is registered
+  /// so that the checks of the instructions of that type need not decode
+  /// them again.
+  struct TypeInfo {
+    /// For scalar, vector, matrix and cooperative matrix types, the result of
+    /// GetComponentType, or 0 for other types.
+    uint32_t component_type = 0;
+    /// For the types with a component type, the result of GetDimension.
+    uint32_t dimension = 0;
+    /// For scalar types, the result of GetBitWidth.
+    uint32_t bit_width = 0;
+    /// For image and sampled image types of the right number of operands,
+    /// true, and |image| is the image type.
+    bool is_image = false;
+    ImageTypeInfo image;
+  };
+
+  /// Decodes the type declared by |inst|, if it is one of the types of
+  /// TypeInfo whose operands are registered types.
+  void RegisterTypeInfo(const Instruction* inst);
+
+  /// Returns the decoded type |id|, or nullptr if it is not registered.
+  const TypeInfo* FindTypeInfo(uint32_t id) const {
+    if (id >= id_type_info_index_.size() || !id_type_info_index_[id]) {
+      return nullptr;
+    }
+    return &type_infos_[id_type_info_index_[id] - 1];
+  }
+
+  /// Returns the bit of |property| in |type_properties_|.
+  static uint32_t TypePropertyMask(TypeProperty property) {
+    return 1u << static_cast<uint32_t>(property);
+  }
+
+  /// Sets |property| to the property of |type| values of |width| bits, for
+  /// OpTypeInt and OpTypeFloat.  Returns false if there is none.
+  static bool GetSizedTypeProperty(SpvOp type, uint32_t width,
+                                   TypeProperty* property);
+
+  /// Computes the properties of the type declared by |inst|, if it is one,
+  /// from those of the types it contains.
+  void RegisterTypeProperties(const Instruction* inst);
+
+  /// Returns the properties of the type |id|, or 0 if it has none.
+  uint32_t TypePropertiesOf(uint32_t id) const {
+    return id < type_properties_.size() ? type_properties_[id] : 0;
+  }
+
+  /// The TypePropertyMask of the properties of each type.  Indexed by <id>.
+  std::vector<uint32_t> type_properties_;
+
+  /// The decoded types, and the index of each type in |type_infos_|, plus
+  /// one, or 0 if it has none.  Indexed by <id>.
+  std::vector<TypeInfo> type_infos_;
+  std::vector<uint32_t> id_type_info_index_;
+
+  /// Stores the list of decorations for each decorated <id>.  A deque, so
+  /// that references to a list stay valid as others are added.
+  std::deque<std::vector<Decoration>> decorations_;
+  /// The index of the decorations of each <id> in |decorations_|, plus one,
+  /// or 0 if the <id> has none.  Indexed by <id>.
+  std::vector<uint32_t> id_decorations_index_;
+  /// The decorations of an <id> without any.
+  std::vector<Decoration> empty_decorations_;
+  /// The decorations of each kind, in the order in which they were
+  /// registered.  Only positions are kept, since the member index of a
+  /// registered decoration may still change.
+  std::unordered_map<uint32_t, std::vector<DecorationRef>>
+      decorations_by_kind_;
+  /// The decorations of a kind without any.
+  std::vector<DecorationRef> empty_decoration_refs_;
+
+  /// Hashes the words of a type declaration.
+  struct TypeDeclarationHash {
+    size_t operator()(const std::vector<uint32_t>& words) const;
+  };
 
   /// Stores type declarations which need to be unique (i.e. non-aggregates),
   /// in the form [opcode, operand words], result_id is not stored.
-  /// Using ordered set to avoid the need for a vector hash function.
-  /// The size of this container is expected not to exceed double-digits.
-  std::set<std::vector<uint32_t>> unique_type_declarations_;
+  std::unordered_set<std::vector<uint32_t>, TypeDeclarationHash>
+      unique_type_declarations_;
 
   AssemblyGrammar grammar_;
 
@@ -839,6 +1087,20 @@ class ValidationState_t {
   std::unordered_map<uint32_t, std::vector<uint32_t>> function_to_entry_points_;
   const std::vector<uint32_t> empty_ids_;
 
+  /// Computes entry_point_references_.
+  void ComputeEntryPointReferences();
+
+  /// Mapping global <id> -> entry points which use it, directly or through
+  /// other global instructions, in increasing order.  The <id>s used by no
+  /// entry point are absent.
+  std::unordered_map<uint32_t, std::vector<uint32_t>> entry_point_references_;
+
+  /// Mapping function -> execution models of the entry points in
+  /// function_to_entry_points_.
+  std::unordered_map<uint32_t, std::set<SpvExecutionModel>>
+      function_to_execution_models_;
+  const std::set<SpvExecutionModel> empty_execution_models_;
+
   // The IDs of types of pointers to Block-decorated structs in Uniform storage
   // class. This is populated at the start of ValidateDecorations.
   std::unordered_set<uint32_t> pointer_to_uniform_block_;
@@ -855,14 +1117,31 @@ class ValidationState_t {
   // The IDs of types of pointers to storage images.  This is populated in the
   // TypePass.
   std::unordered_set<uint32_t> pointer_to_storage_image_;
+  // The memoized layout properties of struct types, keyed by StructLayoutKey.
+  std::unordered_map<uint64_t, uint32_t> struct_layouts_;
+  // The struct layouts known to satisfy block layout rules, as (struct id,
+  // block rules, offset).  This is populated in ValidateDecorations.
+  std::set<std::tuple<uint32_t, bool, uint32_t>> checked_struct_layouts_;
+
+  /// Returns the key of |property| of |struct_id| in struct_layouts_.
+  static uint64_t StructLayoutKey(uint32_t struct_id, StructLayout property) {
+    return uint64_t(struct_id) << 2 | uint64_t(property);
+  }
+
+  /// Makes friendly_mapper_, and the binary if needed, on first use.  This
+  /// takes a parse of the whole module, which is only needed by diagnostics.
+  /// Safe to call from several threads at once.
+  void PrepareNames() const;
 
-  /// Maps ids to friendly names.
-  std::unique_ptr<spvtools::FriendlyNameMapper> friendly_mapper_;
-  spvtools::NameMapper name_mapper_;
+  /// Maps ids to friendly names.  Made by PrepareNames.
+  mutable std::unique_ptr<spvtools::FriendlyNameMapper> friendly_mapper_;
+  mutable std::once_flag names_prepared_;
 
   /// Variables used to reduce the number of diagnostic messages.
   uint32_t num_of_warnings_;
   uint32_t max_num_of_warnings_;
+  /// Are diagnostics being discarded?
+  bool diagnostics_suppressed_;
 };
 
 }  // namespace val
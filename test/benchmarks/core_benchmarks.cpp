@@ -0,0 +1,497 @@
+// Copyright (c) 2019 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// Benchmarks for the creation of contexts, for the parser, assembler,
+// disassembler and validator, for the passes of the optimizer which dominate
+// legalization, and for loading a module into the optimizer with its ids
+// compacted in module order or by locality.
+//
+// Usage: spirv-tools-benchmarks [benchmark options] [<file.spv> ...]
+//
+// Each benchmark runs over the given SPIR-V binaries, or over the fuzzer
+// corpus when none are given, and over a few large synthetic modules.  The
+// throughput is reported in bytes per second of input, and in instructions
+// per second.  To benchmark legalization, pass the modules produced by an
+// HLSL front end before legalization.
+
+#include <cstdint>
+#include <cstdio>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "benchmark/benchmark.h"
+#include "source/opt/build_module.h"
+#include "source/opt/ir_context.h"
+#include "spirv-tools/libspirv.h"
+#include "spirv-tools/optimizer.hpp"
+#include "tools/io.h"
+
+namespace {
+
+const spv_target_env kEnv = SPV_ENV_UNIVERSAL_1_3;
+
+// A module to run the benchmarks over, in both binary and text form.
+struct Module {
+  std::string name;
+  std::vector<uint32_t> binary;
+  std::string text;
+  size_t num_instructions = 0;
+  bool valid = false;
+};
+
+// Owns a context for the duration of a benchmark.
+class Context {
+ public:
+  Context() : context_(spvContextCreate(kEnv)) {}
+  ~Context() { spvContextDestroy(context_); }
+  Context(const Context&) = delete;
+  Context& operator=(const Context&) = delete;
+
+  spv_context get() const { return context_; }
+
+ private:
+  spv_context context_;
+};
+
+void IgnoreMessage(spv_message_level_t, const char*, const spv_position_t&,
+                   const char*) {}
+
+spv_result_t CountInstruction(void* user_data,
+                              const spv_parsed_instruction_t*) {
+  ++*static_cast<size_t*>(user_data);
+  return SPV_SUCCESS;
+}
+
+// Fills in the text form, instruction count and validity of |module| from
+// its binary form.  Returns false if the binary cannot be parsed.
+bool Prepare(Module* module) {
+  Context context;
+  if (spvBinaryParse(context.get(), &module->num_instructions,
+                     module->binary.data(), module->binary.size(), nullptr,
+                     CountInstruction, nullptr) != SPV_SUCCESS) {
+    return false;
+  }
+  spv_text text = nullptr;
+  if (spvBinaryToText(context.get(), module->binary.data(),
+                      module->binary.size(), SPV_BINARY_TO_TEXT_OPTION_NONE,
+                      &text, nullptr) != SPV_SUCCESS) {
+    return false;
+  }
+  module->text.assign(text->str, text->length);
+  spvTextDestroy(text);
+  module->valid = spvValidateBinary(context.get(), module->binary.data(),
+                                    module->binary.size(),
+                                    nullptr) == SPV_SUCCESS;
+  return true;
+}
+
+// Assembles |text| into a module called |name|.  Returns nullptr on failure.
+std::unique_ptr<Module> Assemble(const std::string& name,
+                                 const std::string& text) {
+  Context context;
+  spv_binary binary = nullptr;
+  if (spvTextToBinary(context.get(), text.data(), text.size(), &binary,
+                      nullptr) != SPV_SUCCESS) {
+    return nullptr;
+  }
+  std::unique_ptr<Module> module(new Module);
+  module->name = name;
+  module->binary.assign(binary->code, binary->code + binary->wordCount);
+  spvBinaryDestroy(binary);
+  if (!Prepare(module.get())) return nullptr;
+  return module;
+}
+
+// Returns a copy of |module| whose ids were compacted by the compact ids pass,
+// in module order or by locality.  Returns nullptr on failure.
+std::unique_ptr<Module> CompactIds(const Module& module,
+                                   bool order_by_locality) {
+  spvtools::Optimizer optimizer(kEnv);
+  optimizer.RegisterPass(spvtools::CreateCompactIdsPass(order_by_locality));
+  spvtools::OptimizerOptions options;
+  options.set_run_validator(false);
+  std::unique_ptr<Module> compacted(new Module);
+  compacted->name =
+      module.name + (order_by_locality ? ".locality" : ".compact");
+  if (!optimizer.Run(module.binary.data(), module.binary.size(),
+                     &compacted->binary, options) ||
+      !Prepare(compacted.get())) {
+    return nullptr;
+  }
+  return compacted;
+}
+
+// Returns the text of a module with |count| small functions.
+std::string ManyFunctions(int count) {
+  std::string text =
+      "OpCapability Shader\n"
+      "OpMemoryModel Logical GLSL450\n"
+      "%int = OpTypeInt 32 1\n"
+      "%fn = OpTypeFunction %int %int\n"
+      "%ten = OpConstant %int 10\n";
+  for (int i = 0; i < count; ++i) {
+    const std::string n = std::to_string(i);
+    text += "%f" + n + " = OpFunction %int None %fn\n" + "%p" + n +
+            " = OpFunctionParameter %int\n" + "%l" + n + " = OpLabel\n" +
+            "%a" + n + " = OpIAdd %int %p" + n + " %ten\n" + "%m" + n +
+            " = OpIMul %int %a" + n + " %p" + n + "\n" + "OpReturnValue %m" +
+            n + "\n" + "OpFunctionEnd\n";
+  }
+  return text;
+}
+
+// Returns the text of a module with a single function of about |count|
+// arithmetic instructions.
+std::string LongFunction(int count) {
+  std::string text =
+      "OpCapability Shader\n"
+      "OpMemoryModel Logical GLSL450\n"
+      "%float = OpTypeFloat 32\n"
+      "%fn = OpTypeFunction %float %float\n"
+      "%half = OpConstant %float 0.5\n"
+      "%f = OpFunction %float None %fn\n"
+      "%v0 = OpFunctionParameter %float\n"
+      "%entry = OpLabel\n";
+  for (int i = 0; i < count; ++i) {
+    text += "%v" + std::to_string(i + 1) + " = OpFMul %float %v" +
+            std::to_string(i) + " %half\n";
+  }
+  text += "OpReturnValue %v" + std::to_string(count) +
+          "\n"
+          "OpFunctionEnd\n";
+  return text;
+}
+
+// Returns the text of a module with |count| named variables and constants,
+// to exercise the global section and the friendly names.
+std::string ManyGlobals(int count) {
+  std::string text =
+      "OpCapability Shader\n"
+      "OpMemoryModel Logical GLSL450\n";
+  for (int i = 0; i < count; ++i) {
+    text += "OpName %var" + std::to_string(i) + " \"variable_" +
+            std::to_string(i) + "\"\n";
+  }
+  text +=
+      "%float = OpTypeFloat 32\n"
+      "%ptr = OpTypePointer Private %float\n";
+  for (int i = 0; i < count; ++i) {
+    const std::string n = std::to_string(i);
+    text += "%c" + n + " = OpConstant %float " + n + ".5\n" + "%var" + n +
+            " = OpVariable %ptr Private %c" + n + "\n";
+  }
+  return text;
+}
+
+// Returns the text of a module with |count| integer, hexadecimal and float
+// constants of each width, as in generated lookup tables, to exercise the
+// parsing of numeric literals.
+std::string ManyLiterals(int count) {
+  std::string text =
+      "OpCapability Shader\n"
+      "OpCapability Int64\n"
+      "OpCapability Float64\n"
+      "OpMemoryModel Logical GLSL450\n"
+      "%int = OpTypeInt 32 1\n"
+      "%uint = OpTypeInt 32 0\n"
+      "%long = OpTypeInt 64 1\n"
+      "%float = OpTypeFloat 32\n"
+      "%double = OpTypeFloat 64\n";
+  for (int i = 0; i < count; ++i) {
+    const std::string n = std::to_string(i);
+    char hex[16];
+    snprintf(hex, sizeof(hex), "0x%08x", unsigned(i) * 2654435761u);
+    text += "%i" + n + " = OpConstant %int -" + std::to_string(i * 7919) +
+            "\n" + "%u" + n + " = OpConstant %uint " + hex + "\n" + "%l" +
+            n + " = OpConstant %long " + std::to_string(i * 1000003LL) +
+            "\n" + "%f" + n + " = OpConstant %float " + n + ".125\n" + "%d" +
+            n + " = OpConstant %double -" + n + ".0625e-3\n";
+  }
+  return text;
+}
+
+// Returns the text of a module with a single function of |depth| nested
+// selection constructs, to exercise the structured control flow checks.
+std::string NestedSelections(int depth) {
+  std::string text =
+      "OpCapability Shader\n"
+      "OpMemoryModel Logical GLSL450\n"
+      "%void = OpTypeVoid\n"
+      "%bool = OpTypeBool\n"
+      "%true = OpConstantTrue %bool\n"
+      "%fn = OpTypeFunction %void\n"
+      "%f = OpFunction %void None %fn\n";
+  for (int i = 0; i < depth; ++i) {
+    const std::string n = std::to_string(i);
+    text += "%h" + n + " = OpLabel\n" + "OpSelectionMerge %m" + n +
+            " None\n" + "OpBranchConditional %true %h" +
+            std::to_string(i + 1) + " %m" + n + "\n";
+  }
+  text += "%h" + std::to_string(depth) + " = OpLabel\n";
+  for (int i = depth - 1; i >= 0; --i) {
+    const std::string n = std::to_string(i);
+    text += "OpBranch %m" + n + "\n" + "%m" + n + " = OpLabel\n";
+  }
+  text +=
+      "OpReturn\n"
+      "OpFunctionEnd\n";
+  return text;
+}
+
+// Returns the text of a module with a single function of |blocks| selection
+// constructs, each of which loads one of |vars| local variables and
+// conditionally stores to it, as front ends emit before legalization.
+std::string ManyLocals(int vars, int blocks) {
+  std::string text =
+      "OpCapability Shader\n"
+      "OpMemoryModel Logical GLSL450\n"
+      "%void = OpTypeVoid\n"
+      "%bool = OpTypeBool\n"
+      "%true = OpConstantTrue %bool\n"
+      "%int = OpTypeInt 32 1\n"
+      "%zero = OpConstant %int 0\n"
+      "%one = OpConstant %int 1\n"
+      "%ptr = OpTypePointer Function %int\n"
+      "%fn = OpTypeFunction %void\n"
+      "%f = OpFunction %void None %fn\n"
+      "%entry = OpLabel\n";
+  for (int i = 0; i < vars; ++i) {
+    text += "%var" + std::to_string(i) + " = OpVariable %ptr Function\n";
+  }
+  for (int i = 0; i < vars; ++i) {
+    text += "OpStore %var" + std::to_string(i) + " %zero\n";
+  }
+  text += "OpBranch %h0\n";
+  for (int i = 0; i < blocks; ++i) {
+    const std::string n = std::to_string(i);
+    const std::string next = "%h" + std::to_string(i + 1);
+    const std::string var = "%var" + std::to_string(i % vars);
+    text += "%h" + n + " = OpLabel\n" + "%x" + n + " = OpLoad %int " + var +
+            "\n" + "%y" + n + " = OpIAdd %int %x" + n + " %one\n" +
+            "OpSelectionMerge " + next + " None\n" +
+            "OpBranchConditional %true %t" + n + " " + next + "\n" + "%t" +
+            n + " = OpLabel\n" + "OpStore " + var + " %y" + n + "\n" +
+            "OpBranch " + next + "\n";
+  }
+  text += "%h" + std::to_string(blocks) +
+          " = OpLabel\n"
+          "OpReturn\n"
+          "OpFunctionEnd\n";
+  return text;
+}
+
+// Records the throughput of the benchmark, where each iteration processed
+// |bytes| of input holding the instructions of |module|.
+void SetThroughput(benchmark::State& state, const Module& module,
+                   size_t bytes) {
+  state.SetBytesProcessed(int64_t(state.iterations()) * int64_t(bytes));
+  state.counters["instructions"] = benchmark::Counter(
+      double(state.iterations()) * double(module.num_instructions),
+      benchmark::Counter::kIsRate);
+}
+
+void BM_BinaryParse(benchmark::State& state, const Module* module) {
+  Context context;
+  while (state.KeepRunning()) {
+    if (spvBinaryParse(context.get(), nullptr, module->binary.data(),
+                       module->binary.size(), nullptr, nullptr,
+                       nullptr) != SPV_SUCCESS) {
+      state.SkipWithError("spvBinaryParse failed");
+      break;
+    }
+  }
+  SetThroughput(state, *module, module->binary.size() * sizeof(uint32_t));
+}
+
+void BM_TextToBinary(benchmark::State& state, const Module* module) {
+  Context context;
+  while (state.KeepRunning()) {
+    spv_binary binary = nullptr;
+    if (spvTextToBinary(context.get(), module->text.data(),
+                        module->text.size(), &binary,
+                        nullptr) != SPV_SUCCESS) {
+      state.SkipWithError("spvTextToBinary failed");
+      break;
+    }
+    spvBinaryDestroy(binary);
+  }
+  SetThroughput(state, *module, module->text.size());
+}
+
+void BM_BinaryToText(benchmark::State& state, const Module* module) {
+  Context context;
+  while (state.KeepRunning()) {
+    spv_text text = nullptr;
+    if (spvBinaryToText(context.get(), module->binary.data(),
+                        module->binary.size(),
+                        SPV_BINARY_TO_TEXT_OPTION_FRIENDLY_NAMES, &text,
+                        nullptr) != SPV_SUCCESS) {
+      state.SkipWithError("spvBinaryToText failed");
+      break;
+    }
+    spvTextDestroy(text);
+  }
+  SetThroughput(state, *module, module->binary.size() * sizeof(uint32_t));
+}
+
+void BM_Validate(benchmark::State& state, const Module* module) {
+  Context context;
+  while (state.KeepRunning()) {
+    if (spvValidateBinary(context.get(), module->binary.data(),
+                          module->binary.size(), nullptr) != SPV_SUCCESS) {
+      state.SkipWithError("spvValidateBinary failed");
+      break;
+    }
+  }
+  SetThroughput(state, *module, module->binary.size() * sizeof(uint32_t));
+}
+
+// Measures the creation and destruction of a context, which is done for each
+// call of many of the entry points of the library.
+void BM_ContextCreate(benchmark::State& state) {
+  while (state.KeepRunning()) {
+    spv_context context = spvContextCreate(kEnv);
+    benchmark::DoNotOptimize(context);
+    spvContextDestroy(context);
+  }
+}
+
+// Measures the creation and destruction of an optimizer context for an empty
+// module, which is done for each module loaded.
+void BM_IRContextCreate(benchmark::State& state) {
+  while (state.KeepRunning()) {
+    spvtools::opt::IRContext context(kEnv, IgnoreMessage);
+    benchmark::DoNotOptimize(context.module());
+  }
+}
+
+// Measures spvBinaryParse and the construction of the module, followed by the
+// def-use analysis, which is the first analysis built by most passes and
+// which indexes the instructions by id.
+void BM_Load(benchmark::State& state, const Module* module) {
+  while (state.KeepRunning()) {
+    std::unique_ptr<spvtools::opt::IRContext> context =
+        spvtools::BuildModule(kEnv, IgnoreMessage, module->binary.data(),
+                              module->binary.size());
+    if (!context) {
+      state.SkipWithError("BuildModule failed");
+      break;
+    }
+    benchmark::DoNotOptimize(context->get_def_use_mgr());
+  }
+  SetThroughput(state, *module, module->binary.size() * sizeof(uint32_t));
+}
+
+void BM_SSARewrite(benchmark::State& state, const Module* module) {
+  spvtools::Optimizer optimizer(kEnv);
+  optimizer.RegisterPass(spvtools::CreateSSARewritePass());
+  spvtools::OptimizerOptions options;
+  options.set_run_validator(false);
+  std::vector<uint32_t> optimized;
+  while (state.KeepRunning()) {
+    if (!optimizer.Run(module->binary.data(), module->binary.size(),
+                       &optimized, options)) {
+      state.SkipWithError("SSA rewriting failed");
+      break;
+    }
+  }
+  SetThroughput(state, *module, module->binary.size() * sizeof(uint32_t));
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+  benchmark::Initialize(&argc, argv);
+
+  std::vector<std::string> files(argv + 1, argv + argc);
+  if (files.empty()) {
+    files = {
+#include "corpus.inc"
+    };
+  }
+
+  std::vector<std::unique_ptr<Module>> modules;
+  for (const auto& file : files) {
+    std::unique_ptr<Module> module(new Module);
+    module->name = file.substr(file.find_last_of("/\\") + 1);
+    if (!ReadFile<uint32_t>(file.c_str(), "rb", &module->binary)) return 1;
+    if (!Prepare(module.get())) {
+      fprintf(stderr, "error: %s is not a SPIR-V binary\n", file.c_str());
+      return 1;
+    }
+    modules.push_back(std::move(module));
+  }
+  const std::pair<const char*, std::string> synthetic[] = {
+      {"many_functions", ManyFunctions(5000)},
+      {"long_function", LongFunction(50000)},
+      {"many_globals", ManyGlobals(5000)},
+      {"many_literals", ManyLiterals(5000)},
+      {"nested_selections", NestedSelections(1000)},
+      {"many_locals", ManyLocals(200, 2000)},
+  };
+  for (const auto& source : synthetic) {
+    modules.push_back(Assemble(source.first, source.second));
+    if (!modules.back()) {
+      fprintf(stderr, "error: failed to assemble %s\n", source.first);
+      return 1;
+    }
+  }
+
+  // Compare the loading of the modules accepted by the validator with their
+  // ids as given, compacted in module order, and compacted by locality.
+  std::vector<std::unique_ptr<Module>> compacted_modules;
+  for (const auto& module : modules) {
+    if (!module->valid) continue;
+    for (bool order_by_locality : {false, true}) {
+      std::unique_ptr<Module> compacted =
+          CompactIds(*module, order_by_locality);
+      if (!compacted) {
+        fprintf(stderr, "error: failed to compact the ids of %s\n",
+                module->name.c_str());
+        return 1;
+      }
+      compacted_modules.push_back(std::move(compacted));
+    }
+  }
+  benchmark::RegisterBenchmark("ContextCreate", BM_ContextCreate);
+  benchmark::RegisterBenchmark("IRContextCreate", BM_IRContextCreate);
+
+  for (const auto& module : compacted_modules) {
+    benchmark::RegisterBenchmark(("Load/" + module->name).c_str(), BM_Load,
+                                 module.get());
+  }
+
+  for (const auto& module : modules) {
+    const Module* m = module.get();
+    benchmark::RegisterBenchmark(("BinaryParse/" + m->name).c_str(),
+                                 BM_BinaryParse, m);
+    benchmark::RegisterBenchmark(("TextToBinary/" + m->name).c_str(),
+                                 BM_TextToBinary, m);
+    benchmark::RegisterBenchmark(("BinaryToText/" + m->name).c_str(),
+                                 BM_BinaryToText, m);
+    // Benchmark the validator only on modules it accepts, since it may stop
+    // early on the others.
+    if (m->valid) {
+      benchmark::RegisterBenchmark(("Validate/" + m->name).c_str(),
+                                   BM_Validate, m);
+      benchmark::RegisterBenchmark(("SSARewrite/" + m->name).c_str(),
+                                   BM_SSARewrite, m);
+      benchmark::RegisterBenchmark(("Load/" + m->name).c_str(), BM_Load, m);
+    }
+  }
+
+  benchmark::RunSpecifiedBenchmarks();
+  return 0;
+}
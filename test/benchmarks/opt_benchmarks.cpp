@@ -0,0 +1,376 @@
+// Copyright (c) 2019 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// Benchmarks for the pipelines of the optimizer, -O, -Os and legalization,
+// and for a few single passes which dominate them.
+//
+// Usage: spirv-tools-bench [benchmark options] [<file.spv|file.spvasm> ...]
+//
+// Each benchmark runs over the given modules, or over the shaders of
+// test/benchmarks/corpus when none are given, and over synthetic shaders of
+// growing numbers of functions, blocks and ids.  Besides the time, each
+// benchmark reports per run:
+//
+//  - heap_peak: the peak of the bytes allocated on the heap, over those
+//    allocated when the run starts;
+//  - builds/<analysis>: the number of times the passes built the analysis.
+//
+// To track the results across commits, write them as JSON with
+// --benchmark_out=<file> --benchmark_out_format=json.
+
+#include <atomic>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <memory>
+#include <new>
+#include <string>
+#include <vector>
+
+#include "benchmark/benchmark.h"
+#include "spirv-tools/libspirv.h"
+#include "spirv-tools/optimizer.hpp"
+#include "tools/io.h"
+
+namespace {
+
+const spv_target_env kEnv = SPV_ENV_UNIVERSAL_1_3;
+
+// The bytes allocated on the heap and not freed yet, and their peak since the
+// last call to ResetHeapPeak.  They are kept by the replacements of the global
+// operator new and delete below.
+std::atomic<int64_t> heap_bytes(0);
+std::atomic<int64_t> heap_peak(0);
+
+// The size of the header before each block, which records its size.  It keeps
+// the blocks aligned for any type.
+const size_t kHeaderSize = 16;
+
+void* Allocate(size_t size) {
+  char* block = static_cast<char*>(std::malloc(size + kHeaderSize));
+  if (!block) return nullptr;
+  *reinterpret_cast<size_t*>(block) = size;
+  const int64_t bytes = heap_bytes += int64_t(size);
+  int64_t peak = heap_peak.load();
+  while (bytes > peak && !heap_peak.compare_exchange_weak(peak, bytes)) {
+  }
+  return block + kHeaderSize;
+}
+
+void Free(void* pointer) {
+  if (!pointer) return;
+  char* block = static_cast<char*>(pointer) - kHeaderSize;
+  heap_bytes -= int64_t(*reinterpret_cast<size_t*>(block));
+  std::free(block);
+}
+
+// Restarts the peak of the heap from the bytes currently allocated, and
+// returns them.
+int64_t ResetHeapPeak() {
+  const int64_t bytes = heap_bytes.load();
+  heap_peak = bytes;
+  return bytes;
+}
+
+// A module to optimize.
+struct Module {
+  std::string name;
+  std::vector<uint32_t> binary;
+};
+
+// Assembles |text| into the binary of |module|.  Returns false on failure.
+bool Assemble(const std::string& text, Module* module) {
+  spv_context context = spvContextCreate(kEnv);
+  spv_binary binary = nullptr;
+  const bool assembled = spvTextToBinary(context, text.data(), text.size(),
+                                         &binary, nullptr) == SPV_SUCCESS;
+  if (assembled) {
+    module->binary.assign(binary->code, binary->code + binary->wordCount);
+  }
+  spvBinaryDestroy(binary);
+  spvContextDestroy(context);
+  return assembled;
+}
+
+// Reads the module in |file|, in binary form, or in text form if its name
+// ends with ".spvasm".  Returns false on failure.
+bool ReadModule(const std::string& file, Module* module) {
+  module->name = file.substr(file.find_last_of("/\\") + 1);
+  const std::string text_suffix = ".spvasm";
+  if (file.size() > text_suffix.size() &&
+      file.compare(file.size() - text_suffix.size(), text_suffix.size(),
+                   text_suffix) == 0) {
+    std::vector<char> text;
+    return ReadFile<char>(file.c_str(), "r", &text) &&
+           Assemble(std::string(text.begin(), text.end()), module);
+  }
+  return ReadFile<uint32_t>(file.c_str(), "rb", &module->binary);
+}
+
+// The beginning of the synthetic fragment shaders, whose entry point is "%main"
+// and which write a float to "%out".
+const char* kFragmentShaderHeader =
+    "OpCapability Shader\n"
+    "OpMemoryModel Logical GLSL450\n"
+    "OpEntryPoint Fragment %main \"main\" %in %out\n"
+    "OpExecutionMode %main OriginUpperLeft\n"
+    "OpDecorate %in Location 0\n"
+    "OpDecorate %out Location 0\n"
+    "%void = OpTypeVoid\n"
+    "%main_type = OpTypeFunction %void\n"
+    "%bool = OpTypeBool\n"
+    "%float = OpTypeFloat 32\n"
+    "%half = OpConstant %float 0.5\n"
+    "%one = OpConstant %float 1\n"
+    "%float_ptr = OpTypePointer Function %float\n"
+    "%in_ptr = OpTypePointer Input %float\n"
+    "%out_ptr = OpTypePointer Output %float\n"
+    "%in = OpVariable %in_ptr Input\n"
+    "%out = OpVariable %out_ptr Output\n";
+
+// Returns the text of a fragment shader whose entry point calls |count|
+// functions in turn, each through a local variable, as front ends emit them.
+std::string CallChain(int count) {
+  std::string text = kFragmentShaderHeader;
+  text += "%fn = OpTypeFunction %float %float_ptr\n";
+  for (int i = 0; i < count; ++i) {
+    const std::string n = std::to_string(i);
+    text += "%f" + n + " = OpFunction %float None %fn\n" + "%p" + n +
+            " = OpFunctionParameter %float_ptr\n" + "%fl" + n +
+            " = OpLabel\n" + "%x" + n + " = OpLoad %float %p" + n + "\n" +
+            "%y" + n + " = OpFMul %float %x" + n + " %half\n" + "%z" + n +
+            " = OpFAdd %float %y" + n + " %one\n" + "OpReturnValue %z" + n +
+            "\n" + "OpFunctionEnd\n";
+  }
+  text +=
+      "%main = OpFunction %void None %main_type\n"
+      "%entry = OpLabel\n"
+      "%arg = OpVariable %float_ptr Function\n"
+      "%v0 = OpLoad %float %in\n";
+  for (int i = 0; i < count; ++i) {
+    const std::string n = std::to_string(i);
+    text += "OpStore %arg %v" + n + "\n" + "%v" + std::to_string(i + 1) +
+            " = OpFunctionCall %float %f" + n + " %arg\n";
+  }
+  text += "OpStore %out %v" + std::to_string(count) +
+          "\n"
+          "OpReturn\n"
+          "OpFunctionEnd\n";
+  return text;
+}
+
+// Returns the text of a fragment shader whose entry point has |count|
+// selection constructs in sequence, each conditionally updating a local
+// variable, as front ends emit them.
+std::string Branches(int count) {
+  std::string text = kFragmentShaderHeader;
+  text +=
+      "%main = OpFunction %void None %main_type\n"
+      "%entry = OpLabel\n"
+      "%var = OpVariable %float_ptr Function\n"
+      "%init = OpLoad %float %in\n"
+      "OpStore %var %init\n"
+      "OpBranch %h0\n";
+  for (int i = 0; i < count; ++i) {
+    const std::string n = std::to_string(i);
+    const std::string next = "%h" + std::to_string(i + 1);
+    text += "%h" + n + " = OpLabel\n" + "%x" + n + " = OpLoad %float %var\n" +
+            "%c" + n + " = OpFOrdLessThan %bool %x" + n + " %one\n" +
+            "OpSelectionMerge " + next + " None\n" +
+            "OpBranchConditional %c" + n + " %t" + n + " " + next + "\n" +
+            "%t" + n + " = OpLabel\n" + "%y" + n + " = OpFAdd %float %x" + n +
+            " %half\n" + "OpStore %var %y" + n + "\n" + "OpBranch " + next +
+            "\n";
+  }
+  text += "%h" + std::to_string(count) +
+          " = OpLabel\n"
+          "%result = OpLoad %float %var\n"
+          "OpStore %out %result\n"
+          "OpReturn\n"
+          "OpFunctionEnd\n";
+  return text;
+}
+
+// Returns the text of a fragment shader whose entry point has a single block
+// of about |count| arithmetic instructions, each defining an id.
+std::string Arithmetic(int count) {
+  std::string text = kFragmentShaderHeader;
+  text +=
+      "%main = OpFunction %void None %main_type\n"
+      "%entry = OpLabel\n"
+      "%v0 = OpLoad %float %in\n";
+  for (int i = 0; i < count; ++i) {
+    const std::string n = std::to_string(i);
+    text += "%v" + std::to_string(i + 1) + " = " +
+            (i % 2 ? "OpFMul %float %v" : "OpFAdd %float %v") + n +
+            (i % 3 ? " %half\n" : " %one\n");
+  }
+  text += "OpStore %out %v" + std::to_string(count) +
+          "\n"
+          "OpReturn\n"
+          "OpFunctionEnd\n";
+  return text;
+}
+
+// The passes of an optimizer to benchmark.
+struct Passes {
+  const char* name;
+  void (*add)(spvtools::Optimizer* optimizer);
+};
+
+const Passes kPipelines[] = {
+    {"Performance",
+     [](spvtools::Optimizer* o) { o->RegisterPerformancePasses(); }},
+    {"Size", [](spvtools::Optimizer* o) { o->RegisterSizePasses(); }},
+    {"Legalization",
+     [](spvtools::Optimizer* o) { o->RegisterLegalizationPasses(); }},
+};
+
+// The single passes to benchmark, by flag.
+const char* kPassFlags[] = {
+    "--inline-entry-points-exhaustive",
+    "--scalar-replacement",
+    "--ssa-rewrite",
+    "--ccp",
+    "--simplify-instructions",
+    "--redundancy-elimination",
+    "--eliminate-dead-code-aggressive",
+    "--merge-blocks",
+};
+
+void IgnoreMessage(spv_message_level_t, const char*, const spv_position_t&,
+                   const char*) {}
+
+// Optimizes |module| with |optimizer| on each iteration, and reports the work
+// done per iteration.
+void RunOptimizer(benchmark::State& state, spvtools::Optimizer* optimizer,
+                  const Module& module) {
+  optimizer->SetMessageConsumer(IgnoreMessage);
+  spvtools::OptimizerOptions options;
+  options.set_run_validator(false);
+  std::vector<uint32_t> optimized;
+
+  const int64_t heap_start = ResetHeapPeak();
+  while (state.KeepRunning()) {
+    optimized.clear();
+    if (!optimizer->Run(module.binary.data(), module.binary.size(),
+                        &optimized, options)) {
+      state.SkipWithError("the optimizer failed");
+      return;
+    }
+  }
+  state.SetBytesProcessed(int64_t(state.iterations()) *
+                          int64_t(module.binary.size() * sizeof(uint32_t)));
+  state.counters["heap_peak"] = double(heap_peak.load() - heap_start);
+  for (const auto& analysis : optimizer->GetStatistics().analyses) {
+    if (analysis.builds == 0) continue;
+    state.counters[std::string("builds/") + analysis.name] =
+        benchmark::Counter(double(analysis.builds),
+                           benchmark::Counter::kAvgIterations);
+  }
+}
+
+void BM_Pipeline(benchmark::State& state, const Passes* pipeline,
+                 const Module* module) {
+  spvtools::Optimizer optimizer(kEnv);
+  pipeline->add(&optimizer);
+  RunOptimizer(state, &optimizer, *module);
+}
+
+void BM_Pass(benchmark::State& state, const char* flag, const Module* module) {
+  spvtools::Optimizer optimizer(kEnv);
+  if (!optimizer.RegisterPassFromFlag(flag)) {
+    state.SkipWithError("unknown pass");
+    return;
+  }
+  RunOptimizer(state, &optimizer, *module);
+}
+
+}  // namespace
+
+void* operator new(size_t size) {
+  void* pointer = Allocate(size);
+  // The library is built without exceptions.
+  if (!pointer) std::abort();
+  return pointer;
+}
+void* operator new[](size_t size) { return operator new(size); }
+void* operator new(size_t size, const std::nothrow_t&) noexcept {
+  return Allocate(size);
+}
+void* operator new[](size_t size, const std::nothrow_t&) noexcept {
+  return Allocate(size);
+}
+void operator delete(void* pointer) noexcept { Free(pointer); }
+void operator delete[](void* pointer) noexcept { Free(pointer); }
+void operator delete(void* pointer, const std::nothrow_t&) noexcept {
+  Free(pointer);
+}
+void operator delete[](void* pointer, const std::nothrow_t&) noexcept {
+  Free(pointer);
+}
+
+int main(int argc, char** argv) {
+  benchmark::Initialize(&argc, argv);
+
+  std::vector<std::string> files(argv + 1, argv + argc);
+  if (files.empty()) {
+    files = {
+#include "opt_corpus.inc"
+    };
+  }
+
+  std::vector<std::unique_ptr<Module>> modules;
+  for (const auto& file : files) {
+    std::unique_ptr<Module> module(new Module);
+    if (!ReadModule(file, module.get())) {
+      fprintf(stderr, "error: failed to read %s\n", file.c_str());
+      return 1;
+    }
+    modules.push_back(std::move(module));
+  }
+  for (int size : {256, 1024, 4096}) {
+    const std::pair<std::string, std::string> synthetic[] = {
+        {"calls", CallChain(size)},
+        {"branches", Branches(size)},
+        {"arithmetic", Arithmetic(size * 4)},
+    };
+    for (const auto& source : synthetic) {
+      std::unique_ptr<Module> module(new Module);
+      module->name = source.first + "_" + std::to_string(size);
+      if (!Assemble(source.second, module.get())) {
+        fprintf(stderr, "error: failed to assemble %s\n",
+                module->name.c_str());
+        return 1;
+      }
+      modules.push_back(std::move(module));
+    }
+  }
+
+  for (const auto& module : modules) {
+    const Module* m = module.get();
+    for (const Passes& pipeline : kPipelines) {
+      benchmark::RegisterBenchmark(
+          (std::string(pipeline.name) + "/" + m->name).c_str(), BM_Pipeline,
+          &pipeline, m);
+    }
+    for (const char* flag : kPassFlags) {
+      benchmark::RegisterBenchmark(
+          ((flag + 2) + ("/" + m->name)).c_str(), BM_Pass, flag, m);
+    }
+  }
+
+  benchmark::RunSpecifiedBenchmarks();
+  return 0;
+}
@@ -0,0 +1,259 @@
+// Copyright (c) 2019 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// Benchmarks of the validator and the optimizer on the stress modules, which
+// grow along one axis each: the nesting of the constructs, the blocks of a
+// function, the depth and width of structures, the entry points, and the
+// early returns of a function.
+//
+// Usage: spirv-tools-stress-bench [benchmark options]
+//        spirv-tools-stress-bench --write <axis> <size> <file.spv>
+//
+// Before the benchmarks, the work which must scale linearly is checked to do
+// so: its time must grow less than twice as fast as the size of the module.
+// The program fails if it does not, so that quadratic regressions are
+// caught.  The benchmarks then report the complexity fitted to their times.
+//
+// With --write, the stress module of <size> along <axis> is written to
+// <file.spv>, to reproduce a problem with the command line tools.  The axes
+// are nesting, blocks, struct_depth, struct_width, entry_points and returns.
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "benchmark/benchmark.h"
+#include "source/opt/build_module.h"
+#include "source/opt/ir_context.h"
+#include "spirv-tools/libspirv.h"
+#include "spirv-tools/optimizer.hpp"
+#include "test/benchmarks/stress_modules.h"
+#include "tools/io.h"
+
+namespace {
+
+using spvtools::benchmarks::GenerateStressModule;
+using spvtools::benchmarks::GetStressAxisName;
+using spvtools::benchmarks::StressAxis;
+using spvtools::benchmarks::kStressEnv;
+
+// The work to measure on a module.
+enum class Work {
+  // spvValidateBinary.
+  kValidate,
+  // BuildModule and the def-use analysis.
+  kLoad,
+  // The passes of -O.
+  kOptimize,
+  // The merge return pass.
+  kMergeReturn,
+};
+
+const char* GetWorkName(Work work) {
+  switch (work) {
+    case Work::kValidate:
+      return "Validate";
+    case Work::kLoad:
+      return "Load";
+    case Work::kOptimize:
+      return "Optimize";
+    case Work::kMergeReturn:
+      return "MergeReturn";
+  }
+  return "";
+}
+
+void IgnoreMessage(spv_message_level_t, const char*, const spv_position_t&,
+                   const char*) {}
+
+// Does |work| on |binary|, with |context| for the validator.  Returns false
+// on failure.
+bool DoWork(Work work, spv_const_context context,
+            const std::vector<uint32_t>& binary) {
+  switch (work) {
+    case Work::kValidate:
+      return spvValidateBinary(context, binary.data(), binary.size(),
+                               nullptr) == SPV_SUCCESS;
+    case Work::kLoad: {
+      std::unique_ptr<spvtools::opt::IRContext> ir_context =
+          spvtools::BuildModule(kStressEnv, IgnoreMessage, binary.data(),
+                                binary.size());
+      return ir_context && ir_context->get_def_use_mgr();
+    }
+    case Work::kOptimize: {
+      spvtools::Optimizer optimizer(kStressEnv);
+      optimizer.SetMessageConsumer(IgnoreMessage);
+      optimizer.RegisterPerformancePasses();
+      std::vector<uint32_t> optimized;
+      return optimizer.Run(binary.data(), binary.size(), &optimized);
+    }
+    case Work::kMergeReturn: {
+      spvtools::Optimizer optimizer(kStressEnv);
+      optimizer.SetMessageConsumer(IgnoreMessage);
+      optimizer.RegisterPass(spvtools::CreateMergeReturnPass());
+      std::vector<uint32_t> optimized;
+      return optimizer.Run(binary.data(), binary.size(), &optimized);
+    }
+  }
+  return false;
+}
+
+// Work which must scale linearly with the size of the modules along an axis.
+struct LinearWork {
+  Work work;
+  StressAxis axis;
+  // A size at which the work takes about a millisecond.
+  uint32_t base_size;
+};
+
+const LinearWork kLinearWork[] = {
+    {Work::kValidate, StressAxis::kBlocks, 4096},
+    {Work::kValidate, StressAxis::kStructWidth, 1024},
+    {Work::kValidate, StressAxis::kEntryPoints, 1024},
+    {Work::kLoad, StressAxis::kBlocks, 4096},
+    {Work::kLoad, StressAxis::kEntryPoints, 1024},
+    {Work::kMergeReturn, StressAxis::kReturns, 512},
+};
+
+// The factor by which the size grows in the checks of linear work, and the
+// largest factor by which the time may grow.
+const uint32_t kSizeGrowth = 8;
+const double kMaxTimeGrowth = 2.0 * kSizeGrowth;
+
+// Returns the seconds taken by the fastest of a few runs of |work| on the
+// stress module of |size| along |axis|, or a negative value on failure.
+double MeasureWork(Work work, StressAxis axis, uint32_t size) {
+  const std::vector<uint32_t> binary = GenerateStressModule(axis, size);
+  spv_context context = spvContextCreate(kStressEnv);
+  double best = -1.0;
+  for (int run = 0; run < 5; ++run) {
+    const auto start = std::chrono::steady_clock::now();
+    if (!DoWork(work, context, binary)) {
+      best = -1.0;
+      break;
+    }
+    const double seconds = std::chrono::duration<double>(
+                               std::chrono::steady_clock::now() - start)
+                               .count();
+    best = best < 0.0 ? seconds : std::min(best, seconds);
+  }
+  spvContextDestroy(context);
+  return best;
+}
+
+// Checks that the work of |kLinearWork| scales linearly.  Returns false and
+// reports the work which does not.
+bool CheckLinearWork() {
+  bool linear = true;
+  for (const LinearWork& check : kLinearWork) {
+    const uint32_t large_size = check.base_size * kSizeGrowth;
+    const double small = MeasureWork(check.work, check.axis, check.base_size);
+    const double large = MeasureWork(check.work, check.axis, large_size);
+    if (small < 0.0 || large < 0.0) {
+      fprintf(stderr, "error: %s failed on the %s stress module\n",
+              GetWorkName(check.work), GetStressAxisName(check.axis));
+      linear = false;
+      continue;
+    }
+    // Avoid dividing by a time too short to measure.
+    const double growth = large / std::max(small, 1e-6);
+    printf("%s/%s: %ux the size takes %.1fx the time\n",
+           GetWorkName(check.work), GetStressAxisName(check.axis),
+           kSizeGrowth, growth);
+    if (growth > kMaxTimeGrowth) {
+      fprintf(stderr,
+              "error: %s does not scale linearly with %s: %ux the size took "
+              "%.1fx the time\n",
+              GetWorkName(check.work), GetStressAxisName(check.axis),
+              kSizeGrowth, growth);
+      linear = false;
+    }
+  }
+  return linear;
+}
+
+void BM_Stress(benchmark::State& state, Work work, StressAxis axis) {
+  const std::vector<uint32_t> binary =
+      GenerateStressModule(axis, uint32_t(state.range(0)));
+  spv_context context = spvContextCreate(kStressEnv);
+  while (state.KeepRunning()) {
+    if (!DoWork(work, context, binary)) {
+      state.SkipWithError("the work failed on the stress module");
+      break;
+    }
+  }
+  spvContextDestroy(context);
+  state.SetComplexityN(state.range(0));
+}
+
+// Writes the stress module of |size_arg| along the axis |axis_arg| to |file|.
+// Returns the exit code.
+int WriteStressModule(const char* axis_arg, const char* size_arg,
+                      const char* file) {
+  StressAxis axis;
+  if (!spvtools::benchmarks::GetStressAxisFromName(axis_arg, &axis)) {
+    fprintf(stderr, "error: unknown axis %s\n", axis_arg);
+    return 1;
+  }
+  const std::vector<uint32_t> binary =
+      GenerateStressModule(axis, uint32_t(strtoul(size_arg, nullptr, 10)));
+  return WriteFile<uint32_t>(file, "wb", binary.data(), binary.size()) ? 0
+                                                                       : 1;
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+  if (argc == 5 && strcmp(argv[1], "--write") == 0) {
+    return WriteStressModule(argv[2], argv[3], argv[4]);
+  }
+  benchmark::Initialize(&argc, argv);
+  if (!CheckLinearWork()) return 1;
+
+  // The nesting of the constructs and the depth of the structures are bounded
+  // by the limits of the validator.
+  const struct {
+    StressAxis axis;
+    int64_t min_size;
+    int64_t max_size;
+  } axes[] = {
+      {StressAxis::kNesting, 16, 256},
+      {StressAxis::kBlocks, 1 << 8, 1 << 16},
+      {StressAxis::kStructDepth, 16, 250},
+      {StressAxis::kStructWidth, 1 << 6, 1 << 12},
+      {StressAxis::kEntryPoints, 1 << 6, 1 << 12},
+      {StressAxis::kReturns, 1 << 6, 1 << 12},
+  };
+  for (Work work :
+       {Work::kValidate, Work::kLoad, Work::kOptimize, Work::kMergeReturn}) {
+    for (const auto& axis : axes) {
+      benchmark::RegisterBenchmark(
+          (std::string(GetWorkName(work)) + "/" + GetStressAxisName(axis.axis))
+              .c_str(),
+          BM_Stress, work, axis.axis)
+          ->RangeMultiplier(4)
+          ->Range(axis.min_size, axis.max_size)
+          ->Complexity();
+    }
+  }
+
+  benchmark::RunSpecifiedBenchmarks();
+  return 0;
+}
@@ -0,0 +1,374 @@
+// Copyright (c) 2019 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "test/benchmarks/stress_modules.h"
+
+#include <cassert>
+#include <cstring>
+#include <memory>
+#include <string>
+#include <utility>
+
+#include "source/opt/build_module.h"
+#include "source/opt/ir_builder.h"
+#include "source/opt/ir_context.h"
+#include "source/util/string_utils.h"
+
+namespace spvtools {
+namespace benchmarks {
+namespace {
+
+using opt::BasicBlock;
+using opt::Function;
+using opt::Instruction;
+using opt::InstructionBuilder;
+using opt::IRContext;
+
+const struct {
+  StressAxis axis;
+  const char* name;
+} kAxisNames[] = {
+    {StressAxis::kNesting, "nesting"},
+    {StressAxis::kBlocks, "blocks"},
+    {StressAxis::kStructDepth, "struct_depth"},
+    {StressAxis::kStructWidth, "struct_width"},
+    {StressAxis::kEntryPoints, "entry_points"},
+    {StressAxis::kReturns, "returns"},
+};
+
+// Builds a fragment shader module reading the float |input_id| and writing
+// the float |output_id|.
+class StressModuleBuilder {
+ public:
+  StressModuleBuilder();
+
+  IRContext* context() const { return context_.get(); }
+  uint32_t float_type_id() const { return float_type_id_; }
+  uint32_t bool_type_id() const { return bool_type_id_; }
+  uint32_t input_id() const { return input_id_; }
+  uint32_t output_id() const { return output_id_; }
+
+  // Adds an entry point called |name|, and returns its function, which has
+  // no blocks yet.
+  Function* AddEntryPoint(const std::string& name);
+
+  // Appends a block of label |label_id| to |function|, and returns it.
+  BasicBlock* AddBlock(Function* function, uint32_t label_id);
+
+  // Returns the id of the 32-bit unsigned integer constant |value|.
+  uint32_t GetUIntConstant(uint32_t value);
+
+  // Returns the binary of the module.
+  std::vector<uint32_t> ToBinary() const;
+
+ private:
+  // Adds a float variable of |storage_class| at location 0, and returns its
+  // id.
+  uint32_t AddVariable(SpvStorageClass storage_class);
+
+  std::unique_ptr<IRContext> context_;
+  uint32_t void_type_id_;
+  uint32_t float_type_id_;
+  uint32_t bool_type_id_;
+  uint32_t function_type_id_;
+  uint32_t input_id_;
+  uint32_t output_id_;
+};
+
+StressModuleBuilder::StressModuleBuilder()
+    : context_(BuildModule(kStressEnv, nullptr,
+                           "OpCapability Shader\n"
+                           "OpMemoryModel Logical GLSL450\n")) {
+  opt::analysis::TypeManager* type_mgr = context_->get_type_mgr();
+  float_type_id_ = type_mgr->GetFloatTypeId();
+  bool_type_id_ = type_mgr->GetBoolTypeId();
+  opt::analysis::Void void_type;
+  const opt::analysis::Type* registered_void_type =
+      type_mgr->GetRegisteredType(&void_type);
+  void_type_id_ = type_mgr->GetTypeInstruction(registered_void_type);
+  opt::analysis::Function function_type(registered_void_type, {});
+  function_type_id_ = type_mgr->GetTypeInstruction(&function_type);
+  input_id_ = AddVariable(SpvStorageClassInput);
+  output_id_ = AddVariable(SpvStorageClassOutput);
+}
+
+uint32_t StressModuleBuilder::AddVariable(SpvStorageClass storage_class) {
+  const uint32_t pointer_type_id =
+      context_->get_type_mgr()->FindPointerToType(float_type_id_,
+                                                  storage_class);
+  const uint32_t id = context_->TakeNextId();
+  context_->AddGlobalValue(std::unique_ptr<Instruction>(
+      new (context()) Instruction(
+          context(), SpvOpVariable, pointer_type_id, id,
+          {{SPV_OPERAND_TYPE_STORAGE_CLASS, {uint32_t(storage_class)}}})));
+  context_->get_decoration_mgr()->AddDecorationVal(id, SpvDecorationLocation,
+                                                   0);
+  return id;
+}
+
+Function* StressModuleBuilder::AddEntryPoint(const std::string& name) {
+  const uint32_t function_id = context_->TakeNextId();
+  std::unique_ptr<Function> function(
+      new Function(std::unique_ptr<Instruction>(new (context()) Instruction(
+          context(), SpvOpFunction, void_type_id_, function_id,
+          {{SPV_OPERAND_TYPE_FUNCTION_CONTROL, {SpvFunctionControlMaskNone}},
+           {SPV_OPERAND_TYPE_ID, {function_type_id_}}}))));
+  function->SetFunctionEnd(std::unique_ptr<Instruction>(
+      new (context()) Instruction(context(), SpvOpFunctionEnd, 0, 0, {})));
+  Function* result = function.get();
+  context_->AddFunction(std::move(function));
+
+  context_->AddEntryPoint(std::unique_ptr<Instruction>(
+      new (context()) Instruction(
+          context(), SpvOpEntryPoint, 0, 0,
+          {{SPV_OPERAND_TYPE_EXECUTION_MODEL, {SpvExecutionModelFragment}},
+           {SPV_OPERAND_TYPE_ID, {function_id}},
+           {SPV_OPERAND_TYPE_LITERAL_STRING, utils::MakeVector(name)},
+           {SPV_OPERAND_TYPE_ID, {input_id_}},
+           {SPV_OPERAND_TYPE_ID, {output_id_}}})));
+  context_->AddExecutionMode(std::unique_ptr<Instruction>(
+      new (context()) Instruction(
+          context(), SpvOpExecutionMode, 0, 0,
+          {{SPV_OPERAND_TYPE_ID, {function_id}},
+           {SPV_OPERAND_TYPE_EXECUTION_MODE,
+            {SpvExecutionModeOriginUpperLeft}}})));
+  return result;
+}
+
+BasicBlock* StressModuleBuilder::AddBlock(Function* function,
+                                          uint32_t label_id) {
+  std::unique_ptr<Instruction> label(
+      new (context()) Instruction(context(), SpvOpLabel, 0, label_id, {}));
+  std::unique_ptr<BasicBlock> block(new BasicBlock(std::move(label)));
+  block->SetParent(function);
+  BasicBlock* result = block.get();
+  function->AddBasicBlock(std::move(block));
+  return result;
+}
+
+uint32_t StressModuleBuilder::GetUIntConstant(uint32_t value) {
+  opt::analysis::ConstantManager* const_mgr = context_->get_constant_mgr();
+  const opt::analysis::Constant* constant = const_mgr->GetConstant(
+      context_->get_type_mgr()->GetUIntType(), std::vector<uint32_t>{value});
+  return const_mgr->GetDefiningInstruction(constant)->result_id();
+}
+
+std::vector<uint32_t> StressModuleBuilder::ToBinary() const {
+  std::vector<uint32_t> binary;
+  context_->module()->ToBinary(&binary, /* skip_nop = */ true);
+  return binary;
+}
+
+// Returns a vector of |count| new ids of |context|.
+std::vector<uint32_t> TakeIds(IRContext* context, uint32_t count) {
+  std::vector<uint32_t> ids(count);
+  for (uint32_t& id : ids) id = context->TakeNextId();
+  return ids;
+}
+
+std::vector<uint32_t> GenerateNesting(uint32_t depth) {
+  StressModuleBuilder builder;
+  IRContext* context = builder.context();
+  Function* function = builder.AddEntryPoint("main");
+  const std::vector<uint32_t> headers = TakeIds(context, depth + 1);
+  const std::vector<uint32_t> merges = TakeIds(context, depth);
+
+  InstructionBuilder entry(context,
+                           builder.AddBlock(function, context->TakeNextId()));
+  const uint32_t value =
+      entry.AddLoad(builder.float_type_id(), builder.input_id())->result_id();
+  const uint32_t condition =
+      entry
+          .AddBinaryOp(builder.bool_type_id(), SpvOpFOrdLessThan, value,
+                       context->get_constant_mgr()->GetFloatConst(0.5f))
+          ->result_id();
+  entry.AddBranch(headers[0]);
+
+  for (uint32_t i = 0; i < depth; ++i) {
+    InstructionBuilder header(context, builder.AddBlock(function, headers[i]));
+    header.AddConditionalBranch(condition, headers[i + 1], merges[i],
+                                merges[i]);
+  }
+  InstructionBuilder innermost(context,
+                               builder.AddBlock(function, headers[depth]));
+  innermost.AddStore(builder.output_id(), value);
+  if (depth == 0) {
+    innermost.AddNullaryOp(0, SpvOpReturn);
+    return builder.ToBinary();
+  }
+  innermost.AddBranch(merges[depth - 1]);
+  for (uint32_t i = depth - 1; i > 0; --i) {
+    InstructionBuilder merge(context, builder.AddBlock(function, merges[i]));
+    merge.AddBranch(merges[i - 1]);
+  }
+  InstructionBuilder outermost(context, builder.AddBlock(function, merges[0]));
+  outermost.AddNullaryOp(0, SpvOpReturn);
+  return builder.ToBinary();
+}
+
+// Returns the module of kBlocks, or of kReturns if |early_returns| is true.
+std::vector<uint32_t> GenerateBlocks(uint32_t count, bool early_returns) {
+  StressModuleBuilder builder;
+  IRContext* context = builder.context();
+  Function* function = builder.AddEntryPoint("main");
+  const std::vector<uint32_t> headers = TakeIds(context, count + 1);
+
+  InstructionBuilder entry(context,
+                           builder.AddBlock(function, context->TakeNextId()));
+  const uint32_t value =
+      entry.AddLoad(builder.float_type_id(), builder.input_id())->result_id();
+  const uint32_t condition =
+      entry
+          .AddBinaryOp(builder.bool_type_id(), SpvOpFOrdLessThan, value,
+                       context->get_constant_mgr()->GetFloatConst(0.5f))
+          ->result_id();
+  entry.AddBranch(headers[0]);
+
+  const uint32_t one = context->get_constant_mgr()->GetFloatConst(1.0f);
+  for (uint32_t i = 0; i < count; ++i) {
+    const uint32_t then_id = context->TakeNextId();
+    InstructionBuilder header(context, builder.AddBlock(function, headers[i]));
+    header.AddConditionalBranch(condition, then_id, headers[i + 1],
+                                headers[i + 1]);
+    InstructionBuilder then_block(context,
+                                  builder.AddBlock(function, then_id));
+    const uint32_t sum =
+        then_block
+            .AddBinaryOp(builder.float_type_id(), SpvOpFAdd, value, one)
+            ->result_id();
+    then_block.AddStore(builder.output_id(), sum);
+    if (early_returns) {
+      then_block.AddNullaryOp(0, SpvOpReturn);
+    } else {
+      then_block.AddBranch(headers[i + 1]);
+    }
+  }
+  InstructionBuilder last(context, builder.AddBlock(function, headers[count]));
+  last.AddNullaryOp(0, SpvOpReturn);
+  return builder.ToBinary();
+}
+
+std::vector<uint32_t> GenerateStruct(uint32_t levels, uint32_t width) {
+  assert(levels > 0 && (width > 1 || (width == 1 && levels == 1)));
+  StressModuleBuilder builder;
+  IRContext* context = builder.context();
+  opt::analysis::TypeManager* type_mgr = context->get_type_mgr();
+
+  // Build the levels from the innermost one.
+  const opt::analysis::Type* float_type = type_mgr->GetFloatType();
+  const opt::analysis::Type* level = nullptr;
+  for (uint32_t i = 0; i < levels; ++i) {
+    std::vector<const opt::analysis::Type*> members(width, float_type);
+    if (level) members.back() = level;
+    opt::analysis::Struct struct_type(members);
+    level = type_mgr->GetType(type_mgr->GetTypeInstruction(&struct_type));
+  }
+  const uint32_t variable_type_id = type_mgr->FindPointerToType(
+      type_mgr->GetId(level), SpvStorageClassFunction);
+  const uint32_t float_pointer_type_id = type_mgr->FindPointerToType(
+      builder.float_type_id(), SpvStorageClassFunction);
+
+  Function* function = builder.AddEntryPoint("main");
+  InstructionBuilder entry(context,
+                           builder.AddBlock(function, context->TakeNextId()));
+  const uint32_t variable = context->TakeNextId();
+  entry.AddInstruction(std::unique_ptr<Instruction>(new (context) Instruction(
+      context, SpvOpVariable, variable_type_id, variable,
+      {{SPV_OPERAND_TYPE_STORAGE_CLASS, {SpvStorageClassFunction}}})));
+  const uint32_t value =
+      entry.AddLoad(builder.float_type_id(), builder.input_id())->result_id();
+
+  for (uint32_t i = 0; i < width; ++i) {
+    // Store to the float member |i|, or to the first float of the innermost
+    // level through the last member.
+    std::vector<uint32_t> indices(1, builder.GetUIntConstant(i));
+    if (i == width - 1 && levels > 1) {
+      indices.resize(levels - 1, indices[0]);
+      indices.push_back(builder.GetUIntConstant(0));
+    }
+    const uint32_t pointer =
+        entry.AddAccessChain(float_pointer_type_id, variable, indices)
+            ->result_id();
+    entry.AddStore(pointer, value);
+  }
+  const uint32_t first = entry
+                             .AddAccessChain(float_pointer_type_id, variable,
+                                             {builder.GetUIntConstant(0)})
+                             ->result_id();
+  entry.AddStore(builder.output_id(),
+                 entry.AddLoad(builder.float_type_id(), first)->result_id());
+  entry.AddNullaryOp(0, SpvOpReturn);
+  return builder.ToBinary();
+}
+
+std::vector<uint32_t> GenerateEntryPoints(uint32_t count) {
+  StressModuleBuilder builder;
+  IRContext* context = builder.context();
+  for (uint32_t i = 0; i < count; ++i) {
+    Function* function = builder.AddEntryPoint("main" + std::to_string(i));
+    InstructionBuilder entry(context,
+                             builder.AddBlock(function, context->TakeNextId()));
+    const uint32_t value =
+        entry.AddLoad(builder.float_type_id(), builder.input_id())
+            ->result_id();
+    const uint32_t scaled =
+        entry
+            .AddBinaryOp(builder.float_type_id(), SpvOpFMul, value,
+                         context->get_constant_mgr()->GetFloatConst(float(i)))
+            ->result_id();
+    entry.AddStore(builder.output_id(), scaled);
+    entry.AddNullaryOp(0, SpvOpReturn);
+  }
+  return builder.ToBinary();
+}
+
+}  // namespace
+
+const char* GetStressAxisName(StressAxis axis) {
+  for (const auto& entry : kAxisNames) {
+    if (entry.axis == axis) return entry.name;
+  }
+  return "unknown";
+}
+
+bool GetStressAxisFromName(const char* name, StressAxis* axis) {
+  for (const auto& entry : kAxisNames) {
+    if (strcmp(entry.name, name) == 0) {
+      *axis = entry.axis;
+      return true;
+    }
+  }
+  return false;
+}
+
+std::vector<uint32_t> GenerateStressModule(StressAxis axis, uint32_t size) {
+  switch (axis) {
+    case StressAxis::kNesting:
+      return GenerateNesting(size);
+    case StressAxis::kBlocks:
+      return GenerateBlocks(size, false);
+    case StressAxis::kStructDepth:
+      return GenerateStruct(size, kStressStructWidth);
+    case StressAxis::kStructWidth:
+      return GenerateStruct(4, size);
+    case StressAxis::kEntryPoints:
+      return GenerateEntryPoints(size);
+    case StressAxis::kReturns:
+      return GenerateBlocks(size, true);
+  }
+  return {};
+}
+
+}  // namespace benchmarks
+}  // namespace spvtools
@@ -0,0 +1,68 @@
+// Copyright (c) 2019 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef TEST_BENCHMARKS_STRESS_MODULES_H_
+#define TEST_BENCHMARKS_STRESS_MODULES_H_
+
+#include <cstdint>
+#include <vector>
+
+#include "spirv-tools/libspirv.h"
+
+namespace spvtools {
+namespace benchmarks {
+
+// The target environment of the stress modules.
+const spv_target_env kStressEnv = SPV_ENV_UNIVERSAL_1_3;
+
+// The axes along which the stress modules grow.  Each module is a valid
+// fragment shader, which reads a float input and writes a float output so
+// that its code is live.
+enum class StressAxis {
+  // A single function of |size| selection constructs nested in one another.
+  kNesting,
+  // A single function of |size| selection constructs in sequence, which has
+  // 2 * |size| + 2 blocks.
+  kBlocks,
+  // A local variable of a structure of |size| levels of nested structures.
+  // Each level has |kStressStructWidth| members: floats, and the next level
+  // as the last member.  A float is stored through each member of the outer
+  // level.
+  kStructDepth,
+  // As kStructDepth, with 4 levels of |size| members each.
+  kStructWidth,
+  // |size| entry points, each with its own function.
+  kEntryPoints,
+  // As kBlocks, with a return at the end of each selection, as left by
+  // inlining functions with early returns.
+  kReturns,
+};
+
+// The number of members of each level of the structures of kStructDepth.
+const uint32_t kStressStructWidth = 8;
+
+// Returns the name of |axis|, such as "blocks".
+const char* GetStressAxisName(StressAxis axis);
+
+// Sets |axis| to the axis called |name|.  Returns false if there is none.
+bool GetStressAxisFromName(const char* name, StressAxis* axis);
+
+// Returns the binary of the stress module of |size| along |axis|.  It is
+// built with the IRContext and InstructionBuilder of the optimizer.
+std::vector<uint32_t> GenerateStressModule(StressAxis axis, uint32_t size);
+
+}  // namespace benchmarks
+}  // namespace spvtools
+
+#endif  // TEST_BENCHMARKS_STRESS_MODULES_H_
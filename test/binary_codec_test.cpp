@@ -0,0 +1,135 @@
+// Copyright (c) 2020 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "gmock/gmock.h"
+#include "spirv-tools/libspirv.hpp"
+#include "test/unit_spirv.h"
+
+namespace spvtools {
+namespace {
+
+const char kModule[] = R"(
+OpCapability Shader
+OpCapability Float64
+%ext = OpExtInstImport "GLSL.std.450"
+OpMemoryModel Logical GLSL450
+OpEntryPoint Fragment %main "main" %color
+OpExecutionMode %main OriginUpperLeft
+OpName %main "a name long enough to take several words"
+OpDecorate %color Location 0
+OpDecorate %x SpecId 3
+%void = OpTypeVoid
+%fn = OpTypeFunction %void
+%int = OpTypeInt 32 1
+%float = OpTypeFloat 32
+%double = OpTypeFloat 64
+%ptr = OpTypePointer Output %float
+%color = OpVariable %ptr Output
+%int_1 = OpConstant %int 1
+%float_2 = OpConstant %float 2
+%double_pi = OpConstant %double 3.14159265358979
+%x = OpSpecConstant %int 7
+%y = OpSpecConstantOp %int IAdd %x %int_1
+%main = OpFunction %void None %fn
+%entry = OpLabel
+%abs = OpExtInst %float %ext FAbs %float_2
+OpStore %color %abs Aligned 4
+OpSelectionMerge %merge None
+OpSwitch %y %merge 1 %one 2 %merge
+%one = OpLabel
+OpBranch %merge
+%merge = OpLabel
+OpReturn
+OpFunctionEnd
+)";
+
+TEST(BinaryCodec, RoundTripsModule) {
+  SpirvTools tools(SPV_ENV_UNIVERSAL_1_3);
+  std::vector<uint32_t> binary;
+  ASSERT_TRUE(tools.Assemble(kModule, &binary));
+
+  std::vector<uint8_t> encoded;
+  ASSERT_TRUE(tools.Encode(binary, &encoded));
+  EXPECT_LT(encoded.size() * 2, binary.size() * sizeof(uint32_t));
+
+  std::vector<uint32_t> decoded;
+  ASSERT_TRUE(tools.Decode(encoded, &decoded));
+  EXPECT_EQ(decoded, binary);
+}
+
+TEST(BinaryCodec, EncodingDoesNotDependOnTheEnvironment) {
+  SpirvTools tools(SPV_ENV_UNIVERSAL_1_3);
+  std::vector<uint32_t> binary;
+  ASSERT_TRUE(tools.Assemble(kModule, &binary));
+  std::vector<uint8_t> encoded;
+  ASSERT_TRUE(tools.Encode(binary, &encoded));
+
+  SpirvTools other_tools(SPV_ENV_VULKAN_1_0);
+  std::vector<uint32_t> decoded;
+  ASSERT_TRUE(other_tools.Decode(encoded, &decoded));
+  EXPECT_EQ(decoded, binary);
+}
+
+TEST(BinaryCodec, RoundTripsWordsTheGrammarDoesNotPredict) {
+  // An unknown opcode, an OpNop with operands, and an OpName whose string
+  // is not terminated.
+  const std::vector<uint32_t> binary = {
+      SpvMagicNumber, 0x00010300, 0, 100, 0,
+      3u << 16 | 0xfffe, 0xdeadbeef, 0,
+      4u << 16 | SpvOpNop, 1, 0xffffffff, 2,
+      3u << 16 | SpvOpName, 5, 0x41414141};
+
+  SpirvTools tools(SPV_ENV_UNIVERSAL_1_3);
+  std::vector<uint8_t> encoded;
+  ASSERT_TRUE(tools.Encode(binary, &encoded));
+  std::vector<uint32_t> decoded;
+  ASSERT_TRUE(tools.Decode(encoded, &decoded));
+  EXPECT_EQ(decoded, binary);
+}
+
+TEST(BinaryCodec, RejectsInvalidWordCount) {
+  const std::vector<uint32_t> binary = {SpvMagicNumber, 0x00010300, 0, 100, 0,
+                                        5u << 16 | SpvOpNop, 1};
+
+  SpirvTools tools(SPV_ENV_UNIVERSAL_1_3);
+  std::vector<uint8_t> encoded;
+  EXPECT_FALSE(tools.Encode(binary, &encoded));
+  EXPECT_TRUE(encoded.empty());
+}
+
+TEST(BinaryCodec, RejectsTruncatedEncoding) {
+  SpirvTools tools(SPV_ENV_UNIVERSAL_1_3);
+  std::vector<uint32_t> binary;
+  ASSERT_TRUE(tools.Assemble(kModule, &binary));
+  std::vector<uint8_t> encoded;
+  ASSERT_TRUE(tools.Encode(binary, &encoded));
+
+  std::vector<uint32_t> decoded;
+  encoded.pop_back();
+  EXPECT_FALSE(tools.Decode(encoded, &decoded));
+  EXPECT_TRUE(decoded.empty());
+
+  // A plain SPIR-V binary is not mistaken for an encoded one.
+  const uint8_t* bytes = reinterpret_cast<const uint8_t*>(binary.data());
+  const std::vector<uint8_t> plain(bytes,
+                                   bytes + binary.size() * sizeof(uint32_t));
+  EXPECT_FALSE(tools.Decode(plain, &decoded));
+}
+
+}  // namespace
+}  // namespace spvtools
@@ -0,0 +1,237 @@
+// Copyright (c) 2020 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "gmock/gmock.h"
+#include "spirv-tools/libspirv.hpp"
+#include "test/unit_spirv.h"
+
+namespace spvtools {
+namespace {
+
+using ::testing::HasSubstr;
+
+const char kModule[] = R"(
+OpCapability Shader
+OpMemoryModel Logical GLSL450
+OpEntryPoint Fragment %main "main"
+OpExecutionMode %main OriginUpperLeft
+OpName %main "main"
+OpName %helper "helper"
+%void = OpTypeVoid
+%fn = OpTypeFunction %void
+%int = OpTypeInt 32 1
+%int_1 = OpConstant %int 1
+%int_2 = OpConstant %int 2
+%helper = OpFunction %void None %fn
+%helper_entry = OpLabel
+OpReturn
+OpFunctionEnd
+%main = OpFunction %void None %fn
+%entry = OpLabel
+%sum = OpIAdd %int %int_1 %int_2
+OpSelectionMerge %merge None
+OpSwitch %sum %merge 1 %one 2 %merge
+%one = OpLabel
+%call = OpFunctionCall %void %helper
+OpBranch %merge
+%merge = OpLabel
+OpReturn
+OpFunctionEnd
+)";
+
+class BinaryIndexTest : public ::testing::Test {
+ protected:
+  BinaryIndexTest() : context_(spvContextCreate(SPV_ENV_UNIVERSAL_1_3)) {}
+
+  ~BinaryIndexTest() override {
+    spvBinaryIndexDestroy(index_);
+    spvContextDestroy(context_);
+  }
+
+  void SetUp() override {
+    SpirvTools tools(SPV_ENV_UNIVERSAL_1_3);
+    ASSERT_TRUE(tools.Assemble(kModule, &binary_));
+    ASSERT_EQ(SPV_SUCCESS,
+              spvBinaryIndexBuild(context_, binary_.data(), binary_.size(),
+                                  &index_, nullptr));
+  }
+
+  // Returns the disassembly of the words from |begin| to |end|.
+  std::string DisassembleRange(size_t begin, size_t end) {
+    spv_text text = nullptr;
+    std::string result;
+    EXPECT_EQ(SPV_SUCCESS,
+              spvBinaryToTextRange(context_, binary_.data(), binary_.size(),
+                                   index_, begin, end,
+                                   SPV_BINARY_TO_TEXT_OPTION_FRIENDLY_NAMES,
+                                   &text, nullptr));
+    if (text) result.assign(text->str, text->length);
+    spvTextDestroy(text);
+    return result;
+  }
+
+  // Returns the disassembly of the whole module, without its header.
+  std::string Disassemble() {
+    std::string text;
+    SpirvTools tools(SPV_ENV_UNIVERSAL_1_3);
+    const uint32_t options = SPV_BINARY_TO_TEXT_OPTION_NO_HEADER |
+                             SPV_BINARY_TO_TEXT_OPTION_FRIENDLY_NAMES;
+    EXPECT_TRUE(tools.Disassemble(binary_, &text, options));
+    return text;
+  }
+
+  spv_context context_;
+  std::vector<uint32_t> binary_;
+  spv_binary_index index_ = nullptr;
+};
+
+TEST_F(BinaryIndexTest, FindsFunctionsAndBlocks) {
+  ASSERT_EQ(2u, spvBinaryIndexFunctionCount(index_));
+  EXPECT_EQ(1u, spvBinaryIndexBlockCount(index_, 0));
+  EXPECT_EQ(3u, spvBinaryIndexBlockCount(index_, 1));
+  EXPECT_EQ(0u, spvBinaryIndexBlockCount(index_, 2));
+
+  spv_binary_range_t globals;
+  ASSERT_EQ(SPV_SUCCESS, spvBinaryIndexGetGlobalSection(index_, &globals));
+  spv_binary_range_t helper;
+  ASSERT_EQ(SPV_SUCCESS, spvBinaryIndexGetFunction(index_, 0, &helper));
+  spv_binary_range_t main;
+  ASSERT_EQ(SPV_SUCCESS, spvBinaryIndexGetFunction(index_, 1, &main));
+  EXPECT_EQ(globals.end, helper.begin);
+  EXPECT_EQ(helper.end, main.begin);
+  EXPECT_EQ(binary_.size(), main.end);
+  EXPECT_EQ(SpvOpFunction, SpvOp(binary_[main.begin] & 0xffff));
+  EXPECT_EQ(main.id, binary_[main.begin + 2]);
+
+  spv_binary_range_t block;
+  ASSERT_EQ(SPV_SUCCESS, spvBinaryIndexGetBlock(index_, 1, 2, &block));
+  EXPECT_EQ(SpvOpLabel, SpvOp(binary_[block.begin] & 0xffff));
+  EXPECT_EQ(block.id, binary_[block.begin + 1]);
+  EXPECT_EQ(SpvOpFunctionEnd, SpvOp(binary_[block.end] & 0xffff));
+  EXPECT_EQ(SPV_ERROR_INVALID_LOOKUP,
+            spvBinaryIndexGetBlock(index_, 1, 3, &block));
+}
+
+TEST_F(BinaryIndexTest, DisassemblesPartsOfTheModule) {
+  const std::string whole = Disassemble();
+
+  spv_binary_range_t main;
+  ASSERT_EQ(SPV_SUCCESS, spvBinaryIndexGetFunction(index_, 1, &main));
+  const std::string function = DisassembleRange(main.begin, main.end);
+  EXPECT_THAT(function, HasSubstr("%main = OpFunction %void None %fn"));
+  EXPECT_THAT(function, HasSubstr("OpFunctionCall %void %helper"));
+  EXPECT_THAT(whole, HasSubstr(function));
+
+  // The literals of the OpSwitch are decoded with the type of its selector.
+  spv_binary_range_t block;
+  ASSERT_EQ(SPV_SUCCESS, spvBinaryIndexGetBlock(index_, 1, 0, &block));
+  const std::string entry = DisassembleRange(block.begin, block.end);
+  EXPECT_THAT(entry, HasSubstr("OpSwitch %sum %merge 1 %one 2 %merge"));
+  EXPECT_THAT(whole, HasSubstr(entry));
+
+  spv_binary_range_t globals;
+  ASSERT_EQ(SPV_SUCCESS, spvBinaryIndexGetGlobalSection(index_, &globals));
+  EXPECT_EQ(0u, whole.find(DisassembleRange(globals.begin, globals.end)));
+}
+
+TEST_F(BinaryIndexTest, RejectsRangesNotOnInstructions) {
+  spv_binary_range_t main;
+  ASSERT_EQ(SPV_SUCCESS, spvBinaryIndexGetFunction(index_, 1, &main));
+  spv_text text = nullptr;
+  EXPECT_EQ(SPV_ERROR_INVALID_BINARY,
+            spvBinaryToTextRange(context_, binary_.data(), binary_.size(),
+                                 index_, main.begin + 1, main.end, 0, &text,
+                                 nullptr));
+  EXPECT_EQ(SPV_ERROR_INVALID_BINARY,
+            spvBinaryToTextRange(context_, binary_.data(), binary_.size(),
+                                 index_, main.begin, main.end - 1, 0, &text,
+                                 nullptr));
+  EXPECT_EQ(nullptr, text);
+}
+
+TEST_F(BinaryIndexTest, FindsInstructions) {
+  size_t offset = SPV_INDEX_INSTRUCTION;
+  for (size_t i = 0; i < spvBinaryIndexInstructionCount(index_); ++i) {
+    size_t found = 0;
+    ASSERT_EQ(SPV_SUCCESS, spvBinaryIndexFindInstruction(
+                               index_, binary_.data(), i, &found));
+    EXPECT_EQ(offset, found);
+    offset += binary_[offset] >> 16;
+  }
+  EXPECT_EQ(binary_.size(), offset);
+}
+
+TEST_F(BinaryIndexTest, SavedIndexIsOnlyLoadedForItsBinary) {
+  spv_binary saved = nullptr;
+  ASSERT_EQ(SPV_SUCCESS, spvBinaryIndexSave(index_, &saved));
+
+  spv_binary_index loaded = nullptr;
+  ASSERT_EQ(SPV_SUCCESS,
+            spvBinaryIndexLoad(context_, saved->code, saved->wordCount,
+                               binary_.data(), binary_.size(), &loaded,
+                               nullptr));
+  spv_binary_range_t expected;
+  spv_binary_range_t actual;
+  ASSERT_EQ(SPV_SUCCESS, spvBinaryIndexGetBlock(index_, 1, 1, &expected));
+  ASSERT_EQ(SPV_SUCCESS, spvBinaryIndexGetBlock(loaded, 1, 1, &actual));
+  EXPECT_EQ(expected.id, actual.id);
+  EXPECT_EQ(expected.begin, actual.begin);
+  EXPECT_EQ(expected.end, actual.end);
+  spvBinaryIndexDestroy(loaded);
+
+  // Changing the value of a constant changes the global section.
+  std::vector<uint32_t> changed = binary_;
+  spv_binary_range_t globals;
+  ASSERT_EQ(SPV_SUCCESS, spvBinaryIndexGetGlobalSection(index_, &globals));
+  changed[globals.end - 1] = 3;
+  loaded = nullptr;
+  spv_diagnostic diagnostic = nullptr;
+  EXPECT_EQ(SPV_ERROR_INVALID_BINARY,
+            spvBinaryIndexLoad(context_, saved->code, saved->wordCount,
+                               changed.data(), changed.size(), &loaded,
+                               &diagnostic));
+  EXPECT_EQ(nullptr, loaded);
+  ASSERT_NE(nullptr, diagnostic);
+  EXPECT_THAT(diagnostic->error, HasSubstr("another binary"));
+  spvDiagnosticDestroy(diagnostic);
+
+  // A truncated index is rejected.
+  EXPECT_EQ(SPV_ERROR_INVALID_BINARY,
+            spvBinaryIndexLoad(context_, saved->code, saved->wordCount - 1,
+                               binary_.data(), binary_.size(), &loaded,
+                               nullptr));
+  spvBinaryDestroy(saved);
+}
+
+TEST(BinaryIndex, RejectsUnterminatedFunction) {
+  SpirvTools tools(SPV_ENV_UNIVERSAL_1_3);
+  std::vector<uint32_t> binary;
+  ASSERT_TRUE(tools.Assemble(kModule, &binary));
+  binary.pop_back();
+
+  spv_context context = spvContextCreate(SPV_ENV_UNIVERSAL_1_3);
+  spv_binary_index index = nullptr;
+  EXPECT_EQ(SPV_ERROR_INVALID_BINARY,
+            spvBinaryIndexBuild(context, binary.data(), binary.size(), &index,
+                                nullptr));
+  EXPECT_EQ(nullptr, index);
+  spvContextDestroy(context);
+}
+
+}  // namespace
+}  // namespace spvtools
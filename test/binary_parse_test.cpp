@@ -542,6 +542,436 @@ TEST_F(BinaryParseTest, ExtendedInstruction) {
   EXPECT_EQ(nullptr, diagnostic_);
 }
 
+// Records the instruction views issued by spvBinaryParseView, decoding each
+// of them if requested.
+struct ViewClient {
+  bool decode = false;
+  std::vector<spv_instruction_view_t> views;
+  std::vector<ParsedInstruction> decoded;
+};
+
+spv_result_t invoke_view(void* user_data,
+                         const spv_instruction_view_t* instruction_view) {
+  auto* client = static_cast<ViewClient*>(user_data);
+  client->views.push_back(*instruction_view);
+  if (client->decode) {
+    spv_parsed_instruction_t inst;
+    if (auto error = spvInstructionViewDecode(instruction_view, &inst))
+      return error;
+    client->decoded.push_back(ParsedInstruction(inst));
+  }
+  return SPV_SUCCESS;
+}
+
+TEST_F(BinaryParseTest, ViewPointsIntoOriginalWords) {
+  const auto words = CompileSuccessfully(
+      "%1 = OpTypeVoid "
+      "%2 = OpTypeInt 32 1");
+  ViewClient client;
+  EXPECT_EQ(SPV_SUCCESS,
+            spvBinaryParseView(ScopedContext().context, &client, words.data(),
+                               words.size(), nullptr, invoke_view,
+                               &diagnostic_));
+  EXPECT_EQ(nullptr, diagnostic_);
+  ASSERT_EQ(2u, client.views.size());
+  EXPECT_EQ(words.data() + SPV_INDEX_INSTRUCTION, client.views[0].words);
+  EXPECT_EQ(SpvOpTypeVoid, client.views[0].opcode);
+  EXPECT_EQ(2u, client.views[0].num_words);
+  EXPECT_EQ(0u, client.views[0].type_id);
+  EXPECT_EQ(1u, client.views[0].result_id);
+  EXPECT_EQ(words.data() + SPV_INDEX_INSTRUCTION + 2, client.views[1].words);
+  EXPECT_EQ(SpvOpTypeInt, client.views[1].opcode);
+  EXPECT_EQ(4u, client.views[1].num_words);
+  EXPECT_EQ(2u, client.views[1].result_id);
+  EXPECT_EQ(SPV_INDEX_INSTRUCTION + 2, client.views[1].offset);
+}
+
+TEST_F(BinaryParseTest, ViewDecodesIdsForBothEndians) {
+  for (bool endian_swap : kSwapEndians) {
+    SpirvVector words = CompileSuccessfully(
+        "%extcl = OpExtInstImport \"OpenCL.std\" "
+        "%result = OpExtInst %float %extcl sqrt %x");
+    if (endian_swap) {
+      std::transform(words.begin(), words.end(), words.begin(),
+                     [](const uint32_t raw_word) {
+                       return spvFixWord(raw_word,
+                                         I32_ENDIAN_HOST == I32_ENDIAN_BIG
+                                             ? SPV_ENDIANNESS_LITTLE
+                                             : SPV_ENDIANNESS_BIG);
+                     });
+    }
+    ViewClient client;
+    EXPECT_EQ(SPV_SUCCESS, spvBinaryParseView(ScopedContext().context, &client,
+                                              words.data(), words.size(),
+                                              nullptr, invoke_view, nullptr));
+    ASSERT_EQ(2u, client.views.size());
+    EXPECT_EQ(SpvOpExtInst, client.views[1].opcode);
+    EXPECT_EQ(SPV_EXT_INST_TYPE_OPENCL_STD, client.views[1].ext_inst_type);
+    EXPECT_EQ(2u, client.views[1].type_id);
+    EXPECT_EQ(3u, client.views[1].result_id);
+  }
+}
+
+TEST_F(BinaryParseTest, ViewDecodeMatchesFullParse) {
+  const auto words = CompileSuccessfully(
+      "%extcl = OpExtInstImport \"OpenCL.std\" "
+      "%result = OpExtInst %float %extcl sqrt %x");
+  EXPECT_HEADER(5).WillOnce(Return(SPV_SUCCESS));
+  std::vector<ParsedInstruction> expected;
+  EXPECT_CALL(client_, Instruction(_))
+      .Times(2)
+      .WillRepeatedly(
+          ::testing::Invoke([&expected](const ParsedInstruction& inst) {
+            expected.push_back(inst);
+            return SPV_SUCCESS;
+          }));
+  Parse(words, SPV_SUCCESS, false);
+
+  ViewClient client;
+  client.decode = true;
+  EXPECT_EQ(SPV_SUCCESS,
+            spvBinaryParseView(ScopedContext().context, &client, words.data(),
+                               words.size(), nullptr, invoke_view,
+                               &diagnostic_));
+  EXPECT_EQ(nullptr, diagnostic_);
+  EXPECT_THAT(client.decoded, Eq(expected));
+}
+
+TEST_F(BinaryParseTest, ViewDiagnosesTruncatedInstruction) {
+  auto words = CompileSuccessfully("%1 = OpTypeInt 32 1");
+  words.pop_back();
+  ViewClient client;
+  EXPECT_EQ(SPV_ERROR_INVALID_BINARY,
+            spvBinaryParseView(ScopedContext().context, &client, words.data(),
+                               words.size(), nullptr, invoke_view,
+                               &diagnostic_));
+  ASSERT_NE(nullptr, diagnostic_);
+  EXPECT_THAT(diagnostic_->error,
+              Eq("End of input reached while decoding OpTypeInt starting at "
+                 "word 5: stated word count is 4, but only 3 words remain."));
+  EXPECT_TRUE(client.views.empty());
+}
+
+TEST_F(BinaryParseTest, ViewDiagnosesMissingOperands) {
+  const auto words = Concatenate(
+      {ExpectedHeaderForBound(2), MakeInstruction(SpvOpTypeInt, {1, 32})});
+  EXPECT_EQ(SPV_ERROR_INVALID_BINARY,
+            spvBinaryParseView(ScopedContext().context, nullptr, words.data(),
+                               words.size(), nullptr, invoke_view,
+                               &diagnostic_));
+  ASSERT_NE(nullptr, diagnostic_);
+  EXPECT_THAT(diagnostic_->error,
+              Eq("End of input reached while decoding OpTypeInt starting at "
+                 "word 5: expected more operands after 3 words."));
+}
+
+// Collects the instructions issued by spvBinaryParse and
+// spvBinaryParseParallel.
+spv_result_t collect_instruction(
+    void* user_data, const spv_parsed_instruction_t* parsed_instruction) {
+  static_cast<std::vector<ParsedInstruction>*>(user_data)->push_back(
+      ParsedInstruction(*parsed_instruction));
+  return SPV_SUCCESS;
+}
+
+const char* kModuleWithFunctions = R"(
+               OpCapability Shader
+               OpMemoryModel Logical GLSL450
+       %void = OpTypeVoid
+       %uint = OpTypeInt 32 0
+     %uint_1 = OpConstant %uint 1
+         %fn = OpTypeFunction %void
+          %1 = OpFunction %void None %fn
+          %2 = OpLabel
+               OpSelectionMerge %3 None
+               OpSwitch %uint_1 %3 0 %4 1 %3
+          %4 = OpLabel
+               OpBranch %3
+          %3 = OpLabel
+               OpReturn
+               OpFunctionEnd
+          %5 = OpFunction %void None %fn
+          %6 = OpLabel
+          %7 = OpIAdd %uint %uint_1 %uint_1
+               OpReturn
+               OpFunctionEnd
+          %8 = OpFunction %void None %fn
+          %9 = OpLabel
+               OpReturn
+               OpFunctionEnd
+)";
+
+TEST_F(BinaryParseTest, ParallelParseMatchesSequentialParse) {
+  for (bool endian_swap : kSwapEndians) {
+    SpirvVector words = CompileSuccessfully(kModuleWithFunctions);
+    if (endian_swap) {
+      std::transform(words.begin(), words.end(), words.begin(),
+                     [](const uint32_t raw_word) {
+                       return spvFixWord(raw_word,
+                                         I32_ENDIAN_HOST == I32_ENDIAN_BIG
+                                             ? SPV_ENDIANNESS_LITTLE
+                                             : SPV_ENDIANNESS_BIG);
+                     });
+    }
+    std::vector<ParsedInstruction> expected;
+    EXPECT_EQ(SPV_SUCCESS, spvBinaryParse(ScopedContext().context, &expected,
+                                          words.data(), words.size(), nullptr,
+                                          collect_instruction, nullptr));
+    for (uint32_t num_threads : {0u, 1u, 2u, 3u, 16u}) {
+      std::vector<ParsedInstruction> actual;
+      EXPECT_EQ(SPV_SUCCESS,
+                spvBinaryParseParallel(ScopedContext().context, &actual,
+                                       words.data(), words.size(), nullptr,
+                                       collect_instruction, num_threads,
+                                       &diagnostic_));
+      EXPECT_EQ(nullptr, diagnostic_);
+      EXPECT_THAT(actual, Eq(expected)) << num_threads;
+    }
+  }
+}
+
+TEST_F(BinaryParseTest, ParallelParseIssuesHeaderCallbackOnce) {
+  const auto words = CompileSuccessfully(kModuleWithFunctions);
+  InSequence calls_expected_in_specific_order;
+  EXPECT_CALL(client_, Header(_, _, _, _, _, _))
+      .WillOnce(Return(SPV_SUCCESS));
+  EXPECT_CALL(client_, Instruction(_))
+      .Times(2)
+      .WillOnce(Return(SPV_SUCCESS))
+      .WillOnce(Return(SPV_REQUESTED_TERMINATION));
+  EXPECT_EQ(SPV_REQUESTED_TERMINATION,
+            spvBinaryParseParallel(ScopedContext().context, &client_,
+                                   words.data(), words.size(), invoke_header,
+                                   invoke_instruction, 4, &diagnostic_));
+  EXPECT_EQ(nullptr, diagnostic_);
+}
+
+// Collects the instructions issued by spvBinaryParseBatched, and the size of
+// each batch.
+struct BatchCollector {
+  std::vector<ParsedInstruction> instructions;
+  std::vector<size_t> batch_sizes;
+};
+
+spv_result_t collect_batch(void* user_data,
+                           const spv_parsed_instruction_t* parsed_instructions,
+                           size_t num_instructions) {
+  auto* collector = static_cast<BatchCollector*>(user_data);
+  for (size_t i = 0; i < num_instructions; ++i) {
+    collector->instructions.push_back(
+        ParsedInstruction(parsed_instructions[i]));
+  }
+  collector->batch_sizes.push_back(num_instructions);
+  return SPV_SUCCESS;
+}
+
+TEST_F(BinaryParseTest, BatchedParseMatchesSequentialParse) {
+  for (bool endian_swap : kSwapEndians) {
+    SpirvVector words = CompileSuccessfully(kModuleWithFunctions);
+    if (endian_swap) {
+      std::transform(words.begin(), words.end(), words.begin(),
+                     [](const uint32_t raw_word) {
+                       return spvFixWord(raw_word,
+                                         I32_ENDIAN_HOST == I32_ENDIAN_BIG
+                                             ? SPV_ENDIANNESS_LITTLE
+                                             : SPV_ENDIANNESS_BIG);
+                     });
+    }
+    std::vector<ParsedInstruction> expected;
+    EXPECT_EQ(SPV_SUCCESS, spvBinaryParse(ScopedContext().context, &expected,
+                                          words.data(), words.size(), nullptr,
+                                          collect_instruction, nullptr));
+    for (size_t batch_size : {0u, 1u, 2u, 7u, 1000u}) {
+      BatchCollector actual;
+      EXPECT_EQ(SPV_SUCCESS,
+                spvBinaryParseBatched(ScopedContext().context, &actual,
+                                      words.data(), words.size(), nullptr,
+                                      collect_batch, batch_size,
+                                      &diagnostic_));
+      EXPECT_EQ(nullptr, diagnostic_);
+      EXPECT_THAT(actual.instructions, Eq(expected)) << batch_size;
+      for (size_t size : actual.batch_sizes) {
+        EXPECT_GT(size, 0u);
+        if (batch_size) EXPECT_LE(size, batch_size);
+      }
+    }
+  }
+}
+
+// Returns the offsets of the result Ids of the OpLabel instructions in words.
+std::vector<size_t> LabelIdOffsets(const std::vector<uint32_t>& words) {
+  std::vector<size_t> offsets;
+  for (size_t i = SPV_INDEX_INSTRUCTION; i < words.size();
+       i += words[i] >> 16) {
+    if ((words[i] & 0xFFFF) == SpvOpLabel) offsets.push_back(i + 1);
+  }
+  return offsets;
+}
+
+TEST_F(BinaryParseTest, ParallelParseDiagnosesIdDefinedInTwoFunctions) {
+  auto words = CompileSuccessfully(kModuleWithFunctions);
+  // Make the label of the last function reuse the label Id of the first.
+  const std::vector<size_t> label_ids = LabelIdOffsets(words);
+  ASSERT_EQ(5u, label_ids.size());
+  words[label_ids.back()] = words[label_ids.front()];
+  std::vector<ParsedInstruction> actual;
+  EXPECT_EQ(SPV_ERROR_INVALID_ID,
+            spvBinaryParseParallel(ScopedContext().context, &actual,
+                                   words.data(), words.size(), nullptr,
+                                   collect_instruction, 2, &diagnostic_));
+  ASSERT_NE(nullptr, diagnostic_);
+  EXPECT_THAT(diagnostic_->error, Eq("Id 2 is defined more than once"));
+}
+
+TEST_F(BinaryParseTest, BatchedParseIssuesInstructionsBeforeAnError) {
+  auto words = CompileSuccessfully(kModuleWithFunctions);
+  const std::vector<size_t> label_ids = LabelIdOffsets(words);
+  ASSERT_EQ(5u, label_ids.size());
+  words[label_ids.back()] = words[label_ids.front()];
+  std::vector<ParsedInstruction> expected;
+  EXPECT_EQ(SPV_ERROR_INVALID_ID,
+            spvBinaryParse(ScopedContext().context, &expected, words.data(),
+                           words.size(), nullptr, collect_instruction,
+                           nullptr));
+  BatchCollector actual;
+  EXPECT_EQ(SPV_ERROR_INVALID_ID,
+            spvBinaryParseBatched(ScopedContext().context, &actual,
+                                  words.data(), words.size(), nullptr,
+                                  collect_batch, 4, &diagnostic_));
+  ASSERT_NE(nullptr, diagnostic_);
+  EXPECT_THAT(diagnostic_->error, Eq("Id 2 is defined more than once"));
+  EXPECT_THAT(actual.instructions, Eq(expected));
+}
+
+TEST_F(BinaryParseTest, IdsBeyondWordCount) {
+  auto words = CompileSuccessfully(kModuleWithFunctions);
+  const std::vector<size_t> label_ids = LabelIdOffsets(words);
+  ASSERT_EQ(5u, label_ids.size());
+  words[SPV_INDEX_BOUND] = 0x100000;
+  words[label_ids.back()] = 0xFFFFF;
+  std::vector<ParsedInstruction> actual;
+  EXPECT_EQ(SPV_SUCCESS, spvBinaryParse(ScopedContext().context, &actual,
+                                        words.data(), words.size(), nullptr,
+                                        collect_instruction, &diagnostic_));
+  EXPECT_EQ(nullptr, diagnostic_);
+  ASSERT_FALSE(actual.empty());
+  EXPECT_EQ(0xFFFFFu, actual[actual.size() - 3].result_id);
+
+  // Ids beyond the word count are still checked for being defined twice.
+
+  words[label_ids.front()] = 0xFFFFF;
+  EXPECT_EQ(SPV_ERROR_INVALID_ID,
+            spvBinaryParse(ScopedContext().context, &actual, words.data(),
+                           words.size(), nullptr, collect_instruction,
+                           &diagnostic_));
+  ASSERT_NE(nullptr, diagnostic_);
+  EXPECT_THAT(diagnostic_->error, Eq("Id 1048575 is defined more than once"));
+}
+
+TEST_F(BinaryParseTest, ReusableParserMatchesParse) {
+  ScopedContext context;
+  spv_binary_parser parser = spvBinaryParserCreate(context.context);
+  ASSERT_NE(nullptr, parser);
+  const SpirvVector small_words =
+      CompileSuccessfully("%1 = OpTypeInt 32 0\n%2 = OpTypeFloat 32");
+  for (bool endian_swap : kSwapEndians) {
+    SpirvVector words = CompileSuccessfully(kModuleWithFunctions);
+    if (endian_swap) {
+      std::transform(words.begin(), words.end(), words.begin(),
+                     [](const uint32_t raw_word) {
+                       return spvFixWord(raw_word,
+                                         I32_ENDIAN_HOST == I32_ENDIAN_BIG
+                                             ? SPV_ENDIANNESS_LITTLE
+                                             : SPV_ENDIANNESS_BIG);
+                     });
+    }
+    std::vector<ParsedInstruction> expected;
+    EXPECT_EQ(SPV_SUCCESS, spvBinaryParse(context.context, &expected,
+                                          words.data(), words.size(), nullptr,
+                                          collect_instruction, nullptr));
+    // Parse each module twice, so that nothing is left over from the
+    // previous parse of the same module.
+    for (int i = 0; i < 2; ++i) {
+      std::vector<ParsedInstruction> actual;
+      EXPECT_EQ(SPV_SUCCESS,
+                spvBinaryParserParse(parser, &actual, words.data(),
+                                     words.size(), nullptr,
+                                     collect_instruction, &diagnostic_));
+      EXPECT_EQ(nullptr, diagnostic_);
+      EXPECT_THAT(actual, Eq(expected));
+
+      std::vector<ParsedInstruction> small;
+      EXPECT_EQ(SPV_SUCCESS,
+                spvBinaryParserParse(parser, &small, small_words.data(),
+                                     small_words.size(), nullptr,
+                                     collect_instruction, nullptr));
+      EXPECT_EQ(2u, small.size());
+    }
+  }
+  spvBinaryParserDestroy(parser);
+}
+
+TEST_F(BinaryParseTest, ReusableParserDiagnosesEachParse) {
+  ScopedContext context;
+  spv_binary_parser parser = spvBinaryParserCreate(context.context);
+  ASSERT_NE(nullptr, parser);
+  auto words = CompileSuccessfully(kModuleWithFunctions);
+  auto bad_words = words;
+  const std::vector<size_t> label_ids = LabelIdOffsets(bad_words);
+  ASSERT_EQ(5u, label_ids.size());
+  bad_words[label_ids.back()] = bad_words[label_ids.front()];
+
+  EXPECT_EQ(SPV_ERROR_INVALID_ID,
+            spvBinaryParserParse(parser, nullptr, bad_words.data(),
+                                 bad_words.size(), nullptr, nullptr,
+                                 &diagnostic_));
+  ASSERT_NE(nullptr, diagnostic_);
+  EXPECT_THAT(diagnostic_->error, Eq("Id 2 is defined more than once"));
+  spvDiagnosticDestroy(diagnostic_);
+  diagnostic_ = nullptr;
+
+  EXPECT_EQ(SPV_SUCCESS,
+            spvBinaryParserParse(parser, nullptr, words.data(), words.size(),
+                                 nullptr, nullptr, &diagnostic_));
+  EXPECT_EQ(nullptr, diagnostic_);
+
+  spvBinaryParserDestroy(parser);
+}
+
+TEST_F(BinaryParseTest, ReusableParserUsesConsumerWithoutDiagnostic) {
+  auto words = CompileSuccessfully("");
+  words.push_back(0xffffffff);  // Certainly invalid instruction header.
+  auto ctx = spvtools::Context(SPV_ENV_UNIVERSAL_1_1);
+  int invocation = 0;
+  ctx.SetMessageConsumer([&invocation](spv_message_level_t, const char*,
+                                       const spv_position_t&,
+                                       const char* message) {
+    ++invocation;
+    EXPECT_STREQ("Invalid opcode: 65535", message);
+  });
+  spv_binary_parser parser = spvBinaryParserCreate(ctx.CContext());
+  ASSERT_NE(nullptr, parser);
+  // A parse with a diagnostic does not stop later parses from using the
+  // consumer.
+  EXPECT_EQ(SPV_ERROR_INVALID_BINARY,
+            spvBinaryParserParse(parser, nullptr, words.data(), words.size(),
+                                 nullptr, nullptr, &diagnostic_));
+  EXPECT_EQ(0, invocation);
+  EXPECT_EQ(SPV_ERROR_INVALID_BINARY,
+            spvBinaryParserParse(parser, nullptr, words.data(), words.size(),
+                                 nullptr, nullptr, nullptr));
+  EXPECT_EQ(1, invocation);
+  spvBinaryParserDestroy(parser);
+}
+
+TEST_F(BinaryParseTest, ReusableParserRequiresParser) {
+  const auto words = CompileSuccessfully("");
+  EXPECT_EQ(nullptr, spvBinaryParserCreate(nullptr));
+  EXPECT_EQ(SPV_ERROR_INVALID_POINTER,
+            spvBinaryParserParse(nullptr, nullptr, words.data(), words.size(),
+                                 nullptr, nullptr, nullptr));
+}
+
 // A binary parser diagnostic test case where we provide the words array
 // pointer and word count explicitly.
 struct WordsAndCountDiagnosticCase {
@@ -634,6 +1064,10 @@ INSTANTIATE_TEST_SUITE_P(
                       MakeInstruction(SpvOpTypeInt, {1})}),
          "End of input reached while decoding OpTypeInt starting at word 5:"
          " expected more operands after 2 words."},
+        // The repeated operands of a variable operand are checked too.
+        {Concatenate({ExpectedHeaderForBound(3),
+                      MakeInstruction(SpvOpTypeStruct, {1, 2, 0})}),
+         "Id is 0"},
 
         // Check several cases for running off the end of input.
 
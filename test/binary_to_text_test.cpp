@@ -156,6 +156,127 @@ TEST_F(BinaryToText, InvalidMagicNumber) {
   spvDiagnosticDestroy(diagnostic);
 }
 
+// Appends each piece of text from spvBinaryToTextStream to the vector of
+// strings given as |user_data|.
+spv_result_t AppendText(void* user_data, const char* text, size_t length) {
+  static_cast<std::vector<std::string>*>(user_data)->emplace_back(text, length);
+  return SPV_SUCCESS;
+}
+
+spv_result_t FailToWriteText(void*, const char*, size_t) {
+  return SPV_ERROR_INTERNAL;
+}
+
+TEST_F(BinaryToText, StreamMatchesText) {
+  spv_text text = nullptr;
+  ASSERT_EQ(SPV_SUCCESS,
+            spvBinaryToText(context, binary->code, binary->wordCount,
+                            SPV_BINARY_TO_TEXT_OPTION_NONE, &text, nullptr));
+  std::vector<std::string> pieces;
+  ASSERT_EQ(SPV_SUCCESS,
+            spvBinaryToTextStream(context, binary->code, binary->wordCount,
+                                  SPV_BINARY_TO_TEXT_OPTION_NONE, &pieces,
+                                  AppendText, nullptr));
+  std::string streamed;
+  for (const auto& piece : pieces) streamed += piece;
+  EXPECT_EQ(std::string(text->str, text->length), streamed);
+  spvTextDestroy(text);
+}
+
+TEST_F(BinaryToText, StreamWritesLargeModuleInPieces) {
+  std::string source;
+  for (int i = 0; i < 4000; ++i) {
+    source += "OpSourceExtension \"" + std::string(40, 'a') + "\"\n";
+  }
+  CompileSuccessfully(source);
+  std::vector<std::string> pieces;
+  ASSERT_EQ(SPV_SUCCESS,
+            spvBinaryToTextStream(context, binary->code, binary->wordCount,
+                                  SPV_BINARY_TO_TEXT_OPTION_NO_HEADER, &pieces,
+                                  AppendText, nullptr));
+  EXPECT_LT(1u, pieces.size());
+  std::string streamed;
+  for (const auto& piece : pieces) streamed += piece;
+  EXPECT_EQ(source, streamed);
+}
+
+TEST_F(BinaryToText, StreamStopsOnWriteError) {
+  EXPECT_EQ(SPV_ERROR_INTERNAL,
+            spvBinaryToTextStream(context, binary->code, binary->wordCount,
+                                  SPV_BINARY_TO_TEXT_OPTION_NONE, nullptr,
+                                  FailToWriteText, nullptr));
+}
+
+TEST_F(BinaryToText, StreamRequiresWriter) {
+  EXPECT_EQ(SPV_ERROR_INVALID_POINTER,
+            spvBinaryToTextStream(context, binary->code, binary->wordCount,
+                                  SPV_BINARY_TO_TEXT_OPTION_NONE, nullptr,
+                                  nullptr, nullptr));
+}
+
+// Returns the text of a module with many small functions.
+std::string ModuleWithManyFunctions() {
+  std::string source =
+      "OpCapability Shader\n"
+      "OpMemoryModel Logical GLSL450\n"
+      "OpName %f0 \"first\"\n"
+      "%void = OpTypeVoid\n"
+      "%int = OpTypeInt 32 1\n"
+      "%fn = OpTypeFunction %int %int\n"
+      "%ten = OpConstant %int 10\n";
+  for (int i = 0; i < 100; ++i) {
+    const std::string n = std::to_string(i);
+    source += "%f" + n + " = OpFunction %int None %fn\n" + "%p" + n +
+              " = OpFunctionParameter %int\n" + "%l" + n + " = OpLabel\n" +
+              "%add" + n + " = OpIAdd %int %p" + n + " %ten\n" +
+              "OpReturnValue %add" + n + "\n" + "OpFunctionEnd\n";
+  }
+  return source;
+}
+
+TEST_F(BinaryToText, ParallelMatchesSequential) {
+  CompileSuccessfully(ModuleWithManyFunctions());
+  for (uint32_t options :
+       {uint32_t(SPV_BINARY_TO_TEXT_OPTION_NONE),
+        uint32_t(SPV_BINARY_TO_TEXT_OPTION_FRIENDLY_NAMES |
+                 SPV_BINARY_TO_TEXT_OPTION_INDENT),
+        uint32_t(SPV_BINARY_TO_TEXT_OPTION_SHOW_BYTE_OFFSET |
+                 SPV_BINARY_TO_TEXT_OPTION_COLOR)}) {
+    spv_text expected = nullptr;
+    ASSERT_EQ(SPV_SUCCESS, spvBinaryToText(context, binary->code,
+                                           binary->wordCount, options,
+                                           &expected, nullptr));
+    spv_text text = nullptr;
+    ASSERT_EQ(SPV_SUCCESS,
+              spvBinaryToText(context, binary->code, binary->wordCount,
+                              options | SPV_BINARY_TO_TEXT_OPTION_PARALLEL,
+                              &text, nullptr));
+    EXPECT_EQ(std::string(expected->str, expected->length),
+              std::string(text->str, text->length))
+        << options;
+    spvTextDestroy(expected);
+    spvTextDestroy(text);
+  }
+}
+
+TEST_F(BinaryToText, ParallelStreamMatchesSequential) {
+  CompileSuccessfully(ModuleWithManyFunctions());
+  spv_text expected = nullptr;
+  ASSERT_EQ(SPV_SUCCESS,
+            spvBinaryToText(context, binary->code, binary->wordCount,
+                            SPV_BINARY_TO_TEXT_OPTION_NONE, &expected,
+                            nullptr));
+  std::vector<std::string> pieces;
+  ASSERT_EQ(SPV_SUCCESS,
+            spvBinaryToTextStream(context, binary->code, binary->wordCount,
+                                  SPV_BINARY_TO_TEXT_OPTION_PARALLEL, &pieces,
+                                  AppendText, nullptr));
+  std::string streamed;
+  for (const auto& piece : pieces) streamed += piece;
+  EXPECT_EQ(std::string(expected->str, expected->length), streamed);
+  spvTextDestroy(expected);
+}
+
 struct FailedDecodeCase {
   std::string source_text;
   std::vector<uint32_t> appended_instruction;
@@ -475,6 +596,54 @@ OpMemoryModel Logical GLSL450
               expected);
 }
 
+// The names are collected while disassembling, so check that the global
+// section can refer to Ids named or defined later in the module.
+TEST_F(FriendlyNameDisassemblyTest, ForwardReferences) {
+  const std::string input = R"(
+OpCapability Shader
+OpMemoryModel Logical GLSL450
+OpEntryPoint GLCompute %main "main"
+OpExecutionMode %main LocalSize 1 1 1
+OpName %entry "8"
+OpDecorate %value RelaxedPrecision
+%void = OpTypeVoid
+%fn = OpTypeFunction %void
+%ptr = OpTypePointer Function %int
+%int = OpTypeInt 32 1
+%main = OpFunction %void None %fn
+%entry = OpLabel
+%var = OpVariable %ptr Function
+%value = OpLoad %int %var
+OpReturn
+OpFunctionEnd
+)";
+  const std::string expected =
+      R"(OpCapability Shader
+OpMemoryModel Logical GLSL450
+OpEntryPoint GLCompute %1 "main"
+OpExecutionMode %1 LocalSize 1 1 1
+OpName %8 "8"
+OpDecorate %3 RelaxedPrecision
+%void = OpTypeVoid
+%5 = OpTypeFunction %void
+%_ptr_Function_7 = OpTypePointer Function %int
+%int = OpTypeInt 32 1
+%1 = OpFunction %void None %5
+%8 = OpLabel
+%8_0 = OpVariable %_ptr_Function_7 Function
+%3 = OpLoad %int %8_0
+OpReturn
+OpFunctionEnd
+)";
+  EXPECT_THAT(EncodeAndDecodeSuccessfully(
+                  input, SPV_BINARY_TO_TEXT_OPTION_FRIENDLY_NAMES),
+              expected);
+  EXPECT_THAT(EncodeAndDecodeSuccessfully(
+                  input, SPV_BINARY_TO_TEXT_OPTION_FRIENDLY_NAMES |
+                             SPV_BINARY_TO_TEXT_OPTION_PARALLEL),
+              expected);
+}
+
 TEST_F(TextToBinaryTest, ShowByteOffsetsWhenRequested) {
   const std::string input = R"(
 OpCapability Shader
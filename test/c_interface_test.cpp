@@ -295,5 +295,53 @@ TEST(CInterface, SpecifyConsumerSpecifyDiagnosticForValidating) {
   spvContextDestroy(context);
 }
 
+TEST(CInterface, ValidateBatchReportsEachBinary) {
+  const char valid_text[] =
+      "OpCapability Shader\n"
+      "OpCapability Linkage\n"
+      "OpMemoryModel Logical GLSL450";
+  const char invalid_text[] = "OpNop";
+
+  auto context = spvContextCreate(SPV_ENV_UNIVERSAL_1_1);
+  spv_binary valid = nullptr;
+  ASSERT_EQ(SPV_SUCCESS, spvTextToBinary(context, valid_text,
+                                         sizeof(valid_text), &valid, nullptr));
+  spv_binary invalid = nullptr;
+  ASSERT_EQ(SPV_SUCCESS,
+            spvTextToBinary(context, invalid_text, sizeof(invalid_text),
+                            &invalid, nullptr));
+
+  const spv_const_binary_t binaries[] = {
+      {valid->code, valid->wordCount},
+      {invalid->code, invalid->wordCount},
+      {valid->code, valid->wordCount}};
+  spv_validator_options options = spvValidatorOptionsCreate();
+  for (uint32_t num_threads : {1u, 3u}) {
+    spv_result_t results[3];
+    spv_diagnostic diagnostics[3];
+    EXPECT_EQ(SPV_ERROR_INVALID_LAYOUT,
+              spvValidateBatchWithOptions(context, options, binaries, 3,
+                                          num_threads, results, diagnostics));
+    EXPECT_EQ(SPV_SUCCESS, results[0]);
+    EXPECT_EQ(SPV_ERROR_INVALID_LAYOUT, results[1]);
+    EXPECT_EQ(SPV_SUCCESS, results[2]);
+    EXPECT_EQ(nullptr, diagnostics[0]);
+    ASSERT_NE(nullptr, diagnostics[1]);
+    EXPECT_STREQ(
+        "Nop cannot appear before the memory model instruction\n"
+        "  OpNop\n",
+        diagnostics[1]->error);
+    EXPECT_EQ(nullptr, diagnostics[2]);
+    for (spv_diagnostic diagnostic : diagnostics) {
+      spvDiagnosticDestroy(diagnostic);
+    }
+  }
+
+  spvValidatorOptionsDestroy(options);
+  spvBinaryDestroy(invalid);
+  spvBinaryDestroy(valid);
+  spvContextDestroy(context);
+}
+
 }  // namespace
 }  // namespace spvtools
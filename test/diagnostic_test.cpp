@@ -81,6 +81,14 @@ TEST(DiagnosticStream, ConversionToResultType) {
             spv_result_t(DiagnosticStream({}, nullptr, "", SPV_FAILED_MATCH)));
 }
 
+TEST(DiagnosticStream, WithoutConsumerOnlyCarriesTheResult) {
+  DiagnosticStream ds0({}, nullptr, "", SPV_ERROR_INVALID_ID);
+  ds0 << "Ignored " << 42;
+  DiagnosticStream ds1(std::move(ds0));
+  ds1 << "Also ignored";
+  EXPECT_EQ(SPV_ERROR_INVALID_ID, spv_result_t(ds1));
+}
+
 TEST(
     DiagnosticStream,
     MoveConstructorPreservesPreviousMessagesAndPreventsOutputFromExpiringValue) {
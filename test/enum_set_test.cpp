@@ -178,6 +178,24 @@ TEST(EnumSet, DefaultIsEmpty) {
   }
 }
 
+TEST(EnumSet, ValuesInSeveralBuckets) {
+  // Values in the same range of 64 values share a bucket.
+  EnumSet<uint32_t> set{5000, 4423, 4424, 5001, 1, 0xffffffff};
+  for (uint32_t value : {0u, 2u, 63u, 64u, 4422u, 4425u, 4999u, 5002u,
+                         0xfffffffeu}) {
+    EXPECT_FALSE(set.Contains(value)) << value;
+  }
+  for (uint32_t value : {1u, 4423u, 4424u, 5000u, 5001u, 0xffffffffu}) {
+    EXPECT_TRUE(set.Contains(value)) << value;
+  }
+  std::vector<uint32_t> elements;
+  set.ForEach([&elements](uint32_t value) { elements.push_back(value); });
+  EXPECT_THAT(elements, Eq(std::vector<uint32_t>{1, 4423, 4424, 5000, 5001,
+                                                 0xffffffff}));
+  EXPECT_TRUE(set.HasAnyOf(EnumSet<uint32_t>{4000, 5001}));
+  EXPECT_FALSE(set.HasAnyOf(EnumSet<uint32_t>{4000, 5002, 4422}));
+}
+
 TEST(CapabilitySet, ConstructSingleMemberMatrix) {
   CapabilitySet s(SpvCapabilityMatrix);
   EXPECT_TRUE(s.Contains(SpvCapabilityMatrix));
@@ -0,0 +1,81 @@
+// Copyright (c) 2020 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "gmock/gmock.h"
+#include "source/ext_inst.h"
+#include "source/latest_version_glsl_std_450_header.h"
+#include "source/table.h"
+#include "test/unit_spirv.h"
+
+namespace spvtools {
+namespace {
+
+TEST(ExtInstTable, LookupsFindFirstEntry) {
+  spv_ext_inst_table table;
+  ASSERT_EQ(SPV_SUCCESS, spvExtInstTableGet(&table, SPV_ENV_UNIVERSAL_1_0));
+  for (uint32_t groupIndex = 0; groupIndex < table->count; ++groupIndex) {
+    const spv_ext_inst_group_t& group = table->groups[groupIndex];
+    for (uint32_t i = 0; i < group.count; ++i) {
+      const spv_ext_inst_desc_t& expected = group.entries[i];
+      spv_ext_inst_desc entry = nullptr;
+      ASSERT_EQ(SPV_SUCCESS, spvExtInstTableValueLookup(
+                                 table, group.type, expected.ext_inst, &entry));
+      EXPECT_EQ(expected.ext_inst, entry->ext_inst);
+      EXPECT_LE(entry, &expected) << expected.name;
+
+      ASSERT_EQ(SPV_SUCCESS, spvExtInstTableNameLookup(
+                                 table, group.type, expected.name, &entry));
+      EXPECT_STREQ(expected.name, entry->name);
+      EXPECT_LE(entry, &expected) << expected.name;
+    }
+  }
+}
+
+TEST(ExtInstTable, LookupsRejectUnknownInstructions) {
+  spv_ext_inst_table table;
+  ASSERT_EQ(SPV_SUCCESS, spvExtInstTableGet(&table, SPV_ENV_UNIVERSAL_1_0));
+  spv_ext_inst_desc entry = nullptr;
+  const spv_ext_inst_type_t glsl = SPV_EXT_INST_TYPE_GLSL_STD_450;
+
+  EXPECT_EQ(SPV_SUCCESS,
+            spvExtInstTableValueLookup(table, glsl, GLSLstd450Sqrt, &entry));
+  EXPECT_STREQ("Sqrt", entry->name);
+  // GLSL.std.450 has no instruction 0.
+  EXPECT_EQ(SPV_ERROR_INVALID_LOOKUP,
+            spvExtInstTableValueLookup(table, glsl, 0, &entry));
+  EXPECT_EQ(SPV_ERROR_INVALID_LOOKUP,
+            spvExtInstTableValueLookup(table, glsl, 0xFFFF, &entry));
+  EXPECT_EQ(SPV_ERROR_INVALID_LOOKUP,
+            spvExtInstTableValueLookup(table, glsl, ~0u, &entry));
+
+  EXPECT_EQ(SPV_SUCCESS,
+            spvExtInstTableNameLookup(table, glsl, "Sqrt", &entry));
+  EXPECT_EQ(uint32_t(GLSLstd450Sqrt), entry->ext_inst);
+  EXPECT_EQ(SPV_ERROR_INVALID_LOOKUP,
+            spvExtInstTableNameLookup(table, glsl, "Sqr", &entry));
+  EXPECT_EQ(SPV_ERROR_INVALID_LOOKUP,
+            spvExtInstTableNameLookup(table, glsl, "Sqrtt", &entry));
+  EXPECT_EQ(SPV_ERROR_INVALID_LOOKUP,
+            spvExtInstTableNameLookup(table, glsl, "", &entry));
+
+  EXPECT_EQ(SPV_ERROR_INVALID_LOOKUP,
+            spvExtInstTableValueLookup(table, SPV_EXT_INST_TYPE_NONE,
+                                       GLSLstd450Sqrt, &entry));
+  EXPECT_EQ(SPV_ERROR_INVALID_LOOKUP,
+            spvExtInstTableNameLookup(table, SPV_EXT_INST_TYPE_NONE, "Sqrt",
+                                      &entry));
+}
+
+}  // namespace
+}  // namespace spvtools
@@ -40,6 +40,39 @@ TEST(FixWord, Reorder) {
   ASSERT_EQ(result, spvFixWord(word, endian));
 }
 
+TEST(FixWords, Default) {
+  spv_endianness_t endian =
+      (I32_ENDIAN_HOST == I32_ENDIAN_LITTLE ? SPV_ENDIANNESS_LITTLE
+                                            : SPV_ENDIANNESS_BIG);
+  const std::vector<uint32_t> words = {0x53780921, 0xdeadbeef, 1, 2, 3};
+  std::vector<uint32_t> result(words.size());
+  spvFixWords(words.data(), words.size(), endian, result.data());
+  ASSERT_EQ(words, result);
+}
+
+TEST(FixWords, ReorderMatchesFixWord) {
+  spv_endianness_t endian =
+      (I32_ENDIAN_HOST == I32_ENDIAN_LITTLE ? SPV_ENDIANNESS_BIG
+                                            : SPV_ENDIANNESS_LITTLE);
+  // Use sizes that exercise both the vectorized and the remainder loops.
+  for (size_t size : {0, 1, 3, 4, 5, 8, 17, 64}) {
+    std::vector<uint32_t> words(size);
+    for (size_t i = 0; i < size; ++i) {
+      words[i] = 0x01020304u * static_cast<uint32_t>(i + 1) + 0xdeadbeef;
+    }
+    std::vector<uint32_t> expected(size);
+    for (size_t i = 0; i < size; ++i) {
+      expected[i] = spvFixWord(words[i], endian);
+    }
+    std::vector<uint32_t> result(size);
+    spvFixWords(words.data(), size, endian, result.data());
+    EXPECT_EQ(expected, result) << size;
+    // Converting in place gives the same result.
+    spvFixWords(words.data(), size, endian, words.data());
+    EXPECT_EQ(expected, words) << size;
+  }
+}
+
 TEST(FixDoubleWord, Default) {
   spv_endianness_t endian =
       (I32_ENDIAN_HOST == I32_ENDIAN_LITTLE ? SPV_ENDIANNESS_LITTLE
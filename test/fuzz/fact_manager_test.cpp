@@ -1173,6 +1173,69 @@ TEST(FactManagerTest, RecursiveAdditionOfFacts) {
                                         context.get()));
 }
 
+TEST(FactManagerTest, CorollaryFactsAreDeducedAsFactsAreAdded) {
+  std::string shader = R"(
+               OpCapability Shader
+          %1 = OpExtInstImport "GLSL.std.450"
+               OpMemoryModel Logical GLSL450
+               OpEntryPoint Fragment %14 "main"
+               OpExecutionMode %14 OriginUpperLeft
+               OpSource ESSL 310
+          %2 = OpTypeVoid
+          %3 = OpTypeFunction %2
+          %6 = OpTypeFloat 32
+          %7 = OpTypeVector %6 4
+          %8 = OpTypeMatrix %7 4
+          %9 = OpConstant %6 0
+         %10 = OpConstantComposite %7 %9 %9 %9 %9
+         %11 = OpConstantComposite %8 %10 %10 %10 %10
+         %12 = OpConstantComposite %7 %9 %9 %9 %9
+         %13 = OpConstantComposite %8 %10 %10 %10 %10
+         %14 = OpFunction %2 None %3
+         %15 = OpLabel
+               OpReturn
+               OpFunctionEnd
+  )";
+
+  const auto env = SPV_ENV_UNIVERSAL_1_3;
+  const auto consumer = nullptr;
+  const auto context = BuildModule(env, consumer, shader, kFuzzAssembleOption);
+  ASSERT_TRUE(IsValid(env, context.get()));
+
+  FactManager fact_manager;
+
+  // %10 and %12 only become synonymous once all their components are.
+  for (uint32_t i : {2, 0, 3}) {
+    fact_manager.AddFactDataSynonym(MakeDataDescriptor(10, {i}),
+                                    MakeDataDescriptor(12, {i}),
+                                    context.get());
+    ASSERT_FALSE(fact_manager.IsSynonymous(MakeDataDescriptor(10, {}),
+                                           MakeDataDescriptor(12, {}),
+                                           context.get()));
+  }
+  fact_manager.AddFactDataSynonym(MakeDataDescriptor(12, {1}),
+                                  MakeDataDescriptor(10, {1}), context.get());
+  ASSERT_TRUE(fact_manager.IsSynonymous(
+      MakeDataDescriptor(10, {}), MakeDataDescriptor(12, {}), context.get()));
+
+  // The columns of %11 and %13 become synonymous through %10 and %12, which
+  // makes %11 and %13 synonymous.
+  for (uint32_t i = 0; i < 4; i++) {
+    ASSERT_FALSE(fact_manager.IsSynonymous(MakeDataDescriptor(11, {}),
+                                           MakeDataDescriptor(13, {}),
+                                           context.get()));
+    fact_manager.AddFactDataSynonym(MakeDataDescriptor(11, {i}),
+                                    MakeDataDescriptor(10, {}), context.get());
+    fact_manager.AddFactDataSynonym(MakeDataDescriptor(13, {i}),
+                                    MakeDataDescriptor(12, {}), context.get());
+  }
+  ASSERT_TRUE(fact_manager.IsSynonymous(
+      MakeDataDescriptor(11, {}), MakeDataDescriptor(13, {}), context.get()));
+  ASSERT_TRUE(fact_manager.IsSynonymous(MakeDataDescriptor(11, {3, 1}),
+                                        MakeDataDescriptor(13, {0, 1}),
+                                        context.get()));
+}
+
 }  // namespace
 }  // namespace fuzz
 }  // namespace spvtools
@@ -667,6 +667,76 @@ TEST(FuzzerPassDonateModulesTest, Miscellaneous1) {
   ASSERT_TRUE(IsValid(env, recipient_context.get()));
 }
 
+TEST(FuzzerPassDonateModulesTest, DonorsAreSuppliedOnce) {
+  // This test checks that a donor module is only supplied the first time it
+  // is chosen, however many times the pass is applied.
+  std::string recipient_shader = R"(
+               OpCapability Shader
+               OpMemoryModel Logical GLSL450
+               OpEntryPoint Fragment %4 "main"
+               OpExecutionMode %4 OriginUpperLeft
+               OpSource ESSL 310
+          %2 = OpTypeVoid
+          %3 = OpTypeFunction %2
+          %4 = OpFunction %2 None %3
+          %5 = OpLabel
+               OpReturn
+               OpFunctionEnd
+  )";
+
+  std::string donor_shader = R"(
+               OpCapability Shader
+               OpMemoryModel Logical GLSL450
+               OpEntryPoint Fragment %4 "main"
+               OpExecutionMode %4 OriginUpperLeft
+               OpSource ESSL 310
+          %2 = OpTypeVoid
+          %3 = OpTypeFunction %2
+          %6 = OpTypeInt 32 1
+          %7 = OpTypeFunction %6
+          %8 = OpConstant %6 2
+          %4 = OpFunction %2 None %3
+          %5 = OpLabel
+         %10 = OpFunctionCall %6 %11
+               OpReturn
+               OpFunctionEnd
+         %11 = OpFunction %6 None %7
+         %12 = OpLabel
+               OpReturnValue %8
+               OpFunctionEnd
+  )";
+
+  const auto env = SPV_ENV_UNIVERSAL_1_3;
+  const auto consumer = nullptr;
+  const auto recipient_context =
+      BuildModule(env, consumer, recipient_shader, kFuzzAssembleOption);
+  ASSERT_TRUE(IsValid(env, recipient_context.get()));
+
+  uint32_t num_supplied = 0;
+  std::vector<fuzzerutil::ModuleSupplier> donor_suppliers = {
+      [&num_supplied, env, consumer,
+       &donor_shader]() -> std::unique_ptr<opt::IRContext> {
+        num_supplied++;
+        return BuildModule(env, consumer, donor_shader, kFuzzAssembleOption);
+      }};
+
+  FactManager fact_manager;
+
+  PseudoRandomGenerator random_generator(0);
+  FuzzerContext fuzzer_context(&random_generator, 100);
+  protobufs::TransformationSequence transformation_sequence;
+
+  FuzzerPassDonateModules fuzzer_pass(recipient_context.get(), &fact_manager,
+                                      &fuzzer_context, &transformation_sequence,
+                                      donor_suppliers);
+
+  for (uint32_t i = 0; i < 3; i++) {
+    fuzzer_pass.Apply();
+    ASSERT_TRUE(IsValid(env, recipient_context.get()));
+  }
+  ASSERT_EQ(1, num_supplied);
+}
+
 }  // namespace
 }  // namespace fuzz
 }  // namespace spvtools
@@ -1594,6 +1594,48 @@ void RunFuzzerAndReplayer(const std::string& shader,
         &replayer_transformations_string);
     ASSERT_EQ(fuzzer_transformations_string, replayer_transformations_string);
     ASSERT_EQ(fuzzer_binary_out, replayer_binary_out);
+
+    // The module should remain valid after every transformation.
+    std::vector<uint32_t> validated_binary_out;
+    protobufs::TransformationSequence validated_transformation_sequence_out;
+    Replayer validating_replayer(env, true);
+    validating_replayer.SetMessageConsumer(kSilentConsumer);
+    ASSERT_EQ(Replayer::ReplayerResultStatus::kComplete,
+              validating_replayer.Run(binary_in, initial_facts,
+                                      fuzzer_transformation_sequence_out,
+                                      &validated_binary_out,
+                                      &validated_transformation_sequence_out));
+    ASSERT_EQ(fuzzer_binary_out, validated_binary_out);
+
+    // Resuming the replay from any of its checkpoints should give the same
+    // result.
+    const uint32_t kCheckpointInterval = 5;
+    std::vector<Replayer::Checkpoint> checkpoints;
+    std::vector<uint32_t> checkpointed_binary_out;
+    protobufs::TransformationSequence checkpointed_transformation_sequence_out;
+    ASSERT_EQ(Replayer::ReplayerResultStatus::kComplete,
+              replayer.RunWithCheckpoints(
+                  binary_in, initial_facts, fuzzer_transformation_sequence_out,
+                  kCheckpointInterval, &checkpointed_binary_out,
+                  &checkpointed_transformation_sequence_out, &checkpoints));
+    ASSERT_EQ(fuzzer_binary_out, checkpointed_binary_out);
+    ASSERT_EQ(fuzzer_transformation_sequence_out.transformation_size() /
+                  kCheckpointInterval,
+              checkpoints.size());
+    for (auto& checkpoint : checkpoints) {
+      std::vector<uint32_t> resumed_binary_out;
+      protobufs::TransformationSequence resumed_transformation_sequence_out;
+      ASSERT_EQ(Replayer::ReplayerResultStatus::kComplete,
+                replayer.ResumeFromCheckpoint(
+                    checkpoint, fuzzer_transformation_sequence_out,
+                    kCheckpointInterval, &resumed_binary_out,
+                    &resumed_transformation_sequence_out, nullptr));
+      std::string resumed_transformations_string;
+      resumed_transformation_sequence_out.SerializeToString(
+          &resumed_transformations_string);
+      ASSERT_EQ(fuzzer_transformations_string, resumed_transformations_string);
+      ASSERT_EQ(fuzzer_binary_out, resumed_binary_out);
+    }
   }
 }
 
@@ -978,16 +978,18 @@ class InterestingThenRandom : public InterestingnessTest {
 //
 // The |step_limit| parameter restricts the number of steps that the shrinker
 // will try; it can be set to something small for a faster (but less thorough)
-// test.
+// test.  The shrinker tries the removals of up to |num_threads| chunks at the
+// same time.
 void RunAndCheckShrinker(
     const spv_target_env& target_env, const std::vector<uint32_t>& binary_in,
     const protobufs::FactSequence& initial_facts,
     const protobufs::TransformationSequence& transformation_sequence_in,
     const Shrinker::InterestingnessFunction& interestingness_function,
     const std::vector<uint32_t>& expected_binary_out,
-    uint32_t expected_transformations_out_size, uint32_t step_limit) {
+    uint32_t expected_transformations_out_size, uint32_t step_limit,
+    uint32_t num_threads = 1) {
   // Run the shrinker.
-  Shrinker shrinker(target_env, step_limit, false);
+  Shrinker shrinker(target_env, step_limit, false, num_threads);
   shrinker.SetMessageConsumer(kSilentConsumer);
 
   std::vector<uint32_t> binary_out;
@@ -1052,6 +1054,13 @@ void RunFuzzerAndShrinker(const std::string& shader,
       env, binary_in, initial_facts, fuzzer_transformation_sequence_out,
       AlwaysInteresting().AsFunction(), binary_in, 0, kReasonableStepLimit);
 
+  // Trying the removals of several chunks at the same time should give the
+  // same result.
+  RunAndCheckShrinker(env, binary_in, initial_facts,
+                      fuzzer_transformation_sequence_out,
+                      AlwaysInteresting().AsFunction(), binary_in, 0,
+                      kReasonableStepLimit, 4);
+
   // With the OnlyInterestingFirstTime test, no shrinking should be achieved.
   RunAndCheckShrinker(
       env, binary_in, initial_facts, fuzzer_transformation_sequence_out,
@@ -2608,6 +2608,60 @@ TEST(TransformationAddDeadBreakTest,
   ASSERT_FALSE(bad_transformation.IsApplicable(context.get(), fact_manager));
 }
 
+TEST(TransformationAddDeadBreakTest, IsApplicableLeavesModuleUnchanged) {
+  // The validity of a dead break is checked by adding it to the module
+  // tentatively; this checks that the module is restored afterwards, including
+  // the OpPhi instructions of the target block.
+  std::string shader = R"(
+               OpCapability Shader
+          %1 = OpExtInstImport "GLSL.std.450"
+               OpMemoryModel Logical GLSL450
+               OpEntryPoint Fragment %4 "main"
+               OpExecutionMode %4 OriginUpperLeft
+               OpSource ESSL 310
+          %2 = OpTypeVoid
+          %3 = OpTypeFunction %2
+          %6 = OpTypeInt 32 1
+          %9 = OpConstant %6 1
+         %17 = OpConstant %6 2
+         %13 = OpTypeBool
+         %25 = OpConstantTrue %13
+          %4 = OpFunction %2 None %3
+          %5 = OpLabel
+               OpSelectionMerge %16 None
+               OpBranchConditional %25 %15 %19
+         %15 = OpLabel
+               OpBranch %21
+         %21 = OpLabel
+               OpBranch %16
+         %19 = OpLabel
+               OpBranch %16
+         %16 = OpLabel
+         %20 = OpPhi %6 %9 %21 %17 %19
+               OpReturn
+               OpFunctionEnd
+  )";
+
+  const auto env = SPV_ENV_UNIVERSAL_1_3;
+  const auto consumer = nullptr;
+  const auto context = BuildModule(env, consumer, shader, kFuzzAssembleOption);
+  ASSERT_TRUE(IsValid(env, context.get()));
+  FactManager fact_manager;
+
+  std::vector<uint32_t> binary_before;
+  context->module()->ToBinary(&binary_before, false);
+
+  auto transformation = TransformationAddDeadBreak(15, 16, true, {17});
+  ASSERT_TRUE(transformation.IsApplicable(context.get(), fact_manager));
+
+  std::vector<uint32_t> binary_after;
+  context->module()->ToBinary(&binary_after, false);
+  ASSERT_EQ(binary_before, binary_after);
+
+  transformation.Apply(context.get(), &fact_manager);
+  ASSERT_TRUE(IsValid(env, context.get()));
+}
+
 }  // namespace
 }  // namespace fuzz
 }  // namespace spvtools
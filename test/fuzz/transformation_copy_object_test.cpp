@@ -588,6 +588,53 @@ TEST(TransformationCopyObjectTest, MiscellaneousCopies) {
   ASSERT_TRUE(IsEqual(env, after_transformation, context.get()));
 }
 
+TEST(TransformationCopyObjectTest, KeepsAnalysesValid) {
+  std::string shader = R"(
+               OpCapability Shader
+          %1 = OpExtInstImport "GLSL.std.450"
+               OpMemoryModel Logical GLSL450
+               OpEntryPoint Fragment %4 "main"
+               OpExecutionMode %4 OriginUpperLeft
+               OpSource ESSL 310
+          %2 = OpTypeVoid
+          %6 = OpTypeBool
+          %7 = OpConstantTrue %6
+          %3 = OpTypeFunction %2
+          %4 = OpFunction %2 None %3
+          %5 = OpLabel
+               OpReturn
+               OpFunctionEnd
+  )";
+
+  const auto env = SPV_ENV_UNIVERSAL_1_3;
+  const auto consumer = nullptr;
+  const auto context = BuildModule(env, consumer, shader, kFuzzAssembleOption);
+  ASSERT_TRUE(IsValid(env, context.get()));
+
+  FactManager fact_manager;
+  opt::Function* function = context->GetFunction(4);
+  const opt::DominatorAnalysis* dominators =
+      context->GetDominatorAnalysis(function);
+
+  TransformationCopyObject copy_true(
+      7, MakeInstructionDescriptor(5, SpvOpReturn, 0), 100);
+  ASSERT_TRUE(copy_true.IsApplicable(context.get(), fact_manager));
+  copy_true.Apply(context.get(), &fact_manager);
+
+  // The copy is added to the def-use manager in place, and the control flow
+  // analyses survive.
+  ASSERT_TRUE(context->AreAnalysesValid(
+      opt::IRContext::kAnalysisDefUse | opt::IRContext::kAnalysisCFG |
+      opt::IRContext::kAnalysisDominatorAnalysis));
+  EXPECT_EQ(dominators, context->GetDominatorAnalysis(function));
+  opt::Instruction* copy = context->get_def_use_mgr()->GetDef(100);
+  ASSERT_NE(nullptr, copy);
+  EXPECT_EQ(SpvOpCopyObject, copy->opcode());
+  EXPECT_EQ(context->get_instr_block(5), context->get_instr_block(copy));
+  EXPECT_EQ(1u, context->get_def_use_mgr()->NumUses(7));
+  ASSERT_TRUE(IsValid(env, context.get()));
+}
+
 }  // namespace
 }  // namespace fuzz
 }  // namespace spvtools
@@ -0,0 +1,93 @@
+// Copyright (c) 2019 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "source/fuzz/transformation_stream.h"
+
+#include <sstream>
+
+#include "source/fuzz/transformation_add_type_boolean.h"
+#include "source/fuzz/transformation_add_type_int.h"
+#include "test/fuzz/fuzz_test_util.h"
+
+namespace spvtools {
+namespace fuzz {
+namespace {
+
+protobufs::TransformationSequence MakeSequence() {
+  protobufs::TransformationSequence result;
+  *result.add_transformation() = TransformationAddTypeBoolean(10).ToMessage();
+  *result.add_transformation() =
+      TransformationAddTypeInt(11, 32, true).ToMessage();
+  *result.add_transformation() =
+      TransformationAddTypeInt(12, 32, false).ToMessage();
+  return result;
+}
+
+TEST(TransformationStreamTest, RoundTrip) {
+  auto sequence = MakeSequence();
+  std::stringstream stream;
+  ASSERT_TRUE(WriteTransformationsToStream(sequence, &stream));
+
+  TransformationStreamReader reader(&stream);
+  protobufs::Transformation transformation;
+  for (auto& expected : sequence.transformation()) {
+    ASSERT_TRUE(reader.Next(&transformation));
+    ASSERT_EQ(expected.SerializeAsString(),
+              transformation.SerializeAsString());
+  }
+  ASSERT_FALSE(reader.Next(&transformation));
+  ASSERT_FALSE(reader.failed());
+}
+
+TEST(TransformationStreamTest, EmptyStream) {
+  std::stringstream stream;
+  protobufs::TransformationSequence sequence;
+  ASSERT_TRUE(ReadTransformationsFromStream(&stream, &sequence));
+  ASSERT_EQ(0, sequence.transformation_size());
+}
+
+TEST(TransformationStreamTest, ConcatenatedStreams) {
+  auto sequence = MakeSequence();
+  std::stringstream stream;
+  ASSERT_TRUE(WriteTransformationsToStream(sequence, &stream));
+  ASSERT_TRUE(WriteTransformationToStream(sequence.transformation(0), &stream));
+
+  protobufs::TransformationSequence read_sequence;
+  ASSERT_TRUE(ReadTransformationsFromStream(&stream, &read_sequence));
+  ASSERT_EQ(4, read_sequence.transformation_size());
+  ASSERT_EQ(sequence.transformation(0).SerializeAsString(),
+            read_sequence.transformation(3).SerializeAsString());
+}
+
+TEST(TransformationStreamTest, TruncatedStream) {
+  auto sequence = MakeSequence();
+  std::stringstream stream;
+  ASSERT_TRUE(WriteTransformationsToStream(sequence, &stream));
+  std::string bytes = stream.str();
+
+  // Dropping the last byte leaves the last transformation incomplete, but the
+  // transformations preceding it can still be read.
+  std::stringstream truncated_stream(bytes.substr(0, bytes.size() - 1));
+  TransformationStreamReader reader(&truncated_stream);
+  protobufs::Transformation transformation;
+  ASSERT_TRUE(reader.Next(&transformation));
+  ASSERT_TRUE(reader.Next(&transformation));
+  ASSERT_FALSE(reader.Next(&transformation));
+  ASSERT_TRUE(reader.failed());
+  ASSERT_FALSE(reader.Next(&transformation));
+}
+
+}  // namespace
+}  // namespace fuzz
+}  // namespace spvtools
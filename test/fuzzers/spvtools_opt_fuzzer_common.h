@@ -0,0 +1,65 @@
+// Copyright (c) 2020 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef TEST_FUZZERS_SPVTOOLS_OPT_FUZZER_COMMON_H_
+#define TEST_FUZZERS_SPVTOOLS_OPT_FUZZER_COMMON_H_
+
+#include <cstdint>
+#include <vector>
+
+#include "spirv-tools/libspirv.hpp"
+#include "spirv-tools/optimizer.hpp"
+
+namespace spvtools {
+namespace fuzzers {
+
+// Optimizes the binary in the |size| bytes at |data| for |env| with the passes
+// that |register_passes| registers.  A pass can only run once, so each input
+// gets a new optimizer.  The validator is shared by the inputs, so that its
+// tables are only built once, and every call must give the same |env|.
+inline void OptimizeFuzzerInput(const uint8_t* data, size_t size,
+                                spv_target_env env,
+                                Optimizer& (Optimizer::*register_passes)()) {
+  const MessageConsumer ignore_messages =
+      [](spv_message_level_t, const char*, const spv_position_t&,
+         const char*) {};
+  static const SpirvTools* const tools = [env, &ignore_messages] {
+    auto* result = new SpirvTools(env);
+    result->SetMessageConsumer(ignore_messages);
+    return result;
+  }();
+
+  std::vector<uint32_t> input;
+  input.resize(size >> 2);
+
+  size_t count = 0;
+  for (size_t i = 0; (i + 3) < size; i += 4) {
+    input[count++] = data[i] | (data[i + 1] << 8) | (data[i + 2] << 16) |
+                     (data[i + 3]) << 24;
+  }
+
+  if (!tools->Validate(input)) return;
+
+  Optimizer optimizer(env);
+  optimizer.SetMessageConsumer(ignore_messages);
+  (optimizer.*register_passes)();
+  OptimizerOptions options;
+  options.set_run_validator(false);
+  optimizer.Run(input.data(), input.size(), &input, options);
+}
+
+}  // namespace fuzzers
+}  // namespace spvtools
+
+#endif  // TEST_FUZZERS_SPVTOOLS_OPT_FUZZER_COMMON_H_
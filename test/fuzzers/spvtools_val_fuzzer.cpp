@@ -17,11 +17,23 @@
 
 #include "spirv-tools/libspirv.hpp"
 
-extern "C" int LLVMFuzzerTestOneInput(const uint8_t* data, size_t size) {
-  spvtools::SpirvTools tools(SPV_ENV_UNIVERSAL_1_3);
-  tools.SetMessageConsumer([](spv_message_level_t, const char*,
-                              const spv_position_t&, const char*) {});
+namespace {
+
+// Returns the validator shared by all the inputs, so that its tables are only
+// built once.  Validating does not change it.
+const spvtools::SpirvTools& GetTools() {
+  static const spvtools::SpirvTools* const tools = [] {
+    auto* result = new spvtools::SpirvTools(SPV_ENV_UNIVERSAL_1_3);
+    result->SetMessageConsumer([](spv_message_level_t, const char*,
+                                  const spv_position_t&, const char*) {});
+    return result;
+  }();
+  return *tools;
+}
 
+}  // namespace
+
+extern "C" int LLVMFuzzerTestOneInput(const uint8_t* data, size_t size) {
   std::vector<uint32_t> input;
   input.resize(size >> 2);
 
@@ -31,6 +43,6 @@ extern "C" int LLVMFuzzerTestOneInput(const uint8_t* data, size_t size) {
                      (data[i + 3]) << 24;
   }
 
-  tools.Validate(input);
+  GetTools().Validate(input);
   return 0;
 }
@@ -13,6 +13,7 @@
 // limitations under the License.
 
 #include <string>
+#include <vector>
 
 #include "gmock/gmock.h"
 #include "test/link/linker_fixture.h"
@@ -90,5 +91,51 @@ OpFunctionEnd
                         "GLCompute, was already defined."));
 }
 
+TEST_F(EntryPoints, LoadModulesOnSeveralThreads) {
+  std::vector<std::string> bodies;
+  for (int i = 0; i < 16; ++i) {
+    bodies.push_back("OpEntryPoint GLCompute %3 \"main" + std::to_string(i) +
+                     R"("
+%1 = OpTypeVoid
+%2 = OpTypeFunction %1
+%3 = OpFunction %1 None %2
+OpFunctionEnd
+)");
+  }
+
+  spvtest::Binary serial_binary;
+  ASSERT_EQ(SPV_SUCCESS, AssembleAndLink(bodies, &serial_binary));
+
+  LinkerOptions options;
+  options.SetNumThreads(4);
+  spvtest::Binary parallel_binary;
+  ASSERT_EQ(SPV_SUCCESS, AssembleAndLink(bodies, &parallel_binary, options));
+  EXPECT_THAT(GetErrorMessage(), std::string());
+  EXPECT_EQ(serial_binary, parallel_binary);
+}
+
+TEST_F(EntryPoints, ReportBuildErrorsInInputOrder) {
+  SpirvTools tools(SPV_ENV_UNIVERSAL_1_2);
+  spvtest::Binaries binaries(2);
+  ASSERT_TRUE(tools.Assemble("%1 = OpTypeInt 32 0", &binaries[0]));
+  ASSERT_TRUE(tools.Assemble("%1 = OpTypeFloat 32", &binaries[1]));
+  // Drop the last operand of each type, so that neither module builds.
+  for (spvtest::Binary& binary : binaries) binary.pop_back();
+
+  LinkerOptions options;
+  options.SetNumThreads(2);
+  spvtest::Binary linked_binary;
+  EXPECT_EQ(SPV_ERROR_INVALID_BINARY, Link(binaries, &linked_binary, options));
+  const std::string message = GetErrorMessage();
+  const size_t int_error = message.find("decoding OpTypeInt");
+  const size_t float_error = message.find("decoding OpTypeFloat");
+  const size_t link_error = message.find("Failed to build a module out of 0.");
+  ASSERT_NE(std::string::npos, int_error);
+  ASSERT_NE(std::string::npos, float_error);
+  ASSERT_NE(std::string::npos, link_error);
+  EXPECT_LT(int_error, float_error);
+  EXPECT_LT(float_error, link_error);
+}
+
 }  // namespace
 }  // namespace spvtools
@@ -0,0 +1,110 @@
+// Copyright (c) 2019 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <string>
+#include <vector>
+
+#include "gmock/gmock.h"
+#include "test/link/linker_fixture.h"
+
+namespace spvtools {
+namespace {
+
+using LinkCacheTest = spvtest::LinkerTest;
+
+const std::string kImportBody = R"(
+OpCapability Linkage
+OpDecorate %1 LinkageAttributes "foo" Import
+%2 = OpTypeFloat 32
+%3 = OpTypePointer Private %2
+%1 = OpVariable %3 Private
+)";
+
+std::string ExportBody(const std::string& value) {
+  return R"(
+OpCapability Linkage
+OpDecorate %1 LinkageAttributes "foo" Export
+%2 = OpTypeFloat 32
+%3 = OpTypePointer Private %2
+%4 = OpConstant %2 )" +
+         value + R"(
+%1 = OpVariable %3 Private %4
+)";
+}
+
+TEST_F(LinkCacheTest, RelinkGivesTheSameResult) {
+  LinkCache cache;
+  LinkerOptions options;
+  options.SetCache(&cache);
+
+  std::vector<std::string> bodies = {kImportBody, ExportBody("1")};
+  spvtest::Binary uncached_binary;
+  ASSERT_EQ(SPV_SUCCESS, AssembleAndLink(bodies, &uncached_binary));
+
+  spvtest::Binary first_binary;
+  ASSERT_EQ(SPV_SUCCESS, AssembleAndLink(bodies, &first_binary, options));
+  EXPECT_EQ(2u, cache.size());
+  EXPECT_EQ(uncached_binary, first_binary);
+
+  spvtest::Binary second_binary;
+  ASSERT_EQ(SPV_SUCCESS, AssembleAndLink(bodies, &second_binary, options));
+  EXPECT_EQ(2u, cache.size());
+  EXPECT_EQ(uncached_binary, second_binary);
+}
+
+TEST_F(LinkCacheTest, RelinkAfterChangingAModule) {
+  LinkCache cache;
+  LinkerOptions options;
+  options.SetCache(&cache);
+
+  spvtest::Binary linked_binary;
+  ASSERT_EQ(SPV_SUCCESS, AssembleAndLink({kImportBody, ExportBody("1")},
+                                         &linked_binary, options));
+
+  // The module which was changed replaces the old one in the cache.
+  std::vector<std::string> bodies = {kImportBody, ExportBody("2")};
+  spvtest::Binary uncached_binary;
+  ASSERT_EQ(SPV_SUCCESS, AssembleAndLink(bodies, &uncached_binary));
+  ASSERT_EQ(SPV_SUCCESS, AssembleAndLink(bodies, &linked_binary, options));
+  EXPECT_EQ(2u, cache.size());
+  EXPECT_EQ(uncached_binary, linked_binary);
+
+  cache.Clear();
+  EXPECT_EQ(0u, cache.size());
+}
+
+TEST_F(LinkCacheTest, SameModuleTwice) {
+  const std::string body = R"(
+%1 = OpTypeFloat 32
+%2 = OpTypePointer Private %1
+%3 = OpVariable %2 Private
+)";
+
+  LinkCache cache;
+  LinkerOptions options;
+  options.SetCache(&cache);
+
+  spvtest::Binary uncached_binary;
+  ASSERT_EQ(SPV_SUCCESS, AssembleAndLink({body, body}, &uncached_binary));
+  for (int i = 0; i < 2; ++i) {
+    spvtest::Binary linked_binary;
+    ASSERT_EQ(SPV_SUCCESS,
+              AssembleAndLink({body, body}, &linked_binary, options));
+    EXPECT_EQ(uncached_binary, linked_binary);
+    EXPECT_EQ(2u, cache.size());
+  }
+}
+
+}  // namespace
+}  // namespace spvtools
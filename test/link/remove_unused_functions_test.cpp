@@ -0,0 +1,115 @@
+// Copyright (c) 2019 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <string>
+
+#include "gmock/gmock.h"
+#include "test/link/linker_fixture.h"
+
+namespace spvtools {
+namespace {
+
+using ::testing::ContainsRegex;
+using ::testing::Not;
+
+using RemoveUnusedFunctions = spvtest::LinkerTest;
+
+const std::string kMainBody = R"(
+OpCapability Linkage
+OpCapability Shader
+OpMemoryModel Logical GLSL450
+OpEntryPoint GLCompute %main "main"
+OpName %main "main"
+OpDecorate %foo LinkageAttributes "foo" Import
+%void = OpTypeVoid
+%fn = OpTypeFunction %void
+%foo = OpFunction %void None %fn
+OpFunctionEnd
+%main = OpFunction %void None %fn
+%1 = OpLabel
+%2 = OpFunctionCall %void %foo
+OpReturn
+OpFunctionEnd
+)";
+
+const std::string kLibraryBody = R"(
+OpCapability Linkage
+OpCapability Shader
+OpMemoryModel Logical GLSL450
+OpName %foo "foo"
+OpName %bar "bar"
+OpDecorate %foo LinkageAttributes "foo" Export
+OpDecorate %bar LinkageAttributes "bar" Export
+%void = OpTypeVoid
+%fn = OpTypeFunction %void
+%foo = OpFunction %void None %fn
+%1 = OpLabel
+OpReturn
+OpFunctionEnd
+%bar = OpFunction %void None %fn
+%2 = OpLabel
+OpReturn
+OpFunctionEnd
+)";
+
+TEST_F(RemoveUnusedFunctions, Executable) {
+  LinkerOptions options;
+  options.SetRemoveUnusedFunctions(true);
+
+  spvtest::Binary linked_binary;
+  ASSERT_EQ(SPV_SUCCESS, AssembleAndLink({kMainBody, kLibraryBody},
+                                         &linked_binary, options))
+      << GetErrorMessage();
+
+  std::string res_body;
+  SetDisassembleOptions(SPV_BINARY_TO_TEXT_OPTION_NO_HEADER);
+  ASSERT_EQ(SPV_SUCCESS, Disassemble(linked_binary, &res_body))
+      << GetErrorMessage();
+  EXPECT_THAT(res_body, ContainsRegex("OpName %[0-9]+ \"main\""));
+  EXPECT_THAT(res_body, ContainsRegex("OpName %[0-9]+ \"foo\""));
+  EXPECT_THAT(res_body, Not(ContainsRegex("OpName %[0-9]+ \"bar\"")));
+}
+
+TEST_F(RemoveUnusedFunctions, LibraryKeepsExports) {
+  LinkerOptions options;
+  options.SetRemoveUnusedFunctions(true);
+  options.SetCreateLibrary(true);
+
+  spvtest::Binary linked_binary;
+  ASSERT_EQ(SPV_SUCCESS, AssembleAndLink({kMainBody, kLibraryBody},
+                                         &linked_binary, options))
+      << GetErrorMessage();
+
+  std::string res_body;
+  SetDisassembleOptions(SPV_BINARY_TO_TEXT_OPTION_NO_HEADER);
+  ASSERT_EQ(SPV_SUCCESS, Disassemble(linked_binary, &res_body))
+      << GetErrorMessage();
+  EXPECT_THAT(res_body, ContainsRegex("OpName %[0-9]+ \"bar\""));
+}
+
+TEST_F(RemoveUnusedFunctions, KeptByDefault) {
+  spvtest::Binary linked_binary;
+  ASSERT_EQ(SPV_SUCCESS,
+            AssembleAndLink({kMainBody, kLibraryBody}, &linked_binary))
+      << GetErrorMessage();
+
+  std::string res_body;
+  SetDisassembleOptions(SPV_BINARY_TO_TEXT_OPTION_NO_HEADER);
+  ASSERT_EQ(SPV_SUCCESS, Disassemble(linked_binary, &res_body))
+      << GetErrorMessage();
+  EXPECT_THAT(res_body, ContainsRegex("OpName %[0-9]+ \"bar\""));
+}
+
+}  // namespace
+}  // namespace spvtools
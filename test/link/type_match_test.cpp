@@ -12,6 +12,8 @@
 // See the License for the specific language governing permissions and
 // limitations under the License.
 
+#include <string>
+
 #include "gmock/gmock.h"
 #include "test/link/linker_fixture.h"
 
@@ -144,5 +146,44 @@ MatchFp2(Struct, Float)
 MatchFp2(Function, Float)
 // clang-format on
 
+TEST_F(TypeMatch, SameTypesAndConstantsAreMergedOnce) {
+  const std::string body1 = R"(
+OpName %float "float1"
+%float = OpTypeFloat 32
+%v4float = OpTypeVector %float 4
+%float_1 = OpConstant %float 1
+%ptr = OpTypePointer Private %v4float
+%var1 = OpVariable %ptr Private
+)";
+  const std::string body2 = R"(
+OpName %float "float2"
+%float = OpTypeFloat 32
+%float_1 = OpConstant %float 1
+%v4float = OpTypeVector %float 4
+%ptr = OpTypePointer Private %v4float
+%var2 = OpVariable %ptr Private
+)";
+
+  spvtest::Binary linked_binary;
+  ASSERT_EQ(SPV_SUCCESS, AssembleAndLink({body1, body2}, &linked_binary))
+      << GetErrorMessage();
+
+  const std::string expected_res =
+      R"(OpName %1 "float1"
+OpModuleProcessed "Linked by SPIR-V Tools Linker"
+%1 = OpTypeFloat 32
+%2 = OpTypeVector %1 4
+%3 = OpConstant %1 1
+%4 = OpTypePointer Private %2
+%5 = OpVariable %4 Private
+%6 = OpVariable %4 Private
+)";
+  std::string res_body;
+  SetDisassembleOptions(SPV_BINARY_TO_TEXT_OPTION_NO_HEADER);
+  ASSERT_EQ(SPV_SUCCESS, Disassemble(linked_binary, &res_body))
+      << GetErrorMessage();
+  EXPECT_EQ(expected_res, res_body);
+}
+
 }  // namespace
 }  // namespace spvtools
@@ -0,0 +1,65 @@
+// Copyright (c) 2019 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "source/opcode.h"
+#include "test/unit_spirv.h"
+
+namespace spvtools {
+namespace {
+
+TEST(OpcodeProperties, Constants) {
+  EXPECT_TRUE(spvOpcodeIsConstant(SpvOpConstant));
+  EXPECT_TRUE(spvOpcodeIsConstant(SpvOpSpecConstantOp));
+  EXPECT_FALSE(spvOpcodeIsConstant(SpvOpUndef));
+  EXPECT_TRUE(spvOpcodeIsConstantOrUndef(SpvOpUndef));
+  EXPECT_TRUE(spvOpcodeIsConstantOrUndef(SpvOpConstantNull));
+  EXPECT_TRUE(spvOpcodeIsScalarSpecConstant(SpvOpSpecConstant));
+  EXPECT_FALSE(spvOpcodeIsScalarSpecConstant(SpvOpSpecConstantComposite));
+}
+
+TEST(OpcodeProperties, Types) {
+  EXPECT_TRUE(spvOpcodeGeneratesType(SpvOpTypeCooperativeMatrixNV));
+  EXPECT_FALSE(spvOpcodeGeneratesType(SpvOpTypeForwardPointer));
+  EXPECT_TRUE(spvOpcodeIsBaseOpaqueType(SpvOpTypeForwardPointer));
+  EXPECT_TRUE(spvOpcodeIsComposite(SpvOpTypeStruct));
+  EXPECT_FALSE(spvOpcodeIsScalarType(SpvOpTypeVector));
+}
+
+TEST(OpcodeProperties, Terminators) {
+  EXPECT_TRUE(spvOpcodeIsBranch(SpvOpSwitch));
+  EXPECT_FALSE(spvOpcodeIsReturn(SpvOpKill));
+  EXPECT_TRUE(spvOpcodeIsReturnOrAbort(SpvOpKill));
+  EXPECT_TRUE(spvOpcodeIsBlockTerminator(SpvOpBranchConditional));
+  EXPECT_TRUE(spvOpcodeIsBlockTerminator(SpvOpReturnValue));
+  EXPECT_TRUE(spvOpcodeIsBlockTerminator(SpvOpUnreachable));
+  EXPECT_FALSE(spvOpcodeIsBlockTerminator(SpvOpSelectionMerge));
+}
+
+TEST(OpcodeProperties, Atomics) {
+  EXPECT_TRUE(spvOpcodeIsAtomicWithLoad(SpvOpAtomicIAdd));
+  EXPECT_FALSE(spvOpcodeIsAtomicWithLoad(SpvOpAtomicStore));
+  EXPECT_TRUE(spvOpcodeIsAtomicOp(SpvOpAtomicStore));
+  EXPECT_TRUE(spvOpcodeIsAtomicOp(SpvOpAtomicFlagTestAndSet));
+  EXPECT_FALSE(spvOpcodeIsAtomicOp(SpvOpLoad));
+}
+
+TEST(OpcodeProperties, OpcodesWithoutProperties) {
+  EXPECT_FALSE(spvOpcodeIsScalarizable(SpvOpNop));
+  EXPECT_FALSE(spvOpcodeIsDebug(SpvOpNop));
+  // An opcode past the end of all the lists.
+  EXPECT_FALSE(spvOpcodeIsBlockTerminator(static_cast<SpvOp>(0xFFFF)));
+}
+
+}  // namespace
+}  // namespace spvtools
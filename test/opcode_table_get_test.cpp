@@ -32,6 +32,35 @@ TEST_P(GetTargetOpcodeTableGetTest, InvalidPointerTable) {
   ASSERT_EQ(SPV_ERROR_INVALID_POINTER, spvOpcodeTableGet(nullptr, GetParam()));
 }
 
+TEST_P(GetTargetOpcodeTableGetTest, NameLookupFindsFirstEntryWithName) {
+  spv_opcode_table table;
+  ASSERT_EQ(SPV_SUCCESS, spvOpcodeTableGet(&table, GetParam()));
+  for (uint32_t i = 0; i < table->count; ++i) {
+    const char* name = table->entries[i].name;
+    spv_opcode_desc entry = nullptr;
+    if (SPV_SUCCESS ==
+        spvOpcodeTableNameLookup(GetParam(), table, name, &entry)) {
+      EXPECT_STREQ(name, entry->name);
+      EXPECT_LE(entry, &table->entries[i]) << name;
+    }
+  }
+}
+
+TEST_P(GetTargetOpcodeTableGetTest, NameLookupRejectsPartialNames) {
+  spv_opcode_table table;
+  ASSERT_EQ(SPV_SUCCESS, spvOpcodeTableGet(&table, GetParam()));
+  spv_opcode_desc entry = nullptr;
+  EXPECT_EQ(SPV_SUCCESS,
+            spvOpcodeTableNameLookup(GetParam(), table, "Capability", &entry));
+  EXPECT_EQ(SpvOpCapability, entry->opcode);
+  EXPECT_EQ(SPV_ERROR_INVALID_LOOKUP,
+            spvOpcodeTableNameLookup(GetParam(), table, "Capabilit", &entry));
+  EXPECT_EQ(SPV_ERROR_INVALID_LOOKUP,
+            spvOpcodeTableNameLookup(GetParam(), table, "Capabilityy", &entry));
+  EXPECT_EQ(SPV_ERROR_INVALID_LOOKUP,
+            spvOpcodeTableNameLookup(GetParam(), table, "", &entry));
+}
+
 INSTANTIATE_TEST_SUITE_P(OpcodeTableGet, GetTargetOpcodeTableGetTest,
                          ValuesIn(spvtest::AllTargetEnvironments()));
 
@@ -12,6 +12,7 @@
 // See the License for the specific language governing permissions and
 // limitations under the License.
 
+#include <cstring>
 #include <vector>
 
 #include "test/unit_spirv.h"
@@ -38,6 +39,43 @@ INSTANTIATE_TEST_SUITE_P(OperandTableGet, GetTargetTest,
                              SPV_ENV_UNIVERSAL_1_0, SPV_ENV_UNIVERSAL_1_1,
                              SPV_ENV_VULKAN_1_0}));
 
+TEST(OperandTableNameLookup, FindsFirstEntryWithName) {
+  spv_operand_table table;
+  ASSERT_EQ(SPV_SUCCESS, spvOperandTableGet(&table, SPV_ENV_UNIVERSAL_1_5));
+  for (uint32_t i = 0; i < table->count; ++i) {
+    const auto& group = table->types[i];
+    for (uint32_t j = 0; j < group.count; ++j) {
+      const char* name = group.entries[j].name;
+      spv_operand_desc entry = nullptr;
+      if (SPV_SUCCESS == spvOperandTableNameLookup(SPV_ENV_UNIVERSAL_1_5,
+                                                   table, group.type, name,
+                                                   strlen(name), &entry)) {
+        EXPECT_STREQ(name, entry->name);
+        EXPECT_LE(entry, &group.entries[j]) << name;
+      }
+    }
+  }
+}
+
+TEST(OperandTableNameLookup, UsesOnlyGivenLength) {
+  spv_operand_table table;
+  ASSERT_EQ(SPV_SUCCESS, spvOperandTableGet(&table, SPV_ENV_UNIVERSAL_1_0));
+  spv_operand_desc entry = nullptr;
+  const char* names = "ShaderFoo";
+  EXPECT_EQ(SPV_SUCCESS, spvOperandTableNameLookup(
+                             SPV_ENV_UNIVERSAL_1_0, table,
+                             SPV_OPERAND_TYPE_CAPABILITY, names, 6, &entry));
+  EXPECT_EQ(uint32_t(SpvCapabilityShader), entry->value);
+  EXPECT_EQ(SPV_ERROR_INVALID_LOOKUP,
+            spvOperandTableNameLookup(SPV_ENV_UNIVERSAL_1_0, table,
+                                      SPV_OPERAND_TYPE_CAPABILITY, names, 5,
+                                      &entry));
+  EXPECT_EQ(SPV_ERROR_INVALID_LOOKUP,
+            spvOperandTableNameLookup(SPV_ENV_UNIVERSAL_1_0, table,
+                                      SPV_OPERAND_TYPE_CAPABILITY, names, 9,
+                                      &entry));
+}
+
 TEST(OperandString, AllAreDefinedExceptVariable) {
   // None has no string, so don't test it.
   EXPECT_EQ(0u, SPV_OPERAND_TYPE_NONE);
@@ -13,9 +13,11 @@
 // See the License for the specific language governing permissions and
 // limitations under the License.
 
+#include <memory>
 #include <string>
 #include <vector>
 
+#include "source/opt/build_module.h"
 #include "test/opt/assembly_builder.h"
 #include "test/opt/pass_fixture.h"
 #include "test/opt/pass_utils.h"
@@ -6767,6 +6769,129 @@ OpFunctionEnd
 //    Check that function calls inhibit optimization
 //    Others?
 
+// Returns the context holding |text| after running ADCE on up to
+// |num_threads| threads.
+std::unique_ptr<IRContext> RunAggressiveDCE(const std::string& text,
+                                            uint32_t num_threads) {
+  std::unique_ptr<IRContext> context =
+      BuildModule(SPV_ENV_UNIVERSAL_1_3, nullptr, text,
+                  SPV_TEXT_TO_BINARY_OPTION_PRESERVE_NUMERIC_IDS);
+  context->set_num_threads(num_threads);
+  AggressiveDCEPass pass;
+  pass.Run(context.get());
+  return context;
+}
+
+std::vector<uint32_t> ToBinary(IRContext* context) {
+  std::vector<uint32_t> binary;
+  context->module()->ToBinary(&binary, /* skip_nop = */ false);
+  return binary;
+}
+
+const char kTwoEntryPoints[] = R"(
+OpCapability Shader
+OpMemoryModel Logical GLSL450
+OpEntryPoint Fragment %main1 "main1" %out
+OpEntryPoint Fragment %main2 "main2" %out
+OpExecutionMode %main1 OriginUpperLeft
+OpExecutionMode %main2 OriginUpperLeft
+%void = OpTypeVoid
+%void_fn = OpTypeFunction %void
+%float = OpTypeFloat 32
+%float_fn = OpTypeFunction %float
+%bool = OpTypeBool
+%true = OpConstantTrue %bool
+%float_1 = OpConstant %float 1
+%float_2 = OpConstant %float 2
+%ptr_out = OpTypePointer Output %float
+%ptr_func = OpTypePointer Function %float
+%ptr_priv = OpTypePointer Private %float
+%out = OpVariable %ptr_out Output
+%priv = OpVariable %ptr_priv Private
+%helper = OpFunction %float None %float_fn
+%h_entry = OpLabel
+%dead_var = OpVariable %ptr_func Function
+OpStore %dead_var %float_2
+%dead_add = OpFAdd %float %float_1 %float_2
+OpReturnValue %float_1
+OpFunctionEnd
+%main1 = OpFunction %void None %void_fn
+%m1_entry = OpLabel
+%call = OpFunctionCall %float %helper
+%dead_mul = OpFMul %float %call %float_2
+OpStore %out %call
+OpReturn
+OpFunctionEnd
+%main2 = OpFunction %void None %void_fn
+%m2_entry = OpLabel
+OpSelectionMerge %m2_merge None
+OpBranchConditional %true %m2_then %m2_merge
+%m2_then = OpLabel
+%dead_sub = OpFSub %float %float_2 %float_1
+OpBranch %m2_merge
+%m2_merge = OpLabel
+OpStore %out %float_2
+OpReturn
+OpFunctionEnd
+)";
+
+TEST(AggressiveDCEThreadsTest, ThreadsGiveTheSameResult) {
+  std::unique_ptr<IRContext> serial = RunAggressiveDCE(kTwoEntryPoints, 1);
+  std::unique_ptr<IRContext> parallel = RunAggressiveDCE(kTwoEntryPoints, 4);
+  EXPECT_EQ(ToBinary(serial.get()), ToBinary(parallel.get()));
+
+  parallel->module()->ForEachInst([](const Instruction* inst) {
+    EXPECT_NE(SpvOpFAdd, inst->opcode());
+    EXPECT_NE(SpvOpFMul, inst->opcode());
+    EXPECT_NE(SpvOpFSub, inst->opcode());
+    EXPECT_NE(SpvOpSelectionMerge, inst->opcode());
+    if (inst->opcode() == SpvOpVariable) {
+      EXPECT_NE(static_cast<uint32_t>(SpvStorageClassFunction),
+                inst->GetSingleWordInOperand(0));
+    }
+  });
+}
+
+TEST(AggressiveDCEThreadsTest, DecoratedLocalIds) {
+  // The workers query the decorations of the ids of each function at once.
+  std::string text = kTwoEntryPoints;
+  const std::string mode = "OpExecutionMode %main2 OriginUpperLeft\n";
+  text.replace(text.find(mode), mode.size(),
+               mode +
+                   "OpDecorate %call RelaxedPrecision\n"
+                   "OpDecorate %dead_add RelaxedPrecision\n"
+                   "OpDecorate %dead_mul RelaxedPrecision\n"
+                   "OpDecorate %dead_sub RelaxedPrecision\n");
+
+  std::unique_ptr<IRContext> serial = RunAggressiveDCE(text, 1);
+  std::unique_ptr<IRContext> parallel = RunAggressiveDCE(text, 4);
+  EXPECT_EQ(ToBinary(serial.get()), ToBinary(parallel.get()));
+
+  // Only the decoration of the live call is left.
+  uint32_t num_decorations = 0;
+  for (const Instruction& inst : parallel->annotations()) {
+    EXPECT_EQ(SpvOpDecorate, inst.opcode());
+    ++num_decorations;
+  }
+  EXPECT_EQ(1u, num_decorations);
+}
+
+TEST(AggressiveDCEThreadsTest, FunctionsDependingOnEachOther) {
+  // %main2 has no call, so it treats %priv as a local variable, and marks the
+  // store to it in %helper as live.
+  std::string text = kTwoEntryPoints;
+  const std::string dead_add = "%dead_add = OpFAdd %float %float_1 %float_2\n";
+  text.replace(text.find(dead_add), dead_add.size(),
+               dead_add + "OpStore %priv %dead_add\n");
+  const std::string store = "OpStore %out %float_2\n";
+  text.replace(text.find(store), store.size(),
+               "%load = OpLoad %float %priv\nOpStore %out %load\n");
+
+  std::unique_ptr<IRContext> serial = RunAggressiveDCE(text, 1);
+  std::unique_ptr<IRContext> parallel = RunAggressiveDCE(text, 4);
+  EXPECT_EQ(ToBinary(serial.get()), ToBinary(parallel.get()));
+}
+
 }  // namespace
 }  // namespace opt
 }  // namespace spvtools
@@ -0,0 +1,220 @@
+// Copyright (c) 2019 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "source/opt/binary_filter.h"
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "gmock/gmock.h"
+#include "source/opt/build_module.h"
+#include "source/opt/null_pass.h"
+#include "source/opt/pass_manager.h"
+#include "source/opt/strip_atomic_counter_memory_pass.h"
+#include "source/opt/strip_debug_info_pass.h"
+#include "source/opt/strip_reflect_info_pass.h"
+#include "spirv-tools/libspirv.hpp"
+
+namespace spvtools {
+namespace opt {
+namespace {
+
+const spv_target_env kEnv = SPV_ENV_UNIVERSAL_1_3;
+
+std::vector<uint32_t> Assemble(const std::string& text) {
+  SpirvTools tools(kEnv);
+  std::vector<uint32_t> binary;
+  EXPECT_TRUE(tools.Assemble(text, &binary));
+  return binary;
+}
+
+// Runs a pass of type |T| on the IR of |binary|, as the Optimizer does.
+template <typename T>
+std::vector<uint32_t> RunOnIR(const std::vector<uint32_t>& binary) {
+  std::unique_ptr<IRContext> context =
+      BuildModule(kEnv, nullptr, binary.data(), binary.size());
+  EXPECT_NE(context, nullptr);
+  PassManager manager;
+  manager.AddPass<T>();
+  EXPECT_NE(manager.Run(context.get()), Pass::Status::Failure);
+  std::vector<uint32_t> result;
+  context->module()->ToBinary(&result, /* skip_nop = */ true);
+  return result;
+}
+
+// Runs a pass of type |T| on |binary| as a filter.  Returns false if it
+// cannot be.
+template <typename T>
+bool RunAsFilter(const std::vector<uint32_t>& binary,
+                 std::vector<uint32_t>* result) {
+  PassManager manager;
+  manager.AddPass<T>();
+  return manager.RunAsBinaryFilters(kEnv, binary.data(), binary.size(),
+                                    result);
+}
+
+// Expects the pass of type |T| to give the same result on the binary of
+// |text| as a filter as it does on the IR.
+template <typename T>
+void ExpectSameAsIR(const std::string& text) {
+  const std::vector<uint32_t> binary = Assemble(text);
+  std::vector<uint32_t> filtered;
+  ASSERT_TRUE(RunAsFilter<T>(binary, &filtered));
+  EXPECT_EQ(filtered, RunOnIR<T>(binary));
+}
+
+const char kDebugModule[] = R"(
+OpCapability Shader
+OpExtension "SPV_GOOGLE_decorate_string"
+OpExtension "SPV_GOOGLE_hlsl_functionality1"
+OpMemoryModel Logical GLSL450
+OpEntryPoint Fragment %main "main"
+OpExecutionMode %main OriginUpperLeft
+%file = OpString "file.hlsl"
+OpSource HLSL 500 %file
+OpName %main "main"
+OpName %var "var"
+OpModuleProcessed "flags"
+OpDecorateStringGOOGLE %var HlslSemanticGOOGLE "SV_TARGET"
+OpDecorate %var Location 0
+%void = OpTypeVoid
+%float = OpTypeFloat 32
+%ptr = OpTypePointer Output %float
+%var = OpVariable %ptr Output
+%float_1 = OpConstant %float 1
+%void_fn = OpTypeFunction %void
+OpLine %file 2 0
+%main = OpFunction %void None %void_fn
+%entry = OpLabel
+OpLine %file 3 0
+OpStore %var %float_1
+OpNop
+OpNoLine
+OpReturn
+OpFunctionEnd
+)";
+
+TEST(BinaryFilterTest, StripDebugMatchesIR) {
+  ExpectSameAsIR<StripDebugInfoPass>(kDebugModule);
+}
+
+TEST(BinaryFilterTest, StripReflectMatchesIR) {
+  ExpectSameAsIR<StripReflectInfoPass>(kDebugModule);
+}
+
+TEST(BinaryFilterTest, StripDebugKeepsStringsOfNonSemanticInstructions) {
+  ExpectSameAsIR<StripDebugInfoPass>(R"(
+OpCapability Shader
+OpExtension "SPV_KHR_non_semantic_info"
+%ns = OpExtInstImport "NonSemantic.Test"
+OpMemoryModel Logical GLSL450
+OpEntryPoint Fragment %main "main"
+OpExecutionMode %main OriginUpperLeft
+%used = OpString "used"
+%unused = OpString "unused"
+OpName %main "main"
+%void = OpTypeVoid
+%void_fn = OpTypeFunction %void
+%info = OpExtInst %void %ns 1 %used
+%main = OpFunction %void None %void_fn
+%entry = OpLabel
+OpReturn
+OpFunctionEnd
+)");
+}
+
+TEST(BinaryFilterTest, StripReflectRemovesNonSemanticInstructions) {
+  ExpectSameAsIR<StripReflectInfoPass>(R"(
+OpCapability Shader
+OpExtension "SPV_KHR_non_semantic_info"
+%ns = OpExtInstImport "NonSemantic.Test"
+OpMemoryModel Logical GLSL450
+OpEntryPoint Fragment %main "main"
+OpExecutionMode %main OriginUpperLeft
+%str = OpString "str"
+%void = OpTypeVoid
+%void_fn = OpTypeFunction %void
+%info = OpExtInst %void %ns 1 %str
+%main = OpFunction %void None %void_fn
+%entry = OpLabel
+%more = OpExtInst %void %ns 2 %info
+OpReturn
+OpFunctionEnd
+)");
+}
+
+TEST(BinaryFilterTest, UnchangedModuleKeepsItsIdBound) {
+  const std::vector<uint32_t> binary = Assemble(R"(
+OpCapability Shader
+OpMemoryModel Logical GLSL450
+OpEntryPoint Fragment %main "main"
+OpExecutionMode %main OriginUpperLeft
+%void = OpTypeVoid
+%void_fn = OpTypeFunction %void
+%main = OpFunction %void None %void_fn
+%entry = OpLabel
+OpReturn
+OpFunctionEnd
+)");
+  std::vector<uint32_t> filtered;
+  ASSERT_TRUE(RunAsFilter<StripDebugInfoPass>(binary, &filtered));
+  EXPECT_EQ(filtered, binary);
+}
+
+const char kAtomicModule[] = R"(
+OpCapability Shader
+OpMemoryModel Logical GLSL450
+OpEntryPoint GLCompute %main "main"
+OpExecutionMode %main LocalSize 1 1 1
+%void = OpTypeVoid
+%uint = OpTypeInt 32 0
+%uint_1 = OpConstant %uint 1
+%semantics = OpConstant %uint SEMANTICS
+%void_fn = OpTypeFunction %void
+%main = OpFunction %void None %void_fn
+%entry = OpLabel
+OpMemoryBarrier %uint_1 %semantics
+OpReturn
+OpFunctionEnd
+)";
+
+TEST(BinaryFilterTest, StripAtomicCounterMemoryCopiesModuleWithoutTheBit) {
+  std::string text = kAtomicModule;
+  text.replace(text.find("SEMANTICS"), 9, "0x40");
+  ExpectSameAsIR<StripAtomicCounterMemoryPass>(text);
+}
+
+TEST(BinaryFilterTest, StripAtomicCounterMemoryNeedsIRToStripTheBit) {
+  std::string text = kAtomicModule;
+  text.replace(text.find("SEMANTICS"), 9, "0x440");
+  std::vector<uint32_t> filtered;
+  EXPECT_FALSE(
+      RunAsFilter<StripAtomicCounterMemoryPass>(Assemble(text), &filtered));
+}
+
+TEST(BinaryFilterTest, PassesWithoutFiltersRunOnIR) {
+  const std::vector<uint32_t> binary = Assemble(kDebugModule);
+  PassManager manager;
+  manager.AddPass<StripDebugInfoPass>();
+  manager.AddPass<NullPass>();
+  std::vector<uint32_t> filtered;
+  EXPECT_FALSE(manager.RunAsBinaryFilters(kEnv, binary.data(), binary.size(),
+                                          &filtered));
+  EXPECT_EQ(manager.NumPasses(), 2u);
+}
+
+}  // namespace
+}  // namespace opt
+}  // namespace spvtools
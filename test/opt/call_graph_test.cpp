@@ -0,0 +1,156 @@
+// Copyright (c) 2020 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "source/opt/call_graph.h"
+
+#include <memory>
+#include <vector>
+
+#include "gmock/gmock.h"
+#include "source/opt/build_module.h"
+#include "source/opt/ir_context.h"
+
+namespace spvtools {
+namespace opt {
+namespace {
+
+using ::testing::ElementsAre;
+using ::testing::IsEmpty;
+using ::testing::UnorderedElementsAre;
+
+// %10 calls %20 once and %30 twice, %20 and %30 call %40, and %40 and %50
+// call each other.
+const char kModule[] = R"(
+OpCapability Shader
+OpMemoryModel Logical GLSL450
+OpEntryPoint Fragment %10 "main"
+OpExecutionMode %10 OriginUpperLeft
+%1 = OpTypeVoid
+%2 = OpTypeFunction %1
+%10 = OpFunction %1 None %2
+%11 = OpLabel
+%12 = OpFunctionCall %1 %20
+%13 = OpFunctionCall %1 %30
+%14 = OpFunctionCall %1 %30
+OpReturn
+OpFunctionEnd
+%20 = OpFunction %1 None %2
+%21 = OpLabel
+%22 = OpFunctionCall %1 %40
+OpReturn
+OpFunctionEnd
+%30 = OpFunction %1 None %2
+%31 = OpLabel
+%32 = OpFunctionCall %1 %40
+OpReturn
+OpFunctionEnd
+%40 = OpFunction %1 None %2
+%41 = OpLabel
+%42 = OpFunctionCall %1 %50
+OpReturn
+OpFunctionEnd
+%50 = OpFunction %1 None %2
+%51 = OpLabel
+%52 = OpFunctionCall %1 %40
+OpReturn
+OpFunctionEnd
+)";
+
+const uint32_t kMain = 10;
+const uint32_t kA = 20;
+const uint32_t kB = 30;
+const uint32_t kC = 40;
+const uint32_t kD = 50;
+const uint32_t kCallAC = 22;
+const uint32_t kCallB1 = 13;
+const uint32_t kCallDC = 52;
+
+std::unique_ptr<IRContext> BuildCallGraphModule() {
+  return BuildModule(SPV_ENV_UNIVERSAL_1_1, nullptr, kModule,
+                     SPV_TEXT_TO_BINARY_OPTION_PRESERVE_NUMERIC_IDS);
+}
+
+TEST(CallGraphTest, CalleesAndCallers) {
+  std::unique_ptr<IRContext> context = BuildCallGraphModule();
+  ASSERT_NE(context, nullptr);
+  CallGraph* call_graph = context->GetCallGraph();
+
+  EXPECT_THAT(call_graph->Callees(kMain), ElementsAre(kA, kB));
+  EXPECT_EQ(call_graph->NumCalls(kMain, kB), 2u);
+  EXPECT_EQ(call_graph->NumCalls(kMain, kC), 0u);
+  EXPECT_THAT(call_graph->Callers(kC), UnorderedElementsAre(kA, kB, kD));
+  EXPECT_THAT(call_graph->Callers(kMain), IsEmpty());
+}
+
+TEST(CallGraphTest, ComponentsAreBottomUp) {
+  std::unique_ptr<IRContext> context = BuildCallGraphModule();
+  ASSERT_NE(context, nullptr);
+  CallGraph* call_graph = context->GetCallGraph();
+
+  EXPECT_THAT(call_graph->StronglyConnectedComponents(),
+              ElementsAre(ElementsAre(kC, kD), ElementsAre(kA),
+                          ElementsAre(kB), ElementsAre(kMain)));
+  EXPECT_THAT(call_graph->BottomUpOrder(), ElementsAre(kC, kD, kA, kB, kMain));
+  EXPECT_THAT(call_graph->TopDownOrder(), ElementsAre(kMain, kB, kA, kC, kD));
+  EXPECT_TRUE(call_graph->IsRecursive(kC));
+  EXPECT_TRUE(call_graph->IsRecursive(kD));
+  EXPECT_FALSE(call_graph->IsRecursive(kA));
+  EXPECT_FALSE(context->GetFunction(kMain)->IsRecursive());
+}
+
+TEST(CallGraphTest, KillingCallsUpdatesTheGraph) {
+  std::unique_ptr<IRContext> context = BuildCallGraphModule();
+  ASSERT_NE(context, nullptr);
+  CallGraph* call_graph = context->GetCallGraph();
+
+  context->KillInst(context->get_def_use_mgr()->GetDef(kCallB1));
+  EXPECT_TRUE(context->AreAnalysesValid(IRContext::kAnalysisCallGraph));
+  EXPECT_EQ(call_graph->NumCalls(kMain, kB), 1u);
+  EXPECT_THAT(call_graph->Callers(kB), ElementsAre(kMain));
+
+  context->KillInst(context->get_def_use_mgr()->GetDef(kCallDC));
+  EXPECT_THAT(call_graph->Callees(kD), IsEmpty());
+  EXPECT_FALSE(call_graph->IsRecursive(kC));
+  EXPECT_THAT(call_graph->BottomUpOrder(), ElementsAre(kD, kC, kA, kB, kMain));
+}
+
+TEST(CallGraphTest, UpdateFunctionRescansCalls) {
+  std::unique_ptr<IRContext> context = BuildCallGraphModule();
+  ASSERT_NE(context, nullptr);
+  CallGraph* call_graph = context->GetCallGraph();
+
+  // Make %20 call itself instead of %40, without telling the graph.
+  Instruction* call = context->get_def_use_mgr()->GetDef(kCallAC);
+  ASSERT_EQ(call->opcode(), SpvOpFunctionCall);
+  call->SetInOperand(0, {kA});
+  EXPECT_THAT(call_graph->Callees(kA), ElementsAre(kC));
+
+  call_graph->UpdateFunction(context->GetFunction(kA));
+  EXPECT_THAT(call_graph->Callees(kA), ElementsAre(kA));
+  EXPECT_THAT(call_graph->Callers(kC), UnorderedElementsAre(kB, kD));
+  EXPECT_TRUE(call_graph->IsRecursive(kA));
+}
+
+TEST(CallGraphTest, InvalidatedWithOtherAnalyses) {
+  std::unique_ptr<IRContext> context = BuildCallGraphModule();
+  ASSERT_NE(context, nullptr);
+  context->GetCallGraph();
+  EXPECT_TRUE(context->AreAnalysesValid(IRContext::kAnalysisCallGraph));
+  context->InvalidateAnalysesExceptFor(IRContext::kAnalysisNone);
+  EXPECT_FALSE(context->AreAnalysesValid(IRContext::kAnalysisCallGraph));
+}
+
+}  // namespace
+}  // namespace opt
+}  // namespace spvtools
@@ -12,10 +12,14 @@
 // See the License for the specific language governing permissions and
 // limitations under the License.
 
+#include <list>
 #include <string>
+#include <vector>
 
 #include "gmock/gmock.h"
 #include "gtest/gtest.h"
+#include "source/opt/block_merge_util.h"
+#include "source/opt/ir_builder.h"
 #include "source/opt/ir_context.h"
 #include "test/opt/pass_fixture.h"
 #include "test/opt/pass_utils.h"
@@ -25,6 +29,8 @@ namespace opt {
 namespace {
 
 using ::testing::ContainerEq;
+using ::testing::ElementsAre;
+using ::testing::UnorderedElementsAre;
 
 using CFGTest = PassTest<::testing::Test>;
 
@@ -200,6 +206,149 @@ OpFunctionEnd
                            ContainerEq(expected_result2)));
 }
 
+// Checks that the cached dominator and post-dominator trees of |function|
+// match trees built again from the CFG.
+void ExpectSameDominators(IRContext* context, Function* function) {
+  DominatorAnalysis* dominators = context->GetDominatorAnalysis(function);
+  PostDominatorAnalysis* post_dominators =
+      context->GetPostDominatorAnalysis(function);
+  DominatorAnalysis new_dominators;
+  new_dominators.InitializeTree(*context->cfg(), function);
+  PostDominatorAnalysis new_post_dominators;
+  new_post_dominators.InitializeTree(*context->cfg(), function);
+  for (BasicBlock& block : *function) {
+    EXPECT_EQ(new_dominators.ImmediateDominator(&block),
+              dominators->ImmediateDominator(&block));
+    EXPECT_EQ(new_post_dominators.ImmediateDominator(&block),
+              post_dominators->ImmediateDominator(&block));
+    for (BasicBlock& other : *function) {
+      EXPECT_EQ(new_dominators.Dominates(&block, &other),
+                dominators->Dominates(&block, &other));
+    }
+  }
+}
+
+TEST_F(CFGTest, SplitAndMergeBlocksKeepAnalyses) {
+  const std::string test = R"(
+OpCapability Shader
+%1 = OpExtInstImport "GLSL.std.450"
+OpMemoryModel Logical GLSL450
+OpEntryPoint Vertex %main "main"
+OpName %main "main"
+%bool = OpTypeBool
+%true = OpConstantTrue %bool
+%void = OpTypeVoid
+%4 = OpTypeFunction %void
+%main = OpFunction %void None %4
+%8 = OpLabel
+OpSelectionMerge %10 None
+OpBranchConditional %true %9 %10
+%9 = OpLabel
+OpBranch %10
+%10 = OpLabel
+OpReturn
+OpFunctionEnd
+)";
+
+  std::unique_ptr<IRContext> context =
+      BuildModule(SPV_ENV_UNIVERSAL_1_1, nullptr, test,
+                  SPV_TEXT_TO_BINARY_OPTION_PRESERVE_NUMERIC_IDS);
+  ASSERT_NE(nullptr, context);
+
+  CFG* cfg = context->cfg();
+  Function* function = &*context->module()->begin();
+  ExpectSameDominators(context.get(), function);
+
+  // Split %9 before its branch.
+  BasicBlock* block = cfg->block(9);
+  const uint32_t new_id = context->TakeNextId();
+  BasicBlock* new_block =
+      block->SplitBasicBlock(context.get(), new_id, block->begin());
+  InstructionBuilder builder(context.get(), block,
+                             IRContext::kAnalysisDefUse |
+                                 IRContext::kAnalysisInstrToBlockMapping);
+  builder.AddBranch(new_id);
+  context->UpdateAnalysesForSplit(block, new_block);
+
+  EXPECT_EQ(new_block, cfg->block(new_id));
+  EXPECT_THAT(cfg->preds(new_id), ElementsAre(9));
+  EXPECT_THAT(cfg->preds(10), UnorderedElementsAre(8, new_id));
+  ExpectSameDominators(context.get(), function);
+
+  // Merge the new block back into %9.
+  auto iter = function->begin();
+  while (iter->id() != 9) ++iter;
+  ASSERT_TRUE(blockmergeutil::CanMergeWithSuccessor(context.get(), &*iter));
+  blockmergeutil::MergeWithSuccessor(context.get(), function, iter);
+
+  EXPECT_THAT(cfg->preds(10), UnorderedElementsAre(8, 9));
+  EXPECT_EQ(nullptr, context->GetDominatorAnalysis(function)
+                         ->GetDomTree()
+                         .GetTreeNode(new_id));
+  ExpectSameDominators(context.get(), function);
+}
+
+TEST_F(CFGTest, CachedOrdersFollowEdgeChanges) {
+  const std::string test = R"(
+OpCapability Shader
+%1 = OpExtInstImport "GLSL.std.450"
+OpMemoryModel Logical GLSL450
+OpEntryPoint Vertex %main "main"
+OpName %main "main"
+%bool = OpTypeBool
+%true = OpConstantTrue %bool
+%void = OpTypeVoid
+%4 = OpTypeFunction %void
+%main = OpFunction %void None %4
+%8 = OpLabel
+OpSelectionMerge %10 None
+OpBranchConditional %true %9 %10
+%9 = OpLabel
+OpBranch %10
+%10 = OpLabel
+OpReturn
+OpFunctionEnd
+)";
+
+  std::unique_ptr<IRContext> context =
+      BuildModule(SPV_ENV_UNIVERSAL_1_1, nullptr, test,
+                  SPV_TEXT_TO_BINARY_OPTION_PRESERVE_NUMERIC_IDS);
+  ASSERT_NE(nullptr, context);
+
+  CFG* cfg = context->cfg();
+  Function* function = &*context->module()->begin();
+  BasicBlock* entry = &*function->begin();
+  auto post_order = [cfg, entry]() -> std::vector<uint32_t> {
+    std::vector<uint32_t> order;
+    cfg->ForEachBlockInPostOrder(
+        entry, [&order](BasicBlock* bb) { order.push_back(bb->id()); });
+    return order;
+  };
+  auto structured_order = [cfg, function]() -> std::vector<uint32_t> {
+    std::list<BasicBlock*> blocks;
+    cfg->ComputeStructuredOrder(function, &*function->begin(), &blocks);
+    std::vector<uint32_t> order;
+    for (BasicBlock* bb : blocks) order.push_back(bb->id());
+    return order;
+  };
+
+  // The second traversals come from the cache.
+  EXPECT_THAT(post_order(), ElementsAre(10, 9, 8));
+  EXPECT_THAT(post_order(), ElementsAre(10, 9, 8));
+  EXPECT_THAT(structured_order(), ElementsAre(8, 9, 10));
+  EXPECT_THAT(structured_order(), ElementsAre(8, 9, 10));
+
+  // Branch straight to the merge block, as dead branch elimination does.
+  cfg->RemoveSuccessorEdges(entry);
+  context->KillInst(entry->GetMergeInst());
+  entry->terminator()->SetOpcode(SpvOpBranch);
+  entry->terminator()->SetInOperands({{SPV_OPERAND_TYPE_ID, {10}}});
+  cfg->AddEdges(entry);
+
+  EXPECT_THAT(post_order(), ElementsAre(10, 8));
+  EXPECT_THAT(structured_order(), ElementsAre(8, 10));
+}
+
 }  // namespace
 }  // namespace opt
 }  // namespace spvtools
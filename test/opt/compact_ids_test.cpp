@@ -92,6 +92,71 @@ OpFunctionEnd
   SinglePassRunAndCheck<CompactIdsPass>(before, after, false, false);
 }
 
+TEST_F(CompactIdsTest, OrderByLocality) {
+  // The helper function uses the integer values, and the entry point the
+  // float values.  The void type goes with the entry point, which uses it the
+  // most, but it is placed before the function type of the helper.
+  const std::string before =
+      R"(OpCapability Shader
+OpMemoryModel Logical GLSL450
+OpEntryPoint GLCompute %50 "main"
+OpExecutionMode %50 LocalSize 1 1 1
+%1 = OpTypeVoid
+%2 = OpTypeFunction %1
+%3 = OpTypeInt 32 0
+%4 = OpTypeFloat 32
+%5 = OpTypePointer Function %4
+%6 = OpConstant %3 1
+%7 = OpConstant %4 1
+%8 = OpTypePointer Function %3
+%20 = OpFunction %1 None %2
+%21 = OpLabel
+%22 = OpVariable %8 Function
+OpStore %22 %6
+OpReturn
+OpFunctionEnd
+%50 = OpFunction %1 None %2
+%51 = OpLabel
+%52 = OpVariable %5 Function
+OpStore %52 %7
+%53 = OpFunctionCall %1 %20
+OpReturn
+OpFunctionEnd
+)";
+
+  const std::string after =
+      R"(OpCapability Shader
+OpMemoryModel Logical GLSL450
+OpEntryPoint GLCompute %12 "main"
+OpExecutionMode %12 LocalSize 1 1 1
+%1 = OpTypeVoid
+%2 = OpTypeFunction %1
+%3 = OpTypeInt 32 0
+%4 = OpConstant %3 1
+%5 = OpTypePointer Function %3
+%9 = OpTypeFloat 32
+%10 = OpTypePointer Function %9
+%11 = OpConstant %9 1
+%6 = OpFunction %1 None %2
+%7 = OpLabel
+%8 = OpVariable %5 Function
+OpStore %8 %4
+OpReturn
+OpFunctionEnd
+%12 = OpFunction %1 None %2
+%13 = OpLabel
+%14 = OpVariable %10 Function
+OpStore %14 %11
+%15 = OpFunctionCall %1 %6
+OpReturn
+OpFunctionEnd
+)";
+
+  SetAssembleOptions(SPV_TEXT_TO_BINARY_OPTION_PRESERVE_NUMERIC_IDS);
+  SetDisassembleOptions(SPV_BINARY_TO_TEXT_OPTION_NO_HEADER);
+  SinglePassRunAndCheck<CompactIdsPass>(before, after, false, true, true);
+}
+
 TEST(CompactIds, InstructionResultIsUpdated) {
   // For https://github.com/KhronosGroup/SPIRV-Tools/issues/827
   // In that bug, the compact Ids pass was directly updating the result Id
@@ -194,6 +259,25 @@ OpFunctionEnd
   EXPECT_THAT(disassembly, ::testing::Eq(expected));
 }
 
+TEST(CompactIds, UnusedBoundIsRemoved) {
+  const std::string input(R"(OpCapability Shader
+OpCapability Linkage
+OpMemoryModel Logical GLSL450
+%1 = OpTypeVoid
+%2 = OpTypeFloat 32
+)");
+
+  std::unique_ptr<IRContext> context =
+      BuildModule(SPV_ENV_UNIVERSAL_1_0, nullptr, input,
+                  SPV_TEXT_TO_BINARY_OPTION_PRESERVE_NUMERIC_IDS);
+  ASSERT_NE(nullptr, context);
+  context->module()->SetIdBound(100);
+
+  CompactIdsPass pass;
+  EXPECT_EQ(Pass::Status::SuccessWithChange, pass.Run(context.get()));
+  EXPECT_EQ(3u, context->module()->IdBound());
+}
+
 // Test context consistency check after invalidating
 // CFG and others by compact IDs Pass.
 // Uses a GLSL shader with named labels for variety
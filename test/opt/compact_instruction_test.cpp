@@ -0,0 +1,112 @@
+// Copyright (c) 2019 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "source/opt/compact_instruction.h"
+
+#include <memory>
+#include <vector>
+
+#include "gmock/gmock.h"
+#include "source/opt/build_module.h"
+
+namespace spvtools {
+namespace opt {
+namespace {
+
+using ::testing::ElementsAre;
+
+const char kModule[] = R"(
+OpCapability Shader
+OpCapability Linkage
+OpMemoryModel Logical GLSL450
+OpName %main "main"
+%void = OpTypeVoid
+%int = OpTypeInt 32 0
+%v4int = OpTypeVector %int 4
+%int_1 = OpConstant %int 1
+%int_2 = OpConstant %int 2
+%composite = OpConstantComposite %v4int %int_1 %int_2 %int_1 %int_2
+%void_fn = OpTypeFunction %void
+%main = OpFunction %void None %void_fn
+%entry = OpLabel
+OpReturn
+OpFunctionEnd
+)";
+
+std::unique_ptr<IRContext> BuildContext() {
+  return BuildModule(SPV_ENV_UNIVERSAL_1_1, nullptr, kModule);
+}
+
+TEST(CompactInstructionTest, ToBinaryMatchesInstruction) {
+  std::unique_ptr<IRContext> context = BuildContext();
+  context->module()->ForEachInst([](const Instruction* inst) {
+    std::vector<uint32_t> expected;
+    inst->ToBinaryWithoutAttachedDebugInsts(&expected);
+    std::vector<uint32_t> binary;
+    CompactInstruction compact(*inst);
+    compact.ToBinary(&binary);
+    EXPECT_EQ(expected, binary);
+    EXPECT_EQ(expected.size(), compact.NumWords());
+    EXPECT_EQ(inst->opcode(), compact.opcode());
+    EXPECT_EQ(inst->type_id(), compact.type_id());
+    EXPECT_EQ(inst->result_id(), compact.result_id());
+    EXPECT_EQ(inst->NumInOperands(), compact.NumInOperands());
+  });
+}
+
+TEST(CompactInstructionTest, DecodeRoundTrips) {
+  std::unique_ptr<IRContext> context = BuildContext();
+  context->module()->ForEachInst([&context](const Instruction* inst) {
+    std::unique_ptr<Instruction> decoded =
+        CompactInstruction(*inst).Decode(context.get());
+    EXPECT_EQ(inst->opcode(), decoded->opcode());
+    EXPECT_EQ(inst->type_id(), decoded->type_id());
+    EXPECT_EQ(inst->result_id(), decoded->result_id());
+    ASSERT_EQ(inst->NumOperands(), decoded->NumOperands());
+    for (uint32_t i = 0; i < inst->NumOperands(); ++i) {
+      EXPECT_EQ(inst->GetOperand(i), decoded->GetOperand(i));
+    }
+  });
+}
+
+TEST(CompactInstructionTest, SetInOperand) {
+  std::unique_ptr<IRContext> context = BuildContext();
+  // The ids are numbered in order of appearance, starting with %main.
+  Instruction* composite = context->get_def_use_mgr()->GetDef(7);
+  CompactInstruction compact(*composite);
+  EXPECT_EQ(6u, compact.GetSingleWordInOperand(1));
+
+  compact.SetInOperand(1, {5});
+  EXPECT_EQ(5u, compact.GetSingleWordInOperand(1));
+  EXPECT_EQ(5u, compact.GetSingleWordInOperand(2));
+
+  // A longer operand grows the instruction.
+  Instruction* name = &*context->module()->debug2_begin();
+  CompactInstruction compact_name(*name);
+  compact_name.SetInOperand(1, {0x64636261, 0x68676665, 0});
+  EXPECT_EQ(SPV_OPERAND_TYPE_LITERAL_STRING,
+            compact_name.GetInOperandType(1));
+  uint32_t num_words = 0;
+  const uint32_t* words = compact_name.GetInOperandWords(1, &num_words);
+  EXPECT_EQ(3u, num_words);
+  EXPECT_EQ(0x68676665u, words[1]);
+  std::vector<uint32_t> binary;
+  compact_name.ToBinary(&binary);
+  EXPECT_THAT(binary, ElementsAre((5u << 16) | SpvOpName, 1u, 0x64636261u,
+                                  0x68676665u, 0u));
+}
+
+}  // namespace
+}  // namespace opt
+}  // namespace spvtools
@@ -44,6 +44,22 @@ using GetSignExtendedValueTest =
 using GetZeroExtendedValueTest =
     ::testing::TestWithParam<GetZeroExtendedValueCase>;
 
+TEST_F(ConstantTest, CompositesWithTheSameComponentsAreEqual) {
+  Integer int_type(32, false);
+  Vector vec_type(&int_type, 3);
+  IntConstant zero(&int_type, {0});
+  IntConstant one(&int_type, {1});
+  VectorConstant first(&vec_type, {&zero, &one, &zero});
+  VectorConstant second(&vec_type, {&zero, &one, &zero});
+  VectorConstant third(&vec_type, {&zero, &zero, &one});
+
+  EXPECT_EQ(first.GetComponentsHash(), second.GetComponentsHash());
+  EXPECT_NE(first.GetComponentsHash(), third.GetComponentsHash());
+  EXPECT_EQ(ConstantHash()(&first), ConstantHash()(&second));
+  EXPECT_TRUE(ConstantEqual()(&first, &second));
+  EXPECT_FALSE(ConstantEqual()(&first, &third));
+}
+
 TEST_P(GetSignExtendedValueTest, Case) {
   Integer type(GetParam().width, GetParam().is_signed);
   IntConstant value(&type, GetParam().words);
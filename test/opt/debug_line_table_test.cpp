@@ -0,0 +1,105 @@
+// Copyright (c) 2019 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "source/opt/debug_line_table.h"
+
+#include <memory>
+#include <vector>
+
+#include "gmock/gmock.h"
+#include "source/opt/build_module.h"
+#include "spirv-tools/libspirv.hpp"
+
+namespace spvtools {
+namespace opt {
+namespace {
+
+using ::testing::ElementsAre;
+
+const DebugLine kLine1 = {SpvOpLine, 5, 1, 2};
+const DebugLine kLine2 = {SpvOpLine, 5, 3, 4};
+
+TEST(DebugLineTableTest, EqualSequencesShareAnIndex) {
+  DebugLineTable table;
+  const uint32_t index = table.Intern({kLine1, kLine2});
+  EXPECT_NE(index, DebugLineTable::kNoLines);
+  EXPECT_EQ(table.Intern({kLine1, kLine2}), index);
+  EXPECT_NE(table.Intern({kLine2, kLine1}), index);
+  EXPECT_NE(table.Intern({kLine1}), index);
+  EXPECT_EQ(table.Intern(std::vector<DebugLine>()), DebugLineTable::kNoLines);
+  EXPECT_EQ(table.NumLines(index), 2u);
+  EXPECT_THAT(table.Lines(index), ElementsAre(kLine1, kLine2));
+}
+
+TEST(DebugLineTableTest, Concat) {
+  DebugLineTable table;
+  const uint32_t first = table.Intern({kLine1});
+  const uint32_t second = table.Intern({kLine2, DebugLine::NoLine()});
+  EXPECT_EQ(table.Concat(first, DebugLineTable::kNoLines), first);
+  EXPECT_EQ(table.Concat(DebugLineTable::kNoLines, second), second);
+  const uint32_t both = table.Concat(first, second);
+  EXPECT_THAT(table.Lines(both),
+              ElementsAre(kLine1, kLine2, DebugLine::NoLine()));
+  EXPECT_EQ(table.Intern({kLine1, kLine2, DebugLine::NoLine()}), both);
+}
+
+TEST(DebugLineTableTest, ToBinary) {
+  DebugLineTable table;
+  const uint32_t index = table.Intern({DebugLine::NoLine(), kLine1});
+  EXPECT_EQ(table.NumWords(index), 5u);
+  std::vector<uint32_t> words(table.NumWords(index));
+  EXPECT_EQ(table.ToBinary(index, words.data()), words.data() + words.size());
+  EXPECT_THAT(words, ElementsAre((1u << 16) | SpvOpNoLine,
+                                 (4u << 16) | SpvOpLine, 5u, 1u, 2u));
+}
+
+TEST(DebugLineTableTest, InstructionsShareTheirLines) {
+  const char text[] = R"(
+OpCapability Shader
+OpMemoryModel Logical GLSL450
+OpEntryPoint Fragment %main "main"
+OpExecutionMode %main OriginUpperLeft
+%file = OpString "file.hlsl"
+%void = OpTypeVoid
+%void_fn = OpTypeFunction %void
+%main = OpFunction %void None %void_fn
+%entry = OpLabel
+OpLine %file 3 0
+OpNop
+OpLine %file 3 0
+OpNop
+OpNoLine
+OpReturn
+OpFunctionEnd
+)";
+  std::unique_ptr<IRContext> context =
+      BuildModule(SPV_ENV_UNIVERSAL_1_3, nullptr, text);
+  ASSERT_NE(context, nullptr);
+  BasicBlock* block = &*context->module()->begin()->begin();
+  auto inst = block->begin();
+  const uint32_t first = inst->dbg_lines();
+  EXPECT_EQ((++inst)->dbg_lines(), first);
+  EXPECT_EQ((++inst)->last_dbg_line()->opcode, SpvOpNoLine);
+
+  std::vector<uint32_t> binary;
+  context->module()->ToBinary(&binary, /* skip_nop = */ false);
+  std::vector<uint32_t> expected;
+  SpirvTools tools(SPV_ENV_UNIVERSAL_1_3);
+  ASSERT_TRUE(tools.Assemble(text, &expected));
+  EXPECT_EQ(binary, expected);
+}
+
+}  // namespace
+}  // namespace opt
+}  // namespace spvtools
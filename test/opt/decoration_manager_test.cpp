@@ -573,6 +573,45 @@ OpDecorate %1 Invariant
   EXPECT_THAT(ModuleToText(), expected_binary);
 }
 
+TEST_F(DecorationManagerTest, WhileEachDecorationOfIncludesGroups) {
+  const std::string spirv = R"(
+OpCapability Shader
+OpCapability Linkage
+OpMemoryModel Logical GLSL450
+OpDecorate %1 Constant
+OpDecorate %1 LinkageAttributes "foo" Import
+OpDecorate %2 Restrict
+%2      = OpDecorationGroup
+OpGroupDecorate %2 %1
+%3      = OpTypeInt 32 0
+%1      = OpVariable %3 Input
+%4      = OpVariable %3 Input
+)";
+  DecorationManager* decoManager = GetDecorationManager(spirv);
+  EXPECT_THAT(GetErrorMessage(), "");
+
+  std::vector<Instruction*> decorations;
+  EXPECT_TRUE(decoManager->WhileEachDecorationOf(
+      1u, false, [&decorations](Instruction* inst) {
+        decorations.push_back(inst);
+        return true;
+      }));
+  EXPECT_EQ(decorations, decoManager->GetDecorationsFor(1u, false));
+  EXPECT_THAT(ToText(decorations), R"(OpDecorate %1 Constant
+OpDecorate %2 Restrict
+)");
+
+  uint32_t visited = 0;
+  EXPECT_FALSE(decoManager->WhileEachDecorationOf(
+      1u, true, [&visited](Instruction*) { return ++visited < 2; }));
+  EXPECT_EQ(visited, 2u);
+
+  EXPECT_TRUE(decoManager->HasDecorations(1u, false));
+  EXPECT_TRUE(decoManager->HasDecorations(2u, false));
+  EXPECT_FALSE(decoManager->HasDecorations(3u, true));
+  EXPECT_FALSE(decoManager->HasDecorations(4u, true));
+}
+
 TEST_F(DecorationManagerTest, RemoveDecorationDecorate) {
   const std::string spirv = R"(
 OpCapability Shader
@@ -1504,6 +1543,42 @@ OpDecorateString %1 HlslSemanticGOOGLE "hello"
   EXPECT_FALSE(decoManager->HaveSubsetOfDecorations(1u, 2u));
   EXPECT_TRUE(decoManager->HaveSubsetOfDecorations(2u, 1u));
 }
+
+TEST_F(DecorationManagerTest, ChangeDecorationsBeforeFirstQuery) {
+  const std::string spirv = R"(
+OpCapability Shader
+OpCapability Linkage
+OpMemoryModel Logical GLSL450
+OpDecorate %1 Constant
+OpDecorate %1 Restrict
+OpDecorate %2 Invariant
+%2      = OpDecorationGroup
+OpGroupDecorate %2 %1 %3
+%4   = OpTypeInt 32 0
+%1      = OpVariable %4 Uniform
+%3      = OpVariable %4 Uniform
+)";
+  DecorationManager* decoManager = GetDecorationManager(spirv);
+  EXPECT_THAT(GetErrorMessage(), "");
+
+  // The decorations of %1 and %3 were not analyzed yet.
+  context_->KillInst(&*context_->annotation_begin());
+  decoManager->AddDecoration(3u, SpvDecorationVolatile);
+
+  auto decorations = decoManager->GetDecorationsFor(1u, false);
+  EXPECT_THAT(GetErrorMessage(), "");
+  const std::string expected_decorations_1 = R"(OpDecorate %1 Restrict
+OpDecorate %2 Invariant
+)";
+  EXPECT_THAT(ToText(decorations), expected_decorations_1);
+
+  decorations = decoManager->GetDecorationsFor(3u, false);
+  EXPECT_THAT(GetErrorMessage(), "");
+  const std::string expected_decorations_3 = R"(OpDecorate %3 Volatile
+OpDecorate %2 Invariant
+)";
+  EXPECT_THAT(ToText(decorations), expected_decorations_3);
+}
 }  // namespace
 }  // namespace analysis
 }  // namespace opt
@@ -1428,6 +1428,45 @@ TEST(AnalyzeInstDefUse, AddNewInstruction) {
   CheckUse(expected, &manager, context->module()->IdBound());
 }
 
+TEST(AnalyzeInstDefUse, UsersChangedDuringIteration) {
+  const std::string input = "%1 = OpTypeBool";
+
+  // Build module.
+  std::unique_ptr<IRContext> context =
+      BuildModule(SPV_ENV_UNIVERSAL_1_1, nullptr, input);
+  ASSERT_NE(nullptr, context);
+
+  // Analyze the instructions.
+  DefUseManager manager(context->module());
+
+  Instruction first(context.get(), SpvOpConstantTrue, 1, 2, {});
+  Instruction second(context.get(), SpvOpConstantTrue, 1, 3, {});
+  Instruction third(context.get(), SpvOpConstantTrue, 1, 4, {});
+  manager.AnalyzeInstDefUse(&first);
+  manager.AnalyzeInstDefUse(&third);
+
+  // Users added during the iteration are visited, removed ones are not.
+  std::vector<Instruction*> visited;
+  manager.ForEachUser(1, [&](Instruction* user) {
+    if (visited.empty()) {
+      manager.AnalyzeInstDefUse(&second);
+      manager.ClearInst(&third);
+    }
+    visited.push_back(user);
+  });
+  EXPECT_EQ((std::vector<Instruction*>{&first, &second}), visited);
+  EXPECT_EQ(2u, manager.NumUsers(1));
+  EXPECT_EQ(2u, manager.id_to_users().size());
+
+  manager.ClearInst(&first);
+  EXPECT_EQ(1u, manager.NumUsers(1));
+  manager.AnalyzeInstDefUse(&third);
+  EXPECT_EQ(2u, manager.NumUsers(1));
+  EXPECT_THAT(manager.id_to_users(),
+              UnorderedElementsAre(UserEntry(manager.GetDef(1), &second),
+                                   UserEntry(manager.GetDef(1), &third)));
+}
+
 struct KillInstTestCase {
   const char* before;
   std::unordered_set<uint32_t> indices_for_inst_to_kill;
@@ -265,6 +265,109 @@ TEST_F(DescriptorScalarReplacementTest, NameNewVariables) {
 
   SinglePassRunAndMatch<DescriptorScalarReplacement>(text, true);
 }
+
+TEST_F(DescriptorScalarReplacementTest, PartialKeepsDynamicallyIndexedArray) {
+  // The array keeps binding 0 for the dynamic access.  The elements accessed
+  // with constant indices are bound after the largest binding of the set, 5,
+  // element 0 at binding 6.
+  const std::string text = R"(
+; CHECK: OpDecorate %MyTextures DescriptorSet 0
+; CHECK: OpDecorate %MyTextures Binding 0
+; CHECK: OpDecorate [[var1:%\w+]] DescriptorSet 0
+; CHECK: OpDecorate [[var1]] Binding 7
+; CHECK: OpDecorate [[var3:%\w+]] DescriptorSet 0
+; CHECK: OpDecorate [[var3]] Binding 9
+; CHECK: %MyTextures = OpVariable
+; CHECK: [[var1]] = OpVariable %_ptr_UniformConstant_type_2d_image UniformConstant
+; CHECK: [[var3]] = OpVariable %_ptr_UniformConstant_type_2d_image UniformConstant
+; CHECK: OpLoad %type_2d_image [[var1]]
+; CHECK: OpLoad %type_2d_image [[var3]]
+; CHECK: [[ac:%\w+]] = OpAccessChain %_ptr_UniformConstant_type_2d_image %MyTextures %index
+; CHECK: OpLoad %type_2d_image [[ac]]
+               OpCapability Shader
+               OpMemoryModel Logical GLSL450
+               OpEntryPoint Fragment %main "main"
+               OpExecutionMode %main OriginUpperLeft
+               OpName %MyTextures "MyTextures"
+               OpDecorate %MyTextures DescriptorSet 0
+               OpDecorate %MyTextures Binding 0
+               OpDecorate %Other DescriptorSet 0
+               OpDecorate %Other Binding 5
+        %int = OpTypeInt 32 1
+      %int_1 = OpConstant %int 1
+      %int_3 = OpConstant %int 3
+       %uint = OpTypeInt 32 0
+     %uint_4 = OpConstant %uint 4
+      %float = OpTypeFloat 32
+%type_2d_image = OpTypeImage %float 2D 2 0 0 1 Unknown
+%_arr_type_2d_image_uint_4 = OpTypeArray %type_2d_image %uint_4
+%_ptr_UniformConstant__arr_type_2d_image_uint_4 = OpTypePointer UniformConstant %_arr_type_2d_image_uint_4
+%_ptr_UniformConstant_type_2d_image = OpTypePointer UniformConstant %type_2d_image
+%_ptr_Private_int = OpTypePointer Private %int
+       %void = OpTypeVoid
+         %fn = OpTypeFunction %void
+ %MyTextures = OpVariable %_ptr_UniformConstant__arr_type_2d_image_uint_4 UniformConstant
+      %Other = OpVariable %_ptr_UniformConstant_type_2d_image UniformConstant
+          %i = OpVariable %_ptr_Private_int Private
+       %main = OpFunction %void None %fn
+      %entry = OpLabel
+        %ac1 = OpAccessChain %_ptr_UniformConstant_type_2d_image %MyTextures %int_1
+         %t1 = OpLoad %type_2d_image %ac1
+        %ac3 = OpAccessChain %_ptr_UniformConstant_type_2d_image %MyTextures %int_3
+         %t3 = OpLoad %type_2d_image %ac3
+      %index = OpLoad %int %i
+         %ac = OpAccessChain %_ptr_UniformConstant_type_2d_image %MyTextures %index
+          %t = OpLoad %type_2d_image %ac
+               OpReturn
+               OpFunctionEnd
+  )";
+
+  SinglePassRunAndMatch<DescriptorScalarReplacement>(text, true, true, -1);
+}
+
+TEST_F(DescriptorScalarReplacementTest, PartialSplitsRuntimeArray) {
+  // Element 0 of the runtime array is placed at the requested binding 20.
+  const std::string text = R"(
+; CHECK: OpDecorate %MyTextures Binding 0
+; CHECK: OpDecorate [[var2:%\w+]] DescriptorSet 1
+; CHECK: OpDecorate [[var2]] Binding 22
+; CHECK: [[var2]] = OpVariable %_ptr_UniformConstant_type_2d_image UniformConstant
+; CHECK: OpLoad %type_2d_image [[var2]]
+; CHECK: OpAccessChain %_ptr_UniformConstant_type_2d_image %MyTextures %index
+               OpCapability Shader
+               OpCapability RuntimeDescriptorArrayEXT
+               OpExtension "SPV_EXT_descriptor_indexing"
+               OpMemoryModel Logical GLSL450
+               OpEntryPoint Fragment %main "main"
+               OpExecutionMode %main OriginUpperLeft
+               OpName %MyTextures "MyTextures"
+               OpDecorate %MyTextures DescriptorSet 1
+               OpDecorate %MyTextures Binding 0
+        %int = OpTypeInt 32 1
+      %int_2 = OpConstant %int 2
+      %float = OpTypeFloat 32
+%type_2d_image = OpTypeImage %float 2D 2 0 0 1 Unknown
+%_runtimearr_type_2d_image = OpTypeRuntimeArray %type_2d_image
+%_ptr_UniformConstant__runtimearr_type_2d_image = OpTypePointer UniformConstant %_runtimearr_type_2d_image
+%_ptr_UniformConstant_type_2d_image = OpTypePointer UniformConstant %type_2d_image
+%_ptr_Private_int = OpTypePointer Private %int
+       %void = OpTypeVoid
+         %fn = OpTypeFunction %void
+ %MyTextures = OpVariable %_ptr_UniformConstant__runtimearr_type_2d_image UniformConstant
+          %i = OpVariable %_ptr_Private_int Private
+       %main = OpFunction %void None %fn
+      %entry = OpLabel
+        %ac2 = OpAccessChain %_ptr_UniformConstant_type_2d_image %MyTextures %int_2
+         %t2 = OpLoad %type_2d_image %ac2
+      %index = OpLoad %int %i
+         %ac = OpAccessChain %_ptr_UniformConstant_type_2d_image %MyTextures %index
+          %t = OpLoad %type_2d_image %ac
+               OpReturn
+               OpFunctionEnd
+  )";
+
+  SinglePassRunAndMatch<DescriptorScalarReplacement>(text, true, true, 20);
+}
 }  // namespace
 }  // namespace opt
 }  // namespace spvtools
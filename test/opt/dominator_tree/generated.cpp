@@ -895,6 +895,60 @@ TEST_F(PassClassTest, DominatorUnreachableFromEntry) {
   }
 }
 
+// A long chain of blocks with nested back edges: block k branches back to
+// block N - 1 - k.  Every block is immediately dominated by the previous one
+// and immediately post-dominated by the next one, however deep the nesting.
+TEST_F(PassClassTest, DominatorDeeplyNestedBackEdges) {
+  const uint32_t kNumBlocks = 2000;
+  const uint32_t kFirstBlock = 100;
+  std::string text = R"(
+               OpCapability Addresses
+               OpCapability Kernel
+               OpMemoryModel Physical64 OpenCL
+               OpEntryPoint Kernel %1 "main"
+          %2 = OpTypeVoid
+          %3 = OpTypeFunction %2
+          %4 = OpTypeBool
+          %5 = OpConstantTrue %4
+          %1 = OpFunction %2 None %3
+)";
+  for (uint32_t k = 0; k < kNumBlocks; ++k) {
+    const std::string next = "%" + std::to_string(kFirstBlock + k + 1);
+    text += "%" + std::to_string(kFirstBlock + k) + " = OpLabel\n";
+    if (k == kNumBlocks - 1) {
+      text += "OpReturn\n";
+    } else if (k >= kNumBlocks / 2) {
+      const uint32_t target = kFirstBlock + kNumBlocks - 1 - k;
+      text += "OpBranchConditional %5 " + next + " %" +
+              std::to_string(target) + "\n";
+    } else {
+      text += "OpBranch " + next + "\n";
+    }
+  }
+  text += "OpFunctionEnd\n";
+
+  std::unique_ptr<IRContext> context =
+      BuildModule(SPV_ENV_UNIVERSAL_1_0, nullptr, text,
+                  SPV_TEXT_TO_BINARY_OPTION_PRESERVE_NUMERIC_IDS);
+  Module* module = context->module();
+  EXPECT_NE(nullptr, module) << "Assembling failed for shader:\n"
+                             << text << std::endl;
+  const Function* fn = spvtest::GetFunction(module, 1);
+  const CFG& cfg = *context->cfg();
+
+  DominatorAnalysis dom_tree;
+  dom_tree.InitializeTree(cfg, fn);
+  PostDominatorAnalysis post_dom_tree;
+  post_dom_tree.InitializeTree(cfg, fn);
+  for (uint32_t id = kFirstBlock + 1; id < kFirstBlock + kNumBlocks; ++id) {
+    EXPECT_EQ(dom_tree.ImmediateDominator(id)->id(), id - 1);
+    EXPECT_EQ(post_dom_tree.ImmediateDominator(id - 1)->id(), id);
+  }
+  check_dominance(dom_tree, fn, kFirstBlock, kFirstBlock + kNumBlocks - 1);
+  check_dominance(post_dom_tree, fn, kFirstBlock + kNumBlocks - 1,
+                  kFirstBlock);
+}
+
 }  // namespace
 }  // namespace opt
 }  // namespace spvtools
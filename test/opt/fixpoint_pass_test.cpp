@@ -0,0 +1,183 @@
+// Copyright (c) 2019 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#include "source/opt/fixpoint_pass.h"
+
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "gmock/gmock.h"
+#include "source/opt/build_module.h"
+#include "source/opt/dead_branch_elim_pass.h"
+#include "source/opt/simplification_pass.h"
+#include "source/util/make_unique.h"
+#include "test/opt/pass_fixture.h"
+
+namespace spvtools {
+namespace opt {
+namespace {
+
+using ::testing::ElementsAre;
+using FixpointPassTest = PassTest<::testing::Test>;
+
+// Pretends to change each function the number of times given in |*changes|,
+// once per run, and appends the ids of the functions it processes to
+// |*processed|.
+class CountdownPass : public Pass {
+ public:
+  CountdownPass(std::unordered_map<uint32_t, int>* changes,
+                std::vector<uint32_t>* processed, bool record_changes)
+      : changes_(changes),
+        processed_(processed),
+        record_changes_(record_changes) {}
+
+  const char* name() const override { return "countdown"; }
+
+  Status Process() override {
+    bool changed = false;
+    for (Function& function : *get_module()) {
+      if (!ShouldProcessFunction(&function)) continue;
+      processed_->push_back(function.result_id());
+      int& count = (*changes_)[function.result_id()];
+      if (count > 0) {
+        --count;
+        changed = true;
+        if (record_changes_) RecordChangedFunction(&function);
+      }
+    }
+    return changed ? Status::SuccessWithChange : Status::SuccessWithoutChange;
+  }
+
+  IRContext::Analysis GetPreservedAnalyses() override {
+    return IRContext::Analysis(IRContext::kAnalysisEnd - 1);
+  }
+
+ private:
+  std::unordered_map<uint32_t, int>* changes_;
+  std::vector<uint32_t>* processed_;
+  bool record_changes_;
+};
+
+const char kThreeFunctions[] = R"(
+OpCapability Shader
+OpCapability Linkage
+OpMemoryModel Logical GLSL450
+%void = OpTypeVoid
+%4 = OpTypeFunction %void
+%1 = OpFunction %void None %4
+%5 = OpLabel
+OpReturn
+OpFunctionEnd
+%2 = OpFunction %void None %4
+%6 = OpLabel
+OpReturn
+OpFunctionEnd
+%3 = OpFunction %void None %4
+%7 = OpLabel
+OpReturn
+OpFunctionEnd
+)";
+
+std::unique_ptr<IRContext> BuildThreeFunctions() {
+  return BuildModule(SPV_ENV_UNIVERSAL_1_1, nullptr, kThreeFunctions,
+                     SPV_TEXT_TO_BINARY_OPTION_PRESERVE_NUMERIC_IDS);
+}
+
+TEST_F(FixpointPassTest, OnlyChangedFunctionsAreProcessedAgain) {
+  std::unique_ptr<IRContext> context = BuildThreeFunctions();
+  std::unordered_map<uint32_t, int> changes = {{2, 2}};
+  std::vector<uint32_t> processed;
+  FixpointPass pass({[&changes, &processed]() -> std::unique_ptr<Pass> {
+                      return MakeUnique<CountdownPass>(&changes, &processed,
+                                                       true);
+                    }},
+                    10);
+  EXPECT_EQ(Pass::Status::SuccessWithChange, pass.Run(context.get()));
+  EXPECT_EQ(3u, pass.num_rounds());
+  EXPECT_THAT(processed, ElementsAre(1, 2, 3, 2, 2));
+}
+
+TEST_F(FixpointPassTest, UnrecordedChangesProcessEveryFunction) {
+  std::unique_ptr<IRContext> context = BuildThreeFunctions();
+  std::unordered_map<uint32_t, int> changes = {{2, 1}};
+  std::vector<uint32_t> processed;
+  FixpointPass pass({[&changes, &processed]() -> std::unique_ptr<Pass> {
+                      return MakeUnique<CountdownPass>(&changes, &processed,
+                                                       false);
+                    }},
+                    10);
+  EXPECT_EQ(Pass::Status::SuccessWithChange, pass.Run(context.get()));
+  EXPECT_EQ(2u, pass.num_rounds());
+  EXPECT_THAT(processed, ElementsAre(1, 2, 3, 1, 2, 3));
+}
+
+TEST_F(FixpointPassTest, StopsAfterMaxRounds) {
+  std::unique_ptr<IRContext> context = BuildThreeFunctions();
+  std::unordered_map<uint32_t, int> changes = {{1, 100}};
+  std::vector<uint32_t> processed;
+  FixpointPass pass({[&changes, &processed]() -> std::unique_ptr<Pass> {
+                      return MakeUnique<CountdownPass>(&changes, &processed,
+                                                       true);
+                    }},
+                    4);
+  EXPECT_EQ(Pass::Status::SuccessWithChange, pass.Run(context.get()));
+  EXPECT_EQ(4u, pass.num_rounds());
+  EXPECT_EQ(96, changes[1]);
+}
+
+TEST_F(FixpointPassTest, FoldedBranchIsEliminated) {
+  // Dead branch elimination only sees the constant condition after
+  // simplification folds it, in the second round.
+  const std::string text = R"(
+; CHECK: %main = OpFunction
+; CHECK-NOT: OpBranchConditional
+; CHECK: OpReturn
+OpCapability Shader
+OpMemoryModel Logical GLSL450
+OpEntryPoint Fragment %main "main"
+OpExecutionMode %main OriginUpperLeft
+%void = OpTypeVoid
+%fn = OpTypeFunction %void
+%bool = OpTypeBool
+%true = OpConstantTrue %bool
+%int = OpTypeInt 32 1
+%int_1 = OpConstant %int 1
+%main = OpFunction %void None %fn
+%entry = OpLabel
+%cond = OpIEqual %bool %int_1 %int_1
+OpSelectionMerge %merge None
+OpBranchConditional %cond %then %merge
+%then = OpLabel
+OpBranch %merge
+%merge = OpLabel
+OpReturn
+OpFunctionEnd
+)";
+
+  std::vector<FixpointPass::PassFactory> factories = {
+      []() -> std::unique_ptr<Pass> {
+        return MakeUnique<DeadBranchElimPass>();
+      },
+      []() -> std::unique_ptr<Pass> {
+        return MakeUnique<SimplificationPass>();
+      }};
+  SinglePassRunAndMatch<FixpointPass>(text, true, factories, 4u);
+}
+
+}  // namespace
+}  // namespace opt
+}  // namespace spvtools
@@ -7175,6 +7175,30 @@ INSTANTIATE_TEST_SUITE_P(ImageOperandsBitmaskFoldingTest, MatchingInstructionWit
       , 0 /* No result-id */, true)
 ));
 
+TEST(FoldingRulesTest, CoreRulesAreSharedByContexts) {
+  const std::string text = R"(
+OpCapability Shader
+OpCapability Linkage
+OpMemoryModel Logical GLSL450
+)";
+  std::unique_ptr<IRContext> context1 =
+      BuildModule(SPV_ENV_UNIVERSAL_1_1, nullptr, text);
+  std::unique_ptr<IRContext> context2 =
+      BuildModule(SPV_ENV_UNIVERSAL_1_1, nullptr, text);
+  const FoldingRules& rules1 =
+      context1->get_instruction_folder().GetFoldingRules();
+  const FoldingRules& rules2 =
+      context2->get_instruction_folder().GetFoldingRules();
+
+  Instruction add(context1.get(), SpvOpIAdd);
+  EXPECT_FALSE(rules1.GetRulesForInstruction(&add).empty());
+  EXPECT_EQ(&rules1.GetRulesForInstruction(&add),
+            &rules2.GetRulesForInstruction(&add));
+
+  Instruction nop(context1.get(), SpvOpNop);
+  EXPECT_TRUE(rules1.GetRulesForInstruction(&nop).empty());
+}
+
 }  // namespace
 }  // namespace opt
 }  // namespace spvtools
@@ -1394,6 +1394,55 @@ TEST_F(GraphicsRobustAccessTest,
 //   - all Dim types that can be arrayed: 1D 2D 3D
 //   - sample index: set to 0 if not multisampled
 //   - Dim (2D, Cube Rect} with multisampling
+// Returns a shader indexing an array of |array_size| floats with the
+// induction variable of a loop running 4 times.
+std::string LoopIndexShader(const std::string& array_size) {
+  return ShaderPreambleAC({"i"}) + TypesVoid() + TypesInt() + TypesFloat() +
+         R"(
+       %bool = OpTypeBool
+       %int_0 = OpConstant %int 0
+       %int_1 = OpConstant %int 1
+       %int_4 = OpConstant %int 4
+       %uint_size = OpConstant %uint )" +
+         array_size + R"(
+       %arr = OpTypeArray %float %uint_size
+       %var_ty = OpTypePointer Function %arr
+       %ptr_ty = OpTypePointer Function %float
+       )" + MainPrefix() +
+         R"(
+       %var = OpVariable %var_ty Function
+       OpBranch %header
+       %header = OpLabel
+       %i = OpPhi %int %int_0 %entry %next %body
+       %cond = OpSLessThan %bool %i %int_4
+       OpLoopMerge %exit %body None
+       OpBranchConditional %cond %body %exit
+       %body = OpLabel
+       %ac = OpAccessChain %ptr_ty %var %i
+       %next = OpIAdd %int %i %int_1
+       OpBranch %header
+       %exit = OpLabel
+       )" + MainSuffix();
+}
+
+TEST_F(GraphicsRobustAccessTest, ACArrayInductionVariableInBoundsUntouched) {
+  const std::string checks = R"(
+       ; CHECK-NOT: SClamp
+       ; CHECK: %ac = OpAccessChain %ptr_ty %var %i
+  )";
+  SinglePassRunAndMatch<GraphicsRobustAccessPass>(
+      checks + LoopIndexShader("4"), true);
+}
+
+TEST_F(GraphicsRobustAccessTest, ACArrayInductionVariableExcessClamped) {
+  const std::string checks = R"(
+       ; CHECK: %[[clamp:\w+]] = OpExtInst %int {{%\w+}} SClamp %i %int_0 %int_2
+       ; CHECK: %ac = OpAccessChain %ptr_ty %var %[[clamp]]
+  )";
+  SinglePassRunAndMatch<GraphicsRobustAccessPass>(
+      checks + LoopIndexShader("3"), true);
+}
+
 //      -1 0 max excess
 // TODO(dneto): Test OpImageTexelPointer with coordinate component index other
 // than 32 bits.
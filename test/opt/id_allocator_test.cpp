@@ -0,0 +1,115 @@
+// Copyright (c) 2019 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "source/opt/id_allocator.h"
+
+#include <memory>
+#include <set>
+#include <vector>
+
+#include "gmock/gmock.h"
+#include "source/opt/build_module.h"
+#include "source/util/parallel.h"
+
+namespace spvtools {
+namespace opt {
+namespace {
+
+const char kModule[] = R"(
+OpCapability Shader
+OpCapability Linkage
+OpMemoryModel Logical GLSL450
+%void = OpTypeVoid
+%float = OpTypeFloat 32
+)";
+
+std::unique_ptr<IRContext> BuildContext() {
+  return BuildModule(SPV_ENV_UNIVERSAL_1_1, nullptr, kModule);
+}
+
+TEST(IdAllocatorTest, RangeHandsOutConsecutiveIds) {
+  std::unique_ptr<IRContext> context = BuildContext();
+  const uint32_t bound = context->module()->IdBound();
+
+  IdAllocator allocator(context.get(), 4);
+  {
+    IdAllocator::Range range(&allocator);
+    for (uint32_t i = 0; i < 6; ++i) {
+      EXPECT_EQ(bound + i, range.TakeNextId());
+    }
+  }
+  EXPECT_EQ(2u, allocator.unused_ids());
+  EXPECT_TRUE(allocator.Finish(/* compact = */ false));
+  EXPECT_EQ(bound + 8, context->module()->IdBound());
+}
+
+TEST(IdAllocatorTest, RangesOnThreadsTakeDistinctIds) {
+  std::unique_ptr<IRContext> context = BuildContext();
+  const uint32_t bound = context->module()->IdBound();
+  const size_t kNumRanges = 8;
+  const size_t kIdsPerRange = 1000;
+
+  IdAllocator allocator(context.get());
+  std::vector<std::vector<uint32_t>> ids(kNumRanges);
+  utils::ParallelFor(kNumRanges, 4, [&allocator, &ids](size_t i) {
+    IdAllocator::Range range(&allocator);
+    for (size_t j = 0; j < kIdsPerRange; ++j) {
+      ids[i].push_back(range.TakeNextId());
+    }
+  });
+  EXPECT_TRUE(allocator.Finish(/* compact = */ false));
+
+  std::set<uint32_t> all_ids;
+  for (const auto& range_ids : ids) {
+    all_ids.insert(range_ids.begin(), range_ids.end());
+  }
+  EXPECT_EQ(kNumRanges * kIdsPerRange, all_ids.size());
+  EXPECT_LE(bound, *all_ids.begin());
+  EXPECT_GT(context->module()->IdBound(), *all_ids.rbegin());
+}
+
+TEST(IdAllocatorTest, StopsAtMaxIdBound) {
+  std::unique_ptr<IRContext> context = BuildContext();
+  const uint32_t bound = context->module()->IdBound();
+  context->set_max_id_bound(bound + 10);
+
+  IdAllocator allocator(context.get(), 4);
+  uint32_t num_ids = 0;
+  {
+    IdAllocator::Range range(&allocator);
+    while (range.TakeNextId() != 0) ++num_ids;
+  }
+  EXPECT_EQ(10u, num_ids);
+  EXPECT_EQ(0u, allocator.unused_ids());
+  EXPECT_TRUE(allocator.Finish(/* compact = */ false));
+  EXPECT_EQ(bound + 10, context->module()->IdBound());
+}
+
+TEST(IdAllocatorTest, FinishCompactsUnusedIds) {
+  std::unique_ptr<IRContext> context = BuildContext();
+  const uint32_t bound = context->module()->IdBound();
+
+  IdAllocator allocator(context.get());
+  {
+    IdAllocator::Range range(&allocator);
+    range.TakeNextId();
+  }
+  EXPECT_TRUE(allocator.Finish(/* compact = */ true));
+  EXPECT_EQ(bound, context->module()->IdBound());
+  EXPECT_EQ(0u, allocator.unused_ids());
+}
+
+}  // namespace
+}  // namespace opt
+}  // namespace spvtools
@@ -0,0 +1,59 @@
+// Copyright (c) 2020 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "source/opt/id_remap.h"
+
+#include "gmock/gmock.h"
+
+namespace spvtools {
+namespace opt {
+namespace {
+
+TEST(IdRemapTest, MapsAndRemapsIds) {
+  IdRemap remap;
+  EXPECT_EQ(0u, remap.Get(7));
+  remap.Set(10, 100);
+  remap.Set(12, 120);
+  // Ids below the first one mapped move the table.
+  remap.Set(3, 30);
+  EXPECT_EQ(100u, remap.Get(10));
+  EXPECT_EQ(120u, remap.Get(12));
+  EXPECT_EQ(30u, remap.Get(3));
+  EXPECT_EQ(0u, remap.Get(11));
+  EXPECT_EQ(0u, remap.Get(2));
+  EXPECT_EQ(0u, remap.Get(1000));
+
+  uint32_t id = 12;
+  EXPECT_TRUE(remap.Remap(&id));
+  EXPECT_EQ(120u, id);
+  id = 5;
+  EXPECT_FALSE(remap.Remap(&id));
+  EXPECT_EQ(5u, id);
+}
+
+TEST(IdRemapTest, ClearForgetsAllTheIds) {
+  IdRemap remap;
+  remap.Set(20, 1);
+  remap.Set(5, 2);
+  remap.clear();
+  EXPECT_EQ(0u, remap.Get(20));
+  EXPECT_EQ(0u, remap.Get(5));
+  remap.Set(5, 3);
+  EXPECT_EQ(3u, remap.Get(5));
+  EXPECT_EQ(0u, remap.Get(20));
+}
+
+}  // namespace
+}  // namespace opt
+}  // namespace spvtools
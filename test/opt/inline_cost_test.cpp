@@ -0,0 +1,200 @@
+// Copyright (c) 2019 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <string>
+
+#include "test/opt/pass_fixture.h"
+#include "test/opt/pass_utils.h"
+
+namespace spvtools {
+namespace opt {
+namespace {
+
+using InlineCostTest = PassTest<::testing::Test>;
+
+// The entry point calls %f twice, and %f calls %g once.
+const std::string kCallChain = R"(
+OpCapability Shader
+OpMemoryModel Logical GLSL450
+OpEntryPoint Fragment %main "main"
+OpExecutionMode %main OriginUpperLeft
+OpName %main "main"
+OpName %f "f"
+OpName %g "g"
+%void = OpTypeVoid
+%int = OpTypeInt 32 1
+%int_1 = OpConstant %int 1
+%_ptr_Function_int = OpTypePointer Function %int
+%void_fn = OpTypeFunction %void
+%int_fn = OpTypeFunction %int %int
+%main = OpFunction %void None %void_fn
+%main_entry = OpLabel
+%x = OpVariable %_ptr_Function_int Function
+%a = OpLoad %int %x
+%b = OpFunctionCall %int %f %a
+%c = OpFunctionCall %int %f %b
+OpStore %x %c
+OpReturn
+OpFunctionEnd
+%f = OpFunction %int None %int_fn
+%f_param = OpFunctionParameter %int
+%f_entry = OpLabel
+%f_call = OpFunctionCall %int %g %f_param
+OpReturnValue %f_call
+OpFunctionEnd
+%g = OpFunction %int None %int_fn
+%g_param = OpFunctionParameter %int
+%g_entry = OpLabel
+%sum = OpIAdd %int %g_param %int_1
+OpReturnValue %sum
+OpFunctionEnd
+)";
+
+TEST_F(InlineCostTest, InlinesCallsWithinBudget) {
+  const std::string checks = R"(
+; CHECK: %main = OpFunction
+; CHECK-NOT: OpFunctionCall
+; CHECK: OpFunctionEnd
+)";
+
+  SinglePassRunAndMatch<InlineCostPass>(checks + kCallChain, true, 100u);
+}
+
+TEST_F(InlineCostTest, InlinesOnlyCallSiteBottomUp) {
+  // With no budget, only the single call to %g is inlined, into %f.
+  const std::string checks = R"(
+; CHECK: %main = OpFunction
+; CHECK: OpFunctionCall %int %f
+; CHECK: OpFunctionCall %int %f
+; CHECK: %f = OpFunction
+; CHECK-NOT: OpFunctionCall
+; CHECK: OpFunctionEnd
+)";
+
+  SinglePassRunAndMatch<InlineCostPass>(checks + kCallChain, true, 0u);
+}
+
+TEST_F(InlineCostTest, KeepsOnlyCallSiteWithLinkage) {
+  // With linkage, %g could be called from another module once linked, so
+  // inlining its only call here would not let it be removed.
+  const std::string text = R"(
+; CHECK: %f = OpFunction
+; CHECK: OpFunctionCall %int %g
+OpCapability Shader
+OpCapability Linkage
+OpMemoryModel Logical GLSL450
+OpName %f "f"
+OpName %g "g"
+OpDecorate %f LinkageAttributes "f" Export
+%int = OpTypeInt 32 1
+%int_1 = OpConstant %int 1
+%int_fn = OpTypeFunction %int %int
+%f = OpFunction %int None %int_fn
+%f_param = OpFunctionParameter %int
+%f_entry = OpLabel
+%f_call = OpFunctionCall %int %g %f_param
+OpReturnValue %f_call
+OpFunctionEnd
+%g = OpFunction %int None %int_fn
+%g_param = OpFunctionParameter %int
+%g_entry = OpLabel
+%sum = OpIAdd %int %g_param %int_1
+OpReturnValue %sum
+OpFunctionEnd
+)";
+
+  SinglePassRunAndMatch<InlineCostPass>(text, true, 0u);
+}
+
+TEST_F(InlineCostTest, AlwaysInlinesOpaqueArguments) {
+  const std::string text = R"(
+; CHECK: %main = OpFunction
+; CHECK-NOT: OpFunctionCall
+; CHECK: OpFunctionEnd
+OpCapability Shader
+OpMemoryModel Logical GLSL450
+OpEntryPoint Fragment %main "main"
+OpExecutionMode %main OriginUpperLeft
+OpName %main "main"
+OpName %use_image "use_image"
+OpDecorate %tex DescriptorSet 0
+OpDecorate %tex Binding 0
+%void = OpTypeVoid
+%float = OpTypeFloat 32
+%image = OpTypeImage %float 2D 0 0 0 1 Unknown
+%sampled_image = OpTypeSampledImage %image
+%_ptr_sampled_image = OpTypePointer UniformConstant %sampled_image
+%tex = OpVariable %_ptr_sampled_image UniformConstant
+%void_fn = OpTypeFunction %void
+%sampled_image_fn = OpTypeFunction %void %sampled_image
+%main = OpFunction %void None %void_fn
+%main_entry = OpLabel
+%s = OpLoad %sampled_image %tex
+%call1 = OpFunctionCall %void %use_image %s
+%call2 = OpFunctionCall %void %use_image %s
+OpReturn
+OpFunctionEnd
+%use_image = OpFunction %void None %sampled_image_fn
+%param = OpFunctionParameter %sampled_image
+%use_image_entry = OpLabel
+OpReturn
+OpFunctionEnd
+)";
+
+  SinglePassRunAndMatch<InlineCostPass>(text, true, 0u);
+}
+
+TEST_F(InlineCostTest, AlwaysInlinesPointersToMembers) {
+  // A pointer to a member of a variable is not a memory object declaration,
+  // so it cannot be passed to a function in logical addressing mode.
+  const std::string text = R"(
+; CHECK: %main = OpFunction
+; CHECK-NOT: OpFunctionCall
+; CHECK: OpFunctionEnd
+OpCapability Shader
+OpMemoryModel Logical GLSL450
+OpEntryPoint Fragment %main "main"
+OpExecutionMode %main OriginUpperLeft
+OpName %main "main"
+OpName %load "load"
+%void = OpTypeVoid
+%int = OpTypeInt 32 1
+%int_0 = OpConstant %int 0
+%S = OpTypeStruct %int
+%_ptr_Function_S = OpTypePointer Function %S
+%_ptr_Function_int = OpTypePointer Function %int
+%void_fn = OpTypeFunction %void
+%ptr_fn = OpTypeFunction %int %_ptr_Function_int
+%main = OpFunction %void None %void_fn
+%main_entry = OpLabel
+%var = OpVariable %_ptr_Function_S Function
+%member = OpAccessChain %_ptr_Function_int %var %int_0
+%a = OpFunctionCall %int %load %member
+%b = OpFunctionCall %int %load %member
+OpReturn
+OpFunctionEnd
+%load = OpFunction %int None %ptr_fn
+%param = OpFunctionParameter %_ptr_Function_int
+%load_entry = OpLabel
+%value = OpLoad %int %param
+OpReturnValue %value
+OpFunctionEnd
+)";
+
+  SinglePassRunAndMatch<InlineCostPass>(text, true, 0u);
+}
+
+}  // namespace
+}  // namespace opt
+}  // namespace spvtools
@@ -3030,6 +3030,59 @@ OpFunctionEnd
   SinglePassRunAndCheck<InlineExhaustivePass>(before, after, false, true);
 }
 
+TEST_F(InlineTest, InlineSameCalleeTwiceWithForwardReference) {
+  // Both copies of %f map the forward reference to %next in the OpPhi to
+  // their own result id.
+  const std::string text = R"(
+; CHECK: %main = OpFunction
+; CHECK-NOT: OpFunctionCall
+; CHECK: [[phi1:%\w+]] = OpPhi %int %int_0 {{%\w+}} [[next1:%\w+]] {{%\w+}}
+; CHECK: [[next1]] = OpIAdd %int [[phi1]] %int_1
+; CHECK: [[phi2:%\w+]] = OpPhi %int %int_0 {{%\w+}} [[next2:%\w+]] {{%\w+}}
+; CHECK: [[next2]] = OpIAdd %int [[phi2]] %int_1
+; CHECK: OpFunctionEnd
+OpCapability Shader
+OpMemoryModel Logical GLSL450
+OpEntryPoint Fragment %main "main"
+OpExecutionMode %main OriginUpperLeft
+OpName %main "main"
+OpName %f "f"
+%void = OpTypeVoid
+%bool = OpTypeBool
+%int = OpTypeInt 32 1
+%int_0 = OpConstant %int 0
+%int_1 = OpConstant %int 1
+%int_4 = OpConstant %int 4
+%void_fn = OpTypeFunction %void
+%int_fn = OpTypeFunction %int %int
+%main = OpFunction %void None %void_fn
+%main_entry = OpLabel
+%a = OpFunctionCall %int %f %int_4
+%b = OpFunctionCall %int %f %a
+OpReturn
+OpFunctionEnd
+%f = OpFunction %int None %int_fn
+%n = OpFunctionParameter %int
+%f_entry = OpLabel
+OpBranch %header
+%header = OpLabel
+%i = OpPhi %int %int_0 %f_entry %next %continue
+%cond = OpSLessThan %bool %i %n
+OpLoopMerge %merge %continue None
+OpBranchConditional %cond %body %merge
+%body = OpLabel
+OpBranch %continue
+%continue = OpLabel
+%next = OpIAdd %int %i %int_1
+OpBranch %header
+%merge = OpLabel
+OpReturnValue %i
+OpFunctionEnd
+)";
+
+  SinglePassRunAndMatch<InlineExhaustivePass>(text, true);
+}
+
 // TODO(greg-lunarg): Add tests to verify handling of these cases:
 //
 //    Empty modules
@@ -125,16 +125,16 @@ OpDecorate %bufStruct Block
 OpDecorate %u_info DescriptorSet 0
 OpDecorate %u_info Binding 0
 OpDecorate %_runtimearr_ulong ArrayStride 8
-OpDecorate %_struct_39 Block
-OpMemberDecorate %_struct_39 0 Offset 0
-OpDecorate %41 DescriptorSet 7
-OpDecorate %41 Binding 2
+OpDecorate %_struct_34 Block
+OpMemberDecorate %_struct_34 0 Offset 0
+OpDecorate %36 DescriptorSet 7
+OpDecorate %36 Binding 2
 OpDecorate %_runtimearr_uint ArrayStride 4
-OpDecorate %_struct_77 Block
-OpMemberDecorate %_struct_77 0 Offset 0
-OpMemberDecorate %_struct_77 1 Offset 4
-OpDecorate %79 DescriptorSet 7
-OpDecorate %79 Binding 0
+OpDecorate %_struct_83 Block
+OpMemberDecorate %_struct_83 0 Offset 0
+OpMemberDecorate %_struct_83 1 Offset 4
+OpDecorate %85 DescriptorSet 7
+OpDecorate %85 Binding 0
 OpDecorate %gl_GlobalInvocationID BuiltIn GlobalInvocationId
 %void = OpTypeVoid
 %8 = OpTypeFunction %void
@@ -157,19 +157,19 @@ OpTypeForwardPointer %_ptr_PhysicalStorageBuffer_bufStruct PhysicalStorageBuffer
 %uint_4 = OpConstant %uint 4
 %bool = OpTypeBool
 %28 = OpTypeFunction %bool %ulong %uint
-%uint_1 = OpConstant %uint 1
 %_runtimearr_ulong = OpTypeRuntimeArray %ulong
-%_struct_39 = OpTypeStruct %_runtimearr_ulong
-%_ptr_StorageBuffer__struct_39 = OpTypePointer StorageBuffer %_struct_39
-%41 = OpVariable %_ptr_StorageBuffer__struct_39 StorageBuffer
+%_struct_34 = OpTypeStruct %_runtimearr_ulong
+%_ptr_StorageBuffer__struct_34 = OpTypePointer StorageBuffer %_struct_34
+%36 = OpVariable %_ptr_StorageBuffer__struct_34 StorageBuffer
 %_ptr_StorageBuffer_ulong = OpTypePointer StorageBuffer %ulong
 %uint_0 = OpConstant %uint 0
+%uint_1 = OpConstant %uint 1
 %uint_32 = OpConstant %uint 32
-%70 = OpTypeFunction %void %uint %uint %uint %uint
+%76 = OpTypeFunction %void %uint %uint %uint %uint
 %_runtimearr_uint = OpTypeRuntimeArray %uint
-%_struct_77 = OpTypeStruct %uint %_runtimearr_uint
-%_ptr_StorageBuffer__struct_77 = OpTypePointer StorageBuffer %_struct_77
-%79 = OpVariable %_ptr_StorageBuffer__struct_77 StorageBuffer
+%_struct_83 = OpTypeStruct %uint %_runtimearr_uint
+%_ptr_StorageBuffer__struct_83 = OpTypePointer StorageBuffer %_struct_83
+%85 = OpVariable %_ptr_StorageBuffer__struct_83 StorageBuffer
 %_ptr_StorageBuffer_uint = OpTypePointer StorageBuffer %uint
 %uint_10 = OpConstant %uint 10
 %uint_23 = OpConstant %uint 23
@@ -203,19 +203,19 @@ OpFunctionEnd
 %21 = OpLoad %_ptr_PhysicalStorageBuffer_bufStruct %20
 %22 = OpAccessChain %_ptr_PhysicalStorageBuffer_int %21 %int_1
 %24 = OpConvertPtrToU %ulong %22
-%61 = OpFunctionCall %bool %26 %24 %uint_4
-OpSelectionMerge %62 None
-OpBranchConditional %61 %63 %64
-%63 = OpLabel
+%67 = OpFunctionCall %bool %26 %24 %uint_4
+OpSelectionMerge %68 None
+OpBranchConditional %67 %69 %70
+%69 = OpLabel
 OpStore %22 %int_3239 Aligned 16
-OpBranch %62
-%64 = OpLabel
-%65 = OpUConvert %uint %24
-%67 = OpShiftRightLogical %ulong %24 %uint_32
-%68 = OpUConvert %uint %67
-%124 = OpFunctionCall %void %69 %uint_48 %uint_2 %65 %68
-OpBranch %62
-%62 = OpLabel
+OpBranch %68
+%70 = OpLabel
+%71 = OpUConvert %uint %24
+%73 = OpShiftRightLogical %ulong %24 %uint_32
+%74 = OpUConvert %uint %73
+%130 = OpFunctionCall %void %75 %uint_48 %uint_2 %71 %74
+OpBranch %68
+%68 = OpLabel
 OpReturn
 OpFunctionEnd
 )";
@@ -225,84 +225,90 @@ OpFunctionEnd
 %29 = OpFunctionParameter %ulong
 %30 = OpFunctionParameter %uint
 %31 = OpLabel
+%39 = OpAccessChain %_ptr_StorageBuffer_ulong %36 %uint_0 %uint_0
+%40 = OpLoad %ulong %39
+%41 = OpUConvert %uint %40
+%43 = OpISub %uint %41 %uint_1
 OpBranch %32
 %32 = OpLabel
-%34 = OpPhi %uint %uint_1 %31 %35 %33
-OpLoopMerge %37 %33 None
-OpBranch %33
-%33 = OpLabel
-%35 = OpIAdd %uint %34 %uint_1
-%44 = OpAccessChain %_ptr_StorageBuffer_ulong %41 %uint_0 %35
-%45 = OpLoad %ulong %44
-%46 = OpUGreaterThan %bool %45 %29
-OpBranchConditional %46 %37 %32
-%37 = OpLabel
-%47 = OpISub %uint %35 %uint_1
-%48 = OpAccessChain %_ptr_StorageBuffer_ulong %41 %uint_0 %47
-%49 = OpLoad %ulong %48
-%50 = OpISub %ulong %29 %49
-%51 = OpUConvert %ulong %30
-%52 = OpIAdd %ulong %50 %51
-%53 = OpAccessChain %_ptr_StorageBuffer_ulong %41 %uint_0 %uint_0
-%54 = OpLoad %ulong %53
-%55 = OpUConvert %uint %54
-%56 = OpISub %uint %47 %uint_1
-%57 = OpIAdd %uint %56 %55
-%58 = OpAccessChain %_ptr_StorageBuffer_ulong %41 %uint_0 %57
-%59 = OpLoad %ulong %58
-%60 = OpULessThanEqual %bool %52 %59
-OpReturnValue %60
+%46 = OpPhi %uint %uint_1 %31 %48 %44
+%47 = OpPhi %uint %43 %31 %49 %44
+OpLoopMerge %45 %44 None
+OpBranch %44
+%44 = OpLabel
+%50 = OpIAdd %uint %46 %47
+%51 = OpShiftRightLogical %uint %50 %uint_1
+%52 = OpAccessChain %_ptr_StorageBuffer_ulong %36 %uint_0 %51
+%53 = OpLoad %ulong %52
+%54 = OpUGreaterThan %bool %53 %29
+%48 = OpSelect %uint %54 %46 %51
+%49 = OpSelect %uint %54 %51 %47
+%55 = OpIAdd %uint %48 %uint_1
+%56 = OpIEqual %bool %55 %49
+OpBranchConditional %56 %45 %32
+%45 = OpLabel
+%57 = OpAccessChain %_ptr_StorageBuffer_ulong %36 %uint_0 %48
+%58 = OpLoad %ulong %57
+%59 = OpISub %ulong %29 %58
+%60 = OpUConvert %ulong %30
+%61 = OpIAdd %ulong %59 %60
+%62 = OpISub %uint %48 %uint_1
+%63 = OpIAdd %uint %62 %41
+%64 = OpAccessChain %_ptr_StorageBuffer_ulong %36 %uint_0 %63
+%65 = OpLoad %ulong %64
+%66 = OpULessThanEqual %bool %61 %65
+OpReturnValue %66
 OpFunctionEnd
-%69 = OpFunction %void None %70
-%71 = OpFunctionParameter %uint
-%72 = OpFunctionParameter %uint
-%73 = OpFunctionParameter %uint
-%74 = OpFunctionParameter %uint
-%75 = OpLabel
-%81 = OpAccessChain %_ptr_StorageBuffer_uint %79 %uint_0
-%83 = OpAtomicIAdd %uint %81 %uint_4 %uint_0 %uint_10
-%84 = OpIAdd %uint %83 %uint_10
-%85 = OpArrayLength %uint %79 1
-%86 = OpULessThanEqual %bool %84 %85
-OpSelectionMerge %87 None
-OpBranchConditional %86 %88 %87
-%88 = OpLabel
-%89 = OpIAdd %uint %83 %uint_0
-%90 = OpAccessChain %_ptr_StorageBuffer_uint %79 %uint_1 %89
-OpStore %90 %uint_10
-%92 = OpIAdd %uint %83 %uint_1
-%93 = OpAccessChain %_ptr_StorageBuffer_uint %79 %uint_1 %92
-OpStore %93 %uint_23
-%94 = OpIAdd %uint %83 %uint_2
-%95 = OpAccessChain %_ptr_StorageBuffer_uint %79 %uint_1 %94
-OpStore %95 %71
-%98 = OpIAdd %uint %83 %uint_3
-%99 = OpAccessChain %_ptr_StorageBuffer_uint %79 %uint_1 %98
-OpStore %99 %uint_5
-%103 = OpLoad %v3uint %gl_GlobalInvocationID
-%104 = OpCompositeExtract %uint %103 0
-%105 = OpCompositeExtract %uint %103 1
-%106 = OpCompositeExtract %uint %103 2
-%107 = OpIAdd %uint %83 %uint_4
-%108 = OpAccessChain %_ptr_StorageBuffer_uint %79 %uint_1 %107
-OpStore %108 %104
-%109 = OpIAdd %uint %83 %uint_5
-%110 = OpAccessChain %_ptr_StorageBuffer_uint %79 %uint_1 %109
-OpStore %110 %105
-%112 = OpIAdd %uint %83 %uint_6
-%113 = OpAccessChain %_ptr_StorageBuffer_uint %79 %uint_1 %112
-OpStore %113 %106
-%115 = OpIAdd %uint %83 %uint_7
-%116 = OpAccessChain %_ptr_StorageBuffer_uint %79 %uint_1 %115
-OpStore %116 %72
-%118 = OpIAdd %uint %83 %uint_8
-%119 = OpAccessChain %_ptr_StorageBuffer_uint %79 %uint_1 %118
-OpStore %119 %73
-%121 = OpIAdd %uint %83 %uint_9
-%122 = OpAccessChain %_ptr_StorageBuffer_uint %79 %uint_1 %121
-OpStore %122 %74
-OpBranch %87
-%87 = OpLabel
+%75 = OpFunction %void None %76
+%77 = OpFunctionParameter %uint
+%78 = OpFunctionParameter %uint
+%79 = OpFunctionParameter %uint
+%80 = OpFunctionParameter %uint
+%81 = OpLabel
+%87 = OpAccessChain %_ptr_StorageBuffer_uint %85 %uint_0
+%89 = OpAtomicIAdd %uint %87 %uint_4 %uint_0 %uint_10
+%90 = OpIAdd %uint %89 %uint_10
+%91 = OpArrayLength %uint %85 1
+%92 = OpULessThanEqual %bool %90 %91
+OpSelectionMerge %93 None
+OpBranchConditional %92 %94 %93
+%94 = OpLabel
+%95 = OpIAdd %uint %89 %uint_0
+%96 = OpAccessChain %_ptr_StorageBuffer_uint %85 %uint_1 %95
+OpStore %96 %uint_10
+%98 = OpIAdd %uint %89 %uint_1
+%99 = OpAccessChain %_ptr_StorageBuffer_uint %85 %uint_1 %98
+OpStore %99 %uint_23
+%100 = OpIAdd %uint %89 %uint_2
+%101 = OpAccessChain %_ptr_StorageBuffer_uint %85 %uint_1 %100
+OpStore %101 %77
+%104 = OpIAdd %uint %89 %uint_3
+%105 = OpAccessChain %_ptr_StorageBuffer_uint %85 %uint_1 %104
+OpStore %105 %uint_5
+%109 = OpLoad %v3uint %gl_GlobalInvocationID
+%110 = OpCompositeExtract %uint %109 0
+%111 = OpCompositeExtract %uint %109 1
+%112 = OpCompositeExtract %uint %109 2
+%113 = OpIAdd %uint %89 %uint_4
+%114 = OpAccessChain %_ptr_StorageBuffer_uint %85 %uint_1 %113
+OpStore %114 %110
+%115 = OpIAdd %uint %89 %uint_5
+%116 = OpAccessChain %_ptr_StorageBuffer_uint %85 %uint_1 %115
+OpStore %116 %111
+%118 = OpIAdd %uint %89 %uint_6
+%119 = OpAccessChain %_ptr_StorageBuffer_uint %85 %uint_1 %118
+OpStore %119 %112
+%121 = OpIAdd %uint %89 %uint_7
+%122 = OpAccessChain %_ptr_StorageBuffer_uint %85 %uint_1 %121
+OpStore %122 %78
+%124 = OpIAdd %uint %89 %uint_8
+%125 = OpAccessChain %_ptr_StorageBuffer_uint %85 %uint_1 %124
+OpStore %125 %79
+%127 = OpIAdd %uint %89 %uint_9
+%128 = OpAccessChain %_ptr_StorageBuffer_uint %85 %uint_1 %127
+OpStore %128 %80
+OpBranch %93
+%93 = OpLabel
 OpReturn
 OpFunctionEnd
 )";
@@ -406,16 +412,16 @@ OpDecorate %rootBlock Block
 OpDecorate %r DescriptorSet 0
 OpDecorate %r Binding 0
 OpDecorate %_runtimearr_ulong ArrayStride 8
-OpDecorate %_struct_45 Block
-OpMemberDecorate %_struct_45 0 Offset 0
-OpDecorate %47 DescriptorSet 7
-OpDecorate %47 Binding 2
+OpDecorate %_struct_40 Block
+OpMemberDecorate %_struct_40 0 Offset 0
+OpDecorate %42 DescriptorSet 7
+OpDecorate %42 Binding 2
 OpDecorate %_runtimearr_uint ArrayStride 4
-OpDecorate %_struct_84 Block
-OpMemberDecorate %_struct_84 0 Offset 0
-OpMemberDecorate %_struct_84 1 Offset 4
-OpDecorate %86 DescriptorSet 7
-OpDecorate %86 Binding 0
+OpDecorate %_struct_90 Block
+OpMemberDecorate %_struct_90 0 Offset 0
+OpMemberDecorate %_struct_90 1 Offset 4
+OpDecorate %92 DescriptorSet 7
+OpDecorate %92 Binding 0
 OpDecorate %gl_GlobalInvocationID BuiltIn GlobalInvocationId
 %void = OpTypeVoid
 %3 = OpTypeFunction %void
@@ -438,19 +444,19 @@ OpTypeForwardPointer %_ptr_PhysicalStorageBuffer_blockType PhysicalStorageBuffer
 %uint_8 = OpConstant %uint 8
 %bool = OpTypeBool
 %34 = OpTypeFunction %bool %ulong %uint
-%uint_1 = OpConstant %uint 1
 %_runtimearr_ulong = OpTypeRuntimeArray %ulong
-%_struct_45 = OpTypeStruct %_runtimearr_ulong
-%_ptr_StorageBuffer__struct_45 = OpTypePointer StorageBuffer %_struct_45
-%47 = OpVariable %_ptr_StorageBuffer__struct_45 StorageBuffer
+%_struct_40 = OpTypeStruct %_runtimearr_ulong
+%_ptr_StorageBuffer__struct_40 = OpTypePointer StorageBuffer %_struct_40
+%42 = OpVariable %_ptr_StorageBuffer__struct_40 StorageBuffer
 %_ptr_StorageBuffer_ulong = OpTypePointer StorageBuffer %ulong
 %uint_0 = OpConstant %uint 0
+%uint_1 = OpConstant %uint 1
 %uint_32 = OpConstant %uint 32
-%77 = OpTypeFunction %void %uint %uint %uint %uint
+%83 = OpTypeFunction %void %uint %uint %uint %uint
 %_runtimearr_uint = OpTypeRuntimeArray %uint
-%_struct_84 = OpTypeStruct %uint %_runtimearr_uint
-%_ptr_StorageBuffer__struct_84 = OpTypePointer StorageBuffer %_struct_84
-%86 = OpVariable %_ptr_StorageBuffer__struct_84 StorageBuffer
+%_struct_90 = OpTypeStruct %uint %_runtimearr_uint
+%_ptr_StorageBuffer__struct_90 = OpTypePointer StorageBuffer %_struct_90
+%92 = OpVariable %_ptr_StorageBuffer__struct_90 StorageBuffer
 %_ptr_StorageBuffer_uint = OpTypePointer StorageBuffer %uint
 %uint_10 = OpConstant %uint 10
 %uint_4 = OpConstant %uint 4
@@ -464,7 +470,7 @@ OpTypeForwardPointer %_ptr_PhysicalStorageBuffer_blockType PhysicalStorageBuffer
 %uint_7 = OpConstant %uint 7
 %uint_9 = OpConstant %uint 9
 %uint_44 = OpConstant %uint 44
-%132 = OpConstantNull %ulong
+%138 = OpConstantNull %ulong
 %uint_46 = OpConstant %uint 46
 )";
 
@@ -488,36 +494,36 @@ OpFunctionEnd
 %17 = OpLoad %_ptr_PhysicalStorageBuffer_blockType %16
 %21 = OpAccessChain %_ptr_PhysicalStorageBuffer__ptr_PhysicalStorageBuffer_blockType %17 %int_1
 %30 = OpConvertPtrToU %ulong %21
-%67 = OpFunctionCall %bool %32 %30 %uint_8
-OpSelectionMerge %68 None
-OpBranchConditional %67 %69 %70
-%69 = OpLabel
-%71 = OpLoad %_ptr_PhysicalStorageBuffer_blockType %21 Aligned 8
-OpBranch %68
-%70 = OpLabel
-%72 = OpUConvert %uint %30
-%74 = OpShiftRightLogical %ulong %30 %uint_32
-%75 = OpUConvert %uint %74
-%131 = OpFunctionCall %void %76 %uint_44 %uint_2 %72 %75
-%133 = OpConvertUToPtr %_ptr_PhysicalStorageBuffer_blockType %132
-OpBranch %68
-%68 = OpLabel
-%134 = OpPhi %_ptr_PhysicalStorageBuffer_blockType %71 %69 %133 %70
-%26 = OpAccessChain %_ptr_PhysicalStorageBuffer_int %134 %int_0
-%135 = OpConvertPtrToU %ulong %26
-%136 = OpFunctionCall %bool %32 %135 %uint_4
-OpSelectionMerge %137 None
-OpBranchConditional %136 %138 %139
-%138 = OpLabel
+%73 = OpFunctionCall %bool %32 %30 %uint_8
+OpSelectionMerge %74 None
+OpBranchConditional %73 %75 %76
+%75 = OpLabel
+%77 = OpLoad %_ptr_PhysicalStorageBuffer_blockType %21 Aligned 8
+OpBranch %74
+%76 = OpLabel
+%78 = OpUConvert %uint %30
+%80 = OpShiftRightLogical %ulong %30 %uint_32
+%81 = OpUConvert %uint %80
+%137 = OpFunctionCall %void %82 %uint_44 %uint_2 %78 %81
+%139 = OpConvertUToPtr %_ptr_PhysicalStorageBuffer_blockType %138
+OpBranch %74
+%74 = OpLabel
+%140 = OpPhi %_ptr_PhysicalStorageBuffer_blockType %77 %75 %139 %76
+%26 = OpAccessChain %_ptr_PhysicalStorageBuffer_int %140 %int_0
+%141 = OpConvertPtrToU %ulong %26
+%142 = OpFunctionCall %bool %32 %141 %uint_4
+OpSelectionMerge %143 None
+OpBranchConditional %142 %144 %145
+%144 = OpLabel
 OpStore %26 %int_531 Aligned 16
-OpBranch %137
-%139 = OpLabel
-%140 = OpUConvert %uint %135
-%141 = OpShiftRightLogical %ulong %135 %uint_32
-%142 = OpUConvert %uint %141
-%144 = OpFunctionCall %void %76 %uint_46 %uint_2 %140 %142
-OpBranch %137
-%137 = OpLabel
+OpBranch %143
+%145 = OpLabel
+%146 = OpUConvert %uint %141
+%147 = OpShiftRightLogical %ulong %141 %uint_32
+%148 = OpUConvert %uint %147
+%150 = OpFunctionCall %void %82 %uint_46 %uint_2 %146 %148
+OpBranch %143
+%143 = OpLabel
 OpReturn
 OpFunctionEnd
 )";
@@ -527,84 +533,90 @@ OpFunctionEnd
 %35 = OpFunctionParameter %ulong
 %36 = OpFunctionParameter %uint
 %37 = OpLabel
+%45 = OpAccessChain %_ptr_StorageBuffer_ulong %42 %uint_0 %uint_0
+%46 = OpLoad %ulong %45
+%47 = OpUConvert %uint %46
+%49 = OpISub %uint %47 %uint_1
 OpBranch %38
 %38 = OpLabel
-%40 = OpPhi %uint %uint_1 %37 %41 %39
-OpLoopMerge %43 %39 None
-OpBranch %39
-%39 = OpLabel
-%41 = OpIAdd %uint %40 %uint_1
-%50 = OpAccessChain %_ptr_StorageBuffer_ulong %47 %uint_0 %41
-%51 = OpLoad %ulong %50
-%52 = OpUGreaterThan %bool %51 %35
-OpBranchConditional %52 %43 %38
-%43 = OpLabel
-%53 = OpISub %uint %41 %uint_1
-%54 = OpAccessChain %_ptr_StorageBuffer_ulong %47 %uint_0 %53
-%55 = OpLoad %ulong %54
-%56 = OpISub %ulong %35 %55
-%57 = OpUConvert %ulong %36
-%58 = OpIAdd %ulong %56 %57
-%59 = OpAccessChain %_ptr_StorageBuffer_ulong %47 %uint_0 %uint_0
-%60 = OpLoad %ulong %59
-%61 = OpUConvert %uint %60
-%62 = OpISub %uint %53 %uint_1
-%63 = OpIAdd %uint %62 %61
-%64 = OpAccessChain %_ptr_StorageBuffer_ulong %47 %uint_0 %63
-%65 = OpLoad %ulong %64
-%66 = OpULessThanEqual %bool %58 %65
-OpReturnValue %66
+%52 = OpPhi %uint %uint_1 %37 %54 %50
+%53 = OpPhi %uint %49 %37 %55 %50
+OpLoopMerge %51 %50 None
+OpBranch %50
+%50 = OpLabel
+%56 = OpIAdd %uint %52 %53
+%57 = OpShiftRightLogical %uint %56 %uint_1
+%58 = OpAccessChain %_ptr_StorageBuffer_ulong %42 %uint_0 %57
+%59 = OpLoad %ulong %58
+%60 = OpUGreaterThan %bool %59 %35
+%54 = OpSelect %uint %60 %52 %57
+%55 = OpSelect %uint %60 %57 %53
+%61 = OpIAdd %uint %54 %uint_1
+%62 = OpIEqual %bool %61 %55
+OpBranchConditional %62 %51 %38
+%51 = OpLabel
+%63 = OpAccessChain %_ptr_StorageBuffer_ulong %42 %uint_0 %54
+%64 = OpLoad %ulong %63
+%65 = OpISub %ulong %35 %64
+%66 = OpUConvert %ulong %36
+%67 = OpIAdd %ulong %65 %66
+%68 = OpISub %uint %54 %uint_1
+%69 = OpIAdd %uint %68 %47
+%70 = OpAccessChain %_ptr_StorageBuffer_ulong %42 %uint_0 %69
+%71 = OpLoad %ulong %70
+%72 = OpULessThanEqual %bool %67 %71
+OpReturnValue %72
 OpFunctionEnd
-%76 = OpFunction %void None %77
-%78 = OpFunctionParameter %uint
-%79 = OpFunctionParameter %uint
-%80 = OpFunctionParameter %uint
-%81 = OpFunctionParameter %uint
-%82 = OpLabel
-%88 = OpAccessChain %_ptr_StorageBuffer_uint %86 %uint_0
-%91 = OpAtomicIAdd %uint %88 %uint_4 %uint_0 %uint_10
-%92 = OpIAdd %uint %91 %uint_10
-%93 = OpArrayLength %uint %86 1
-%94 = OpULessThanEqual %bool %92 %93
-OpSelectionMerge %95 None
-OpBranchConditional %94 %96 %95
-%96 = OpLabel
-%97 = OpIAdd %uint %91 %uint_0
-%98 = OpAccessChain %_ptr_StorageBuffer_uint %86 %uint_1 %97
-OpStore %98 %uint_10
-%100 = OpIAdd %uint %91 %uint_1
-%101 = OpAccessChain %_ptr_StorageBuffer_uint %86 %uint_1 %100
-OpStore %101 %uint_23
-%102 = OpIAdd %uint %91 %uint_2
-%103 = OpAccessChain %_ptr_StorageBuffer_uint %86 %uint_1 %102
-OpStore %103 %78
-%106 = OpIAdd %uint %91 %uint_3
-%107 = OpAccessChain %_ptr_StorageBuffer_uint %86 %uint_1 %106
-OpStore %107 %uint_5
-%111 = OpLoad %v3uint %gl_GlobalInvocationID
-%112 = OpCompositeExtract %uint %111 0
-%113 = OpCompositeExtract %uint %111 1
-%114 = OpCompositeExtract %uint %111 2
-%115 = OpIAdd %uint %91 %uint_4
-%116 = OpAccessChain %_ptr_StorageBuffer_uint %86 %uint_1 %115
-OpStore %116 %112
-%117 = OpIAdd %uint %91 %uint_5
-%118 = OpAccessChain %_ptr_StorageBuffer_uint %86 %uint_1 %117
-OpStore %118 %113
-%120 = OpIAdd %uint %91 %uint_6
-%121 = OpAccessChain %_ptr_StorageBuffer_uint %86 %uint_1 %120
-OpStore %121 %114
-%123 = OpIAdd %uint %91 %uint_7
-%124 = OpAccessChain %_ptr_StorageBuffer_uint %86 %uint_1 %123
-OpStore %124 %79
-%125 = OpIAdd %uint %91 %uint_8
-%126 = OpAccessChain %_ptr_StorageBuffer_uint %86 %uint_1 %125
-OpStore %126 %80
-%128 = OpIAdd %uint %91 %uint_9
-%129 = OpAccessChain %_ptr_StorageBuffer_uint %86 %uint_1 %128
-OpStore %129 %81
-OpBranch %95
-%95 = OpLabel
+%82 = OpFunction %void None %83
+%84 = OpFunctionParameter %uint
+%85 = OpFunctionParameter %uint
+%86 = OpFunctionParameter %uint
+%87 = OpFunctionParameter %uint
+%88 = OpLabel
+%94 = OpAccessChain %_ptr_StorageBuffer_uint %92 %uint_0
+%97 = OpAtomicIAdd %uint %94 %uint_4 %uint_0 %uint_10
+%98 = OpIAdd %uint %97 %uint_10
+%99 = OpArrayLength %uint %92 1
+%100 = OpULessThanEqual %bool %98 %99
+OpSelectionMerge %101 None
+OpBranchConditional %100 %102 %101
+%102 = OpLabel
+%103 = OpIAdd %uint %97 %uint_0
+%104 = OpAccessChain %_ptr_StorageBuffer_uint %92 %uint_1 %103
+OpStore %104 %uint_10
+%106 = OpIAdd %uint %97 %uint_1
+%107 = OpAccessChain %_ptr_StorageBuffer_uint %92 %uint_1 %106
+OpStore %107 %uint_23
+%108 = OpIAdd %uint %97 %uint_2
+%109 = OpAccessChain %_ptr_StorageBuffer_uint %92 %uint_1 %108
+OpStore %109 %84
+%112 = OpIAdd %uint %97 %uint_3
+%113 = OpAccessChain %_ptr_StorageBuffer_uint %92 %uint_1 %112
+OpStore %113 %uint_5
+%117 = OpLoad %v3uint %gl_GlobalInvocationID
+%118 = OpCompositeExtract %uint %117 0
+%119 = OpCompositeExtract %uint %117 1
+%120 = OpCompositeExtract %uint %117 2
+%121 = OpIAdd %uint %97 %uint_4
+%122 = OpAccessChain %_ptr_StorageBuffer_uint %92 %uint_1 %121
+OpStore %122 %118
+%123 = OpIAdd %uint %97 %uint_5
+%124 = OpAccessChain %_ptr_StorageBuffer_uint %92 %uint_1 %123
+OpStore %124 %119
+%126 = OpIAdd %uint %97 %uint_6
+%127 = OpAccessChain %_ptr_StorageBuffer_uint %92 %uint_1 %126
+OpStore %127 %120
+%129 = OpIAdd %uint %97 %uint_7
+%130 = OpAccessChain %_ptr_StorageBuffer_uint %92 %uint_1 %129
+OpStore %130 %85
+%131 = OpIAdd %uint %97 %uint_8
+%132 = OpAccessChain %_ptr_StorageBuffer_uint %92 %uint_1 %131
+OpStore %132 %86
+%134 = OpIAdd %uint %97 %uint_9
+%135 = OpAccessChain %_ptr_StorageBuffer_uint %92 %uint_1 %134
+OpStore %135 %87
+OpBranch %101
+%101 = OpLabel
 OpReturn
 OpFunctionEnd
 )";
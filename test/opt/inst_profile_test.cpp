@@ -0,0 +1,158 @@
+// Copyright (c) 2019 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// Profiling Instrumentation Tests.
+
+#include <string>
+
+#include "gmock/gmock.h"
+#include "test/opt/pass_fixture.h"
+#include "test/opt/pass_utils.h"
+
+namespace spvtools {
+namespace opt {
+namespace {
+
+using InstProfileTest = PassTest<::testing::Test>;
+
+TEST_F(InstProfileTest, FunctionAndSelection) {
+  const std::string text = R"(
+; CHECK: OpCapability ShaderClockKHR
+; CHECK-NEXT: OpCapability GroupNonUniform
+; CHECK-NEXT: OpCapability GroupNonUniformArithmetic
+; CHECK: OpExtension "SPV_KHR_shader_clock"
+; CHECK: OpDecorate [[buf:%\w+]] DescriptorSet 7
+; CHECK-NEXT: OpDecorate [[buf]] Binding 3
+; CHECK: %main = OpFunction
+; CHECK-NEXT: %entry = OpLabel
+; CHECK-NEXT: [[fclock:%\w+]] = OpReadClockKHR %v2uint %uint_3
+; CHECK-NEXT: [[fstart:%\w+]] = OpCompositeExtract %uint [[fclock]] 0
+; CHECK-NEXT: [[sclock:%\w+]] = OpReadClockKHR %v2uint %uint_3
+; CHECK-NEXT: [[sstart:%\w+]] = OpCompositeExtract %uint [[sclock]] 0
+; CHECK-NEXT: OpSelectionMerge %merge None
+; CHECK: %merge = OpLabel
+; CHECK-NEXT: {{%\w+}} = OpFunctionCall %void [[profile:%\w+]] %uint_0 %uint_{{\d+}} [[fstart]]
+; CHECK-NEXT: {{%\w+}} = OpFunctionCall %void [[profile]] %uint_1 %uint_{{\d+}} [[sstart]]
+; CHECK-NEXT: OpReturn
+; CHECK: [[profile]] = OpFunction %void None
+; CHECK-NEXT: {{%\w+}} = OpFunctionParameter %uint
+; CHECK-NEXT: [[inst:%\w+]] = OpFunctionParameter %uint
+; CHECK-NEXT: [[start:%\w+]] = OpFunctionParameter %uint
+; CHECK-NEXT: {{%\w+}} = OpLabel
+; CHECK-NEXT: [[clock:%\w+]] = OpReadClockKHR %v2uint %uint_3
+; CHECK-NEXT: [[end:%\w+]] = OpCompositeExtract %uint [[clock]] 0
+; CHECK-NEXT: [[delta:%\w+]] = OpISub %uint [[end]] [[start]]
+; CHECK-NEXT: [[cycles:%\w+]] = OpGroupNonUniformIAdd %uint %uint_3 Reduce [[delta]]
+; CHECK-NEXT: [[count:%\w+]] = OpGroupNonUniformIAdd %uint %uint_3 Reduce %uint_1
+; CHECK-NEXT: [[elect:%\w+]] = OpGroupNonUniformElect %bool %uint_3
+; CHECK: OpArrayLength %uint [[buf]] 1
+; CHECK: OpLogicalAnd %bool [[elect]]
+; CHECK-NEXT: OpSelectionMerge [[merge:%\w+]] None
+; CHECK-NEXT: OpBranchConditional {{%\w+}} {{%\w+}} [[merge]]
+; CHECK: OpAtomicStore {{%\w+}} %uint_1 %uint_0 [[inst]]
+; CHECK: OpAtomicIAdd %uint {{%\w+}} %uint_1 %uint_0 [[count]]
+; CHECK: [[old:%\w+]] = OpAtomicIAdd %uint {{%\w+}} %uint_1 %uint_0 [[cycles]]
+; CHECK-NEXT: [[new:%\w+]] = OpIAdd %uint [[old]] [[cycles]]
+; CHECK-NEXT: [[wrapped:%\w+]] = OpULessThan %bool [[new]] [[old]]
+; CHECK-NEXT: [[carry:%\w+]] = OpSelect %uint [[wrapped]] %uint_1 %uint_0
+; CHECK: OpAtomicIAdd %uint {{%\w+}} %uint_1 %uint_0 [[carry]]
+; CHECK: [[merge]] = OpLabel
+; CHECK-NEXT: OpReturn
+               OpCapability Shader
+               OpMemoryModel Logical GLSL450
+               OpEntryPoint GLCompute %main "main"
+               OpExecutionMode %main LocalSize 1 1 1
+       %void = OpTypeVoid
+          %3 = OpTypeFunction %void
+       %bool = OpTypeBool
+       %true = OpConstantTrue %bool
+       %main = OpFunction %void None %3
+      %entry = OpLabel
+               OpSelectionMerge %merge None
+               OpBranchConditional %true %then %merge
+       %then = OpLabel
+               OpBranch %merge
+      %merge = OpLabel
+               OpReturn
+               OpFunctionEnd
+)";
+
+  SetTargetEnv(SPV_ENV_UNIVERSAL_1_3);
+  SinglePassRunAndMatch<InstProfilePass>(text, false, 7u, 23u);
+}
+
+TEST_F(InstProfileTest, LoopIsTimedFromItsEnteringBlock) {
+  const std::string text = R"(
+; CHECK: %entry = OpLabel
+; CHECK-NEXT: OpReadClockKHR
+; CHECK-NEXT: OpCompositeExtract
+; CHECK-NEXT: [[lclock:%\w+]] = OpReadClockKHR %v2uint %uint_3
+; CHECK-NEXT: [[lstart:%\w+]] = OpCompositeExtract %uint [[lclock]] 0
+; CHECK-NEXT: OpBranch %header
+; CHECK: %header = OpLabel
+; CHECK-NEXT: OpLoopMerge %merge %continue None
+; CHECK: %merge = OpLabel
+; CHECK-NEXT: {{%\w+}} = OpFunctionCall %void {{%\w+}} %uint_0
+; CHECK-NEXT: {{%\w+}} = OpFunctionCall %void {{%\w+}} %uint_1 %uint_{{\d+}} [[lstart]]
+; CHECK-NEXT: OpReturn
+               OpCapability Shader
+               OpMemoryModel Logical GLSL450
+               OpEntryPoint GLCompute %main "main"
+               OpExecutionMode %main LocalSize 1 1 1
+       %void = OpTypeVoid
+          %3 = OpTypeFunction %void
+       %bool = OpTypeBool
+       %true = OpConstantTrue %bool
+       %main = OpFunction %void None %3
+      %entry = OpLabel
+               OpBranch %header
+     %header = OpLabel
+               OpLoopMerge %merge %continue None
+               OpBranchConditional %true %body %merge
+       %body = OpLabel
+               OpBranch %continue
+   %continue = OpLabel
+               OpBranch %header
+      %merge = OpLabel
+               OpReturn
+               OpFunctionEnd
+)";
+
+  SetTargetEnv(SPV_ENV_UNIVERSAL_1_3);
+  SinglePassRunAndMatch<InstProfilePass>(text, false, 7u, 23u);
+}
+
+TEST_F(InstProfileTest, RequiresSpirv13) {
+  const std::string text = R"(
+               OpCapability Shader
+               OpMemoryModel Logical GLSL450
+               OpEntryPoint GLCompute %main "main"
+               OpExecutionMode %main LocalSize 1 1 1
+       %void = OpTypeVoid
+          %3 = OpTypeFunction %void
+       %main = OpFunction %void None %3
+      %entry = OpLabel
+               OpReturn
+               OpFunctionEnd
+)";
+
+  SetTargetEnv(SPV_ENV_UNIVERSAL_1_0);
+  auto result = SinglePassRunAndDisassemble<InstProfilePass>(
+      text, /* skip_nop = */ true, /* do_validation = */ false, 7u, 23u);
+  EXPECT_EQ(Pass::Status::SuccessWithoutChange, std::get<1>(result));
+}
+
+}  // namespace
+}  // namespace opt
+}  // namespace spvtools
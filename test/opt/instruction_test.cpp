@@ -12,6 +12,7 @@
 // See the License for the specific language governing permissions and
 // limitations under the License.
 
+#include <functional>
 #include <memory>
 #include <string>
 #include <vector>
@@ -238,6 +239,26 @@ TEST(InstructionTest, ForInIdNonstandardIdTypes) {
   EXPECT_THAT(ids, Eq(std::vector<uint32_t>{100, 101, 102}));
 }
 
+TEST(InstructionTest, ForInIdWithCallables) {
+  IRContext context(SPV_ENV_UNIVERSAL_1_2, nullptr);
+  Instruction inst(&context, kSampleAccessChainInstruction);
+
+  // A std::function is accepted like any other callable.
+  std::vector<uint32_t> ids;
+  const std::function<void(const uint32_t*)> collect =
+      [&ids](const uint32_t* idptr) { ids.push_back(*idptr); };
+  static_cast<const Instruction&>(inst).ForEachInId(collect);
+  EXPECT_THAT(ids, Eq(std::vector<uint32_t>{102, 103, 104, 105}));
+
+  // Stops at the first id for which the callable returns false.
+  ids.clear();
+  EXPECT_FALSE(inst.WhileEachInId([&ids](uint32_t* idptr) {
+    ids.push_back(*idptr);
+    return *idptr != 103;
+  }));
+  EXPECT_THAT(ids, Eq(std::vector<uint32_t>{102, 103}));
+}
+
 TEST(InstructionTest, UniqueIds) {
   IRContext context(SPV_ENV_UNIVERSAL_1_2, nullptr);
   Instruction inst1(&context);
@@ -15,13 +15,16 @@
 #include "source/opt/ir_context.h"
 
 #include <algorithm>
+#include <iterator>
 #include <memory>
 #include <string>
 #include <utility>
+#include <vector>
 
 #include "gmock/gmock.h"
 #include "gtest/gtest.h"
 #include "source/opt/pass.h"
+#include "source/util/parallel.h"
 #include "test/opt/pass_fixture.h"
 #include "test/opt/pass_utils.h"
 
@@ -133,7 +136,10 @@ TEST_F(IRContextTest, NoneValidAfterPassWithChange) {
   EXPECT_EQ(s, Pass::Status::SuccessWithChange);
   for (Analysis i = IRContext::kAnalysisBegin; i < IRContext::kAnalysisEnd;
        i <<= 1) {
-    EXPECT_FALSE(localContext.AreAnalysesValid(i));
+    // The instruction-block mapping is kept in the instructions, so it is
+    // always valid.
+    EXPECT_EQ(i == IRContext::kAnalysisInstrToBlockMapping,
+              localContext.AreAnalysesValid(i));
   }
 }
 
@@ -172,7 +178,8 @@ TEST_F(IRContextTest, PreserveFirstOnlyAfterPassWithChange) {
   EXPECT_TRUE(localContext.AreAnalysesValid(IRContext::kAnalysisBegin));
   for (Analysis i = IRContext::kAnalysisBegin << 1; i < IRContext::kAnalysisEnd;
        i <<= 1) {
-    EXPECT_FALSE(localContext.AreAnalysesValid(i));
+    EXPECT_EQ(i == IRContext::kAnalysisInstrToBlockMapping,
+              localContext.AreAnalysesValid(i));
   }
 }
 
@@ -695,6 +702,302 @@ OpFunctionEnd)";
   EXPECT_FALSE(ctx->AreAnalysesValid(IRContext::kAnalysisDominatorAnalysis));
 }
 
+const char kTwoFunctions[] = R"(
+OpCapability Shader
+OpCapability Linkage
+OpMemoryModel Logical GLSL450
+%1 = OpTypeVoid
+%2 = OpTypeFunction %1
+%3 = OpFunction %1 None %2
+%4 = OpLabel
+OpBranch %5
+%5 = OpLabel
+OpReturn
+OpFunctionEnd
+%6 = OpFunction %1 None %2
+%7 = OpLabel
+OpBranch %8
+%8 = OpLabel
+OpReturn
+OpFunctionEnd)";
+
+// Replaces the branch ending the entry block of |function| with a return.
+void ReturnFromEntryBlock(Function* function) {
+  Instruction* branch = function->begin()->terminator();
+  branch->SetOpcode(SpvOpReturn);
+  branch->SetInOperands({});
+}
+
+TEST_F(IRContextTest, InvalidateAnalysesForFunction) {
+  std::unique_ptr<IRContext> ctx =
+      BuildModule(SPV_ENV_UNIVERSAL_1_1, nullptr, kTwoFunctions,
+                  SPV_TEXT_TO_BINARY_OPTION_PRESERVE_NUMERIC_IDS);
+  Function* first = &*ctx->module()->begin();
+  Function* second = &*++ctx->module()->begin();
+  EXPECT_TRUE(ctx->GetDominatorAnalysis(first)->Dominates(4, 5));
+  DominatorAnalysis* second_dom = ctx->GetDominatorAnalysis(second);
+  ctx->get_def_use_mgr();
+
+  ReturnFromEntryBlock(first);
+  ctx->InvalidateAnalysesForFunction(
+      first, IRContext::kAnalysisCFG | IRContext::kAnalysisDefUse);
+
+  // The CFG and dominators are updated for |first| only.
+  EXPECT_TRUE(ctx->AreAnalysesValid(IRContext::kAnalysisCFG));
+  EXPECT_TRUE(ctx->AreAnalysesValid(IRContext::kAnalysisDominatorAnalysis));
+  EXPECT_FALSE(ctx->AreAnalysesValid(IRContext::kAnalysisDefUse));
+  EXPECT_TRUE(ctx->cfg()->preds(5).empty());
+  EXPECT_FALSE(ctx->GetDominatorAnalysis(first)->Dominates(4, 5));
+  EXPECT_EQ(second_dom, ctx->GetDominatorAnalysis(second));
+  EXPECT_TRUE(second_dom->Dominates(7, 8));
+}
+
+TEST_F(IRContextTest, BuildDominatorAnalysesOnThreads) {
+  std::unique_ptr<IRContext> ctx =
+      BuildModule(SPV_ENV_UNIVERSAL_1_1, nullptr, kTwoFunctions,
+                  SPV_TEXT_TO_BINARY_OPTION_PRESERVE_NUMERIC_IDS);
+  Function* first = &*ctx->module()->begin();
+  Function* second = &*++ctx->module()->begin();
+  DominatorAnalysis* first_dom = ctx->GetDominatorAnalysis(first);
+
+  ctx->set_num_threads(4);
+  ctx->BuildDominatorAnalyses(/* post_dominators = */ true);
+
+  // Existing trees are kept, and the missing ones are built.
+  EXPECT_EQ(first_dom, ctx->GetDominatorAnalysis(first));
+  EXPECT_TRUE(ctx->GetDominatorAnalysis(second)->Dominates(7, 8));
+  EXPECT_TRUE(ctx->GetPostDominatorAnalysis(first)->Dominates(5, 4));
+  EXPECT_TRUE(ctx->GetPostDominatorAnalysis(second)->Dominates(8, 7));
+  EXPECT_FALSE(ctx->GetPostDominatorAnalysis(second)->Dominates(7, 8));
+}
+
+TEST_F(IRContextTest, CountsAnalysisBuilds) {
+  std::unique_ptr<IRContext> ctx =
+      BuildModule(SPV_ENV_UNIVERSAL_1_1, nullptr, kTwoFunctions,
+                  SPV_TEXT_TO_BINARY_OPTION_PRESERVE_NUMERIC_IDS);
+  EXPECT_EQ(0u, ctx->GetAnalysisStatistics(IRContext::kAnalysisDefUse).builds);
+
+  ctx->get_def_use_mgr();
+  ctx->get_def_use_mgr();
+  EXPECT_EQ(1u, ctx->GetAnalysisStatistics(IRContext::kAnalysisDefUse).builds);
+  ctx->InvalidateAnalyses(IRContext::kAnalysisDefUse);
+  ctx->get_def_use_mgr();
+  EXPECT_EQ(2u, ctx->GetAnalysisStatistics(IRContext::kAnalysisDefUse).builds);
+
+  // The dominator analysis counts each tree, and needs the CFG.
+  Function* first = &*ctx->module()->begin();
+  ctx->GetDominatorAnalysis(first);
+  ctx->BuildDominatorAnalyses(/* post_dominators = */ true);
+  const IRContext::AnalysisStatistics& dominators =
+      ctx->GetAnalysisStatistics(IRContext::kAnalysisDominatorAnalysis);
+  EXPECT_EQ(4u, dominators.builds);
+  EXPECT_EQ(1u, ctx->GetAnalysisStatistics(IRContext::kAnalysisCFG).builds);
+  EXPECT_EQ(0u, ctx->GetAnalysisStatistics(IRContext::kAnalysisTypes).builds);
+}
+
+TEST_F(IRContextTest, AnalysisNames) {
+  EXPECT_STREQ("def-use",
+               IRContext::GetAnalysisName(IRContext::kAnalysisDefUse));
+  EXPECT_STREQ("dominators", IRContext::GetAnalysisName(
+                                 IRContext::kAnalysisDominatorAnalysis));
+  EXPECT_STREQ("types", IRContext::GetAnalysisName(IRContext::kAnalysisTypes));
+}
+
+TEST_F(IRContextTest, ChangeNamesBeforeFirstQuery) {
+  const std::string text = R"(
+               OpCapability Shader
+               OpCapability Linkage
+               OpMemoryModel Logical GLSL450
+               OpName %1 "a"
+               OpName %2 "b"
+               OpMemberName %2 0 "x"
+          %1 = OpTypeInt 32 0
+          %2 = OpTypeStruct %1
+)";
+  std::unique_ptr<IRContext> ctx =
+      BuildModule(SPV_ENV_UNIVERSAL_1_2, nullptr, text,
+                  SPV_TEXT_TO_BINARY_OPTION_PRESERVE_NUMERIC_IDS);
+  Instruction* name_a = &*ctx->debug2_begin();
+  Instruction* name_b = name_a->NextNode();
+  Instruction* member_name = name_b->NextNode();
+
+  auto names = ctx->GetNames(1);
+  ASSERT_EQ(1, std::distance(names.begin(), names.end()));
+  EXPECT_EQ(name_a, names.begin()->second);
+
+  // The names of %2 were not added to the map yet.
+  ctx->KillInst(name_b);
+  std::unique_ptr<Instruction> name_c(name_a->Clone(ctx.get()));
+  name_c->SetInOperand(0, {2});
+  Instruction* name_c_ptr = name_c.get();
+  ctx->AddDebug2Inst(std::move(name_c));
+
+  names = ctx->GetNames(2);
+  ASSERT_EQ(2, std::distance(names.begin(), names.end()));
+  EXPECT_EQ(member_name, names.begin()->second);
+  EXPECT_EQ(name_c_ptr, std::next(names.begin())->second);
+  EXPECT_EQ(1u,
+            ctx->GetAnalysisStatistics(IRContext::kAnalysisNameMap).builds);
+}
+
+TEST_F(IRContextTest, AllocatesNodesInPools) {
+  std::unique_ptr<IRContext> ctx =
+      BuildModule(SPV_ENV_UNIVERSAL_1_1, nullptr, kTwoFunctions,
+                  SPV_TEXT_TO_BINARY_OPTION_PRESERVE_NUMERIC_IDS);
+  EXPECT_EQ(4u, ctx->block_pool()->num_live_nodes());
+  const size_t num_insts = ctx->instruction_pool()->num_live_nodes();
+  EXPECT_LT(0u, num_insts);
+
+  std::unique_ptr<Instruction> clone(
+      ctx->get_def_use_mgr()->GetDef(1)->Clone(ctx.get()));
+  EXPECT_EQ(num_insts + 1, ctx->instruction_pool()->num_live_nodes());
+
+  // A node may outlive its context.
+  ctx.reset();
+  EXPECT_EQ(SpvOpTypeVoid, clone->opcode());
+}
+
+// A pass that changes the control flow of the first function and records it.
+class DummyPassChangesFirstFunction : public Pass {
+ public:
+  const char* name() const override { return "dummy-pass"; }
+  Status Process() override {
+    Function* first = &*get_module()->begin();
+    ReturnFromEntryBlock(first);
+    get_def_use_mgr()->AnalyzeInstUse(first->begin()->terminator());
+    RecordChangedFunction(first);
+    return Status::SuccessWithChange;
+  }
+  Analysis GetPreservedAnalyses() override {
+    return IRContext::kAnalysisDefUse;
+  }
+};
+
+TEST_F(IRContextTest, PassInvalidatesChangedFunctionsOnly) {
+  std::unique_ptr<IRContext> ctx =
+      BuildModule(SPV_ENV_UNIVERSAL_1_1, nullptr, kTwoFunctions,
+                  SPV_TEXT_TO_BINARY_OPTION_PRESERVE_NUMERIC_IDS);
+  Function* second = &*++ctx->module()->begin();
+  DominatorAnalysis* second_dom = ctx->GetDominatorAnalysis(second);
+  ctx->get_def_use_mgr();
+
+  DummyPassChangesFirstFunction pass;
+  EXPECT_EQ(Pass::Status::SuccessWithChange, pass.Run(ctx.get()));
+
+  EXPECT_TRUE(ctx->AreAnalysesValid(IRContext::kAnalysisDefUse));
+  EXPECT_TRUE(ctx->AreAnalysesValid(IRContext::kAnalysisCFG));
+  EXPECT_TRUE(ctx->AreAnalysesValid(IRContext::kAnalysisDominatorAnalysis));
+  EXPECT_TRUE(ctx->cfg()->preds(5).empty());
+  EXPECT_EQ(second_dom, ctx->GetDominatorAnalysis(second));
+}
+
+// The functions of kTwoFunctions, exported.
+const char kTwoExportedFunctions[] = R"(
+OpCapability Shader
+OpCapability Linkage
+OpMemoryModel Logical GLSL450
+OpDecorate %3 LinkageAttributes "first" Export
+OpDecorate %6 LinkageAttributes "second" Export
+%1 = OpTypeVoid
+%2 = OpTypeFunction %1
+%3 = OpFunction %1 None %2
+%4 = OpLabel
+OpBranch %5
+%5 = OpLabel
+OpReturn
+OpFunctionEnd
+%6 = OpFunction %1 None %2
+%7 = OpLabel
+OpBranch %8
+%8 = OpLabel
+OpReturn
+OpFunctionEnd)";
+
+TEST_F(IRContextTest, FrozenContextIsQueriedConcurrently) {
+  std::unique_ptr<IRContext> ctx =
+      BuildModule(SPV_ENV_UNIVERSAL_1_1, nullptr, kTwoExportedFunctions,
+                  SPV_TEXT_TO_BINARY_OPTION_PRESERVE_NUMERIC_IDS);
+  ctx->Freeze(IRContext::kAnalysisDefUse | IRContext::kAnalysisDecorations |
+              IRContext::kAnalysisDominatorAnalysis |
+              IRContext::kAnalysisNameMap);
+  EXPECT_TRUE(ctx->IsFrozen());
+  EXPECT_TRUE(ctx->AreAnalysesValid(IRContext::kAnalysisDefUse |
+                                    IRContext::kAnalysisCFG |
+                                    IRContext::kAnalysisDominatorAnalysis));
+  const uint64_t dominator_builds =
+      ctx->GetAnalysisStatistics(IRContext::kAnalysisDominatorAnalysis).builds;
+  EXPECT_EQ(4u, dominator_builds);
+
+  // Each query asks whether the entry block of a function dominates and
+  // post-dominates its other block, then reads the decorations of the
+  // function and the uses of its type.
+  std::vector<const Function*> functions;
+  for (const Function& function : *ctx->module()) {
+    functions.push_back(&function);
+  }
+  const size_t kNumQueries = 64;
+  std::vector<int> results(kNumQueries);
+  utils::ParallelFor(kNumQueries, 4, [&ctx, &functions, &results](size_t i) {
+    const Function* function = functions[i % functions.size()];
+    const uint32_t entry = function->begin()->id();
+    const uint32_t exit =
+        function->begin()->terminator()->GetSingleWordInOperand(0);
+    uint32_t num_uses = 0;
+    ctx->get_def_use_mgr()->ForEachUse(
+        function->DefInst().GetSingleWordInOperand(1),
+        [&num_uses](Instruction*, uint32_t) { ++num_uses; });
+    results[i] = ctx->get_def_use_mgr()->GetDef(exit) != nullptr &&
+                 ctx->GetDominatorAnalysis(function)->Dominates(entry, exit) &&
+                 !ctx->GetPostDominatorAnalysis(function)->Dominates(entry,
+                                                                      exit) &&
+                 ctx->get_decoration_mgr()
+                         ->GetDecorationsFor(function->result_id(), true)
+                         .size() == 1 &&
+                 num_uses == 2;
+  });
+  EXPECT_EQ(std::vector<int>(kNumQueries, 1), results);
+  EXPECT_EQ(
+      dominator_builds,
+      ctx->GetAnalysisStatistics(IRContext::kAnalysisDominatorAnalysis).builds);
+
+  ctx->Unfreeze();
+  EXPECT_FALSE(ctx->IsFrozen());
+  ctx->InvalidateAnalyses(IRContext::kAnalysisDominatorAnalysis);
+  EXPECT_FALSE(ctx->AreAnalysesValid(IRContext::kAnalysisDominatorAnalysis));
+}
+
+TEST_F(IRContextTest, InstrToBlockFollowsMovedInstructions) {
+  std::unique_ptr<IRContext> ctx =
+      BuildModule(SPV_ENV_UNIVERSAL_1_1, nullptr, kTwoFunctions,
+                  SPV_TEXT_TO_BINARY_OPTION_PRESERVE_NUMERIC_IDS);
+  BasicBlock* block4 = ctx->get_instr_block(4);
+  BasicBlock* block5 = ctx->get_instr_block(5);
+  ASSERT_NE(nullptr, block4);
+  ASSERT_NE(nullptr, block5);
+  EXPECT_EQ(4u, block4->id());
+  EXPECT_EQ(block4, ctx->get_instr_block(block4->terminator()));
+  EXPECT_EQ(nullptr, ctx->get_instr_block(1));
+
+  // The mapping survives invalidating every analysis.
+  ctx->InvalidateAnalyses(IRContext::kAnalysisInstrToBlockMapping);
+  EXPECT_TRUE(ctx->AreAnalysesValid(IRContext::kAnalysisInstrToBlockMapping));
+
+  // Moving an instruction places it in its new block.
+  Instruction* branch = block4->terminator();
+  branch->InsertBefore(block5->terminator());
+  EXPECT_EQ(block5, ctx->get_instr_block(branch));
+
+  // So does moving all the instructions of a block.
+  block4->AddInstructions(block5);
+  EXPECT_EQ(block4, ctx->get_instr_block(branch));
+  EXPECT_EQ(block4, ctx->get_instr_block(block4->terminator()));
+
+  // And cloning a block.
+  std::unique_ptr<BasicBlock> clone(block4->Clone(ctx.get()));
+  EXPECT_EQ(clone.get(), ctx->get_instr_block(clone->GetLabelInst()));
+  EXPECT_EQ(clone.get(), ctx->get_instr_block(clone->terminator()));
+}
+
 TEST_F(IRContextTest, AsanErrorTest) {
   std::string shader = R"(
                OpCapability Shader
@@ -749,6 +1052,53 @@ TEST_F(IRContextTest, AsanErrorTest) {
       << bb->id();  // Make sure asan does not complain about use after free.
 }
 
+TEST_F(IRContextTest, ReplaceManyIdsAndKill) {
+  const std::string text = R"(
+               OpCapability Shader
+               OpMemoryModel Logical GLSL450
+               OpEntryPoint Fragment %1 "main"
+               OpExecutionMode %1 OriginUpperLeft
+               OpName %4 "a"
+          %2 = OpTypeVoid
+          %3 = OpTypeFloat 32
+          %4 = OpConstant %3 1
+          %5 = OpConstant %3 2
+          %6 = OpConstant %3 1
+          %7 = OpConstant %3 2
+          %8 = OpTypeVector %3 2
+          %9 = OpConstantComposite %8 %6 %7
+         %10 = OpTypeFunction %2
+          %1 = OpFunction %2 None %10
+         %11 = OpLabel
+         %12 = OpFAdd %3 %6 %7
+               OpReturn
+               OpFunctionEnd
+)";
+
+  std::unique_ptr<IRContext> context =
+      BuildModule(SPV_ENV_UNIVERSAL_1_2, nullptr, text,
+                  SPV_TEXT_TO_BINARY_OPTION_PRESERVE_NUMERIC_IDS);
+  analysis::DefUseManager* def_use_mgr = context->get_def_use_mgr();
+
+  EXPECT_FALSE(context->ReplaceAllUsesWith({}));
+  EXPECT_TRUE(context->ReplaceAllUsesWith({{6, 4}, {7, 5}}));
+  context->KillInsts({def_use_mgr->GetDef(6), def_use_mgr->GetDef(7)});
+  EXPECT_TRUE(context->AreAnalysesValid(IRContext::kAnalysisDefUse));
+
+  Instruction* composite = def_use_mgr->GetDef(9);
+  EXPECT_EQ(composite->GetSingleWordInOperand(0), 4u);
+  EXPECT_EQ(composite->GetSingleWordInOperand(1), 5u);
+  Instruction* add = def_use_mgr->GetDef(12);
+  EXPECT_EQ(add->GetSingleWordInOperand(0), 4u);
+  EXPECT_EQ(add->GetSingleWordInOperand(1), 5u);
+  EXPECT_EQ(def_use_mgr->GetDef(6), nullptr);
+  EXPECT_EQ(def_use_mgr->NumUses(5), 2u);
+
+  // The uses must match what a fresh analysis finds.
+  analysis::DefUseManager fresh(context->module());
+  EXPECT_TRUE(*def_use_mgr == fresh);
+}
+
 }  // namespace
 }  // namespace opt
 }  // namespace spvtools
@@ -712,6 +712,202 @@ TEST_F(FusionPassTest, TooManyRegisters) {
   SinglePassRunAndMatch<LoopFusionPass>(text, true, 5);
 }
 
+/*
+Equivalent to the following GLSL
+
+#version 440 core
+layout(std430) buffer A { int a[10]; };
+layout(std430) buffer B { int b[10]; };
+void main() {
+  for (int i = 0; i < 10; i++) {
+    a[i] = a[i]*2;
+  }
+  for (int i = 0; i < 10; i++) {
+    b[i] = a[i]+2;
+  }
+}
+
+*/
+TEST_F(FusionPassTest, FuseLoopsSharingBufferData) {
+  const std::string text = R"(
+; CHECK: OpPhi
+; CHECK: OpLoad
+; CHECK: OpStore
+; CHECK-NOT: OpPhi
+; CHECK: OpLoad
+; CHECK: OpStore
+               OpCapability Shader
+               OpMemoryModel Logical GLSL450
+               OpEntryPoint GLCompute %4 "main"
+               OpExecutionMode %4 LocalSize 1 1 1
+               OpDecorate %21 ArrayStride 4
+               OpMemberDecorate %24 0 Offset 0
+               OpDecorate %24 BufferBlock
+               OpDecorate %23 DescriptorSet 0
+               OpDecorate %23 Binding 0
+               OpDecorate %42 DescriptorSet 0
+               OpDecorate %42 Binding 1
+          %2 = OpTypeVoid
+          %3 = OpTypeFunction %2
+          %6 = OpTypeInt 32 1
+          %9 = OpConstant %6 0
+         %16 = OpConstant %6 10
+         %17 = OpTypeBool
+         %19 = OpTypeInt 32 0
+         %20 = OpConstant %19 10
+         %21 = OpTypeArray %6 %20
+         %24 = OpTypeStruct %21
+         %22 = OpTypePointer Uniform %24
+         %25 = OpTypePointer Uniform %6
+         %28 = OpConstant %6 2
+         %32 = OpConstant %6 1
+         %23 = OpVariable %22 Uniform
+         %42 = OpVariable %22 Uniform
+          %4 = OpFunction %2 None %3
+          %5 = OpLabel
+               OpBranch %10
+         %10 = OpLabel
+         %51 = OpPhi %6 %9 %5 %33 %13
+               OpLoopMerge %12 %13 None
+               OpBranch %14
+         %14 = OpLabel
+         %18 = OpSLessThan %17 %51 %16
+               OpBranchConditional %18 %11 %12
+         %11 = OpLabel
+         %26 = OpAccessChain %25 %23 %9 %51
+         %27 = OpLoad %6 %26
+         %29 = OpIMul %6 %27 %28
+               OpStore %26 %29
+               OpBranch %13
+         %13 = OpLabel
+         %33 = OpIAdd %6 %51 %32
+               OpBranch %10
+         %12 = OpLabel
+               OpBranch %35
+         %35 = OpLabel
+         %52 = OpPhi %6 %9 %12 %50 %38
+               OpLoopMerge %37 %38 None
+               OpBranch %39
+         %39 = OpLabel
+         %41 = OpSLessThan %17 %52 %16
+               OpBranchConditional %41 %36 %37
+         %36 = OpLabel
+         %45 = OpAccessChain %25 %23 %9 %52
+         %46 = OpLoad %6 %45
+         %47 = OpIAdd %6 %46 %28
+         %48 = OpAccessChain %25 %42 %9 %52
+               OpStore %48 %47
+               OpBranch %38
+         %38 = OpLabel
+         %50 = OpIAdd %6 %52 %32
+               OpBranch %35
+         %37 = OpLabel
+               OpReturn
+               OpFunctionEnd
+  )";
+
+  SinglePassRunAndMatch<LoopFusionPass>(
+      text, true, LoopFusionPass::kDefaultMaxRegistersPerLoop, true);
+}
+
+/*
+Equivalent to the following GLSL
+
+#version 440 core
+layout(std430) buffer A { int a[10]; };
+layout(std430) buffer B { int b[10]; };
+void main() {
+  for (int i = 0; i < 10; i++) {
+    a[i] = a[i]*2;
+  }
+  for (int i = 0; i < 10; i++) {
+    b[i] = b[i]+2;
+  }
+}
+
+*/
+TEST_F(FusionPassTest, DontFuseLoopsWithoutSharedData) {
+  const std::string text = R"(
+               OpCapability Shader
+               OpMemoryModel Logical GLSL450
+               OpEntryPoint GLCompute %4 "main"
+               OpExecutionMode %4 LocalSize 1 1 1
+               OpDecorate %21 ArrayStride 4
+               OpMemberDecorate %24 0 Offset 0
+               OpDecorate %24 BufferBlock
+               OpDecorate %23 DescriptorSet 0
+               OpDecorate %23 Binding 0
+               OpDecorate %42 DescriptorSet 0
+               OpDecorate %42 Binding 1
+          %2 = OpTypeVoid
+          %3 = OpTypeFunction %2
+          %6 = OpTypeInt 32 1
+          %9 = OpConstant %6 0
+         %16 = OpConstant %6 10
+         %17 = OpTypeBool
+         %19 = OpTypeInt 32 0
+         %20 = OpConstant %19 10
+         %21 = OpTypeArray %6 %20
+         %24 = OpTypeStruct %21
+         %22 = OpTypePointer Uniform %24
+         %25 = OpTypePointer Uniform %6
+         %28 = OpConstant %6 2
+         %32 = OpConstant %6 1
+         %23 = OpVariable %22 Uniform
+         %42 = OpVariable %22 Uniform
+          %4 = OpFunction %2 None %3
+          %5 = OpLabel
+               OpBranch %10
+         %10 = OpLabel
+         %51 = OpPhi %6 %9 %5 %33 %13
+               OpLoopMerge %12 %13 None
+               OpBranch %14
+         %14 = OpLabel
+         %18 = OpSLessThan %17 %51 %16
+               OpBranchConditional %18 %11 %12
+         %11 = OpLabel
+         %26 = OpAccessChain %25 %23 %9 %51
+         %27 = OpLoad %6 %26
+         %29 = OpIMul %6 %27 %28
+               OpStore %26 %29
+               OpBranch %13
+         %13 = OpLabel
+         %33 = OpIAdd %6 %51 %32
+               OpBranch %10
+         %12 = OpLabel
+               OpBranch %35
+         %35 = OpLabel
+         %52 = OpPhi %6 %9 %12 %50 %38
+               OpLoopMerge %37 %38 None
+               OpBranch %39
+         %39 = OpLabel
+         %41 = OpSLessThan %17 %52 %16
+               OpBranchConditional %41 %36 %37
+         %36 = OpLabel
+         %45 = OpAccessChain %25 %42 %9 %52
+         %46 = OpLoad %6 %45
+         %47 = OpIAdd %6 %46 %28
+         %48 = OpAccessChain %25 %42 %9 %52
+               OpStore %48 %47
+               OpBranch %38
+         %38 = OpLabel
+         %50 = OpIAdd %6 %52 %32
+               OpBranch %35
+         %37 = OpLabel
+               OpReturn
+               OpFunctionEnd
+  )";
+
+  auto result = SinglePassRunAndDisassemble<LoopFusionPass>(
+      text, true, true, LoopFusionPass::kDefaultMaxRegistersPerLoop, true);
+  EXPECT_EQ(Pass::Status::SuccessWithoutChange, std::get<1>(result));
+
+  // The loops are still fused when they do not need to share data.
+  result = SinglePassRunAndDisassemble<LoopFusionPass>(
+      text, true, true, LoopFusionPass::kDefaultMaxRegistersPerLoop, false);
+  EXPECT_EQ(Pass::Status::SuccessWithChange, std::get<1>(result));
+}
+
 }  // namespace
 }  // namespace opt
 }  // namespace spvtools
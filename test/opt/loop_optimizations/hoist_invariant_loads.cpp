@@ -0,0 +1,177 @@
+// Copyright (c) 2019 Google LLC.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <string>
+
+#include "gmock/gmock.h"
+#include "source/opt/licm_pass.h"
+#include "test/opt/pass_fixture.h"
+
+namespace spvtools {
+namespace opt {
+namespace {
+
+using PassClassTest = PassTest<::testing::Test>;
+
+const std::string kHeader = R"(OpCapability Shader
+OpMemoryModel Logical GLSL450
+OpEntryPoint GLCompute %main "main"
+OpExecutionMode %main LocalSize 1 1 1
+OpName %main "main"
+OpName %u "u"
+OpName %s "s"
+OpName %entry "entry"
+OpName %header "header"
+OpName %n "n"
+OpDecorate %U Block
+OpMemberDecorate %U 0 Offset 0
+OpDecorate %u DescriptorSet 0
+OpDecorate %u Binding 0
+OpDecorate %S Block
+OpMemberDecorate %S 0 Offset 0
+OpDecorate %s DescriptorSet 0
+OpDecorate %s Binding 1
+%void = OpTypeVoid
+%void_fn = OpTypeFunction %void
+%int = OpTypeInt 32 1
+%int_0 = OpConstant %int 0
+%int_1 = OpConstant %int 1
+%bool = OpTypeBool
+%U = OpTypeStruct %int
+%S = OpTypeStruct %int
+%_ptr_Uniform_U = OpTypePointer Uniform %U
+%_ptr_Uniform_int = OpTypePointer Uniform %int
+%_ptr_StorageBuffer_S = OpTypePointer StorageBuffer %S
+%_ptr_StorageBuffer_int = OpTypePointer StorageBuffer %int
+%u = OpVariable %_ptr_Uniform_U Uniform
+%s = OpVariable %_ptr_StorageBuffer_S StorageBuffer
+%main = OpFunction %void None %void_fn
+%entry = OpLabel
+OpBranch %header
+%header = OpLabel
+%i = OpPhi %int %int_0 %entry %next %body
+)";
+
+/*
+  The bound of the loop is read from a uniform buffer, which the stores to the
+  storage buffer cannot change.
+
+  for (int i = 0; i < u.n; ++i) {
+    s.x = i;
+  }
+*/
+TEST_F(PassClassTest, HoistUniformLoad) {
+  const std::string text = R"(
+; CHECK: %entry = OpLabel
+; CHECK-NEXT: [[ptr:%\w+]] = OpAccessChain %_ptr_Uniform_int %u %int_0
+; CHECK-NEXT: %n = OpLoad %int [[ptr]]
+; CHECK-NEXT: OpBranch %header
+; CHECK: %header = OpLabel
+; CHECK-NOT: OpLoad
+; CHECK: OpLoopMerge
+)" + kHeader + R"(
+%pu = OpAccessChain %_ptr_Uniform_int %u %int_0
+%n = OpLoad %int %pu
+%cond = OpSLessThan %bool %i %n
+OpLoopMerge %merge %body None
+OpBranchConditional %cond %body %merge
+%body = OpLabel
+%ps = OpAccessChain %_ptr_StorageBuffer_int %s %int_0
+OpStore %ps %i
+%next = OpIAdd %int %i %int_1
+OpBranch %header
+%merge = OpLabel
+OpReturn
+OpFunctionEnd
+)";
+
+  SinglePassRunAndMatch<LICMPass>(text, true);
+}
+
+/*
+  The bound of the loop is read from the storage buffer the loop writes.
+
+  for (int i = 0; i < s.x; ++i) {
+    s.x = i;
+  }
+*/
+TEST_F(PassClassTest, DoNotHoistLoadOfWrittenBuffer) {
+  const std::string text = R"(
+; CHECK: %entry = OpLabel
+; CHECK-NOT: OpLoad
+; CHECK: %header = OpLabel
+; CHECK: %n = OpLoad %int
+; CHECK: OpLoopMerge
+)" + kHeader + R"(
+%pn = OpAccessChain %_ptr_StorageBuffer_int %s %int_0
+%n = OpLoad %int %pn
+%cond = OpSLessThan %bool %i %n
+OpLoopMerge %merge %body None
+OpBranchConditional %cond %body %merge
+%body = OpLabel
+%ps = OpAccessChain %_ptr_StorageBuffer_int %s %int_0
+OpStore %ps %i
+%next = OpIAdd %int %i %int_1
+OpBranch %header
+%merge = OpLabel
+OpReturn
+OpFunctionEnd
+)";
+
+  SinglePassRunAndMatch<LICMPass>(text, true);
+}
+
+/*
+  The storage buffer is not written in the loop, so its load in the header is
+  hoisted.  The load in the body is not executed if the loop exits in its
+  first iteration, so it stays.
+
+  for (int i = 0; i < s.x; ++i) {
+    sum += s.x;
+  }
+*/
+TEST_F(PassClassTest, HoistBufferLoadExecutedInFirstIteration) {
+  const std::string text = R"(
+; CHECK: %entry = OpLabel
+; CHECK: %n = OpLoad %int
+; CHECK: OpBranch %header
+; CHECK: %header = OpLabel
+; CHECK-NOT: OpLoad
+; CHECK: OpLoopMerge
+; CHECK: OpLoad %int
+; CHECK: OpBranch %header
+)" + kHeader + R"(
+%sum = OpPhi %int %int_0 %entry %add %body
+%pn = OpAccessChain %_ptr_StorageBuffer_int %s %int_0
+%n = OpLoad %int %pn
+%cond = OpSLessThan %bool %i %n
+OpLoopMerge %merge %body None
+OpBranchConditional %cond %body %merge
+%body = OpLabel
+%pm = OpAccessChain %_ptr_StorageBuffer_int %s %int_0
+%m = OpLoad %int %pm
+%add = OpIAdd %int %sum %m
+%next = OpIAdd %int %i %int_1
+OpBranch %header
+%merge = OpLabel
+OpReturn
+OpFunctionEnd
+)";
+
+  SinglePassRunAndMatch<LICMPass>(text, true);
+}
+
+}  // namespace
+}  // namespace opt
+}  // namespace spvtools
@@ -17,8 +17,10 @@
 #include <vector>
 
 #include "gmock/gmock.h"
+#include "source/opt/licm_pass.h"
 #include "source/opt/loop_descriptor.h"
 #include "source/opt/pass.h"
+#include "source/opt/simplification_pass.h"
 #include "test/opt/assembly_builder.h"
 #include "test/opt/function_utils.h"
 #include "test/opt/pass_fixture.h"
@@ -379,6 +381,129 @@ TEST_F(PassClassTest, LoopLatchNotContinue) {
   EXPECT_EQ(loop.GetLatchBlock()->id(), 30u);
 }
 
+// Two functions with a loop each.  The loop of %main holds an invariant
+// instruction, %15, and the loop of %other an addition of zero, %30.
+const char kTwoLoops[] = R"(
+OpCapability Shader
+OpMemoryModel Logical GLSL450
+OpEntryPoint Fragment %main "main"
+OpExecutionMode %main OriginUpperLeft
+%void = OpTypeVoid
+%4 = OpTypeFunction %void
+%int = OpTypeInt 32 1
+%int_1 = OpConstant %int 1
+%int_2 = OpConstant %int 2
+%int_0 = OpConstant %int 0
+%int_10 = OpConstant %int 10
+%bool = OpTypeBool
+%main = OpFunction %void None %4
+%12 = OpLabel
+OpBranch %13
+%13 = OpLabel
+%14 = OpPhi %int %int_0 %12 %15 %16
+%17 = OpPhi %int %int_0 %12 %18 %16
+OpLoopMerge %19 %16 None
+OpBranch %20
+%20 = OpLabel
+%21 = OpSLessThan %bool %17 %int_10
+OpBranchConditional %21 %22 %19
+%22 = OpLabel
+%15 = OpIAdd %int %int_1 %int_2
+OpBranch %16
+%16 = OpLabel
+%18 = OpIAdd %int %17 %int_1
+OpBranch %13
+%19 = OpLabel
+OpReturn
+OpFunctionEnd
+%other = OpFunction %void None %4
+%23 = OpLabel
+OpBranch %24
+%24 = OpLabel
+%25 = OpPhi %int %int_0 %23 %30 %26
+OpLoopMerge %27 %26 None
+OpBranch %28
+%28 = OpLabel
+%29 = OpSLessThan %bool %25 %int_10
+OpBranchConditional %29 %26 %27
+%26 = OpLabel
+%31 = OpIAdd %int %25 %int_1
+%30 = OpIAdd %int %31 %int_0
+OpBranch %24
+%27 = OpLabel
+OpReturn
+OpFunctionEnd
+)";
+
+uint64_t NumLoopBuilds(IRContext* context) {
+  return context->GetAnalysisStatistics(IRContext::kAnalysisLoopAnalysis)
+      .builds;
+}
+
+TEST_F(PassClassTest, StraightLineCodeChangesKeepLoops) {
+  std::unique_ptr<IRContext> context =
+      BuildModule(SPV_ENV_UNIVERSAL_1_1, nullptr, kTwoLoops,
+                  SPV_TEXT_TO_BINARY_OPTION_PRESERVE_NUMERIC_IDS);
+  Module* module = context->module();
+  const Function* main = &*module->begin();
+  const Function* other = &*++module->begin();
+  EXPECT_EQ(1u, context->GetLoopDescriptor(main)->NumLoops());
+  EXPECT_EQ(1u, context->GetLoopDescriptor(other)->NumLoops());
+  EXPECT_EQ(2u, NumLoopBuilds(context.get()));
+
+  // Folding the additions does not change the loops.
+  EXPECT_EQ(Pass::Status::SuccessWithChange,
+            SimplificationPass().Run(context.get()));
+  EXPECT_TRUE(context->AreAnalysesValid(IRContext::kAnalysisLoopAnalysis));
+  EXPECT_EQ(1u, context->GetLoopDescriptor(main)->NumLoops());
+  EXPECT_EQ(1u, context->GetLoopDescriptor(other)->NumLoops());
+  EXPECT_EQ(2u, NumLoopBuilds(context.get()));
+}
+
+TEST_F(PassClassTest, LoopPassKeepsLoopsOfOtherFunctions) {
+  std::unique_ptr<IRContext> context =
+      BuildModule(SPV_ENV_UNIVERSAL_1_1, nullptr, kTwoLoops,
+                  SPV_TEXT_TO_BINARY_OPTION_PRESERVE_NUMERIC_IDS);
+  Module* module = context->module();
+  const Function* main = &*module->begin();
+  const Function* other = &*++module->begin();
+  context->GetLoopDescriptor(main);
+  context->GetLoopDescriptor(other);
+  EXPECT_EQ(2u, NumLoopBuilds(context.get()));
+
+  // Only the loops of %main, from which %15 is hoisted, are found again.
+  EXPECT_EQ(Pass::Status::SuccessWithChange, LICMPass().Run(context.get()));
+  EXPECT_EQ(1u, context->GetLoopDescriptor(other)->NumLoops());
+  EXPECT_EQ(2u, NumLoopBuilds(context.get()));
+  EXPECT_EQ(1u, context->GetLoopDescriptor(main)->NumLoops());
+  EXPECT_EQ(3u, NumLoopBuilds(context.get()));
+}
+
+TEST_F(PassClassTest, NoLoopNeedsNoDominators) {
+  const std::string text = R"(
+OpCapability Shader
+OpMemoryModel Logical GLSL450
+OpEntryPoint Fragment %main "main"
+OpExecutionMode %main OriginUpperLeft
+%void = OpTypeVoid
+%4 = OpTypeFunction %void
+%main = OpFunction %void None %4
+%5 = OpLabel
+OpBranch %6
+%6 = OpLabel
+OpReturn
+OpFunctionEnd
+)";
+  std::unique_ptr<IRContext> context =
+      BuildModule(SPV_ENV_UNIVERSAL_1_1, nullptr, text,
+                  SPV_TEXT_TO_BINARY_OPTION_PRESERVE_NUMERIC_IDS);
+  const Function* main = &*context->module()->begin();
+  EXPECT_EQ(0u, context->GetLoopDescriptor(main)->NumLoops());
+  const IRContext::AnalysisStatistics& dominators =
+      context->GetAnalysisStatistics(IRContext::kAnalysisDominatorAnalysis);
+  EXPECT_EQ(0u, dominators.builds);
+}
+
 }  // namespace
 }  // namespace opt
 }  // namespace spvtools
@@ -3486,6 +3486,89 @@ OpFunctionEnd
   SinglePassRunAndCheck<LoopFissionPass>(source, expected, true);
 }
 
+/*
+Equivalent to the following GLSL
+
+#version 430
+layout(std430) buffer BufferA { float A[10]; };
+layout(std430) buffer BufferB { float B[10]; };
+void main(void) {
+    for (int i = 0; i < 10; i++) {
+        A[i] = B[i];
+        B[i] = A[i];
+    }
+}
+
+Both loops would access the same elements of A and B in the same iteration, so
+the loop is kept whole when the reused data is kept.
+*/
+TEST_F(FissionClassTest, FissionKeepsReusedBufferData) {
+  // clang-format off
+const std::string source = R"(OpCapability Shader
+OpMemoryModel Logical GLSL450
+OpEntryPoint GLCompute %2 "main"
+OpExecutionMode %2 LocalSize 1 1 1
+OpDecorate %16 ArrayStride 4
+OpMemberDecorate %17 0 Offset 0
+OpDecorate %17 BufferBlock
+OpDecorate %4 DescriptorSet 0
+OpDecorate %4 Binding 0
+OpDecorate %5 DescriptorSet 0
+OpDecorate %5 Binding 1
+%6 = OpTypeVoid
+%7 = OpTypeFunction %6
+%8 = OpTypeInt 32 1
+%10 = OpConstant %8 0
+%11 = OpConstant %8 10
+%12 = OpTypeBool
+%13 = OpTypeFloat 32
+%14 = OpTypeInt 32 0
+%15 = OpConstant %14 10
+%16 = OpTypeArray %13 %15
+%17 = OpTypeStruct %16
+%18 = OpTypePointer Uniform %17
+%9 = OpTypePointer Uniform %13
+%19 = OpConstant %8 1
+%4 = OpVariable %18 Uniform
+%5 = OpVariable %18 Uniform
+%2 = OpFunction %6 None %7
+%20 = OpLabel
+OpBranch %21
+%21 = OpLabel
+%22 = OpPhi %8 %10 %20 %23 %24
+OpLoopMerge %25 %24 None
+OpBranch %26
+%26 = OpLabel
+%27 = OpSLessThan %12 %22 %11
+OpBranchConditional %27 %28 %25
+%28 = OpLabel
+%29 = OpAccessChain %9 %5 %10 %22
+%30 = OpLoad %13 %29
+%31 = OpAccessChain %9 %4 %10 %22
+OpStore %31 %30
+%32 = OpAccessChain %9 %4 %10 %22
+%33 = OpLoad %13 %32
+%34 = OpAccessChain %9 %5 %10 %22
+OpStore %34 %33
+OpBranch %24
+%24 = OpLabel
+%23 = OpIAdd %8 %22 %19
+OpBranch %21
+%25 = OpLabel
+OpReturn
+OpFunctionEnd
+)";
+  // clang-format on
+
+  auto result = SinglePassRunAndDisassemble<LoopFissionPass>(
+      source, true, true, size_t{0}, false, true);
+  EXPECT_EQ(Pass::Status::SuccessWithoutChange, std::get<1>(result));
+
+  result = SinglePassRunAndDisassemble<LoopFissionPass>(source, true, true,
+                                                        size_t{0}, false);
+  EXPECT_EQ(Pass::Status::SuccessWithChange, std::get<1>(result));
+}
+
 }  // namespace
 }  // namespace opt
 }  // namespace spvtools
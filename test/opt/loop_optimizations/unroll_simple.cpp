@@ -2998,6 +2998,89 @@ TEST_F(PassClassTest, OpPhiSelfReference) {
                                            kUnrollFactor);
 }
 
+// Returns a fragment shader writing |count| elements of an array in a loop
+// marked with the Unroll loop control.
+std::string UnrollableLoop(const std::string& count) {
+  return R"(
+OpCapability Shader
+OpMemoryModel Logical GLSL450
+OpEntryPoint Fragment %main "main" %out
+OpExecutionMode %main OriginUpperLeft
+OpDecorate %out Location 0
+%void = OpTypeVoid
+%fn = OpTypeFunction %void
+%int = OpTypeInt 32 1
+%uint = OpTypeInt 32 0
+%bool = OpTypeBool
+%float = OpTypeFloat 32
+%int_0 = OpConstant %int 0
+%int_1 = OpConstant %int 1
+%int_count = OpConstant %int )" +
+         count + R"(
+%uint_count = OpConstant %uint )" +
+         count + R"(
+%array = OpTypeArray %float %uint_count
+%_ptr_Output_array = OpTypePointer Output %array
+%_ptr_Output_float = OpTypePointer Output %float
+%out = OpVariable %_ptr_Output_array Output
+%main = OpFunction %void None %fn
+%entry = OpLabel
+OpBranch %header
+%header = OpLabel
+%i = OpPhi %int %int_0 %entry %next %continue
+OpLoopMerge %merge %continue Unroll
+OpBranch %cond
+%cond = OpLabel
+%lt = OpSLessThan %bool %i %int_count
+OpBranchConditional %lt %body %merge
+%body = OpLabel
+%value = OpConvertSToF %float %i
+%ptr = OpAccessChain %_ptr_Output_float %out %i
+OpStore %ptr %value
+OpBranch %continue
+%continue = OpLabel
+%next = OpIAdd %int %i %int_1
+OpBranch %header
+%merge = OpLabel
+OpReturn
+OpFunctionEnd
+)";
+}
+
+TEST_F(PassClassTest, AutoUnrollFullyUnrollsSmallLoops) {
+  const std::string checks = R"(
+; CHECK-NOT: OpLoopMerge
+; CHECK: OpStore
+; CHECK: OpStore
+; CHECK: OpStore
+; CHECK: OpStore
+; CHECK-NOT: OpStore
+; CHECK: OpReturn
+)";
+
+  SinglePassRunAndMatch<LoopUnroller>(checks + UnrollableLoop("4"), true,
+                                      size_t(64));
+}
+
+TEST_F(PassClassTest, AutoUnrollPartiallyUnrollsLongLoops) {
+  const std::string checks = R"(
+; CHECK: OpLoopMerge
+; CHECK: OpStore
+; CHECK: OpStore
+; CHECK: OpReturn
+)";
+
+  SinglePassRunAndMatch<LoopUnroller>(checks + UnrollableLoop("1000"), true,
+                                      size_t(64));
+}
+
+TEST_F(PassClassTest, AutoUnrollRespectsRegisterBudget) {
+  const std::string text = UnrollableLoop("4");
+
+  auto result = SinglePassRunToBinary<LoopUnroller>(text, true, size_t(1));
+  EXPECT_EQ(Pass::Status::SuccessWithoutChange, std::get<1>(result));
+}
+
 }  // namespace
 }  // namespace opt
 }  // namespace spvtools
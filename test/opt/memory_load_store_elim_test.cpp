@@ -0,0 +1,188 @@
+// Copyright (c) 2019 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <string>
+
+#include "test/opt/pass_fixture.h"
+#include "test/opt/pass_utils.h"
+
+namespace spvtools {
+namespace opt {
+namespace {
+
+using MemoryLoadStoreElimTest = PassTest<::testing::Test>;
+
+const std::string kHeader = R"(
+OpCapability Shader
+OpCapability Linkage
+OpMemoryModel Logical GLSL450
+OpName %f "f"
+OpName %x "x"
+OpName %y "y"
+OpName %c "c"
+OpName %cond "cond"
+OpName %g "g"
+OpName %entry "entry"
+OpDecorate %f LinkageAttributes "f" Export
+%void = OpTypeVoid
+%bool = OpTypeBool
+%int = OpTypeInt 32 1
+%int_0 = OpConstant %int 0
+%int_1 = OpConstant %int 1
+%float = OpTypeFloat 32
+%float_2 = OpConstant %float 2
+%S = OpTypeStruct %float %float
+%_ptr_Function_S = OpTypePointer Function %S
+%_ptr_Function_float = OpTypePointer Function %float
+%_ptr_Private_float = OpTypePointer Private %float
+%g = OpVariable %_ptr_Private_float Private
+%void_fn = OpTypeFunction %void
+%f_fn = OpTypeFunction %float %float %float %S %bool
+%f = OpFunction %float None %f_fn
+%x = OpFunctionParameter %float
+%y = OpFunctionParameter %float
+%c = OpFunctionParameter %S
+%cond = OpFunctionParameter %bool
+%entry = OpLabel
+)";
+
+TEST_F(MemoryLoadStoreElimTest, ForwardsMemberStoreAcrossBlocks) {
+  // The store to the other member in %then does not clobber s.0, and the
+  // stores are dead once the load is forwarded.
+  const std::string text = R"(
+; CHECK: %f = OpFunction
+; CHECK-NOT: OpLoad
+; CHECK-NOT: OpStore
+; CHECK: OpReturnValue %x
+)" + kHeader + R"(
+%s = OpVariable %_ptr_Function_S Function
+%p0 = OpAccessChain %_ptr_Function_float %s %int_0
+OpStore %p0 %x
+OpSelectionMerge %merge None
+OpBranchConditional %cond %then %merge
+%then = OpLabel
+%p1 = OpAccessChain %_ptr_Function_float %s %int_1
+OpStore %p1 %float_2
+OpBranch %merge
+%merge = OpLabel
+%p2 = OpAccessChain %_ptr_Function_float %s %int_0
+%v = OpLoad %float %p2
+OpReturnValue %v
+OpFunctionEnd
+)";
+
+  SinglePassRunAndMatch<MemoryLoadStoreElimPass>(text, true);
+}
+
+TEST_F(MemoryLoadStoreElimTest, ForwardsPartOfCompositeStore) {
+  const std::string text = R"(
+; CHECK: %f = OpFunction
+; CHECK-NOT: OpLoad
+; CHECK: [[member:%\w+]] = OpCompositeExtract %float %c 1
+; CHECK: OpReturnValue [[member]]
+)" + kHeader + R"(
+%s = OpVariable %_ptr_Function_S Function
+OpStore %s %c
+OpBranch %next
+%next = OpLabel
+%p1 = OpAccessChain %_ptr_Function_float %s %int_1
+%v = OpLoad %float %p1
+OpReturnValue %v
+OpFunctionEnd
+)";
+
+  SinglePassRunAndMatch<MemoryLoadStoreElimPass>(text, true);
+}
+
+TEST_F(MemoryLoadStoreElimTest, KeepsLoadOfMergedStores) {
+  const std::string text = R"(
+; CHECK: OpStore {{%\w+}} %x
+; CHECK: OpStore {{%\w+}} %y
+; CHECK: [[value:%\w+]] = OpLoad %float
+; CHECK: OpReturnValue [[value]]
+)" + kHeader + R"(
+%s = OpVariable %_ptr_Function_S Function
+OpSelectionMerge %merge None
+OpBranchConditional %cond %then %else
+%then = OpLabel
+%p0 = OpAccessChain %_ptr_Function_float %s %int_0
+OpStore %p0 %x
+OpBranch %merge
+%else = OpLabel
+%p1 = OpAccessChain %_ptr_Function_float %s %int_0
+OpStore %p1 %y
+OpBranch %merge
+%merge = OpLabel
+%p2 = OpAccessChain %_ptr_Function_float %s %int_0
+%v = OpLoad %float %p2
+OpReturnValue %v
+OpFunctionEnd
+)";
+
+  SinglePassRunAndMatch<MemoryLoadStoreElimPass>(text, true);
+}
+
+TEST_F(MemoryLoadStoreElimTest, RemovesStoreOverwrittenOnAllPaths) {
+  // The private variable may be read after returning, so only the first
+  // store is dead.
+  const std::string text = R"(
+; CHECK: %entry = OpLabel
+; CHECK-NOT: OpStore
+; CHECK: OpBranchConditional
+; CHECK: OpStore %g %x
+; CHECK: OpStore %g %y
+)" + kHeader + R"(
+OpStore %g %float_2
+OpSelectionMerge %merge None
+OpBranchConditional %cond %then %else
+%then = OpLabel
+OpStore %g %x
+OpBranch %merge
+%else = OpLabel
+OpStore %g %y
+OpBranch %merge
+%merge = OpLabel
+OpReturnValue %x
+OpFunctionEnd
+)";
+
+  SinglePassRunAndMatch<MemoryLoadStoreElimPass>(text, true);
+}
+
+TEST_F(MemoryLoadStoreElimTest, KeepsPrivateLoadAfterCall) {
+  // The callee may store to the private variable.
+  const std::string text = R"(
+; CHECK: OpStore %g %x
+; CHECK: OpFunctionCall %void
+; CHECK: [[value:%\w+]] = OpLoad %float %g
+; CHECK: OpReturnValue [[value]]
+)" + kHeader + R"(
+OpStore %g %x
+%call = OpFunctionCall %void %h
+%v = OpLoad %float %g
+OpReturnValue %v
+OpFunctionEnd
+%h = OpFunction %void None %void_fn
+%h_entry = OpLabel
+OpStore %g %y
+OpReturn
+OpFunctionEnd
+)";
+
+  SinglePassRunAndMatch<MemoryLoadStoreElimPass>(text, true);
+}
+
+}  // namespace
+}  // namespace opt
+}  // namespace spvtools
@@ -0,0 +1,148 @@
+// Copyright (c) 2020 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <string>
+
+#include "test/opt/pass_fixture.h"
+#include "test/opt/pass_utils.h"
+
+namespace spvtools {
+namespace opt {
+namespace {
+
+using MergeIdenticalFunctionsTest = PassTest<::testing::Test>;
+
+const std::string kHeader = R"(
+OpCapability Shader
+OpMemoryModel Logical GLSL450
+OpEntryPoint Fragment %main "main"
+OpExecutionMode %main OriginUpperLeft
+OpName %main "main"
+OpName %add1 "add1"
+OpName %add2 "add2"
+%void = OpTypeVoid
+%float = OpTypeFloat 32
+%float_1 = OpConstant %float 1
+%float_2 = OpConstant %float 2
+%void_fn = OpTypeFunction %void
+%float_fn = OpTypeFunction %float %float
+)";
+
+TEST_F(MergeIdenticalFunctionsTest, MergesFunctionsThatDifferInIds) {
+  const std::string text = R"(
+; CHECK-NOT: OpName %add2
+; CHECK: %main = OpFunction
+; CHECK: OpFunctionCall %float %add1 %float_1
+; CHECK: OpFunctionCall %float %add1 %float_2
+; CHECK: %add1 = OpFunction
+; CHECK-NOT: = OpFunction %
+)" + kHeader + R"(
+%main = OpFunction %void None %void_fn
+%main_entry = OpLabel
+%r1 = OpFunctionCall %float %add1 %float_1
+%r2 = OpFunctionCall %float %add2 %float_2
+OpReturn
+OpFunctionEnd
+%add1 = OpFunction %float None %float_fn
+%x1 = OpFunctionParameter %float
+%add1_entry = OpLabel
+%y1 = OpFAdd %float %x1 %float_1
+OpReturnValue %y1
+OpFunctionEnd
+%add2 = OpFunction %float None %float_fn
+%x2 = OpFunctionParameter %float
+%add2_entry = OpLabel
+%y2 = OpFAdd %float %x2 %float_1
+OpReturnValue %y2
+OpFunctionEnd
+)";
+
+  SinglePassRunAndMatch<MergeIdenticalFunctionsPass>(text, true);
+}
+
+TEST_F(MergeIdenticalFunctionsTest, KeepsFunctionsThatDifferInConstants) {
+  const std::string text = kHeader + R"(
+%main = OpFunction %void None %void_fn
+%main_entry = OpLabel
+%r1 = OpFunctionCall %float %add1 %float_1
+%r2 = OpFunctionCall %float %add2 %float_2
+OpReturn
+OpFunctionEnd
+%add1 = OpFunction %float None %float_fn
+%x1 = OpFunctionParameter %float
+%add1_entry = OpLabel
+%y1 = OpFAdd %float %x1 %float_1
+OpReturnValue %y1
+OpFunctionEnd
+%add2 = OpFunction %float None %float_fn
+%x2 = OpFunctionParameter %float
+%add2_entry = OpLabel
+%y2 = OpFAdd %float %x2 %float_2
+OpReturnValue %y2
+OpFunctionEnd
+)";
+
+  auto result = SinglePassRunAndDisassemble<MergeIdenticalFunctionsPass>(
+      text, true, false);
+  EXPECT_EQ(Pass::Status::SuccessWithoutChange, std::get<1>(result));
+}
+
+TEST_F(MergeIdenticalFunctionsTest, MergesCallersOfMergedFunctions) {
+  const std::string text = R"(
+; CHECK: %main = OpFunction
+; CHECK: OpFunctionCall %float %add1 %float_1
+; CHECK: OpFunctionCall %float %add1 %float_2
+; CHECK: %add1 = OpFunction
+; CHECK: OpFunctionCall %float [[inc:%\w+]]
+; CHECK: [[inc]] = OpFunction
+; CHECK-NOT: = OpFunction %
+)" + kHeader + R"(
+%main = OpFunction %void None %void_fn
+%main_entry = OpLabel
+%r1 = OpFunctionCall %float %add1 %float_1
+%r2 = OpFunctionCall %float %add2 %float_2
+OpReturn
+OpFunctionEnd
+%add1 = OpFunction %float None %float_fn
+%x1 = OpFunctionParameter %float
+%add1_entry = OpLabel
+%y1 = OpFunctionCall %float %inc1 %x1
+OpReturnValue %y1
+OpFunctionEnd
+%add2 = OpFunction %float None %float_fn
+%x2 = OpFunctionParameter %float
+%add2_entry = OpLabel
+%y2 = OpFunctionCall %float %inc2 %x2
+OpReturnValue %y2
+OpFunctionEnd
+%inc1 = OpFunction %float None %float_fn
+%a1 = OpFunctionParameter %float
+%inc1_entry = OpLabel
+%b1 = OpFAdd %float %a1 %float_1
+OpReturnValue %b1
+OpFunctionEnd
+%inc2 = OpFunction %float None %float_fn
+%a2 = OpFunctionParameter %float
+%inc2_entry = OpLabel
+%b2 = OpFAdd %float %a2 %float_1
+OpReturnValue %b2
+OpFunctionEnd
+)";
+
+  SinglePassRunAndMatch<MergeIdenticalFunctionsPass>(text, true);
+}
+
+}  // namespace
+}  // namespace opt
+}  // namespace spvtools
@@ -0,0 +1,93 @@
+// Copyright (c) 2019 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "source/opt/module_snapshot.h"
+
+#include <memory>
+#include <vector>
+
+#include "gmock/gmock.h"
+#include "source/opt/build_module.h"
+
+namespace spvtools {
+namespace opt {
+namespace {
+
+const char kModule[] = R"(
+OpCapability Shader
+%glsl = OpExtInstImport "GLSL.std.450"
+OpMemoryModel Logical GLSL450
+OpEntryPoint Fragment %main "main"
+OpExecutionMode %main OriginUpperLeft
+%file = OpString "file.frag"
+OpName %main "main"
+OpName %helper "helper"
+%void = OpTypeVoid
+%float = OpTypeFloat 32
+%float_1 = OpConstant %float 1
+%void_fn = OpTypeFunction %void
+%float_fn = OpTypeFunction %float
+%main = OpFunction %void None %void_fn
+%main_entry = OpLabel
+OpLine %file 3 0
+%call = OpFunctionCall %float %helper
+OpReturn
+OpFunctionEnd
+%helper = OpFunction %float None %float_fn
+%helper_entry = OpLabel
+%abs = OpExtInst %float %glsl FAbs %float_1
+OpReturnValue %abs
+OpFunctionEnd
+OpLine %file 10 0
+)";
+
+std::vector<uint32_t> ToBinary(IRContext* context) {
+  std::vector<uint32_t> binary;
+  context->module()->ToBinary(&binary, false);
+  return binary;
+}
+
+TEST(ModuleSnapshotTest, RestoreRoundTrips) {
+  std::unique_ptr<IRContext> context =
+      BuildModule(SPV_ENV_UNIVERSAL_1_1, nullptr, kModule);
+  ModuleSnapshot snapshot(*context->module());
+  EXPECT_EQ(2u, snapshot.num_functions());
+
+  std::unique_ptr<IRContext> restored =
+      snapshot.Restore(SPV_ENV_UNIVERSAL_1_1, nullptr);
+  ASSERT_NE(nullptr, restored);
+  EXPECT_EQ(ToBinary(context.get()), ToBinary(restored.get()));
+}
+
+TEST(ModuleSnapshotTest, SharesUnchangedFunctions) {
+  std::unique_ptr<IRContext> context =
+      BuildModule(SPV_ENV_UNIVERSAL_1_1, nullptr, kModule);
+  ModuleSnapshot base(*context->module());
+
+  std::unique_ptr<IRContext> restored =
+      base.Restore(SPV_ENV_UNIVERSAL_1_1, nullptr);
+  // Remove the call to %helper from %main.
+  Function& main = *restored->module()->begin();
+  restored->KillInst(&*main.entry()->begin());
+
+  ModuleSnapshot next(*restored->module(), base, {main.result_id()});
+  EXPECT_FALSE(next.SharesFunctionWith(0, base));
+  EXPECT_TRUE(next.SharesFunctionWith(1, base));
+  EXPECT_EQ(ToBinary(restored.get()),
+            ToBinary(next.Restore(SPV_ENV_UNIVERSAL_1_1, nullptr).get()));
+}
+
+}  // namespace
+}  // namespace opt
+}  // namespace spvtools
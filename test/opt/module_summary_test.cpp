@@ -0,0 +1,110 @@
+// Copyright (c) 2019 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "source/opt/module_summary.h"
+
+#include <memory>
+
+#include "gmock/gmock.h"
+#include "source/opt/build_module.h"
+#include "source/opt/licm_pass.h"
+
+namespace spvtools {
+namespace opt {
+namespace {
+
+const char kModule[] = R"(
+OpCapability Shader
+%glsl = OpExtInstImport "GLSL.std.450"
+%unused = OpExtInstImport "SPV_AMD_gcn_shader"
+OpMemoryModel Logical GLSL450
+OpEntryPoint Fragment %main "main"
+OpExecutionMode %main OriginUpperLeft
+OpDecorate %a RelaxedPrecision
+OpDecorate %b RelaxedPrecision
+OpDecorate %s Block
+OpMemberDecorate %s 0 Offset 0
+%void = OpTypeVoid
+%float = OpTypeFloat 32
+%s = OpTypeStruct %float
+%float_1 = OpConstant %float 1
+%void_fn = OpTypeFunction %void
+%main = OpFunction %void None %void_fn
+%entry = OpLabel
+%a = OpExtInst %float %glsl FAbs %float_1
+%b = OpExtInst %float %glsl Sqrt %a
+OpReturn
+OpFunctionEnd
+)";
+
+TEST(ModuleSummaryTest, CountsInstructions) {
+  std::unique_ptr<IRContext> context =
+      BuildModule(SPV_ENV_UNIVERSAL_1_1, nullptr, kModule);
+  ASSERT_NE(context, nullptr);
+  const ModuleSummary* summary = context->GetModuleSummary();
+
+  EXPECT_EQ(summary->NumInstructions(SpvOpExtInst), 2u);
+  EXPECT_EQ(summary->NumInstructions(SpvOpTypeFloat), 1u);
+  EXPECT_TRUE(summary->HasInstruction(SpvOpReturn));
+  EXPECT_FALSE(summary->HasInstruction(SpvOpTypeImage));
+  EXPECT_EQ(summary->NumLoops(), 0u);
+}
+
+TEST(ModuleSummaryTest, CountsDecorations) {
+  std::unique_ptr<IRContext> context =
+      BuildModule(SPV_ENV_UNIVERSAL_1_1, nullptr, kModule);
+  ASSERT_NE(context, nullptr);
+  const ModuleSummary* summary = context->GetModuleSummary();
+
+  EXPECT_EQ(summary->NumDecorations(SpvDecorationRelaxedPrecision), 2u);
+  EXPECT_EQ(summary->NumDecorations(SpvDecorationBlock), 1u);
+  EXPECT_EQ(summary->NumDecorations(SpvDecorationOffset), 1u);
+  EXPECT_EQ(summary->NumDecorations(SpvDecorationDescriptorSet), 0u);
+}
+
+TEST(ModuleSummaryTest, CountsExtInstsBySet) {
+  std::unique_ptr<IRContext> context =
+      BuildModule(SPV_ENV_UNIVERSAL_1_1, nullptr, kModule);
+  ASSERT_NE(context, nullptr);
+  const ModuleSummary* summary = context->GetModuleSummary();
+
+  EXPECT_TRUE(summary->ImportsExtInstSet("GLSL.std.450"));
+  EXPECT_EQ(summary->NumExtInsts("GLSL.std.450"), 2u);
+  EXPECT_TRUE(summary->ImportsExtInstSet("SPV_AMD_gcn_shader"));
+  EXPECT_EQ(summary->NumExtInsts("SPV_AMD_gcn_shader"), 0u);
+  EXPECT_FALSE(summary->ImportsExtInstSet("OpenCL.std"));
+}
+
+TEST(ModuleSummaryTest, InvalidatedWithOtherAnalyses) {
+  std::unique_ptr<IRContext> context =
+      BuildModule(SPV_ENV_UNIVERSAL_1_1, nullptr, kModule);
+  ASSERT_NE(context, nullptr);
+  context->GetModuleSummary();
+  EXPECT_TRUE(context->AreAnalysesValid(IRContext::kAnalysisModuleSummary));
+  context->InvalidateAnalysesExceptFor(IRContext::kAnalysisNone);
+  EXPECT_FALSE(context->AreAnalysesValid(IRContext::kAnalysisModuleSummary));
+}
+
+TEST(ModuleSummaryTest, LoopPassIsSkippedWithoutLoops) {
+  std::unique_ptr<IRContext> context =
+      BuildModule(SPV_ENV_UNIVERSAL_1_1, nullptr, kModule);
+  ASSERT_NE(context, nullptr);
+  LICMPass pass;
+  EXPECT_TRUE(pass.IsNoOp(context.get()));
+  EXPECT_EQ(pass.Run(context.get()), Pass::Status::SuccessWithoutChange);
+}
+
+}  // namespace
+}  // namespace opt
+}  // namespace spvtools
@@ -295,6 +295,63 @@ OpLine %5 1 1
 
   AssembleAndDisassemble(text);
 }
+
+TEST(ModuleTest, ToBinaryIntoBufferAndChunks) {
+  const std::string text = R"(OpCapability Shader
+OpCapability Linkage
+OpMemoryModel Logical GLSL450
+%5 = OpString "file.ext"
+%void = OpTypeVoid
+%2 = OpTypeFunction %void
+%3 = OpFunction %void None %2
+%4 = OpLabel
+OpLine %5 1 0
+OpNop
+OpReturn
+OpFunctionEnd
+)";
+  std::unique_ptr<IRContext> context = BuildModule(text);
+  Module* module = context->module();
+
+  for (bool skip_nop : {false, true}) {
+    std::vector<uint32_t> binary = {42};
+    module->ToBinary(&binary, skip_nop);
+    EXPECT_EQ(1 + module->BinarySize(skip_nop), binary.size());
+    EXPECT_EQ(42u, binary[0]);
+    binary.erase(binary.begin());
+
+    std::vector<uint32_t> buffer(module->BinarySize(skip_nop));
+    module->ToBinary(buffer.data(), skip_nop);
+    EXPECT_EQ(binary, buffer);
+
+    // The chunks are no larger than asked, unless an instruction is.
+    std::vector<uint32_t> streamed;
+    size_t num_chunks = 0;
+    EXPECT_TRUE(module->ToBinary(
+        [&streamed, &num_chunks](const uint32_t* words, size_t num_words) {
+          EXPECT_LE(num_words, 8u);
+          streamed.insert(streamed.end(), words, words + num_words);
+          ++num_chunks;
+          return true;
+        },
+        skip_nop, 8));
+    EXPECT_EQ(binary, streamed);
+    EXPECT_LT(1u, num_chunks);
+  }
+
+  // Without the OpNop, one word less.
+  EXPECT_EQ(module->BinarySize(false), module->BinarySize(true) + 1);
+
+  // Writing stops when the sink asks for it.
+  size_t num_chunks = 0;
+  EXPECT_FALSE(module->ToBinary(
+      [&num_chunks](const uint32_t*, size_t) {
+        ++num_chunks;
+        return false;
+      },
+      false, 8));
+  EXPECT_EQ(1u, num_chunks);
+}
 }  // namespace
 }  // namespace opt
 }  // namespace spvtools
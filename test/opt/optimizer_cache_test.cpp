@@ -0,0 +1,206 @@
+// Copyright (c) 2019 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// Tests for the cache of the optimized modules.
+
+#include <map>
+#include <string>
+#include <vector>
+
+#include "gmock/gmock.h"
+#include "spirv-tools/libspirv.hpp"
+#include "spirv-tools/optimizer.hpp"
+
+namespace spvtools {
+namespace opt {
+namespace {
+
+// A cache that remembers the keys looked up and the results stored.
+class TestCache : public OptimizationCache {
+ public:
+  bool Lookup(const std::string& key, std::vector<uint32_t>* binary) override {
+    looked_up.push_back(key);
+    auto it = stored.find(key);
+    if (it == stored.end()) return false;
+    *binary = it->second;
+    return true;
+  }
+
+  void Insert(const std::string& key,
+              const std::vector<uint32_t>& binary) override {
+    stored[key] = binary;
+  }
+
+  std::vector<std::string> looked_up;
+  std::map<std::string, std::vector<uint32_t>> stored;
+};
+
+const char kModule[] = R"(OpCapability Shader
+OpCapability Linkage
+OpMemoryModel Logical GLSL450
+OpName %foo "foo"
+%foo = OpTypeVoid
+)";
+
+std::vector<uint32_t> Assemble(const std::string& text) {
+  std::vector<uint32_t> binary;
+  EXPECT_TRUE(SpirvTools(SPV_ENV_UNIVERSAL_1_0).Assemble(text, &binary));
+  return binary;
+}
+
+// Strips the debug instructions of |binary| into |optimized| with a new
+// optimizer, since an optimizer drops its passes once it has run them.
+bool StripDebug(TestCache* cache, const std::vector<uint32_t>& binary,
+                std::vector<uint32_t>* optimized,
+                const OptimizerOptions& options = OptimizerOptions(),
+                spv_target_env env = SPV_ENV_UNIVERSAL_1_0) {
+  Optimizer opt(env);
+  opt.RegisterPassFromFlag("--strip-debug");
+  opt.SetCache(cache);
+  return opt.Run(binary.data(), binary.size(), optimized, options);
+}
+
+TEST(OptimizerCache, StoresResult) {
+  const std::vector<uint32_t> binary = Assemble(kModule);
+  TestCache cache;
+
+  std::vector<uint32_t> optimized;
+  EXPECT_TRUE(StripDebug(&cache, binary, &optimized));
+  ASSERT_EQ(1u, cache.looked_up.size());
+  EXPECT_EQ(64u, cache.looked_up[0].size());
+  ASSERT_EQ(1u, cache.stored.count(cache.looked_up[0]));
+  EXPECT_EQ(optimized, cache.stored[cache.looked_up[0]]);
+
+  std::vector<uint32_t> again;
+  EXPECT_TRUE(StripDebug(&cache, binary, &again));
+  ASSERT_EQ(2u, cache.looked_up.size());
+  EXPECT_EQ(cache.looked_up[0], cache.looked_up[1]);
+  EXPECT_EQ(optimized, again);
+}
+
+TEST(OptimizerCache, HitDoesNotOptimize) {
+  const std::vector<uint32_t> binary = Assemble(kModule);
+  TestCache cache;
+
+  std::vector<uint32_t> optimized;
+  EXPECT_TRUE(StripDebug(&cache, binary, &optimized));
+  // Not even a module: it would fail to parse.
+  const std::vector<uint32_t> fake = {1, 2, 3};
+  cache.stored[cache.looked_up[0]] = fake;
+
+  // The input may alias the output.
+  Optimizer opt(SPV_ENV_UNIVERSAL_1_0);
+  opt.RegisterPassFromFlag("--strip-debug");
+  opt.SetCache(&cache);
+  std::vector<uint32_t> result = binary;
+  EXPECT_TRUE(opt.Run(result.data(), result.size(), &result));
+  EXPECT_EQ(fake, result);
+}
+
+TEST(OptimizerCache, FailureIsNotStored) {
+  // Duplicate non-aggregate types are invalid.
+  const std::vector<uint32_t> binary =
+      Assemble(std::string(kModule) + "%void = OpTypeVoid\n");
+  TestCache cache;
+
+  std::vector<uint32_t> optimized;
+  EXPECT_FALSE(StripDebug(&cache, binary, &optimized));
+  EXPECT_EQ(1u, cache.looked_up.size());
+  EXPECT_TRUE(cache.stored.empty());
+}
+
+TEST(OptimizerCache, KeyDependsOnModulePassesAndOptions) {
+  const std::vector<uint32_t> binary = Assemble(kModule);
+  const std::vector<uint32_t> other = Assemble(std::string(kModule) +
+                                               "%float = OpTypeFloat 32\n");
+  TestCache cache;
+  std::vector<uint32_t> optimized;
+
+  EXPECT_TRUE(StripDebug(&cache, binary, &optimized));
+  EXPECT_TRUE(StripDebug(&cache, other, &optimized));
+  OptimizerOptions options;
+  options.set_preserve_bindings(true);
+  EXPECT_TRUE(StripDebug(&cache, binary, &optimized, options));
+  EXPECT_TRUE(StripDebug(&cache, binary, &optimized, OptimizerOptions(),
+                         SPV_ENV_UNIVERSAL_1_1));
+  EXPECT_EQ(4u, cache.stored.size());
+
+  Optimizer strip_reflect(SPV_ENV_UNIVERSAL_1_0);
+  strip_reflect.RegisterPassFromFlag("--strip-reflect");
+  strip_reflect.SetCache(&cache);
+  EXPECT_TRUE(strip_reflect.Run(binary.data(), binary.size(), &optimized));
+  EXPECT_EQ(5u, cache.stored.size());
+}
+
+TEST(OptimizerCache, KeyDependsOnFlagArguments) {
+  const std::vector<uint32_t> binary = Assemble(kModule);
+  TestCache cache;
+  std::vector<uint32_t> optimized;
+
+  Optimizer unroll(SPV_ENV_UNIVERSAL_1_0);
+  unroll.RegisterPassFromFlag("--loop-unroll-partial=2");
+  unroll.SetCache(&cache);
+  EXPECT_TRUE(unroll.Run(binary.data(), binary.size(), &optimized));
+
+  Optimizer unroll_more(SPV_ENV_UNIVERSAL_1_0);
+  unroll_more.RegisterPassFromFlag("--loop-unroll-partial=4");
+  unroll_more.SetCache(&cache);
+  EXPECT_TRUE(unroll_more.Run(binary.data(), binary.size(), &optimized));
+  EXPECT_EQ(2u, cache.stored.size());
+}
+
+TEST(OptimizerCache, PassesNotFromFlagsAreNotCached) {
+  const std::vector<uint32_t> binary = Assemble(kModule);
+  TestCache cache;
+
+  // The key could not tell the two limits apart.
+  for (uint32_t limit : {10u, 20u}) {
+    Optimizer opt(SPV_ENV_UNIVERSAL_1_0);
+    opt.RegisterPassFromFlag("--strip-debug");
+    opt.RegisterPass(CreateScalarReplacementPass(limit)).SetCache(&cache);
+    std::vector<uint32_t> optimized;
+    EXPECT_TRUE(opt.Run(binary.data(), binary.size(), &optimized));
+  }
+  EXPECT_TRUE(cache.looked_up.empty());
+  EXPECT_TRUE(cache.stored.empty());
+}
+
+TEST(OptimizerCache, KeyDoesNotDependOnNumThreads) {
+  const std::vector<uint32_t> binary = Assemble(kModule);
+  TestCache cache;
+
+  std::vector<uint32_t> optimized;
+  OptimizerOptions options;
+  EXPECT_TRUE(StripDebug(&cache, binary, &optimized, options));
+  options.set_num_threads(4);
+  EXPECT_TRUE(StripDebug(&cache, binary, &optimized, options));
+  EXPECT_EQ(1u, cache.stored.size());
+}
+
+TEST(OptimizerCache, RemovedCacheIsNotUsed) {
+  const std::vector<uint32_t> binary = Assemble(kModule);
+  TestCache cache;
+  Optimizer opt(SPV_ENV_UNIVERSAL_1_0);
+  opt.RegisterPassFromFlag("--strip-debug");
+  opt.SetCache(&cache);
+  opt.SetCache(nullptr);
+
+  std::vector<uint32_t> optimized;
+  EXPECT_TRUE(opt.Run(binary.data(), binary.size(), &optimized));
+  EXPECT_TRUE(cache.looked_up.empty());
+}
+
+}  // namespace
+}  // namespace opt
+}  // namespace spvtools
@@ -12,7 +12,9 @@
 // See the License for the specific language governing permissions and
 // limitations under the License.
 
+#include <sstream>
 #include <string>
+#include <unordered_map>
 #include <vector>
 
 #include "gmock/gmock.h"
@@ -25,6 +27,8 @@ namespace opt {
 namespace {
 
 using ::testing::Eq;
+using ::testing::HasSubstr;
+using ::testing::Not;
 
 // Return a string that contains the minimum instructions needed to form
 // a valid module.  Other instructions can be appended to this string.
@@ -118,6 +122,369 @@ TEST(Optimizer, CanRunTransformingPassWithAliasedVectors) {
   EXPECT_THAT(disassembly, Eq(Header() + "%void = OpTypeVoid\n"));
 }
 
+TEST(Optimizer, CanChainOptimizersOnOneIR) {
+  SpirvTools tools(SPV_ENV_UNIVERSAL_1_0);
+  std::vector<uint32_t> binary;
+  tools.Assemble(Header() +
+                     "OpName %foo \"foo\"\n%foo = OpTypeVoid\n"
+                     "%uint = OpTypeInt 32 0\n%1 = OpConstant %uint 1",
+                 &binary);
+
+  Optimizer strip(SPV_ENV_UNIVERSAL_1_0);
+  strip.RegisterPass(CreateStripDebugInfoPass());
+  Optimizer dead_constants(SPV_ENV_UNIVERSAL_1_0);
+  dead_constants.RegisterPass(CreateEliminateDeadConstantPass());
+
+  OptimizerOptions options;
+  Optimizer::IRHandle ir;
+  ASSERT_TRUE(strip.BuildIR(binary.data(), binary.size(), &ir, options));
+  EXPECT_TRUE(strip.Run(&ir, options));
+  EXPECT_TRUE(dead_constants.Run(&ir, options));
+  ir.ToBinary(&binary);
+
+  std::string disassembly;
+  tools.Disassemble(binary.data(), binary.size(), &disassembly);
+  EXPECT_THAT(disassembly,
+              Eq(Header() + "%void = OpTypeVoid\n%uint = OpTypeInt 32 0\n"));
+}
+
+TEST(Optimizer, CanRunSpecializationsOfOneIR) {
+  SpirvTools tools(SPV_ENV_UNIVERSAL_1_0);
+  std::vector<uint32_t> binary;
+  tools.Assemble(Header() +
+                     "OpName %sum \"sum\"\nOpDecorate %x SpecId 0\n"
+                     "%uint = OpTypeInt 32 0\n%uint_1 = OpConstant %uint 1\n"
+                     "%x = OpSpecConstant %uint 0\n"
+                     "%sum = OpSpecConstantOp %uint IAdd %x %uint_1",
+                 &binary);
+
+  Optimizer opt(SPV_ENV_UNIVERSAL_1_0);
+  ASSERT_TRUE(opt.RegisterPassFromFlag("--strip-debug"));
+  OptimizerOptions options;
+  Optimizer::IRHandle ir;
+  ASSERT_TRUE(opt.BuildIR(binary.data(), binary.size(), &ir, options));
+
+  const std::vector<std::unordered_map<uint32_t, std::string>> values = {
+      {{0, "1"}}, {{0, "2"}}};
+  std::vector<std::vector<uint32_t>> sequential;
+  ASSERT_TRUE(opt.RunSpecializations(ir, values, &sequential, options));
+  ASSERT_EQ(sequential.size(), 2u);
+  for (uint32_t i = 0; i < 2; ++i) {
+    std::string disassembly;
+    tools.Disassemble(sequential[i], &disassembly);
+    EXPECT_THAT(disassembly, Not(HasSubstr("OpSpecConstant")));
+    EXPECT_THAT(disassembly, Not(HasSubstr("OpName")));
+    EXPECT_THAT(disassembly,
+                HasSubstr("OpConstant %uint " + std::to_string(i + 2)));
+  }
+
+  // The module of the handle is not specialized.
+  ir.ToBinary(&binary);
+  std::string disassembly;
+  tools.Disassemble(binary, &disassembly);
+  EXPECT_THAT(disassembly, HasSubstr("OpSpecConstantOp"));
+
+  options.set_num_threads(2);
+  std::vector<std::vector<uint32_t>> concurrent;
+  ASSERT_TRUE(opt.RunSpecializations(ir, values, &concurrent, options));
+  EXPECT_EQ(concurrent, sequential);
+}
+
+TEST(Optimizer, CanRunEntryPointsOfOneIR) {
+  SpirvTools tools(SPV_ENV_UNIVERSAL_1_0);
+  std::vector<uint32_t> binary;
+  tools.Assemble(Header() +
+                     "OpEntryPoint Fragment %main1 \"main1\"\n"
+                     "OpEntryPoint Fragment %main2 \"main2\"\n"
+                     "OpExecutionMode %main1 OriginUpperLeft\n"
+                     "OpExecutionMode %main2 OriginUpperLeft\n"
+                     "OpName %f1 \"f1\"\nOpName %f2 \"f2\"\n"
+                     "%void = OpTypeVoid\n%fn = OpTypeFunction %void\n"
+                     "%uint = OpTypeInt 32 0\n%uint_7 = OpConstant %uint 7\n"
+                     "%main1 = OpFunction %void None %fn\n%10 = OpLabel\n"
+                     "%11 = OpFunctionCall %void %f1\nOpReturn\nOpFunctionEnd\n"
+                     "%main2 = OpFunction %void None %fn\n%20 = OpLabel\n"
+                     "%21 = OpFunctionCall %void %f2\nOpReturn\nOpFunctionEnd\n"
+                     "%f1 = OpFunction %void None %fn\n%30 = OpLabel\n"
+                     "OpReturn\nOpFunctionEnd\n"
+                     "%f2 = OpFunction %void None %fn\n%40 = OpLabel\n"
+                     "OpReturn\nOpFunctionEnd",
+                 &binary);
+
+  Optimizer opt(SPV_ENV_UNIVERSAL_1_0);
+  ASSERT_TRUE(opt.RegisterPassFromFlag("--eliminate-dead-const"));
+  OptimizerOptions options;
+  Optimizer::IRHandle ir;
+  ASSERT_TRUE(opt.BuildIR(binary.data(), binary.size(), &ir, options));
+
+  std::vector<std::string> names;
+  std::vector<std::vector<uint32_t>> sequential;
+  ASSERT_TRUE(opt.RunEntryPoints(ir, &names, &sequential, options));
+  EXPECT_THAT(names, ::testing::ElementsAre("main1", "main2"));
+  ASSERT_EQ(sequential.size(), 2u);
+  for (uint32_t i = 0; i < 2; ++i) {
+    const std::string kept = std::to_string(i + 1);
+    const std::string removed = std::to_string(2 - i);
+    std::string disassembly;
+    tools.Disassemble(sequential[i], &disassembly);
+    EXPECT_THAT(disassembly, HasSubstr("%main" + kept + " = OpFunction"));
+    EXPECT_THAT(disassembly, HasSubstr("%f" + kept + " = OpFunction"));
+    EXPECT_THAT(disassembly, Not(HasSubstr("%main" + removed)));
+    EXPECT_THAT(disassembly, Not(HasSubstr("%f" + removed)));
+    // The passes run on every entry point.
+    EXPECT_THAT(disassembly, Not(HasSubstr("OpConstant")));
+  }
+
+  // The module of the handle keeps both entry points.
+  ir.ToBinary(&binary);
+  std::string disassembly;
+  tools.Disassemble(binary, &disassembly);
+  EXPECT_THAT(disassembly, HasSubstr("%f2 = OpFunction"));
+  EXPECT_THAT(disassembly, HasSubstr("OpConstant"));
+
+  options.set_num_threads(2);
+  std::vector<std::vector<uint32_t>> concurrent;
+  ASSERT_TRUE(opt.RunEntryPoints(ir, &names, &concurrent, options));
+  EXPECT_EQ(concurrent, sequential);
+}
+
+TEST(Optimizer, CanRunBatchOfModules) {
+  SpirvTools tools(SPV_ENV_UNIVERSAL_1_0);
+  std::vector<std::vector<uint32_t>> binaries(3);
+  tools.Assemble(Header() + "OpName %foo \"foo\"\n%foo = OpTypeVoid",
+                 &binaries[0]);
+  tools.Assemble(Header() + "%void = OpTypeVoid\n%void2 = OpTypeVoid",
+                 &binaries[1]);
+  tools.Assemble(Header() + "OpName %bar \"bar\"\n%bar = OpTypeFloat 32",
+                 &binaries[2]);
+
+  Optimizer opt(SPV_ENV_UNIVERSAL_1_0);
+  ASSERT_TRUE(opt.RegisterPassFromFlag("--strip-debug"));
+  OptimizerOptions options;
+  for (uint32_t num_threads : {1u, 2u}) {
+    options.set_num_threads(num_threads);
+    std::vector<std::vector<uint32_t>> optimized;
+    std::vector<std::string> messages;
+    // The second module has two identical non-aggregate types.
+    EXPECT_FALSE(opt.RunBatch(binaries, &optimized, &messages, options));
+    ASSERT_EQ(optimized.size(), 3u);
+    ASSERT_EQ(messages.size(), 3u);
+
+    std::string disassembly;
+    tools.Disassemble(optimized[0], &disassembly);
+    EXPECT_THAT(disassembly, Eq(Header() + "%void = OpTypeVoid\n"));
+    tools.Disassemble(optimized[2], &disassembly);
+    EXPECT_THAT(disassembly, Eq(Header() + "%float = OpTypeFloat 32\n"));
+    EXPECT_TRUE(optimized[1].empty());
+
+    EXPECT_THAT(messages[0], Eq(""));
+    EXPECT_THAT(messages[1], HasSubstr("error: "));
+    EXPECT_THAT(messages[2], Eq(""));
+  }
+}
+
+TEST(Optimizer, OneOptimizerOptimizesSeveralModules) {
+  SpirvTools tools(SPV_ENV_UNIVERSAL_1_0);
+  std::vector<std::vector<uint32_t>> binaries(2);
+  tools.Assemble(Header() + "OpName %foo \"foo\"\n%foo = OpTypeVoid",
+                 &binaries[0]);
+  tools.Assemble(Header() + "OpName %bar \"bar\"\n%bar = OpTypeFloat 32",
+                 &binaries[1]);
+
+  Optimizer opt(SPV_ENV_UNIVERSAL_1_0);
+  ASSERT_TRUE(opt.RegisterPassFromFlag("--strip-debug"));
+  OptimizerOptions options;
+  std::vector<std::vector<uint32_t>> optimized;
+  ASSERT_TRUE(opt.RunBatch(binaries, &optimized, nullptr, options));
+  ASSERT_EQ(optimized.size(), 2u);
+  std::string disassembly;
+  tools.Disassemble(optimized[0], &disassembly);
+  EXPECT_THAT(disassembly, Eq(Header() + "%void = OpTypeVoid\n"));
+  tools.Disassemble(optimized[1], &disassembly);
+  EXPECT_THAT(disassembly, Eq(Header() + "%float = OpTypeFloat 32\n"));
+
+  // The batch leaves the passes of the optimizer for its own run.
+  std::vector<uint32_t> binary;
+  ASSERT_TRUE(opt.Run(binaries[1].data(), binaries[1].size(), &binary));
+  EXPECT_EQ(optimized[1], binary);
+}
+
+TEST(Optimizer, CanRunOneFunctionAtATime) {
+  SpirvTools tools(SPV_ENV_UNIVERSAL_1_0);
+  std::vector<uint32_t> binary;
+  tools.Assemble(Header() +
+                     "OpEntryPoint Fragment %main \"main\"\n"
+                     "OpExecutionMode %main OriginUpperLeft\n"
+                     "OpName %f \"f\"\nOpName %x \"x\"\nOpName %v \"v\"\n"
+                     "%void = OpTypeVoid\n%fn = OpTypeFunction %void\n"
+                     "%float = OpTypeFloat 32\n"
+                     "%float_fn = OpTypeFunction %float %float\n"
+                     "%ptr = OpTypePointer Function %float\n"
+                     "%float_1 = OpConstant %float 1\n"
+                     "%main = OpFunction %void None %fn\n%10 = OpLabel\n"
+                     "%v = OpVariable %ptr Function\n"
+                     "OpStore %v %float_1\n%11 = OpLoad %float %v\n"
+                     "%12 = OpFunctionCall %float %f %11\n"
+                     "OpReturn\nOpFunctionEnd\n"
+                     "%f = OpFunction %float None %float_fn\n"
+                     "%x = OpFunctionParameter %float\n%20 = OpLabel\n"
+                     "%21 = OpVariable %ptr Function\n"
+                     "OpStore %21 %x\n%22 = OpLoad %float %21\n"
+                     "OpReturnValue %22\nOpFunctionEnd",
+                 &binary);
+
+  Optimizer opt(SPV_ENV_UNIVERSAL_1_0);
+  ASSERT_TRUE(opt.RegisterPassesFromFlags({"--ssa-rewrite"}));
+  OptimizerOptions options;
+  std::vector<uint32_t> streamed;
+  ASSERT_TRUE(
+      opt.RunStreaming(binary.data(), binary.size(), &streamed, options));
+  std::string disassembly;
+  tools.Disassemble(streamed, &disassembly);
+  EXPECT_THAT(disassembly, HasSubstr("OpName %x \"x\""));
+  EXPECT_THAT(disassembly, Not(HasSubstr("OpName %v")));
+  EXPECT_THAT(disassembly, HasSubstr("OpFunctionCall %float %f %float_1"));
+  EXPECT_THAT(disassembly, HasSubstr("OpReturnValue %x"));
+  EXPECT_THAT(disassembly, Not(HasSubstr("OpLoad")));
+
+  std::vector<uint32_t> optimized;
+  ASSERT_TRUE(opt.Run(binary.data(), binary.size(), &optimized, options));
+  EXPECT_EQ(streamed, optimized);
+
+  // Inlining needs the callees of a function.
+  Optimizer inliner(SPV_ENV_UNIVERSAL_1_0);
+  ASSERT_TRUE(
+      inliner.RegisterPassesFromFlags({"--inline-entry-points-exhaustive"}));
+  EXPECT_FALSE(
+      inliner.RunStreaming(binary.data(), binary.size(), &streamed, options));
+}
+
+TEST(Optimizer, BuildIRValidatesModule) {
+  SpirvTools tools(SPV_ENV_UNIVERSAL_1_0);
+  std::vector<uint32_t> binary;
+  tools.Assemble(Header() + "%void = OpTypeVoid\n%void2 = OpTypeVoid",
+                 &binary);
+
+  Optimizer opt(SPV_ENV_UNIVERSAL_1_0);
+  OptimizerOptions options;
+  Optimizer::IRHandle ir;
+  EXPECT_FALSE(opt.BuildIR(binary.data(), binary.size(), &ir, options));
+  EXPECT_FALSE(ir.HasModule());
+
+  options.set_run_validator(false);
+  EXPECT_TRUE(opt.BuildIR(binary.data(), binary.size(), &ir, options));
+  EXPECT_TRUE(ir.HasModule());
+}
+
+TEST(Optimizer, CanWriteProfileTrace) {
+  SpirvTools tools(SPV_ENV_UNIVERSAL_1_0);
+  std::vector<uint32_t> binary;
+  tools.Assemble(R"(OpCapability Shader
+OpMemoryModel Logical GLSL450
+OpEntryPoint GLCompute %main "main"
+OpExecutionMode %main LocalSize 1 1 1
+%void = OpTypeVoid
+%void_fn = OpTypeFunction %void
+%main = OpFunction %void None %void_fn
+%entry = OpLabel
+OpBranch %next
+%next = OpLabel
+OpReturn
+OpFunctionEnd
+)",
+                 &binary);
+
+  std::ostringstream trace;
+  Optimizer opt(SPV_ENV_UNIVERSAL_1_0);
+  opt.RegisterPass(CreateBlockMergePass()).SetProfileTrace(&trace);
+  EXPECT_TRUE(opt.Run(binary.data(), binary.size(), &binary));
+
+  EXPECT_THAT(trace.str(), HasSubstr("{\"traceEvents\":["));
+  EXPECT_THAT(trace.str(), HasSubstr("\"name\":\"validate\""));
+  EXPECT_THAT(trace.str(), HasSubstr("\"name\":\"parse\""));
+  EXPECT_THAT(trace.str(),
+              HasSubstr("\"name\":\"merge-blocks\",\"cat\":\"pass\""));
+  EXPECT_THAT(trace.str(),
+              HasSubstr("\"name\":\"function %1\",\"cat\":\"function\""));
+  EXPECT_THAT(trace.str(),
+              HasSubstr("\"name\":\"def-use\",\"cat\":\"analysis\""));
+  EXPECT_THAT(trace.str(),
+              HasSubstr("\"name\":\"cfg\",\"cat\":\"analysis\""));
+  EXPECT_THAT(trace.str(), HasSubstr("\"name\":\"serialize\""));
+}
+
+TEST(Optimizer, CountsAnalysisBuilds) {
+  SpirvTools tools(SPV_ENV_UNIVERSAL_1_0);
+  std::vector<uint32_t> binary;
+  tools.Assemble(Header() + "%uint = OpTypeInt 32 0\n%1 = OpConstant %uint 1",
+                 &binary);
+
+  Optimizer opt(SPV_ENV_UNIVERSAL_1_0);
+  Optimizer::Statistics statistics = opt.GetStatistics();
+  ASSERT_EQ(16u, statistics.analyses.size());
+  EXPECT_STREQ("def-use", statistics.analyses[0].name);
+  EXPECT_EQ(0u, statistics.analyses[0].builds);
+
+  opt.RegisterPass(CreateEliminateDeadConstantPass());
+  EXPECT_TRUE(opt.Run(binary.data(), binary.size(), &binary));
+  statistics = opt.GetStatistics();
+  ASSERT_EQ(16u, statistics.analyses.size());
+  EXPECT_STREQ("def-use", statistics.analyses[0].name);
+  EXPECT_LE(1u, statistics.analyses[0].builds);
+}
+
+TEST(Optimizer, KeepsBiasedBranchesWithBlockCounts) {
+  SpirvTools tools(SPV_ENV_UNIVERSAL_1_0);
+  std::vector<uint32_t> binary;
+  tools.Assemble(R"(OpCapability Shader
+OpMemoryModel Logical GLSL450
+OpEntryPoint Vertex %1 "func" %2
+%3 = OpTypeVoid
+%4 = OpTypeBool
+%5 = OpTypeInt 32 0
+%6 = OpConstant %5 0
+%7 = OpConstant %5 1
+%8 = OpTypePointer Output %5
+%9 = OpTypePointer Input %4
+%2 = OpVariable %8 Output
+%10 = OpVariable %9 Input
+%11 = OpTypeFunction %3
+%1 = OpFunction %3 None %11
+%12 = OpLabel
+%13 = OpLoad %4 %10
+OpSelectionMerge %14 None
+OpBranchConditional %13 %15 %16
+%15 = OpLabel
+OpBranch %14
+%16 = OpLabel
+OpBranch %14
+%14 = OpLabel
+%17 = OpPhi %5 %6 %15 %7 %16
+OpStore %2 %17
+OpReturn
+OpFunctionEnd
+)",
+                 &binary, SPV_TEXT_TO_BINARY_OPTION_PRESERVE_NUMERIC_IDS);
+
+  // The true side is taken once in a hundred executions.
+  std::vector<uint32_t> optimized;
+  Optimizer opt(SPV_ENV_UNIVERSAL_1_0);
+  opt.RegisterPass(CreateIfConversionPass())
+      .SetBlockCounts({{12, 100}, {14, 100}, {15, 1}, {16, 99}});
+  EXPECT_TRUE(opt.Run(binary.data(), binary.size(), &optimized));
+  std::string disassembly;
+  tools.Disassemble(optimized, &disassembly);
+  EXPECT_THAT(disassembly, HasSubstr("OpPhi"));
+  EXPECT_THAT(disassembly, Not(HasSubstr("OpSelect ")));
+
+  // Without the counts, the phi is converted.
+  opt.SetBlockCounts({});
+  EXPECT_TRUE(opt.Run(binary.data(), binary.size(), &optimized));
+  tools.Disassemble(optimized, &disassembly);
+  EXPECT_THAT(disassembly, Not(HasSubstr("OpPhi")));
+  EXPECT_THAT(disassembly, HasSubstr("OpSelect "));
+}
+
 TEST(Optimizer, CanValidateFlags) {
   Optimizer opt(SPV_ENV_UNIVERSAL_1_0);
   EXPECT_FALSE(opt.FlagHasValidForm("bad-flag"));
@@ -0,0 +1,168 @@
+// Copyright (c) 2019 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <string>
+
+#include "test/opt/pass_fixture.h"
+#include "test/opt/pass_utils.h"
+
+namespace spvtools {
+namespace opt {
+namespace {
+
+using PartialRedundancyEliminationTest = PassTest<::testing::Test>;
+
+TEST_F(PartialRedundancyEliminationTest, ValueComputedOnOnePath) {
+  const std::string text = R"(
+; CHECK: %else = OpLabel
+; CHECK-NEXT: [[copy:%\w+]] = OpIAdd %int %a %b
+; CHECK-NEXT: OpBranch %merge
+; CHECK: %merge = OpLabel
+; CHECK-NEXT: [[value:%\w+]] = OpPhi %int %add1 %then [[copy]] %else
+; CHECK-NOT: OpIAdd %int %a %b
+; CHECK: OpIAdd %int %phi [[value]]
+OpCapability Shader
+OpCapability Linkage
+OpMemoryModel Logical GLSL450
+OpName %f "f"
+OpName %a "a"
+OpName %b "b"
+OpName %cond "cond"
+OpName %entry "entry"
+OpName %then "then"
+OpName %else "else"
+OpName %merge "merge"
+OpName %add1 "add1"
+OpName %phi "phi"
+OpDecorate %f LinkageAttributes "f" Export
+%int = OpTypeInt 32 1
+%bool = OpTypeBool
+%fn = OpTypeFunction %int %int %int %bool
+%f = OpFunction %int None %fn
+%a = OpFunctionParameter %int
+%b = OpFunctionParameter %int
+%cond = OpFunctionParameter %bool
+%entry = OpLabel
+OpSelectionMerge %merge None
+OpBranchConditional %cond %then %else
+%then = OpLabel
+%add1 = OpIAdd %int %a %b
+OpBranch %merge
+%else = OpLabel
+OpBranch %merge
+%merge = OpLabel
+%phi = OpPhi %int %add1 %then %a %else
+%add2 = OpIAdd %int %a %b
+%sum = OpIAdd %int %phi %add2
+OpReturnValue %sum
+OpFunctionEnd
+)";
+
+  SinglePassRunAndMatch<PartialRedundancyEliminationPass>(text, true);
+}
+
+TEST_F(PartialRedundancyEliminationTest, ValueComputedInLoop) {
+  // The product is computed in the latch, so only the first iteration needs
+  // the copy inserted before the loop.
+  const std::string text = R"(
+; CHECK: %entry = OpLabel
+; CHECK-NEXT: [[copy:%\w+]] = OpIMul %int %a %b
+; CHECK-NEXT: OpBranch %header
+; CHECK: %header = OpLabel
+; CHECK-NEXT: [[value:%\w+]] = OpPhi %int [[copy]] %entry %mul2 %latch
+; CHECK-NOT: OpIMul
+; CHECK: OpSLessThan %bool %i [[value]]
+; CHECK: %latch = OpLabel
+; CHECK-NEXT: %mul2 = OpIMul %int %a %b
+OpCapability Shader
+OpCapability Linkage
+OpMemoryModel Logical GLSL450
+OpName %f "f"
+OpName %a "a"
+OpName %b "b"
+OpName %entry "entry"
+OpName %header "header"
+OpName %latch "latch"
+OpName %i "i"
+OpName %mul2 "mul2"
+OpDecorate %f LinkageAttributes "f" Export
+%int = OpTypeInt 32 1
+%int_0 = OpConstant %int 0
+%bool = OpTypeBool
+%fn = OpTypeFunction %int %int %int
+%f = OpFunction %int None %fn
+%a = OpFunctionParameter %int
+%b = OpFunctionParameter %int
+%entry = OpLabel
+OpBranch %header
+%header = OpLabel
+%i = OpPhi %int %int_0 %entry %inc %latch
+%mul1 = OpIMul %int %a %b
+%cmp = OpSLessThan %bool %i %mul1
+OpLoopMerge %exit %latch None
+OpBranchConditional %cmp %latch %exit
+%latch = OpLabel
+%mul2 = OpIMul %int %a %b
+%inc = OpIAdd %int %i %mul2
+OpBranch %header
+%exit = OpLabel
+OpReturnValue %i
+OpFunctionEnd
+)";
+
+  SinglePassRunAndMatch<PartialRedundancyEliminationPass>(text, true);
+}
+
+TEST_F(PartialRedundancyEliminationTest, NoCopyOnCriticalEdge) {
+  // A copy at the end of %entry would be computed on the path to %then too.
+  const std::string text = R"(
+; CHECK: %entry = OpLabel
+; CHECK-NOT: OpIAdd
+; CHECK: %merge = OpLabel
+; CHECK-NEXT: %add2 = OpIAdd %int %a %b
+OpCapability Shader
+OpCapability Linkage
+OpMemoryModel Logical GLSL450
+OpName %f "f"
+OpName %a "a"
+OpName %b "b"
+OpName %entry "entry"
+OpName %merge "merge"
+OpName %add2 "add2"
+OpDecorate %f LinkageAttributes "f" Export
+%int = OpTypeInt 32 1
+%bool = OpTypeBool
+%fn = OpTypeFunction %int %int %int %bool
+%f = OpFunction %int None %fn
+%a = OpFunctionParameter %int
+%b = OpFunctionParameter %int
+%cond = OpFunctionParameter %bool
+%entry = OpLabel
+OpSelectionMerge %merge None
+OpBranchConditional %cond %then %merge
+%then = OpLabel
+%add1 = OpIAdd %int %a %b
+OpBranch %merge
+%merge = OpLabel
+%add2 = OpIAdd %int %a %b
+OpReturnValue %add2
+OpFunctionEnd
+)";
+
+  SinglePassRunAndMatch<PartialRedundancyEliminationPass>(text, true);
+}
+
+}  // namespace
+}  // namespace opt
+}  // namespace spvtools
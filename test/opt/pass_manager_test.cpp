@@ -12,9 +12,12 @@
 // See the License for the specific language governing permissions and
 // limitations under the License.
 
+#include <chrono>
 #include <initializer_list>
+#include <iterator>
 #include <memory>
 #include <string>
+#include <thread>
 #include <utility>
 #include <vector>
 
@@ -29,6 +32,7 @@ namespace {
 
 using spvtest::GetIdBound;
 using ::testing::Eq;
+using ::testing::HasSubstr;
 
 // A null pass whose construtors accept arguments
 class NullPassWithArgs : public NullPass {
@@ -186,6 +190,84 @@ TEST(PassManager, RecomputeIdBoundAutomatically) {
   EXPECT_THAT(GetIdBound(*context.module()), Eq(201u));
 }
 
+TEST(PassManager, ValidateAfterAll) {
+  const std::string text = R"(OpCapability Shader
+OpCapability Linkage
+OpMemoryModel Logical GLSL450
+%void = OpTypeVoid
+)";
+  std::vector<std::string> messages;
+  auto consumer = [&messages](spv_message_level_t, const char*,
+                              const spv_position_t&, const char* message) {
+    messages.push_back(message);
+  };
+  std::unique_ptr<IRContext> context =
+      BuildModule(SPV_ENV_UNIVERSAL_1_2, consumer, text);
+  ASSERT_NE(nullptr, context);
+  context->module()->SetIdBound(10);
+
+  PassManager manager;
+  manager.SetMessageConsumer(consumer);
+  manager.SetValidateAfterAll(true);
+  manager.AddPass<NullPass>();
+  // Declares void again.
+  manager.AddPass(MakeUnique<AppendTypeVoidInstPass>(5));
+  EXPECT_EQ(Pass::Status::Failure, manager.Run(context.get()));
+  ASSERT_EQ(2u, messages.size());
+  EXPECT_THAT(messages[0],
+              HasSubstr("Duplicate non-aggregate type declarations are not "
+                        "allowed. Opcode: TypeVoid id: 5"));
+  EXPECT_THAT(messages[0], HasSubstr("= OpTypeVoid"));
+  EXPECT_THAT(messages[1],
+              Eq("Validation failed after pass AppendTypeVoidInstPass"));
+}
+
+// A required pass that appends an OpNop instruction to the debug1 section
+// after waiting for |delay|.
+class RequiredAppendOpNopPass : public AppendOpNopPass {
+ public:
+  explicit RequiredAppendOpNopPass(std::chrono::milliseconds delay)
+      : delay_(delay) {}
+
+  bool IsRequired() const override { return true; }
+  Status Process() override {
+    std::this_thread::sleep_for(delay_);
+    return AppendOpNopPass::Process();
+  }
+
+ private:
+  std::chrono::milliseconds delay_;
+};
+
+TEST(PassManager, TimeBudget) {
+  const std::string text = "OpMemoryModel Logical GLSL450\n";
+  std::vector<std::string> messages;
+  auto consumer = [&messages](spv_message_level_t, const char*,
+                              const spv_position_t&, const char* message) {
+    messages.push_back(message);
+  };
+  std::unique_ptr<IRContext> context =
+      BuildModule(SPV_ENV_UNIVERSAL_1_2, consumer, text);
+  ASSERT_NE(nullptr, context);
+
+  PassManager manager;
+  manager.SetMessageConsumer(consumer);
+  manager.SetTimeBudget(std::chrono::milliseconds(1));
+  manager.AddPass(
+      MakeUnique<RequiredAppendOpNopPass>(std::chrono::milliseconds(2)));
+  // Skipped, as the first pass took longer than the budget.
+  manager.AddPass<AppendOpNopPass>();
+  manager.AddPass<AppendOpNopPass>();
+  // Still run.
+  manager.AddPass(
+      MakeUnique<RequiredAppendOpNopPass>(std::chrono::milliseconds(0)));
+  EXPECT_EQ(Pass::Status::SuccessWithChange, manager.Run(context.get()));
+  EXPECT_EQ(2u, manager.NumSkippedPasses());
+  EXPECT_EQ(2, std::distance(context->debug1_begin(), context->debug1_end()));
+  EXPECT_THAT(messages, ::testing::ElementsAre(
+                            "Time budget spent, skipped 2 passes"));
+}
+
 }  // anonymous namespace
 }  // namespace opt
 }  // namespace spvtools
@@ -218,6 +218,37 @@ OpDecorate %1 GLSLPacked
   EXPECT_EQ(GetErrorMessage(), "");
 }
 
+TEST_F(RemoveDuplicatesTest, DuplicateDecorations) {
+  const std::string spirv = R"(
+OpCapability Shader
+OpCapability Linkage
+OpMemoryModel Logical GLSL450
+OpDecorate %1 Offset 0
+OpMemberDecorate %3 0 Offset 0
+OpDecorate %1 Offset 4
+OpMemberDecorate %3 1 Offset 0
+OpDecorate %1 Offset 0
+OpMemberDecorate %3 0 Offset 0
+%2 = OpTypeInt 32 0
+%1 = OpTypeStruct %2
+%3 = OpTypeStruct %2 %2
+)";
+  const std::string after = R"(OpCapability Shader
+OpCapability Linkage
+OpMemoryModel Logical GLSL450
+OpDecorate %1 Offset 0
+OpMemberDecorate %3 0 Offset 0
+OpDecorate %1 Offset 4
+OpMemberDecorate %3 1 Offset 0
+%2 = OpTypeInt 32 0
+%1 = OpTypeStruct %2
+%3 = OpTypeStruct %2 %2
+)";
+
+  EXPECT_EQ(RunPass(spirv), after);
+  EXPECT_EQ(GetErrorMessage(), "");
+}
+
 TEST_F(RemoveDuplicatesTest, SameTypeAndDifferentName) {
   const std::string spirv = R"(
 OpCapability Shader
@@ -15,6 +15,7 @@
 #include <map>
 #include <memory>
 #include <string>
+#include <utility>
 #include <vector>
 
 #include "gmock/gmock.h"
@@ -214,6 +215,31 @@ TEST_F(PropagatorTest, PropagateThroughPhis) {
   EXPECT_THAT(GetValues(), UnorderedElementsAre(4u, 4u, 4u));
 }
 
+TEST(DenseLatticeTest, UnsetIdsReadAsUnsetValue) {
+  DenseLattice<uint32_t> lattice(0);
+  lattice.Reserve(4);
+  EXPECT_FALSE(lattice.Has(2));
+  EXPECT_EQ(lattice.Get(100), 0u);
+
+  lattice.Set(2, 7);
+  lattice.Set(100, 9);
+  EXPECT_TRUE(lattice.Has(2));
+  EXPECT_TRUE(lattice.Has(100));
+  EXPECT_FALSE(lattice.Has(3));
+  EXPECT_EQ(lattice.Get(2), 7u);
+  EXPECT_EQ(lattice.Get(100), 9u);
+
+  std::vector<std::pair<uint32_t, uint32_t>> entries;
+  lattice.ForEach([&entries](uint32_t id, uint32_t value) {
+    entries.emplace_back(id, value);
+  });
+  EXPECT_THAT(entries, ::testing::ElementsAre(std::make_pair(2u, 7u),
+                                              std::make_pair(100u, 9u)));
+
+  lattice.Clear();
+  EXPECT_FALSE(lattice.Has(2));
+}
+
 }  // namespace
 }  // namespace opt
 }  // namespace spvtools
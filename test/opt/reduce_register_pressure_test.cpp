@@ -0,0 +1,141 @@
+// Copyright (c) 2019 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <string>
+#include <tuple>
+
+#include "test/opt/pass_fixture.h"
+#include "test/opt/pass_utils.h"
+
+namespace spvtools {
+namespace opt {
+namespace {
+
+using ReduceRegisterPressureTest = PassTest<::testing::Test>;
+
+const std::string kHeader = R"(
+OpCapability Shader
+OpMemoryModel Logical GLSL450
+OpEntryPoint Fragment %main "main" %in %in_array %out
+OpExecutionMode %main OriginUpperLeft
+OpName %main "main"
+OpName %in "in"
+OpName %in_array "in_array"
+OpName %out "out"
+OpDecorate %in Location 0
+OpDecorate %in_array Location 1
+OpDecorate %out Location 0
+%void = OpTypeVoid
+%void_fn = OpTypeFunction %void
+%float = OpTypeFloat 32
+%float_1 = OpConstant %float 1
+%int = OpTypeInt 32 1
+%int_0 = OpConstant %int 0
+%uint = OpTypeInt 32 0
+%uint_4 = OpConstant %uint 4
+%_arr_float_uint_4 = OpTypeArray %float %uint_4
+%_ptr_Input_float = OpTypePointer Input %float
+%_ptr_Input__arr_float_uint_4 = OpTypePointer Input %_arr_float_uint_4
+%_ptr_Output_float = OpTypePointer Output %float
+%in = OpVariable %_ptr_Input_float Input
+%in_array = OpVariable %_ptr_Input__arr_float_uint_4 Input
+%out = OpVariable %_ptr_Output_float Output
+)";
+
+// %a is computed long before its only use, while %x stays live until the end
+// of the block anyway.
+const std::string kEarlyValue = R"(
+%main = OpFunction %void None %void_fn
+%entry = OpLabel
+%x = OpLoad %float %in
+%a = OpFAdd %float %x %float_1
+%b = OpFMul %float %x %x
+%c = OpFAdd %float %b %x
+%d = OpFAdd %float %c %a
+%e = OpFAdd %float %d %x
+OpStore %out %e
+OpReturn
+OpFunctionEnd
+)";
+
+TEST_F(ReduceRegisterPressureTest, MovesValueToItsUse) {
+  const std::string checks = R"(
+; CHECK: %x = OpLoad %float %in
+; CHECK-NEXT: %b = OpFMul %float %x %x
+; CHECK-NEXT: %c = OpFAdd %float %b %x
+; CHECK-NEXT: %a = OpFAdd %float %x %float_1
+; CHECK-NEXT: %d = OpFAdd %float %c %a
+)";
+
+  SinglePassRunAndMatch<ReduceRegisterPressurePass>(
+      checks + kHeader + kEarlyValue, true, 1u);
+}
+
+TEST_F(ReduceRegisterPressureTest, KeepsOperandLiveRanges) {
+  // Moving %a next to %d would keep %x live after its last use.
+  const std::string text = kHeader + R"(
+; CHECK: %a = OpFAdd %float %x %float_1
+; CHECK-NEXT: %b = OpFMul %float %x %x
+%main = OpFunction %void None %void_fn
+%entry = OpLabel
+%x = OpLoad %float %in
+%a = OpFAdd %float %x %float_1
+%b = OpFMul %float %x %x
+%c = OpFAdd %float %b %x
+%d = OpFAdd %float %c %a
+OpStore %out %d
+OpReturn
+OpFunctionEnd
+)";
+
+  SinglePassRunAndMatch<ReduceRegisterPressurePass>(text, true, 1u);
+}
+
+TEST_F(ReduceRegisterPressureTest, RematerializesReadOnlyLoad) {
+  // %x is used in both blocks, so it cannot be sunk, but it is loaded again
+  // in %next instead of being kept live across the branch.
+  const std::string text = kHeader + R"(
+; CHECK: %entry = OpLabel
+; CHECK: %x = OpLoad %float %ptr
+; CHECK: %next = OpLabel
+; CHECK-NEXT: [[ptr:%\w+]] = OpAccessChain %_ptr_Input_float %in_array %int_0
+; CHECK-NEXT: [[x:%\w+]] = OpLoad %float [[ptr]]
+; CHECK-NEXT: %b = OpFMul %float [[x]] [[x]]
+%main = OpFunction %void None %void_fn
+%entry = OpLabel
+%ptr = OpAccessChain %_ptr_Input_float %in_array %int_0
+%x = OpLoad %float %ptr
+%a = OpFAdd %float %x %float_1
+OpStore %out %a
+OpBranch %next
+%next = OpLabel
+%b = OpFMul %float %x %x
+OpStore %out %b
+OpReturn
+OpFunctionEnd
+)";
+
+  SinglePassRunAndMatch<ReduceRegisterPressurePass>(text, true, 1u);
+}
+
+TEST_F(ReduceRegisterPressureTest, NoChangeWithinBudget) {
+  auto result = SinglePassRunAndDisassemble<ReduceRegisterPressurePass>(
+      kHeader + kEarlyValue, /* skip_nop = */ true,
+      /* do_validation = */ true, 100u);
+  EXPECT_EQ(Pass::Status::SuccessWithoutChange, std::get<1>(result));
+}
+
+}  // namespace
+}  // namespace opt
+}  // namespace spvtools
@@ -137,6 +137,50 @@ OpFunctionEnd
       true);
 }
 
+TEST_F(RelaxFloatOpsTest, RelaxFloatOpsInRange) {
+  // The input is unbounded, so only the computations after the clamp are
+  // relaxed.
+  const std::string text = R"(
+; CHECK-NOT: OpDecorate %10 RelaxedPrecision
+; CHECK-NOT: OpDecorate %11 RelaxedPrecision
+; CHECK: OpDecorate %12 RelaxedPrecision
+; CHECK-NEXT: OpDecorate %13 RelaxedPrecision
+; CHECK-NEXT: OpDecorate %15 RelaxedPrecision
+; CHECK-NOT: OpDecorate %14 RelaxedPrecision
+OpCapability Shader
+%1 = OpExtInstImport "GLSL.std.450"
+OpMemoryModel Logical GLSL450
+OpEntryPoint Fragment %main "main" %in %out
+OpExecutionMode %main OriginUpperLeft
+OpDecorate %in Location 0
+OpDecorate %out Location 0
+%void = OpTypeVoid
+%3 = OpTypeFunction %void
+%float = OpTypeFloat 32
+%float_0 = OpConstant %float 0
+%float_0_5 = OpConstant %float 0.5
+%float_1 = OpConstant %float 1
+%_ptr_Input_float = OpTypePointer Input %float
+%_ptr_Output_float = OpTypePointer Output %float
+%in = OpVariable %_ptr_Input_float Input
+%out = OpVariable %_ptr_Output_float Output
+%main = OpFunction %void None %3
+%5 = OpLabel
+%10 = OpLoad %float %in
+%11 = OpExtInst %float %1 FClamp %10 %float_0 %float_1
+%12 = OpFMul %float %11 %float_0_5
+%13 = OpExtInst %float %1 Sin %12
+%14 = OpFMul %float %10 %float_0_5
+%15 = OpFAdd %float %13 %float_1
+OpStore %out %15
+OpReturn
+OpFunctionEnd
+)";
+
+  SetAssembleOptions(SPV_TEXT_TO_BINARY_OPTION_PRESERVE_NUMERIC_IDS);
+  SinglePassRunAndMatch<RelaxFloatOpsPass>(text, true, 65504.0);
+}
+
 }  // namespace
 }  // namespace opt
 }  // namespace spvtools
@@ -155,6 +155,86 @@ TEST_F(ScalarAnalysisTest, BasicEvolutionTest) {
   EXPECT_EQ(simplified->GetChild(0), simplified->GetChild(1));
 }
 
+// Checks that the nodes of a loop are rebuilt once the loop is invalidated.
+TEST_F(ScalarAnalysisTest, InvalidateLoop) {
+  const std::string text = R"(
+               OpCapability Shader
+               OpMemoryModel Logical GLSL450
+               OpEntryPoint Fragment %4 "main" %24
+               OpExecutionMode %4 OriginUpperLeft
+               OpDecorate %24 Location 1
+          %2 = OpTypeVoid
+          %3 = OpTypeFunction %2
+          %6 = OpTypeInt 32 1
+          %9 = OpConstant %6 0
+         %16 = OpConstant %6 10
+         %17 = OpTypeBool
+         %19 = OpTypeFloat 32
+         %20 = OpTypeInt 32 0
+         %21 = OpConstant %20 10
+         %22 = OpTypeArray %19 %21
+         %23 = OpTypePointer Output %22
+         %24 = OpVariable %23 Output
+         %27 = OpConstant %6 1
+         %29 = OpTypePointer Output %19
+          %4 = OpFunction %2 None %3
+          %5 = OpLabel
+               OpBranch %10
+         %10 = OpLabel
+         %35 = OpPhi %6 %9 %5 %34 %13
+               OpLoopMerge %12 %13 None
+               OpBranch %14
+         %14 = OpLabel
+         %18 = OpSLessThan %17 %35 %16
+               OpBranchConditional %18 %11 %12
+         %11 = OpLabel
+         %28 = OpIAdd %6 %35 %27
+         %30 = OpAccessChain %29 %24 %28
+         %31 = OpLoad %19 %30
+         %32 = OpAccessChain %29 %24 %35
+               OpStore %32 %31
+               OpBranch %13
+         %13 = OpLabel
+         %34 = OpIAdd %6 %35 %27
+               OpBranch %10
+         %12 = OpLabel
+               OpReturn
+               OpFunctionEnd
+  )";
+  std::unique_ptr<IRContext> context =
+      BuildModule(SPV_ENV_UNIVERSAL_1_1, nullptr, text,
+                  SPV_TEXT_TO_BINARY_OPTION_PRESERVE_NUMERIC_IDS);
+  Module* module = context->module();
+  EXPECT_NE(nullptr, module) << "Assembling failed for shader:\n"
+                             << text << std::endl;
+  const Function* f = spvtest::GetFunction(module, 4);
+  Loop* loop = (*context->GetLoopDescriptor(f))[10];
+  ScalarEvolutionAnalysis analysis{context.get()};
+  Instruction* add = context->get_def_use_mgr()->GetDef(28);
+
+  // REC(0,1) + 1 is simplified into REC(1,1).
+  SENode* node = analysis.SimplifyExpression(analysis.AnalyzeInstruction(add));
+  ASSERT_EQ(node->GetType(), SENode::RecurrentAddExpr);
+  const SERecurrentNode* recurrent = node->AsSERecurrentNode();
+  EXPECT_EQ(recurrent->GetOffset()->AsSEConstantNode()->FoldToSingleValue(),
+            1);
+  EXPECT_EQ(node,
+            analysis.SimplifyExpression(analysis.AnalyzeInstruction(add)));
+
+  // Add 0 rather than 1, then forget the nodes of the loop.
+  analysis.InvalidateLoop(loop);
+  add->SetInOperand(1, {9});
+  context->get_def_use_mgr()->AnalyzeInstUse(add);
+
+  node = analysis.SimplifyExpression(analysis.AnalyzeInstruction(add));
+  ASSERT_EQ(node->GetType(), SENode::RecurrentAddExpr);
+  recurrent = node->AsSERecurrentNode();
+  EXPECT_EQ(recurrent->GetOffset()->AsSEConstantNode()->FoldToSingleValue(),
+            0);
+  EXPECT_EQ(
+      recurrent->GetCoefficient()->AsSEConstantNode()->FoldToSingleValue(), 1);
+}
+
 /*
 Generated from the following GLSL + --eliminate-local-multi-store
 
@@ -1482,7 +1482,8 @@ OpFunctionEnd
   SinglePassRunAndMatch<ScalarReplacementPass>(text, true);
 }
 
-// Test that a struct of size 4 is not replaced when there is a limit of 2.
+// Test that a struct of size 4 is not replaced when there is a limit of 2 and
+// more than 2 of its members are accessed.
 TEST_F(ScalarReplacementTest, TestLimit) {
   const std::string text = R"(
 OpCapability Shader
@@ -1508,7 +1509,10 @@ OpName %6 "simple_struct"
 %17 = OpAccessChain %5 %14 %10
 %18 = OpLoad %2 %17
 %19 = OpIAdd %2 %16 %18
-OpReturnValue %19
+%20 = OpAccessChain %5 %14 %9
+%21 = OpLoad %2 %20
+%22 = OpIAdd %2 %19 %21
+OpReturnValue %22
 OpFunctionEnd
   )";
 
@@ -1899,6 +1903,85 @@ TEST_F(ScalarReplacementTest, RelaxedPrecisionMemberDecoration) {
   SinglePassRunAndMatch<ScalarReplacementPass>(text, true);
 }
 
+// Test that only the accessed elements of an array over the size limit are
+// replaced.
+TEST_F(ScalarReplacementTest, LazyReplacementOfLargeArray) {
+  const std::string text = R"(
+; CHECK-NOT: OpVariable %_ptr_Function__arr_float_uint_200
+; CHECK: [[var7:%\w+]] = OpVariable %_ptr_Function_float Function
+; CHECK: [[var3:%\w+]] = OpVariable %_ptr_Function_float Function
+; CHECK-NOT: OpVariable
+; CHECK: OpStore [[var3]] %float_1
+; CHECK: OpLoad %float [[var7]]
+               OpCapability Shader
+               OpCapability Linkage
+               OpMemoryModel Logical GLSL450
+       %void = OpTypeVoid
+      %float = OpTypeFloat 32
+       %uint = OpTypeInt 32 0
+   %uint_200 = OpConstant %uint 200
+     %uint_3 = OpConstant %uint 3
+     %uint_7 = OpConstant %uint 7
+    %float_1 = OpConstant %float 1
+%_arr_float_uint_200 = OpTypeArray %float %uint_200
+%_ptr_Function__arr_float_uint_200 = OpTypePointer Function %_arr_float_uint_200
+%_ptr_Function_float = OpTypePointer Function %float
+          %9 = OpTypeFunction %float
+         %10 = OpFunction %float None %9
+         %11 = OpLabel
+         %12 = OpVariable %_ptr_Function__arr_float_uint_200 Function
+         %13 = OpAccessChain %_ptr_Function_float %12 %uint_3
+               OpStore %13 %float_1
+         %14 = OpAccessChain %_ptr_Function_float %12 %uint_7
+         %15 = OpLoad %float %14
+               OpReturnValue %15
+               OpFunctionEnd
+)";
+
+  SinglePassRunAndMatch<ScalarReplacementPass>(text, true);
+}
+
+// Test that a variable over the size limit that is also loaded and stored as a
+// whole is kept for the elements that are not replaced.
+TEST_F(ScalarReplacementTest, LazyReplacementKeepsResidual) {
+  const std::string text = R"(
+; CHECK: [[struct:%\w+]] = OpTypeStruct %uint %uint %uint %uint
+; CHECK: [[in:%\w+]] = OpFunctionParameter [[struct]]
+; CHECK: [[var1:%\w+]] = OpVariable %_ptr_Function_uint Function
+; CHECK: [[residual:%\w+]] = OpVariable {{%\w+}} Function
+; CHECK: [[ex:%\w+]] = OpCompositeExtract %uint [[in]] 1
+; CHECK: OpStore [[var1]] [[ex]]
+; CHECK: OpStore [[residual]] [[in]]
+; CHECK: OpStore [[var1]] %uint_5
+; CHECK: [[ld:%\w+]] = OpLoad [[struct]] [[residual]]
+; CHECK: [[ld1:%\w+]] = OpLoad %uint [[var1]]
+; CHECK: [[ins:%\w+]] = OpCompositeInsert [[struct]] [[ld1]] [[ld]] 1
+; CHECK: OpReturnValue [[ins]]
+               OpCapability Shader
+               OpCapability Linkage
+               OpMemoryModel Logical GLSL450
+       %uint = OpTypeInt 32 0
+     %uint_1 = OpConstant %uint 1
+     %uint_5 = OpConstant %uint 5
+     %struct = OpTypeStruct %uint %uint %uint %uint
+%_ptr_Function_struct = OpTypePointer Function %struct
+%_ptr_Function_uint = OpTypePointer Function %uint
+          %7 = OpTypeFunction %struct %struct
+          %8 = OpFunction %struct None %7
+         %in = OpFunctionParameter %struct
+          %9 = OpLabel
+         %10 = OpVariable %_ptr_Function_struct Function
+               OpStore %10 %in
+         %11 = OpAccessChain %_ptr_Function_uint %10 %uint_1
+               OpStore %11 %uint_5
+         %12 = OpLoad %struct %10
+               OpReturnValue %12
+               OpFunctionEnd
+)";
+
+  SinglePassRunAndMatch<ScalarReplacementPass>(text, true, 2);
+}
+
 }  // namespace
 }  // namespace opt
 }  // namespace spvtools
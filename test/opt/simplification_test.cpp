@@ -12,9 +12,11 @@
 // See the License for the specific language governing permissions and
 // limitations under the License.
 
+#include <memory>
 #include <string>
 
 #include "gmock/gmock.h"
+#include "source/opt/build_module.h"
 #include "source/opt/simplification_pass.h"
 #include "test/opt/assembly_builder.h"
 #include "test/opt/pass_fixture.h"
@@ -360,6 +362,92 @@ OpFunctionEnd
   SinglePassRunAndMatch<SimplificationPass>(spirv, true);
 }
 
+TEST(IncrementalSimplificationTest, OnlyChangedInstructionsAreSimplified) {
+  const std::string text = R"(
+               OpCapability Shader
+               OpMemoryModel Logical GLSL450
+               OpEntryPoint Fragment %1 "main" %2 %3
+               OpExecutionMode %1 OriginUpperLeft
+          %4 = OpTypeVoid
+          %5 = OpTypeFunction %4
+          %6 = OpTypeInt 32 1
+          %7 = OpConstant %6 0
+          %8 = OpConstant %6 1
+          %9 = OpConstant %6 2
+         %10 = OpTypePointer Input %6
+         %11 = OpTypePointer Output %6
+          %2 = OpVariable %10 Input
+          %3 = OpVariable %11 Output
+          %1 = OpFunction %4 None %5
+         %12 = OpLabel
+         %14 = OpLoad %6 %2
+         %15 = OpIAdd %6 %14 %7
+         %16 = OpIMul %6 %14 %9
+               OpStore %3 %15
+               OpStore %3 %16
+               OpReturn
+               OpFunctionEnd
+)";
+
+  std::unique_ptr<IRContext> context =
+      BuildModule(SPV_ENV_UNIVERSAL_1_2, nullptr, text,
+                  SPV_TEXT_TO_BINARY_OPTION_PRESERVE_NUMERIC_IDS);
+  ASSERT_NE(nullptr, context);
+  analysis::DefUseManager* def_use_mgr = context->get_def_use_mgr();
+  EXPECT_FALSE(context->AreChangedInstructionsTracked());
+  context->StartTrackingChangedInstructions();
+  EXPECT_TRUE(context->AreChangedInstructionsTracked());
+
+  // Turn %16 into a multiplication by 1.  Only %16 changed, so %15 is not
+  // simplified.
+  Instruction* mul = def_use_mgr->GetDef(16);
+  mul->SetInOperand(1, {8});
+  context->AnalyzeUses(mul);
+  EXPECT_EQ(1u, context->changed_instructions()->count(mul));
+
+  SimplificationPass incremental(/* incremental = */ true);
+  EXPECT_EQ(Pass::Status::SuccessWithChange, incremental.Run(context.get()));
+  EXPECT_EQ(nullptr, def_use_mgr->GetDef(16));
+  EXPECT_EQ(SpvOpIAdd, def_use_mgr->GetDef(15)->opcode());
+  EXPECT_TRUE(context->AreChangedInstructionsTracked());
+  EXPECT_TRUE(context->changed_instructions()->empty());
+
+  // Nothing changed since the last simplification.
+  EXPECT_EQ(Pass::Status::SuccessWithoutChange,
+            incremental.Run(context.get()));
+
+  // A pass that is not incremental simplifies everything.
+  SimplificationPass full;
+  EXPECT_EQ(Pass::Status::SuccessWithChange, full.Run(context.get()));
+  EXPECT_EQ(nullptr, def_use_mgr->GetDef(15));
+}
+
+TEST(IncrementalSimplificationTest, TrackingStopsWithDefUse) {
+  const std::string text = R"(
+               OpCapability Shader
+               OpCapability Linkage
+               OpMemoryModel Logical GLSL450
+       %void = OpTypeVoid
+          %3 = OpTypeFunction %void
+          %1 = OpFunction %void None %3
+          %4 = OpLabel
+               OpReturn
+               OpFunctionEnd
+)";
+
+  std::unique_ptr<IRContext> context =
+      BuildModule(SPV_ENV_UNIVERSAL_1_2, nullptr, text);
+  ASSERT_NE(nullptr, context);
+  SimplificationPass incremental(/* incremental = */ true);
+  incremental.Run(context.get());
+  EXPECT_TRUE(context->AreChangedInstructionsTracked());
+
+  context->InvalidateAnalyses(IRContext::kAnalysisDefUse);
+  EXPECT_FALSE(context->AreChangedInstructionsTracked());
+  context->get_def_use_mgr();
+  EXPECT_FALSE(context->AreChangedInstructionsTracked());
+}
+
 }  // namespace
 }  // namespace opt
 }  // namespace spvtools
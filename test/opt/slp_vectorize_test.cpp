@@ -0,0 +1,130 @@
+// Copyright (c) 2019 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <string>
+
+#include "test/opt/pass_fixture.h"
+#include "test/opt/pass_utils.h"
+
+namespace spvtools {
+namespace opt {
+namespace {
+
+using SLPVectorizeTest = PassTest<::testing::Test>;
+
+const std::string kHeader = R"(
+OpCapability Shader
+OpCapability Linkage
+OpMemoryModel Logical GLSL450
+OpName %f "f"
+OpName %a "a"
+OpName %b "b"
+OpName %x "x"
+OpDecorate %f LinkageAttributes "f" Export
+%float = OpTypeFloat 32
+%float_1 = OpConstant %float 1
+%float_2 = OpConstant %float 2
+%v2float = OpTypeVector %float 2
+%v4float = OpTypeVector %float 4
+%f_fn = OpTypeFunction %v4float %v4float %v4float %float
+%f = OpFunction %v4float None %f_fn
+%a = OpFunctionParameter %v4float
+%b = OpFunctionParameter %v4float
+%x = OpFunctionParameter %float
+%entry = OpLabel
+)";
+
+TEST_F(SLPVectorizeTest, VectorizesScalarizedAdd) {
+  const std::string text = R"(
+; CHECK: %entry = OpLabel
+; CHECK-NEXT: [[add:%\w+]] = OpFAdd %v4float %a %b
+; CHECK-NEXT: OpReturnValue [[add]]
+)" + kHeader + R"(
+%a0 = OpCompositeExtract %float %a 0
+%a1 = OpCompositeExtract %float %a 1
+%a2 = OpCompositeExtract %float %a 2
+%a3 = OpCompositeExtract %float %a 3
+%b0 = OpCompositeExtract %float %b 0
+%b1 = OpCompositeExtract %float %b 1
+%b2 = OpCompositeExtract %float %b 2
+%b3 = OpCompositeExtract %float %b 3
+%s0 = OpFAdd %float %a0 %b0
+%s1 = OpFAdd %float %a1 %b1
+%s2 = OpFAdd %float %a2 %b2
+%s3 = OpFAdd %float %a3 %b3
+%v = OpCompositeConstruct %v4float %s0 %s1 %s2 %s3
+OpReturnValue %v
+OpFunctionEnd
+)";
+
+  SinglePassRunAndMatch<SLPVectorizePass>(text, true);
+}
+
+TEST_F(SLPVectorizeTest, VectorizesTreeWithShuffleAndConstants) {
+  const std::string text = R"(
+; CHECK: %entry = OpLabel
+; CHECK-NEXT: [[shuffle:%\w+]] = OpVectorShuffle %v4float %b %b 1 0 3 2
+; CHECK-NEXT: [[mul:%\w+]] = OpFMul %v4float %a [[shuffle]]
+; CHECK-NEXT: [[add:%\w+]] = OpFAdd %v4float [[mul]] {{%\w+}}
+; CHECK-NEXT: OpReturnValue [[add]]
+)" + kHeader + R"(
+%a0 = OpCompositeExtract %float %a 0
+%a1 = OpCompositeExtract %float %a 1
+%a2 = OpCompositeExtract %float %a 2
+%a3 = OpCompositeExtract %float %a 3
+%b0 = OpCompositeExtract %float %b 0
+%b1 = OpCompositeExtract %float %b 1
+%b2 = OpCompositeExtract %float %b 2
+%b3 = OpCompositeExtract %float %b 3
+%m0 = OpFMul %float %a0 %b1
+%m1 = OpFMul %float %a1 %b0
+%m2 = OpFMul %float %a2 %b3
+%m3 = OpFMul %float %a3 %b2
+%s0 = OpFAdd %float %m0 %float_1
+%s1 = OpFAdd %float %m1 %float_2
+%s2 = OpFAdd %float %m2 %float_1
+%s3 = OpFAdd %float %m3 %float_2
+%v = OpCompositeConstruct %v4float %s0 %s1 %s2 %s3
+OpReturnValue %v
+OpFunctionEnd
+)";
+
+  SinglePassRunAndMatch<SLPVectorizePass>(text, true);
+}
+
+TEST_F(SLPVectorizeTest, KeepsUnprofitableTree) {
+  // Vectorizing would need to gather the operands, and the scalar additions
+  // are still used.
+  const std::string text = R"(
+; CHECK: OpFAdd %float
+; CHECK: OpFAdd %float
+; CHECK-NOT: OpFAdd %v2float
+; CHECK: OpCompositeConstruct %v2float
+)" + kHeader + R"(
+%a0 = OpCompositeExtract %float %a 0
+%b2 = OpCompositeExtract %float %b 2
+%s0 = OpFAdd %float %a0 %x
+%s1 = OpFAdd %float %b2 %x
+%v = OpCompositeConstruct %v2float %s0 %s1
+%w = OpCompositeConstruct %v4float %v %s0 %s1
+OpReturnValue %w
+OpFunctionEnd
+)";
+
+  SinglePassRunAndMatch<SLPVectorizePass>(text, true);
+}
+
+}  // namespace
+}  // namespace opt
+}  // namespace spvtools
@@ -433,6 +433,268 @@ TEST_F(StrengthReductionBasicTest, BasicTestMultipleReplacements) {
       /* skip_nop = */ true, /* do_validate = */ true);
 }
 
+// Test that the unsigned division and modulo by a power of 2 become a shift
+// and a mask.
+TEST_F(StrengthReductionBasicTest, ReplaceUDivAndUModByPowerOf2) {
+  const std::string text = R"(
+; CHECK-DAG: [[uint:%\w+]] = OpTypeInt 32 0
+; CHECK-DAG: [[uint_3:%\w+]] = OpConstant [[uint]] 3
+; CHECK-DAG: [[uint_7:%\w+]] = OpConstant [[uint]] 7
+; CHECK: [[x:%\w+]] = OpLoad [[uint]]
+; CHECK-NEXT: [[div:%\w+]] = OpShiftRightLogical [[uint]] [[x]] [[uint_3]]
+; CHECK-NEXT: [[mod:%\w+]] = OpBitwiseAnd [[uint]] [[x]] [[uint_7]]
+; CHECK-NEXT: OpIAdd [[uint]] [[div]] [[mod]]
+; CHECK-NOT: OpUDiv
+; CHECK-NOT: OpUMod
+               OpCapability Shader
+               OpMemoryModel Logical GLSL450
+               OpEntryPoint GLCompute %main "main"
+               OpExecutionMode %main LocalSize 1 1 1
+       %void = OpTypeVoid
+          %3 = OpTypeFunction %void
+       %uint = OpTypeInt 32 0
+%_ptr_Function_uint = OpTypePointer Function %uint
+     %uint_8 = OpConstant %uint 8
+       %main = OpFunction %void None %3
+          %5 = OpLabel
+        %var = OpVariable %_ptr_Function_uint Function
+          %x = OpLoad %uint %var
+        %div = OpUDiv %uint %x %uint_8
+        %mod = OpUMod %uint %x %uint_8
+        %sum = OpIAdd %uint %div %mod
+               OpStore %var %sum
+               OpReturn
+               OpFunctionEnd
+)";
+
+  SinglePassRunAndMatch<StrengthReductionPass>(text, true);
+}
+
+// Test that the unsigned division by 3 becomes a multiplication by a magic
+// number and a shift.
+TEST_F(StrengthReductionBasicTest, ReplaceUDivByMagicNumber) {
+  const std::string text = R"(
+; CHECK-DAG: [[uint:%\w+]] = OpTypeInt 32 0
+; CHECK-DAG: [[uint_1:%\w+]] = OpConstant [[uint]] 1
+; CHECK-DAG: [[magic:%\w+]] = OpConstant [[uint]] 2863311531
+; CHECK-DAG: [[struct:%\w+]] = OpTypeStruct [[uint]] [[uint]]
+; CHECK: [[x:%\w+]] = OpLoad [[uint]]
+; CHECK-NEXT: [[mul:%\w+]] = OpUMulExtended [[struct]] [[x]] [[magic]]
+; CHECK-NEXT: [[hi:%\w+]] = OpCompositeExtract [[uint]] [[mul]] 1
+; CHECK-NEXT: [[div:%\w+]] = OpShiftRightLogical [[uint]] [[hi]] [[uint_1]]
+; CHECK-NEXT: OpStore {{%\w+}} [[div]]
+               OpCapability Shader
+               OpMemoryModel Logical GLSL450
+               OpEntryPoint GLCompute %main "main"
+               OpExecutionMode %main LocalSize 1 1 1
+       %void = OpTypeVoid
+          %3 = OpTypeFunction %void
+       %uint = OpTypeInt 32 0
+%_ptr_Function_uint = OpTypePointer Function %uint
+     %uint_3 = OpConstant %uint 3
+       %main = OpFunction %void None %3
+          %5 = OpLabel
+        %var = OpVariable %_ptr_Function_uint Function
+          %x = OpLoad %uint %var
+        %div = OpUDiv %uint %x %uint_3
+               OpStore %var %div
+               OpReturn
+               OpFunctionEnd
+)";
+
+  SinglePassRunAndMatch<StrengthReductionPass>(text, true);
+}
+
+// Test that the unsigned modulo by 7, whose magic number needs 33 bits, is
+// computed from the quotient.
+TEST_F(StrengthReductionBasicTest, ReplaceUModByMagicNumberWithAdd) {
+  const std::string text = R"(
+; CHECK-DAG: [[uint:%\w+]] = OpTypeInt 32 0
+; CHECK-DAG: [[uint_7:%\w+]] = OpConstant [[uint]] 7
+; CHECK-DAG: [[uint_1:%\w+]] = OpConstant [[uint]] 1
+; CHECK-DAG: [[uint_2:%\w+]] = OpConstant [[uint]] 2
+; CHECK-DAG: [[magic:%\w+]] = OpConstant [[uint]] 613566757
+; CHECK-DAG: [[struct:%\w+]] = OpTypeStruct [[uint]] [[uint]]
+; CHECK: [[x:%\w+]] = OpLoad [[uint]]
+; CHECK-NEXT: [[mul:%\w+]] = OpUMulExtended [[struct]] [[x]] [[magic]]
+; CHECK-NEXT: [[hi:%\w+]] = OpCompositeExtract [[uint]] [[mul]] 1
+; CHECK-NEXT: [[diff:%\w+]] = OpISub [[uint]] [[x]] [[hi]]
+; CHECK-NEXT: [[half:%\w+]] = OpShiftRightLogical [[uint]] [[diff]] [[uint_1]]
+; CHECK-NEXT: [[sum:%\w+]] = OpIAdd [[uint]] [[hi]] [[half]]
+; CHECK-NEXT: [[div:%\w+]] = OpShiftRightLogical [[uint]] [[sum]] [[uint_2]]
+; CHECK-NEXT: [[prod:%\w+]] = OpIMul [[uint]] [[div]] [[uint_7]]
+; CHECK-NEXT: [[mod:%\w+]] = OpISub [[uint]] [[x]] [[prod]]
+; CHECK-NEXT: OpStore {{%\w+}} [[mod]]
+               OpCapability Shader
+               OpMemoryModel Logical GLSL450
+               OpEntryPoint GLCompute %main "main"
+               OpExecutionMode %main LocalSize 1 1 1
+       %void = OpTypeVoid
+          %3 = OpTypeFunction %void
+       %uint = OpTypeInt 32 0
+%_ptr_Function_uint = OpTypePointer Function %uint
+     %uint_7 = OpConstant %uint 7
+       %main = OpFunction %void None %3
+          %5 = OpLabel
+        %var = OpVariable %_ptr_Function_uint Function
+          %x = OpLoad %uint %var
+        %mod = OpUMod %uint %x %uint_7
+               OpStore %var %mod
+               OpReturn
+               OpFunctionEnd
+)";
+
+  SinglePassRunAndMatch<StrengthReductionPass>(text, true);
+}
+
+// Test that the signed division by 7 and the signed remainder by 4 are
+// rounded toward 0.
+TEST_F(StrengthReductionBasicTest, ReplaceSDivAndSRem) {
+  const std::string text = R"(
+; CHECK-DAG: [[int:%\w+]] = OpTypeInt 32 1
+; CHECK-DAG: [[int_4:%\w+]] = OpConstant [[int]] 4
+; CHECK-DAG: [[uint:%\w+]] = OpTypeInt 32 0
+; CHECK-DAG: [[uint_2:%\w+]] = OpConstant [[uint]] 2
+; CHECK-DAG: [[uint_30:%\w+]] = OpConstant [[uint]] 30
+; CHECK-DAG: [[uint_31:%\w+]] = OpConstant [[uint]] 31
+; CHECK-DAG: [[magic:%\w+]] = OpConstant [[int]] -1840700269
+; CHECK-DAG: [[struct:%\w+]] = OpTypeStruct [[int]] [[int]]
+; CHECK: [[x:%\w+]] = OpLoad [[int]]
+; CHECK-NEXT: [[mul:%\w+]] = OpSMulExtended [[struct]] [[x]] [[magic]]
+; CHECK-NEXT: [[hi:%\w+]] = OpCompositeExtract [[int]] [[mul]] 1
+; CHECK-NEXT: [[fix:%\w+]] = OpIAdd [[int]] [[hi]] [[x]]
+; CHECK-NEXT: [[shr:%\w+]] = OpShiftRightArithmetic [[int]] [[fix]] [[uint_2]]
+; CHECK-NEXT: [[neg:%\w+]] = OpShiftRightLogical [[int]] [[shr]] [[uint_31]]
+; CHECK-NEXT: [[div:%\w+]] = OpIAdd [[int]] [[shr]] [[neg]]
+; CHECK-NEXT: [[sign:%\w+]] = OpShiftRightArithmetic [[int]] [[x]] [[uint_31]]
+; CHECK-NEXT: [[bias:%\w+]] = OpShiftRightLogical [[int]] [[sign]] [[uint_30]]
+; CHECK-NEXT: [[biased:%\w+]] = OpIAdd [[int]] [[x]] [[bias]]
+; CHECK-NEXT: [[q:%\w+]] = OpShiftRightArithmetic [[int]] [[biased]] [[uint_2]]
+; CHECK-NEXT: [[prod:%\w+]] = OpIMul [[int]] [[q]] [[int_4]]
+; CHECK-NEXT: [[rem:%\w+]] = OpISub [[int]] [[x]] [[prod]]
+; CHECK-NEXT: OpIAdd [[int]] [[div]] [[rem]]
+; CHECK-NOT: OpSDiv
+; CHECK-NOT: OpSRem
+               OpCapability Shader
+               OpMemoryModel Logical GLSL450
+               OpEntryPoint GLCompute %main "main"
+               OpExecutionMode %main LocalSize 1 1 1
+       %void = OpTypeVoid
+          %3 = OpTypeFunction %void
+        %int = OpTypeInt 32 1
+%_ptr_Function_int = OpTypePointer Function %int
+      %int_4 = OpConstant %int 4
+      %int_7 = OpConstant %int 7
+       %main = OpFunction %void None %3
+          %5 = OpLabel
+        %var = OpVariable %_ptr_Function_int Function
+          %x = OpLoad %int %var
+        %div = OpSDiv %int %x %int_7
+        %rem = OpSRem %int %x %int_4
+        %sum = OpIAdd %int %div %rem
+               OpStore %var %sum
+               OpReturn
+               OpFunctionEnd
+)";
+
+  SinglePassRunAndMatch<StrengthReductionPass>(text, true);
+}
+
+// Test that, where the shader rules for floating point folding do not apply,
+// a float division by a constant becomes a multiplication by its reciprocal
+// only if the reciprocal is exact or the fast-math flags allow it.
+TEST_F(StrengthReductionBasicTest, ReplaceFDivByReciprocal) {
+  const std::string text = R"(
+; CHECK-DAG: [[float:%\w+]] = OpTypeFloat 32
+; CHECK-DAG: [[quarter:%\w+]] = OpConstant [[float]] 0.25
+; CHECK-DAG: [[third:%\w+]] = OpConstant [[float]] 0.333333
+; CHECK: [[x:%\w+]] = OpLoad [[float]]
+; CHECK-NEXT: OpFMul [[float]] [[x]] [[quarter]]
+; CHECK-NEXT: OpFDiv [[float]] [[x]] %float_3
+; CHECK-NEXT: OpFMul [[float]] [[x]] [[third]]
+               OpCapability Shader
+               OpCapability DenormPreserve
+               OpExtension "SPV_KHR_float_controls"
+               OpMemoryModel Logical GLSL450
+               OpEntryPoint GLCompute %main "main"
+               OpExecutionMode %main LocalSize 1 1 1
+               OpDecorate %fast FPFastMathMode AllowRecip
+       %void = OpTypeVoid
+          %3 = OpTypeFunction %void
+      %float = OpTypeFloat 32
+%_ptr_Function_float = OpTypePointer Function %float
+    %float_3 = OpConstant %float 3
+    %float_4 = OpConstant %float 4
+       %main = OpFunction %void None %3
+          %5 = OpLabel
+        %var = OpVariable %_ptr_Function_float Function
+          %x = OpLoad %float %var
+      %exact = OpFDiv %float %x %float_4
+    %inexact = OpFDiv %float %x %float_3
+       %fast = OpFDiv %float %x %float_3
+       %sum1 = OpFAdd %float %exact %inexact
+       %sum2 = OpFAdd %float %sum1 %fast
+               OpStore %var %sum2
+               OpReturn
+               OpFunctionEnd
+)";
+
+  SinglePassRunAndMatch<StrengthReductionPass>(text, false);
+}
+
+// Test that a multiplication of an induction variable by a constant becomes
+// a new induction variable.
+TEST_F(StrengthReductionBasicTest, ReplaceInductionMultiply) {
+  const std::string text = R"(
+; CHECK: [[header:%\w+]] = OpLabel
+; CHECK-NEXT: [[iv:%\w+]] = OpPhi %uint %uint_0 {{%\w+}} [[next:%\w+]] [[latch:%\w+]]
+; CHECK-NEXT: [[i:%\w+]] = OpPhi %uint %uint_0
+; CHECK-NEXT: OpLoopMerge {{%\w+}} [[latch]] None
+; CHECK-NOT: OpIMul
+; CHECK: OpStore {{%\w+}} [[iv]]
+; CHECK: [[latch]] = OpLabel
+; CHECK-NEXT: OpIAdd %uint [[i]] %uint_1
+; CHECK-NEXT: [[next]] = OpIAdd %uint [[iv]] %uint_3
+; CHECK-NEXT: OpBranch [[header]]
+               OpCapability Shader
+               OpMemoryModel Logical GLSL450
+               OpEntryPoint GLCompute %main "main"
+               OpExecutionMode %main LocalSize 1 1 1
+       %void = OpTypeVoid
+          %3 = OpTypeFunction %void
+       %bool = OpTypeBool
+       %uint = OpTypeInt 32 0
+%_ptr_Function_uint = OpTypePointer Function %uint
+     %uint_0 = OpConstant %uint 0
+     %uint_1 = OpConstant %uint 1
+     %uint_3 = OpConstant %uint 3
+    %uint_10 = OpConstant %uint 10
+       %main = OpFunction %void None %3
+          %5 = OpLabel
+        %var = OpVariable %_ptr_Function_uint Function
+               OpBranch %10
+         %10 = OpLabel
+          %i = OpPhi %uint %uint_0 %5 %inc %12
+               OpLoopMerge %11 %12 None
+               OpBranch %13
+         %13 = OpLabel
+       %cond = OpULessThan %bool %i %uint_10
+               OpBranchConditional %cond %14 %11
+         %14 = OpLabel
+        %mul = OpIMul %uint %i %uint_3
+               OpStore %var %mul
+               OpBranch %12
+         %12 = OpLabel
+        %inc = OpIAdd %uint %i %uint_1
+               OpBranch %10
+         %11 = OpLabel
+               OpReturn
+               OpFunctionEnd
+)";
+
+  SinglePassRunAndMatch<StrengthReductionPass>(text, true);
+}
+
 }  // namespace
 }  // namespace opt
 }  // namespace spvtools
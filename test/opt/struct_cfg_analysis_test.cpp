@@ -1369,6 +1369,57 @@ TEST_F(StructCFGAnalysisTest, FuncCallInContinueIndirect) {
   auto c = analysis.FindFuncsCalledFromContinue();
   EXPECT_THAT(c, UnorderedElementsAre(14u, 16u, 21u));
 }
+
+TEST_F(StructCFGAnalysisTest, QueriesOutsideTheAnalysis) {
+  const std::string text = R"(
+               OpCapability Shader
+               OpMemoryModel Logical GLSL450
+               OpEntryPoint Fragment %1 "main"
+       %void = OpTypeVoid
+       %bool = OpTypeBool
+          %4 = OpUndef %bool
+          %7 = OpTypeFunction %void
+          %1 = OpFunction %void None %7
+          %8 = OpLabel
+               OpBranch %9
+          %9 = OpLabel
+               OpLoopMerge %10 %11 None
+               OpBranchConditional %4 %10 %11
+         %11 = OpLabel
+         %13 = OpFunctionCall %void %14
+               OpBranch %9
+         %10 = OpLabel
+               OpReturn
+               OpFunctionEnd
+         %14 = OpFunction %void None %7
+         %17 = OpLabel
+               OpReturn
+               OpFunctionEnd
+)";
+
+  std::unique_ptr<IRContext> context =
+      BuildModule(SPV_ENV_UNIVERSAL_1_1, nullptr, text,
+                  SPV_TEXT_TO_BINARY_OPTION_PRESERVE_NUMERIC_IDS);
+
+  StructuredCFGAnalysis analysis(context.get());
+
+  // The ids past the bound, such as those of blocks added after the analysis,
+  // are not in any construct.
+  uint32_t new_id = context->module()->IdBound() + 10;
+  EXPECT_EQ(analysis.ContainingConstruct(new_id), 0);
+  EXPECT_EQ(analysis.ContainingLoop(new_id), 0);
+  EXPECT_EQ(analysis.MergeBlock(new_id), 0);
+  EXPECT_FALSE(analysis.IsInContinueConstruct(new_id));
+
+  EXPECT_EQ(analysis.LoopContinueBlock(11), 11);
+  EXPECT_EQ(analysis.LoopMergeBlock(11), 10);
+
+  // The set is the same when it is queried again.
+  EXPECT_THAT(analysis.FindFuncsCalledFromContinue(),
+              UnorderedElementsAre(14u));
+  EXPECT_THAT(analysis.FindFuncsCalledFromContinue(),
+              UnorderedElementsAre(14u));
+}
 }  // namespace
 }  // namespace opt
 }  // namespace spvtools
@@ -383,6 +383,36 @@ TEST(Types, RemoveDecorations) {
   }
 }
 
+TEST(Types, HashValue) {
+  std::vector<std::unique_ptr<Type>> types = GenerateAllTypesWithDecorations();
+  for (auto& t : types) {
+    auto clone = t->Clone();
+    EXPECT_EQ(t->HashValue(), clone->HashValue());
+    // The kept hash value is the one computed again.
+    EXPECT_EQ(t->HashValue(), t->HashValue());
+  }
+
+  // Equal types built from different element types hash the same.
+  Integer u32(32, false);
+  Integer other_u32(32, false);
+  Vector v4u32(&u32, 4);
+  Vector other_v4u32(&other_u32, 4);
+  Struct s({&v4u32, &u32});
+  Struct other_s({&other_v4u32, &other_u32});
+  EXPECT_EQ(s.HashValue(), other_s.HashValue());
+  EXPECT_FALSE(s.ContainsPointer());
+  Pointer p(&s, SpvStorageClassUniform);
+  Pointer other_p(&other_s, SpvStorageClassUniform);
+  EXPECT_TRUE(p.ContainsPointer());
+  EXPECT_EQ(p.HashValue(), other_p.HashValue());
+
+  // Decorating a type forgets its kept hash value.
+  size_t hash = s.HashValue();
+  s.AddMemberDecoration(0, {SpvDecorationOffset, 0});
+  EXPECT_NE(hash, s.HashValue());
+  EXPECT_EQ(s.HashValue(), s.Clone()->HashValue());
+}
+
 }  // namespace
 }  // namespace analysis
 }  // namespace opt
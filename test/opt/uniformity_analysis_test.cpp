@@ -0,0 +1,201 @@
+// Copyright (c) 2019 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "source/opt/uniformity_analysis.h"
+
+#include <string>
+
+#include "gmock/gmock.h"
+#include "test/opt/pass_fixture.h"
+#include "test/opt/pass_utils.h"
+
+namespace spvtools {
+namespace opt {
+namespace {
+
+using UniformityAnalysisTest = PassTest<::testing::Test>;
+
+// A compute shader with a divergent built-in (%2), a uniform built-in (%3)
+// and a push constant (%5).
+const std::string kHeader = R"(
+OpCapability Shader
+OpCapability GroupNonUniformArithmetic
+OpMemoryModel Logical GLSL450
+OpEntryPoint GLCompute %1 "main" %2 %3
+OpExecutionMode %1 LocalSize 64 1 1
+OpDecorate %2 BuiltIn LocalInvocationIndex
+OpDecorate %3 BuiltIn WorkgroupId
+OpMemberDecorate %4 0 Offset 0
+OpDecorate %4 Block
+%void = OpTypeVoid
+%fn = OpTypeFunction %void
+%bool = OpTypeBool
+%uint = OpTypeInt 32 0
+%v3uint = OpTypeVector %uint 3
+%uint_0 = OpConstant %uint 0
+%uint_1 = OpConstant %uint 1
+%uint_3 = OpConstant %uint 3
+%uint_32 = OpConstant %uint 32
+%_ptr_Input_uint = OpTypePointer Input %uint
+%_ptr_Input_v3uint = OpTypePointer Input %v3uint
+%_ptr_Function_uint = OpTypePointer Function %uint
+%2 = OpVariable %_ptr_Input_uint Input
+%3 = OpVariable %_ptr_Input_v3uint Input
+%4 = OpTypeStruct %uint
+%_ptr_PushConstant_4 = OpTypePointer PushConstant %4
+%_ptr_PushConstant_uint = OpTypePointer PushConstant %uint
+%5 = OpVariable %_ptr_PushConstant_4 PushConstant
+%1 = OpFunction %void None %fn
+)";
+
+TEST_F(UniformityAnalysisTest, SeedsFromBuiltInsAndPushConstants) {
+  const std::string text = kHeader + R"(
+%10 = OpLabel
+%11 = OpLoad %uint %2
+%12 = OpLoad %v3uint %3
+%13 = OpCompositeExtract %uint %12 0
+%14 = OpAccessChain %_ptr_PushConstant_uint %5 %uint_0
+%15 = OpLoad %uint %14
+%16 = OpIAdd %uint %13 %15
+%17 = OpIAdd %uint %16 %11
+OpReturn
+OpFunctionEnd
+)";
+
+  std::unique_ptr<IRContext> context =
+      BuildModule(SPV_ENV_UNIVERSAL_1_3, nullptr, text,
+                  SPV_TEXT_TO_BINARY_OPTION_PRESERVE_NUMERIC_IDS);
+  UniformityAnalysis* analysis = context->GetUniformityAnalysis();
+
+  EXPECT_FALSE(analysis->IsUniform(11));
+  EXPECT_TRUE(analysis->IsUniform(12));
+  EXPECT_TRUE(analysis->IsUniform(13));
+  EXPECT_TRUE(analysis->IsUniform(15));
+  EXPECT_TRUE(analysis->IsUniform(16));
+  EXPECT_FALSE(analysis->IsUniform(17));
+  EXPECT_TRUE(analysis->IsUniformBlock(10));
+}
+
+TEST_F(UniformityAnalysisTest, DivergentBranchJoinsDivergentValues) {
+  // The first branch is divergent, the second is uniform.
+  const std::string text = kHeader + R"(
+%10 = OpLabel
+%11 = OpLoad %uint %2
+%12 = OpULessThan %bool %11 %uint_32
+OpSelectionMerge %14 None
+OpBranchConditional %12 %13 %14
+%13 = OpLabel
+OpBranch %14
+%14 = OpLabel
+%15 = OpPhi %uint %uint_0 %10 %uint_1 %13
+%16 = OpLoad %v3uint %3
+%17 = OpCompositeExtract %uint %16 0
+%18 = OpULessThan %bool %17 %uint_32
+OpSelectionMerge %20 None
+OpBranchConditional %18 %19 %20
+%19 = OpLabel
+OpBranch %20
+%20 = OpLabel
+%21 = OpPhi %uint %uint_0 %14 %uint_1 %19
+OpReturn
+OpFunctionEnd
+)";
+
+  std::unique_ptr<IRContext> context =
+      BuildModule(SPV_ENV_UNIVERSAL_1_3, nullptr, text,
+                  SPV_TEXT_TO_BINARY_OPTION_PRESERVE_NUMERIC_IDS);
+  UniformityAnalysis* analysis = context->GetUniformityAnalysis();
+
+  EXPECT_FALSE(analysis->IsUniformBlock(13));
+  EXPECT_TRUE(analysis->IsUniformBlock(14));
+  EXPECT_FALSE(analysis->IsUniform(15));
+  EXPECT_TRUE(analysis->IsUniformBlock(19));
+  EXPECT_TRUE(analysis->IsUniform(21));
+}
+
+TEST_F(UniformityAnalysisTest, DivergentLoopExitMakesLiveOutsDivergent) {
+  // The invocations leave the loop in different iterations, but those still
+  // in it agree on the induction variable.
+  const std::string text = kHeader + R"(
+%10 = OpLabel
+%11 = OpLoad %uint %2
+OpBranch %12
+%12 = OpLabel
+%13 = OpPhi %uint %uint_0 %10 %17 %15
+OpLoopMerge %16 %15 None
+OpBranch %14
+%14 = OpLabel
+%18 = OpIEqual %bool %13 %11
+OpBranchConditional %18 %16 %15
+%15 = OpLabel
+%17 = OpIAdd %uint %13 %uint_1
+OpBranch %12
+%16 = OpLabel
+%19 = OpIAdd %uint %13 %uint_1
+OpReturn
+OpFunctionEnd
+)";
+
+  std::unique_ptr<IRContext> context =
+      BuildModule(SPV_ENV_UNIVERSAL_1_3, nullptr, text,
+                  SPV_TEXT_TO_BINARY_OPTION_PRESERVE_NUMERIC_IDS);
+  UniformityAnalysis* analysis = context->GetUniformityAnalysis();
+
+  EXPECT_TRUE(analysis->IsUniform(13));
+  EXPECT_TRUE(analysis->IsUniform(17));
+  EXPECT_FALSE(analysis->IsUniform(18));
+  EXPECT_FALSE(analysis->IsUniformBlock(15));
+  EXPECT_TRUE(analysis->IsUniformBlock(16));
+  EXPECT_FALSE(analysis->IsUniform(19));
+}
+
+TEST_F(UniformityAnalysisTest, TracksVariablesAndReductions) {
+  // %11 is stored from divergent control flow, %19 is not.  The reduction of
+  // a divergent value is uniform, its scan is not.
+  const std::string text = kHeader + R"(
+%10 = OpLabel
+%11 = OpVariable %_ptr_Function_uint Function
+%19 = OpVariable %_ptr_Function_uint Function
+%12 = OpLoad %uint %2
+%13 = OpULessThan %bool %12 %uint_32
+OpStore %11 %uint_0
+OpStore %19 %uint_1
+OpSelectionMerge %15 None
+OpBranchConditional %13 %14 %15
+%14 = OpLabel
+OpStore %11 %uint_1
+OpBranch %15
+%15 = OpLabel
+%16 = OpLoad %uint %11
+%17 = OpGroupNonUniformIAdd %uint %uint_3 Reduce %16
+%18 = OpGroupNonUniformIAdd %uint %uint_3 InclusiveScan %17
+%20 = OpLoad %uint %19
+OpReturn
+OpFunctionEnd
+)";
+
+  std::unique_ptr<IRContext> context =
+      BuildModule(SPV_ENV_UNIVERSAL_1_3, nullptr, text,
+                  SPV_TEXT_TO_BINARY_OPTION_PRESERVE_NUMERIC_IDS);
+  UniformityAnalysis* analysis = context->GetUniformityAnalysis();
+
+  EXPECT_FALSE(analysis->IsUniform(16));
+  EXPECT_TRUE(analysis->IsUniform(17));
+  EXPECT_FALSE(analysis->IsUniform(18));
+  EXPECT_TRUE(analysis->IsUniform(20));
+}
+
+}  // namespace
+}  // namespace opt
+}  // namespace spvtools
@@ -16,6 +16,7 @@
 
 #include "gmock/gmock.h"
 #include "source/opt/build_module.h"
+#include "source/opt/redundancy_elimination.h"
 #include "source/opt/value_number_table.h"
 #include "test/opt/assembly_builder.h"
 #include "test/opt/pass_fixture.h"
@@ -684,6 +685,82 @@ TEST_F(ValueTableTest, EmptyPhiTest) {
   vtable.GetValueNumber(inst);
 }
 
+TEST_F(ValueTableTest, KillInstKeepsTableValid) {
+  const std::string text = R"(
+               OpCapability Shader
+          %1 = OpExtInstImport "GLSL.std.450"
+               OpMemoryModel Logical GLSL450
+               OpEntryPoint Fragment %2 "main"
+               OpExecutionMode %2 OriginUpperLeft
+               OpSource GLSL 430
+          %3 = OpTypeVoid
+          %4 = OpTypeFunction %3
+          %5 = OpTypeFloat 32
+          %6 = OpTypePointer Function %5
+          %2 = OpFunction %3 None %4
+          %7 = OpLabel
+          %8 = OpVariable %6 Function
+          %9 = OpLoad %5 %8
+         %10 = OpFAdd %5 %9 %9
+         %11 = OpFAdd %5 %9 %9
+               OpReturn
+               OpFunctionEnd
+  )";
+  auto context = BuildModule(SPV_ENV_UNIVERSAL_1_2, nullptr, text);
+  ValueNumberTable* vtable = context->GetValueNumberTable();
+  uint32_t value = vtable->GetValueNumber(11);
+  EXPECT_EQ(vtable->GetValueNumber(10), value);
+
+  // Killing the first instruction computing the value keeps the table.
+  context->KillInst(context->get_def_use_mgr()->GetDef(10));
+  EXPECT_TRUE(
+      context->AreAnalysesValid(IRContext::kAnalysisValueNumberTable));
+  EXPECT_EQ(vtable, context->GetValueNumberTable());
+
+  // A new instruction computing the value gets the same value number.
+  Instruction* inst11 = context->get_def_use_mgr()->GetDef(11);
+  Instruction* inst12 = inst11->Clone(context.get());
+  inst12->SetResultId(context->TakeNextId());
+  inst12->InsertAfter(inst11);
+  context->AnalyzeDefUse(inst12);
+  EXPECT_EQ(value, vtable->AnalyzeInstruction(inst12));
+}
+
+TEST_F(ValueTableTest, RedundancyEliminationPreservesTable) {
+  const std::string text = R"(
+               OpCapability Shader
+          %1 = OpExtInstImport "GLSL.std.450"
+               OpMemoryModel Logical GLSL450
+               OpEntryPoint Fragment %2 "main"
+               OpExecutionMode %2 OriginUpperLeft
+               OpSource GLSL 430
+          %3 = OpTypeVoid
+          %4 = OpTypeFunction %3
+          %5 = OpTypeFloat 32
+          %6 = OpTypePointer Function %5
+          %2 = OpFunction %3 None %4
+          %7 = OpLabel
+          %8 = OpVariable %6 Function
+          %9 = OpLoad %5 %8
+         %10 = OpFAdd %5 %9 %9
+         %11 = OpFAdd %5 %9 %9
+         %12 = OpFMul %5 %11 %9
+               OpReturn
+               OpFunctionEnd
+  )";
+  auto context = BuildModule(SPV_ENV_UNIVERSAL_1_2, nullptr, text);
+  ValueNumberTable* vtable = context->GetValueNumberTable();
+  uint32_t value = vtable->GetValueNumber(12);
+
+  RedundancyEliminationPass pass;
+  EXPECT_EQ(Pass::Status::SuccessWithChange, pass.Run(context.get()));
+  EXPECT_EQ(nullptr, context->get_def_use_mgr()->GetDef(11));
+  EXPECT_TRUE(
+      context->AreAnalysesValid(IRContext::kAnalysisValueNumberTable));
+  EXPECT_EQ(vtable, context->GetValueNumberTable());
+  EXPECT_EQ(value, vtable->GetValueNumber(12));
+}
+
 }  // namespace
 }  // namespace opt
 }  // namespace spvtools
@@ -965,6 +965,73 @@ TEST(ParseAndEncodeNumber, Sample) {
   EXPECT_EQ(EncodeNumberStatus::kSuccess, rc);
 }
 
+// Returns the words encoding |text| as a number of |type|, or an empty vector
+// if it cannot be encoded.
+std::vector<uint32_t> Encode(const char* text, const NumberType& type) {
+  std::vector<uint32_t> words;
+  if (ParseAndEncodeNumber(
+          text, type, [&words](uint32_t word) { words.push_back(word); },
+          nullptr) != EncodeNumberStatus::kSuccess) {
+    return {};
+  }
+  return words;
+}
+
+TEST(ParseAndEncodeNumber, IntegerForms) {
+  const NumberType int32 = {32, SPV_NUMBER_SIGNED_INT};
+  const NumberType int64 = {64, SPV_NUMBER_SIGNED_INT};
+  const NumberType uint64 = {64, SPV_NUMBER_UNSIGNED_INT};
+
+  EXPECT_THAT(Encode("0", int32), Eq(std::vector<uint32_t>{0u}));
+  EXPECT_THAT(Encode("-0", int32), Eq(std::vector<uint32_t>{0u}));
+  EXPECT_THAT(Encode("+5", int32), Eq(std::vector<uint32_t>{5u}));
+  // Leading zeros are octal.
+  EXPECT_THAT(Encode("010", int32), Eq(std::vector<uint32_t>{8u}));
+  EXPECT_THAT(Encode("0x1F", int32), Eq(std::vector<uint32_t>{31u}));
+  EXPECT_THAT(Encode("-0x10", int32), Eq(std::vector<uint32_t>{0xfffffff0u}));
+  EXPECT_THAT(Encode("0x", int32), Eq(std::vector<uint32_t>{}));
+  EXPECT_THAT(Encode("12a", int32), Eq(std::vector<uint32_t>{}));
+
+  EXPECT_THAT(Encode("-9223372036854775808", int64),
+              Eq(std::vector<uint32_t>{0u, 0x80000000u}));
+  EXPECT_THAT(Encode("-9223372036854775809", int64),
+              Eq(std::vector<uint32_t>{}));
+  EXPECT_THAT(Encode("18446744073709551615", uint64),
+              Eq(std::vector<uint32_t>{0xffffffffu, 0xffffffffu}));
+  EXPECT_THAT(Encode("18446744073709551616", uint64),
+              Eq(std::vector<uint32_t>{}));
+}
+
+TEST(ParseAndEncodeNumber, FloatForms) {
+  const NumberType float32 = {32, SPV_NUMBER_FLOATING};
+  const NumberType float64 = {64, SPV_NUMBER_FLOATING};
+
+  // Decimal literals are rounded to nearest, whether their digits fit in the
+  // significand or not.
+  EXPECT_THAT(Encode("0.1", float32), Eq(std::vector<uint32_t>{0x3dcccccdu}));
+  EXPECT_THAT(Encode("1.5e-3", float32),
+              Eq(std::vector<uint32_t>{0x3ac49ba6u}));
+  EXPECT_THAT(Encode("123456789", float32),
+              Eq(std::vector<uint32_t>{0x4ceb79a3u}));
+  EXPECT_THAT(Encode("3.4028234e38", float32),
+              Eq(std::vector<uint32_t>{0x7f7fffffu}));
+  EXPECT_THAT(Encode("1e-45", float32), Eq(std::vector<uint32_t>{1u}));
+  EXPECT_THAT(Encode("0.1", float64),
+              Eq(std::vector<uint32_t>{0x9999999au, 0x3fb99999u}));
+  EXPECT_THAT(Encode("1e22", float64),
+              Eq(std::vector<uint32_t>{0x064dd592u, 0x4480f0cfu}));
+  EXPECT_THAT(Encode("-0.0", float64),
+              Eq(std::vector<uint32_t>{0u, 0x80000000u}));
+
+  // Hexadecimal floats and invalid literals.
+  EXPECT_THAT(Encode("0x1p+1", float32),
+              Eq(std::vector<uint32_t>{0x40000000u}));
+  EXPECT_THAT(Encode("-0x1.8p-1", float64),
+              Eq(std::vector<uint32_t>{0u, 0xbfe80000u}));
+  EXPECT_THAT(Encode("1e", float32), Eq(std::vector<uint32_t>{}));
+  EXPECT_THAT(Encode("1e39", float32), Eq(std::vector<uint32_t>{}));
+}
+
 }  // namespace
 }  // namespace utils
 }  // namespace spvtools
@@ -436,6 +436,178 @@ TEST(ReducerTest, ShaderReduceWhileDivReachable) {
   ASSERT_EQ(status, Reducer::ReductionResultStatus::kComplete);
 }
 
+TEST(ReducerTest, ShaderReduceOnSeveralThreads) {
+  std::vector<uint32_t> binary_in;
+  SpirvTools t(kEnv);
+  ASSERT_TRUE(
+      t.Assemble(kShaderWithLoopsDivAndMul, &binary_in, kReduceAssembleOption));
+
+  // The steps tested at the same time are considered in order, so the result
+  // is the same as on a single thread.
+  std::vector<uint32_t> binary_out[2];
+  const uint32_t num_threads[2] = {1, 4};
+  for (int i = 0; i < 2; ++i) {
+    Reducer reducer(kEnv);
+    reducer.SetInterestingnessFunction(InterestingWhileIMulReachable);
+    reducer.AddDefaultReductionPasses();
+    reducer.SetMessageConsumer(kMessageConsumer);
+
+    spvtools::ReducerOptions reducer_options;
+    reducer_options.set_step_limit(500);
+    reducer_options.set_fail_on_validation_error(true);
+    reducer_options.set_num_threads(num_threads[i]);
+    spvtools::ValidatorOptions validator_options;
+
+    std::vector<uint32_t> binary = binary_in;
+    Reducer::ReductionResultStatus status =
+        reducer.Run(std::move(binary), &binary_out[i], reducer_options,
+                    validator_options);
+    ASSERT_EQ(status, Reducer::ReductionResultStatus::kComplete);
+  }
+  EXPECT_EQ(binary_out[0], binary_out[1]);
+}
+
+TEST(ReducerTest, ShaderReduceWithInterestingnessCache) {
+  std::vector<uint32_t> binary_in;
+  SpirvTools t(kEnv);
+  ASSERT_TRUE(
+      t.Assemble(kShaderWithLoopsDivAndMul, &binary_in, kReduceAssembleOption));
+
+  // The second reduction finds the result of every step in the cache, and
+  // only tests the initial binary.
+  MemoryInterestingnessCache cache;
+  std::vector<uint32_t> binary_out[2];
+  uint32_t num_tests[2] = {0, 0};
+  for (int i = 0; i < 2; ++i) {
+    Reducer reducer(kEnv);
+    uint32_t* tests = &num_tests[i];
+    reducer.SetInterestingnessFunction(
+        [tests](const std::vector<uint32_t>& binary, uint32_t count) {
+          ++*tests;
+          return InterestingWhileIMulReachable(binary, count);
+        });
+    reducer.AddDefaultReductionPasses();
+    reducer.SetMessageConsumer(kMessageConsumer);
+    reducer.SetInterestingnessCache(&cache);
+
+    spvtools::ReducerOptions reducer_options;
+    reducer_options.set_step_limit(500);
+    reducer_options.set_fail_on_validation_error(true);
+    spvtools::ValidatorOptions validator_options;
+
+    std::vector<uint32_t> binary = binary_in;
+    Reducer::ReductionResultStatus status =
+        reducer.Run(std::move(binary), &binary_out[i], reducer_options,
+                    validator_options);
+    ASSERT_EQ(status, Reducer::ReductionResultStatus::kComplete);
+  }
+  EXPECT_EQ(binary_out[0], binary_out[1]);
+  EXPECT_GT(num_tests[0], 1u);
+  EXPECT_EQ(num_tests[1], 1u);
+}
+
+TEST(ReducerTest, ShaderReduceWithAdaptiveScheduling) {
+  std::vector<uint32_t> binary_in;
+  SpirvTools t(kEnv);
+  ASSERT_TRUE(
+      t.Assemble(kShaderWithLoopsDivAndMul, &binary_in, kReduceAssembleOption));
+
+  Reducer reducer(kEnv);
+  reducer.SetInterestingnessFunction(InterestingWhileIMulReachable);
+  reducer.AddDefaultReductionPasses();
+  reducer.SetMessageConsumer(kMessageConsumer);
+
+  spvtools::ReducerOptions reducer_options;
+  reducer_options.set_step_limit(500);
+  reducer_options.set_fail_on_validation_error(true);
+  reducer_options.set_adaptive_scheduling(true);
+  spvtools::ValidatorOptions validator_options;
+
+  std::vector<uint32_t> binary_out;
+  Reducer::ReductionResultStatus status = reducer.Run(
+      std::move(binary_in), &binary_out, reducer_options, validator_options);
+  ASSERT_EQ(status, Reducer::ReductionResultStatus::kComplete);
+  EXPECT_TRUE(InterestingWhileIMulReachable(binary_out, 0));
+}
+
+TEST(ReducerTest, ShaderReduceFunctionByFunction) {
+  std::vector<uint32_t> binary_in;
+  SpirvTools t(kEnv);
+  ASSERT_TRUE(
+      t.Assemble(kShaderWithLoopsDivAndMul, &binary_in, kReduceAssembleOption));
+
+  Reducer reducer(kEnv);
+  reducer.SetInterestingnessFunction(InterestingWhileIMulReachable);
+  reducer.AddDefaultReductionPasses();
+  reducer.SetMessageConsumer(kMessageConsumer);
+
+  spvtools::ReducerOptions reducer_options;
+  reducer_options.set_step_limit(500);
+  reducer_options.set_fail_on_validation_error(true);
+  reducer_options.set_function_by_function(true);
+  spvtools::ValidatorOptions validator_options;
+
+  std::vector<uint32_t> binary_out;
+  Reducer::ReductionResultStatus status = reducer.Run(
+      std::move(binary_in), &binary_out, reducer_options, validator_options);
+  ASSERT_EQ(status, Reducer::ReductionResultStatus::kComplete);
+  EXPECT_TRUE(InterestingWhileIMulReachable(binary_out, 0));
+}
+
+TEST(ReducerTest, ShaderReduceRecordsStatistics) {
+  std::vector<uint32_t> binary_in;
+  SpirvTools t(kEnv);
+  ASSERT_TRUE(
+      t.Assemble(kShaderWithLoopsDivAndMul, &binary_in, kReduceAssembleOption));
+  const size_t size_in = binary_in.size();
+
+  // The number of tests, except that of the initial state.
+  uint64_t num_tests = 0;
+  Reducer reducer(kEnv);
+  reducer.SetInterestingnessFunction(
+      [&num_tests](const std::vector<uint32_t>& binary, uint32_t count) {
+        if (count) ++num_tests;
+        return InterestingWhileIMulReachable(binary, count);
+      });
+  reducer.AddDefaultReductionPasses();
+  reducer.SetMessageConsumer(kMessageConsumer);
+  utils::StepStatistics statistics;
+  reducer.SetStatistics(&statistics);
+
+  spvtools::ReducerOptions reducer_options;
+  reducer_options.set_step_limit(500);
+  reducer_options.set_fail_on_validation_error(true);
+  spvtools::ValidatorOptions validator_options;
+
+  std::vector<uint32_t> binary_out;
+  Reducer::ReductionResultStatus status = reducer.Run(
+      std::move(binary_in), &binary_out, reducer_options, validator_options);
+  ASSERT_EQ(status, Reducer::ReductionResultStatus::kComplete);
+
+  ASSERT_FALSE(statistics.phases().empty());
+  EXPECT_EQ("Initial state", statistics.phases()[0].name);
+  EXPECT_EQ(1u, statistics.phases()[0].successes);
+  uint64_t attempts = 0;
+  uint64_t successes = 0;
+  int64_t bytes_removed = 0;
+  bool has_cleanup = false;
+  for (size_t i = 1; i < statistics.phases().size(); ++i) {
+    const auto& phase = statistics.phases()[i];
+    EXPECT_LE(phase.successes, phase.attempts);
+    attempts += phase.attempts;
+    successes += phase.successes;
+    bytes_removed += phase.bytes_removed;
+    has_cleanup |= phase.name.compare(0, 8, "Cleanup ") == 0;
+  }
+  // On a single thread without a cache, every step is tested once.
+  EXPECT_EQ(num_tests, attempts);
+  EXPECT_GT(successes, 0u);
+  EXPECT_EQ(static_cast<int64_t>((size_in - binary_out.size()) *
+                                 sizeof(uint32_t)),
+            bytes_removed);
+  EXPECT_TRUE(has_cleanup);
+}
+
 }  // namespace
 }  // namespace reduce
 }  // namespace spvtools
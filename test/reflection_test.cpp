@@ -0,0 +1,168 @@
+// Copyright (c) 2020 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <string>
+#include <vector>
+
+#include "gmock/gmock.h"
+#include "source/latest_version_spirv_header.h"
+#include "spirv-tools/libspirv.hpp"
+#include "spirv-tools/reflection.hpp"
+
+namespace spvtools {
+namespace {
+
+using ::testing::ElementsAre;
+
+std::vector<uint32_t> Assemble(const std::string& text) {
+  std::vector<uint32_t> binary;
+  SpirvTools tools(SPV_ENV_VULKAN_1_1);
+  EXPECT_TRUE(tools.Assemble(text, &binary)) << text;
+  return binary;
+}
+
+const std::string kShader = R"(
+               OpCapability Shader
+               OpMemoryModel Logical GLSL450
+               OpEntryPoint Fragment %main "main" %in %out %coord
+               OpExecutionMode %main OriginUpperLeft
+               OpDecorate %in Location 1
+               OpDecorate %in Component 2
+               OpDecorate %out Location 0
+               OpDecorate %coord BuiltIn FragCoord
+               OpDecorate %textures DescriptorSet 1
+               OpDecorate %textures Binding 2
+               OpDecorate %ubo DescriptorSet 0
+               OpDecorate %ubo Binding 0
+               OpDecorate %ssbo DescriptorSet 0
+               OpDecorate %ssbo Binding 1
+               OpDecorate %UBO Block
+               OpMemberDecorate %UBO 0 Offset 0
+               OpDecorate %SSBO BufferBlock
+               OpMemberDecorate %SSBO 0 Offset 0
+               OpDecorate %runtime ArrayStride 4
+               OpDecorate %PC Block
+               OpMemberDecorate %PC 0 Offset 0
+               OpMemberDecorate %PC 0 ColMajor
+               OpMemberDecorate %PC 0 MatrixStride 16
+               OpMemberDecorate %PC 1 Offset 64
+               OpDecorate %scale SpecId 7
+       %void = OpTypeVoid
+          %3 = OpTypeFunction %void
+      %float = OpTypeFloat 32
+       %uint = OpTypeInt 32 0
+     %uint_4 = OpConstant %uint 4
+    %v4float = OpTypeVector %float 4
+%mat4v4float = OpTypeMatrix %v4float 4
+      %scale = OpSpecConstant %float 1.5
+      %image = OpTypeImage %float 2D 0 0 0 1 Unknown
+    %sampled = OpTypeSampledImage %image
+%sampled_arr = OpTypeArray %sampled %uint_4
+%ptr_sampled = OpTypePointer UniformConstant %sampled_arr
+   %textures = OpVariable %ptr_sampled UniformConstant
+        %UBO = OpTypeStruct %v4float
+    %ptr_UBO = OpTypePointer Uniform %UBO
+        %ubo = OpVariable %ptr_UBO Uniform
+    %runtime = OpTypeRuntimeArray %uint
+       %SSBO = OpTypeStruct %runtime
+   %ptr_SSBO = OpTypePointer Uniform %SSBO
+       %ssbo = OpVariable %ptr_SSBO Uniform
+         %PC = OpTypeStruct %mat4v4float %v4float
+     %ptr_PC = OpTypePointer PushConstant %PC
+         %pc = OpVariable %ptr_PC PushConstant
+  %ptr_in_v4 = OpTypePointer Input %v4float
+ %ptr_out_v4 = OpTypePointer Output %v4float
+         %in = OpVariable %ptr_in_v4 Input
+      %coord = OpVariable %ptr_in_v4 Input
+        %out = OpVariable %ptr_out_v4 Output
+       %main = OpFunction %void None %3
+          %5 = OpLabel
+               OpReturn
+               OpFunctionEnd
+)";
+
+TEST(ReflectionTest, EntryPointsAndInterface) {
+  const std::vector<uint32_t> binary = Assemble(kShader);
+  Context context(SPV_ENV_VULKAN_1_1);
+  ModuleReflection reflection;
+  ASSERT_EQ(SPV_SUCCESS,
+            Reflect(context, binary.data(), binary.size(), &reflection));
+
+  ASSERT_EQ(1u, reflection.entry_points.size());
+  const ReflectedEntryPoint& entry_point = reflection.entry_points[0];
+  EXPECT_EQ(uint32_t(SpvExecutionModelFragment), entry_point.execution_model);
+  EXPECT_EQ("main", entry_point.name);
+  EXPECT_EQ(3u, entry_point.interface_ids.size());
+
+  const uint32_t kNone = ReflectedInterfaceVariable::kNone;
+  ASSERT_EQ(3u, reflection.interface_variables.size());
+  const ReflectedInterfaceVariable& in = reflection.interface_variables[0];
+  EXPECT_EQ(uint32_t(SpvStorageClassInput), in.storage_class);
+  EXPECT_EQ(1u, in.location);
+  EXPECT_EQ(2u, in.component);
+  EXPECT_EQ(kNone, in.built_in);
+  const ReflectedInterfaceVariable& coord = reflection.interface_variables[1];
+  EXPECT_EQ(kNone, coord.location);
+  EXPECT_EQ(uint32_t(SpvBuiltInFragCoord), coord.built_in);
+  const ReflectedInterfaceVariable& out = reflection.interface_variables[2];
+  EXPECT_EQ(uint32_t(SpvStorageClassOutput), out.storage_class);
+  EXPECT_EQ(0u, out.location);
+}
+
+TEST(ReflectionTest, DescriptorsAndPushConstants) {
+  const std::vector<uint32_t> binary = Assemble(kShader);
+  Context context(SPV_ENV_VULKAN_1_1);
+  ModuleReflection reflection;
+  ASSERT_EQ(SPV_SUCCESS,
+            Reflect(context, binary.data(), binary.size(), &reflection));
+
+  ASSERT_EQ(3u, reflection.descriptors.size());
+  const ReflectedDescriptor& textures = reflection.descriptors[0];
+  EXPECT_EQ(1u, textures.set);
+  EXPECT_EQ(2u, textures.binding);
+  EXPECT_EQ(4u, textures.count);
+  EXPECT_EQ(DescriptorKind::kCombinedImageSampler, textures.kind);
+  const ReflectedDescriptor& ubo = reflection.descriptors[1];
+  EXPECT_EQ(0u, ubo.binding);
+  EXPECT_EQ(1u, ubo.count);
+  EXPECT_EQ(DescriptorKind::kUniformBuffer, ubo.kind);
+  const ReflectedDescriptor& ssbo = reflection.descriptors[2];
+  EXPECT_EQ(1u, ssbo.binding);
+  EXPECT_EQ(DescriptorKind::kStorageBuffer, ssbo.kind);
+
+  ASSERT_EQ(1u, reflection.push_constants.size());
+  const ReflectedPushConstant& push_constant = reflection.push_constants[0];
+  EXPECT_EQ(80u, push_constant.size);
+  ASSERT_EQ(2u, push_constant.members.size());
+  EXPECT_EQ(0u, push_constant.members[0].offset);
+  EXPECT_EQ(64u, push_constant.members[0].size);
+  EXPECT_EQ(64u, push_constant.members[1].offset);
+  EXPECT_EQ(16u, push_constant.members[1].size);
+
+  ASSERT_EQ(1u, reflection.spec_constants.size());
+  const ReflectedSpecConstant& scale = reflection.spec_constants[0];
+  EXPECT_EQ(7u, scale.spec_id);
+  EXPECT_THAT(scale.default_value, ElementsAre(0x3fc00000u));
+}
+
+TEST(ReflectionTest, InvalidHeaderIsAnError) {
+  const std::vector<uint32_t> binary = {0x12345678u, 0u, 0u, 1u, 0u};
+  Context context(SPV_ENV_VULKAN_1_1);
+  ModuleReflection reflection;
+  EXPECT_NE(SPV_SUCCESS,
+            Reflect(context, binary.data(), binary.size(), &reflection));
+}
+
+}  // namespace
+}  // namespace spvtools
@@ -50,6 +50,21 @@ TEST(ToString, Double) {
   EXPECT_EQ("-1.5", ToString(-1.5));
 }
 
+TEST(AppendDecimal, MatchesToString) {
+  for (uint64_t value : {uint64_t(0), uint64_t(7), uint64_t(10),
+                         uint64_t(4294967295u), ~uint64_t(0)}) {
+    std::string str = "x";
+    AppendUnsigned(value, &str);
+    EXPECT_EQ("x" + ToString(value), str);
+  }
+  for (int64_t value : {int64_t(0), int64_t(-1), int64_t(-2147483647 - 1),
+                        int64_t(-9223372036854775807 - 1)}) {
+    std::string str;
+    AppendSigned(value, &str);
+    EXPECT_EQ(ToString(value), str);
+  }
+}
+
 TEST(CardinalToOrdinal, Test) {
   EXPECT_EQ("1st", CardinalToOrdinal(1));
   EXPECT_EQ("2nd", CardinalToOrdinal(2));
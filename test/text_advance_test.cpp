@@ -66,6 +66,16 @@ TEST(TextAdvance, LeadingWhitespaceAfterCommentLine) {
   ASSERT_EQ(14u, data.position().index);
 }
 
+TEST(TextAdvance, LongCommentLines) {
+  const std::string comment = "; " + std::string(37, 'c') + "\n";
+  AutoText input(comment + comment + "  Word");
+  AssemblyContext data(input, nullptr);
+  ASSERT_EQ(SPV_SUCCESS, data.advance());
+  ASSERT_EQ(2u, data.position().column);
+  ASSERT_EQ(2u, data.position().line);
+  ASSERT_EQ(2 * comment.size() + 2, data.position().index);
+}
+
 TEST(TextAdvance, EOFAfterCommentLine) {
   AutoText input("; comment");
   AssemblyContext data(input, nullptr);
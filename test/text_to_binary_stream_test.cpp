@@ -0,0 +1,166 @@
+// Copyright (c) 2019 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <algorithm>
+#include <string>
+#include <vector>
+
+#include "gmock/gmock.h"
+#include "source/spirv_constant.h"
+#include "test/test_fixture.h"
+#include "test/unit_spirv.h"
+
+namespace spvtools {
+namespace {
+
+using spvtest::ScopedContext;
+using ::testing::Eq;
+
+// Supplies text to spvTextToBinaryStream in pieces of at most |piece_size|
+// bytes, and collects the binary it writes.
+struct Stream {
+  std::string text;
+  size_t piece_size;
+  size_t read_position = 0;
+  std::vector<uint32_t> binary;
+  // The offsets passed to each write, in order.
+  std::vector<size_t> write_offsets;
+  // The result to return from a write at write_offsets.size() == fail_at.
+  size_t fail_at = ~size_t(0);
+};
+
+size_t ReadText(void* user_data, char* buffer, size_t size) {
+  auto* stream = static_cast<Stream*>(user_data);
+  const size_t count =
+      std::min(std::min(size, stream->piece_size),
+               stream->text.size() - stream->read_position);
+  stream->text.copy(buffer, count, stream->read_position);
+  stream->read_position += count;
+  return count;
+}
+
+spv_result_t WriteBinary(void* user_data, size_t offset, const uint32_t* words,
+                         size_t num_words) {
+  auto* stream = static_cast<Stream*>(user_data);
+  if (stream->write_offsets.size() == stream->fail_at) {
+    return SPV_ERROR_INTERNAL;
+  }
+  stream->write_offsets.push_back(offset);
+  if (stream->binary.size() < offset + num_words) {
+    stream->binary.resize(offset + num_words);
+  }
+  std::copy(words, words + num_words, stream->binary.begin() + offset);
+  return SPV_SUCCESS;
+}
+
+// The parameter is the largest number of bytes supplied by each read.
+class TextToBinaryStreamTest : public ::testing::TestWithParam<size_t> {
+ protected:
+  TextToBinaryStreamTest() : diagnostic_(nullptr) {}
+  ~TextToBinaryStreamTest() override { spvDiagnosticDestroy(diagnostic_); }
+
+  // Assembles |text| with spvTextToBinaryStream into stream_.
+  spv_result_t AssembleStream(const std::string& text,
+                              uint32_t options = 0) {
+    stream_.text = text;
+    stream_.piece_size = GetParam();
+    return spvTextToBinaryStream(context_.context, &stream_, ReadText,
+                                 WriteBinary, options, &diagnostic_);
+  }
+
+  ScopedContext context_;
+  Stream stream_;
+  spv_diagnostic diagnostic_;
+};
+
+// Exercises comments, strings containing instruction-like text, instructions
+// spanning lines, and instructions starting with !<integer>.
+const char kModule[] =
+    "; A comment with OpNop in it\n"
+    "OpCapability Shader\n"
+    "!0x00020011 !1\n"
+    "OpMemoryModel Logical\n"
+    "  GLSL450\n"
+    "OpSource GLSL 450 %file \"a ; source \\\" %x = OpNop string\"\n"
+    "OpName %main \"main\" ; trailing comment %y = OpUndef\n"
+    "%file = OpString \"a.comp\"\r\n"
+    "%void = OpTypeVoid\n"
+    "%fn = OpTypeFunction %void\n"
+    "%float = OpTypeFloat 32\n"
+    "%one = OpConstant %float 1.5\n"
+    "%main = OpFunction %void None %fn\n"
+    "%entry = OpLabel\n"
+    "OpReturn\n"
+    "OpFunctionEnd";
+
+TEST_P(TextToBinaryStreamTest, MatchesTextToBinary) {
+  spv_binary expected = nullptr;
+  ASSERT_EQ(SPV_SUCCESS,
+            spvTextToBinary(context_.context, kModule, sizeof(kModule) - 1,
+                            &expected, nullptr));
+  ASSERT_EQ(SPV_SUCCESS, AssembleStream(kModule));
+  EXPECT_THAT(stream_.binary,
+              Eq(std::vector<uint32_t>(expected->code,
+                                       expected->code + expected->wordCount)));
+  spvBinaryDestroy(expected);
+}
+
+TEST_P(TextToBinaryStreamTest, RewritesHeaderAtEnd) {
+  ASSERT_EQ(SPV_SUCCESS, AssembleStream(kModule));
+  ASSERT_LE(2u, stream_.write_offsets.size());
+  EXPECT_EQ(0u, stream_.write_offsets.front());
+  EXPECT_EQ(0u, stream_.write_offsets.back());
+  EXPECT_TRUE(std::is_sorted(stream_.write_offsets.begin(),
+                             stream_.write_offsets.end() - 1));
+  EXPECT_EQ(8u, stream_.binary[SPV_INDEX_BOUND]);
+}
+
+TEST_P(TextToBinaryStreamTest, EmptyText) {
+  ASSERT_EQ(SPV_SUCCESS, AssembleStream(""));
+  EXPECT_EQ(size_t(SPV_INDEX_INSTRUCTION), stream_.binary.size());
+}
+
+TEST_P(TextToBinaryStreamTest, DiagnosesInvalidText) {
+  ASSERT_EQ(SPV_ERROR_INVALID_TEXT,
+            AssembleStream("OpCapability Shader\n"
+                           "OpMemoryModel Logical GLSL450\n"
+                           "%1 = OpTypeVoid\n"
+                           "%2 = OpNotAnOpcode\n"));
+  ASSERT_NE(nullptr, diagnostic_);
+  EXPECT_TRUE(diagnostic_->isTextSource);
+  EXPECT_EQ(3u, diagnostic_->position.line);
+  EXPECT_THAT(diagnostic_->error,
+              Eq(std::string("Invalid Opcode name 'OpNotAnOpcode'")));
+}
+
+TEST_P(TextToBinaryStreamTest, StopsOnWriteError) {
+  stream_.fail_at = 1;
+  ASSERT_EQ(SPV_ERROR_INTERNAL, AssembleStream(kModule));
+  EXPECT_EQ(1u, stream_.write_offsets.size());
+  ASSERT_NE(nullptr, diagnostic_);
+}
+
+TEST_P(TextToBinaryStreamTest, PreserveNumericIdsIsUnsupported) {
+  ASSERT_EQ(SPV_UNSUPPORTED,
+            AssembleStream(kModule,
+                           SPV_TEXT_TO_BINARY_OPTION_PRESERVE_NUMERIC_IDS));
+  EXPECT_TRUE(stream_.write_offsets.empty());
+}
+
+INSTANTIATE_TEST_SUITE_P(PieceSizes, TextToBinaryStreamTest,
+                         ::testing::ValuesIn(std::vector<size_t>{
+                             1, 2, 3, 7, 16, 1000, 1 << 20}));
+
+}  // namespace
+}  // namespace spvtools
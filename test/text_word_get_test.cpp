@@ -250,5 +250,19 @@ TEST(TextWordGet, CRLF) {
   EXPECT_STREQ("d", word.c_str());
 }
 
+TEST(TextWordGet, BoundaryAtEachPositionOfALongWord) {
+  const std::string letters(40, 'x');
+  for (size_t len = 0; len < letters.size(); ++len) {
+    AutoText input(letters.substr(0, len) + QUOTE "a b" QUOTE " c");
+    std::string word;
+    spv_position_t endPosition = {};
+    ASSERT_EQ(SPV_SUCCESS,
+              AssemblyContext(input, nullptr).getWord(&word, &endPosition));
+    EXPECT_EQ(len + 5, endPosition.column);
+    EXPECT_EQ(len + 5, endPosition.index);
+    EXPECT_EQ(letters.substr(0, len) + QUOTE "a b" QUOTE, word);
+  }
+}
+
 }  // namespace
 }  // namespace spvtools
@@ -159,6 +159,77 @@ TEST(BitVectorTest, SubsetOrTest) {
   EXPECT_FALSE(bvec1.Or(bvec2));
 }
 
+TEST(BitVectorTest, AndTest) {
+  BitVector bvec1;
+  bvec1.Set(3);
+  bvec1.Set(4);
+  bvec1.Set(10000);
+
+  BitVector bvec2;
+  bvec2.Set(2);
+  bvec2.Set(4);
+
+  // The bits past the end of |bvec2| are cleared too.
+  EXPECT_TRUE(bvec1.And(bvec2));
+  EXPECT_FALSE(bvec1.Get(2));
+  EXPECT_FALSE(bvec1.Get(3));
+  EXPECT_TRUE(bvec1.Get(4));
+  EXPECT_FALSE(bvec1.Get(10000));
+
+  // |And| returns false if |bvec1| does not change.
+  EXPECT_FALSE(bvec1.And(bvec2));
+}
+
+TEST(BitVectorTest, AndNotTest) {
+  BitVector bvec1;
+  bvec1.Set(3);
+  bvec1.Set(4);
+
+  BitVector bvec2;
+  bvec2.Set(4);
+  bvec2.Set(10000);
+
+  EXPECT_TRUE(bvec1.AndNot(bvec2));
+  EXPECT_TRUE(bvec1.Get(3));
+  EXPECT_FALSE(bvec1.Get(4));
+  EXPECT_FALSE(bvec1.Get(10000));
+
+  // |AndNot| returns false if |bvec1| does not change.
+  EXPECT_FALSE(bvec1.AndNot(bvec2));
+}
+
+TEST(BitVectorTest, CountAndForEachSetBit) {
+  BitVector bvec;
+  EXPECT_EQ(0u, bvec.Count());
+
+  std::vector<uint32_t> expected = {0, 3, 63, 64, 127, 1000, 10000};
+  for (uint32_t i : expected) {
+    bvec.Set(i);
+  }
+  EXPECT_EQ(expected.size(), bvec.Count());
+
+  std::vector<uint32_t> actual;
+  bvec.ForEachSetBit([&actual](uint32_t i) { actual.push_back(i); });
+  EXPECT_EQ(expected, actual);
+}
+
+TEST(BitVectorTest, CountBefore) {
+  BitVector bvec(64);
+  bvec.Set(0);
+  bvec.Set(5);
+  bvec.Set(63);
+  EXPECT_EQ(0u, bvec.CountBefore(0));
+  EXPECT_EQ(1u, bvec.CountBefore(5));
+  EXPECT_EQ(2u, bvec.CountBefore(6));
+  EXPECT_EQ(3u, bvec.CountBefore(64));
+
+  // Growing past the inline bits keeps the ones set before.
+  bvec.Set(200);
+  EXPECT_TRUE(bvec.Get(63));
+  EXPECT_EQ(3u, bvec.CountBefore(200));
+  EXPECT_EQ(4u, bvec.CountBefore(10000));
+}
+
 }  // namespace
 }  // namespace utils
 }  // namespace spvtools
@@ -0,0 +1,122 @@
+// Copyright (c) 2019 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <cstdint>
+#include <vector>
+
+#include "gmock/gmock.h"
+#include "source/util/node_pool.h"
+
+namespace spvtools {
+namespace utils {
+namespace {
+
+using NodePoolTest = ::testing::Test;
+
+TEST(NodePoolTest, AllocateAndFree) {
+  NodePool* pool = new NodePool(sizeof(uint64_t));
+  std::vector<uint64_t*> nodes;
+  for (uint64_t i = 0; i < 1000; ++i) {
+    nodes.push_back(
+        static_cast<uint64_t*>(NodePool::Allocate(pool, sizeof(uint64_t))));
+    *nodes.back() = i;
+  }
+  EXPECT_EQ(pool->num_live_nodes(), 1000);
+  for (uint64_t i = 0; i < 1000; ++i) {
+    EXPECT_EQ(*nodes[i], i);
+    EXPECT_EQ(reinterpret_cast<uintptr_t>(nodes[i]) % alignof(std::max_align_t),
+              0);
+  }
+  for (uint64_t* node : nodes) NodePool::Free(node);
+  EXPECT_EQ(pool->num_live_nodes(), 0);
+  pool->Release();
+}
+
+TEST(NodePoolTest, ReusesFreedNodes) {
+  NodePool* pool = new NodePool(sizeof(uint32_t));
+  void* first = NodePool::Allocate(pool, sizeof(uint32_t));
+  void* second = NodePool::Allocate(pool, sizeof(uint32_t));
+  const size_t num_slabs = pool->num_slabs();
+  NodePool::Free(first);
+  EXPECT_EQ(NodePool::Allocate(pool, sizeof(uint32_t)), first);
+  EXPECT_EQ(pool->num_slabs(), num_slabs);
+  EXPECT_EQ(pool->num_live_nodes(), 2);
+  NodePool::Free(first);
+  NodePool::Free(second);
+  pool->Release();
+}
+
+TEST(NodePoolTest, OtherSizesComeFromTheHeap) {
+  NodePool* pool = new NodePool(sizeof(uint32_t));
+  void* node = NodePool::Allocate(pool, 3 * sizeof(uint32_t));
+  EXPECT_EQ(pool->num_live_nodes(), 0);
+  EXPECT_EQ(pool->num_slabs(), 0);
+  NodePool::Free(node);
+  NodePool::Free(NodePool::Allocate(nullptr, sizeof(uint32_t)));
+  NodePool::Free(nullptr);
+  pool->Release();
+}
+
+TEST(NodePoolTest, ReservedNodesComeFromOneSlab) {
+  NodePool* pool = new NodePool(sizeof(uint32_t));
+  NodePool::Free(NodePool::Allocate(pool, sizeof(uint32_t)));
+  pool->Reserve(10000);
+  EXPECT_EQ(pool->num_slabs(), 2);
+  std::vector<void*> nodes;
+  for (int i = 0; i < 10000; ++i) {
+    nodes.push_back(NodePool::Allocate(pool, sizeof(uint32_t)));
+  }
+  EXPECT_EQ(pool->num_slabs(), 2);
+  for (void* node : nodes) NodePool::Free(node);
+  pool->Release();
+}
+
+TEST(NodePoolTest, RunNodesAreAdjacent) {
+  NodePool* pool = new NodePool(sizeof(uint32_t));
+  std::vector<void*> freed;
+  for (int i = 0; i < 4; ++i) {
+    freed.push_back(NodePool::Allocate(pool, sizeof(uint32_t)));
+  }
+  for (void* node : freed) NodePool::Free(node);
+  pool->ReserveRun(3);
+  std::vector<char*> run;
+  for (int i = 0; i < 3; ++i) {
+    run.push_back(
+        static_cast<char*>(NodePool::Allocate(pool, sizeof(uint32_t))));
+  }
+  EXPECT_EQ(run[1] - run[0], run[2] - run[1]);
+  EXPECT_GT(run[1], run[0]);
+  for (void* node : freed) EXPECT_NE(node, run[0]);
+  // Once the run is over, the freed nodes are reused.
+  void* reused = NodePool::Allocate(pool, sizeof(uint32_t));
+  EXPECT_EQ(reused, freed.back());
+  NodePool::Free(reused);
+  for (char* node : run) NodePool::Free(node);
+  pool->Release();
+}
+
+TEST(NodePoolTest, NodesOutliveTheOwner) {
+  NodePool* pool = new NodePool(sizeof(uint32_t));
+  uint32_t* node =
+      static_cast<uint32_t*>(NodePool::Allocate(pool, sizeof(uint32_t)));
+  pool->Release();
+  // The pool is still alive, and is destroyed with its last node.
+  *node = 42;
+  EXPECT_EQ(*node, 42);
+  NodePool::Free(node);
+}
+
+}  // namespace
+}  // namespace utils
+}  // namespace spvtools
@@ -0,0 +1,53 @@
+// Copyright (c) 2019 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <vector>
+
+#include "gmock/gmock.h"
+#include "source/util/parallel.h"
+
+namespace spvtools {
+namespace utils {
+namespace {
+
+TEST(ParallelTest, ResolveNumThreadsIsNeverZero) {
+  EXPECT_GE(ResolveNumThreads(0), 1u);
+  EXPECT_EQ(ResolveNumThreads(1), 1u);
+  EXPECT_EQ(ResolveNumThreads(7), 7u);
+}
+
+TEST(ParallelTest, NoWork) {
+  bool called = false;
+  ParallelFor(0, 4, [&called](size_t) { called = true; });
+  EXPECT_FALSE(called);
+}
+
+TEST(ParallelTest, EachIndexIsVisitedOnce) {
+  for (uint32_t num_threads : {0u, 1u, 2u, 8u, 100u}) {
+    std::vector<uint32_t> visits(1000, 0);
+    ParallelFor(visits.size(), num_threads,
+                [&visits](size_t i) { visits[i]++; });
+    EXPECT_THAT(visits, ::testing::Each(1u)) << num_threads;
+  }
+}
+
+TEST(ParallelTest, SingleThreadRunsInOrder) {
+  std::vector<size_t> order;
+  ParallelFor(5, 1, [&order](size_t i) { order.push_back(i); });
+  EXPECT_THAT(order, ::testing::ElementsAre(0, 1, 2, 3, 4));
+}
+
+}  // namespace
+}  // namespace utils
+}  // namespace spvtools
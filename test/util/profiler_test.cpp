@@ -0,0 +1,115 @@
+// Copyright (c) 2019 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <sstream>
+#include <string>
+
+#include "gmock/gmock.h"
+#include "source/util/profiler.h"
+
+namespace spvtools {
+namespace utils {
+namespace {
+
+using ::testing::HasSubstr;
+using ::testing::Not;
+
+std::string Trace(const Profiler& profiler) {
+  std::ostringstream out;
+  profiler.WriteChromeTrace(&out);
+  return out.str();
+}
+
+TEST(ProfilerTest, EmptyTrace) {
+  Profiler profiler;
+  EXPECT_EQ("{\"traceEvents\":[\n],\"displayTimeUnit\":\"ms\"}\n",
+            Trace(profiler));
+}
+
+TEST(ProfilerTest, RecordsNestedScopes) {
+  Profiler profiler;
+  {
+    ProfileScope pass(&profiler, "pass", "merge-blocks");
+    ProfileScope function(&profiler, "function", "function", 4);
+    ProfileScope analysis(&profiler, "analysis", "cfg");
+  }
+  EXPECT_EQ(3u, profiler.num_scopes());
+  const std::string trace = Trace(profiler);
+  EXPECT_THAT(trace, HasSubstr("{\"name\":\"merge-blocks\",\"cat\":\"pass\","
+                               "\"ph\":\"X\",\"pid\":1,\"tid\":1,\"ts\":"));
+  EXPECT_THAT(trace, HasSubstr("{\"name\":\"function %4\","
+                               "\"cat\":\"function\""));
+  EXPECT_THAT(trace, HasSubstr("{\"name\":\"cfg\",\"cat\":\"analysis\""));
+  // The enclosing scope is recorded first.
+  EXPECT_LT(trace.find("merge-blocks"), trace.find("function %4"));
+  EXPECT_LT(trace.find("function %4"), trace.find("cfg"));
+}
+
+TEST(ProfilerTest, OpenScopesAreNotWritten) {
+  Profiler profiler;
+  profiler.BeginScope("pass", "finished");
+  profiler.EndScope();
+  profiler.BeginScope("pass", "running");
+  const std::string trace = Trace(profiler);
+  EXPECT_THAT(trace, HasSubstr("finished"));
+  EXPECT_THAT(trace, Not(HasSubstr("running")));
+  profiler.EndScope();
+}
+
+TEST(ProfilerTest, EscapesNames) {
+  Profiler profiler;
+  { ProfileScope scope(&profiler, "pass", "a \"b\" \\c\n"); }
+  EXPECT_THAT(Trace(profiler), HasSubstr("\"a \\\"b\\\" \\\\c\\u000a\""));
+}
+
+TEST(ProfilerTest, NullProfilerDoesNothing) {
+  ProfileScope scope(nullptr, "pass", "nothing");
+  ProfileScope with_id(nullptr, "function", "function", 4);
+}
+
+TEST(StepStatisticsTest, WritesPhasesAndTotals) {
+  StepStatistics statistics;
+  StepStatistics::Phase* remove = statistics.GetPhase("remove");
+  remove->attempts = 3;
+  remove->successes = 1;
+  remove->bytes_removed = 40;
+  remove->test_us = 7;
+  StepStatistics::Phase* merge = statistics.GetPhase("merge \"blocks\"");
+  merge->attempts = 2;
+  merge->cache_hits = 1;
+  merge->test_us = 5;
+  EXPECT_EQ(3u, statistics.GetPhase("remove")->attempts);
+  ASSERT_EQ(2u, statistics.phases().size());
+
+  std::ostringstream out;
+  statistics.WriteJson(&out);
+  const std::string json = out.str();
+  EXPECT_THAT(json, HasSubstr("{\"name\":\"remove\",\"attempts\":3,"
+                              "\"successes\":1,\"cache_hits\":0,"
+                              "\"bytes_removed\":40,\"tool_us\":0,"
+                              "\"validate_us\":0,\"test_us\":7}"));
+  EXPECT_THAT(json, HasSubstr("\"name\":\"merge \\\"blocks\\\"\""));
+  EXPECT_THAT(json, HasSubstr("\"total\":{\"attempts\":5,\"successes\":1,"
+                              "\"cache_hits\":1,\"bytes_removed\":40,"
+                              "\"tool_us\":0,\"validate_us\":0,"
+                              "\"test_us\":12}"));
+  EXPECT_THAT(json, HasSubstr("\"wall_us\":"));
+
+  statistics.Clear();
+  EXPECT_TRUE(statistics.phases().empty());
+}
+
+}  // namespace
+}  // namespace utils
+}  // namespace spvtools
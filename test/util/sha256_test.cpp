@@ -0,0 +1,66 @@
+// Copyright (c) 2019 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <algorithm>
+#include <string>
+
+#include "gmock/gmock.h"
+#include "source/util/sha256.h"
+
+namespace spvtools {
+namespace utils {
+namespace {
+
+// Returns the digest of |message|, supplied |piece_size| bytes at a time.
+std::string Digest(const std::string& message, size_t piece_size) {
+  Sha256 sha;
+  for (size_t i = 0; i < message.size(); i += piece_size) {
+    sha.Update(message.data() + i, std::min(piece_size, message.size() - i));
+  }
+  return sha.HexDigest();
+}
+
+TEST(Sha256Test, Empty) {
+  EXPECT_EQ(
+      "e3b0c44298fc1c149afbf4c8996fb92427ae41e4649b934ca495991b7852b855",
+      Digest("", 1));
+}
+
+TEST(Sha256Test, OneBlock) {
+  EXPECT_EQ(
+      "ba7816bf8f01cfea414140de5dae2223b00361a396177a9cb410ff61f20015ad",
+      Digest("abc", 1));
+}
+
+TEST(Sha256Test, TwoBlocks) {
+  const std::string message =
+      "abcdbcdecdefdefgefghfghighijhijkijkljklmklmnlmnomnopnopq";
+  EXPECT_EQ(
+      "248d6a61d20638b8e5c026930c3e6039a33ce45964ff2167f6ecedd419db06c1",
+      Digest(message, message.size()));
+}
+
+TEST(Sha256Test, PiecesOfAnySize) {
+  const std::string message(1000, 'x');
+  const std::string expected =
+      "44f8354494a5ba03ba1792a8d3e9c534c47a9181980fde7a3f44b06ef2ae7c7f";
+  EXPECT_EQ(expected, Digest(message, 1));
+  EXPECT_EQ(expected, Digest(message, 7));
+  EXPECT_EQ(expected, Digest(message, 64));
+  EXPECT_EQ(expected, Digest(message, message.size()));
+}
+
+}  // namespace
+}  // namespace utils
+}  // namespace spvtools
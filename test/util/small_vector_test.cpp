@@ -56,6 +56,15 @@ TEST(SmallVectorTest, Initialize_list2) {
   }
 }
 
+TEST(SmallVectorTest, Initialize_range) {
+  const uint32_t words[] = {0, 1, 2, 3};
+  SmallVector<uint32_t, 2> small(words, words + 2);
+  SmallVector<uint32_t, 2> large(words, words + 4);
+
+  EXPECT_EQ(small, std::vector<uint32_t>({0, 1}));
+  EXPECT_EQ(large, std::vector<uint32_t>({0, 1, 2, 3}));
+}
+
 TEST(SmallVectorTest, Initialize_copy1) {
   SmallVector<uint32_t, 6> vec1 = {0, 1, 2, 3};
   SmallVector<uint32_t, 6> vec2(vec1);
@@ -0,0 +1,63 @@
+// Copyright (c) 2019 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <vector>
+
+#include "gmock/gmock.h"
+#include "source/util/span.h"
+
+namespace spvtools {
+namespace utils {
+namespace {
+
+using ::testing::ElementsAre;
+
+TEST(SpanTest, Initialize_default) {
+  Span<uint32_t> span;
+
+  EXPECT_TRUE(span.empty());
+  EXPECT_EQ(span.size(), 0u);
+  EXPECT_EQ(span.begin(), span.end());
+}
+
+TEST(SpanTest, Initialize_data) {
+  const std::vector<uint32_t> words = {1, 2, 3, 4};
+  Span<uint32_t> span(words.data() + 1, 2);
+
+  EXPECT_FALSE(span.empty());
+  EXPECT_EQ(span.size(), 2u);
+  EXPECT_EQ(span.data(), words.data() + 1);
+  EXPECT_EQ(span[0], 2u);
+  EXPECT_EQ(span[1], 3u);
+  EXPECT_EQ(span.front(), 2u);
+  EXPECT_EQ(span.back(), 3u);
+  EXPECT_THAT(std::vector<uint32_t>(span.begin(), span.end()),
+              ElementsAre(2, 3));
+  EXPECT_THAT(std::vector<uint32_t>(span.cbegin(), span.cend()),
+              ElementsAre(2, 3));
+}
+
+TEST(SpanTest, Compare) {
+  const std::vector<uint32_t> words = {1, 2, 1, 2, 3};
+
+  EXPECT_TRUE(Span<uint32_t>(&words[0], 2) == Span<uint32_t>(&words[2], 2));
+  EXPECT_FALSE(Span<uint32_t>(&words[0], 2) != Span<uint32_t>(&words[2], 2));
+  EXPECT_TRUE(Span<uint32_t>(&words[0], 2) != Span<uint32_t>(&words[2], 3));
+  EXPECT_TRUE(Span<uint32_t>(&words[0], 2) != Span<uint32_t>(&words[1], 2));
+  EXPECT_TRUE(Span<uint32_t>() == Span<uint32_t>(&words[0], 0));
+}
+
+}  // namespace
+}  // namespace utils
+}  // namespace spvtools
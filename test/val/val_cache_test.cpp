@@ -0,0 +1,185 @@
+// Copyright (c) 2019 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// Tests for the cache of the modules known to be valid.
+
+#include <set>
+#include <string>
+#include <vector>
+
+#include "gmock/gmock.h"
+#include "test/val/val_fixtures.h"
+
+namespace spvtools {
+namespace val {
+namespace {
+
+// A cache that remembers the keys looked up and stored.  If |contains_all| is
+// true, it claims to contain every module.
+class TestCache : public ValidationCache {
+ public:
+  explicit TestCache(bool contains_all = false) : contains_all_(contains_all) {}
+
+  bool Contains(const std::string& key) override {
+    looked_up.push_back(key);
+    return contains_all_ || stored.count(key) != 0;
+  }
+
+  void Insert(const std::string& key) override { stored.insert(key); }
+
+  std::vector<std::string> looked_up;
+  std::set<std::string> stored;
+
+ private:
+  const bool contains_all_;
+};
+
+class ValidateCache : public spvtest::ValidateBase<bool> {
+ protected:
+  // Sets |cache| as the cache of the validator options.
+  void SetCache(TestCache* cache) {
+    spvValidatorOptionsSetCache(
+        getValidatorOptions(),
+        [](void* user_data, const char* key) {
+          return static_cast<TestCache*>(user_data)->Contains(key);
+        },
+        [](void* user_data, const char* key) {
+          static_cast<TestCache*>(user_data)->Insert(key);
+        },
+        cache);
+  }
+};
+
+const char kValid[] = R"(
+OpCapability Shader
+OpCapability Linkage
+OpMemoryModel Logical GLSL450
+%void = OpTypeVoid
+%float = OpTypeFloat 32
+)";
+
+const char kInvalid[] = R"(
+OpCapability Shader
+OpCapability Linkage
+OpMemoryModel Logical GLSL450
+%void = OpTypeVoid
+%void2 = OpTypeVoid
+)";
+
+// Only valid if only the structure of the module is checked.
+const char kStructurallyValid[] = R"(
+OpCapability Shader
+OpCapability Linkage
+OpMemoryModel Logical GLSL450
+%void = OpTypeVoid
+%fn = OpTypeFunction %void
+%float = OpTypeFloat 32
+%float_1 = OpConstant %float 1
+%func = OpFunction %void None %fn
+%entry = OpLabel
+%sum = OpIAdd %float %float_1 %float_1
+OpReturn
+OpFunctionEnd
+)";
+
+TEST_F(ValidateCache, StoresValidModule) {
+  TestCache cache;
+  SetCache(&cache);
+  CompileSuccessfully(kValid);
+  EXPECT_EQ(SPV_SUCCESS, ValidateInstructions());
+  ASSERT_EQ(1u, cache.looked_up.size());
+  EXPECT_EQ(64u, cache.looked_up[0].size());
+  EXPECT_EQ(std::string::npos,
+            cache.looked_up[0].find_first_not_of("0123456789abcdef"));
+  EXPECT_EQ(std::set<std::string>{cache.looked_up[0]}, cache.stored);
+
+  EXPECT_EQ(SPV_SUCCESS, ValidateInstructions());
+  ASSERT_EQ(2u, cache.looked_up.size());
+  EXPECT_EQ(cache.looked_up[0], cache.looked_up[1]);
+  EXPECT_EQ(1u, cache.stored.size());
+}
+
+TEST_F(ValidateCache, DoesNotStoreInvalidModule) {
+  TestCache cache;
+  SetCache(&cache);
+  CompileSuccessfully(kInvalid);
+  EXPECT_EQ(SPV_ERROR_INVALID_DATA, ValidateInstructions());
+  EXPECT_THAT(getDiagnosticString(),
+              ::testing::HasSubstr("Duplicate non-aggregate type "
+                                   "declarations are not allowed"));
+  EXPECT_EQ(1u, cache.looked_up.size());
+  EXPECT_TRUE(cache.stored.empty());
+}
+
+TEST_F(ValidateCache, CachedModuleIsNotChecked) {
+  TestCache cache(/* contains_all = */ true);
+  SetCache(&cache);
+  CompileSuccessfully(kInvalid);
+  EXPECT_EQ(SPV_SUCCESS, ValidateInstructions());
+  EXPECT_EQ("", getDiagnosticString());
+  EXPECT_TRUE(cache.stored.empty());
+}
+
+TEST_F(ValidateCache, KeyDependsOnModuleEnvironmentAndOptions) {
+  TestCache cache;
+  SetCache(&cache);
+  CompileSuccessfully(kValid);
+  EXPECT_EQ(SPV_SUCCESS, ValidateInstructions());
+  EXPECT_EQ(SPV_SUCCESS, ValidateInstructions(SPV_ENV_UNIVERSAL_1_3));
+  spvValidatorOptionsSetRelaxBlockLayout(getValidatorOptions(), true);
+  EXPECT_EQ(SPV_SUCCESS, ValidateInstructions());
+  spvValidatorOptionsSetUniversalLimit(getValidatorOptions(),
+                                       spv_validator_limit_max_id_bound, 1000);
+  EXPECT_EQ(SPV_SUCCESS, ValidateInstructions());
+  CompileSuccessfully(std::string(kValid) + "%int = OpTypeInt 32 0\n");
+  EXPECT_EQ(SPV_SUCCESS, ValidateInstructions());
+  EXPECT_EQ(5u, cache.stored.size());
+}
+
+TEST_F(ValidateCache, StructuralCheckDoesNotSatisfyFullValidation) {
+  TestCache cache;
+  SetCache(&cache);
+  CompileSuccessfully(kStructurallyValid);
+  spvValidatorOptionsSetStructuralOnly(getValidatorOptions(), true);
+  EXPECT_EQ(SPV_SUCCESS, ValidateInstructions());
+  EXPECT_EQ(1u, cache.stored.size());
+
+  spvValidatorOptionsSetStructuralOnly(getValidatorOptions(), false);
+  EXPECT_EQ(SPV_ERROR_INVALID_DATA, ValidateInstructions());
+  EXPECT_EQ(1u, cache.stored.size());
+}
+
+TEST_F(ValidateCache, KeyDoesNotDependOnNumThreads) {
+  TestCache cache;
+  SetCache(&cache);
+  CompileSuccessfully(kValid);
+  EXPECT_EQ(SPV_SUCCESS, ValidateInstructions());
+  spvValidatorOptionsSetNumThreads(getValidatorOptions(), 4);
+  EXPECT_EQ(SPV_SUCCESS, ValidateInstructions());
+  EXPECT_EQ(1u, cache.stored.size());
+}
+
+TEST_F(ValidateCache, RemovedCacheIsNotUsed) {
+  TestCache cache(/* contains_all = */ true);
+  SetCache(&cache);
+  spvValidatorOptionsSetCache(getValidatorOptions(), nullptr, nullptr,
+                              nullptr);
+  CompileSuccessfully(kInvalid);
+  EXPECT_EQ(SPV_ERROR_INVALID_DATA, ValidateInstructions());
+  EXPECT_TRUE(cache.looked_up.empty());
+}
+
+}  // namespace
+}  // namespace val
+}  // namespace spvtools
@@ -3892,6 +3892,46 @@ TEST_F(ValidateDecorations, BlockLayoutOffsetOverlapBad) {
           "offset 16 overlaps previous member ending at offset 31"));
 }
 
+TEST_F(ValidateDecorations, BlockLayoutOfSharedStructUsesEachRule) {
+  // The alignment of %Inner is memoized under storage buffer rules first, and
+  // must not be reused under uniform buffer rules.
+  std::string spirv = R"(
+               OpCapability Shader
+               OpMemoryModel Logical GLSL450
+               OpEntryPoint GLCompute %main "main"
+               OpExecutionMode %main LocalSize 1 1 1
+               OpMemberDecorate %Inner 0 Offset 0
+               OpMemberDecorate %Buffer 0 Offset 0
+               OpMemberDecorate %Buffer 1 Offset 4
+               OpMemberDecorate %Uniform 0 Offset 0
+               OpMemberDecorate %Uniform 1 Offset 4
+               OpDecorate %Buffer BufferBlock
+               OpDecorate %Uniform Block
+       %void = OpTypeVoid
+          %3 = OpTypeFunction %void
+      %float = OpTypeFloat 32
+      %Inner = OpTypeStruct %float
+     %Buffer = OpTypeStruct %float %Inner
+    %Uniform = OpTypeStruct %float %Inner
+%_ptr_Uniform_Buffer = OpTypePointer Uniform %Buffer
+%_ptr_Uniform_Uniform = OpTypePointer Uniform %Uniform
+          %B = OpVariable %_ptr_Uniform_Buffer Uniform
+          %U = OpVariable %_ptr_Uniform_Uniform Uniform
+       %main = OpFunction %void None %3
+          %5 = OpLabel
+               OpReturn
+               OpFunctionEnd
+  )";
+
+  CompileSuccessfully(spirv);
+  EXPECT_EQ(SPV_ERROR_INVALID_ID, ValidateAndRetrieveValidationState());
+  EXPECT_THAT(
+      getDiagnosticString(),
+      HasSubstr("decorated as Block for variable in Uniform storage class "
+                "must follow standard uniform buffer layout rules: member 1 "
+                "at offset 4 is not aligned to 16"));
+}
+
 TEST_F(ValidateDecorations, BufferBlockEmptyStruct) {
   std::string spirv = R"(
                OpCapability Shader
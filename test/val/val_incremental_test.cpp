@@ -0,0 +1,186 @@
+// Copyright (c) 2019 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// Tests for validating a series of modules with an incremental validator.
+
+#include <string>
+
+#include "gmock/gmock.h"
+#include "test/val/val_fixtures.h"
+
+namespace spvtools {
+namespace val {
+namespace {
+
+using ::testing::HasSubstr;
+
+// The parameter is the number of threads to validate with.
+class ValidateIncremental : public spvtest::ValidateBase<uint32_t> {
+ protected:
+  ValidateIncremental() : validator_(nullptr) {}
+  ~ValidateIncremental() override {
+    spvIncrementalValidatorDestroy(validator_);
+  }
+
+  // Validates the module compiled last with validator_, which is created on
+  // first use.
+  spv_result_t ValidateIncrementally() {
+    if (!validator_) {
+      spvValidatorOptionsSetNumThreads(getValidatorOptions(), GetParam());
+      validator_ = spvIncrementalValidatorCreate(context_.context,
+                                                 getValidatorOptions());
+    }
+    DestroyDiagnostic();
+    return spvIncrementalValidatorValidate(validator_, binary_->code,
+                                           binary_->wordCount, &diagnostic_);
+  }
+
+  spvtest::ScopedContext context_;
+  spv_incremental_validator validator_;
+};
+
+// Returns a module where %main calls %callee, and %other is unrelated.
+// |callee| is the body of %callee, and |other| the body of %other.
+std::string GenerateModule(const std::string& callee,
+                           const std::string& other) {
+  return R"(
+OpCapability Shader
+OpMemoryModel Logical GLSL450
+OpEntryPoint Fragment %main "main"
+OpExecutionMode %main OriginUpperLeft
+%void = OpTypeVoid
+%int = OpTypeInt 32 0
+%float = OpTypeFloat 32
+%fn = OpTypeFunction %void
+%fn_int = OpTypeFunction %void %int
+%one = OpConstant %float 1
+%main = OpFunction %void None %fn
+%main_entry = OpLabel
+%call = OpFunctionCall %void %callee
+OpReturn
+OpFunctionEnd
+)" + callee + other;
+}
+
+const char kCallee[] = R"(
+%callee = OpFunction %void None %fn
+%callee_entry = OpLabel
+%d = OpDPdx %float %one
+OpReturn
+OpFunctionEnd
+)";
+
+const char kOther[] = R"(
+%other = OpFunction %void None %fn
+%other_entry = OpLabel
+%a = OpFAdd %float %one %one
+OpReturn
+OpFunctionEnd
+)";
+
+TEST_P(ValidateIncremental, SameModuleAgain) {
+  CompileSuccessfully(GenerateModule(kCallee, kOther));
+  EXPECT_EQ(SPV_SUCCESS, ValidateIncrementally());
+  EXPECT_EQ(SPV_SUCCESS, ValidateIncrementally());
+}
+
+TEST_P(ValidateIncremental, ChangedFunctionIsChecked) {
+  CompileSuccessfully(GenerateModule(kCallee, kOther));
+  EXPECT_EQ(SPV_SUCCESS, ValidateIncrementally());
+  CompileSuccessfully(GenerateModule(kCallee, R"(
+%other = OpFunction %void None %fn
+%other_entry = OpLabel
+%a = OpIAdd %float %one %one
+OpReturn
+OpFunctionEnd
+)"));
+  EXPECT_EQ(SPV_ERROR_INVALID_DATA, ValidateIncrementally());
+  EXPECT_THAT(getDiagnosticString(),
+              HasSubstr("Expected int scalar or vector type as Result Type: "
+                        "IAdd"));
+}
+
+TEST_P(ValidateIncremental, CallerOfChangedFunctionIsChecked) {
+  CompileSuccessfully(GenerateModule(kCallee, kOther));
+  EXPECT_EQ(SPV_SUCCESS, ValidateIncrementally());
+  // The call in %main no longer matches the parameters of %callee.
+  CompileSuccessfully(GenerateModule(R"(
+%callee = OpFunction %void None %fn_int
+%param = OpFunctionParameter %int
+%callee_entry = OpLabel
+OpReturn
+OpFunctionEnd
+)",
+                                     kOther));
+  EXPECT_EQ(SPV_ERROR_INVALID_ID, ValidateIncrementally());
+  EXPECT_THAT(getDiagnosticString(),
+              HasSubstr("OpFunctionCall Function <id>'s parameter count does "
+                        "not match the argument count."));
+}
+
+TEST_P(ValidateIncremental, ChangedGlobalsAreChecked) {
+  CompileSuccessfully(GenerateModule(kCallee, kOther));
+  EXPECT_EQ(SPV_SUCCESS, ValidateIncrementally());
+  // The derivative in the unchanged %callee is not allowed in a Vertex entry
+  // point.
+  std::string text = GenerateModule(kCallee, kOther);
+  const std::string fragment =
+      "OpEntryPoint Fragment %main \"main\"\n"
+      "OpExecutionMode %main OriginUpperLeft\n";
+  text.replace(text.find(fragment), fragment.size(),
+               "OpEntryPoint Vertex %main \"main\"\n");
+  CompileSuccessfully(text);
+  EXPECT_EQ(SPV_ERROR_INVALID_ID, ValidateIncrementally());
+  EXPECT_THAT(getDiagnosticString(),
+              HasSubstr("Derivative instructions require Fragment or GLCompute "
+                        "execution model: DPdx"));
+}
+
+TEST_P(ValidateIncremental, KeepsLastValidModuleAfterFailure) {
+  CompileSuccessfully(GenerateModule(kCallee, kOther));
+  EXPECT_EQ(SPV_SUCCESS, ValidateIncrementally());
+  CompileSuccessfully(GenerateModule(kCallee, R"(
+%other = OpFunction %void None %fn
+%other_entry = OpLabel
+%a = OpIAdd %float %one %one
+OpReturn
+OpFunctionEnd
+)"));
+  EXPECT_EQ(SPV_ERROR_INVALID_DATA, ValidateIncrementally());
+  CompileSuccessfully(GenerateModule(kCallee, R"(
+%other = OpFunction %void None %fn
+%other_entry = OpLabel
+%a = OpFMul %float %one %one
+OpReturn
+OpFunctionEnd
+)"));
+  EXPECT_EQ(SPV_SUCCESS, ValidateIncrementally());
+}
+
+TEST(IncrementalValidator, RequiresContext) {
+  EXPECT_EQ(nullptr, spvIncrementalValidatorCreate(nullptr, nullptr));
+}
+
+TEST(IncrementalValidator, RequiresValidator) {
+  const uint32_t words[] = {0};
+  EXPECT_EQ(SPV_ERROR_INVALID_POINTER,
+            spvIncrementalValidatorValidate(nullptr, words, 1, nullptr));
+}
+
+INSTANTIATE_TEST_SUITE_P(NumThreads, ValidateIncremental,
+                         ::testing::Values(1u, 4u));
+
+}  // namespace
+}  // namespace val
+}  // namespace spvtools
@@ -84,6 +84,50 @@ OpMemoryModel Logical GLSL450
       HasSubstr("Cannot create undefined values with 8- or 16-bit types"));
 }
 
+TEST_F(ValidateMisc, UndefRestrictedNestedShort) {
+  const std::string spirv = R"(
+OpCapability Shader
+OpCapability Linkage
+OpCapability StorageBuffer16BitAccess
+OpExtension "SPV_KHR_16bit_storage"
+OpMemoryModel Logical GLSL450
+%int = OpTypeInt 32 0
+%int_2 = OpConstant %int 2
+%short = OpTypeInt 16 0
+%short2 = OpTypeVector %short 2
+%array = OpTypeArray %short2 %int_2
+%inner = OpTypeStruct %int %array
+%outer = OpTypeStruct %inner %int
+%undef = OpUndef %outer
+)";
+
+  CompileSuccessfully(spirv);
+  EXPECT_EQ(SPV_ERROR_INVALID_ID, ValidateInstructions());
+  EXPECT_THAT(
+      getDiagnosticString(),
+      HasSubstr("Cannot create undefined values with 8- or 16-bit types"));
+}
+
+TEST_F(ValidateMisc, UndefNestedIntGood) {
+  const std::string spirv = R"(
+OpCapability Shader
+OpCapability Linkage
+OpCapability StorageBuffer16BitAccess
+OpExtension "SPV_KHR_16bit_storage"
+OpMemoryModel Logical GLSL450
+%int = OpTypeInt 32 0
+%int_2 = OpConstant %int 2
+%int2 = OpTypeVector %int 2
+%array = OpTypeArray %int2 %int_2
+%inner = OpTypeStruct %int %array
+%outer = OpTypeStruct %inner %int
+%undef = OpUndef %outer
+)";
+
+  CompileSuccessfully(spirv);
+  EXPECT_EQ(SPV_SUCCESS, ValidateInstructions());
+}
+
 const std::string ShaderClockSpriv = R"(
 OpCapability Shader
 OpCapability Int64
@@ -0,0 +1,143 @@
+// Copyright (c) 2019 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// Tests for validating a module supplied one instruction at a time.
+
+#include <algorithm>
+#include <functional>
+#include <string>
+#include <vector>
+
+#include "gmock/gmock.h"
+#include "source/val/validate.h"
+#include "test/val/val_fixtures.h"
+
+namespace spvtools {
+namespace val {
+namespace {
+
+using ::testing::Eq;
+
+class ValidateModuleInstructionsTest : public spvtest::ValidateBase<bool> {
+ protected:
+  ValidateModuleInstructionsTest() : to_binary_calls_(0) {}
+
+  // Returns the module compiled last, supplied one instruction at a time.
+  ModuleInstructions GetModuleInstructions() {
+    const std::vector<uint32_t> binary(binary_->code,
+                                       binary_->code + binary_->wordCount);
+    ModuleInstructions module;
+    std::copy(binary.begin(), binary.begin() + SPV_INDEX_INSTRUCTION,
+              module.header);
+    module.num_instructions = 0;
+    module.num_words = binary.size() - SPV_INDEX_INSTRUCTION;
+    module.num_functions = 0;
+    for (size_t i = SPV_INDEX_INSTRUCTION; i < binary.size();
+         i += binary[i] >> 16) {
+      ++module.num_instructions;
+      if ((binary[i] & 0xffff) == SpvOpFunction) ++module.num_functions;
+    }
+    module.for_each_instruction =
+        [binary](
+            const std::function<spv_result_t(const uint32_t*, size_t)>& parse) {
+          for (size_t i = SPV_INDEX_INSTRUCTION; i < binary.size();
+               i += binary[i] >> 16) {
+            if (auto error = parse(&binary[i], binary[i] >> 16)) return error;
+          }
+          return SPV_SUCCESS;
+        };
+    module.to_binary = [this, binary]() {
+      ++to_binary_calls_;
+      return binary;
+    };
+    return module;
+  }
+
+  // Validates the module compiled last both from its binary and from its
+  // instructions, and checks that the results and diagnostics are the same.
+  // Returns the result.
+  spv_result_t ValidateBoth() {
+    spvtest::ScopedContext context;
+    const spv_result_t expected = ValidateInstructions();
+    const std::string expected_diagnostic = getDiagnosticString();
+    DestroyDiagnostic();
+    const spv_result_t result = ValidateModuleInstructions(
+        context.context, getValidatorOptions(), GetModuleInstructions(),
+        &diagnostic_);
+    EXPECT_EQ(expected, result);
+    EXPECT_THAT(getDiagnosticString(), Eq(expected_diagnostic));
+    return result;
+  }
+
+  int to_binary_calls_;
+};
+
+const char kModule[] = R"(
+OpCapability Shader
+OpMemoryModel Logical GLSL450
+OpEntryPoint GLCompute %main "main"
+OpExecutionMode %main LocalSize 1 1 1
+OpName %main "main"
+%void = OpTypeVoid
+%fn = OpTypeFunction %void
+%float = OpTypeFloat 32
+%one = OpConstant %float 1
+%main = OpFunction %void None %fn
+%entry = OpLabel
+%sum = OpFAdd %float %one %one
+OpReturn
+OpFunctionEnd
+)";
+
+TEST_F(ValidateModuleInstructionsTest, ValidModule) {
+  CompileSuccessfully(kModule);
+  EXPECT_EQ(SPV_SUCCESS, ValidateBoth());
+  EXPECT_EQ(0, to_binary_calls_);
+}
+
+TEST_F(ValidateModuleInstructionsTest, InvalidModule) {
+  std::string text = kModule;
+  const std::string add = "OpFAdd";
+  text.replace(text.find(add), add.size(), "OpIAdd");
+  CompileSuccessfully(text);
+  EXPECT_EQ(SPV_ERROR_INVALID_DATA, ValidateBoth());
+  EXPECT_EQ(1, to_binary_calls_);
+}
+
+TEST_F(ValidateModuleInstructionsTest, InvalidEncoding) {
+  CompileSuccessfully(kModule);
+  // Sets the result id of OpTypeVoid to 0, which the parser rejects.
+  const uint32_t* words = binary_->code;
+  size_t i = SPV_INDEX_INSTRUCTION;
+  while ((words[i] & 0xffff) != SpvOpTypeVoid) i += words[i] >> 16;
+  OverwriteAssembledBinary(uint32_t(i + 1), 0);
+  EXPECT_EQ(SPV_ERROR_INVALID_ID, ValidateBoth());
+}
+
+TEST_F(ValidateModuleInstructionsTest, IncrementalValidator) {
+  CompileSuccessfully(kModule);
+  spvtest::ScopedContext context;
+  spv_incremental_validator validator =
+      spvIncrementalValidatorCreate(context.context, getValidatorOptions());
+  EXPECT_EQ(SPV_SUCCESS, ValidateModuleInstructions(
+                             validator, GetModuleInstructions(), nullptr));
+  EXPECT_EQ(SPV_SUCCESS, ValidateModuleInstructions(
+                             validator, GetModuleInstructions(), nullptr));
+  spvIncrementalValidatorDestroy(validator);
+  EXPECT_EQ(0, to_binary_calls_);
+}
+
+}  // namespace
+}  // namespace val
+}  // namespace spvtools
@@ -0,0 +1,153 @@
+// Copyright (c) 2019 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// Tests for validating the functions of a module on multiple threads.
+
+#include <algorithm>
+#include <string>
+#include <vector>
+
+#include "gmock/gmock.h"
+#include "test/val/val_fixtures.h"
+
+namespace spvtools {
+namespace val {
+namespace {
+
+using ::testing::HasSubstr;
+using ::testing::Not;
+
+// The parameter is the number of threads to validate with.
+using ValidateParallel = spvtest::ValidateBase<uint32_t>;
+
+// Returns a module with many functions.  The functions whose indices are in
+// |bad_functions| use OpIAdd with a float result, which is invalid.  If
+// |derivative| is true, the Vertex entry point uses a derivative, which is
+// only invalid because of the execution model.
+std::string GenerateModule(const std::vector<int>& bad_functions,
+                           bool derivative) {
+  std::string names;
+  for (int i : bad_functions) {
+    names += "OpName %bad" + std::to_string(i) + " \"bad" +
+             std::to_string(i) + "\"\n";
+  }
+  std::string text = R"(
+OpCapability Shader
+OpMemoryModel Logical GLSL450
+OpEntryPoint Vertex %main "main"
+)" + names + R"(
+%void = OpTypeVoid
+%fn = OpTypeFunction %void
+%float = OpTypeFloat 32
+%one = OpConstant %float 1
+)";
+  for (int i = 0; i < 20; ++i) {
+    const std::string n = std::to_string(i);
+    const bool bad = std::find(bad_functions.begin(), bad_functions.end(),
+                               i) != bad_functions.end();
+    text += "%f" + n + " = OpFunction %void None %fn\n" + "%l" + n +
+            " = OpLabel\n" +
+            (bad ? "%bad" + n + " = OpIAdd %float %one %one\n"
+                 : "%v" + n + " = OpFAdd %float %one %one\n") +
+            "OpReturn\n" + "OpFunctionEnd\n";
+  }
+  text += R"(
+%main = OpFunction %void None %fn
+%entry = OpLabel
+)" + std::string(derivative ? "%d = OpDPdx %float %one\n" : "") +
+          R"(OpReturn
+OpFunctionEnd
+)";
+  return text;
+}
+
+TEST_P(ValidateParallel, ValidModule) {
+  spvValidatorOptionsSetNumThreads(getValidatorOptions(), GetParam());
+  CompileSuccessfully(GenerateModule({}, false));
+  EXPECT_EQ(SPV_SUCCESS, ValidateInstructions());
+}
+
+TEST_P(ValidateParallel, ReportsFirstFailureInModuleOrder) {
+  spvValidatorOptionsSetNumThreads(getValidatorOptions(), GetParam());
+  CompileSuccessfully(GenerateModule({3, 15, 19}, false));
+  EXPECT_EQ(SPV_ERROR_INVALID_DATA, ValidateInstructions());
+  EXPECT_THAT(getDiagnosticString(),
+              HasSubstr("Expected int scalar or vector type as Result Type: "
+                        "IAdd"));
+  EXPECT_THAT(getDiagnosticString(), HasSubstr("%bad3 = OpIAdd"));
+  EXPECT_THAT(getDiagnosticString(), Not(HasSubstr("%bad15")));
+  EXPECT_THAT(getDiagnosticString(), Not(HasSubstr("%bad19")));
+}
+
+TEST_P(ValidateParallel, AppliesLimitationsFromFunctions) {
+  spvValidatorOptionsSetNumThreads(getValidatorOptions(), GetParam());
+  CompileSuccessfully(GenerateModule({}, true));
+  EXPECT_EQ(SPV_ERROR_INVALID_ID, ValidateInstructions());
+  EXPECT_THAT(getDiagnosticString(),
+              HasSubstr("Derivative instructions require Fragment or GLCompute "
+                        "execution model: DPdx"));
+}
+
+TEST_P(ValidateParallel, ReportsFirstLimitationFailureInModuleOrder) {
+  // Every helper is called by a Fragment and a Vertex entry point.  The
+  // helpers using a derivative cannot be used by the Vertex one, and the
+  // first of them in module order is reported.
+  std::string text = R"(
+OpCapability Shader
+OpMemoryModel Logical GLSL450
+OpEntryPoint Fragment %frag "frag"
+OpEntryPoint Vertex %vert "vert"
+OpExecutionMode %frag OriginUpperLeft
+OpName %f7 "f7"
+OpName %f12 "f12"
+%void = OpTypeVoid
+%fn = OpTypeFunction %void
+%float = OpTypeFloat 32
+%one = OpConstant %float 1
+)";
+  for (int i = 0; i < 20; ++i) {
+    const std::string n = std::to_string(i);
+    const bool derivative = i == 7 || i == 12;
+    text += "%f" + n + " = OpFunction %void None %fn\n%l" + n +
+            " = OpLabel\n" +
+            (derivative ? "%d" + n + " = OpDPdx %float %one\n" : "") +
+            "OpReturn\nOpFunctionEnd\n";
+  }
+  for (const std::string entry : {"frag", "vert"}) {
+    text += "%" + entry + " = OpFunction %void None %fn\n%" + entry +
+            "_entry = OpLabel\n";
+    for (int i = 0; i < 20; ++i) {
+      const std::string n = std::to_string(i);
+      text += "%" + entry + "_call" + n + " = OpFunctionCall %void %f" + n +
+              "\n";
+    }
+    text += "OpReturn\nOpFunctionEnd\n";
+  }
+
+  spvValidatorOptionsSetNumThreads(getValidatorOptions(), GetParam());
+  CompileSuccessfully(text);
+  EXPECT_EQ(SPV_ERROR_INVALID_ID, ValidateInstructions());
+  EXPECT_THAT(getDiagnosticString(),
+              HasSubstr("Derivative instructions require Fragment or GLCompute "
+                        "execution model: DPdx"));
+  EXPECT_THAT(getDiagnosticString(), HasSubstr("[%f7]"));
+  EXPECT_THAT(getDiagnosticString(), Not(HasSubstr("[%f12]")));
+}
+
+INSTANTIATE_TEST_SUITE_P(NumThreads, ValidateParallel,
+                         ::testing::Values(1u, 2u, 3u, 8u, 0u));
+
+}  // namespace
+}  // namespace val
+}  // namespace spvtools
@@ -546,6 +546,72 @@ TEST_F(ValidateSSA, ForwardBranchConditionalMissingTargetBad) {
   EXPECT_THAT(getDiagnosticString(), HasSubstr("missing"));
 }
 
+// Returns a function of |depth| selection constructs nested in the true
+// branches of one another, where %def is defined in the true branch of the
+// outermost construct.  The last instruction of the true branch of the
+// innermost construct is |inner_use|, and that of the merge block of the
+// outermost construct is |outer_use|.
+std::string GenerateNestedSelections(int depth, const std::string& inner_use,
+                                     const std::string& outer_use) {
+  std::string text = R"(
+     OpCapability Shader
+     OpCapability Linkage
+     OpMemoryModel Logical GLSL450
+     OpName %def "def"
+%void = OpTypeVoid
+%fn = OpTypeFunction %void
+%bool = OpTypeBool
+%uint = OpTypeInt 32 0
+%true = OpConstantTrue %bool
+%one = OpConstant %uint 1
+%func = OpFunction %void None %fn
+%entry = OpLabel
+OpBranch %header0
+)";
+  for (int i = 0; i < depth; ++i) {
+    const std::string n = std::to_string(i);
+    text += "%header" + n + " = OpLabel
+" + "OpSelectionMerge %merge" + n +
+            " None
+" + "OpBranchConditional %true %then" + n + " %merge" +
+            n + "
+" + "%then" + n + " = OpLabel
+" +
+            (i == 0 ? "%def = OpIAdd %uint %one %one
+" : "") +
+            (i + 1 < depth ? "OpBranch %header" + std::to_string(i + 1) + "
+"
+                           : inner_use + "OpBranch %merge" + n + "
+");
+  }
+  for (int i = depth - 1; i >= 0; --i) {
+    const std::string n = std::to_string(i);
+    text += "%merge" + n + " = OpLabel
+" +
+            (i > 0 ? "OpBranch %merge" + std::to_string(i - 1) + "
+"
+                   : outer_use + "OpReturn
+");
+  }
+  return text + "OpFunctionEnd
+";
+}
+
+TEST_F(ValidateSSA, DominateUsageInNestedSelectionGood) {
+  CompileSuccessfully(
+      GenerateNestedSelections(64, "%use = OpIAdd %uint %def %one\n", ""));
+  ASSERT_EQ(SPV_SUCCESS, ValidateInstructions());
+}
+
+TEST_F(ValidateSSA, DominateUsageAfterNestedSelectionBad) {
+  CompileSuccessfully(
+      GenerateNestedSelections(64, "", "%use = OpIAdd %uint %def %one\n"));
+  ASSERT_EQ(SPV_ERROR_INVALID_ID, ValidateInstructions());
+  EXPECT_THAT(getDiagnosticString(), HasSubstr("[%def] defined in block"));
+  EXPECT_THAT(getDiagnosticString(),
+              HasSubstr("does not dominate its use in block"));
+}
+
 // Since Int8 requires the Kernel capability, the signedness of int types may
 // not be "1".
 const std::string kHeader = R"(
@@ -134,6 +134,40 @@ TEST_F(ValidationState_HasAnyOfExtensions, MultiCapMask) {
   EXPECT_FALSE(state_.HasAnyOfExtensions(set2));
 }
 
+// A test of ValidationState_t::decorations_of_kind().
+using ValidationState_DecorationsOfKind = ValidationStateTest;
+
+TEST_F(ValidationState_DecorationsOfKind, IndexesRegisteredDecorations) {
+  EXPECT_TRUE(state_.decorations_of_kind(SpvDecorationBlock).empty());
+
+  state_.RegisterDecorationForId(5, Decoration(SpvDecorationBlock));
+  state_.RegisterDecorationForId(3, Decoration(SpvDecorationNonWritable));
+  state_.RegisterDecorationForId(3, Decoration(SpvDecorationBlock));
+  // A decoration registered again is not indexed again.
+  state_.RegisterDecorationForId(5, Decoration(SpvDecorationBlock));
+  const std::vector<Decoration> member_decorations = {
+      Decoration(SpvDecorationOffset, {4}),
+      Decoration(SpvDecorationNonWritable)};
+  state_.RegisterDecorationsForStructMember(
+      5, 1, member_decorations.begin(), member_decorations.end());
+
+  const auto& blocks = state_.decorations_of_kind(SpvDecorationBlock);
+  ASSERT_EQ(2u, blocks.size());
+  EXPECT_EQ(5u, blocks[0].id);
+  EXPECT_EQ(3u, blocks[1].id);
+  EXPECT_EQ(SpvDecorationBlock, state_.decoration(blocks[1]).dec_type());
+
+  const auto refs = state_.decorations_of_kinds(
+      {SpvDecorationOffset, SpvDecorationNonWritable});
+  ASSERT_EQ(3u, refs.size());
+  EXPECT_EQ(3u, refs[0].id);
+  EXPECT_EQ(5u, refs[1].id);
+  EXPECT_EQ(SpvDecorationOffset, state_.decoration(refs[1]).dec_type());
+  EXPECT_EQ(1, state_.decoration(refs[1]).struct_member_index());
+  EXPECT_EQ(5u, refs[2].id);
+  EXPECT_EQ(SpvDecorationNonWritable, state_.decoration(refs[2]).dec_type());
+}
+
 }  // namespace
 }  // namespace val
 }  // namespace spvtools
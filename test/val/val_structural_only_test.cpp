@@ -0,0 +1,129 @@
+// Copyright (c) 2019 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// Tests for the validation of the structure of modules only.
+
+#include <string>
+
+#include "gmock/gmock.h"
+#include "test/val/val_fixtures.h"
+
+namespace spvtools {
+namespace val {
+namespace {
+
+using ::testing::HasSubstr;
+
+class ValidateStructuralOnly : public spvtest::ValidateBase<bool> {
+ protected:
+  // Returns the result of validating a module with the given |annotations|,
+  // extra |types| and |body| of a function returning void.  Only the
+  // structure of the module is checked if |structural_only| is true.
+  spv_result_t Validate(const std::string& annotations,
+                        const std::string& types, const std::string& body,
+                        bool structural_only) {
+    spvValidatorOptionsSetStructuralOnly(getValidatorOptions(),
+                                         structural_only);
+    CompileSuccessfully(R"(
+OpCapability Shader
+OpCapability Linkage
+OpMemoryModel Logical GLSL450
+)" + annotations + R"(
+%void = OpTypeVoid
+%fn = OpTypeFunction %void
+%float = OpTypeFloat 32
+%int = OpTypeInt 32 1
+%bool = OpTypeBool
+%true = OpConstantTrue %bool
+%float_1 = OpConstant %float 1
+%int_1 = OpConstant %int 1
+)" + types + R"(
+%func = OpFunction %void None %fn
+%entry = OpLabel
+)" + body + R"(
+OpFunctionEnd
+)");
+    return ValidateInstructions();
+  }
+};
+
+TEST_F(ValidateStructuralOnly, SkipsInstructionOperandRules) {
+  const std::string body = R"(
+%sum = OpIAdd %float %float_1 %float_1
+OpReturn
+)";
+  EXPECT_EQ(SPV_ERROR_INVALID_DATA, Validate("", "", body, false));
+  EXPECT_EQ(SPV_SUCCESS, Validate("", "", body, true));
+}
+
+TEST_F(ValidateStructuralOnly, SkipsDecorationRules) {
+  const std::string annotations = R"(
+OpDecorate %struct Block
+OpDecorate %struct BufferBlock
+)";
+  const std::string types = "%struct = OpTypeStruct %float\n";
+  EXPECT_EQ(SPV_ERROR_INVALID_ID,
+            Validate(annotations, types, "OpReturn\n", false));
+  EXPECT_THAT(getDiagnosticString(),
+              HasSubstr("decorated with both BufferBlock and Block"));
+  EXPECT_EQ(SPV_SUCCESS, Validate(annotations, types, "OpReturn\n", true));
+}
+
+TEST_F(ValidateStructuralOnly, ChecksIds) {
+  const std::string body = R"(
+%sum = OpFAdd %float %float_1 %undefined
+OpReturn
+)";
+  EXPECT_EQ(SPV_ERROR_INVALID_ID, Validate("", "", body, true));
+  EXPECT_THAT(getDiagnosticString(), HasSubstr("has not been defined"));
+}
+
+TEST_F(ValidateStructuralOnly, ChecksTypes) {
+  const std::string types = "%vec1 = OpTypeVector %float 1\n";
+  EXPECT_EQ(SPV_ERROR_INVALID_DATA, Validate("", types, "OpReturn\n", true));
+  EXPECT_THAT(getDiagnosticString(),
+              HasSubstr("Illegal number of components"));
+}
+
+TEST_F(ValidateStructuralOnly, ChecksControlFlow) {
+  const std::string body = R"(
+OpSelectionMerge %merge None
+OpBranchConditional %int_1 %merge %merge
+%merge = OpLabel
+OpReturn
+)";
+  EXPECT_EQ(SPV_ERROR_INVALID_ID, Validate("", "", body, true));
+  EXPECT_THAT(getDiagnosticString(),
+              HasSubstr("Condition operand for OpBranchConditional must be "
+                        "of boolean type"));
+}
+
+TEST_F(ValidateStructuralOnly, ChecksDominance) {
+  const std::string body = R"(
+OpSelectionMerge %merge None
+OpBranchConditional %true %then %merge
+%then = OpLabel
+%value = OpCopyObject %float %float_1
+OpBranch %merge
+%merge = OpLabel
+%use = OpFAdd %float %value %value
+OpReturn
+)";
+  EXPECT_EQ(SPV_ERROR_INVALID_ID, Validate("", "", body, true));
+  EXPECT_THAT(getDiagnosticString(), HasSubstr("not dominate its use"));
+}
+
+}  // namespace
+}  // namespace val
+}  // namespace spvtools
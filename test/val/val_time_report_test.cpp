@@ -0,0 +1,111 @@
+// Copyright (c) 2019 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// Tests for the time reports of the validator.
+
+#include <string>
+#include <vector>
+
+#include "gmock/gmock.h"
+#include "test/val/val_fixtures.h"
+
+namespace spvtools {
+namespace val {
+namespace {
+
+using ::testing::HasSubstr;
+using ::testing::Not;
+
+using ValidateTimeReport = spvtest::ValidateBase<bool>;
+
+const char kModule[] = R"(
+OpCapability Shader
+OpMemoryModel Logical GLSL450
+OpEntryPoint GLCompute %main "main"
+OpExecutionMode %main LocalSize 1 1 1
+%void = OpTypeVoid
+%fn = OpTypeFunction %void
+%float = OpTypeFloat 32
+%one = OpConstant %float 1
+%main = OpFunction %void None %fn
+%entry = OpLabel
+%sum = OpFAdd %float %one %one
+OpReturn
+OpFunctionEnd
+)";
+
+// Appends each report to the vector of strings at |user_data|.
+void CollectReport(void* user_data, const char* report) {
+  static_cast<std::vector<std::string>*>(user_data)->push_back(report);
+}
+
+TEST_F(ValidateTimeReport, ReportsPhasesAndChecks) {
+  std::vector<std::string> reports;
+  spvValidatorOptionsSetTimeReport(getValidatorOptions(), CollectReport,
+                                   &reports);
+  CompileSuccessfully(kModule);
+  EXPECT_EQ(SPV_SUCCESS, ValidateInstructions());
+  ASSERT_EQ(1u, reports.size());
+  const std::string& report = reports.front();
+  for (const char* phase :
+       {"\nparse ", "\ninstructions ", "\nopcodes ", "\ncfg ",
+        "\ndecorations ", "\nbuilt-ins ", "\nlimitations ", "\ntotal "}) {
+    EXPECT_THAT(report, HasSubstr(phase));
+  }
+  for (const char* check : {"\n  Id ", "\n  ModuleLayout ", "\n  Image ",
+                            "\n  Arithmetics ", "\n  SmallTypeUses "}) {
+    EXPECT_THAT(report, HasSubstr(check));
+  }
+}
+
+TEST_F(ValidateTimeReport, ReportsStructuralChecksOnly) {
+  std::vector<std::string> reports;
+  spvValidatorOptionsSetTimeReport(getValidatorOptions(), CollectReport,
+                                   &reports);
+  spvValidatorOptionsSetStructuralOnly(getValidatorOptions(), true);
+  CompileSuccessfully(kModule);
+  EXPECT_EQ(SPV_SUCCESS, ValidateInstructions());
+  ASSERT_EQ(1u, reports.size());
+  EXPECT_THAT(reports.front(), HasSubstr("\n  ControlFlow "));
+  EXPECT_THAT(reports.front(), Not(HasSubstr("\n  Arithmetics ")));
+  EXPECT_THAT(reports.front(), Not(HasSubstr("\ndecorations ")));
+}
+
+TEST_F(ValidateTimeReport, ReportsPhasesUpToFailure) {
+  std::vector<std::string> reports;
+  spvValidatorOptionsSetTimeReport(getValidatorOptions(), CollectReport,
+                                   &reports);
+  std::string module = kModule;
+  module.replace(module.find("OpFAdd"), 6, "OpIAdd");
+  CompileSuccessfully(module);
+  EXPECT_EQ(SPV_ERROR_INVALID_DATA, ValidateInstructions());
+  ASSERT_EQ(1u, reports.size());
+  EXPECT_THAT(reports.front(), HasSubstr("\nopcodes "));
+  EXPECT_THAT(reports.front(), Not(HasSubstr("\ncfg ")));
+  EXPECT_THAT(reports.front(), HasSubstr("\ntotal "));
+}
+
+TEST_F(ValidateTimeReport, NullCallbackTurnsReportsOff) {
+  std::vector<std::string> reports;
+  spvValidatorOptionsSetTimeReport(getValidatorOptions(), CollectReport,
+                                   &reports);
+  spvValidatorOptionsSetTimeReport(getValidatorOptions(), nullptr, nullptr);
+  CompileSuccessfully(kModule);
+  EXPECT_EQ(SPV_SUCCESS, ValidateInstructions());
+  EXPECT_TRUE(reports.empty());
+}
+
+}  // namespace
+}  // namespace val
+}  // namespace spvtools
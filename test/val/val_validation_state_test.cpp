@@ -14,6 +14,7 @@
 
 // Basic tests for the ValidationState_t datastructure.
 
+#include <set>
 #include <string>
 
 #include "gmock/gmock.h"
@@ -184,6 +185,50 @@ TEST_F(ValidationStateTest, CheckEntryPoints) {
             vstate_->FindDef(vstate_->entry_points()[0])->opcode());
 }
 
+// Tests that the execution models of a function in ValidationState are those
+// of all the entry points calling it.
+TEST_F(ValidationStateTest, CheckFunctionExecutionModels) {
+  std::string spirv = std::string(kHeader) + R"(
+OpEntryPoint Vertex %vert "vert"
+OpEntryPoint Fragment %frag "frag"
+OpExecutionMode %frag OriginUpperLeft
+%void = OpTypeVoid
+%void_f = OpTypeFunction %void
+%helper = OpFunction %void None %void_f
+%helper_label = OpLabel
+OpReturn
+OpFunctionEnd
+%vert = OpFunction %void None %void_f
+%vert_label = OpLabel
+%vert_call = OpFunctionCall %void %helper
+OpReturn
+OpFunctionEnd
+%frag = OpFunction %void None %void_f
+%frag_label = OpLabel
+%frag_call = OpFunctionCall %void %helper
+OpReturn
+OpFunctionEnd
+%unused = OpFunction %void None %void_f
+%unused_label = OpLabel
+OpReturn
+OpFunctionEnd
+)";
+  CompileSuccessfully(spirv);
+  EXPECT_EQ(SPV_SUCCESS, ValidateAndRetrieveValidationState());
+  const uint32_t vert = vstate_->entry_points()[0];
+  const uint32_t frag = vstate_->entry_points()[1];
+  const uint32_t helper = vstate_->functions()[0].id();
+  const uint32_t unused = vstate_->functions()[3].id();
+  EXPECT_EQ(std::set<SpvExecutionModel>({SpvExecutionModelVertex}),
+            vstate_->FunctionExecutionModels(vert));
+  EXPECT_EQ(std::set<SpvExecutionModel>({SpvExecutionModelFragment}),
+            vstate_->FunctionExecutionModels(frag));
+  EXPECT_EQ(std::set<SpvExecutionModel>(
+                {SpvExecutionModelVertex, SpvExecutionModelFragment}),
+            vstate_->FunctionExecutionModels(helper));
+  EXPECT_TRUE(vstate_->FunctionExecutionModels(unused).empty());
+}
+
 TEST_F(ValidationStateTest, CheckStructMemberLimitOption) {
   spvValidatorOptionsSetUniversalLimit(
       options_, spv_validator_limit_max_struct_members, 32000u);
@@ -294,6 +339,22 @@ TEST_F(ValidationStateTest, CheckVulkanIndirectlyRecursiveBodyBad) {
                         " %1 = OpFunction %void Pure|Const %3\n"));
 }
 
+TEST_F(ValidationStateTest, CheckRecursiveEntryPoints) {
+  CompileSuccessfully(std::string(kHeader) + kNonRecursiveBody);
+  EXPECT_EQ(SPV_SUCCESS, ValidateAndRetrieveValidationState());
+  EXPECT_TRUE(vstate_->recursive_entry_points().empty());
+
+  CompileSuccessfully(std::string(kHeader) + kDirectlyRecursiveBody);
+  EXPECT_EQ(SPV_SUCCESS, ValidateAndRetrieveValidationState());
+  EXPECT_EQ(std::set<uint32_t>({vstate_->entry_points()[0]}),
+            vstate_->recursive_entry_points());
+
+  CompileSuccessfully(std::string(kHeader) + kIndirectlyRecursiveBody);
+  EXPECT_EQ(SPV_SUCCESS, ValidateAndRetrieveValidationState());
+  EXPECT_EQ(std::set<uint32_t>({vstate_->entry_points()[0]}),
+            vstate_->recursive_entry_points());
+}
+
 // Indirectly recursive functions are caught by the function definition layout
 // rules, because they cause a situation where there are 2 functions that have
 // to be before each other, and layout is checked earlier.
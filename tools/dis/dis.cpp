@@ -18,6 +18,7 @@
 #endif
 
 #include <cstdio>
+#include <cstdlib>
 #include <cstring>
 #include <string>
 #include <vector>
@@ -56,12 +57,64 @@ Options:
   --raw-id        Show raw Id values instead of friendly names.
 
   --offsets       Show byte offsets for each instruction.
+
+  --parallel      Format functions on multiple threads.
+
+  --function <id> Only disassemble the function with the given result Id,
+                  without reading the other functions of the binary.
+  --index         With --function, find the function with the index saved
+                  in <filename>.idx, building and saving it if the file
+                  does not hold the index of the binary.
 )",
       argv0, argv0);
 }
 
 static const auto kDefaultEnvironment = SPV_ENV_UNIVERSAL_1_5;
 
+// Writes disassembled text to the FILE* given as |user_data|.
+static spv_result_t WriteText(void* user_data, const char* text,
+                              size_t length) {
+  FILE* fp = static_cast<FILE*>(user_data);
+  if (fwrite(text, 1, length, fp) != length) return SPV_ERROR_INTERNAL;
+  return SPV_SUCCESS;
+}
+
+// Returns the index of |words|.  If |index_file| is not null, the index is
+// loaded from it, or else built and saved to it.  Returns null on failure.
+static spv_binary_index GetIndex(spv_const_context context,
+                                 const std::vector<uint32_t>& words,
+                                 const char* index_file,
+                                 spv_diagnostic* diagnostic) {
+  spv_binary_index index = nullptr;
+  std::vector<uint32_t> saved;
+  // Check that the file exists first, since ReadFile reports missing files.
+  if (index_file) {
+    if (FILE* fp = fopen(index_file, "rb")) {
+      fclose(fp);
+      if (ReadFile<uint32_t>(index_file, "rb", &saved) &&
+          spvBinaryIndexLoad(context, saved.data(), saved.size(), words.data(),
+                             words.size(), &index, nullptr) == SPV_SUCCESS) {
+        return index;
+      }
+    }
+  }
+
+  if (spvBinaryIndexBuild(context, words.data(), words.size(), &index,
+                          diagnostic) != SPV_SUCCESS) {
+    return nullptr;
+  }
+  spv_binary index_words = nullptr;
+  if (index_file && spvBinaryIndexSave(index, &index_words) == SPV_SUCCESS) {
+    if (!WriteFile<uint32_t>(index_file, "wb", index_words->code,
+                             index_words->wordCount)) {
+      fprintf(stderr, "warning: could not write the index to '%s'\n",
+              index_file);
+    }
+    spvBinaryDestroy(index_words);
+  }
+  return index;
+}
+
 int main(int argc, char** argv) {
   const char* inFile = nullptr;
   const char* outFile = nullptr;
@@ -79,6 +132,9 @@ int main(int argc, char** argv) {
   bool show_byte_offsets = false;
   bool no_header = false;
   bool friendly_names = true;
+  bool parallel = false;
+  uint32_t function_id = 0;
+  bool use_index_file = false;
 
   for (int argi = 1; argi < argc; ++argi) {
     if ('-' == argv[argi][0]) {
@@ -110,6 +166,19 @@ int main(int argc, char** argv) {
             no_header = true;
           } else if (0 == strcmp(argv[argi], "--raw-id")) {
             friendly_names = false;
+          } else if (0 == strcmp(argv[argi], "--parallel")) {
+            parallel = true;
+          } else if (0 == strcmp(argv[argi], "--function")) {
+            char* end = nullptr;
+            if (argi + 1 < argc) {
+              function_id = uint32_t(strtoul(argv[++argi], &end, 10));
+            }
+            if (!function_id || *end) {
+              print_usage(argv[0]);
+              return 1;
+            }
+          } else if (0 == strcmp(argv[argi], "--index")) {
+            use_index_file = true;
           } else if (0 == strcmp(argv[argi], "--help")) {
             print_usage(argv[0]);
             return 0;
@@ -156,6 +225,8 @@ int main(int argc, char** argv) {
 
   if (friendly_names) options |= SPV_BINARY_TO_TEXT_OPTION_FRIENDLY_NAMES;
 
+  if (parallel) options |= SPV_BINARY_TO_TEXT_OPTION_PARALLEL;
+
   if (!outFile || (0 == strcmp("-", outFile))) {
     // Print to standard output.
     options |= SPV_BINARY_TO_TEXT_OPTION_PRINT;
@@ -171,6 +242,13 @@ int main(int argc, char** argv) {
     }
   }
 
+  const bool use_stdin = !inFile || (0 == strcmp("-", inFile));
+  if (use_index_file && (!function_id || use_stdin)) {
+    fprintf(stderr,
+            "error: --index requires --function and an input file\n");
+    return 1;
+  }
+
   // Read the input binary.
   std::vector<uint32_t> contents;
   if (!ReadFile<uint32_t>(inFile, "rb", &contents)) return 1;
@@ -180,30 +258,68 @@ int main(int argc, char** argv) {
   // controlled by modifying console objects synchronously while
   // outputting to the stream rather than by injecting escape codes
   // into the output stream.
-  // If the printing option is off, then save the text in memory, so
-  // it can be emitted later in this function.
+  // If the printing option is off, then stream the text to the output
+  // file as it is disassembled.
   const bool print_to_stdout = SPV_BINARY_TO_TEXT_OPTION_PRINT & options;
-  spv_text text = nullptr;
-  spv_text* textOrNull = print_to_stdout ? nullptr : &text;
+  FILE* fp = nullptr;
+  if (!print_to_stdout) {
+    fp = fopen(outFile, "w");
+    if (!fp) {
+      fprintf(stderr, "error: could not open file '%s'\n", outFile);
+      return 1;
+    }
+  }
   spv_diagnostic diagnostic = nullptr;
   spv_context context = spvContextCreate(kDefaultEnvironment);
-  spv_result_t error =
-      spvBinaryToText(context, contents.data(), contents.size(), options,
-                      textOrNull, &diagnostic);
+  spv_result_t error = SPV_SUCCESS;
+  if (function_id) {
+    // Only the global section and the function are decoded.
+    std::string index_file;
+    if (use_index_file) index_file = std::string(inFile) + ".idx";
+    spv_binary_index index = GetIndex(
+        context, contents, use_index_file ? index_file.c_str() : nullptr,
+        &diagnostic);
+    spv_binary_range_t range = {0, 0, 0};
+    for (size_t i = 0; i < spvBinaryIndexFunctionCount(index); ++i) {
+      spvBinaryIndexGetFunction(index, i, &range);
+      if (range.id == function_id) break;
+    }
+    if (!index) {
+      error = SPV_ERROR_INVALID_BINARY;
+    } else if (range.id != function_id) {
+      fprintf(stderr, "error: no function with Id %u\n", function_id);
+      error = SPV_ERROR_INVALID_LOOKUP;
+    } else {
+      spv_text text = nullptr;
+      error = spvBinaryToTextRange(context, contents.data(), contents.size(),
+                                   index, range.begin, range.end, options,
+                                   &text, &diagnostic);
+      if (!error && text) error = WriteText(fp, text->str, text->length);
+      spvTextDestroy(text);
+    }
+    spvBinaryIndexDestroy(index);
+  } else {
+    error = print_to_stdout
+                ? spvBinaryToText(context, contents.data(), contents.size(),
+                                  options, nullptr, &diagnostic)
+                : spvBinaryToTextStream(context, contents.data(),
+                                        contents.size(), options, fp,
+                                        WriteText, &diagnostic);
+  }
   spvContextDestroy(context);
-  if (error) {
-    spvDiagnosticPrint(diagnostic);
-    spvDiagnosticDestroy(diagnostic);
-    return error;
+  if (fp && fclose(fp) != 0 && !error) {
+    fprintf(stderr, "error: could not write to file '%s'\n", outFile);
+    return 1;
   }
-
-  if (!print_to_stdout) {
-    if (!WriteFile<char>(outFile, "w", text->str, text->length)) {
-      spvTextDestroy(text);
-      return 1;
+  if (error) {
+    if (diagnostic) {
+      spvDiagnosticPrint(diagnostic);
+      spvDiagnosticDestroy(diagnostic);
+    } else if (!print_to_stdout && error == SPV_ERROR_INTERNAL) {
+      fprintf(stderr, "error: could not write to file '%s'\n", outFile);
     }
+    return error;
   }
-  spvTextDestroy(text);
 
   return 0;
 }
@@ -12,11 +12,13 @@
 // See the License for the specific language governing permissions and
 // limitations under the License.
 
+#include <algorithm>
 #include <cassert>
 #include <cerrno>
 #include <cstring>
 #include <fstream>
 #include <functional>
+#include <memory>
 #include <random>
 #include <sstream>
 #include <string>
@@ -27,10 +29,13 @@
 #include "source/fuzz/protobufs/spirvfuzz_protobufs.h"
 #include "source/fuzz/replayer.h"
 #include "source/fuzz/shrinker.h"
+#include "source/fuzz/transformation_stream.h"
 #include "source/opt/build_module.h"
 #include "source/opt/ir_context.h"
 #include "source/opt/log.h"
 #include "source/spirv_fuzzer_options.h"
+#include "source/util/parallel.h"
+#include "source/util/profiler.h"
 #include "source/util/string_utils.h"
 #include "tools/io.h"
 #include "tools/util/cli_consumer.h"
@@ -57,6 +62,7 @@ bool ExecuteCommand(const std::string& command) {
 
 // Status and actions to perform after parsing command-line arguments.
 enum class FuzzActions {
+  CONVERT,  // Convert a sequence of transformations to another format.
   FORCE_RENDER_RED,  // Turn the shader into a form such that it is guaranteed
                      // to render a red image.
   FUZZ,    // Run the fuzzer to apply transformations in a randomized fashion.
@@ -78,8 +84,12 @@ void PrintUsage(const char* program) {
 
 USAGE: %s [options] <input.spv> -o <output.spv> \
   --donors=<donors.txt>
+USAGE: %s [options] <input.spv> -o <output.spv> \
+  --donors=<donors.txt> --num-seeds=<count>
 USAGE: %s [options] <input.spv> -o <output.spv> \
   --shrink=<input.transformations> -- <interestingness_test> [args...]
+USAGE: %s --convert-transformations=<input.transformations> \
+  -o <output.transformations_stream>
 
 The SPIR-V binary is read from <input.spv>.  If <input.facts> is also present,
 facts about the SPIR-V binary are read from this file.
@@ -88,6 +98,11 @@ The transformed SPIR-V binary is written to <output.spv>.  Human-readable and
 binary representations of the transformations that were applied are written to
 <output.transformations_json> and <output.transformations>, respectively.
 
+When passing --num-seeds=<count>, the binary is fuzzed with <count> consecutive
+seeds, concurrently, starting from the seed given by --seed.  The results for
+seed <n> are written to <output_n.spv>, <output_n.transformations_json> and
+<output_n.transformations> as soon as they are ready.
+
 When passing --shrink=<input.transformations> an <interestingness_test>
 must also be provided; this is the path to a script that returns 0 if and only
 if a given SPIR-V binary is interesting.  The SPIR-V binary will be passed to
@@ -96,12 +111,22 @@ the script as an argument after any other provided arguments [args...].  The
 positional arguments and thus will be forwarded to the interestingness script,
 and not parsed by %s.
 
+A sequence of transformations is read from or written to a file in a format
+given by its extension: a protobuf message for .transformations, JSON for
+.transformations_json, and a transformation stream for .transformations_stream.
+A transformation stream is a compact binary format that is replayed as it is
+read, one transformation at a time, rather than being loaded as a whole first.
+
 NOTE: The fuzzer is a work in progress.
 
 Options (in lexicographical order):
 
   -h, --help
                Print this help.
+  --convert-transformations=
+               File from which to read a sequence of transformations to write
+               to the file given by -o, in the format of its extension.  No
+               other arguments may be used.
   --donors=
                File specifying a series of donor files, one per line.  Must be
                provided if the tool is invoked in fuzzing mode; incompatible
@@ -118,6 +143,15 @@ Options (in lexicographical order):
                Run the validator after applying each fuzzer pass during
                fuzzing.  Aborts fuzzing early if an invalid binary is created.
                Useful for debugging spirv-fuzz.
+  --num-seeds=
+               Unsigned 32-bit integer specifying a number of consecutive
+               seeds to fuzz the input binary with, in one run of the tool.
+               The input binary and the donors are only read once.  Only valid
+               in fuzzing mode.
+  --num-threads=
+               Unsigned 32-bit integer specifying the number of seeds fuzzed
+               at the same time.  The default of 0 means one per hardware
+               thread.  Ignored unless --num-seeds is used.
   --replay
                File from which to read a sequence of transformations to replay
                (instead of fuzzing)
@@ -127,6 +161,17 @@ Options (in lexicographical order):
   --shrink=
                File from which to read a sequence of transformations to shrink
                (instead of fuzzing)
+  --shrinker-parallel
+               Try removing several chunks of transformations concurrently,
+               on one thread per hardware thread.  The interestingness test is
+               then run on several temporary files at once.  The result is
+               the same as on one thread.  Ignored unless --shrink is used.
+  --shrinker-statistics=
+               Specifies a file to write statistics of the shrinking to, as
+               JSON: for each chunk size, the removals of chunks tried and
+               those that were interesting, the bytes they removed, and the
+               time spent replaying and testing them.  Ignored unless
+               --shrink is used.
   --shrinker-step-limit=
                Unsigned 32-bit integer specifying maximum number of steps the
                shrinker will take before giving up.  Ignored unless --shrink
@@ -146,7 +191,7 @@ Options (in lexicographical order):
                Display fuzzer version information.
 
 )",
-      program, program, program, program);
+      program, program, program, program, program, program);
 }
 
 // Message consumer for this tool.  Used to emit diagnostics during
@@ -161,11 +206,15 @@ void FuzzDiagnostic(spv_message_level_t level, const char* /*source*/,
 }
 
 FuzzStatus ParseFlags(int argc, const char** argv, std::string* in_binary_file,
-                      std::string* out_binary_file, std::string* donors_file,
+                      std::string* out_binary_file,
+                      std::string* convert_transformations_file,
+                      std::string* donors_file,
                       std::string* replay_transformations_file,
                       std::vector<std::string>* interestingness_test,
                       std::string* shrink_transformations_file,
                       std::string* shrink_temp_file_prefix,
+                      std::string* shrink_statistics_file,
+                      uint32_t* num_seeds, uint32_t* num_threads,
                       spvtools::FuzzerOptions* fuzzer_options) {
   uint32_t positional_arg_index = 0;
   bool only_positional_arguments_remain = false;
@@ -188,6 +237,10 @@ FuzzStatus ParseFlags(int argc, const char** argv, std::string* in_binary_file,
           PrintUsage(argv[0]);
           return {FuzzActions::STOP, 1};
         }
+      } else if (0 == strncmp(cur_arg, "--convert-transformations=",
+                              sizeof("--convert-transformations=") - 1)) {
+        const auto split_flag = spvtools::utils::SplitFlagArgs(cur_arg);
+        *convert_transformations_file = std::string(split_flag.second);
       } else if (0 == strncmp(cur_arg, "--donors=", sizeof("--donors=") - 1)) {
         const auto split_flag = spvtools::utils::SplitFlagArgs(cur_arg);
         *donors_file = std::string(split_flag.second);
@@ -197,6 +250,22 @@ FuzzStatus ParseFlags(int argc, const char** argv, std::string* in_binary_file,
       } else if (0 == strncmp(cur_arg, "--fuzzer-pass-validation",
                               sizeof("--fuzzer-pass-validation") - 1)) {
         fuzzer_options->enable_fuzzer_pass_validation();
+      } else if (0 == strncmp(cur_arg, "--num-seeds=",
+                              sizeof("--num-seeds=") - 1)) {
+        const auto split_flag = spvtools::utils::SplitFlagArgs(cur_arg);
+        char* end = nullptr;
+        errno = 0;
+        *num_seeds =
+            static_cast<uint32_t>(strtol(split_flag.second.c_str(), &end, 10));
+        assert(end != split_flag.second.c_str() && errno == 0);
+      } else if (0 == strncmp(cur_arg, "--num-threads=",
+                              sizeof("--num-threads=") - 1)) {
+        const auto split_flag = spvtools::utils::SplitFlagArgs(cur_arg);
+        char* end = nullptr;
+        errno = 0;
+        *num_threads =
+            static_cast<uint32_t>(strtol(split_flag.second.c_str(), &end, 10));
+        assert(end != split_flag.second.c_str() && errno == 0);
       } else if (0 == strncmp(cur_arg, "--replay=", sizeof("--replay=") - 1)) {
         const auto split_flag = spvtools::utils::SplitFlagArgs(cur_arg);
         *replay_transformations_file = std::string(split_flag.second);
@@ -214,6 +283,8 @@ FuzzStatus ParseFlags(int argc, const char** argv, std::string* in_binary_file,
             static_cast<uint32_t>(strtol(split_flag.second.c_str(), &end, 10));
         assert(end != split_flag.second.c_str() && errno == 0);
         fuzzer_options->set_random_seed(seed);
+      } else if (0 == strcmp(cur_arg, "--shrinker-parallel")) {
+        fuzzer_options->set_shrinker_num_threads(0);
       } else if (0 == strncmp(cur_arg, "--shrinker-step-limit=",
                               sizeof("--shrinker-step-limit=") - 1)) {
         const auto split_flag = spvtools::utils::SplitFlagArgs(cur_arg);
@@ -223,6 +294,10 @@ FuzzStatus ParseFlags(int argc, const char** argv, std::string* in_binary_file,
             static_cast<uint32_t>(strtol(split_flag.second.c_str(), &end, 10));
         assert(end != split_flag.second.c_str() && errno == 0);
         fuzzer_options->set_shrinker_step_limit(step_limit);
+      } else if (0 == strncmp(cur_arg, "--shrinker-statistics=",
+                              sizeof("--shrinker-statistics=") - 1)) {
+        const auto split_flag = spvtools::utils::SplitFlagArgs(cur_arg);
+        *shrink_statistics_file = std::string(split_flag.second);
       } else if (0 == strncmp(cur_arg, "--shrinker-temp-file-prefix=",
                               sizeof("--shrinker-temp-file-prefix=") - 1)) {
         const auto split_flag = spvtools::utils::SplitFlagArgs(cur_arg);
@@ -246,6 +321,17 @@ FuzzStatus ParseFlags(int argc, const char** argv, std::string* in_binary_file,
     }
   }
 
+  if (!convert_transformations_file->empty()) {
+    // Only the program name, the flag, -o and the output file are expected.
+    if (argc != 4 || out_binary_file->empty()) {
+      spvtools::Error(FuzzDiagnostic, nullptr, {},
+                      "The --convert-transformations argument can only be "
+                      "used with -o.");
+      return {FuzzActions::STOP, 1};
+    }
+    return {FuzzActions::CONVERT, 0};
+  }
+
   if (in_binary_file->empty()) {
     spvtools::Error(FuzzDiagnostic, nullptr, {}, "No input file specified");
     return {FuzzActions::STOP, 1};
@@ -258,6 +344,14 @@ FuzzStatus ParseFlags(int argc, const char** argv, std::string* in_binary_file,
 
   auto const_fuzzer_options =
       static_cast<spv_const_fuzzer_options>(*fuzzer_options);
+  if (*num_seeds > 0 && (force_render_red ||
+                         !replay_transformations_file->empty() ||
+                         !shrink_transformations_file->empty())) {
+    spvtools::Error(FuzzDiagnostic, nullptr, {},
+                    "The --num-seeds argument can only be used when fuzzing.");
+    return {FuzzActions::STOP, 1};
+  }
+
   if (force_render_red) {
     if (!replay_transformations_file->empty() ||
         !shrink_transformations_file->empty() ||
@@ -336,14 +430,42 @@ FuzzStatus ParseFlags(int argc, const char** argv, std::string* in_binary_file,
   return {FuzzActions::FUZZ, 0};
 }
 
+// Returns true if |file| has the extension |extension|.
+bool HasExtension(const std::string& file, const std::string& extension) {
+  return file.size() >= extension.size() &&
+         file.compare(file.size() - extension.size(), extension.size(),
+                      extension) == 0;
+}
+
+// Returns true if |transformations_file| holds a transformation stream.
+bool IsTransformationStreamFile(const std::string& transformations_file) {
+  return HasExtension(transformations_file, ".transformations_stream");
+}
+
+// Reads |transformations| from |transformations_file|, in the format given by
+// its extension.
 bool ParseTransformations(
     const std::string& transformations_file,
     spvtools::fuzz::protobufs::TransformationSequence* transformations) {
   std::ifstream transformations_stream;
-  transformations_stream.open(transformations_file,
-                              std::ios::in | std::ios::binary);
-  auto parse_success =
-      transformations->ParseFromIstream(&transformations_stream);
+  bool parse_success;
+  if (HasExtension(transformations_file, ".transformations_json")) {
+    transformations_stream.open(transformations_file);
+    std::string json_string(
+        (std::istreambuf_iterator<char>(transformations_stream)),
+        std::istreambuf_iterator<char>());
+    parse_success = google::protobuf::util::Status::OK ==
+                    google::protobuf::util::JsonStringToMessage(
+                        json_string, transformations);
+  } else {
+    transformations_stream.open(transformations_file,
+                                std::ios::in | std::ios::binary);
+    parse_success =
+        IsTransformationStreamFile(transformations_file)
+            ? spvtools::fuzz::ReadTransformationsFromStream(
+                  &transformations_stream, transformations)
+            : transformations->ParseFromIstream(&transformations_stream);
+  }
   transformations_stream.close();
   if (!parse_success) {
     spvtools::Error(FuzzDiagnostic, nullptr, {},
@@ -355,6 +477,46 @@ bool ParseTransformations(
   return true;
 }
 
+// Writes |transformations| to |transformations_file|, in the format given by
+// its extension.
+bool WriteTransformations(
+    const std::string& transformations_file,
+    const spvtools::fuzz::protobufs::TransformationSequence& transformations) {
+  bool success;
+  if (HasExtension(transformations_file, ".transformations_json")) {
+    std::string json_string;
+    auto json_options = google::protobuf::util::JsonOptions();
+    json_options.add_whitespace = true;
+    success = google::protobuf::util::MessageToJsonString(
+                  transformations, &json_string, json_options) ==
+              google::protobuf::util::Status::OK;
+    if (success) {
+      std::ofstream transformations_json_file(transformations_file);
+      transformations_json_file << json_string;
+      transformations_json_file.close();
+      success = !transformations_json_file.fail();
+    }
+  } else {
+    std::ofstream transformations_stream;
+    transformations_stream.open(transformations_file,
+                                std::ios::out | std::ios::binary);
+    success = IsTransformationStreamFile(transformations_file)
+                  ? spvtools::fuzz::WriteTransformationsToStream(
+                        transformations, &transformations_stream)
+                  : transformations.SerializeToOstream(&transformations_stream);
+    transformations_stream.close();
+    success = success && !transformations_stream.fail();
+  }
+  if (!success) {
+    spvtools::Error(FuzzDiagnostic, nullptr, {},
+                    ("Error writing transformations to file '" +
+                     transformations_file + "'")
+                        .c_str());
+    return false;
+  }
+  return true;
+}
+
 bool Replay(const spv_target_env& target_env,
             spv_const_fuzzer_options fuzzer_options,
             const std::vector<uint32_t>& binary_in,
@@ -363,17 +525,35 @@ bool Replay(const spv_target_env& target_env,
             std::vector<uint32_t>* binary_out,
             spvtools::fuzz::protobufs::TransformationSequence*
                 transformations_applied) {
-  spvtools::fuzz::protobufs::TransformationSequence transformation_sequence;
-  if (!ParseTransformations(replay_transformations_file,
-                            &transformation_sequence)) {
-    return false;
-  }
   spvtools::fuzz::Replayer replayer(target_env,
                                     fuzzer_options->replay_validation_enabled);
   replayer.SetMessageConsumer(spvtools::utils::CLIMessageConsumer);
-  auto replay_result_status =
-      replayer.Run(binary_in, initial_facts, transformation_sequence,
-                   binary_out, transformations_applied);
+  spvtools::fuzz::Replayer::ReplayerResultStatus replay_result_status;
+  if (IsTransformationStreamFile(replay_transformations_file)) {
+    // The transformations are replayed as they are read.
+    std::ifstream transformations_stream(replay_transformations_file,
+                                         std::ios::in | std::ios::binary);
+    if (!transformations_stream) {
+      spvtools::Error(FuzzDiagnostic, nullptr, {},
+                      ("Error opening transformations file '" +
+                       replay_transformations_file + "'")
+                          .c_str());
+      return false;
+    }
+    spvtools::fuzz::TransformationStreamReader reader(&transformations_stream);
+    replay_result_status =
+        replayer.RunFromStream(binary_in, initial_facts, &reader, binary_out,
+                               transformations_applied);
+  } else {
+    spvtools::fuzz::protobufs::TransformationSequence transformation_sequence;
+    if (!ParseTransformations(replay_transformations_file,
+                              &transformation_sequence)) {
+      return false;
+    }
+    replay_result_status =
+        replayer.Run(binary_in, initial_facts, transformation_sequence,
+                     binary_out, transformations_applied);
+  }
   return !(replay_result_status !=
            spvtools::fuzz::Replayer::ReplayerResultStatus::kComplete);
 }
@@ -384,6 +564,7 @@ bool Shrink(const spv_target_env& target_env,
             const spvtools::fuzz::protobufs::FactSequence& initial_facts,
             const std::string& shrink_transformations_file,
             const std::string& shrink_temp_file_prefix,
+            const std::string& shrink_statistics_file,
             const std::vector<std::string>& interestingness_command,
             std::vector<uint32_t>* binary_out,
             spvtools::fuzz::protobufs::TransformationSequence*
@@ -393,10 +574,13 @@ bool Shrink(const spv_target_env& target_env,
                             &transformation_sequence)) {
     return false;
   }
-  spvtools::fuzz::Shrinker shrinker(target_env,
-                                    fuzzer_options->shrinker_step_limit,
-                                    fuzzer_options->replay_validation_enabled);
+  spvtools::fuzz::Shrinker shrinker(
+      target_env, fuzzer_options->shrinker_step_limit,
+      fuzzer_options->replay_validation_enabled,
+      fuzzer_options->shrinker_num_threads);
   shrinker.SetMessageConsumer(spvtools::utils::CLIMessageConsumer);
+  spvtools::utils::StepStatistics statistics;
+  if (!shrink_statistics_file.empty()) shrinker.SetStatistics(&statistics);
 
   assert(!interestingness_command.empty() &&
          "An error should have been raised because the interestingness_command "
@@ -426,23 +610,32 @@ bool Shrink(const spv_target_env& target_env,
   auto shrink_result_status = shrinker.Run(
       binary_in, initial_facts, transformation_sequence,
       interestingness_function, binary_out, transformations_applied);
+  if (!shrink_statistics_file.empty()) {
+    std::ofstream statistics_out(shrink_statistics_file);
+    statistics.WriteJson(&statistics_out);
+    statistics_out.close();
+    if (statistics_out.fail()) {
+      spvtools::Error(FuzzDiagnostic, nullptr, {},
+                      "Error writing shrinker statistics");
+      return false;
+    }
+  }
   return spvtools::fuzz::Shrinker::ShrinkerResultStatus::kComplete ==
              shrink_result_status ||
          spvtools::fuzz::Shrinker::ShrinkerResultStatus::kStepLimitReached ==
              shrink_result_status;
 }
 
-bool Fuzz(const spv_target_env& target_env,
-          spv_const_fuzzer_options fuzzer_options,
-          const std::vector<uint32_t>& binary_in,
-          const spvtools::fuzz::protobufs::FactSequence& initial_facts,
-          const std::string& donors, std::vector<uint32_t>* binary_out,
-          spvtools::fuzz::protobufs::TransformationSequence*
-              transformations_applied) {
+// Reads the names of the donor files, one per line, from the file |donors|,
+// and adds a supplier of the module of each donor to |donor_suppliers|.  If
+// |load_once| is true, the donor files are read now and each supplier builds
+// its module from memory; otherwise each supplier reads its file when called.
+bool GetDonorSuppliers(
+    const spv_target_env& target_env, const std::string& donors,
+    bool load_once,
+    std::vector<spvtools::fuzz::fuzzerutil::ModuleSupplier>* donor_suppliers) {
   auto message_consumer = spvtools::utils::CLIMessageConsumer;
 
-  std::vector<spvtools::fuzz::fuzzerutil::ModuleSupplier> donor_suppliers;
-
   std::ifstream donors_file(donors);
   if (!donors_file) {
     spvtools::Error(FuzzDiagnostic, nullptr, {}, "Error opening donors file");
@@ -450,7 +643,22 @@ bool Fuzz(const spv_target_env& target_env,
   }
   std::string donor_filename;
   while (std::getline(donors_file, donor_filename)) {
-    donor_suppliers.emplace_back(
+    if (load_once) {
+      auto donor_binary = std::make_shared<std::vector<uint32_t>>();
+      if (!ReadFile<uint32_t>(donor_filename.c_str(), "rb",
+                              donor_binary.get())) {
+        return false;
+      }
+      donor_suppliers->emplace_back(
+          [donor_binary, message_consumer,
+           target_env]() -> std::unique_ptr<spvtools::opt::IRContext> {
+            return spvtools::BuildModule(target_env, message_consumer,
+                                         donor_binary->data(),
+                                         donor_binary->size());
+          });
+      continue;
+    }
+    donor_suppliers->emplace_back(
         [donor_filename, message_consumer,
          target_env]() -> std::unique_ptr<spvtools::opt::IRContext> {
           std::vector<uint32_t> donor_binary;
@@ -463,14 +671,22 @@ bool Fuzz(const spv_target_env& target_env,
                                        donor_binary.size());
         });
   }
+  return true;
+}
 
-  spvtools::fuzz::Fuzzer fuzzer(
-      target_env,
-      fuzzer_options->has_random_seed
-          ? fuzzer_options->random_seed
-          : static_cast<uint32_t>(std::random_device()()),
-      fuzzer_options->fuzzer_pass_validation_enabled);
-  fuzzer.SetMessageConsumer(message_consumer);
+// Fuzzes |binary_in| with |seed| and the donors of |donor_suppliers|.
+bool RunFuzzer(
+    const spv_target_env& target_env, spv_const_fuzzer_options fuzzer_options,
+    uint32_t seed, const std::vector<uint32_t>& binary_in,
+    const spvtools::fuzz::protobufs::FactSequence& initial_facts,
+    const std::vector<spvtools::fuzz::fuzzerutil::ModuleSupplier>&
+        donor_suppliers,
+    std::vector<uint32_t>* binary_out,
+    spvtools::fuzz::protobufs::TransformationSequence*
+        transformations_applied) {
+  spvtools::fuzz::Fuzzer fuzzer(target_env, seed,
+                                fuzzer_options->fuzzer_pass_validation_enabled);
+  fuzzer.SetMessageConsumer(spvtools::utils::CLIMessageConsumer);
   auto fuzz_result_status =
       fuzzer.Run(binary_in, initial_facts, donor_suppliers, binary_out,
                  transformations_applied);
@@ -482,6 +698,103 @@ bool Fuzz(const spv_target_env& target_env,
   return true;
 }
 
+bool Fuzz(const spv_target_env& target_env,
+          spv_const_fuzzer_options fuzzer_options,
+          const std::vector<uint32_t>& binary_in,
+          const spvtools::fuzz::protobufs::FactSequence& initial_facts,
+          const std::string& donors, std::vector<uint32_t>* binary_out,
+          spvtools::fuzz::protobufs::TransformationSequence*
+              transformations_applied) {
+  std::vector<spvtools::fuzz::fuzzerutil::ModuleSupplier> donor_suppliers;
+  if (!GetDonorSuppliers(target_env, donors, false, &donor_suppliers)) {
+    return false;
+  }
+
+  return RunFuzzer(target_env, fuzzer_options,
+                   fuzzer_options->has_random_seed
+                       ? fuzzer_options->random_seed
+                       : static_cast<uint32_t>(std::random_device()()),
+                   binary_in, initial_facts, donor_suppliers, binary_out,
+                   transformations_applied);
+}
+
+// Writes |binary_out| to |out_binary_file|, and, if |transformations_applied|
+// is not null, the transformations in binary and JSON form to files named
+// after it.
+bool WriteOutputs(const std::string& out_binary_file,
+                  const std::vector<uint32_t>& binary_out,
+                  const spvtools::fuzz::protobufs::TransformationSequence*
+                      transformations_applied) {
+  if (!WriteFile<uint32_t>(out_binary_file.c_str(), "wb", binary_out.data(),
+                           binary_out.size())) {
+    spvtools::Error(FuzzDiagnostic, nullptr, {}, "Error writing out binary");
+    return false;
+  }
+
+  if (transformations_applied) {
+    // If not found, dot_pos will be std::string::npos, which can be used in
+    // substr to mean "the end of the string"; there is no need to check the
+    // result.
+    size_t dot_pos = out_binary_file.rfind('.');
+    std::string output_file_prefix = out_binary_file.substr(0, dot_pos);
+    if (!WriteTransformations(output_file_prefix + ".transformations",
+                              *transformations_applied) ||
+        !WriteTransformations(output_file_prefix + ".transformations_json",
+                              *transformations_applied)) {
+      return false;
+    }
+  }
+  return true;
+}
+
+// Fuzzes |binary_in| with |num_seeds| consecutive seeds, |num_threads| seeds
+// at a time, reading the donors only once.  The outputs for each seed are
+// written as soon as they are ready, to |out_binary_file| with the seed added
+// before its extension.  Returns true if fuzzing succeeded for every seed.
+bool FuzzBatch(const spv_target_env& target_env,
+               spv_const_fuzzer_options fuzzer_options,
+               const std::vector<uint32_t>& binary_in,
+               const spvtools::fuzz::protobufs::FactSequence& initial_facts,
+               const std::string& donors, const std::string& out_binary_file,
+               uint32_t num_seeds, uint32_t num_threads) {
+  std::vector<spvtools::fuzz::fuzzerutil::ModuleSupplier> donor_suppliers;
+  if (!GetDonorSuppliers(target_env, donors, true, &donor_suppliers)) {
+    return false;
+  }
+
+  const uint32_t first_seed =
+      fuzzer_options->has_random_seed
+          ? fuzzer_options->random_seed
+          : static_cast<uint32_t>(std::random_device()());
+  // If not found, dot_pos will be std::string::npos, which can be used in
+  // substr to mean "the end of the string"; there is no need to check the
+  // result.
+  const size_t dot_pos = out_binary_file.rfind('.');
+  const std::string output_file_prefix = out_binary_file.substr(0, dot_pos);
+  const std::string output_file_extension =
+      dot_pos == std::string::npos ? "" : out_binary_file.substr(dot_pos);
+
+  std::vector<char> succeeded(num_seeds, 0);
+  spvtools::utils::ParallelFor(
+      num_seeds, num_threads,
+      [target_env, fuzzer_options, &binary_in, &initial_facts,
+       &donor_suppliers, first_seed, &output_file_prefix,
+       &output_file_extension, &succeeded](size_t i) {
+        const uint32_t seed = first_seed + static_cast<uint32_t>(i);
+        std::vector<uint32_t> binary_out;
+        spvtools::fuzz::protobufs::TransformationSequence
+            transformations_applied;
+        succeeded[i] =
+            RunFuzzer(target_env, fuzzer_options, seed, binary_in,
+                      initial_facts, donor_suppliers, &binary_out,
+                      &transformations_applied) &&
+            WriteOutputs(output_file_prefix + "_" + std::to_string(seed) +
+                             output_file_extension,
+                         binary_out, &transformations_applied);
+      });
+  return std::find(succeeded.begin(), succeeded.end(), 0) == succeeded.end();
+}
+
 }  // namespace
 
 // Dumps |binary| to file |filename|. Useful for interactive debugging.
@@ -506,23 +819,38 @@ const auto kDefaultEnvironment = SPV_ENV_UNIVERSAL_1_3;
 int main(int argc, const char** argv) {
   std::string in_binary_file;
   std::string out_binary_file;
+  std::string convert_transformations_file;
   std::string donors_file;
   std::string replay_transformations_file;
   std::vector<std::string> interestingness_test;
   std::string shrink_transformations_file;
   std::string shrink_temp_file_prefix = "temp_";
+  std::string shrink_statistics_file;
+  uint32_t num_seeds = 0;
+  uint32_t num_threads = 0;
 
   spvtools::FuzzerOptions fuzzer_options;
 
   FuzzStatus status = ParseFlags(
-      argc, argv, &in_binary_file, &out_binary_file, &donors_file,
+      argc, argv, &in_binary_file, &out_binary_file,
+      &convert_transformations_file, &donors_file,
       &replay_transformations_file, &interestingness_test,
-      &shrink_transformations_file, &shrink_temp_file_prefix, &fuzzer_options);
+      &shrink_transformations_file, &shrink_temp_file_prefix,
+      &shrink_statistics_file, &num_seeds, &num_threads, &fuzzer_options);
 
   if (status.action == FuzzActions::STOP) {
     return status.code;
   }
 
+  if (status.action == FuzzActions::CONVERT) {
+    spvtools::fuzz::protobufs::TransformationSequence transformations;
+    return ParseTransformations(convert_transformations_file,
+                                &transformations) &&
+                   WriteTransformations(out_binary_file, transformations)
+               ? 0
+               : 1;
+  }
+
   std::vector<uint32_t> binary_in;
   if (!ReadFile<uint32_t>(in_binary_file.c_str(), "rb", &binary_in)) {
     return 1;
@@ -561,6 +889,13 @@ int main(int argc, const char** argv) {
       }
       break;
     case FuzzActions::FUZZ:
+      if (num_seeds > 0) {
+        // Each seed writes its own outputs.
+        return FuzzBatch(target_env, fuzzer_options, binary_in, initial_facts,
+                         donors_file, out_binary_file, num_seeds, num_threads)
+                   ? 0
+                   : 1;
+      }
       if (!Fuzz(target_env, fuzzer_options, binary_in, initial_facts,
                 donors_file, &binary_out, &transformations_applied)) {
         return 1;
@@ -581,7 +916,7 @@ int main(int argc, const char** argv) {
       }
       if (!Shrink(target_env, fuzzer_options, binary_in, initial_facts,
                   shrink_transformations_file, shrink_temp_file_prefix,
-                  interestingness_test, &binary_out,
+                  shrink_statistics_file, interestingness_test, &binary_out,
                   &transformations_applied)) {
         return 1;
       }
@@ -591,46 +926,12 @@ int main(int argc, const char** argv) {
       break;
   }
 
-  if (!WriteFile<uint32_t>(out_binary_file.c_str(), "wb", binary_out.data(),
-                           binary_out.size())) {
-    spvtools::Error(FuzzDiagnostic, nullptr, {}, "Error writing out binary");
+  if (!WriteOutputs(out_binary_file, binary_out,
+                    status.action != FuzzActions::FORCE_RENDER_RED
+                        ? &transformations_applied
+                        : nullptr)) {
     return 1;
   }
 
-  if (status.action != FuzzActions::FORCE_RENDER_RED) {
-    // If not found, dot_pos will be std::string::npos, which can be used in
-    // substr to mean "the end of the string"; there is no need to check the
-    // result.
-    dot_pos = out_binary_file.rfind('.');
-    std::string output_file_prefix = out_binary_file.substr(0, dot_pos);
-    std::ofstream transformations_file;
-    transformations_file.open(output_file_prefix + ".transformations",
-                              std::ios::out | std::ios::binary);
-    bool success =
-        transformations_applied.SerializeToOstream(&transformations_file);
-    transformations_file.close();
-    if (!success) {
-      spvtools::Error(FuzzDiagnostic, nullptr, {},
-                      "Error writing out transformations binary");
-      return 1;
-    }
-
-    std::string json_string;
-    auto json_options = google::protobuf::util::JsonOptions();
-    json_options.add_whitespace = true;
-    auto json_generation_status = google::protobuf::util::MessageToJsonString(
-        transformations_applied, &json_string, json_options);
-    if (json_generation_status != google::protobuf::util::Status::OK) {
-      spvtools::Error(FuzzDiagnostic, nullptr, {},
-                      "Error writing out transformations in JSON format");
-      return 1;
-    }
-
-    std::ofstream transformations_json_file(output_file_prefix +
-                                            ".transformations_json");
-    transformations_json_file << json_string;
-    transformations_json_file.close();
-  }
-
   return 0;
 }
@@ -17,8 +17,24 @@
 
 #include <cstdint>
 #include <cstdio>
+#include <cstring>
 #include <vector>
 
+#if defined(_WIN32)
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN
+#endif
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
 // Appends the content from the file named as |filename| to |data|, assuming
 // each element in the file is of type |T|. The file is opened with the given
 // |mode|. If |filename| is nullptr or "-", reads from the standard input, but
@@ -58,6 +74,98 @@ bool ReadFile(const char* filename, const char* mode, std::vector<T>* data) {
   return true;
 }
 
+// The words of a SPIR-V binary file.  The file is mapped into memory rather
+// than copied when possible.  The standard input, and the files which cannot
+// be mapped, are read with ReadFile.
+class BinaryFile {
+ public:
+  BinaryFile() = default;
+  BinaryFile(const BinaryFile&) = delete;
+  BinaryFile& operator=(const BinaryFile&) = delete;
+  ~BinaryFile() { Unmap(); }
+
+  // Maps or reads the file named as |filename|, or the standard input if
+  // |filename| is nullptr or "-".  If any error occurs, writes error messages
+  // to standard error and returns false.
+  bool Open(const char* filename) {
+    Unmap();
+    contents_.clear();
+    const bool use_file = filename && strcmp("-", filename);
+    if (use_file && Map(filename)) return true;
+    if (!ReadFile<uint32_t>(filename, "rb", &contents_)) return false;
+    data_ = contents_.data();
+    size_ = contents_.size();
+    return true;
+  }
+
+  // Returns the words of the file.
+  const uint32_t* data() const { return data_; }
+
+  // Returns the number of words of the file.
+  size_t size() const { return size_; }
+
+ private:
+  // Maps the file named as |filename|.  Returns false if it cannot be mapped
+  // or its size is not a multiple of a word, leaving the error to ReadFile.
+  bool Map(const char* filename) {
+#if defined(_WIN32)
+    HANDLE file = CreateFileA(filename, GENERIC_READ, FILE_SHARE_READ, nullptr,
+                              OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+    if (file == INVALID_HANDLE_VALUE) return false;
+    LARGE_INTEGER file_size;
+    HANDLE mapping = nullptr;
+    void* view = nullptr;
+    if (GetFileSizeEx(file, &file_size) && file_size.QuadPart > 0 &&
+        file_size.QuadPart % sizeof(uint32_t) == 0) {
+      mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+      if (mapping) view = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+    }
+    if (mapping) CloseHandle(mapping);
+    CloseHandle(file);
+    if (!view) return false;
+    mapped_size_ = static_cast<size_t>(file_size.QuadPart);
+#else
+    const int fd = open(filename, O_RDONLY);
+    if (fd == -1) return false;
+    struct stat file_stat;
+    void* view = MAP_FAILED;
+    if (fstat(fd, &file_stat) == 0 && S_ISREG(file_stat.st_mode) &&
+        file_stat.st_size > 0 && file_stat.st_size % sizeof(uint32_t) == 0) {
+      view = mmap(nullptr, static_cast<size_t>(file_stat.st_size), PROT_READ,
+                  MAP_PRIVATE, fd, 0);
+    }
+    close(fd);
+    if (view == MAP_FAILED) return false;
+    mapped_size_ = static_cast<size_t>(file_stat.st_size);
+#endif
+    mapped_ = view;
+    data_ = static_cast<const uint32_t*>(view);
+    size_ = mapped_size_ / sizeof(uint32_t);
+    return true;
+  }
+
+  // Unmaps the file, if it was mapped.
+  void Unmap() {
+    if (mapped_) {
+#if defined(_WIN32)
+      UnmapViewOfFile(mapped_);
+#else
+      munmap(mapped_, mapped_size_);
+#endif
+    }
+    mapped_ = nullptr;
+    mapped_size_ = 0;
+    data_ = nullptr;
+    size_ = 0;
+  }
+
+  void* mapped_ = nullptr;
+  size_t mapped_size_ = 0;
+  std::vector<uint32_t> contents_;
+  const uint32_t* data_ = nullptr;
+  size_t size_ = 0;
+};
+
 // Writes the given |data| into the file named as |filename| using the given
 // |mode|, assuming |data| is an array of |count| elements of type |T|. If
 // |filename| is nullptr or "-", writes to standard output. If any error occurs,
@@ -39,6 +39,10 @@ Options:
   --create-library        Link the binaries into a library, keeping all exported symbols.
   --allow-partial-linkage Allow partial linkage by accepting imported symbols to be unresolved.
   --verify-ids            Verify that IDs in the resulting modules are truly unique.
+  --parallel              Load the input modules on one thread per hardware thread.
+  --remove-unused-functions
+                          Remove the functions that cannot be called from the entry
+                          points, or from the exported functions of a library.
   --version               Display linker version information
   --target-env            {%s}
                           Use validation rules from the specified environment.
@@ -77,6 +81,10 @@ int main(int argc, char** argv) {
         options.SetVerifyIds(true);
       } else if (0 == strcmp(cur_arg, "--allow-partial-linkage")) {
         options.SetAllowPartialLinkage(true);
+      } else if (0 == strcmp(cur_arg, "--parallel")) {
+        options.SetNumThreads(0);
+      } else if (0 == strcmp(cur_arg, "--remove-unused-functions")) {
+        options.SetRemoveUnusedFunctions(true);
       } else if (0 == strcmp(cur_arg, "--version")) {
         printf("%s\n", spvSoftwareVersionDetailsString());
         // TODO(dneto): Add OpenCL 2.2 at least.
@@ -119,9 +127,15 @@ int main(int argc, char** argv) {
     return 1;
   }
 
-  std::vector<std::vector<uint32_t>> contents(inFiles.size());
+  // The input files are mapped rather than copied, since there may be many
+  // of them.
+  std::vector<BinaryFile> files(inFiles.size());
+  std::vector<const uint32_t*> binaries(inFiles.size());
+  std::vector<size_t> binary_sizes(inFiles.size());
   for (size_t i = 0u; i < inFiles.size(); ++i) {
-    if (!ReadFile<uint32_t>(inFiles[i], "rb", &contents[i])) return 1;
+    if (!files[i].Open(inFiles[i])) return 1;
+    binaries[i] = files[i].data();
+    binary_sizes[i] = files[i].size();
   }
 
   const spvtools::MessageConsumer consumer = [](spv_message_level_t level,
@@ -150,7 +164,9 @@ int main(int argc, char** argv) {
   context.SetMessageConsumer(consumer);
 
   std::vector<uint32_t> linkingResult;
-  spv_result_t status = Link(context, contents, &linkingResult, options);
+  spv_result_t status = Link(context, binaries.data(), binary_sizes.data(),
+                             binaries.size(), &linkingResult, options);
+  files.clear();
 
   if (!WriteFile<uint32_t>(outFile, "wb", linkingResult.data(),
                            linkingResult.size()))
@@ -20,15 +20,19 @@
 #include <memory>
 #include <sstream>
 #include <string>
+#include <unordered_map>
+#include <utility>
 #include <vector>
 
 #include "source/opt/log.h"
 #include "source/spirv_target_env.h"
+#include "source/util/parse_number.h"
 #include "source/util/string_utils.h"
 #include "spirv-tools/libspirv.hpp"
 #include "spirv-tools/optimizer.hpp"
 #include "tools/io.h"
 #include "tools/util/cli_consumer.h"
+#include "tools/util/server.h"
 
 namespace {
 
@@ -98,6 +102,7 @@ void PrintUsage(const char* program) {
       R"(%s - Optimize a SPIR-V binary file.
 
 USAGE: %s [options] [<input>] -o <output>
+       %s [options] --batch=<file>
 
 The SPIR-V binary is read from <input>. If no file is specified,
 or if <input> is "-", then the binary is read from standard input.
@@ -107,13 +112,34 @@ standard output.
 NOTE: The optimizer is a work in progress.
 
 Options (in lexicographical order):)",
-      program, program);
+      program, program, program);
   printf(R"(
   --amd-ext-to-khr
                Replaces the extensions VK_AMD_shader_ballot, VK_AMD_gcn_shader,
                and VK_AMD_shader_trinary_minmax with equivalant code using core
                instructions and capabilities.)");
   printf(R"(
+  --batch=<file>
+               Optimize each of the files listed in <file> rather than a
+               single one, with the flags parsed once.  Each line of <file>
+               holds an input file and an output file, separated by spaces.
+               Empty lines and lines starting with '#' are ignored.  A failure
+               on one file is reported with its name, and does not stop the
+               others.  Several files are optimized at once when -j allows
+               it.)");
+  printf(R"(
+  --block-counts=<file>
+               Read the execution counts of the blocks of the module from the
+               file, as lines of the form "<block id> <count>".  Lines starting
+               with '#' are ignored.  If-conversion then keeps the branches
+               the profile shows to be biased, and loop unswitching and loop
+               peeling skip the loops it shows to be cold.)");
+  printf(R"(
+  --cache-dir <existing directory>
+               Remember the optimized modules in the directory, and reuse
+               them when the same module is optimized again with the same
+               flags.)");
+  printf(R"(
   --ccp
                Apply the conditional constant propagation transform.  This will
                propagate constant values throughout the program, and simplify
@@ -130,9 +156,19 @@ Options (in lexicographical order):)",
                Combines chained access chains to produce a single instruction
                where possible.)");
   printf(R"(
-  --compact-ids
+  --compact-ids[=locality]
                Remap result ids to a compact range starting from %%1 and without
-               any gaps.)");
+               any gaps.  With "locality", number the ids by their first use in
+               each function, and group the types, constants and global
+               variables with the function using them the most.)");
+  printf(R"(
+  --compress
+               Write the output in the compact encoding of spvBinaryEncode
+               rather than as SPIR-V words.  Operands become varints and ids
+               deltas, which roughly halves the file and makes it a better
+               input for a generic compressor.  It is read back with
+               --decompress.  Without optimization flags, this only converts
+               the file.)");
   printf(R"(
   --convert-local-access-chains
                Convert constant index access chain loads/stores into
@@ -162,6 +198,10 @@ Options (in lexicographical order):)",
                around known issues with some Vulkan drivers for initialize
                variables.)");
   printf(R"(
+  --decompress
+               Read the input in the compact encoding written by --compress
+               rather than as SPIR-V words.)");
+  printf(R"(
   --descriptor-scalar-replacement
                Replaces every array variable |desc| that has a DescriptorSet
                and Binding decorations with a new variable for each element of
@@ -171,6 +211,16 @@ Options (in lexicographical order):)",
                must be in OpAccessChain instructions with a literal index for
                the first index.)");
   printf(R"(
+  --descriptor-scalar-replacement-partial[=<n>]
+               Like --descriptor-scalar-replacement, but the arrays which are
+               also indexed dynamically, runtime arrays included, are kept for
+               those accesses, and their elements accessed with a literal index
+               get new variables.  Those are bound consecutively from binding
+               <n> in each descriptor set, element |i| of the first array at
+               <n>+|i|, and the elements of the following arrays after the
+               largest element used of the previous one.  Without <n>, they
+               follow the largest binding of the set.)");
+  printf(R"(
   --eliminate-dead-branches
                Convert conditional branches with constant condition to the
                indicated unconditional brranch. Delete all resulting dead
@@ -217,6 +267,12 @@ Options (in lexicographical order):)",
                loads and stores. Performed only on entry point call tree
                functions.)");
   printf(R"(
+  --eliminate-memory-load-store
+               Replace the loads of function scope and private variables
+               reading the value of a single store, possibly in another block
+               or through access chains with constant indices, and remove
+               the stores which are never read.)");
+  printf(R"(
   --flatten-decorations
                Replace decoration groups with repeated OpDecorate and
                OpMemberDecorate instructions.)");
@@ -242,11 +298,24 @@ Options (in lexicographical order):)",
   --if-conversion
                Convert if-then-else like assignments into OpSelect.)");
   printf(R"(
+  --inline-budget[=<n>]
+               Inline the calls whose callee, less the cost of the call, has
+               at most <n> instructions, or which are the only call to their
+               callee, visiting callees before their callers.  Calls which
+               must be inlined for the module to be legal are always inlined.
+               The default budget is 75.)");
+  printf(R"(
   --inline-entry-points-exhaustive
                Exhaustively inline all function calls in entry point call tree
                functions. Currently does not inline calls to functions with
                early return in a loop.)");
   printf(R"(
+  -j <n>, --jobs=<n>
+               Use at most <n> threads, or one per hardware thread if <n> is 0.
+               With --batch, this is the number of files optimized at once,
+               and with --split-entry-points the number of entry points.
+               Otherwise the threads are used as with --parallel.)");
+  printf(R"(
   --legalize-hlsl
                Runs a series of optimizations that attempts to take SPIR-V
                generated by an HLSL front-end and generates legal Vulkan SPIR-V.
@@ -269,7 +338,10 @@ Options (in lexicographical order):)",
   --loop-fission
                Splits any top level loops in which the register pressure has
                exceeded a given threshold. The threshold must follow the use of
-               this flag and must be a positive integer value.)");
+               this flag and must be a positive integer value. With the 'auto'
+               argument, loops are split above a default threshold, unless
+               both parts would access the same buffer elements within a few
+               iterations.)");
   printf(R"(
   --loop-fusion
                Identifies adjacent loops with the same lower and upper bound.
@@ -277,7 +349,9 @@ Options (in lexicographical order):)",
                Includes heuristics to ensure it does not increase number of
                registers too much, while reducing the number of loads from
                memory. Takes an additional positive integer argument to set
-               the maximum number of registers.)");
+               the maximum number of registers. With the 'auto' argument, only
+               the loops accessing the same buffer elements within a few
+               iterations are fused, under a default number of registers.)");
   printf(R"(
   --loop-invariant-code-motion
                Identifies code in loops that has the same value for every
@@ -291,6 +365,13 @@ Options (in lexicographical order):)",
                additional non-0 integer argument to set the unroll factor, or
                how many times a loop body should be duplicated)");
   printf(R"(
+  --loop-unroll-auto=<n>
+               Unrolls loops marked with the Unroll flag by a factor picked
+               for each loop from its trip count, its size and its register
+               pressure.  Small loops are fully unrolled.  Takes an
+               additional positive integer argument to set the number of
+               registers the unrolled loops may use.)");
+  printf(R"(
   --loop-peeling
                Execute few first (respectively last) iterations before
                (respectively after) the loop if it can elide some branches.)");
@@ -311,6 +392,10 @@ Options (in lexicographical order):)",
                first as its only predecessor. Performed only on entry point
                call tree functions.)");
   printf(R"(
+  --merge-identical-functions
+               Redirect the calls to functions that are identical, up to the
+               renaming of their ids, to one of them, and remove the others.)");
+  printf(R"(
   --merge-return
                Changes functions that have multiple return statements so they
                have a single return statement.
@@ -326,10 +411,12 @@ Options (in lexicographical order):)",
                These conditions are guaranteed to be met after running
                dead-branch elimination.)");
   printf(R"(
-  --loop-unswitch
+  --loop-unswitch[=<n>]
                Hoists loop-invariant conditionals out of loops by duplicating
                the loop on each branch of the conditional and adjusting each
-               copy of the loop.)");
+               copy of the loop.  <n> is the number of instructions the copies
+               may add to each function.  0 means there is no limit.  The
+               default value is 1000.)");
   printf(R"(
   -O
                Optimize for performance. Apply a sequence of transformations
@@ -379,6 +466,16 @@ Options (in lexicographical order):)",
                --merge-blocks followed by all the transformations implied by
                -O.)");
   printf(R"(
+  --parallel
+               Build the dominator trees of different functions on multiple
+               threads in the passes that use the trees of every function.
+               The result is the same as on one thread.)");
+  printf(R"(
+  --partial-redundancy-elimination
+               Looks for instructions whose value is already computed on some
+               of the paths leading to them, computes it on the other paths,
+               and replaces the instructions by an OpPhi.)");
+  printf(R"(
   --preserve-bindings
                Ensure that the optimizer preserves all bindings declared within
                the module, even when those bindings are unused.)");
@@ -395,17 +492,35 @@ Options (in lexicographical order):)",
                Change the scope of private variables that are used in a single
                function to that function.)");
   printf(R"(
+  --profile-trace=<file>
+               Write a Chrome trace of the run to the file, for
+               chrome://tracing or Perfetto.  It shows the time and memory
+               taken by each pass, by the functions it processes and by the
+               analyses it rebuilds.)");
+  printf(R"(
   --reduce-load-size
                Replaces loads of composite objects where not every component is
                used by loads of just the elements that are used.)");
   printf(R"(
+  --reduce-register-pressure=<n>
+               Shortens the live ranges of values in the functions needing
+               more registers than the positive integer argument: loads from
+               read only memory are recomputed where they are used, loads
+               are sunk, and instructions are moved next to their first
+               user within blocks.)");
+  printf(R"(
   --redundancy-elimination
                Looks for instructions in the same function that compute the
                same value, and deletes the redundant ones.)");
   printf(R"(
   --relax-float-ops
                Decorate all float operations with RelaxedPrecision if not already
-               so decorated. This does not decorate types or variables.)");
+               so decorated. This does not decorate types or variables.
+  --relax-float-ops-in-range[=<m>]
+               Like --relax-float-ops, but only decorate the operations whose
+               result and float operands are known to stay within [-<m>, <m>]
+               by an interval analysis.  The default <m> is 65504, the
+               largest half value; smaller values keep more precision.)");
   printf(R"(
   --relax-struct-store
                Allow store from one struct type to a different type with
@@ -429,8 +544,18 @@ Options (in lexicographical order):)",
                Replace aggregate function scope variables that are only accessed
                via their elements with new function variables representing each
                element.  <n> is a limit on the size of the aggragates that will
-               be replaced.  0 means there is no limit.  The default value is
-               100.)");
+               be replaced.  In a larger aggregate, only the elements that are
+               accessed individually are replaced, if there are at most <n> of
+               them.  0 means there is no limit.  The default value is 100.)");
+  printf(R"(
+  --server
+               Optimize the binaries of a stream of requests read from standard
+               input, and write a response for each to standard output, rather
+               than optimizing one file.  Each request is a word count followed
+               by the words of a binary.  Each response is a status word, 0 on
+               success, the byte count and bytes of the messages, and the word
+               count and words of the optimized binary.  The requests are
+               optimized one at a time; --parallel applies within each.)");
   printf(R"(
   --set-spec-const-default-value "<spec id>:<default value> ..."
                Set the default values of the specialization constants with
@@ -444,6 +569,18 @@ Options (in lexicographical order):)",
                Will simplify all instructions in the function as much as
                possible.)");
   printf(R"(
+  --slp-vectorize
+               Replace vectors constructed from the same scalar arithmetic on
+               each component with vector arithmetic, when it takes fewer
+               instructions.)");
+  printf(R"(
+  --split-entry-points
+               Optimize each entry point of the module on its own, with only
+               the functions it calls, rather than the whole module.  The
+               module of the entry point <i>, counting the OpEntryPoint
+               instructions from 0, is written to <output>.<i>.  Several
+               entry points are optimized at once when -j allows it.)");
+  printf(R"(
   --split-invalid-unreachable
                Attempts to legalize for WebGPU cases where an unreachable
                merge-block is also a continue-target by splitting it into two
@@ -456,6 +593,20 @@ Options (in lexicographical order):)",
                is invalid, the optimizer may fail or generate incorrect code.
                This options should be used rarely, and with caution.)");
   printf(R"(
+  --stats
+               Print to standard error how many times each analysis of the
+               module was built, and the time spent building it.)");
+  printf(R"(
+  --stream-functions
+               Optimize the module one function at a time, holding only the
+               global section and the function being optimized in memory,
+               rather than the whole module.  Only function local passes can
+               be used, such as --eliminate-local-single-block,
+               --eliminate-local-single-store, --ssa-rewrite, --ccp,
+               --simplify-instructions, --redundancy-elimination,
+               --local-redundancy-elimination, --eliminate-dead-branches and
+               --merge-blocks.)");
+  printf(R"(
   --strength-reduction
                Replaces instructions with equivalent and less expensive ones.)");
   printf(R"(
@@ -484,6 +635,13 @@ Options (in lexicographical order):)",
                USR/SYS time are returned by getrusage() and can have a small
                error.)");
   printf(R"(
+  --time-budget=<microseconds>
+               Stop running the optimization passes once they took the given
+               time, and output the module as optimized so far.  The passes
+               the module needs for its target environment, and the
+               instrumentation passes, still run.  A pass is not interrupted,
+               so the budget can be exceeded by the time of one pass.)");
+  printf(R"(
   --upgrade-memory-model
                Upgrades the Logical GLSL450 memory model to Logical VulkanKHR.
                Transforms memory, image, atomic and barrier operations to conform
@@ -594,22 +752,111 @@ bool ReadFlagsFromFile(const char* oconfig_flag,
   return true;
 }
 
+// An input file and the output file its optimized binary is written to.
+struct BatchEntry {
+  std::string input;
+  std::string output;
+};
+
+// Reads the files to optimize listed in the file |fname| into |entries|.
+// Each line that is not empty or a comment starting with '#' holds an input
+// file and an output file, separated by blanks.
+//
+// This function returns true on success, false on failure.
+bool ReadBatchFile(const char* fname, std::vector<BatchEntry>* entries) {
+  std::ifstream input_file;
+  input_file.open(fname);
+  if (input_file.fail()) {
+    spvtools::Errorf(opt_diagnostic, nullptr, {}, "Could not open file '%s'",
+                     fname);
+    return false;
+  }
+
+  std::string line;
+  for (size_t line_number = 1; std::getline(input_file, line); ++line_number) {
+    if (line.find_first_not_of(" \t\r") == std::string::npos ||
+        line[0] == '#') {
+      continue;
+    }
+
+    std::istringstream iss(line);
+    BatchEntry entry;
+    std::string rest;
+    if (!(iss >> entry.input >> entry.output) || (iss >> rest)) {
+      spvtools::Errorf(opt_diagnostic, nullptr, {},
+                       "Invalid line %zu in batch file '%s'", line_number,
+                       fname);
+      return false;
+    }
+    entries->push_back(std::move(entry));
+  }
+  return true;
+}
+
+// Reads the block counts in the file |fname| into |counts|.  Each line that
+// is not empty or a comment starting with '#' holds a block id and its
+// execution count, separated by blanks.
+//
+// This function returns true on success, false on failure.
+bool ReadBlockCounts(const char* fname,
+                     std::unordered_map<uint32_t, uint64_t>* counts) {
+  std::ifstream input_file;
+  input_file.open(fname);
+  if (input_file.fail()) {
+    spvtools::Errorf(opt_diagnostic, nullptr, {}, "Could not open file '%s'",
+                     fname);
+    return false;
+  }
+
+  std::string line;
+  while (std::getline(input_file, line)) {
+    if (line.find_first_not_of(" \t\r") == std::string::npos ||
+        line[0] == '#') {
+      continue;
+    }
+
+    std::istringstream iss(line);
+    uint32_t id = 0;
+    uint64_t count = 0;
+    std::string rest;
+    if (!(iss >> id >> count) || (iss >> rest)) {
+      spvtools::Errorf(opt_diagnostic, nullptr, {},
+                       "Invalid block count '%s' in file '%s'", line.c_str(),
+                       fname);
+      return false;
+    }
+    (*counts)[id] = count;
+  }
+
+  return true;
+}
+
 OptStatus ParseFlags(int argc, const char** argv,
                      spvtools::Optimizer* optimizer, const char** in_file,
-                     const char** out_file,
+                     const char** out_file, const char** batch_file,
+                     const char** cache_dir, const char** profile_file,
+                     bool* print_stats, bool* server,
+                     bool* split_entry_points, bool* stream_functions,
+                     bool* compress, bool* decompress,
                      spvtools::ValidatorOptions* validator_options,
                      spvtools::OptimizerOptions* optimizer_options);
 
 // Parses and handles the -Oconfig flag. |prog_name| contains the name of
 // the spirv-opt binary (used to build a new argv vector for the recursive
 // invocation to ParseFlags). |opt_flag| contains the -Oconfig=FILENAME flag.
-// |optimizer|, |in_file|, |out_file|, |validator_options|, and
+// |optimizer|, |in_file|, |out_file|, |batch_file|, |cache_dir|,
+// |profile_file|, |print_stats|, |server|, |split_entry_points|,
+// |stream_functions|, |compress|, |decompress|, |validator_options|, and
 // |optimizer_options| are as in ParseFlags.
 //
 // This returns the same OptStatus instance returned by ParseFlags.
 OptStatus ParseOconfigFlag(const char* prog_name, const char* opt_flag,
                            spvtools::Optimizer* optimizer, const char** in_file,
-                           const char** out_file,
+                           const char** out_file, const char** batch_file,
+                           const char** cache_dir, const char** profile_file,
+                           bool* print_stats, bool* server,
+                           bool* split_entry_points, bool* stream_functions,
+                           bool* compress, bool* decompress,
                            spvtools::ValidatorOptions* validator_options,
                            spvtools::OptimizerOptions* optimizer_options) {
   std::vector<std::string> flags;
@@ -636,7 +883,9 @@ OptStatus ParseOconfigFlag(const char* prog_name, const char* opt_flag,
 
   auto ret_val =
       ParseFlags(static_cast<int>(flags.size()), new_argv, optimizer, in_file,
-                 out_file, validator_options, optimizer_options);
+                 out_file, batch_file, cache_dir, profile_file, print_stats,
+                 server, split_entry_points, stream_functions, compress,
+                 decompress, validator_options, optimizer_options);
   delete[] new_argv;
   return ret_val;
 }
@@ -686,12 +935,23 @@ std::string CanonicalizeFlag(const char** argv, int argc, int* argi) {
 // Optimizer instance used to optimize the program.
 //
 // On return, this function stores the name of the input program in |in_file|.
-// The name of the output file in |out_file|. The return value indicates whether
-// optimization should continue and a status code indicating an error or
-// success.
+// The name of the output file in |out_file|.  The file listing the files to
+// optimize in |batch_file|, if any.  The directory of the
+// optimization cache in |cache_dir|, and the file of the profile in
+// |profile_file|, if any.  Whether to print the statistics of the run in
+// |print_stats|, whether to serve requests in |server|, whether to
+// optimize each entry point on its own in |split_entry_points|, whether to
+// optimize one function at a time in |stream_functions|, and whether the
+// output and the input are encoded by spvBinaryEncode in |compress| and
+// |decompress|. The return value indicates whether optimization should
+// continue and a status code indicating an error or success.
 OptStatus ParseFlags(int argc, const char** argv,
                      spvtools::Optimizer* optimizer, const char** in_file,
-                     const char** out_file,
+                     const char** out_file, const char** batch_file,
+                     const char** cache_dir, const char** profile_file,
+                     bool* print_stats, bool* server,
+                     bool* split_entry_points, bool* stream_functions,
+                     bool* compress, bool* decompress,
                      spvtools::ValidatorOptions* validator_options,
                      spvtools::OptimizerOptions* optimizer_options) {
   std::vector<std::string> pass_flags;
@@ -725,9 +985,11 @@ OptStatus ParseFlags(int argc, const char** argv,
           return {OPT_STOP, 1};
         }
       } else if (0 == strncmp(cur_arg, "-Oconfig=", sizeof("-Oconfig=") - 1)) {
-        OptStatus status =
-            ParseOconfigFlag(argv[0], cur_arg, optimizer, in_file, out_file,
-                             validator_options, optimizer_options);
+        OptStatus status = ParseOconfigFlag(
+            argv[0], cur_arg, optimizer, in_file, out_file, batch_file,
+            cache_dir, profile_file, print_stats, server, split_entry_points,
+            stream_functions, compress, decompress, validator_options,
+            optimizer_options);
         if (status.action != OPT_CONTINUE) {
           return status;
         }
@@ -739,6 +1001,66 @@ OptStatus ParseFlags(int argc, const char** argv,
         optimizer_options->set_preserve_bindings(true);
       } else if (0 == strcmp(cur_arg, "--preserve-spec-constants")) {
         optimizer_options->set_preserve_spec_constants(true);
+      } else if (0 == strcmp(cur_arg, "--parallel")) {
+        optimizer_options->set_num_threads(0);
+      } else if (0 == strcmp(cur_arg, "-j") ||
+                 0 == strncmp(cur_arg, "--jobs=", sizeof("--jobs=") - 1)) {
+        const char* jobs = nullptr;
+        if (cur_arg[1] == 'j') {
+          if (argi + 1 < argc) jobs = argv[++argi];
+        } else {
+          jobs = cur_arg + sizeof("--jobs=") - 1;
+        }
+        uint32_t num_threads = 0;
+        if (!jobs || !spvtools::utils::ParseNumber(jobs, &num_threads)) {
+          spvtools::Error(opt_diagnostic, nullptr, {},
+                          "-j requires a number of threads");
+          return {OPT_STOP, 1};
+        }
+        optimizer_options->set_num_threads(num_threads);
+      } else if (0 == strncmp(cur_arg, "--time-budget=",
+                              sizeof("--time-budget=") - 1)) {
+        uint32_t time_budget = 0;
+        if (!spvtools::utils::ParseNumber(
+                cur_arg + sizeof("--time-budget=") - 1, &time_budget)) {
+          spvtools::Error(opt_diagnostic, nullptr, {},
+                          "--time-budget requires a number of microseconds");
+          return {OPT_STOP, 1};
+        }
+        optimizer_options->set_time_budget(time_budget);
+      } else if (0 == strncmp(cur_arg, "--batch=", sizeof("--batch=") - 1)) {
+        *batch_file = cur_arg + sizeof("--batch=") - 1;
+      } else if (0 == strcmp(cur_arg, "--cache-dir")) {
+        if (argi + 1 < argc) {
+          *cache_dir = argv[++argi];
+        } else {
+          spvtools::Error(opt_diagnostic, nullptr, {},
+                          "Missing argument to --cache-dir");
+          return {OPT_STOP, 1};
+        }
+      } else if (0 == strncmp(cur_arg, "--block-counts=",
+                              sizeof("--block-counts=") - 1)) {
+        std::unordered_map<uint32_t, uint64_t> counts;
+        if (!ReadBlockCounts(cur_arg + sizeof("--block-counts=") - 1,
+                             &counts)) {
+          return {OPT_STOP, 1};
+        }
+        optimizer->SetBlockCounts(counts);
+      } else if (0 == strncmp(cur_arg, "--profile-trace=",
+                              sizeof("--profile-trace=") - 1)) {
+        *profile_file = cur_arg + sizeof("--profile-trace=") - 1;
+      } else if (0 == strcmp(cur_arg, "--stats")) {
+        *print_stats = true;
+      } else if (0 == strcmp(cur_arg, "--server")) {
+        *server = true;
+      } else if (0 == strcmp(cur_arg, "--split-entry-points")) {
+        *split_entry_points = true;
+      } else if (0 == strcmp(cur_arg, "--stream-functions")) {
+        *stream_functions = true;
+      } else if (0 == strcmp(cur_arg, "--compress")) {
+        *compress = true;
+      } else if (0 == strcmp(cur_arg, "--decompress")) {
+        *decompress = true;
       } else if (0 == strcmp(cur_arg, "--time-report")) {
         optimizer->SetTimeReport(&std::cerr);
       } else if (0 == strcmp(cur_arg, "--relax-struct-store")) {
@@ -851,11 +1173,148 @@ OptStatus ParseFlags(int argc, const char** argv,
   return {OPT_CONTINUE, 0};
 }
 
+// Prints |statistics| to standard error, one analysis per line.
+void PrintStatistics(const spvtools::Optimizer::Statistics& statistics) {
+  fprintf(stderr, "%-20s %10s %12s\n", "analysis", "builds", "time (ms)");
+  for (const auto& analysis : statistics.analyses) {
+    fprintf(stderr, "%-20s %10llu %12.3f\n", analysis.name,
+            static_cast<unsigned long long>(analysis.builds),
+            static_cast<double>(analysis.nanoseconds) / 1e6);
+  }
+}
+
 }  // namespace
 
+// Optimizes the binaries of the requests read from the standard input with
+// |optimizer|, and writes the responses to the standard output.  Returns the
+// exit code.
+int Serve(const spvtools::Optimizer& optimizer,
+          const spvtools::OptimizerOptions& optimizer_options) {
+  FILE* in = freopen(nullptr, "rb", stdin);
+  FILE* out = freopen(nullptr, "wb", stdout);
+  if (!in || !out) {
+    spvtools::Error(opt_diagnostic, nullptr, {},
+                    "Could not reopen the standard streams");
+    return 1;
+  }
+  // The passes of the optimizer hold the module they run on, so the requests
+  // are optimized one at a time.
+  const bool ok = spvtools::utils::Serve(
+      in, out, 1,
+      [&optimizer, &optimizer_options](const std::vector<uint32_t>& binary) {
+        std::vector<std::vector<uint32_t>> optimized;
+        std::vector<std::string> messages;
+        const bool succeeded = optimizer.RunBatch(
+            {binary}, &optimized, &messages, optimizer_options);
+        spvtools::utils::ServerResponse response;
+        response.status = succeeded ? 0 : 1;
+        response.messages = std::move(messages.front());
+        response.binary = std::move(optimized.front());
+        return response;
+      });
+  return ok ? 0 : 1;
+}
+
+// Optimizes the files listed in |batch_file| with |optimizer|.  The files
+// are read and optimized a group at a time, so that the binaries of a long
+// list are not all held at once.  Returns the exit code, which is 1 if any
+// file failed.
+int RunBatchFile(const char* batch_file, const spvtools::Optimizer& optimizer,
+                 const spvtools::OptimizerOptions& optimizer_options) {
+  std::vector<BatchEntry> entries;
+  if (!ReadBatchFile(batch_file, &entries)) return 1;
+
+  const size_t kGroupSize = 256;
+  bool ok = true;
+  for (size_t first = 0; first < entries.size(); first += kGroupSize) {
+    const size_t last = std::min(first + kGroupSize, entries.size());
+
+    // The entries that could be read, and their binaries.
+    std::vector<const BatchEntry*> read;
+    std::vector<std::vector<uint32_t>> binaries;
+    for (size_t i = first; i < last; ++i) {
+      std::vector<uint32_t> binary;
+      if (!ReadFile<uint32_t>(entries[i].input.c_str(), "rb", &binary)) {
+        ok = false;
+        continue;
+      }
+      read.push_back(&entries[i]);
+      binaries.push_back(std::move(binary));
+    }
+
+    std::vector<std::vector<uint32_t>> optimized;
+    std::vector<std::string> messages;
+    optimizer.RunBatch(binaries, &optimized, &messages, optimizer_options);
+    for (size_t i = 0; i < read.size(); ++i) {
+      const char* input = read[i]->input.c_str();
+      std::istringstream lines(messages[i]);
+      for (std::string line; std::getline(lines, line);) {
+        fprintf(stderr, "%s: %s\n", input, line.c_str());
+      }
+      // As for a single file, a failed run writes out the input.
+      const std::vector<uint32_t>* binary = &optimized[i];
+      if (binary->empty()) {
+        fprintf(stderr, "%s: optimization failed\n", input);
+        binary = &binaries[i];
+        ok = false;
+      }
+      if (!WriteFile<uint32_t>(read[i]->output.c_str(), "wb", binary->data(),
+                               binary->size())) {
+        ok = false;
+      }
+    }
+  }
+  return ok ? 0 : 1;
+}
+
+// Optimizes each entry point of |in_file| on its own with |optimizer|, and
+// writes the module of the entry point i to |out_file| followed by ".i".
+// Returns the exit code, which is 1 if any entry point failed.
+int RunEntryPoints(const char* in_file, const char* out_file,
+                   const spvtools::Optimizer& optimizer,
+                   const spvtools::OptimizerOptions& optimizer_options) {
+  spvtools::Optimizer::IRHandle ir;
+  {
+    BinaryFile input;
+    if (!input.Open(in_file)) return 1;
+    if (!optimizer.BuildIR(input.data(), input.size(), &ir,
+                           optimizer_options)) {
+      return 1;
+    }
+  }
+
+  std::vector<std::string> names;
+  std::vector<std::vector<uint32_t>> optimized;
+  bool ok = optimizer.RunEntryPoints(ir, &names, &optimized,
+                                     optimizer_options);
+  for (size_t i = 0; i < names.size(); ++i) {
+    if (optimized[i].empty()) {
+      spvtools::Errorf(opt_diagnostic, nullptr, {},
+                       "Optimization of the entry point '%s' failed",
+                       names[i].c_str());
+      continue;
+    }
+    const std::string output = std::string(out_file) + "." + std::to_string(i);
+    if (!WriteFile<uint32_t>(output.c_str(), "wb", optimized[i].data(),
+                             optimized[i].size())) {
+      ok = false;
+    }
+  }
+  return ok ? 0 : 1;
+}
+
 int main(int argc, const char** argv) {
   const char* in_file = nullptr;
   const char* out_file = nullptr;
+  const char* batch_file = nullptr;
+  const char* cache_dir = nullptr;
+  const char* profile_file = nullptr;
+  bool print_stats = false;
+  bool server = false;
+  bool split_entry_points = false;
+  bool stream_functions = false;
+  bool compress = false;
+  bool decompress = false;
 
   spv_target_env target_env = kDefaultEnvironment;
 
@@ -864,30 +1323,137 @@ int main(int argc, const char** argv) {
 
   spvtools::ValidatorOptions validator_options;
   spvtools::OptimizerOptions optimizer_options;
-  OptStatus status = ParseFlags(argc, argv, &optimizer, &in_file, &out_file,
-                                &validator_options, &optimizer_options);
+  OptStatus status =
+      ParseFlags(argc, argv, &optimizer, &in_file, &out_file, &batch_file,
+                 &cache_dir, &profile_file, &print_stats, &server,
+                 &split_entry_points, &stream_functions, &compress,
+                 &decompress, &validator_options, &optimizer_options);
   optimizer_options.set_validator_options(validator_options);
 
   if (status.action == OPT_STOP) {
     return status.code;
   }
 
-  if (out_file == nullptr) {
+  if (server && (in_file || out_file)) {
+    spvtools::Error(opt_diagnostic, nullptr, {},
+                    "--server reads the standard input and writes the "
+                    "standard output");
+    return 1;
+  }
+
+  if (batch_file && (server || in_file || out_file)) {
+    spvtools::Error(opt_diagnostic, nullptr, {},
+                    "--batch reads the input and output files from the batch "
+                    "file");
+    return 1;
+  }
+
+  if (split_entry_points && (server || batch_file)) {
+    spvtools::Error(opt_diagnostic, nullptr, {},
+                    "--split-entry-points optimizes a single input file");
+    return 1;
+  }
+
+  if (stream_functions && (server || batch_file || split_entry_points)) {
+    spvtools::Error(opt_diagnostic, nullptr, {},
+                    "--stream-functions optimizes a single input file");
+    return 1;
+  }
+
+  if ((compress || decompress) &&
+      (server || batch_file || split_entry_points)) {
+    spvtools::Error(opt_diagnostic, nullptr, {},
+                    "--compress and --decompress apply to a single input "
+                    "and output file");
+    return 1;
+  }
+
+  if (!server && !batch_file && out_file == nullptr) {
     spvtools::Error(opt_diagnostic, nullptr, {}, "-o required");
     return 1;
   }
 
+  std::ofstream profile;
+  if (profile_file) {
+    profile.open(profile_file);
+    if (!profile) {
+      spvtools::Errorf(opt_diagnostic, nullptr, {},
+                       "Could not open the profile file '%s'", profile_file);
+      return 1;
+    }
+    optimizer.SetProfileTrace(&profile);
+  }
+
+  std::unique_ptr<spvtools::DirectoryOptimizationCache> cache;
+  if (cache_dir) {
+    cache.reset(new spvtools::DirectoryOptimizationCache(cache_dir));
+    optimizer.SetCache(cache.get());
+  }
+
+  if (server) {
+    const int code = Serve(optimizer, optimizer_options);
+    if (print_stats) PrintStatistics(optimizer.GetStatistics());
+    return code;
+  }
+
+  if (batch_file) {
+    const int code = RunBatchFile(batch_file, optimizer, optimizer_options);
+    if (print_stats) PrintStatistics(optimizer.GetStatistics());
+    return code;
+  }
+
+  if (split_entry_points) {
+    const int code =
+        RunEntryPoints(in_file, out_file, optimizer, optimizer_options);
+    if (print_stats) PrintStatistics(optimizer.GetStatistics());
+    return code;
+  }
+
+  spvtools::SpirvTools tools(kDefaultEnvironment);
+  tools.SetMessageConsumer(spvtools::utils::CLIMessageConsumer);
+
+  // Optimizes the module of |size| words at |words| into |binary|.
+  auto run = [&optimizer, &optimizer_options, stream_functions](
+                 const uint32_t* words, size_t size,
+                 std::vector<uint32_t>* binary) {
+    return stream_functions
+               ? optimizer.RunStreaming(words, size, binary, optimizer_options)
+               : optimizer.Run(words, size, binary, optimizer_options);
+  };
+
+  // The input is released before the output is written, since they may be
+  // the same file.
   std::vector<uint32_t> binary;
-  if (!ReadFile<uint32_t>(in_file, "rb", &binary)) {
-    return 1;
+  bool ok = false;
+  if (decompress) {
+    std::vector<uint8_t> encoded;
+    std::vector<uint32_t> decoded;
+    if (!ReadFile<uint8_t>(in_file, "rb", &encoded) ||
+        !tools.Decode(encoded, &decoded)) {
+      return 1;
+    }
+    ok = run(decoded.data(), decoded.size(), &binary);
+    if (!ok) binary = std::move(decoded);
+  } else {
+    BinaryFile input;
+    if (!input.Open(in_file)) {
+      return 1;
+    }
+    ok = run(input.data(), input.size(), &binary);
+    // As before the input was mapped, a failed run writes out the input.
+    if (!ok) binary.assign(input.data(), input.data() + input.size());
   }
 
-  // By using the same vector as input and output, we save time in the case
-  // that there was no change.
-  bool ok =
-      optimizer.Run(binary.data(), binary.size(), &binary, optimizer_options);
+  if (print_stats) PrintStatistics(optimizer.GetStatistics());
 
-  if (!WriteFile<uint32_t>(out_file, "wb", binary.data(), binary.size())) {
+  if (compress) {
+    std::vector<uint8_t> encoded;
+    if (!tools.Encode(binary, &encoded) ||
+        !WriteFile<uint8_t>(out_file, "wb", encoded.data(), encoded.size())) {
+      return 1;
+    }
+  } else if (!WriteFile<uint32_t>(out_file, "wb", binary.data(),
+                                  binary.size())) {
     return 1;
   }
 
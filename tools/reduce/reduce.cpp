@@ -15,17 +15,24 @@
 #include <cassert>
 #include <cerrno>
 #include <cstring>
+#include <fstream>
 #include <functional>
+#include <memory>
 
 #include "source/opt/build_module.h"
 #include "source/opt/ir_context.h"
 #include "source/opt/log.h"
 #include "source/reduce/reducer.h"
 #include "source/spirv_reducer_options.h"
+#include "source/util/profiler.h"
 #include "source/util/string_utils.h"
 #include "tools/io.h"
 #include "tools/util/cli_consumer.h"
 
+#if !defined(_WIN32)
+#include <dlfcn.h>
+#endif
+
 namespace {
 
 // Check that the std::system function can actually be used.
@@ -46,6 +53,53 @@ bool ExecuteCommand(const std::string& command) {
   return status == 0;
 }
 
+// The type of the function named "Interesting" that a library given with
+// --interestingness-library exports with C linkage.
+typedef bool (*InterestingFunction)(const uint32_t* words, size_t num_words);
+
+// A shared library exporting an interestingness function.
+class InterestingnessLibrary {
+ public:
+  InterestingnessLibrary() = default;
+  InterestingnessLibrary(const InterestingnessLibrary&) = delete;
+  InterestingnessLibrary& operator=(const InterestingnessLibrary&) = delete;
+
+  ~InterestingnessLibrary() {
+    if (!handle_) return;
+#if defined(_WIN32)
+    FreeLibrary(handle_);
+#else
+    dlclose(handle_);
+#endif
+  }
+
+  // Loads the library at |path|.  Returns true if it exports the function.
+  bool Load(const std::string& path) {
+#if defined(_WIN32)
+    handle_ = LoadLibraryA(path.c_str());
+    if (!handle_) return false;
+    function_ = reinterpret_cast<InterestingFunction>(
+        GetProcAddress(handle_, "Interesting"));
+#else
+    handle_ = dlopen(path.c_str(), RTLD_NOW | RTLD_LOCAL);
+    if (!handle_) return false;
+    function_ =
+        reinterpret_cast<InterestingFunction>(dlsym(handle_, "Interesting"));
+#endif
+    return function_ != nullptr;
+  }
+
+  InterestingFunction function() const { return function_; }
+
+ private:
+#if defined(_WIN32)
+  HMODULE handle_ = nullptr;
+#else
+  void* handle_ = nullptr;
+#endif
+  InterestingFunction function_ = nullptr;
+};
+
 // Status and actions to perform after parsing command-line arguments.
 enum ReduceActions { REDUCE_CONTINUE, REDUCE_STOP };
 
@@ -61,6 +115,7 @@ void PrintUsage(const char* program) {
 interestingness test.
 
 USAGE: %s [options] <input.spv> -o <output.spv> -- <interestingness_test> [args...]
+       %s [options] <input.spv> -o <output.spv> --interestingness-library=<library>
 
 The SPIR-V binary is read from <input.spv>. The reduced SPIR-V binary is
 written to <output.spv>.
@@ -90,15 +145,53 @@ forwarded to the interestingness test, and not parsed by %s.
    script when invoking SPIR-V-processing tools (such as "foo" in the above
    example).
 
+Alternatively, whether a binary is interesting is determined by calling the
+function that <library> exports, with C linkage, as:
+
+  bool Interesting(const uint32_t* words, size_t num_words);
+
+It receives the words of the SPIR-V binary, and returns true if and only if the
+binary is interesting.  This avoids starting a process and writing a file for
+each reduction step.  With --parallel, the function is called concurrently.
+
 NOTE: The reducer is a work in progress.
 
 Options (in lexicographical order):
 
+  --adaptive-scheduling
+               Run first the reduction passes which have most often made
+               interesting reduction steps, and let each pass try keeping
+               only small parts of what it can reduce, as delta debugging
+               does.  This usually needs fewer runs of the interestingness
+               test, but may give a different result.
+  --cache-dir=
+               Specifies an existing directory in which to remember whether
+               the binaries tested were interesting, so that a later reduction
+               with the same interestingness test does not test them again.
   --fail-on-validation-error
                Stop reduction with an error if any reduction step produces a
                SPIR-V module that fails to validate.
+  --function-by-function
+               First remove the functions that are not needed, then reduce
+               the remaining functions one at a time.  Each reduction step
+               then only looks at one function, which is faster for large
+               modules.
   -h, --help
                Print this help.
+  --interestingness-library=
+               Specifies a shared library exporting the interestingness
+               function, as described above, to use instead of an
+               interestingness test.
+  --parallel
+               Test reduction steps concurrently, on one thread per hardware
+               thread.  The interestingness test is then run on several
+               temporary files at once.  The result is the same as on one
+               thread.
+  --statistics=
+               Specifies a file to write statistics of the reduction to, as
+               JSON: for each reduction pass, the steps tried and those that
+               were interesting, the bytes they removed, and the time spent
+               making, validating and testing them.
   --step-limit=
                32-bit unsigned integer specifying maximum number of steps the
                reducer will take before giving up.
@@ -119,7 +212,7 @@ Supported validator options are as follows. See `spirv-val --help` for details.
   --scalar-block-layout
   --skip-block-layout
 )",
-      program, program, program);
+      program, program, program, program);
 }
 
 // Message consumer for this tool.  Used to emit diagnostics during
@@ -137,7 +230,9 @@ ReduceStatus ParseFlags(int argc, const char** argv,
                         std::string* in_binary_file,
                         std::string* out_binary_file,
                         std::vector<std::string>* interestingness_test,
-                        std::string* temp_file_prefix,
+                        std::string* temp_file_prefix, std::string* cache_dir,
+                        std::string* interestingness_library,
+                        std::string* statistics_file,
                         spvtools::ReducerOptions* reducer_options,
                         spvtools::ValidatorOptions* validator_options) {
   uint32_t positional_arg_index = 0;
@@ -171,6 +266,12 @@ ReduceStatus ParseFlags(int argc, const char** argv,
         reducer_options->set_step_limit(step_limit);
       } else if (0 == strcmp(cur_arg, "--fail-on-validation-error")) {
         reducer_options->set_fail_on_validation_error(true);
+      } else if (0 == strcmp(cur_arg, "--adaptive-scheduling")) {
+        reducer_options->set_adaptive_scheduling(true);
+      } else if (0 == strcmp(cur_arg, "--function-by-function")) {
+        reducer_options->set_function_by_function(true);
+      } else if (0 == strcmp(cur_arg, "--parallel")) {
+        reducer_options->set_num_threads(0);
       } else if (0 == strcmp(cur_arg, "--before-hlsl-legalization")) {
         validator_options->SetBeforeHlslLegalization(true);
       } else if (0 == strcmp(cur_arg, "--relax-logical-pointer")) {
@@ -187,6 +288,18 @@ ReduceStatus ParseFlags(int argc, const char** argv,
                               sizeof("--temp-file-prefix=") - 1)) {
         const auto split_flag = spvtools::utils::SplitFlagArgs(cur_arg);
         *temp_file_prefix = std::string(split_flag.second);
+      } else if (0 == strncmp(cur_arg, "--cache-dir=",
+                              sizeof("--cache-dir=") - 1)) {
+        const auto split_flag = spvtools::utils::SplitFlagArgs(cur_arg);
+        *cache_dir = std::string(split_flag.second);
+      } else if (0 == strncmp(cur_arg, "--interestingness-library=",
+                              sizeof("--interestingness-library=") - 1)) {
+        const auto split_flag = spvtools::utils::SplitFlagArgs(cur_arg);
+        *interestingness_library = std::string(split_flag.second);
+      } else if (0 == strncmp(cur_arg, "--statistics=",
+                              sizeof("--statistics=") - 1)) {
+        const auto split_flag = spvtools::utils::SplitFlagArgs(cur_arg);
+        *statistics_file = std::string(split_flag.second);
       } else if (0 == strcmp(cur_arg, "--")) {
         only_positional_arguments_remain = true;
       } else {
@@ -216,9 +329,12 @@ ReduceStatus ParseFlags(int argc, const char** argv,
     return {REDUCE_STOP, 1};
   }
 
-  if (interestingness_test->empty()) {
+  if (interestingness_test->empty() == interestingness_library->empty()) {
     spvtools::Error(ReduceDiagnostic, nullptr, {},
-                    "No interestingness test specified");
+                    interestingness_test->empty()
+                        ? "No interestingness test specified"
+                        : "Both an interestingness test and an "
+                          "interestingness library specified");
     return {REDUCE_STOP, 1};
   }
 
@@ -251,6 +367,9 @@ int main(int argc, const char** argv) {
   std::string out_binary_file;
   std::vector<std::string> interestingness_test;
   std::string temp_file_prefix = "temp_";
+  std::string cache_dir;
+  std::string interestingness_library;
+  std::string statistics_file;
 
   spv_target_env target_env = kDefaultEnvironment;
   spvtools::ReducerOptions reducer_options;
@@ -258,47 +377,74 @@ int main(int argc, const char** argv) {
 
   ReduceStatus status = ParseFlags(
       argc, argv, &in_binary_file, &out_binary_file, &interestingness_test,
-      &temp_file_prefix, &reducer_options, &validator_options);
+      &temp_file_prefix, &cache_dir, &interestingness_library,
+      &statistics_file, &reducer_options, &validator_options);
 
   if (status.action == REDUCE_STOP) {
     return status.code;
   }
 
-  if (!CheckExecuteCommand()) {
-    std::cerr << "could not find shell interpreter for executing a command"
-              << std::endl;
-    return 2;
-  }
-
   spvtools::reduce::Reducer reducer(target_env);
 
-  std::stringstream joined;
-  joined << interestingness_test[0];
-  for (size_t i = 1, size = interestingness_test.size(); i < size; ++i) {
-    joined << " " << interestingness_test[i];
-  }
-  std::string interestingness_command_joined = joined.str();
+  InterestingnessLibrary library;
+  if (!interestingness_library.empty()) {
+    if (!library.Load(interestingness_library)) {
+      std::cerr << "could not load the function Interesting from "
+                << interestingness_library << std::endl;
+      return 2;
+    }
+    const InterestingFunction interesting = library.function();
+    reducer.SetInterestingnessFunction(
+        [interesting](const std::vector<uint32_t>& binary, uint32_t) {
+          return interesting(binary.data(), binary.size());
+        });
+  } else {
+    if (!CheckExecuteCommand()) {
+      std::cerr << "could not find shell interpreter for executing a command"
+                << std::endl;
+      return 2;
+    }
 
-  reducer.SetInterestingnessFunction(
-      [interestingness_command_joined, temp_file_prefix](
-          std::vector<uint32_t> binary, uint32_t reductions_applied) -> bool {
-        std::stringstream ss;
-        ss << temp_file_prefix << std::setw(4) << std::setfill('0')
-           << reductions_applied << ".spv";
-        const auto spv_file = ss.str();
-        const std::string command =
-            interestingness_command_joined + " " + spv_file;
-        auto write_file_succeeded =
-            WriteFile(spv_file.c_str(), "wb", &binary[0], binary.size());
-        (void)(write_file_succeeded);
-        assert(write_file_succeeded);
-        return ExecuteCommand(command);
-      });
+    std::stringstream joined;
+    joined << interestingness_test[0];
+    for (size_t i = 1, size = interestingness_test.size(); i < size; ++i) {
+      joined << " " << interestingness_test[i];
+    }
+    std::string interestingness_command_joined = joined.str();
+
+    reducer.SetInterestingnessFunction(
+        [interestingness_command_joined, temp_file_prefix](
+            std::vector<uint32_t> binary, uint32_t reductions_applied) -> bool {
+          std::stringstream ss;
+          ss << temp_file_prefix << std::setw(4) << std::setfill('0')
+             << reductions_applied << ".spv";
+          const auto spv_file = ss.str();
+          const std::string command =
+              interestingness_command_joined + " " + spv_file;
+          auto write_file_succeeded =
+              WriteFile(spv_file.c_str(), "wb", &binary[0], binary.size());
+          (void)(write_file_succeeded);
+          assert(write_file_succeeded);
+          return ExecuteCommand(command);
+        });
+  }
 
   reducer.AddDefaultReductionPasses();
 
   reducer.SetMessageConsumer(spvtools::utils::CLIMessageConsumer);
 
+  // The binaries produced again by later steps are not tested again.
+  std::unique_ptr<spvtools::reduce::InterestingnessCache> cache;
+  if (cache_dir.empty()) {
+    cache.reset(new spvtools::reduce::MemoryInterestingnessCache());
+  } else {
+    cache.reset(new spvtools::reduce::DirectoryInterestingnessCache(cache_dir));
+  }
+  reducer.SetInterestingnessCache(cache.get());
+
+  spvtools::utils::StepStatistics statistics;
+  if (!statistics_file.empty()) reducer.SetStatistics(&statistics);
+
   std::vector<uint32_t> binary_in;
   if (!ReadFile<uint32_t>(in_binary_file.c_str(), "rb", &binary_in)) {
     return 1;
@@ -314,6 +460,17 @@ int main(int argc, const char** argv) {
     return 1;
   }
 
+  if (!statistics_file.empty()) {
+    std::ofstream statistics_out(statistics_file);
+    statistics.WriteJson(&statistics_out);
+    statistics_out.close();
+    if (statistics_out.fail()) {
+      std::cerr << "could not write statistics to " << statistics_file
+                << std::endl;
+      return 1;
+    }
+  }
+
   // These are the only successful statuses.
   switch (reduction_status) {
     case spvtools::reduce::Reducer::ReductionResultStatus::kComplete:
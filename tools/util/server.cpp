@@ -0,0 +1,144 @@
+// Copyright (c) 2019 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "tools/util/server.h"
+
+#include <algorithm>
+#include <condition_variable>
+#include <deque>
+#include <map>
+#include <mutex>
+#include <thread>
+#include <utility>
+
+namespace spvtools {
+namespace utils {
+namespace {
+
+// The most requests read ahead of the oldest unwritten response, for each
+// thread.
+const size_t kRequestsAheadPerThread = 4;
+
+// Reads a request from |in| into |binary|.  Returns false at the end of the
+// stream, and sets |truncated| if it ends within a request.
+bool ReadRequest(FILE* in, std::vector<uint32_t>* binary, bool* truncated) {
+  uint32_t num_words = 0;
+  const size_t read = fread(&num_words, 1, sizeof(num_words), in);
+  if (read != sizeof(num_words)) {
+    *truncated = read != 0;
+    return false;
+  }
+  if (num_words == 0) return false;
+  binary->resize(num_words);
+  if (fread(binary->data(), sizeof(uint32_t), num_words, in) != num_words) {
+    *truncated = true;
+    return false;
+  }
+  return true;
+}
+
+// Writes |response| to |out|.  Returns false on failure.
+bool WriteResponse(FILE* out, const ServerResponse& response) {
+  const uint32_t num_bytes = static_cast<uint32_t>(response.messages.size());
+  const uint32_t num_words = static_cast<uint32_t>(response.binary.size());
+  return fwrite(&response.status, sizeof(uint32_t), 1, out) == 1 &&
+         fwrite(&num_bytes, sizeof(uint32_t), 1, out) == 1 &&
+         fwrite(response.messages.data(), 1, num_bytes, out) == num_bytes &&
+         fwrite(&num_words, sizeof(uint32_t), 1, out) == 1 &&
+         fwrite(response.binary.data(), sizeof(uint32_t), num_words, out) ==
+             num_words;
+}
+
+}  // namespace
+
+bool Serve(FILE* in, FILE* out, uint32_t num_threads,
+           const ServerHandler& handler) {
+  if (num_threads == 0) {
+    num_threads = std::max(1u, std::thread::hardware_concurrency());
+  }
+  const size_t max_ahead = kRequestsAheadPerThread * num_threads;
+
+  std::mutex mutex;
+  std::condition_variable changed;
+  // The requests read but not handled yet, with their index.
+  std::deque<std::pair<size_t, std::vector<uint32_t>>> requests;
+  // The responses handled but not written yet, by the index of the request.
+  std::map<size_t, ServerResponse> responses;
+  size_t num_written = 0;
+  bool end_of_requests = false;
+  bool write_failed = false;
+
+  // Handles the requests until the end of the requests.  The responses are
+  // written by the thread which completes the oldest unwritten one.
+  auto work = [&]() {
+    std::unique_lock<std::mutex> lock(mutex);
+    while (true) {
+      changed.wait(lock,
+                   [&]() { return !requests.empty() || end_of_requests; });
+      if (requests.empty()) return;
+      std::pair<size_t, std::vector<uint32_t>> request =
+          std::move(requests.front());
+      requests.pop_front();
+
+      lock.unlock();
+      ServerResponse response = handler(request.second);
+      lock.lock();
+
+      responses.emplace(request.first, std::move(response));
+      bool wrote = false;
+      for (auto it = responses.find(num_written); it != responses.end();
+           it = responses.find(num_written)) {
+        if (!write_failed && !WriteResponse(out, it->second)) {
+          write_failed = true;
+        }
+        responses.erase(it);
+        ++num_written;
+        wrote = true;
+      }
+      if (wrote) {
+        if (fflush(out) != 0) write_failed = true;
+        changed.notify_all();
+      }
+    }
+  };
+
+  std::vector<std::thread> threads;
+  for (uint32_t i = 0; i < num_threads; ++i) threads.emplace_back(work);
+
+  bool truncated = false;
+  size_t num_read = 0;
+  std::vector<uint32_t> binary;
+  while (ReadRequest(in, &binary, &truncated)) {
+    std::unique_lock<std::mutex> lock(mutex);
+    changed.wait(lock, [&]() { return num_read - num_written < max_ahead; });
+    requests.emplace_back(num_read++, std::move(binary));
+    binary.clear();
+    changed.notify_all();
+  }
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    end_of_requests = true;
+  }
+  changed.notify_all();
+  for (std::thread& thread : threads) thread.join();
+
+  if (truncated) {
+    fprintf(stderr, "error: truncated request %zu\n", num_read);
+  }
+  if (write_failed) fprintf(stderr, "error: could not write a response\n");
+  return !truncated && !write_failed;
+}
+
+}  // namespace utils
+}  // namespace spvtools
@@ -0,0 +1,65 @@
+// Copyright (c) 2019 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef TOOLS_UTIL_SERVER_H_
+#define TOOLS_UTIL_SERVER_H_
+
+#include <cstdint>
+#include <cstdio>
+#include <functional>
+#include <string>
+#include <vector>
+
+namespace spvtools {
+namespace utils {
+
+// The server mode of the command line tools handles a stream of binaries in a
+// single process, so that the cost of starting a process and of building the
+// grammar tables is paid once rather than for each binary.
+//
+// All the words below are in the byte order of the host.  A request is a word
+// count, followed by that many words of a SPIR-V binary.  A request of no
+// words, or the end of the input, ends the stream.  The response to each
+// request is:
+//   - a status word, 0 if the request succeeded,
+//   - a byte count, followed by that many bytes of messages, one per line,
+//   - a word count, followed by that many words of the output binary, if the
+//     tool writes one.
+// The responses are written in the order of the requests, each as soon as it
+// and the ones before it are ready.
+
+// The response to a request of the server mode.
+struct ServerResponse {
+  uint32_t status = 0;
+  std::string messages;
+  std::vector<uint32_t> binary;
+};
+
+// Handles the binary of a request.
+using ServerHandler =
+    std::function<ServerResponse(const std::vector<uint32_t>& binary)>;
+
+// Serves the requests read from |in| until the end of the stream, and writes
+// the responses to |out|.  The requests are handled by |handler| on
+// |num_threads| threads, or one per hardware thread if |num_threads| is 0, so
+// |handler| must be thread safe if there are several.  Returns false if a
+// request is truncated or a response cannot be written, after writing an
+// error message to standard error.
+bool Serve(FILE* in, FILE* out, uint32_t num_threads,
+           const ServerHandler& handler);
+
+}  // namespace utils
+}  // namespace spvtools
+
+#endif  // TOOLS_UTIL_SERVER_H_
@@ -16,6 +16,8 @@
 #include <cstdio>
 #include <cstring>
 #include <iostream>
+#include <memory>
+#include <string>
 #include <vector>
 
 #include "source/spirv_target_env.h"
@@ -23,6 +25,7 @@
 #include "spirv-tools/libspirv.hpp"
 #include "tools/io.h"
 #include "tools/util/cli_consumer.h"
+#include "tools/util/server.h"
 
 void print_usage(char* argv0) {
   std::string target_env_list = spvTargetEnvList(36, 105);
@@ -65,6 +68,26 @@ Options:
                                    members.
   --before-hlsl-legalization       Allows code patterns that are intended to be
                                    fixed by spirv-opt's legalization passes.
+  --structural-only                Only check that ids, types and control flow are
+                                   well formed, skipping decoration, layout, built-in
+                                   and per-instruction operand rules.
+  --parallel                       Check the instructions of different functions
+                                   on multiple threads.
+  --cache-dir                      <existing directory>
+                                   Remember the modules found valid in the directory,
+                                   and do not check them again.
+  --time-report                    Print the time spent in each phase of the
+                                   validation, and in each check of the
+                                   instructions, to standard error.
+  --server                         Validate the binaries of a stream of requests
+                                   read from standard input, and write a response
+                                   for each to standard output.  Each request is
+                                   a word count followed by the words of a binary.
+                                   Each response is the spv_result_t of the
+                                   validation, the byte count and bytes of the
+                                   error message, and a word count of 0.  With
+                                   --parallel, several binaries are validated at
+                                   once.
   --version                        Display validator version information.
   --target-env                     {%s}
                                    Use validation rules from the specified environment.
@@ -72,10 +95,53 @@ Options:
       argv0, argv0, target_env_list.c_str());
 }
 
+// Validates the binaries of the requests read from the standard input with
+// |options|, and writes the responses to the standard output.  Returns the
+// exit code.
+int Serve(spv_target_env target_env, spvtools::ValidatorOptions* options,
+          bool parallel) {
+  FILE* in = freopen(nullptr, "rb", stdin);
+  FILE* out = freopen(nullptr, "wb", stdout);
+  if (!in || !out) {
+    fprintf(stderr, "error: could not reopen the standard streams\n");
+    return 1;
+  }
+  // The binaries are the unit of parallelism, as in
+  // spvValidateBatchWithOptions.
+  if (parallel) options->SetNumThreads(1);
+
+  // The context, and the grammar tables it holds, are shared by every
+  // request.
+  spv_context context = spvContextCreate(target_env);
+  const spv_validator_options validator_options = *options;
+  const bool ok = spvtools::utils::Serve(
+      in, out, parallel ? 0 : 1,
+      [context, validator_options](const std::vector<uint32_t>& binary) {
+        spvtools::utils::ServerResponse response;
+        const spv_const_binary_t module = {binary.data(), binary.size()};
+        spv_diagnostic diagnostic = nullptr;
+        const spv_result_t result = spvValidateWithOptions(
+            context, validator_options, &module, &diagnostic);
+        response.status = static_cast<uint32_t>(result);
+        if (diagnostic) {
+          response.messages = "error: line " +
+                              std::to_string(diagnostic->position.index) +
+                              ": " + diagnostic->error + "\n";
+          spvDiagnosticDestroy(diagnostic);
+        }
+        return response;
+      });
+  spvContextDestroy(context);
+  return ok ? 0 : 1;
+}
+
 int main(int argc, char** argv) {
   const char* inFile = nullptr;
   spv_target_env target_env = SPV_ENV_UNIVERSAL_1_5;
   spvtools::ValidatorOptions options;
+  std::unique_ptr<spvtools::DirectoryValidationCache> cache;
+  bool parallel = false;
+  bool server = false;
   bool continue_processing = true;
   int return_code = 0;
 
@@ -151,8 +217,26 @@ int main(int argc, char** argv) {
         options.SetScalarBlockLayout(true);
       } else if (0 == strcmp(cur_arg, "--skip-block-layout")) {
         options.SetSkipBlockLayout(true);
+      } else if (0 == strcmp(cur_arg, "--structural-only")) {
+        options.SetStructuralOnly(true);
       } else if (0 == strcmp(cur_arg, "--relax-struct-store")) {
         options.SetRelaxStructStore(true);
+      } else if (0 == strcmp(cur_arg, "--parallel")) {
+        options.SetNumThreads(0);
+        parallel = true;
+      } else if (0 == strcmp(cur_arg, "--time-report")) {
+        options.SetTimeReport(&std::cerr);
+      } else if (0 == strcmp(cur_arg, "--server")) {
+        server = true;
+      } else if (0 == strcmp(cur_arg, "--cache-dir")) {
+        if (argi + 1 < argc) {
+          cache.reset(new spvtools::DirectoryValidationCache(argv[++argi]));
+          options.SetCache(cache.get());
+        } else {
+          fprintf(stderr, "error: Missing argument to --cache-dir\n");
+          continue_processing = false;
+          return_code = 1;
+        }
       } else if (0 == cur_arg[1]) {
         // Setting a filename of "-" to indicate stdin.
         if (!inFile) {
@@ -183,8 +267,16 @@ int main(int argc, char** argv) {
     return return_code;
   }
 
-  std::vector<uint32_t> contents;
-  if (!ReadFile<uint32_t>(inFile, "rb", &contents)) return 1;
+  if (server) {
+    if (inFile) {
+      fprintf(stderr, "error: --server reads the standard input\n");
+      return 1;
+    }
+    return Serve(target_env, &options, parallel);
+  }
+
+  BinaryFile contents;
+  if (!contents.Open(inFile)) return 1;
 
   spvtools::SpirvTools tools(target_env);
   tools.SetMessageConsumer(spvtools::utils::CLIMessageConsumer);
@@ -335,9 +335,35 @@ def generate_instruction(inst, is_ext_inst):
         return str(InstInitializer(opname, caps, exts, operands, min_version, max_version))
 
 
+def generate_name_order(name, names):
+    """Returns the C definition of an array named |name| holding the indices
+    of |names|, sorted by name.  Indices of equal names keep their relative
+    order, so a lookup by binary search finds the first of them in the
+    original table.
+    """
+    order = sorted(range(len(names)), key=lambda i: names[i])
+    template = ['static const uint16_t {name}[] = {{', '  {order}', '}};']
+    return '\n'.join(template).format(
+        name=name, order=', '.join([str(i) for i in order]) if order else '0')
+
+
+def generate_value_index(name, values):
+    """Returns the C definition of an array named |name| indexed by value,
+    holding the index of the first of |values| equal to each value, or
+    0xFFFF if none is, so a lookup by value is a single load.
+    """
+    index = [0xFFFF] * (max(values) + 1 if values else 1)
+    for i in reversed(range(len(values))):
+        index[values[i]] = i
+    template = ['static const uint16_t {name}[] = {{', '  {index}', '}};']
+    return '\n'.join(template).format(
+        name=name, index=', '.join([str(i) for i in index]))
+
+
 def generate_instruction_table(inst_table):
     """Returns the info table containing all SPIR-V instructions, sorted by
-    opcode, and prefixed by capability arrays.
+    opcode, and prefixed by capability arrays.  It is followed by an index
+    of the table sorted by opcode name.
 
     Note:
       - the built-in sorted() function is guaranteed to be stable.
@@ -357,12 +383,18 @@ def generate_instruction_table(inst_table):
     insts = ['static const spv_opcode_desc_t kOpcodeTableEntries[] = {{\n'
              '  {}\n}};'.format(',\n  '.join(insts))]
 
-    return '{}\n\n{}\n\n{}'.format(caps_arrays, exts_arrays, '\n'.join(insts))
+    name_order = generate_name_order(
+        'kOpcodeTableNameOrder', [inst['opname'] for inst in inst_table])
+
+    return '{}\n\n{}\n\n{}\n\n{}'.format(caps_arrays, exts_arrays,
+                                         '\n'.join(insts), name_order)
 
 
 def generate_extended_instruction_table(json_grammar, set_name, operand_kind_prefix=""):
     """Returns the info table containing all SPIR-V extended instructions,
-    sorted by opcode, and prefixed by capability arrays.
+    sorted by opcode, and prefixed by capability arrays.  It is followed by
+    an index of the table sorted by instruction name, and an index of the
+    table by opcode.
 
     Arguments:
       - inst_table: a list containing all SPIR-V instructions.
@@ -383,7 +415,15 @@ def generate_extended_instruction_table(json_grammar, set_name, operand_kind_pre
     insts = ['static const spv_ext_inst_desc_t {}_entries[] = {{\n'
              '  {}\n}};'.format(set_name, ',\n  '.join(insts))]
 
-    return '{}\n\n{}'.format(caps_arrays, '\n'.join(insts))
+    name_order = generate_name_order(
+        '{}_name_order'.format(set_name),
+        [inst['opname'] for inst in inst_table])
+    value_index = generate_value_index(
+        '{}_value_index'.format(set_name),
+        [inst['opcode'] for inst in inst_table])
+
+    return '{}\n\n{}\n\n{}\n\n{}'.format(caps_arrays, '\n'.join(insts),
+                                         name_order, value_index)
 
 
 class EnumerantInitializer(object):
@@ -460,7 +500,8 @@ def generate_enum_operand_kind_entry(entry, extension_map):
 
 def generate_enum_operand_kind(enum, synthetic_exts_list):
     """Returns the C definition for the given operand kind.
-    It's a static const named array of spv_operand_desc_t.
+    It's a static const named array of spv_operand_desc_t, followed by
+    an index of that array sorted by enumerant name.
 
     Also appends to |synthetic_exts_list| a list of extension lists
     used.
@@ -495,6 +536,9 @@ def generate_enum_operand_kind(enum, synthetic_exts_list):
     synthetic_exts_list.extend(extension_map.values())
 
     name = '{}_{}Entries'.format(PYGEN_VARIABLE_PREFIX, kind)
+    order_name = '{}_{}NameOrder'.format(PYGEN_VARIABLE_PREFIX, kind)
+    name_order = generate_name_order(order_name,
+                                     [e.get('enumerant') for e in entries])
     entries = ['  {}'.format(generate_enum_operand_kind_entry(e, extension_map))
                for e in entries]
 
@@ -504,7 +548,7 @@ def generate_enum_operand_kind(enum, synthetic_exts_list):
         name=name,
         entries=',\n'.join(entries))
 
-    return kind, name, entries
+    return kind, (name, order_name), entries + '\n' + name_order
 
 
 def generate_operand_kind_table(enums):
@@ -536,8 +580,9 @@ def generate_operand_kind_table(enums):
     enum_entries = enum_entries[:-3]
     enum_kinds = [convert_operand_kind(e)
                   for e in zip(enum_kinds, enum_quantifiers)]
-    table_entries = zip(enum_kinds, enum_names, enum_names)
-    table_entries = ['  {{{}, ARRAY_SIZE({}), {}}}'.format(*e)
+    table_entries = [(kind, names[0], names[0], names[1])
+                     for kind, names in zip(enum_kinds, enum_names)]
+    table_entries = ['  {{{}, ARRAY_SIZE({}), {}, {}}}'.format(*e)
                      for e in table_entries]
 
     template = [